@@ -0,0 +1,405 @@
+#!/usr/bin/env python3
+#
+# Runs glmark2-es2 and the GLOVE demos on top of a GLOVE build, collects the
+# FPS and frame times of every scene into a JSON file and compares them
+# against a stored baseline.
+#
+# Usage: run_benchmarks.py [options]
+#   -b, --build-dir <dir>    GLOVE build folder (default: build)
+#   -B, --build              build GLOVE, the demos included, before running
+#   -g, --glmark2 <path>     glmark2-es2 executable (default: looked up in PATH)
+#   -s, --scenes <file>      glmark2 scenes (default: glmark/glmark2_benchmarks_options)
+#   -d, --demos <list>       comma separated demos to run (default: all the built ones)
+#   -n, --no-demos           do not run the demos
+#   -G, --no-glmark2         do not run glmark2
+#   -o, --output <file>      results (default: <build-dir>/benchmark_results.json)
+#   -c, --compare <file>     baseline the results are compared against
+#   -t, --tolerance <pct>    slowdown allowed before a scene is a regression (default: 5)
+#   -u, --update-baseline    write the results over the baseline given by -c
+#   -S, --startup            also time the startup of the demos, with cold and then warm caches
+#   -M, --memory             also record the peak memory of the demos, and of each glmark2 scene on its own
+#
+# The exit status is 1 when at least one scene regressed or went missing.
+
+import os
+import re
+import sys
+import json
+import getopt
+import shutil
+import tempfile
+import subprocess
+
+BASEDIR = os.path.dirname(os.path.realpath(__file__))
+GLOVE_ROOT = os.path.dirname(BASEDIR)
+
+BUILD_DIR = os.path.join(GLOVE_ROOT, "build")
+BUILD = False
+GLMARK2 = ""
+SCENES_FILE = os.path.join(BASEDIR, "glmark", "glmark2_benchmarks_options")
+DEMOS = []
+RUN_DEMOS = True
+RUN_GLMARK2 = True
+OUTPUT = ""
+BASELINE = ""
+TOLERANCE = 5.0
+UPDATE_BASELINE = False
+RUN_STARTUP = False
+RUN_MEMORY = False
+
+# seconds each glmark2 scene runs for when its memory is recorded, the peak is reached with the first frames
+MEMORY_SCENE_DURATION = 2.0
+
+# the peaks of the memory report a scene regresses on, the others are recorded for reference
+MEMORY_KEYS = ("peak_rss_bytes", "peak_device_local_bytes", "peak_host_visible_bytes")
+
+# the spans of the GLOVE trace that make up the startup breakdown, and the keys they are reported as
+STARTUP_SPANS = {"init API":                  "init_api",
+                 "create context":            "context",
+                 "InitializeDefaultTextures": "default_textures",
+                 "set surfaces":              "set_surfaces",
+                 "compile shader":            "glslang_compile",
+                 "link program":              "glslang_link",
+                 "vkCreateGraphicsPipelines": "pipeline"}
+
+# [build] use-vbo=false: FPS: 1234 FrameTime: 0.810 ms
+GLMARK2_RESULT = re.compile(r"^\[(?P<scene>[^\]]+)\] (?P<options>.*?):? FPS: (?P<fps>[\d.]+) FrameTime: (?P<frametime>[\d.]+) ms")
+
+def PrintUsage():
+    with open(os.path.realpath(__file__)) as script:
+        for line in script.readlines()[6:22]:
+            print(line[2:].rstrip())
+
+def Environment():
+    env = os.environ.copy()
+    libs = [os.path.join(BUILD_DIR, "EGL", "source"), os.path.join(BUILD_DIR, "GLES", "source")]
+    if env.get("LD_LIBRARY_PATH"):
+        libs.append(env["LD_LIBRARY_PATH"])
+    env["LD_LIBRARY_PATH"] = os.pathsep.join(libs)
+    return env
+
+def Wrapper():
+    # without a display, the window system the demos and glmark2 need is a virtual one
+    if os.environ.get("DISPLAY") or os.environ.get("WAYLAND_DISPLAY"):
+        return []
+    xvfb = shutil.which("xvfb-run")
+    if xvfb is None:
+        print("Warning: neither a display nor xvfb-run is available")
+        return []
+    return [xvfb, "-a", "-s", "-screen 0 1280x1024x24"]
+
+def Percentile(values, percent):
+    ordered = sorted(values)
+    rank = max(0, int(round(percent / 100.0 * len(ordered) + 0.5)) - 1)
+    return ordered[min(rank, len(ordered) - 1)]
+
+def FrameStats(frameTimes):
+    total = sum(frameTimes)
+    return {"fps":           len(frameTimes) * 1000.0 / total if total > 0 else 0.0,
+            "frame_time_ms": total / len(frameTimes),
+            "p50_ms":        Percentile(frameTimes, 50),
+            "p90_ms":        Percentile(frameTimes, 90),
+            "p99_ms":        Percentile(frameTimes, 99),
+            "frames":        len(frameTimes)}
+
+def CpuStats(cpuTimes, draws):
+    total = sum(cpuTimes)
+    return {"cpu_ms":        total / len(cpuTimes),
+            "draws_per_sec": sum(draws) * 1000.0 / total if total > 0 else 0.0}
+
+def Build():
+    print("Building GLOVE (" + BUILD_DIR + ")")
+    subprocess.check_call(["cmake", "--build", BUILD_DIR, "--", "-j", str(os.cpu_count() or 1)])
+
+def RunGlmark2():
+    results = {}
+    glmark2 = GLMARK2 or shutil.which("glmark2-es2")
+    if not glmark2:
+        print("Skipping glmark2: glmark2-es2 was not found")
+        return results
+
+    print("Running glmark2 (" + glmark2 + ")")
+    command = Wrapper() + [glmark2, "--reuse-context", "--off-screen", "-f", SCENES_FILE]
+    output = subprocess.run(command, env=Environment(), stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True).stdout
+
+    for line in output.splitlines():
+        match = GLMARK2_RESULT.match(line.strip())
+        if match is None:
+            continue
+        # glmark2 reports the mean frame time only
+        name = "glmark2/" + match.group("scene")
+        if match.group("options") not in ("", "<default>"):
+            name += ":" + match.group("options")
+        results[name] = {"fps": float(match.group("fps")), "frame_time_ms": float(match.group("frametime"))}
+
+    return results
+
+def BuiltDemos(demosDir):
+    demos = []
+    for source in sorted(os.listdir(os.path.join(GLOVE_ROOT, "Demos", "demos"))):
+        name, extension = os.path.splitext(source)
+        if extension == ".c" and os.access(os.path.join(demosDir, name), os.X_OK):
+            demos.append(name)
+    return demos
+
+def RunDemos():
+    results = {}
+    demosDir = os.path.join(BUILD_DIR, "Demos", "demos")
+    demos = DEMOS or BuiltDemos(demosDir)
+    if not demos:
+        print("Skipping demos: none was found in " + demosDir)
+        return results
+
+    env = Environment()
+    for demo in demos:
+        print("Running " + demo)
+        with tempfile.NamedTemporaryFile(mode="r", suffix=".log") as frameLog, \
+             tempfile.NamedTemporaryFile(mode="r", suffix=".log") as cpuLog:
+            env["GLOVE_DEMOS_FRAME_LOG"] = frameLog.name
+            env["GLOVE_DEMOS_CPU_LOG"] = cpuLog.name
+            # the demos load their assets relatively to the folder they are built into
+            subprocess.run(Wrapper() + [os.path.join(demosDir, demo)], cwd=demosDir, env=env,
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            frameTimes = [float(line) for line in frameLog.read().split()]
+            # "<cpu ms> <draws>" per frame, written by the demos that time their GL calls
+            cpuFrames = [line.split() for line in cpuLog.read().splitlines() if len(line.split()) == 2]
+
+        if frameTimes:
+            results["demos/" + demo] = FrameStats(frameTimes)
+            if cpuFrames:
+                results["demos/" + demo].update(CpuStats([float(frame[0]) for frame in cpuFrames],
+                                                         [int(frame[1]) for frame in cpuFrames]))
+        else:
+            print("Warning: " + demo + " rendered no frames")
+
+    return results
+
+def StartupStats(phases, trace):
+    # "<phase> <start ms> <duration ms>" per line, since eglutInit, the last one is the first swap
+    stats = {}
+    traceStart = 0.0
+    for phase, start, duration in phases:
+        stats[phase + "_ms"] = stats.get(phase + "_ms", 0.0) + duration
+        stats[phase + "_count"] = stats.get(phase + "_count", 0) + 1
+        if phase == "first_swap":
+            stats["first_frame_ms"] = start + duration
+        if phase == "egl_initialize":
+            traceStart = start
+
+    # the GLOVE trace starts along with eglInitialize, its spans are laid out on the same time line
+    for event in trace:
+        key = STARTUP_SPANS.get(event.get("name"))
+        if key is None or event.get("ph") != "X":
+            continue
+        key = "trace_" + key
+        if key + "_count" not in stats:
+            stats[key + "_first_at_ms"] = traceStart + event["ts"] / 1000.0
+            stats[key + "_first_ms"] = event["dur"] / 1000.0
+        stats[key + "_ms"] = stats.get(key + "_ms", 0.0) + event["dur"] / 1000.0
+        stats[key + "_count"] = stats.get(key + "_count", 0) + 1
+
+    return stats
+
+def RunStartup():
+    results = {}
+    demosDir = os.path.join(BUILD_DIR, "Demos", "demos")
+    demos = DEMOS or BuiltDemos(demosDir)
+    if not demos:
+        print("Skipping startup: no demo was found in " + demosDir)
+        return results
+
+    env = Environment()
+    for demo in demos:
+        # the first run fills the shader and pipeline caches, which the second one starts from
+        cacheDir = tempfile.mkdtemp(prefix="glove_startup_")
+        env["GLOVE_PIPELINE_CACHE_PATH"] = os.path.join(cacheDir, "pipeline.cache")
+        env["GLOVE_SHADER_CACHE_PATH"] = os.path.join(cacheDir, "shaders")
+        for run in ("cold", "warm"):
+            print("Timing the " + run + " startup of " + demo)
+            with tempfile.NamedTemporaryFile(mode="r", suffix=".log") as startupLog, \
+                 tempfile.NamedTemporaryFile(mode="r", suffix=".json") as traceFile:
+                env["GLOVE_DEMOS_STARTUP_LOG"] = startupLog.name
+                env["GLOVE_CHROME_TRACE"] = traceFile.name
+                subprocess.run(Wrapper() + [os.path.join(demosDir, demo)], cwd=demosDir, env=env,
+                               stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+                phases = [(fields[0], float(fields[1]), float(fields[2]))
+                          for fields in (line.split() for line in startupLog.read().splitlines()) if len(fields) == 3]
+                try:
+                    trace = json.loads(traceFile.read())["traceEvents"]
+                except ValueError:
+                    trace = []
+
+            if phases and phases[-1][0] == "first_swap":
+                results["startup/" + demo + ":" + run] = StartupStats(phases, trace)
+            else:
+                print("Warning: " + demo + " presented no frame")
+        shutil.rmtree(cacheDir, ignore_errors=True)
+
+    return results
+
+def RunWithMemoryReport(command, cwd):
+    # "<name> <bytes>" per line, written by GLOVE when the process is done with the device
+    env = Environment()
+    with tempfile.NamedTemporaryFile(mode="r", suffix=".log") as report:
+        env["GLOVE_MEMORY_REPORT"] = report.name
+        subprocess.run(Wrapper() + command, cwd=cwd, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        peaks = [line.split() for line in report.read().splitlines() if len(line.split()) == 2]
+    return {name: int(value) for name, value in peaks}
+
+def RunMemory():
+    results = {}
+    demosDir = os.path.join(BUILD_DIR, "Demos", "demos")
+    for demo in DEMOS or BuiltDemos(demosDir):
+        print("Recording the memory of " + demo)
+        peaks = RunWithMemoryReport([os.path.join(demosDir, demo)], demosDir)
+        if peaks:
+            results["memory/demos/" + demo] = peaks
+        else:
+            print("Warning: " + demo + " wrote no memory report")
+
+    glmark2 = GLMARK2 or shutil.which("glmark2-es2")
+    if not glmark2:
+        print("Skipping the memory of glmark2: glmark2-es2 was not found")
+        return results
+
+    # each scene runs in a process of its own, so that its peak is not that of the scenes before it
+    with open(SCENES_FILE) as scenesFile:
+        scenes = [line.strip() for line in scenesFile if line.strip() and not line.startswith("#")]
+    for scene in scenes:
+        print("Recording the memory of glmark2 " + scene)
+        peaks = RunWithMemoryReport([glmark2, "--reuse-context", "--off-screen",
+                                     "-b", scene + ":duration=" + str(MEMORY_SCENE_DURATION)], None)
+        if peaks:
+            results["memory/glmark2/" + scene] = peaks
+        else:
+            print("Warning: glmark2 " + scene + " wrote no memory report")
+
+    return results
+
+def Compare(results, baseline):
+    regressions = 0
+    print("")
+    print("%-72s %10s %10s %8s" % ("scene", "baseline", "current", "change"))
+    for name in sorted(baseline):
+        if name not in results:
+            print("%-72s %10s" % (name, "MISSING"))
+            regressions += 1
+            continue
+
+        base = baseline[name]
+        current = results[name]
+        # memory is compared by its peaks, which are to shrink, the largest growth is the one listed
+        if "peak_rss_bytes" in base:
+            growths = [(current.get(key, 0) / float(base[key]) - 1.0) * 100.0 for key in MEMORY_KEYS if base.get(key, 0) > 0]
+            change = max(growths) if growths else 0.0
+            regressed = change > TOLERANCE
+            print("%-72s %8.1fMB %8.1fMB %+7.1f%%%s" % (name, base["peak_rss_bytes"] / 1048576.0, current.get("peak_rss_bytes", 0) / 1048576.0,
+                                                       change, "  REGRESSION" if regressed else ""))
+            regressions += 1 if regressed else 0
+            continue
+
+        # startups are compared by the time to their first frame, which is to shrink
+        if "first_frame_ms" in base:
+            change = (current["first_frame_ms"] / base["first_frame_ms"] - 1.0) * 100.0 if base["first_frame_ms"] > 0 else 0.0
+            regressed = change > TOLERANCE
+            print("%-72s %8.1fms %8.1fms %+7.1f%%%s" % (name, base["first_frame_ms"], current["first_frame_ms"], change,
+                                                       "  REGRESSION" if regressed else ""))
+            regressions += 1 if regressed else 0
+            continue
+
+        change = (current["fps"] / base["fps"] - 1.0) * 100.0 if base["fps"] > 0 else 0.0
+        regressed = change < -TOLERANCE
+        # a steady average may hide a few long frames more than before
+        if "p99_ms" in base and "p99_ms" in current and base["p99_ms"] > 0:
+            regressed = regressed or (current["p99_ms"] / base["p99_ms"] - 1.0) * 100.0 > TOLERANCE
+        # a GPU bound scene may hide the time spent issuing its draws growing
+        if "cpu_ms" in base and "cpu_ms" in current and base["cpu_ms"] > 0:
+            regressed = regressed or (current["cpu_ms"] / base["cpu_ms"] - 1.0) * 100.0 > TOLERANCE
+
+        print("%-72s %10.1f %10.1f %+7.1f%%%s" % (name, base["fps"], current["fps"], change, "  REGRESSION" if regressed else ""))
+        regressions += 1 if regressed else 0
+
+    for name in sorted(set(results) - set(baseline)):
+        print("%-72s %10s %10.1f" % (name, "NEW", results[name].get("fps", results[name].get("first_frame_ms", results[name].get("peak_rss_bytes", 0.0)))))
+
+    return regressions
+
+def main(argv):
+    global BUILD_DIR, BUILD, GLMARK2, SCENES_FILE, DEMOS, RUN_DEMOS, RUN_GLMARK2, OUTPUT, BASELINE, TOLERANCE, UPDATE_BASELINE, RUN_STARTUP, RUN_MEMORY
+
+    try:
+        opts, args = getopt.getopt(argv, "hb:Bg:s:d:nGo:c:t:uSM", ["help", "build-dir=", "build", "glmark2=", "scenes=", "demos=",
+                                                                    "no-demos", "no-glmark2", "output=", "compare=", "tolerance=",
+                                                                    "update-baseline", "startup", "memory"])
+    except getopt.GetoptError:
+        PrintUsage()
+        sys.exit(2)
+
+    for opt, arg in opts:
+        if opt in ("-h", "--help"):
+            PrintUsage()
+            sys.exit()
+        elif opt in ("-b", "--build-dir"):
+            BUILD_DIR = os.path.realpath(arg)
+        elif opt in ("-B", "--build"):
+            BUILD = True
+        elif opt in ("-g", "--glmark2"):
+            GLMARK2 = arg
+        elif opt in ("-s", "--scenes"):
+            SCENES_FILE = os.path.realpath(arg)
+        elif opt in ("-d", "--demos"):
+            DEMOS = [demo for demo in arg.split(",") if demo]
+        elif opt in ("-n", "--no-demos"):
+            RUN_DEMOS = False
+        elif opt in ("-G", "--no-glmark2"):
+            RUN_GLMARK2 = False
+        elif opt in ("-o", "--output"):
+            OUTPUT = arg
+        elif opt in ("-c", "--compare"):
+            BASELINE = arg
+        elif opt in ("-t", "--tolerance"):
+            TOLERANCE = float(arg)
+        elif opt in ("-u", "--update-baseline"):
+            UPDATE_BASELINE = True
+        elif opt in ("-S", "--startup"):
+            RUN_STARTUP = True
+        elif opt in ("-M", "--memory"):
+            RUN_MEMORY = True
+
+    if BUILD:
+        Build()
+
+    results = {}
+    if RUN_GLMARK2:
+        results.update(RunGlmark2())
+    if RUN_DEMOS:
+        results.update(RunDemos())
+    if RUN_STARTUP:
+        results.update(RunStartup())
+    if RUN_MEMORY:
+        results.update(RunMemory())
+
+    output = OUTPUT or os.path.join(BUILD_DIR, "benchmark_results.json")
+    with open(output, "w") as outputFile:
+        json.dump({"scenes": results}, outputFile, indent=4, sort_keys=True)
+    print("Results of " + str(len(results)) + " scenes written to " + output)
+
+    if not BASELINE:
+        return 0
+
+    if UPDATE_BASELINE or not os.path.exists(BASELINE):
+        shutil.copyfile(output, BASELINE)
+        print("Baseline " + BASELINE + " updated")
+        return 0
+
+    with open(BASELINE) as baselineFile:
+        baseline = json.load(baselineFile)["scenes"]
+
+    regressions = Compare(results, baseline)
+    print("")
+    print(str(regressions) + " scenes regressed by more than " + str(TOLERANCE) + "%")
+    return 1 if regressions else 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -2,6 +2,7 @@ start /W triangle2d_one_color
 start /W triangle2d_split_colors
 start /W circle2d_sdf
 start /W texture2d_color
+start /W texture2d_shared_context
 start /W cube3d_vertexcolors
 start /W cube3d_textures
 start /W render_to_texture_filter_gamma
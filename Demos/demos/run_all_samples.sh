@@ -32,6 +32,7 @@ function setupDemos() {
               $CMDDIR/triangle2d_split_colors \
               $CMDDIR/circle2d_sdf \
               $CMDDIR/texture2d_color \
+              $CMDDIR/texture2d_shared_context \
               $CMDDIR/cube3d_vertexcolors \
               $CMDDIR/cube3d_textures \
               $CMDDIR/render_to_texture_filter_gamma \
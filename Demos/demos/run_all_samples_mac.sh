@@ -12,6 +12,7 @@ open -W ${BUILD_TYPE}/triangle2d_one_color.app
 open -W ${BUILD_TYPE}/triangle2d_split_colors.app
 open -W ${BUILD_TYPE}/circle2d_sdf.app
 open -W ${BUILD_TYPE}/texture2d_color.app
+open -W ${BUILD_TYPE}/texture2d_shared_context.app
 open -W ${BUILD_TYPE}/cube3d_vertexcolors.app
 open -W ${BUILD_TYPE}/cube3d_textures.app
 open -W ${BUILD_TYPE}/render_to_texture_filter_gamma.app
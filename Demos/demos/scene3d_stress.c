@@ -0,0 +1,261 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "scene3d_stress.h"
+
+static  openGL_mesh_t      mesh_textures_a;
+static  openGL_mesh_t      mesh_textures_b;
+static  openGL_mesh_t      mesh_colors;
+static  openGL_program_t   program_textures;
+static  openGL_program_t   program_colors;
+static  openGL_scene_t     scene;
+static  openGL_camera_t    camera;
+static  openGL_viewport_t  viewport;
+static  openGL_rendering_t rendering;
+static  const char        *win_name;
+
+static bool InitStressProgram(struct openGL_program_t *program, const char *vertex_shader_name, const char *fragment_shader_name)
+{
+    InitProgram(program);
+
+    if(!LoadShader(vertex_shader_name, &program->mVertexShader, GL_VERTEX_SHADER))
+        return false;
+    if(!LoadShader(fragment_shader_name, &program->mFragmentShader, GL_FRAGMENT_SHADER))
+        return false;
+    if(!LoadProgram(program->mVertexShader, program->mFragmentShader, &program->mID))
+        return false;
+
+    glUseProgram(program->mID);
+    program->mLocationPos      = glGetAttribLocation (program->mID, "v_posCoord_in");
+    program->mLocationUV       = glGetAttribLocation (program->mID, "v_textCoord_in");
+    program->mLocationColor    = glGetAttribLocation (program->mID, "v_colorCoord_in");
+    program->mLocationMVP      = glGetUniformLocation(program->mID, "uniform_mvp");
+    program->mLocationMixValue = glGetUniformLocation(program->mID, "uniform_mix_value");
+    glUniform1i(glGetUniformLocation(program->mID, "uniform_texture0"), 0);
+    glUniform1i(glGetUniformLocation(program->mID, "uniform_texture1"), 1);
+
+    return true;
+}
+
+static bool InitStressScene(int nodes_num)
+{
+    if(!InitScene(&scene, nodes_num))
+        return false;
+
+    int   side    = (int)ceilf(sqrtf((float)nodes_num));
+    float spacing = STRESS_GRID_SIZE / (float)side;
+
+    for(int i = 0; i < nodes_num; ++i) {
+        vec3 position = { ((float)(i % side) + 0.5f) * spacing - STRESS_GRID_SIZE * 0.5f,
+                          0.0f,
+                          ((float)(i / side) + 0.5f) * spacing - STRESS_GRID_SIZE * 0.5f };
+
+// Interleave the materials, so that the program, the textures and the blending state change between draws
+        openGL_scene_node_t *node;
+        switch(i % 4) {
+        case 0:  node = AddSceneNode(&scene, &mesh_textures_a, &program_textures, OPAQUE     , position, spacing * 0.35f); break;
+        case 1:  node = AddSceneNode(&scene, &mesh_colors    , &program_colors  , OPAQUE     , position, spacing * 0.35f); break;
+        case 2:  node = AddSceneNode(&scene, &mesh_textures_b, &program_textures, OPAQUE     , position, spacing * 0.35f); break;
+        default: node = AddSceneNode(&scene, &mesh_textures_a, &program_textures, TRANSPARENT, position, spacing * 0.35f); break;
+        }
+
+        node->mSpinAxis[0] = (i / 4) % 3 == 0 ? 1.0f : 0.0f;
+        node->mSpinAxis[1] = (i / 4) % 3 == 1 ? 1.0f : 0.0f;
+        node->mSpinAxis[2] = (i / 4) % 3 == 2 ? 1.0f : 0.0f;
+        node->mSpinAngle   = 0.5f + (float)(i % 7) * 0.25f;
+        node->mMixValue    = (float)(i % 16) / 16.0f;
+    }
+
+    return true;
+}
+
+bool InitGL()
+{
+  // Print GPU specifications
+    GpuViewer();
+
+// Initialize Shader Programs
+    if(!InitStressProgram(&program_textures, VERTEX_TEXTURES_SHADER_NAME, FRAGMENT_TEXTURES_SHADER_NAME))
+        return false;
+    if(!InitStressProgram(&program_colors, VERTEX_COLORS_SHADER_NAME, FRAGMENT_COLORS_SHADER_NAME))
+        return false;
+
+// Free Shader Compiler Resources
+    glReleaseShaderCompiler();
+
+// Initialize Meshes, shared by all the nodes of the scene
+    InitMesh      (&mesh_textures_a, 3, 12, cube_vertex_buffer_data, sizeof(cube_vertex_buffer_data)                             ,
+                                            cube_uv_buffer_data    , sizeof(cube_uv_buffer_data)                                 ,
+                                            NULL                   , 0                                                           ,
+                                            cube_index_buffer_data , cube_index_buffer_data ? sizeof(cube_index_buffer_data) : 0 ,
+                                            diffuse_textures_a, 2);
+    InitMesh      (&mesh_textures_b, 3, 12, cube_vertex_buffer_data, sizeof(cube_vertex_buffer_data)                             ,
+                                            cube_uv_buffer_data    , sizeof(cube_uv_buffer_data)                                 ,
+                                            NULL                   , 0                                                           ,
+                                            cube_index_buffer_data , cube_index_buffer_data ? sizeof(cube_index_buffer_data) : 0 ,
+                                            diffuse_textures_b, 2);
+    InitMesh      (&mesh_colors    , 3, 12, cube_vertex_buffer_data, sizeof(cube_vertex_buffer_data)                             ,
+                                            NULL                   , 0                                                           ,
+                                            cube_color_buffer_data , sizeof(cube_color_buffer_data)                              ,
+                                            cube_index_buffer_data , cube_index_buffer_data ? sizeof(cube_index_buffer_data) : 0 ,
+                                            NULL, 0);
+
+// Initialize Scene
+    const char *nodes_env = getenv(STRESS_NODES_ENV);
+    int         nodes_num = nodes_env && atoi(nodes_env) > 0 ? atoi(nodes_env) : STRESS_NODES_NUM;
+    if(!InitStressScene(nodes_num))
+        return false;
+
+// Initialize Camera, far enough for the whole grid to be seen
+    InitCamera    (&camera);
+    camera.mFar    = 200.0f;
+    camera.mEye[1] = STRESS_GRID_SIZE * 0.6f;
+    camera.mEye[2] = STRESS_GRID_SIZE * 0.9f;
+    mat4x4_look_at(camera.mViewMatrix, camera.mEye, camera.mOrigin, camera.mUp);
+
+// Basic Rendering Setup, (a) Init Depth & (b) Init Background Color
+    InitRendering (&rendering, COLOR_BLACK);
+
+// Culling Setup
+    glEnable      (GL_CULL_FACE);
+    glCullFace    (GL_BACK);
+    glFrontFace   (GL_CW);
+
+// Depth Testing Setup
+    glEnable      (GL_DEPTH_TEST);
+    glDepthFunc   (GL_LEQUAL);
+    glClearDepthf (rendering.mDepth);
+
+// Set Clear Color
+    glClearColor  (rendering.mBackgroundColor[0], rendering.mBackgroundColor[1], rendering.mBackgroundColor[2], rendering.mBackgroundColor[3]);
+
+#ifdef INFO_DISPLAY
+    printf("[Scene      Mode] [%d NODES] [Total Time] [%d sec]\n", scene.mNodesNum, KILL_APP_PERIOD);
+#endif
+
+// Check for opengGL-relate Errors
+    ASSERT_NO_GL_ERROR();
+
+    return true;
+}
+
+void DrawGL(void)
+{
+    CpuTimerBegin();
+
+// Set Viewport
+    glViewport(0, 0, viewport.mWidth, viewport.mHeight);
+
+// Clear Depth & Color of Screen Buffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+// Draw Scene, one draw per node
+    DrawScene(&scene, &camera);
+
+// Check for opengGL-relate Errors
+    ASSERT_NO_GL_ERROR();
+
+    CpuTimerEnd(win_name, scene.mDrawsNum);
+}
+
+void IdleGL(void)
+{
+    static double totalTimeScript   = 0.0;
+
+    double timePerFrame = GpuTimer(win_name);
+
+    totalTimeScript   += timePerFrame;
+    if(totalTimeScript>= (float)KILL_APP_PERIOD)
+        KeyboardGL(ESC_KEY);
+
+// Update Dynamic Values (Transformations & Uniforms)
+    UpdateScene(&scene, 0.025f);
+
+    eglutPostRedisplay();
+}
+
+void DestroyGL(void)
+{
+// Delete Scene
+    DeleteScene   (&scene);
+// Delete Programs
+    DeleteProgram (program_textures.mID);
+    DeleteProgram (program_colors.mID);
+// Delete Meshes
+    DeleteMesh    (&mesh_textures_a);
+    DeleteMesh    (&mesh_textures_b);
+    DeleteMesh    (&mesh_colors);
+}
+
+void ReshapeGL(int width, int height)
+{
+// Set viewport
+    SetViewport(&viewport, 0, 0, width, height);
+
+// Update the projection matrix since aspect ratio has been modified
+    mat4x4_perspective(camera.mProjectionMatrix, camera.mFov, viewport.mAspectRatio, camera.mNear, camera.mFar);
+}
+
+void KeyboardGL(unsigned char key)
+{
+   if (key == ESC_KEY) // escape key
+   {
+// Close app
+     DestroyGL();
+     if (_eglut->current)
+        eglutDestroyWindow(_eglut->current->index);
+     _eglutFini();
+
+      exit(0);
+   }
+}
+#ifdef VK_USE_PLATFORM_MACOS_MVK
+int macos_main(int argc, char **argv)
+#else
+int main(int argc, char **argv)
+#endif
+{
+    win_name = EXECUTABLE_NAME(argv[0]);
+
+    eglutInitWindowSize (WIDTH, HEIGHT);
+    eglutInitAPIMask    (EGLUT_OPENGL_ES2_BIT);
+    eglutInit           (argc, (const char **)argv);
+
+    int win = eglutCreateWindow(win_name);
+
+    eglutIdleFunc       (IdleGL);
+    eglutDisplayFunc    (DrawGL);
+    eglutReshapeFunc    (ReshapeGL);
+    eglutKeyboardFunc   (KeyboardGL);
+
+    if(!InitGL()) {
+        return 1;
+    }
+
+    if(SmokeTestsRunning()) {
+        ReshapeGL(WIDTH, HEIGHT);
+        char *fileName = EXECUTABLE_NAME(argv[0]);
+        TakeScreenshot(fileName, DrawGL, WIDTH, HEIGHT);
+        DestroyGL();
+        eglutDestroyWindow(win);
+        _eglutFini();
+
+    } else {
+        eglutMainLoop();
+#ifndef VK_USE_PLATFORM_MACOS_MVK
+        DestroyGL();
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __SCENE3D_STRESS_H_
+#define __SCENE3D_STRESS_H_
+
+#include "../engine/glcore/common.h"
+#include "../assets/geometry/cube.h"
+
+#define VERTEX_TEXTURES_SHADER_NAME        SOURCES_PATH SHADERS_PATH "geometry3d_textures.vert"
+#define FRAGMENT_TEXTURES_SHADER_NAME      SOURCES_PATH SHADERS_PATH "geometry3d_textures.frag"
+#define VERTEX_COLORS_SHADER_NAME          SOURCES_PATH SHADERS_PATH "geometry3d_vertexcolors.vert"
+#define FRAGMENT_COLORS_SHADER_NAME        SOURCES_PATH SHADERS_PATH "geometry3d_vertexcolors.frag"
+
+/// Nodes of the scene, unless the environment variable below gives their number
+#define STRESS_NODES_NUM            4096
+#define STRESS_NODES_ENV            "GLOVE_DEMOS_STRESS_NODES"
+
+/// Extent of the grid the nodes are laid out on
+#define STRESS_GRID_SIZE            48.0f
+
+#ifdef VK_USE_PLATFORM_MACOS_MVK
+static const char* diffuse_textures_a [] = { "assets/textures/tsi_256x256.tga", "assets/textures/vulkan_512x512.tga"};
+static const char* diffuse_textures_b [] = { "assets/textures/vulkan_512x512.tga", "assets/textures/tsi_256x256.tga"};
+#else
+static const char* diffuse_textures_a [] = { "../assets/textures/tsi_256x256.tga", "../assets/textures/vulkan_512x512.tga"};
+static const char* diffuse_textures_b [] = { "../assets/textures/vulkan_512x512.tga", "../assets/textures/tsi_256x256.tga"};
+#endif
+
+#endif // __SCENE3D_STRESS_H_
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "texture2d_shared_context.h"
+
+static  openGL_mesh_t      mesh_screen_quad;
+static  openGL_program_t   program;
+static  openGL_camera_t    camera;
+static  openGL_viewport_t  viewport;
+static  openGL_rendering_t rendering;
+static  openGL_shading_t   shading;
+static  const char        *win_name;
+
+// A second context of the share group, that only uploads the texture the window samples
+static  EGLContext         loader_context = EGL_NO_CONTEXT;
+static  unsigned char      texels[SHARED_TEXTURE_SIZE * SHARED_TEXTURE_SIZE * 4];
+
+static void FillCheckerboard(unsigned int frame)
+{
+    for(int y = 0; y < SHARED_TEXTURE_SIZE; ++y) {
+        for(int x = 0; x < SHARED_TEXTURE_SIZE; ++x) {
+            unsigned char *texel = &texels[(y * SHARED_TEXTURE_SIZE + x) * 4];
+            int            odd   = ((x / SHARED_TEXTURE_TILE) + (y / SHARED_TEXTURE_TILE) + frame) & 1;
+            texel[0] = odd ? 255 : 0;
+            texel[1] = odd ? (unsigned char)(frame * 4) : 0;
+            texel[2] = odd ? 0 : 255;
+            texel[3] = 255;
+        }
+    }
+}
+
+// The upload is left to the switch back to the window context: no glFlush, no glFinish
+static void UploadTexture(Texture *tex, unsigned int frame, bool allocate)
+{
+    eglMakeCurrent(_eglut->dpy, _eglut->current->surface, _eglut->current->surface, loader_context);
+
+    FillCheckerboard(frame);
+    glBindTexture(GL_TEXTURE_2D, tex->texID);
+    if(allocate) {
+        glTexImage2D   (GL_TEXTURE_2D, 0, GL_RGBA, tex->width, tex->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex->width, tex->height, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    }
+
+    eglMakeCurrent(_eglut->dpy, _eglut->current->surface, _eglut->current->surface, _eglut->current->context);
+}
+
+bool InitGL()
+{
+// Print GPU specifications
+    GpuViewer();
+
+#ifdef BINARY_PROG
+// Load Precompilde binary program
+    if(!LoadProgramBinary(BINARY_PROGRAM_SHADER_NAME, 1, &program.mID))
+        return false;
+#else
+// Load Vertex Shader
+    if(!LoadShader(VERTEX_SHADER_NAME   , &program.mVertexShader  , GL_VERTEX_SHADER))
+        return false;
+// Load Fragment Shader
+    if(!LoadShader(FRAGMENT_SHADER_NAME , &program.mFragmentShader, GL_FRAGMENT_SHADER))
+        return false;
+// Load Program Shader
+    if(!LoadProgram(program.mVertexShader, program.mFragmentShader, &program.mID))
+        return false;
+#endif
+
+// Free Shader Compiler Resources
+    glReleaseShaderCompiler();
+
+// Initialize Program
+    InitProgram(&program);
+
+// Initialize Mesh, its texture comes from the loader context
+    InitMesh      (&mesh_screen_quad, 2, 2, squad_vertex_buffer_data, sizeof(squad_vertex_buffer_data)                              ,
+                                            squad_uv_buffer_data    , sizeof(squad_uv_buffer_data)                                  ,
+                                            squad_color_buffer_data , squad_color_buffer_data ? sizeof(squad_color_buffer_data) : 0 ,
+                                            squad_index_buffer_data , squad_index_buffer_data ? sizeof(squad_index_buffer_data) : 0 ,
+                                            NULL, 0);
+
+// Create the Loader Context, sharing the objects of the window one
+    const EGLint context_attribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    loader_context = eglCreateContext(_eglut->dpy, _eglut->current->config, _eglut->current->context, context_attribs);
+    if(loader_context == EGL_NO_CONTEXT)
+        return false;
+
+// Upload the Shared Texture from the Loader Context
+    Texture *tex = (Texture *)malloc(sizeof(Texture));
+    tex->width  = SHARED_TEXTURE_SIZE;
+    tex->height = SHARED_TEXTURE_SIZE;
+    tex->type   = GL_RGBA;
+    tex->levels = 1;
+    glGenTextures(1, &tex->texID);
+    UploadTexture(tex, 0, true);
+    mesh_screen_quad.mTexturesNum = 1;
+    mesh_screen_quad.mTexture[0]  = tex;
+
+// Initialize Camera
+    InitCamera    (&camera);
+
+// Basic Rendering Setup, (a) Init Depth & (b) Init Background Color
+    InitRendering (&rendering, COLOR_BLACK);
+
+// Basic Shading Setup, (a) Init Shading Count & (b) Init uniform value
+    InitShading   (&shading  , 1, 0.5f);
+
+// Culling Setup
+    glEnable      (GL_CULL_FACE);
+    glCullFace    (GL_BACK);
+    glFrontFace   (GL_CW);
+
+// Depth Testing Setup
+    glEnable      (GL_DEPTH_TEST);
+    glDepthFunc   (GL_LEQUAL);
+    glClearDepthf (rendering.mDepth);
+
+// Set Clear Color
+    glClearColor  (rendering.mBackgroundColor[0], rendering.mBackgroundColor[1], rendering.mBackgroundColor[2], rendering.mBackgroundColor[3]);
+
+// Upload shader uniforms
+    glUseProgram(program.mID);
+    program.mLocationPos = glGetAttribLocation (program.mID, "v_posCoord_in");
+    program.mLocationUV  = glGetAttribLocation (program.mID, "v_texCoord_in");
+    glUniform1i(glGetUniformLocation(program.mID, "uniform_texture"), 0);
+
+#ifdef INFO_DISPLAY
+    printf("[Shading    Mode] [%s] [Total Time] [%d sec]\n", shading_titles[shading.mType], KILL_APP_PERIOD);
+#endif
+// Check for opengGL-relate Errors
+    ASSERT_NO_GL_ERROR();
+
+    return true;
+}
+
+void DrawGL(void)
+{
+  // Set Viewport
+    glViewport(0, 0, viewport.mWidth, viewport.mHeight);
+
+// Clear Depth & Color of Screen Buffer
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+// Draw Scene, sampling what the loader context has uploaded last
+    DrawMesh(&program, &mesh_screen_quad);
+
+// Check for opengGL-relate Errors
+    ASSERT_NO_GL_ERROR();
+}
+
+void IdleGL(void)
+{
+    static unsigned int frame           = 0;
+    static double       totalTimeScript = 0.0;
+
+    double timePerFrame = GpuTimer(win_name);
+
+    totalTimeScript   += timePerFrame;
+    if(totalTimeScript >= (float)KILL_APP_PERIOD)
+        KeyboardGL(ESC_KEY);
+
+// Update the Shared Texture from the Loader Context, every frame
+    UploadTexture(mesh_screen_quad.mTexture[0], ++frame, false);
+
+// Redraw
+    eglutPostRedisplay();
+}
+
+void DestroyGL(void)
+{
+// Delete Program
+    DeleteProgram (program.mID);
+// Delete Mesh, along with the shared texture
+    DeleteMesh    (&mesh_screen_quad);
+// Delete the Loader Context
+    if(loader_context != EGL_NO_CONTEXT) {
+        eglDestroyContext(_eglut->dpy, loader_context);
+        loader_context = EGL_NO_CONTEXT;
+    }
+}
+
+void ReshapeGL(int width, int height)
+{
+// Set viewport
+    SetViewport(&viewport, 0, 0, width, height);
+
+// Check for opengGL-relate Errors
+    ASSERT_NO_GL_ERROR();
+}
+
+void KeyboardGL(unsigned char key)
+{
+   if      (key == ESC_KEY) // escape key
+   {
+// Close app
+     DestroyGL();
+     if (_eglut->current)
+        eglutDestroyWindow(_eglut->current->index);
+     _eglutFini();
+
+      exit(0);
+   }
+}
+
+#ifdef VK_USE_PLATFORM_MACOS_MVK
+int macos_main(int argc, char **argv)
+#else
+int main(int argc, char **argv)
+#endif
+{
+    win_name = EXECUTABLE_NAME(argv[0]);
+
+    eglutInitWindowSize (WIDTH, HEIGHT);
+    eglutInitAPIMask    (EGLUT_OPENGL_ES2_BIT);
+    eglutInit           (argc, (const char **)argv);
+
+    int win = eglutCreateWindow(win_name);
+
+    eglutIdleFunc       (IdleGL);
+    eglutDisplayFunc    (DrawGL);
+    eglutReshapeFunc    (ReshapeGL);
+    eglutKeyboardFunc   (KeyboardGL);
+
+    if(!InitGL()) {
+        return 1;
+    }
+
+    if(SmokeTestsRunning()) {
+        ReshapeGL(WIDTH, HEIGHT);
+        char *fileName = EXECUTABLE_NAME(argv[0]);
+        TakeScreenshot(fileName, DrawGL, WIDTH, HEIGHT);
+        DestroyGL();
+        eglutDestroyWindow(win);
+        _eglutFini();
+
+    } else {
+        eglutMainLoop();
+#ifndef VK_USE_PLATFORM_MACOS_MVK
+        DestroyGL();
+#endif
+    }
+
+    return 0;
+}
@@ -28,6 +28,9 @@
 
 #include "eglutint.h"
 
+/* Environment variable naming a file that the startup phases are written to, one "<phase> <start ms> <duration ms>" per line */
+#define STARTUP_LOG_ENV "GLOVE_DEMOS_STARTUP_LOG"
+
 static struct eglut_state _eglut_state = {
    .api_mask = EGLUT_OPENGL_ES2_BIT,
    .window_width = 600,
@@ -73,6 +76,34 @@ _eglutNow(void)
 #endif
 }
 
+static double
+_eglutPreciseNow(void)
+{
+#ifdef WIN32
+   LARGE_INTEGER frequency, counter;
+   QueryPerformanceFrequency(&frequency);
+   QueryPerformanceCounter(&counter);
+   return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+   struct timeval tv;
+   (void) gettimeofday(&tv, NULL);
+   return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+double
+eglutStartupTime(void)
+{
+   return _eglutPreciseNow() - _eglut->startup_origin;
+}
+
+void
+eglutStartupPhase(const char *phase, double start)
+{
+   if (_eglut->startup_log)
+      fprintf(_eglut->startup_log, "%s %.3f %.3f\n", phase, start, eglutStartupTime() - start);
+}
+
 static void
 _eglutDestroyWindow(struct eglut_window *win)
 {
@@ -131,6 +162,7 @@ _eglutCreateWindow(const char *title, int x, int y, int w, int h)
    struct eglut_window *win;
    EGLint context_attribs[4];
    EGLint api, i;
+   double start;
 
    win = calloc(1, sizeof(*win));
    if (!win)
@@ -158,16 +190,21 @@ _eglutCreateWindow(const char *title, int x, int y, int w, int h)
    context_attribs[i] = EGL_NONE;
 
    eglBindAPI(api);
+   start = eglutStartupTime();
    win->context = eglCreateContext(_eglut->dpy,
          win->config, EGL_NO_CONTEXT, context_attribs);
    if (!win->context)
       _eglutFatal("failed to create context");
+   eglutStartupPhase("create_context", start);
 
    switch (_eglut->surface_type) {
    case EGL_WINDOW_BIT:
       _eglutNativeInitWindow(win, title, x, y, w, h);
+      /* the swapchain is set up along with the surface */
+      start = eglutStartupTime();
       win->surface = eglCreateWindowSurface(_eglut->dpy,
             win->config, win->native.u.window, NULL);
+      eglutStartupPhase("create_surface", start);
       break;
    case EGL_PIXMAP_BIT:
       win->surface = eglCreatePixmapSurface(_eglut->dpy,
@@ -178,7 +215,9 @@ _eglutCreateWindow(const char *title, int x, int y, int w, int h)
       EGLint attr[] = {EGL_WIDTH, w,
                        EGL_HEIGHT, h,
                        EGL_NONE};
+      start = eglutStartupTime();
       win->surface = eglCreatePbufferSurface(_eglut->dpy, win->config, attr);
+      eglutStartupPhase("create_surface", start);
       } break;
    default:
       break;
@@ -205,8 +244,15 @@ eglutInitWindowSize(int width, int height)
 void
 eglutInit(int argc, const char **argv)
 {
+   const char *startup_log;
+   double start;
    int i;
 
+   _eglut->startup_origin = _eglutPreciseNow();
+   startup_log = getenv(STARTUP_LOG_ENV);
+   if (startup_log && startup_log[0] != '\0')
+      _eglut->startup_log = fopen(startup_log, "w");
+
    for (i = 1; i < argc; i++) {
       if (strcmp(argv[i], "-display") == 0)
          _eglut->display_name = argv[++i];
@@ -218,8 +264,10 @@ eglutInit(int argc, const char **argv)
    _eglutNativeInitDisplay();
    _eglut->dpy = eglGetDisplay(_eglut->native_dpy);
 
+   start = eglutStartupTime();
    if (!eglInitialize(_eglut->dpy, &_eglut->major, &_eglut->minor))
       _eglutFatal("failed to initialize EGL display");
+   eglutStartupPhase("egl_initialize", start);
 
    _eglut->init_time = _eglutNow();
 }
@@ -267,6 +315,28 @@ eglutMainLoop(void)
    _eglutNativeEventLoop();
 }
 
+void
+_eglutSwapBuffers(struct eglut_window *win)
+{
+   double start;
+
+   if (!_eglut->startup_log) {
+      eglSwapBuffers(_eglut->dpy, win->surface);
+      return;
+   }
+
+   /* startup ends with the first frame presented, which is all the run is for */
+   start = eglutStartupTime();
+   eglSwapBuffers(_eglut->dpy, win->surface);
+   eglutStartupPhase("first_swap", start);
+   fclose(_eglut->startup_log);
+   _eglut->startup_log = NULL;
+
+   eglutDestroyWindow(win->index);
+   _eglutFini();
+   exit(0);
+}
+
 void
 _eglutFini(void)
 {
@@ -304,6 +374,7 @@ int
 eglutCreateWindow(const char *title)
 {
    struct eglut_window *win;
+   double start;
 
    win = _eglutCreateWindow(title, 0, 0,
          _eglut->window_width, _eglut->window_height);
@@ -314,8 +385,10 @@ eglutCreateWindow(const char *title)
    win->keyboard_cb = _eglutDefaultKeyboard;
    win->special_cb = NULL;
 
+   start = eglutStartupTime();
    if (!eglMakeCurrent(_eglut->dpy, win->surface, win->surface, win->context))
       _eglutFatal("failed to make window current");
+   eglutStartupPhase("make_current", start);
    _eglut->current = win;
 
    return win->index;
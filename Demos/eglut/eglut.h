@@ -76,6 +76,11 @@ void eglutInit(int argc, const char **argv);
 
 int  eglutGet(int state);
 
+/* ms since eglutInit, and the phase of startup that began at the given time and ends now,
+   written to the file named by GLOVE_DEMOS_STARTUP_LOG; the demo exits after its first frame when set */
+double eglutStartupTime(void);
+void   eglutStartupPhase(const char *phase, double start);
+
 void eglutIdleFunc(EGLUTidleCB func);
 void eglutPostRedisplay(void);
 
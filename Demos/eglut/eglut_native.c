@@ -84,7 +84,7 @@ _eglutNativeEventLoop(void)
 
           if(win->display_cb)
             win->display_cb();
-         eglSwapBuffers(_eglut->dpy, win->surface);
+         _eglutSwapBuffers(win);
       }
    }
 }
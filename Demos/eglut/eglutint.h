@@ -85,6 +85,10 @@ struct eglut_state {
    struct eglut_window *current;
 
    int redisplay;
+
+   /* startup phases are logged from the start of eglutInit, until the first frame is presented */
+   FILE *startup_log;
+   double startup_origin;
 };
 
 extern struct eglut_state *_eglut;
@@ -95,6 +99,9 @@ _eglutFatal(char *format, ...);
 int
 _eglutNow(void);
 
+void
+_eglutSwapBuffers(struct eglut_window *win);
+
 void
 _eglutFini(void);
 
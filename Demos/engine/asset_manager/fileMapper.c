@@ -0,0 +1,111 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "fileMapper.h"
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef VK_USE_PLATFORM_MACOS_MVK
+extern FILE *macos_fopen(const char *filename, const char *mode);
+#define fopen macos_fopen
+#endif
+
+static bool
+ReadFile(FILE *fd, MappedFile *file)
+{
+    fseek(fd, 0, SEEK_END);
+    long size = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    if(size <= 0) {
+        return false;
+    }
+
+    unsigned char *data = (unsigned char *)malloc(size);
+    if(data == NULL) {
+        return false;
+    }
+
+    if(fread(data, 1, size, fd) != (size_t)size) {
+        free(data);
+        return false;
+    }
+
+    file->data   = data;
+    file->size   = (size_t)size;
+    file->mapped = false;
+
+    return true;
+}
+
+// The assets are mapped rather than read, so that loading them costs no copy
+// through stdio and the pages not touched by the upload are never read in
+bool
+MapFile(const char *filename, MappedFile *file)
+{
+    file->data   = NULL;
+    file->size   = 0;
+    file->mapped = false;
+
+    FILE *fd = fopen(filename, "rb");
+    if(fd == NULL) {
+#ifdef DEBUG_ASSET_MANAGEMENT
+        fprintf(stderr, "[fileMapper.c] [MapFile()]: Error opening file %s\n", filename);
+#endif
+        return false;
+    }
+
+#ifndef WIN32
+    struct stat st;
+    if(fstat(fileno(fd), &st) == 0 && st.st_size > 0) {
+        // the mapping outlives the file being closed
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fd), 0);
+        if(data != MAP_FAILED) {
+            file->data   = (const unsigned char *)data;
+            file->size   = (size_t)st.st_size;
+            file->mapped = true;
+            fclose(fd);
+            return true;
+        }
+    }
+#endif
+
+    bool read = ReadFile(fd, file);
+    fclose(fd);
+
+    return read;
+}
+
+void
+UnmapFile(MappedFile *file)
+{
+    if(file->data == NULL) {
+        return;
+    }
+
+#ifndef WIN32
+    if(file->mapped) {
+        munmap((void *)file->data, file->size);
+    } else {
+        free((void *)file->data);
+    }
+#else
+    free((void *)file->data);
+#endif
+
+    file->data   = NULL;
+    file->size   = 0;
+    file->mapped = false;
+}
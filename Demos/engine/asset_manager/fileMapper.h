@@ -0,0 +1,29 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __FILEMAPPER_H_
+#define __FILEMAPPER_H_
+
+#include "../utilities/debug.h"
+
+typedef struct
+{
+    const unsigned char *data;                      // Contents Of The File
+    size_t               size;                      // Size Of The File In Bytes
+    bool                 mapped;                    // Mapped, Or Read Into A Buffer Where Mapping Is Not Available
+} MappedFile;
+
+bool  MapFile           (const char *filename, MappedFile *file);
+void  UnmapFile         (MappedFile *file);
+
+#endif // __FILEMAPPER_H_
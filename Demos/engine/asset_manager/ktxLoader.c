@@ -0,0 +1,93 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "ktxLoader.h"
+
+static const unsigned char KTXidentifier[KTX_IDENTIFIER_SIZE] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+bool IsKTX(const MappedFile *file)
+{
+    return file->size >= sizeof(KTXHeader) && memcmp(file->data, KTXidentifier, KTX_IDENTIFIER_SIZE) == 0;
+}
+
+// Uploads the levels of a KTX container to the texture bound to GL_TEXTURE_2D as they are stored,
+// with glCompressedTexImage2D for compressed formats, so loading them costs no decoding
+int LoadKTX(Texture *texture, const MappedFile *file)
+{
+    KTXHeader header;
+    if(!IsKTX(file))
+        return 0;
+    memcpy(&header, file->data, sizeof(KTXHeader));
+
+    // only 2D textures written in the byte order of this machine, meant to be loaded as they are
+    if(header.endianness != KTX_ENDIANNESS || header.pixelWidth == 0 || header.pixelHeight == 0 ||
+       header.pixelDepth != 0 || header.numberOfFaces != 1 || header.numberOfArrayElements != 0) {
+#ifdef DEBUG_ASSET_MANAGEMENT
+        fprintf(stderr, "[ktxLoader.c] [LoadKTX()]: Unsupported KTX texture\n");
+#endif
+        return 0;
+    }
+
+    bool     compressed = header.glType == 0;
+    bool     generate   = header.numberOfMipmapLevels == 0;
+    uint32_t levels     = generate ? 1 : header.numberOfMipmapLevels;
+    uint32_t width      = header.pixelWidth;
+    uint32_t height     = header.pixelHeight;
+    size_t   offset     = sizeof(KTXHeader) + header.bytesOfKeyValueData;
+
+    // mipmaps of compressed formats cannot be generated
+    if(compressed && generate)
+        return 0;
+
+    texture->width     = header.pixelWidth;
+    texture->height    = header.pixelHeight;
+    texture->type      = header.glBaseInternalFormat;
+    texture->bpp       = compressed ? 0 : header.glTypeSize * 8;
+    texture->levels    = levels;
+    texture->imageData = NULL;
+
+    for(uint32_t level = 0; level < levels; ++level) {
+        uint32_t imageSize;
+        if(offset + sizeof(uint32_t) > file->size)
+            return 0;
+        memcpy(&imageSize, file->data + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if(offset + imageSize > file->size)
+            return 0;
+
+        if(compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat, width, height, 0, imageSize, file->data + offset);
+        } else {
+            // the rows are 4 byte aligned, as GL_UNPACK_ALIGNMENT expects by default
+            glTexImage2D(GL_TEXTURE_2D, level, header.glBaseInternalFormat, width, height, 0, header.glFormat, header.glType, file->data + offset);
+        }
+        if(glGetError() != GL_NO_ERROR) {
+#ifdef DEBUG_ASSET_MANAGEMENT
+            fprintf(stderr, "[ktxLoader.c] [LoadKTX()]: Error uploading level %u of format 0x%x\n", level, header.glInternalFormat);
+#endif
+            return 0;
+        }
+
+        offset += (imageSize + 3) & ~3u;
+        width   = width  > 1 ? width  >> 1 : 1;
+        height  = height > 1 ? height >> 1 : 1;
+    }
+
+    if(generate) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        for(width = header.pixelWidth, height = header.pixelHeight; width > 1 || height > 1; width >>= 1, height >>= 1)
+            ++texture->levels;
+    }
+
+    return 1;
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __KTXLOADER_H__
+#define __KTXLOADER_H__
+
+#include <stdint.h>
+#include "fileMapper.h"
+#include "tgaLoader.h"
+
+#define KTX_IDENTIFIER_SIZE     12
+#define KTX_ENDIANNESS          0x04030201
+
+typedef struct
+{
+    unsigned char   identifier[KTX_IDENTIFIER_SIZE];    // "\xABKTX 11\xBB\r\n\x1A\n"
+    uint32_t        endianness;                         // KTX_ENDIANNESS In The Byte Order Of The Writer
+    uint32_t        glType;                             // 0 For Compressed Formats
+    uint32_t        glTypeSize;
+    uint32_t        glFormat;                           // 0 For Compressed Formats
+    uint32_t        glInternalFormat;
+    uint32_t        glBaseInternalFormat;
+    uint32_t        pixelWidth;
+    uint32_t        pixelHeight;
+    uint32_t        pixelDepth;
+    uint32_t        numberOfArrayElements;
+    uint32_t        numberOfFaces;
+    uint32_t        numberOfMipmapLevels;               // 0 To Have The Mipmaps Generated
+    uint32_t        bytesOfKeyValueData;
+} KTXHeader;
+
+bool IsKTX               (const MappedFile *file);
+int  LoadKTX             (Texture *texture, const MappedFile *file);
+
+#endif //__KTXLOADER_H__
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include "shaderManager.h"
+#include "../../eglut/eglut.h"
 
 #ifdef VK_USE_PLATFORM_MACOS_MVK
 extern FILE *macos_fopen(const char *filename, const char *mode);
@@ -74,8 +75,12 @@ LoadShader(const char *filename, GLuint *shader, GLenum shaderType)
 
   glShaderSource(*shader, 1, (const char **) &source, NULL);
   ASSERT_NO_GL_ERROR();
+  // the compile may complete in the background, until its status is queried
+  double start = eglutStartupTime();
   glCompileShader(*shader);
   ASSERT_NO_GL_ERROR();
+  glGetShaderiv(*shader, GL_COMPILE_STATUS, &status);
+  eglutStartupPhase("compile_shader", start);
 
   glGetShaderiv(*shader, GL_SHADER_SOURCE_LENGTH, &length);
   ASSERT_NO_GL_ERROR();
@@ -118,10 +123,12 @@ LoadProgram(const GLuint vs, const GLuint fs, GLuint *prog)
     glAttachShader(*prog, fs);
     ASSERT_NO_GL_ERROR();
     assert(glIsProgram(*prog));
+    double start = eglutStartupTime();
     glLinkProgram(*prog);
 
     glGetProgramiv(*prog, GL_LINK_STATUS, &status);
     ASSERT_NO_GL_ERROR();
+    eglutStartupPhase("link_program", start);
     if(status == GL_FALSE) {
         glGetProgramiv(*prog, GL_INFO_LOG_LENGTH, &length);
         char *info = (char *)malloc(length * sizeof(char));
@@ -12,92 +12,65 @@
  */
 
 #include "tgaLoader.h"
+#include "ktxLoader.h"
 
-#ifdef VK_USE_PLATFORM_MACOS_MVK
-extern FILE *macos_fopen(const char *filename, const char *mode);
-#define fopen macos_fopen
-#endif
+#define TGA_HEADER_SIZE     (sizeof(TGAHeader) + sizeof(tga.header))
 
-int LoadTGA(Texture * texture, const char *filename)
+int LoadTGA(Texture * texture, const MappedFile *file)
 {
-    FILE * fTGA;												// File pointer to texture file
-    fTGA = fopen(filename, "rb");				// Open file for reading
-
-    if(fTGA == NULL)
-        return 0;													// Exit function
-
-    if(fread(&tgaheader, sizeof(TGAHeader), 1, fTGA) == 0)					// Attempt to read 12 byte header from file
-    {
-        if(fTGA != NULL)
-            fclose(fTGA);
+    if(file->size < TGA_HEADER_SIZE)
         return 0;
-    }
 
-    if(memcmp(uTGAcompare, &tgaheader, sizeof(tgaheader)) == 0)			// See if header matches the predefined header of an Uncompressed TGA image
-    {
-        LoadUncompressedTGA(texture, filename, fTGA);									// If so, jump to Uncompressed TGA loading code
-    }
-    else if(memcmp(cTGAcompare, &tgaheader, sizeof(tgaheader)) == 0)// See if header matches the predefined header of an RLE compressed TGA image
-    {
-        LoadCompressedTGA(texture, filename, fTGA);										// If so, jump to Compressed TGA loading code
-    }
-    else																														// If header matches neither type
-    {
-        fclose(fTGA);
-        return 0;																											// Exit function
-    }
+    memcpy(&tgaheader, file->data, sizeof(TGAHeader));                  // Read the 12 byte header from the file
+
+    if(memcmp(uTGAcompare, &tgaheader, sizeof(tgaheader)) == 0)         // See if header matches the predefined header of an Uncompressed TGA image
+        return LoadUncompressedTGA(texture, file);                      // If so, jump to Uncompressed TGA loading code
+    else if(memcmp(cTGAcompare, &tgaheader, sizeof(tgaheader)) == 0)    // See if header matches the predefined header of an RLE compressed TGA image
+        return LoadCompressedTGA(texture, file);                        // If so, jump to Compressed TGA loading code
 
-    return 1;																												// All went well, continue on
+    return 0;                                                           // If header matches neither type
 }
 
-int LoadUncompressedTGA(Texture * texture, const char *filename, FILE *fTGA)	// Load an uncompressed TGA
+static int ReadTGAInfo(Texture * texture, const MappedFile *file)
 {
-    if(fread(tga.header, sizeof(tga.header), 1, fTGA) == 0)					// Read TGA header
-    {
-        if(fTGA != NULL)
-            fclose(fTGA);
-        return 0;
-    }
+    memcpy(tga.header, file->data + sizeof(TGAHeader), sizeof(tga.header));    // Read TGA header
 
-    texture->width  = tga.header[1] * 256 + tga.header[0];	// Determine The TGA Width	(highbyte*256+lowbyte)
-    texture->height = tga.header[3] * 256 + tga.header[2];	// Determine The TGA Height	(highbyte*256+lowbyte)
-    texture->bpp		= tga.header[4];												// Determine the bits per pixel
-    tga.Width				= texture->width;												// Copy width into local structure
-    tga.Height			= texture->height;											// Copy height into local structure
-    tga.Bpp					= texture->bpp;													// Copy BPP into local structure
+    texture->width  = tga.header[1] * 256 + tga.header[0];             // Determine The TGA Width	(highbyte*256+lowbyte)
+    texture->height = tga.header[3] * 256 + tga.header[2];             // Determine The TGA Height	(highbyte*256+lowbyte)
+    texture->bpp    = tga.header[4];                                    // Determine the bits per pixel
+    texture->levels = 1;
+    tga.Width       = texture->width;                                   // Copy width into local structure
+    tga.Height      = texture->height;                                  // Copy height into local structure
+    tga.Bpp         = texture->bpp;                                     // Copy BPP into local structure
 
     if((texture->width <= 0) || (texture->height <= 0) || ((texture->bpp != 24) && (texture->bpp !=32)))	// Make sure all information is valid
-    {
-        if(fTGA != NULL)
-            fclose(fTGA);
         return 0;
-    }
 
-    if(texture->bpp == 24)												// If the BPP of the image is 24...
-        texture->type	= GL_RGB;											// Set Image type to GL_RGB
-    else																					// Else if its 32 BPP
-        texture->type	= GL_RGBA;										// Set image type to GL_RGBA
+    if(texture->bpp == 24)                                              // If the BPP of the image is 24...
+        texture->type = GL_RGB;                                         // Set Image type to GL_RGB
+    else                                                                // Else if its 32 BPP
+        texture->type = GL_RGBA;                                        // Set image type to GL_RGBA
 
-    tga.bytesPerPixel	= (tga.Bpp / 8);															// Compute the number of BYTES per pixel
-    tga.imageSize		= (tga.bytesPerPixel * tga.Width * tga.Height);	// Compute the total amout ofmemory needed to store data
-    texture->imageData	= (GLubyte *)malloc(tga.imageSize);					// Allocate that much memory
+    tga.bytesPerPixel   = (tga.Bpp / 8);                                // Compute the number of BYTES per pixel
+    tga.imageSize       = (tga.bytesPerPixel * tga.Width * tga.Height); // Compute the total amout ofmemory needed to store data
+    texture->imageData  = (GLubyte *)malloc(tga.imageSize);             // Allocate that much memory
 
-    if(texture->imageData == NULL)								// If no space was allocated
-    {
-        fclose(fTGA);
+    return texture->imageData != NULL;
+}
+
+int LoadUncompressedTGA(Texture * texture, const MappedFile *file)     // Load an uncompressed TGA
+{
+    if(!ReadTGAInfo(texture, file))
         return 0;
-    }
 
-    if(fread(texture->imageData, 1, tga.imageSize, fTGA) != tga.imageSize)	// Attempt to read image data
+    if(file->size - TGA_HEADER_SIZE < tga.imageSize)                    // Make sure the image data is all there
     {
-        if(texture->imageData != NULL)							// If imagedata has data in it
-        {
-            free(texture->imageData);									// Delete data from memory
-        }
-        fclose(fTGA);																// Close file
+        free(texture->imageData);
         return 0;
     }
 
+    memcpy(texture->imageData, file->data + TGA_HEADER_SIZE, tga.imageSize);
+
     // Byte Swapping Optimized By Steve Thomas
     for(GLuint cswap = 0; cswap < tga.imageSize; cswap += tga.bytesPerPixel)
     {
@@ -106,187 +79,104 @@ int LoadUncompressedTGA(Texture * texture, const char *filename, FILE *fTGA)	//
         texture->imageData[cswap + 1] = tmp;
     }
 
-    fclose(fTGA);																// Close file
-    return 1;																		// Return success
+    return 1;                                                           // Return success
 }
 
-int LoadCompressedTGA(Texture * texture, const char *filename, FILE * fTGA)		// Load compressed TGAs
+int LoadCompressedTGA(Texture * texture, const MappedFile *file)       // Load compressed TGAs
 {
-    if(fread(tga.header, sizeof(tga.header), 1, fTGA) == 0)					// Attempt to read header
-    {
-        if(fTGA != NULL)
-            fclose(fTGA);
+    if(!ReadTGAInfo(texture, file))
         return 0;
-    }
 
-    texture->width  = tga.header[1] * 256 + tga.header[0];					// Determine The TGA Width	(highbyte*256+lowbyte)
-    texture->height = tga.header[3] * 256 + tga.header[2];					// Determine The TGA Height	(highbyte*256+lowbyte)
-    texture->bpp	= tga.header[4];																	// Determine Bits Per Pixel
-    tga.Width		= texture->width;																		// Copy width to local structure
-    tga.Height		= texture->height;																// Copy width to local structure
-    tga.Bpp			= texture->bpp;																			// Copy width to local structure
+    const GLubyte *src  = file->data + TGA_HEADER_SIZE;                 // Current byte being read
+    const GLubyte *end  = file->data + file->size;
+    GLuint pixelcount   = tga.Height * tga.Width;                       // Nuber of pixels in the image
+    GLuint currentpixel = 0;                                            // Current pixel being read
+    GLuint currentbyte  = 0;                                            // Current byte
 
-    if((texture->width <= 0) || (texture->height <= 0) || ((texture->bpp != 24) && (texture->bpp !=32)))	//Make sure all texture info is ok
+    do
     {
-        if(fTGA != NULL)
-            fclose(fTGA);
-        return 0;
-    }
+        if(src >= end)                                                  // Read in the 1 byte "chunk" header
+            break;
+        GLubyte chunkheader = *src++;
 
-    if(texture->bpp == 24)													// If the BPP of the image is 24...
-        texture->type	= GL_RGB;												// Set Image type to GL_RGB
-    else																						// Else if its 32 BPP
-        texture->type	= GL_RGBA;											// Set image type to GL_RGBA
+        // If the header is < 128, it means the that is the number of RAW color packets minus 1 that follow the header,
+        // otherwise the next color is repeated chunkheader - 127 times
+        bool   raw    = chunkheader < 128;
+        GLuint pixels = raw ? chunkheader + 1 : chunkheader - 127;
 
-    tga.bytesPerPixel	= (tga.Bpp / 8);							// Compute BYTES per pixel
-    tga.imageSize		= (tga.bytesPerPixel * tga.Width * tga.Height);	// Compute amout of memory needed to store image
-    texture->imageData	= (GLubyte *)malloc(tga.imageSize);					// Allocate that much memory
+        if(currentpixel + pixels > pixelcount ||                        // Make sure we dont write too many pixels
+           (size_t)(end - src) < (raw ? pixels : 1) * tga.bytesPerPixel)    // or read past the end of the file
+            break;
 
-    if(texture->imageData == NULL)									// If it wasnt allocated correctly..
-    {
-        fclose(fTGA);
-        return 0;
-    }
+        for(GLuint counter = 0; counter < pixels; counter++)
+        {
+            const GLubyte *colorbuffer = raw ? src + counter * tga.bytesPerPixel : src;
 
-    GLuint pixelcount	= tga.Height * tga.Width;			// Nuber of pixels in the image
-    GLuint currentpixel	= 0;												// Current pixel being read
-    GLuint currentbyte	= 0;												// Current byte
-    GLubyte * colorbuffer = (GLubyte *)malloc(tga.bytesPerPixel);			// Storage for 1 pixel
+            texture->imageData[currentbyte    ] = colorbuffer[2];       // Flip R and B vcolor values around in the process
+            texture->imageData[currentbyte + 1] = colorbuffer[1];
+            texture->imageData[currentbyte + 2] = colorbuffer[0];
 
-    do
-    {
-        GLubyte chunkheader = 0;											// Storage for "chunk" header
+            if(tga.bytesPerPixel == 4)                                  // if its a 32 bpp image
+                texture->imageData[currentbyte + 3] = colorbuffer[3];   // copy the 4th byte
 
-        if(fread(&chunkheader, sizeof(GLubyte), 1, fTGA) == 0)				// Read in the 1 byte header
-        {
-            if(fTGA != NULL)
-                fclose(fTGA);
-            if(texture->imageData != NULL)							// If there is stored image data
-                free(texture->imageData);									// Delete image data
-            return 0;
+            currentbyte += tga.bytesPerPixel;                           // Increase thecurrent byte by the number of bytes per pixel
         }
 
-        if(chunkheader < 128)												// If the ehader is < 128, it means the that is the number of RAW color packets minus 1 that follow the header
-        {
-            chunkheader++;														// add 1 to get number of following color values
-            for(short counter = 0; counter < chunkheader; counter++)		// Read RAW color values
-            {
-                if(fread(colorbuffer, 1, tga.bytesPerPixel, fTGA) != tga.bytesPerPixel) // Try to read 1 pixel
-                {
-                    if(fTGA != NULL)
-                        fclose(fTGA);
-
-                    if(colorbuffer != NULL)								// See if colorbuffer has data in it
-                        free(colorbuffer);									// If so, delete it
-
-                    if(texture->imageData != NULL)				// See if there is stored Image data
-                        free(texture->imageData);						// If so, delete it too
-
-                    return 0;
-                }
-                                                                                                                                                    // write to memory
-                texture->imageData[currentbyte			] = colorbuffer[2];                 // Flip R and B vcolor values around in the process
-                texture->imageData[currentbyte + 1	] = colorbuffer[1];
-                texture->imageData[currentbyte + 2	] = colorbuffer[0];
-
-                if(tga.bytesPerPixel == 4)							// if its a 32 bpp image
-                {
-                    texture->imageData[currentbyte + 3] = colorbuffer[3];				// copy the 4th byte
-                }
-
-                currentbyte += tga.bytesPerPixel;				// Increase thecurrent byte by the number of bytes per pixel
-                currentpixel++;													// Increase current pixel by 1
-
-                if(currentpixel > pixelcount)						// Make sure we havent read too many pixels
-                {
-                    if(fTGA != NULL)
-                        fclose(fTGA);
-
-                    if(colorbuffer != NULL)								// If there is data in colorbuffer
-                        free(colorbuffer);									// Delete it
-
-                    if(texture->imageData != NULL)				// If there is Image data
-                        free(texture->imageData);						// delete it
-
-                    return 0;
-                }
-            }
-        }
-        else																				// chunkheader > 128 RLE data, next color reapeated chunkheader - 127 times
-        {
-            chunkheader -= 127;												// Subteact 127 to get rid of the ID bit
-            if(fread(colorbuffer, 1, tga.bytesPerPixel, fTGA) != tga.bytesPerPixel)		// Attempt to read following color values
-            {
-                if(fTGA != NULL)
-                    fclose(fTGA);
-                if(colorbuffer != NULL)									// If there is data in the colorbuffer
-                    free(colorbuffer);										// delete it
-
-                if(texture->imageData != NULL)					// If thereis image data
-                    free(texture->imageData);							// delete it
-
-                return 0;
-            }
-
-            for(short counter = 0; counter < chunkheader; counter++)				// copy the color into the image data as many times as dictated by the header
-            {
-                texture->imageData[currentbyte		] = colorbuffer[2];					// switch R and B bytes areound while copying
-                texture->imageData[currentbyte + 1	] = colorbuffer[1];
-                texture->imageData[currentbyte + 2	] = colorbuffer[0];
-
-                if(tga.bytesPerPixel == 4)																		// If TGA images is 32 bpp
-                {
-                    texture->imageData[currentbyte + 3] = colorbuffer[3];				// Copy 4th byte
-                }
-
-                currentbyte += tga.bytesPerPixel;															// Increase current byte by the number of bytes per pixel
-                currentpixel++;																								// Increase pixel count by 1
-
-                if(currentpixel > pixelcount)																	// Make sure we havent written too many pixels
-                {
-                    if(fTGA != NULL)
-                        fclose(fTGA);
-
-                    if(colorbuffer != NULL)											// If there is data in colorbuffer
-                        free(colorbuffer);												// Delete it
-
-                    if(texture->imageData != NULL)							// If there is Image data
-                        free(texture->imageData);									// delete it
-
-                    return 0;														// Return failed
-                }
-            }
-        }
+        src          += (raw ? pixels : 1) * tga.bytesPerPixel;
+        currentpixel += pixels;
+    }
+    while(currentpixel < pixelcount);                                   // Loop while there are still pixels left
+
+    if(currentpixel < pixelcount)                                       // The file ended, or held too many pixels
+    {
+        free(texture->imageData);
+        return 0;
     }
 
-    while(currentpixel < pixelcount);										// Loop while there are still pixels left
-    fclose(fTGA);																				// Close the file
-    free(colorbuffer);
-    return 1;																						// return success
+    return 1;                                                           // return success
 }
 
 Texture *LoadGLTexture(const char *filename)
 {
+   MappedFile file;
+   int        loaded = 0;
+
    Texture *texture = (Texture *)malloc(sizeof(Texture));
-   if(!LoadTGA(texture, filename)) {
+   if(MapFile(filename, &file)) {
+      glGenTextures (1, &texture->texID);
+      glBindTexture (GL_TEXTURE_2D, texture->texID);
+
+      // KTX containers are uploaded straight from the mapped file, with the mipmaps they hold
+      if(IsKTX(&file)) {
+         loaded = LoadKTX(texture, &file);
+      } else if(LoadTGA(texture, &file)) {
+         glTexImage2D (GL_TEXTURE_2D, 0, texture->type, texture->width, texture->height, 0, texture->type, GL_UNSIGNED_BYTE, texture->imageData);
+         free(texture->imageData);
+         loaded = 1;
+      }
+
+      UnmapFile(&file);
+      if(!loaded) {
+         glDeleteTextures(1, &texture->texID);
+      }
+   }
+
+   if(!loaded) {
 #ifdef DEBUG_ASSET_MANAGEMENT
-            fprintf(stderr, "[tgaLoader.c] [LoadGLTexture()]: Error loading texture %s\n", filename);
+      fprintf(stderr, "[tgaLoader.c] [LoadGLTexture()]: Error loading texture %s\n", filename);
 #endif
       assert(0);
 
-            return NULL;
+      free(texture);
+      return NULL;
    }
 
-   glGenTextures	(1, &texture->texID);
-   glBindTexture	(GL_TEXTURE_2D, texture->texID);
-   glTexImage2D		(GL_TEXTURE_2D, 0, texture->type, texture->width, texture->height, 0, texture->type, GL_UNSIGNED_BYTE, texture->imageData);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture->levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-     free(texture->imageData);
 
-     ASSERT_NO_GL_ERROR();
+   ASSERT_NO_GL_ERROR();
 
    return texture;
 }
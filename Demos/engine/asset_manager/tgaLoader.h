@@ -15,6 +15,7 @@
 #define __TGALOADER_H__
 
 #include "../utilities/debug.h"
+#include "fileMapper.h"
 
 typedef	struct
 {
@@ -24,6 +25,7 @@ typedef	struct
     unsigned int	height;										// Image Height
     unsigned int	texID;										// Texture ID Used To Select A Texture
     unsigned int	type;											// Image Type (GL_RGB, GL_RGBA)
+    unsigned int	levels;										// Mipmap Levels
 } Texture;
 
 typedef struct
@@ -49,9 +51,9 @@ TGA tga;                                                   // TGA image data
 static unsigned char uTGAcompare[12] = {0,0,2, 0,0,0,0,0,0,0,0,0};	// Uncompressed TGA Header
 static unsigned char cTGAcompare[12] = {0,0,10,0,0,0,0,0,0,0,0,0};	// Compressed TGA Header
 
-int          LoadUncompressedTGA	(Texture *, const char *, FILE *);					// Load an Uncompressed file
-int          LoadCompressedTGA		(Texture *, const char *, FILE *);					// Load a Compressed file
-int          LoadTGA							(Texture * texture, const char *filename);
+int          LoadUncompressedTGA	(Texture *, const MappedFile *);					// Load an Uncompressed file
+int          LoadCompressedTGA		(Texture *, const MappedFile *);					// Load a Compressed file
+int          LoadTGA							(Texture * texture, const MappedFile *file);
 Texture *LoadGLTexture				(const char *filename);
 
 #endif //__TGALOADER_H__
@@ -21,6 +21,7 @@
 #include "../renderer/viewport.h"
 #include "../renderer/shading.h"
 #include "../scenegraph/mesh.h"
+#include "../scenegraph/scene.h"
 #include "../utilities/profiler.h"
 #include "../utilities/smoke_tests.h"
 #include "../asset_manager/shaderManager.h"
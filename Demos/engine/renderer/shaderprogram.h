@@ -26,15 +26,17 @@ typedef struct openGL_program_t
     GLint            mLocationPos;
     GLint            mLocationUV;
     GLint            mLocationColor;
+    GLint            mLocationMixValue;
 
 } openGL_program_t;
 
 static inline void InitProgram(struct openGL_program_t *p)
 {
-    p->mLocationMVP   = -1;
-    p->mLocationPos   = -1;
-    p->mLocationUV    = -1;
-    p->mLocationColor = -1;
+    p->mLocationMVP      = -1;
+    p->mLocationPos      = -1;
+    p->mLocationUV       = -1;
+    p->mLocationColor    = -1;
+    p->mLocationMixValue = -1;
 }
 
 #endif //__SHADERPROGRAM_H_
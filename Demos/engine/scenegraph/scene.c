@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "scene.h"
+
+bool InitScene(struct openGL_scene_t *scene, const int nodes_capacity)
+{
+    scene->mNodesNum      = 0;
+    scene->mDrawsNum      = 0;
+    scene->mNodesCapacity = nodes_capacity;
+    scene->mNodes         = (openGL_scene_node_t *)malloc(nodes_capacity * sizeof(openGL_scene_node_t));
+    if(scene->mNodes == NULL) {
+        scene->mNodesCapacity = 0;
+        return false;
+    }
+
+    return true;
+}
+
+openGL_scene_node_t *AddSceneNode(struct openGL_scene_t *scene, struct openGL_mesh_t *mesh, struct openGL_program_t *program,
+                                  const int material_type, const vec3 position, const float scale)
+{
+    if(scene->mNodesNum >= scene->mNodesCapacity) {
+        return NULL;
+    }
+
+    openGL_scene_node_t *node = &scene->mNodes[scene->mNodesNum++];
+    node->mMesh         = mesh;
+    node->mProgram      = program;
+    node->mMaterialType = material_type;
+    node->mMixValue     = 0.0f;
+    node->mSpinAxis[0]  = 0.0f;
+    node->mSpinAxis[1]  = 1.0f;
+    node->mSpinAxis[2]  = 0.0f;
+    node->mSpinAngle    = 1.0f;
+
+    mat4x4 T;
+    mat4x4_translate(T, position[0], position[1], position[2]);
+    mat4x4_scale_aniso(node->mModelMatrix, T, scale, scale, scale);
+
+    return node;
+}
+
+void UpdateScene(struct openGL_scene_t *scene, const float mix_step)
+{
+    mat4x4 M;
+    for(int i = 0; i < scene->mNodesNum; ++i) {
+        openGL_scene_node_t *node = &scene->mNodes[i];
+
+        mat4x4_dup(M, node->mModelMatrix);
+        mat4x4_rotate(node->mModelMatrix, M, node->mSpinAxis[0], node->mSpinAxis[1], node->mSpinAxis[2], (float)degreesToRadians(node->mSpinAngle));
+
+        node->mMixValue = fmodf(node->mMixValue + mix_step, 1.0f);
+    }
+}
+
+void DrawScene(struct openGL_scene_t *scene, struct openGL_camera_t *camera)
+{
+    mat4x4 VP, WVP, MWVP;
+    mat4x4_mul(VP , camera->mProjectionMatrix, camera->mViewMatrix);
+    mat4x4_mul(WVP, VP                       , camera->mWorldMatrix);
+
+    // the nodes are drawn in the order they were added, so that the program, textures and
+    // blending state may change from one draw to the next
+    GLint materialType = -1;
+    scene->mDrawsNum   = 0;
+    for(int i = 0; i < scene->mNodesNum; ++i) {
+        openGL_scene_node_t *node = &scene->mNodes[i];
+
+        if(node->mMaterialType != materialType) {
+            materialType = node->mMaterialType;
+            if(materialType == TRANSPARENT) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDepthMask(GL_FALSE);
+            } else {
+                glDisable(GL_BLEND);
+                glDepthMask(GL_TRUE);
+            }
+        }
+
+        mat4x4_mul(MWVP, WVP, node->mModelMatrix);
+
+        glUseProgram(node->mProgram->mID);
+        glUniformMatrix4fv(node->mProgram->mLocationMVP, 1, GL_FALSE, (const float *)&MWVP[0][0]);
+        if(node->mProgram->mLocationMixValue > -1) {
+            glUniform1f(node->mProgram->mLocationMixValue, node->mMixValue);
+        }
+
+        DrawMesh(node->mProgram, node->mMesh);
+        ++scene->mDrawsNum;
+    }
+
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    ASSERT_NO_GL_ERROR();
+}
+
+void DeleteScene(struct openGL_scene_t *scene)
+{
+    // the meshes and programs belong to the application
+    free(scene->mNodes);
+    scene->mNodes         = NULL;
+    scene->mNodesNum      = 0;
+    scene->mNodesCapacity = 0;
+}
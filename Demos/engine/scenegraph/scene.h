@@ -0,0 +1,53 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __SCENE_H_
+#define __SCENE_H_
+
+#include "mesh.h"
+#include "../renderer/rendering.h"
+
+typedef struct openGL_scene_node_t
+{
+    // shared with the other nodes, that differ in the program, textures and transformation only
+    struct openGL_mesh_t    *mMesh;
+    struct openGL_program_t *mProgram;
+
+    GLint      mMaterialType;
+    GLfloat    mMixValue;
+
+    vec3       mSpinAxis;
+    GLfloat    mSpinAngle;
+    mat4x4     mModelMatrix;
+
+} openGL_scene_node_t;
+
+typedef struct openGL_scene_t
+{
+    openGL_scene_node_t *mNodes;
+    GLint                mNodesNum;
+    GLint                mNodesCapacity;
+
+    // draws issued by the last DrawScene
+    GLint                mDrawsNum;
+
+} openGL_scene_t;
+
+bool InitScene(struct openGL_scene_t *scene, const int nodes_capacity);
+openGL_scene_node_t *AddSceneNode(struct openGL_scene_t *scene, struct openGL_mesh_t *mesh, struct openGL_program_t *program,
+                                  const int material_type, const vec3 position, const float scale);
+void UpdateScene(struct openGL_scene_t *scene, const float mix_step);
+void DrawScene(struct openGL_scene_t *scene, struct openGL_camera_t *camera);
+void DeleteScene(struct openGL_scene_t *scene);
+
+#endif // __SCENE_H_
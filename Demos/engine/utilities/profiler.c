@@ -12,6 +12,62 @@
  */
 
 #include "profiler.h"
+#include <stdlib.h>
+
+/// Environment variable naming a file that the time of every frame is written to, in ms, one per line
+#define FRAME_LOG_ENV "GLOVE_DEMOS_FRAME_LOG"
+/// Environment variable naming a file that the CPU time of every frame, in ms, and its draws are written to, one frame per line
+#define CPU_LOG_ENV   "GLOVE_DEMOS_CPU_LOG"
+
+static FILE *OpenLog(const char *env)
+{
+    const char *path = getenv(env);
+    if(path && path[0] != '\0') {
+        return fopen(path, "w");
+    }
+
+    return NULL;
+}
+
+static FILE *GetFrameLog()
+{
+    static FILE *frameLog = NULL;
+    static int   opened   = 0;
+
+    if(!opened) {
+        frameLog = OpenLog(FRAME_LOG_ENV);
+        opened = 1;
+    }
+
+    return frameLog;
+}
+
+static FILE *GetCpuLog()
+{
+    static FILE *cpuLog = NULL;
+    static int   opened = 0;
+
+    if(!opened) {
+        cpuLog = OpenLog(CPU_LOG_ENV);
+        opened = 1;
+    }
+
+    return cpuLog;
+}
+
+static double GetTime()
+{
+#ifdef WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timeval tim;
+    gettimeofday(&tim, NULL);
+    return tim.tv_sec + (tim.tv_usec / 1000000.0);
+#endif
+}
 
 void GpuViewer()
 {
@@ -44,6 +100,7 @@ double GpuTimer(const char *title)
     static double t0                = 0.0;
     static double totalTimeFPS      = 0.0;
     static int    frames            = 0;
+    static int    firstFrame        = 1;
 
     double t1                = 0.0;
     double timePerFrame      = 0.0;
@@ -73,6 +130,13 @@ double GpuTimer(const char *title)
     totalTimeFPS      += timePerFrame;
     t0                 = t1;
 
+    // the first call only starts the clock
+    FILE *frameLog = GetFrameLog();
+    if(frameLog && !firstFrame) {
+        fprintf(frameLog, "%.3f\n", timePerFrame*1000);
+    }
+    firstFrame         = 0;
+
     // Count fps (ms)
     ++frames;
     totalTimePerFrame += timePerFrame*1000;
@@ -93,3 +157,54 @@ double GpuTimer(const char *title)
 
     return timePerFrame;
 }
+
+static double cpuT0 = 0.0;
+
+void CpuTimerBegin()
+{
+    cpuT0 = GetTime();
+}
+
+double CpuTimerEnd(const char *title, int draws)
+{
+    static double totalTime      = 0.0;
+    static double totalTimeCpu   = 0.0;
+    static double lastT1         = 0.0;
+    static int    totalDraws     = 0;
+    static int    frames         = 0;
+
+    char  str[256];
+
+    // the time spent issuing the GL calls of the frame, which the GPU timer cannot tell apart
+    double t1          = GetTime();
+    double timeCpu     = t1 - cpuT0;
+
+    FILE *cpuLog = GetCpuLog();
+    if(cpuLog) {
+        fprintf(cpuLog, "%.3f %d\n", timeCpu*1000, draws);
+    }
+
+    if(lastT1 != 0.0) {
+        totalTime     += t1 - lastT1;
+    }
+    lastT1             = t1;
+
+    ++frames;
+    totalTimeCpu      += timeCpu;
+    totalDraws        += draws;
+    if(totalTime >= (float)FPS_TIME_PERIOD) {
+        float ms       = (float)(totalTimeCpu*1000)/(float)frames;
+        float drawsSec = totalTimeCpu > 0.0 ? (float)totalDraws/(float)totalTimeCpu : 0.0f;
+        sprintf(str, "%s CPU (%2.3f ms) (%d draws) (%.0f draws/sec)\n", title, ms, totalDraws/frames, drawsSec);
+#ifdef INFO_DISPLAY
+        printf("%s", str);
+#endif
+
+        frames         = 0;
+        totalDraws     = 0;
+        totalTime      = 0.0;
+        totalTimeCpu   = 0.0;
+    }
+
+    return timeCpu;
+}
@@ -23,5 +23,7 @@
 
 double GpuTimer(const char *title);
 void GpuViewer(void);
+void CpuTimerBegin(void);
+double CpuTimerEnd(const char *title, int draws);
 
 #endif // __PROFILER_H_
@@ -0,0 +1,860 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       gl_replay.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Replays a GL call capture of GLOVE_CAPTURE on a pbuffer and reports its frame times
+ *
+ *  @section
+ *
+ *  The capture is read into memory as a whole, so that the client memory
+ *  the calls read is handed to GL straight from it. The names and uniform
+ *  locations the capture recorded are mapped to the ones the replay gets,
+ *  while vertex attribute indices are replayed as they were captured.
+ *
+ */
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <GLES2/gl2ext_glove.h>
+#include "glCaptureFormat.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/// client memory handed to the calls that write to it, when the capture does not tell how much they write
+#define SCRATCH_SIZE                                    4096
+
+typedef std::pair<GLuint, GLint> location_t;
+
+class Reader;
+typedef std::function<void(Reader &)> handler_t;
+
+typedef struct callStats_t {
+    uint64_t                        count;
+    uint64_t                        nanoseconds;
+} callStats_t;
+
+typedef struct pendingNames_t {
+    captureNameKind_e               kind;
+    const GLuint                   *captured;
+    GLuint                         *replayed;
+    uint32_t                        count;
+} pendingNames_t;
+
+static std::unordered_map<GLuint, GLuint> names[CAPTURE_NAME_COUNT];
+static std::map<location_t, GLint>        locations;
+
+static inline uint64_t
+Now(void)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static GLuint
+Name(uint8_t kind, GLuint captured)
+{
+    if(captured == 0 || kind >= CAPTURE_NAME_COUNT) {
+        return captured;
+    }
+
+    // names the application used without generating them first stay as they are
+    auto name = names[kind].find(captured);
+    return name != names[kind].end() ? name->second : captured;
+}
+
+static GLint
+Location(GLuint program, GLint captured)
+{
+    auto location = locations.find(location_t(program, captured));
+    return location != locations.end() ? location->second : captured;
+}
+
+/// Decodes the arguments of a record into the ones of the call it replays
+class Reader {
+private:
+    const uint8_t                  *mPos;
+    const uint8_t                  *mEnd;
+    uint8_t                         mArguments;
+    bool                            mReturns;
+    bool                            mValid;
+    std::deque<std::vector<uint8_t>> mMemory;
+    std::vector<pendingNames_t>     mPendingNames;
+
+    template<typename T>
+    T                               Get()                   { T value = T(); if(Has(sizeof(T))) { memcpy(&value, mPos, sizeof(T)); mPos += sizeof(T); } return value; }
+    bool                            Has(size_t size)        { mValid = mValid && static_cast<size_t>(mEnd - mPos) >= size; return mValid; }
+    uint8_t                        *Memory(size_t size)     { mMemory.emplace_back(size, 0); return mMemory.back().data(); }
+
+    template<typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, T>::type
+                                    FromBits(uint32_t bits) { float value; memcpy(&value, &bits, sizeof(value)); return static_cast<T>(value); }
+    template<typename T>
+    static typename std::enable_if<!std::is_floating_point<T>::value, T>::type
+                                    FromBits(uint32_t bits) { return std::is_signed<T>::value ? static_cast<T>(static_cast<int32_t>(bits)) : static_cast<T>(bits); }
+
+    const void                     *Blob(uint32_t *size);
+    void                           *Pointer();
+
+public:
+    Reader(const uint8_t *args, const uint8_t *end, const captureRecordHeader_t &header)
+    : mPos(args), mEnd(end), mArguments(header.arguments), mReturns((header.flags & GLOVE_CAPTURE_FLAG_RETURN) != 0), mValid(true) { }
+
+    inline bool                     IsValid()         const { return mValid; }
+    inline uint8_t                  Arguments()       const { return mArguments; }
+    inline bool                     Returns()         const { return mReturns; }
+    inline void                     Invalidate()            { mValid = false; }
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, T>::type
+                                    Read();
+    template<typename T>
+    typename std::enable_if<std::is_pointer<T>::value, T>::type
+                                    Read()                  { return (T)(Pointer()); }
+    const char                     *ReadName()              { uint32_t size; Get<uint8_t>(); Get<uint8_t>(); const char *name = static_cast<const char *>(Blob(&size)); return (name && size && name[size - 1] == '\0') ? name : nullptr; }
+
+    /// maps what the capture returned, along with the names the call wrote, to what the replay did
+    void                            Returned(GLuint value);
+    void                            Returned(GLint value);
+    void                            Returned(GLboolean)     { }
+    void                            Returned(const void *)  { }
+    void                            Finish();
+};
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, T>::type
+Reader::Read()
+{
+    const uint8_t type = Get<uint8_t>();
+    const uint8_t kind = Get<uint8_t>();
+
+    switch(type) {
+    case CAPTURE_ARG_VALUE32:   return FromBits<T>(Get<uint32_t>());
+    case CAPTURE_ARG_VALUE64:   return static_cast<T>(Get<uint64_t>());
+    case CAPTURE_ARG_NAME:      return static_cast<T>(Name(kind, Get<uint32_t>()));
+    case CAPTURE_ARG_LOCATION: {
+        const GLuint program = Get<uint32_t>();
+        return static_cast<T>(Location(program, Get<int32_t>()));
+    }
+    default:
+        mValid = false;
+        return T();
+    }
+}
+
+const void *
+Reader::Blob(uint32_t *size)
+{
+    // the capture aligns the bytes that follow the size, as the whole of it is read to aligned memory
+    while((reinterpret_cast<uintptr_t>(mPos) + sizeof(uint32_t)) % GLOVE_CAPTURE_ALIGNMENT && mPos < mEnd) {
+        ++mPos;
+    }
+
+    *size = Get<uint32_t>();
+    if(!Has(*size)) {
+        return nullptr;
+    }
+
+    const void *data = mPos;
+    mPos += *size;
+    return data;
+}
+
+void *
+Reader::Pointer()
+{
+    const uint8_t type = Get<uint8_t>();
+    const uint8_t kind = Get<uint8_t>();
+
+    switch(type) {
+    case CAPTURE_ARG_NULL:
+        return nullptr;
+    case CAPTURE_ARG_OFFSET:
+        return reinterpret_cast<void *>(static_cast<uintptr_t>(Get<uint64_t>()));
+    case CAPTURE_ARG_BLOB: {
+        uint32_t size;
+        return const_cast<void *>(Blob(&size));
+    }
+    case CAPTURE_ARG_OUT:
+        return Memory(std::max<size_t>(Get<uint32_t>(), SCRATCH_SIZE));
+    case CAPTURE_ARG_NAMES: {
+        const uint32_t count = Get<uint32_t>();
+        GLuint *replayed = reinterpret_cast<GLuint *>(Memory((count + 1) * sizeof(GLuint)));
+        for(uint32_t i = 0; i < count && mValid; ++i) {
+            replayed[i] = Name(kind, Get<uint32_t>());
+        }
+        return replayed;
+    }
+    case CAPTURE_ARG_NAMES_OUT: {
+        const uint32_t count = Get<uint32_t>();
+        if(!Has(count * sizeof(GLuint))) {
+            return nullptr;
+        }
+        const pendingNames_t pending = { static_cast<captureNameKind_e>(kind), reinterpret_cast<const GLuint *>(mPos),
+                                         reinterpret_cast<GLuint *>(Memory((count + 1) * sizeof(GLuint))), count };
+        mPendingNames.push_back(pending);
+        mPos += count * sizeof(GLuint);
+        return pending.replayed;
+    }
+    case CAPTURE_ARG_STRINGS:
+    case CAPTURE_ARG_POINTERS: {
+        const uint32_t count = Get<uint32_t>();
+        const void **pointers = reinterpret_cast<const void **>(Memory((count + 1) * sizeof(void *)));
+        for(uint32_t i = 0; i < count && mValid; ++i) {
+            pointers[i] = Pointer();
+        }
+        return pointers;
+    }
+    default:
+        mValid = false;
+        return nullptr;
+    }
+}
+
+void
+Reader::Returned(GLuint value)
+{
+    if(!mReturns) {
+        return;
+    }
+
+    const uint8_t type = Get<uint8_t>();
+    const uint8_t kind = Get<uint8_t>();
+    if(type == CAPTURE_ARG_NAME && kind < CAPTURE_NAME_COUNT) {
+        names[kind][Get<uint32_t>()] = value;
+    }
+}
+
+void
+Reader::Returned(GLint value)
+{
+    if(!mReturns) {
+        return;
+    }
+
+    const uint8_t type = Get<uint8_t>();
+    Get<uint8_t>();
+    if(type == CAPTURE_ARG_LOCATION) {
+        const GLuint program = Get<uint32_t>();
+        locations[location_t(program, Get<int32_t>())] = value;
+    }
+}
+
+void
+Reader::Finish()
+{
+    for(const pendingNames_t &pending : mPendingNames) {
+        for(uint32_t i = 0; pending.kind < CAPTURE_NAME_COUNT && i < pending.count; ++i) {
+            GLuint captured;
+            memcpy(&captured, pending.captured + i, sizeof(captured));
+            names[pending.kind][captured] = pending.replayed[i];
+        }
+    }
+}
+
+template<size_t... I>
+struct Indices { };
+
+template<size_t N, size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+
+template<size_t... I>
+struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+template<typename R, typename... Args, size_t... I>
+static inline R
+Apply(R (GL_APIENTRY *function)(Args...), std::tuple<Args...> &args, Indices<I...>)
+{
+    return function(std::get<I>(args)...);
+}
+
+template<typename R>
+struct Invoke {
+    template<typename... Args>
+    static void Run(Reader &reader, R (GL_APIENTRY *function)(Args...), std::tuple<Args...> &args)
+    {
+        reader.Returned(Apply(function, args, typename MakeIndices<sizeof...(Args)>::type()));
+    }
+};
+
+template<>
+struct Invoke<void> {
+    template<typename... Args>
+    static void Run(Reader &, void (GL_APIENTRY *function)(Args...), std::tuple<Args...> &args)
+    {
+        Apply(function, args, typename MakeIndices<sizeof...(Args)>::type());
+    }
+};
+
+/// Reads the arguments of function in order off a record, then calls it
+template<typename R, typename... Args>
+static handler_t
+Call(R (GL_APIENTRY *function)(Args...))
+{
+    return [function](Reader &reader) {
+        if(reader.Arguments() != sizeof...(Args) + (reader.Returns() ? 1 : 0)) {
+            reader.Invalidate();
+            return;
+        }
+
+        // the arguments of a braced list are read from the left
+        std::tuple<Args...> args { reader.Read<Args>()... };
+        if(reader.IsValid()) {
+            Invoke<R>::Run(reader, function, args);
+            reader.Finish();
+        }
+    };
+}
+
+#define CALL(function)                                  { #function, Call(function) }
+
+static const std::unordered_map<std::string, handler_t> &
+Handlers(void)
+{
+    static const std::unordered_map<std::string, handler_t> handlers = {
+        CALL(glActiveTexture),
+        CALL(glAttachShader),
+        CALL(glBindAttribLocation),
+        CALL(glBindBuffer),
+        CALL(glBindFramebuffer),
+        CALL(glBindRenderbuffer),
+        CALL(glBlendColor),
+        CALL(glBlendEquation),
+        CALL(glBlendEquationSeparate),
+        CALL(glBlendFunc),
+        CALL(glBlendFuncSeparate),
+        CALL(glBufferData),
+        CALL(glBufferSubData),
+        CALL(glCheckFramebufferStatus),
+        CALL(glClear),
+        CALL(glClearColor),
+        CALL(glClearDepthf),
+        CALL(glClearStencil),
+        CALL(glColorMask),
+        CALL(glCompileShader),
+        CALL(glCompressedTexImage2D),
+        CALL(glCompressedTexSubImage2D),
+        CALL(glCopyTexImage2D),
+        CALL(glCopyTexSubImage2D),
+        CALL(glCreateProgram),
+        CALL(glCreateShader),
+        CALL(glCullFace),
+        CALL(glDeleteBuffers),
+        CALL(glDeleteFramebuffers),
+        CALL(glDeleteProgram),
+        CALL(glDeleteRenderbuffers),
+        CALL(glDeleteShader),
+        CALL(glDeleteTextures),
+        CALL(glDepthFunc),
+        CALL(glDepthMask),
+        CALL(glDepthRangef),
+        CALL(glDetachShader),
+        CALL(glDisable),
+        CALL(glDisableVertexAttribArray),
+        CALL(glDrawArrays),
+        CALL(glDrawElements),
+        CALL(glEnable),
+        CALL(glEnableVertexAttribArray),
+        CALL(glFinish),
+        CALL(glFlush),
+        CALL(glFramebufferRenderbuffer),
+        CALL(glFramebufferTexture2D),
+        CALL(glFrontFace),
+        CALL(glGenBuffers),
+        CALL(glGenerateMipmap),
+        CALL(glGenFramebuffers),
+        CALL(glGenRenderbuffers),
+        CALL(glBindTexture),
+        CALL(glGenTextures),
+        CALL(glGetActiveAttrib),
+        CALL(glGetActiveUniform),
+        CALL(glGetAttachedShaders),
+        CALL(glGetAttribLocation),
+        CALL(glGetBooleanv),
+        CALL(glGetBufferParameteriv),
+        CALL(glGetError),
+        CALL(glGetFloatv),
+        CALL(glGetFramebufferAttachmentParameteriv),
+        CALL(glGetIntegerv),
+        CALL(glGetProgramiv),
+        CALL(glGetProgramInfoLog),
+        CALL(glGetRenderbufferParameteriv),
+        CALL(glGetShaderiv),
+        CALL(glGetShaderInfoLog),
+        CALL(glGetShaderPrecisionFormat),
+        CALL(glGetShaderSource),
+        CALL(glGetString),
+        CALL(glGetTexParameterfv),
+        CALL(glGetTexParameteriv),
+        CALL(glGetUniformfv),
+        CALL(glGetUniformiv),
+        CALL(glGetUniformLocation),
+        CALL(glGetVertexAttribfv),
+        CALL(glGetVertexAttribiv),
+        CALL(glGetVertexAttribPointerv),
+        CALL(glHint),
+        CALL(glIsBuffer),
+        CALL(glIsEnabled),
+        CALL(glIsFramebuffer),
+        CALL(glIsProgram),
+        CALL(glIsRenderbuffer),
+        CALL(glIsShader),
+        CALL(glIsTexture),
+        CALL(glLineWidth),
+        CALL(glLinkProgram),
+        CALL(glPixelStorei),
+        CALL(glPolygonOffset),
+        CALL(glReadPixels),
+        CALL(glReleaseShaderCompiler),
+        CALL(glRenderbufferStorage),
+        CALL(glSampleCoverage),
+        CALL(glScissor),
+        CALL(glShaderBinary),
+        CALL(glShaderSource),
+        CALL(glStencilFunc),
+        CALL(glStencilFuncSeparate),
+        CALL(glStencilMask),
+        CALL(glStencilMaskSeparate),
+        CALL(glStencilOp),
+        CALL(glStencilOpSeparate),
+        CALL(glTexImage2D),
+        CALL(glTexParameterf),
+        CALL(glTexParameterfv),
+        CALL(glTexParameteri),
+        CALL(glTexParameteriv),
+        CALL(glTexSubImage2D),
+        CALL(glUniform1f),
+        CALL(glUniform1fv),
+        CALL(glUniform1i),
+        CALL(glUniform1iv),
+        CALL(glUniform2f),
+        CALL(glUniform2fv),
+        CALL(glUniform2i),
+        CALL(glUniform2iv),
+        CALL(glUniform3f),
+        CALL(glUniform3fv),
+        CALL(glUniform3i),
+        CALL(glUniform3iv),
+        CALL(glUniform4f),
+        CALL(glUniform4fv),
+        CALL(glUniform4i),
+        CALL(glUniform4iv),
+        CALL(glUniformMatrix2fv),
+        CALL(glUniformMatrix3fv),
+        CALL(glUniformMatrix4fv),
+        CALL(glUseProgram),
+        CALL(glValidateProgram),
+        CALL(glVertexAttrib1f),
+        CALL(glVertexAttrib1fv),
+        CALL(glVertexAttrib2f),
+        CALL(glVertexAttrib2fv),
+        CALL(glVertexAttrib3f),
+        CALL(glVertexAttrib3fv),
+        CALL(glVertexAttrib4f),
+        CALL(glVertexAttrib4fv),
+        CALL(glVertexAttribPointer),
+        CALL(glViewport),
+        CALL(glInsertEventMarkerEXT),
+        CALL(glPushGroupMarkerEXT),
+        CALL(glPopGroupMarkerEXT),
+        CALL(glDrawArraysInstancedEXT),
+        CALL(glDrawElementsInstancedEXT),
+        CALL(glVertexAttribDivisorEXT),
+        CALL(glMultiDrawArraysEXT),
+        CALL(glMultiDrawElementsEXT),
+        CALL(glDrawArraysIndirect),
+        CALL(glDrawElementsIndirect),
+        CALL(glMultiDrawArraysIndirectEXT),
+        CALL(glMultiDrawElementsIndirectEXT),
+        CALL(glDiscardFramebufferEXT),
+        CALL(glRenderbufferStorageMultisampleEXT),
+        CALL(glFramebufferTexture2DMultisampleEXT),
+        CALL(glFramebufferTextureMultiviewOVR),
+        CALL(glBlitFramebufferANGLE),
+        CALL(glBlitFramebufferNV),
+        CALL(glTexStorage2DEXT),
+        CALL(glMapBufferOES),
+        CALL(glUnmapBufferOES),
+        CALL(glGetBufferPointervOES),
+        CALL(glMapBufferRangeEXT),
+        CALL(glFlushMappedBufferRangeEXT),
+        CALL(glGetProgramBinaryOES),
+        CALL(glProgramBinaryOES),
+        CALL(glMaxShaderCompilerThreadsKHR),
+        CALL(glGenQueriesEXT),
+        CALL(glDeleteQueriesEXT),
+        CALL(glIsQueryEXT),
+        CALL(glBeginQueryEXT),
+        CALL(glEndQueryEXT),
+        CALL(glQueryCounterEXT),
+        CALL(glGetQueryivEXT),
+        CALL(glGetQueryObjectivEXT),
+        CALL(glGetQueryObjectuivEXT),
+        CALL(glGetQueryObjecti64vEXT),
+        CALL(glGetQueryObjectui64vEXT),
+        CALL(glGenVertexArraysOES),
+        CALL(glDeleteVertexArraysOES),
+        CALL(glIsVertexArrayOES),
+        CALL(glBindVertexArrayOES),
+        CALL(glGenCommandBundlesGLOVE),
+        CALL(glDeleteCommandBundlesGLOVE),
+        CALL(glBeginCommandBundleGLOVE),
+        CALL(glEndCommandBundleGLOVE),
+        CALL(glCallCommandBundleGLOVE),
+        CALL(glDispatchCompute),
+        CALL(glMemoryBarrier),
+        CALL(glBindBufferBase),
+        CALL(glBindBufferRange),
+        CALL(glTransformFeedbackVaryings),
+        CALL(glBeginTransformFeedback),
+        CALL(glEndTransformFeedback),
+        CALL(glDrawRangeElements),
+        CALL(glGetUniformBlockIndex),
+        CALL(glUniformBlockBinding)
+    };
+
+    return handlers;
+}
+
+static const char *captureFile  = nullptr;
+static const char *frameLogFile = nullptr;
+static uint32_t    width        = 0;
+static uint32_t    height       = 0;
+static bool        callTimes    = false;
+static bool        finishFrames = false;
+
+static void
+PrintUsage()
+{
+    printf("Correct Usage: ./gl_replay [-s <width>x<height>] [-f] [-c] [-l <frame_log>] <capture_file>\n");
+    printf("  -s  size of the pbuffer replayed to (default: the surface of the capture)\n");
+    printf("  -f  finish every frame, so that the frame times include the GPU\n");
+    printf("  -c  report the CPU time the replay spent in each GL call\n");
+    printf("  -l  write the time of every replayed frame to a file, in ms one per line\n");
+}
+
+static bool
+ReadArguments(int argc, char *argv[])
+{
+    int c;
+
+    while((c = getopt(argc, argv, "s:fcl:h")) != -1) {
+        switch(c) {
+        case 's':
+            if(sscanf(optarg, "%ux%u", &width, &height) != 2) {
+                return false;
+            }
+            break;
+        case 'f':
+            finishFrames = true;
+            break;
+        case 'c':
+            callTimes = true;
+            break;
+        case 'l':
+            frameLogFile = optarg;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if(optind != argc - 1) {
+        return false;
+    }
+    captureFile = argv[optind];
+
+    return true;
+}
+
+static bool
+LoadCapture(const char *path, std::vector<uint64_t> &capture, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == nullptr) {
+        fprintf(stderr, "gl_replay: cannot open %s\n", path);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *size = static_cast<size_t>(ftell(file));
+    fseek(file, 0, SEEK_SET);
+
+    // 64 bit words keep the records, and the client memory in them, aligned
+    capture.resize((*size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    const bool read = fread(capture.data(), 1, *size, file) == *size;
+    fclose(file);
+
+    uint32_t version = 0;
+    if(read && *size >= GLOVE_CAPTURE_HEADER_SIZE) {
+        memcpy(&version, reinterpret_cast<const uint8_t *>(capture.data()) + GLOVE_CAPTURE_MAGIC_SIZE, sizeof(version));
+    }
+    if(!read || *size < GLOVE_CAPTURE_HEADER_SIZE || memcmp(capture.data(), GLOVE_CAPTURE_MAGIC, GLOVE_CAPTURE_MAGIC_SIZE) || version != GLOVE_CAPTURE_VERSION) {
+        fprintf(stderr, "gl_replay: %s is not a GLOVE capture of version %u\n", path, GLOVE_CAPTURE_VERSION);
+        return false;
+    }
+
+    return true;
+}
+
+/// Calls every record of the capture along with its header, until one is malformed
+template<typename F>
+static bool
+ForEachRecord(const uint8_t *data, size_t size, F function)
+{
+    for(size_t pos = GLOVE_CAPTURE_HEADER_SIZE; pos < size;) {
+        captureRecordHeader_t header;
+        if(size - pos < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, data + pos, sizeof(header));
+        if(header.size < sizeof(header) || header.size % GLOVE_CAPTURE_ALIGNMENT || header.size > size - pos) {
+            fprintf(stderr, "gl_replay: malformed record at offset %zu\n", pos);
+            return false;
+        }
+
+        function(header, data + pos + sizeof(header), data + pos + header.size);
+        pos += header.size;
+    }
+
+    return true;
+}
+
+static bool
+CreateSurface(EGLDisplay *display, EGLSurface *surface, EGLContext *context)
+{
+    const EGLint configAttribs[] = { EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+                                     EGL_RED_SIZE,        8,
+                                     EGL_GREEN_SIZE,      8,
+                                     EGL_BLUE_SIZE,       8,
+                                     EGL_ALPHA_SIZE,      8,
+                                     EGL_DEPTH_SIZE,      24,
+                                     EGL_STENCIL_SIZE,    8,
+                                     EGL_NONE };
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, static_cast<EGLint>(width), EGL_HEIGHT, static_cast<EGLint>(height), EGL_NONE };
+    const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+
+    EGLConfig config;
+    EGLint    configs = 0;
+
+    *display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if(*display == EGL_NO_DISPLAY || !eglInitialize(*display, nullptr, nullptr) ||
+       !eglChooseConfig(*display, configAttribs, &config, 1, &configs) || configs < 1) {
+        fprintf(stderr, "gl_replay: no EGL config renders to a pbuffer with OpenGL ES 2\n");
+        return false;
+    }
+
+    *surface = eglCreatePbufferSurface(*display, config, surfaceAttribs);
+    *context = eglCreateContext(*display, config, EGL_NO_CONTEXT, contextAttribs);
+    if(*surface == EGL_NO_SURFACE || *context == EGL_NO_CONTEXT || !eglMakeCurrent(*display, *surface, *surface, *context)) {
+        fprintf(stderr, "gl_replay: cannot make a %ux%u pbuffer current (0x%x)\n", width, height, eglGetError());
+        return false;
+    }
+
+    return true;
+}
+
+static double
+Percentile(std::vector<double> ordered, double percent)
+{
+    std::sort(ordered.begin(), ordered.end());
+    const size_t rank = static_cast<size_t>(percent / 100.0 * ordered.size() + 0.5);
+    return ordered[std::min(rank ? rank - 1 : 0, ordered.size() - 1)];
+}
+
+static void
+PrintFrameTimes(const char *name, const std::vector<double> &frameTimes)
+{
+    if(frameTimes.empty()) {
+        printf("%-8s no frames\n", name);
+        return;
+    }
+
+    double total = 0.0;
+    for(double frameTime : frameTimes) {
+        total += frameTime;
+    }
+
+    printf("%-8s %6zu frames  mean %8.3f ms  p50 %8.3f ms  p90 %8.3f ms  p99 %8.3f ms  %8.1f fps\n", name, frameTimes.size(),
+           total / frameTimes.size(), Percentile(frameTimes, 50), Percentile(frameTimes, 90), Percentile(frameTimes, 99),
+           total > 0.0 ? frameTimes.size() * 1000.0 / total : 0.0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if(!ReadArguments(argc, argv)) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint64_t> capture;
+    size_t size;
+    if(!LoadCapture(captureFile, capture, &size)) {
+        return EXIT_FAILURE;
+    }
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(capture.data());
+
+    // the calls are known by the names the capture defines, and the surface by the first one made current
+    std::vector<std::string> calls;
+    std::vector<double>      capturedFrameTimes;
+    uint64_t                 lastSwap = 0;
+    uint32_t                 capturedWidth = 0, capturedHeight = 0;
+    ForEachRecord(data, size, [&](const captureRecordHeader_t &header, const uint8_t *args, const uint8_t *end) {
+        Reader reader(args, end, header);
+        if(header.flags & GLOVE_CAPTURE_FLAG_DEFINE) {
+            const char *name = reader.ReadName();
+            calls.resize(std::max<size_t>(calls.size(), header.call + 1u));
+            calls[header.call] = name ? name : "";
+        } else if(header.call < calls.size() && calls[header.call] == GLOVE_CAPTURE_MAKE_CURRENT && !capturedWidth) {
+            capturedWidth  = reader.Read<uint32_t>();
+            capturedHeight = reader.Read<uint32_t>();
+        } else if(header.call < calls.size() && calls[header.call] == GLOVE_CAPTURE_SWAP_BUFFERS) {
+            if(lastSwap) {
+                capturedFrameTimes.push_back(static_cast<double>(header.nanoseconds - lastSwap) / 1e6);
+            }
+            lastSwap = header.nanoseconds;
+        }
+    });
+
+    if(!width || !height) {
+        width  = capturedWidth  ? capturedWidth  : 1920;
+        height = capturedHeight ? capturedHeight : 1080;
+    }
+
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+    if(!CreateSurface(&display, &surface, &context)) {
+        return EXIT_FAILURE;
+    }
+
+    const std::unordered_map<std::string, handler_t> &handlers = Handlers();
+    std::vector<const handler_t *> callHandlers(calls.size(), nullptr);
+    std::vector<callStats_t>       callStats(calls.size(), callStats_t());
+    std::vector<bool>              warned(calls.size(), false);
+    for(size_t i = 0; i < calls.size(); ++i) {
+        auto handler = handlers.find(calls[i]);
+        callHandlers[i] = handler != handlers.end() ? &handler->second : nullptr;
+    }
+
+    std::vector<double> frameTimes;
+    uint64_t frameStart = Now();
+    uint64_t skipped    = 0;
+    const bool complete = ForEachRecord(data, size, [&](const captureRecordHeader_t &header, const uint8_t *args, const uint8_t *end) {
+        if((header.flags & GLOVE_CAPTURE_FLAG_DEFINE) || header.call >= calls.size()) {
+            return;
+        }
+
+        if(calls[header.call] == GLOVE_CAPTURE_SWAP_BUFFERS) {
+            if(finishFrames) {
+                glFinish();
+            }
+            eglSwapBuffers(display, surface);
+
+            const uint64_t now = Now();
+            frameTimes.push_back(static_cast<double>(now - frameStart) / 1e6);
+            frameStart = now;
+            return;
+        }
+
+        if(calls[header.call] == GLOVE_CAPTURE_MAKE_CURRENT) {
+            return;
+        }
+
+        if(callHandlers[header.call] == nullptr) {
+            if(!warned[header.call]) {
+                fprintf(stderr, "gl_replay: %s is not replayed\n", calls[header.call].c_str());
+                warned[header.call] = true;
+            }
+            ++skipped;
+            return;
+        }
+
+        Reader reader(args, end, header);
+        const uint64_t start = callTimes ? Now() : 0;
+        (*callHandlers[header.call])(reader);
+        if(callTimes) {
+            callStats[header.call].nanoseconds += Now() - start;
+            ++callStats[header.call].count;
+        }
+
+        if(!reader.IsValid()) {
+            if(!warned[header.call]) {
+                fprintf(stderr, "gl_replay: %s has arguments that do not match its signature\n", calls[header.call].c_str());
+                warned[header.call] = true;
+            }
+            ++skipped;
+        }
+    });
+    glFinish();
+
+    printf("%s: %ux%u\n", captureFile, width, height);
+    PrintFrameTimes("replay", frameTimes);
+    PrintFrameTimes("capture", capturedFrameTimes);
+    if(skipped || !complete) {
+        printf("%" PRIu64 " calls were not replayed%s\n", skipped, complete ? "" : ", the capture ends in a malformed record");
+    }
+
+    if(callTimes) {
+        std::vector<size_t> order;
+        for(size_t i = 0; i < calls.size(); ++i) {
+            if(callStats[i].count) {
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return callStats[a].nanoseconds > callStats[b].nanoseconds; });
+
+        printf("%-40s %10s %12s %10s\n", "call", "count", "total ms", "mean us");
+        for(size_t i : order) {
+            printf("%-40s %10" PRIu64 " %12.3f %10.3f\n", calls[i].c_str(), callStats[i].count,
+                   static_cast<double>(callStats[i].nanoseconds) / 1e6, static_cast<double>(callStats[i].nanoseconds) / 1e3 / callStats[i].count);
+        }
+    }
+
+    if(frameLogFile) {
+        FILE *frameLog = fopen(frameLogFile, "w");
+        for(size_t i = 0; frameLog && i < frameTimes.size(); ++i) {
+            fprintf(frameLog, "%.3f\n", frameTimes[i]);
+        }
+        if(frameLog) {
+            fclose(frameLog);
+        }
+    }
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglDestroySurface(display, surface);
+    eglTerminate(display);
+
+    return complete ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -11,28 +11,49 @@
  * Lesser General Public License for more details.
  */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <unistd.h>
 #include <getopt.h>
 #include <ctype.h>
+#include <time.h>
 
 #include "../engine/glcore/common.h"
 
-#define ARGS_NUM 7
+#define MAX_LINE_LENGTH         1024
+#define MAX_SLOWEST_PROGRAMS    10
+#define DEFAULT_THREADS         4
+
+/// A program of the manifest, along with the points in time its shaders and itself completed
+typedef struct batch_program {
+    char     vs_source[MAX_LINE_LENGTH];
+    char     fs_source[MAX_LINE_LENGTH];
+    char     out_file [MAX_LINE_LENGTH];
+    GLuint   vs, fs, id;
+    double   start_ms, vs_ms, fs_ms, link_ms;
+    bool     submitted, completed, linked;
+} batch_program_t;
 
 static openGL_program_t  program;
 
-static char *vs_source = NULL;
-static char *fs_source = NULL;
-static char *out_file  = NULL;
+static char *vs_source     = NULL;
+static char *fs_source     = NULL;
+static char *out_file      = NULL;
+static char *manifest_file = NULL;
+static char *cache_dir     = NULL;
+static int   threads       = DEFAULT_THREADS;
 
 static void PrintUsage    ();
 static void CompileShaders();
+static bool CompileBatch  ();
 static bool ReadArguments (int argc, char *argv[]);
 
 static void
 PrintUsage()
 {
     printf("Correct Usage: ./offline_shader_compiler -v <vertex_shader_source> -f <fragment_shader_source> -o <output_file>\n");
+    printf("               ./offline_shader_compiler -m <manifest_file> [-j <threads>] [-c <shader_cache_dir>]\n");
+    printf("Each manifest line holds '<vertex_shader_source> <fragment_shader_source> [<output_file>]', '#' starts a comment.\n");
 }
 
 static bool
@@ -40,12 +61,7 @@ ReadArguments(int argc, char *argv[])
 {
     signed char c;
 
-    if(argc != ARGS_NUM) {
-        PrintUsage();
-        return false;
-    }
-
-    while ((c = getopt(argc, argv, "v:f:o:")) != -1) {
+    while ((c = getopt(argc, argv, "v:f:o:m:j:c:")) != -1) {
         switch (c) {
         case 'v':
             vs_source = optarg;
@@ -56,12 +72,18 @@ ReadArguments(int argc, char *argv[])
         case 'o':
             out_file = optarg;
             break;
+        case 'm':
+            manifest_file = optarg;
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 'c':
+            cache_dir = optarg;
+            break;
         case '?':
-            if (optopt == 'v')
-                printf ("Option -%c requires an argument.\n", optopt);
-            else if (optopt == 'f')
-                printf ("Option -%c requires an argument.\n", optopt);
-            else if (optopt == 'o')
+            if (optopt == 'v' || optopt == 'f' || optopt == 'o' ||
+                optopt == 'm' || optopt == 'j' || optopt == 'c')
                 printf ("Option -%c requires an argument.\n", optopt);
             else if (isprint (optopt))
                 printf ("Unknown option `-%c'.\n", optopt);
@@ -75,9 +97,243 @@ ReadArguments(int argc, char *argv[])
         }
     }
 
+    if(manifest_file ? (vs_source || fs_source || out_file || threads < 1)
+                     : (!vs_source || !fs_source || !out_file || cache_dir)) {
+        PrintUsage();
+        return false;
+    }
+
+    return true;
+}
+
+static double
+GetTimeMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static batch_program_t *
+ReadManifest(int *count)
+{
+    FILE *file = fopen(manifest_file, "r");
+    if(!file) {
+        printf("Cannot open manifest '%s'\n", manifest_file);
+        return NULL;
+    }
+
+    int              capacity = 64;
+    batch_program_t *programs = (batch_program_t *)malloc(capacity * sizeof(batch_program_t));
+    char             line[3 * MAX_LINE_LENGTH];
+
+    *count = 0;
+    while(fgets(line, sizeof(line), file)) {
+        char *comment = strchr(line, '#');
+        if(comment) {
+            *comment = '\0';
+        }
+
+        batch_program_t entry;
+        memset(&entry, 0, sizeof(entry));
+        int fields = sscanf(line, "%1023s %1023s %1023s", entry.vs_source, entry.fs_source, entry.out_file);
+        if(fields <= 0) {
+            continue;
+        }
+        if(fields < 2 || (fields == 2 && !cache_dir)) {
+            printf("Skipping manifest line '%s': programs need an output file unless a shader cache is filled\n", entry.vs_source);
+            continue;
+        }
+
+        if(*count == capacity) {
+            capacity *= 2;
+            programs  = (batch_program_t *)realloc(programs, capacity * sizeof(batch_program_t));
+        }
+        programs[(*count)++] = entry;
+    }
+    fclose(file);
+
+    return programs;
+}
+
+static bool
+SubmitShader(const char *filename, GLenum type, GLuint *shader)
+{
+    char *source = NULL;
+    int   length = 0;
+
+    *shader = glCreateShader(type);
+    if(!LoadSource(filename, &source, &length)) {
+        printf("Cannot open shader source '%s'\n", filename);
+        return false;
+    }
+
+    glShaderSource(*shader, 1, (const char **)&source, NULL);
+    glCompileShader(*shader);
+    free(source);
+
     return true;
 }
 
+static void
+SubmitProgram(batch_program_t *prog)
+{
+    prog->submitted = true;
+    prog->start_ms  = GetTimeMs();
+
+    /// no status is queried here, so that the implementation compiles in the background
+    if(!SubmitShader(prog->vs_source, GL_VERTEX_SHADER, &prog->vs) ||
+       !SubmitShader(prog->fs_source, GL_FRAGMENT_SHADER, &prog->fs)) {
+        prog->completed = true;
+        return;
+    }
+
+    prog->id = glCreateProgram();
+    glAttachShader(prog->id, prog->vs);
+    glAttachShader(prog->id, prog->fs);
+    glLinkProgram(prog->id);
+}
+
+static void
+PollProgram(batch_program_t *prog)
+{
+    GLint done = GL_FALSE;
+    double now = GetTimeMs();
+
+    if(prog->vs_ms == 0.0) {
+        glGetShaderiv(prog->vs, GL_COMPLETION_STATUS_KHR, &done);
+        if(done) {
+            prog->vs_ms = now - prog->start_ms;
+        }
+    }
+    if(prog->fs_ms == 0.0) {
+        glGetShaderiv(prog->fs, GL_COMPLETION_STATUS_KHR, &done);
+        if(done) {
+            prog->fs_ms = now - prog->start_ms;
+        }
+    }
+
+    glGetProgramiv(prog->id, GL_COMPLETION_STATUS_KHR, &done);
+    if(!done) {
+        return;
+    }
+
+    GLint status = GL_FALSE;
+    prog->link_ms   = now - prog->start_ms;
+    prog->completed = true;
+    glGetProgramiv(prog->id, GL_LINK_STATUS, &status);
+    prog->linked    = status == GL_TRUE;
+
+    if(!prog->linked) {
+        GLint length = 0;
+        glGetProgramiv(prog->id, GL_INFO_LOG_LENGTH, &length);
+        char *info = (char *)malloc(length + 1);
+        info[0] = '\0';
+        glGetProgramInfoLog(prog->id, length + 1, NULL, info);
+        printf("FAILED   %s %s\n%s\n", prog->vs_source, prog->fs_source, info);
+        free(info);
+    } else if(prog->out_file[0]) {
+        SaveProgramBinary(&prog->id, prog->out_file);
+    }
+}
+
+static void
+ReleaseProgram(batch_program_t *prog)
+{
+    if(prog->id) {
+        DetachShader(prog->id, prog->vs);
+        DetachShader(prog->id, prog->fs);
+        DeleteProgram(prog->id);
+    }
+    DeleteShader(prog->vs);
+    DeleteShader(prog->fs);
+}
+
+static int
+CompareLinkTimes(const void *a, const void *b)
+{
+    const batch_program_t *pa = *(const batch_program_t * const *)a;
+    const batch_program_t *pb = *(const batch_program_t * const *)b;
+
+    return (pa->link_ms < pb->link_ms) - (pa->link_ms > pb->link_ms);
+}
+
+static bool
+CompileBatch(void)
+{
+    int              count    = 0;
+    batch_program_t *programs = ReadManifest(&count);
+    if(!programs) {
+        return false;
+    }
+
+    glMaxShaderCompilerThreadsKHR(threads);
+
+    /// at most as many programs as compiler threads are in flight, so that
+    /// the reported times do not include waiting for a free thread
+    double start   = GetTimeMs();
+    int    next    = 0;
+    int    pending = 0;
+    int    failed  = 0;
+    while(next < count || pending) {
+        while(next < count && pending < threads) {
+            SubmitProgram(&programs[next++]);
+            ++pending;
+        }
+
+        bool progress = false;
+        for(int i = 0; i < next; ++i) {
+            batch_program_t *prog = &programs[i];
+            if(prog->completed && !prog->id && prog->submitted) {
+                /// a source could not be read
+                prog->submitted = false;
+                ++failed;
+                --pending;
+                progress = true;
+                ReleaseProgram(prog);
+                continue;
+            }
+            if(!prog->id || prog->completed) {
+                continue;
+            }
+
+            PollProgram(prog);
+            if(prog->completed) {
+                printf("%9.2f ms (vs %9.2f ms, fs %9.2f ms)  %s %s\n",
+                       prog->link_ms, prog->vs_ms, prog->fs_ms, prog->vs_source, prog->fs_source);
+                failed  += !prog->linked;
+                --pending;
+                progress = true;
+                ReleaseProgram(prog);
+            }
+        }
+
+        if(!progress) {
+            struct timespec delay = { 0, 200000 };
+            nanosleep(&delay, NULL);
+        }
+    }
+
+    /// the slowest programs tell which shaders are worth simplifying
+    batch_program_t **sorted = (batch_program_t **)malloc(count * sizeof(batch_program_t *));
+    for(int i = 0; i < count; ++i) {
+        sorted[i] = &programs[i];
+    }
+    qsort(sorted, count, sizeof(batch_program_t *), CompareLinkTimes);
+
+    printf("\nCompiled %d programs (%d failed) in %.2f ms with %d threads\n", count, failed, GetTimeMs() - start, threads);
+    printf("Slowest programs:\n");
+    for(int i = 0; i < count && i < MAX_SLOWEST_PROGRAMS; ++i) {
+        printf("%9.2f ms  %s %s\n", sorted[i]->link_ms, sorted[i]->vs_source, sorted[i]->fs_source);
+    }
+
+    free(sorted);
+    free(programs);
+
+    return failed == 0;
+}
+
 static void
 CompileShaders(void)
 {
@@ -117,12 +373,21 @@ main(int argc, char **argv)
     if(!ReadArguments(argc, argv))
       return 0;
 
+    /// linked programs are stored into the shader cache of GLOVE, ready to be shipped
+    if(cache_dir) {
+        setenv("GLOVE_SHADER_CACHE_PATH", cache_dir, 1);
+    }
+
     eglutInit(argc, (const char **)argv);
     int win = eglutCreateWindow("");
 
-    CompileShaders();
+    if(manifest_file) {
+        CompileBatch();
+    } else {
+        CompileShaders();
 
-    DestroyGL();
+        DestroyGL();
+    }
 
     eglutDestroyWindow(win);
     _eglutFini();
@@ -38,6 +38,8 @@ extern "C" {
 typedef struct EGLSurfaceInterface_t {
     void    *surface;
     void    *images;
+    /// host visible buffers of a pbuffer, one per image, that each frame is copied to on a swap (null if not streamed)
+    void    *readbackBuffers;
     void    *depthBuffer;
     int32_t  contextRef;
     uint32_t imageCount;
@@ -48,15 +50,44 @@ typedef struct EGLSurfaceInterface_t {
     uint32_t height;
     uint32_t depthSize;
     uint32_t stencilSize;
+    uint32_t samples;
+    /// VkSurfaceTransformFlagBitsKHR the images are presented with, width and height are the ones before it is applied
+    uint32_t preTransform;
+    /// vkSyncItems_t of the swapchain of a window surface, null to use the ones of the vkInterface
+    void    *syncItems;
 } EGLSurfaceInterface;
 
+#define GLOVE_MAX_EGL_IMAGE_PLANES          4
+#define GLOVE_DRM_FORMAT_MOD_LINEAR         0ull
+
+typedef enum EGLImageSource {
+    EGL_IMAGE_SOURCE_DMA_BUF                    = 0,
+    EGL_IMAGE_SOURCE_ANDROID_HARDWARE_BUFFER    = 1
+} EGLImageSource_e;
+
+/// client buffer behind an EGLImage, the client API imports its memory instead of copying it
+typedef struct EGLImageInterface_t {
+    uint32_t source;
+    uint32_t width;
+    uint32_t height;
+    uint32_t fourcc;
+    VkFormat vkFormat;
+    uint32_t planeCount;
+    int32_t  fds[GLOVE_MAX_EGL_IMAGE_PLANES];
+    uint32_t offsets[GLOVE_MAX_EGL_IMAGE_PLANES];
+    uint32_t pitches[GLOVE_MAX_EGL_IMAGE_PLANES];
+    uint64_t modifier;
+    bool     hasModifier;
+    void    *hardwareBuffer;
+} EGLImageInterface;
+
 typedef void * api_state_t;
 typedef void * api_context_t;
 typedef void (*GLPROC)(void);
 
 typedef api_state_t (*init_API_cb_t)();
 typedef void (*terminate_API_cb_t)();
-typedef api_context_t (*create_context_cb_t)();
+typedef api_context_t (*create_context_cb_t)(api_context_t share_context);
 typedef void (*set_read_write_surface_cb_t)(api_context_t api_context, EGLSurfaceInterface *eglReadSurfaceInterface, EGLSurfaceInterface *eglWriteSurfaceInterface);
 typedef void (*delete_shared_surface_data_cb_t)(EGLSurfaceInterface *eglSurfaceInterface);
 typedef void (*delete_context_cb_t)(api_context_t api_context);
@@ -65,6 +96,16 @@ typedef GLPROC (*get_proc_addr_cb_t)(const char* procname);
 typedef void (*flush_cb_t)(api_context_t api_context);
 typedef void (*finish_cb_t)(api_context_t api_context);
 typedef void (*bind_to_texture_cb_t)(api_context_t api_context, uint32_t bind);
+typedef void (*submit_frame_cb_t)(api_context_t api_context);
+typedef void (*set_damage_region_cb_t)(api_context_t api_context, const EGLint *rects, EGLint n_rects);
+typedef void * (*create_fence_cb_t)(api_context_t api_context);
+typedef void (*server_wait_fence_cb_t)(api_context_t api_context, void *fence);
+typedef bool (*client_wait_fence_cb_t)(void *fence, uint64_t timeout);
+typedef void (*destroy_fence_cb_t)(void *fence);
+typedef void (*set_no_error_cb_t)(api_context_t api_context, bool no_error);
+typedef void * (*create_native_fence_cb_t)(api_context_t api_context);
+typedef int (*dup_native_fence_fd_cb_t)(void *fence);
+typedef bool (*export_texture_image_cb_t)(api_context_t api_context, uint32_t texture, EGLImageInterface *eglImage);
 
 typedef struct rendering_api_interface {
     api_state_t state;
@@ -79,6 +120,17 @@ typedef struct rendering_api_interface {
     flush_cb_t flush_cb;
     finish_cb_t finish_cb;
     bind_to_texture_cb_t bind_to_texture_cb;
+    submit_frame_cb_t submit_frame_cb;
+    set_damage_region_cb_t set_damage_region_cb;
+    create_fence_cb_t create_fence_cb;
+    server_wait_fence_cb_t server_wait_fence_cb;
+    client_wait_fence_cb_t client_wait_fence_cb;
+    destroy_fence_cb_t destroy_fence_cb;
+    set_no_error_cb_t set_no_error_cb;
+    /// fences exported as sync files, and textures exported as dma-bufs, null where not supported
+    create_native_fence_cb_t create_native_fence_cb;
+    dup_native_fence_fd_cb_t dup_native_fence_fd_cb;
+    export_texture_image_cb_t export_texture_image_cb;
 } rendering_api_interface_t;
 
 extern rendering_api_interface_t GLES2Interface;
@@ -93,21 +145,50 @@ extern "C" {
 #endif
 #endif
 
+#define GLOVE_MAX_SWAPCHAIN_IMAGES          8
+
+/// Set to 1 to run without a window system: no surface or swapchain extensions are needed, only pbuffers can be created
+#define GLOVE_HEADLESS_ENV                  "GLOVE_HEADLESS"
+
 typedef struct vkSyncItems_t {
+    /// semaphores of the frame being rendered, they belong to its swapchain image
     VkSemaphore                         vkAcquireSemaphore;
     bool                                acquireSemaphoreFlag;
     VkSemaphore                         vkDrawSemaphore;
     bool                                drawSemaphoreFlag;
+
+    /// the next image is acquired with the spare semaphore, which is then swapped with the one
+    /// of the acquired image, so that no semaphore is signaled again while a frame still waits on it
+    VkSemaphore                         vkSpareAcquireSemaphore;
+    VkSemaphore                         vkImageAcquireSemaphores[GLOVE_MAX_SWAPCHAIN_IMAGES];
+    VkSemaphore                         vkImageDrawSemaphores[GLOVE_MAX_SWAPCHAIN_IMAGES];
+
+    /// frames the CPU may record ahead of the GPU, set by the presentation policy of the window surface
+    uint32_t                            maxFramesInFlight;
 } vkSyncItems_t;
 
 typedef struct vkInterface {
     VkInstance                          vkInstance;
-    VkPhysicalDevice                    *vkGpus;
+    /// the GPU GLES runs on, chosen once among the enumerated ones
+    VkPhysicalDevice                    vkPhysicalDevice;
     VkQueue                             vkQueue;
     uint32_t                            vkGraphicsQueueNodeIndex;
     VkDevice                            vkDevice;
     VkPhysicalDeviceMemoryProperties    vkDeviceMemoryProperties;
     vkSyncItems_t                       *vkSyncItems;
+    bool                                isIncrementalPresentSupported;
+    /// frames can be given a present time, and the time they were presented at is read back (VK_GOOGLE_display_timing)
+    bool                                isDisplayTimingSupported;
+    /// the vblank of a display plane the frames are presented to directly can be waited for (VK_EXT_display_control)
+    bool                                isDisplayControlSupported;
+    /// client buffers EGLImages may be created from
+    bool                                isExternalMemoryDmaBufSupported;
+    bool                                isDrmFormatModifierSupported;
+    bool                                isAndroidHardwareBufferSupported;
+    /// fences can be exported as sync files (EGL_ANDROID_native_fence_sync)
+    bool                                isSyncFdFenceSupported;
+    /// locks or unlocks the queue, which client API contexts current to other threads submit to
+    void                                (*vkLockQueue)(bool lock);
 } vkInterface_t;
 
 #endif // __RENDERING_API_INTERFACE_H__
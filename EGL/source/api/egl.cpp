@@ -34,7 +34,7 @@
 #endif // DEBUG_DEPTH
 #define DEBUG_DEPTH                          EGL_LOG_INFO
 
-RenderingThread currentThread;
+thread_local RenderingThread currentThread;
 EGLGlobalResourceManager eglGlobalResourceManager;
 
 #define THREAD_EXEC_RETURN(func)             FUN_ENTRY(DEBUG_DEPTH);                                                      \
@@ -131,7 +131,9 @@ eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_context, con
     CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_NO_CONTEXT)
     CHECK_BAD_CONFIG(eglDriver, eglConfig, config, EGL_NO_CONTEXT)
     EGLContext_t* eglShareContext = static_cast<EGLContext_t*>(share_context);
-    // TODO::check for valid context
+    if(eglShareContext != nullptr && eglDriver->CheckBadContext(eglShareContext) == EGL_FALSE) {
+        return EGL_NO_CONTEXT;
+    }
     THREAD_EXEC_RETURN(CreateContext(eglDriver, eglConfig, eglShareContext, attrib_list));
 }
 
@@ -444,7 +446,10 @@ eglCreateImageKHR(EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffe
 
     CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_NO_IMAGE_KHR)
     CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_NO_IMAGE_KHR)
-    CHECK_BAD_CONTEXT(eglDriver, eglContext, ctx, EGL_NO_IMAGE_KHR)
+    // images of client buffers are created without a context, the ones of textures with theirs
+    if(ctx != EGL_NO_CONTEXT) {
+        CHECK_BAD_CONTEXT(eglDriver, eglContext, ctx, EGL_NO_IMAGE_KHR)
+    }
     return eglDriver->CreateImageKHR(ctx, target, buffer, attrib_list);
 }
 
@@ -458,7 +463,173 @@ eglDestroyImageKHR(EGLDisplay dpy, EGLImageKHR image)
     return eglDriver->DestroyImageKHR(image);
 }
 
-//TODO: Implement the KHR_fence_sync extension
+EGLBoolean EGLAPIENTRY
+eglQueryDmaBufFormatsEXT(EGLDisplay dpy, EGLint max_formats, EGLint *formats, EGLint *num_formats)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->QueryDmaBufFormats(max_formats, formats, num_formats);
+}
+
+EGLBoolean EGLAPIENTRY
+eglQueryDmaBufModifiersEXT(EGLDisplay dpy, EGLint format, EGLint max_modifiers, EGLuint64KHR *modifiers, EGLBoolean *external_only, EGLint *num_modifiers)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->QueryDmaBufModifiers(format, max_modifiers, modifiers, external_only, num_modifiers);
+}
+
+EGLBoolean EGLAPIENTRY
+eglExportDMABUFImageQueryMESA(EGLDisplay dpy, EGLImageKHR image, int *fourcc, int *num_planes, EGLuint64KHR *modifiers)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->ExportDMABUFImageQuery(image, fourcc, num_planes, modifiers);
+}
+
+EGLBoolean EGLAPIENTRY
+eglExportDMABUFImageMESA(EGLDisplay dpy, EGLImageKHR image, int *fds, EGLint *strides, EGLint *offsets)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->ExportDMABUFImage(image, fds, strides, offsets);
+}
+
+EGLBoolean EGLAPIENTRY
+eglSwapBuffersWithDamageKHR(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->SwapBuffersWithDamage(eglSurface, rects, n_rects);
+}
+
+EGLBoolean EGLAPIENTRY
+eglSwapBuffersWithDamageEXT(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    return eglSwapBuffersWithDamageKHR(dpy, surface, rects, n_rects);
+}
+
+EGLBoolean EGLAPIENTRY
+eglSetDamageRegionKHR(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->SetDamageRegion(eglSurface, rects, n_rects);
+}
+
+EGLBoolean EGLAPIENTRY
+eglGetSurfaceFrameGLOVE(EGLDisplay dpy, EGLSurface surface, const void **pixels, EGLint *stride)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->GetSurfaceFrame(eglSurface, pixels, stride);
+}
+
+EGLBoolean EGLAPIENTRY
+eglBeginSwapBatchGLOVE(EGLDisplay dpy)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->BeginSwapBatch();
+}
+
+EGLBoolean EGLAPIENTRY
+eglEndSwapBatchGLOVE(EGLDisplay dpy)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->EndSwapBatch();
+}
+
+EGLBoolean EGLAPIENTRY
+eglPresentationTimeANDROID(EGLDisplay dpy, EGLSurface surface, EGLnsecsANDROID time)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->PresentationTime(eglSurface, time);
+}
+
+EGLBoolean EGLAPIENTRY
+eglGetCompositorTimingSupportedANDROID(EGLDisplay dpy, EGLSurface surface, EGLint name)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->GetCompositorTimingSupported(eglSurface, name);
+}
+
+EGLBoolean EGLAPIENTRY
+eglGetCompositorTimingANDROID(EGLDisplay dpy, EGLSurface surface, EGLint numTimestamps, const EGLint *names, EGLnsecsANDROID *values)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->GetCompositorTiming(eglSurface, numTimestamps, names, values);
+}
+
+EGLBoolean EGLAPIENTRY
+eglGetNextFrameIdANDROID(EGLDisplay dpy, EGLSurface surface, EGLuint64KHR *frameId)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->GetNextFrameId(eglSurface, frameId);
+}
+
+EGLBoolean EGLAPIENTRY
+eglGetFrameTimestampSupportedANDROID(EGLDisplay dpy, EGLSurface surface, EGLint timestamp)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->GetFrameTimestampSupported(eglSurface, timestamp);
+}
+
+EGLBoolean EGLAPIENTRY
+eglGetFrameTimestampsANDROID(EGLDisplay dpy, EGLSurface surface, EGLuint64KHR frameId, EGLint numTimestamps, const EGLint *timestamps, EGLnsecsANDROID *values)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    CHECK_BAD_SURFACE(eglDriver, eglSurface, surface, EGL_FALSE)
+    return eglDriver->GetFrameTimestamps(eglSurface, frameId, numTimestamps, timestamps, values);
+}
+
 EGLSyncKHR EGLAPIENTRY
 eglCreateSyncKHR(EGLDisplay dpy, EGLenum type, const EGLint *attrib_list)
 {
@@ -488,3 +659,33 @@ eglClientWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR t
     CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
     return eglDriver->ClientWaitSyncKHR(sync, flags, timeout);
 }
+
+EGLBoolean EGLAPIENTRY
+eglGetSyncAttribKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint attribute, EGLint *value)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->GetSyncAttribKHR(sync, attribute, value);
+}
+
+EGLint EGLAPIENTRY
+eglDupNativeFenceFDANDROID(EGLDisplay dpy, EGLSyncKHR sync)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_NO_NATIVE_FENCE_FD_ANDROID)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_NO_NATIVE_FENCE_FD_ANDROID)
+    return eglDriver->DupNativeFenceFD(sync);
+}
+
+EGLint EGLAPIENTRY
+eglWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    CHECK_BAD_DISPLAY(eglDisplay, dpy, EGL_FALSE)
+    CHECK_UNINITIALIZED_DISPLAY(eglDriver, eglDisplay, EGL_FALSE)
+    return eglDriver->WaitSyncKHR(sync, flags);
+}
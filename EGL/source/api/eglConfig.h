@@ -212,9 +212,9 @@ EGLint CompareConfigs(const EGLConfig_t *conf1, const EGLConfig_t *conf2, const
 EGLBoolean FilterConfigArray(EGLConfig_t **configs, EGLint config_size, EGLint *num_config, const EGLConfig_t *criteria);
 
 #ifdef VK_USE_PLATFORM_ANDROID_KHR
-extern const EGLConfig_t EglConfigs[4];
+extern const EGLConfig_t EglConfigs[5];
 #else
-extern const EGLConfig_t EglConfigs[1];
+extern const EGLConfig_t EglConfigs[2];
 #endif
 
 #endif // __EGL_CONFIG_H__
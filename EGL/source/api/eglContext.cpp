@@ -33,7 +33,7 @@ EGLRefObject(),
 mAPIContext(nullptr), mRenderingAPI(rendering_api), mAPIInterface(nullptr),
 mDisplay(display), mReadSurface(nullptr), mDrawSurface(nullptr),
 mConfig(config), mAttribList(attribList), mClientVersion(1),
-mIsCurrent(false)
+mNoError(false), mIsCurrent(false)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 
@@ -84,7 +84,7 @@ EGLContext_t::GetAPIRenderableType()
 }
 
 EGLBoolean
-EGLContext_t::Validate()
+EGLContext_t::Validate(const EGLContext_t *shareContext)
 {
     FUN_ENTRY(EGL_LOG_DEBUG);
 
@@ -100,17 +100,23 @@ EGLContext_t::Validate()
         return EGL_FALSE;
     }
 
-    // TODO:: generate EGL_BAD_MATCH for incompatible share_contets
+    // objects are only shared between contexts of the same client API, version and error mode
+    if(shareContext != nullptr && (shareContext->GetRenderingAPI() != mRenderingAPI ||
+                                   shareContext->GetClientVersion() != mClientVersion ||
+                                   shareContext->IsNoError() != mNoError)) {
+        currentThread.RecordError(EGL_BAD_MATCH);
+        return EGL_FALSE;
+    }
 
     return EGL_TRUE;
 }
 
 EGLBoolean
-EGLContext_t::Create()
+EGLContext_t::Create(const EGLContext_t *shareContext)
 {
     FUN_ENTRY(EGL_LOG_DEBUG);
 
-    if(!Validate()) {
+    if(!Validate(shareContext)) {
         return EGL_FALSE;
     }
 
@@ -122,9 +128,16 @@ EGLContext_t::Create()
         return EGL_FALSE;
     }
 
-    mAPIContext = mAPIInterface->create_context_cb();
+    mAPIContext = mAPIInterface->create_context_cb(shareContext != nullptr ? shareContext->mAPIContext : nullptr);
+    if(mAPIContext == nullptr) {
+        return EGL_FALSE;
+    }
+
+    if(mNoError && mAPIInterface->set_no_error_cb != nullptr) {
+        mAPIInterface->set_no_error_cb(mAPIContext, true);
+    }
 
-    return mAPIContext != nullptr ? EGL_TRUE : EGL_FALSE;
+    return EGL_TRUE;
 }
 
 EGLBoolean
@@ -151,8 +164,8 @@ EGLContext_t::MakeCurrent(EGLDisplay_t *dpy, EGLSurface_t *draw, EGLSurface_t *r
     mDrawSurface = draw;
     mReadSurface = read;
 
-    // TODO: support pbuffers/pixmaps
-    if (draw && draw->GetType() != EGL_WINDOW_BIT) {
+    // TODO: support pixmaps
+    if (draw && draw->GetType() != EGL_WINDOW_BIT && draw->GetType() != EGL_PBUFFER_BIT) {
         return EGL_TRUE;
     }
 
@@ -189,6 +202,54 @@ EGLContext_t::Finish()
     mAPIInterface->finish_cb(mAPIContext);
 }
 
+void
+EGLContext_t::SubmitFrame()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    mAPIInterface->submit_frame_cb(mAPIContext);
+}
+
+void
+EGLContext_t::SetDamageRegion(const EGLint *rects, EGLint nRects)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    mAPIInterface->set_damage_region_cb(mAPIContext, rects, nRects);
+}
+
+void *
+EGLContext_t::CreateFence()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    return mAPIInterface->create_fence_cb(mAPIContext);
+}
+
+void *
+EGLContext_t::CreateNativeFence()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    return mAPIInterface->create_native_fence_cb != nullptr ? mAPIInterface->create_native_fence_cb(mAPIContext) : nullptr;
+}
+
+bool
+EGLContext_t::ExportTextureImage(uint32_t texture, EGLImageInterface *eglImage)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    return mAPIInterface->export_texture_image_cb != nullptr && mAPIInterface->export_texture_image_cb(mAPIContext, texture, eglImage);
+}
+
+void
+EGLContext_t::ServerWaitFence(void *fence)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    mAPIInterface->server_wait_fence_cb(mAPIContext, fence);
+}
+
 void
 EGLContext_t::BindToTexture(EGLint bind)
 {
@@ -212,6 +273,7 @@ EGLContext_t::ParseAttributeList(const EGLint* attrib_list)
 
     // EGL_BAD_ATTRIBUTE is also generated if
     // attribute is not EGL_CONTEXT_CLIENT_VERSION  with values 1 or 2
+    // or EGL_CONTEXT_OPENGL_NO_ERROR_KHR with values EGL_TRUE or EGL_FALSE
     for(int i = 0; attrib_list[i] != EGL_NONE; i++) {
         EGLint attr = attrib_list[i++];
         EGLint val = attrib_list[i];
@@ -220,6 +282,8 @@ EGLContext_t::ParseAttributeList(const EGLint* attrib_list)
            mClientVersion = EGL_GL_VERSION_1;
         } else if(attr == EGL_CONTEXT_CLIENT_VERSION && val == 2) {
             mClientVersion = EGL_GL_VERSION_2;
+        } else if(attr == EGL_CONTEXT_OPENGL_NO_ERROR_KHR && (val == EGL_TRUE || val == EGL_FALSE)) {
+            mNoError = val == EGL_TRUE;
         } else {
             currentThread.RecordError(EGL_BAD_ATTRIBUTE);
             return EGL_FALSE;
@@ -43,33 +43,43 @@ private:
     struct EGLConfig_t          *mConfig;
     const EGLint                *mAttribList;
     EGLenum                      mClientVersion;
+    /// created with EGL_CONTEXT_OPENGL_NO_ERROR_KHR, the client API skips its error checks
+    bool                         mNoError;
     bool                         mIsCurrent;
 
     EGLBoolean                   GetAPIRenderableType();
     EGLBoolean                   ParseAttributeList(const EGLint* attrib_list);
-    EGLBoolean                   Validate();
+    EGLBoolean                   Validate(const EGLContext_t *shareContext);
 
 public:
     EGLContext_t(struct EGLDisplay_t * display, EGLenum rendering_api, EGLConfig_t* config, const EGLint *attribList);
     ~EGLContext_t();
 
-    EGLBoolean                   Create();
+    EGLBoolean                   Create(const EGLContext_t *shareContext);
     EGLBoolean                   Destroy();
     EGLBoolean                   MakeCurrent(struct EGLDisplay_t *dpy, EGLSurface_t *draw, EGLSurface_t *read);
     //void                         SetNextImageIndex(uint32_t index);
     void                         Flush();
     void                         Finish();
+    void                         SubmitFrame();
     void                         BindToTexture(EGLint bind);
     void                         ReleaseSurfaceResources();
+    void                         SetDamageRegion(const EGLint *rects, EGLint nRects);
+    void                        *CreateFence();
+    void                        *CreateNativeFence();
+    void                         ServerWaitFence(void *fence);
+    bool                         ExportTextureImage(uint32_t texture, EGLImageInterface *eglImage);
 
     inline void                  SetNotCurrent()                                { FUN_ENTRY(EGL_LOG_TRACE); mIsCurrent = false; }
 
     inline EGLenum               GetRenderingAPI()                        const { FUN_ENTRY(EGL_LOG_TRACE); return mRenderingAPI; }
+    inline rendering_api_interface_t *GetAPIInterface()                   const { FUN_ENTRY(EGL_LOG_TRACE); return mAPIInterface; }
     inline EGLDisplay_t         *GetDisplay()                             const { FUN_ENTRY(EGL_LOG_TRACE); return mDisplay; }
     inline EGLSurface_t         *GetReadSurface()                         const { FUN_ENTRY(EGL_LOG_TRACE); return mReadSurface; }
     inline EGLSurface_t         *GetDrawSurface()                         const { FUN_ENTRY(EGL_LOG_TRACE); return mDrawSurface; }
     inline EGLint                GetConfigID()                            const { FUN_ENTRY(EGL_LOG_TRACE); return GetConfigKey(mConfig, EGL_CONFIG_ID); }
     inline EGLint                GetClientVersion()                       const { FUN_ENTRY(EGL_LOG_TRACE); return mClientVersion; }
+    inline bool                  IsNoError()                              const { FUN_ENTRY(EGL_LOG_TRACE); return mNoError; }
            EGLint                GetRenderBuffer()                        const;
     inline bool                  IsCurrent()                              const  { FUN_ENTRY(EGL_LOG_TRACE); return mIsCurrent; }
 
@@ -26,8 +26,69 @@
 #endif //  EGL_FUNC_PTR
 
 #include "EGL/egl.h"
+#include "EGL/eglext.h"
+#include <cstring>
 #include <string>
 #include <unordered_map>
+
+/// eglext.h declares the extension entry points only along with EGL_EGLEXT_PROTOTYPES
+extern "C" {
+#ifdef EGL_KHR_image
+EGLAPI EGLImageKHR EGLAPIENTRY eglCreateImageKHR(EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list);
+EGLAPI EGLBoolean EGLAPIENTRY eglDestroyImageKHR(EGLDisplay dpy, EGLImageKHR image);
+#endif /* EGL_KHR_image */
+#ifdef EGL_EXT_image_dma_buf_import_modifiers
+EGLAPI EGLBoolean EGLAPIENTRY eglQueryDmaBufFormatsEXT(EGLDisplay dpy, EGLint max_formats, EGLint *formats, EGLint *num_formats);
+EGLAPI EGLBoolean EGLAPIENTRY eglQueryDmaBufModifiersEXT(EGLDisplay dpy, EGLint format, EGLint max_modifiers, EGLuint64KHR *modifiers, EGLBoolean *external_only, EGLint *num_modifiers);
+#endif /* EGL_EXT_image_dma_buf_import_modifiers */
+#ifdef EGL_MESA_image_dma_buf_export
+EGLAPI EGLBoolean EGLAPIENTRY eglExportDMABUFImageQueryMESA(EGLDisplay dpy, EGLImageKHR image, int *fourcc, int *num_planes, EGLuint64KHR *modifiers);
+EGLAPI EGLBoolean EGLAPIENTRY eglExportDMABUFImageMESA(EGLDisplay dpy, EGLImageKHR image, int *fds, EGLint *strides, EGLint *offsets);
+#endif /* EGL_MESA_image_dma_buf_export */
+#ifdef EGL_KHR_fence_sync
+EGLAPI EGLSyncKHR EGLAPIENTRY eglCreateSyncKHR(EGLDisplay dpy, EGLenum type, const EGLint *attrib_list);
+EGLAPI EGLBoolean EGLAPIENTRY eglDestroySyncKHR(EGLDisplay dpy, EGLSyncKHR sync);
+EGLAPI EGLint EGLAPIENTRY eglClientWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout);
+EGLAPI EGLBoolean EGLAPIENTRY eglGetSyncAttribKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint attribute, EGLint *value);
+#endif /* EGL_KHR_fence_sync */
+#ifdef EGL_ANDROID_native_fence_sync
+EGLAPI EGLint EGLAPIENTRY eglDupNativeFenceFDANDROID(EGLDisplay dpy, EGLSyncKHR sync);
+#endif /* EGL_ANDROID_native_fence_sync */
+#ifdef EGL_KHR_partial_update
+EGLAPI EGLBoolean EGLAPIENTRY eglSetDamageRegionKHR(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects);
+#endif /* EGL_KHR_partial_update */
+#ifdef EGL_KHR_swap_buffers_with_damage
+EGLAPI EGLBoolean EGLAPIENTRY eglSwapBuffersWithDamageKHR(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects);
+#endif /* EGL_KHR_swap_buffers_with_damage */
+#ifdef EGL_EXT_swap_buffers_with_damage
+EGLAPI EGLBoolean EGLAPIENTRY eglSwapBuffersWithDamageEXT(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects);
+#endif /* EGL_EXT_swap_buffers_with_damage */
+#ifdef EGL_KHR_wait_sync
+EGLAPI EGLint EGLAPIENTRY eglWaitSyncKHR(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags);
+#endif /* EGL_KHR_wait_sync */
+#ifdef EGL_ANDROID_presentation_time
+EGLAPI EGLBoolean EGLAPIENTRY eglPresentationTimeANDROID(EGLDisplay dpy, EGLSurface surface, EGLnsecsANDROID time);
+#endif /* EGL_ANDROID_presentation_time */
+#ifdef EGL_ANDROID_get_frame_timestamps
+EGLAPI EGLBoolean EGLAPIENTRY eglGetCompositorTimingSupportedANDROID(EGLDisplay dpy, EGLSurface surface, EGLint name);
+EGLAPI EGLBoolean EGLAPIENTRY eglGetCompositorTimingANDROID(EGLDisplay dpy, EGLSurface surface, EGLint numTimestamps, const EGLint *names, EGLnsecsANDROID *values);
+EGLAPI EGLBoolean EGLAPIENTRY eglGetNextFrameIdANDROID(EGLDisplay dpy, EGLSurface surface, EGLuint64KHR *frameId);
+EGLAPI EGLBoolean EGLAPIENTRY eglGetFrameTimestampSupportedANDROID(EGLDisplay dpy, EGLSurface surface, EGLint timestamp);
+EGLAPI EGLBoolean EGLAPIENTRY eglGetFrameTimestampsANDROID(EGLDisplay dpy, EGLSurface surface, EGLuint64KHR frameId, EGLint numTimestamps, const EGLint *timestamps, EGLnsecsANDROID *values);
+#endif /* EGL_ANDROID_get_frame_timestamps */
+#ifndef EGL_GLOVE_pbuffer_readback
+#define EGL_GLOVE_pbuffer_readback 1
+/* the pixels of the frame swapped last on a pbuffer streamed to the host (GLOVE_PBUFFER_READBACK), rows bottom-up */
+EGLAPI EGLBoolean EGLAPIENTRY eglGetSurfaceFrameGLOVE(EGLDisplay dpy, EGLSurface surface, const void **pixels, EGLint *stride);
+#endif /* EGL_GLOVE_pbuffer_readback */
+#ifndef EGL_GLOVE_swap_batch
+#define EGL_GLOVE_swap_batch 1
+/* the window surfaces swapped between the two calls, from one thread, are presented together when the batch ends
+   and acquire their next images then, a surface is not rendered to again before */
+EGLAPI EGLBoolean EGLAPIENTRY eglBeginSwapBatchGLOVE(EGLDisplay dpy);
+EGLAPI EGLBoolean EGLAPIENTRY eglEndSwapBatchGLOVE(EGLDisplay dpy);
+#endif /* EGL_GLOVE_swap_batch */
+}
 static const std::unordered_map<std::string, __eglMustCastToProperFunctionPointerType> eglFPMap = {
 #ifdef EGL_VERSION_1_0
 EGL_FUNC_PTR(eglChooseConfig),
@@ -71,8 +132,58 @@ EGL_FUNC_PTR(eglWaitClient),
 #ifdef EGL_VERSION_1_3
 #endif /* EGL_VERSION_1_3 */
 #ifdef EGL_VERSION_1_4
-EGL_FUNC_PTR(eglGetCurrentContext)
+EGL_FUNC_PTR(eglGetCurrentContext),
 #endif /* EGL_VERSION_1_4 */
+#ifdef EGL_KHR_image
+EGL_FUNC_PTR(eglCreateImageKHR),
+EGL_FUNC_PTR(eglDestroyImageKHR),
+#endif /* EGL_KHR_image */
+#ifdef EGL_EXT_image_dma_buf_import_modifiers
+EGL_FUNC_PTR(eglQueryDmaBufFormatsEXT),
+EGL_FUNC_PTR(eglQueryDmaBufModifiersEXT),
+#endif /* EGL_EXT_image_dma_buf_import_modifiers */
+#ifdef EGL_MESA_image_dma_buf_export
+EGL_FUNC_PTR(eglExportDMABUFImageQueryMESA),
+EGL_FUNC_PTR(eglExportDMABUFImageMESA),
+#endif /* EGL_MESA_image_dma_buf_export */
+#ifdef EGL_KHR_fence_sync
+EGL_FUNC_PTR(eglCreateSyncKHR),
+EGL_FUNC_PTR(eglDestroySyncKHR),
+EGL_FUNC_PTR(eglClientWaitSyncKHR),
+EGL_FUNC_PTR(eglGetSyncAttribKHR),
+#endif /* EGL_KHR_fence_sync */
+#ifdef EGL_ANDROID_native_fence_sync
+EGL_FUNC_PTR(eglDupNativeFenceFDANDROID),
+#endif /* EGL_ANDROID_native_fence_sync */
+#ifdef EGL_KHR_partial_update
+EGL_FUNC_PTR(eglSetDamageRegionKHR),
+#endif /* EGL_KHR_partial_update */
+#ifdef EGL_KHR_swap_buffers_with_damage
+EGL_FUNC_PTR(eglSwapBuffersWithDamageKHR),
+#endif /* EGL_KHR_swap_buffers_with_damage */
+#ifdef EGL_EXT_swap_buffers_with_damage
+EGL_FUNC_PTR(eglSwapBuffersWithDamageEXT),
+#endif /* EGL_EXT_swap_buffers_with_damage */
+#ifdef EGL_KHR_wait_sync
+EGL_FUNC_PTR(eglWaitSyncKHR),
+#endif /* EGL_KHR_wait_sync */
+#ifdef EGL_ANDROID_presentation_time
+EGL_FUNC_PTR(eglPresentationTimeANDROID),
+#endif /* EGL_ANDROID_presentation_time */
+#ifdef EGL_ANDROID_get_frame_timestamps
+EGL_FUNC_PTR(eglGetCompositorTimingSupportedANDROID),
+EGL_FUNC_PTR(eglGetCompositorTimingANDROID),
+EGL_FUNC_PTR(eglGetNextFrameIdANDROID),
+EGL_FUNC_PTR(eglGetFrameTimestampSupportedANDROID),
+EGL_FUNC_PTR(eglGetFrameTimestampsANDROID),
+#endif /* EGL_ANDROID_get_frame_timestamps */
+#ifdef EGL_GLOVE_pbuffer_readback
+EGL_FUNC_PTR(eglGetSurfaceFrameGLOVE),
+#endif /* EGL_GLOVE_pbuffer_readback */
+#ifdef EGL_GLOVE_swap_batch
+EGL_FUNC_PTR(eglBeginSwapBatchGLOVE),
+EGL_FUNC_PTR(eglEndSwapBatchGLOVE),
+#endif /* EGL_GLOVE_swap_batch */
 };
 #undef EGL_FUNC_PTR
 
@@ -0,0 +1,440 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       eglImage.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      EGL Image Object. It holds a client buffer, whose memory the client API imports without a copy,
+ *              or a texture of the client API, whose memory it exports as a dma-buf
+ *
+ *  @section
+ *
+ *  dma-bufs are described by the attributes of EGL_EXT_image_dma_buf_import(_modifiers)
+ *  and keep duplicates of the descriptors of their planes, so that the application may
+ *  close its own right after the image is created. Android native buffers keep a
+ *  reference to the buffer instead. Only RGB formats are accepted, as sampling YUV
+ *  buffers requires conversions the client API does not set up.
+ *
+ *  Textures are moved into linear memory allocated for export, which they keep
+ *  from then on, and are handed out as dma-bufs of a single plane, so that video
+ *  encoders and other devices read the frames rendered into them without copies.
+ *
+ */
+
+#include <cstring>
+#ifndef WIN32
+#include <unistd.h>
+#endif // WIN32
+#include "utils/egl_defs.h"
+#include "eglImage.h"
+#include "eglContext.h"
+
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+#include "system/window.h"
+#endif // VK_USE_PLATFORM_ANDROID_KHR
+
+typedef struct drmFormat_t {
+    uint32_t                         fourcc;
+    VkFormat                         vkFormat;
+} drmFormat_t;
+
+/// DRM formats are little endian words, so ABGR8888 has its bytes in the order of R8G8B8A8
+static const drmFormat_t drmFormats[] = {
+    { GLOVE_DRM_FOURCC('A', 'B', '2', '4'), VK_FORMAT_R8G8B8A8_UNORM       },
+    { GLOVE_DRM_FOURCC('A', 'R', '2', '4'), VK_FORMAT_B8G8R8A8_UNORM       },
+    { GLOVE_DRM_FOURCC('R', 'G', '1', '6'), VK_FORMAT_R5G6B5_UNORM_PACK16  }
+};
+
+static const EGLint planeFdAttribs[GLOVE_MAX_EGL_IMAGE_PLANES]         = { EGL_DMA_BUF_PLANE0_FD_EXT,          EGL_DMA_BUF_PLANE1_FD_EXT,
+                                                                           EGL_DMA_BUF_PLANE2_FD_EXT,          EGL_DMA_BUF_PLANE3_FD_EXT };
+static const EGLint planeOffsetAttribs[GLOVE_MAX_EGL_IMAGE_PLANES]     = { EGL_DMA_BUF_PLANE0_OFFSET_EXT,      EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+                                                                           EGL_DMA_BUF_PLANE2_OFFSET_EXT,      EGL_DMA_BUF_PLANE3_OFFSET_EXT };
+static const EGLint planePitchAttribs[GLOVE_MAX_EGL_IMAGE_PLANES]      = { EGL_DMA_BUF_PLANE0_PITCH_EXT,       EGL_DMA_BUF_PLANE1_PITCH_EXT,
+                                                                           EGL_DMA_BUF_PLANE2_PITCH_EXT,       EGL_DMA_BUF_PLANE3_PITCH_EXT };
+static const EGLint planeModifierLoAttribs[GLOVE_MAX_EGL_IMAGE_PLANES] = { EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+                                                                           EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT };
+static const EGLint planeModifierHiAttribs[GLOVE_MAX_EGL_IMAGE_PLANES] = { EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT,
+                                                                           EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT };
+
+EGLImage_t::EGLImage_t()
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    memset(static_cast<EGLImageInterface *>(this), 0, sizeof(EGLImageInterface));
+    for(uint32_t i = 0; i < GLOVE_MAX_EGL_IMAGE_PLANES; ++i) {
+        fds[i] = -1;
+    }
+    vkFormat = VK_FORMAT_UNDEFINED;
+}
+
+EGLImage_t::~EGLImage_t()
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+#ifndef WIN32
+    for(uint32_t i = 0; i < GLOVE_MAX_EGL_IMAGE_PLANES; ++i) {
+        if(fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+#endif // WIN32
+
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    if(hardwareBuffer) {
+        ANativeWindowBuffer *nativeBuffer = static_cast<ANativeWindowBuffer *>(hardwareBuffer);
+        nativeBuffer->common.decRef(&nativeBuffer->common);
+    }
+#endif // VK_USE_PLATFORM_ANDROID_KHR
+}
+
+VkFormat
+EGLImage_t::DrmFourccToVkFormat(EGLint fourcc)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    for(const drmFormat_t &format : drmFormats) {
+        if(format.fourcc == static_cast<uint32_t>(fourcc)) {
+            return format.vkFormat;
+        }
+    }
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+uint32_t
+EGLImage_t::VkFormatToDrmFourcc(VkFormat format)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    for(const drmFormat_t &drmFormat : drmFormats) {
+        if(drmFormat.vkFormat == format) {
+            return drmFormat.fourcc;
+        }
+    }
+
+    return 0;
+}
+
+EGLint
+EGLImage_t::GetDmaBufFormats(EGLint maxFormats, EGLint *formats)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    const EGLint formatCount = static_cast<EGLint>(sizeof(drmFormats) / sizeof(drmFormats[0]));
+    if(!maxFormats) {
+        return formatCount;
+    }
+
+    EGLint count = 0;
+    for(; count < formatCount && count < maxFormats; ++count) {
+        formats[count] = static_cast<EGLint>(drmFormats[count].fourcc);
+    }
+
+    return count;
+}
+
+void
+EGLImage_t::GetDmaBufModifiers(EGLint fourcc, const vkInterface_t *vkInterface, std::vector<uint64_t> *modifiers)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    modifiers->clear();
+
+#ifdef VK_EXT_image_drm_format_modifier
+    // the device lists the tilings it samples the format with
+    PFN_vkGetPhysicalDeviceFormatProperties2KHR getFormatProperties2 = vkInterface->isDrmFormatModifierSupported ?
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFormatProperties2KHR>(vkGetInstanceProcAddr(vkInterface->vkInstance, "vkGetPhysicalDeviceFormatProperties2KHR")) : nullptr;
+    if(getFormatProperties2 != nullptr) {
+        VkDrmFormatModifierPropertiesListEXT modifierList;
+        memset(static_cast<void *>(&modifierList), 0, sizeof(modifierList));
+        modifierList.sType = VK_STRUCTURE_TYPE_DRM_FORMAT_MODIFIER_PROPERTIES_LIST_EXT;
+
+        VkFormatProperties2KHR properties;
+        memset(static_cast<void *>(&properties), 0, sizeof(properties));
+        properties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2_KHR;
+        properties.pNext = &modifierList;
+
+        const VkFormat format = DrmFourccToVkFormat(fourcc);
+        getFormatProperties2(vkInterface->vkPhysicalDevice, format, &properties);
+
+        std::vector<VkDrmFormatModifierPropertiesEXT> modifierProperties(modifierList.drmFormatModifierCount);
+        modifierList.pDrmFormatModifierProperties = modifierProperties.data();
+        getFormatProperties2(vkInterface->vkPhysicalDevice, format, &properties);
+
+        for(uint32_t i = 0; i < modifierList.drmFormatModifierCount; ++i) {
+            if(modifierProperties[i].drmFormatModifierTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) {
+                modifiers->push_back(modifierProperties[i].drmFormatModifier);
+            }
+        }
+        return;
+    }
+#endif // VK_EXT_image_drm_format_modifier
+
+    // otherwise buffers are imported as linear images
+    modifiers->push_back(GLOVE_DRM_FORMAT_MOD_LINEAR);
+}
+
+EGLint
+EGLImage_t::InitDmaBuf(const EGLint *attribList, const vkInterface_t *vkInterface)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+#ifndef WIN32
+    if(vkInterface == nullptr || !vkInterface->isExternalMemoryDmaBufSupported) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    source = EGL_IMAGE_SOURCE_DMA_BUF;
+
+    EGLint   planeFds[GLOVE_MAX_EGL_IMAGE_PLANES]     = { -1, -1, -1, -1 };
+    bool     planeOffsetSet[GLOVE_MAX_EGL_IMAGE_PLANES] = { false };
+    bool     planePitchSet[GLOVE_MAX_EGL_IMAGE_PLANES]  = { false };
+    uint32_t modifierLoSet = 0;
+    uint32_t modifierHiSet = 0;
+    uint64_t modifiers[GLOVE_MAX_EGL_IMAGE_PLANES]    = { 0 };
+    bool     widthSet  = false;
+    bool     heightSet = false;
+    bool     fourccSet = false;
+
+    for(const EGLint *attrib = attribList; attrib != nullptr && attrib[0] != EGL_NONE; attrib += 2) {
+        const EGLint value = attrib[1];
+
+        switch(attrib[0]) {
+        case EGL_WIDTH:                 width  = static_cast<uint32_t>(value); widthSet  = value > 0; continue;
+        case EGL_HEIGHT:                height = static_cast<uint32_t>(value); heightSet = value > 0; continue;
+        case EGL_LINUX_DRM_FOURCC_EXT:  fourcc = static_cast<uint32_t>(value); fourccSet = true;      continue;
+        // the hints only apply to YUV formats, which are rejected below
+        case EGL_YUV_COLOR_SPACE_HINT_EXT:
+        case EGL_SAMPLE_RANGE_HINT_EXT:
+        case EGL_YUV_CHROMA_HORIZONTAL_SITING_HINT_EXT:
+        case EGL_YUV_CHROMA_VERTICAL_SITING_HINT_EXT:
+        case EGL_IMAGE_PRESERVED_KHR:   continue;
+        default:                        break;
+        }
+
+        bool found = false;
+        for(uint32_t plane = 0; plane < GLOVE_MAX_EGL_IMAGE_PLANES && !found; ++plane) {
+            found = true;
+            if(attrib[0] == planeFdAttribs[plane]) {
+                planeFds[plane] = value;
+            } else if(attrib[0] == planeOffsetAttribs[plane]) {
+                offsets[plane] = static_cast<uint32_t>(value);
+                planeOffsetSet[plane] = true;
+            } else if(attrib[0] == planePitchAttribs[plane]) {
+                pitches[plane] = static_cast<uint32_t>(value);
+                planePitchSet[plane] = true;
+            } else if(attrib[0] == planeModifierLoAttribs[plane]) {
+                modifiers[plane] |= static_cast<uint64_t>(static_cast<uint32_t>(value));
+                modifierLoSet    |= 1u << plane;
+            } else if(attrib[0] == planeModifierHiAttribs[plane]) {
+                modifiers[plane] |= static_cast<uint64_t>(static_cast<uint32_t>(value)) << 32;
+                modifierHiSet    |= 1u << plane;
+            } else {
+                found = false;
+            }
+        }
+
+        if(!found) {
+            return EGL_BAD_ATTRIBUTE;
+        }
+    }
+
+    if(!widthSet || !heightSet || !fourccSet || planeFds[0] < 0 || !planeOffsetSet[0] || !planePitchSet[0]) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    vkFormat = DrmFourccToVkFormat(static_cast<EGLint>(fourcc));
+    if(vkFormat == VK_FORMAT_UNDEFINED) {
+        return EGL_BAD_MATCH;
+    }
+
+    // the planes are specified in order, each one completely
+    planeCount = 0;
+    while(planeCount < GLOVE_MAX_EGL_IMAGE_PLANES && planeFds[planeCount] >= 0) {
+        if(!planeOffsetSet[planeCount] || !planePitchSet[planeCount]) {
+            return EGL_BAD_PARAMETER;
+        }
+        ++planeCount;
+    }
+    for(uint32_t plane = planeCount; plane < GLOVE_MAX_EGL_IMAGE_PLANES; ++plane) {
+        if(planeFds[plane] >= 0) {
+            return EGL_BAD_ATTRIBUTE;
+        }
+    }
+
+    // a modifier is given in both halves, the same one for every plane
+    if(modifierLoSet != modifierHiSet || (modifierLoSet && modifierLoSet != (1u << planeCount) - 1)) {
+        return EGL_BAD_PARAMETER;
+    }
+    hasModifier = modifierLoSet != 0;
+    modifier    = modifiers[0];
+    for(uint32_t plane = 1; plane < planeCount; ++plane) {
+        if(modifiers[plane] != modifier) {
+            return EGL_BAD_PARAMETER;
+        }
+    }
+
+    // only explicit modifiers describe the auxiliary planes of a single plane format
+    if(!vkInterface->isDrmFormatModifierSupported &&
+       ((hasModifier && modifier != GLOVE_DRM_FORMAT_MOD_LINEAR) || planeCount != 1)) {
+        return EGL_BAD_MATCH;
+    }
+
+    for(uint32_t plane = 0; plane < planeCount; ++plane) {
+        fds[plane] = dup(planeFds[plane]);
+        if(fds[plane] < 0) {
+            return EGL_BAD_ALLOC;
+        }
+    }
+
+    return EGL_SUCCESS;
+#else
+    return EGL_BAD_PARAMETER;
+#endif // WIN32
+}
+
+EGLint
+EGLImage_t::InitNativeBuffer(EGLClientBuffer buffer, const vkInterface_t *vkInterface)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    if(vkInterface == nullptr || !vkInterface->isAndroidHardwareBufferSupported) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    ANativeWindowBuffer *nativeBuffer = static_cast<ANativeWindowBuffer *>(buffer);
+    if(nativeBuffer == nullptr ||
+       nativeBuffer->common.magic   != ANDROID_NATIVE_BUFFER_MAGIC ||
+       nativeBuffer->common.version != sizeof(ANativeWindowBuffer)) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    switch(nativeBuffer->format) {
+    case HAL_PIXEL_FORMAT_RGBA_8888:
+    case HAL_PIXEL_FORMAT_RGBX_8888:    vkFormat = VK_FORMAT_R8G8B8A8_UNORM;      break;
+    case HAL_PIXEL_FORMAT_RGB_565:      vkFormat = VK_FORMAT_R5G6B5_UNORM_PACK16; break;
+    default:                            return EGL_BAD_PARAMETER;
+    }
+
+    source     = EGL_IMAGE_SOURCE_ANDROID_HARDWARE_BUFFER;
+    width      = static_cast<uint32_t>(nativeBuffer->width);
+    height     = static_cast<uint32_t>(nativeBuffer->height);
+    planeCount = 1;
+
+    // native buffers are GraphicBuffers, whose address is also the one of their AHardwareBuffer
+    nativeBuffer->common.incRef(&nativeBuffer->common);
+    hardwareBuffer = nativeBuffer;
+
+    return EGL_SUCCESS;
+#else
+    (void)buffer;
+    (void)vkInterface;
+
+    return EGL_BAD_PARAMETER;
+#endif // VK_USE_PLATFORM_ANDROID_KHR
+}
+
+EGLint
+EGLImage_t::InitGLTexture(EGLContext_t *eglContext, EGLClientBuffer buffer, const EGLint *attribList)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    // only the base level is exported
+    for(const EGLint *attrib = attribList; attrib != nullptr && attrib[0] != EGL_NONE; attrib += 2) {
+        switch(attrib[0]) {
+        case EGL_GL_TEXTURE_LEVEL_KHR:  if(attrib[1] != 0) { return EGL_BAD_MATCH; } break;
+        case EGL_IMAGE_PRESERVED_KHR:   break;
+        default:                        return EGL_BAD_ATTRIBUTE;
+        }
+    }
+
+    const uint32_t texture = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(buffer));
+    if(!texture || !eglContext->ExportTextureImage(texture, this)) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    // the image is then a dma-buf like any imported one, and is queried and imported as such
+    fourcc = VkFormatToDrmFourcc(vkFormat);
+
+    return fourcc ? EGL_SUCCESS : EGL_BAD_MATCH;
+}
+
+EGLint
+EGLImage_t::QueryDmaBufExport(int *fourccOut, int *numPlanes, EGLuint64KHR *modifiers) const
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    if(source != EGL_IMAGE_SOURCE_DMA_BUF) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    if(fourccOut != nullptr) {
+        *fourccOut = static_cast<int>(fourcc);
+    }
+    if(numPlanes != nullptr) {
+        *numPlanes = static_cast<int>(planeCount);
+    }
+    if(modifiers != nullptr) {
+        for(uint32_t plane = 0; plane < planeCount; ++plane) {
+            modifiers[plane] = hasModifier ? modifier : GLOVE_DRM_FORMAT_MOD_INVALID;
+        }
+    }
+
+    return EGL_SUCCESS;
+}
+
+EGLint
+EGLImage_t::ExportDmaBuf(int *fdsOut, EGLint *strides, EGLint *offsetsOut) const
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+#ifndef WIN32
+    if(source != EGL_IMAGE_SOURCE_DMA_BUF) {
+        return EGL_BAD_PARAMETER;
+    }
+
+    // the image keeps its own descriptors, for as long as it lives
+    if(fdsOut != nullptr) {
+        for(uint32_t plane = 0; plane < planeCount; ++plane) {
+            fdsOut[plane] = dup(fds[plane]);
+            if(fdsOut[plane] < 0) {
+                for(uint32_t i = 0; i < plane; ++i) {
+                    close(fdsOut[i]);
+                    fdsOut[i] = -1;
+                }
+                return EGL_BAD_ALLOC;
+            }
+        }
+    }
+    for(uint32_t plane = 0; plane < planeCount; ++plane) {
+        if(strides != nullptr) {
+            strides[plane] = static_cast<EGLint>(pitches[plane]);
+        }
+        if(offsetsOut != nullptr) {
+            offsetsOut[plane] = static_cast<EGLint>(offsets[plane]);
+        }
+    }
+
+    return EGL_SUCCESS;
+#else
+    (void)fdsOut;
+    (void)strides;
+    (void)offsetsOut;
+
+    return EGL_BAD_PARAMETER;
+#endif // WIN32
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       eglImage.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      EGL Image Object. It holds a client buffer, whose memory the client API imports without a copy
+ *
+ */
+
+#ifndef __EGL_IMAGE_H__
+#define __EGL_IMAGE_H__
+
+#include <vector>
+#include "EGL/egl.h"
+#include "EGL/eglext.h"
+#include "rendering_api_interface.h"
+#include "utils/eglLogger.h"
+
+/// DRM_FORMAT_MOD_INVALID, reported for buffers imported without a modifier
+#define GLOVE_DRM_FORMAT_MOD_INVALID     0x00ffffffffffffffull
+
+#define GLOVE_DRM_FOURCC(a, b, c, d)     (static_cast<uint32_t>(a)       | (static_cast<uint32_t>(b) << 8) | \
+                                          (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24))
+
+class EGLContext_t;
+
+class EGLImage_t : public EGLImageInterface
+{
+public:
+    EGLImage_t();
+    ~EGLImage_t();
+
+    /// return EGL_SUCCESS, or the error the creation of the image fails with
+    EGLint                           InitDmaBuf(const EGLint *attribList, const vkInterface_t *vkInterface);
+    EGLint                           InitNativeBuffer(EGLClientBuffer buffer, const vkInterface_t *vkInterface);
+    /// the texture of the context, current to the calling thread, is moved to memory the image exports as a dma-buf
+    EGLint                           InitGLTexture(EGLContext_t *eglContext, EGLClientBuffer buffer, const EGLint *attribList);
+
+    /// describe a dma-buf image to another API or process, the descriptors are new ones owned by the caller
+    EGLint                           QueryDmaBufExport(int *fourccOut, int *numPlanes, EGLuint64KHR *modifiers) const;
+    EGLint                           ExportDmaBuf(int *fdsOut, EGLint *strides, EGLint *offsetsOut) const;
+
+    static VkFormat                  DrmFourccToVkFormat(EGLint fourcc);
+    static uint32_t                  VkFormatToDrmFourcc(VkFormat format);
+    static EGLint                    GetDmaBufFormats(EGLint maxFormats, EGLint *formats);
+    static void                      GetDmaBufModifiers(EGLint fourcc, const vkInterface_t *vkInterface, std::vector<uint64_t> *modifiers);
+};
+
+#endif // __EGL_IMAGE_H__
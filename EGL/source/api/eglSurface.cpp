@@ -29,21 +29,26 @@
 EGLSurface_t::EGLSurface_t():
 EGLRefObject (),
 Config(nullptr), Type(0), Width(0), Height(0),
-DepthSize(0), StencilSize(0), RedSize(0), GreenSize(0), BlueSize(0), AlphaSize(0),
+DepthSize(0), StencilSize(0), Samples(0), RedSize(0), GreenSize(0), BlueSize(0), AlphaSize(0),
 TextureFormat(0), TextureTarget(0), MipmapTexture(EGL_FALSE),
 LargestPbuffer(EGL_FALSE), RenderBuffer(0), VGAlphaFormat(0), VGColorspace(0),
 MipmapLevel(0), MultisampleResolve(0), SwapBehavior(0), HorizontalResolution(0),
 VerticalResolution(0), AspectRatio(0), SwapInterval(1), BindToTexture(EGL_FALSE), PostSubBufferSupportedNV(0),
-CurrentImageIndex(0), mPlatformResources(nullptr)
+CurrentImageIndex(0), PreTransform(0), SwapCount(0), BufferAgeQueried(EGL_FALSE), DamageRegionSet(EGL_FALSE),
+PresentationTime(0), TimestampsEnabled(EGL_FALSE), RefreshDuration(0),
+ReadbackAPIInterface(nullptr), ReadbackImageIndex(-1), mPlatformResources(nullptr)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 
     memset(&SurfaceInterface, 0, sizeof(SurfaceInterface));
+    memset(FrameTimestamps, 0, sizeof(FrameTimestamps));
 }
 
 EGLSurface_t::~EGLSurface_t()
 {
     FUN_ENTRY(EGL_LOG_TRACE);
+
+    ResetReadbackFences(0);
 }
 
 /**
@@ -242,6 +247,7 @@ EGLSurface_t::InitSurface(EGLint type, EGLConfig_t *conf, const EGLint *attrib_l
     AlphaSize         = GetConfigKey(conf, EGL_ALPHA_SIZE);
     DepthSize         = GetConfigKey(conf, EGL_DEPTH_SIZE);
     StencilSize       = GetConfigKey(conf, EGL_STENCIL_SIZE);
+    Samples           = GetConfigKey(conf, EGL_SAMPLES);
     BindToTextureRGB  = GetConfigKey(conf, EGL_BIND_TO_TEXTURE_RGB);
     BindToTextureRGBA = GetConfigKey(conf, EGL_BIND_TO_TEXTURE_RGBA);
 
@@ -347,6 +353,13 @@ EGLSurface_t::QuerySurface(EGLint attribute, EGLint *value)
     case EGL_VG_COLORSPACE:
         *value = VGColorspace;
         break;
+    case EGL_BUFFER_AGE_EXT:
+        *value = GetBufferAge();
+        BufferAgeQueried = EGL_TRUE;
+        break;
+    case EGL_TIMESTAMPS_ANDROID:
+        *value = TimestampsEnabled;
+        break;
     default:
         return EGL_FALSE;
     }
@@ -374,6 +387,122 @@ EGLSurface_t::ClampSwapInterval(EGLint interval)
     SwapInterval           = clampedInterval;
 }
 
+void
+EGLSurface_t::ResetBufferAges(uint32_t imageCount)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    /// images of a new swapchain hold nothing that was presented
+    ImageSwaps.assign(imageCount, 0);
+}
+
+void
+EGLSurface_t::EndFrame()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    ++SwapCount;
+    if(CurrentImageIndex >= 0 && static_cast<size_t>(CurrentImageIndex) < ImageSwaps.size()) {
+        ImageSwaps[CurrentImageIndex] = SwapCount;
+    }
+
+    BufferAgeQueried = EGL_FALSE;
+    DamageRegionSet  = EGL_FALSE;
+    PresentationTime = 0;
+}
+
+void
+EGLSurface_t::RecordFrame(uint64_t frameId, EGLnsecsANDROID requestedPresentTime)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    FrameTimestamps_t *frame    = &FrameTimestamps[frameId % EGL_GLOVE_FRAME_TIMESTAMPS_HISTORY];
+    frame->frameId              = frameId;
+    frame->requestedPresentTime = requestedPresentTime;
+    frame->displayPresentTime   = EGL_TIMESTAMP_PENDING_ANDROID;
+}
+
+FrameTimestamps_t *
+EGLSurface_t::GetFrameTimestamps(uint64_t frameId)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    // frame 0 is never presented, so that the empty slots match no frame
+    FrameTimestamps_t *frame = &FrameTimestamps[frameId % EGL_GLOVE_FRAME_TIMESTAMPS_HISTORY];
+    return (frameId != 0 && frame->frameId == frameId) ? frame : nullptr;
+}
+
+void
+EGLSurface_t::ResetReadbackFences(uint32_t imageCount)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    for(void *fence : ReadbackFences) {
+        if(fence != nullptr) {
+            ReadbackAPIInterface->destroy_fence_cb(fence);
+        }
+    }
+
+    ReadbackFences.assign(imageCount, nullptr);
+    ReadbackImageIndex = -1;
+}
+
+void
+EGLSurface_t::SetReadbackFence(rendering_api_interface_t *apiInterface, void *fence)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(CurrentImageIndex < 0 || static_cast<size_t>(CurrentImageIndex) >= ReadbackFences.size()) {
+        if(fence != nullptr) {
+            apiInterface->destroy_fence_cb(fence);
+        }
+        return;
+    }
+
+    /// the fence of the frame the image held before is signaled by now, or it is about to be
+    void *&imageFence = ReadbackFences[CurrentImageIndex];
+    if(imageFence != nullptr) {
+        ReadbackAPIInterface->destroy_fence_cb(imageFence);
+    }
+
+    ReadbackAPIInterface = apiInterface;
+    imageFence           = fence;
+    ReadbackImageIndex   = CurrentImageIndex;
+}
+
+EGLBoolean
+EGLSurface_t::WaitReadbackFence()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(ReadbackImageIndex < 0) {
+        return EGL_FALSE;
+    }
+
+    /// without a fence the frame has been finished before the swap returned
+    void *fence = ReadbackFences[ReadbackImageIndex];
+    if(fence == nullptr) {
+        return EGL_TRUE;
+    }
+
+    return ReadbackAPIInterface->client_wait_fence_cb(fence, EGL_FENCE_WAIT_TIMEOUT) ? EGL_TRUE : EGL_FALSE;
+}
+
+EGLint
+EGLSurface_t::GetBufferAge() const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    /// the multisampled color is not kept across frames, only its resolve is presented
+    if(Type != EGL_WINDOW_BIT || Samples > 1 ||
+       CurrentImageIndex < 0 || static_cast<size_t>(CurrentImageIndex) >= ImageSwaps.size() ||
+       ImageSwaps[CurrentImageIndex] == 0) {
+        return 0;
+    }
+
+    return static_cast<EGLint>(SwapCount - ImageSwaps[CurrentImageIndex] + 1);
+}
+
 void
 EGLSurface_t::UpdateRef(bool increaseRef)
 {
@@ -25,8 +25,10 @@
 #define __EGL_SURFACE_H__
 
 #include "EGL/egl.h"
+#include "EGL/eglext.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 #include "eglRefObject.h"
 #include "eglContext.h"
 #include "eglConfig.h"
@@ -39,6 +41,13 @@
 #endif // DEBUG_DEPTH
 #define DEBUG_DEPTH EGL_LOG_DEBUG
 
+/* the times a frame was requested and displayed at, EGL_TIMESTAMP_PENDING_ANDROID until they are known */
+typedef struct FrameTimestamps_t {
+    uint64_t                         frameId;
+    EGLnsecsANDROID                  requestedPresentTime;
+    EGLnsecsANDROID                  displayPresentTime;
+} FrameTimestamps_t;
+
 class EGLSurface_t : public EGLRefObject
 {
 private:
@@ -50,6 +59,7 @@ private:
     /* attributes set by attribute list */
     EGLint                           Width, Height;
     EGLint                           DepthSize, StencilSize;
+    EGLint                           Samples;
     EGLint                           RedSize, GreenSize, BlueSize, AlphaSize;
     EGLenum                          TextureFormat;
     EGLenum                          TextureTarget;
@@ -77,8 +87,32 @@ private:
     EGLBoolean                       PostSubBufferSupportedNV;
     EGLint                           CurrentImageIndex;
     EGLint                           ColorFormat;
+    /* transform the swapchain images are presented with (VkSurfaceTransformFlagBitsKHR), the client API draws into them rotated */
+    uint32_t                         PreTransform;
+
+    /* buffer age (EGL_EXT_buffer_age): the swap each swapchain image was last presented with, 0 if never */
+    uint64_t                         SwapCount;
+    std::vector<uint64_t>            ImageSwaps;
+
+    /* EGL_KHR_partial_update state of the current frame */
+    EGLBoolean                       BufferAgeQueried;
+    EGLBoolean                       DamageRegionSet;
     EGLSurfaceInterface_t            SurfaceInterface;
 
+    /* EGL_ANDROID_presentation_time of the next swap, 0 if none was set */
+    EGLnsecsANDROID                  PresentationTime;
+
+    /* EGL_ANDROID_get_frame_timestamps: frames are identified by the swap count they are presented with,
+       and kept in the slot of their id modulo the history */
+    EGLBoolean                       TimestampsEnabled;
+    FrameTimestamps_t                FrameTimestamps[EGL_GLOVE_FRAME_TIMESTAMPS_HISTORY];
+    EGLnsecsANDROID                  RefreshDuration;
+
+    /* pbuffer frames streamed to the host: the fence each image was last copied back with, and the image swapped last */
+    rendering_api_interface_t       *ReadbackAPIInterface;
+    std::vector<void *>              ReadbackFences;
+    EGLint                           ReadbackImageIndex;
+
     PlatformResources               *mPlatformResources;
 
 public:
@@ -102,12 +136,23 @@ public:
     inline void                      SetWidth(EGLint width)                                     { FUN_ENTRY(EGL_LOG_TRACE); Width = width; }
     inline void                      SetHeight(EGLint height)                                   { FUN_ENTRY(EGL_LOG_TRACE); Height = height; }
     inline void                      SetColorFormat(EGLint colorFormat)                         { FUN_ENTRY(EGL_LOG_TRACE); ColorFormat = colorFormat; }
+    inline void                      SetPreTransform(uint32_t preTransform)                     { FUN_ENTRY(EGL_LOG_TRACE); PreTransform = preTransform; }
     inline void                      SetPlatformResources(PlatformResources *platformResources) { FUN_ENTRY(EGL_LOG_TRACE); mPlatformResources = platformResources; }
            void                      SetMipmapLevel(EGLint mipmapLevel);
     inline void                      SetMultisampleResolve(EGLint multisampleResolve)           { FUN_ENTRY(EGL_LOG_TRACE); MultisampleResolve = multisampleResolve; }
     inline void                      SetSwapBehavior(EGLint swapBehavior)                       { FUN_ENTRY(EGL_LOG_TRACE); SwapBehavior = swapBehavior; }
     inline void                      SetBindToTexture(EGLint bindToTexture)                     { FUN_ENTRY(EGL_LOG_TRACE); BindToTexture = bindToTexture; }
            void                      ClampSwapInterval(EGLint swapInterval);
+           void                      ResetBufferAges(uint32_t imageCount);
+           void                      EndFrame();
+    inline void                      SetDamageRegionSet()                                       { FUN_ENTRY(EGL_LOG_TRACE); DamageRegionSet = EGL_TRUE; }
+    inline void                      SetPresentationTime(EGLnsecsANDROID time)                  { FUN_ENTRY(EGL_LOG_TRACE); PresentationTime = time; }
+    inline void                      SetTimestampsEnabled(EGLBoolean enabled)                   { FUN_ENTRY(EGL_LOG_TRACE); TimestampsEnabled = enabled; }
+    inline void                      SetRefreshDuration(EGLnsecsANDROID duration)               { FUN_ENTRY(EGL_LOG_TRACE); RefreshDuration = duration; }
+           void                      RecordFrame(uint64_t frameId, EGLnsecsANDROID requestedPresentTime);
+           void                      ResetReadbackFences(uint32_t imageCount);
+           void                      SetReadbackFence(rendering_api_interface_t *apiInterface, void *fence);
+           EGLBoolean                WaitReadbackFence();
            void                      UpdateRef(bool increaseRef) override;
 
     inline EGLint                    GetType()                                            const { FUN_ENTRY(EGL_LOG_TRACE); return Type; }
@@ -115,19 +160,33 @@ public:
     inline EGLint                    GetHeight()                                          const { FUN_ENTRY(EGL_LOG_TRACE); return Height; }
     inline EGLint                    GetDepthSize()                                       const { FUN_ENTRY(EGL_LOG_TRACE); return DepthSize; }
     inline EGLint                    GetStencilSize()                                     const { FUN_ENTRY(EGL_LOG_TRACE); return StencilSize; }
+    inline EGLint                    GetSamples()                                         const { FUN_ENTRY(EGL_LOG_TRACE); return Samples; }
     inline EGLint                    GetCurrentImageIndex()                               const { FUN_ENTRY(EGL_LOG_TRACE); return CurrentImageIndex; }
     inline EGLint                    GetColorFormat()                                     const { FUN_ENTRY(EGL_LOG_TRACE); return ColorFormat; }
+    inline uint32_t                  GetPreTransform()                                    const { FUN_ENTRY(EGL_LOG_TRACE); return PreTransform; }
     inline EGLSurfaceInterface_t    *GetEGLSurfaceInterface()                                   { FUN_ENTRY(EGL_LOG_TRACE); return &SurfaceInterface; }
     inline const PlatformResources  *GetPlatformResources()                               const { FUN_ENTRY(EGL_LOG_TRACE); return mPlatformResources; }
     inline PlatformResources        *GetPlatformResources()                                     { FUN_ENTRY(EGL_LOG_TRACE); return mPlatformResources; }
     inline uint32_t                  GetPlatformSurfaceImageCount()                             { FUN_ENTRY(EGL_LOG_TRACE); return mPlatformResources->GetSwapchainImageCount(); }
     inline void                     *GetPlatformSurfaceImages()                                 { FUN_ENTRY(EGL_LOG_TRACE); return mPlatformResources->GetSwapchainImages(); }
+    inline void                     *GetPlatformReadbackBuffers()                               { FUN_ENTRY(EGL_LOG_TRACE); return mPlatformResources->GetReadbackBuffers(); }
+    inline void                     *GetPlatformSyncItems()                                     { FUN_ENTRY(EGL_LOG_TRACE); return mPlatformResources->GetSyncItems(); }
+    inline EGLint                    GetReadbackImageIndex()                              const { FUN_ENTRY(EGL_LOG_TRACE); return ReadbackImageIndex; }
 
     inline EGLint                    GetBindToTextureRGB()                                const { FUN_ENTRY(EGL_LOG_TRACE); return BindToTextureRGB; }
     inline EGLint                    GetBindToTextureRGBA()                               const { FUN_ENTRY(EGL_LOG_TRACE); return BindToTextureRGBA; }
     inline EGLint                    GetSwapInterval()                                    const { FUN_ENTRY(EGL_LOG_TRACE); return SwapInterval; }
     inline EGLBoolean                GetBindToTexture()                                   const { FUN_ENTRY(EGL_LOG_TRACE); return BindToTexture; }
     inline EGLenum                   GetRenderBuffer()                                    const { FUN_ENTRY(EGL_LOG_TRACE); return RenderBuffer; }
+    inline EGLenum                   GetSwapBehavior()                                    const { FUN_ENTRY(EGL_LOG_TRACE); return SwapBehavior; }
+           EGLint                    GetBufferAge()                                       const;
+    inline EGLnsecsANDROID           GetPresentationTime()                                const { FUN_ENTRY(EGL_LOG_TRACE); return PresentationTime; }
+    inline EGLBoolean                GetTimestampsEnabled()                               const { FUN_ENTRY(EGL_LOG_TRACE); return TimestampsEnabled; }
+    inline EGLnsecsANDROID           GetRefreshDuration()                                 const { FUN_ENTRY(EGL_LOG_TRACE); return RefreshDuration; }
+    inline uint64_t                  GetNextFrameId()                                     const { FUN_ENTRY(EGL_LOG_TRACE); return SwapCount + 1; }
+           FrameTimestamps_t        *GetFrameTimestamps(uint64_t frameId);
+    inline EGLBoolean                IsBufferAgeQueried()                                 const { FUN_ENTRY(EGL_LOG_TRACE); return BufferAgeQueried; }
+    inline EGLBoolean                IsDamageRegionSet()                                  const { FUN_ENTRY(EGL_LOG_TRACE); return DamageRegionSet; }
 };
 
 #endif // __EGL_SURFACE_H__
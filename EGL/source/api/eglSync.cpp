@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       eglSync.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      EGL Sync Object. It wraps a fence of the client API that signals when the commands before it complete
+ *
+ */
+
+#include "utils/egl_defs.h"
+#include "eglSync.h"
+
+EGLSync_t::EGLSync_t(rendering_api_interface_t *apiInterface, void *fence, EGLenum type):
+mAPIInterface(apiInterface), mFence(fence), mType(type), mSignaled(false)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+}
+
+EGLSync_t::~EGLSync_t()
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    mAPIInterface->destroy_fence_cb(mFence);
+}
+
+EGLint
+EGLSync_t::ClientWait(EGLTimeKHR timeout)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    // a fence sync never returns to the unsignaled state
+    if(!mSignaled) {
+        mSignaled = mAPIInterface->client_wait_fence_cb(mFence, timeout);
+    }
+
+    return mSignaled ? EGL_CONDITION_SATISFIED_KHR : EGL_TIMEOUT_EXPIRED_KHR;
+}
+
+EGLint
+EGLSync_t::DupNativeFenceFD()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    if(mType != EGL_SYNC_NATIVE_FENCE_ANDROID || mAPIInterface->dup_native_fence_fd_cb == nullptr) {
+        return EGL_NO_NATIVE_FENCE_FD_ANDROID;
+    }
+
+    return mAPIInterface->dup_native_fence_fd_cb(mFence);
+}
+
+EGLint
+EGLSync_t::GetStatus()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    return ClientWait(0) == EGL_CONDITION_SATISFIED_KHR ? EGL_SIGNALED_KHR : EGL_UNSIGNALED_KHR;
+}
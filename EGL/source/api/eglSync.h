@@ -0,0 +1,53 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       eglSync.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      EGL Sync Object. It wraps a fence of the client API that signals when the commands before it complete
+ *
+ */
+
+#ifndef __EGL_SYNC_H__
+#define __EGL_SYNC_H__
+
+#include "EGL/egl.h"
+#include "EGL/eglext.h"
+#include "rendering_api/rendering_api.h"
+#include "utils/eglLogger.h"
+
+class EGLSync_t
+{
+private:
+    rendering_api_interface_t       *mAPIInterface;
+    void                            *mFence;
+    EGLenum                          mType;
+    bool                             mSignaled;
+
+public:
+    EGLSync_t(rendering_api_interface_t *apiInterface, void *fence, EGLenum type);
+    ~EGLSync_t();
+
+    EGLint                           ClientWait(EGLTimeKHR timeout);
+    EGLint                           GetStatus();
+    /// a new sync file descriptor of a native fence, EGL_NO_NATIVE_FENCE_FD_ANDROID once signaled or on failure
+    EGLint                           DupNativeFenceFD();
+
+    inline void                     *GetFence()                               const { FUN_ENTRY(EGL_LOG_TRACE); return mFence; }
+    inline EGLenum                   GetType()                                const { FUN_ENTRY(EGL_LOG_TRACE); return mType; }
+};
+
+#endif // __EGL_SYNC_H__
@@ -30,19 +30,29 @@
 #include "utils/egl_defs.h"
 #include "utils/eglUtils.h"
 #include "platform/platformFactory.h"
+#include "rendering_api/rendering_api.h"
 #include <algorithm>
+#include <string>
 
-#ifdef VK_USE_PLATFORM_ANDROID_KHR
-#include "system/window.h"
-#endif
 RenderingThread *callingThread = nullptr;
 
 void setCallingThread(RenderingThread *thread) { callingThread = thread; }
 
+/// the client API owns the device, whose memory EGLImages are imported into
+static const vkInterface_t *
+GetVkInterface(void)
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    const rendering_api_interface_t *apiInterface = RENDERING_API_get_gles2_interface();
+    return apiInterface != nullptr ? static_cast<const vkInterface_t *>(apiInterface->state) : nullptr;
+}
+
 DisplayDriver::DisplayDriver(EGLDisplay_t* eglDisplay)
 : mEGLDisplay(eglDisplay),
-  mActiveContext(nullptr), mWindowInterface(nullptr),
-  mInitialized(false)
+  mWindowInterface(nullptr),
+  mInitialized(false),
+  mSwapBatchActive(false)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 }
@@ -148,11 +158,11 @@ DisplayDriver::Terminate()
 }
 
 EGLContext
-DisplayDriver::CreateContext(EGLenum rendering_api, EGLConfig_t* config, const EGLint* attribList)
+DisplayDriver::CreateContext(EGLenum rendering_api, EGLConfig_t* config, EGLContext_t* shareContext, const EGLint* attribList)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    EGLContext_t *eglContext = mDisplayDriverResourceManager.AddEGLContext(mEGLDisplay, rendering_api, config, attribList);
+    EGLContext_t *eglContext = mDisplayDriverResourceManager.AddEGLContext(mEGLDisplay, rendering_api, config, shareContext, attribList);
     return static_cast<EGLContext>(eglContext);
 }
 
@@ -269,11 +279,14 @@ DisplayDriver::CreateWindowSurface(EGLConfig_t* eglConfig, EGLNativeWindowType w
     eglSurface->SetPlatformResources(platformResources);
 
     if(mWindowInterface->CreateSurface(mEGLDisplay, win, eglSurface) == EGL_FALSE) {
-        delete eglSurface;
+        // a headless display has no native windows at all
+        currentThread.RecordError(EGL_BAD_NATIVE_WINDOW);
+        mDisplayDriverResourceManager.RemoveEGLSurface(mWindowInterface, eglSurface);
         return EGL_NO_SURFACE;
     }
 
     mWindowInterface->AllocateSurfaceImages(eglSurface);
+    eglSurface->ResetBufferAges(eglSurface->GetPlatformSurfaceImageCount());
 
     uint32_t imageNext = 0;
     mWindowInterface->AcquireNextImage(eglSurface, &imageNext);
@@ -288,7 +301,7 @@ DisplayDriver::CreatePbufferSurface(EGLConfig_t* eglConfig, const EGLint *attrib
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    EGLSurface_t *eglSurface = new EGLSurface_t();
+    EGLSurface_t *eglSurface = mDisplayDriverResourceManager.AddEGLSurface();
     if(!eglSurface) {
         currentThread.RecordError(EGL_BAD_ALLOC);
         return EGL_NO_SURFACE;
@@ -297,7 +310,7 @@ DisplayDriver::CreatePbufferSurface(EGLConfig_t* eglConfig, const EGLint *attrib
     EGLint eglError = EGL_SUCCESS;
     if(eglSurface->InitSurface(EGL_PBUFFER_BIT, eglConfig, attrib_list, &eglError) != EGL_TRUE) {
         currentThread.RecordError(eglError);
-        delete eglSurface;
+        mDisplayDriverResourceManager.RemoveEGLSurface(mWindowInterface, eglSurface);
         return EGL_NO_SURFACE;
     }
 
@@ -306,10 +319,21 @@ DisplayDriver::CreatePbufferSurface(EGLConfig_t* eglConfig, const EGLint *attrib
         eglSurface->SetHeight(EglConfigs[0].MaxPbufferHeight);
     }
 
-    //TODO: Pbuffer is not supported
-    NOT_IMPLEMENTED();
+    PlatformResources *platformResources = PlatformFactory::GetResources();
+    eglSurface->SetPlatformResources(platformResources);
 
-    return EGL_NO_SURFACE;
+    // the images come out of the pool of the window interface, there is no swapchain behind a pbuffer
+    mWindowInterface->AllocateSurfaceImages(eglSurface);
+    if(eglSurface->GetPlatformSurfaceImageCount() == 0) {
+        currentThread.RecordError(EGL_BAD_ALLOC);
+        mDisplayDriverResourceManager.RemoveEGLSurface(mWindowInterface, eglSurface);
+        return EGL_NO_SURFACE;
+    }
+    eglSurface->ResetReadbackFences(eglSurface->GetPlatformSurfaceImageCount());
+
+    CreateEGLSurfaceInterface(eglSurface);
+
+    return static_cast<EGLSurface>(eglSurface);
 }
 
 EGLSurface
@@ -333,9 +357,11 @@ DisplayDriver::CreateEGLSurfaceInterface(EGLSurface_t *eglSurface)
     memset(surfaceInterface, 0, sizeof(*surfaceInterface));
 
     surfaceInterface->surface = reinterpret_cast<void *>(eglSurface);
-    if(eglSurface->GetType() == EGL_WINDOW_BIT) {
+    if(eglSurface->GetType() == EGL_WINDOW_BIT || eglSurface->GetType() == EGL_PBUFFER_BIT) {
         surfaceInterface->images            = eglSurface->GetPlatformSurfaceImages();
         surfaceInterface->imageCount        = eglSurface->GetPlatformSurfaceImageCount();
+        surfaceInterface->readbackBuffers   = eglSurface->GetPlatformReadbackBuffers();
+        surfaceInterface->syncItems         = eglSurface->GetPlatformSyncItems();
         surfaceInterface->depthBuffer       = 0;
         surfaceInterface->contextRef        = 0;
     }
@@ -344,7 +370,9 @@ DisplayDriver::CreateEGLSurfaceInterface(EGLSurface_t *eglSurface)
     surfaceInterface->height                = eglSurface->GetHeight();
     surfaceInterface->depthSize             = eglSurface->GetDepthSize();
     surfaceInterface->stencilSize           = eglSurface->GetStencilSize();
+    surfaceInterface->samples               = eglSurface->GetSamples();
     surfaceInterface->surfaceColorFormat    = eglSurface->GetColorFormat();
+    surfaceInterface->preTransform          = eglSurface->GetPreTransform();
     surfaceInterface->nextImageIndex        = eglSurface->GetCurrentImageIndex();
 }
 
@@ -355,6 +383,11 @@ DisplayDriver::DestroySurface(EGLSurface_t* eglSurface)
 
     eglSurface->MarkForDeletion();
 
+    // a swap still queued in a batch is dropped along with the surface
+    mSwapBatch.erase(std::remove_if(mSwapBatch.begin(), mSwapBatch.end(),
+                                    [eglSurface](const BatchedSwap_t &swap) { return swap.surface == eglSurface; }),
+                     mSwapBatch.end());
+
     if(eglSurface->FreeForDeletion()) {
         mDisplayDriverResourceManager.RemoveEGLSurface(mWindowInterface, eglSurface);
     }
@@ -412,6 +445,9 @@ DisplayDriver::SurfaceAttrib(EGLSurface_t* eglSurface, EGLint attribute, EGLint
         }
    	    eglSurface->SetSwapBehavior(value);
         break;
+    case EGL_TIMESTAMPS_ANDROID:
+        eglSurface->SetTimestampsEnabled(value ? EGL_TRUE : EGL_FALSE);
+        break;
     default:
         currentThread.RecordError(EGL_BAD_ATTRIBUTE);
         return EGL_FALSE;
@@ -449,9 +485,9 @@ DisplayDriver::BindTexImage(EGLSurface_t* eglSurface, EGLint buffer)
 
     //TODO: We are assuming that the BindTexImage refers to the surface that is currently active for GLOVE.
     //If we have multiple surfaces for GLES, additional information may need to be passed to GLOVE.
-    mActiveContext->BindToTexture(EGL_TRUE);
+    GetActiveContext()->BindToTexture(EGL_TRUE);
     //If display and surface are the display and surface for the calling thread's current context, eglBindTexImage performs an implicit glFlush
-    mActiveContext->Finish();
+    GetActiveContext()->Finish();
 
     return EGL_TRUE;
 }
@@ -471,7 +507,7 @@ DisplayDriver::ReleaseTexImage(EGLSurface_t* eglSurface, EGLint buffer)
         currentThread.RecordError(EGL_BAD_MATCH);
         return EGL_FALSE;
     }
-    mActiveContext->BindToTexture(EGL_FALSE);
+    GetActiveContext()->BindToTexture(EGL_FALSE);
 
     return EGL_TRUE;
 }
@@ -481,12 +517,12 @@ DisplayDriver::SwapInterval(EGLint interval)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    if(currentThread.GetCurrentContext() == nullptr) {
+    if(GetActiveContext() == nullptr) {
         currentThread.RecordError(EGL_BAD_CONTEXT);
         return EGL_FALSE;
     }
 
-    EGLSurface_t* surface = static_cast<EGLSurface_t*>(mActiveContext->GetDrawSurface());
+    EGLSurface_t* surface = static_cast<EGLSurface_t*>(GetActiveContext()->GetDrawSurface());
     if(surface == nullptr) {
         currentThread.RecordError(EGL_BAD_SURFACE);
         return EGL_FALSE;
@@ -495,7 +531,7 @@ DisplayDriver::SwapInterval(EGLint interval)
     //If the interval remains the same, there is no need to update the surface
     if(interval != surface->GetSwapInterval()) {
         surface->ClampSwapInterval(interval);
-        mActiveContext->Finish();
+        GetActiveContext()->Finish();
         UpdateSurface(surface);
     }
     return EGL_TRUE;
@@ -507,6 +543,23 @@ DisplayDriver::SwapBuffers(EGLSurface_t* eglSurface)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
+    return SwapBuffersWithDamage(eglSurface, nullptr, 0);
+}
+
+EGLBoolean
+DisplayDriver::SwapBuffersWithDamage(EGLSurface_t* eglSurface, const EGLint *rects, EGLint nRects)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(nRects < 0 || (nRects > 0 && rects == nullptr)) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    if(eglSurface->GetType() == EGL_PBUFFER_BIT) {
+        return SwapPbuffer(eglSurface);
+    }
+
     if(eglSurface->GetType() != EGL_WINDOW_BIT) {
         return EGL_TRUE;
     }
@@ -515,9 +568,39 @@ DisplayDriver::SwapBuffers(EGLSurface_t* eglSurface)
         return EGL_TRUE;
     }
 
-    mActiveContext->Finish();
+    // only the thread the surface is current to may post it
+    if(GetActiveContext() == nullptr || GetActiveContext()->GetDrawSurface() != eglSurface) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
+    }
+
+    GetActiveContext()->SubmitFrame();
+
+    if(eglSurface->IsDamageRegionSet()) {
+        GetActiveContext()->SetDamageRegion(nullptr, 0);
+    }
+
+    // in a batch the image is presented along with the ones of the other surfaces, and the next one acquired then
+    if(mSwapBatchActive) {
+        QueueSwap(eglSurface, rects, nRects);
+        return EGL_TRUE;
+    }
+
+    // the damage only tells the presentation engine what changed, the whole image is still presented
+    EGLBoolean presented = mWindowInterface->PresentImage(eglSurface, rects, nRects);
+    BeginNextFrame(eglSurface, presented);
+
+    return EGL_TRUE;
+}
+
+void
+DisplayDriver::BeginNextFrame(EGLSurface_t* eglSurface, EGLBoolean presented)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
 
-    if(mWindowInterface->PresentImage(eglSurface) == EGL_FALSE) {
+    eglSurface->EndFrame();
+
+    if(presented == EGL_FALSE) {
         UpdateSurface(eglSurface);
     }
 
@@ -527,81 +610,351 @@ DisplayDriver::SwapBuffers(EGLSurface_t* eglSurface)
     }
 
     eglSurface->GetEGLSurfaceInterface()->nextImageIndex = imageIndex;
+}
+
+void
+DisplayDriver::QueueSwap(EGLSurface_t* eglSurface, const EGLint *rects, EGLint nRects)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    // the surface has no new image before the batch ends, so swapping it again only adds to the frame
+    // already queued, which is then presented whole
+    for(auto &swap : mSwapBatch) {
+        if(swap.surface == eglSurface) {
+            swap.rects.clear();
+            return;
+        }
+    }
+
+    BatchedSwap_t swap;
+    swap.surface = eglSurface;
+    swap.rects.assign(rects, rects + 4 * nRects);
+    mSwapBatch.push_back(std::move(swap));
+}
+
+EGLBoolean
+DisplayDriver::PresentSwapBatch(void)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(mSwapBatch.empty()) {
+        return EGL_TRUE;
+    }
+
+    // surfaces that have to be recreated are made the draw surface of the context for it
+    EGLContext_t *eglContext = GetActiveContext();
+    if(eglContext == nullptr) {
+        currentThread.RecordError(EGL_BAD_CONTEXT);
+        return EGL_FALSE;
+    }
+
+    std::vector<SurfacePresent_t> presents;
+    presents.reserve(mSwapBatch.size());
+    for(const auto &swap : mSwapBatch) {
+        SurfacePresent_t present = { swap.surface, swap.rects.data(), static_cast<EGLint>(swap.rects.size() / 4), EGL_FALSE };
+        presents.push_back(present);
+    }
+    mSwapBatch.clear();
+
+    // one present for all the swapchains, then the next image of each is acquired ahead of its next frame
+    mWindowInterface->PresentImages(presents.data(), static_cast<uint32_t>(presents.size()));
+
+    EGLSurface_t *drawSurface = eglContext->GetDrawSurface();
+    EGLSurface_t *readSurface = eglContext->GetReadSurface();
+    for(const auto &present : presents) {
+        if(present.presented == EGL_FALSE && eglContext->GetDrawSurface() != present.surface) {
+            eglContext->MakeCurrent(mEGLDisplay, present.surface, present.surface);
+        }
+        BeginNextFrame(present.surface, present.presented);
+    }
+
+    if(eglContext->GetDrawSurface() != drawSurface || eglContext->GetReadSurface() != readSurface) {
+        eglContext->MakeCurrent(mEGLDisplay, drawSurface, readSurface);
+    }
 
     return EGL_TRUE;
 }
 
-void
-DisplayDriver::UpdateSurface(EGLSurface_t* eglSurface)
+EGLBoolean
+DisplayDriver::BeginSwapBatch(void)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    assert(mActiveContext != nullptr);
-    assert(mWindowInterface != nullptr);
+    if(mSwapBatchActive) {
+        currentThread.RecordError(EGL_BAD_ACCESS);
+        return EGL_FALSE;
+    }
 
-    mActiveContext->ReleaseSurfaceResources();
-    mWindowInterface->DestroySurfaceImages(eglSurface);
-    mWindowInterface->AllocateSurfaceImages(eglSurface);
-    CreateEGLSurfaceInterface(eglSurface);
-    mActiveContext->MakeCurrent(mEGLDisplay, eglSurface, eglSurface);
+    mSwapBatchActive = true;
+
+    return EGL_TRUE;
 }
 
 EGLBoolean
-DisplayDriver::CopyBuffers(EGLSurface_t* eglSurface, EGLNativePixmapType target)
+DisplayDriver::EndSwapBatch(void)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    //The implementation does not support native pixmaps
-    currentThread.RecordError(EGL_BAD_NATIVE_PIXMAP);
+    if(!mSwapBatchActive) {
+        currentThread.RecordError(EGL_BAD_ACCESS);
+        return EGL_FALSE;
+    }
 
-    //TODO: EGL_BAD_MATCH is generated if the format of native_pixmap is not compatible with the color buffer of surface.
-    //TODO: EGL_CONTEXT_LOST is generated if a power management event has occurred
+    if(PresentSwapBatch() == EGL_FALSE) {
+        return EGL_FALSE;
+    }
 
-    return EGL_FALSE;
+    mSwapBatchActive = false;
+
+    return EGL_TRUE;
 }
 
-EGLImageKHR
-DisplayDriver::CreateImageNativeBufferAndroid(EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list)
+EGLBoolean
+DisplayDriver::SwapPbuffer(EGLSurface_t* eglSurface)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-#ifdef VK_USE_PLATFORM_ANDROID_KHR
-    (void)target;
+    // a swap has no effect on a pbuffer, unless its frames are streamed to the host
+    if(eglSurface->GetEGLSurfaceInterface()->readbackBuffers == nullptr || eglSurface->GetBindToTexture() == EGL_TRUE) {
+        return EGL_TRUE;
+    }
 
-    if(dpy == EGL_NO_DISPLAY) {
-        currentThread.RecordError(EGL_BAD_DISPLAY);
-        return EGL_NO_IMAGE_KHR;
+    EGLContext_t *eglContext = GetActiveContext();
+    if(eglContext == nullptr || eglContext->GetDrawSurface() != eglSurface) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
     }
 
-    if(ctx != EGL_NO_CONTEXT) {
-        currentThread.RecordError(EGL_BAD_CONTEXT);
-        return EGL_NO_IMAGE_KHR;
+    // the frame is copied back in its own submission, only the host that reads it waits on the fence
+    eglContext->SubmitFrame();
+    void *fence = eglContext->CreateFence();
+    if(fence == nullptr) {
+        eglContext->Finish();
     }
+    eglSurface->SetReadbackFence(eglContext->GetAPIInterface(), fence);
+    eglSurface->EndFrame();
 
-    ANativeWindowBuffer *native_buffer = (ANativeWindowBuffer*)buffer;
+    uint32_t imageIndex;
+    mWindowInterface->AcquireNextImage(eglSurface, &imageIndex);
+    eglSurface->GetEGLSurfaceInterface()->nextImageIndex = imageIndex;
+
+    return EGL_TRUE;
+}
 
-    if(native_buffer->common.magic != ANDROID_NATIVE_BUFFER_MAGIC ||
-       native_buffer->common.version != sizeof(ANativeWindowBuffer)) {
+EGLBoolean
+DisplayDriver::GetSurfaceFrame(EGLSurface_t* eglSurface, const void **pixels, EGLint *stride)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(pixels == nullptr || stride == nullptr) {
         currentThread.RecordError(EGL_BAD_PARAMETER);
-        return EGL_NO_IMAGE_KHR;
+        return EGL_FALSE;
+    }
+
+    if(eglSurface->GetType() != EGL_PBUFFER_BIT || eglSurface->GetEGLSurfaceInterface()->readbackBuffers == nullptr) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
+    }
+
+    // nothing has been swapped yet, or the frame never completed
+    const EGLint imageIndex = eglSurface->GetReadbackImageIndex();
+    if(imageIndex < 0 || eglSurface->WaitReadbackFence() == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_ACCESS);
+        return EGL_FALSE;
+    }
+
+    // the pixels stay valid until the image is rendered to again, as many swaps later as the pbuffer has images
+    *pixels = mWindowInterface->GetReadbackData(eglSurface, static_cast<uint32_t>(imageIndex));
+    *stride = eglSurface->GetWidth() * EGL_GLOVE_PBUFFER_BYTES_PER_PIXEL;
+
+    return *pixels != nullptr ? EGL_TRUE : EGL_FALSE;
+}
+
+EGLBoolean
+DisplayDriver::SetDamageRegion(EGLSurface_t* eglSurface, const EGLint *rects, EGLint nRects)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(nRects < 0 || (nRects > 0 && rects == nullptr)) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    if(eglSurface->GetType() != EGL_WINDOW_BIT || GetActiveContext() == nullptr ||
+       GetActiveContext()->GetDrawSurface() != eglSurface || eglSurface->GetSwapBehavior() != EGL_BUFFER_DESTROYED) {
+        currentThread.RecordError(EGL_BAD_MATCH);
+        return EGL_FALSE;
+    }
+
+    // the region is set once per frame, by a client that knows what the buffer holds
+    if(eglSurface->IsDamageRegionSet() == EGL_TRUE || eglSurface->IsBufferAgeQueried() == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_ACCESS);
+        return EGL_FALSE;
+    }
+
+    eglSurface->SetDamageRegionSet();
+    GetActiveContext()->SetDamageRegion(rects, nRects);
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::PresentationTime(EGLSurface_t* eglSurface, EGLnsecsANDROID time)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(eglSurface->GetType() != EGL_WINDOW_BIT) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
     }
 
-    switch(native_buffer->format) {
-        case HAL_PIXEL_FORMAT_RGBA_8888:
-        case HAL_PIXEL_FORMAT_RGBX_8888:
-        case HAL_PIXEL_FORMAT_RGB_565:
+    // taken by the next swap of the surface only
+    eglSurface->SetPresentationTime(time);
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::GetCompositorTimingSupported(EGLSurface_t* eglSurface, EGLint name)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    // the refresh duration is the only timing the display reports
+    return (eglSurface->GetType() == EGL_WINDOW_BIT && name == EGL_COMPOSITE_INTERVAL_ANDROID) ? EGL_TRUE : EGL_FALSE;
+}
+
+EGLBoolean
+DisplayDriver::GetCompositorTiming(EGLSurface_t* eglSurface, EGLint numTimestamps, const EGLint *names, EGLnsecsANDROID *values)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(eglSurface->GetType() != EGL_WINDOW_BIT) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
+    }
+
+    if(numTimestamps < 0 || (numTimestamps > 0 && (names == nullptr || values == nullptr))) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    for(EGLint i = 0; i < numTimestamps; ++i) {
+        if(GetCompositorTimingSupported(eglSurface, names[i]) == EGL_FALSE) {
+            currentThread.RecordError(EGL_BAD_PARAMETER);
+            return EGL_FALSE;
+        }
+        values[i] = eglSurface->GetRefreshDuration() > 0 ? eglSurface->GetRefreshDuration() : EGL_TIMESTAMP_INVALID_ANDROID;
+    }
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::GetNextFrameId(EGLSurface_t* eglSurface, EGLuint64KHR *frameId)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(eglSurface->GetType() != EGL_WINDOW_BIT || eglSurface->GetTimestampsEnabled() == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
+    }
+
+    if(frameId == nullptr) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    *frameId = eglSurface->GetNextFrameId();
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::GetFrameTimestampSupported(EGLSurface_t* eglSurface, EGLint timestamp)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(eglSurface->GetType() != EGL_WINDOW_BIT) {
+        return EGL_FALSE;
+    }
+
+    // the present timing of VK_GOOGLE_display_timing holds when the frame was asked for and shown at only
+    switch(timestamp) {
+    case EGL_REQUESTED_PRESENT_TIME_ANDROID:
+    case EGL_DISPLAY_PRESENT_TIME_ANDROID:
+        return EGL_TRUE;
+    default:
+        return EGL_FALSE;
+    }
+}
+
+EGLBoolean
+DisplayDriver::GetFrameTimestamps(EGLSurface_t* eglSurface, EGLuint64KHR frameId, EGLint numTimestamps, const EGLint *timestamps, EGLnsecsANDROID *values)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(eglSurface->GetType() != EGL_WINDOW_BIT || eglSurface->GetTimestampsEnabled() == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_SURFACE);
+        return EGL_FALSE;
+    }
+
+    if(numTimestamps < 0 || (numTimestamps > 0 && (timestamps == nullptr || values == nullptr))) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    // frames that were not presented yet, or whose history was overwritten
+    const FrameTimestamps_t *frame = eglSurface->GetFrameTimestamps(frameId);
+    if(frame == nullptr) {
+        currentThread.RecordError(EGL_BAD_ACCESS);
+        return EGL_FALSE;
+    }
+
+    for(EGLint i = 0; i < numTimestamps; ++i) {
+        switch(timestamps[i]) {
+        case EGL_REQUESTED_PRESENT_TIME_ANDROID:
+            values[i] = frame->requestedPresentTime > 0 ? frame->requestedPresentTime : EGL_TIMESTAMP_INVALID_ANDROID;
+            break;
+        case EGL_DISPLAY_PRESENT_TIME_ANDROID:
+            values[i] = frame->displayPresentTime;
             break;
         default:
             currentThread.RecordError(EGL_BAD_PARAMETER);
-            return EGL_NO_IMAGE_KHR;
+            return EGL_FALSE;
+        }
     }
 
-    native_buffer->common.incRef(&native_buffer->common);
+    return EGL_TRUE;
+}
+
+void
+DisplayDriver::UpdateSurface(EGLSurface_t* eglSurface)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    assert(GetActiveContext() != nullptr);
+    assert(mWindowInterface != nullptr);
+
+    // the swapchain is not destroyed first, the new one is created out of it
+    GetActiveContext()->ReleaseSurfaceResources();
+    mWindowInterface->AllocateSurfaceImages(eglSurface);
+    eglSurface->ResetBufferAges(eglSurface->GetPlatformSurfaceImageCount());
+    CreateEGLSurfaceInterface(eglSurface);
+    GetActiveContext()->MakeCurrent(mEGLDisplay, eglSurface, eglSurface);
+}
+
+EGLBoolean
+DisplayDriver::CopyBuffers(EGLSurface_t* eglSurface, EGLNativePixmapType target)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    //The implementation does not support native pixmaps
+    currentThread.RecordError(EGL_BAD_NATIVE_PIXMAP);
+
+    //TODO: EGL_BAD_MATCH is generated if the format of native_pixmap is not compatible with the color buffer of surface.
+    //TODO: EGL_CONTEXT_LOST is generated if a power management event has occurred
 
-    return (EGLImageKHR)native_buffer;
-#else
-    return (EGLImageKHR)EGL_NO_IMAGE_KHR;
-#endif
+    return EGL_FALSE;
 }
 
 EGLImageKHR
@@ -610,9 +963,10 @@ DisplayDriver::CreateImageKHR(EGLContext ctx, EGLenum target, EGLClientBuffer bu
     FUN_ENTRY(DEBUG_DEPTH);
 
     switch(target) {
+        case EGL_LINUX_DMA_BUF_EXT:
         case EGL_NATIVE_BUFFER_ANDROID:
-            return CreateImageNativeBufferAndroid(ctx, target, buffer, attrib_list);
         case EGL_GL_TEXTURE_2D_KHR:
+            break;
         case EGL_GL_TEXTURE_CUBE_MAP_POSITIVE_X_KHR:
         case EGL_GL_TEXTURE_CUBE_MAP_NEGATIVE_X_KHR:
         case EGL_GL_TEXTURE_CUBE_MAP_POSITIVE_Y_KHR:
@@ -628,6 +982,43 @@ DisplayDriver::CreateImageKHR(EGLContext ctx, EGLenum target, EGLClientBuffer bu
             currentThread.RecordError(EGL_BAD_PARAMETER);
             return EGL_NO_IMAGE_KHR;
     }
+
+    // client buffers belong to no context, textures to the one given
+    if((target == EGL_GL_TEXTURE_2D_KHR) != (ctx != EGL_NO_CONTEXT)) {
+        currentThread.RecordError(EGL_BAD_CONTEXT);
+        return EGL_NO_IMAGE_KHR;
+    }
+
+    // textures are exported by their context through the commands of the calling thread
+    EGLContext_t *eglContext = static_cast<EGLContext_t *>(ctx);
+    if(target == EGL_GL_TEXTURE_2D_KHR) {
+        const vkInterface_t *vkInterface = GetVkInterface();
+        if(vkInterface == nullptr || !vkInterface->isExternalMemoryDmaBufSupported) {
+            currentThread.RecordError(EGL_BAD_PARAMETER);
+            return EGL_NO_IMAGE_KHR;
+        }
+        if(eglContext != currentThread.GetCurrentContext() || eglContext->GetDisplay() != mEGLDisplay) {
+            currentThread.RecordError(EGL_BAD_MATCH);
+            return EGL_NO_IMAGE_KHR;
+        }
+    }
+
+    if(target == EGL_LINUX_DMA_BUF_EXT && buffer != nullptr) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_NO_IMAGE_KHR;
+    }
+
+    EGLImage_t *eglImage = mDisplayDriverResourceManager.AddEGLImage();
+    EGLint error = (target == EGL_LINUX_DMA_BUF_EXT)     ? eglImage->InitDmaBuf(attrib_list, GetVkInterface())       :
+                   (target == EGL_NATIVE_BUFFER_ANDROID) ? eglImage->InitNativeBuffer(buffer, GetVkInterface())      :
+                                                           eglImage->InitGLTexture(eglContext, buffer, attrib_list);
+    if(error != EGL_SUCCESS) {
+        mDisplayDriverResourceManager.RemoveEGLImage(eglImage);
+        currentThread.RecordError(error);
+        return EGL_NO_IMAGE_KHR;
+    }
+
+    return static_cast<EGLImageKHR>(eglImage);
 }
 
 EGLBoolean
@@ -635,39 +1026,146 @@ DisplayDriver::DestroyImageKHR(EGLImageKHR image)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-#ifdef VK_USE_PLATFORM_ANDROID_KHR
-    if(dpy == EGL_NO_DISPLAY) {
-        currentThread.RecordError(EGL_BAD_DISPLAY);
+    if(mDisplayDriverResourceManager.RemoveEGLImage(static_cast<EGLImage_t *>(image)) == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
         return EGL_FALSE;
     }
 
-    ANativeWindowBuffer* native_buffer = (ANativeWindowBuffer*)image;
+    return EGL_TRUE;
+}
 
-    if(native_buffer->common.magic != ANDROID_NATIVE_BUFFER_MAGIC ||
-       native_buffer->common.version != sizeof(ANativeWindowBuffer)) {
+EGLBoolean
+DisplayDriver::QueryDmaBufFormats(EGLint max_formats, EGLint *formats, EGLint *num_formats)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(max_formats < 0 || (max_formats > 0 && formats == nullptr) || num_formats == nullptr) {
         currentThread.RecordError(EGL_BAD_PARAMETER);
         return EGL_FALSE;
     }
 
-    native_buffer->common.decRef(&native_buffer->common);
+    const vkInterface_t *vkInterface = GetVkInterface();
+    if(vkInterface == nullptr || !vkInterface->isExternalMemoryDmaBufSupported) {
+        *num_formats = 0;
+        return EGL_TRUE;
+    }
+
+    *num_formats = EGLImage_t::GetDmaBufFormats(max_formats, formats);
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::QueryDmaBufModifiers(EGLint format, EGLint max_modifiers, EGLuint64KHR *modifiers, EGLBoolean *external_only, EGLint *num_modifiers)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const vkInterface_t *vkInterface = GetVkInterface();
+    if(max_modifiers < 0 || (max_modifiers > 0 && modifiers == nullptr) || num_modifiers == nullptr ||
+       vkInterface == nullptr || !vkInterface->isExternalMemoryDmaBufSupported ||
+       EGLImage_t::DrmFourccToVkFormat(format) == VK_FORMAT_UNDEFINED) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    std::vector<uint64_t> formatModifiers;
+    EGLImage_t::GetDmaBufModifiers(format, vkInterface, &formatModifiers);
+
+    if(!max_modifiers) {
+        *num_modifiers = static_cast<EGLint>(formatModifiers.size());
+        return EGL_TRUE;
+    }
+
+    // every format is sampled as a 2D texture, none is restricted to external ones
+    EGLint count = 0;
+    for(; count < max_modifiers && count < static_cast<EGLint>(formatModifiers.size()); ++count) {
+        modifiers[count] = formatModifiers[count];
+        if(external_only != nullptr) {
+            external_only[count] = EGL_FALSE;
+        }
+    }
+    *num_modifiers = count;
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::ExportDMABUFImageQuery(EGLImageKHR image, int *fourcc, int *num_planes, EGLuint64KHR *modifiers)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const EGLImage_t *eglImage = static_cast<const EGLImage_t *>(image);
+    const EGLint error = mDisplayDriverResourceManager.FindEGLImage(eglImage) == EGL_FALSE ? EGL_BAD_PARAMETER :
+                                                                                          eglImage->QueryDmaBufExport(fourcc, num_planes, modifiers);
+    if(error != EGL_SUCCESS) {
+        currentThread.RecordError(error);
+        return EGL_FALSE;
+    }
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriver::ExportDMABUFImage(EGLImageKHR image, int *fds, EGLint *strides, EGLint *offsets)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const EGLImage_t *eglImage = static_cast<const EGLImage_t *>(image);
+    const EGLint error = mDisplayDriverResourceManager.FindEGLImage(eglImage) == EGL_FALSE ? EGL_BAD_PARAMETER :
+                                                                                          eglImage->ExportDmaBuf(fds, strides, offsets);
+    if(error != EGL_SUCCESS) {
+        currentThread.RecordError(error);
+        return EGL_FALSE;
+    }
 
     return EGL_TRUE;
-#endif
-    return EGL_FALSE;
 }
 
 EGLSyncKHR
 DisplayDriver::CreateSyncKHR(EGLenum type, const EGLint *attrib_list)
 {
-    FUN_ENTRY(EGL_LOG_TRACE);
-    uintptr_t sync = 0xFE4CE000;
-    return ((EGLSyncKHR)sync);
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    // native fences are created to be exported, sync files are not imported into them
+    const vkInterface_t *vkInterface = GetVkInterface();
+    const bool nativeFence = type == EGL_SYNC_NATIVE_FENCE_ANDROID && vkInterface != nullptr && vkInterface->isSyncFdFenceSupported;
+    if(type != EGL_SYNC_FENCE_KHR && !nativeFence) {
+        currentThread.RecordError(EGL_BAD_ATTRIBUTE);
+        return EGL_NO_SYNC_KHR;
+    }
+    for(const EGLint *attrib = attrib_list; attrib != nullptr && attrib[0] != EGL_NONE; attrib += 2) {
+        if(!nativeFence || attrib[0] != EGL_SYNC_NATIVE_FENCE_FD_ANDROID || attrib[1] != EGL_NO_NATIVE_FENCE_FD_ANDROID) {
+            currentThread.RecordError(EGL_BAD_ATTRIBUTE);
+            return EGL_NO_SYNC_KHR;
+        }
+    }
+
+    // the fence is inserted in the command stream of the context current to the calling thread
+    EGLContext_t *eglContext = currentThread.GetCurrentContext();
+    if(eglContext == nullptr || eglContext->GetDisplay() != mEGLDisplay) {
+        currentThread.RecordError(EGL_BAD_MATCH);
+        return EGL_NO_SYNC_KHR;
+    }
+
+    void *fence = nativeFence ? eglContext->CreateNativeFence() : eglContext->CreateFence();
+    if(fence == nullptr) {
+        currentThread.RecordError(EGL_BAD_ALLOC);
+        return EGL_NO_SYNC_KHR;
+    }
+
+    EGLSync_t *eglSync = mDisplayDriverResourceManager.AddEGLSync(eglContext->GetAPIInterface(), fence, type);
+    return static_cast<EGLSyncKHR>(eglSync);
 }
 
 EGLBoolean
 DisplayDriver::DestroySyncKHR(EGLSyncKHR sync)
 {
-    FUN_ENTRY(EGL_LOG_TRACE);
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(mDisplayDriverResourceManager.RemoveEGLSync(static_cast<EGLSync_t *>(sync)) == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
 
     return EGL_TRUE;
 }
@@ -675,14 +1173,129 @@ DisplayDriver::DestroySyncKHR(EGLSyncKHR sync)
 EGLint
 DisplayDriver::ClientWaitSyncKHR(EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout)
 {
-    FUN_ENTRY(EGL_LOG_TRACE);
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLSync_t *eglSync = static_cast<EGLSync_t *>(sync);
+    if(mDisplayDriverResourceManager.FindEGLSync(eglSync) == EGL_FALSE) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    // the fence was submitted on creation, only the current context may still hold unsubmitted work
+    EGLContext_t *eglContext = currentThread.GetCurrentContext();
+    if((flags & EGL_SYNC_FLUSH_COMMANDS_BIT_KHR) && eglContext != nullptr && eglSync->GetStatus() == EGL_UNSIGNALED_KHR) {
+        eglContext->Flush();
+    }
+
+    return eglSync->ClientWait(timeout);
+}
+
+EGLBoolean
+DisplayDriver::GetSyncAttribKHR(EGLSyncKHR sync, EGLint attribute, EGLint *value)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLSync_t *eglSync = static_cast<EGLSync_t *>(sync);
+    if(mDisplayDriverResourceManager.FindEGLSync(eglSync) == EGL_FALSE || value == nullptr) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    switch(attribute) {
+    case EGL_SYNC_TYPE_KHR:         *value = eglSync->GetType(); break;
+    case EGL_SYNC_STATUS_KHR:       *value = eglSync->GetStatus(); break;
+    case EGL_SYNC_CONDITION_KHR:    *value = EGL_SYNC_PRIOR_COMMANDS_COMPLETE_KHR; break;
+    default:
+        currentThread.RecordError(EGL_BAD_ATTRIBUTE);
+        return EGL_FALSE;
+    }
 
-    return EGL_CONDITION_SATISFIED_KHR;
+    return EGL_TRUE;
+}
+
+EGLint
+DisplayDriver::WaitSyncKHR(EGLSyncKHR sync, EGLint flags)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLSync_t *eglSync = static_cast<EGLSync_t *>(sync);
+    if(mDisplayDriverResourceManager.FindEGLSync(eglSync) == EGL_FALSE || flags != 0) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_FALSE;
+    }
+
+    EGLContext_t *eglContext = currentThread.GetCurrentContext();
+    if(eglContext == nullptr || eglContext->GetDisplay() != mEGLDisplay) {
+        currentThread.RecordError(EGL_BAD_MATCH);
+        return EGL_FALSE;
+    }
+
+    // the GPU of the current context holds off the commands issued from now on, the CPU returns at once
+    eglContext->ServerWaitFence(eglSync->GetFence());
+
+    return EGL_TRUE;
+}
+
+EGLint
+DisplayDriver::DupNativeFenceFD(EGLSyncKHR sync)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLSync_t *eglSync = static_cast<EGLSync_t *>(sync);
+    if(mDisplayDriverResourceManager.FindEGLSync(eglSync) == EGL_FALSE || eglSync->GetType() != EGL_SYNC_NATIVE_FENCE_ANDROID) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+        return EGL_NO_NATIVE_FENCE_FD_ANDROID;
+    }
+
+    // a fence signaled before it was first exported has no sync file, and needs no waiting either
+    const EGLint fd = eglSync->DupNativeFenceFD();
+    if(fd == EGL_NO_NATIVE_FENCE_FD_ANDROID && eglSync->GetStatus() != EGL_SIGNALED_KHR) {
+        currentThread.RecordError(EGL_BAD_PARAMETER);
+    }
+
+    return fd;
 }
 
 const char *DisplayDriver::GetExtensions()
 {
-    return "";
+    static const char *baseExtensions = "EGL_EXT_buffer_age EGL_KHR_fence_sync EGL_KHR_partial_update EGL_KHR_swap_buffers_with_damage EGL_EXT_swap_buffers_with_damage EGL_KHR_wait_sync EGL_KHR_create_context_no_error EGL_GLOVE_swap_batch";
+
+    // the client buffers EGLImages are created from depend on the device of the client API
+    static std::string extensions;
+    if(!extensions.empty()) {
+        return extensions.c_str();
+    }
+
+    const vkInterface_t *vkInterface = GetVkInterface();
+    if(vkInterface == nullptr) {
+        return baseExtensions;
+    }
+
+    extensions = baseExtensions;
+    if(vkInterface->isExternalMemoryDmaBufSupported || vkInterface->isAndroidHardwareBufferSupported) {
+        extensions += " EGL_KHR_image_base";
+    }
+    if(vkInterface->isExternalMemoryDmaBufSupported) {
+        extensions += " EGL_EXT_image_dma_buf_import EGL_EXT_image_dma_buf_import_modifiers EGL_KHR_gl_texture_2D_image EGL_MESA_image_dma_buf_export";
+    }
+    if(vkInterface->isSyncFdFenceSupported) {
+        extensions += " EGL_ANDROID_native_fence_sync";
+    }
+    if(vkInterface->isAndroidHardwareBufferSupported) {
+        extensions += " EGL_ANDROID_image_native_buffer";
+    }
+    if(vkInterface->isDisplayTimingSupported) {
+        extensions += " EGL_ANDROID_presentation_time EGL_ANDROID_get_frame_timestamps";
+    } else if(vkInterface->isDisplayControlSupported) {
+        // the display present times are measured on the vblank of the display plane instead
+        extensions += " EGL_ANDROID_get_frame_timestamps";
+    }
+    const char *readback = getenv(EGL_GLOVE_PBUFFER_READBACK_ENV);
+    if(readback != nullptr && strtoul(readback, nullptr, 10) > 0) {
+        extensions += " EGL_GLOVE_pbuffer_readback";
+    }
+
+    return extensions.c_str();
 }
 
 EGLBoolean
@@ -46,21 +46,35 @@ void setCallingThread(RenderingThread *thread);
 class DisplayDriver {
 private:
     EGLDisplay_t                *mEGLDisplay;
-    EGLContext_t                *mActiveContext;
     PlatformWindowInterface     *mWindowInterface;
     DisplayDriverResourceManager mDisplayDriverResourceManager;
     bool                         mInitialized;
 
-    EGLImageKHR                  CreateImageNativeBufferAndroid(EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list);
+    /// swaps of window surfaces whose images are presented together at the end of the batch (EGL_GLOVE_swap_batch),
+    /// the damage of each is kept as it was given
+    typedef struct BatchedSwap_t {
+        EGLSurface_t            *surface;
+        std::vector<EGLint>      rects;
+    } BatchedSwap_t;
+
+    bool                         mSwapBatchActive;
+    std::vector<BatchedSwap_t>   mSwapBatch;
+
     void                         CreateEGLSurfaceInterface(EGLSurface_t *eglSurface);
     void                         UpdateSurface(EGLSurface_t *eglSurface);
+    void                         BeginNextFrame(EGLSurface_t *eglSurface, EGLBoolean presented);
+    EGLBoolean                   SwapPbuffer(EGLSurface_t *eglSurface);
+    void                         QueueSwap(EGLSurface_t *eglSurface, const EGLint *rects, EGLint nRects);
+    EGLBoolean                   PresentSwapBatch(void);
+
+    /// the context current to the calling thread, displays are shared by all threads
+    inline EGLContext_t         *GetActiveContext()                       const { FUN_ENTRY(EGL_LOG_TRACE); return currentThread.GetCurrentContext(); }
 
 public:
 
     DisplayDriver(EGLDisplay_t *eglDisplay);
     ~DisplayDriver(void);
 
-    inline void                  SetActiveContext(EGLContext ctx)               { FUN_ENTRY(EGL_LOG_TRACE); mActiveContext = static_cast<EGLContext_t *>(ctx); }
     inline bool                  Initialized()                            const { FUN_ENTRY(EGL_LOG_TRACE); return mInitialized; }
     void                         CleanMarkedResources(void);
 
@@ -73,7 +87,7 @@ public:
     /// EGL API core functions
     EGLBoolean                   Initialize(EGLint *major, EGLint *minor);
     EGLBoolean                   Terminate(void);
-    EGLContext                   CreateContext(EGLenum rendering_api, EGLConfig_t *config, const EGLint *attribList);
+    EGLContext                   CreateContext(EGLenum rendering_api, EGLConfig_t *config, EGLContext_t *shareContext, const EGLint *attribList);
     EGLBoolean                   DestroyContext(EGLContext_t *eglContext);
     EGLBoolean                   GetConfigs(EGLConfig *configs, EGLint config_size, EGLint *num_config);
     EGLBoolean                   ChooseConfig(const EGLint *attrib_list, EGLConfig *configs, EGLint config_size, EGLint *num_config);
@@ -95,9 +109,27 @@ public:
     /// EGL API extension functions
     EGLImageKHR                  CreateImageKHR(EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list);
     EGLBoolean                   DestroyImageKHR(EGLImageKHR image);
+    EGLBoolean                   QueryDmaBufFormats(EGLint max_formats, EGLint *formats, EGLint *num_formats);
+    EGLBoolean                   QueryDmaBufModifiers(EGLint format, EGLint max_modifiers, EGLuint64KHR *modifiers, EGLBoolean *external_only, EGLint *num_modifiers);
+    EGLBoolean                   ExportDMABUFImageQuery(EGLImageKHR image, int *fourcc, int *num_planes, EGLuint64KHR *modifiers);
+    EGLBoolean                   ExportDMABUFImage(EGLImageKHR image, int *fds, EGLint *strides, EGLint *offsets);
     EGLSyncKHR                   CreateSyncKHR(EGLenum type, const EGLint *attrib_list);
     EGLBoolean                   DestroySyncKHR(EGLSyncKHR sync);
     EGLint                       ClientWaitSyncKHR(EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout);
+    EGLBoolean                   GetSyncAttribKHR(EGLSyncKHR sync, EGLint attribute, EGLint *value);
+    EGLint                       WaitSyncKHR(EGLSyncKHR sync, EGLint flags);
+    EGLint                       DupNativeFenceFD(EGLSyncKHR sync);
+    EGLBoolean                   SwapBuffersWithDamage(EGLSurface_t* eglSurface, const EGLint *rects, EGLint nRects);
+    EGLBoolean                   SetDamageRegion(EGLSurface_t* eglSurface, const EGLint *rects, EGLint nRects);
+    EGLBoolean                   GetSurfaceFrame(EGLSurface_t* eglSurface, const void **pixels, EGLint *stride);
+    EGLBoolean                   BeginSwapBatch(void);
+    EGLBoolean                   EndSwapBatch(void);
+    EGLBoolean                   PresentationTime(EGLSurface_t* eglSurface, EGLnsecsANDROID time);
+    EGLBoolean                   GetCompositorTimingSupported(EGLSurface_t* eglSurface, EGLint name);
+    EGLBoolean                   GetCompositorTiming(EGLSurface_t* eglSurface, EGLint numTimestamps, const EGLint *names, EGLnsecsANDROID *values);
+    EGLBoolean                   GetNextFrameId(EGLSurface_t* eglSurface, EGLuint64KHR *frameId);
+    EGLBoolean                   GetFrameTimestampSupported(EGLSurface_t* eglSurface, EGLint timestamp);
+    EGLBoolean                   GetFrameTimestamps(EGLSurface_t* eglSurface, EGLuint64KHR frameId, EGLint numTimestamps, const EGLint *timestamps, EGLnsecsANDROID *values);
 };
 
 #endif // __DISPLAY_DRIVER_H__
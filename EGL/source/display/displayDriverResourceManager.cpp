@@ -129,13 +129,13 @@ DisplayDriverResourceManager::FindEGLContext(const EGLContext_t* eglContext) con
 }
 
 EGLContext_t*
-DisplayDriverResourceManager::CreateEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, const EGLint *attribList)
+DisplayDriverResourceManager::CreateEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, EGLContext_t *shareContext, const EGLint *attribList)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
     EGLContext_t * eglContext = new EGLContext_t(display, rendering_api, config, attribList);
 
-    if(eglContext->Create() == EGL_FALSE) {
+    if(eglContext->Create(shareContext) == EGL_FALSE) {
         delete eglContext;
         eglContext = nullptr;
     }
@@ -156,11 +156,11 @@ DisplayDriverResourceManager::DeleteEGLContext(EGLContext_t* eglContext)
 }
 
 EGLContext_t*
-DisplayDriverResourceManager::AddEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, const EGLint *attribList)
+DisplayDriverResourceManager::AddEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, EGLContext_t *shareContext, const EGLint *attribList)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    EGLContext_t *eglContext = CreateEGLContext(display, rendering_api, config, attribList);
+    EGLContext_t *eglContext = CreateEGLContext(display, rendering_api, config, shareContext, attribList);
 
     if(eglContext) {
         mContextList.push_back(eglContext);
@@ -182,6 +182,80 @@ DisplayDriverResourceManager::RemoveEGLContext(EGLContext_t* eglContext)
     return EGL_FALSE;
 }
 
+EGLBoolean
+DisplayDriverResourceManager::FindEGLSync(const EGLSync_t* eglSync) const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const auto iter = std::find(mSyncList.begin(), mSyncList.end(), eglSync);
+    if(iter == mSyncList.end()) {
+        return EGL_FALSE;
+    }
+    return EGL_TRUE;
+}
+
+EGLSync_t*
+DisplayDriverResourceManager::AddEGLSync(rendering_api_interface_t *apiInterface, void *fence, EGLenum type)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLSync_t *eglSync = new EGLSync_t(apiInterface, fence, type);
+    mSyncList.push_back(eglSync);
+
+    return eglSync;
+}
+
+EGLBoolean
+DisplayDriverResourceManager::RemoveEGLSync(EGLSync_t* eglSync)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const auto iter = std::find(mSyncList.begin(), mSyncList.end(), eglSync);
+    if(iter != mSyncList.end()) {
+        mSyncList.erase(iter);
+        delete eglSync;
+        return EGL_TRUE;
+    }
+    return EGL_FALSE;
+}
+
+EGLImage_t*
+DisplayDriverResourceManager::AddEGLImage(void)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    EGLImage_t *eglImage = new EGLImage_t();
+    mImageList.push_back(eglImage);
+
+    return eglImage;
+}
+
+EGLBoolean
+DisplayDriverResourceManager::FindEGLImage(const EGLImage_t* eglImage) const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const auto iter = std::find(mImageList.begin(), mImageList.end(), eglImage);
+    if(iter == mImageList.end()) {
+        return EGL_FALSE;
+    }
+    return EGL_TRUE;
+}
+
+EGLBoolean
+DisplayDriverResourceManager::RemoveEGLImage(EGLImage_t* eglImage)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const auto iter = std::find(mImageList.begin(), mImageList.end(), eglImage);
+    if(iter != mImageList.end()) {
+        mImageList.erase(iter);
+        delete eglImage;
+        return EGL_TRUE;
+    }
+    return EGL_FALSE;
+}
+
 void
 DisplayDriverResourceManager::CleanMarkedResources(PlatformWindowInterface *windowInterface)
 {
@@ -217,6 +291,18 @@ DisplayDriverResourceManager::CleanResources(PlatformWindowInterface *windowInte
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
+    // clear syncs, their fences belong to the client API device
+    for (auto syncIter : mSyncList) {
+        delete syncIter;
+    }
+    mSyncList.clear();
+
+    // clear images, textures made from them keep the memory they imported
+    for (auto imageIter : mImageList) {
+        delete imageIter;
+    }
+    mImageList.clear();
+
     // clear surfaces
     for (auto surfaceIter : mSurfaceList) {
         DeleteEGLSurface(windowInterface, surfaceIter);
@@ -29,6 +29,8 @@
 #include "api/eglContext.h"
 #include "api/eglConfig.h"
 #include "api/eglSurface.h"
+#include "api/eglSync.h"
+#include "api/eglImage.h"
 #include "vector"
 
 class DisplayDriverResourceManager
@@ -38,9 +40,11 @@ protected:
     std::vector<EGLSurface_t*>   mSurfaceList;
     std::vector<EGLConfig_t*>    mConfigList;
     std::vector<EGLContext_t*>   mContextList;
+    std::vector<EGLSync_t*>      mSyncList;
+    std::vector<EGLImage_t*>     mImageList;
 
     // EGLContext resources
-    EGLContext_t                *CreateEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, const EGLint *attribList);
+    EGLContext_t                *CreateEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, EGLContext_t *shareContext, const EGLint *attribList);
     EGLBoolean                   DeleteEGLContext(EGLContext_t* eglContext);
 
     // EGLSurface resources
@@ -61,10 +65,20 @@ public:
     EGLBoolean                   FindEGLSurface(const EGLSurface_t* eglSurface) const;
 
     // EGLContext resources
-    EGLContext_t                *AddEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, const EGLint *attribList);
+    EGLContext_t                *AddEGLContext(EGLDisplay_t *display, EGLenum rendering_api, EGLConfig_t *config, EGLContext_t *shareContext, const EGLint *attribList);
     EGLBoolean                   RemoveEGLContext(EGLContext_t* eglContext);
     EGLBoolean                   FindEGLContext(const EGLContext_t* eglContext) const;
 
+    // EGLSync resources
+    EGLSync_t                   *AddEGLSync(rendering_api_interface_t *apiInterface, void *fence, EGLenum type);
+    EGLBoolean                   RemoveEGLSync(EGLSync_t* eglSync);
+    EGLBoolean                   FindEGLSync(const EGLSync_t* eglSync) const;
+
+    // EGLImage resources
+    EGLImage_t                  *AddEGLImage(void);
+    EGLBoolean                   RemoveEGLImage(EGLImage_t* eglImage);
+    EGLBoolean                   FindEGLImage(const EGLImage_t* eglImage) const;
+
     void                         CleanResources(class PlatformWindowInterface *windowInterface);
     void                         CleanMarkedResources(class PlatformWindowInterface *windowInterface);
 
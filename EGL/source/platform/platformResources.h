@@ -35,6 +35,8 @@ public:
 
     virtual uint32_t    GetSwapchainImageCount() = 0;
     virtual void       *GetSwapchainImages()     = 0;
+    virtual void       *GetReadbackBuffers()     = 0;
+    virtual void       *GetSyncItems()           = 0;
 };
 
 #endif // __PLATFORM_RESOURCES_H__
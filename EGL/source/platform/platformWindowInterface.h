@@ -30,6 +30,15 @@
 #include "api/eglSurface.h"
 #include "api/eglDisplay.h"
 
+/// a swap of a window surface that is presented along with the swaps of other surfaces
+typedef struct SurfacePresent_t {
+    EGLSurface_t                    *surface;
+    const EGLint                    *rects;
+    EGLint                           nRects;
+    /// EGL_FALSE if the surface has to be recreated
+    EGLBoolean                       presented;
+} SurfacePresent_t;
+
 class PlatformWindowInterface
 {
 public:
@@ -43,7 +52,12 @@ public:
     virtual void                 DestroySurfaceImages(EGLSurface_t *eglSurface) = 0;
     virtual void                 DestroySurface(EGLSurface_t *eglSurface) = 0;
     virtual EGLBoolean           AcquireNextImage(EGLSurface_t *surface, uint32_t *imageIndex) = 0;
-    virtual EGLBoolean           PresentImage(EGLSurface_t *eglSurface) = 0;
+    /// the damage rectangles (x, y, width, height from the bottom left corner) may be empty for a full update
+    virtual EGLBoolean           PresentImage(EGLSurface_t *eglSurface, const EGLint *rects, EGLint nRects) = 0;
+    /// all the images in one presentation, EGL_FALSE if any of the surfaces has to be recreated
+    virtual EGLBoolean           PresentImages(SurfacePresent_t *presents, uint32_t count) = 0;
+    /// the host copy of a pbuffer image, null if the frames of the pbuffer are not streamed
+    virtual const void          *GetReadbackData(EGLSurface_t *eglSurface, uint32_t imageIndex) = 0;
 };
 
 #endif // __PLATFORM_WINDOW_INTERFACE_H__
@@ -50,6 +50,7 @@ public:
     VkSurfaceKHR       CreateSurface(EGLDisplay_t* dpy,
                                      EGLNativeWindowType win,
                                      EGLSurface_t *surface) override;
+    bool               PreRotatesSwapchain() const override { return true; }
 
 
 };
@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       WSIHeadless.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      WSI Headless module. There is no window system, so it gets no VkSurface and only pbuffers are rendered to.
+ *
+ */
+
+#include "WSIHeadless.h"
+
+EGLBoolean
+WSIHeadless::Initialize()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    // the instance has been created without VK_KHR_surface and the device without VK_KHR_swapchain,
+    // so there are no callbacks to get and none of them is ever called
+    memset(&mWsiCallbacks, 0, sizeof(mWsiCallbacks));
+
+    return SetPlatformCallbacks();
+}
+
+EGLBoolean
+WSIHeadless::SetPlatformCallbacks(void)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    return EGL_TRUE;
+}
+
+VkSurfaceKHR
+WSIHeadless::CreateSurface(EGLDisplay_t* dpy, EGLNativeWindowType win, EGLSurface_t *surface)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    return VK_NULL_HANDLE;
+}
@@ -21,9 +21,18 @@
  *
  */
 
+#include <cstdlib>
 #include "WSIPlaneDisplay.h"
 #include "vulkanResources.h"
 
+WSIPlaneDisplay::WSIPlaneDisplay()
+: mPlaneIndex(0), mPlaneStackIndex(0), mAlphaMode(VK_DISPLAY_PLANE_ALPHA_OPAQUE_BIT_KHR)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    memset(static_cast<void *>(&mDisplayMode), 0, sizeof(mDisplayMode));
+}
+
 EGLBoolean
 WSIPlaneDisplay::Initialize()
 {
@@ -39,6 +48,10 @@ WSIPlaneDisplay::Initialize()
 
     SetPhysicalDeviceDisplayProperties();
 
+    if(mDisplayPropertiesList.empty() || SelectDisplayMode() == EGL_FALSE || SelectPlane() == EGL_FALSE) {
+        return EGL_FALSE;
+    }
+
     return EGL_TRUE;
 }
 
@@ -52,6 +65,10 @@ WSIPlaneDisplay::SetPlatformCallbacks(void)
     // VK_KHR_display functions
     GET_WSI_FUNCTION_PTR(mWsiPlaneDisplayCallbacks, CreateDisplayPlaneSurfaceKHR);
     GET_WSI_FUNCTION_PTR(mWsiPlaneDisplayCallbacks, GetPhysicalDeviceDisplayPropertiesKHR);
+    GET_WSI_FUNCTION_PTR(mWsiPlaneDisplayCallbacks, GetPhysicalDeviceDisplayPlanePropertiesKHR);
+    GET_WSI_FUNCTION_PTR(mWsiPlaneDisplayCallbacks, GetDisplayPlaneSupportedDisplaysKHR);
+    GET_WSI_FUNCTION_PTR(mWsiPlaneDisplayCallbacks, GetDisplayModePropertiesKHR);
+    GET_WSI_FUNCTION_PTR(mWsiPlaneDisplayCallbacks, GetDisplayPlaneCapabilitiesKHR);
 
     return EGL_TRUE;
 }
@@ -67,8 +84,8 @@ WSIPlaneDisplay::CreateSurface(EGLDisplay_t* dpy, EGLNativeWindowType win, EGLSu
 
     assert(mDisplayPropertiesList.size() > 0);
 
-    surface->SetWidth(mDisplayPropertiesList[0].physicalResolution.width);
-    surface->SetHeight(mDisplayPropertiesList[0].physicalResolution.height);
+    surface->SetWidth(mDisplayMode.parameters.visibleRegion.width);
+    surface->SetHeight(mDisplayMode.parameters.visibleRegion.height);
 
     /// Create a vk surface
     VkSurfaceKHR vkSurface;
@@ -76,6 +93,12 @@ WSIPlaneDisplay::CreateSurface(EGLDisplay_t* dpy, EGLNativeWindowType win, EGLSu
     memset(static_cast<void *>(&surfaceCreateInfo), 0 ,sizeof(surfaceCreateInfo));
     surfaceCreateInfo.sType = VK_STRUCTURE_TYPE_DISPLAY_SURFACE_CREATE_INFO_KHR;
     surfaceCreateInfo.pNext = nullptr;
+    surfaceCreateInfo.displayMode = mDisplayMode.displayMode;
+    surfaceCreateInfo.planeIndex = mPlaneIndex;
+    surfaceCreateInfo.planeStackIndex = mPlaneStackIndex;
+    surfaceCreateInfo.transform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    surfaceCreateInfo.globalAlpha = 1.0f;
+    surfaceCreateInfo.alphaMode = mAlphaMode;
     surfaceCreateInfo.imageExtent.width = static_cast<uint32_t>(surface->GetWidth());
     surfaceCreateInfo.imageExtent.height = static_cast<uint32_t>(surface->GetHeight());
 
@@ -95,10 +118,143 @@ WSIPlaneDisplay::SetPhysicalDeviceDisplayProperties()
 
     VkResult ASSERT_ONLY res;
     uint32_t physicalDeviceDisplayPropertiesCount = 0;
-    res = mWsiPlaneDisplayCallbacks.fpGetPhysicalDeviceDisplayPropertiesKHR(mVkInterface->vkGpus[0], &physicalDeviceDisplayPropertiesCount, nullptr);
+    res = mWsiPlaneDisplayCallbacks.fpGetPhysicalDeviceDisplayPropertiesKHR(mVkInterface->vkPhysicalDevice, &physicalDeviceDisplayPropertiesCount, nullptr);
     assert(!res);
 
     mDisplayPropertiesList.resize(physicalDeviceDisplayPropertiesCount);
-    res = mWsiPlaneDisplayCallbacks.fpGetPhysicalDeviceDisplayPropertiesKHR(mVkInterface->vkGpus[0], &physicalDeviceDisplayPropertiesCount, mDisplayPropertiesList.data());
+    res = mWsiPlaneDisplayCallbacks.fpGetPhysicalDeviceDisplayPropertiesKHR(mVkInterface->vkPhysicalDevice, &physicalDeviceDisplayPropertiesCount, mDisplayPropertiesList.data());
     assert(!res);
 }
+
+EGLBoolean
+WSIPlaneDisplay::SelectDisplayMode()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    VkDisplayKHR display = mDisplayPropertiesList[0].display;
+
+    uint32_t modeCount = 0;
+    if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetDisplayModePropertiesKHR(mVkInterface->vkPhysicalDevice, display, &modeCount, nullptr) || !modeCount) {
+        return EGL_FALSE;
+    }
+
+    std::vector<VkDisplayModePropertiesKHR> modes(modeCount);
+    if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetDisplayModePropertiesKHR(mVkInterface->vkPhysicalDevice, display, &modeCount, modes.data())) {
+        return EGL_FALSE;
+    }
+    modes.resize(modeCount);
+
+    // refresh rates are in millihertz, the requested one in hertz
+    const char *env = getenv(EGL_GLOVE_DISPLAY_REFRESH_RATE_ENV);
+    uint64_t requestedRate = env ? static_cast<uint64_t>(strtoul(env, nullptr, 10)) * 1000 : 0;
+
+    const VkExtent2D &resolution = mDisplayPropertiesList[0].physicalResolution;
+    const VkDisplayModePropertiesKHR *selected = nullptr;
+    bool selectedNative = false;
+    for(const auto &mode : modes) {
+        bool native = mode.parameters.visibleRegion.width  == resolution.width &&
+                      mode.parameters.visibleRegion.height == resolution.height;
+        if(selected && selectedNative && !native) {
+            continue;
+        }
+
+        uint32_t rate = mode.parameters.refreshRate;
+        bool better = !selected || (native && !selectedNative);
+        if(!better && requestedRate) {
+            uint64_t distance         = rate > requestedRate ? rate - requestedRate : requestedRate - rate;
+            uint64_t selectedRate     = selected->parameters.refreshRate;
+            uint64_t selectedDistance = selectedRate > requestedRate ? selectedRate - requestedRate : requestedRate - selectedRate;
+            better = distance < selectedDistance;
+        } else if(!better) {
+            better = rate > selected->parameters.refreshRate;
+        }
+
+        if(better) {
+            selected       = &mode;
+            selectedNative = native;
+        }
+    }
+
+    mDisplayMode = *selected;
+
+    return EGL_TRUE;
+}
+
+EGLBoolean
+WSIPlaneDisplay::SelectPlane()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    VkDisplayKHR display = mDisplayPropertiesList[0].display;
+
+    uint32_t planeCount = 0;
+    if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetPhysicalDeviceDisplayPlanePropertiesKHR(mVkInterface->vkPhysicalDevice, &planeCount, nullptr) || !planeCount) {
+        return EGL_FALSE;
+    }
+
+    std::vector<VkDisplayPlanePropertiesKHR> planes(planeCount);
+    if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetPhysicalDeviceDisplayPlanePropertiesKHR(mVkInterface->vkPhysicalDevice, &planeCount, planes.data())) {
+        return EGL_FALSE;
+    }
+
+    for(uint32_t plane = 0; plane < planeCount; ++plane) {
+        // a plane already in use by another display can not be flipped to
+        if(planes[plane].currentDisplay != VK_NULL_HANDLE && planes[plane].currentDisplay != display) {
+            continue;
+        }
+
+        uint32_t displayCount = 0;
+        if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetDisplayPlaneSupportedDisplaysKHR(mVkInterface->vkPhysicalDevice, plane, &displayCount, nullptr) || !displayCount) {
+            continue;
+        }
+
+        std::vector<VkDisplayKHR> displays(displayCount);
+        if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetDisplayPlaneSupportedDisplaysKHR(mVkInterface->vkPhysicalDevice, plane, &displayCount, displays.data())) {
+            continue;
+        }
+
+        bool supported = false;
+        for(uint32_t i = 0; i < displayCount; ++i) {
+            supported |= displays[i] == display;
+        }
+        if(!supported) {
+            continue;
+        }
+
+        VkDisplayPlaneCapabilitiesKHR capabilities;
+        if(VK_SUCCESS != mWsiPlaneDisplayCallbacks.fpGetDisplayPlaneCapabilitiesKHR(mVkInterface->vkPhysicalDevice, mDisplayMode.displayMode, plane, &capabilities)) {
+            continue;
+        }
+
+        mPlaneIndex      = plane;
+        mPlaneStackIndex = planes[plane].currentStackIndex;
+        if(capabilities.supportedAlpha & VK_DISPLAY_PLANE_ALPHA_OPAQUE_BIT_KHR) {
+            mAlphaMode = VK_DISPLAY_PLANE_ALPHA_OPAQUE_BIT_KHR;
+        } else {
+            uint32_t alpha = capabilities.supportedAlpha;
+            mAlphaMode = static_cast<VkDisplayPlaneAlphaFlagBitsKHR>(alpha & ~(alpha - 1));
+        }
+
+        return EGL_TRUE;
+    }
+
+    return EGL_FALSE;
+}
+
+VkDisplayKHR
+WSIPlaneDisplay::GetDirectDisplay() const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    return mDisplayPropertiesList.empty() ? VK_NULL_HANDLE : mDisplayPropertiesList[0].display;
+}
+
+uint64_t
+WSIPlaneDisplay::GetRefreshDuration() const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    uint32_t refreshRate = mDisplayMode.parameters.refreshRate;
+
+    return refreshRate ? 1000000000000ull / refreshRate : 0;
+}
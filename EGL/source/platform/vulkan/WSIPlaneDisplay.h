@@ -34,25 +34,36 @@ protected:
         // VK_KHR_display functions
         PFN_vkCreateDisplayPlaneSurfaceKHR              fpCreateDisplayPlaneSurfaceKHR;
         PFN_vkGetPhysicalDeviceDisplayPropertiesKHR     fpGetPhysicalDeviceDisplayPropertiesKHR;
+        PFN_vkGetPhysicalDeviceDisplayPlanePropertiesKHR fpGetPhysicalDeviceDisplayPlanePropertiesKHR;
+        PFN_vkGetDisplayPlaneSupportedDisplaysKHR       fpGetDisplayPlaneSupportedDisplaysKHR;
+        PFN_vkGetDisplayModePropertiesKHR               fpGetDisplayModePropertiesKHR;
+        PFN_vkGetDisplayPlaneCapabilitiesKHR            fpGetDisplayPlaneCapabilitiesKHR;
     } wsiPlaneDisplayCallbacks_t;
 
     wsiPlaneDisplayCallbacks_t                          mWsiPlaneDisplayCallbacks;
     std::vector<VkDisplayPropertiesKHR>                 mDisplayPropertiesList;
 
+    /// the mode of the first display and the plane its frames are scanned out of
+    VkDisplayModePropertiesKHR                          mDisplayMode;
+    uint32_t                                            mPlaneIndex;
+    uint32_t                                            mPlaneStackIndex;
+    VkDisplayPlaneAlphaFlagBitsKHR                      mAlphaMode;
+
     void               SetPhysicalDeviceDisplayProperties();
+    EGLBoolean         SelectDisplayMode();
+    EGLBoolean         SelectPlane();
     EGLBoolean         SetPlatformCallbacks() override;
 
 public:
-    WSIPlaneDisplay() {}
+    WSIPlaneDisplay();
     ~WSIPlaneDisplay() override {}
 
     EGLBoolean         Initialize() override;
     VkSurfaceKHR       CreateSurface(EGLDisplay_t* dpy,
                                      EGLNativeWindowType win,
                                      EGLSurface_t *surface) override;
-
-
-
+    VkDisplayKHR       GetDirectDisplay() const override;
+    uint64_t           GetRefreshDuration() const override;
 };
 
 #endif // __WSI_PLANE_DISPLAY_H__
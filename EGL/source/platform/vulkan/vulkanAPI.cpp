@@ -22,12 +22,20 @@
  */
 
 #include "vulkanAPI.h"
+#include <cstring>
 
 VulkanAPI::VulkanAPI(vkInterface_t *vkInterface)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
     mVkInterface = vkInterface;
+#ifdef VK_GOOGLE_display_timing
+    mFpGetRefreshCycleDuration   = nullptr;
+    mFpGetPastPresentationTiming = nullptr;
+#endif // VK_GOOGLE_display_timing
+#ifdef VK_EXT_display_control
+    mFpRegisterDisplayEvent      = nullptr;
+#endif // VK_EXT_display_control
 }
 
 VulkanAPI::~VulkanAPI()
@@ -41,7 +49,7 @@ VulkanAPI::DoesSupportPresent(const VulkanResources *vkResources)
     FUN_ENTRY(DEBUG_DEPTH);
 
     VkBool32 supportsPresent;
-    vkGetPhysicalDeviceSurfaceSupportKHR(mVkInterface->vkGpus[0], mVkInterface->vkGraphicsQueueNodeIndex, vkResources->GetSurface(), &supportsPresent);
+    vkGetPhysicalDeviceSurfaceSupportKHR(mVkInterface->vkPhysicalDevice, mVkInterface->vkGraphicsQueueNodeIndex, vkResources->GetSurface(), &supportsPresent);
 
     return (supportsPresent == VK_TRUE) ? EGL_TRUE : EGL_FALSE;
 }
@@ -50,6 +58,7 @@ VkSwapchainKHR
 VulkanAPI::CreateSwapchain(const VulkanResources *vkResources,
                                     uint32_t desiredNumberOfSwapChainImages,
                                     VkSurfaceCapabilitiesKHR surfCapabilities,
+                                    VkSurfaceTransformFlagBitsKHR preTransform,
                                     VkExtent2D swapChainExtent,
                                     VkPresentModeKHR swapchainPresentMode,
                                     VkFormat surfaceColorFormat,
@@ -57,14 +66,6 @@ VulkanAPI::CreateSwapchain(const VulkanResources *vkResources,
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    VkSurfaceTransformFlagBitsKHR preTransform;
-    if (surfCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) {
-        preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
-    }
-    else {
-        preTransform = surfCapabilities.currentTransform;
-    }
-
     // Find a supported composite alpha mode - one of these is guaranteed to be set
     const VkCompositeAlphaFlagBitsKHR compositeAlphaFlagBits[4] = {
         VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
@@ -97,7 +98,9 @@ VulkanAPI::CreateSwapchain(const VulkanResources *vkResources,
     swapChainCreateInfo.oldSwapchain          = oldSwapchain;
     swapChainCreateInfo.clipped               = true;
     swapChainCreateInfo.imageColorSpace       = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
-    swapChainCreateInfo.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    // framebuffer blits may draw to the window as well
+    swapChainCreateInfo.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                                (surfCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
     swapChainCreateInfo.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE;
     swapChainCreateInfo.queueFamilyIndexCount = 0;
     swapChainCreateInfo.pQueueFamilyIndices   = nullptr;
@@ -135,7 +138,7 @@ VulkanAPI::GetPhysicalDevFormats(const VulkanResources *vkResources, uint32_t fo
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    VkResult  res = vkGetPhysicalDeviceSurfaceFormatsKHR(mVkInterface->vkGpus[0], vkResources->GetSurface(), &formatCount, formats);
+    VkResult  res = vkGetPhysicalDeviceSurfaceFormatsKHR(mVkInterface->vkPhysicalDevice, vkResources->GetSurface(), &formatCount, formats);
 
     return (VK_SUCCESS == res) ? EGL_TRUE : EGL_FALSE;
 }
@@ -147,7 +150,7 @@ VulkanAPI::GetPhysicalDevFormatsCount(const VulkanResources *vkResources)
 
     VkResult res;
     uint32_t formatCount = 0;
-    res = vkGetPhysicalDeviceSurfaceFormatsKHR(mVkInterface->vkGpus[0], vkResources->GetSurface(), &formatCount, nullptr);
+    res = vkGetPhysicalDeviceSurfaceFormatsKHR(mVkInterface->vkPhysicalDevice, vkResources->GetSurface(), &formatCount, nullptr);
 
     return (VK_SUCCESS == res) ? formatCount : 0;
 }
@@ -157,7 +160,14 @@ VulkanAPI::GetPhysicalDevFormatProperties(VkFormat format, VkFormatProperties *f
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    vkGetPhysicalDeviceFormatProperties(mVkInterface->vkGpus[0], format, formatProperties);
+    auto it = mFormatProperties.find(format);
+    if(it == mFormatProperties.end()) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(mVkInterface->vkPhysicalDevice, format, &properties);
+        it = mFormatProperties.emplace(format, properties).first;
+    }
+
+    *formatProperties = it->second;
 }
 
 EGLBoolean
@@ -165,7 +175,7 @@ VulkanAPI::GetPhysicalDevPresentModes(const VulkanResources *vkResources, uint32
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    VkResult res = vkGetPhysicalDeviceSurfacePresentModesKHR(mVkInterface->vkGpus[0], vkResources->GetSurface(), &presentModeCount, presentModes);
+    VkResult res = vkGetPhysicalDeviceSurfacePresentModesKHR(mVkInterface->vkPhysicalDevice, vkResources->GetSurface(), &presentModeCount, presentModes);
 
     return (VK_SUCCESS == res) ? EGL_TRUE : EGL_FALSE;
 }
@@ -177,7 +187,7 @@ VulkanAPI::GetPhysicalDevPresentModesCount(const VulkanResources *vkResources)
 
     VkResult res;
     uint32_t presentModeCount = 0;
-    res = vkGetPhysicalDeviceSurfacePresentModesKHR(mVkInterface->vkGpus[0], vkResources->GetSurface(), &presentModeCount, nullptr);
+    res = vkGetPhysicalDeviceSurfacePresentModesKHR(mVkInterface->vkPhysicalDevice, vkResources->GetSurface(), &presentModeCount, nullptr);
 
     return (VK_SUCCESS == res) ? presentModeCount : 0;
 }
@@ -187,20 +197,20 @@ VulkanAPI::GetPhysicalDevSurfaceCapabilities(const VulkanResources *vkResources,
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    VkResult res = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mVkInterface->vkGpus[0], vkResources->GetSurface(), surfCapabilities);
+    VkResult res = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mVkInterface->vkPhysicalDevice, vkResources->GetSurface(), surfCapabilities);
 
     return (VK_SUCCESS == res) ? EGL_TRUE : EGL_FALSE;
 }
 
 VkResult
-VulkanAPI::AcquireNextImage(const VulkanResources *vkResources, uint32_t *imageIndex)
+VulkanAPI::AcquireNextImage(const VulkanResources *vkResources, VkSemaphore vkSemaphore, uint32_t *imageIndex)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
     VkResult res = mWsiCallbacks->fpAcquireNextImageKHR(mVkInterface->vkDevice,
                                                         vkResources->GetSwapchain(),
                                                         UINT64_MAX,
-                                                        mVkInterface->vkSyncItems->vkAcquireSemaphore,
+                                                        vkSemaphore,
                                                         VK_NULL_HANDLE,
                                                         imageIndex);
 
@@ -210,26 +220,249 @@ VulkanAPI::AcquireNextImage(const VulkanResources *vkResources, uint32_t *imageI
 }
 
 VkResult
-VulkanAPI::PresentImage(const VulkanResources *vkResources, uint32_t imageIndex, std::vector<VkSemaphore> &vkSemaphores)
+VulkanAPI::PresentImages(std::vector<SwapchainPresent_t> &presents)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
+    const uint32_t count = static_cast<uint32_t>(presents.size());
+    std::vector<VkSwapchainKHR> swapchains(count);
+    std::vector<uint32_t>       imageIndices(count);
+    std::vector<VkSemaphore>    semaphores;
+    std::vector<VkResult>       results(count, VK_SUCCESS);
+    bool                        hasRegions = false;
+    for(uint32_t i = 0; i < count; ++i) {
+        swapchains[i]   = presents[i].vkResources->GetSwapchain();
+        imageIndices[i] = presents[i].imageIndex;
+        if(presents[i].waitSemaphore != VK_NULL_HANDLE) {
+            semaphores.push_back(presents[i].waitSemaphore);
+        }
+        hasRegions |= !presents[i].regions.empty();
+    }
+
     VkPresentInfoKHR presentInfo;
-    VkSwapchainKHR swapchain        = vkResources->GetSwapchain();
     presentInfo.sType               = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.pNext               = nullptr;
-    presentInfo.waitSemaphoreCount  = static_cast<uint32_t>(vkSemaphores.size());
-    presentInfo.pWaitSemaphores     = vkSemaphores.data();
-    presentInfo.swapchainCount      = 1;
-    presentInfo.pSwapchains         = &swapchain;
-    presentInfo.pImageIndices       = &imageIndex;
-    presentInfo.pResults            = nullptr;
+    presentInfo.waitSemaphoreCount  = static_cast<uint32_t>(semaphores.size());
+    presentInfo.pWaitSemaphores     = semaphores.data();
+    presentInfo.swapchainCount      = count;
+    presentInfo.pSwapchains         = swapchains.data();
+    presentInfo.pImageIndices       = imageIndices.data();
+    presentInfo.pResults            = results.data();
+
+#ifdef VK_KHR_incremental_present
+    /// a swapchain without rectangles is updated as a whole
+    std::vector<VkPresentRegionKHR> presentRegion(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        presentRegion[i].rectangleCount = static_cast<uint32_t>(presents[i].regions.size());
+        presentRegion[i].pRectangles    = presents[i].regions.data();
+    }
+
+    VkPresentRegionsKHR presentRegions;
+    presentRegions.sType            = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR;
+    presentRegions.pNext            = nullptr;
+    presentRegions.swapchainCount   = count;
+    presentRegions.pRegions         = presentRegion.data();
+
+    if(hasRegions) {
+        presentInfo.pNext           = &presentRegions;
+    }
+#else
+    (void)hasRegions;
+#endif // VK_KHR_incremental_present
+
+#ifdef VK_GOOGLE_display_timing
+    std::vector<VkPresentTimeGOOGLE> presentTime(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        presentTime[i].presentID          = presents[i].presentID;
+        presentTime[i].desiredPresentTime = presents[i].desiredPresentTime;
+    }
+
+    VkPresentTimesInfoGOOGLE presentTimes;
+    presentTimes.sType              = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+    presentTimes.pNext              = presentInfo.pNext;
+    presentTimes.swapchainCount     = count;
+    presentTimes.pTimes             = presentTime.data();
 
+    if(mVkInterface->isDisplayTimingSupported) {
+        presentInfo.pNext           = &presentTimes;
+    }
+#endif // VK_GOOGLE_display_timing
+
+    mVkInterface->vkLockQueue(true);
     VkResult res = mWsiCallbacks->fpQueuePresentKHR(mVkInterface->vkQueue, &presentInfo);
+    mVkInterface->vkLockQueue(false);
+
+    for(uint32_t i = 0; i < count; ++i) {
+        presents[i].result = (res == VK_SUCCESS || res == VK_SUBOPTIMAL_KHR) ? results[i] : res;
+    }
 
     return res;
 }
 
+EGLBoolean
+VulkanAPI::CreateSyncItems(vkSyncItems_t *syncItems)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo;
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+    semaphoreCreateInfo.flags = 0;
+
+    memset(static_cast<void *>(syncItems), 0, sizeof(vkSyncItems_t));
+
+    VkResult res = vkCreateSemaphore(mVkInterface->vkDevice, &semaphoreCreateInfo, nullptr, &syncItems->vkSpareAcquireSemaphore);
+    for(uint32_t i = 0; res == VK_SUCCESS && i < GLOVE_MAX_SWAPCHAIN_IMAGES; ++i) {
+        res = vkCreateSemaphore(mVkInterface->vkDevice, &semaphoreCreateInfo, nullptr, &syncItems->vkImageAcquireSemaphores[i]);
+        if(res == VK_SUCCESS) {
+            res = vkCreateSemaphore(mVkInterface->vkDevice, &semaphoreCreateInfo, nullptr, &syncItems->vkImageDrawSemaphores[i]);
+        }
+    }
+
+    if(res != VK_SUCCESS) {
+        DestroySyncItems(syncItems);
+        return EGL_FALSE;
+    }
+
+    // nothing waits on an acquire before the surface acquires its first image
+    syncItems->vkAcquireSemaphore = syncItems->vkImageAcquireSemaphores[0];
+    syncItems->vkDrawSemaphore    = syncItems->vkImageDrawSemaphores[0];
+    syncItems->maxFramesInFlight  = mVkInterface->vkSyncItems->maxFramesInFlight;
+
+    return EGL_TRUE;
+}
+
+void
+VulkanAPI::DestroySyncItems(vkSyncItems_t *syncItems)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(syncItems->vkSpareAcquireSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(mVkInterface->vkDevice, syncItems->vkSpareAcquireSemaphore, nullptr);
+    }
+    for(uint32_t i = 0; i < GLOVE_MAX_SWAPCHAIN_IMAGES; ++i) {
+        if(syncItems->vkImageAcquireSemaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(mVkInterface->vkDevice, syncItems->vkImageAcquireSemaphores[i], nullptr);
+        }
+        if(syncItems->vkImageDrawSemaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(mVkInterface->vkDevice, syncItems->vkImageDrawSemaphores[i], nullptr);
+        }
+    }
+
+    memset(static_cast<void *>(syncItems), 0, sizeof(vkSyncItems_t));
+}
+
+#ifdef VK_GOOGLE_display_timing
+void
+VulkanAPI::LoadDisplayTimingFunctions(void)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    if(mFpGetRefreshCycleDuration == nullptr) {
+        mFpGetRefreshCycleDuration   = reinterpret_cast<PFN_vkGetRefreshCycleDurationGOOGLE>(
+                                       vkGetDeviceProcAddr(mVkInterface->vkDevice, "vkGetRefreshCycleDurationGOOGLE"));
+        mFpGetPastPresentationTiming = reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(
+                                       vkGetDeviceProcAddr(mVkInterface->vkDevice, "vkGetPastPresentationTimingGOOGLE"));
+    }
+}
+#endif // VK_GOOGLE_display_timing
+
+uint64_t
+VulkanAPI::GetRefreshCycleDuration(const VulkanResources *vkResources)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+#ifdef VK_GOOGLE_display_timing
+    if(mVkInterface->isDisplayTimingSupported) {
+        LoadDisplayTimingFunctions();
+
+        VkRefreshCycleDurationGOOGLE refreshCycle;
+        if(mFpGetRefreshCycleDuration &&
+           mFpGetRefreshCycleDuration(mVkInterface->vkDevice, vkResources->GetSwapchain(), &refreshCycle) == VK_SUCCESS) {
+            return refreshCycle.refreshDuration;
+        }
+    }
+#else
+    (void)vkResources;
+#endif // VK_GOOGLE_display_timing
+
+    return 0;
+}
+
+#ifdef VK_GOOGLE_display_timing
+EGLBoolean
+VulkanAPI::GetPastPresentationTiming(const VulkanResources *vkResources, std::vector<VkPastPresentationTimingGOOGLE> *timings)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    timings->clear();
+
+    if(mVkInterface->isDisplayTimingSupported) {
+        LoadDisplayTimingFunctions();
+        if(mFpGetPastPresentationTiming == nullptr) {
+            return EGL_FALSE;
+        }
+
+        VkResult res;
+        uint32_t timingCount = 0;
+        do {
+            res = mFpGetPastPresentationTiming(mVkInterface->vkDevice, vkResources->GetSwapchain(), &timingCount, nullptr);
+            if(!timingCount || res != VK_SUCCESS) {
+                break;
+            }
+
+            timings->resize(timingCount);
+            res = mFpGetPastPresentationTiming(mVkInterface->vkDevice, vkResources->GetSwapchain(), &timingCount, timings->data());
+            timings->resize(timingCount);
+        } while(res == VK_INCOMPLETE);
+
+        return (res == VK_SUCCESS) ? EGL_TRUE : EGL_FALSE;
+    }
+
+    return EGL_FALSE;
+}
+#endif // VK_GOOGLE_display_timing
+
+EGLBoolean
+VulkanAPI::WaitForDisplayVBlank(VkDisplayKHR display, uint64_t timeout)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+#ifdef VK_EXT_display_control
+    if(!mVkInterface->isDisplayControlSupported || display == VK_NULL_HANDLE) {
+        return EGL_FALSE;
+    }
+
+    if(mFpRegisterDisplayEvent == nullptr) {
+        mFpRegisterDisplayEvent = reinterpret_cast<PFN_vkRegisterDisplayEventEXT>(
+                                  vkGetDeviceProcAddr(mVkInterface->vkDevice, "vkRegisterDisplayEventEXT"));
+        if(mFpRegisterDisplayEvent == nullptr) {
+            return EGL_FALSE;
+        }
+    }
+
+    VkDisplayEventInfoEXT eventInfo;
+    memset(static_cast<void *>(&eventInfo), 0, sizeof(eventInfo));
+    eventInfo.sType        = VK_STRUCTURE_TYPE_DISPLAY_EVENT_INFO_EXT;
+    eventInfo.displayEvent = VK_DISPLAY_EVENT_TYPE_FIRST_PIXEL_OUT_EXT;
+
+    VkFence fence = VK_NULL_HANDLE;
+    if(mFpRegisterDisplayEvent(mVkInterface->vkDevice, display, &eventInfo, nullptr, &fence) != VK_SUCCESS) {
+        return EGL_FALSE;
+    }
+
+    VkResult res = vkWaitForFences(mVkInterface->vkDevice, 1, &fence, VK_TRUE, timeout);
+    vkDestroyFence(mVkInterface->vkDevice, fence, nullptr);
+
+    return (res == VK_SUCCESS) ? EGL_TRUE : EGL_FALSE;
+#else
+    (void)display;
+    (void)timeout;
+
+    return EGL_FALSE;
+#endif // VK_EXT_display_control
+}
+
 void
 VulkanAPI::DestroySwapchain(const VulkanResources *vkResources)
 {
@@ -27,6 +27,7 @@
 #include "vulkanResources.h"
 #include "vulkanWSI.h"
 #include "rendering_api_interface.h"
+#include <map>
 #include <vector>
 
 #ifdef DEBUG_DEPTH
@@ -34,12 +35,42 @@
 #endif // DEBUG_DEPTH
 #define DEBUG_DEPTH EGL_LOG_DEBUG
 
+/// the image of one swapchain given to a present, along with its result
+typedef struct SwapchainPresent_t {
+    const VulkanResources           *vkResources;
+    uint32_t                         imageIndex;
+    /// VK_NULL_HANDLE if the image is presented without waiting
+    VkSemaphore                      waitSemaphore;
+    /// empty for a full update
+    std::vector<VkRectLayerKHR>      regions;
+    /// VK_GOOGLE_display_timing, a desired present time of 0 has no constraint
+    uint32_t                         presentID;
+    uint64_t                         desiredPresentTime;
+    VkResult                         result;
+} SwapchainPresent_t;
+
 class VulkanAPI
 {
 private:
     vkInterface_t                    *mVkInterface;
     const VulkanWSI::wsiCallbacks_t  *mWsiCallbacks;
 
+    /// format features do not change for the life of the device, every surface asks for the same ones
+    std::map<VkFormat, VkFormatProperties> mFormatProperties;
+
+#ifdef VK_GOOGLE_display_timing
+    /// device functions of VK_GOOGLE_display_timing, loaded the first time they are needed
+    PFN_vkGetRefreshCycleDurationGOOGLE   mFpGetRefreshCycleDuration;
+    PFN_vkGetPastPresentationTimingGOOGLE mFpGetPastPresentationTiming;
+
+    void                         LoadDisplayTimingFunctions(void);
+#endif // VK_GOOGLE_display_timing
+
+#ifdef VK_EXT_display_control
+    /// device function of VK_EXT_display_control, loaded the first time it is needed
+    PFN_vkRegisterDisplayEventEXT         mFpRegisterDisplayEvent;
+#endif // VK_EXT_display_control
+
 public:
     VulkanAPI(vkInterface_t *vkInterface);
     ~VulkanAPI();
@@ -48,6 +79,7 @@ public:
     VkSwapchainKHR               CreateSwapchain(const VulkanResources *vkResources,
                                                  uint32_t desiredNumberOfSwapChainImages,
                                                  VkSurfaceCapabilitiesKHR surfCapabilities,
+                                                 VkSurfaceTransformFlagBitsKHR preTransform,
                                                  VkExtent2D swapChainExtent,
                                                  VkPresentModeKHR swapchainPresentMode,
                                                  VkFormat surfaceColorFormat,
@@ -61,8 +93,21 @@ public:
     EGLBoolean                   GetPhysicalDevPresentModes(const VulkanResources *vkResources, uint32_t presentModeCount, VkPresentModeKHR *presentModes);
     uint32_t                     GetPhysicalDevPresentModesCount(const VulkanResources *vkResources);
     EGLBoolean                   GetPhysicalDevSurfaceCapabilities(const VulkanResources *vkResources, VkSurfaceCapabilitiesKHR *surfCapabilities);
-    VkResult                     AcquireNextImage(const VulkanResources *vkResources, uint32_t *imageIndex);
-    VkResult                     PresentImage(const VulkanResources *vkResources, uint32_t imageIndex, std::vector<VkSemaphore> &vkSemaphores);
+    VkResult                     AcquireNextImage(const VulkanResources *vkResources, VkSemaphore vkSemaphore, uint32_t *imageIndex);
+    /// the swapchains are presented together in one call, each gets its own result
+    VkResult                     PresentImages(std::vector<SwapchainPresent_t> &presents);
+
+    EGLBoolean                   CreateSyncItems(vkSyncItems_t *syncItems);
+    void                         DestroySyncItems(vkSyncItems_t *syncItems);
+
+    /// VK_GOOGLE_display_timing, all times are in nanoseconds of CLOCK_MONOTONIC
+    uint64_t                     GetRefreshCycleDuration(const VulkanResources *vkResources);
+#ifdef VK_GOOGLE_display_timing
+    EGLBoolean                   GetPastPresentationTiming(const VulkanResources *vkResources, std::vector<VkPastPresentationTimingGOOGLE> *timings);
+#endif // VK_GOOGLE_display_timing
+
+    /// VK_EXT_display_control, blocks until the next frame starts being scanned out of the display or the timeout expires
+    EGLBoolean                   WaitForDisplayVBlank(VkDisplayKHR display, uint64_t timeout);
 
     void                         DestroySwapchain(const VulkanResources *vkResources);
     void                         DestroyPlatformSurface(const VulkanResources *vkResources);
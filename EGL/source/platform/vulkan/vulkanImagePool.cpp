@@ -0,0 +1,317 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       vulkanImagePool.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Pool of the images pbuffer surfaces render to. The images of a destroyed pbuffer are kept for the next one of the same size.
+ *
+ *  @section
+ *
+ *  Services that render offscreen create and destroy pbuffers of a few sizes
+ *  over and over. Instead of allocating device memory for each of them, the
+ *  images of a destroyed pbuffer return to the pool and the next pbuffer of
+ *  the same size and format gets them back. Reuse needs no wait, since all
+ *  contexts submit to the same queue and the new pbuffer starts from the
+ *  undefined layout; the GPU is only waited upon before an image is freed.
+ *
+ */
+
+#include "vulkanImagePool.h"
+#include "utils/egl_defs.h"
+#include <iterator>
+
+VulkanImagePool::VulkanImagePool()
+: mVkInterface(nullptr)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+}
+
+VulkanImagePool::~VulkanImagePool()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    assert(mFreeImages.empty() && mUsedImages.empty());
+}
+
+bool
+VulkanImagePool::FindMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags flags, uint32_t *typeIndex) const
+{
+    FUN_ENTRY(EGL_LOG_TRACE);
+
+    const VkPhysicalDeviceMemoryProperties &memoryProperties = mVkInterface->vkDeviceMemoryProperties;
+    for(uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+        if((memoryTypeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & flags) == flags) {
+            *typeIndex = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+VulkanImagePool::CreateImage(uint32_t width, uint32_t height, VkFormat format, poolImage_t *poolImage)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    memset(static_cast<void *>(poolImage), 0, sizeof(*poolImage));
+    poolImage->width  = width;
+    poolImage->height = height;
+    poolImage->format = format;
+
+    VkImageCreateInfo imageInfo;
+    memset(static_cast<void *>(&imageInfo), 0, sizeof(imageInfo));
+    imageInfo.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.pNext                 = nullptr;
+    imageInfo.flags                 = 0;
+    imageInfo.imageType             = VK_IMAGE_TYPE_2D;
+    imageInfo.format                = format;
+    imageInfo.extent                = { width, height, 1 };
+    imageInfo.mipLevels             = 1;
+    imageInfo.arrayLayers           = 1;
+    imageInfo.samples               = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling                = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage                 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    imageInfo.sharingMode           = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.queueFamilyIndexCount = 0;
+    imageInfo.pQueueFamilyIndices   = nullptr;
+    imageInfo.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if(vkCreateImage(mVkInterface->vkDevice, &imageInfo, nullptr, &poolImage->image) != VK_SUCCESS) {
+        poolImage->image = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(mVkInterface->vkDevice, poolImage->image, &memoryRequirements);
+
+    VkMemoryAllocateInfo allocateInfo;
+    allocateInfo.sType              = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.pNext              = nullptr;
+    allocateInfo.allocationSize     = memoryRequirements.size;
+    if(!FindMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &allocateInfo.memoryTypeIndex) &&
+       !FindMemoryType(memoryRequirements.memoryTypeBits, 0, &allocateInfo.memoryTypeIndex)) {
+        DestroyImage(poolImage);
+        return false;
+    }
+
+    if(vkAllocateMemory(mVkInterface->vkDevice, &allocateInfo, nullptr, &poolImage->memory) != VK_SUCCESS) {
+        poolImage->memory = VK_NULL_HANDLE;
+        DestroyImage(poolImage);
+        return false;
+    }
+
+    if(vkBindImageMemory(mVkInterface->vkDevice, poolImage->image, poolImage->memory, 0) != VK_SUCCESS) {
+        DestroyImage(poolImage);
+        return false;
+    }
+
+    return true;
+}
+
+bool
+VulkanImagePool::CreateReadbackBuffer(poolImage_t *poolImage)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    VkBufferCreateInfo bufferInfo;
+    memset(static_cast<void *>(&bufferInfo), 0, sizeof(bufferInfo));
+    bufferInfo.sType                = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.pNext                = nullptr;
+    bufferInfo.flags                = 0;
+    bufferInfo.size                 = static_cast<VkDeviceSize>(poolImage->width) * poolImage->height * EGL_GLOVE_PBUFFER_BYTES_PER_PIXEL;
+    bufferInfo.usage                = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode          = VK_SHARING_MODE_EXCLUSIVE;
+
+    if(vkCreateBuffer(mVkInterface->vkDevice, &bufferInfo, nullptr, &poolImage->readbackBuffer) != VK_SUCCESS) {
+        poolImage->readbackBuffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(mVkInterface->vkDevice, poolImage->readbackBuffer, &memoryRequirements);
+
+    // the host reads every byte of each frame, which is much faster out of cached memory
+    VkMemoryAllocateInfo allocateInfo;
+    allocateInfo.sType              = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.pNext              = nullptr;
+    allocateInfo.allocationSize     = memoryRequirements.size;
+    if(!FindMemoryType(memoryRequirements.memoryTypeBits,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                       &allocateInfo.memoryTypeIndex) &&
+       !FindMemoryType(memoryRequirements.memoryTypeBits,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                       &allocateInfo.memoryTypeIndex)) {
+        return false;
+    }
+
+    if(vkAllocateMemory(mVkInterface->vkDevice, &allocateInfo, nullptr, &poolImage->readbackMemory) != VK_SUCCESS) {
+        poolImage->readbackMemory = VK_NULL_HANDLE;
+        return false;
+    }
+
+    if(vkBindBufferMemory(mVkInterface->vkDevice, poolImage->readbackBuffer, poolImage->readbackMemory, 0) != VK_SUCCESS ||
+       vkMapMemory(mVkInterface->vkDevice, poolImage->readbackMemory, 0, VK_WHOLE_SIZE, 0, &poolImage->readbackData) != VK_SUCCESS) {
+        poolImage->readbackData = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+void
+VulkanImagePool::DestroyImage(poolImage_t *poolImage)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    if(poolImage->readbackData != nullptr) {
+        vkUnmapMemory(mVkInterface->vkDevice, poolImage->readbackMemory);
+        poolImage->readbackData = nullptr;
+    }
+    if(poolImage->readbackBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(mVkInterface->vkDevice, poolImage->readbackBuffer, nullptr);
+        poolImage->readbackBuffer = VK_NULL_HANDLE;
+    }
+    if(poolImage->readbackMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(mVkInterface->vkDevice, poolImage->readbackMemory, nullptr);
+        poolImage->readbackMemory = VK_NULL_HANDLE;
+    }
+    if(poolImage->image != VK_NULL_HANDLE) {
+        vkDestroyImage(mVkInterface->vkDevice, poolImage->image, nullptr);
+        poolImage->image = VK_NULL_HANDLE;
+    }
+    if(poolImage->memory != VK_NULL_HANDLE) {
+        vkFreeMemory(mVkInterface->vkDevice, poolImage->memory, nullptr);
+        poolImage->memory = VK_NULL_HANDLE;
+    }
+}
+
+void
+VulkanImagePool::WaitIdle()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    // the queue is shared with the contexts current to other threads
+    mVkInterface->vkLockQueue(true);
+    vkQueueWaitIdle(mVkInterface->vkQueue);
+    mVkInterface->vkLockQueue(false);
+}
+
+EGLBoolean
+VulkanImagePool::AcquireImages(uint32_t width, uint32_t height, VkFormat format, uint32_t count,
+                               VkImage *images, VkBuffer *readbackBuffers, void **readbackData)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    assert(mVkInterface != nullptr);
+
+    std::vector<poolImage_t> acquired;
+    acquired.reserve(count);
+
+    // the most recently released images come first, they are the likeliest to be resident
+    for(auto it = mFreeImages.rbegin(); it != mFreeImages.rend() && acquired.size() < count;) {
+        if(it->width == width && it->height == height && it->format == format) {
+            acquired.push_back(*it);
+            it = std::vector<poolImage_t>::reverse_iterator(mFreeImages.erase(std::next(it).base()));
+        } else {
+            ++it;
+        }
+    }
+
+    bool success = true;
+    while(acquired.size() < count) {
+        poolImage_t poolImage;
+        if(!CreateImage(width, height, format, &poolImage)) {
+            success = false;
+            break;
+        }
+        acquired.push_back(poolImage);
+    }
+
+    for(uint32_t i = 0; success && i < acquired.size() && readbackBuffers != nullptr; ++i) {
+        if(acquired[i].readbackBuffer == VK_NULL_HANDLE && !CreateReadbackBuffer(&acquired[i])) {
+            success = false;
+        }
+    }
+
+    if(!success) {
+        for(auto &poolImage : acquired) {
+            DestroyImage(&poolImage);
+        }
+        return EGL_FALSE;
+    }
+
+    for(uint32_t i = 0; i < count; ++i) {
+        images[i] = acquired[i].image;
+        if(readbackBuffers != nullptr) {
+            readbackBuffers[i] = acquired[i].readbackBuffer;
+            readbackData[i]    = acquired[i].readbackData;
+        }
+        mUsedImages.push_back(acquired[i]);
+    }
+
+    return EGL_TRUE;
+}
+
+void
+VulkanImagePool::ReleaseImages(uint32_t count, const VkImage *images)
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    for(uint32_t i = 0; i < count; ++i) {
+        for(auto it = mUsedImages.begin(); it != mUsedImages.end(); ++it) {
+            if(it->image == images[i]) {
+                mFreeImages.push_back(*it);
+                mUsedImages.erase(it);
+                break;
+            }
+        }
+    }
+
+    if(mFreeImages.size() <= EGL_GLOVE_PBUFFER_POOL_SIZE) {
+        return;
+    }
+
+    // the oldest images are freed, once the frames that may still render to them are done
+    WaitIdle();
+    const size_t excess = mFreeImages.size() - EGL_GLOVE_PBUFFER_POOL_SIZE;
+    for(size_t i = 0; i < excess; ++i) {
+        DestroyImage(&mFreeImages[i]);
+    }
+    mFreeImages.erase(mFreeImages.begin(), mFreeImages.begin() + excess);
+}
+
+void
+VulkanImagePool::Destroy()
+{
+    FUN_ENTRY(EGL_LOG_DEBUG);
+
+    if(mVkInterface == nullptr || (mFreeImages.empty() && mUsedImages.empty())) {
+        return;
+    }
+
+    WaitIdle();
+    for(auto &poolImage : mFreeImages) {
+        DestroyImage(&poolImage);
+    }
+    for(auto &poolImage : mUsedImages) {
+        DestroyImage(&poolImage);
+    }
+    mFreeImages.clear();
+    mUsedImages.clear();
+}
@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       vulkanImagePool.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Pool of the images pbuffer surfaces render to. The images of a destroyed pbuffer are kept for the next one of the same size.
+ *
+ */
+
+#ifndef __VULKAN_IMAGE_POOL_H__
+#define __VULKAN_IMAGE_POOL_H__
+
+#include "EGL/egl.h"
+#include "rendering_api_interface.h"
+#include "utils/eglLogger.h"
+#include <vector>
+
+class VulkanImagePool
+{
+private:
+    typedef struct poolImage {
+        VkImage                      image;
+        VkDeviceMemory               memory;
+        uint32_t                     width;
+        uint32_t                     height;
+        VkFormat                     format;
+
+        /// host visible copy of the image, mapped for as long as it lives
+        VkBuffer                     readbackBuffer;
+        VkDeviceMemory               readbackMemory;
+        void                        *readbackData;
+    } poolImage_t;
+
+    const vkInterface_t             *mVkInterface;
+    std::vector<poolImage_t>         mFreeImages;
+    std::vector<poolImage_t>         mUsedImages;
+
+    bool                             FindMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags flags, uint32_t *typeIndex) const;
+    bool                             CreateImage(uint32_t width, uint32_t height, VkFormat format, poolImage_t *poolImage);
+    bool                             CreateReadbackBuffer(poolImage_t *poolImage);
+    void                             DestroyImage(poolImage_t *poolImage);
+    void                             WaitIdle();
+
+public:
+    VulkanImagePool();
+    ~VulkanImagePool();
+
+    /// the images are handed out in the undefined layout, along with their readback buffers if they are requested
+    EGLBoolean                       AcquireImages(uint32_t width, uint32_t height, VkFormat format, uint32_t count,
+                                                   VkImage *images, VkBuffer *readbackBuffers, void **readbackData);
+    void                             ReleaseImages(uint32_t count, const VkImage *images);
+    void                             Destroy();
+
+    inline void                      SetVkInterface(const vkInterface_t *vkInterface)       { mVkInterface = vkInterface; }
+};
+
+#endif // __VULKAN_IMAGE_POOL_H__
@@ -22,12 +22,16 @@
  */
 
 #include "vulkanResources.h"
+#include <cstring>
 
 VulkanResources::VulkanResources()
     : mSurface(VK_NULL_HANDLE), mSwapchain(VK_NULL_HANDLE),
-      mSwapChainImageCount(0), mSwapChainImages(nullptr)
+      mSwapChainImageCount(0), mSwapChainImages(nullptr),
+      mReadbackBuffers(nullptr), mReadbackData(nullptr)
 {
     FUN_ENTRY(DEBUG_DEPTH);
+
+    memset(static_cast<void *>(&mSyncItems), 0, sizeof(mSyncItems));
 }
 
 VulkanResources::~VulkanResources()
@@ -47,4 +51,11 @@ VulkanResources::Release(void)
         mSwapChainImages = nullptr;
         mSwapChainImageCount = 0;
    } 
+
+    if(mReadbackBuffers) {
+        delete[] mReadbackBuffers;
+        delete[] mReadbackData;
+        mReadbackBuffers = nullptr;
+        mReadbackData = nullptr;
+    }
 }
@@ -25,6 +25,7 @@
 #define __VULKAN_RESOURCES_H__
 
 #include "platform/platformResources.h"
+#include "rendering_api_interface.h"
 #include <vulkan/vulkan.h>
 
 class VulkanResources : public PlatformResources
@@ -35,6 +36,13 @@ private:
     uint32_t                         mSwapChainImageCount;
     VkImage                         *mSwapChainImages;
 
+    /// pbuffers whose frames are streamed to the host, one mapped buffer per image
+    VkBuffer                        *mReadbackBuffers;
+    void                           **mReadbackData;
+
+    /// semaphores of the swapchain of a window surface, they live as long as the surface
+    vkSyncItems_t                    mSyncItems;
+
 public:
     VulkanResources();
     ~VulkanResources() override;
@@ -46,12 +54,19 @@ public:
     inline VkSwapchainKHR            GetSwapchain()                                 const { return mSwapchain; }
     inline uint32_t                  GetSwapchainImageCount()                    override { return mSwapChainImageCount; }
     inline void *                    GetSwapchainImages()                        override { return reinterpret_cast<void *>(mSwapChainImages); }
+    inline void *                    GetReadbackBuffers()                        override { return reinterpret_cast<void *>(mReadbackBuffers); }
+    inline void *                    GetReadbackData(uint32_t imageIndex)           const { return mReadbackData ? mReadbackData[imageIndex] : nullptr; }
+    inline void *                    GetSyncItems()                              override { return mSyncItems.vkSpareAcquireSemaphore != VK_NULL_HANDLE ? &mSyncItems : nullptr; }
+    inline vkSyncItems_t *           GetVkSyncItems()                                     { return &mSyncItems; }
 
     // Set Functions
     inline void                      SetSurface(VkSurfaceKHR surface)                     { mSurface              = surface; }
     inline void                      SetSwapchain(VkSwapchainKHR swapchain)               { mSwapchain            = swapchain; }
     inline void                      SetSwapChainImageCount(uint32_t swapChainImageCount) { mSwapChainImageCount  = swapChainImageCount; }
     inline void                      SetSwapChainImages(VkImage *swapChainImages)         { mSwapChainImages      = swapChainImages; }
+    inline void                      SetReadbackBuffers(VkBuffer *readbackBuffers, void **readbackData)
+                                                                                          { mReadbackBuffers      = readbackBuffers;
+                                                                                            mReadbackData         = readbackData; }
 };
 
 #endif // #define __VULKAN_RESOURCES_H__
@@ -69,6 +69,12 @@ public:
 
     virtual EGLBoolean                             Initialize();
     virtual VkSurfaceKHR                           CreateSurface(EGLDisplay_t* dpy, EGLNativeWindowType win, EGLSurface_t *surface) = 0;
+    /// the swapchain is created in the orientation of the display, instead of the compositor rotating every frame
+    virtual bool                                   PreRotatesSwapchain() const { return false; }
+    /// the images are scanned out of a display plane with no compositor in between, VK_NULL_HANDLE otherwise
+    virtual VkDisplayKHR                           GetDirectDisplay() const    { return VK_NULL_HANDLE; }
+    /// nanoseconds between two vblanks of the display, 0 if unknown
+    virtual uint64_t                               GetRefreshDuration() const  { return 0; }
 
     inline void                                    SetVkInterface(const vkInterface_t* vkInterface) { mVkInterface = vkInterface; }
     const wsiCallbacks_t                           *GetWsiCallbacks() { return &mWsiCallbacks; }
@@ -22,11 +22,27 @@
  */
 
 #include "vulkanWindowInterface.h"
+#include <algorithm>
+#include <utility>
+#include <time.h>
+
+static EGLnsecsANDROID
+GetMonotonicTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<EGLnsecsANDROID>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
 
 VulkanWindowInterface::VulkanWindowInterface(void)
-: mVkInitialized(false), mGLES2Interface(nullptr), mVkAPI(nullptr), mVkWSI(nullptr)
+: mVkInitialized(false), mPresentPolicy(PRESENT_POLICY_BALANCED), mRequestedImageCount(0), mPbufferReadbackImages(0),
+  mGLES2Interface(nullptr), mVkAPI(nullptr), mVkWSI(nullptr)
 {
     FUN_ENTRY(DEBUG_DEPTH);
+
+    ReadPresentPolicy();
+    ReadPbufferReadback();
 }
 
 VulkanWindowInterface::~VulkanWindowInterface(void)
@@ -36,6 +52,71 @@ VulkanWindowInterface::~VulkanWindowInterface(void)
     delete mVkWSI;
 }
 
+void
+VulkanWindowInterface::ReadPresentPolicy()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const char *policy = getenv(EGL_GLOVE_PRESENT_POLICY_ENV);
+    if(policy != nullptr) {
+        if(!strcmp(policy, "low_latency")) {
+            mPresentPolicy = PRESENT_POLICY_LOW_LATENCY;
+        } else if(!strcmp(policy, "throughput")) {
+            mPresentPolicy = PRESENT_POLICY_THROUGHPUT;
+        } else if(!strcmp(policy, "paced")) {
+            mPresentPolicy = PRESENT_POLICY_PACED;
+        }
+    }
+
+    const char *imageCount = getenv(EGL_GLOVE_SWAPCHAIN_IMAGES_ENV);
+    if(imageCount != nullptr) {
+        mRequestedImageCount = static_cast<uint32_t>(strtoul(imageCount, nullptr, 10));
+    }
+}
+
+void
+VulkanWindowInterface::ReadPbufferReadback()
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    const char *imageCount = getenv(EGL_GLOVE_PBUFFER_READBACK_ENV);
+    if(imageCount != nullptr) {
+        mPbufferReadbackImages = std::min(static_cast<uint32_t>(strtoul(imageCount, nullptr, 10)),
+                                          static_cast<uint32_t>(GLOVE_MAX_SWAPCHAIN_IMAGES));
+    }
+}
+
+uint32_t
+VulkanWindowInterface::GetSwapchainImageCount(const VkSurfaceCapabilitiesKHR &surfCapabilities) const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    uint32_t imageCount = mRequestedImageCount;
+    if(imageCount == 0) {
+        imageCount = (mPresentPolicy == PRESENT_POLICY_THROUGHPUT) ? 3 : 2;
+    }
+
+    // a maxImageCount of 0 means there is no limit
+    imageCount = std::max(imageCount, surfCapabilities.minImageCount);
+    if(surfCapabilities.maxImageCount > 0) {
+        imageCount = std::min(imageCount, surfCapabilities.maxImageCount);
+    }
+
+    return std::min(imageCount, static_cast<uint32_t>(GLOVE_MAX_SWAPCHAIN_IMAGES));
+}
+
+uint32_t
+VulkanWindowInterface::GetMaxFramesInFlight() const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    switch(mPresentPolicy) {
+    case PRESENT_POLICY_LOW_LATENCY:    return 1;
+    case PRESENT_POLICY_THROUGHPUT:     return 3;
+    default:                            return 2;
+    }
+}
+
 EGLBoolean
 VulkanWindowInterface::InitializeVulkanAPI()
 {
@@ -50,6 +131,7 @@ VulkanWindowInterface::InitializeVulkanAPI()
         mVkInterface = reinterpret_cast<vkInterface_t *>(mGLES2Interface->state);
 
         mVkAPI = new VulkanAPI(mVkInterface);
+        mImagePool.SetVkInterface(mVkInterface);
 
         mVkWSI->SetVkInterface(mVkInterface);
 
@@ -71,6 +153,7 @@ VulkanWindowInterface::TerminateVulkanAPI()
     FUN_ENTRY(DEBUG_DEPTH);
 
     if(mVkAPI) {
+        mImagePool.Destroy();
         RENDERING_API_terminate_gles2_api();
         delete mVkAPI;
     }
@@ -104,9 +187,41 @@ VulkanWindowInterface::SetSwapchainExtent(EGLSurface_t* surface, VkSurfaceCapabi
         surface->SetHeight(swapChainExtent.height);
     }
 
+    // the surface keeps the size the client sees, the images of a swapchain it draws turned by a quarter are transposed
+    const uint32_t preTransform = SetSwapchainTransform(surface, *surfCapabilities);
+    if(mVkWSI->PreRotatesSwapchain() &&
+       (preTransform == VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR || preTransform == VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR)) {
+        std::swap(swapChainExtent.width, swapChainExtent.height);
+    }
+
     return swapChainExtent;
 }
 
+VkSurfaceTransformFlagBitsKHR
+VulkanWindowInterface::SetSwapchainTransform(EGLSurface_t* surface, const VkSurfaceCapabilitiesKHR &surfCapabilities)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    // rotations that the presentation engine would apply to every frame are drawn into the images instead
+    const VkSurfaceTransformFlagBitsKHR currentTransform = surfCapabilities.currentTransform;
+    const bool rotated = currentTransform == VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR  ||
+                         currentTransform == VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR ||
+                         currentTransform == VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR;
+
+    VkSurfaceTransformFlagBitsKHR preTransform;
+    if(rotated && mVkWSI->PreRotatesSwapchain()) {
+        preTransform = currentTransform;
+    } else if(surfCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) {
+        preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    } else {
+        preTransform = currentTransform;
+    }
+
+    surface->SetPreTransform(static_cast<uint32_t>(preTransform));
+
+    return preTransform;
+}
+
 VkPresentModeKHR
 VulkanWindowInterface::SetSwapchainPresentMode(EGLSurface_t* surface)
 {
@@ -128,7 +243,23 @@ VulkanWindowInterface::SetSwapchainPresentMode(EGLSurface_t* surface)
 
     VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
     //Select the appropriate present mode
-    if(surface->GetSwapInterval() == 0) {
+    if(surface->GetSwapInterval() != 0 && mPresentPolicy == PRESENT_POLICY_LOW_LATENCY && mVkWSI->GetDirectDisplay() != VK_NULL_HANDLE) {
+        //Without a compositor, a newer frame replaces the queued one at the page flip instead of waiting behind it
+        for(size_t i = 0; i < presentModeCount; i++) {
+            if(presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
+                swapchainPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+                break;
+            }
+        }
+    } else if(surface->GetSwapInterval() != 0 && mPresentPolicy == PRESENT_POLICY_THROUGHPUT) {
+        //A frame that misses the vertical blank is shown right away, instead of stalling the queue for another one
+        for(size_t i = 0; i < presentModeCount; i++) {
+            if(presentModes[i] == VK_PRESENT_MODE_FIFO_RELAXED_KHR) {
+                swapchainPresentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+                break;
+            }
+        }
+    } else if(surface->GetSwapInterval() == 0) {
         for(size_t i = 0; i < presentModeCount; i++) {
             //VK_PRESENT_MODE_MAILBOX_KHR, if supported, is prefered to VK_PRESENT_MODE_IMMEDIATE_KHR
             if(presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
@@ -201,6 +332,29 @@ VulkanWindowInterface::SetSurfaceColorFormat(EGLSurface_t *surface)
     surface->SetColorFormat(static_cast<EGLint>(format));
 }
 
+void
+VulkanWindowInterface::SetPbufferColorFormat(EGLSurface_t *surface)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    /// there is no presentation engine to ask, the format only has to be rendered to
+    const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+    const VkFormat formats[] = { VK_FORMAT_R8G8B8A8_UNORM, mVkDefaultFormat };
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    for(uint32_t i = 0; i < ARRAY_SIZE(formats); ++i) {
+        VkFormatProperties formatDeviceProps;
+        mVkAPI->GetPhysicalDevFormatProperties(formats[i], &formatDeviceProps);
+        if((formatDeviceProps.optimalTilingFeatures & features) == features) {
+            format = formats[i];
+            break;
+        }
+    }
+    assert(format != VK_FORMAT_UNDEFINED);
+
+    surface->SetColorFormat(static_cast<EGLint>(format));
+}
+
 void
 VulkanWindowInterface::CreateVkSwapchain(EGLSurface_t* surface,
                                    VkPresentModeKHR swapchainPresentMode,
@@ -209,24 +363,41 @@ VulkanWindowInterface::CreateVkSwapchain(EGLSurface_t* surface,
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    EGLBoolean ASSERT_ONLY wsiSuccess;
     /// Determine number of buffers
     assert(surfCapabilities.minImageCount >= 1);
-    uint32_t desiredNumberOfSwapChainImages = 2;
+    uint32_t desiredNumberOfSwapChainImages = GetSwapchainImageCount(surfCapabilities);
+    mVkInterface->vkSyncItems->maxFramesInFlight = GetMaxFramesInFlight();
 
     VulkanResources *vkResources = dynamic_cast<VulkanResources *>(surface->GetPlatformResources());
     assert(vkResources);
 
+    /// on resize or rotation the current swapchain is handed over, so that its resources are reused
     VkSwapchainKHR vkSwapchain = mVkAPI->CreateSwapchain(vkResources,
                                                          desiredNumberOfSwapChainImages,
                                                          surfCapabilities,
+                                                         static_cast<VkSurfaceTransformFlagBitsKHR>(surface->GetPreTransform()),
                                                          swapChainExtent,
                                                          swapchainPresentMode,
                                                          static_cast<VkFormat>(surface->GetColorFormat()),
-                                                         VK_NULL_HANDLE);
+                                                         vkResources->GetSwapchain());
     assert(vkSwapchain != VK_NULL_HANDLE);
 
+    if(vkResources->GetSwapchain() != VK_NULL_HANDLE) {
+        mVkAPI->DestroySwapchain(vkResources);
+    }
     vkResources->SetSwapchain(vkSwapchain);
+
+    /// the semaphores outlive the swapchains of the surface, a frame in flight may still wait on them
+    if(vkResources->GetSyncItems() == nullptr) {
+        EGLBoolean ASSERT_ONLY created = mVkAPI->CreateSyncItems(vkResources->GetVkSyncItems());
+        assert(created == EGL_TRUE);
+    }
+
+    uint64_t refreshDuration = mVkAPI->GetRefreshCycleDuration(vkResources);
+    if(refreshDuration == 0) {
+        refreshDuration = mVkWSI->GetRefreshDuration();
+    }
+    surface->SetRefreshDuration(static_cast<EGLnsecsANDROID>(refreshDuration));
 }
 
 EGLBoolean
@@ -266,11 +437,64 @@ VulkanWindowInterface::CreateSwapchain(EGLSurface_t *surface)
     CreateVkSwapchain(surface, swapchainPresentMode, swapChainExtent, surfCapabilities);
 }
 
+void
+VulkanWindowInterface::AllocatePbufferImages(EGLSurface_t *surface)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    VulkanResources *vkResources = dynamic_cast<VulkanResources *>(surface->GetPlatformResources());
+    assert(vkResources);
+
+    SetPbufferColorFormat(surface);
+
+    // one image is enough, unless the host reads a frame back while the next ones are rendered
+    const bool readback = mPbufferReadbackImages > 0;
+    const uint32_t imageCount = readback ? mPbufferReadbackImages : 1;
+    VkImage *images = new VkImage[imageCount]();
+    VkBuffer *readbackBuffers = readback ? new VkBuffer[imageCount]() : nullptr;
+    void **readbackData = readback ? new void *[imageCount]() : nullptr;
+
+    vkResources->Release();
+    if(mImagePool.AcquireImages(static_cast<uint32_t>(surface->GetWidth()), static_cast<uint32_t>(surface->GetHeight()),
+                                static_cast<VkFormat>(surface->GetColorFormat()), imageCount,
+                                images, readbackBuffers, readbackData) == EGL_FALSE) {
+        delete[] images;
+        delete[] readbackBuffers;
+        delete[] readbackData;
+        return;
+    }
+
+    vkResources->SetSwapChainImageCount(imageCount);
+    vkResources->SetSwapChainImages(images);
+    vkResources->SetReadbackBuffers(readbackBuffers, readbackData);
+    surface->SetCurrentImageIndex(0);
+}
+
+void
+VulkanWindowInterface::DestroyPbufferImages(EGLSurface_t *surface)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    VulkanResources *vkResources = dynamic_cast<VulkanResources *>(surface->GetPlatformResources());
+    if(vkResources == nullptr) {
+        return;
+    }
+
+    // the images return to the pool, for the next pbuffer of the same size
+    mImagePool.ReleaseImages(vkResources->GetSwapchainImageCount(), static_cast<const VkImage *>(vkResources->GetSwapchainImages()));
+    vkResources->Release();
+}
+
 void
 VulkanWindowInterface::AllocateSurfaceImages(EGLSurface_t* surface)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
+    if(surface->GetType() == EGL_PBUFFER_BIT) {
+        AllocatePbufferImages(surface);
+        return;
+    }
+
     CreateSwapchain(surface);
 
     EGLBoolean ASSERT_ONLY wsiSuccess;
@@ -280,7 +504,7 @@ VulkanWindowInterface::AllocateSurfaceImages(EGLSurface_t* surface)
     assert(vkResources);
 
     swapChainImageCount = mVkAPI->GetSwapChainImagesCount(vkResources);
-    assert(swapChainImageCount);
+    assert(swapChainImageCount && swapChainImageCount <= GLOVE_MAX_SWAPCHAIN_IMAGES);
 
     swapChainImages = new VkImage[swapChainImageCount]();
     assert(swapChainImages);
@@ -288,6 +512,7 @@ VulkanWindowInterface::AllocateSurfaceImages(EGLSurface_t* surface)
     wsiSuccess = mVkAPI->GetSwapChainImages(vkResources, swapChainImageCount, swapChainImages);
     assert(EGL_TRUE == wsiSuccess);
 
+    vkResources->Release();
     vkResources->SetSwapChainImageCount(swapChainImageCount);
     vkResources->SetSwapChainImages(swapChainImages);
 }
@@ -297,23 +522,46 @@ VulkanWindowInterface::AcquireNextImage(EGLSurface_t *surface, uint32_t *imageIn
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    const VulkanResources *vkResources = dynamic_cast<const VulkanResources *>(surface->GetPlatformResources());
+    VulkanResources *vkResources = dynamic_cast<VulkanResources *>(surface->GetPlatformResources());
     if(vkResources == nullptr) {
         return EGL_FALSE;
     }
 
-    VkResult res = mVkAPI->AcquireNextImage(vkResources, imageIndex);
-    if(res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
-        mVkAPI->DeviceWaitIdle();
+    /// pbuffer images are handed out in turn, the one rendered last is read back while the next is rendered
+    if(surface->GetType() == EGL_PBUFFER_BIT) {
+        *imageIndex = (static_cast<uint32_t>(surface->GetCurrentImageIndex()) + 1) % std::max(vkResources->GetSwapchainImageCount(), 1u);
+        surface->SetCurrentImageIndex(*imageIndex);
+        return EGL_TRUE;
+    }
 
+    /// a suboptimal swapchain still hands out the image, it is recreated once the frame is presented
+    vkSyncItems_t *syncItems = GetSyncItems(surface);
+    VkResult res = mVkAPI->AcquireNextImage(vkResources, syncItems->vkSpareAcquireSemaphore, imageIndex);
+    if(res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR) {
         return EGL_FALSE;
     }
 
+    std::swap(syncItems->vkSpareAcquireSemaphore, syncItems->vkImageAcquireSemaphores[*imageIndex]);
+    syncItems->vkAcquireSemaphore   = syncItems->vkImageAcquireSemaphores[*imageIndex];
+    syncItems->vkDrawSemaphore      = syncItems->vkImageDrawSemaphores[*imageIndex];
+    syncItems->acquireSemaphoreFlag = true;
+    syncItems->drawSemaphoreFlag    = false;
+
     surface->SetCurrentImageIndex(*imageIndex);
 
     return EGL_TRUE;
 }
 
+vkSyncItems_t *
+VulkanWindowInterface::GetSyncItems(EGLSurface_t *surface)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    vkSyncItems_t *syncItems = static_cast<vkSyncItems_t *>(surface->GetPlatformSyncItems());
+
+    return syncItems ? syncItems : mVkInterface->vkSyncItems;
+}
+
 void
 VulkanWindowInterface::DestroySwapchain(EGLSurface_t *surface)
 {
@@ -324,6 +572,9 @@ VulkanWindowInterface::DestroySwapchain(EGLSurface_t *surface)
         mVkAPI->DestroySwapchain(vkResources);
         vkResources->SetSwapchain(VK_NULL_HANDLE);
     }
+    if(vkResources) {
+        mVkAPI->DestroySyncItems(vkResources->GetVkSyncItems());
+    }
 
     if(vkResources) {
         vkResources->Release();
@@ -340,6 +591,8 @@ VulkanWindowInterface::DestroySurface(EGLSurface_t *surface)
         mVkAPI->DestroyPlatformSurface(vkResources);
         vkResources->SetSurface(VK_NULL_HANDLE);
         mGLES2Interface->delete_shared_surface_data_cb(surface->GetEGLSurfaceInterface());
+    } else if(vkResources && surface->GetType() == EGL_PBUFFER_BIT) {
+        mGLES2Interface->delete_shared_surface_data_cb(surface->GetEGLSurfaceInterface());
     }
 }
 
@@ -348,33 +601,232 @@ VulkanWindowInterface::DestroySurfaceImages(EGLSurface_t *surface)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
+    if(surface->GetType() == EGL_PBUFFER_BIT) {
+        DestroyPbufferImages(surface);
+        return;
+    }
+
     DestroySwapchain(surface);
 }
 
+void
+VulkanWindowInterface::UpdateFrameTimestamps(EGLSurface_t *surface, uint64_t frameId)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+#ifdef VK_GOOGLE_display_timing
+    std::vector<VkPastPresentationTimingGOOGLE> timings;
+    if(mVkAPI->GetPastPresentationTiming(dynamic_cast<const VulkanResources *>(surface->GetPlatformResources()), &timings) == EGL_FALSE) {
+        return;
+    }
+
+    /// present IDs are the low bits of the frame IDs, of frames presented before this one
+    for(const auto &timing : timings) {
+        uint64_t timingFrameId = (frameId & ~static_cast<uint64_t>(UINT32_MAX)) | timing.presentID;
+        if(timingFrameId >= frameId) {
+            timingFrameId -= static_cast<uint64_t>(UINT32_MAX) + 1;
+        }
+
+        FrameTimestamps_t *frame = surface->GetFrameTimestamps(timingFrameId);
+        if(frame) {
+            frame->displayPresentTime = static_cast<EGLnsecsANDROID>(timing.actualPresentTime);
+        }
+    }
+#else
+    (void)surface;
+    (void)frameId;
+#endif // VK_GOOGLE_display_timing
+}
+
+uint64_t
+VulkanWindowInterface::GetDesiredPresentTime(EGLSurface_t *surface, uint64_t frameId)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    /// the time set by the client is taken as it is
+    if(surface->GetPresentationTime() > 0) {
+        return static_cast<uint64_t>(surface->GetPresentationTime());
+    }
+
+    const EGLnsecsANDROID refreshDuration = surface->GetRefreshDuration();
+    if(mPresentPolicy != PRESENT_POLICY_PACED || refreshDuration <= 0) {
+        return 0;
+    }
+
+    const EGLnsecsANDROID period = refreshDuration * std::max(surface->GetSwapInterval(), 1);
+    const EGLnsecsANDROID now    = GetMonotonicTime();
+
+    /// one period after the previous frame, or after the last one that was displayed should the previous be late
+    EGLnsecsANDROID desired = 0;
+    EGLnsecsANDROID lastDisplayed = 0;
+    const FrameTimestamps_t *previous = surface->GetFrameTimestamps(frameId - 1);
+    if(previous && previous->requestedPresentTime > 0) {
+        desired = previous->requestedPresentTime + period;
+    }
+    for(uint64_t id = frameId - 1; id > 0 && id + EGL_GLOVE_FRAME_TIMESTAMPS_HISTORY >= frameId; --id) {
+        const FrameTimestamps_t *frame = surface->GetFrameTimestamps(id);
+        if(frame && frame->displayPresentTime > 0) {
+            lastDisplayed = frame->displayPresentTime;
+            desired = std::max(desired, lastDisplayed + static_cast<EGLnsecsANDROID>(frameId - id) * period);
+            break;
+        }
+    }
+
+    /// a frame that is already late goes out at the next refresh, in phase with the display
+    if(desired <= now) {
+        desired = now + period;
+        if(lastDisplayed > 0) {
+            desired = now + refreshDuration - (now - lastDisplayed) % refreshDuration;
+        }
+    }
+
+    /// never queue further ahead than the latency bound
+    const EGLnsecsANDROID latest = now + EGL_GLOVE_PACED_MAX_LATENCY_CYCLES * period;
+    if(desired > latest) {
+        desired -= ((desired - latest + period - 1) / period) * period;
+    }
+
+    return static_cast<uint64_t>(desired);
+}
+
+bool
+VulkanWindowInterface::WaitsForDisplayVBlank() const
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    return mVkInterface->isDisplayControlSupported && mVkWSI->GetDirectDisplay() != VK_NULL_HANDLE &&
+           (mPresentPolicy == PRESENT_POLICY_LOW_LATENCY || mPresentPolicy == PRESENT_POLICY_PACED);
+}
+
+void
+VulkanWindowInterface::PrepareSwapchainPresent(EGLSurface_t *surface, const EGLint *rects, EGLint nRects, SwapchainPresent_t *present)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    vkSyncItems_t *syncItems = GetSyncItems(surface);
+    present->vkResources    = dynamic_cast<const VulkanResources *>(surface->GetPlatformResources());
+    present->waitSemaphore  = VK_NULL_HANDLE;
+    if(syncItems->drawSemaphoreFlag) {
+        present->waitSemaphore = syncItems->vkDrawSemaphore;
+    } else if(syncItems->acquireSemaphoreFlag) {
+        present->waitSemaphore = syncItems->vkAcquireSemaphore;
+    }
+
+    syncItems->acquireSemaphoreFlag = false;
+    syncItems->drawSemaphoreFlag    = false;
+
+    /// Vulkan counts the rectangles from the top left corner, of the images as they are stored
+    std::vector<VkRectLayerKHR> &regions = present->regions;
+    regions.clear();
+    if(mVkInterface->isIncrementalPresentSupported) {
+        const int32_t width  = surface->GetWidth();
+        const int32_t height = surface->GetHeight();
+        regions.reserve(nRects);
+        for(EGLint i = 0; i < nRects; ++i) {
+            const EGLint *rect = &rects[4 * i];
+            const int32_t x = std::max(rect[0], 0);
+            const int32_t y = std::max(height - rect[1] - rect[3], 0);
+            const int32_t w = std::max(rect[2], 0);
+            const int32_t h = std::max(rect[3], 0);
+
+            VkRectLayerKHR region;
+            switch(mVkWSI->PreRotatesSwapchain() ? surface->GetPreTransform() : VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) {
+            case VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR:
+                region = { { std::max(height - y - h, 0), x }, { static_cast<uint32_t>(h), static_cast<uint32_t>(w) }, 0 };
+                break;
+            case VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR:
+                region = { { std::max(width - x - w, 0), std::max(height - y - h, 0) }, { static_cast<uint32_t>(w), static_cast<uint32_t>(h) }, 0 };
+                break;
+            case VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR:
+                region = { { y, std::max(width - x - w, 0) }, { static_cast<uint32_t>(h), static_cast<uint32_t>(w) }, 0 };
+                break;
+            default:
+                region = { { x, y }, { static_cast<uint32_t>(w), static_cast<uint32_t>(h) }, 0 };
+                break;
+            }
+            regions.push_back(region);
+        }
+    }
+
+    /// frames are identified by the swap they are presented with, the timings of the earlier ones are collected first
+    const uint64_t frameId      = surface->GetNextFrameId();
+    uint64_t desiredPresentTime = 0;
+    if(mVkInterface->isDisplayTimingSupported) {
+        if(surface->GetTimestampsEnabled() || mPresentPolicy == PRESENT_POLICY_PACED) {
+            UpdateFrameTimestamps(surface, frameId);
+        }
+        desiredPresentTime = GetDesiredPresentTime(surface, frameId);
+        surface->RecordFrame(frameId, static_cast<EGLnsecsANDROID>(desiredPresentTime));
+    } else if(WaitsForDisplayVBlank() || surface->GetTimestampsEnabled()) {
+        surface->RecordFrame(frameId, 0);
+    }
+
+    present->imageIndex         = surface->GetCurrentImageIndex();
+    present->presentID          = static_cast<uint32_t>(frameId);
+    present->desiredPresentTime = desiredPresentTime;
+    present->result             = VK_SUCCESS;
+}
+
 EGLBoolean
-VulkanWindowInterface::PresentImage(EGLSurface_t *surface)
+VulkanWindowInterface::PresentImage(EGLSurface_t *surface, const EGLint *rects, EGLint nRects)
 {
     FUN_ENTRY(DEBUG_DEPTH);
 
-    std::vector<VkSemaphore> pSems;
-    if(mVkInterface->vkSyncItems->drawSemaphoreFlag) {
-        pSems.push_back(mVkInterface->vkSyncItems->vkDrawSemaphore);
-    } else {
-        pSems.push_back(mVkInterface->vkSyncItems->vkAcquireSemaphore);
+    SurfacePresent_t present = { surface, rects, nRects, EGL_FALSE };
+
+    return PresentImages(&present, 1);
+}
+
+EGLBoolean
+VulkanWindowInterface::PresentImages(SurfacePresent_t *presents, uint32_t count)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
+
+    std::vector<SwapchainPresent_t> swapchainPresents(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        PrepareSwapchainPresent(presents[i].surface, presents[i].rects, presents[i].nRects, &swapchainPresents[i]);
+    }
+
+    /// the caller recreates the swapchains, the frames in flight keep running on the retired ones
+    mVkAPI->PresentImages(swapchainPresents);
+
+    /// without a compositor the swap returns on the flip, so the next frame is rendered from the latest input
+    if(WaitsForDisplayVBlank()) {
+        const EGLnsecsANDROID refreshDuration = presents[0].surface->GetRefreshDuration();
+        const uint64_t timeout = refreshDuration > 0 ? static_cast<uint64_t>(refreshDuration) * EGL_GLOVE_VBLANK_WAIT_CYCLES : UINT64_MAX;
+        const EGLBoolean flipped = mVkAPI->WaitForDisplayVBlank(mVkWSI->GetDirectDisplay(), timeout);
+        const EGLnsecsANDROID now = GetMonotonicTime();
+        for(uint32_t i = 0; i < count; ++i) {
+            FrameTimestamps_t *frame = presents[i].surface->GetFrameTimestamps(presents[i].surface->GetNextFrameId());
+            if(frame) {
+                frame->displayPresentTime = flipped ? now : EGL_TIMESTAMP_INVALID_ANDROID;
+            }
+        }
+    }
+
+    EGLBoolean presented = EGL_TRUE;
+    for(uint32_t i = 0; i < count; ++i) {
+        const VkResult res    = swapchainPresents[i].result;
+        presents[i].presented = (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) ? EGL_FALSE : EGL_TRUE;
+        if(presents[i].presented == EGL_FALSE) {
+            presented = EGL_FALSE;
+        }
     }
 
-    mVkInterface->vkSyncItems->acquireSemaphoreFlag = true;
-    mVkInterface->vkSyncItems->drawSemaphoreFlag = false;
+    return presented;
+}
 
-    uint32_t imageIndex = surface->GetCurrentImageIndex();
-    VkResult res = mVkAPI->PresentImage(dynamic_cast<const VulkanResources *>(surface->GetPlatformResources()), imageIndex, pSems);
-    if(res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
-        mVkAPI->DeviceWaitIdle();
+const void *
+VulkanWindowInterface::GetReadbackData(EGLSurface_t *surface, uint32_t imageIndex)
+{
+    FUN_ENTRY(DEBUG_DEPTH);
 
-        return EGL_FALSE;
+    VulkanResources *vkResources = dynamic_cast<VulkanResources *>(surface->GetPlatformResources());
+    if(vkResources == nullptr || surface->GetType() != EGL_PBUFFER_BIT || imageIndex >= vkResources->GetSwapchainImageCount()) {
+        return nullptr;
     }
 
-    return EGL_TRUE;
+    return vkResources->GetReadbackData(imageIndex);
 }
 
 EGLBoolean
@@ -26,6 +26,7 @@
 
 #include "platform/platformWindowInterface.h"
 #include "vulkanAPI.h"
+#include "vulkanImagePool.h"
 
 #ifdef DEBUG_DEPTH
 #   undef DEBUG_DEPTH
@@ -35,7 +36,18 @@
 class VulkanWindowInterface : public PlatformWindowInterface
 {
 private:
+    typedef enum {
+        PRESENT_POLICY_BALANCED = 0,
+        PRESENT_POLICY_LOW_LATENCY,
+        PRESENT_POLICY_THROUGHPUT,
+        PRESENT_POLICY_PACED
+    } present_policy_t;
+
     EGLBoolean                   mVkInitialized;
+    present_policy_t             mPresentPolicy;
+    uint32_t                     mRequestedImageCount;  /// 0 lets the policy decide
+    uint32_t                     mPbufferReadbackImages;/// 0 if the frames of pbuffers are not streamed
+    VulkanImagePool              mImagePool;
     rendering_api_interface_t   *mGLES2Interface;
 
     VulkanAPI                   *mVkAPI;
@@ -44,16 +56,32 @@ private:
 
     const VkFormat               mVkDefaultFormat = VK_FORMAT_B8G8R8A8_UNORM;
 
+    void                         ReadPresentPolicy();
+    void                         ReadPbufferReadback();
+    uint32_t                     GetSwapchainImageCount(const VkSurfaceCapabilitiesKHR &surfCapabilities) const;
+    uint32_t                     GetMaxFramesInFlight() const;
+    void                         UpdateFrameTimestamps(EGLSurface_t *surface, uint64_t frameId);
+    uint64_t                     GetDesiredPresentTime(EGLSurface_t *surface, uint64_t frameId);
+    /// a swap on a display plane returns once its frame is scanned out, with the latency bounding policies
+    bool                         WaitsForDisplayVBlank() const;
+    vkSyncItems_t               *GetSyncItems(EGLSurface_t *surface);
+    void                         PrepareSwapchainPresent(EGLSurface_t *surface, const EGLint *rects, EGLint nRects, SwapchainPresent_t *present);
+
     EGLBoolean                   InitializeVulkanAPI();
     void                         TerminateVulkanAPI();
     EGLBoolean                   InitSwapchainExtension(const EGLSurface_t *surface);
     VkExtent2D                   SetSwapchainExtent(EGLSurface_t* surface, VkSurfaceCapabilitiesKHR *surfCapabilities);
+    VkSurfaceTransformFlagBitsKHR SetSwapchainTransform(EGLSurface_t* surface, const VkSurfaceCapabilitiesKHR &surfCapabilities);
 
     void                         CreateSwapchain(EGLSurface_t *surface);
     void                         DestroySwapchain(EGLSurface_t *surface);
 
     VkPresentModeKHR             SetSwapchainPresentMode(EGLSurface_t* surface);
     void                         SetSurfaceColorFormat(EGLSurface_t *surface);
+    void                         SetPbufferColorFormat(EGLSurface_t *surface);
+
+    void                         AllocatePbufferImages(EGLSurface_t *surface);
+    void                         DestroyPbufferImages(EGLSurface_t *surface);
 
     void                         CreateVkSwapchain(EGLSurface_t* surface,
                                                    VkPresentModeKHR swapchainPresentMode,
@@ -71,7 +99,9 @@ public:
     void                         DestroySurfaceImages(EGLSurface_t *surface) override;
     void                         DestroySurface(EGLSurface_t *surface) override;
     EGLBoolean                   AcquireNextImage(EGLSurface_t *surface, uint32_t *imageIndex) override;
-    EGLBoolean                   PresentImage(EGLSurface_t *surface) override;
+    EGLBoolean                   PresentImage(EGLSurface_t *surface, const EGLint *rects, EGLint nRects) override;
+    EGLBoolean                   PresentImages(SurfacePresent_t *presents, uint32_t count) override;
+    const void                  *GetReadbackData(EGLSurface_t *surface, uint32_t imageIndex) override;
 
     /// Set Functions
     inline void                  SetWSI(VulkanWSI *vkWSI)                       { mVkWSI = vkWSI; }
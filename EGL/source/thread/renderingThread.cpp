@@ -44,7 +44,7 @@ const char * const RenderingThread::EGLErrors[] = {   "EGL_SUCCESS",
                                                       "EGL_CONTEXT_LOST"};
 
 RenderingThread::RenderingThread()
-: mCurrentAPI(EGL_OPENGL_ES_API), mLastError(EGL_SUCCESS)
+: mCurrentAPI(EGL_OPENGL_ES_API), mGLESCurrentContext(nullptr), mVGCurrentContext(nullptr), mLastError(EGL_SUCCESS)
 {
     FUN_ENTRY(EGL_LOG_TRACE);
 }
@@ -202,7 +202,7 @@ RenderingThread::CreateContext(DisplayDriver* eglDriver, EGLConfig_t* eglConfig,
         return EGL_NO_CONTEXT;
     }
 
-    return eglDriver->CreateContext(mCurrentAPI, eglConfig, attrib_list);
+    return eglDriver->CreateContext(mCurrentAPI, eglConfig, eglShareContext, attrib_list);
 }
 
 EGLBoolean
@@ -291,8 +291,12 @@ RenderingThread::ValidateCurrentContext(DisplayDriver* eglDriver, EGLSurface_t*
         return EGL_FALSE;
     }
 
-    // TODO:: If ctx is current to some other thread, or if either draw or read are bound to
-    // contexts in another thread, an EGL_BAD_ACCESS error is generated.
+    // generate EGL_BAD_ACCESS if ctx is current to some other thread
+    // TODO:: If either draw or read are bound to contexts in another thread, an EGL_BAD_ACCESS error is generated.
+    if(eglContext != EGL_NO_CONTEXT && eglContext->IsCurrent() && eglContext != GetCurrentContext()) {
+        currentThread.RecordError(EGL_BAD_ACCESS);
+        return EGL_FALSE;
+    }
 
     // TODO:: If binding ctx would exceed the number of current contexts of that client
     // API type supported by the implementation, an EGL_BAD_ACCESS error is generated
@@ -325,10 +329,19 @@ RenderingThread::MakeCurrent(DisplayDriver* eglDriver, EGLDisplay_t* dpy, EGLSur
         return EGL_FALSE;
     }
 
-    // Flush commands when changing contexts of the same client API type
+    // Flush commands when changing contexts of the same client API type. They are only submitted,
+    // the context made current next orders its own after them; surfaces destroyed while current
+    // are deleted below though, so the work drawing to them has to complete first
     EGLContext_t* currentContext = GetCurrentContext();
     if(currentContext && currentContext != eglContext) {
-        currentContext->Finish();
+        EGLSurface_t *currentDrawSurface = currentContext->GetDrawSurface();
+        EGLSurface_t *currentReadSurface = currentContext->GetReadSurface();
+        if((currentDrawSurface && currentDrawSurface->IsMarkedForDeletion()) ||
+           (currentReadSurface && currentReadSurface->IsMarkedForDeletion())) {
+            currentContext->Finish();
+        } else {
+            currentContext->Flush();
+        }
     }
 
    UpdateCurrentContextResourcesRef(currentContext, false);
@@ -347,8 +360,6 @@ RenderingThread::MakeCurrent(DisplayDriver* eglDriver, EGLDisplay_t* dpy, EGLSur
     currentContext = GetCurrentContext();
     UpdateCurrentContextResourcesRef(currentContext, true);
 
-    eglDriver->SetActiveContext(currentContext);
-
     // clean any marked resources that may have been released after the current call to MakeCurrent
     eglDriver->CleanMarkedResources();
 
@@ -64,6 +64,7 @@ public:
     EGLBoolean              WaitNative(EGLint engine);
 };
 
-extern RenderingThread currentThread;
+/// each thread has its own current contexts and error state
+extern thread_local RenderingThread currentThread;
 
 #endif // __RENDERINGTHREAD_H__
@@ -37,6 +37,30 @@
 
 #define EGL_FENCE_WAIT_TIMEOUT                         UINT64_MAX
 
+/// Presentation of window surfaces: "low_latency" keeps a single frame in flight for interactive UIs,
+/// "throughput" queues deeper for playback, "paced" presents at a steady multiple of the refresh duration
+/// where the present times can be set (VK_GOOGLE_display_timing), anything else keeps the balanced default
+#define EGL_GLOVE_PRESENT_POLICY_ENV                   "GLOVE_PRESENT_POLICY"
+/// Refresh cycles a paced frame may be requested ahead of the time it is swapped at, which bounds its latency
+#define EGL_GLOVE_PACED_MAX_LATENCY_CYCLES             2
+/// Frames whose timestamps are kept for EGL_ANDROID_get_frame_timestamps
+#define EGL_GLOVE_FRAME_TIMESTAMPS_HISTORY             8
+/// Refresh rate in Hz of the mode a display plane is driven at, the closest one at the native resolution is chosen
+/// (the highest one by default)
+#define EGL_GLOVE_DISPLAY_REFRESH_RATE_ENV             "GLOVE_DISPLAY_REFRESH_RATE"
+/// Refresh cycles a swap waits for the vblank of a display plane at most, before it gives up on it
+#define EGL_GLOVE_VBLANK_WAIT_CYCLES                   4
+/// Number of swapchain images requested, clamped to the surface capabilities (2 for double, 3 for triple buffering)
+#define EGL_GLOVE_SWAPCHAIN_IMAGES_ENV                 "GLOVE_SWAPCHAIN_IMAGES"
+/// Number of images a pbuffer rotates through while its frames are streamed to mapped readback buffers on each swap,
+/// 0 (the default) keeps pbuffers single buffered and without readback
+#define EGL_GLOVE_PBUFFER_READBACK_ENV                 "GLOVE_PBUFFER_READBACK"
+
+/// Pbuffer images kept for reuse after their surface has been destroyed
+#define EGL_GLOVE_PBUFFER_POOL_SIZE                    8
+/// Pbuffers render to 32-bit color formats only
+#define EGL_GLOVE_PBUFFER_BYTES_PER_PIXEL              4
+
 #ifndef EGL_SUPPORT_ONLY_PBUFFER_SURFACE
 #   define EGL_SUPPORT_ONLY_PBUFFER_SURFACE            0
 #else
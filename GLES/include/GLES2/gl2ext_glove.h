@@ -0,0 +1,182 @@
+#ifndef __gles2_gl2ext_glove_h_
+#define __gles2_gl2ext_glove_h_ 1
+
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       gl2ext_glove.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES extensions specific to GLOVE, whose enums are not registered with Khronos
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef GL_GLOVE_transient_texture
+#define GL_GLOVE_transient_texture 1
+/// texture parameter, GL_TRUE when the contents of the texture are not needed from one frame to the next,
+/// e.g., intermediates of post-processing, so that its memory may be shared with other transient textures
+#define GL_TEXTURE_TRANSIENT_GLOVE        0x9FF0
+#endif /* GL_GLOVE_transient_texture */
+
+#ifndef GL_GLOVE_command_bundle
+#define GL_GLOVE_command_bundle 1
+/// draws issued between glBeginCommandBundleGLOVE and glEndCommandBundleGLOVE are recorded into the bundle instead
+/// of being drawn, along with the state and the uniform values they were issued with, and are all drawn again into
+/// the bound framebuffer by every glCallCommandBundleGLOVE. the buffers, textures and programs they use must be
+/// left unchanged for as long as the bundle is called
+typedef void (GL_APIENTRYP PFNGLGENCOMMANDBUNDLESGLOVEPROC) (GLsizei n, GLuint *bundles);
+typedef void (GL_APIENTRYP PFNGLDELETECOMMANDBUNDLESGLOVEPROC) (GLsizei n, const GLuint *bundles);
+typedef void (GL_APIENTRYP PFNGLBEGINCOMMANDBUNDLEGLOVEPROC) (GLuint bundle);
+typedef void (GL_APIENTRYP PFNGLENDCOMMANDBUNDLEGLOVEPROC) (void);
+typedef void (GL_APIENTRYP PFNGLCALLCOMMANDBUNDLEGLOVEPROC) (GLuint bundle);
+#ifdef GL_GLEXT_PROTOTYPES
+GL_APICALL void GL_APIENTRY glGenCommandBundlesGLOVE (GLsizei n, GLuint *bundles);
+GL_APICALL void GL_APIENTRY glDeleteCommandBundlesGLOVE (GLsizei n, const GLuint *bundles);
+GL_APICALL void GL_APIENTRY glBeginCommandBundleGLOVE (GLuint bundle);
+GL_APICALL void GL_APIENTRY glEndCommandBundleGLOVE (void);
+GL_APICALL void GL_APIENTRY glCallCommandBundleGLOVE (GLuint bundle);
+#endif
+#endif /* GL_GLOVE_command_bundle */
+
+#ifndef GL_ES_VERSION_3_1
+/// the ES 3.1 indirect draws, which GL_EXT_multi_draw_indirect builds on, exposed to ES 2.0 contexts along with it.
+/// the commands are read from the buffer bound to GL_DRAW_INDIRECT_BUFFER, in the layouts of ES 3.1
+#define GL_DRAW_INDIRECT_BUFFER           0x8F3F
+#define GL_DRAW_INDIRECT_BUFFER_BINDING   0x8F43
+typedef void (GL_APIENTRYP PFNGLDRAWARRAYSINDIRECTPROC) (GLenum mode, const void *indirect);
+typedef void (GL_APIENTRYP PFNGLDRAWELEMENTSINDIRECTPROC) (GLenum mode, GLenum type, const void *indirect);
+#ifdef GL_GLEXT_PROTOTYPES
+GL_APICALL void GL_APIENTRY glDrawArraysIndirect (GLenum mode, const void *indirect);
+GL_APICALL void GL_APIENTRY glDrawElementsIndirect (GLenum mode, GLenum type, const void *indirect);
+#endif
+#endif /* GL_ES_VERSION_3_1 */
+
+#ifndef GL_GLOVE_compute_shader
+#define GL_GLOVE_compute_shader 1
+/// the ES 3.1 compute shaders, in GLSL ES 3.10, reading and writing the buffers bound to the indexed
+/// GL_SHADER_STORAGE_BUFFER targets. the uniforms of the default block are pushed as constants, so they fit
+/// in 128 bytes, and a program holds nothing but its compute shader
+#ifndef GL_ES_VERSION_3_1
+#define GL_COMPUTE_SHADER                 0x91B9
+#define GL_SHADER_STORAGE_BUFFER          0x90D2
+#define GL_SHADER_STORAGE_BUFFER_BINDING  0x90D3
+#define GL_SHADER_STORAGE_BUFFER_START    0x90D4
+#define GL_SHADER_STORAGE_BUFFER_SIZE     0x90D5
+#define GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS 0x90DD
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
+#define GL_MAX_COMPUTE_WORK_GROUP_COUNT   0x91BE
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_ELEMENT_ARRAY_BARRIER_BIT      0x00000002
+#define GL_UNIFORM_BARRIER_BIT            0x00000004
+#define GL_TEXTURE_FETCH_BARRIER_BIT      0x00000008
+#define GL_COMMAND_BARRIER_BIT            0x00000040
+#define GL_PIXEL_BUFFER_BARRIER_BIT       0x00000080
+#define GL_BUFFER_UPDATE_BARRIER_BIT      0x00000200
+#define GL_SHADER_STORAGE_BARRIER_BIT     0x00002000
+#define GL_ALL_BARRIER_BITS               0xFFFFFFFF
+typedef void (GL_APIENTRYP PFNGLDISPATCHCOMPUTEPROC) (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (GL_APIENTRYP PFNGLMEMORYBARRIERPROC) (GLbitfield barriers);
+typedef void (GL_APIENTRYP PFNGLBINDBUFFERBASEPROC) (GLenum target, GLuint index, GLuint buffer);
+typedef void (GL_APIENTRYP PFNGLBINDBUFFERRANGEPROC) (GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+#ifdef GL_GLEXT_PROTOTYPES
+GL_APICALL void GL_APIENTRY glDispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+GL_APICALL void GL_APIENTRY glMemoryBarrier (GLbitfield barriers);
+GL_APICALL void GL_APIENTRY glBindBufferBase (GLenum target, GLuint index, GLuint buffer);
+GL_APICALL void GL_APIENTRY glBindBufferRange (GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+#endif
+#endif /* GL_ES_VERSION_3_1 */
+#endif /* GL_GLOVE_compute_shader */
+
+#ifndef GL_GLOVE_transform_feedback
+#define GL_GLOVE_transform_feedback 1
+/// the ES 3.0 transform feedback of the outputs of vertex shaders into the buffers bound to the indexed
+/// GL_TRANSFORM_FEEDBACK_BUFFER targets, through glBindBufferBase and glBindBufferRange. only user defined
+/// outputs are captured, by glDrawArrays and glDrawArraysInstanced, and there are no transform feedback objects
+#ifndef GL_ES_VERSION_3_0
+#define GL_TRANSFORM_FEEDBACK_VARYING_MAX_LENGTH 0x8C76
+#define GL_TRANSFORM_FEEDBACK_BUFFER_MODE 0x8C7F
+#define GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS 0x8C80
+#define GL_TRANSFORM_FEEDBACK_VARYINGS    0x8C83
+#define GL_TRANSFORM_FEEDBACK_BUFFER_START 0x8C84
+#define GL_TRANSFORM_FEEDBACK_BUFFER_SIZE 0x8C85
+#define GL_RASTERIZER_DISCARD             0x8C89
+#define GL_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS 0x8C8A
+#define GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS 0x8C8B
+#define GL_INTERLEAVED_ATTRIBS            0x8C8C
+#define GL_SEPARATE_ATTRIBS               0x8C8D
+#define GL_TRANSFORM_FEEDBACK_BUFFER      0x8C8E
+#define GL_TRANSFORM_FEEDBACK_BUFFER_BINDING 0x8C8F
+#define GL_TRANSFORM_FEEDBACK_ACTIVE      0x8E24
+typedef void (GL_APIENTRYP PFNGLTRANSFORMFEEDBACKVARYINGSPROC) (GLuint program, GLsizei count, const GLchar *const*varyings, GLenum bufferMode);
+typedef void (GL_APIENTRYP PFNGLBEGINTRANSFORMFEEDBACKPROC) (GLenum primitiveMode);
+typedef void (GL_APIENTRYP PFNGLENDTRANSFORMFEEDBACKPROC) (void);
+#ifdef GL_GLEXT_PROTOTYPES
+GL_APICALL void GL_APIENTRY glTransformFeedbackVaryings (GLuint program, GLsizei count, const GLchar *const*varyings, GLenum bufferMode);
+GL_APICALL void GL_APIENTRY glBeginTransformFeedback (GLenum primitiveMode);
+GL_APICALL void GL_APIENTRY glEndTransformFeedback (void);
+#endif
+#endif /* GL_ES_VERSION_3_0 */
+#endif /* GL_GLOVE_transform_feedback */
+
+#ifndef GL_GLOVE_primitive_restart
+#define GL_GLOVE_primitive_restart 1
+/// the ES 3.0 GL_PRIMITIVE_RESTART_FIXED_INDEX capability, which cuts strips and fans where the highest index
+/// of the index type is drawn, and glDrawRangeElements, whose range spares the scan of the indices for it
+#ifndef GL_ES_VERSION_3_0
+#define GL_PRIMITIVE_RESTART_FIXED_INDEX  0x8D69
+typedef void (GL_APIENTRYP PFNGLDRAWRANGEELEMENTSPROC) (GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices);
+#ifdef GL_GLEXT_PROTOTYPES
+GL_APICALL void GL_APIENTRY glDrawRangeElements (GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices);
+#endif
+#endif /* GL_ES_VERSION_3_0 */
+#endif /* GL_GLOVE_primitive_restart */
+
+#ifndef GL_GLOVE_uniform_buffer_object
+#define GL_GLOVE_uniform_buffer_object 1
+/// the ES 3.0 uniform blocks, read by compute shaders of GL_GLOVE_compute_shader from the buffers bound to the
+/// indexed GL_UNIFORM_BUFFER targets, through glBindBufferBase and glBindBufferRange. each block of a program reads
+/// the binding glUniformBlockBinding has given it, the one of its layout qualifier until then
+#ifndef GL_ES_VERSION_3_0
+#define GL_UNIFORM_BUFFER                 0x8A11
+#define GL_UNIFORM_BUFFER_BINDING         0x8A28
+#define GL_UNIFORM_BUFFER_START           0x8A29
+#define GL_UNIFORM_BUFFER_SIZE            0x8A2A
+#define GL_MAX_UNIFORM_BUFFER_BINDINGS    0x8A2F
+#define GL_MAX_UNIFORM_BLOCK_SIZE         0x8A30
+#define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8A34
+#define GL_ACTIVE_UNIFORM_BLOCKS          0x8A36
+#define GL_INVALID_INDEX                  0xFFFFFFFFu
+typedef GLuint (GL_APIENTRYP PFNGLGETUNIFORMBLOCKINDEXPROC) (GLuint program, const GLchar *uniformBlockName);
+typedef void (GL_APIENTRYP PFNGLUNIFORMBLOCKBINDINGPROC) (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+#ifdef GL_GLEXT_PROTOTYPES
+GL_APICALL GLuint GL_APIENTRY glGetUniformBlockIndex (GLuint program, const GLchar *uniformBlockName);
+GL_APICALL void GL_APIENTRY glUniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+#endif
+#endif /* GL_ES_VERSION_3_0 */
+#ifndef GL_ES_VERSION_3_1
+#define GL_MAX_COMPUTE_UNIFORM_BLOCKS     0x91BB
+#endif /* GL_ES_VERSION_3_1 */
+#endif /* GL_GLOVE_uniform_buffer_object */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __gles2_gl2ext_glove_h_ */
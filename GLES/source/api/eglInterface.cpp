@@ -24,13 +24,14 @@
 #include "rendering_api_interface.h"
 #include "context/context.h"
 #include "glFunctions.h"
+#include "utils/glCapture.h"
 
 static vkInterface_t  vkInterface;
 static api_state_t    gles2_state = nullptr;
 
 api_state_t           init_API();
           void        terminate_API();
-api_context_t         create_context();
+api_context_t         create_context(api_context_t share_context);
 void                  set_read_write_surface(api_context_t api_context, EGLSurfaceInterface *eglReadSurfaceInterface, EGLSurfaceInterface *eglWriteSurfaceInterface);
 void                  delete_shared_surface_data(EGLSurfaceInterface *eglSurfaceInterface);
 void                  delete_context(api_context_t api_context);
@@ -39,8 +40,19 @@ GLPROC                get_proc_addr(const char* procname);
 void                  flush(api_context_t api_context);
 void                  finish(api_context_t api_context);
 void                  bind_to_texture(api_context_t api_context, uint32_t bind);
+void                  submit_frame(api_context_t api_context);
+void                  set_damage_region(api_context_t api_context, const EGLint *rects, EGLint n_rects);
+void *                create_fence(api_context_t api_context);
+void                  server_wait_fence(api_context_t api_context, void *fence);
+bool                  client_wait_fence(void *fence, uint64_t timeout);
+void                  destroy_fence(void *fence);
+void                  set_no_error(api_context_t api_context, bool no_error);
+void *                create_native_fence(api_context_t api_context);
+int                   dup_native_fence_fd(void *fence);
+bool                  export_texture_image(api_context_t api_context, uint32_t texture, EGLImageInterface *eglImage);
 
 static void           FillInVkInterface(vulkanAPI::vkContext_t* vkContext);
+static void           LockVkQueue(bool lock);
 
 rendering_api_interface_t GLES2Interface = {
     gles2_state,
@@ -54,7 +66,17 @@ rendering_api_interface_t GLES2Interface = {
     get_proc_addr,
     flush,
     finish,
-    bind_to_texture
+    bind_to_texture,
+    submit_frame,
+    set_damage_region,
+    create_fence,
+    server_wait_fence,
+    client_wait_fence,
+    destroy_fence,
+    set_no_error,
+    create_native_fence,
+    dup_native_fence_fd,
+    export_texture_image
 };
 
 #ifdef WIN32
@@ -67,17 +89,35 @@ rendering_api_interface_t* EGLAPIENTRY GetGLES2Interface(void)
 static void FillInVkInterface(vulkanAPI::vkContext_t* vkContext)
 {
     vkInterface.vkInstance = vkContext->vkInstance;
-    vkInterface.vkGpus = &vkContext->vkGpus[0];
+    vkInterface.vkPhysicalDevice = vkContext->vkPhysicalDevice;
     vkInterface.vkQueue = vkContext->vkQueue;
     vkInterface.vkGraphicsQueueNodeIndex = vkContext->vkGraphicsQueueNodeIndex;
     vkInterface.vkDeviceMemoryProperties = vkContext->vkDeviceMemoryProperties;
     vkInterface.vkDevice = vkContext->vkDevice;
     vkInterface.vkSyncItems = vkContext->vkSyncItems;
+    vkInterface.isIncrementalPresentSupported = vkContext->mIsIncrementalPresentSupported;
+    vkInterface.isDisplayTimingSupported = vkContext->mIsDisplayTimingSupported;
+    vkInterface.isDisplayControlSupported = vkContext->mIsDisplayControlSupported;
+    vkInterface.isExternalMemoryDmaBufSupported  = vkContext->mIsExternalMemoryDmaBufSupported;
+    vkInterface.isDrmFormatModifierSupported     = vkContext->mIsDrmFormatModifierSupported;
+    vkInterface.isAndroidHardwareBufferSupported = vkContext->mIsAndroidHardwareBufferSupported;
+    vkInterface.isSyncFdFenceSupported           = vkContext->mIsSyncFdFenceSupported;
+    vkInterface.vkLockQueue = LockVkQueue;
+}
+
+static void LockVkQueue(bool lock)
+{
+    if(lock) {
+        vulkanAPI::GetContext()->vkQueueMutex.lock();
+    } else {
+        vulkanAPI::GetContext()->vkQueueMutex.unlock();
+    }
 }
 
 api_state_t init_API()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("init API", "startup");
 
     vulkanAPI::InitContext();
 
@@ -91,24 +131,37 @@ void terminate_API()
     FUN_ENTRY(GL_LOG_DEBUG);
 
     vulkanAPI::TerminateContext();
+    GLCapture::Shutdown();
     GLLogger::Shutdown();
 }
 
-api_context_t create_context()
+api_context_t create_context(api_context_t share_context)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("create context", "startup");
 
-    Context *ctx = new Context();
+    Context *ctx = new Context(reinterpret_cast<Context *>(share_context));
     return ctx;
 }
 
 void set_read_write_surface(api_context_t api_context, EGLSurfaceInterface *eglReadSurfaceInterface, EGLSurfaceInterface *eglWriteSurfaceInterface)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("set surfaces", "startup");
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
+    // the calls still queued by a threaded dispatch run before EGL uses the context
+    ctx->SyncGLThread();
+    // EGL only submits the work of the context made not current, without waiting for it, and the one
+    // made current in its place orders its commands after it through a barrier (see ServerWaitFence)
+    if(GetCurrentContext() != ctx) {
+        ctx->GetVkCommandBufferManager()->WaitPriorSubmissions();
+    }
     SetCurrentContext(ctx);
     ctx->SetReadWriteSurfaces(eglReadSurfaceInterface, eglWriteSurfaceInterface);
+    if(eglWriteSurfaceInterface) {
+        CAPTURE_STATE(MakeCurrent(eglWriteSurfaceInterface->width, eglWriteSurfaceInterface->height));
+    }
 }
 
 void delete_shared_surface_data(EGLSurfaceInterface *eglSurfaceInterface)
@@ -132,6 +185,7 @@ void release_system_fbo(api_context_t api_context)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
     ctx->ReleaseSystemFBO();
 }
 
@@ -147,6 +201,7 @@ void flush(api_context_t api_context)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
     ctx->Flush();
 }
 
@@ -155,6 +210,7 @@ void finish(api_context_t api_context)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
     ctx->Finish();
 }
 
@@ -163,5 +219,93 @@ void bind_to_texture(api_context_t api_context, uint32_t bind)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
     ctx->BindToTexture(bind);
 }
+
+void submit_frame(api_context_t api_context)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    ctx->SubmitFrame();
+    ctx->EndFrame();
+    vulkanAPI::GetContext()->perfCounters->EndFrame();
+    CAPTURE_STATE(SwapBuffers());
+}
+
+void set_damage_region(api_context_t api_context, const EGLint *rects, EGLint n_rects)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    ctx->SetDamageRegion(rects, n_rects);
+}
+
+void *create_fence(api_context_t api_context)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    return ctx->CreateFence();
+}
+
+void server_wait_fence(api_context_t api_context, void *fence)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    ctx->ServerWaitFence(reinterpret_cast<vulkanAPI::Fence *>(fence));
+}
+
+bool client_wait_fence(void *fence, uint64_t timeout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return Context::ClientWaitFence(reinterpret_cast<vulkanAPI::Fence *>(fence), timeout);
+}
+
+void destroy_fence(void *fence)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context::DestroyFence(reinterpret_cast<vulkanAPI::Fence *>(fence));
+}
+
+void set_no_error(api_context_t api_context, bool no_error)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    ctx->SetNoError(no_error);
+}
+
+void *create_native_fence(api_context_t api_context)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    return ctx->CreateFence(true);
+}
+
+int dup_native_fence_fd(void *fence)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return Context::ExportFenceSyncFd(reinterpret_cast<vulkanAPI::Fence *>(fence));
+}
+
+bool export_texture_image(api_context_t api_context, uint32_t texture, EGLImageInterface *eglImage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *ctx = reinterpret_cast<Context *>(api_context);
+    ctx->SyncGLThread();
+    return ctx->ExportTextureImage(static_cast<GLuint>(texture), eglImage);
+}
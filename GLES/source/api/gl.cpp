@@ -19,870 +19,1135 @@
  *
  *  @brief      Entry points for the OpenGL ES API calls
  *
+ *  These are the implementations of the default dispatch table, which the
+ *  exported entry points of glDispatch.cpp call unless the current context
+ *  has installed a table of its own.
+ *
  */
 
+#include "glDispatch.h"
 #include "context/context.h"
+#include "utils/glCapture.h"
+#include "utils/systemTrace.h"
+#include "GLES2/gl2ext_glove.h"
+
+/// Any call other than a draw records the draws batched so far, so that
+/// they never see state set after them.
+/// With a threaded dispatch, CONTEXT_EXEC, CONTEXT_EXEC_RETURN and CONTEXT_EXEC_DRAW
+/// wait for the queued calls and run on the calling thread, as they return values,
+/// write to client memory or read client memory whose size is only known later.
+/// Every call is a span of the Chrome trace, queued calls a second one on the GL thread,
+/// and the waits on the GPU made in there are attributed to it.
+#define GL_CALL_SCOPE(name, category)                                                                       \
+                                    CHROME_TRACE_SPAN(name, category);                                       \
+                                    STALL_GL_CALL(name)
 
 #define CONTEXT_EXEC(func)          FUN_ENTRY(GL_LOG_INFO);                      \
+                                    GL_CALL_SCOPE(__func__, "gl");               \
                                     Context * context = GetCurrentContext();     \
                                     if (context) {                               \
+                                        context->SyncGLThread();                 \
+                                        context->FlushDrawBatch();               \
                                         context->func;                           \
                                     }
 
 #define CONTEXT_EXEC_RETURN(func)   FUN_ENTRY(GL_LOG_INFO);                      \
+                                    GL_CALL_SCOPE(__func__, "gl");               \
                                     Context * context = GetCurrentContext();     \
-                                    return context ? context->func : 0;
+                                    if (context) {                               \
+                                        context->SyncGLThread();                 \
+                                        context->FlushDrawBatch();               \
+                                    }                                            \
+                                    return glCapture.Return(context ? context->func : 0);
+
+#define CONTEXT_EXEC_DRAW(func)     FUN_ENTRY(GL_LOG_INFO);                      \
+                                    GL_CALL_SCOPE(__func__, "gl");               \
+                                    Context * context = GetCurrentContext();     \
+                                    if (context) {                               \
+                                        context->SyncGLThread();                 \
+                                        context->func;                           \
+                                    }
+
+/// Calls that only take values are queued to the GL thread when there is one
+#define CONTEXT_EXEC_ASYNC(func)    FUN_ENTRY(GL_LOG_INFO);                                                  \
+                                    GL_CALL_SCOPE(__func__, "gl");                                           \
+                                    const char *glCall = __func__;                                           \
+                                    Context * context = GetCurrentContext();                                 \
+                                    if (context) {                                                           \
+                                        GLThread *glThread = context->GetGLThread();                         \
+                                        if (!glThread || !glThread->Enqueue([=](const void *) {              \
+                                                GL_CALL_SCOPE(glCall, "gl thread");                          \
+                                                context->FlushDrawBatch();                                   \
+                                                context->func;                                               \
+                                            })) {                                                            \
+                                            context->SyncGLThread();                                         \
+                                            context->FlushDrawBatch();                                       \
+                                            context->func;                                                   \
+                                        }                                                                    \
+                                    }
+
+/// Draws are queued as long as they read no client memory, given by the client state of the GL thread
+#define CONTEXT_EXEC_DRAW_ASYNC(func, clientMemory)                                                          \
+                                    FUN_ENTRY(GL_LOG_INFO);                                                  \
+                                    GL_CALL_SCOPE(__func__, "gl");                                           \
+                                    const char *glCall = __func__;                                           \
+                                    Context * context = GetCurrentContext();                                 \
+                                    if (context) {                                                           \
+                                        GLThread *glThread = context->GetGLThread();                         \
+                                        if (!glThread || (clientMemory) ||                                   \
+                                            !glThread->Enqueue([=](const void *) {                           \
+                                                GL_CALL_SCOPE(glCall, "gl thread");                          \
+                                                context->func;                                               \
+                                            })) {                                                            \
+                                            context->SyncGLThread();                                         \
+                                            context->func;                                                   \
+                                        }                                                                    \
+                                    }
+
+/// Calls reading size bytes of client memory at data get a copy of it, which func refers to as payload
+#define CONTEXT_EXEC_COPY(func, data, size)                                                                  \
+                                    FUN_ENTRY(GL_LOG_INFO);                                                  \
+                                    GL_CALL_SCOPE(__func__, "gl");                                           \
+                                    const char *glCall = __func__;                                           \
+                                    Context * context = GetCurrentContext();                                 \
+                                    if (context) {                                                           \
+                                        GLThread *glThread = context->GetGLThread();                         \
+                                        if (!glThread || !glThread->Enqueue([=](const void *payload) {       \
+                                                GL_CALL_SCOPE(glCall, "gl thread");                          \
+                                                context->FlushDrawBatch();                                   \
+                                                context->func;                                               \
+                                            }, data, size)) {                                                \
+                                            const void *payload = data;                                      \
+                                            context->SyncGLThread();                                         \
+                                            context->FlushDrawBatch();                                       \
+                                            context->func;                                                   \
+                                        }                                                                    \
+                                    }
+
+/// Mirrors the client state that decides whether later calls can be queued
+#define CLIENT_STATE(func)          if (context && context->GetGLThread()) {     \
+                                        context->GetGLThread()->func;            \
+                                    }
+
+/// Bytes of client memory a call reads, none for a null pointer or a negative count
+static inline size_t
+ClientSize(const void *data, GLsizei count, size_t elementSize)
+{
+    return (data != nullptr && count > 0) ? static_cast<size_t>(count) * elementSize : 0;
+}
+
+namespace glDefault {
 
 void GL_APIENTRY
 glActiveTexture(GLenum texture)
 {
-    CONTEXT_EXEC(ActiveTexture(texture));
+    GL_CAPTURE(texture);
+    CONTEXT_EXEC_ASYNC(ActiveTexture(texture));
 }
 
 void GL_APIENTRY
 glAttachShader(GLuint program, GLuint shader)
 {
-    CONTEXT_EXEC(AttachShader(program, shader));
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureName(shader, CAPTURE_NAME_SHADER));
+    CONTEXT_EXEC_ASYNC(AttachShader(program, shader));
 }
 
 void GL_APIENTRY
 glBindAttribLocation(GLuint program, GLuint index, const char* name)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), index, CaptureString(name));
     CONTEXT_EXEC(BindAttribLocation(program, index, name));
 }
 
 void GL_APIENTRY
 glBindBuffer(GLenum target, GLuint buffer)
 {
-    CONTEXT_EXEC(BindBuffer(target, buffer));
+    GL_CAPTURE(target, CaptureName(buffer, CAPTURE_NAME_BUFFER));
+    CONTEXT_EXEC_ASYNC(BindBuffer(target, buffer));
+    CLIENT_STATE(BindBuffer(target, buffer));
+    CAPTURE_STATE(BindBuffer(target, buffer));
 }
 
 void GL_APIENTRY
 glBindFramebuffer(GLenum target, GLuint framebuffer)
 {
-    CONTEXT_EXEC(BindFramebuffer(target, framebuffer));
+    GL_CAPTURE(target, CaptureName(framebuffer, CAPTURE_NAME_FRAMEBUFFER));
+    CONTEXT_EXEC_ASYNC(BindFramebuffer(target, framebuffer));
 }
 
 void GL_APIENTRY
 glBindRenderbuffer(GLenum target, GLuint renderbuffer)
 {
-    CONTEXT_EXEC(BindRenderbuffer(target, renderbuffer));
+    GL_CAPTURE(target, CaptureName(renderbuffer, CAPTURE_NAME_RENDERBUFFER));
+    CONTEXT_EXEC_ASYNC(BindRenderbuffer(target, renderbuffer));
 }
 
 void GL_APIENTRY
 glBlendColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
 {
-    CONTEXT_EXEC(BlendColor(red, green, blue, alpha));
+    GL_CAPTURE(red, green, blue, alpha);
+    CONTEXT_EXEC_ASYNC(BlendColor(red, green, blue, alpha));
 }
 
 void GL_APIENTRY
 glBlendEquation(GLenum mode)
 {
-    CONTEXT_EXEC(BlendEquation(mode));
+    GL_CAPTURE(mode);
+    CONTEXT_EXEC_ASYNC(BlendEquation(mode));
 }
 
 void GL_APIENTRY
 glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
 {
-    CONTEXT_EXEC(BlendEquationSeparate(modeRGB, modeAlpha));
+    GL_CAPTURE(modeRGB, modeAlpha);
+    CONTEXT_EXEC_ASYNC(BlendEquationSeparate(modeRGB, modeAlpha));
 }
 
 void GL_APIENTRY
 glBlendFunc(GLenum sfactor, GLenum dfactor)
 {
-    CONTEXT_EXEC(BlendFunc(sfactor, dfactor));
+    GL_CAPTURE(sfactor, dfactor);
+    CONTEXT_EXEC_ASYNC(BlendFunc(sfactor, dfactor));
 }
 
 void GL_APIENTRY
 glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
 {
-    CONTEXT_EXEC(BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha));
+    GL_CAPTURE(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    CONTEXT_EXEC_ASYNC(BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha));
 }
 
 void GL_APIENTRY
 glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
 {
-    CONTEXT_EXEC(BufferData(target, size, data, usage));
+    GL_CAPTURE(target, size, CaptureBlob(data, ClientSize(data, size > 0, static_cast<size_t>(size))), usage);
+    CONTEXT_EXEC_COPY(BufferData(target, size, payload, usage), data, ClientSize(data, size > 0, static_cast<size_t>(size)));
+    CAPTURE_STATE(BufferData(target, size));
 }
 
 void GL_APIENTRY
 glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
 {
-    CONTEXT_EXEC(BufferSubData(target, offset, size, data));
+    GL_CAPTURE(target, offset, size, CaptureBlob(data, ClientSize(data, size > 0, static_cast<size_t>(size))));
+    CONTEXT_EXEC_COPY(BufferSubData(target, offset, size, payload), data, ClientSize(data, size > 0, static_cast<size_t>(size)));
 }
 
 GLenum GL_APIENTRY
 glCheckFramebufferStatus(GLenum target)
 {
+    GL_CAPTURE(target);
     CONTEXT_EXEC_RETURN(CheckFramebufferStatus(target));
 }
 
 void GL_APIENTRY
 glClear(GLbitfield mask)
 {
-    CONTEXT_EXEC(Clear(mask));
+    GL_CAPTURE(mask);
+    CONTEXT_EXEC_ASYNC(Clear(mask));
 }
 
 void GL_APIENTRY
 glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
 {
-    CONTEXT_EXEC(ClearColor(red, green, blue, alpha));
+    GL_CAPTURE(red, green, blue, alpha);
+    CONTEXT_EXEC_ASYNC(ClearColor(red, green, blue, alpha));
 }
 
 void GL_APIENTRY
 glClearDepthf(GLclampf depth)
 {
-    CONTEXT_EXEC(ClearDepthf(depth));
+    GL_CAPTURE(depth);
+    CONTEXT_EXEC_ASYNC(ClearDepthf(depth));
 }
 
 void GL_APIENTRY
 glClearStencil(GLint s)
 {
-    CONTEXT_EXEC(ClearStencil(s));
+    GL_CAPTURE(s);
+    CONTEXT_EXEC_ASYNC(ClearStencil(s));
 }
 
 void GL_APIENTRY
 glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
 {
-    CONTEXT_EXEC(ColorMask(red, green, blue, alpha));
+    GL_CAPTURE(red, green, blue, alpha);
+    CONTEXT_EXEC_ASYNC(ColorMask(red, green, blue, alpha));
 }
 
 void GL_APIENTRY
 glCompileShader(GLuint shader)
 {
-    CONTEXT_EXEC(CompileShader(shader));
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER));
+    CONTEXT_EXEC_ASYNC(CompileShader(shader));
 }
 
 void GL_APIENTRY
 glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
 {
-    CONTEXT_EXEC(CompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data));
+    GL_CAPTURE(target, level, internalformat, width, height, border, imageSize, CaptureBlob(data, ClientSize(data, imageSize, 1)));
+    CONTEXT_EXEC_COPY(CompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, payload), data, ClientSize(data, imageSize, 1));
 }
 
 void GL_APIENTRY
 glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data)
 {
-    CONTEXT_EXEC(CompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data));
+    GL_CAPTURE(target, level, xoffset, yoffset, width, height, format, imageSize, CaptureBlob(data, ClientSize(data, imageSize, 1)));
+    CONTEXT_EXEC_COPY(CompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, payload), data, ClientSize(data, imageSize, 1));
 }
 
 void GL_APIENTRY
 glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border)
 {
-    CONTEXT_EXEC(CopyTexImage2D(target, level, internalformat, x, y, width, height, border));
+    GL_CAPTURE(target, level, internalformat, x, y, width, height, border);
+    CONTEXT_EXEC_ASYNC(CopyTexImage2D(target, level, internalformat, x, y, width, height, border));
 }
 
 void GL_APIENTRY
 glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height)
 {
-    CONTEXT_EXEC(CopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height));
+    GL_CAPTURE(target, level, xoffset, yoffset, x, y, width, height);
+    CONTEXT_EXEC_ASYNC(CopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height));
 }
 
 GLuint GL_APIENTRY
 glCreateProgram(void)
 {
+    GL_CAPTURE();
+    glCapture.ReturnsName(CAPTURE_NAME_PROGRAM);
     CONTEXT_EXEC_RETURN(CreateProgram());
 }
 
 GLuint GL_APIENTRY
 glCreateShader(GLenum type)
 {
+    GL_CAPTURE(type);
+    glCapture.ReturnsName(CAPTURE_NAME_SHADER);
     CONTEXT_EXEC_RETURN(CreateShader(type));
 }
 
 void GL_APIENTRY
 glCullFace(GLenum mode)
 {
-    CONTEXT_EXEC(CullFace(mode));
+    GL_CAPTURE(mode);
+    CONTEXT_EXEC_ASYNC(CullFace(mode));
 }
 
 void GL_APIENTRY
 glDeleteBuffers(GLsizei n, const GLuint* buffers)
 {
-    CONTEXT_EXEC(DeleteBuffers(n, buffers));
+    GL_CAPTURE(n, CaptureNames(buffers, n, CAPTURE_NAME_BUFFER));
+    CONTEXT_EXEC_COPY(DeleteBuffers(n, static_cast<const GLuint *>(payload)), buffers, ClientSize(buffers, n, sizeof(GLuint)));
+    CLIENT_STATE(DeleteBuffers(n, buffers));
+    CAPTURE_STATE(DeleteBuffers(n, buffers));
 }
 
 void GL_APIENTRY
 glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
 {
-    CONTEXT_EXEC(DeleteFramebuffers(n, framebuffers));
+    GL_CAPTURE(n, CaptureNames(framebuffers, n, CAPTURE_NAME_FRAMEBUFFER));
+    CONTEXT_EXEC_COPY(DeleteFramebuffers(n, static_cast<const GLuint *>(payload)), framebuffers, ClientSize(framebuffers, n, sizeof(GLuint)));
 }
 
 void GL_APIENTRY
 glDeleteProgram(GLuint program)
 {
-    CONTEXT_EXEC(DeleteProgram(program));
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM));
+    CONTEXT_EXEC_ASYNC(DeleteProgram(program));
 }
 
 void GL_APIENTRY
 glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
 {
-    CONTEXT_EXEC(DeleteRenderbuffers(n, renderbuffers));
+    GL_CAPTURE(n, CaptureNames(renderbuffers, n, CAPTURE_NAME_RENDERBUFFER));
+    CONTEXT_EXEC_COPY(DeleteRenderbuffers(n, static_cast<const GLuint *>(payload)), renderbuffers, ClientSize(renderbuffers, n, sizeof(GLuint)));
 }
 
 void GL_APIENTRY
 glDeleteShader(GLuint shader)
 {
-    CONTEXT_EXEC(DeleteShader(shader));
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER));
+    CONTEXT_EXEC_ASYNC(DeleteShader(shader));
 }
 
 void GL_APIENTRY
 glDeleteTextures(GLsizei n, const GLuint* textures)
 {
-    CONTEXT_EXEC(DeleteTextures(n, textures));
+    GL_CAPTURE(n, CaptureNames(textures, n, CAPTURE_NAME_TEXTURE));
+    CONTEXT_EXEC_COPY(DeleteTextures(n, static_cast<const GLuint *>(payload)), textures, ClientSize(textures, n, sizeof(GLuint)));
 }
 
 void GL_APIENTRY
 glDepthFunc(GLenum func)
 {
-    CONTEXT_EXEC(DepthFunc(func));
+    GL_CAPTURE(func);
+    CONTEXT_EXEC_ASYNC(DepthFunc(func));
 }
 
 void GL_APIENTRY
 glDepthMask(GLboolean flag)
 {
-    CONTEXT_EXEC(DepthMask(flag));
+    GL_CAPTURE(flag);
+    CONTEXT_EXEC_ASYNC(DepthMask(flag));
 }
 
 void GL_APIENTRY
 glDepthRangef(GLclampf zNear, GLclampf zFar)
 {
-    CONTEXT_EXEC(DepthRangef(zNear, zFar));
+    GL_CAPTURE(zNear, zFar);
+    CONTEXT_EXEC_ASYNC(DepthRangef(zNear, zFar));
 }
 
 void GL_APIENTRY
 glDetachShader(GLuint program, GLuint shader)
 {
-    CONTEXT_EXEC(DetachShader(program, shader));
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureName(shader, CAPTURE_NAME_SHADER));
+    CONTEXT_EXEC_ASYNC(DetachShader(program, shader));
 }
 
 void GL_APIENTRY
 glDisable(GLenum cap)
 {
-    CONTEXT_EXEC(Disable(cap));
+    GL_CAPTURE(cap);
+    CONTEXT_EXEC_ASYNC(Disable(cap));
 }
 
 void GL_APIENTRY
 glDisableVertexAttribArray(GLuint index)
 {
-    CONTEXT_EXEC(DisableVertexAttribArray(index));
+    GL_CAPTURE(index);
+    CONTEXT_EXEC_ASYNC(DisableVertexAttribArray(index));
+    CLIENT_STATE(SetVertexAttribArrayEnabled(index, false));
+    CAPTURE_STATE(SetVertexAttribArrayEnabled(index, false));
 }
 
 void GL_APIENTRY
 glDrawArrays(GLenum mode, GLint first, GLsizei count)
 {
-    CONTEXT_EXEC(DrawArrays(mode, first, count));
+    CAPTURE_STATE(ClientArrays(first, count));
+    GL_CAPTURE(mode, first, count);
+    CONTEXT_EXEC_DRAW_ASYNC(DrawArrays(mode, first, count), glThread->UsesClientArrays());
 }
 
 void GL_APIENTRY
 glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
 {
-    CONTEXT_EXEC(DrawElements(mode, count, type, indices));
+    CAPTURE_STATE(ClientArrays(count, type, indices));
+    GL_CAPTURE(mode, count, type, CaptureIndices(indices, count, type));
+    CONTEXT_EXEC_DRAW_ASYNC(DrawElements(mode, count, type, indices), glThread->UsesClientArrays() || glThread->UsesClientIndices());
 }
 
 void GL_APIENTRY
 glEnable(GLenum cap)
 {
-    CONTEXT_EXEC(Enable(cap));
+    GL_CAPTURE(cap);
+    CONTEXT_EXEC_ASYNC(Enable(cap));
 }
 
 void GL_APIENTRY
 glEnableVertexAttribArray(GLuint index)
 {
-    CONTEXT_EXEC(EnableVertexAttribArray(index));
+    GL_CAPTURE(index);
+    CONTEXT_EXEC_ASYNC(EnableVertexAttribArray(index));
+    CLIENT_STATE(SetVertexAttribArrayEnabled(index, true));
+    CAPTURE_STATE(SetVertexAttribArrayEnabled(index, true));
 }
 
 void GL_APIENTRY
 glFinish(void)
 {
+    GL_CAPTURE();
     CONTEXT_EXEC(Finish());
 }
 
 void GL_APIENTRY
 glFlush(void)
 {
-    CONTEXT_EXEC(Flush());
+    GL_CAPTURE();
+    CONTEXT_EXEC_ASYNC(FlushHint());
 }
 
 void GL_APIENTRY
 glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
 {
-    CONTEXT_EXEC(FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer));
+    GL_CAPTURE(target, attachment, renderbuffertarget, CaptureName(renderbuffer, CAPTURE_NAME_RENDERBUFFER));
+    CONTEXT_EXEC_ASYNC(FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer));
 }
 
 void GL_APIENTRY
 glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
-    CONTEXT_EXEC(FramebufferTexture2D(target, attachment, textarget, texture, level));
+    GL_CAPTURE(target, attachment, textarget, CaptureName(texture, CAPTURE_NAME_TEXTURE), level);
+    CONTEXT_EXEC_ASYNC(FramebufferTexture2D(target, attachment, textarget, texture, level));
 }
 
 void GL_APIENTRY
 glFrontFace(GLenum mode)
 {
-    CONTEXT_EXEC(FrontFace(mode));
+    GL_CAPTURE(mode);
+    CONTEXT_EXEC_ASYNC(FrontFace(mode));
 }
 
 void GL_APIENTRY
 glGenBuffers(GLsizei n, GLuint* buffers)
 {
+    GL_CAPTURE(n, CaptureNamesOut(buffers, n, CAPTURE_NAME_BUFFER));
     CONTEXT_EXEC(GenBuffers(n, buffers));
 }
 
 void GL_APIENTRY
 glGenerateMipmap(GLenum target)
 {
-    CONTEXT_EXEC(GenerateMipmap(target));
+    GL_CAPTURE(target);
+    CONTEXT_EXEC_ASYNC(GenerateMipmap(target));
 }
 
 void GL_APIENTRY
 glGenFramebuffers(GLsizei n, GLuint* framebuffers)
 {
+    GL_CAPTURE(n, CaptureNamesOut(framebuffers, n, CAPTURE_NAME_FRAMEBUFFER));
     CONTEXT_EXEC(GenFramebuffers(n, framebuffers));
 }
 
 void GL_APIENTRY
 glGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
 {
+    GL_CAPTURE(n, CaptureNamesOut(renderbuffers, n, CAPTURE_NAME_RENDERBUFFER));
     CONTEXT_EXEC(GenRenderbuffers(n, renderbuffers));
 }
 
 void GL_APIENTRY
 glBindTexture(GLenum target, GLuint texture)
 {
-    CONTEXT_EXEC(BindTexture(target, texture));
+    GL_CAPTURE(target, CaptureName(texture, CAPTURE_NAME_TEXTURE));
+    CONTEXT_EXEC_ASYNC(BindTexture(target, texture));
 }
 
 void GL_APIENTRY
 glGenTextures(GLsizei n, GLuint* textures)
 {
+    GL_CAPTURE(n, CaptureNamesOut(textures, n, CAPTURE_NAME_TEXTURE));
     CONTEXT_EXEC(GenTextures(n, textures));
 }
 
 void GL_APIENTRY
 glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, char* name)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), index, bufsize, CaptureOut(length, 0), CaptureOut(size, 0), CaptureOut(type, 0), CaptureOut(name, 0));
     CONTEXT_EXEC(GetActiveAttrib(program, index, bufsize, length, size, type, name));
 }
 
 void GL_APIENTRY
 glGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, char* name)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), index, bufsize, CaptureOut(length, 0), CaptureOut(size, 0), CaptureOut(type, 0), CaptureOut(name, 0));
     CONTEXT_EXEC(GetActiveUniform(program, index, bufsize, length, size, type, name));
 }
 
 void GL_APIENTRY
 glGetAttachedShaders(GLuint program, GLsizei maxcount, GLsizei* count, GLuint* shaders)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), maxcount, CaptureOut(count, 0), CaptureOut(shaders, 0));
     CONTEXT_EXEC(GetAttachedShaders(program, maxcount, count, shaders));
 }
 
 int  GL_APIENTRY
 glGetAttribLocation(GLuint program, const char* name)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureString(name));
     CONTEXT_EXEC_RETURN(GetAttribLocation(program, name));
 }
 
 void GL_APIENTRY
 glGetBooleanv(GLenum pname, GLboolean* params)
 {
+    GL_CAPTURE(pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetBooleanv(pname, params));
 }
 
 void GL_APIENTRY
 glGetBufferParameteriv(GLenum target, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(target, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetBufferParameteriv(target, pname, params));
 }
 
 GLenum GL_APIENTRY
 glGetError(void)
 {
+    GL_CAPTURE();
     CONTEXT_EXEC_RETURN(GetError());
 }
 
 void GL_APIENTRY
 glGetFloatv(GLenum pname, GLfloat* params)
 {
+    GL_CAPTURE(pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetFloatv(pname, params));
 }
 
 void GL_APIENTRY
 glGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(target, attachment, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetFramebufferAttachmentParameteriv(target, attachment, pname, params));
 }
 
 void GL_APIENTRY
 glGetIntegerv(GLenum pname, GLint* params)
 {
+    GL_CAPTURE(pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetIntegerv(pname, params));
 }
 
 void GL_APIENTRY
 glGetProgramiv(GLuint program, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetProgramiv(program, pname, params));
 }
 
 void GL_APIENTRY
 glGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, char* infolog)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), bufsize, CaptureOut(length, 0), CaptureOut(infolog, 0));
     CONTEXT_EXEC(GetProgramInfoLog(program, bufsize, length, infolog));
 }
 
 void GL_APIENTRY
 glGetRenderbufferParameteriv(GLenum target, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(target, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetRenderbufferParameteriv(target, pname, params));
 }
 
 void GL_APIENTRY
 glGetShaderiv(GLuint shader, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER), pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetShaderiv(shader, pname, params));
 }
 
 void GL_APIENTRY
 glGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, char* infolog)
 {
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER), bufsize, CaptureOut(length, 0), CaptureOut(infolog, 0));
     CONTEXT_EXEC(GetShaderInfoLog(shader, bufsize, length, infolog));
 }
 
 void GL_APIENTRY
 glGetShaderPrecisionFormat(GLenum shadertype, GLenum precisiontype, GLint* range, GLint* precision)
 {
+    GL_CAPTURE(shadertype, precisiontype, CaptureOut(range, 0), CaptureOut(precision, 0));
     CONTEXT_EXEC(GetShaderPrecisionFormat(shadertype, precisiontype, range, precision));
 }
 
 void GL_APIENTRY
 glGetShaderSource(GLuint shader, GLsizei bufsize, GLsizei* length, char* source)
 {
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER), bufsize, CaptureOut(length, 0), CaptureOut(source, 0));
     CONTEXT_EXEC(GetShaderSource(shader, bufsize, length, source));
 }
 
 const GLubyte* GL_APIENTRY
 glGetString(GLenum name)
 {
+    GL_CAPTURE(name);
     CONTEXT_EXEC_RETURN(GetString(name));
 }
 
 void GL_APIENTRY
 glGetTexParameterfv(GLenum target, GLenum pname, GLfloat* params)
 {
+    GL_CAPTURE(target, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetTexParameterfv(target, pname, params));
 }
 
 void GL_APIENTRY
 glGetTexParameteriv(GLenum target, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(target, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetTexParameteriv(target, pname, params));
 }
 
 void GL_APIENTRY
 glGetUniformfv(GLuint program, GLint location, GLfloat* params)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureLocation(location, program), CaptureOut(params, 0));
     CONTEXT_EXEC(GetUniformfv(program, location, params));
 }
 
 void GL_APIENTRY
 glGetUniformiv(GLuint program, GLint location, GLint* params)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureLocation(location, program), CaptureOut(params, 0));
     CONTEXT_EXEC(GetUniformiv(program, location, params));
 }
 
 int  GL_APIENTRY
 glGetUniformLocation(GLuint program, const char* name)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureString(name));
+    glCapture.ReturnsLocation(program);
     CONTEXT_EXEC_RETURN(GetUniformLocation(program, name));
 }
 
 void GL_APIENTRY
 glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat* params)
 {
+    GL_CAPTURE(index, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetVertexAttribfv(index, pname, params));
 }
 
 void GL_APIENTRY
 glGetVertexAttribiv(GLuint index, GLenum pname, GLint* params)
 {
+    GL_CAPTURE(index, pname, CaptureOut(params, 0));
     CONTEXT_EXEC(GetVertexAttribiv(index, pname, params));
 }
 
 void GL_APIENTRY
 glGetVertexAttribPointerv(GLuint index, GLenum pname, void** pointer)
 {
+    GL_CAPTURE(index, pname, CaptureOut(pointer, 0));
     CONTEXT_EXEC(GetVertexAttribPointerv(index, pname, pointer));
 }
 
 void GL_APIENTRY
 glHint(GLenum target, GLenum mode)
 {
-    CONTEXT_EXEC(Hint(target, mode));
+    GL_CAPTURE(target, mode);
+    CONTEXT_EXEC_ASYNC(Hint(target, mode));
 }
 
 GLboolean GL_APIENTRY
 glIsBuffer(GLuint buffer)
 {
+    GL_CAPTURE(CaptureName(buffer, CAPTURE_NAME_BUFFER));
     CONTEXT_EXEC_RETURN(IsBuffer(buffer));
 }
 
 GLboolean GL_APIENTRY
 glIsEnabled(GLenum cap)
 {
+    GL_CAPTURE(cap);
     CONTEXT_EXEC_RETURN(IsEnabled(cap));
 }
 
 GLboolean GL_APIENTRY
 glIsFramebuffer(GLuint framebuffer)
 {
+    GL_CAPTURE(CaptureName(framebuffer, CAPTURE_NAME_FRAMEBUFFER));
     CONTEXT_EXEC_RETURN(IsFramebuffer(framebuffer));
 }
 
 GLboolean GL_APIENTRY
 glIsProgram(GLuint program)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM));
     CONTEXT_EXEC_RETURN(IsProgram(program));
 }
 
 GLboolean GL_APIENTRY
 glIsRenderbuffer(GLuint renderbuffer)
 {
+    GL_CAPTURE(CaptureName(renderbuffer, CAPTURE_NAME_RENDERBUFFER));
     CONTEXT_EXEC_RETURN(IsRenderbuffer(renderbuffer));
 }
 
 GLboolean GL_APIENTRY
 glIsShader(GLuint shader)
 {
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER));
     CONTEXT_EXEC_RETURN(IsShader(shader));
 }
 
 GLboolean GL_APIENTRY
 glIsTexture(GLuint texture)
 {
+    GL_CAPTURE(CaptureName(texture, CAPTURE_NAME_TEXTURE));
     CONTEXT_EXEC_RETURN(IsTexture(texture));
 }
 
 void GL_APIENTRY
 glLineWidth(GLfloat width)
 {
-    CONTEXT_EXEC(LineWidth(width));
+    GL_CAPTURE(width);
+    CONTEXT_EXEC_ASYNC(LineWidth(width));
 }
 
 void GL_APIENTRY
 glLinkProgram(GLuint program)
 {
-    CONTEXT_EXEC(LinkProgram(program));
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM));
+    CONTEXT_EXEC_ASYNC(LinkProgram(program));
 }
 
 void GL_APIENTRY
 glPixelStorei(GLenum pname, GLint param)
 {
-    CONTEXT_EXEC(PixelStorei(pname, param));
+    GL_CAPTURE(pname, param);
+    CONTEXT_EXEC_ASYNC(PixelStorei(pname, param));
+    CAPTURE_STATE(PixelStorei(pname, param));
 }
 
 void GL_APIENTRY
 glPolygonOffset(GLfloat factor, GLfloat units)
 {
-    CONTEXT_EXEC(PolygonOffset(factor, units));
+    GL_CAPTURE(factor, units);
+    CONTEXT_EXEC_ASYNC(PolygonOffset(factor, units));
 }
 
 void GL_APIENTRY
 glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
 {
+    GL_CAPTURE(x, y, width, height, format, type, CaptureOut(pixels, GLCapture::ImageSize(width, height, format, type, true)));
     CONTEXT_EXEC(ReadPixels(x, y, width, height, format, type, pixels));
 }
 
 void GL_APIENTRY
 glReleaseShaderCompiler(void)
 {
-    CONTEXT_EXEC(ReleaseShaderCompiler());
+    GL_CAPTURE();
+    CONTEXT_EXEC_ASYNC(ReleaseShaderCompiler());
 }
 
 void GL_APIENTRY
 glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
 {
-    CONTEXT_EXEC(RenderbufferStorage(target, internalformat, width, height));
+    GL_CAPTURE(target, internalformat, width, height);
+    CONTEXT_EXEC_ASYNC(RenderbufferStorage(target, internalformat, width, height));
 }
 
 void GL_APIENTRY
 glSampleCoverage(GLclampf value, GLboolean invert)
 {
-    CONTEXT_EXEC(SampleCoverage(value, invert));
+    GL_CAPTURE(value, invert);
+    CONTEXT_EXEC_ASYNC(SampleCoverage(value, invert));
 }
 
 void GL_APIENTRY
 glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
 {
-    CONTEXT_EXEC(Scissor(x, y, width, height));
+    GL_CAPTURE(x, y, width, height);
+    CONTEXT_EXEC_ASYNC(Scissor(x, y, width, height));
 }
 
 void GL_APIENTRY
 glShaderBinary(GLsizei n, const GLuint* shaders, GLenum binaryformat, const void* binary, GLsizei length)
 {
+    GL_CAPTURE(n, CaptureNames(shaders, n, CAPTURE_NAME_SHADER), binaryformat, CaptureBlob(binary, ClientSize(binary, length, 1)), length);
     CONTEXT_EXEC(ShaderBinary(n, shaders, binaryformat, binary, length));
 }
 
 void GL_APIENTRY
 glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
 {
+    GL_CAPTURE(CaptureName(shader, CAPTURE_NAME_SHADER), count, CaptureStrings(string, length, count), CaptureBlob(nullptr, 0));
     CONTEXT_EXEC(ShaderSource(shader, count, string, length));
 }
 
 void GL_APIENTRY
 glStencilFunc(GLenum func, GLint ref, GLuint mask)
 {
-    CONTEXT_EXEC(StencilFunc(func, ref, mask));
+    GL_CAPTURE(func, ref, mask);
+    CONTEXT_EXEC_ASYNC(StencilFunc(func, ref, mask));
 }
 
 void GL_APIENTRY
 glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
 {
-    CONTEXT_EXEC(StencilFuncSeparate(face, func, ref, mask));
+    GL_CAPTURE(face, func, ref, mask);
+    CONTEXT_EXEC_ASYNC(StencilFuncSeparate(face, func, ref, mask));
 }
 
 void GL_APIENTRY
 glStencilMask(GLuint mask)
 {
-    CONTEXT_EXEC(StencilMask(mask));
+    GL_CAPTURE(mask);
+    CONTEXT_EXEC_ASYNC(StencilMask(mask));
 }
 
 void GL_APIENTRY
 glStencilMaskSeparate(GLenum face, GLuint mask)
 {
-    CONTEXT_EXEC(StencilMaskSeparate(face, mask));
+    GL_CAPTURE(face, mask);
+    CONTEXT_EXEC_ASYNC(StencilMaskSeparate(face, mask));
 }
 
 void GL_APIENTRY
 glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
 {
-    CONTEXT_EXEC(StencilOp(fail, zfail, zpass));
+    GL_CAPTURE(fail, zfail, zpass);
+    CONTEXT_EXEC_ASYNC(StencilOp(fail, zfail, zpass));
 }
 
 void GL_APIENTRY
 glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum zpass)
 {
-    CONTEXT_EXEC(StencilOpSeparate(face, fail, zfail, zpass));
+    GL_CAPTURE(face, fail, zfail, zpass);
+    CONTEXT_EXEC_ASYNC(StencilOpSeparate(face, fail, zfail, zpass));
 }
 
 void GL_APIENTRY
 glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
 {
+    GL_CAPTURE(target, level, internalformat, width, height, border, format, type, CaptureBlob(pixels, pixels ? GLCapture::ImageSize(width, height, format, type, false) : 0));
     CONTEXT_EXEC(TexImage2D(target, level, internalformat, width, height, border, format, type, pixels));
 }
 
 void GL_APIENTRY
 glTexParameterf(GLenum target, GLenum pname, GLfloat param)
 {
-    CONTEXT_EXEC(TexParameterf(target, pname, param));
+    GL_CAPTURE(target, pname, param);
+    CONTEXT_EXEC_ASYNC(TexParameterf(target, pname, param));
 }
 
 void GL_APIENTRY
 glTexParameterfv(GLenum target, GLenum pname, const GLfloat* params)
 {
-    CONTEXT_EXEC(TexParameterfv(target, pname, params));
+    GL_CAPTURE(target, pname, CaptureBlob(params, ClientSize(params, 1, sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(TexParameterfv(target, pname, static_cast<const GLfloat *>(payload)), params, ClientSize(params, 1, sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glTexParameteri(GLenum target, GLenum pname, GLint param)
 {
-    CONTEXT_EXEC(TexParameteri(target, pname, param));
+    GL_CAPTURE(target, pname, param);
+    CONTEXT_EXEC_ASYNC(TexParameteri(target, pname, param));
 }
 
 void GL_APIENTRY
 glTexParameteriv(GLenum target, GLenum pname, const GLint* params)
 {
-    CONTEXT_EXEC(TexParameteriv(target, pname, params));
+    GL_CAPTURE(target, pname, CaptureBlob(params, ClientSize(params, 1, sizeof(GLint))));
+    CONTEXT_EXEC_COPY(TexParameteriv(target, pname, static_cast<const GLint *>(payload)), params, ClientSize(params, 1, sizeof(GLint)));
 }
 
 void GL_APIENTRY
 glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
 {
+    GL_CAPTURE(target, level, xoffset, yoffset, width, height, format, type, CaptureBlob(pixels, pixels ? GLCapture::ImageSize(width, height, format, type, false) : 0));
     CONTEXT_EXEC(TexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels));
 }
 
 void GL_APIENTRY
 glUniform1f(GLint location, GLfloat x)
 {
-    CONTEXT_EXEC(Uniform1f(location, x));
+    GL_CAPTURE(CaptureLocation(location), x);
+    CONTEXT_EXEC_ASYNC(Uniform1f(location, x));
 }
 
 void GL_APIENTRY
 glUniform1fv(GLint location, GLsizei count, const GLfloat* v)
 {
-    CONTEXT_EXEC(Uniform1fv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 1 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(Uniform1fv(location, count, static_cast<const GLfloat *>(payload)), v, ClientSize(v, count, 1 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUniform1i(GLint location, GLint x)
 {
-    CONTEXT_EXEC(Uniform1i(location, x));
+    GL_CAPTURE(CaptureLocation(location), x);
+    CONTEXT_EXEC_ASYNC(Uniform1i(location, x));
 }
 
 void GL_APIENTRY
 glUniform1iv(GLint location, GLsizei count, const GLint* v)
 {
-    CONTEXT_EXEC(Uniform1iv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 1 * sizeof(GLint))));
+    CONTEXT_EXEC_COPY(Uniform1iv(location, count, static_cast<const GLint *>(payload)), v, ClientSize(v, count, 1 * sizeof(GLint)));
 }
 
 void GL_APIENTRY
 glUniform2f(GLint location, GLfloat x, GLfloat y)
 {
-    CONTEXT_EXEC(Uniform2f(location, x, y));
+    GL_CAPTURE(CaptureLocation(location), x, y);
+    CONTEXT_EXEC_ASYNC(Uniform2f(location, x, y));
 }
 
 void GL_APIENTRY
 glUniform2fv(GLint location, GLsizei count, const GLfloat* v)
 {
-    CONTEXT_EXEC(Uniform2fv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 2 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(Uniform2fv(location, count, static_cast<const GLfloat *>(payload)), v, ClientSize(v, count, 2 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUniform2i(GLint location, GLint x, GLint y)
 {
-    CONTEXT_EXEC(Uniform2i(location, x, y));
+    GL_CAPTURE(CaptureLocation(location), x, y);
+    CONTEXT_EXEC_ASYNC(Uniform2i(location, x, y));
 }
 
 void GL_APIENTRY
 glUniform2iv(GLint location, GLsizei count, const GLint* v)
 {
-    CONTEXT_EXEC(Uniform2iv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 2 * sizeof(GLint))));
+    CONTEXT_EXEC_COPY(Uniform2iv(location, count, static_cast<const GLint *>(payload)), v, ClientSize(v, count, 2 * sizeof(GLint)));
 }
 
 void GL_APIENTRY
 glUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z)
 {
-    CONTEXT_EXEC(Uniform3f(location, x, y, z));
+    GL_CAPTURE(CaptureLocation(location), x, y, z);
+    CONTEXT_EXEC_ASYNC(Uniform3f(location, x, y, z));
 }
 
 void GL_APIENTRY
 glUniform3fv(GLint location, GLsizei count, const GLfloat* v)
 {
-    CONTEXT_EXEC(Uniform3fv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 3 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(Uniform3fv(location, count, static_cast<const GLfloat *>(payload)), v, ClientSize(v, count, 3 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUniform3i(GLint location, GLint x, GLint y, GLint z)
 {
-    CONTEXT_EXEC(Uniform3i(location, x, y, z));
+    GL_CAPTURE(CaptureLocation(location), x, y, z);
+    CONTEXT_EXEC_ASYNC(Uniform3i(location, x, y, z));
 }
 
 void GL_APIENTRY
 glUniform3iv(GLint location, GLsizei count, const GLint* v)
 {
-    CONTEXT_EXEC(Uniform3iv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 3 * sizeof(GLint))));
+    CONTEXT_EXEC_COPY(Uniform3iv(location, count, static_cast<const GLint *>(payload)), v, ClientSize(v, count, 3 * sizeof(GLint)));
 }
 
 void GL_APIENTRY
 glUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 {
-    CONTEXT_EXEC(Uniform4f(location, x, y, z, w));
+    GL_CAPTURE(CaptureLocation(location), x, y, z, w);
+    CONTEXT_EXEC_ASYNC(Uniform4f(location, x, y, z, w));
 }
 
 void GL_APIENTRY
 glUniform4fv(GLint location, GLsizei count, const GLfloat* v)
 {
-    CONTEXT_EXEC(Uniform4fv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 4 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(Uniform4fv(location, count, static_cast<const GLfloat *>(payload)), v, ClientSize(v, count, 4 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUniform4i(GLint location, GLint x, GLint y, GLint z, GLint w)
 {
-    CONTEXT_EXEC(Uniform4i(location, x, y, z, w));
+    GL_CAPTURE(CaptureLocation(location), x, y, z, w);
+    CONTEXT_EXEC_ASYNC(Uniform4i(location, x, y, z, w));
 }
 
 void GL_APIENTRY
 glUniform4iv(GLint location, GLsizei count, const GLint* v)
 {
-    CONTEXT_EXEC(Uniform4iv(location, count, v));
+    GL_CAPTURE(CaptureLocation(location), count, CaptureBlob(v, ClientSize(v, count, 4 * sizeof(GLint))));
+    CONTEXT_EXEC_COPY(Uniform4iv(location, count, static_cast<const GLint *>(payload)), v, ClientSize(v, count, 4 * sizeof(GLint)));
 }
 
 void GL_APIENTRY
 glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
-    CONTEXT_EXEC(UniformMatrix2fv(location, count, transpose, value));
+    GL_CAPTURE(CaptureLocation(location), count, transpose, CaptureBlob(value, ClientSize(value, count, 4 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(UniformMatrix2fv(location, count, transpose, static_cast<const GLfloat *>(payload)), value, ClientSize(value, count, 4 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
-    CONTEXT_EXEC(UniformMatrix3fv(location, count, transpose, value));
+    GL_CAPTURE(CaptureLocation(location), count, transpose, CaptureBlob(value, ClientSize(value, count, 9 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(UniformMatrix3fv(location, count, transpose, static_cast<const GLfloat *>(payload)), value, ClientSize(value, count, 9 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
-    CONTEXT_EXEC(UniformMatrix4fv(location, count, transpose, value));
+    GL_CAPTURE(CaptureLocation(location), count, transpose, CaptureBlob(value, ClientSize(value, count, 16 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(UniformMatrix4fv(location, count, transpose, static_cast<const GLfloat *>(payload)), value, ClientSize(value, count, 16 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glUseProgram(GLuint program)
 {
-    CONTEXT_EXEC(UseProgram(program));
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM));
+    CONTEXT_EXEC_ASYNC(UseProgram(program));
+    CAPTURE_STATE(UseProgram(program));
 }
 
 void GL_APIENTRY
 glValidateProgram(GLuint program)
 {
-    CONTEXT_EXEC(ValidateProgram(program));
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM));
+    CONTEXT_EXEC_ASYNC(ValidateProgram(program));
 }
 
 void GL_APIENTRY
 glVertexAttrib1f(GLuint indx, GLfloat x)
 {
-    CONTEXT_EXEC(VertexAttrib1f(indx, x));
+    GL_CAPTURE(indx, x);
+    CONTEXT_EXEC_ASYNC(VertexAttrib1f(indx, x));
 }
 
 void GL_APIENTRY
 glVertexAttrib1fv(GLuint indx, const GLfloat* values)
 {
-    CONTEXT_EXEC(VertexAttrib1fv(indx, values));
+    GL_CAPTURE(indx, CaptureBlob(values, ClientSize(values, 1, 1 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(VertexAttrib1fv(indx, static_cast<const GLfloat *>(payload)), values, ClientSize(values, 1, 1 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glVertexAttrib2f(GLuint indx, GLfloat x, GLfloat y)
 {
-    CONTEXT_EXEC(VertexAttrib2f(indx, x, y));
+    GL_CAPTURE(indx, x, y);
+    CONTEXT_EXEC_ASYNC(VertexAttrib2f(indx, x, y));
 }
 
 void GL_APIENTRY
 glVertexAttrib2fv(GLuint indx, const GLfloat* values)
 {
-    CONTEXT_EXEC(VertexAttrib2fv(indx, values));
+    GL_CAPTURE(indx, CaptureBlob(values, ClientSize(values, 1, 2 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(VertexAttrib2fv(indx, static_cast<const GLfloat *>(payload)), values, ClientSize(values, 1, 2 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glVertexAttrib3f(GLuint indx, GLfloat x, GLfloat y, GLfloat z)
 {
-    CONTEXT_EXEC(VertexAttrib3f(indx, x, y, z));
+    GL_CAPTURE(indx, x, y, z);
+    CONTEXT_EXEC_ASYNC(VertexAttrib3f(indx, x, y, z));
 }
 
 void GL_APIENTRY
 glVertexAttrib3fv(GLuint indx, const GLfloat* values)
 {
-    CONTEXT_EXEC(VertexAttrib3fv(indx, values));
+    GL_CAPTURE(indx, CaptureBlob(values, ClientSize(values, 1, 3 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(VertexAttrib3fv(indx, static_cast<const GLfloat *>(payload)), values, ClientSize(values, 1, 3 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glVertexAttrib4f(GLuint indx, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 {
-    CONTEXT_EXEC(VertexAttrib4f(indx, x, y, z, w));
+    GL_CAPTURE(indx, x, y, z, w);
+    CONTEXT_EXEC_ASYNC(VertexAttrib4f(indx, x, y, z, w));
 }
 
 void GL_APIENTRY
 glVertexAttrib4fv(GLuint indx, const GLfloat* values)
 {
-    CONTEXT_EXEC(VertexAttrib4fv(indx, values));
+    GL_CAPTURE(indx, CaptureBlob(values, ClientSize(values, 1, 4 * sizeof(GLfloat))));
+    CONTEXT_EXEC_COPY(VertexAttrib4fv(indx, static_cast<const GLfloat *>(payload)), values, ClientSize(values, 1, 4 * sizeof(GLfloat)));
 }
 
 void GL_APIENTRY
 glVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* ptr)
 {
-    CONTEXT_EXEC(VertexAttribPointer(indx, size, type, normalized, stride, ptr));
+    GL_CAPTURE(indx, size, type, normalized, stride, CaptureOffset(ptr));
+    CONTEXT_EXEC_ASYNC(VertexAttribPointer(indx, size, type, normalized, stride, ptr));
+    CLIENT_STATE(SetVertexAttribPointer(indx));
+    CAPTURE_STATE(VertexAttribPointer(indx, size, type, normalized, stride, ptr));
 }
 
 void GL_APIENTRY
 glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
-    CONTEXT_EXEC(Viewport(x, y, width, height));
+    GL_CAPTURE(x, y, width, height);
+    CONTEXT_EXEC_ASYNC(Viewport(x, y, width, height));
 }
 
 void GL_APIENTRY
@@ -900,27 +1165,481 @@ glEGLImageTargetRenderbufferStorageOES(GLenum target, GLeglImageOES image)
 void GL_APIENTRY
 glInsertEventMarkerEXT(GLsizei length, const GLchar *marker)
 {
+    GL_CAPTURE(length, CaptureBlob(marker, marker ? (length ? static_cast<size_t>(length) : strlen(marker) + 1) : 0));
+    SystemTrace::InsertMarker(length, marker);
     CONTEXT_EXEC(InsertEventMarkerEXT(length, marker));
 }
 
 void GL_APIENTRY
 glPushGroupMarkerEXT(GLsizei length, const GLchar *marker)
 {
+    GL_CAPTURE(length, CaptureBlob(marker, marker ? (length ? static_cast<size_t>(length) : strlen(marker) + 1) : 0));
+    SystemTrace::BeginSection(length, marker);
     CONTEXT_EXEC(PushGroupMarkerEXT(length, marker));
 }
 
 void GL_APIENTRY
 glPopGroupMarkerEXT(void)
 {
-    CONTEXT_EXEC(PopGroupMarkerEXT());
+    GL_CAPTURE();
+    // the sections of the system trace belong to the thread of the application, not the one the call may run on
+    SystemTrace::EndSection();
+    CONTEXT_EXEC_ASYNC(PopGroupMarkerEXT());
+}
+
+void GL_APIENTRY
+glDrawArraysInstancedEXT(GLenum mode, GLint start, GLsizei count, GLsizei primcount)
+{
+    CAPTURE_STATE(ClientArrays(start, count));
+    GL_CAPTURE(mode, start, count, primcount);
+    CONTEXT_EXEC_DRAW_ASYNC(DrawArraysInstancedEXT(mode, start, count, primcount), glThread->UsesClientArrays());
+}
+
+void GL_APIENTRY
+glDrawElementsInstancedEXT(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount)
+{
+    CAPTURE_STATE(ClientArrays(count, type, indices));
+    GL_CAPTURE(mode, count, type, CaptureIndices(indices, count, type), primcount);
+    CONTEXT_EXEC_DRAW_ASYNC(DrawElementsInstancedEXT(mode, count, type, indices, primcount), glThread->UsesClientArrays() || glThread->UsesClientIndices());
+}
+
+void GL_APIENTRY
+glVertexAttribDivisorEXT(GLuint index, GLuint divisor)
+{
+    GL_CAPTURE(index, divisor);
+    CONTEXT_EXEC_ASYNC(VertexAttribDivisorEXT(index, divisor));
+}
+
+void GL_APIENTRY
+glMultiDrawArraysEXT(GLenum mode, const GLint *first, const GLsizei *count, GLsizei primcount)
+{
+    CAPTURE_STATE(ClientArrays(first, count, primcount));
+    GL_CAPTURE(mode, CaptureBlob(first, ClientSize(first, primcount, sizeof(GLint))), CaptureBlob(count, ClientSize(count, primcount, sizeof(GLsizei))), primcount);
+    CONTEXT_EXEC_DRAW(MultiDrawArraysEXT(mode, first, count, primcount));
+}
+
+void GL_APIENTRY
+glMultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei primcount)
+{
+    CAPTURE_STATE(ClientArrays(count, type, indices, primcount));
+    GL_CAPTURE(mode, CaptureBlob(count, ClientSize(count, primcount, sizeof(GLsizei))), type, CaptureIndexPointers(indices, count, type, primcount), primcount);
+    CONTEXT_EXEC_DRAW(MultiDrawElementsEXT(mode, count, type, indices, primcount));
+}
+
+void GL_APIENTRY
+glDrawArraysIndirect(GLenum mode, const void *indirect)
+{
+    GL_CAPTURE(mode, CaptureOffset(indirect));
+    CONTEXT_EXEC_DRAW_ASYNC(DrawArraysIndirect(mode, indirect), glThread->UsesClientArrays());
+}
+
+void GL_APIENTRY
+glDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect)
+{
+    GL_CAPTURE(mode, type, CaptureOffset(indirect));
+    CONTEXT_EXEC_DRAW_ASYNC(DrawElementsIndirect(mode, type, indirect), glThread->UsesClientArrays());
+}
+
+void GL_APIENTRY
+glMultiDrawArraysIndirectEXT(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+    GL_CAPTURE(mode, CaptureOffset(indirect), drawcount, stride);
+    CONTEXT_EXEC_DRAW_ASYNC(MultiDrawArraysIndirectEXT(mode, indirect, drawcount, stride), glThread->UsesClientArrays());
+}
+
+void GL_APIENTRY
+glMultiDrawElementsIndirectEXT(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+    GL_CAPTURE(mode, type, CaptureOffset(indirect), drawcount, stride);
+    CONTEXT_EXEC_DRAW_ASYNC(MultiDrawElementsIndirectEXT(mode, type, indirect, drawcount, stride), glThread->UsesClientArrays());
+}
+
+void GL_APIENTRY
+glDiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+{
+    GL_CAPTURE(target, numAttachments, CaptureBlob(attachments, ClientSize(attachments, numAttachments, sizeof(GLenum))));
+    CONTEXT_EXEC_COPY(DiscardFramebufferEXT(target, numAttachments, static_cast<const GLenum *>(payload)), attachments, ClientSize(attachments, numAttachments, sizeof(GLenum)));
+}
+
+void GL_APIENTRY
+glRenderbufferStorageMultisampleEXT(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    GL_CAPTURE(target, samples, internalformat, width, height);
+    CONTEXT_EXEC_ASYNC(RenderbufferStorageMultisampleEXT(target, samples, internalformat, width, height));
+}
+
+void GL_APIENTRY
+glFramebufferTexture2DMultisampleEXT(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples)
+{
+    GL_CAPTURE(target, attachment, textarget, CaptureName(texture, CAPTURE_NAME_TEXTURE), level, samples);
+    CONTEXT_EXEC_ASYNC(FramebufferTexture2DMultisampleEXT(target, attachment, textarget, texture, level, samples));
+}
+
+void GL_APIENTRY
+glFramebufferTextureMultiviewOVR(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews)
+{
+    GL_CAPTURE(target, attachment, CaptureName(texture, CAPTURE_NAME_TEXTURE), level, baseViewIndex, numViews);
+    CONTEXT_EXEC_ASYNC(FramebufferTextureMultiviewOVR(target, attachment, texture, level, baseViewIndex, numViews));
+}
+
+void GL_APIENTRY
+glBlitFramebufferANGLE(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    GL_CAPTURE(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    CONTEXT_EXEC_ASYNC(BlitFramebufferANGLE(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter));
+}
+
+void GL_APIENTRY
+glBlitFramebufferNV(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    GL_CAPTURE(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    CONTEXT_EXEC_ASYNC(BlitFramebufferNV(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter));
+}
+
+void GL_APIENTRY
+glTexStorage2DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    GL_CAPTURE(target, levels, internalformat, width, height);
+    CONTEXT_EXEC(TexStorage2DEXT(target, levels, internalformat, width, height));
+}
+
+void* GL_APIENTRY
+glMapBufferOES(GLenum target, GLenum access)
+{
+    GL_CAPTURE(target, access);
+    glCapture.MapsBuffer(target, 0, 0);
+    CONTEXT_EXEC_RETURN(MapBufferOES(target, access));
+}
+
+GLboolean GL_APIENTRY
+glUnmapBufferOES(GLenum target)
+{
+    GLCaptureMappedBuffer mappedBuffer(target);
+    GL_CAPTURE(target);
+    CONTEXT_EXEC_RETURN(UnmapBufferOES(target));
+}
+
+void GL_APIENTRY
+glGetBufferPointervOES(GLenum target, GLenum pname, void **params)
+{
+    GL_CAPTURE(target, pname, CaptureOut(params, 0));
+    CONTEXT_EXEC(GetBufferPointervOES(target, pname, params));
+}
+
+void* GL_APIENTRY
+glMapBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    GL_CAPTURE(target, offset, length, access);
+    glCapture.MapsBuffer(target, offset, length);
+    CONTEXT_EXEC_RETURN(MapBufferRangeEXT(target, offset, length, access));
+}
+
+void GL_APIENTRY
+glFlushMappedBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length)
+{
+    GL_CAPTURE(target, offset, length);
+    CONTEXT_EXEC_ASYNC(FlushMappedBufferRangeEXT(target, offset, length));
 }
 
 void GL_APIENTRY glGetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), bufSize, CaptureOut(length, 0), CaptureOut(binaryFormat, 0), CaptureOut(binary, 0));
     CONTEXT_EXEC(GetProgramBinaryOES(program, bufSize, length, binaryFormat, binary));
 }
 
 void GL_APIENTRY glProgramBinaryOES(GLuint program, GLenum binaryFormat, const void *binary, GLint length)
 {
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), binaryFormat, CaptureBlob(binary, ClientSize(binary, length, 1)), length);
     CONTEXT_EXEC(ProgramBinaryOES(program, binaryFormat, binary, length));
 }
+
+void GL_APIENTRY
+glMaxShaderCompilerThreadsKHR(GLuint count)
+{
+    GL_CAPTURE(count);
+    CONTEXT_EXEC_ASYNC(MaxShaderCompilerThreadsKHR(count));
+}
+
+void GL_APIENTRY
+glGetPerfMonitorGroupsAMD(GLint *numGroups, GLsizei groupsSize, GLuint *groups)
+{
+    CONTEXT_EXEC(GetPerfMonitorGroupsAMD(numGroups, groupsSize, groups));
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCountersAMD(GLuint group, GLint *numCounters, GLint *maxActiveCounters, GLsizei counterSize, GLuint *counters)
+{
+    CONTEXT_EXEC(GetPerfMonitorCountersAMD(group, numCounters, maxActiveCounters, counterSize, counters));
+}
+
+void GL_APIENTRY
+glGetPerfMonitorGroupStringAMD(GLuint group, GLsizei bufSize, GLsizei *length, GLchar *groupString)
+{
+    CONTEXT_EXEC(GetPerfMonitorGroupStringAMD(group, bufSize, length, groupString));
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCounterStringAMD(GLuint group, GLuint counter, GLsizei bufSize, GLsizei *length, GLchar *counterString)
+{
+    CONTEXT_EXEC(GetPerfMonitorCounterStringAMD(group, counter, bufSize, length, counterString));
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCounterInfoAMD(GLuint group, GLuint counter, GLenum pname, void *data)
+{
+    CONTEXT_EXEC(GetPerfMonitorCounterInfoAMD(group, counter, pname, data));
+}
+
+void GL_APIENTRY
+glGenPerfMonitorsAMD(GLsizei n, GLuint *monitors)
+{
+    CONTEXT_EXEC(GenPerfMonitorsAMD(n, monitors));
+}
+
+void GL_APIENTRY
+glDeletePerfMonitorsAMD(GLsizei n, GLuint *monitors)
+{
+    CONTEXT_EXEC(DeletePerfMonitorsAMD(n, monitors));
+}
+
+void GL_APIENTRY
+glSelectPerfMonitorCountersAMD(GLuint monitor, GLboolean enable, GLuint group, GLint numCounters, GLuint *counterList)
+{
+    CONTEXT_EXEC(SelectPerfMonitorCountersAMD(monitor, enable, group, numCounters, counterList));
+}
+
+void GL_APIENTRY
+glBeginPerfMonitorAMD(GLuint monitor)
+{
+    CONTEXT_EXEC_ASYNC(BeginPerfMonitorAMD(monitor));
+}
+
+void GL_APIENTRY
+glEndPerfMonitorAMD(GLuint monitor)
+{
+    CONTEXT_EXEC_ASYNC(EndPerfMonitorAMD(monitor));
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCounterDataAMD(GLuint monitor, GLenum pname, GLsizei dataSize, GLuint *data, GLint *bytesWritten)
+{
+    CONTEXT_EXEC(GetPerfMonitorCounterDataAMD(monitor, pname, dataSize, data, bytesWritten));
+}
+
+void GL_APIENTRY
+glGenQueriesEXT(GLsizei n, GLuint *ids)
+{
+    GL_CAPTURE(n, CaptureNamesOut(ids, n, CAPTURE_NAME_QUERY));
+    CONTEXT_EXEC(GenQueriesEXT(n, ids));
+}
+
+void GL_APIENTRY
+glDeleteQueriesEXT(GLsizei n, const GLuint *ids)
+{
+    GL_CAPTURE(n, CaptureNames(ids, n, CAPTURE_NAME_QUERY));
+    CONTEXT_EXEC(DeleteQueriesEXT(n, ids));
+}
+
+GLboolean GL_APIENTRY
+glIsQueryEXT(GLuint id)
+{
+    GL_CAPTURE(CaptureName(id, CAPTURE_NAME_QUERY));
+    CONTEXT_EXEC_RETURN(IsQueryEXT(id));
+}
+
+void GL_APIENTRY
+glBeginQueryEXT(GLenum target, GLuint id)
+{
+    GL_CAPTURE(target, CaptureName(id, CAPTURE_NAME_QUERY));
+    CONTEXT_EXEC_ASYNC(BeginQueryEXT(target, id));
+}
+
+void GL_APIENTRY
+glEndQueryEXT(GLenum target)
+{
+    GL_CAPTURE(target);
+    CONTEXT_EXEC_ASYNC(EndQueryEXT(target));
+}
+
+void GL_APIENTRY
+glQueryCounterEXT(GLuint id, GLenum target)
+{
+    GL_CAPTURE(CaptureName(id, CAPTURE_NAME_QUERY), target);
+    CONTEXT_EXEC_ASYNC(QueryCounterEXT(id, target));
+}
+
+void GL_APIENTRY
+glGetQueryivEXT(GLenum target, GLenum pname, GLint *params)
+{
+    GL_CAPTURE(target, pname, CaptureOut(params, 0));
+    CONTEXT_EXEC(GetQueryivEXT(target, pname, params));
+}
+
+void GL_APIENTRY
+glGetQueryObjectivEXT(GLuint id, GLenum pname, GLint *params)
+{
+    GL_CAPTURE(CaptureName(id, CAPTURE_NAME_QUERY), pname, CaptureOut(params, 0));
+    CONTEXT_EXEC(GetQueryObjectivEXT(id, pname, params));
+}
+
+void GL_APIENTRY
+glGetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint *params)
+{
+    GL_CAPTURE(CaptureName(id, CAPTURE_NAME_QUERY), pname, CaptureOut(params, 0));
+    CONTEXT_EXEC(GetQueryObjectuivEXT(id, pname, params));
+}
+
+void GL_APIENTRY
+glGetQueryObjecti64vEXT(GLuint id, GLenum pname, GLint64 *params)
+{
+    GL_CAPTURE(CaptureName(id, CAPTURE_NAME_QUERY), pname, CaptureOut(params, 0));
+    CONTEXT_EXEC(GetQueryObjecti64vEXT(id, pname, params));
+}
+
+void GL_APIENTRY
+glGetQueryObjectui64vEXT(GLuint id, GLenum pname, GLuint64 *params)
+{
+    GL_CAPTURE(CaptureName(id, CAPTURE_NAME_QUERY), pname, CaptureOut(params, 0));
+    CONTEXT_EXEC(GetQueryObjectui64vEXT(id, pname, params));
+}
+
+void GL_APIENTRY
+glGenVertexArraysOES(GLsizei n, GLuint *arrays)
+{
+    GL_CAPTURE(n, CaptureNamesOut(arrays, n, CAPTURE_NAME_VERTEX_ARRAY));
+    CONTEXT_EXEC(GenVertexArraysOES(n, arrays));
+    CLIENT_STATE(GenVertexArrays(n, arrays));
+}
+
+void GL_APIENTRY
+glDeleteVertexArraysOES(GLsizei n, const GLuint *arrays)
+{
+    GL_CAPTURE(n, CaptureNames(arrays, n, CAPTURE_NAME_VERTEX_ARRAY));
+    CONTEXT_EXEC_COPY(DeleteVertexArraysOES(n, static_cast<const GLuint *>(payload)), arrays, ClientSize(arrays, n, sizeof(GLuint)));
+    CLIENT_STATE(DeleteVertexArrays(n, arrays));
+    CAPTURE_STATE(DeleteVertexArrays(n, arrays));
+}
+
+GLboolean GL_APIENTRY
+glIsVertexArrayOES(GLuint array)
+{
+    GL_CAPTURE(CaptureName(array, CAPTURE_NAME_VERTEX_ARRAY));
+    CONTEXT_EXEC_RETURN(IsVertexArrayOES(array));
+}
+
+void GL_APIENTRY
+glBindVertexArrayOES(GLuint array)
+{
+    GL_CAPTURE(CaptureName(array, CAPTURE_NAME_VERTEX_ARRAY));
+    CONTEXT_EXEC_ASYNC(BindVertexArrayOES(array));
+    CLIENT_STATE(BindVertexArray(array));
+    CAPTURE_STATE(BindVertexArray(array));
+}
+
+void GL_APIENTRY
+glGenCommandBundlesGLOVE(GLsizei n, GLuint *bundles)
+{
+    GL_CAPTURE(n, CaptureNamesOut(bundles, n, CAPTURE_NAME_COMMAND_BUNDLE));
+    CONTEXT_EXEC(GenCommandBundlesGLOVE(n, bundles));
+}
+
+void GL_APIENTRY
+glDeleteCommandBundlesGLOVE(GLsizei n, const GLuint *bundles)
+{
+    GL_CAPTURE(n, CaptureNames(bundles, n, CAPTURE_NAME_COMMAND_BUNDLE));
+    CONTEXT_EXEC_COPY(DeleteCommandBundlesGLOVE(n, static_cast<const GLuint *>(payload)), bundles, ClientSize(bundles, n, sizeof(GLuint)));
+}
+
+void GL_APIENTRY
+glBeginCommandBundleGLOVE(GLuint bundle)
+{
+    GL_CAPTURE(CaptureName(bundle, CAPTURE_NAME_COMMAND_BUNDLE));
+    CONTEXT_EXEC_ASYNC(BeginCommandBundleGLOVE(bundle));
+}
+
+void GL_APIENTRY
+glEndCommandBundleGLOVE(void)
+{
+    GL_CAPTURE();
+    CONTEXT_EXEC_ASYNC(EndCommandBundleGLOVE());
+}
+
+void GL_APIENTRY
+glCallCommandBundleGLOVE(GLuint bundle)
+{
+    GL_CAPTURE(CaptureName(bundle, CAPTURE_NAME_COMMAND_BUNDLE));
+    CONTEXT_EXEC_ASYNC(CallCommandBundleGLOVE(bundle));
+}
+
+void GL_APIENTRY
+glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+    GL_CAPTURE(num_groups_x, num_groups_y, num_groups_z);
+    CONTEXT_EXEC_ASYNC(DispatchCompute(num_groups_x, num_groups_y, num_groups_z));
+}
+
+void GL_APIENTRY
+glMemoryBarrier(GLbitfield barriers)
+{
+    GL_CAPTURE(barriers);
+    CONTEXT_EXEC_ASYNC(MemoryBarrier(barriers));
+}
+
+void GL_APIENTRY
+glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    GL_CAPTURE(target, index, CaptureName(buffer, CAPTURE_NAME_BUFFER));
+    CONTEXT_EXEC_ASYNC(BindBufferBase(target, index, buffer));
+}
+
+void GL_APIENTRY
+glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    GL_CAPTURE(target, index, CaptureName(buffer, CAPTURE_NAME_BUFFER), offset, size);
+    CONTEXT_EXEC_ASYNC(BindBufferRange(target, index, buffer, offset, size));
+}
+
+void GL_APIENTRY
+glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode)
+{
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), count, CaptureStrings(varyings, nullptr, count), bufferMode);
+    CONTEXT_EXEC(TransformFeedbackVaryings(program, count, varyings, bufferMode));
+}
+
+void GL_APIENTRY
+glBeginTransformFeedback(GLenum primitiveMode)
+{
+    GL_CAPTURE(primitiveMode);
+    CONTEXT_EXEC_ASYNC(BeginTransformFeedback(primitiveMode));
+}
+
+void GL_APIENTRY
+glEndTransformFeedback(void)
+{
+    GL_CAPTURE();
+    CONTEXT_EXEC_ASYNC(EndTransformFeedback());
+}
+
+void GL_APIENTRY
+glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices)
+{
+    CAPTURE_STATE(ClientArrays(count, type, indices));
+    GL_CAPTURE(mode, start, end, count, type, CaptureIndices(indices, count, type));
+    CONTEXT_EXEC_DRAW_ASYNC(DrawRangeElements(mode, start, end, count, type, indices), glThread->UsesClientArrays() || glThread->UsesClientIndices());
+}
+
+GLuint GL_APIENTRY
+glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+{
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), CaptureString(uniformBlockName));
+    CONTEXT_EXEC_RETURN(GetUniformBlockIndex(program, uniformBlockName));
+}
+
+void GL_APIENTRY
+glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+    GL_CAPTURE(CaptureName(program, CAPTURE_NAME_PROGRAM), uniformBlockIndex, uniformBlockBinding);
+    CONTEXT_EXEC_ASYNC(UniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding));
+}
+
+}
@@ -0,0 +1,1319 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glDispatch.cpp
+ *  @author     Think Silicon
+ *  @date       28/09/2018
+ *  @version    1.0
+ *
+ *  @brief      Exported GL ES API entry points, forwarded to the dispatch table of the current context
+ *
+ */
+
+#include "glDispatch.h"
+
+static const GLDispatchTable defaultDispatchTable = {
+#define GL_FUNC_PTR(f) glDefault::f,
+#include "glFunctionList.h"
+#undef GL_FUNC_PTR
+};
+
+/// contexts current to different threads are used in parallel; a thread without one calls the default
+/// entry points, which find no context. The entry points read the table from this translation unit, with
+/// no call in between, and the default ones then read the current context as they always did
+static thread_local const GLDispatchTable *currentDispatchTable = &defaultDispatchTable;
+
+const GLDispatchTable *
+GetDefaultGLDispatchTable(void)
+{
+    return &defaultDispatchTable;
+}
+
+void
+SetCurrentGLDispatchTable(const GLDispatchTable *table)
+{
+    currentDispatchTable = table ? table : &defaultDispatchTable;
+}
+
+void GL_APIENTRY
+glActiveTexture(GLenum texture)
+{
+    currentDispatchTable->glActiveTexture(texture);
+}
+
+void GL_APIENTRY
+glAttachShader(GLuint program, GLuint shader)
+{
+    currentDispatchTable->glAttachShader(program, shader);
+}
+
+void GL_APIENTRY
+glBindAttribLocation(GLuint program, GLuint index, const char* name)
+{
+    currentDispatchTable->glBindAttribLocation(program, index, name);
+}
+
+void GL_APIENTRY
+glBindBuffer(GLenum target, GLuint buffer)
+{
+    currentDispatchTable->glBindBuffer(target, buffer);
+}
+
+void GL_APIENTRY
+glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    currentDispatchTable->glBindFramebuffer(target, framebuffer);
+}
+
+void GL_APIENTRY
+glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    currentDispatchTable->glBindRenderbuffer(target, renderbuffer);
+}
+
+void GL_APIENTRY
+glBindTexture(GLenum target, GLuint texture)
+{
+    currentDispatchTable->glBindTexture(target, texture);
+}
+
+void GL_APIENTRY
+glBlendColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+    currentDispatchTable->glBlendColor(red, green, blue, alpha);
+}
+
+void GL_APIENTRY
+glBlendEquation(GLenum mode)
+{
+    currentDispatchTable->glBlendEquation(mode);
+}
+
+void GL_APIENTRY
+glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+{
+    currentDispatchTable->glBlendEquationSeparate(modeRGB, modeAlpha);
+}
+
+void GL_APIENTRY
+glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    currentDispatchTable->glBlendFunc(sfactor, dfactor);
+}
+
+void GL_APIENTRY
+glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+{
+    currentDispatchTable->glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+void GL_APIENTRY
+glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    currentDispatchTable->glBufferData(target, size, data, usage);
+}
+
+void GL_APIENTRY
+glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    currentDispatchTable->glBufferSubData(target, offset, size, data);
+}
+
+GLenum GL_APIENTRY
+glCheckFramebufferStatus(GLenum target)
+{
+    return currentDispatchTable->glCheckFramebufferStatus(target);
+}
+
+void GL_APIENTRY
+glClear(GLbitfield mask)
+{
+    currentDispatchTable->glClear(mask);
+}
+
+void GL_APIENTRY
+glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+    currentDispatchTable->glClearColor(red, green, blue, alpha);
+}
+
+void GL_APIENTRY
+glClearDepthf(GLclampf depth)
+{
+    currentDispatchTable->glClearDepthf(depth);
+}
+
+void GL_APIENTRY
+glClearStencil(GLint s)
+{
+    currentDispatchTable->glClearStencil(s);
+}
+
+void GL_APIENTRY
+glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    currentDispatchTable->glColorMask(red, green, blue, alpha);
+}
+
+void GL_APIENTRY
+glCompileShader(GLuint shader)
+{
+    currentDispatchTable->glCompileShader(shader);
+}
+
+void GL_APIENTRY
+glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
+{
+    currentDispatchTable->glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+}
+
+void GL_APIENTRY
+glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data)
+{
+    currentDispatchTable->glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data);
+}
+
+void GL_APIENTRY
+glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border)
+{
+    currentDispatchTable->glCopyTexImage2D(target, level, internalformat, x, y, width, height, border);
+}
+
+void GL_APIENTRY
+glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    currentDispatchTable->glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height);
+}
+
+GLuint GL_APIENTRY
+glCreateProgram(void)
+{
+    return currentDispatchTable->glCreateProgram();
+}
+
+GLuint GL_APIENTRY
+glCreateShader(GLenum type)
+{
+    return currentDispatchTable->glCreateShader(type);
+}
+
+void GL_APIENTRY
+glCullFace(GLenum mode)
+{
+    currentDispatchTable->glCullFace(mode);
+}
+
+void GL_APIENTRY
+glDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    currentDispatchTable->glDeleteBuffers(n, buffers);
+}
+
+void GL_APIENTRY
+glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    currentDispatchTable->glDeleteFramebuffers(n, framebuffers);
+}
+
+void GL_APIENTRY
+glDeleteProgram(GLuint program)
+{
+    currentDispatchTable->glDeleteProgram(program);
+}
+
+void GL_APIENTRY
+glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+    currentDispatchTable->glDeleteRenderbuffers(n, renderbuffers);
+}
+
+void GL_APIENTRY
+glDeleteShader(GLuint shader)
+{
+    currentDispatchTable->glDeleteShader(shader);
+}
+
+void GL_APIENTRY
+glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    currentDispatchTable->glDeleteTextures(n, textures);
+}
+
+void GL_APIENTRY
+glDepthFunc(GLenum func)
+{
+    currentDispatchTable->glDepthFunc(func);
+}
+
+void GL_APIENTRY
+glDepthMask(GLboolean flag)
+{
+    currentDispatchTable->glDepthMask(flag);
+}
+
+void GL_APIENTRY
+glDepthRangef(GLclampf zNear, GLclampf zFar)
+{
+    currentDispatchTable->glDepthRangef(zNear, zFar);
+}
+
+void GL_APIENTRY
+glDetachShader(GLuint program, GLuint shader)
+{
+    currentDispatchTable->glDetachShader(program, shader);
+}
+
+void GL_APIENTRY
+glDisable(GLenum cap)
+{
+    currentDispatchTable->glDisable(cap);
+}
+
+void GL_APIENTRY
+glDisableVertexAttribArray(GLuint index)
+{
+    currentDispatchTable->glDisableVertexAttribArray(index);
+}
+
+void GL_APIENTRY
+glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    currentDispatchTable->glDrawArrays(mode, first, count);
+}
+
+void GL_APIENTRY
+glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    currentDispatchTable->glDrawElements(mode, count, type, indices);
+}
+
+void GL_APIENTRY
+glEnable(GLenum cap)
+{
+    currentDispatchTable->glEnable(cap);
+}
+
+void GL_APIENTRY
+glEnableVertexAttribArray(GLuint index)
+{
+    currentDispatchTable->glEnableVertexAttribArray(index);
+}
+
+void GL_APIENTRY
+glFinish(void)
+{
+    currentDispatchTable->glFinish();
+}
+
+void GL_APIENTRY
+glFlush(void)
+{
+    currentDispatchTable->glFlush();
+}
+
+void GL_APIENTRY
+glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    currentDispatchTable->glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+}
+
+void GL_APIENTRY
+glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    currentDispatchTable->glFramebufferTexture2D(target, attachment, textarget, texture, level);
+}
+
+void GL_APIENTRY
+glFrontFace(GLenum mode)
+{
+    currentDispatchTable->glFrontFace(mode);
+}
+
+void GL_APIENTRY
+glGenBuffers(GLsizei n, GLuint* buffers)
+{
+    currentDispatchTable->glGenBuffers(n, buffers);
+}
+
+void GL_APIENTRY
+glGenerateMipmap(GLenum target)
+{
+    currentDispatchTable->glGenerateMipmap(target);
+}
+
+void GL_APIENTRY
+glGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    currentDispatchTable->glGenFramebuffers(n, framebuffers);
+}
+
+void GL_APIENTRY
+glGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+    currentDispatchTable->glGenRenderbuffers(n, renderbuffers);
+}
+
+void GL_APIENTRY
+glGenTextures(GLsizei n, GLuint* textures)
+{
+    currentDispatchTable->glGenTextures(n, textures);
+}
+
+void GL_APIENTRY
+glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, char* name)
+{
+    currentDispatchTable->glGetActiveAttrib(program, index, bufsize, length, size, type, name);
+}
+
+void GL_APIENTRY
+glGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, char* name)
+{
+    currentDispatchTable->glGetActiveUniform(program, index, bufsize, length, size, type, name);
+}
+
+void GL_APIENTRY
+glGetAttachedShaders(GLuint program, GLsizei maxcount, GLsizei* count, GLuint* shaders)
+{
+    currentDispatchTable->glGetAttachedShaders(program, maxcount, count, shaders);
+}
+
+int GL_APIENTRY
+glGetAttribLocation(GLuint program, const char* name)
+{
+    return currentDispatchTable->glGetAttribLocation(program, name);
+}
+
+void GL_APIENTRY
+glGetBooleanv(GLenum pname, GLboolean* params)
+{
+    currentDispatchTable->glGetBooleanv(pname, params);
+}
+
+void GL_APIENTRY
+glGetBufferParameteriv(GLenum target, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetBufferParameteriv(target, pname, params);
+}
+
+GLenum GL_APIENTRY
+glGetError(void)
+{
+    return currentDispatchTable->glGetError();
+}
+
+void GL_APIENTRY
+glGetFloatv(GLenum pname, GLfloat* params)
+{
+    currentDispatchTable->glGetFloatv(pname, params);
+}
+
+void GL_APIENTRY
+glGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetFramebufferAttachmentParameteriv(target, attachment, pname, params);
+}
+
+void GL_APIENTRY
+glGetIntegerv(GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetIntegerv(pname, params);
+}
+
+void GL_APIENTRY
+glGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetProgramiv(program, pname, params);
+}
+
+void GL_APIENTRY
+glGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, char* infolog)
+{
+    currentDispatchTable->glGetProgramInfoLog(program, bufsize, length, infolog);
+}
+
+void GL_APIENTRY
+glGetRenderbufferParameteriv(GLenum target, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetRenderbufferParameteriv(target, pname, params);
+}
+
+void GL_APIENTRY
+glGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetShaderiv(shader, pname, params);
+}
+
+void GL_APIENTRY
+glGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, char* infolog)
+{
+    currentDispatchTable->glGetShaderInfoLog(shader, bufsize, length, infolog);
+}
+
+void GL_APIENTRY
+glGetShaderPrecisionFormat(GLenum shadertype, GLenum precisiontype, GLint* range, GLint* precision)
+{
+    currentDispatchTable->glGetShaderPrecisionFormat(shadertype, precisiontype, range, precision);
+}
+
+void GL_APIENTRY
+glGetShaderSource(GLuint shader, GLsizei bufsize, GLsizei* length, char* source)
+{
+    currentDispatchTable->glGetShaderSource(shader, bufsize, length, source);
+}
+
+const GLubyte* GL_APIENTRY
+glGetString(GLenum name)
+{
+    return currentDispatchTable->glGetString(name);
+}
+
+void GL_APIENTRY
+glGetTexParameterfv(GLenum target, GLenum pname, GLfloat* params)
+{
+    currentDispatchTable->glGetTexParameterfv(target, pname, params);
+}
+
+void GL_APIENTRY
+glGetTexParameteriv(GLenum target, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetTexParameteriv(target, pname, params);
+}
+
+void GL_APIENTRY
+glGetUniformfv(GLuint program, GLint location, GLfloat* params)
+{
+    currentDispatchTable->glGetUniformfv(program, location, params);
+}
+
+void GL_APIENTRY
+glGetUniformiv(GLuint program, GLint location, GLint* params)
+{
+    currentDispatchTable->glGetUniformiv(program, location, params);
+}
+
+int GL_APIENTRY
+glGetUniformLocation(GLuint program, const char* name)
+{
+    return currentDispatchTable->glGetUniformLocation(program, name);
+}
+
+void GL_APIENTRY
+glGetVertexAttribfv(GLuint index, GLenum pname, GLfloat* params)
+{
+    currentDispatchTable->glGetVertexAttribfv(index, pname, params);
+}
+
+void GL_APIENTRY
+glGetVertexAttribiv(GLuint index, GLenum pname, GLint* params)
+{
+    currentDispatchTable->glGetVertexAttribiv(index, pname, params);
+}
+
+void GL_APIENTRY
+glGetVertexAttribPointerv(GLuint index, GLenum pname, void** pointer)
+{
+    currentDispatchTable->glGetVertexAttribPointerv(index, pname, pointer);
+}
+
+void GL_APIENTRY
+glHint(GLenum target, GLenum mode)
+{
+    currentDispatchTable->glHint(target, mode);
+}
+
+GLboolean GL_APIENTRY
+glIsBuffer(GLuint buffer)
+{
+    return currentDispatchTable->glIsBuffer(buffer);
+}
+
+GLboolean GL_APIENTRY
+glIsEnabled(GLenum cap)
+{
+    return currentDispatchTable->glIsEnabled(cap);
+}
+
+GLboolean GL_APIENTRY
+glIsFramebuffer(GLuint framebuffer)
+{
+    return currentDispatchTable->glIsFramebuffer(framebuffer);
+}
+
+GLboolean GL_APIENTRY
+glIsProgram(GLuint program)
+{
+    return currentDispatchTable->glIsProgram(program);
+}
+
+GLboolean GL_APIENTRY
+glIsRenderbuffer(GLuint renderbuffer)
+{
+    return currentDispatchTable->glIsRenderbuffer(renderbuffer);
+}
+
+GLboolean GL_APIENTRY
+glIsShader(GLuint shader)
+{
+    return currentDispatchTable->glIsShader(shader);
+}
+
+GLboolean GL_APIENTRY
+glIsTexture(GLuint texture)
+{
+    return currentDispatchTable->glIsTexture(texture);
+}
+
+void GL_APIENTRY
+glLineWidth(GLfloat width)
+{
+    currentDispatchTable->glLineWidth(width);
+}
+
+void GL_APIENTRY
+glLinkProgram(GLuint program)
+{
+    currentDispatchTable->glLinkProgram(program);
+}
+
+void GL_APIENTRY
+glPixelStorei(GLenum pname, GLint param)
+{
+    currentDispatchTable->glPixelStorei(pname, param);
+}
+
+void GL_APIENTRY
+glPolygonOffset(GLfloat factor, GLfloat units)
+{
+    currentDispatchTable->glPolygonOffset(factor, units);
+}
+
+void GL_APIENTRY
+glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+    currentDispatchTable->glReadPixels(x, y, width, height, format, type, pixels);
+}
+
+void GL_APIENTRY
+glReleaseShaderCompiler(void)
+{
+    currentDispatchTable->glReleaseShaderCompiler();
+}
+
+void GL_APIENTRY
+glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    currentDispatchTable->glRenderbufferStorage(target, internalformat, width, height);
+}
+
+void GL_APIENTRY
+glSampleCoverage(GLclampf value, GLboolean invert)
+{
+    currentDispatchTable->glSampleCoverage(value, invert);
+}
+
+void GL_APIENTRY
+glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    currentDispatchTable->glScissor(x, y, width, height);
+}
+
+void GL_APIENTRY
+glShaderBinary(GLsizei n, const GLuint* shaders, GLenum binaryformat, const void* binary, GLsizei length)
+{
+    currentDispatchTable->glShaderBinary(n, shaders, binaryformat, binary, length);
+}
+
+void GL_APIENTRY
+glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    currentDispatchTable->glShaderSource(shader, count, string, length);
+}
+
+void GL_APIENTRY
+glStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    currentDispatchTable->glStencilFunc(func, ref, mask);
+}
+
+void GL_APIENTRY
+glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
+{
+    currentDispatchTable->glStencilFuncSeparate(face, func, ref, mask);
+}
+
+void GL_APIENTRY
+glStencilMask(GLuint mask)
+{
+    currentDispatchTable->glStencilMask(mask);
+}
+
+void GL_APIENTRY
+glStencilMaskSeparate(GLenum face, GLuint mask)
+{
+    currentDispatchTable->glStencilMaskSeparate(face, mask);
+}
+
+void GL_APIENTRY
+glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+    currentDispatchTable->glStencilOp(fail, zfail, zpass);
+}
+
+void GL_APIENTRY
+glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum zpass)
+{
+    currentDispatchTable->glStencilOpSeparate(face, fail, zfail, zpass);
+}
+
+void GL_APIENTRY
+glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    currentDispatchTable->glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+void GL_APIENTRY
+glTexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+    currentDispatchTable->glTexParameterf(target, pname, param);
+}
+
+void GL_APIENTRY
+glTexParameterfv(GLenum target, GLenum pname, const GLfloat* params)
+{
+    currentDispatchTable->glTexParameterfv(target, pname, params);
+}
+
+void GL_APIENTRY
+glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    currentDispatchTable->glTexParameteri(target, pname, param);
+}
+
+void GL_APIENTRY
+glTexParameteriv(GLenum target, GLenum pname, const GLint* params)
+{
+    currentDispatchTable->glTexParameteriv(target, pname, params);
+}
+
+void GL_APIENTRY
+glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    currentDispatchTable->glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+void GL_APIENTRY
+glUniform1f(GLint location, GLfloat x)
+{
+    currentDispatchTable->glUniform1f(location, x);
+}
+
+void GL_APIENTRY
+glUniform1fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    currentDispatchTable->glUniform1fv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform1i(GLint location, GLint x)
+{
+    currentDispatchTable->glUniform1i(location, x);
+}
+
+void GL_APIENTRY
+glUniform1iv(GLint location, GLsizei count, const GLint* v)
+{
+    currentDispatchTable->glUniform1iv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform2f(GLint location, GLfloat x, GLfloat y)
+{
+    currentDispatchTable->glUniform2f(location, x, y);
+}
+
+void GL_APIENTRY
+glUniform2fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    currentDispatchTable->glUniform2fv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform2i(GLint location, GLint x, GLint y)
+{
+    currentDispatchTable->glUniform2i(location, x, y);
+}
+
+void GL_APIENTRY
+glUniform2iv(GLint location, GLsizei count, const GLint* v)
+{
+    currentDispatchTable->glUniform2iv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z)
+{
+    currentDispatchTable->glUniform3f(location, x, y, z);
+}
+
+void GL_APIENTRY
+glUniform3fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    currentDispatchTable->glUniform3fv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform3i(GLint location, GLint x, GLint y, GLint z)
+{
+    currentDispatchTable->glUniform3i(location, x, y, z);
+}
+
+void GL_APIENTRY
+glUniform3iv(GLint location, GLsizei count, const GLint* v)
+{
+    currentDispatchTable->glUniform3iv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    currentDispatchTable->glUniform4f(location, x, y, z, w);
+}
+
+void GL_APIENTRY
+glUniform4fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    currentDispatchTable->glUniform4fv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniform4i(GLint location, GLint x, GLint y, GLint z, GLint w)
+{
+    currentDispatchTable->glUniform4i(location, x, y, z, w);
+}
+
+void GL_APIENTRY
+glUniform4iv(GLint location, GLsizei count, const GLint* v)
+{
+    currentDispatchTable->glUniform4iv(location, count, v);
+}
+
+void GL_APIENTRY
+glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    currentDispatchTable->glUniformMatrix2fv(location, count, transpose, value);
+}
+
+void GL_APIENTRY
+glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    currentDispatchTable->glUniformMatrix3fv(location, count, transpose, value);
+}
+
+void GL_APIENTRY
+glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    currentDispatchTable->glUniformMatrix4fv(location, count, transpose, value);
+}
+
+void GL_APIENTRY
+glUseProgram(GLuint program)
+{
+    currentDispatchTable->glUseProgram(program);
+}
+
+void GL_APIENTRY
+glValidateProgram(GLuint program)
+{
+    currentDispatchTable->glValidateProgram(program);
+}
+
+void GL_APIENTRY
+glVertexAttrib1f(GLuint indx, GLfloat x)
+{
+    currentDispatchTable->glVertexAttrib1f(indx, x);
+}
+
+void GL_APIENTRY
+glVertexAttrib1fv(GLuint indx, const GLfloat* values)
+{
+    currentDispatchTable->glVertexAttrib1fv(indx, values);
+}
+
+void GL_APIENTRY
+glVertexAttrib2f(GLuint indx, GLfloat x, GLfloat y)
+{
+    currentDispatchTable->glVertexAttrib2f(indx, x, y);
+}
+
+void GL_APIENTRY
+glVertexAttrib2fv(GLuint indx, const GLfloat* values)
+{
+    currentDispatchTable->glVertexAttrib2fv(indx, values);
+}
+
+void GL_APIENTRY
+glVertexAttrib3f(GLuint indx, GLfloat x, GLfloat y, GLfloat z)
+{
+    currentDispatchTable->glVertexAttrib3f(indx, x, y, z);
+}
+
+void GL_APIENTRY
+glVertexAttrib3fv(GLuint indx, const GLfloat* values)
+{
+    currentDispatchTable->glVertexAttrib3fv(indx, values);
+}
+
+void GL_APIENTRY
+glVertexAttrib4f(GLuint indx, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    currentDispatchTable->glVertexAttrib4f(indx, x, y, z, w);
+}
+
+void GL_APIENTRY
+glVertexAttrib4fv(GLuint indx, const GLfloat* values)
+{
+    currentDispatchTable->glVertexAttrib4fv(indx, values);
+}
+
+void GL_APIENTRY
+glVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* ptr)
+{
+    currentDispatchTable->glVertexAttribPointer(indx, size, type, normalized, stride, ptr);
+}
+
+void GL_APIENTRY
+glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    currentDispatchTable->glViewport(x, y, width, height);
+}
+
+void GL_APIENTRY
+glEGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image)
+{
+    currentDispatchTable->glEGLImageTargetTexture2DOES(target, image);
+}
+
+void GL_APIENTRY
+glEGLImageTargetRenderbufferStorageOES(GLenum target, GLeglImageOES image)
+{
+    currentDispatchTable->glEGLImageTargetRenderbufferStorageOES(target, image);
+}
+
+void GL_APIENTRY
+glInsertEventMarkerEXT(GLsizei length, const GLchar *marker)
+{
+    currentDispatchTable->glInsertEventMarkerEXT(length, marker);
+}
+
+void GL_APIENTRY
+glPushGroupMarkerEXT(GLsizei length, const GLchar *marker)
+{
+    currentDispatchTable->glPushGroupMarkerEXT(length, marker);
+}
+
+void GL_APIENTRY
+glPopGroupMarkerEXT(void)
+{
+    currentDispatchTable->glPopGroupMarkerEXT();
+}
+
+void GL_APIENTRY
+glDrawArraysInstancedEXT(GLenum mode, GLint start, GLsizei count, GLsizei primcount)
+{
+    currentDispatchTable->glDrawArraysInstancedEXT(mode, start, count, primcount);
+}
+
+void GL_APIENTRY
+glDrawElementsInstancedEXT(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount)
+{
+    currentDispatchTable->glDrawElementsInstancedEXT(mode, count, type, indices, primcount);
+}
+
+void GL_APIENTRY
+glVertexAttribDivisorEXT(GLuint index, GLuint divisor)
+{
+    currentDispatchTable->glVertexAttribDivisorEXT(index, divisor);
+}
+
+void GL_APIENTRY
+glMultiDrawArraysEXT(GLenum mode, const GLint *first, const GLsizei *count, GLsizei primcount)
+{
+    currentDispatchTable->glMultiDrawArraysEXT(mode, first, count, primcount);
+}
+
+void GL_APIENTRY
+glMultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei primcount)
+{
+    currentDispatchTable->glMultiDrawElementsEXT(mode, count, type, indices, primcount);
+}
+
+void GL_APIENTRY
+glDrawArraysIndirect(GLenum mode, const void *indirect)
+{
+    currentDispatchTable->glDrawArraysIndirect(mode, indirect);
+}
+
+void GL_APIENTRY
+glDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect)
+{
+    currentDispatchTable->glDrawElementsIndirect(mode, type, indirect);
+}
+
+void GL_APIENTRY
+glMultiDrawArraysIndirectEXT(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+    currentDispatchTable->glMultiDrawArraysIndirectEXT(mode, indirect, drawcount, stride);
+}
+
+void GL_APIENTRY
+glMultiDrawElementsIndirectEXT(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+    currentDispatchTable->glMultiDrawElementsIndirectEXT(mode, type, indirect, drawcount, stride);
+}
+
+void GL_APIENTRY
+glDiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+{
+    currentDispatchTable->glDiscardFramebufferEXT(target, numAttachments, attachments);
+}
+
+void GL_APIENTRY
+glRenderbufferStorageMultisampleEXT(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    currentDispatchTable->glRenderbufferStorageMultisampleEXT(target, samples, internalformat, width, height);
+}
+
+void GL_APIENTRY
+glFramebufferTexture2DMultisampleEXT(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples)
+{
+    currentDispatchTable->glFramebufferTexture2DMultisampleEXT(target, attachment, textarget, texture, level, samples);
+}
+
+void GL_APIENTRY
+glFramebufferTextureMultiviewOVR(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews)
+{
+    currentDispatchTable->glFramebufferTextureMultiviewOVR(target, attachment, texture, level, baseViewIndex, numViews);
+}
+
+void GL_APIENTRY
+glBlitFramebufferANGLE(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    currentDispatchTable->glBlitFramebufferANGLE(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+void GL_APIENTRY
+glBlitFramebufferNV(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    currentDispatchTable->glBlitFramebufferNV(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+void GL_APIENTRY
+glTexStorage2DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    currentDispatchTable->glTexStorage2DEXT(target, levels, internalformat, width, height);
+}
+
+void* GL_APIENTRY
+glMapBufferOES(GLenum target, GLenum access)
+{
+    return currentDispatchTable->glMapBufferOES(target, access);
+}
+
+GLboolean GL_APIENTRY
+glUnmapBufferOES(GLenum target)
+{
+    return currentDispatchTable->glUnmapBufferOES(target);
+}
+
+void GL_APIENTRY
+glGetBufferPointervOES(GLenum target, GLenum pname, void **params)
+{
+    currentDispatchTable->glGetBufferPointervOES(target, pname, params);
+}
+
+void* GL_APIENTRY
+glMapBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    return currentDispatchTable->glMapBufferRangeEXT(target, offset, length, access);
+}
+
+void GL_APIENTRY
+glFlushMappedBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length)
+{
+    currentDispatchTable->glFlushMappedBufferRangeEXT(target, offset, length);
+}
+
+void GL_APIENTRY
+glGetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary)
+{
+    currentDispatchTable->glGetProgramBinaryOES(program, bufSize, length, binaryFormat, binary);
+}
+
+void GL_APIENTRY
+glProgramBinaryOES(GLuint program, GLenum binaryFormat, const void *binary, GLint length)
+{
+    currentDispatchTable->glProgramBinaryOES(program, binaryFormat, binary, length);
+}
+
+void GL_APIENTRY
+glMaxShaderCompilerThreadsKHR(GLuint count)
+{
+    currentDispatchTable->glMaxShaderCompilerThreadsKHR(count);
+}
+
+void GL_APIENTRY
+glGetPerfMonitorGroupsAMD(GLint *numGroups, GLsizei groupsSize, GLuint *groups)
+{
+    currentDispatchTable->glGetPerfMonitorGroupsAMD(numGroups, groupsSize, groups);
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCountersAMD(GLuint group, GLint *numCounters, GLint *maxActiveCounters, GLsizei counterSize, GLuint *counters)
+{
+    currentDispatchTable->glGetPerfMonitorCountersAMD(group, numCounters, maxActiveCounters, counterSize, counters);
+}
+
+void GL_APIENTRY
+glGetPerfMonitorGroupStringAMD(GLuint group, GLsizei bufSize, GLsizei *length, GLchar *groupString)
+{
+    currentDispatchTable->glGetPerfMonitorGroupStringAMD(group, bufSize, length, groupString);
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCounterStringAMD(GLuint group, GLuint counter, GLsizei bufSize, GLsizei *length, GLchar *counterString)
+{
+    currentDispatchTable->glGetPerfMonitorCounterStringAMD(group, counter, bufSize, length, counterString);
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCounterInfoAMD(GLuint group, GLuint counter, GLenum pname, void *data)
+{
+    currentDispatchTable->glGetPerfMonitorCounterInfoAMD(group, counter, pname, data);
+}
+
+void GL_APIENTRY
+glGenPerfMonitorsAMD(GLsizei n, GLuint *monitors)
+{
+    currentDispatchTable->glGenPerfMonitorsAMD(n, monitors);
+}
+
+void GL_APIENTRY
+glDeletePerfMonitorsAMD(GLsizei n, GLuint *monitors)
+{
+    currentDispatchTable->glDeletePerfMonitorsAMD(n, monitors);
+}
+
+void GL_APIENTRY
+glSelectPerfMonitorCountersAMD(GLuint monitor, GLboolean enable, GLuint group, GLint numCounters, GLuint *counterList)
+{
+    currentDispatchTable->glSelectPerfMonitorCountersAMD(monitor, enable, group, numCounters, counterList);
+}
+
+void GL_APIENTRY
+glBeginPerfMonitorAMD(GLuint monitor)
+{
+    currentDispatchTable->glBeginPerfMonitorAMD(monitor);
+}
+
+void GL_APIENTRY
+glEndPerfMonitorAMD(GLuint monitor)
+{
+    currentDispatchTable->glEndPerfMonitorAMD(monitor);
+}
+
+void GL_APIENTRY
+glGetPerfMonitorCounterDataAMD(GLuint monitor, GLenum pname, GLsizei dataSize, GLuint *data, GLint *bytesWritten)
+{
+    currentDispatchTable->glGetPerfMonitorCounterDataAMD(monitor, pname, dataSize, data, bytesWritten);
+}
+
+void GL_APIENTRY
+glGenQueriesEXT(GLsizei n, GLuint *ids)
+{
+    currentDispatchTable->glGenQueriesEXT(n, ids);
+}
+
+void GL_APIENTRY
+glDeleteQueriesEXT(GLsizei n, const GLuint *ids)
+{
+    currentDispatchTable->glDeleteQueriesEXT(n, ids);
+}
+
+GLboolean GL_APIENTRY
+glIsQueryEXT(GLuint id)
+{
+    return currentDispatchTable->glIsQueryEXT(id);
+}
+
+void GL_APIENTRY
+glBeginQueryEXT(GLenum target, GLuint id)
+{
+    currentDispatchTable->glBeginQueryEXT(target, id);
+}
+
+void GL_APIENTRY
+glEndQueryEXT(GLenum target)
+{
+    currentDispatchTable->glEndQueryEXT(target);
+}
+
+void GL_APIENTRY
+glQueryCounterEXT(GLuint id, GLenum target)
+{
+    currentDispatchTable->glQueryCounterEXT(id, target);
+}
+
+void GL_APIENTRY
+glGetQueryivEXT(GLenum target, GLenum pname, GLint *params)
+{
+    currentDispatchTable->glGetQueryivEXT(target, pname, params);
+}
+
+void GL_APIENTRY
+glGetQueryObjectivEXT(GLuint id, GLenum pname, GLint *params)
+{
+    currentDispatchTable->glGetQueryObjectivEXT(id, pname, params);
+}
+
+void GL_APIENTRY
+glGetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint *params)
+{
+    currentDispatchTable->glGetQueryObjectuivEXT(id, pname, params);
+}
+
+void GL_APIENTRY
+glGetQueryObjecti64vEXT(GLuint id, GLenum pname, GLint64 *params)
+{
+    currentDispatchTable->glGetQueryObjecti64vEXT(id, pname, params);
+}
+
+void GL_APIENTRY
+glGetQueryObjectui64vEXT(GLuint id, GLenum pname, GLuint64 *params)
+{
+    currentDispatchTable->glGetQueryObjectui64vEXT(id, pname, params);
+}
+
+void GL_APIENTRY
+glGenVertexArraysOES(GLsizei n, GLuint *arrays)
+{
+    currentDispatchTable->glGenVertexArraysOES(n, arrays);
+}
+
+void GL_APIENTRY
+glDeleteVertexArraysOES(GLsizei n, const GLuint *arrays)
+{
+    currentDispatchTable->glDeleteVertexArraysOES(n, arrays);
+}
+
+GLboolean GL_APIENTRY
+glIsVertexArrayOES(GLuint array)
+{
+    return currentDispatchTable->glIsVertexArrayOES(array);
+}
+
+void GL_APIENTRY
+glBindVertexArrayOES(GLuint array)
+{
+    currentDispatchTable->glBindVertexArrayOES(array);
+}
+
+void GL_APIENTRY
+glGenCommandBundlesGLOVE(GLsizei n, GLuint *bundles)
+{
+    currentDispatchTable->glGenCommandBundlesGLOVE(n, bundles);
+}
+
+void GL_APIENTRY
+glDeleteCommandBundlesGLOVE(GLsizei n, const GLuint *bundles)
+{
+    currentDispatchTable->glDeleteCommandBundlesGLOVE(n, bundles);
+}
+
+void GL_APIENTRY
+glBeginCommandBundleGLOVE(GLuint bundle)
+{
+    currentDispatchTable->glBeginCommandBundleGLOVE(bundle);
+}
+
+void GL_APIENTRY
+glEndCommandBundleGLOVE(void)
+{
+    currentDispatchTable->glEndCommandBundleGLOVE();
+}
+
+void GL_APIENTRY
+glCallCommandBundleGLOVE(GLuint bundle)
+{
+    currentDispatchTable->glCallCommandBundleGLOVE(bundle);
+}
+
+void GL_APIENTRY
+glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+    currentDispatchTable->glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+}
+
+void GL_APIENTRY
+glMemoryBarrier(GLbitfield barriers)
+{
+    currentDispatchTable->glMemoryBarrier(barriers);
+}
+
+void GL_APIENTRY
+glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    currentDispatchTable->glBindBufferBase(target, index, buffer);
+}
+
+void GL_APIENTRY
+glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    currentDispatchTable->glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GL_APIENTRY
+glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode)
+{
+    currentDispatchTable->glTransformFeedbackVaryings(program, count, varyings, bufferMode);
+}
+
+void GL_APIENTRY
+glBeginTransformFeedback(GLenum primitiveMode)
+{
+    currentDispatchTable->glBeginTransformFeedback(primitiveMode);
+}
+
+void GL_APIENTRY
+glEndTransformFeedback(void)
+{
+    currentDispatchTable->glEndTransformFeedback();
+}
+
+void GL_APIENTRY
+glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices)
+{
+    currentDispatchTable->glDrawRangeElements(mode, start, end, count, type, indices);
+}
+
+GLuint GL_APIENTRY
+glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+{
+    return currentDispatchTable->glGetUniformBlockIndex(program, uniformBlockName);
+}
+
+void GL_APIENTRY
+glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+    currentDispatchTable->glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+}
@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glDispatch.h
+ *  @author     Think Silicon
+ *  @date       28/09/2018
+ *  @version    1.0
+ *
+ *  @brief      Per context dispatch of the GL ES API entry points
+ *
+ *  Every exported entry point calls through the table of the context current
+ *  to the calling thread, which is installed on eglMakeCurrent. A context
+ *  starts with the default table, the one implemented in gl.cpp; a context
+ *  that wants specialized implementations (no-error, marshalling, tracing)
+ *  installs a table of its own, leaving the calls of the others untouched.
+ *
+ */
+
+#ifndef __GLDISPATCH_H__
+#define __GLDISPATCH_H__
+
+#include "GLES2/gl2.h"
+#include "GLES2/gl2ext.h"
+#include "GLES2/gl2ext_glove.h"
+
+struct GLDispatchTable {
+#define GL_FUNC_PTR(f) decltype(&::f) f;
+#include "glFunctionList.h"
+#undef GL_FUNC_PTR
+};
+
+/// the implementations of the default table, the entry points resolve the current context themselves
+namespace glDefault {
+#define GL_FUNC_PTR(f) decltype(::f) f;
+#include "glFunctionList.h"
+#undef GL_FUNC_PTR
+}
+
+const GLDispatchTable *GetDefaultGLDispatchTable(void);
+/// installs table for the calling thread, the default one for a null table
+void                   SetCurrentGLDispatchTable(const GLDispatchTable *table);
+
+#endif // __GLDISPATCH_H__
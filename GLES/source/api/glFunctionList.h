@@ -0,0 +1,287 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glFunctionList.h
+ *  @author     Think Silicon
+ *  @date       28/09/2018
+ *  @version    1.0
+ *
+ *  @brief      The GL ES API entry points, one GL_FUNC_PTR(f) each
+ *
+ *  Included with GL_FUNC_PTR defined by the includer, without a guard, to
+ *  build the tables that enumerate the API: the map of eglGetProcAddress and
+ *  the dispatch table of the contexts.
+ *
+ */
+
+GL_FUNC_PTR(glActiveTexture)
+GL_FUNC_PTR(glAttachShader)
+GL_FUNC_PTR(glBindAttribLocation)
+GL_FUNC_PTR(glBindBuffer)
+GL_FUNC_PTR(glBindFramebuffer)
+GL_FUNC_PTR(glBindRenderbuffer)
+GL_FUNC_PTR(glBindTexture)
+GL_FUNC_PTR(glBlendColor)
+GL_FUNC_PTR(glBlendEquation)
+GL_FUNC_PTR(glBlendEquationSeparate)
+GL_FUNC_PTR(glBlendFunc)
+GL_FUNC_PTR(glBlendFuncSeparate)
+GL_FUNC_PTR(glBufferData)
+GL_FUNC_PTR(glBufferSubData)
+GL_FUNC_PTR(glCheckFramebufferStatus)
+GL_FUNC_PTR(glClear)
+GL_FUNC_PTR(glClearColor)
+GL_FUNC_PTR(glClearDepthf)
+GL_FUNC_PTR(glClearStencil)
+GL_FUNC_PTR(glColorMask)
+GL_FUNC_PTR(glCompileShader)
+GL_FUNC_PTR(glCompressedTexImage2D)
+GL_FUNC_PTR(glCompressedTexSubImage2D)
+GL_FUNC_PTR(glCopyTexImage2D)
+GL_FUNC_PTR(glCopyTexSubImage2D)
+GL_FUNC_PTR(glCreateProgram)
+GL_FUNC_PTR(glCreateShader)
+GL_FUNC_PTR(glCullFace)
+GL_FUNC_PTR(glDeleteBuffers)
+GL_FUNC_PTR(glDeleteFramebuffers)
+GL_FUNC_PTR(glDeleteProgram)
+GL_FUNC_PTR(glDeleteRenderbuffers)
+GL_FUNC_PTR(glDeleteShader)
+GL_FUNC_PTR(glDeleteTextures)
+GL_FUNC_PTR(glDepthFunc)
+GL_FUNC_PTR(glDepthMask)
+GL_FUNC_PTR(glDepthRangef)
+GL_FUNC_PTR(glDetachShader)
+GL_FUNC_PTR(glDisable)
+GL_FUNC_PTR(glDisableVertexAttribArray)
+GL_FUNC_PTR(glDrawArrays)
+GL_FUNC_PTR(glDrawElements)
+GL_FUNC_PTR(glEnable)
+GL_FUNC_PTR(glEnableVertexAttribArray)
+GL_FUNC_PTR(glFinish)
+GL_FUNC_PTR(glFlush)
+GL_FUNC_PTR(glFramebufferRenderbuffer)
+GL_FUNC_PTR(glFramebufferTexture2D)
+GL_FUNC_PTR(glFrontFace)
+GL_FUNC_PTR(glGenBuffers)
+GL_FUNC_PTR(glGenerateMipmap)
+GL_FUNC_PTR(glGenFramebuffers)
+GL_FUNC_PTR(glGenRenderbuffers)
+GL_FUNC_PTR(glGenTextures)
+GL_FUNC_PTR(glGetActiveAttrib)
+GL_FUNC_PTR(glGetActiveUniform)
+GL_FUNC_PTR(glGetAttachedShaders)
+GL_FUNC_PTR(glGetAttribLocation)
+GL_FUNC_PTR(glGetBooleanv)
+GL_FUNC_PTR(glGetBufferParameteriv)
+GL_FUNC_PTR(glGetError)
+GL_FUNC_PTR(glGetFloatv)
+GL_FUNC_PTR(glGetFramebufferAttachmentParameteriv)
+GL_FUNC_PTR(glGetIntegerv)
+GL_FUNC_PTR(glGetProgramiv)
+GL_FUNC_PTR(glGetProgramInfoLog)
+GL_FUNC_PTR(glGetRenderbufferParameteriv)
+GL_FUNC_PTR(glGetShaderiv)
+GL_FUNC_PTR(glGetShaderInfoLog)
+GL_FUNC_PTR(glGetShaderPrecisionFormat)
+GL_FUNC_PTR(glGetShaderSource)
+GL_FUNC_PTR(glGetString)
+GL_FUNC_PTR(glGetTexParameterfv)
+GL_FUNC_PTR(glGetTexParameteriv)
+GL_FUNC_PTR(glGetUniformfv)
+GL_FUNC_PTR(glGetUniformiv)
+GL_FUNC_PTR(glGetUniformLocation)
+GL_FUNC_PTR(glGetVertexAttribfv)
+GL_FUNC_PTR(glGetVertexAttribiv)
+GL_FUNC_PTR(glGetVertexAttribPointerv)
+GL_FUNC_PTR(glHint)
+GL_FUNC_PTR(glIsBuffer)
+GL_FUNC_PTR(glIsEnabled)
+GL_FUNC_PTR(glIsFramebuffer)
+GL_FUNC_PTR(glIsProgram)
+GL_FUNC_PTR(glIsRenderbuffer)
+GL_FUNC_PTR(glIsShader)
+GL_FUNC_PTR(glIsTexture)
+GL_FUNC_PTR(glLineWidth)
+GL_FUNC_PTR(glLinkProgram)
+GL_FUNC_PTR(glPixelStorei)
+GL_FUNC_PTR(glPolygonOffset)
+GL_FUNC_PTR(glReadPixels)
+GL_FUNC_PTR(glReleaseShaderCompiler)
+GL_FUNC_PTR(glRenderbufferStorage)
+GL_FUNC_PTR(glSampleCoverage)
+GL_FUNC_PTR(glScissor)
+GL_FUNC_PTR(glShaderBinary)
+GL_FUNC_PTR(glShaderSource)
+GL_FUNC_PTR(glStencilFunc)
+GL_FUNC_PTR(glStencilFuncSeparate)
+GL_FUNC_PTR(glStencilMask)
+GL_FUNC_PTR(glStencilMaskSeparate)
+GL_FUNC_PTR(glStencilOp)
+GL_FUNC_PTR(glStencilOpSeparate)
+GL_FUNC_PTR(glTexImage2D)
+GL_FUNC_PTR(glTexParameterf)
+GL_FUNC_PTR(glTexParameterfv)
+GL_FUNC_PTR(glTexParameteri)
+GL_FUNC_PTR(glTexParameteriv)
+GL_FUNC_PTR(glTexSubImage2D)
+GL_FUNC_PTR(glUniform1f)
+GL_FUNC_PTR(glUniform1fv)
+GL_FUNC_PTR(glUniform1i)
+GL_FUNC_PTR(glUniform1iv)
+GL_FUNC_PTR(glUniform2f)
+GL_FUNC_PTR(glUniform2fv)
+GL_FUNC_PTR(glUniform2i)
+GL_FUNC_PTR(glUniform2iv)
+GL_FUNC_PTR(glUniform3f)
+GL_FUNC_PTR(glUniform3fv)
+GL_FUNC_PTR(glUniform3i)
+GL_FUNC_PTR(glUniform3iv)
+GL_FUNC_PTR(glUniform4f)
+GL_FUNC_PTR(glUniform4fv)
+GL_FUNC_PTR(glUniform4i)
+GL_FUNC_PTR(glUniform4iv)
+GL_FUNC_PTR(glUniformMatrix2fv)
+GL_FUNC_PTR(glUniformMatrix3fv)
+GL_FUNC_PTR(glUniformMatrix4fv)
+GL_FUNC_PTR(glUseProgram)
+GL_FUNC_PTR(glValidateProgram)
+GL_FUNC_PTR(glVertexAttrib1f)
+GL_FUNC_PTR(glVertexAttrib1fv)
+GL_FUNC_PTR(glVertexAttrib2f)
+GL_FUNC_PTR(glVertexAttrib2fv)
+GL_FUNC_PTR(glVertexAttrib3f)
+GL_FUNC_PTR(glVertexAttrib3fv)
+GL_FUNC_PTR(glVertexAttrib4f)
+GL_FUNC_PTR(glVertexAttrib4fv)
+GL_FUNC_PTR(glVertexAttribPointer)
+GL_FUNC_PTR(glViewport)
+#ifdef GL_OES_EGL_image
+GL_FUNC_PTR(glEGLImageTargetTexture2DOES)
+GL_FUNC_PTR(glEGLImageTargetRenderbufferStorageOES)
+#endif // GL_OES_EGL_image
+#ifdef GL_EXT_debug_marker
+GL_FUNC_PTR(glInsertEventMarkerEXT)
+GL_FUNC_PTR(glPushGroupMarkerEXT)
+GL_FUNC_PTR(glPopGroupMarkerEXT)
+#endif // GL_EXT_debug_marker
+#ifdef GL_EXT_draw_instanced
+GL_FUNC_PTR(glDrawArraysInstancedEXT)
+GL_FUNC_PTR(glDrawElementsInstancedEXT)
+#endif // GL_EXT_draw_instanced
+#ifdef GL_EXT_instanced_arrays
+GL_FUNC_PTR(glVertexAttribDivisorEXT)
+#endif // GL_EXT_instanced_arrays
+#ifdef GL_EXT_multi_draw_arrays
+GL_FUNC_PTR(glMultiDrawArraysEXT)
+GL_FUNC_PTR(glMultiDrawElementsEXT)
+#endif // GL_EXT_multi_draw_arrays
+#ifdef GL_EXT_multi_draw_indirect
+GL_FUNC_PTR(glDrawArraysIndirect)
+GL_FUNC_PTR(glDrawElementsIndirect)
+GL_FUNC_PTR(glMultiDrawArraysIndirectEXT)
+GL_FUNC_PTR(glMultiDrawElementsIndirectEXT)
+#endif // GL_EXT_multi_draw_indirect
+#ifdef GL_EXT_discard_framebuffer
+GL_FUNC_PTR(glDiscardFramebufferEXT)
+#endif // GL_EXT_discard_framebuffer
+#ifdef GL_EXT_multisampled_render_to_texture
+GL_FUNC_PTR(glRenderbufferStorageMultisampleEXT)
+GL_FUNC_PTR(glFramebufferTexture2DMultisampleEXT)
+#endif // GL_EXT_multisampled_render_to_texture
+#ifdef GL_OVR_multiview
+GL_FUNC_PTR(glFramebufferTextureMultiviewOVR)
+#endif // GL_OVR_multiview
+#ifdef GL_ANGLE_framebuffer_blit
+GL_FUNC_PTR(glBlitFramebufferANGLE)
+#endif // GL_ANGLE_framebuffer_blit
+#ifdef GL_NV_framebuffer_blit
+GL_FUNC_PTR(glBlitFramebufferNV)
+#endif // GL_NV_framebuffer_blit
+#ifdef GL_EXT_texture_storage
+GL_FUNC_PTR(glTexStorage2DEXT)
+#endif // GL_EXT_texture_storage
+#ifdef GL_OES_mapbuffer
+GL_FUNC_PTR(glMapBufferOES)
+GL_FUNC_PTR(glUnmapBufferOES)
+GL_FUNC_PTR(glGetBufferPointervOES)
+#endif // GL_OES_mapbuffer
+#ifdef GL_EXT_map_buffer_range
+GL_FUNC_PTR(glMapBufferRangeEXT)
+GL_FUNC_PTR(glFlushMappedBufferRangeEXT)
+#endif // GL_EXT_map_buffer_range
+#ifdef GL_OES_get_program_binary
+GL_FUNC_PTR(glGetProgramBinaryOES)
+GL_FUNC_PTR(glProgramBinaryOES)
+#endif /* GL_OES_get_program_binary */
+#ifdef GL_KHR_parallel_shader_compile
+GL_FUNC_PTR(glMaxShaderCompilerThreadsKHR)
+#endif // GL_KHR_parallel_shader_compile
+#ifdef GL_AMD_performance_monitor
+GL_FUNC_PTR(glGetPerfMonitorGroupsAMD)
+GL_FUNC_PTR(glGetPerfMonitorCountersAMD)
+GL_FUNC_PTR(glGetPerfMonitorGroupStringAMD)
+GL_FUNC_PTR(glGetPerfMonitorCounterStringAMD)
+GL_FUNC_PTR(glGetPerfMonitorCounterInfoAMD)
+GL_FUNC_PTR(glGenPerfMonitorsAMD)
+GL_FUNC_PTR(glDeletePerfMonitorsAMD)
+GL_FUNC_PTR(glSelectPerfMonitorCountersAMD)
+GL_FUNC_PTR(glBeginPerfMonitorAMD)
+GL_FUNC_PTR(glEndPerfMonitorAMD)
+GL_FUNC_PTR(glGetPerfMonitorCounterDataAMD)
+#endif // GL_AMD_performance_monitor
+#ifdef GL_EXT_disjoint_timer_query
+GL_FUNC_PTR(glGenQueriesEXT)
+GL_FUNC_PTR(glDeleteQueriesEXT)
+GL_FUNC_PTR(glIsQueryEXT)
+GL_FUNC_PTR(glBeginQueryEXT)
+GL_FUNC_PTR(glEndQueryEXT)
+GL_FUNC_PTR(glQueryCounterEXT)
+GL_FUNC_PTR(glGetQueryivEXT)
+GL_FUNC_PTR(glGetQueryObjectivEXT)
+GL_FUNC_PTR(glGetQueryObjectuivEXT)
+GL_FUNC_PTR(glGetQueryObjecti64vEXT)
+GL_FUNC_PTR(glGetQueryObjectui64vEXT)
+#endif // GL_EXT_disjoint_timer_query
+#ifdef GL_OES_vertex_array_object
+GL_FUNC_PTR(glGenVertexArraysOES)
+GL_FUNC_PTR(glDeleteVertexArraysOES)
+GL_FUNC_PTR(glIsVertexArrayOES)
+GL_FUNC_PTR(glBindVertexArrayOES)
+#endif // GL_OES_vertex_array_object
+#ifdef GL_GLOVE_command_bundle
+GL_FUNC_PTR(glGenCommandBundlesGLOVE)
+GL_FUNC_PTR(glDeleteCommandBundlesGLOVE)
+GL_FUNC_PTR(glBeginCommandBundleGLOVE)
+GL_FUNC_PTR(glEndCommandBundleGLOVE)
+GL_FUNC_PTR(glCallCommandBundleGLOVE)
+#endif // GL_GLOVE_command_bundle
+#ifdef GL_GLOVE_compute_shader
+GL_FUNC_PTR(glDispatchCompute)
+GL_FUNC_PTR(glMemoryBarrier)
+GL_FUNC_PTR(glBindBufferBase)
+GL_FUNC_PTR(glBindBufferRange)
+#endif // GL_GLOVE_compute_shader
+#ifdef GL_GLOVE_transform_feedback
+GL_FUNC_PTR(glTransformFeedbackVaryings)
+GL_FUNC_PTR(glBeginTransformFeedback)
+GL_FUNC_PTR(glEndTransformFeedback)
+#endif // GL_GLOVE_transform_feedback
+#ifdef GL_GLOVE_primitive_restart
+GL_FUNC_PTR(glDrawRangeElements)
+#endif // GL_GLOVE_primitive_restart
+#ifdef GL_GLOVE_uniform_buffer_object
+GL_FUNC_PTR(glGetUniformBlockIndex)
+GL_FUNC_PTR(glUniformBlockBinding)
+#endif // GL_GLOVE_uniform_buffer_object
@@ -22,9 +22,11 @@
  */
 
 #include "context.h"
+#include "vulkan/hostAllocator.h"
 #include "utils/VkToGlConverter.h"
 
-static Context *currentContext = nullptr;
+/// contexts current to different threads are used in parallel
+static thread_local Context *currentContext = nullptr;
 
 Context *GetCurrentContext()
 {
@@ -38,17 +40,45 @@ void SetCurrentContext(Context *ctx)
     FUN_ENTRY(GL_LOG_TRACE);
 
     currentContext = ctx;
+    SetCurrentGLDispatchTable(ctx ? ctx->GetGLDispatchTable() : nullptr);
 }
 
-Context::Context()
+/// Quarter turns clockwise of the transform a window surface is presented with, when vertex shaders draw it rotated
+static uint32_t
+GetPreRotation(const EGLSurfaceInterface *eglSurfaceInterface)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(!GLOVE_USE_PRE_ROTATION) {
+        return 0;
+    }
+
+    switch(eglSurfaceInterface->preTransform) {
+    case VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR:  return 1;
+    case VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR: return 2;
+    case VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR: return 3;
+    default:                                      return 0;
+    }
+}
+
+Context::Context(Context *shareContext)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
     mVkContext            = vulkanAPI::GetContext();
     mCommandBufferManager = new vulkanAPI::CommandBufferManager(mVkContext);
 
-    mResourceManager = new ResourceManager(mVkContext);
+    // textures, buffers, shaders and programs of the share group live in a single manager;
+    // the compiler, the caches and the rings stay per context, as they are used without locking
+    if(shareContext != nullptr) {
+        mResourceManager = shareContext->GetResourceManager();
+        mResourceManager->Retain();
+    } else {
+        mResourceManager = new ResourceManager(mVkContext);
+    }
+    mShareGroupSlot  = mResourceManager->AcquireContextSlot();
     mShaderCompiler  = new GlslangShaderCompiler();
+    mShaderCompileQueue = new TaskQueue();
     mPipeline        = new vulkanAPI::Pipeline(mVkContext);
     mCacheManager    = new CacheManager(mVkContext);
 
@@ -57,35 +87,112 @@ Context::Context()
     InitializeDefaultTextures();
 
     mPipeline->SetCacheManager(mCacheManager);
-    mResourceManager->SetCacheManager(mCacheManager);
+
+    mDefaultVertexArray = new VertexArray(mVkContext, mCacheManager);
+    mVertexArray        = mDefaultVertexArray;
+    mVertexArrayId      = 0;
+    mNextVertexArrayId  = 1;
+    mNextCommandBundleId = 1;
+    mDebugGroupDepth     = 0;
+    mGLDispatchTable     = GetDefaultGLDispatchTable();
+    mCommandBundle      = nullptr;
+    mTransformFeedback.active      = false;
+    mTransformFeedback.primitiveMode = GL_POINTS;
+    mTransformFeedback.bufferCount = 0;
 
     mWriteSurface = nullptr;
     mReadSurface  = nullptr;
     mWriteFBO     = nullptr;
     mSystemFBO    = nullptr;
+    mSurfaceBoundTexture = nullptr;
 
     //If VK_KHR_maintenance1 is supported, then there is no need to invert the Y
     mIsYInverted        = !(vulkanAPI::GetContext()->mIsMaintenanceExtSupported);
     mIsModeLineLoop     = false;
+    mIsModeTriangleFan  = false;
+    mIsPrimitiveRestart = false;
+    mIsDrawRange        = false;
+    mDrawRangeEnd       = 0;
+    mNoError            = false;
+    mFramesSincePipelineCacheSave = 0;
+    mDrawsSinceSubmit = 0;
+    mNextPerfMonitorId  = 1;
+    mNextQueryId        = 1;
+    mActiveTimeElapsedQuery = 0;
+    mActiveOcclusionQuery = 0;
+    mQueryBlock.generation = 0;
+    mQueryBlock.stale  = true;
+    mDrawBatch.drawCount = 0;
+    mBoundDescriptorSet.cmdBuffer = VK_NULL_HANDLE;
+    mBoundDescriptorSet.bindlessSet = VK_NULL_HANDLE;
+    DiscardPendingClear(true, true, true);
 
     mScreenSpacePass = new ScreenSpacePass(mVkContext);
+    mPixelConversionPass = new PixelConversionPass(mVkContext);
     mScreenSpacePass->SetCacheManager(mCacheManager);
     mStateManager.InitVkPipelineStates(mScreenSpacePass->GetPipeline());
+
+    // the worker runs the calls of this context only, so it is current there for good
+    mGLThread = GLOVE_THREADED_DISPATCH ? new GLThread([this] { SetCurrentContext(this); }) : nullptr;
 }
 
 Context::~Context()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    // the calls still in the ring run first
+    if(mGLThread != nullptr) {
+        delete mGLThread;
+        mGLThread = nullptr;
+    }
+
     ReleaseSystemFBO();
 
+    // compiles still running are drained before the objects they report to go away
+    if(mShaderCompileQueue != nullptr) {
+        delete mShaderCompileQueue;
+        mShaderCompileQueue = nullptr;
+    }
+
     if(mShaderCompiler != nullptr) {
         delete mShaderCompiler;
         mShaderCompiler = nullptr;
     }
 
-    delete mResourceManager;
-    delete mCacheManager;
+    // the vertex arrays not bound keep a reference of their element array buffers
+    for(auto& vertexArray : mVertexArrays) {
+        if(vertexArray.second && vertexArray.second->GetElementArrayBuffer()) {
+            vertexArray.second->GetElementArrayBuffer()->Unbind();
+        }
+    }
+    if(mDefaultVertexArray->GetElementArrayBuffer()) {
+        mDefaultVertexArray->GetElementArrayBuffer()->Unbind();
+    }
+
+    if(mResourceManager->Release() == 0) {
+        delete mResourceManager;
+    } else {
+        // the slot is handed to the next context once nothing this one has submitted refers to the textures
+        mCommandBufferManager->GetUploadManager()->WaitAll();
+        mResourceManager->ReleaseContextSlot(mShareGroupSlot);
+        mResourceManager->DetachCacheManager(mCacheManager);
+    }
+
+    for(auto& vertexArray : mVertexArrays) {
+        delete vertexArray.second;
+    }
+    mVertexArrays.clear();
+    delete mDefaultVertexArray;
+    mDefaultVertexArray = nullptr;
+    mVertexArray        = nullptr;
+
+    // the frames that executed the bundles have completed along with the last submission
+    mCacheManager->SetCaptureBundle(nullptr);
+    for(auto& commandBundle : mCommandBundles) {
+        delete commandBundle.second;
+    }
+    mCommandBundles.clear();
+    mCommandBundle = nullptr;
 
     if(mPipeline != nullptr) {
         delete mPipeline;
@@ -97,6 +204,15 @@ Context::~Context()
         mScreenSpacePass = nullptr;
     }
 
+    // its pipeline and descriptor set are recorded into upload batches that may still be in flight
+    if(mPixelConversionPass != nullptr) {
+        mCommandBufferManager->GetUploadManager()->WaitAll();
+        delete mPixelConversionPass;
+        mPixelConversionPass = nullptr;
+    }
+
+    // cached pipelines are shared by the pipelines and programs released above
+    delete mCacheManager;
     delete mCommandBufferManager;
 }
 
@@ -105,6 +221,23 @@ Context::ReleaseSystemFBO(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    FlushDrawBatch();
+
+    // frames still in flight may refer to the system textures
+    if(mCommandBufferManager) {
+        STALL_REASON(STALL_REASON_TEARDOWN);
+        mCommandBufferManager->WaitLastSubmition();
+    }
+
+    // and the texture bound to the pbuffer to its color image
+    if(mSurfaceBoundTexture) {
+        if(mSurfaceBoundTexture->IsSurfaceBound()) {
+            mSurfaceBoundTexture->ReleaseSurfaceImage();
+        }
+        mSurfaceBoundTexture->Unbind();
+        mSurfaceBoundTexture = nullptr;
+    }
+
     for(uint32_t i = 0; i < mSystemTextures.size(); ++i) {
         if(mSystemTextures[i] != nullptr) {
             delete mSystemTextures[i];
@@ -127,12 +260,14 @@ Context::ReleaseSystemFBO(void)
     mReadSurface = nullptr;
     mWriteSurface = nullptr;
     mWriteFBO = nullptr;
+    DiscardPendingClear(true, true, true);
 }
 
 void
 Context::InitializeDefaultTextures()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("InitializeDefaultTextures", "startup");
 
     for(int i = 0; i < GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS; ++i) {
         mStateManager.GetActiveObjectsState()->SetActiveTexture(GL_TEXTURE_2D      , i, mResourceManager->GetDefaultTexture(GL_TEXTURE_2D));
@@ -145,13 +280,14 @@ Context::CreateFBOFromEGLSurface(EGLSurfaceInterface *eglSurfaceInterface)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // TODO: Pbuffer/pixmaps are not properly supported
-    assert(eglSurfaceInterface->type == EGL_WINDOW_BIT);
+    // TODO: Pixmaps are not supported
+    assert(eglSurfaceInterface->type == EGL_WINDOW_BIT || eglSurfaceInterface->type == EGL_PBUFFER_BIT);
 
     Framebuffer *fbo = InitializeFrameBuffer(eglSurfaceInterface);
+    fbo->UpdateSamples();
     fbo->CreateVkRenderPass(false, false, false, true, true, false);
     fbo->Create();
-    fbo->SetSurfaceType(GLOVE_SURFACE_WINDOW);
+    fbo->SetSurfaceType(eglSurfaceInterface->type == EGL_PBUFFER_BIT ? GLOVE_SURFACE_PBUFFER : GLOVE_SURFACE_WINDOW);
 
     return fbo;
 }
@@ -182,7 +318,11 @@ Context::InitializeFrameBuffer(EGLSurfaceInterface *eglSurfaceInterface)
         tex->SetExplicitType(glType);
 
         tex->SetVkFormat(surfaceColorFormat);
-        tex->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+        // pbuffer images are created by EGL to be read back, sampled and fetched from as well
+        tex->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(eglSurfaceInterface->type == EGL_PBUFFER_BIT ?
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                             VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT :
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
         tex->SetVkImageTiling();
         tex->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
         tex->SetVkImage(vkImages[i]);
@@ -193,11 +333,15 @@ Context::InitializeFrameBuffer(EGLSurfaceInterface *eglSurfaceInterface)
         mSystemTextures.push_back(tex);
     }
 
-    // depth/stencil images
-    Texture *tex = CreateDepthStencil(eglSurfaceInterface);
+    // depth/stencil images are allocated once a test or a clear first needs them, as many applications
+    // choose a config with depth and never enable the test. The one of another context is used right away
+    Texture *tex = eglSurfaceInterface->depthBuffer ? CreateDepthStencil(eglSurfaceInterface) : nullptr;
     fbo->SetDepthStencilAttachmentTexture(tex);
+    fbo->SetDeferredDepthStencilFormat(tex ? VK_FORMAT_UNDEFINED :
+                                       FindSupportedDepthStencilFormat(mVkContext->capabilityCache, eglSurfaceInterface->depthSize, eglSurfaceInterface->stencilSize));
     fbo->SetTarget(GL_FRAMEBUFFER);
     fbo->SetIsSystem();
+    fbo->SetPreRotation(GetPreRotation(eglSurfaceInterface));
     fbo->SetEGLSurfaceInterface(eglSurfaceInterface);
 
     return fbo;
@@ -209,7 +353,7 @@ Context::CreateDepthStencil(EGLSurfaceInterface *eglSurfaceInterface)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkFormat depthStencilFormat = FindSupportedDepthStencilFormat(mVkContext->vkGpus[0], eglSurfaceInterface->depthSize, eglSurfaceInterface->stencilSize);
+    VkFormat depthStencilFormat = FindSupportedDepthStencilFormat(mVkContext->capabilityCache, eglSurfaceInterface->depthSize, eglSurfaceInterface->stencilSize);
 
     if(depthStencilFormat == VK_FORMAT_UNDEFINED) {
         return nullptr;
@@ -218,15 +362,19 @@ Context::CreateDepthStencil(EGLSurfaceInterface *eglSurfaceInterface)
     Texture *tex = new Texture(mVkContext);
     tex->SetTarget(GL_TEXTURE_2D);
     tex->SetVkFormat(depthStencilFormat);
+    tex->SetVkSampleCount(FindSupportedVkSampleCount(mVkContext->vkFramebufferSampleCounts, eglSurfaceInterface->samples));
     tex->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
     tex->SetVkImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
     tex->SetVkImageTiling();
     tex->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
 
     if(!eglSurfaceInterface->depthBuffer) {
+        // stored the way the color images are
+        const bool transposed = GetPreRotation(eglSurfaceInterface) & 1;
         GLenum glformat = VkFormatToGlInternalformat(depthStencilFormat);
         tex->InitState();
-        tex->SetState(eglSurfaceInterface->width, eglSurfaceInterface->height,
+        tex->SetState(transposed ? eglSurfaceInterface->height : eglSurfaceInterface->width,
+                      transposed ? eglSurfaceInterface->width  : eglSurfaceInterface->height,
                   0, 0,
                   GlInternalFormatToGlFormat(glformat),
                   GlInternalFormatToGlType(glformat),
@@ -249,6 +397,71 @@ Context::CreateDepthStencil(EGLSurfaceInterface *eglSurfaceInterface)
     return tex;
 }
 
+void
+Context::AttachSystemDepthStencil(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mWriteFBO != mSystemFBO || !mSystemFBO->IsDepthStencilDeferred()) {
+        return;
+    }
+
+    // the render passes and framebuffers of the surface are created again with the buffer,
+    // once the frames recorded with the ones it has so far have been executed
+    if(IsFramebufferPending(mSystemFBO)) {
+        Finish();
+    }
+
+    // the surface interface belongs to EGL, the image is kept in it for the other contexts, as when allocated upfront
+    EGLSurfaceInterface *eglSurfaceInterface = const_cast<EGLSurfaceInterface *>(mSystemFBO->GetEGLSurfaceInterface());
+    Texture *tex = CreateDepthStencil(eglSurfaceInterface);
+    mSystemFBO->SetDeferredDepthStencilFormat(VK_FORMAT_UNDEFINED);
+    if(tex == nullptr) {
+        return;
+    }
+
+    mSystemFBO->SetDepthStencilAttachmentTexture(tex);
+    mSystemFBO->SetUpdated();
+    mPipeline->SetUpdatePipeline(true);
+
+    // nothing but the clears issued so far has defined its contents
+    if(mSystemFBO->HasDeferredDepthClear() || mSystemFBO->HasDeferredStencilClear()) {
+        mPendingClear.depth        = mSystemFBO->HasDeferredDepthClear();
+        mPendingClear.stencil      = mSystemFBO->HasDeferredStencilClear();
+        mPendingClear.depthValue   = mSystemFBO->GetDeferredDepthClearValue();
+        mPendingClear.stencilValue = mSystemFBO->GetDeferredStencilClearValue();
+        mPendingClear.rect         = *mSystemFBO->GetRect();
+    }
+
+    const Texture *colorTexture = mSystemFBO->GetColorAttachmentTexture();
+    if(colorTexture) {
+        mScreenSpacePass->WarmUp(colorTexture->GetVkFormat(), tex->GetVkFormat(), mSystemFBO->GetSamples());
+    }
+}
+
+bool
+Context::DeferSystemDepthStencilClear(bool clearDepthEnabled, bool clearStencilEnabled)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // only clears of the whole buffer can be replayed, nor do masked stencil bits keep contents a replay could restore
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+    const Rect *rect = mSystemFBO->GetRect();
+    if(mClearRect.x != rect->x || mClearRect.y != rect->y || mClearRect.width != rect->width || mClearRect.height != rect->height ||
+       (clearStencilEnabled && stateFramebufferOperations->StencilMaskActive())) {
+        return false;
+    }
+
+    if(clearDepthEnabled && stateFramebufferOperations->IsDepthWriteEnabled()) {
+        mSystemFBO->SetDeferredDepthClear(stateFramebufferOperations->GetClearDepth());
+    }
+    if(clearStencilEnabled && stateFramebufferOperations->IsStencilWriteEnabled()) {
+        mSystemFBO->SetDeferredStencilClear(stateFramebufferOperations->GetClearStencilMasked());
+    }
+
+    return true;
+}
+
 void
 Context::DestroyAPISurfaceData(const vulkanAPI::vkContext_t *vkContext,
                                EGLSurfaceInterface *eglSurfaceInterface)
@@ -259,7 +472,7 @@ Context::DestroyAPISurfaceData(const vulkanAPI::vkContext_t *vkContext,
        eglSurfaceInterface->depthBuffer != 0) {
         VkImage vkImage = reinterpret_cast<VkImage>(eglSurfaceInterface->depthBuffer);
         if(vkImage != VK_NULL_HANDLE) {
-            vkDestroyImage(vkContext->vkDevice, vkImage, nullptr);
+            vkDestroyImage(vkContext->vkDevice, vkImage, vkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
         }
         eglSurfaceInterface->depthBuffer = 0;
     }
@@ -270,11 +483,22 @@ Context::SetReadWriteSurfaces(EGLSurfaceInterface *eglReadSurfaceInterface, EGLS
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    FlushDrawBatch();
+
     // TODO:: TBD as we do not take into account read surface!
     if(mWriteSurface && mWriteSurface == eglWriteSurfaceInterface->surface) {
         return;
     }
 
+    // a clear still pending belongs to the surface that is made current no more,
+    // and frames of a window surface are submitted before the context leaves it
+    if(mWriteFBO) {
+        ResolvePendingClear();
+        if(mSystemFBO && mSystemFBO->GetSurfaceType() == GLOVE_SURFACE_WINDOW) {
+            Flush();
+        }
+    }
+
     FRAMEBUFFER_SURFACES_PAIR readWritePair = {eglReadSurfaceInterface, eglWriteSurfaceInterface};
 
     auto fboIter = mSystemFBOMap.find(readWritePair);
@@ -285,7 +509,8 @@ Context::SetReadWriteSurfaces(EGLSurfaceInterface *eglReadSurfaceInterface, EGLS
         // if surface has been invalidated, recreate the FBO (e.g., resized on another context)
         bool surfaceUpdated =
                 (eglWriteSurfaceInterface->width != static_cast<uint32_t>(mWriteFBO->GetWidth())) ||
-                (eglWriteSurfaceInterface->height != static_cast<uint32_t>(mWriteFBO->GetHeight()));
+                (eglWriteSurfaceInterface->height != static_cast<uint32_t>(mWriteFBO->GetHeight())) ||
+                (GetPreRotation(eglWriteSurfaceInterface) != mWriteFBO->GetPreRotation());
         if(!surfaceUpdated) {
             mWriteFBO = fboIter->second;
         } else {
@@ -301,6 +526,8 @@ Context::SetReadWriteSurfaces(EGLSurfaceInterface *eglReadSurfaceInterface, EGLS
         mSystemFBOMap[readWritePair] = mWriteFBO;
     }
 
+    // each window surface brings the semaphores of its own swapchain, so that several may be presented together
+    mCommandBufferManager->SetSyncItems(static_cast<vkSyncItems_t *>(eglWriteSurfaceInterface->syncItems));
     SetSystemFramebuffer(mWriteFBO);
 }
 
@@ -310,57 +537,172 @@ Context::SetSystemFramebuffer(Framebuffer *FBO)
     FUN_ENTRY(GL_LOG_TRACE);
 
     mSystemFBO = FBO;
+    mCommandBufferManager->SetWindowSurface(mSystemFBO->GetSurfaceType() == GLOVE_SURFACE_WINDOW);
 
     mStateManager.GetViewportTransformationState()->SetViewportRect(mSystemFBO->GetRect());
     mStateManager.GetFragmentOperationsState()->SetScissorRect(mSystemFBO->GetRect());
+    InvalidateQueryBlock();
     mPipeline->SetUpdatePipeline(true);
     mPipeline->SetUpdateViewportState(true);
+
+    // the pipelines of masked clears into the surface compile in the background while the application starts
+    const Texture *colorTexture        = mSystemFBO->GetColorAttachmentTexture();
+    const Texture *depthStencilTexture = mSystemFBO->GetDepthStencilAttachmentTexture();
+    if(colorTexture) {
+        mScreenSpacePass->WarmUp(colorTexture->GetVkFormat(), depthStencilTexture ? depthStencilTexture->GetVkFormat() : VK_FORMAT_UNDEFINED,
+                                 mSystemFBO->GetSamples());
+    }
 }
 
 void
-Context::EGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image)
+Context::BindToTexture(GLuint bind)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    NOT_IMPLEMENTED();
-}
+    if(mSystemFBO == nullptr || mSystemFBO->GetSurfaceType() != GLOVE_SURFACE_PBUFFER) {
+        return;
+    }
 
-void
-Context::EGLImageTargetRenderBufferStorageOES(GLenum target, GLeglImageOES image)
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
+    // the color buffer leaves every render pass ready to be sampled for as long as it is bound
+    mSystemFBO->SetBindToTexture(bind);
+    Finish();
 
-    NOT_IMPLEMENTED();
+    Texture *colorTexture = mSystemFBO->GetColorAttachmentTexture();
+    if(mSurfaceBoundTexture) {
+        // the surface tracks the layout of its image again
+        if(mSurfaceBoundTexture->IsSurfaceBound()) {
+            colorTexture->SetVkImageLayout(mSurfaceBoundTexture->GetVkImageLayout());
+            mSurfaceBoundTexture->ReleaseSurfaceImage();
+        }
+        mSurfaceBoundTexture->Unbind();
+        mSurfaceBoundTexture = nullptr;
+    }
 
-    return;
+    if(!bind) {
+        return;
+    }
+
+    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_2D);
+    if(!mResourceManager->GetTextureID(activeTexture) || activeTexture->IsImmutable()) {
+        return;
+    }
+
+    // the texture samples the image the pbuffer is rendered to, nothing is copied, and the two agree on its layout
+    if(colorTexture->GetVkImageLayout() != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+        colorTexture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    if(!activeTexture->BindSurfaceImage(colorTexture, mSystemFBO->IsStoredUpright())) {
+        return;
+    }
+
+    // kept alive until released, also when deleted in the meantime
+    activeTexture->Bind();
+    mSurfaceBoundTexture = activeTexture;
+
+    if(mStateManager.GetActiveShaderProgram() != nullptr) {
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
+    }
 }
 
 void
-Context::InsertEventMarkerEXT(GLsizei length, const GLchar *marker)
+Context::EGLImageTargetTexture2DOES(GLenum target, GLeglImageOES image)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    NOT_IMPLEMENTED();
+    if(target != GL_TEXTURE_2D) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(image == nullptr) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
+    if(!mResourceManager->GetTextureID(activeTexture) || activeTexture->IsImmutable()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
 
-    return;
+    // the previous storage may still be sampled by the recorded commands
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    // the texture samples the memory of the EGLImage, nothing is copied
+    if(!activeTexture->ImportEGLImage(static_cast<const EGLImageInterface *>(image),
+                                      static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT))) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(mStateManager.GetActiveShaderProgram() != nullptr) {
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
+    }
 }
 
-void
-Context::PushGroupMarkerEXT(GLsizei length, const GLchar *marker)
+bool
+Context::ExportTextureImage(GLuint texture, EGLImageInterface *eglImage)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    NOT_IMPLEMENTED();
+    if(!mVkContext->mIsExternalMemoryDmaBufSupported || !texture || !mResourceManager->TextureExists(texture)) {
+        return false;
+    }
+
+    // the previous storage may still be used by the recorded commands
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    Texture *exportedTexture = mResourceManager->GetTexture(texture);
+    if(!exportedTexture->ExportEGLImage(eglImage)) {
+        return false;
+    }
 
-    return;
+    // the framebuffers it is attached to, and the shaders it is sampled by, use the new image
+    mResourceManager->UpdateFramebufferObjects(texture, GL_TEXTURE);
+    if(mStateManager.GetActiveShaderProgram() != nullptr) {
+        mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
+    }
+
+    // the levels are in the buffer before anyone imports it
+    Finish();
+
+    return true;
 }
 
 void
-Context::PopGroupMarkerEXT(void)
+Context::EGLImageTargetRenderBufferStorageOES(GLenum target, GLeglImageOES image)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    NOT_IMPLEMENTED();
+    if(target != GL_RENDERBUFFER) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(image == nullptr) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    uint32_t activeRenderbufferId = mStateManager.GetActiveObjectsState()->GetActiveRenderbufferObjectID();
+    if(!activeRenderbufferId) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // the storage may belong to a framebuffer rendered earlier in the recorded commands
+    if(HasPendingCommands()) {
+        Finish();
+    }
 
-    return;
+    Renderbuffer* activeRenderbuffer = mResourceManager->GetRenderbuffer(activeRenderbufferId);
+    if(!activeRenderbuffer->ImportEGLImage(static_cast<const EGLImageInterface *>(image))) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
 }
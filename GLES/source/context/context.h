@@ -27,17 +27,34 @@
 #include "utils/glUtils.h"
 #include "utils/glLogger.h"
 #include "utils/cacheManager.h"
+#include "utils/taskQueue.h"
+#include "utils/glThread.h"
 #include "glslang/glslangShaderCompiler.h"
 #include "state/stateManager.h"
 #include "resources/resourceManager.h"
 #include "vulkan/pipeline.h"
 #include "vulkan/clearPass.h"
 #include "resources/screenSpacePass.h"
+#include "resources/pixelConversionPass.h"
 #include "vulkan/commandBufferManager.h"
+#include "vulkan/perfCounters.h"
 #include "rendering_api_interface.h"
+#include "api/glDispatch.h"
 #include <utility>
 #include <map>
 
+/// Number of values that the queries answered from the flat query block of a context take up
+#define GLOVE_QUERY_BLOCK_SIZE                          16
+
+/// Number of presented frames between two writes of the pipeline cache to its file
+#define GLOVE_PIPELINE_CACHE_SAVE_INTERVAL              600
+
+/// Number of cached pipelines kept when device memory is under pressure
+#define GLOVE_MEMORY_PRESSURE_KEPT_PIPELINES            (GLOVE_MAX_CACHED_PIPELINES / 4)
+
+/// Number of draws recorded since the last submission, below which glFlush keeps recording into the same command buffer
+#define GLOVE_FLUSH_MIN_DRAWS                           64
+
 typedef enum {
     GLOVE_HOST_X86_BINARY = 1,
     GLOVE_HOST_ARM_BINARY,
@@ -53,16 +70,117 @@ private:
     vulkanAPI::vkContext_t                     *mVkContext;
 // ------------
     Rect                                        mClearRect;
+    vulkanAPI::ClearPass                        mClearPass;
     StateManager                                mStateManager;
-    ResourceManager                            *mResourceManager;
+    ResourceManager                            *mResourceManager;   /// shared by the contexts of the share group
+    uint32_t                                    mShareGroupSlot;    /// which of the serials stamped on shared textures are this context's
     CacheManager                               *mCacheManager;
     ShaderCompiler                             *mShaderCompiler;
+    TaskQueue                                  *mShaderCompileQueue;
     vulkanAPI::Pipeline                        *mPipeline;
     ScreenSpacePass                            *mScreenSpacePass;
+    PixelConversionPass                        *mPixelConversionPass;
     vulkanAPI::CommandBufferManager            *mCommandBufferManager;
+    GLThread                                   *mGLThread;          /// executes the calls of the context when dispatch is threaded
 // ------------
     bool                                        mIsYInverted;
     bool                                        mIsModeLineLoop;
+    bool                                        mIsModeTriangleFan;
+    bool                                        mIsPrimitiveRestart; /// the strips of the draw are cut at the restart index of its type
+    bool                                        mIsDrawRange;       /// the indices of the draw are known to be at most mDrawRangeEnd
+    uint32_t                                    mDrawRangeEnd;
+    bool                                        mNoError;           /// GL_KHR_no_error, the checks of the hot calls are skipped
+    const GLDispatchTable                      *mGLDispatchTable;   /// entry points the API calls go to while the context is current
+    uint32_t                                    mFramesSincePipelineCacheSave;
+    uint32_t                                    mDrawsSinceSubmit;
+// ------------
+    /// consecutive draws that only differ in their vertex or index ranges, recorded with a single set of bindings.
+    /// each draw is matched against the fields ahead of the arrays, which thus share as few cache lines as they can
+    typedef struct DrawBatch_t {
+        VkCommandBuffer                         cmdBuffer;
+        const ShaderProgram                    *program;
+        VkPipeline                              pipeline;
+        VkDescriptorSet                         descSet;
+        VkBuffer                                indexBuffer;
+        VkIndexType                             indexType;
+        uint32_t                                indexOffset;
+        bool                                    indexed;
+        uint32_t                                instanceCount;
+        uint32_t                                drawCount;
+        uint32_t                                vertexBufferCount;
+        uint32_t                                pushConstantsSize;
+        std::vector<uint32_t>                   dynamicOffsets;
+        VkBuffer                                vertexBuffers[GLOVE_MAX_VERTEX_ATTRIBS];
+        VkDeviceSize                            vertexBufferOffsets[GLOVE_MAX_VERTEX_ATTRIBS];
+        uint8_t                                 pushConstants[GLOVE_MAX_PUSH_CONSTANTS_SIZE];
+        uint32_t                                firsts[GLOVE_MAX_BATCHED_DRAWS];
+        uint32_t                                counts[GLOVE_MAX_BATCHED_DRAWS];
+    } DrawBatch_t;
+
+    DrawBatch_t                                 mDrawBatch;
+
+    /// descriptor set last bound into a command buffer, so that draws changing only push constants skip the rebind,
+    /// and the bindless texture table bound next to it
+    typedef struct BoundDescriptorSet_t {
+        VkCommandBuffer                         cmdBuffer;
+        VkPipelineLayout                        pipelineLayout;
+        VkDescriptorSet                         descSet;
+        std::vector<uint32_t>                   dynamicOffsets;
+        VkDescriptorSet                         bindlessSet;
+    } BoundDescriptorSet_t;
+
+    BoundDescriptorSet_t                        mBoundDescriptorSet;
+
+    /// clear of the write framebuffer issued while no render pass runs, turned into the
+    /// load operations of the pass that the first draw or pass boundary begins
+    typedef struct PendingClear_t {
+        bool                                    color;
+        bool                                    depth;
+        bool                                    stencil;
+        GLfloat                                 colorValue[4];
+        GLfloat                                 depthValue;
+        uint32_t                                stencilValue;
+        Rect                                    rect;
+    } PendingClear_t;
+
+    PendingClear_t                              mPendingClear;
+
+    /// monitor of GL_AMD_performance_monitor, whose result is what the counters of the device
+    /// have added up between its begin and end, so it is available as soon as it ends
+    typedef struct PerfMonitor_t {
+        uint32_t                                selectedMask;
+        bool                                    active;
+        bool                                    resultAvailable;
+        uint64_t                                begin[vulkanAPI::PERF_COUNTER_COUNT];
+        uint64_t                                result[vulkanAPI::PERF_COUNTER_COUNT];
+    } PerfMonitor_t;
+
+    std::map<GLuint, PerfMonitor_t>             mPerfMonitors;
+    GLuint                                      mNextPerfMonitorId;
+
+    /// query of GL_EXT_disjoint_timer_query or GL_EXT_occlusion_query_boolean, whose target is decided the first
+    /// time it is begun or counted. a time elapsed query keeps both its timestamps, a timestamp query only the end one
+    typedef struct Query_t {
+        GLenum                                  target;
+        std::shared_ptr<vulkanAPI::Timestamp_t> begin;
+        std::shared_ptr<vulkanAPI::Timestamp_t> end;
+        std::shared_ptr<vulkanAPI::OcclusionQuery_t> occlusion;
+    } Query_t;
+
+    std::map<GLuint, Query_t>                   mQueries;
+    GLuint                                      mNextQueryId;
+    GLuint                                      mActiveTimeElapsedQuery;
+    GLuint                                      mActiveOcclusionQuery;
+
+    /// state that middleware saves and restores around every draw, laid out flat so that glGet* copies it,
+    /// derived again once the bindings change or the viewport or the scissor box has been set
+    typedef struct QueryBlock_t {
+        GLint                                   values[GLOVE_QUERY_BLOCK_SIZE];
+        uint32_t                                generation;
+        bool                                    stale;
+    } QueryBlock_t;
+
+    QueryBlock_t                                mQueryBlock;
 // ------------
     EGLSurfaceInterface                        *mWriteSurface;
     EGLSurfaceInterface                        *mReadSurface;
@@ -71,36 +189,134 @@ private:
 
     Framebuffer                                *mSystemFBO;
     vector<Texture *>                           mSystemTextures;
+    /// texture the pbuffer is bound to with eglBindTexImage, which samples its color image
+    Texture                                    *mSurfaceBoundTexture;
+
+    /// vertex arrays are not shared, the names generated are reserved until first bound
+    VertexArray                                *mDefaultVertexArray;
+    VertexArray                                *mVertexArray;       /// the one bound, whose attributes the calls set
+    GLuint                                      mVertexArrayId;
+    std::map<GLuint, VertexArray *>             mVertexArrays;
+    GLuint                                      mNextVertexArrayId;
+
+    /// command bundles are not shared either, the names generated are reserved until first begun
+    std::map<GLuint, vulkanAPI::CommandBundle *> mCommandBundles;
+    GLuint                                      mNextCommandBundleId;
+    vulkanAPI::CommandBundle                   *mCommandBundle;     /// the one the draws are captured into
+
+    /// groups of GL_EXT_debug_marker pushed and not popped yet
+    GLuint                                      mDebugGroupDepth;
+
+    /// capture of GL_GLOVE_transform_feedback, into the buffers bound when it was begun,
+    /// each written from where the previous draw has left it up to the end of its range
+    typedef struct TransformFeedback_t {
+        bool                                    active;
+        GLenum                                  primitiveMode;
+        uint32_t                                bufferCount;
+        BufferObject                           *buffers[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+        VkDeviceSize                            offsets[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+        VkDeviceSize                            ends[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+        uint32_t                                strides[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+    } TransformFeedback_t;
+
+    TransformFeedback_t                         mTransformFeedback;
 
     typedef std::pair<EGLSurfaceInterface*, EGLSurfaceInterface*> FRAMEBUFFER_SURFACES_PAIR;
     std::map<FRAMEBUFFER_SURFACES_PAIR, Framebuffer*> mSystemFBOMap;
 
 // ------------
 
+    Shader        *FindShaderPtr(GLuint shader);
+    ShaderProgram *FindProgramPtr(GLuint program);
     Shader        *GetShaderPtr(GLuint shader);
     ShaderProgram *GetProgramPtr(GLuint program);
+    void           CompleteProgramLink(ShaderProgram *progPtr);
 
     Framebuffer   *CreateFBOFromEGLSurface(EGLSurfaceInterface *eglSurfaceInterface);
     Framebuffer   *InitializeFrameBuffer(EGLSurfaceInterface *eglSurfaceInterface);
     Texture       *CreateDepthStencil(EGLSurfaceInterface *eglSurfaceInterface);
+    void           AttachSystemDepthStencil(void);
+    bool           DeferSystemDepthStencilClear(bool clearDepthEnabled, bool clearStencilEnabled);
 
     void           PrepareRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
     void           CreateShaderCompiler(void);
     void           ClearSimple(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
-    void           ClearWithColorMask(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
+    void           ClearWithWriteMasks(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
+    bool           CanClearInsideRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
+    void           RecordClearAttachments(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
+    void           DeferClear(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
+    void           ResolvePendingClear(void);
+    void           DiscardPendingClear(bool color, bool depth, bool stencil);
+    inline bool    HasPendingClear(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mPendingClear.color || mPendingClear.depth || mPendingClear.stencil; }
 
     void UpdateViewportState(vulkanAPI::Pipeline* pipeline);
     void BeginRendering(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled);
-    void PushGeometry(uint32_t vertCount, uint32_t firstVertex, bool indexed, GLenum type, const void *indices);
-    void UpdateVertexAttributes(uint32_t vertCount, uint32_t firstVertex);
+    void AcquireDrawCommandBuffer(void);
+    bool SubmitDrawCommandBuffer(void);
+    bool HasPendingCommands(void);
+    bool IsFramebufferPending(const Framebuffer *fbo);
+    GLint GetWriteFBOSamples(void);
+    const GLint *FindQuery(GLenum pname, GLsizei *count);
+    void UpdateQueryBlock(void);
+    inline void InvalidateQueryBlock(void)                                  { FUN_ENTRY(GL_LOG_TRACE); mQueryBlock.stale = true; }
+    void PrepareWriteFBOForReading(VkCommandBuffer *cmdBuffer);
+    void SubmitPbufferReadback(void);
+    void RelieveMemoryPressure(void);
+    bool BeginGeometry(bool capturable);
+    bool PrepareGeometryPipeline(void);
+    void BindGeometryState(VkCommandBuffer *drawCmdBuffer, bool indexed, uint32_t indexOffset);
+    void PushGeometry(uint32_t vertCount, uint32_t firstVertex, uint32_t instanceCount, bool indexed, GLenum type, const void *indices);
+    void PushGeometryRanges(bool indexed, uint32_t indexOffset, const uint32_t *firsts, const uint32_t *counts, uint32_t drawCount);
+    void PushGeometryIndirect(bool indexed, uint32_t indexOffset, BufferObject *indirectBo, size_t offset, uint32_t drawCount, uint32_t stride);
+    BufferObject *GetDrawIndirectBufferObject(const void *indirect, GLsizei drawcount, GLsizei stride, size_t commandSize);
+    bool PrepareCommandBundleGeometry(void);
+    void FinishCommandBundle(const vulkanAPI::CommandBundle *bundle);
+    void AddDebugLabel(vulkanAPI::debugLabelOp_t op, GLsizei length, const GLchar *marker);
+    VkCommandBuffer *BeginDrawCommandBuffer(VkCommandBuffer *activeCmdBuffer);
+    void EndDrawCommandBuffer(VkCommandBuffer *activeCmdBuffer, VkCommandBuffer *drawCmdBuffer);
+    void UpdateVertexAttributes(uint32_t vertCount, uint32_t firstVertex, uint32_t instanceCount);
     void UpdateIndices(uint32_t* offset, uint32_t* maxIndex, uint32_t indexCount, GLenum type, const void* indices, BufferObject* ibo);
+    void UpdateUniformDescriptors(void);
     void BindUniformDescriptors(VkCommandBuffer *CmdBuffer);
+    bool IsDescriptorSetBound(VkCommandBuffer cmdBuffer, const ShaderProgram *program) const;
     void BindVertexBuffers(VkCommandBuffer *CmdBuffer);
     void BindIndexBuffer(VkCommandBuffer *CmdBuffer, uint32_t offset, VkIndexType type);
-    void DrawGeometry(VkCommandBuffer *CmdBuffer, bool indexed, uint32_t firstVertex, uint32_t vertCount);
+    void DrawGeometry(VkCommandBuffer *CmdBuffer, bool indexed, uint32_t vertCount, uint32_t instanceCount);
+    void DrawGeometryRanges(VkCommandBuffer *CmdBuffer, bool indexed, const uint32_t *firsts, const uint32_t *counts, uint32_t drawCount);
+    void DrawGeometryIndirect(VkCommandBuffer *CmdBuffer, bool indexed, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+    bool IsDrawBatchable(const VkCommandBuffer *drawCmdBuffer, const VkCommandBuffer *activeCmdBuffer);
+    bool AppendToDrawBatch(VkCommandBuffer cmdBuffer, bool indexed, uint32_t vertCount, uint32_t indexOffset, uint32_t instanceCount);
+    void BeginDrawBatch(VkCommandBuffer cmdBuffer, bool indexed, uint32_t vertCount, uint32_t indexOffset, uint32_t instanceCount);
+    void RecordDrawBatch(void);
+    void RecordDrawBatchRange(VkCommandBuffer cmdBuffer, uint32_t first, uint32_t last) const;
+    void BindDrawBatchState(VkCommandBuffer cmdBuffer, float lineWidth) const;
     void SetCapability(GLenum cap, GLboolean enable);
 
     void InitializeDefaultTextures(void);
+    bool IsCompressedTextureFormatNative(GLenum format);
+    bool IsCompressedTextureFormatSupported(GLenum format);
+    void GetCompressedTextureFormats(std::vector<GLenum> *formats);
+    const char *GetExtensionsString(const char *baseExtensions);
+    static void CopyPerfMonitorString(const char *string, GLsizei bufSize, GLsizei *length, GLchar *dst);
+    std::shared_ptr<vulkanAPI::Timestamp_t> WriteTimerQueryTimestamp(bool begin);
+    bool GetQueryObjectResult(GLuint id, GLenum pname, uint64_t *result);
+    void FinishTextureCommands(const Texture *texture);
+    bool CopyFramebufferToTexture(Texture *texture, GLint x, GLint y, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLint level, GLint layer);
+    const void *ReadUnpackBuffer(BufferObject *pbo, size_t offset, size_t size, std::vector<uint8_t> *data);
+    bool UnpackBufferToTexture(BufferObject *pbo, Texture *texture, const Rect *rect, GLint level, GLint layer, GLenum format, GLenum type, size_t offset);
+    bool ReadPixelsToPackBuffer(BufferObject *pbo, const ImageRect *srcRect, const ImageRect *dstRect, GLenum dstInternalFormat, size_t offset);
+    void ReadPreRotatedPixels(Texture *fbTexture, ImageRect *srcRect, const ImageRect *dstRect, GLenum dstInternalFormat, void *pixels);
+    Framebuffer *GetReadFBO(void);
+    GLenum GetImplementationColorReadType(void);
+    /// views are faces of cube maps, as many as the device draws at once
+    inline GLsizei GetMaxViews(void)                                  const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<GLsizei>(std::min(mVkContext->vkMaxMultiviewViewCount, static_cast<uint32_t>(TEXTURE_CUBE_MAP_LAYERS))); }
+    void ResetColorAttachmentViews(void);
+    void FinishBufferReadbacks(BufferObject *bo);
+    void FinishBufferDeviceWrites(BufferObject *bo);
+    void RecordComputeBarrier(VkCommandBuffer cmdBuffer, bool incoming);
+    void SplitRenderPassForTransformFeedback(bool incoming);
+    bool PrepareTransformFeedbackGeometry(uint32_t vertCount, uint32_t instanceCount, uint32_t *capturedCount);
+    void DrawTransformFeedbackGeometry(VkCommandBuffer *CmdBuffer, uint32_t vertCount, uint32_t instanceCount, uint32_t capturedCount);
 
     void SetClearRect(void);
     bool SetPipelineProgramShaderStages(ShaderProgram *progPtr);
@@ -112,27 +328,58 @@ private:
 
 // Is/Has Functions
     inline bool             IsDrawModeTriangle(GLenum mode)                const { FUN_ENTRY(GL_LOG_TRACE); return (mode == GL_TRIANGLE_STRIP || mode  == GL_TRIANGLE_FAN || mode == GL_TRIANGLES); }
+    inline bool             IsBufferTarget(GLenum target)                  const { FUN_ENTRY(GL_LOG_TRACE); return (target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER || target == GL_PIXEL_PACK_BUFFER_NV || target == GL_PIXEL_UNPACK_BUFFER_NV || target == GL_DRAW_INDIRECT_BUFFER ||
+                                                                                                               target == GL_SHADER_STORAGE_BUFFER || target == GL_UNIFORM_BUFFER ||
+                                                                                                               (target == GL_TRANSFORM_FEEDBACK_BUFFER && mVkContext->mIsTransformFeedbackSupported)); }
 // Other Functions
-    inline void             RecordError(GLenum error)                            { FUN_ENTRY(GL_LOG_TRACE); if (mStateManager.GetError() == GL_NO_ERROR) { mStateManager.SetError(error); } }
+    inline void             RecordError(GLenum error)                            { FUN_ENTRY(GL_LOG_TRACE); if ((!mNoError || error == GL_OUT_OF_MEMORY) && mStateManager.GetError() == GL_NO_ERROR) { mStateManager.SetError(error); } }
 
 public:
-    Context();
+    Context(Context *shareContext);
     ~Context();
 
     static void             DestroyAPISurfaceData(const vulkanAPI::vkContext_t *vkContext, EGLSurfaceInterface *eglSurfaceInterface);
 
     void                    ReleaseSystemFBO(void);
+    void                    SubmitFrame(void);
+    void                    EndFrame(void);
+    void                    SetDamageRegion(const EGLint *rects, EGLint count);
+
+    vulkanAPI::Fence       *CreateFence(bool exportable = false);
+    void                    ServerWaitFence(vulkanAPI::Fence *fence);
+    static bool             ClientWaitFence(vulkanAPI::Fence *fence, uint64_t timeout);
+    static void             DestroyFence(vulkanAPI::Fence *fence);
+    static int              ExportFenceSyncFd(vulkanAPI::Fence *fence);
+    /// shares the texture with other devices through a dma-buf that the EGLImage is filled in with
+    bool                    ExportTextureImage(GLuint texture, EGLImageInterface *eglImage);
+    inline void             InvalidateBoundDescriptorSet(void)                    { FUN_ENTRY(GL_LOG_TRACE); mBoundDescriptorSet.cmdBuffer = VK_NULL_HANDLE; }
+    inline void             FlushDrawBatch(void)                                  { FUN_ENTRY(GL_LOG_TRACE); if(mDrawBatch.drawCount) { RecordDrawBatch(); } }
+    inline void             SetNoError(bool noError)                              { FUN_ENTRY(GL_LOG_TRACE); mNoError = noError; }
+    inline bool             IsNoError(void)                                 const { FUN_ENTRY(GL_LOG_TRACE); return mNoError; }
+    /// takes effect the next time the context is made current
+    inline void             SetGLDispatchTable(const GLDispatchTable *table)      { FUN_ENTRY(GL_LOG_TRACE); mGLDispatchTable = table ? table : GetDefaultGLDispatchTable(); }
+    inline void             SyncGLThread(void)                                    { FUN_ENTRY(GL_LOG_TRACE); if(mGLThread) { mGLThread->Sync(); } }
 
 // Get Functions
     inline  vulkanAPI::CommandBufferManager *GetVkCommandBufferManager(void)      { FUN_ENTRY(GL_LOG_TRACE); return mCommandBufferManager; }
     inline  StateManager    *GetStateManager(void)                                { FUN_ENTRY(GL_LOG_TRACE); return &mStateManager; }
     inline  ResourceManager *GetResourceManager(void)                             { FUN_ENTRY(GL_LOG_TRACE); return mResourceManager; }
+    inline  uint32_t         GetShareGroupSlot(void)                        const { FUN_ENTRY(GL_LOG_TRACE); return mShareGroupSlot; }
+    inline  CacheManager    *GetCacheManager(void)                                { FUN_ENTRY(GL_LOG_TRACE); return mCacheManager; }
+    inline  PixelConversionPass *GetPixelConversionPass(void)                     { FUN_ENTRY(GL_LOG_TRACE); return mPixelConversionPass; }
+    inline  GLThread        *GetGLThread(void)                                    { FUN_ENTRY(GL_LOG_TRACE); return mGLThread; }
+    inline  const GLDispatchTable *GetGLDispatchTable(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mGLDispatchTable; }
+    inline  Framebuffer     *GetWriteFBO(void)                                    { FUN_ENTRY(GL_LOG_TRACE); return mWriteFBO; }
     inline  bool            IsYInverted(void)                              const  { FUN_ENTRY(GL_LOG_TRACE); return mIsYInverted; }
     inline  bool            IsModeLineLoop(void)                           const  { FUN_ENTRY(GL_LOG_TRACE); return mIsModeLineLoop; }
+    inline  bool            IsModeTriangleFan(void)                        const  { FUN_ENTRY(GL_LOG_TRACE); return mIsModeTriangleFan; }
+    inline  bool            IsPrimitiveRestart(void)                       const  { FUN_ENTRY(GL_LOG_TRACE); return mIsPrimitiveRestart; }
+    inline  bool            IsDrawRange(void)                              const  { FUN_ENTRY(GL_LOG_TRACE); return mIsDrawRange; }
+    inline  uint32_t        GetDrawRangeEnd(void)                          const  { FUN_ENTRY(GL_LOG_TRACE); return mDrawRangeEnd; }
 
 // Set Functions
             void            SetReadWriteSurfaces(EGLSurfaceInterface *eglReadSurfaceInterface, EGLSurfaceInterface *eglWriteSurfaceInterface);
-    inline  void            BindToTexture(GLuint bind)                            { FUN_ENTRY(GL_LOG_DEBUG); mSystemFBO->SetBindToTexture(bind); }
+            void            BindToTexture(GLuint bind);
 
     inline  bool            HasShaderCompiler(void);
 
@@ -183,6 +430,7 @@ public:
     void            EnableVertexAttribArray(GLuint index);
     void            Finish(void);
     bool            Flush(void);
+    bool            FlushHint(void);
     void            FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
     void            FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
     void            FrontFace(GLenum mode);
@@ -231,6 +479,7 @@ public:
     void            PolygonOffset(GLfloat factor, GLfloat units);
     void            ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
     void            ReleaseShaderCompiler(void);
+    void            MaxShaderCompilerThreadsKHR(GLuint count);
     void            RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
     void            SampleCoverage(GLclampf value, GLboolean invert);
     void            Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
@@ -286,8 +535,82 @@ public:
     void            InsertEventMarkerEXT(GLsizei length, const GLchar *marker);
     void            PushGroupMarkerEXT(GLsizei length, const GLchar *marker);
     void            PopGroupMarkerEXT(void);
+    void            DrawArraysInstancedEXT(GLenum mode, GLint start, GLsizei count, GLsizei primcount);
+    void            DrawElementsInstancedEXT(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount);
+    void            VertexAttribDivisorEXT(GLuint index, GLuint divisor);
+    void            MultiDrawArraysEXT(GLenum mode, const GLint *first, const GLsizei *count, GLsizei primcount);
+    void            MultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei primcount);
+    void            DrawArraysIndirect(GLenum mode, const void *indirect);
+    void            DrawElementsIndirect(GLenum mode, GLenum type, const void *indirect);
+    void            MultiDrawArraysIndirectEXT(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride);
+    void            MultiDrawElementsIndirectEXT(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
     void            GetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
     void            ProgramBinaryOES(GLuint program, GLenum binaryFormat, const void *binary, GLint length);
+    void            DiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum *attachments);
+    void            RenderbufferStorageMultisampleEXT(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+    void            FramebufferTexture2DMultisampleEXT(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples);
+    void            FramebufferTextureMultiviewOVR(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews);
+    void            BlitFramebufferANGLE(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+    void            BlitFramebufferNV(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+    void            TexStorage2DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+    void*           MapBufferOES(GLenum target, GLenum access);
+    GLboolean       UnmapBufferOES(GLenum target);
+    void            GetBufferPointervOES(GLenum target, GLenum pname, void **params);
+    void*           MapBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    void            FlushMappedBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length);
+    void            GetPerfMonitorGroupsAMD(GLint *numGroups, GLsizei groupsSize, GLuint *groups);
+    void            GetPerfMonitorCountersAMD(GLuint group, GLint *numCounters, GLint *maxActiveCounters, GLsizei counterSize, GLuint *counters);
+    void            GetPerfMonitorGroupStringAMD(GLuint group, GLsizei bufSize, GLsizei *length, GLchar *groupString);
+    void            GetPerfMonitorCounterStringAMD(GLuint group, GLuint counter, GLsizei bufSize, GLsizei *length, GLchar *counterString);
+    void            GetPerfMonitorCounterInfoAMD(GLuint group, GLuint counter, GLenum pname, void *data);
+    void            GenPerfMonitorsAMD(GLsizei n, GLuint *monitors);
+    void            DeletePerfMonitorsAMD(GLsizei n, GLuint *monitors);
+    void            SelectPerfMonitorCountersAMD(GLuint monitor, GLboolean enable, GLuint group, GLint numCounters, GLuint *counterList);
+    void            BeginPerfMonitorAMD(GLuint monitor);
+    void            EndPerfMonitorAMD(GLuint monitor);
+    void            GetPerfMonitorCounterDataAMD(GLuint monitor, GLenum pname, GLsizei dataSize, GLuint *data, GLint *bytesWritten);
+    void            GenVertexArraysOES(GLsizei n, GLuint *arrays);
+    void            DeleteVertexArraysOES(GLsizei n, const GLuint *arrays);
+    GLboolean       IsVertexArrayOES(GLuint array);
+    void            BindVertexArrayOES(GLuint array);
+
+  /// Command Bundle Functions
+    void            GenCommandBundlesGLOVE(GLsizei n, GLuint *bundles);
+    void            DeleteCommandBundlesGLOVE(GLsizei n, const GLuint *bundles);
+    void            BeginCommandBundleGLOVE(GLuint bundle);
+    void            EndCommandBundleGLOVE(void);
+    void            CallCommandBundleGLOVE(GLuint bundle);
+
+  /// Compute Functions
+    void            DispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+    void            MemoryBarrier(GLbitfield barriers);
+    void            BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void            BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+  /// Transform Feedback Functions
+    void            TransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode);
+    void            BeginTransformFeedback(GLenum primitiveMode);
+    void            EndTransformFeedback(void);
+
+  /// Primitive Restart Functions
+    void            DrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices);
+
+  /// Uniform Buffer Functions
+    GLuint          GetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName);
+    void            UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  /// Query Functions
+    void            GenQueriesEXT(GLsizei n, GLuint *ids);
+    void            DeleteQueriesEXT(GLsizei n, const GLuint *ids);
+    GLboolean       IsQueryEXT(GLuint id);
+    void            BeginQueryEXT(GLenum target, GLuint id);
+    void            EndQueryEXT(GLenum target);
+    void            QueryCounterEXT(GLuint id, GLenum target);
+    void            GetQueryivEXT(GLenum target, GLenum pname, GLint *params);
+    void            GetQueryObjectivEXT(GLuint id, GLenum pname, GLint *params);
+    void            GetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint *params);
+    void            GetQueryObjecti64vEXT(GLuint id, GLenum pname, GLint64 *params);
+    void            GetQueryObjectui64vEXT(GLuint id, GLenum pname, GLuint64 *params);
 
 };
 
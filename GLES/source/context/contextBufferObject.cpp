@@ -28,7 +28,7 @@ Context::BindBuffer(GLenum target, GLuint buffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER) {
+    if(!mNoError && !IsBufferTarget(target)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -36,8 +36,10 @@ Context::BindBuffer(GLenum target, GLuint buffer)
     BufferObject *bo = nullptr;
     if(buffer) {
         bo = mResourceManager->GetBuffer(buffer);
-        bo->SetTarget(target);
+        bo->SetCacheManager(mCacheManager);
+        // the usage the buffer is created with depends on the extensions of the device
         bo->SetVkContext(mVkContext);
+        bo->SetTarget(target);
         bo->Bind();
     }
 
@@ -49,6 +51,15 @@ Context::BindBuffer(GLenum target, GLuint buffer)
 
     mStateManager.GetActiveObjectsState()->SetActiveBufferObject(target, bo);
 
+    if(target == GL_PIXEL_PACK_BUFFER_NV || target == GL_PIXEL_UNPACK_BUFFER_NV) {
+        return;
+    }
+
+    // pixels read back into the buffer are about to be drawn with
+    if(bo) {
+        FinishBufferReadbacks(bo);
+    }
+
     if(target == GL_ELEMENT_ARRAY_BUFFER || (bo && bo->IsIndexBuffer())) {
         mPipeline->SetUpdateIndexBuffer(true);
     }
@@ -59,7 +70,7 @@ Context::BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usa
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER) {
+    if(!IsBufferTarget(target)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -81,13 +92,28 @@ Context::BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usa
     }
 
     bo->SetUsage(usage);
-    if((data && bo->HasData()) || (data == nullptr && bo->GetSize() && (size_t)size != bo->GetSize())) {
-        bo->Release();
+    VkBuffer vkBuffer = bo->GetVkBuffer();
+
+    // streaming buffers respecified at the same size rotate through their
+    // backings instead of being reallocated under frames still reading them
+    if((usage == GL_STREAM_DRAW || usage == GL_DYNAMIC_DRAW) && bo->HasData() && (size_t)size == bo->GetSize()) {
+        if(!bo->Respecify(size, data)) {
+            RecordError(GL_OUT_OF_MEMORY);
+            return;
+        }
+    } else {
+        if(bo->HasData()) {
+            bo->Release();
+        }
+
+        if(!bo->Allocate(size, data)) {
+            RecordError(GL_OUT_OF_MEMORY);
+            return;
+        }
     }
 
-    if(!bo->Allocate(size, data)) {
-        RecordError(GL_OUT_OF_MEMORY);
-        return;
+    if(vkBuffer != bo->GetVkBuffer()) {
+        mPipeline->SetUpdateVertexAttribVBOs(true);
     }
 
     if(target == GL_ELEMENT_ARRAY_BUFFER || bo->IsIndexBuffer()) {
@@ -100,24 +126,40 @@ Context::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const vo
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER) {
+    if(!mNoError && !IsBufferTarget(target)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
     BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
-    if(!bo) {
+    if(!mNoError && !bo) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
-    if(size < 0 || offset < 0 || (uint32_t)size + (uint32_t)offset > (uint32_t)bo->GetSize()) {
+    if(!mNoError && (size < 0 || offset < 0 || (uint32_t)size + (uint32_t)offset > (uint32_t)bo->GetSize())) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
+    if(!mNoError && bo->IsMapped()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // pending readbacks must not land on top of the new contents, nor the host copy
+    // the rest of the buffer is carried over with lag behind what compute shaders have written
+    FinishBufferDeviceWrites(bo);
+    FinishBufferReadbacks(bo);
+
+    VkBuffer vkBuffer = bo->GetVkBuffer();
     bo->UpdateData(size, offset, data);
 
+    // buffers still referred to by recorded draws are renamed on update
+    if(vkBuffer != bo->GetVkBuffer()) {
+        mPipeline->SetUpdateVertexAttribVBOs(true);
+    }
+
     if(target == GL_ELEMENT_ARRAY_BUFFER || bo->IsIndexBuffer()) {
         mPipeline->SetUpdateIndexBuffer(true);
     }
@@ -137,10 +179,7 @@ Context::DeleteBuffers(GLsizei n, const GLuint* buffers)
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
-        Finish();
-    }
-
+    // backings that frames in flight may still read are retired along with them
     while(n-- != 0) {
         uint32_t buffer = *buffers++;
 
@@ -148,9 +187,28 @@ Context::DeleteBuffers(GLsizei n, const GLuint* buffers)
 
             BufferObject *buf = mResourceManager->GetBuffer(buffer);
 
-            if(mStateManager.GetActiveObjectsState()->EqualsActiveBufferObject(buf)) {
-                buf->Unbind();
-                mStateManager.GetActiveObjectsState()->ResetActiveBufferObject(buf->GetTarget());
+            // the buffer may be bound to the pack, unpack, indirect, storage, uniform or transform feedback target on top of its vertex or index one
+            for(GLenum target : {GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_PIXEL_PACK_BUFFER_NV, GL_PIXEL_UNPACK_BUFFER_NV, GL_DRAW_INDIRECT_BUFFER,
+                                 GL_SHADER_STORAGE_BUFFER, GL_UNIFORM_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER}) {
+                if(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target) == buf) {
+                    buf->Unbind();
+                    mStateManager.GetActiveObjectsState()->ResetActiveBufferObject(target);
+                }
+            }
+            for(GLuint index = 0; index < GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS; ++index) {
+                if(mStateManager.GetActiveObjectsState()->GetShaderStorageBuffer(index) == buf) {
+                    mStateManager.GetActiveObjectsState()->SetShaderStorageBinding(index, nullptr, 0, 0);
+                }
+            }
+            for(GLuint index = 0; index < GLOVE_MAX_UNIFORM_BUFFER_BINDINGS; ++index) {
+                if(mStateManager.GetActiveObjectsState()->GetUniformBuffer(index) == buf) {
+                    mStateManager.GetActiveObjectsState()->SetUniformBufferBinding(index, nullptr, 0, 0);
+                }
+            }
+            for(GLuint index = 0; index < GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS; ++index) {
+                if(mStateManager.GetActiveObjectsState()->GetTransformFeedbackBuffer(index) == buf) {
+                    mStateManager.GetActiveObjectsState()->SetTransformFeedbackBinding(index, nullptr, 0, 0);
+                }
             }
             mResourceManager->AddToPurgeList(buf);
             mResourceManager->RemoveFromListBuffer(buffer);
@@ -164,12 +222,12 @@ Context::GetBufferParameteriv(GLenum target, GLenum pname, GLint* params)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER) {
+    if(!IsBufferTarget(target)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    if(pname != GL_BUFFER_SIZE && pname != GL_BUFFER_USAGE) {
+    if(pname != GL_BUFFER_SIZE && pname != GL_BUFFER_USAGE && pname != GL_BUFFER_ACCESS_OES && pname != GL_BUFFER_MAPPED_OES) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -183,6 +241,8 @@ Context::GetBufferParameteriv(GLenum target, GLenum pname, GLint* params)
     switch(pname) {
     case GL_BUFFER_SIZE:  *params = static_cast<GLint>(bo->GetSize());  break;
     case GL_BUFFER_USAGE: *params = static_cast<GLint>(bo->GetUsage()); break;
+    case GL_BUFFER_ACCESS_OES: *params = GL_WRITE_ONLY_OES; break;
+    case GL_BUFFER_MAPPED_OES: *params = bo->IsMapped() ? GL_TRUE : GL_FALSE; break;
     }
 }
 
@@ -213,3 +273,194 @@ Context::IsBuffer(GLuint buffer)
 
     return (buffer != 0 && mResourceManager->BufferExists(buffer)) ? GL_TRUE : GL_FALSE;
 }
+
+void
+Context::FinishBufferReadbacks(BufferObject *bo)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!bo->HasPendingReadbacks()) {
+        return;
+    }
+
+    // readbacks complete along with the draw submission they were recorded in,
+    // only the frame still being recorded needs to be flushed for them
+    STALL_REASON(STALL_REASON_BUFFER_READBACK);
+    const uint64_t serial = bo->GetReadbackSerial();
+    if(serial >= mCommandBufferManager->GetSubmitSerial()) {
+        Finish();
+    } else {
+        mCommandBufferManager->WaitVkSerial(serial);
+    }
+
+    VkBuffer vkBuffer = bo->GetVkBuffer();
+    if(!bo->ResolveReadbacks()) {
+        RecordError(GL_OUT_OF_MEMORY);
+    }
+
+    if(vkBuffer != bo->GetVkBuffer()) {
+        mPipeline->SetUpdateVertexAttribVBOs(true);
+        mPipeline->SetUpdateIndexBuffer(true);
+    }
+}
+
+void *
+Context::MapBufferOES(GLenum target, GLenum access)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target) ||
+        access != GL_WRITE_ONLY_OES) {
+        RecordError(GL_INVALID_ENUM);
+        return nullptr;
+    }
+
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(!bo || bo->IsMapped()) {
+        RecordError(GL_INVALID_OPERATION);
+        return nullptr;
+    }
+
+    FinishBufferDeviceWrites(bo);
+    FinishBufferReadbacks(bo);
+
+    void *ptr = bo->Map(0, bo->GetSize(), GL_MAP_WRITE_BIT_EXT);
+    if(!ptr) {
+        RecordError(GL_OUT_OF_MEMORY);
+    }
+
+    return ptr;
+}
+
+void *
+Context::MapBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target)) {
+        RecordError(GL_INVALID_ENUM);
+        return nullptr;
+    }
+
+    const GLbitfield accessBits = GL_MAP_READ_BIT_EXT              | GL_MAP_WRITE_BIT_EXT             |
+                                  GL_MAP_INVALIDATE_RANGE_BIT_EXT  | GL_MAP_INVALIDATE_BUFFER_BIT_EXT |
+                                  GL_MAP_FLUSH_EXPLICIT_BIT_EXT    | GL_MAP_UNSYNCHRONIZED_BIT_EXT;
+    if(offset < 0 || length < 0 || (access & ~accessBits)) {
+        RecordError(GL_INVALID_VALUE);
+        return nullptr;
+    }
+
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(!bo) {
+        RecordError(GL_INVALID_OPERATION);
+        return nullptr;
+    }
+
+    if(static_cast<size_t>(offset) + static_cast<size_t>(length) > bo->GetSize()) {
+        RecordError(GL_INVALID_VALUE);
+        return nullptr;
+    }
+
+    if(!length || bo->IsMapped() || !(access & (GL_MAP_READ_BIT_EXT | GL_MAP_WRITE_BIT_EXT)) ||
+       ((access & GL_MAP_READ_BIT_EXT) &&
+        (access & (GL_MAP_INVALIDATE_RANGE_BIT_EXT | GL_MAP_INVALIDATE_BUFFER_BIT_EXT | GL_MAP_UNSYNCHRONIZED_BIT_EXT))) ||
+       ((access & GL_MAP_FLUSH_EXPLICIT_BIT_EXT) && !(access & GL_MAP_WRITE_BIT_EXT))) {
+        RecordError(GL_INVALID_OPERATION);
+        return nullptr;
+    }
+
+    // readbacks still in flight are dropped along with the contents they were meant for,
+    // otherwise mapping waits on them and converts their pixels into the buffer
+    if(access & GL_MAP_INVALIDATE_BUFFER_BIT_EXT) {
+        bo->DiscardReadbacks();
+    } else {
+        FinishBufferDeviceWrites(bo);
+        FinishBufferReadbacks(bo);
+    }
+
+    VkBuffer vkBuffer = bo->GetVkBuffer();
+    void *ptr = bo->Map(offset, length, access);
+    if(!ptr) {
+        RecordError(GL_OUT_OF_MEMORY);
+    }
+
+    // invalidated buffers still referred to by recorded draws are renamed on map
+    if(vkBuffer != bo->GetVkBuffer()) {
+        mPipeline->SetUpdateVertexAttribVBOs(true);
+        mPipeline->SetUpdateIndexBuffer(true);
+    }
+
+    return ptr;
+}
+
+void
+Context::FlushMappedBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target)) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(!bo || !bo->IsMapped() || !(bo->GetMapAccess() & GL_MAP_FLUSH_EXPLICIT_BIT_EXT)) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(offset < 0 || length < 0 || static_cast<size_t>(offset) + static_cast<size_t>(length) > bo->GetMapLength()) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // the range is written back to the buffer, renaming it if needed, on unmap
+    bo->FlushMappedRange(offset, length);
+}
+
+GLboolean
+Context::UnmapBufferOES(GLenum target)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target)) {
+        RecordError(GL_INVALID_ENUM);
+        return GL_FALSE;
+    }
+
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(!bo || !bo->IsMapped()) {
+        RecordError(GL_INVALID_OPERATION);
+        return GL_FALSE;
+    }
+
+    VkBuffer vkBuffer = bo->GetVkBuffer();
+    bo->Unmap();
+
+    if(vkBuffer != bo->GetVkBuffer()) {
+        mPipeline->SetUpdateVertexAttribVBOs(true);
+        mPipeline->SetUpdateIndexBuffer(true);
+    }
+
+    return GL_TRUE;
+}
+
+void
+Context::GetBufferPointervOES(GLenum target, GLenum pname, void **params)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target) ||
+        pname != GL_BUFFER_MAP_POINTER_OES) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(!bo) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    *params = bo->GetMapPointer();
+}
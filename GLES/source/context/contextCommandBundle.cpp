@@ -0,0 +1,265 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       contextCommandBundle.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES API calls related to Command Bundles (GL_GLOVE_command_bundle)
+ *
+ *  @section
+ *
+ *  The draws issued while a bundle is begun go through the same translation
+ *  as any other draw, but are recorded into the secondary command buffer of
+ *  the bundle, with their data written into its rings (see
+ *  vulkanAPI::CommandBundle). Calling the bundle ends the render pass of the
+ *  bound framebuffer, executes the bundle in one that loads what was drawn
+ *  so far, and resumes rendering in a new one, as a copy out of the
+ *  framebuffer does.
+ *
+ */
+
+#include "context.h"
+
+void
+Context::GenCommandBundlesGLOVE(GLsizei n, GLuint *bundles)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(bundles == nullptr) {
+        return;
+    }
+
+    // the names are reserved, the objects are created when first begun
+    for(GLsizei i = 0; i < n; ++i) {
+        bundles[i] = mNextCommandBundleId++;
+        mCommandBundles[bundles[i]] = nullptr;
+    }
+}
+
+void
+Context::DeleteCommandBundlesGLOVE(GLsizei n, const GLuint *bundles)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(bundles == nullptr) {
+        return;
+    }
+
+    for(GLsizei i = 0; i < n; ++i) {
+        auto it = mCommandBundles.find(bundles[i]);
+        if(bundles[i] == 0 || it == mCommandBundles.end()) {
+            continue;
+        }
+
+        vulkanAPI::CommandBundle *bundle = it->second;
+        if(bundle != nullptr) {
+            // deleting the bundle being captured drops what was captured into it
+            if(bundle == mCommandBundle) {
+                mCacheManager->SetCaptureBundle(nullptr);
+                mCommandBundle = nullptr;
+                mDebugGroupDepth -= bundle->GetDebugLabelDepth();
+            }
+            FinishCommandBundle(bundle);
+            delete bundle;
+        }
+        mCommandBundles.erase(it);
+    }
+}
+
+void
+Context::BeginCommandBundleGLOVE(GLuint bundle)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // captured draws bind their transform feedback buffers, which bundles do not record
+    auto it = mCommandBundles.find(bundle);
+    if(mCommandBundle || mTransformFeedback.active || bundle == 0 || it == mCommandBundles.end()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+        RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+        return;
+    }
+
+    if(it->second == nullptr) {
+        it->second = new vulkanAPI::CommandBundle(mVkContext, mCommandBufferManager);
+    }
+
+    // the draws recorded before are replaced, once no frame executes them anymore
+    FinishCommandBundle(it->second);
+
+    // the draws are recorded against the render pass of the framebuffer, which exists once rendering has begun,
+    // with the depth/stencil buffer any of them may test
+    AttachSystemDepthStencil();
+    if(mWriteFBO->IsInIdleState()) {
+        SetClearRect();
+        mWriteFBO->ResetDiscardedAttachments();
+        PrepareRenderPass(false, false, false);
+    }
+
+    if(!it->second->Begin(mWriteFBO->GetRenderPass())) {
+        RecordError(GL_OUT_OF_MEMORY);
+        return;
+    }
+
+    mCommandBundle = it->second;
+    mCacheManager->SetCaptureBundle(mCommandBundle);
+
+    // the buffers bound by the draws are looked up again in the rings of the bundle
+    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mPipeline->SetUpdateIndexBuffer(true);
+}
+
+void
+Context::EndCommandBundleGLOVE(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mCommandBundle) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    vulkanAPI::CommandBundle *bundle = mCommandBundle;
+    mCacheManager->SetCaptureBundle(nullptr);
+    mCommandBundle = nullptr;
+
+    // the groups pushed into the bundle and left open are ended by it, their pops are ignored
+    mDebugGroupDepth -= bundle->GetDebugLabelDepth();
+
+    // and again in the rings of the frame
+    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mPipeline->SetUpdateIndexBuffer(true);
+
+    if(!bundle->End()) {
+        RecordError(GL_OUT_OF_MEMORY);
+    }
+}
+
+void
+Context::CallCommandBundleGLOVE(GLuint bundle)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("CallCommandBundle", "rendering");
+
+    auto it = mCommandBundles.find(bundle);
+    if(mCommandBundle || mTransformFeedback.active || it == mCommandBundles.end() || it->second == nullptr || !it->second->IsRecorded()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+        RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+        return;
+    }
+
+    vulkanAPI::CommandBundle *commandBundle = it->second;
+    if(!commandBundle->GetDrawCount()) {
+        return;
+    }
+
+    // the pipelines the draws bind are those of the cache of the context,
+    // a bundle whose pipelines have been evicted has to be recorded again
+    for(const auto &ref : commandBundle->GetPipelines()) {
+        if(!mCacheManager->TouchVkPipeline(ref.hash, ref.pipeline, true)) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+    }
+
+    // secondary command buffers are executed in a render pass of their own
+    FlushDrawBatch();
+    ResolvePendingClear();
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
+    }
+
+    mWriteFBO->SetStateDraw();
+    SetClearRect();
+    mWriteFBO->ResetDiscardedAttachments();
+    PrepareRenderPass(false, false, false);
+
+    if(commandBundle->IsCompatible(mWriteFBO->GetRenderPass())) {
+        mWriteFBO->BeginVkRenderPass(true);
+        VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+        vkCmdExecuteCommands(activeCmdBuffer, 1, commandBundle->GetVkCommandBuffer());
+        mWriteFBO->EndVkRenderPass();
+
+        commandBundle->SetLastUsedSerial(mCommandBufferManager->GetSubmitSerial());
+        mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_DRAWS, commandBundle->GetDrawCount());
+        mDrawsSinceSubmit += commandBundle->GetDrawCount();
+    } else {
+        RecordError(GL_INVALID_OPERATION);
+    }
+
+    // rendering resumes on the same attachments, with nothing bound after the bundle
+    InvalidateBoundDescriptorSet();
+    BeginRendering(false, false, false);
+}
+
+bool
+Context::PrepareCommandBundleGeometry(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the draws of a bundle are executed in render passes of their own, so they cannot read back the color
+    // the frame has written, and they bind no descriptor set other than their own
+    const ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+    if(program->UsesFramebufferFetch() || program->UsesBindlessTextures()) {
+        return false;
+    }
+
+    if(mWriteFBO->IsInIdleState()) {
+        SetClearRect();
+        mWriteFBO->ResetDiscardedAttachments();
+        PrepareRenderPass(false, false, false);
+    }
+
+    return mCommandBundle->IsCompatible(mWriteFBO->GetRenderPass());
+}
+
+void
+Context::FinishCommandBundle(const vulkanAPI::CommandBundle *bundle)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const uint64_t serial = bundle->GetLastUsedSerial();
+    if(!serial) {
+        return;
+    }
+
+    // only the frame still being recorded needs to be flushed for the bundle
+    STALL_REASON(STALL_REASON_COMMAND_BUNDLE);
+    if(serial >= mCommandBufferManager->GetSubmitSerial()) {
+        Finish();
+    } else {
+        mCommandBufferManager->WaitVkSerial(serial);
+    }
+}
@@ -0,0 +1,347 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       contextCompute.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES API calls related to Compute Shaders (GL_GLOVE_compute_shader)
+ *
+ *  @section
+ *
+ *  A dispatch is recorded into the draw command buffer of the frame, between
+ *  two render passes of the bound framebuffer, as a copy out of it is. Its
+ *  storage buffers are read and written on the device only; it ends with a
+ *  barrier that makes what it has written visible to every later use of the
+ *  buffers, and their host copies are read back only once the host reads them.
+ *  Its uniform blocks read the buffers bound to GL_UNIFORM_BUFFER in place.
+ *
+ */
+
+#include "context.h"
+
+void
+Context::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target) || (target != GL_SHADER_STORAGE_BUFFER && target != GL_UNIFORM_BUFFER && target != GL_TRANSFORM_FEEDBACK_BUFFER)) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    // the buffers captured into are those bound when the capture began
+    if(target == GL_TRANSFORM_FEEDBACK_BUFFER && mTransformFeedback.active) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(index >= (target == GL_SHADER_STORAGE_BUFFER ? GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS :
+                 target == GL_UNIFORM_BUFFER        ? GLOVE_MAX_UNIFORM_BUFFER_BINDINGS        : GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // the generic binding follows the indexed one
+    BindBuffer(target, buffer);
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(target == GL_SHADER_STORAGE_BUFFER) {
+        mStateManager.GetActiveObjectsState()->SetShaderStorageBinding(index, bo, 0, 0);
+    } else if(target == GL_UNIFORM_BUFFER) {
+        mStateManager.GetActiveObjectsState()->SetUniformBufferBinding(index, bo, 0, 0);
+    } else {
+        mStateManager.GetActiveObjectsState()->SetTransformFeedbackBinding(index, bo, 0, 0);
+    }
+}
+
+void
+Context::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsBufferTarget(target) || (target != GL_SHADER_STORAGE_BUFFER && target != GL_UNIFORM_BUFFER && target != GL_TRANSFORM_FEEDBACK_BUFFER)) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    // the buffers captured into are those bound when the capture began
+    if(target == GL_TRANSFORM_FEEDBACK_BUFFER && mTransformFeedback.active) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(target == GL_SHADER_STORAGE_BUFFER) {
+        if(index >= GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS ||
+           (buffer && (offset < 0 || size <= 0 || static_cast<VkDeviceSize>(offset) % mVkContext->vkMinStorageBufferOffsetAlignment))) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+    } else if(target == GL_UNIFORM_BUFFER) {
+        if(index >= GLOVE_MAX_UNIFORM_BUFFER_BINDINGS ||
+           (buffer && (offset < 0 || size <= 0 || static_cast<VkDeviceSize>(offset) % mVkContext->vkMinUniformBufferOffsetAlignment))) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+    } else {
+        // every component captured is 32 bits wide
+        if(index >= GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS ||
+           (buffer && (offset < 0 || size <= 0 || offset % 4 || size % 4))) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+    }
+
+    // the generic binding follows the indexed one
+    BindBuffer(target, buffer);
+    BufferObject *bo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(target);
+    if(target == GL_SHADER_STORAGE_BUFFER) {
+        mStateManager.GetActiveObjectsState()->SetShaderStorageBinding(index, bo, buffer ? offset : 0, buffer ? size : 0);
+    } else if(target == GL_UNIFORM_BUFFER) {
+        mStateManager.GetActiveObjectsState()->SetUniformBufferBinding(index, bo, buffer ? offset : 0, buffer ? size : 0);
+    } else {
+        mStateManager.GetActiveObjectsState()->SetTransformFeedbackBinding(index, bo, buffer ? offset : 0, buffer ? size : 0);
+    }
+}
+
+void
+Context::DispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("DispatchCompute", "rendering");
+
+    // dispatches are never captured into bundles, as these execute in render passes
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+    if(mCommandBundle || !program || !program->IsLinked() || !program->IsCompute()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(num_groups_x > GLOVE_MAX_COMPUTE_WORK_GROUP_COUNT ||
+       num_groups_y > GLOVE_MAX_COMPUTE_WORK_GROUP_COUNT ||
+       num_groups_z > GLOVE_MAX_COMPUTE_WORK_GROUP_COUNT) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // every storage block of the program reads and writes the buffer bound to its binding
+    StateActiveObjects *activeObjects = mStateManager.GetActiveObjectsState();
+    for(uint32_t block : program->GetStorageBlocks()) {
+        const GLuint binding = program->GetStorageBlockBinding(block);
+        const BufferObject *bo = activeObjects->GetShaderStorageBuffer(binding);
+        const size_t offset = static_cast<size_t>(activeObjects->GetShaderStorageOffset(binding));
+        const size_t size   = static_cast<size_t>(activeObjects->GetShaderStorageSize(binding));
+        if(!bo || !bo->HasData() || bo->IsMapped() || offset >= bo->GetSize() || offset + size > bo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+    }
+
+    // and every uniform block reads the whole of it from the range bound to the binding the program has given it
+    for(uint32_t i = 0; i < program->GetUniformBufferBlockCount(); ++i) {
+        const GLuint binding = program->GetUniformBufferBinding(i);
+        const BufferObject *bo = activeObjects->GetUniformBuffer(binding);
+        const size_t offset = static_cast<size_t>(activeObjects->GetUniformBufferOffset(binding));
+        if(!bo || !bo->HasData() || bo->IsMapped() || offset >= bo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+
+        const size_t size = activeObjects->GetUniformBufferSize(binding) ? static_cast<size_t>(activeObjects->GetUniformBufferSize(binding)) : bo->GetSize() - offset;
+        const size_t blockSize = program->GetUniformBufferBlockSize(i);
+        if(offset + size > bo->GetSize() || size < blockSize || blockSize > mVkContext->vkMaxUniformBufferRange) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+    }
+
+    if(!num_groups_x || !num_groups_y || !num_groups_z) {
+        return;
+    }
+
+    program->SetCacheManager(mCacheManager);
+    for(uint32_t block : program->GetStorageBlocks()) {
+        const GLuint binding = program->GetStorageBlockBinding(block);
+        BufferObject *bo = activeObjects->GetShaderStorageBuffer(binding);
+
+        VkDescriptorBufferInfo info;
+        info.buffer = bo->GetVkBuffer();
+        info.offset = static_cast<VkDeviceSize>(activeObjects->GetShaderStorageOffset(binding));
+        info.range  = activeObjects->GetShaderStorageSize(binding) ? static_cast<VkDeviceSize>(activeObjects->GetShaderStorageSize(binding)) : VK_WHOLE_SIZE;
+        program->SetBufferBlockDescriptor(block, info);
+    }
+    // the application buffers are read in place, at the offset they are bound at, for no more bytes than a uniform buffer may range over
+    for(uint32_t i = 0; i < program->GetUniformBufferBlockCount(); ++i) {
+        const GLuint binding = program->GetUniformBufferBinding(i);
+        BufferObject *bo = activeObjects->GetUniformBuffer(binding);
+        const VkDeviceSize offset = static_cast<VkDeviceSize>(activeObjects->GetUniformBufferOffset(binding));
+        const VkDeviceSize size   = activeObjects->GetUniformBufferSize(binding) ? static_cast<VkDeviceSize>(activeObjects->GetUniformBufferSize(binding)) : bo->GetSize() - offset;
+
+        VkDescriptorBufferInfo info;
+        info.buffer = bo->GetVkBuffer();
+        info.offset = offset;
+        info.range  = std::min(size, static_cast<VkDeviceSize>(mVkContext->vkMaxUniformBufferRange));
+        program->SetBufferBlockDescriptor(program->GetUniformBufferBlock(i), info);
+    }
+
+    if(program->HasUniformData()) {
+        program->UpdateDescriptorSet();
+    }
+
+    VkPipeline pipeline = program->GetVkComputePipeline();
+    if(pipeline == VK_NULL_HANDLE) {
+        RecordError(GL_OUT_OF_MEMORY);
+        return;
+    }
+
+    // dispatches run outside of render passes, the one of the framebuffer is split around them
+    FlushDrawBatch();
+    ResolvePendingClear();
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
+    }
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    RecordComputeBarrier(activeCmdBuffer, true);
+
+    vkCmdBindPipeline(activeCmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    if(*program->GetVkDescSet()) {
+        vkCmdBindDescriptorSets(activeCmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, program->GetVkPipelineLayout(), 0, 1, program->GetVkDescSet(),
+                                program->GetVkDynamicOffsetCount(), program->GetVkDynamicOffsets());
+    }
+    program->PushConstants(&activeCmdBuffer);
+    vkCmdDispatch(activeCmdBuffer, num_groups_x, num_groups_y, num_groups_z);
+
+    RecordComputeBarrier(activeCmdBuffer, false);
+
+    // the buffers are referred to by the frame, and their host copies lag behind the ones written
+    for(uint32_t block : program->GetStorageBlocks()) {
+        BufferObject *bo = activeObjects->GetShaderStorageBuffer(program->GetStorageBlockBinding(block));
+        if(program->IsStorageBlockReadOnly(block)) {
+            bo->SetUsed(true);
+        } else {
+            bo->SetDeviceWritten();
+        }
+    }
+    for(uint32_t i = 0; i < program->GetUniformBufferBlockCount(); ++i) {
+        activeObjects->GetUniformBuffer(program->GetUniformBufferBinding(i))->SetUsed(true);
+    }
+    ++mDrawsSinceSubmit;
+
+    // rendering resumes on the same attachments, with nothing bound after the dispatch
+    mWriteFBO->SetStateDraw();
+    SetClearRect();
+    mWriteFBO->ResetDiscardedAttachments();
+    InvalidateBoundDescriptorSet();
+    BeginRendering(false, false, false);
+}
+
+void
+Context::MemoryBarrier(GLbitfield barriers)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const GLbitfield barrierBits = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT |
+                                   GL_UNIFORM_BARRIER_BIT             | GL_TEXTURE_FETCH_BARRIER_BIT |
+                                   GL_COMMAND_BARRIER_BIT             | GL_PIXEL_BUFFER_BARRIER_BIT  |
+                                   GL_BUFFER_UPDATE_BARRIER_BIT       | GL_SHADER_STORAGE_BARRIER_BIT;
+    if(barriers != GL_ALL_BARRIER_BITS && (barriers & ~barrierBits)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // every dispatch already ends with a barrier towards all the uses of what it has written, and the host
+    // copies of the buffers are read back on their first read, so there is nothing left to order
+}
+
+void
+Context::RecordComputeBarrier(VkCommandBuffer cmdBuffer, bool incoming)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the storage buffers are read and written at any of these stages, by draws, dispatches and copies
+    const VkPipelineStageFlags bufferStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT   |
+                                              VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    VkMemoryBarrier barrier;
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+
+    if(incoming) {
+        // the dispatch does not overwrite what earlier commands are still reading
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(cmdBuffer, bufferStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    } else {
+        // and what it writes is seen by whatever reads it next
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, bufferStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+}
+
+void
+Context::FinishBufferDeviceWrites(BufferObject *bo)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!bo->IsDeviceWritten()) {
+        return;
+    }
+
+    // the contents are copied out right after the dispatches that wrote them,
+    // and converted into the host copy once the frame has completed
+    FlushDrawBatch();
+    ResolvePendingClear();
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
+    }
+
+    VkBuffer stagingBuffer = bo->QueueDeviceReadback(mCommandBufferManager->GetSubmitSerial());
+    if(stagingBuffer != VK_NULL_HANDLE) {
+        VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+
+        VkBufferCopy region;
+        region.srcOffset = 0;
+        region.dstOffset = 0;
+        region.size      = bo->GetSize();
+        vkCmdCopyBuffer(activeCmdBuffer, bo->GetVkBuffer(), stagingBuffer, 1, &region);
+
+        VkMemoryBarrier barrier;
+        barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.pNext         = nullptr;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(activeCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    // rendering resumes on the same attachments
+    mWriteFBO->SetStateDraw();
+    SetClearRect();
+    BeginRendering(false, false, false);
+
+    if(stagingBuffer == VK_NULL_HANDLE) {
+        RecordError(GL_OUT_OF_MEMORY);
+        return;
+    }
+
+    FinishBufferReadbacks(bo);
+}
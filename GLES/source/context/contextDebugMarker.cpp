@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       contextDebugMarker.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES API calls related to Debug Markers (GL_EXT_debug_marker)
+ *
+ *  @section
+ *
+ *  Markers and groups become labels of the command buffers they are issued
+ *  into (VK_EXT_debug_utils), so that capture tools and GPU profilers show
+ *  the frame the way the application has named it. A label issued while no
+ *  command buffer is being recorded, or inside a render pass that only takes
+ *  secondary command buffers, is recorded where the next commands go. Within
+ *  a command bundle, labels go into its own command buffer, which ends the
+ *  groups it has begun by itself; popping them afterwards is ignored.
+ *
+ */
+
+#include "context.h"
+
+void
+Context::InsertEventMarkerEXT(GLsizei length, const GLchar *marker)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mVkContext->mIsDebugUtilsSupported) {
+        return;
+    }
+
+    AddDebugLabel(vulkanAPI::DEBUG_LABEL_INSERT, length, marker);
+}
+
+void
+Context::PushGroupMarkerEXT(GLsizei length, const GLchar *marker)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mVkContext->mIsDebugUtilsSupported) {
+        return;
+    }
+
+    ++mDebugGroupDepth;
+    AddDebugLabel(vulkanAPI::DEBUG_LABEL_BEGIN, length, marker);
+}
+
+void
+Context::PopGroupMarkerEXT(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // popping more groups than were pushed is ignored
+    if(!mVkContext->mIsDebugUtilsSupported || !mDebugGroupDepth) {
+        return;
+    }
+
+    --mDebugGroupDepth;
+    AddDebugLabel(vulkanAPI::DEBUG_LABEL_END, 0, nullptr);
+}
+
+void
+Context::AddDebugLabel(vulkanAPI::debugLabelOp_t op, GLsizei length, const GLchar *marker)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a length of 0 means the marker is null terminated
+    std::string name;
+    if(marker) {
+        name = length > 0 ? std::string(marker, static_cast<size_t>(length)) : std::string(marker);
+    }
+
+    if(mCommandBundle && mCommandBundle->AddDebugLabel(op, name.c_str())) {
+        return;
+    }
+
+    mCommandBufferManager->AddVkDebugLabel(op, name.c_str());
+}
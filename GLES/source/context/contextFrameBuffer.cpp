@@ -21,14 +21,17 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
 #include "context.h"
+#include "vulkan/utils.h"
 
 void
 Context::BindFramebuffer(GLenum target, GLuint framebuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_FRAMEBUFFER) {
+    if(target != GL_FRAMEBUFFER && target != GL_DRAW_FRAMEBUFFER_ANGLE && target != GL_READ_FRAMEBUFFER_ANGLE) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -37,18 +40,36 @@ Context::BindFramebuffer(GLenum target, GLuint framebuffer)
     if(framebuffer) {
         fbo = mResourceManager->GetFramebuffer(framebuffer);
         if(fbo->GetTarget() == GL_INVALID_VALUE) {
-            fbo->SetTarget(target);
+            fbo->SetTarget(GL_FRAMEBUFFER);
             fbo->SetVkContext(mVkContext);
             fbo->SetResources(mResourceManager->GetTextureArray(), mResourceManager->GetRenderbufferArray());
         }
     }
 
-    if(mWriteFBO == fbo) {
+    // only blits read from the read framebuffer, everything else goes through the draw one
+    if(target != GL_DRAW_FRAMEBUFFER_ANGLE) {
+        mStateManager.GetActiveObjectsState()->SetActiveReadFramebufferObjectID(framebuffer);
+    }
+
+    if(target == GL_READ_FRAMEBUFFER_ANGLE || mWriteFBO == fbo) {
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
+    ResolvePendingClear();
+
+    // the pass ends here and the next one is recorded in the same command buffer,
+    // the attachments are left in the layout they are sampled or copied from.
+    // Color textures that are not stored upright are inverted on the host when sampled,
+    // so those still need their pass to complete first
+    if(mWriteFBO->IsInDrawState() && mWriteFBO != mSystemFBO && !mWriteFBO->IsStoredUpright()) {
         Finish();
+    } else if(mWriteFBO->IsInDrawState()) {
+        FlushDrawBatch();
+        if(mWriteFBO->EndVkRenderPass()) {
+            VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+            PrepareWriteFBOForReading(&activeCmdBuffer);
+        }
+        mWriteFBO->SetStateIdle();
     }
 
     mWriteFBO = fbo;
@@ -64,14 +85,26 @@ Context::CheckFramebufferStatus(GLenum target)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_FRAMEBUFFER) {
+    if(target != GL_FRAMEBUFFER && target != GL_DRAW_FRAMEBUFFER_ANGLE && target != GL_READ_FRAMEBUFFER_ANGLE) {
         RecordError(GL_INVALID_ENUM);
         return 0;
     }
 
-    return (mStateManager.GetActiveObjectsState()->IsDefaultFramebufferObjectActive()) ?
-            GL_FRAMEBUFFER_COMPLETE :
-            mResourceManager->GetFramebuffer(mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID())->CheckStatus();
+    const GLuint framebuffer = target == GL_READ_FRAMEBUFFER_ANGLE ?
+                               mStateManager.GetActiveObjectsState()->GetActiveReadFramebufferObjectID() :
+                               mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID();
+
+    return framebuffer ? mResourceManager->GetFramebuffer(framebuffer)->CheckStatus() : GL_FRAMEBUFFER_COMPLETE;
+}
+
+Framebuffer *
+Context::GetReadFBO(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const GLuint framebuffer = mStateManager.GetActiveObjectsState()->GetActiveReadFramebufferObjectID();
+
+    return framebuffer ? mResourceManager->GetFramebuffer(framebuffer) : mSystemFBO;
 }
 
 void
@@ -94,17 +127,17 @@ Context::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
         if(fboindex && mResourceManager->FramebufferExists(fboindex)) {
             Framebuffer *fbo = mResourceManager->GetFramebuffer(fboindex);
 
+            // commands recorded for earlier passes may still refer to it
+            if(IsFramebufferPending(fbo)) {
+                Finish();
+            }
+
             //Unbind the attached textures and renderbuffers
             fbo->UnrefAttachment(GL_COLOR_ATTACHMENT0);
             fbo->UnrefAttachment(GL_DEPTH_ATTACHMENT);
             fbo->UnrefAttachment(GL_STENCIL_ATTACHMENT);
 
             if(mWriteFBO == fbo) {
-
-                if(mWriteFBO->IsInDrawState()) {
-                    Finish();
-                }
-
                 mWriteFBO = mSystemFBO;
                 mWriteFBO->SetStateIdle();
 
@@ -112,6 +145,9 @@ Context::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
                 mPipeline->SetUpdatePipeline(true);
                 mPipeline->SetUpdateViewportState(true);
             }
+            if(mStateManager.GetActiveObjectsState()->GetActiveReadFramebufferObjectID() == fboindex) {
+                mStateManager.GetActiveObjectsState()->SetActiveReadFramebufferObjectID(0);
+            }
 
             mResourceManager->DeallocateFramebuffer(fboindex);
         }
@@ -145,7 +181,12 @@ Context::FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum render
         return;
     }
 
-    if(renderbuffer != mWriteFBO->GetAttachmentName(attachment) && mWriteFBO->IsInDrawState()) {
+    // clears issued earlier still apply to the attachment that is replaced
+    if(renderbuffer != mWriteFBO->GetAttachmentName(attachment)) {
+        ResolvePendingClear();
+    }
+
+    if(renderbuffer != mWriteFBO->GetAttachmentName(attachment) && IsFramebufferPending(mWriteFBO)) {
         Finish();
     }
 
@@ -156,6 +197,7 @@ Context::FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum render
 
     switch(attachment) {
     case GL_COLOR_ATTACHMENT0: {
+        ResetColorAttachmentViews();
         int width  = renderbuffer ? mResourceManager->GetRenderbuffer(renderbuffer)->GetTexture()->GetWidth()  : -1;
         int height = renderbuffer ? mResourceManager->GetRenderbuffer(renderbuffer)->GetTexture()->GetHeight() : -1;
         mWriteFBO->SetColorAttachment(width, height);
@@ -217,7 +259,12 @@ Context::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget
         return;
     }
 
-    if(texture && texture != mWriteFBO->GetAttachmentName(attachment) && mWriteFBO->IsInDrawState()) {
+    // clears issued earlier still apply to the attachment that is replaced
+    if(texture != mWriteFBO->GetAttachmentName(attachment)) {
+        ResolvePendingClear();
+    }
+
+    if(texture && texture != mWriteFBO->GetAttachmentName(attachment) && IsFramebufferPending(mWriteFBO)) {
         Finish();
     }
 
@@ -228,6 +275,7 @@ Context::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget
 
     switch(attachment) {
     case GL_COLOR_ATTACHMENT0: {
+        ResetColorAttachmentViews();
         int width  = texture ? mResourceManager->GetTexture(texture)->GetWidth()  : -1;
         int height = texture ? mResourceManager->GetTexture(texture)->GetHeight() : -1;
         mWriteFBO->SetColorAttachment(width, height);
@@ -235,9 +283,15 @@ Context::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget
         mWriteFBO->SetColorAttachmentName(texture);
         mWriteFBO->SetColorAttachmentLayer(texture && mResourceManager->GetTexture(texture)->IsCubeMap() ? textarget : 0);
         mWriteFBO->SetColorAttachmentLevel(0);
+        mWriteFBO->SetColorAttachmentSamples(0);
         mPipeline->SetUpdateViewportState(true);
         break; }
     case GL_DEPTH_ATTACHMENT:
+        // depth only framebuffers, as rendered for shadow maps, take their size from the depth texture
+        if(texture && mWriteFBO->GetColorAttachmentType() == GL_NONE) {
+            mWriteFBO->SetColorAttachment(mResourceManager->GetTexture(texture)->GetWidth(), mResourceManager->GetTexture(texture)->GetHeight());
+            mPipeline->SetUpdateViewportState(true);
+        }
         mWriteFBO->SetDepthAttachmentType(texture ? GL_TEXTURE : GL_NONE);
         mWriteFBO->SetDepthAttachmentName(texture);
         mWriteFBO->SetDepthAttachmentLayer(texture && mResourceManager->GetTexture(texture)->IsCubeMap() ? textarget : 0);
@@ -295,6 +349,8 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
     GLenum name  = 0;
     GLint  level = 0;
     GLenum layer = GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+    GLint  baseViewIndex = 0;
+    GLint  numViews      = 1;
 
     switch(attachment) {
     case GL_COLOR_ATTACHMENT0:
@@ -303,6 +359,8 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
         if(type == GL_TEXTURE) {
             level = fbo->GetColorAttachmentLevel();
             layer = fbo->GetColorAttachmentLayer();
+            baseViewIndex = fbo->GetColorAttachmentBaseViewIndex();
+            numViews      = fbo->GetColorAttachmentNumViews();
         }
         break;
     case GL_DEPTH_ATTACHMENT:
@@ -339,7 +397,9 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
 
     if(type == GL_TEXTURE &&
       (pname != GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE   && pname != GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME        &&
-       pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL && pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_CUBE_MAP_FACE)
+       pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL && pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_CUBE_MAP_FACE &&
+       pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_SAMPLES_EXT &&
+       pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_NUM_VIEWS_OVR && pname != GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_BASE_VIEW_INDEX_OVR)
       ) {
         RecordError(GL_INVALID_ENUM);
         return;
@@ -350,6 +410,9 @@ Context::GetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, G
     case GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME:             *params = static_cast<GLint>(name);   break;
     case GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL:           *params = level;                      break;
     case GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_CUBE_MAP_FACE:   *params = static_cast<GLint>(layer);  break;
+    case GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_SAMPLES_EXT:     *params = fbo->GetAttachmentSamples(attachment); break;
+    case GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_NUM_VIEWS_OVR:   *params = numViews;                   break;
+    case GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_BASE_VIEW_INDEX_OVR: *params = baseViewIndex;          break;
     }
 }
 
@@ -360,3 +423,306 @@ Context::IsFramebuffer(GLuint framebuffer)
 
     return (framebuffer != 0 && mResourceManager->FramebufferExists(framebuffer)) ? GL_TRUE : GL_FALSE;
 }
+
+void
+Context::DiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(target != GL_FRAMEBUFFER) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(numAttachments < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    const bool isSystem = (mWriteFBO == mSystemFBO);
+    bool discardColor   = false;
+    bool discardDepth   = false;
+    bool discardStencil = false;
+
+    // the default framebuffer names its buffers differently from framebuffer objects
+    for(GLsizei i = 0; i < numAttachments; ++i) {
+        if(isSystem) {
+            switch(attachments[i]) {
+            case GL_COLOR_EXT:          discardColor   = true; break;
+            case GL_DEPTH_EXT:          discardDepth   = true; break;
+            case GL_STENCIL_EXT:        discardStencil = true; break;
+            default:                    RecordError(GL_INVALID_ENUM); return;
+            }
+        } else {
+            switch(attachments[i]) {
+            case GL_COLOR_ATTACHMENT0:  discardColor   = true; break;
+            case GL_DEPTH_ATTACHMENT:   discardDepth   = true; break;
+            case GL_STENCIL_ATTACHMENT: discardStencil = true; break;
+            default:                    RecordError(GL_INVALID_ENUM); return;
+            }
+        }
+    }
+
+    // a clear that has not reached the GPU yet is dropped along with the contents it defines
+    DiscardPendingClear(discardColor, discardDepth, discardStencil);
+
+    // color textures can be written by uploads as well, which would not clear the discard
+    if(!isSystem && mWriteFBO->GetColorAttachmentType() == GL_TEXTURE) {
+        discardColor = false;
+    }
+
+    // the store operations of a running render pass are fixed, so the discard
+    // spares the load of the attachments in the pass that follows it
+    mWriteFBO->DiscardAttachments(discardColor, discardDepth, discardStencil);
+}
+
+void
+Context::FramebufferTexture2DMultisampleEXT(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(target != GL_FRAMEBUFFER || attachment != GL_COLOR_ATTACHMENT0) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(samples < 0 || samples > static_cast<GLsizei>(GetMaxVkSampleCount(mVkContext->vkFramebufferSampleCounts))) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    const GLenum pendingError = mStateManager.GetError();
+    FramebufferTexture2D(target, attachment, textarget, texture, level);
+    if(pendingError == GL_NO_ERROR && mStateManager.GetError() != GL_NO_ERROR) {
+        return;
+    }
+
+    // the texture only receives the resolved samples, the multisampled ones are kept by the framebuffer
+    if(texture && samples > 1 && mWriteFBO->GetColorAttachmentName() == texture) {
+        mWriteFBO->SetColorAttachmentSamples(static_cast<GLsizei>(FindSupportedVkSampleCount(mVkContext->vkFramebufferSampleCounts, samples)));
+    }
+}
+
+void
+Context::FramebufferTextureMultiviewOVR(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // textures of several layers are cube maps only, the views are drawn into consecutive faces of the color one
+    if(target != GL_FRAMEBUFFER || attachment != GL_COLOR_ATTACHMENT0) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(!texture) {
+        FramebufferTexture2D(target, attachment, GL_TEXTURE_2D, 0, level);
+        return;
+    }
+
+    if(!mResourceManager->TextureExists(texture) || !mResourceManager->GetTexture(texture)->IsCubeMap()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(level || baseViewIndex < 0 || numViews < 1 || numViews > GetMaxViews() || baseViewIndex + numViews > TEXTURE_CUBE_MAP_LAYERS) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    const GLenum pendingError = mStateManager.GetError();
+    FramebufferTexture2D(target, attachment, GL_TEXTURE_CUBE_MAP_POSITIVE_X + baseViewIndex, texture, level);
+    if(pendingError == GL_NO_ERROR && mStateManager.GetError() != GL_NO_ERROR) {
+        return;
+    }
+
+    // draws are broadcast to the views by the render passes, whose pipelines are created for their view count
+    if(numViews > 1) {
+        mWriteFBO->SetColorAttachmentViews(baseViewIndex, numViews);
+        mPipeline->SetUpdatePipeline(true);
+    }
+}
+
+void
+Context::ResetColorAttachmentViews(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mWriteFBO->GetColorAttachmentNumViews() > 1) {
+        mWriteFBO->SetColorAttachmentViews(0, 1);
+        mPipeline->SetUpdatePipeline(true);
+    }
+}
+
+/// Clips one axis of a blit to the ranges its source and destination may touch, moving
+/// both ends along the blit so that its scale and direction are kept
+static bool
+ClipBlitAxis(GLint *src0, GLint *src1, GLint *dst0, GLint *dst1, GLint srcMin, GLint srcMax, GLint dstMin, GLint dstMax)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(*src0 == *src1 || *dst0 == *dst1) {
+        return false;
+    }
+
+    // the part of the blit inside a range, as a fraction of the blit from its first end
+    auto clip = [](double end0, double end1, double min, double max, double *t0, double *t1) {
+        const double a = (min - end0) / (end1 - end0);
+        const double b = (max - end0) / (end1 - end0);
+        *t0 = std::max(*t0, std::min(a, b));
+        *t1 = std::min(*t1, std::max(a, b));
+    };
+
+    double t0 = 0.0;
+    double t1 = 1.0;
+    clip(*src0, *src1, srcMin, srcMax, &t0, &t1);
+    clip(*dst0, *dst1, dstMin, dstMax, &t0, &t1);
+    if(t0 >= t1) {
+        return false;
+    }
+
+    const GLint s0 = *src0, s1 = *src1, d0 = *dst0, d1 = *dst1;
+    *src0 = static_cast<GLint>(std::lround(s0 + (s1 - s0) * t0));
+    *src1 = static_cast<GLint>(std::lround(s0 + (s1 - s0) * t1));
+    *dst0 = static_cast<GLint>(std::lround(d0 + (d1 - d0) * t0));
+    *dst1 = static_cast<GLint>(std::lround(d0 + (d1 - d0) * t1));
+
+    return *src0 != *src1 && *dst0 != *dst1;
+}
+
+void
+Context::BlitFramebufferANGLE(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the ANGLE blit neither scales nor mirrors, and reads and draws different framebuffers
+    if(srcX1 - srcX0 != dstX1 - dstX0 || srcY1 - srcY0 != dstY1 - dstY0 ||
+       srcX1 < srcX0 || srcY1 < srcY0 || GetReadFBO() == mWriteFBO) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    BlitFramebufferNV(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+void
+Context::BlitFramebufferNV(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mask & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(filter != GL_NEAREST && filter != GL_LINEAR) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(filter == GL_LINEAR && (mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    Framebuffer *readFBO = GetReadFBO();
+    if((readFBO   != mSystemFBO && readFBO->CheckStatus()   != GL_FRAMEBUFFER_COMPLETE) ||
+       (mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE)) {
+        RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+        return;
+    }
+
+    // pixels outside the read framebuffer are not written, nor are the ones outside the scissor box
+    GLint dstMinX = 0;
+    GLint dstMinY = 0;
+    GLint dstMaxX = mWriteFBO->GetWidth();
+    GLint dstMaxY = mWriteFBO->GetHeight();
+    StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
+    if(stateFragmentOperations->GetScissorTestEnabled()) {
+        const Rect scissor = stateFragmentOperations->GetScissorRect();
+        dstMinX = std::max(scissor.x, dstMinX);
+        dstMinY = std::max(scissor.y, dstMinY);
+        dstMaxX = std::min(scissor.x + scissor.width,  dstMaxX);
+        dstMaxY = std::min(scissor.y + scissor.height, dstMaxY);
+    }
+    if(!mask ||
+       !ClipBlitAxis(&srcX0, &srcX1, &dstX0, &dstX1, 0, readFBO->GetWidth(),  dstMinX, dstMaxX) ||
+       !ClipBlitAxis(&srcY0, &srcY1, &dstY0, &dstY1, 0, readFBO->GetHeight(), dstMinY, dstMaxY)) {
+        return;
+    }
+
+    if(mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) {
+        AttachSystemDepthStencil();
+    }
+
+    // the blit is recorded right after the draws it has to see, so the render pass is split
+    // around it instead of drawing a quad per blit. A pass begins first on framebuffers
+    // that have not drawn yet, so that their attachments exist
+    FlushDrawBatch();
+    ResolvePendingClear();
+    SetClearRect();
+    if(mWriteFBO->IsInIdleState()) {
+        BeginRendering(false, false, false);
+    }
+    mWriteFBO->EndVkRenderPass();
+
+    // both framebuffers are blitted in the orientation their images are stored in
+    VkImageBlit imageBlit;
+    memset(static_cast<void *>(&imageBlit), 0, sizeof(imageBlit));
+    imageBlit.srcOffsets[0].x = srcX0;
+    imageBlit.srcOffsets[0].y = readFBO->IsStoredUpright()   ? srcY0 : readFBO->GetHeight()   - srcY0;
+    imageBlit.srcOffsets[1].x = srcX1;
+    imageBlit.srcOffsets[1].y = readFBO->IsStoredUpright()   ? srcY1 : readFBO->GetHeight()   - srcY1;
+    imageBlit.srcOffsets[1].z = 1;
+    imageBlit.dstOffsets[0].x = dstX0;
+    imageBlit.dstOffsets[0].y = mWriteFBO->IsStoredUpright() ? dstY0 : mWriteFBO->GetHeight() - dstY0;
+    imageBlit.dstOffsets[1].x = dstX1;
+    imageBlit.dstOffsets[1].y = mWriteFBO->IsStoredUpright() ? dstY1 : mWriteFBO->GetHeight() - dstY1;
+    imageBlit.dstOffsets[1].z = 1;
+    imageBlit.srcSubresource.layerCount = 1;
+    imageBlit.dstSubresource.layerCount = 1;
+
+    // multisampled framebuffers are resolved into their attachments at the end of each pass,
+    // so the blit always reads single sampled images
+    const uint64_t  serial          = mCommandBufferManager->GetSubmitSerial();
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    const VkFilter  vkFilter        = filter == GL_LINEAR ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+    Texture *srcColor = readFBO->GetColorAttachmentTexture();
+    Texture *dstColor = mWriteFBO->GetColorAttachmentTexture();
+    if((mask & GL_COLOR_BUFFER_BIT) && srcColor && dstColor) {
+        imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        if(dstColor->BlitFromVkImage(&activeCmdBuffer, srcColor, &imageBlit, vkFilter)) {
+            srcColor->SetLastUsedSerial(mShareGroupSlot, serial);
+            dstColor->SetLastUsedSerial(mShareGroupSlot, serial);
+        }
+    }
+
+    Texture *srcDepthStencil = readFBO->GetDepthStencilAttachmentTexture();
+    Texture *dstDepthStencil = mWriteFBO->GetDepthStencilAttachmentTexture();
+    if((mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) && srcDepthStencil && dstDepthStencil) {
+        const VkFormat vkformat = srcDepthStencil->GetVkFormat();
+        VkImageAspectFlags aspect = 0;
+        if((mask & GL_DEPTH_BUFFER_BIT) && VkFormatIsDepth(vkformat)) {
+            aspect |= VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+        if((mask & GL_STENCIL_BUFFER_BIT) && VkFormatIsStencil(vkformat)) {
+            aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+
+        imageBlit.srcSubresource.aspectMask = aspect;
+        imageBlit.dstSubresource.aspectMask = aspect;
+        if(vkformat != dstDepthStencil->GetVkFormat()) {
+            RecordError(GL_INVALID_OPERATION);
+        } else if(aspect && dstDepthStencil->BlitFromVkImage(&activeCmdBuffer, srcDepthStencil, &imageBlit, VK_FILTER_NEAREST)) {
+            srcDepthStencil->SetLastUsedSerial(mShareGroupSlot, serial);
+            dstDepthStencil->SetLastUsedSerial(mShareGroupSlot, serial);
+        }
+    }
+    readFBO->SetLastUsedSerial(serial);
+
+    // rendering resumes on the same attachments, loading what the blit wrote
+    mWriteFBO->ResetDiscardedAttachments();
+    mWriteFBO->SetStateDraw();
+    BeginRendering(false, false, false);
+}
@@ -0,0 +1,321 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       contextPerfMonitor.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES API calls related to Performance Monitors (GL_AMD_performance_monitor)
+ *
+ *  @section
+ *
+ *  The counters of the Vulkan backend form a single group, each one an
+ *  unsigned 64-bit value (see vulkanAPI::PerfCounters). They are counted on
+ *  the CPU as the work is recorded and submitted, so a monitor samples them
+ *  when it begins and ends and its result is available without a wait.
+ *
+ */
+
+#include <algorithm>
+#include "context.h"
+
+/// The one counter group, holding every counter of vulkanAPI::PerfCounters
+#define GLOVE_PERF_MONITOR_GROUP                        0
+#define GLOVE_PERF_MONITOR_GROUP_NAME                   "GLOVE"
+
+void
+Context::CopyPerfMonitorString(const char *string, GLsizei bufSize, GLsizei *length, GLchar *dst)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the length excludes the terminator, and is all that is returned without a buffer
+    const GLsizei stringLength = static_cast<GLsizei>(strlen(string));
+    if(dst == nullptr || bufSize <= 0) {
+        if(length) {
+            *length = stringLength;
+        }
+        return;
+    }
+
+    const GLsizei copied = std::min(stringLength, bufSize - 1);
+    memcpy(dst, string, copied);
+    dst[copied] = '\0';
+
+    if(length) {
+        *length = copied;
+    }
+}
+
+void
+Context::GetPerfMonitorGroupsAMD(GLint *numGroups, GLsizei groupsSize, GLuint *groups)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(numGroups) {
+        *numGroups = 1;
+    }
+
+    if(groups && groupsSize > 0) {
+        groups[0] = GLOVE_PERF_MONITOR_GROUP;
+    }
+}
+
+void
+Context::GetPerfMonitorCountersAMD(GLuint group, GLint *numCounters, GLint *maxActiveCounters, GLsizei counterSize, GLuint *counters)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(group != GLOVE_PERF_MONITOR_GROUP) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // counting costs the same whichever counters are selected, so all of them can be active at once
+    if(numCounters) {
+        *numCounters = vulkanAPI::PERF_COUNTER_COUNT;
+    }
+
+    if(maxActiveCounters) {
+        *maxActiveCounters = vulkanAPI::PERF_COUNTER_COUNT;
+    }
+
+    if(counters) {
+        for(GLsizei i = 0; i < counterSize && i < vulkanAPI::PERF_COUNTER_COUNT; ++i) {
+            counters[i] = static_cast<GLuint>(i);
+        }
+    }
+}
+
+void
+Context::GetPerfMonitorGroupStringAMD(GLuint group, GLsizei bufSize, GLsizei *length, GLchar *groupString)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(group != GLOVE_PERF_MONITOR_GROUP) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    CopyPerfMonitorString(GLOVE_PERF_MONITOR_GROUP_NAME, bufSize, length, groupString);
+}
+
+void
+Context::GetPerfMonitorCounterStringAMD(GLuint group, GLuint counter, GLsizei bufSize, GLsizei *length, GLchar *counterString)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(group != GLOVE_PERF_MONITOR_GROUP || counter >= vulkanAPI::PERF_COUNTER_COUNT) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    CopyPerfMonitorString(vulkanAPI::PerfCounters::GetName(static_cast<vulkanAPI::perfCounter_t>(counter)), bufSize, length, counterString);
+}
+
+void
+Context::GetPerfMonitorCounterInfoAMD(GLuint group, GLuint counter, GLenum pname, void *data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(group != GLOVE_PERF_MONITOR_GROUP || counter >= vulkanAPI::PERF_COUNTER_COUNT) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    switch(pname) {
+    case GL_COUNTER_TYPE_AMD:
+        *static_cast<GLenum *>(data) = GL_UNSIGNED_INT64_AMD;
+        break;
+    case GL_COUNTER_RANGE_AMD:
+        static_cast<uint64_t *>(data)[0] = 0;
+        static_cast<uint64_t *>(data)[1] = UINT64_MAX;
+        break;
+    default:
+        RecordError(GL_INVALID_ENUM);
+        break;
+    }
+}
+
+void
+Context::GenPerfMonitorsAMD(GLsizei n, GLuint *monitors)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    for(GLsizei i = 0; i < n; ++i) {
+        PerfMonitor_t monitor;
+        memset(static_cast<void *>(&monitor), 0, sizeof(monitor));
+
+        monitors[i] = mNextPerfMonitorId++;
+        mPerfMonitors[monitors[i]] = monitor;
+    }
+}
+
+void
+Context::DeletePerfMonitorsAMD(GLsizei n, GLuint *monitors)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    for(GLsizei i = 0; i < n; ++i) {
+        mPerfMonitors.erase(monitors[i]);
+    }
+}
+
+void
+Context::SelectPerfMonitorCountersAMD(GLuint monitor, GLboolean enable, GLuint group, GLint numCounters, GLuint *counterList)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mPerfMonitors.find(monitor);
+    if(it == mPerfMonitors.end() || group != GLOVE_PERF_MONITOR_GROUP || numCounters < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    uint32_t mask = 0;
+    for(GLint i = 0; i < numCounters; ++i) {
+        if(counterList[i] >= vulkanAPI::PERF_COUNTER_COUNT) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+        mask |= 1u << counterList[i];
+    }
+
+    PerfMonitor_t &perfMonitor = it->second;
+    perfMonitor.selectedMask = enable ? (perfMonitor.selectedMask | mask) : (perfMonitor.selectedMask & ~mask);
+
+    // the outstanding result no longer matches the selection
+    perfMonitor.resultAvailable = false;
+}
+
+void
+Context::BeginPerfMonitorAMD(GLuint monitor)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mPerfMonitors.find(monitor);
+    if(it == mPerfMonitors.end()) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    PerfMonitor_t &perfMonitor = it->second;
+    if(perfMonitor.active) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    mVkContext->perfCounters->GetTotals(perfMonitor.begin);
+    perfMonitor.active          = true;
+    perfMonitor.resultAvailable = false;
+}
+
+void
+Context::EndPerfMonitorAMD(GLuint monitor)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mPerfMonitors.find(monitor);
+    if(it == mPerfMonitors.end()) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    PerfMonitor_t &perfMonitor = it->second;
+    if(!perfMonitor.active) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    uint64_t totals[vulkanAPI::PERF_COUNTER_COUNT];
+    mVkContext->perfCounters->GetTotals(totals);
+    // the gauges report the value at the end of the monitoring
+    for(uint32_t i = 0; i < vulkanAPI::PERF_COUNTER_COUNT; ++i) {
+        perfMonitor.result[i] = vulkanAPI::PerfCounters::IsGauge(static_cast<vulkanAPI::perfCounter_t>(i)) ? totals[i] : totals[i] - perfMonitor.begin[i];
+    }
+
+    perfMonitor.active          = false;
+    perfMonitor.resultAvailable = true;
+}
+
+void
+Context::GetPerfMonitorCounterDataAMD(GLuint monitor, GLenum pname, GLsizei dataSize, GLuint *data, GLint *bytesWritten)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mPerfMonitors.find(monitor);
+    if(it == mPerfMonitors.end()) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    const PerfMonitor_t &perfMonitor = it->second;
+
+    GLuint selectedCount = 0;
+    for(uint32_t i = 0; i < vulkanAPI::PERF_COUNTER_COUNT; ++i) {
+        selectedCount += (perfMonitor.selectedMask >> i) & 1u;
+    }
+
+    // each result is the group, the counter and the 64-bit value, in this order
+    const GLsizei resultSize = 2 * sizeof(GLuint) + sizeof(uint64_t);
+    GLsizei written = 0;
+
+    switch(pname) {
+    case GL_PERFMON_RESULT_AVAILABLE_AMD:
+        if(dataSize >= static_cast<GLsizei>(sizeof(GLuint))) {
+            data[0] = perfMonitor.resultAvailable ? GL_TRUE : GL_FALSE;
+            written = sizeof(GLuint);
+        }
+        break;
+    case GL_PERFMON_RESULT_SIZE_AMD:
+        if(dataSize >= static_cast<GLsizei>(sizeof(GLuint))) {
+            data[0] = perfMonitor.resultAvailable ? selectedCount * resultSize : 0;
+            written = sizeof(GLuint);
+        }
+        break;
+    case GL_PERFMON_RESULT_AMD:
+        if(!perfMonitor.resultAvailable) {
+            break;
+        }
+        for(uint32_t i = 0; i < vulkanAPI::PERF_COUNTER_COUNT && written + resultSize <= dataSize; ++i) {
+            if(!(perfMonitor.selectedMask & (1u << i))) {
+                continue;
+            }
+
+            GLuint *result = data + written / sizeof(GLuint);
+            result[0] = GLOVE_PERF_MONITOR_GROUP;
+            result[1] = i;
+            memcpy(&result[2], &perfMonitor.result[i], sizeof(uint64_t));
+            written += resultSize;
+        }
+        break;
+    default:
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(bytesWritten) {
+        *bytesWritten = written;
+    }
+}
@@ -0,0 +1,330 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       contextQuery.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES API calls related to Queries (GL_EXT_disjoint_timer_query, GL_EXT_occlusion_query_boolean)
+ *
+ *  @section
+ *
+ *  A timer query is made of the timestamps the draw command buffer writes into
+ *  the query pool of its frame (see vulkanAPI::CommandBufferManager). Inside a
+ *  render pass no timestamp can be written among the secondary command
+ *  buffers, so a query begun or ended there takes the timestamps written at
+ *  the begin and the end of that render pass.
+ *
+ *  An occlusion query is made of one Vulkan occlusion query for every render
+ *  pass drawn while it is active. Whatever cannot be counted exactly counts as
+ *  samples passed, so that an object is never culled wrongly.
+ *
+ *  The results arrive with their frame: asking whether they are available
+ *  only polls the fences of the frames in flight, and only asking for the
+ *  result itself waits for them.
+ *
+ */
+
+#include <algorithm>
+#include "context.h"
+
+static inline bool
+IsOcclusionQueryTarget(GLenum target)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return target == GL_ANY_SAMPLES_PASSED_EXT || target == GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT;
+}
+
+std::shared_ptr<vulkanAPI::Timestamp_t>
+Context::WriteTimerQueryTimestamp(bool begin)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mCommandBufferManager->IsInRenderPass()) {
+        return begin ? mCommandBufferManager->GetRenderPassBeginTimestamp() : mCommandBufferManager->GetRenderPassEndTimestamp();
+    }
+
+    if(!mCommandBufferManager->IsActiveCommandBufferRecording()) {
+        AcquireDrawCommandBuffer();
+    }
+
+    return mCommandBufferManager->WriteVkTimestamp(begin ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+bool
+Context::GetQueryObjectResult(GLuint id, GLenum pname, uint64_t *result)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mQueries.find(id);
+    if(it == mQueries.end() || it->second.target == 0 || id == mActiveTimeElapsedQuery || id == mActiveOcclusionQuery) {
+        RecordError(GL_INVALID_OPERATION);
+        return false;
+    }
+
+    if(pname != GL_QUERY_RESULT_EXT && pname != GL_QUERY_RESULT_AVAILABLE_EXT) {
+        RecordError(GL_INVALID_ENUM);
+        return false;
+    }
+
+    // an occlusion query is complete once all its Vulkan queries are, a timer query once its end timestamp is
+    const Query_t &query = it->second;
+    const bool isOcclusion = IsOcclusionQueryTarget(query.target);
+    auto isAvailable = [&query, isOcclusion]() {
+        return isOcclusion ? query.occlusion->pendingQueries == 0 : query.end->available;
+    };
+    const uint64_t serial = isOcclusion ? query.occlusion->serial : query.end->serial;
+    STALL_REASON(STALL_REASON_QUERY_RESULT);
+
+    // the frame holding the query is submitted first, so that polling it eventually succeeds
+    if(!isAvailable() && serial >= mCommandBufferManager->GetSubmitSerial()) {
+        Flush();
+    }
+
+    if(pname == GL_QUERY_RESULT_AVAILABLE_EXT) {
+        if(!isAvailable()) {
+            mCommandBufferManager->PollVkQueries();
+        }
+
+        *result = isAvailable() ? GL_TRUE : GL_FALSE;
+        return true;
+    }
+
+    if(!isAvailable()) {
+        mCommandBufferManager->WaitVkSerial(serial);
+    }
+
+    if(isOcclusion) {
+        *result = query.occlusion->anySamplesPassed ? GL_TRUE : GL_FALSE;
+        return true;
+    }
+
+    const float    period = mVkContext->vkTimestampPeriod;
+    const uint64_t mask   = mVkContext->vkTimestampValidBits >= 64 ? UINT64_MAX : (1ull << mVkContext->vkTimestampValidBits) - 1;
+    const uint64_t ticks  = query.target == GL_TIME_ELAPSED_EXT ? (query.end->ticks - query.begin->ticks) & mask : query.end->ticks;
+
+    *result = static_cast<uint64_t>(static_cast<double>(ticks) * period);
+    return true;
+}
+
+void
+Context::GenQueriesEXT(GLsizei n, GLuint *ids)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    for(GLsizei i = 0; i < n; ++i) {
+        Query_t query;
+        query.target = 0;
+
+        ids[i] = mNextQueryId++;
+        mQueries[ids[i]] = query;
+    }
+}
+
+void
+Context::DeleteQueriesEXT(GLsizei n, const GLuint *ids)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // deleting an active query ends it, its Vulkan queries are released along with their frame
+    for(GLsizei i = 0; i < n; ++i) {
+        if(ids[i] == mActiveTimeElapsedQuery) {
+            mActiveTimeElapsedQuery = 0;
+        }
+        if(ids[i] == mActiveOcclusionQuery) {
+            mCommandBufferManager->EndVkOcclusionQuery();
+            mActiveOcclusionQuery = 0;
+        }
+        mQueries.erase(ids[i]);
+    }
+}
+
+GLboolean
+Context::IsQueryEXT(GLuint id)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mQueries.find(id);
+    return (it != mQueries.end() && it->second.target != 0) ? GL_TRUE : GL_FALSE;
+}
+
+void
+Context::BeginQueryEXT(GLenum target, GLuint id)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const bool isOcclusion = IsOcclusionQueryTarget(target);
+    if(target != GL_TIME_ELAPSED_EXT && !isOcclusion) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    // both occlusion targets count the same samples, so only one of them is active at a time
+    auto it = mQueries.find(id);
+    if((isOcclusion ? mActiveOcclusionQuery != 0 : (mActiveTimeElapsedQuery != 0 || !mCommandBufferManager->IsTimestampSupported())) ||
+       it == mQueries.end() || id == mActiveTimeElapsedQuery || id == mActiveOcclusionQuery ||
+       (it->second.target != 0 && it->second.target != target)) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    Query_t &query = it->second;
+    query.target = target;
+
+    if(isOcclusion) {
+        query.occlusion = mCommandBufferManager->BeginVkOcclusionQuery();
+        mActiveOcclusionQuery = id;
+        return;
+    }
+
+    query.begin  = WriteTimerQueryTimestamp(true);
+    query.end    = nullptr;
+
+    mActiveTimeElapsedQuery = id;
+}
+
+void
+Context::EndQueryEXT(GLenum target)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const bool isOcclusion = IsOcclusionQueryTarget(target);
+    if(target != GL_TIME_ELAPSED_EXT && !isOcclusion) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    GLuint &activeQuery = isOcclusion ? mActiveOcclusionQuery : mActiveTimeElapsedQuery;
+    if(activeQuery == 0 || mQueries[activeQuery].target != target) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(isOcclusion) {
+        mCommandBufferManager->EndVkOcclusionQuery();
+    } else {
+        mQueries[activeQuery].end = WriteTimerQueryTimestamp(false);
+    }
+
+    activeQuery = 0;
+}
+
+void
+Context::QueryCounterEXT(GLuint id, GLenum target)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(target != GL_TIMESTAMP_EXT) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    auto it = mQueries.find(id);
+    if(!mCommandBufferManager->IsTimestampSupported() || id == mActiveTimeElapsedQuery || id == mActiveOcclusionQuery ||
+       it == mQueries.end() || (it->second.target != 0 && it->second.target != target)) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // the timestamp is taken once all the commands before it have completed
+    Query_t &query = it->second;
+    query.target = target;
+    query.begin  = nullptr;
+    query.end    = WriteTimerQueryTimestamp(false);
+}
+
+void
+Context::GetQueryivEXT(GLenum target, GLenum pname, GLint *params)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(IsOcclusionQueryTarget(target)) {
+        if(pname != GL_CURRENT_QUERY_EXT) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+
+        auto it = mQueries.find(mActiveOcclusionQuery);
+        *params = (it != mQueries.end() && it->second.target == target) ? static_cast<GLint>(mActiveOcclusionQuery) : 0;
+        return;
+    }
+
+    if(target != GL_TIME_ELAPSED_EXT && target != GL_TIMESTAMP_EXT) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    switch(pname) {
+    case GL_CURRENT_QUERY_EXT:      *params = target == GL_TIME_ELAPSED_EXT ? static_cast<GLint>(mActiveTimeElapsedQuery) : 0; break;
+    case GL_QUERY_COUNTER_BITS_EXT: *params = static_cast<GLint>(mVkContext->vkTimestampValidBits); break;
+    default:                        RecordError(GL_INVALID_ENUM); break;
+    }
+}
+
+void
+Context::GetQueryObjectivEXT(GLuint id, GLenum pname, GLint *params)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // results too large for the type are clamped to its maximum
+    uint64_t result;
+    if(GetQueryObjectResult(id, pname, &result)) {
+        *params = static_cast<GLint>(std::min(result, static_cast<uint64_t>(INT32_MAX)));
+    }
+}
+
+void
+Context::GetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint *params)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint64_t result;
+    if(GetQueryObjectResult(id, pname, &result)) {
+        *params = static_cast<GLuint>(std::min(result, static_cast<uint64_t>(UINT32_MAX)));
+    }
+}
+
+void
+Context::GetQueryObjecti64vEXT(GLuint id, GLenum pname, GLint64 *params)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint64_t result;
+    if(GetQueryObjectResult(id, pname, &result)) {
+        *params = static_cast<GLint64>(std::min(result, static_cast<uint64_t>(INT64_MAX)));
+    }
+}
+
+void
+Context::GetQueryObjectui64vEXT(GLuint id, GLenum pname, GLuint64 *params)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint64_t result;
+    if(GetQueryObjectResult(id, pname, &result)) {
+        *params = static_cast<GLuint64>(result);
+    }
+}
@@ -22,6 +22,7 @@
  */
 
 #include "context.h"
+#include "vulkan/utils.h"
 
 void
 Context::BindRenderbuffer(GLenum target, GLuint renderbuffer)
@@ -75,11 +76,12 @@ Context::DeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
 
         if(index && mResourceManager->RenderbufferExists(index)) {
 
+            // only a pending framebuffer it is attached to needs to complete, other references retire with their frames
             if( mWriteFBO != mSystemFBO &&
                ((index == mWriteFBO->GetColorAttachmentName() && GL_RENDERBUFFER == mWriteFBO->GetColorAttachmentType())    ||
                 (index == mWriteFBO->GetDepthAttachmentName() && GL_RENDERBUFFER == mWriteFBO->GetDepthAttachmentType())    ||
                 (index == mWriteFBO->GetStencilAttachmentName() && GL_RENDERBUFFER == mWriteFBO->GetStencilAttachmentType())) &&
-                mWriteFBO->IsInDrawState()) {
+                IsFramebufferPending(mWriteFBO)) {
 
                 if(index == mWriteFBO->GetColorAttachmentName() && GL_RENDERBUFFER == mWriteFBO->GetColorAttachmentType()) {
                     mWriteFBO->SetStateDelete();
@@ -175,6 +177,7 @@ Context::GetRenderbufferParameteriv(GLenum target, GLenum pname, GLint* params)
     case GL_RENDERBUFFER_ALPHA_SIZE:        GlFormatToStorageBits(activeRenderbuffer->GetInternalFormat(), nullptr, nullptr, nullptr, params, nullptr, nullptr); break;
     case GL_RENDERBUFFER_DEPTH_SIZE:        GlFormatToStorageBits(activeRenderbuffer->GetInternalFormat(), nullptr, nullptr, nullptr, nullptr, params, nullptr); break;
     case GL_RENDERBUFFER_STENCIL_SIZE:      GlFormatToStorageBits(activeRenderbuffer->GetInternalFormat(), nullptr, nullptr, nullptr, nullptr, nullptr, params); break;
+    case GL_RENDERBUFFER_SAMPLES_EXT:       *params = activeRenderbuffer->GetSamples(); break;
     default:                                RecordError(GL_INVALID_ENUM); break;
     }
 }
@@ -192,12 +195,21 @@ Context::RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    RenderbufferStorageMultisampleEXT(target, 0, internalformat, width, height);
+}
+
+void
+Context::RenderbufferStorageMultisampleEXT(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
     if(target != GL_RENDERBUFFER) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    if(width < 0 || width > GLOVE_MAX_RENDERBUFFER_SIZE || height < 0 || height > GLOVE_MAX_RENDERBUFFER_SIZE) {
+    if(width < 0 || width > GLOVE_MAX_RENDERBUFFER_SIZE || height < 0 || height > GLOVE_MAX_RENDERBUFFER_SIZE ||
+       samples < 0 || samples > static_cast<GLsizei>(GetMaxVkSampleCount(mVkContext->vkFramebufferSampleCounts))) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
@@ -205,7 +217,8 @@ Context::RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width
     if(internalformat != GL_RGB8_OES          && internalformat != GL_RGBA8_OES &&
        internalformat != GL_RGBA4             && internalformat != GL_RGB565 && internalformat != GL_RGB5_A1 &&
        internalformat != GL_DEPTH_COMPONENT16 && internalformat != GL_DEPTH_COMPONENT24_OES && internalformat != GL_DEPTH_COMPONENT32_OES &&
-       internalformat != GL_STENCIL_INDEX8    && internalformat != GL_STENCIL_INDEX4_OES) {
+       internalformat != GL_STENCIL_INDEX8    && internalformat != GL_STENCIL_INDEX4_OES &&
+       internalformat != GL_RGBA16F_EXT       && internalformat != GL_RGB16F_EXT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -220,15 +233,18 @@ Context::RenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width
         return;
     }
 
-    if(((activeRenderbufferId == mWriteFBO->GetColorAttachmentName()   && GL_RENDERBUFFER == mWriteFBO->GetColorAttachmentType())    ||
-        (activeRenderbufferId == mWriteFBO->GetDepthAttachmentName()   && GL_RENDERBUFFER == mWriteFBO->GetDepthAttachmentType())    ||
-        (activeRenderbufferId == mWriteFBO->GetStencilAttachmentName() && GL_RENDERBUFFER == mWriteFBO->GetStencilAttachmentType())) &&
-        mWriteFBO->IsInDrawState()) {
+    // the storage may belong to a framebuffer rendered earlier in the recorded commands
+    if(HasPendingCommands()) {
         Finish();
     }
 
+    // the count reported back is the one the attachments are created with
+    if(samples > 1) {
+        samples = static_cast<GLsizei>(FindSupportedVkSampleCount(mVkContext->vkFramebufferSampleCounts, samples));
+    }
+
     Renderbuffer* activeRenderbuffer = mResourceManager->GetRenderbuffer(activeRenderbufferId);
-    if(!activeRenderbuffer->Allocate(width, height, internalformat)) {
+    if(!activeRenderbuffer->Allocate(width, height, internalformat, samples)) {
         RecordError(GL_OUT_OF_MEMORY);
         return;
     }
@@ -22,6 +22,7 @@
  */
 
 #include "context.h"
+#include "vulkan/utils.h"
 
 void
 Context::PrepareRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
@@ -41,13 +42,6 @@ Context::PrepareRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool
     GLfloat clearDepthValue    = clearDepthEnabled   ? stateFramebufferOperations->GetClearDepth() : 0.0f;
     uint32_t clearStencilValue = clearStencilEnabled ? stateFramebufferOperations->GetClearStencilMasked() : 0u;
 
-    // Update stencil buffer with mask
-    if(clearStencilEnabled && stateFramebufferOperations->StencilMaskActive()) {
-        mWriteFBO->UpdateClearDepthStencilTexture(clearStencilValue, stateFramebufferOperations->GetStencilMaskFront(), mClearRect);
-        clearStencilValue = 0;
-        clearStencilEnabled = false;
-    }
-
     // perform a screen-space pass
     mWriteFBO->CreateRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled,
                                 stateFramebufferOperations->IsColorWriteEnabled(),
@@ -55,8 +49,6 @@ Context::PrepareRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool
                                 stateFramebufferOperations->IsStencilWriteEnabled(),
                                  clearColorValue, clearDepthValue, clearStencilValue,
                                  &mClearRect);
-    mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-    mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 }
 
 void
@@ -65,10 +57,47 @@ Context::BeginRendering(bool clearColorEnabled, bool clearDepthEnabled, bool cle
     FUN_ENTRY(GL_LOG_DEBUG);
 
     PrepareRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
-    mCommandBufferManager->BeginVkDrawCommandBuffer();
+    AcquireDrawCommandBuffer();
     mWriteFBO->BeginVkRenderPass();
 }
 
+void
+Context::AcquireDrawCommandBuffer(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // wait only if the ring has wrapped around to a frame that is still in flight,
+    // then release whatever that frame was keeping alive, and retire the deleted
+    // objects no longer bound along with the frame about to be recorded
+    STALL_REASON(STALL_REASON_FRAME_RING);
+    uint32_t frame = mCommandBufferManager->GetActiveCommandBufferIndex();
+    if(mCommandBufferManager->WaitVkDrawCommandBuffer(frame)) {
+        mCacheManager->CleanUpFrameCaches(frame);
+        mResourceManager->CleanPurgeList();
+    }
+
+    mCommandBufferManager->BeginVkDrawCommandBuffer();
+    InvalidateBoundDescriptorSet();
+}
+
+bool
+Context::SubmitDrawCommandBuffer(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t frame = mCommandBufferManager->GetActiveCommandBufferIndex();
+
+    mCommandBufferManager->EndVkDrawCommandBuffer();
+    if(!mCommandBufferManager->SubmitVkDrawCommandBuffer()) {
+        return false;
+    }
+
+    mCacheManager->SubmitCaches(frame);
+    mDrawsSinceSubmit = 0;
+
+    return true;
+}
+
 void
 Context::Clear(GLbitfield mask)
 {
@@ -78,402 +107,2006 @@ Context::Clear(GLbitfield mask)
     bool clearDepthEnabled   = (mask & GL_DEPTH_BUFFER_BIT);
     bool clearStencilEnabled = (mask & GL_STENCIL_BUFFER_BIT);
 
-    if(!clearColorEnabled && !clearDepthEnabled && !clearStencilEnabled) {
-        RecordError(GL_INVALID_VALUE);
+    if(!clearColorEnabled && !clearDepthEnabled && !clearStencilEnabled) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    SetClearRect();
+
+    // the deferred depth/stencil buffer of the surface is allocated by clears that cannot wait for it
+    if((clearDepthEnabled || clearStencilEnabled) && mWriteFBO == mSystemFBO && mSystemFBO->IsDepthStencilDeferred()) {
+        if(!DeferSystemDepthStencilClear(clearDepthEnabled, clearStencilEnabled)) {
+            AttachSystemDepthStencil();
+        } else if(!clearColorEnabled) {
+            return;
+        } else {
+            clearDepthEnabled   = false;
+            clearStencilEnabled = false;
+        }
+    }
+
+    // color and stencil masks are executed implicitly through a screen-space pass (i.e., need an explicit VkPipeline object)
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+    bool performCustomClear = (stateFramebufferOperations->ColorMaskActive()   && clearColorEnabled) ||
+                              (stateFramebufferOperations->StencilMaskActive() && clearStencilEnabled);
+    if(!performCustomClear) {
+        ClearSimple(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+    } else {
+        ClearWithWriteMasks(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+    }
+}
+
+void
+Context::ClearSimple(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mWriteFBO->IsInDrawState()) {
+        if(CanClearInsideRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled)) {
+            RecordClearAttachments(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+            return;
+        }
+        Finish();
+    }
+
+    DeferClear(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+}
+
+void
+Context::DeferClear(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the buffers are cleared by the load operations, which write masks know nothing about
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+    clearColorEnabled   = clearColorEnabled   && stateFramebufferOperations->IsColorWriteEnabled();
+    clearDepthEnabled   = clearDepthEnabled   && stateFramebufferOperations->IsDepthWriteEnabled();
+    clearStencilEnabled = clearStencilEnabled && stateFramebufferOperations->IsStencilWriteEnabled();
+    if(!clearColorEnabled && !clearDepthEnabled && !clearStencilEnabled) {
+        return;
+    }
+
+    // a clear of the same area merges with the pending one and a clear covering it replaces it,
+    // anything else needs the pending clear in place before it is drawn over
+    if(HasPendingClear()) {
+        const Rect &rect   = mPendingClear.rect;
+        const bool  same   = mClearRect.x == rect.x && mClearRect.y == rect.y &&
+                             mClearRect.width == rect.width && mClearRect.height == rect.height;
+        const bool  covers = mClearRect.x <= rect.x && mClearRect.y <= rect.y &&
+                             mClearRect.x + mClearRect.width  >= rect.x + rect.width &&
+                             mClearRect.y + mClearRect.height >= rect.y + rect.height &&
+                             (clearColorEnabled   || !mPendingClear.color) &&
+                             (clearDepthEnabled   || !mPendingClear.depth) &&
+                             (clearStencilEnabled || !mPendingClear.stencil);
+        if(!same && !covers) {
+            ResolvePendingClear();
+            if(CanClearInsideRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled)) {
+                RecordClearAttachments(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+                return;
+            }
+            Finish();
+        } else if(covers) {
+            DiscardPendingClear(true, true, true);
+        }
+    }
+
+    if(clearColorEnabled) {
+        stateFramebufferOperations->GetClearColor(mPendingClear.colorValue);
+        if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
+            mPendingClear.colorValue[3] = 1.0f;
+        }
+    }
+    if(clearDepthEnabled) {
+        mPendingClear.depthValue   = stateFramebufferOperations->GetClearDepth();
+    }
+    if(clearStencilEnabled) {
+        mPendingClear.stencilValue = stateFramebufferOperations->GetClearStencilMasked();
+    }
+
+    mPendingClear.color   |= clearColorEnabled;
+    mPendingClear.depth   |= clearDepthEnabled;
+    mPendingClear.stencil |= clearStencilEnabled;
+    mPendingClear.rect     = mClearRect;
+}
+
+void
+Context::ResolvePendingClear(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!HasPendingClear()) {
+        return;
+    }
+
+    const PendingClear_t clear = mPendingClear;
+    DiscardPendingClear(true, true, true);
+
+    // the cleared buffers are stored whatever the write masks say by now
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+    mWriteFBO->SetStateClear();
+    mWriteFBO->CreateRenderPass(clear.color, clear.depth, clear.stencil,
+                                stateFramebufferOperations->IsColorWriteEnabled()   || clear.color,
+                                stateFramebufferOperations->IsDepthWriteEnabled()   || clear.depth,
+                                stateFramebufferOperations->IsStencilWriteEnabled() || clear.stencil,
+                                clear.colorValue, clear.depthValue, clear.stencilValue,
+                                &clear.rect);
+    AcquireDrawCommandBuffer();
+    mWriteFBO->BeginVkRenderPass();
+}
+
+void
+Context::DiscardPendingClear(bool color, bool depth, bool stencil)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mPendingClear.color   = mPendingClear.color   && !color;
+    mPendingClear.depth   = mPendingClear.depth   && !depth;
+    mPendingClear.stencil = mPendingClear.stencil && !stencil;
+}
+
+bool
+Context::CanClearInsideRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mWriteFBO->IsInDrawState() || !mCommandBufferManager->IsActiveCommandBufferRecording()) {
+        return false;
+    }
+
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+    const vulkanAPI::RenderPass *renderPass = mWriteFBO->GetRenderPass();
+
+    // attachments that the running pass does not store would lose the clear
+    if((clearColorEnabled   && stateFramebufferOperations->IsColorWriteEnabled()   && !renderPass->GetColorWriteEnabled())  ||
+       (clearDepthEnabled   && stateFramebufferOperations->IsDepthWriteEnabled()   && !renderPass->GetDepthWriteEnabled())  ||
+       (clearStencilEnabled && stateFramebufferOperations->IsStencilWriteEnabled() && !renderPass->GetStencilWriteEnabled())) {
+        return false;
+    }
+
+    // vkCmdClearAttachments cannot reach outside the render area the pass was begun with
+    const VkRect2D *renderArea = renderPass->GetRenderArea();
+    return mClearRect.x >= renderArea->offset.x && mClearRect.y >= renderArea->offset.y &&
+           mClearRect.x + mClearRect.width  <= renderArea->offset.x + static_cast<int32_t>(renderArea->extent.width) &&
+           mClearRect.y + mClearRect.height <= renderArea->offset.y + static_cast<int32_t>(renderArea->extent.height);
+}
+
+void
+Context::RecordClearAttachments(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // batched draws were issued before the clear and must be recorded before it
+    FlushDrawBatch();
+
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+    const vulkanAPI::RenderPass *renderPass = mWriteFBO->GetRenderPass();
+    const VkFormat depthStencilFormat = renderPass->GetDepthStencilFormat();
+
+    // write masks apply to clears, which vkCmdClearAttachments knows nothing about
+    clearColorEnabled   = clearColorEnabled   && stateFramebufferOperations->IsColorWriteEnabled() &&
+                          renderPass->GetColorFormat() != VK_FORMAT_UNDEFINED;
+    clearDepthEnabled   = clearDepthEnabled   && stateFramebufferOperations->IsDepthWriteEnabled() &&
+                          depthStencilFormat != VK_FORMAT_UNDEFINED && VkFormatIsDepth(depthStencilFormat);
+    clearStencilEnabled = clearStencilEnabled && stateFramebufferOperations->IsStencilWriteEnabled() &&
+                          depthStencilFormat != VK_FORMAT_UNDEFINED && VkFormatIsStencil(depthStencilFormat);
+
+    uint32_t attachmentCount = 0;
+    if(clearColorEnabled) {
+        GLfloat clearColorValue[4] = {0.0f,0.0f,0.0f,0.0f};
+        stateFramebufferOperations->GetClearColor(clearColorValue);
+        if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
+            clearColorValue[3] = 1.0f;
+        }
+        mClearPass.SetColorAttachment(attachmentCount++, clearColorValue);
+    }
+
+    if(clearDepthEnabled && clearStencilEnabled) {
+        mClearPass.SetDepthStencilAttachment(attachmentCount++, stateFramebufferOperations->GetClearDepth(),
+                                             static_cast<int>(stateFramebufferOperations->GetClearStencilMasked()));
+    } else if(clearDepthEnabled) {
+        mClearPass.SetDepthAttachment(attachmentCount++, stateFramebufferOperations->GetClearDepth());
+    } else if(clearStencilEnabled) {
+        mClearPass.SetStencilAttachment(attachmentCount++, static_cast<int>(stateFramebufferOperations->GetClearStencilMasked()));
+    }
+
+    if(!attachmentCount) {
+        return;
+    }
+
+    mClearPass.SetAttachmentsCount(attachmentCount);
+    mWriteFBO->ResetDiscardedAttachments();
+    mClearPass.SetRect(mClearRect.x, mClearRect.y, mClearRect.width, mClearRect.height);
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    VkCommandBuffer *drawCmdBuffer = BeginDrawCommandBuffer(&activeCmdBuffer);
+    vkCmdClearAttachments(*drawCmdBuffer, mClearPass.GetAttachmentsCount(), mClearPass.GetAttachments(),
+                                          mClearPass.GetRectCount(), mClearPass.GetRect());
+    EndDrawCommandBuffer(&activeCmdBuffer, drawCmdBuffer);
+}
+
+void
+Context::ClearWithWriteMasks(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // perform lazy initialization once
+    if(!mScreenSpacePass->Initialize()) {
+        return;
+    }
+
+    // the masked draw goes over whatever was cleared before it
+    ResolvePendingClear();
+
+    // validation check in case this functionality is not available
+    if(!mScreenSpacePass->Valid()) {
+        return;
+    }
+
+    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
+
+    // the masked buffers are drawn, whatever the masks leave whole is cleared along with the render pass
+    bool drawColorEnabled   = clearColorEnabled   && stateFramebufferOperations->ColorMaskActive();
+    bool drawStencilEnabled = clearStencilEnabled && stateFramebufferOperations->StencilMaskActive();
+    clearColorEnabled       = clearColorEnabled   && !drawColorEnabled;
+    clearStencilEnabled     = clearStencilEnabled && !drawStencilEnabled;
+
+    // the draw goes into the running pass when it can take the rest of the clear too,
+    // otherwise a new pass takes care of it through its load operations
+    const bool insideRenderPass = CanClearInsideRenderPass(clearColorEnabled || drawColorEnabled, clearDepthEnabled,
+                                                           clearStencilEnabled || drawStencilEnabled);
+    if(insideRenderPass) {
+        RecordClearAttachments(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+    } else {
+        if(mWriteFBO->IsInDrawState()) {
+            Finish();
+        }
+        PrepareRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+    }
+
+    drawStencilEnabled = drawStencilEnabled && VkFormatIsStencil(mWriteFBO->GetRenderPass()->GetDepthStencilFormat());
+
+    // clearColor is passed as a uniform and masked through VkPipelineColorBlendAttachmentState
+    GLfloat clearColorValue[4] = {0.0f,0.0f,0.0f,0.0f};
+    stateFramebufferOperations->GetClearColor(clearColorValue);
+    if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
+        clearColorValue[3] = 1.0f;
+    }
+
+    mScreenSpacePass->UpdateUniformBufferColor(clearColorValue[0], clearColorValue[1], clearColorValue[2], clearColorValue[3]);
+
+    vulkanAPI::Pipeline* pipeline = mScreenSpacePass->GetPipeline();
+
+    if(!drawColorEnabled) {
+        pipeline->SetColorBlendAttachmentWriteMask(0);
+    } else if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
+        GLboolean colormask[4];
+        stateFramebufferOperations->GetColorMask(colormask);
+        GLubyte colorMaskPackRGB = GlColorMaskPack(colormask[0], colormask[1], colormask[2], GL_FALSE);
+        pipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(colorMaskPackRGB));
+    } else {
+        pipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(stateFramebufferOperations->GetColorMask()));
+    }
+
+    // the stencil write mask keeps the bits that glStencilMask leaves out, the clear value replaces the rest
+    pipeline->SetStencilTestEnable(drawStencilEnabled);
+    if(drawStencilEnabled) {
+        const uint32_t stencilMask  = stateFramebufferOperations->GetStencilMaskFront();
+        const uint32_t stencilValue = stateFramebufferOperations->GetClearStencilMasked();
+
+        pipeline->SetStencilFrontCompareOp(VK_COMPARE_OP_ALWAYS);
+        pipeline->SetStencilFrontPassOp(VK_STENCIL_OP_REPLACE);
+        pipeline->SetStencilFrontWriteMask(stencilMask);
+        pipeline->SetStencilFrontReference(stencilValue);
+        pipeline->SetStencilBackCompareOp(VK_COMPARE_OP_ALWAYS);
+        pipeline->SetStencilBackPassOp(VK_STENCIL_OP_REPLACE);
+        pipeline->SetStencilBackWriteMask(stencilMask);
+        pipeline->SetStencilBackReference(stencilValue);
+    }
+
+    pipeline->SetUpdatePipeline(true);
+    pipeline->SetViewport(mClearRect.x, mClearRect.y, mClearRect.width, mClearRect.height);
+    pipeline->SetScissor(mClearRect.x, mClearRect.y, mClearRect.width, mClearRect.height);
+
+    if(!pipeline->Create(mWriteFBO->GetRenderPass())) {
+        Finish();
+        return;
+    }
+
+    if(!insideRenderPass) {
+        AcquireDrawCommandBuffer();
+        mWriteFBO->BeginVkRenderPass();
+        mWriteFBO->SetStateDraw();
+    }
+
+    if(!drawColorEnabled && !drawStencilEnabled) {
+        return;
+    }
+    mWriteFBO->ResetDiscardedAttachments();
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    VkCommandBuffer *drawCmdBuffer = BeginDrawCommandBuffer(&activeCmdBuffer);
+
+    mScreenSpacePass->BindPipeline(drawCmdBuffer);
+    mScreenSpacePass->BindUniformDescriptors(drawCmdBuffer);
+    InvalidateBoundDescriptorSet();
+    mScreenSpacePass->BindVertexBuffers(drawCmdBuffer);
+
+    pipeline->UpdateDynamicState(drawCmdBuffer, mStateManager.GetRasterizationState()->GetLineWidth());
+
+    mScreenSpacePass->Draw(drawCmdBuffer);
+    EndDrawCommandBuffer(&activeCmdBuffer, drawCmdBuffer);
+}
+
+void
+Context::UpdateViewportState(vulkanAPI::Pipeline* pipeline)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    StateFragmentOperations* stateFragmentOperations = mStateManager.GetFragmentOperationsState();
+    StateViewportTransformation* stateViewportTransformation = mStateManager.GetViewportTransformationState();
+
+    if(pipeline->GetUpdateViewportState()) {
+        bool invertY = !mWriteFBO->IsStoredUpright();
+        Rect viewportRect = stateViewportTransformation->GetViewportRect();
+        Rect scissorRect = stateFragmentOperations->GetScissorTestEnabled() ?
+                    stateFragmentOperations->GetScissorRect() : viewportRect;
+
+        // a pre-rotated framebuffer takes both rectangles turned into its images, from their top-left corner,
+        // the vertex shaders turn the primitives alike and leave them upright
+        if(mWriteFBO->IsPreRotated()) {
+            for(Rect *rect : {&viewportRect, &scissorRect}) {
+                rect->width  = std::min(rect->width,  mWriteFBO->GetWidth());
+                rect->height = std::min(rect->height, mWriteFBO->GetHeight());
+                rect->y      = mWriteFBO->GetHeight() - rect->y - rect->height;
+                *rect        = mWriteFBO->PreRotateRect(*rect);
+            }
+            invertY = false;
+        }
+
+        pipeline->ComputeViewport(mWriteFBO->GetStorageWidth(), mWriteFBO->GetStorageHeight(),
+                                  viewportRect.x, viewportRect.y,
+                                  viewportRect.width, viewportRect.height,
+                                  stateViewportTransformation->GetMinDepthRange(), stateViewportTransformation->GetMaxDepthRange(),
+                                  invertY);
+
+        pipeline->ComputeScissor(mWriteFBO->GetStorageWidth(), mWriteFBO->GetStorageHeight(),
+                                 scissorRect.x, scissorRect.y,
+                                 scissorRect.width, scissorRect.height, invertY);
+       pipeline->SetUpdateViewportState(false);
+    }
+}
+
+bool
+Context::BeginGeometry(bool capturable)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // compute programs are only run by glDispatchCompute, and while capturing only the draws that can be captured are issued
+    if(mStateManager.GetActiveShaderProgram()->IsCompute() || (mTransformFeedback.active && !capturable)) {
+        RecordError(GL_INVALID_OPERATION);
+        return false;
+    }
+
+    // draws captured into a command bundle leave the render passes of the frame alone
+    if(mCommandBundle) {
+        if(!PrepareCommandBundleGeometry()) {
+            RecordError(GL_INVALID_OPERATION);
+            return false;
+        }
+
+    } else {
+        // programs that read gl_LastFragData need render passes with the color attachment as input attachment,
+        // so the framebuffer switches to them for good, once the passes recorded so far have been executed
+        if(mStateManager.GetActiveShaderProgram()->UsesFramebufferFetch()) {
+            if(!mWriteFBO->CanFetchColor()) {
+                return false;
+            }
+            if(!mWriteFBO->IsColorFetchEnabled()) {
+                if(IsFramebufferPending(mWriteFBO)) {
+                    Finish();
+                }
+                mWriteFBO->SetColorFetchEnabled();
+                mPipeline->SetUpdatePipeline(true);
+            }
+        }
+
+        // and by the first draw that tests depth or stencil
+        StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
+        if(mWriteFBO == mSystemFBO && mSystemFBO->IsDepthStencilDeferred() &&
+           (stateFragmentOperations->GetDepthTestEnabled() || stateFragmentOperations->GetStencilTestEnabled())) {
+            AttachSystemDepthStencil();
+        }
+
+        ResolvePendingClear();
+        SetClearRect();
+        mWriteFBO->ResetDiscardedAttachments();
+
+        if(mWriteFBO->IsInClearState()) {
+            mWriteFBO->SetStateClearDraw();
+
+        } else if(mWriteFBO->IsInIdleState()) {
+            mWriteFBO->SetStateDraw();
+            BeginRendering(false,false,false);
+
+        } else if(mWriteFBO->IsInClearDrawState()) {
+            mWriteFBO->SetStateDraw();
+        }
+    }
+
+    //If the primitives are rendered with GL_LINE_LOOP, which is not supported in Vulkan,
+    //they are drawn as a line strip with one more index that repeats the first vertex.
+    mIsModeLineLoop = mStateManager.GetInputAssemblyState()->GetPrimitiveMode() == GL_LINE_LOOP;
+    //Where the device has no triangle fans, they are drawn as a triangle list of generated indices.
+    mIsModeTriangleFan = mStateManager.GetInputAssemblyState()->GetPrimitiveMode() == GL_TRIANGLE_FAN &&
+                         !mVkContext->mIsTriangleFanSupported;
+    //Vulkan only restarts strips and fans, the indices of lists and of fans drawn as lists are all vertices.
+    const GLenum mode = mStateManager.GetInputAssemblyState()->GetPrimitiveMode();
+    mIsPrimitiveRestart = mStateManager.GetInputAssemblyState()->GetPrimitiveRestartEnabled() &&
+                          (mode == GL_LINE_STRIP || mode == GL_LINE_LOOP || mode == GL_TRIANGLE_STRIP ||
+                          (mode == GL_TRIANGLE_FAN && !mIsModeTriangleFan));
+
+    // client indices are streamed through the rings of this context
+    mStateManager.GetActiveShaderProgram()->SetCacheManager(mCacheManager);
+
+    return true;
+}
+
+bool
+Context::PrepareGeometryPipeline(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // translate only the GL state that changed since the previous draw
+    mStateManager.UpdateVkPipelineStates(mPipeline, mWriteFBO->GetColorAttachmentTexture() &&
+                                                    mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB,
+                                                    mWriteFBO->IsStoredUpright());
+
+    ShaderProgram *progPtr = mStateManager.GetActiveShaderProgram();
+    if(progPtr->UpdateSpecializationData(mWriteFBO->GetPreRotation())) {
+        mPipeline->SetUpdatePipeline(true);
+    }
+
+    if(SetPipelineProgramShaderStages(progPtr)) {
+        if(!mPipeline->Create(mWriteFBO->GetRenderPass())) {
+            Finish();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+Context::BindGeometryState(VkCommandBuffer *drawCmdBuffer, bool indexed, uint32_t indexOffset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the color attachment written by earlier draws becomes visible to the fragments that fetch it
+    if(mStateManager.GetActiveShaderProgram()->UsesFramebufferFetch()) {
+        mWriteFBO->GetRenderPass()->RecordColorFetchBarrier(drawCmdBuffer);
+    }
+
+    mPipeline->Bind(drawCmdBuffer);
+    BindUniformDescriptors(drawCmdBuffer);
+    BindVertexBuffers(drawCmdBuffer);
+    if(indexed) {
+        BindIndexBuffer(drawCmdBuffer, indexOffset, mStateManager.GetActiveShaderProgram()->GetActiveIndexVkType());
+    }
+    UpdateViewportState(mPipeline);
+
+    mPipeline->UpdateDynamicState(drawCmdBuffer, mStateManager.GetRasterizationState()->GetLineWidth());
+}
+
+void
+Context::PushGeometry(uint32_t vertCount, uint32_t firstVertex, uint32_t instanceCount, bool indexed, GLenum type, const void *indices)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("PushGeometry", "rendering");
+
+    // the range of indices written by compute shaders is only known once they are read back
+    if(indexed && mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER)) {
+        FinishBufferDeviceWrites(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER));
+    }
+
+    // only the vertices of glDrawArrays are captured
+    uint32_t capturedCount = 0;
+    if(mTransformFeedback.active && !indexed && !PrepareTransformFeedbackGeometry(vertCount, instanceCount, &capturedCount)) {
+        return;
+    }
+
+    if(!BeginGeometry(!indexed)) {
+        return;
+    }
+
+    // a fan of less than three vertices has no triangles in it
+    if(mIsModeTriangleFan && !GlTriangleFanToListCount(vertCount)) {
+        return;
+    }
+
+    uint32_t indexOffset = 0;
+    uint32_t maxIndex = 0;
+    if(indexed) {
+        if(mIsModeLineLoop) {
+            ++vertCount;
+        }
+        UpdateIndices(&indexOffset, &maxIndex, vertCount, type, indices, mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER));
+        UpdateVertexAttributes(maxIndex + 1, firstVertex, instanceCount);
+        if(mIsModeTriangleFan) {
+            vertCount = GlTriangleFanToListCount(vertCount);
+        }
+    } else {
+        UpdateVertexAttributes(vertCount, firstVertex, instanceCount);
+
+        // non-indexed line loops and emulated fans use a generated index buffer,
+        // so that the vertex data is never copied
+        if(mIsModeLineLoop || mIsModeTriangleFan) {
+            if(!mStateManager.GetActiveShaderProgram()->PrepareGeneratedIndexBufferObject(mIsModeLineLoop ? GL_LINE_LOOP : GL_TRIANGLE_FAN, vertCount)) {
+                return;
+            }
+            indexed = true;
+            vertCount = mIsModeLineLoop ? vertCount + 1 : GlTriangleFanToListCount(vertCount);
+        }
+    }
+
+    if(!PrepareGeometryPipeline()) {
+        return;
+    }
+
+    // captured draws are recorded once, and counted whenever their bundle is called
+    if(mCommandBundle) {
+        UpdateUniformDescriptors();
+        BindGeometryState(mCommandBundle->GetVkCommandBuffer(), indexed, indexOffset);
+        DrawGeometry(mCommandBundle->GetVkCommandBuffer(), indexed, vertCount, instanceCount);
+        mCommandBundle->AddDraws(1, mPipeline->GetKeyHash(), mPipeline->GetVkPipeline());
+        return;
+    }
+
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_DRAWS);
+    ++mDrawsSinceSubmit;
+
+    // uniform data is written first, as its offsets are part of the bindings a batch is matched against
+    UpdateUniformDescriptors();
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    if(AppendToDrawBatch(activeCmdBuffer, indexed, vertCount, indexOffset, instanceCount)) {
+        return;
+    }
+    FlushDrawBatch();
+
+    // batches of secondary command buffers bind their state when recorded, into every buffer the batch is split in
+    if(GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS && IsDrawBatchable(&activeCmdBuffer, &activeCmdBuffer)) {
+        UpdateViewportState(mPipeline);
+        BeginDrawBatch(activeCmdBuffer, indexed, vertCount, indexOffset, instanceCount);
+        return;
+    }
+
+    VkCommandBuffer *drawCmdBuffer = BeginDrawCommandBuffer(&activeCmdBuffer);
+    BindGeometryState(drawCmdBuffer, indexed, indexOffset);
+
+    if(IsDrawBatchable(drawCmdBuffer, &activeCmdBuffer)) {
+        BeginDrawBatch(activeCmdBuffer, indexed, vertCount, indexOffset, instanceCount);
+    } else if(mTransformFeedback.active) {
+        DrawTransformFeedbackGeometry(drawCmdBuffer, vertCount, instanceCount, capturedCount);
+    } else {
+        DrawGeometry(drawCmdBuffer, indexed, vertCount, instanceCount);
+    }
+    EndDrawCommandBuffer(&activeCmdBuffer, drawCmdBuffer);
+}
+
+void
+Context::PushGeometryRanges(bool indexed, uint32_t indexOffset, const uint32_t *firsts, const uint32_t *counts, uint32_t drawCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("PushGeometryRanges", "rendering");
+
+    if(mCommandBundle) {
+        UpdateUniformDescriptors();
+        BindGeometryState(mCommandBundle->GetVkCommandBuffer(), indexed, indexOffset);
+        DrawGeometryRanges(mCommandBundle->GetVkCommandBuffer(), indexed, firsts, counts, drawCount);
+        mCommandBundle->AddDraws(drawCount, mPipeline->GetKeyHash(), mPipeline->GetVkPipeline());
+        return;
+    }
+
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_DRAWS, drawCount);
+    mDrawsSinceSubmit += drawCount;
+
+    UpdateUniformDescriptors();
+    FlushDrawBatch();
+
+    // the ranges share every binding, so they are recorded right after each other
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    VkCommandBuffer *drawCmdBuffer = BeginDrawCommandBuffer(&activeCmdBuffer);
+    BindGeometryState(drawCmdBuffer, indexed, indexOffset);
+    DrawGeometryRanges(drawCmdBuffer, indexed, firsts, counts, drawCount);
+    EndDrawCommandBuffer(&activeCmdBuffer, drawCmdBuffer);
+}
+
+void
+Context::PushGeometryIndirect(bool indexed, uint32_t indexOffset, BufferObject *indirectBo, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("PushGeometryIndirect", "rendering");
+
+    // the commands are read when the draws execute, so renaming the buffer has to wait for them
+    indirectBo->SetUsed(true);
+
+    if(mCommandBundle) {
+        UpdateUniformDescriptors();
+        BindGeometryState(mCommandBundle->GetVkCommandBuffer(), indexed, indexOffset);
+        DrawGeometryIndirect(mCommandBundle->GetVkCommandBuffer(), indexed, indirectBo->GetVkBuffer(), offset, drawCount, stride);
+        mCommandBundle->AddDraws(drawCount, mPipeline->GetKeyHash(), mPipeline->GetVkPipeline());
+        return;
+    }
+
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_DRAWS, drawCount);
+    mDrawsSinceSubmit += drawCount;
+
+    UpdateUniformDescriptors();
+    FlushDrawBatch();
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    VkCommandBuffer *drawCmdBuffer = BeginDrawCommandBuffer(&activeCmdBuffer);
+    BindGeometryState(drawCmdBuffer, indexed, indexOffset);
+    DrawGeometryIndirect(drawCmdBuffer, indexed, indirectBo->GetVkBuffer(), offset, drawCount, stride);
+    EndDrawCommandBuffer(&activeCmdBuffer, drawCmdBuffer);
+}
+
+bool
+Context::IsDrawBatchable(const VkCommandBuffer *drawCmdBuffer, const VkCommandBuffer *activeCmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // only lists can be joined without changing the primitives drawn, and a draw already
+    // recorded into a secondary command buffer can not be followed by other ones.
+    // draws that fetch the color attachment each need the barrier ahead of them, and captured ones bind their buffers
+    const GLenum mode = mStateManager.GetInputAssemblyState()->GetPrimitiveMode();
+
+    return GLOVE_BATCH_DRAWS && drawCmdBuffer == activeCmdBuffer &&
+           (mode == GL_POINTS || mode == GL_LINES || mode == GL_TRIANGLES) &&
+           !mStateManager.GetActiveShaderProgram()->UsesFramebufferFetch() && !mTransformFeedback.active;
+}
+
+void
+Context::BeginDrawBatch(VkCommandBuffer cmdBuffer, bool indexed, uint32_t vertCount, uint32_t indexOffset, uint32_t instanceCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+
+    mDrawBatch.cmdBuffer         = cmdBuffer;
+    mDrawBatch.program           = program;
+    mDrawBatch.pipeline          = mPipeline->GetVkPipeline();
+    mDrawBatch.descSet           = *program->GetVkDescSet();
+    mDrawBatch.dynamicOffsets.assign(program->GetVkDynamicOffsets(), program->GetVkDynamicOffsets() + program->GetVkDynamicOffsetCount());
+    mDrawBatch.pushConstantsSize = program->GetVkPushConstantRange()->size;
+    if(mDrawBatch.pushConstantsSize) {
+        memcpy(mDrawBatch.pushConstants, program->GetPushConstantData(), mDrawBatch.pushConstantsSize);
+    }
+    mDrawBatch.vertexBufferCount = program->GetActiveVertexVkBuffersCount();
+    memcpy(mDrawBatch.vertexBuffers, program->GetActiveVertexVkBuffers(), mDrawBatch.vertexBufferCount * sizeof(VkBuffer));
+    memcpy(mDrawBatch.vertexBufferOffsets, program->GetActiveVertexVkBufferOffsets(), mDrawBatch.vertexBufferCount * sizeof(VkDeviceSize));
+    mDrawBatch.indexBuffer       = indexed ? program->GetActiveIndexVkBuffer() : VK_NULL_HANDLE;
+    mDrawBatch.indexType         = program->GetActiveIndexVkType();
+    mDrawBatch.indexOffset       = indexOffset;
+    mDrawBatch.indexed           = indexed;
+    mDrawBatch.instanceCount     = instanceCount;
+    mDrawBatch.firsts[0]         = 0;
+    mDrawBatch.counts[0]         = vertCount;
+    mDrawBatch.drawCount         = 1;
+}
+
+bool
+Context::AppendToDrawBatch(VkCommandBuffer cmdBuffer, bool indexed, uint32_t vertCount, uint32_t indexOffset, uint32_t instanceCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // Every other GL call records the batch first, so the state it was begun with is still the
+    // current one. What remains to be matched is what each draw sets up by itself.
+    if(!mDrawBatch.drawCount || !IsDrawBatchable(&cmdBuffer, &cmdBuffer)) {
+        return false;
+    }
+
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+    if(mDrawBatch.cmdBuffer     != cmdBuffer                    ||
+       mDrawBatch.program       != program                      ||
+       mDrawBatch.pipeline      != mPipeline->GetVkPipeline()  ||
+       mDrawBatch.descSet       != *program->GetVkDescSet()     ||
+       mDrawBatch.indexed       != indexed                      ||
+       mDrawBatch.instanceCount != instanceCount                ||
+       mDrawBatch.vertexBufferCount != program->GetActiveVertexVkBuffersCount() ||
+       mDrawBatch.dynamicOffsets.size() != program->GetVkDynamicOffsetCount()   ||
+       (program->GetVkDynamicOffsetCount() &&
+        memcmp(mDrawBatch.dynamicOffsets.data(), program->GetVkDynamicOffsets(), program->GetVkDynamicOffsetCount() * sizeof(uint32_t)))) {
+        return false;
+    }
+
+    // the batch is recorded with the push constants it was begun with
+    if(mDrawBatch.pushConstantsSize != program->GetVkPushConstantRange()->size ||
+       (mDrawBatch.pushConstantsSize && memcmp(mDrawBatch.pushConstants, program->GetPushConstantData(), mDrawBatch.pushConstantsSize))) {
+        return false;
+    }
+
+    // A draw continues the batch when its vertex buffers are bound where the batch bound them,
+    // except that non-indexed draws may start a whole number of vertices further on, the
+    // same number for every binding that steps per vertex. Indexed draws may start further on
+    // in the same index buffer instead.
+    const VkVertexInputBindingDescription *bindings = program->GetVkPipelineVertexInput()->pVertexBindingDescriptions;
+    const VkDeviceSize *offsets = program->GetActiveVertexVkBufferOffsets();
+    const VkDeviceSize *strides = program->GetActiveVertexVkBufferStrides();
+    bool firstKnown = false;
+    VkDeviceSize first = 0;
+    for(uint32_t b = 0; b < mDrawBatch.vertexBufferCount; ++b) {
+        if(mDrawBatch.vertexBuffers[b] != program->GetActiveVertexVkBuffers()[b]) {
+            return false;
+        }
+
+        if(indexed || !strides[b] || bindings[b].inputRate != VK_VERTEX_INPUT_RATE_VERTEX) {
+            if(offsets[b] != mDrawBatch.vertexBufferOffsets[b]) {
+                return false;
+            }
+            continue;
+        }
+
+        if(offsets[b] < mDrawBatch.vertexBufferOffsets[b] || (offsets[b] - mDrawBatch.vertexBufferOffsets[b]) % strides[b]) {
+            return false;
+        }
+
+        const VkDeviceSize vertexFirst = (offsets[b] - mDrawBatch.vertexBufferOffsets[b]) / strides[b];
+        if(firstKnown && vertexFirst != first) {
+            return false;
+        }
+        first      = vertexFirst;
+        firstKnown = true;
+    }
+
+    if(indexed) {
+        const uint32_t indexSize = mDrawBatch.indexType == VK_INDEX_TYPE_UINT32 ? 4 :
+                                   mDrawBatch.indexType == VK_INDEX_TYPE_UINT16 ? 2 : 1;
+        if(mDrawBatch.indexBuffer != program->GetActiveIndexVkBuffer() || mDrawBatch.indexType != program->GetActiveIndexVkType() ||
+           indexOffset < mDrawBatch.indexOffset || (indexOffset - mDrawBatch.indexOffset) % indexSize) {
+            return false;
+        }
+        first = (indexOffset - mDrawBatch.indexOffset) / indexSize;
+    }
+
+    if(first > UINT32_MAX) {
+        return false;
+    }
+
+    // draws that follow each other are joined, others are recorded separately with the batch bindings
+    const uint32_t last = mDrawBatch.drawCount - 1;
+    if(mDrawBatch.firsts[last] + mDrawBatch.counts[last] == first) {
+        mDrawBatch.counts[last] += vertCount;
+        return true;
+    }
+
+    if(mDrawBatch.drawCount == GLOVE_MAX_BATCHED_DRAWS) {
+        return false;
+    }
+
+    mDrawBatch.firsts[mDrawBatch.drawCount] = static_cast<uint32_t>(first);
+    mDrawBatch.counts[mDrawBatch.drawCount] = vertCount;
+    ++mDrawBatch.drawCount;
+
+    return true;
+}
+
+void
+Context::RecordDrawBatch(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS) {
+        RecordDrawBatchRange(mDrawBatch.cmdBuffer, 0, mDrawBatch.drawCount);
+        mDrawBatch.drawCount = 0;
+        return;
+    }
+
+    // The batch is split into consecutive ranges, recorded in parallel and executed in order.
+    // Nothing changes the state the batch was begun with until it has been recorded, so the
+    // recording threads only read it.
+    const uint32_t drawCount = mDrawBatch.drawCount;
+    const uint32_t count     = std::max(1u, std::min(drawCount / GLOVE_MIN_BATCHED_DRAWS_PER_THREAD,
+                                                     static_cast<uint32_t>(GLOVE_SECONDARY_RECORDING_THREADS)));
+    const float    lineWidth = mStateManager.GetRasterizationState()->GetLineWidth();
+
+    mCommandBufferManager->RecordVkSecondaryCommandBuffers(mWriteFBO->GetRenderPass(), *mWriteFBO->GetActiveVkFramebuffer(), count,
+        [this, drawCount, count, lineWidth](VkCommandBuffer cmdBuffer, uint32_t index) {
+            BindDrawBatchState(cmdBuffer, lineWidth);
+            RecordDrawBatchRange(cmdBuffer, drawCount * index / count, drawCount * (index + 1) / count);
+        });
+
+    mDrawBatch.drawCount = 0;
+}
+
+void
+Context::RecordDrawBatchRange(VkCommandBuffer cmdBuffer, uint32_t first, uint32_t last) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(uint32_t i = first; i < last; ++i) {
+        if(mDrawBatch.indexed) {
+            vkCmdDrawIndexed(cmdBuffer, mDrawBatch.counts[i], mDrawBatch.instanceCount, mDrawBatch.firsts[i], 0, 0);
+        } else {
+            vkCmdDraw(cmdBuffer, mDrawBatch.counts[i], mDrawBatch.instanceCount, mDrawBatch.firsts[i], 0);
+        }
+    }
+}
+
+void
+Context::BindDrawBatchState(VkCommandBuffer cmdBuffer, float lineWidth) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a secondary command buffer inherits no state, so each one binds what the batch was begun with
+    const ShaderProgram *program = mDrawBatch.program;
+
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mDrawBatch.pipeline);
+
+    if(mDrawBatch.descSet) {
+        vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, program->GetVkPipelineLayout(), 0, 1, &mDrawBatch.descSet,
+                                static_cast<uint32_t>(mDrawBatch.dynamicOffsets.size()), mDrawBatch.dynamicOffsets.data());
+    }
+
+    if(program->UsesBindlessTextures() && *mCacheManager->GetBindlessTextureTable()->GetVkDescSet()) {
+        vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, program->GetVkPipelineLayout(), GLOVE_BINDLESS_TEXTURE_SET, 1,
+                                mCacheManager->GetBindlessTextureTable()->GetVkDescSet(), 0, nullptr);
+    }
+
+    if(mDrawBatch.pushConstantsSize) {
+        const VkPushConstantRange *range = program->GetVkPushConstantRange();
+        vkCmdPushConstants(cmdBuffer, program->GetVkPipelineLayout(), range->stageFlags, range->offset,
+                           mDrawBatch.pushConstantsSize, mDrawBatch.pushConstants);
+    }
+
+    if(mDrawBatch.indexed && mDrawBatch.indexBuffer) {
+        vkCmdBindIndexBuffer(cmdBuffer, mDrawBatch.indexBuffer, mDrawBatch.indexOffset, mDrawBatch.indexType);
+    }
+
+    mPipeline->UpdateDynamicState(&cmdBuffer, lineWidth);
+
+    if(!mDrawBatch.vertexBufferCount) {
+        return;
+    }
+
+#ifdef VK_EXT_extended_dynamic_state
+    if(mVkContext->mIsExtendedDynamicStateSupported) {
+        mVkContext->fpCmdBindVertexBuffers2EXT(cmdBuffer, 0, mDrawBatch.vertexBufferCount, mDrawBatch.vertexBuffers,
+                                               mDrawBatch.vertexBufferOffsets, nullptr, program->GetActiveVertexVkBufferStrides());
+        return;
+    }
+#endif // VK_EXT_extended_dynamic_state
+
+    vkCmdBindVertexBuffers(cmdBuffer, 0, mDrawBatch.vertexBufferCount, mDrawBatch.vertexBuffers, mDrawBatch.vertexBufferOffsets);
+}
+
+VkCommandBuffer *
+Context::BeginDrawCommandBuffer(VkCommandBuffer *activeCmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // By default draws are recorded inline into the active primary command buffer.
+    // Secondary command buffers are only worth their per-draw cost when recording is split across threads.
+    if(!GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS) {
+        return activeCmdBuffer;
+    }
+
+    VkCommandBuffer *secondaryCmdBuffer = mCommandBufferManager->AllocateVkSecondaryCmdBuffers(1);
+    mCommandBufferManager->BeginVkSecondaryCommandBuffer(secondaryCmdBuffer, mWriteFBO->GetRenderPass(), *mWriteFBO->GetActiveVkFramebuffer());
+
+    return secondaryCmdBuffer;
+}
+
+void
+Context::EndDrawCommandBuffer(VkCommandBuffer *activeCmdBuffer, VkCommandBuffer *drawCmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(drawCmdBuffer == activeCmdBuffer) {
+        return;
+    }
+
+    mCommandBufferManager->EndVkSecondaryCommandBuffer(drawCmdBuffer);
+    vkCmdExecuteCommands(*activeCmdBuffer, 1, drawCmdBuffer);
+}
+
+void
+Context::UpdateIndices(uint32_t* offset, uint32_t* maxIndex, uint32_t indexCount, GLenum type, const void* indices, BufferObject* ibo)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // index ranges and widened byte indices are cached by the bound buffer, so
+    // preparing every draw is cheap and picks up changes of count, type or offset
+    mStateManager.GetActiveShaderProgram()->PrepareIndexBufferObject(offset, maxIndex, indexCount, type, indices, ibo);
+    mPipeline->SetUpdateIndexBuffer(false);
+}
+
+void
+Context::UpdateVertexAttributes(uint32_t vertCount, uint32_t firstVertex, uint32_t instanceCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// A glVertexAttrib related function has been called. Check to see if mVkPipelineVertexInput needs to be updated.
+    /// If this is true then VkPipeline needs to be updated too.
+    /// Otherwise only the buffer that will be bound with vkCmdBindVertexBuffers need to be updated
+    if(mStateManager.GetActiveShaderProgram()->PrepareVertexAttribBufferObjects(vertCount, firstVertex, instanceCount,
+                                                                                mVertexArray,
+                                                                                mPipeline->GetUpdateVertexAttribVBOs())) {
+        mPipeline->SetUpdatePipeline(true);
+        mPipeline->SetUpdateVertexAttribVBOs(false);
+    }
+}
+
+void
+Context::UpdateUniformDescriptors(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mStateManager.GetActiveShaderProgram()->HasUniformData()) {
+        mStateManager.GetActiveShaderProgram()->UpdateBuiltInUniformData(mStateManager.GetViewportTransformationState()->GetMinDepthRange(),
+                                                                         mStateManager.GetViewportTransformationState()->GetMaxDepthRange());
+        mStateManager.GetActiveShaderProgram()->UpdateDescriptorSet();
+    }
+}
+
+bool
+Context::IsDescriptorSetBound(VkCommandBuffer cmdBuffer, const ShaderProgram *program) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return mBoundDescriptorSet.cmdBuffer      == cmdBuffer                          &&
+           mBoundDescriptorSet.pipelineLayout == program->GetVkPipelineLayout()     &&
+           mBoundDescriptorSet.descSet        == *program->GetVkDescSet()           &&
+           mBoundDescriptorSet.dynamicOffsets.size() == program->GetVkDynamicOffsetCount() &&
+           (!program->GetVkDynamicOffsetCount() ||
+            !memcmp(mBoundDescriptorSet.dynamicOffsets.data(), program->GetVkDynamicOffsets(), program->GetVkDynamicOffsetCount() * sizeof(uint32_t)));
+}
+
+void
+Context::BindUniformDescriptors(VkCommandBuffer *CmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+
+    // uniforms in push constants leave the offsets as they were, so the bound set is still the right one
+    if(*program->GetVkDescSet() && !IsDescriptorSetBound(*CmdBuffer, program)) {
+        vkCmdBindDescriptorSets(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, program->GetVkPipelineLayout(), 0, 1, program->GetVkDescSet(),
+                                program->GetVkDynamicOffsetCount(), program->GetVkDynamicOffsets());
+
+        if(mBoundDescriptorSet.cmdBuffer != *CmdBuffer || mBoundDescriptorSet.pipelineLayout != program->GetVkPipelineLayout()) {
+            mBoundDescriptorSet.bindlessSet = VK_NULL_HANDLE;
+        }
+        mBoundDescriptorSet.cmdBuffer      = *CmdBuffer;
+        mBoundDescriptorSet.pipelineLayout = program->GetVkPipelineLayout();
+        mBoundDescriptorSet.descSet        = *program->GetVkDescSet();
+        mBoundDescriptorSet.dynamicOffsets.assign(program->GetVkDynamicOffsets(), program->GetVkDynamicOffsets() + program->GetVkDynamicOffsetCount());
+    }
+
+    // the texture table of the context stays bound for as long as the layout does, only the indices into it are pushed per draw
+    if(program->UsesBindlessTextures()) {
+        if(mBoundDescriptorSet.cmdBuffer != *CmdBuffer || mBoundDescriptorSet.pipelineLayout != program->GetVkPipelineLayout()) {
+            mBoundDescriptorSet.cmdBuffer      = *CmdBuffer;
+            mBoundDescriptorSet.pipelineLayout = program->GetVkPipelineLayout();
+            mBoundDescriptorSet.descSet        = VK_NULL_HANDLE;
+            mBoundDescriptorSet.bindlessSet    = VK_NULL_HANDLE;
+            mBoundDescriptorSet.dynamicOffsets.clear();
+        }
+
+        const VkDescriptorSet *bindlessSet = mCacheManager->GetBindlessTextureTable()->GetVkDescSet();
+        if(*bindlessSet && mBoundDescriptorSet.bindlessSet != *bindlessSet) {
+            vkCmdBindDescriptorSets(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, program->GetVkPipelineLayout(), GLOVE_BINDLESS_TEXTURE_SET, 1, bindlessSet, 0, nullptr);
+            mBoundDescriptorSet.bindlessSet = *bindlessSet;
+        }
+    }
+
+    program->PushConstants(CmdBuffer);
+}
+
+void
+Context::BindVertexBuffers(VkCommandBuffer *CmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+    if(!program->GetActiveVertexVkBuffersCount()) {
+        return;
+    }
+
+#ifdef VK_EXT_extended_dynamic_state
+    // binding strides are dynamic along with the rest of the extended state
+    if(mVkContext->mIsExtendedDynamicStateSupported) {
+        mVkContext->fpCmdBindVertexBuffers2EXT(*CmdBuffer, 0, program->GetActiveVertexVkBuffersCount(), program->GetActiveVertexVkBuffers(),
+                                               program->GetActiveVertexVkBufferOffsets(), nullptr, program->GetActiveVertexVkBufferStrides());
+        return;
+    }
+#endif // VK_EXT_extended_dynamic_state
+
+    vkCmdBindVertexBuffers(*CmdBuffer, 0, program->GetActiveVertexVkBuffersCount(), program->GetActiveVertexVkBuffers(),
+                           program->GetActiveVertexVkBufferOffsets());
+}
+
+void
+Context::BindIndexBuffer(VkCommandBuffer *CmdBuffer, uint32_t offset, VkIndexType type)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mStateManager.GetActiveShaderProgram()->GetActiveIndexVkBuffer()) {
+        vkCmdBindIndexBuffer(*CmdBuffer, mStateManager.GetActiveShaderProgram()->GetActiveIndexVkBuffer(), offset, type);
+    }
+}
+
+void
+Context::DrawGeometry(VkCommandBuffer *CmdBuffer, bool indexed, uint32_t vertCount, uint32_t instanceCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(indexed == false) {
+        vkCmdDraw(*CmdBuffer, vertCount, instanceCount, 0, 0);
+    } else {
+        vkCmdDrawIndexed(*CmdBuffer, vertCount, instanceCount, 0, 0, 0);
+    }
+}
+
+void
+Context::DrawGeometryRanges(VkCommandBuffer *CmdBuffer, bool indexed, const uint32_t *firsts, const uint32_t *counts, uint32_t drawCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the draw parameters are streamed through the vertex ring, which lives as long as the frame
+    if(mVkContext->mIsMultiDrawIndirectSupported && drawCount > 1 && drawCount <= GLOVE_MAX_DRAW_INDIRECT_COUNT) {
+        vulkanAPI::UniformRing *vertexRing = mCacheManager->GetVertexRing();
+        FrameArena::Scope scope(mCacheManager->GetFrameArena());
+        uint32_t offset = 0;
+
+        if(indexed) {
+            VkDrawIndexedIndirectCommand *commands = mCacheManager->GetFrameArena()->Allocate<VkDrawIndexedIndirectCommand>(drawCount);
+            for(uint32_t i = 0; i < drawCount; ++i) {
+                commands[i].indexCount    = counts[i];
+                commands[i].instanceCount = 1;
+                commands[i].firstIndex    = firsts[i];
+                commands[i].vertexOffset  = 0;
+                commands[i].firstInstance = 0;
+            }
+
+            if(vertexRing->Allocate(drawCount * sizeof(VkDrawIndexedIndirectCommand), commands, &offset)) {
+                vkCmdDrawIndexedIndirect(*CmdBuffer, vertexRing->GetVkBuffer(), offset, drawCount, sizeof(VkDrawIndexedIndirectCommand));
+                return;
+            }
+        } else {
+            VkDrawIndirectCommand *commands = mCacheManager->GetFrameArena()->Allocate<VkDrawIndirectCommand>(drawCount);
+            for(uint32_t i = 0; i < drawCount; ++i) {
+                commands[i].vertexCount   = counts[i];
+                commands[i].instanceCount = 1;
+                commands[i].firstVertex   = firsts[i];
+                commands[i].firstInstance = 0;
+            }
+
+            if(vertexRing->Allocate(drawCount * sizeof(VkDrawIndirectCommand), commands, &offset)) {
+                vkCmdDrawIndirect(*CmdBuffer, vertexRing->GetVkBuffer(), offset, drawCount, sizeof(VkDrawIndirectCommand));
+                return;
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < drawCount; ++i) {
+        if(indexed) {
+            vkCmdDrawIndexed(*CmdBuffer, counts[i], 1, firsts[i], 0, 0);
+        } else {
+            vkCmdDraw(*CmdBuffer, counts[i], 1, firsts[i], 0);
+        }
+    }
+}
+
+void
+Context::DrawGeometryIndirect(VkCommandBuffer *CmdBuffer, bool indexed, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the commands of GL share their layout with the ones of Vulkan, so they are read from the GL buffer as they are.
+    // without multiDrawIndirect, or with commands closer together than their size, they are read one at a time
+    const uint32_t commandSize = indexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+    if(drawCount > 1 && mVkContext->mIsMultiDrawIndirectSupported && drawCount <= GLOVE_MAX_DRAW_INDIRECT_COUNT && stride >= commandSize) {
+        if(indexed) {
+            vkCmdDrawIndexedIndirect(*CmdBuffer, buffer, offset, drawCount, stride);
+        } else {
+            vkCmdDrawIndirect(*CmdBuffer, buffer, offset, drawCount, stride);
+        }
+        return;
+    }
+
+    for(uint32_t i = 0; i < drawCount; ++i) {
+        if(indexed) {
+            vkCmdDrawIndexedIndirect(*CmdBuffer, buffer, offset + static_cast<VkDeviceSize>(i) * stride, 1, commandSize);
+        } else {
+            vkCmdDrawIndirect(*CmdBuffer, buffer, offset + static_cast<VkDeviceSize>(i) * stride, 1, commandSize);
+        }
+    }
+}
+
+void
+Context::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    DrawArraysInstancedEXT(mode, first, count, 1);
+}
+
+void
+Context::DrawArraysInstancedEXT(GLenum mode, GLint start, GLsizei count, GLsizei primcount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a GL_KHR_no_error context is known to issue valid draws
+    if(!mNoError) {
+        if(mode > GL_TRIANGLE_FAN) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+
+        if(count < 0 || primcount < 0) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+
+        if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+            RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+            return;
+        }
+    }
+
+    // culled primitives are still captured
+    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode) && !mTransformFeedback.active) {
+        return;
+    }
+
+    if(!mStateManager.GetActiveShaderProgram() || !count || !primcount) {
+        return;
+    }
+
+    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    }
+
+    PushGeometry(count, start, primcount, false, GL_INVALID_ENUM, nullptr);
+}
+
+void
+Context::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    DrawElementsInstancedEXT(mode, count, type, indices, 1);
+}
+
+void
+Context::DrawElementsInstancedEXT(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mNoError) {
+        // GL_UNSIGNED_INT is accepted through GL_OES_element_index_uint, and drawn with 32-bit indices
+        if( (mode > GL_TRIANGLE_FAN)  || !(type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT) ) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+
+        if(count < 0 || primcount < 0) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+
+        if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+            RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+            return;
+        }
+    }
+
+    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+        return;
+    }
+
+    if(!mStateManager.GetActiveShaderProgram() || !count || !primcount) {
+        return;
+    }
+
+    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    }
+
+    PushGeometry(count, 0, primcount, true, type, indices);
+}
+
+void
+Context::DrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mNoError && end < start) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // the vertices the indices refer to are given, so the indices are not scanned for them
+    mIsDrawRange  = true;
+    mDrawRangeEnd = end;
+    DrawElementsInstancedEXT(mode, count, type, indices, 1);
+    mIsDrawRange  = false;
+}
+
+void
+Context::MultiDrawArraysEXT(GLenum mode, const GLint *first, const GLsizei *count, GLsizei primcount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mNoError) {
+        if(mode > GL_TRIANGLE_FAN) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+
+        if(primcount < 0) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+
+        for(GLsizei i = 0; i < primcount; ++i) {
+            if(count[i] < 0) {
+                RecordError(GL_INVALID_VALUE);
+                return;
+            }
+        }
+
+        if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+            RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+            return;
+        }
+    }
+
+    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+        return;
+    }
+
+    if(!mStateManager.GetActiveShaderProgram() || !primcount) {
+        return;
+    }
+
+    // each line loop is closed by an index buffer of its own, as is each emulated fan
+    if(mode == GL_LINE_LOOP || (mode == GL_TRIANGLE_FAN && !mVkContext->mIsTriangleFanSupported)) {
+        for(GLsizei i = 0; i < primcount; ++i) {
+            DrawArrays(mode, first[i], count[i]);
+        }
+        return;
+    }
+
+    // the vertex data of all ranges is prepared at once, and every range is drawn relative to the lowest one
+    FrameArena::Scope scope(mCacheManager->GetFrameArena());
+    uint32_t *firsts   = mCacheManager->GetFrameArena()->Allocate<uint32_t>(primcount);
+    uint32_t *counts   = mCacheManager->GetFrameArena()->Allocate<uint32_t>(primcount);
+    uint32_t drawCount = 0;
+    uint32_t minFirst  = UINT32_MAX;
+    uint32_t maxEnd    = 0;
+    for(GLsizei i = 0; i < primcount; ++i) {
+        if(!count[i]) {
+            continue;
+        }
+        firsts[drawCount] = static_cast<uint32_t>(first[i]);
+        counts[drawCount] = static_cast<uint32_t>(count[i]);
+        minFirst = std::min(minFirst, firsts[drawCount]);
+        maxEnd   = std::max(maxEnd, firsts[drawCount] + counts[drawCount]);
+        ++drawCount;
+    }
+
+    if(!drawCount) {
+        return;
+    }
+
+    for(uint32_t i = 0; i < drawCount; ++i) {
+        firsts[i] -= minFirst;
+    }
+
+    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    }
+
+    FlushDrawBatch();
+    if(!BeginGeometry(false)) {
+        return;
+    }
+    UpdateVertexAttributes(maxEnd - minFirst, minFirst, 1);
+
+    if(!PrepareGeometryPipeline()) {
+        return;
+    }
+
+    PushGeometryRanges(false, 0, firsts, counts, drawCount);
+}
+
+void
+Context::MultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum type, const void *const *indices, GLsizei primcount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mNoError) {
+        if( (mode > GL_TRIANGLE_FAN)  || !(type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT) ) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+
+        if(primcount < 0) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+
+        for(GLsizei i = 0; i < primcount; ++i) {
+            if(count[i] < 0) {
+                RecordError(GL_INVALID_VALUE);
+                return;
+            }
+        }
+
+        if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+            RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+            return;
+        }
+    }
+
+    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+        return;
+    }
+
+    if(!mStateManager.GetActiveShaderProgram() || !primcount) {
+        return;
+    }
+
+    // Ranges can only be drawn together when they are read from the same index buffer, which
+    // needs a bound element array buffer. Line loops repeat their first index at the end instead,
+    // and emulated fans are read from lists of their own.
+    BufferObject *ibo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER);
+    if(!ibo || mode == GL_LINE_LOOP || (mode == GL_TRIANGLE_FAN && !mVkContext->mIsTriangleFanSupported)) {
+        for(GLsizei i = 0; i < primcount; ++i) {
+            DrawElements(mode, count[i], type, indices[i]);
+        }
+        return;
+    }
+
+    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    }
+
+    FlushDrawBatch();
+    FinishBufferDeviceWrites(ibo);
+    if(!BeginGeometry(false)) {
+        return;
+    }
+
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+    FrameArena::Scope scope(mCacheManager->GetFrameArena());
+    uint32_t *firsts      = mCacheManager->GetFrameArena()->Allocate<uint32_t>(primcount);
+    uint32_t *counts      = mCacheManager->GetFrameArena()->Allocate<uint32_t>(primcount);
+    uint32_t drawCount    = 0;
+    VkBuffer indexBuffer  = VK_NULL_HANDLE;
+    uint32_t minOffset    = UINT32_MAX;
+    uint32_t maxIndex     = 0;
+    bool     sharedBuffer = true;
+    for(GLsizei i = 0; i < primcount && sharedBuffer; ++i) {
+        if(!count[i]) {
+            continue;
+        }
+
+        uint32_t rangeOffset   = 0;
+        uint32_t rangeMaxIndex = 0;
+        UpdateIndices(&rangeOffset, &rangeMaxIndex, count[i], type, indices[i], ibo);
+
+        // widened byte indices live in buffers of their own
+        if(!program->GetActiveIndexVkBuffer() || (indexBuffer != VK_NULL_HANDLE && indexBuffer != program->GetActiveIndexVkBuffer())) {
+            sharedBuffer = false;
+            break;
+        }
+
+        indexBuffer = program->GetActiveIndexVkBuffer();
+        firsts[drawCount] = rangeOffset;
+        counts[drawCount] = static_cast<uint32_t>(count[i]);
+        ++drawCount;
+        minOffset = std::min(minOffset, rangeOffset);
+        maxIndex  = std::max(maxIndex, rangeMaxIndex);
+    }
+
+    const uint32_t indexSize = program->GetActiveIndexVkType() == VK_INDEX_TYPE_UINT32 ? 4 :
+                               program->GetActiveIndexVkType() == VK_INDEX_TYPE_UINT16 ? 2 : 1;
+    for(uint32_t i = 0; i < drawCount && sharedBuffer; ++i) {
+        if((firsts[i] - minOffset) % indexSize) {
+            sharedBuffer = false;
+            break;
+        }
+        firsts[i] = (firsts[i] - minOffset) / indexSize;
+    }
+
+    if(!sharedBuffer) {
+        for(GLsizei i = 0; i < primcount; ++i) {
+            DrawElements(mode, count[i], type, indices[i]);
+        }
+        return;
+    }
+
+    if(!drawCount) {
+        return;
+    }
+
+    UpdateVertexAttributes(maxIndex + 1, 0, 1);
+
+    if(!PrepareGeometryPipeline()) {
+        return;
+    }
+
+    PushGeometryRanges(true, minOffset, firsts, counts, drawCount);
+}
+
+BufferObject *
+Context::GetDrawIndirectBufferObject(const void *indirect, GLsizei drawcount, GLsizei stride, size_t commandSize)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const size_t offset = reinterpret_cast<size_t>(indirect);
+    BufferObject *indirectBo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER);
+
+    if(!mNoError) {
+        if(drawcount < 0 || stride < 0 || (stride % sizeof(GLuint)) || (offset % sizeof(GLuint))) {
+            RecordError(GL_INVALID_VALUE);
+            return nullptr;
+        }
+
+        // the commands are only ever read from a buffer, every one of them from within it
+        if(!indirectBo || !indirectBo->HasData() || indirectBo->IsMapped() ||
+           (drawcount && offset + static_cast<size_t>(drawcount - 1) * (stride ? stride : commandSize) + commandSize > indirectBo->GetSize())) {
+            RecordError(GL_INVALID_OPERATION);
+            return nullptr;
+        }
+
+        if(mWriteFBO != mSystemFBO && mWriteFBO->CheckStatus() != GL_FRAMEBUFFER_COMPLETE) {
+            RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+            return nullptr;
+        }
+    }
+
+    if(!indirectBo || !drawcount || !mStateManager.GetActiveShaderProgram()) {
+        return nullptr;
+    }
+
+    // the commands may have been read back into the buffer by the frame, or written by compute shaders
+    FinishBufferDeviceWrites(indirectBo);
+    FinishBufferReadbacks(indirectBo);
+
+    return indirectBo;
+}
+
+void
+Context::DrawArraysIndirect(GLenum mode, const void *indirect)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    MultiDrawArraysIndirectEXT(mode, indirect, 1, 0);
+}
+
+void
+Context::DrawElementsIndirect(GLenum mode, GLenum type, const void *indirect)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    MultiDrawElementsIndirectEXT(mode, type, indirect, 1, 0);
+}
+
+void
+Context::MultiDrawArraysIndirectEXT(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mNoError && mode > GL_TRIANGLE_FAN) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    BufferObject *indirectBo = GetDrawIndirectBufferObject(indirect, drawcount, stride, sizeof(VkDrawIndirectCommand));
+    if(!indirectBo) {
+        return;
+    }
+
+    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+        return;
+    }
+
+    const size_t   offset        = reinterpret_cast<size_t>(indirect);
+    const uint32_t commandStride = stride ? static_cast<uint32_t>(stride) : sizeof(VkDrawIndirectCommand);
+
+    // The commands are also read from the host copy of the buffer, for the extent of the vertex data
+    // they draw, which is prepared from the first vertex on, as each command selects its own.
+    FrameArena::Scope scope(mCacheManager->GetFrameArena());
+    VkDrawIndirectCommand *commands = mCacheManager->GetFrameArena()->Allocate<VkDrawIndirectCommand>(drawcount);
+    uint32_t maxEnd       = 0;
+    uint32_t maxInstances = 0;
+    for(GLsizei i = 0; i < drawcount; ++i) {
+        if(!indirectBo->GetData(sizeof(VkDrawIndirectCommand), offset + i * commandStride, &commands[i])) {
+            return;
+        }
+        if(!commands[i].vertexCount || !commands[i].instanceCount) {
+            continue;
+        }
+        maxEnd       = std::max(maxEnd, commands[i].firstVertex + commands[i].vertexCount);
+        maxInstances = std::max(maxInstances, commands[i].instanceCount);
+    }
+
+    if(!maxEnd) {
         return;
     }
 
-    SetClearRect();
+    // line loops and emulated fans are closed and listed by index buffers of their own, per command
+    if(mode == GL_LINE_LOOP || (mode == GL_TRIANGLE_FAN && !mVkContext->mIsTriangleFanSupported)) {
+        for(GLsizei i = 0; i < drawcount; ++i) {
+            DrawArraysInstancedEXT(mode, commands[i].firstVertex, commands[i].vertexCount, commands[i].instanceCount);
+        }
+        return;
+    }
 
-    // color masks are executed implicitly through a screen-space pass (i.e., need an explicit VkPipeline object)
-    bool performCustomClear = (mStateManager.GetFramebufferOperationsState()->ColorMaskActive() && clearColorEnabled);
-    if(!performCustomClear) {
-        ClearSimple(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
-    } else {
-        ClearWithColorMask(false, clearDepthEnabled, clearStencilEnabled);
+    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
     }
-}
 
-void
-Context::ClearSimple(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
+    FlushDrawBatch();
+    if(!BeginGeometry(false)) {
+        return;
+    }
+    UpdateVertexAttributes(maxEnd, 0, maxInstances);
 
-    if(mWriteFBO->IsInDrawState()) {
-        Finish();
+    if(!PrepareGeometryPipeline()) {
+        return;
     }
-    mWriteFBO->SetStateClear();
 
-    BeginRendering(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
+    PushGeometryIndirect(false, 0, indirectBo, offset, drawcount, commandStride);
 }
 
 void
-Context::ClearWithColorMask(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled)
+Context::MultiDrawElementsIndirectEXT(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // perform lazy initialization once
-    if(!mScreenSpacePass->Initialize()) {
+    if(!mNoError && ((mode > GL_TRIANGLE_FAN) || !(type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT))) {
+        RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    // validation check in case this functionality is not available
-    if(!mScreenSpacePass->Valid()) {
+    // the indices are read from the bound element array buffer, as the first index of each command is relative to it
+    BufferObject *ibo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER);
+    if(!ibo) {
+        RecordError(GL_INVALID_OPERATION);
         return;
     }
 
-    if(mWriteFBO->IsInClearState()) {
-        Finish();
+    BufferObject *indirectBo = GetDrawIndirectBufferObject(indirect, drawcount, stride, sizeof(VkDrawIndexedIndirectCommand));
+    if(!indirectBo) {
+        return;
     }
 
-    PrepareRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled);
-
-    StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
-
-    // clearColor is passed as a uniform and masked through VkPipelineColorBlendAttachmentState
-    GLfloat clearColorValue[4] = {0.0f,0.0f,0.0f,0.0f};
-    stateFramebufferOperations->GetClearColor(clearColorValue);
-    if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
-        clearColorValue[3] = 1.0f;
+    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+        return;
     }
 
-    mStateManager.GetFramebufferOperationsState()->GetClearColor(clearColorValue);
-
-    mScreenSpacePass->UpdateUniformBufferColor(clearColorValue[0], clearColorValue[1], clearColorValue[2], clearColorValue[3]);
-
-    vulkanAPI::Pipeline* pipeline = mScreenSpacePass->GetPipeline();
-
-    if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
-        GLboolean colormask[4];
-        mStateManager.GetFramebufferOperationsState()->GetColorMask(colormask);
-        GLubyte colorMaskPackRGB = GlColorMaskPack(colormask[0], colormask[1], colormask[2], GL_FALSE);
-        pipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(colorMaskPackRGB));
-    } else {
-        pipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(stateFramebufferOperations->GetColorMask()));
+    const size_t   offset        = reinterpret_cast<size_t>(indirect);
+    const uint32_t commandStride = stride ? static_cast<uint32_t>(stride) : sizeof(VkDrawIndexedIndirectCommand);
+    const size_t   indexSize     = type == GL_UNSIGNED_INT ? sizeof(GLuint) : type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLubyte);
+
+    // the extent of the indices and of the vertex data the commands draw, read from the host copy of the buffer
+    FrameArena::Scope scope(mCacheManager->GetFrameArena());
+    VkDrawIndexedIndirectCommand *commands = mCacheManager->GetFrameArena()->Allocate<VkDrawIndexedIndirectCommand>(drawcount);
+    uint32_t maxEnd        = 0;
+    uint32_t maxInstances  = 0;
+    int32_t  maxBaseVertex = 0;
+    for(GLsizei i = 0; i < drawcount; ++i) {
+        if(!indirectBo->GetData(sizeof(VkDrawIndexedIndirectCommand), offset + i * commandStride, &commands[i])) {
+            return;
+        }
+        if(!commands[i].indexCount || !commands[i].instanceCount) {
+            continue;
+        }
+        maxEnd        = std::max(maxEnd, commands[i].firstIndex + commands[i].indexCount);
+        maxInstances  = std::max(maxInstances, commands[i].instanceCount);
+        maxBaseVertex = std::max(maxBaseVertex, commands[i].vertexOffset);
     }
 
-    pipeline->SetUpdatePipeline(true);
-    pipeline->SetViewport(mClearRect.x, mClearRect.y, mClearRect.width, mClearRect.height);
-    pipeline->SetScissor(mClearRect.x, mClearRect.y, mClearRect.width, mClearRect.height);
+    if(!maxEnd) {
+        return;
+    }
 
-    if(!pipeline->Create(mWriteFBO->GetVkRenderPass())) {
-        Finish();
+    if(!mNoError && maxEnd * indexSize > ibo->GetSize()) {
+        RecordError(GL_INVALID_OPERATION);
         return;
     }
 
-    mCommandBufferManager->BeginVkDrawCommandBuffer();
-    mWriteFBO->BeginVkRenderPass();
+    // Line loops and emulated fans are drawn per command from index buffers of their own, with their base
+    // vertex applied through the offsets of the vertex buffers, which cannot begin ahead of the buffers.
+    if(mode == GL_LINE_LOOP || (mode == GL_TRIANGLE_FAN && !mVkContext->mIsTriangleFanSupported)) {
+        if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+            mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+        }
+        for(GLsizei i = 0; i < drawcount; ++i) {
+            if(!commands[i].indexCount || !commands[i].instanceCount || commands[i].vertexOffset < 0) {
+                continue;
+            }
+            PushGeometry(commands[i].indexCount, static_cast<uint32_t>(commands[i].vertexOffset), commands[i].instanceCount, true, type,
+                         reinterpret_cast<const void *>(commands[i].firstIndex * indexSize));
+        }
+        return;
+    }
 
-    const VkCommandBuffer *secondaryCmdBuffer = mCommandBufferManager->AllocateVkSecondaryCmdBuffers(1);
-    mCommandBufferManager->BeginVkSecondaryCommandBuffer(secondaryCmdBuffer, *mWriteFBO->GetVkRenderPass(), *mWriteFBO->GetActiveVkFramebuffer());
+    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
+        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    }
 
-    mScreenSpacePass->BindPipeline(secondaryCmdBuffer);
-    mScreenSpacePass->BindUniformDescriptors(secondaryCmdBuffer);
-    mScreenSpacePass->BindVertexBuffers(secondaryCmdBuffer);
+    FlushDrawBatch();
+    FinishBufferDeviceWrites(ibo);
+    if(!BeginGeometry(false)) {
+        return;
+    }
 
-    pipeline->UpdateDynamicState(secondaryCmdBuffer, mStateManager.GetRasterizationState()->GetLineWidth());
+    // the indices are prepared from the first one on, so that the first index of every command still selects its own
+    uint32_t indexOffset = 0;
+    uint32_t maxIndex    = 0;
+    UpdateIndices(&indexOffset, &maxIndex, maxEnd, type, nullptr, ibo);
+    if(!mStateManager.GetActiveShaderProgram()->GetActiveIndexVkBuffer()) {
+        return;
+    }
+    UpdateVertexAttributes(maxIndex + static_cast<uint32_t>(maxBaseVertex) + 1, 0, maxInstances);
 
-    mScreenSpacePass->Draw(secondaryCmdBuffer);
-    mCommandBufferManager->EndVkSecondaryCommandBuffer(secondaryCmdBuffer);
+    if(!PrepareGeometryPipeline()) {
+        return;
+    }
 
-    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
-    vkCmdExecuteCommands(activeCmdBuffer, 1, secondaryCmdBuffer);
-    Finish();
+    PushGeometryIndirect(true, indexOffset, indirectBo, offset, drawcount, commandStride);
 }
 
 void
-Context::UpdateViewportState(vulkanAPI::Pipeline* pipeline)
+Context::Finish(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    StateFragmentOperations* stateFragmentOperations = mStateManager.GetFragmentOperationsState();
-    StateViewportTransformation* stateViewportTransformation = mStateManager.GetViewportTransformationState();
+    STALL_REASON(STALL_REASON_FINISH);
+    const bool flushed = Flush();
 
-    if(pipeline->GetUpdateViewportState()) {
-        Rect viewportRect = stateViewportTransformation->GetViewportRect();
+    // the uploads were submitted apart from the draws, when there were none
+    mCommandBufferManager->GetUploadManager()->WaitAll();
 
-        pipeline->ComputeViewport(mWriteFBO->GetWidth(), mWriteFBO->GetHeight(),
-                                  viewportRect.x, viewportRect.y,
-                                  viewportRect.width, viewportRect.height,
-                                  stateViewportTransformation->GetMinDepthRange(), stateViewportTransformation->GetMaxDepthRange());
+    if(!flushed || !mCommandBufferManager->WaitLastSubmition()) {
+        return;
+    }
 
-        Rect scissorRect = stateFragmentOperations->GetScissorTestEnabled() ?
-                    stateFragmentOperations->GetScissorRect() : viewportRect;
+    mResourceManager->CleanPurgeList();
 
-        pipeline->ComputeScissor(mWriteFBO->GetWidth(), mWriteFBO->GetHeight(),
-                                 scissorRect.x, scissorRect.y,
-                                 scissorRect.width, scissorRect.height);
-       pipeline->SetUpdateViewportState(false);
-    }
+    mWriteFBO->SetStateIdle();
+
+    mCacheManager->CleanUpCaches();
+    mResourceManager->CleanPurgeList();
 }
 
-void
-Context::PushGeometry(uint32_t vertCount, uint32_t firstVertex, bool indexed, GLenum type, const void *indices)
+bool
+Context::Flush(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    SetClearRect();
+    FlushDrawBatch();
 
-    if(mWriteFBO->IsInClearState()) {
-        mWriteFBO->SetStateClearDraw();
+    if(mWriteFBO == nullptr) {
+        // a context without surfaces may still have uploaded to the resources it shares
+        mCommandBufferManager->SubmitVkUploads();
+        return false;
+    }
 
-    } else if(mWriteFBO->IsInIdleState()) {
-        mWriteFBO->SetStateDraw();
-        BeginRendering(false,false,false);
+    ResolvePendingClear();
 
-    } else if(mWriteFBO->IsInClearDrawState()) {
-        mWriteFBO->SetStateDraw();
+    if(mWriteFBO->EndVkRenderPass()) {
+        VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+        PrepareWriteFBOForReading(&activeCmdBuffer);
     }
 
-    //If the primitives are rendered with GL_LINE_LOOP we have to increment the vertCount.
-    //TODO: In future this functionality may be better to stay hidden.
-    if(mStateManager.GetInputAssemblyState()->GetPrimitiveMode() == GL_LINE_LOOP) {
-        mIsModeLineLoop = true;
-        ++vertCount;
-    } else {
-        mIsModeLineLoop = false;
+    if(mCommandBufferManager->IsActiveCommandBufferRecording()) {
+        SubmitDrawCommandBuffer();
     }
 
-    uint32_t indexOffset = 0;
-    uint32_t maxIndex = 0;
-    if(indexed) {
-        UpdateIndices(&indexOffset, &maxIndex, vertCount, type, indices, mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER));
-    }
+    // uploads take the submission of the draws when there is one, and go on their own otherwise
+    return mCommandBufferManager->SubmitVkUploads();
+}
 
-    UpdateVertexAttributes(indexed ? maxIndex + 1 : vertCount, firstVertex);
+bool
+Context::FlushHint(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
-        GLboolean colormask[4];
-        mStateManager.GetFramebufferOperationsState()->GetColorMask(colormask);
-        GLubyte colorMaskPackRGB = GlColorMaskPack(colormask[0], colormask[1], colormask[2], GL_FALSE);
-        mPipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(colorMaskPackRGB));
+    // every submission takes a frame slot of its own, so a glFlush after a few draws keeps them
+    // in the command buffer being recorded, to be submitted along with the work that follows them.
+    // the contexts of a share group rely on it to order their work on the shared resources
+    if(mDrawsSinceSubmit < GLOVE_FLUSH_MIN_DRAWS && !mResourceManager->IsShared()) {
+        return true;
     }
 
-    if(SetPipelineProgramShaderStages(mStateManager.GetActiveShaderProgram())) {
-        if(!mPipeline->Create(mWriteFBO->GetVkRenderPass())) {
-            Finish();
-            return;
-        }
+    return Flush();
+}
+
+vulkanAPI::Fence *
+Context::CreateFence(bool exportable)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the fence follows the commands recorded so far in the queue, so they are submitted first
+    if(!Flush()) {
+        return nullptr;
     }
 
-    if(mWriteFBO->GetColorAttachmentTexture() && mWriteFBO->GetColorAttachmentTexture()->GetFormat() == GL_RGB) {
-        mPipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(mStateManager.GetFramebufferOperationsState()->GetColorMask()));
+    vulkanAPI::Fence *fence = new vulkanAPI::Fence(mVkContext);
+    if(!fence->Create(false, exportable) || !mCommandBufferManager->SubmitVkFence(fence->GetFence())) {
+        delete fence;
+        return nullptr;
     }
 
-    VkCommandBuffer *secondaryCmdBuffer = mCommandBufferManager->AllocateVkSecondaryCmdBuffers(1);
-    mCommandBufferManager->BeginVkSecondaryCommandBuffer(secondaryCmdBuffer, *mWriteFBO->GetVkRenderPass(), *mWriteFBO->GetActiveVkFramebuffer());
+    return fence;
+}
 
-    mPipeline->Bind(secondaryCmdBuffer);
-    BindUniformDescriptors(secondaryCmdBuffer);
-    BindVertexBuffers(secondaryCmdBuffer);
-    if(indexed) {
-        BindIndexBuffer(secondaryCmdBuffer, indexOffset, GlToVkIndexType(type));
+void
+Context::ServerWaitFence(vulkanAPI::Fence *fence)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(fence->WaitFor(0) == VK_SUCCESS) {
+        return;
     }
-    UpdateViewportState(mPipeline);
 
-    mPipeline->UpdateDynamicState(secondaryCmdBuffer, mStateManager.GetRasterizationState()->GetLineWidth());
+    // all contexts submit to the same queue, so the work the fence waits for is already
+    // queued and a barrier in front of the commands recorded from now on is enough
+    if(!Flush()) {
+        return;
+    }
 
-    DrawGeometry(secondaryCmdBuffer, indexed, firstVertex, vertCount);
-    mCommandBufferManager->EndVkSecondaryCommandBuffer(secondaryCmdBuffer);
+    mCommandBufferManager->WaitPriorSubmissions();
+}
 
-    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
-    vkCmdExecuteCommands(activeCmdBuffer, 1, secondaryCmdBuffer);
+bool
+Context::ClientWaitFence(vulkanAPI::Fence *fence, uint64_t timeout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    STALL_REASON(STALL_REASON_SYNC_OBJECT);
+    return fence->WaitFor(timeout) == VK_SUCCESS;
 }
 
-void
-Context::UpdateIndices(uint32_t* offset, uint32_t* maxIndex, uint32_t indexCount, GLenum type, const void* indices, BufferObject* ibo)
+int
+Context::ExportFenceSyncFd(vulkanAPI::Fence *fence)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mPipeline->GetUpdateIndexBuffer() || indices) {
-        mStateManager.GetActiveShaderProgram()->PrepareIndexBufferObject(offset, maxIndex, indexCount, type, indices, ibo);
-        mPipeline->SetUpdateIndexBuffer(false);
-    }
+    // the fence has been submitted on creation, so it has a signal operation pending to export
+    return fence->ExportSyncFd();
 }
 
 void
-Context::UpdateVertexAttributes(uint32_t vertCount, uint32_t firstVertex)
+Context::DestroyFence(vulkanAPI::Fence *fence)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    /// A glVertexAttrib related function has been called. Check to see if mVkPipelineVertexInput needs to be updated.
-    /// If this is true then VkPipeline needs to be updated too.
-    /// Otherwise only the buffer that will be bound with vkCmdBindVertexBuffers need to be updated
-    if(mStateManager.GetActiveShaderProgram()->PrepareVertexAttribBufferObjects(vertCount, firstVertex,
-                                                                                mResourceManager->GetGenericVertexAttributes(),
-                                                                                mPipeline->GetUpdateVertexAttribVBOs())) {
-        mPipeline->SetUpdatePipeline(true);
-        mPipeline->SetUpdateVertexAttribVBOs(false);
-    }
+    // a fence may only be destroyed once its submission has completed
+    STALL_REASON(STALL_REASON_SYNC_OBJECT);
+    fence->Wait(VK_TRUE, UINT64_MAX);
+    delete fence;
 }
 
-void
-Context::BindUniformDescriptors(VkCommandBuffer *CmdBuffer)
+bool
+Context::HasPendingCommands(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(*mStateManager.GetActiveShaderProgram()->GetVkDescSet()) {
-        mStateManager.GetActiveShaderProgram()->UpdateBuiltInUniformData(mStateManager.GetViewportTransformationState()->GetMinDepthRange(),
-                                                                         mStateManager.GetViewportTransformationState()->GetMaxDepthRange());
-        mStateManager.GetActiveShaderProgram()->UpdateDescriptorSet();
-        vkCmdBindDescriptorSets(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mStateManager.GetActiveShaderProgram()->GetVkPipelineLayout(), 0, 1, mStateManager.GetActiveShaderProgram()->GetVkDescSet(), 0, nullptr);
-    }
+    // passes of framebuffers bound earlier stay in the command buffer until it is submitted
+    return HasPendingClear() || mWriteFBO->IsInDrawState() || mCommandBufferManager->IsActiveCommandBufferRecording();
 }
 
-void
-Context::BindVertexBuffers(VkCommandBuffer *CmdBuffer)
+bool
+Context::IsFramebufferPending(const Framebuffer *fbo)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount()) {
-        VkDeviceSize *offsets = new VkDeviceSize[mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount()];
-        memset(offsets, 0, sizeof(VkDeviceSize) * mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount());
-        vkCmdBindVertexBuffers(*CmdBuffer, 0, mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffersCount(), mStateManager.GetActiveShaderProgram()->GetActiveVertexVkBuffers(), offsets);
-        delete[] offsets;
-    }
+    // a render pass of it is recorded in the command buffer that has not been submitted yet, or is about to begin
+    return (fbo == mWriteFBO && HasPendingClear()) ||
+           (mCommandBufferManager->IsActiveCommandBufferRecording() && fbo->GetLastUsedSerial() >= mCommandBufferManager->GetSubmitSerial());
 }
 
 void
-Context::BindIndexBuffer(VkCommandBuffer *CmdBuffer, uint32_t offset, VkIndexType type)
+Context::PrepareWriteFBOForReading(VkCommandBuffer *cmdBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mStateManager.GetActiveShaderProgram()->GetActiveIndexVkBuffer()) {
-        vkCmdBindIndexBuffer(*CmdBuffer, mStateManager.GetActiveShaderProgram()->GetActiveIndexVkBuffer(), offset, type);
+    // the attachments leave the render pass in the layout their next consumer
+    // expects, recorded after the render pass so that no extra submission is needed
+    if(mWriteFBO->IsInDeleteState()) {
+        return;
+    }
+
+    if(mWriteFBO == mSystemFBO) {
+        if(mWriteFBO->GetSurfaceType() == GLOVE_SURFACE_WINDOW) {
+            mWriteFBO->PrepareVkImage(cmdBuffer, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        } else if (mWriteFBO->GetSurfaceType() == GLOVE_SURFACE_PBUFFER) {
+            if(mSystemFBO->GetBindToTexture()) {
+                mWriteFBO->PrepareVkImage(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+        }
+    } else {
+        mWriteFBO->PrepareVkImage(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
 }
 
 void
-Context::DrawGeometry(VkCommandBuffer *CmdBuffer, bool indexed, uint32_t firstVertex, uint32_t vertCount)
+Context::EndFrame(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(indexed == false) {
-        vkCmdDraw(*CmdBuffer, vertCount, 1, firstVertex, 0);
-    } else {
-        vkCmdDrawIndexed(*CmdBuffer, vertCount, 1, 0, 0, 0);
-    }
+    // the transient textures are aliased anew once their order of use within the frame is known
+    mResourceManager->EndTransientTextureFrame(mCommandBufferManager);
 }
 
 void
-Context::DrawArrays(GLenum mode, GLint first, GLsizei count)
+Context::SubmitFrame(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mode > GL_TRIANGLE_FAN) {
-        RecordError(GL_INVALID_ENUM);
-        return;
-    }
-    
-    if(count < 0) {
-        RecordError(GL_INVALID_VALUE);
-        return;
+    if(++mFramesSincePipelineCacheSave >= GLOVE_PIPELINE_CACHE_SAVE_INTERVAL) {
+        vulkanAPI::SavePipelineCache();
+        mFramesSincePipelineCacheSave = 0;
     }
 
-    if(CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+    // the trims of the other contexts in the share group judge this one's use of the shared textures by these
+    mResourceManager->SetContextSerials(mShareGroupSlot, mCommandBufferManager->UpdateCompletedSerial(), mCommandBufferManager->GetSubmitSerial());
+    RelieveMemoryPressure();
+
+    FlushDrawBatch();
+
+    if(mWriteFBO == nullptr) {
         return;
     }
 
-    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+    ResolvePendingClear();
+
+    // a pbuffer that streams its frames is read back by the host, which waits on the frame itself
+    if(mWriteFBO == mSystemFBO && mWriteFBO->GetSurfaceType() == GLOVE_SURFACE_PBUFFER && !mWriteFBO->IsInDeleteState() &&
+       mWriteFBO->GetEGLSurfaceInterface()->readbackBuffers != nullptr) {
+        SubmitPbufferReadback();
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram() || !count) {
+    // only window surfaces can be presented without waiting on the GPU
+    if(mWriteFBO != mSystemFBO || mWriteFBO->GetSurfaceType() != GLOVE_SURFACE_WINDOW || mWriteFBO->IsInDeleteState()) {
+        Finish();
         return;
     }
 
-    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
-        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    // EGL leaves the ancillary buffers undefined after a swap, so the next frame does not load them,
+    // and neither the multisampled color, of which only the resolved image is presented
+    mWriteFBO->DiscardAttachments(mWriteFBO->GetSamples() != VK_SAMPLE_COUNT_1_BIT, true, true);
+
+    if(!mWriteFBO->EndVkRenderPass()) {
+        Texture *colorTexture = mWriteFBO->GetColorAttachmentTexture();
+        if((!colorTexture || colorTexture->GetVkImageLayout() == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) &&
+           !mCommandBufferManager->IsActiveCommandBufferRecording()) {
+            mWriteFBO->SetStateIdle();
+            return;
+        }
+        AcquireDrawCommandBuffer();
     }
 
-    PushGeometry(count, first, false, GL_INVALID_ENUM, nullptr);
+    // the transition to the present layout is recorded in the frame itself,
+    // presentation waits on the draw semaphore so there is no need to block here
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    PrepareWriteFBOForReading(&activeCmdBuffer);
+
+    SubmitDrawCommandBuffer();
+    mCommandBufferManager->PaceFrames(mVkContext->vkSyncItems->maxFramesInFlight);
+
+    mWriteFBO->SetStateIdle();
 }
 
 void
-Context::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+Context::RelieveMemoryPressure(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if( (mode > GL_TRIANGLE_FAN)  || !(type == GL_UNSIGNED_BYTE || type == GL_UNSIGNED_SHORT) ) {
-        RecordError(GL_INVALID_ENUM);
-        return;
-    }
-
-    if(count < 0) {
-        RecordError(GL_INVALID_VALUE);
-        return;
-    }
-
-    if(CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        RecordError(GL_INVALID_FRAMEBUFFER_OPERATION);
+    vulkanAPI::MemoryAllocator *memoryAllocator = mVkContext->memoryAllocator;
+    if(!memoryAllocator) {
         return;
     }
 
-    if(mStateManager.GetRasterizationState()->GetCullFace() == GL_FRONT_AND_BACK && IsDrawModeTriangle(mode)) {
+    memoryAllocator->UpdateBudget();
+    if(!memoryAllocator->IsUnderPressure()) {
         return;
     }
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_MEMORY_TRIMS);
 
-    if(!mStateManager.GetActiveShaderProgram() || !count) {
+    // what is cheapest to recreate goes first, the evicted pipelines are destroyed once their frame retires
+    mCommandBufferManager->GetUploadManager()->ReleaseFreeStagingBuffers();
+    mCacheManager->TrimVkPipelines(GLOVE_MEMORY_PRESSURE_KEPT_PIPELINES);
+    memoryAllocator->Trim();
+    if(!memoryAllocator->IsUnderPressure()) {
         return;
     }
 
-    if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveMode(mode)) {
-        mPipeline->SetInputAssemblyTopology(GlPrimitiveTopologyToVkPrimitiveTopology(mStateManager.GetInputAssemblyState()->GetPrimitiveMode()));
+    // idle textures are brought back to the host, to be uploaded again when they are next sampled,
+    // shared ones only once every context of the group that sampled them has been seen done with them
+    if(mResourceManager->EvictIdleTextures(mShareGroupSlot, mCommandBufferManager)) {
+        memoryAllocator->Trim();
     }
-
-    PushGeometry(count, 0, true, type, indices);
 }
 
 void
-Context::Finish(void)
+Context::SubmitPbufferReadback(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!Flush()) {
-        return;
-    }
+    // the next frame is rendered to another image of the pbuffer, so the ancillary buffers are not kept either
+    mWriteFBO->DiscardAttachments(mWriteFBO->GetSamples() != VK_SAMPLE_COUNT_1_BIT, true, true);
 
-    if(!mCommandBufferManager->WaitLastSubmition()) {
-        return;
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
     }
 
-    mResourceManager->CleanPurgeList();
+    // the copy follows the frame in the same submission, the rows keep the bottom-up order of glReadPixels
+    const EGLSurfaceInterface *surface = mWriteFBO->GetEGLSurfaceInterface();
+    VkBuffer readbackBuffer = static_cast<VkBuffer *>(surface->readbackBuffers)[surface->nextImageIndex];
+    Texture *colorTexture = mWriteFBO->GetColorAttachmentTexture();
+    Rect rect(0, 0, static_cast<int>(surface->width), static_cast<int>(surface->height));
 
-    if(!mWriteFBO->IsInDeleteState()) {
-        if(mWriteFBO == mSystemFBO) {
-            if(mWriteFBO->GetSurfaceType() == GLOVE_SURFACE_WINDOW) {
-                mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-            } else if (mWriteFBO->GetSurfaceType() == GLOVE_SURFACE_PBUFFER) {
-                if(mSystemFBO->GetBindToTexture()) {
-                    mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-                }
-            }
-        } else {
-            mWriteFBO->PrepareVkImage(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        }
-    }
-    mWriteFBO->SetStateIdle();
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    colorTexture->CopyToVkBuffer(&activeCmdBuffer, &rect, readbackBuffer);
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_BYTES_READ_BACK,
+                                  static_cast<uint64_t>(surface->width) * surface->height *
+                                  GlInternalFormatTypeToNumElements(colorTexture->GetExplicitInternalFormat(), colorTexture->GetExplicitType()) *
+                                  GlTypeToElementSize(colorTexture->GetExplicitType()));
+    colorTexture->SetLastUsedSerial(mShareGroupSlot, mCommandBufferManager->GetSubmitSerial());
 
-    mCacheManager->CleanUpCaches();
-    mResourceManager->CleanPurgeList();
+    SubmitDrawCommandBuffer();
+
+    mWriteFBO->SetStateIdle();
 }
 
-bool
-Context::Flush(void)
+void
+Context::SetDamageRegion(const EGLint *rects, EGLint count)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mWriteFBO == nullptr) {
-        return false;
+    if(mSystemFBO == nullptr) {
+        return;
     }
 
-    if(mWriteFBO->EndVkRenderPass()) {
-        mCommandBufferManager->EndVkDrawCommandBuffer();
-        mCommandBufferManager->SubmitVkDrawCommandBuffer();
+    if(count <= 0) {
+        mSystemFBO->SetDamageArea(nullptr);
+        return;
     }
 
-    return true;
+    // a single render area covers all the rectangles, which EGL gives with a bottom-left origin
+    int x0 = rects[0], y0 = rects[1], x1 = rects[0] + rects[2], y1 = rects[1] + rects[3];
+    for(EGLint i = 1; i < count; ++i) {
+        const EGLint *rect = &rects[4 * i];
+        x0 = std::min(x0, rect[0]);
+        y0 = std::min(y0, rect[1]);
+        x1 = std::max(x1, rect[0] + rect[2]);
+        y1 = std::max(y1, rect[1] + rect[3]);
+    }
+
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, mSystemFBO->GetWidth());
+    y1 = std::min(y1, mSystemFBO->GetHeight());
+    if(x1 <= x0 || y1 <= y0) {
+        mSystemFBO->SetDamageArea(nullptr);
+        return;
+    }
+
+    const Rect damage = mSystemFBO->PreRotateRect(Rect(x0, mSystemFBO->GetHeight() - y1, x1 - x0, y1 - y0));
+    mSystemFBO->SetDamageArea(&damage);
 }
 
 void
@@ -492,7 +2125,8 @@ Context::SetClearRect(void)
 
     if(stateFragmentOperations->GetScissorTestEnabled()) {
         x = stateFragmentOperations->GetScissorRectX();
-        y = mWriteFBO->GetHeight() - stateFragmentOperations->GetScissorRectY() - stateFragmentOperations->GetScissorRectHeight();
+        y = mWriteFBO->IsStoredUpright() ? stateFragmentOperations->GetScissorRectY() :
+            mWriteFBO->GetHeight() - stateFragmentOperations->GetScissorRectY() - stateFragmentOperations->GetScissorRectHeight();
 
         if(x < mWriteFBO->GetX()) {
             w = stateFragmentOperations->GetScissorRectWidth() + x;
@@ -522,4 +2156,9 @@ Context::SetClearRect(void)
     mClearRect.y      = std::max(mWriteFBO->GetY()     , y);
     mClearRect.width  = std::min(mWriteFBO->GetWidth() , w);
     mClearRect.height = std::min(mWriteFBO->GetHeight(), h);
+
+    // clears and render areas are given in the images as they are stored
+    if(mWriteFBO->IsPreRotated()) {
+        mClearRect = mWriteFBO->PreRotateRect(mClearRect);
+    }
 }
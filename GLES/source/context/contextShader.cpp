@@ -39,7 +39,7 @@ Context::CompileShader(GLuint shader)
 
     CreateShaderCompiler();
 
-    shaderPtr->CompileShader();
+    shaderPtr->CompileShader(mShaderCompileQueue);
 }
 
 GLuint
@@ -47,14 +47,14 @@ Context::CreateShader(GLenum type)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(type != GL_VERTEX_SHADER && type != GL_FRAGMENT_SHADER) {
+    if(type != GL_VERTEX_SHADER && type != GL_FRAGMENT_SHADER && type != GL_COMPUTE_SHADER) {
         RecordError(GL_INVALID_ENUM);
         return 0;
     }
 
     GLuint res     = mResourceManager->AllocateShader();
     Shader *shader = mResourceManager->GetShader(res);
-    shader->SetShaderType(type == GL_VERTEX_SHADER ? SHADER_TYPE_VERTEX : SHADER_TYPE_FRAGMENT);
+    shader->SetShaderType(type == GL_VERTEX_SHADER ? SHADER_TYPE_VERTEX : type == GL_COMPUTE_SHADER ? SHADER_TYPE_COMPUTE : SHADER_TYPE_FRAGMENT);
     shader->SetVkContext(mVkContext);
     shader->SetShaderCompiler(mShaderCompiler);
 
@@ -78,11 +78,7 @@ Context::DeleteShader(GLuint shader)
     shaderPtr->SetMarkForDeletion(true);
 
     if(shaderPtr->FreeForDeletion()) {
-        // Flush in case the shader is part of the pipeline
-        // Optimization: perform this only when needed or defer deletion
-        if(mWriteFBO->IsInDrawState()) {
-            Flush();
-        }
+        // shader modules are not referred to by command buffers once the pipelines are built
         mResourceManager->EraseShadingObject(shader);
         mResourceManager->DeallocateShader(shaderPtr);
     } else {
@@ -92,7 +88,7 @@ Context::DeleteShader(GLuint shader)
 }
 
 Shader *
-Context::GetShaderPtr(GLuint shader)
+Context::FindShaderPtr(GLuint shader)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -107,7 +103,25 @@ Context::GetShaderPtr(GLuint shader)
         return nullptr;
     }
 
-    return mResourceManager->GetShader(shadId.arrayIndex);
+    // the shader may have been created by another context of the share group
+    Shader *shaderPtr = mResourceManager->GetShader(shadId.arrayIndex);
+    shaderPtr->SetShaderCompiler(mShaderCompiler);
+
+    return shaderPtr;
+}
+
+Shader *
+Context::GetShaderPtr(GLuint shader)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // a compile running in the background is only waited for once the shader is used
+    Shader *shaderPtr = FindShaderPtr(shader);
+    if(shaderPtr) {
+        shaderPtr->CompleteCompile();
+    }
+
+    return shaderPtr;
 }
 
 void
@@ -115,6 +129,14 @@ Context::GetShaderiv(GLuint shader, GLenum pname, GLint *params)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(pname == GL_COMPLETION_STATUS_KHR) {
+        Shader *shaderPtr = FindShaderPtr(shader);
+        if(shaderPtr) {
+            *params = shaderPtr->IsCompilePending() ? GL_FALSE : GL_TRUE;
+        }
+        return;
+    }
+
     Shader *shaderPtr = GetShaderPtr(shader);
     if(!shaderPtr) {
         return;
@@ -125,7 +147,8 @@ Context::GetShaderiv(GLuint shader, GLenum pname, GLint *params)
     case GL_DELETE_STATUS:          *params = shaderPtr->GetMarkForDeletion()   ? GL_TRUE : GL_FALSE; break;
     case GL_INFO_LOG_LENGTH:        *params = shaderPtr->GetInfoLogLength();      break;
     case GL_SHADER_SOURCE_LENGTH:   *params = shaderPtr->GetShaderSourceLength(); break;
-    case GL_SHADER_TYPE:            *params = shaderPtr->GetShaderType() == SHADER_TYPE_FRAGMENT ? GL_FRAGMENT_SHADER : GL_VERTEX_SHADER; break;
+    case GL_SHADER_TYPE:            *params = shaderPtr->GetShaderType() == SHADER_TYPE_FRAGMENT ? GL_FRAGMENT_SHADER :
+                                              shaderPtr->GetShaderType() == SHADER_TYPE_COMPUTE  ? GL_COMPUTE_SHADER  : GL_VERTEX_SHADER; break;
     default:                        RecordError(GL_INVALID_ENUM); break;
     }
 
@@ -328,12 +351,21 @@ Context::ReleaseShaderCompiler(void)
         return;
     }
 
+    // the compiler object stays, shaders and programs keep pointing to it for their reflection
     if(mShaderCompiler != nullptr) {
-        delete mShaderCompiler;
-        mShaderCompiler = nullptr;
+        mShaderCompiler->ReleaseCompiler();
     }
 }
 
+void
+Context::MaxShaderCompilerThreadsKHR(GLuint count)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // 0xFFFFFFFF asks for as many threads as the implementation sees fit
+    mShaderCompileQueue->SetMaxThreads(count == 0xFFFFFFFF ? GLOVE_TASK_QUEUE_MAX_THREADS : count);
+}
+
 void
 Context::CreateShaderCompiler(void)
 {
@@ -343,15 +375,15 @@ Context::CreateShaderCompiler(void)
         mShaderCompiler = new GlslangShaderCompiler();
 
         ObjectArray<Shader> *shaderArray = mResourceManager->GetShaderArray();
-        for(typename map<uint32_t, Shader *>::const_iterator it =
+        for(typename vector<Shader *>::const_iterator it =
         shaderArray->GetObjects()->begin(); it != shaderArray->GetObjects()->end(); it++) {
-            it->second->SetShaderCompiler(mShaderCompiler);
+            (*it)->SetShaderCompiler(mShaderCompiler);
         }
 
         ObjectArray<ShaderProgram> *shaderProgramArray = mResourceManager->GetShaderProgramArray();
-        for(typename map<uint32_t, ShaderProgram *>::const_iterator it =
+        for(typename vector<ShaderProgram *>::const_iterator it =
         shaderProgramArray->GetObjects()->begin(); it != shaderProgramArray->GetObjects()->end(); it++) {
-            it->second->SetShaderCompiler(mShaderCompiler);
+            (*it)->SetShaderCompiler(mShaderCompiler);
         }
     }
 }
@@ -39,7 +39,8 @@ Context::AttachShader(GLuint program, GLuint shader)
     }
 
     if((progPtr->HasFragmentShader() && shaderPtr->GetShaderType() == SHADER_TYPE_FRAGMENT) ||
-       (progPtr->HasVertexShader()   && shaderPtr->GetShaderType() == SHADER_TYPE_VERTEX)) {
+       (progPtr->HasVertexShader()   && shaderPtr->GetShaderType() == SHADER_TYPE_VERTEX)   ||
+       (progPtr->HasComputeShader()  && shaderPtr->GetShaderType() == SHADER_TYPE_COMPUTE)) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -50,7 +51,7 @@ Context::AttachShader(GLuint program, GLuint shader)
     }
 
     progPtr->AttachShader(shaderPtr);
-    progPtr->SetStagesIDs(shaderPtr->GetShaderType() == SHADER_TYPE_VERTEX ? 0 : 1, shader);
+    progPtr->SetStagesIDs(shaderPtr->GetShaderType() == SHADER_TYPE_FRAGMENT ? 1 : 0, shader);
 }
 
 void
@@ -107,14 +108,10 @@ Context::DeleteProgram(GLuint program)
     progPtr->SetMarkForDeletion(true);
 
     if(progPtr->FreeForDeletion()) {
-        // Flush in case the shader is part of the pipeline
-        // Optimization: perform this only when needed or defer deletion
-        if(mWriteFBO->IsInDrawState()) {
-            Finish();
-        }
+        // command buffers in flight may still use its Vulkan objects, so it retires along with them
         progPtr->DetachShaders();
         mResourceManager->EraseShadingObject(program);
-        mResourceManager->DeallocateShaderProgram(progPtr);
+        mResourceManager->RetireShaderProgram(progPtr);
     } else {
         ResourceManager* resourceManager = GetCurrentContext()->GetResourceManager();
         resourceManager->AddToPurgeList(progPtr);
@@ -144,11 +141,7 @@ Context::DetachShader(GLuint program, GLuint shader)
     progPtr->DetachShader(shaderPtr);
 
     if(shaderPtr->GetMarkForDeletion() && shaderPtr->FreeForDeletion()) {
-        // Flush in case the shader is part of the pipeline
-        // Optimization: perform this only when needed or defer deletion
-        if(mWriteFBO->IsInDrawState()) {
-            Flush();
-        }
+        // shader modules are not referred to by command buffers once the pipelines are built
         mResourceManager->CleanPurgeList();
     }
 }
@@ -168,6 +161,15 @@ Context::GetAttachedShaders(GLuint program, GLsizei maxcount, GLsizei* count, GL
         return;
     }
 
+    // a compute shader is never attached along with the others
+    if(progPtr->HasComputeShader()) {
+        if(maxcount >= 1) {
+            shaders[0] = GetShaderId(progPtr->GetComputeShader());
+        }
+        if(count) *count = maxcount >= 1 ? 1 : 0;
+        return;
+    }
+
     int shaderCount = progPtr->HasVertexShader() + progPtr->HasFragmentShader();
     if(!shaderCount) {
         if(count) *count = 0;
@@ -296,21 +298,29 @@ Context::GetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei *length, G
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    (void)binaryFormat;
-
     ShaderProgram *progPtr = GetProgramPtr(program);
     if(!progPtr) {
         return;
     }
 
-    progPtr->GetBinaryData(binary, length);
-
-    if(bufSize < *length) {
-        *length = 0;
+    // nothing is written unless the whole binary fits
+    if(!progPtr->IsLinked() || progPtr->IsCompute() || progPtr->HasTransformFeedback() || bufSize < progPtr->GetBinaryLength()) {
+        if(length) {
+            *length = 0;
+        }
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
+    GLsizei binaryLength = 0;
+    progPtr->GetBinaryData(binary, bufSize, &binaryLength);
+    if(length) {
+        *length = binaryLength;
+    }
+    if(binaryFormat) {
+        *binaryFormat = GLOVE_DEV_BINARY;
+    }
+
     return;
 }
 
@@ -352,7 +362,7 @@ Context::GetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, cha
 }
 
 ShaderProgram *
-Context::GetProgramPtr(GLuint program)
+Context::FindProgramPtr(GLuint program)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -367,7 +377,53 @@ Context::GetProgramPtr(GLuint program)
         return nullptr;
     }
 
-    return mResourceManager->GetShaderProgram(progId.arrayIndex);
+    // the program may have been created by another context of the share group
+    ShaderProgram *progPtr = mResourceManager->GetShaderProgram(progId.arrayIndex);
+    progPtr->SetShaderCompiler(mShaderCompiler);
+    progPtr->SetCacheManager(mCacheManager);
+
+    return progPtr;
+}
+
+ShaderProgram *
+Context::GetProgramPtr(GLuint program)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the executable lives in the attached shaders, so every call on the program waits for a link in flight
+    ShaderProgram *progPtr = FindProgramPtr(program);
+    if(progPtr) {
+        CompleteProgramLink(progPtr);
+    }
+
+    return progPtr;
+}
+
+void
+Context::CompleteProgramLink(ShaderProgram *progPtr)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!progPtr->HasLinkJob()) {
+        return;
+    }
+
+    // the shader modules of the previous link may still be referred to by recorded commands
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    progPtr->CompleteLink();
+    progPtr->SetShaderModules();
+    progPtr->WarmUpVkPipelines();
+
+    mPipeline->SetUpdatePipeline(progPtr->IsLinked());
+    if(SetPipelineProgramShaderStages(progPtr)) {
+        progPtr->PrepareVertexAttribBufferObjects(0, 0, 1, mVertexArray, true);
+        mPipeline->Create(mSystemFBO->GetRenderPass());
+        // rebuild the pipeline next time
+        mPipeline->SetUpdatePipeline(true);
+    }
 }
 
 void
@@ -378,12 +434,16 @@ Context::GetProgramiv(GLuint program, GLenum pname, GLint* params)
     if(pname != GL_DELETE_STATUS && pname != GL_LINK_STATUS && pname != GL_VALIDATE_STATUS &&
        pname != GL_INFO_LOG_LENGTH && pname != GL_ATTACHED_SHADERS && pname != GL_ACTIVE_ATTRIBUTES &&
        pname != GL_ACTIVE_ATTRIBUTE_MAX_LENGTH && pname != GL_ACTIVE_UNIFORMS &&
-       pname != GL_ACTIVE_UNIFORM_MAX_LENGTH && pname != GL_PROGRAM_BINARY_LENGTH_OES) {
+       pname != GL_ACTIVE_UNIFORM_MAX_LENGTH && pname != GL_PROGRAM_BINARY_LENGTH_OES &&
+       pname != GL_COMPLETION_STATUS_KHR && pname != GL_ACTIVE_UNIFORM_BLOCKS &&
+       (!mVkContext->mIsTransformFeedbackSupported ||
+        (pname != GL_TRANSFORM_FEEDBACK_VARYINGS && pname != GL_TRANSFORM_FEEDBACK_BUFFER_MODE &&
+         pname != GL_TRANSFORM_FEEDBACK_VARYING_MAX_LENGTH))) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    ShaderProgram *progPtr = GetProgramPtr(program);
+    ShaderProgram *progPtr = FindProgramPtr(program);
     if(!progPtr) {
         RecordError(GL_INVALID_VALUE);
         return;
@@ -394,17 +454,28 @@ Context::GetProgramiv(GLuint program, GLenum pname, GLint* params)
         return;
     }
 
+    if(pname == GL_COMPLETION_STATUS_KHR) {
+        *params = progPtr->IsLinkPending() ? GL_FALSE : GL_TRUE;
+        return;
+    }
+
+    CompleteProgramLink(progPtr);
+
     switch(pname) {
     case GL_DELETE_STATUS:               *params = progPtr->GetMarkForDeletion() ? GL_TRUE : GL_FALSE; break;
     case GL_LINK_STATUS:                 *params = progPtr->IsLinked() ? GL_TRUE : GL_FALSE; break;
     case GL_VALIDATE_STATUS:             *params = progPtr->IsValidated() ? GL_TRUE : GL_FALSE; break;
     case GL_INFO_LOG_LENGTH:             *params = progPtr->GetInfoLogLength(); break;
-    case GL_ATTACHED_SHADERS:            *params = (bool)progPtr->GetVertexShader() + (bool)progPtr->GetFragmentShader(); break;
+    case GL_ATTACHED_SHADERS:            *params = (bool)progPtr->GetVertexShader() + (bool)progPtr->GetFragmentShader() + (bool)progPtr->GetComputeShader(); break;
     case GL_ACTIVE_ATTRIBUTES:           *params = progPtr->GetNumberOfActiveAttributes(); break;
     case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH: *params = static_cast<GLint>(progPtr->GetActiveAttribMaxLen()); break;
     case GL_ACTIVE_UNIFORMS:             *params = progPtr->GetNumberOfActiveUniforms(); break;
     case GL_ACTIVE_UNIFORM_MAX_LENGTH:   *params = static_cast<GLint>(progPtr->GetActiveUniformMaxLen()); break;
     case GL_PROGRAM_BINARY_LENGTH_OES:   *params = progPtr->GetBinaryLength(); break;
+    case GL_ACTIVE_UNIFORM_BLOCKS:       *params = static_cast<GLint>(progPtr->GetUniformBufferBlockCount()); break;
+    case GL_TRANSFORM_FEEDBACK_VARYINGS: *params = static_cast<GLint>(progPtr->GetTransformFeedbackVaryings().size()); break;
+    case GL_TRANSFORM_FEEDBACK_BUFFER_MODE: *params = static_cast<GLint>(progPtr->GetTransformFeedbackBufferMode()); break;
+    case GL_TRANSFORM_FEEDBACK_VARYING_MAX_LENGTH: *params = static_cast<GLint>(progPtr->GetTransformFeedbackVaryingMaxLen()); break;
     default:                             RecordError(GL_INVALID_ENUM); return; break;
     }
 }
@@ -602,6 +673,7 @@ Context::SetPipelineProgramShaderStages(ShaderProgram *progPtr)
 
     mPipeline->SetCache(progPtr->GetVkPipelineCache());
     mPipeline->SetLayout(progPtr->GetVkPipelineLayout());
+    mPipeline->SetProgramHash(progPtr->GetShaderSpirvHash());
     mPipeline->SetVertexInputState(progPtr->GetVkPipelineVertexInput());
 
     return true;
@@ -617,19 +689,18 @@ Context::LinkProgram(GLuint program)
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
-        Finish();
+    // the outputs being captured are those of the program in use
+    if(mTransformFeedback.active && mStateManager.GetActiveShaderProgram() == progPtr) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
     }
 
-    progPtr->LinkProgram();
-    progPtr->SetShaderModules();
+    CreateShaderCompiler();
 
-    mPipeline->SetUpdatePipeline(progPtr->IsLinked());
-    if(SetPipelineProgramShaderStages(progPtr)) {
-        progPtr->PrepareVertexAttribBufferObjects(0, 0, mResourceManager->GetGenericVertexAttributes(), true);
-        mPipeline->Create(mSystemFBO->GetVkRenderPass());
-        // rebuild the pipeline next time
-        mPipeline->SetUpdatePipeline(true);
+    // the link runs on the compile queue; only the program in use is replaced right away, as draws read it directly
+    progPtr->LinkProgram(mShaderCompileQueue);
+    if(mStateManager.GetActiveShaderProgram() == progPtr) {
+        CompleteProgramLink(progPtr);
     }
 }
 
@@ -638,7 +709,7 @@ Context::Uniform1f(GLint location, GLfloat x)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -648,8 +719,8 @@ Context::Uniform1f(GLint location, GLfloat x)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT && uniform->type != GL_BOOL)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT && uniform->type != GL_BOOL))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -667,12 +738,12 @@ Context::Uniform1fv(GLint location, GLsizei count, const GLfloat *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -682,9 +753,9 @@ Context::Uniform1fv(GLint location, GLsizei count, const GLfloat *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT && uniform->type != GL_BOOL) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT && uniform->type != GL_BOOL) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -711,7 +782,7 @@ Context::Uniform1i(GLint location, GLint x)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -721,15 +792,15 @@ Context::Uniform1i(GLint location, GLint x)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_INT        && uniform->type != GL_BOOL &&
-        uniform->type != GL_SAMPLER_2D && uniform->type != GL_SAMPLER_CUBE)
-      ) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_INT        && uniform->type != GL_BOOL &&
+                      !IsGlSampler(uniform->type))
+                    )) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
-    if(uniform->type == GL_SAMPLER_2D || uniform->type == GL_SAMPLER_CUBE) {
+    if(IsGlSampler(uniform->type)) {
         mStateManager.GetActiveShaderProgram()->SetUniformSampler(location, 1, &x);
     } else if(uniform->type == GL_INT) {
         mStateManager.GetActiveShaderProgram()->SetUniformData(location, sizeof(int), &x);
@@ -744,12 +815,12 @@ Context::Uniform1iv(GLint location, GLsizei count, const GLint *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -759,10 +830,10 @@ Context::Uniform1iv(GLint location, GLsizei count, const GLint *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform ) ||
-       (uniform->type != GL_INT && uniform->type != GL_BOOL &&
-        uniform->type != GL_SAMPLER_2D && uniform->type != GL_SAMPLER_CUBE) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform ) ||
+                     (uniform->type != GL_INT && uniform->type != GL_BOOL &&
+                      !IsGlSampler(uniform->type)) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -772,7 +843,7 @@ Context::Uniform1iv(GLint location, GLsizei count, const GLint *v)
         count = uniform->arraySize - (location - (GLint)uniform->location);
     }
 
-    if(uniform->type == GL_SAMPLER_2D || uniform->type == GL_SAMPLER_CUBE) {
+    if(IsGlSampler(uniform->type)) {
         mStateManager.GetActiveShaderProgram()->SetUniformSampler(location, count, v);
     } else if(uniform->type == GL_INT) {
         mStateManager.GetActiveShaderProgram()->SetUniformData(location, count * sizeof(int), static_cast<const void *>(v));
@@ -791,7 +862,7 @@ Context::Uniform2f(GLint location, GLfloat x, GLfloat y)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -801,8 +872,8 @@ Context::Uniform2f(GLint location, GLfloat x, GLfloat y)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_VEC2 && uniform->type != GL_BOOL_VEC2)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_VEC2 && uniform->type != GL_BOOL_VEC2))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -821,12 +892,12 @@ Context::Uniform2fv(GLint location, GLsizei count, const GLfloat *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -836,9 +907,9 @@ Context::Uniform2fv(GLint location, GLsizei count, const GLfloat *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_VEC2 && uniform->type != GL_BOOL_VEC2) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_VEC2 && uniform->type != GL_BOOL_VEC2) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -865,7 +936,7 @@ Context::Uniform2i(GLint location, GLint x, GLint y)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -875,8 +946,8 @@ Context::Uniform2i(GLint location, GLint x, GLint y)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-        (uniform->type != GL_INT_VEC2 && uniform->type != GL_BOOL_VEC2)) {
+    if(!mNoError && ((!uniform) ||
+                      (uniform->type != GL_INT_VEC2 && uniform->type != GL_BOOL_VEC2))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -895,12 +966,12 @@ Context::Uniform2iv(GLint location, GLsizei count, const GLint *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -910,9 +981,9 @@ Context::Uniform2iv(GLint location, GLsizei count, const GLint *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_INT_VEC2 && uniform->type != GL_BOOL_VEC2) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_INT_VEC2 && uniform->type != GL_BOOL_VEC2) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -939,7 +1010,7 @@ Context::Uniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -949,8 +1020,8 @@ Context::Uniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_VEC3 && uniform->type != GL_BOOL_VEC3)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_VEC3 && uniform->type != GL_BOOL_VEC3))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -969,12 +1040,12 @@ Context::Uniform3fv(GLint location, GLsizei count, const GLfloat *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -984,9 +1055,9 @@ Context::Uniform3fv(GLint location, GLsizei count, const GLfloat *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_VEC3 && uniform->type != GL_BOOL_VEC3) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_VEC3 && uniform->type != GL_BOOL_VEC3) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -997,7 +1068,7 @@ Context::Uniform3fv(GLint location, GLsizei count, const GLfloat *v)
     }
 
     if(uniform->type == GL_FLOAT_VEC3) {
-        mStateManager.GetActiveShaderProgram()->SetUniformData(location, 3 * count * sizeof(float), static_cast<const void *>(v));
+        mStateManager.GetActiveShaderProgram()->SetUniformColumns(location, static_cast<uint32_t>(count), 1, 3, false, v);
     } else {
         glsl_bool_t *bv = new glsl_bool_t[3 * count];
         for(int i = 0; i < 3 * count; ++i) {
@@ -1013,7 +1084,7 @@ Context::Uniform3i(GLint location, GLint x, GLint y, GLint z)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1023,8 +1094,8 @@ Context::Uniform3i(GLint location, GLint x, GLint y, GLint z)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_INT_VEC3 && uniform->type != GL_BOOL_VEC3)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_INT_VEC3 && uniform->type != GL_BOOL_VEC3))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1043,12 +1114,12 @@ Context::Uniform3iv(GLint location, GLsizei count, const GLint *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1058,9 +1129,9 @@ Context::Uniform3iv(GLint location, GLsizei count, const GLint *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_INT_VEC3 && uniform->type != GL_BOOL_VEC3) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_INT_VEC3 && uniform->type != GL_BOOL_VEC3) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1087,7 +1158,7 @@ Context::Uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1097,8 +1168,8 @@ Context::Uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_VEC4 && uniform->type != GL_BOOL_VEC4)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_VEC4 && uniform->type != GL_BOOL_VEC4))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1117,12 +1188,12 @@ Context::Uniform4fv(GLint location, GLsizei count, const GLfloat *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1132,9 +1203,9 @@ Context::Uniform4fv(GLint location, GLsizei count, const GLfloat *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_VEC4 && uniform->type != GL_BOOL_VEC4) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_VEC4 && uniform->type != GL_BOOL_VEC4) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1161,7 +1232,7 @@ Context::Uniform4i(GLint location, GLint x, GLint y, GLint z, GLint w)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1171,8 +1242,8 @@ Context::Uniform4i(GLint location, GLint x, GLint y, GLint z, GLint w)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_INT_VEC4 && uniform->type != GL_BOOL_VEC4)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_INT_VEC4 && uniform->type != GL_BOOL_VEC4))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1191,12 +1262,12 @@ Context::Uniform4iv(GLint location, GLsizei count, const GLint *v)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1206,9 +1277,9 @@ Context::Uniform4iv(GLint location, GLsizei count, const GLint *v)
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_INT_VEC4 && uniform->type != GL_BOOL_VEC4) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_INT_VEC4 && uniform->type != GL_BOOL_VEC4) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1235,17 +1306,17 @@ Context::UniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, co
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(transpose != GL_FALSE) {
+    if(!mNoError && transpose != GL_FALSE) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1255,9 +1326,9 @@ Context::UniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, co
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_MAT2) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_MAT2) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1267,18 +1338,8 @@ Context::UniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, co
         count = uniform->arraySize - (location - (GLint)uniform->location);
     }
 
-    glsl_mat2_t *v = new glsl_mat2_t[count];
-    for (int k = 0; k < count; k++) {
-        for (int i = 0; i < 2; i++) {
-            for (int j = 0; j < 2; j++) {
-                v[k].fm[i].f[j] = (*value++);
-            }
-            v[k].fm[i].f[2] = 0.0f;
-            v[k].fm[i].f[3] = 0.0f;
-        }
-    }
-    mStateManager.GetActiveShaderProgram()->SetUniformData(location, 2 * 4 * count * sizeof(float), static_cast<void *>(v));
-    delete[] v;
+    // the columns are padded to vec4 straight into the uniform data
+    mStateManager.GetActiveShaderProgram()->SetUniformColumns(location, static_cast<uint32_t>(count), 2, 2, transpose != GL_FALSE, value);
 }
 
 void
@@ -1286,17 +1347,17 @@ Context::UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, co
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(transpose != GL_FALSE) {
+    if(!mNoError && transpose != GL_FALSE) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1306,9 +1367,9 @@ Context::UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, co
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_MAT3) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_MAT3) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1318,17 +1379,8 @@ Context::UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, co
         count = uniform->arraySize - (location - (GLint)uniform->location);
     }
 
-    glsl_mat3_t *v = new glsl_mat3_t[count];
-    for (int k = 0; k < count; k++) {
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                v[k].fm[i].f[j] = (*value++);
-            }
-            v[k].fm[i].f[3] = 0.0f;
-        }
-    }
-    mStateManager.GetActiveShaderProgram()->SetUniformData(location, 3 * 4 * count * sizeof(float), static_cast<void *>(v));
-    delete[] v;
+    // the columns are padded to vec4 straight into the uniform data
+    mStateManager.GetActiveShaderProgram()->SetUniformColumns(location, static_cast<uint32_t>(count), 3, 3, transpose != GL_FALSE, value);
 }
 
 void
@@ -1336,17 +1388,17 @@ Context::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, co
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(count < 0) {
+    if(!mNoError && count < 0) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(transpose != GL_FALSE) {
+    if(!mNoError && transpose != GL_FALSE) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    if(!mStateManager.GetActiveShaderProgram()) {
+    if(!mNoError && !mStateManager.GetActiveShaderProgram()) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1356,9 +1408,9 @@ Context::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, co
     }
 
     const ShaderResourceInterface::uniform *uniform = mStateManager.GetActiveShaderProgram()->GetUniformAtLocation(location);
-    if((!uniform) ||
-       (uniform->type != GL_FLOAT_MAT4) ||
-       (uniform->arraySize == 1 && count > 1)) {
+    if(!mNoError && ((!uniform) ||
+                     (uniform->type != GL_FLOAT_MAT4) ||
+                     (uniform->arraySize == 1 && count > 1))) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -1378,6 +1430,11 @@ Context::UseProgram(GLuint program)
 
     ShaderProgram *progPtr = nullptr;
 
+    if(mTransformFeedback.active) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
     if(program) {
         progPtr = GetProgramPtr(program);
         if(!progPtr) {
@@ -1388,7 +1445,7 @@ Context::UseProgram(GLuint program)
             return;
         }
 
-        if(!progPtr->IsLinked()) {
+        if(!mNoError && !progPtr->IsLinked()) {
             RecordError(GL_INVALID_OPERATION);
             return;
         }
@@ -1457,6 +1514,49 @@ Context::ProgramBinaryOES(GLuint program, GLenum binaryFormat, const void *binar
     AttachShader(program, vs);
     AttachShader(program, fs);
 
-    progPtr->UsePrecompiledBinary(binary, length);
+    if(!progPtr->UsePrecompiledBinary(binary, length)) {
+        return;
+    }
     progPtr->SetShaderModules();
+    progPtr->WarmUpVkPipelines();
+}
+
+// [GLOVE_uniform_buffer_object]
+
+GLuint
+Context::GetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ShaderProgram *progPtr = GetProgramPtr(program);
+    if(!progPtr) {
+        RecordError(IsShader(program) ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+        return GL_INVALID_INDEX;
+    }
+
+    if(!uniformBlockName || !progPtr->IsLinked()) {
+        return GL_INVALID_INDEX;
+    }
+
+    return progPtr->GetUniformBufferBlockIndex(uniformBlockName);
+}
+
+void
+Context::UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ShaderProgram *progPtr = GetProgramPtr(program);
+    if(!progPtr) {
+        RecordError(IsShader(program) ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+        return;
+    }
+
+    if(!progPtr->IsLinked() || uniformBlockIndex >= progPtr->GetUniformBufferBlockCount() ||
+       uniformBlockBinding >= GLOVE_MAX_UNIFORM_BUFFER_BINDINGS) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    progPtr->SetUniformBufferBinding(uniformBlockIndex, uniformBlockBinding);
 }
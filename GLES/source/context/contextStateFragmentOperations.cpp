@@ -30,9 +30,7 @@ Context::BlendColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateBlendingColor(red, green, blue, alpha)) {
-        GLfloat    blendcolor[4];
-        stateFragmentOperations->GetBlendingColor(blendcolor);
-        mPipeline->SetColorBlendConstants(blendcolor);
+        mStateManager.SetDirtyState(STATE_DIRTY_BLEND_COLOR);
     }
 }
 
@@ -48,8 +46,7 @@ Context::BlendEquation(GLenum mode)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateBlendingEquation(mode, mode)) {
-        mPipeline->SetColorBlendAttachmentColorOp(GlBlendEquationToVkBlendOp(stateFragmentOperations->GetBlendingEquationRGB()));
-        mPipeline->SetColorBlendAttachmentAlphaOp(GlBlendEquationToVkBlendOp(stateFragmentOperations->GetBlendingEquationAlpha()));
+        mStateManager.SetDirtyState(STATE_DIRTY_BLEND);
     }
 }
 
@@ -66,8 +63,7 @@ Context::BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateBlendingEquation(modeRGB, modeAlpha)) {
-        mPipeline->SetColorBlendAttachmentColorOp(GlBlendEquationToVkBlendOp(stateFragmentOperations->GetBlendingEquationRGB()));
-        mPipeline->SetColorBlendAttachmentAlphaOp(GlBlendEquationToVkBlendOp(stateFragmentOperations->GetBlendingEquationAlpha()));
+        mStateManager.SetDirtyState(STATE_DIRTY_BLEND);
     }
 }
 
@@ -91,10 +87,7 @@ Context::BlendFunc(GLenum sfactor, GLenum dfactor)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateBlendingFactors(sfactor, sfactor, dfactor, dfactor)) {
-        mPipeline->SetColorBlendAttachmentSrcColorFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorSourceRGB()));
-        mPipeline->SetColorBlendAttachmentDstColorFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorDestinationRGB()));
-        mPipeline->SetColorBlendAttachmentSrcAlphaFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorSourceAlpha()));
-        mPipeline->SetColorBlendAttachmentDstAlphaFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorDestinationAlpha()));
+        mStateManager.SetDirtyState(STATE_DIRTY_BLEND);
     }
 }
 
@@ -118,10 +111,7 @@ Context::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateBlendingFactors(srcRGB, srcAlpha, dstRGB, dstAlpha)) {
-        mPipeline->SetColorBlendAttachmentSrcColorFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorSourceRGB()));
-        mPipeline->SetColorBlendAttachmentDstColorFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorDestinationRGB()));
-        mPipeline->SetColorBlendAttachmentSrcAlphaFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorSourceAlpha()));
-        mPipeline->SetColorBlendAttachmentDstAlphaFactor(GlBlendFactorToVkBlendFactor(stateFragmentOperations->GetBlendingFactorDestinationAlpha()));
+        mStateManager.SetDirtyState(STATE_DIRTY_BLEND);
     }
 }
 
@@ -139,7 +129,7 @@ Context::DepthFunc(GLenum func)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateDepthTestFunc(func)) {
-        mPipeline->SetDepthCompareOp(GlCompareFuncToVkCompareOp(stateFragmentOperations->GetDepthTestFunc()));
+        mStateManager.SetDirtyState(STATE_DIRTY_DEPTH);
     }
 }
 
@@ -167,6 +157,7 @@ Context::Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
 
     if(mStateManager.GetFragmentOperationsState()->UpdateScissorRect(x, y, width, height)) {
         mPipeline->SetUpdateViewportState(true);
+        InvalidateQueryBlock();
     }
 }
 
@@ -184,15 +175,11 @@ Context::StencilFunc(GLenum func, GLint ref, GLuint mask)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateStencilTestFunc(GL_FRONT, func, ref, mask)) {
-        mPipeline->SetStencilFrontCompareOp(GlCompareFuncToVkCompareOp(stateFragmentOperations->GetStencilTestFuncCompareFront()));
-        mPipeline->SetStencilFrontCompareMask(stateFragmentOperations->GetStencilTestFuncMaskFront());
-        mPipeline->SetStencilFrontReference(stateFragmentOperations->GetStencilTestFuncRefFront());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 
     if(stateFragmentOperations->UpdateStencilTestFunc(GL_BACK , func, ref, mask)) {
-        mPipeline->SetStencilBackCompareOp(GlCompareFuncToVkCompareOp(stateFragmentOperations->GetStencilTestFuncCompareBack()));
-        mPipeline->SetStencilBackCompareMask(stateFragmentOperations->GetStencilTestFuncMaskBack());
-        mPipeline->SetStencilBackReference(stateFragmentOperations->GetStencilTestFuncRefBack());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 }
 
@@ -215,15 +202,11 @@ Context::StencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if((face == GL_FRONT || face ==  GL_FRONT_AND_BACK) && stateFragmentOperations->UpdateStencilTestFunc(GL_FRONT, func, ref, mask)) {
-        mPipeline->SetStencilFrontCompareOp(GlCompareFuncToVkCompareOp(stateFragmentOperations->GetStencilTestFuncCompareFront()));
-        mPipeline->SetStencilFrontCompareMask(stateFragmentOperations->GetStencilTestFuncMaskFront());
-        mPipeline->SetStencilFrontReference(stateFragmentOperations->GetStencilTestFuncRefFront());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 
     if((face == GL_BACK || face ==  GL_FRONT_AND_BACK) && stateFragmentOperations->UpdateStencilTestFunc(GL_BACK , func, ref, mask)) {
-        mPipeline->SetStencilBackCompareOp(GlCompareFuncToVkCompareOp(stateFragmentOperations->GetStencilTestFuncCompareBack()));
-        mPipeline->SetStencilBackCompareMask(stateFragmentOperations->GetStencilTestFuncMaskBack());
-        mPipeline->SetStencilBackReference(stateFragmentOperations->GetStencilTestFuncRefBack());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 }
 
@@ -241,15 +224,11 @@ Context::StencilOp(GLenum fail, GLenum zfail, GLenum zpass)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if(stateFragmentOperations->UpdateStencilTestOp(GL_FRONT, fail, zfail, zpass)) {
-        mPipeline->SetStencilFrontFailOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpFailFront()));
-        mPipeline->SetStencilFrontZFailOp(GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZfailFront()));
-        mPipeline->SetStencilFrontPassOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZpassFront()));
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 
     if(stateFragmentOperations->UpdateStencilTestOp(GL_BACK , fail, zfail, zpass)) {
-        mPipeline->SetStencilBackFailOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpFailBack()));
-        mPipeline->SetStencilBackZFailOp(GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZfailBack()));
-        mPipeline->SetStencilBackPassOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZpassBack()));
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 }
 
@@ -272,14 +251,10 @@ Context::StencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum zpass)
 
     StateFragmentOperations *stateFragmentOperations = mStateManager.GetFragmentOperationsState();
     if((face == GL_FRONT || face ==  GL_FRONT_AND_BACK) && stateFragmentOperations->UpdateStencilTestOp(GL_FRONT, fail, zfail, zpass)) {
-        mPipeline->SetStencilFrontFailOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpFailFront()));
-        mPipeline->SetStencilFrontZFailOp(GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZfailFront()));
-        mPipeline->SetStencilFrontPassOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZpassFront()));
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 
     if((face == GL_BACK || face ==  GL_FRONT_AND_BACK) && stateFragmentOperations->UpdateStencilTestOp(GL_BACK , fail, zfail, zpass)) {
-        mPipeline->SetStencilBackFailOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpFailBack()));
-        mPipeline->SetStencilBackZFailOp(GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZfailBack()));
-        mPipeline->SetStencilBackPassOp (GlStencilFuncToVkStencilOp(stateFragmentOperations->GetStencilTestOpZpassBack()));
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
     }
 }
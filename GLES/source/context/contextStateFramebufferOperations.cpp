@@ -54,7 +54,7 @@ Context::ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alp
 
     StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
     if(stateFramebufferOperations->UpdateColorMask(red, green, blue, alpha)) {
-        mPipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(stateFramebufferOperations->GetColorMask()));
+        mStateManager.SetDirtyState(STATE_DIRTY_COLOR_MASK);
     }
 }
 
@@ -65,7 +65,7 @@ Context::DepthMask(GLboolean flag)
 
     StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
     if(stateFramebufferOperations->UpdateDepthMask(flag)) {
-        mPipeline->SetDepthWriteEnable(GlBooleanToVkBool(stateFramebufferOperations->GetDepthMask()));
+        mStateManager.SetDirtyState(STATE_DIRTY_DEPTH);
     }
 }
 
@@ -76,8 +76,7 @@ Context::StencilMask(GLuint mask)
 
     StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
     if(stateFramebufferOperations->UpdateStencilMask(mask)) {
-        mPipeline->SetStencilBackWriteMask(stateFramebufferOperations->GetStencilMaskBack());
-        mPipeline->SetStencilFrontWriteMask(stateFramebufferOperations->GetStencilMaskFront());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL_MASK);
     }
 }
 
@@ -93,10 +92,10 @@ Context::StencilMaskSeparate(GLenum face, GLuint mask)
 
     StateFramebufferOperations *stateFramebufferOperations = mStateManager.GetFramebufferOperationsState();
     if((face == GL_FRONT || face == GL_FRONT_AND_BACK) && stateFramebufferOperations->UpdateStencilMaskFront(mask)) {
-        mPipeline->SetStencilFrontWriteMask(stateFramebufferOperations->GetStencilMaskFront());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL_MASK);
     }
 
     if((face == GL_BACK || face == GL_FRONT_AND_BACK) && stateFramebufferOperations->UpdateStencilMaskBack(mask)) {
-        mPipeline->SetStencilBackWriteMask(stateFramebufferOperations->GetStencilMaskBack());
+        mStateManager.SetDirtyState(STATE_DIRTY_STENCIL_MASK);
     }
 }
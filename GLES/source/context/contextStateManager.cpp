@@ -52,27 +52,27 @@ Context::SetCapability(GLenum cap, GLboolean enable)
         break;
     case GL_DEPTH_TEST:
         if(mStateManager.GetFragmentOperationsState()->UpdateDepthTestEnabled(enable)) {
-            mPipeline->SetDepthTestEnable(GlBooleanToVkBool(mStateManager.GetFragmentOperationsState()->GetDepthTestEnabled()));
+            mStateManager.SetDirtyState(STATE_DIRTY_DEPTH);
         }
         break;
     case GL_STENCIL_TEST:
         if(mStateManager.GetFragmentOperationsState()->UpdateStencilTestEnabled(enable)) {
-            mPipeline->SetStencilTestEnable(GlBooleanToVkBool(mStateManager.GetFragmentOperationsState()->GetStencilTestEnabled()));
+            mStateManager.SetDirtyState(STATE_DIRTY_STENCIL);
         }
         break;
     case GL_CULL_FACE:
         if(mStateManager.GetRasterizationState()->UpdateCullEnabled(enable)) {
-            mPipeline->SetRasterizationCullMode(GlBooleanToVkBool(mStateManager.GetRasterizationState()->GetCullEnabled()), GlCullModeToVkCullMode(mStateManager.GetRasterizationState()->GetCullFace()));
+            mStateManager.SetDirtyState(STATE_DIRTY_CULL);
         }
         break;
     case GL_POLYGON_OFFSET_FILL:
         if(mStateManager.GetRasterizationState()->UpdatePolygonOffsetFillEnabled(enable)) {
-            mPipeline->SetRasterizationDepthBiasEnable(GlBooleanToVkBool(mStateManager.GetRasterizationState()->GetPolygonOffsetFillEnabled()));
+            mStateManager.SetDirtyState(STATE_DIRTY_POLYGON_OFFSET);
         }
         break;
     case GL_SAMPLE_ALPHA_TO_COVERAGE:
         if(mStateManager.GetFragmentOperationsState()->UpdateSampleAlphaToCoverageEnabled(enable)) {
-            mPipeline->SetMultisampleAlphaToCoverage(GlBooleanToVkBool(mStateManager.GetFragmentOperationsState()->GetSampleAlphaToCoverageEnabled()));
+            mStateManager.SetDirtyState(STATE_DIRTY_MULTISAMPLE);
         }
         break;
     case GL_SAMPLE_COVERAGE:
@@ -82,12 +82,25 @@ Context::SetCapability(GLenum cap, GLboolean enable)
         break;
     case GL_BLEND:
         if(mStateManager.GetFragmentOperationsState()->UpdateBlendingEnabled(enable)) {
-            mPipeline->SetColorBlendAttachmentEnable(GlBooleanToVkBool(mStateManager.GetFragmentOperationsState()->GetBlendingEnabled()));
+            mStateManager.SetDirtyState(STATE_DIRTY_BLEND);
         }
         break;
     case GL_DITHER:
         mStateManager.GetFragmentOperationsState()->SetDitheringEnabled(enable);
         break;
+    case GL_RASTERIZER_DISCARD:
+        // the primitives captured by transform feedback are usually all a draw is issued for
+        if(!mVkContext->mIsTransformFeedbackSupported) {
+            RecordError(GL_INVALID_ENUM);
+        } else if(mStateManager.GetRasterizationState()->UpdateRasterizerDiscardEnabled(enable)) {
+            mStateManager.SetDirtyState(STATE_DIRTY_RASTERIZER_DISCARD);
+        }
+        break;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX:
+        if(mStateManager.GetInputAssemblyState()->UpdatePrimitiveRestartEnabled(enable)) {
+            mStateManager.SetDirtyState(STATE_DIRTY_PRIMITIVE_RESTART);
+        }
+        break;
     default:
         RecordError(GL_INVALID_ENUM);
         break;
@@ -62,14 +62,16 @@ Context::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum form
     }
 
     if(type != GL_UNSIGNED_BYTE          && type != GL_UNSIGNED_SHORT_5_6_5 &&
-       type != GL_UNSIGNED_SHORT_4_4_4_4 && type != GL_UNSIGNED_SHORT_5_5_5_1) {
+       type != GL_UNSIGNED_SHORT_4_4_4_4 && type != GL_UNSIGNED_SHORT_5_5_5_1 &&
+       type != GL_HALF_FLOAT_OES         && type != GL_FLOAT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
+    const bool floatType = (type == GL_HALF_FLOAT_OES || type == GL_FLOAT);
     if( (type == GL_UNSIGNED_SHORT_5_6_5                                          && format != GL_RGB)  ||
        ((type == GL_UNSIGNED_SHORT_5_5_5_1 || type == GL_UNSIGNED_SHORT_4_4_4_4)  && format != GL_RGBA) ||
-        (type == GL_UNSIGNED_BYTE                                                 && format != GL_RGBA)) {
+       ((type == GL_UNSIGNED_BYTE || floatType)                                   && format != GL_RGBA)) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
@@ -79,15 +81,18 @@ Context::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum form
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
-        Finish();
-    }
-
     Texture* activeTexture = mWriteFBO->GetColorAttachmentTexture();
     if(activeTexture == nullptr) {
         return;
     }
 
+    // float texels are read back as floats only from float color buffers, the implementation read format
+    const GLenum fbType = activeTexture->GetExplicitType();
+    if(floatType && fbType != GL_HALF_FLOAT_OES && fbType != GL_FLOAT) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
     GLenum srcInternalFormat = activeTexture->GetExplicitInternalFormat();
     GLenum dstInternalFormat = GlFormatToGlInternalFormat(format, type);
 
@@ -100,8 +105,41 @@ Context::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum form
                       GlTypeToElementSize(type),
                       mStateManager.GetPixelStorageState()->GetPixelStorePack());
 
-    srcRect.y = activeTexture->GetInvertedYOrigin(&srcRect);
-    activeTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, 0, dstInternalFormat, pixels);
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_BYTES_READ_BACK, srcRect.GetRectBufferSize());
+
+    // with a pack buffer bound, pixels is an offset into it and the copy
+    // is only recorded, to be converted once the buffer is mapped
+    BufferObject *pbo        = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV);
+    const size_t  packOffset = reinterpret_cast<uintptr_t>(pixels);
+    if(pbo) {
+        if(pbo->IsMapped() || packOffset + dstRect.GetRectBufferSize() > pbo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+
+        if(ReadPixelsToPackBuffer(pbo, &srcRect, &dstRect, dstInternalFormat, packOffset)) {
+            return;
+        }
+
+        // otherwise the pixels are read back right away and written into the buffer
+        FinishBufferReadbacks(pbo);
+        pixels = new uint8_t[dstRect.GetRectBufferSize()];
+    }
+
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    // only the system framebuffer stores its rows bottom-up, or turned towards the display
+    if(mWriteFBO->IsPreRotated()) {
+        ReadPreRotatedPixels(activeTexture, &srcRect, &dstRect, dstInternalFormat, pixels);
+    } else if(mWriteFBO->IsStoredUpright()) {
+        activeTexture->SetDataNoInvertion(true);
+        activeTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, 0, dstInternalFormat, pixels);
+    } else {
+        srcRect.y = activeTexture->GetInvertedYOrigin(&srcRect);
+        activeTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, 0, dstInternalFormat, pixels);
+    }
 
 #if GLOVE_SAVE_READPIXELS_TO_FILE == true
     static int calls = 0;
@@ -113,4 +151,106 @@ Context::ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum form
         fclose(fp);
     }
 #endif
+
+    if(pbo) {
+        pbo->UpdateData(dstRect.GetRectBufferSize(), packOffset, pixels);
+        delete[] static_cast<uint8_t *>(pixels);
+    }
+}
+
+void
+Context::ReadPreRotatedPixels(Texture *fbTexture, ImageRect *srcRect, const ImageRect *dstRect, GLenum dstInternalFormat, void *pixels)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the rectangle is read as it is stored, with tightly packed rows starting from its top
+    const Rect storageRect = mWriteFBO->PreRotateRect(Rect(srcRect->x, mWriteFBO->GetHeight() - srcRect->y - srcRect->height,
+                                                           srcRect->width, srcRect->height));
+    srcRect->x      = storageRect.x;
+    srcRect->y      = storageRect.y;
+    srcRect->width  = storageRect.width;
+    srcRect->height = storageRect.height;
+    ImageRect storageDstRect(0, 0, storageRect.width, storageRect.height, dstRect->mNumElements, dstRect->mSizeElement, 1);
+
+    uint8_t *storagePixels = new uint8_t[storageDstRect.GetRectBufferSize()];
+    fbTexture->SetDataNoInvertion(true);
+    fbTexture->CopyPixelsToHost(srcRect, &storageDstRect, 0, 0, dstInternalFormat, storagePixels);
+
+    // then turned back, into rows from the bottom of the rectangle the client sees
+    const int      width     = dstRect->width;
+    const int      height    = dstRect->height;
+    const uint32_t pixelSize = dstRect->GetPixelByteOffset();
+    const uint32_t srcStride = storageDstRect.GetRectAlignedRowInBytes();
+    const uint32_t dstStride = dstRect->GetRectAlignedRowInBytes();
+    for(int j = 0; j < height; ++j) {
+        uint8_t *dstRow = static_cast<uint8_t *>(pixels) + j * dstStride;
+        for(int i = 0; i < width; ++i) {
+            int u, v;
+            switch(mWriteFBO->GetPreRotation()) {
+            case 1:  u = j;              v = i;             break;
+            case 2:  u = width - 1 - i;  v = j;             break;
+            default: u = height - 1 - j; v = width - 1 - i; break;
+            }
+            memcpy(dstRow + i * pixelSize, storagePixels + v * srcStride + u * pixelSize, pixelSize);
+        }
+    }
+
+    delete[] storagePixels;
+}
+
+GLenum
+Context::GetImplementationColorReadType(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // float color buffers are read back without losing their range
+    Texture *fbTexture = mWriteFBO->GetColorAttachmentTexture();
+    const GLenum fbType = fbTexture ? fbTexture->GetExplicitType() : GL_UNSIGNED_BYTE;
+
+    return (fbType == GL_HALF_FLOAT_OES || fbType == GL_FLOAT) ? fbType : GL_UNSIGNED_BYTE;
+}
+
+bool
+Context::ReadPixelsToPackBuffer(BufferObject *pbo, const ImageRect *srcRect, const ImageRect *dstRect, GLenum dstInternalFormat, size_t offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Texture   *fbTexture = mWriteFBO->GetColorAttachmentTexture();
+    const bool invertY   = !mWriteFBO->IsStoredUpright();
+    if(mWriteFBO->IsPreRotated() ||
+       srcRect->width <= 0 || srcRect->height <= 0 || srcRect->x < 0 || srcRect->y < 0 ||
+       srcRect->x + srcRect->width > mWriteFBO->GetWidth() || srcRect->y + srcRect->height > mWriteFBO->GetHeight()) {
+        return false;
+    }
+
+    // the copy is recorded right after the draws it has to see, so the render pass
+    // is split around it instead of submitting and waiting for the queue to idle
+    FlushDrawBatch();
+    ResolvePendingClear();
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
+    }
+
+    ImageRect imageRect = *srcRect;
+    if(invertY) {
+        imageRect.y = fbTexture->GetInvertedYOrigin(&imageRect);
+    }
+
+    const uint64_t serial = mCommandBufferManager->GetSubmitSerial();
+    VkBuffer stagingBuffer = pbo->QueueReadback(&imageRect, fbTexture->GetExplicitInternalFormat(),
+                                                dstRect, dstInternalFormat, invertY, offset, serial);
+    if(stagingBuffer != VK_NULL_HANDLE) {
+        VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+        fbTexture->CopyToVkBuffer(&activeCmdBuffer, &imageRect, stagingBuffer);
+        fbTexture->SetLastUsedSerial(mShareGroupSlot, serial);
+    }
+
+    // rendering resumes on the same attachments
+    mWriteFBO->SetStateDraw();
+    SetClearRect();
+    BeginRendering(false, false, false);
+
+    return stagingBuffer != VK_NULL_HANDLE;
 }
@@ -22,6 +22,8 @@
  */
 
 #include "context.h"
+#include "utils/glEnumTable.h"
+#include "vulkan/utils.h"
 
 static glove_program_binary_formats_e glove_program_binary_formats[GLOVE_MAX_BINARY_FORMATS] = {
     GLOVE_HOST_X86_BINARY,
@@ -29,25 +31,136 @@ static glove_program_binary_formats_e glove_program_binary_formats[GLOVE_MAX_BIN
     GLOVE_DEV_BINARY
 };
 
+/// where the value of each query lies in the query block
+typedef enum {
+    QUERY_VIEWPORT                  = 0,
+    QUERY_SCISSOR_BOX               = QUERY_VIEWPORT + 4,
+    QUERY_TEXTURE_BINDING_2D        = QUERY_SCISSOR_BOX + 4,
+    QUERY_ACTIVE_TEXTURE,
+    QUERY_TEXTURE_BINDING_CUBE_MAP,
+    QUERY_ARRAY_BUFFER_BINDING,
+    QUERY_ELEMENT_ARRAY_BUFFER_BINDING,
+    QUERY_CURRENT_PROGRAM,
+    QUERY_FRAMEBUFFER_BINDING,
+    QUERY_RENDERBUFFER_BINDING,
+    QUERY_COUNT
+} querySlot_e;
+static_assert(QUERY_COUNT == GLOVE_QUERY_BLOCK_SIZE, "GLOVE_QUERY_BLOCK_SIZE must match the slots of the query block");
+
+typedef struct queryEntry_t {
+    querySlot_e                     slot;
+    GLsizei                         count;
+} queryEntry_t;
+
+static constexpr GlEnumEntry_t<queryEntry_t> queryTable[] = {
+    { GL_VIEWPORT,                          { QUERY_VIEWPORT,                     4 } },
+    { GL_SCISSOR_BOX,                       { QUERY_SCISSOR_BOX,                  4 } },
+    { GL_TEXTURE_BINDING_2D,                { QUERY_TEXTURE_BINDING_2D,           1 } },
+    { GL_ACTIVE_TEXTURE,                    { QUERY_ACTIVE_TEXTURE,               1 } },
+    { GL_TEXTURE_BINDING_CUBE_MAP,          { QUERY_TEXTURE_BINDING_CUBE_MAP,     1 } },
+    { GL_ARRAY_BUFFER_BINDING,              { QUERY_ARRAY_BUFFER_BINDING,         1 } },
+    { GL_ELEMENT_ARRAY_BUFFER_BINDING,      { QUERY_ELEMENT_ARRAY_BUFFER_BINDING, 1 } },
+    { GL_CURRENT_PROGRAM,                   { QUERY_CURRENT_PROGRAM,              1 } },
+    { GL_FRAMEBUFFER_BINDING,               { QUERY_FRAMEBUFFER_BINDING,          1 } },
+    { GL_RENDERBUFFER_BINDING,              { QUERY_RENDERBUFFER_BINDING,         1 } }
+};
+static_assert(GlEnumTableIsSorted(queryTable), "queryTable must list ascending enums");
+
+void
+Context::UpdateQueryBlock(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    StateActiveObjects *activeObjects = mStateManager.GetActiveObjectsState();
+    BufferObject *arrayBuffer   = activeObjects->GetActiveBufferObject(GL_ARRAY_BUFFER);
+    BufferObject *elementBuffer = activeObjects->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER);
+    GLint *values               = mQueryBlock.values;
+
+    mStateManager.GetViewportTransformationState()->GetViewportRect(&values[QUERY_VIEWPORT]);
+    mStateManager.GetFragmentOperationsState()->GetScissorRect(&values[QUERY_SCISSOR_BOX]);
+    values[QUERY_TEXTURE_BINDING_2D]           = static_cast<GLint>(mResourceManager->GetTextureID(activeObjects->GetActiveTexture(GL_TEXTURE_2D)));
+    values[QUERY_ACTIVE_TEXTURE]               = static_cast<GLint>(activeObjects->GetActiveTextureUnit());
+    values[QUERY_TEXTURE_BINDING_CUBE_MAP]     = static_cast<GLint>(mResourceManager->GetTextureID(activeObjects->GetActiveTexture(GL_TEXTURE_CUBE_MAP)));
+    values[QUERY_ARRAY_BUFFER_BINDING]         = arrayBuffer   ? static_cast<GLint>(mResourceManager->GetBufferID(arrayBuffer))   : 0;
+    values[QUERY_ELEMENT_ARRAY_BUFFER_BINDING] = elementBuffer ? static_cast<GLint>(mResourceManager->GetBufferID(elementBuffer)) : 0;
+    values[QUERY_CURRENT_PROGRAM]              = static_cast<GLint>(GetProgramId(activeObjects->GetActiveShaderProgram()));
+    values[QUERY_FRAMEBUFFER_BINDING]          = static_cast<GLint>(activeObjects->GetActiveFramebufferObjectID());
+    values[QUERY_RENDERBUFFER_BINDING]         = static_cast<GLint>(activeObjects->GetActiveRenderbufferObjectID());
+
+    mQueryBlock.generation = activeObjects->GetGeneration();
+    mQueryBlock.stale      = false;
+}
+
+const GLint *
+Context::FindQuery(GLenum pname, GLsizei *count)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const GlEnumEntry_t<queryEntry_t> *entry = GlEnumTableSearch(queryTable, pname);
+    if(entry == nullptr) {
+        return nullptr;
+    }
+
+    if(mQueryBlock.stale || mQueryBlock.generation != mStateManager.GetActiveObjectsState()->GetGeneration()) {
+        UpdateQueryBlock();
+    }
+
+    *count = entry->value.count;
+    return &mQueryBlock.values[entry->value.slot];
+}
+
+GLint
+Context::GetWriteFBOSamples(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // attachments may have been respecified since the last render pass
+    mWriteFBO->UpdateSamples();
+
+    return mWriteFBO->GetSamples() != VK_SAMPLE_COUNT_1_BIT ? static_cast<GLint>(mWriteFBO->GetSamples()) : 0;
+}
+
 void
 Context::GetBooleanv(GLenum pname, GLboolean* params)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    GLsizei count;
+    const GLint *values = FindQuery(pname, &count);
+    if(values) {
+        for(GLsizei i = 0; i < count; ++i) {
+            params[i] = values[i] ? GL_TRUE : GL_FALSE;
+        }
+        return;
+    }
+
     switch(pname) {
     case GL_IMPLEMENTATION_COLOR_READ_FORMAT:   *params = GL_TRUE; break;
     case GL_IMPLEMENTATION_COLOR_READ_TYPE:     *params = GL_TRUE; break;
     case GL_TEXTURE_BINDING_2D:                 *params = mResourceManager->GetTextureID(mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_2D)) == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_TEXTURE_BINDING_CUBE_MAP:           *params = mResourceManager->GetTextureID(mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_CUBE_MAP)) == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_FRAMEBUFFER_BINDING:                *params = mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID() == 0 ? GL_FALSE : GL_TRUE; break;
+    case GL_READ_FRAMEBUFFER_BINDING_ANGLE:     *params = mStateManager.GetActiveObjectsState()->GetActiveReadFramebufferObjectID() == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_RENDERBUFFER_BINDING:               *params = mStateManager.GetActiveObjectsState()->GetActiveRenderbufferObjectID() == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_ACTIVE_TEXTURE:                     *params = mStateManager.GetActiveObjectsState()->GetActiveTextureUnit() == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_CURRENT_PROGRAM:                    *params = GetProgramId(mStateManager.GetActiveShaderProgram()) == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_ARRAY_BUFFER_BINDING:               *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER)         ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER)        ) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
     case GL_ELEMENT_ARRAY_BUFFER_BINDING:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_PIXEL_PACK_BUFFER_BINDING_NV:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_PIXEL_UNPACK_BUFFER_BINDING_NV:     *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_DRAW_INDIRECT_BUFFER_BINDING:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_SHADER_STORAGE_BUFFER_BINDING:      *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_SHADER_STORAGE_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_SHADER_STORAGE_BUFFER)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_UNIFORM_BUFFER_BINDING:             *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_UNIFORM_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_UNIFORM_BUFFER)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_TRANSFORM_FEEDBACK_BUFFER_BINDING:  *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_TRANSFORM_FEEDBACK_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_TRANSFORM_FEEDBACK_BUFFER)) == 0 ? GL_FALSE : GL_TRUE : GL_FALSE; break;
+    case GL_TRANSFORM_FEEDBACK_ACTIVE:          *params = mTransformFeedback.active ? GL_TRUE : GL_FALSE; break;
+    case GL_RASTERIZER_DISCARD:                 *params = mStateManager.GetRasterizationState()->GetRasterizerDiscardEnabled(); break;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX:      *params = mStateManager.GetInputAssemblyState()->GetPrimitiveRestartEnabled(); break;
+    case GL_VERTEX_ARRAY_BINDING_OES:           *params = mVertexArrayId == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_NUM_SHADER_BINARY_FORMATS:          *params = GLOVE_NUM_SHADER_BINARY_FORMATS == 0 ? GL_FALSE : GL_TRUE; break;
-    case GL_COMPRESSED_TEXTURE_FORMATS:         *params = GL_FALSE; break;
-    case GL_NUM_COMPRESSED_TEXTURE_FORMATS:     *params = GL_FALSE; break;
+    case GL_COMPRESSED_TEXTURE_FORMATS:         { std::vector<GLenum> formats; GetCompressedTextureFormats(&formats);
+                                                  for(size_t i = 0; i < formats.size(); ++i) { params[i] = GL_TRUE; } } break;
+    case GL_NUM_COMPRESSED_TEXTURE_FORMATS:     { std::vector<GLenum> formats; GetCompressedTextureFormats(&formats);
+                                                  *params = formats.empty() ? GL_FALSE : GL_TRUE; } break;
     case GL_BLEND_COLOR:                        mStateManager.GetFragmentOperationsState()->GetBlendingColor(params); break;
     case GL_BLEND_DST_ALPHA:                    *params = mStateManager.GetFragmentOperationsState()->GetBlendingFactorDestinationAlpha() == 0 ? GL_FALSE : GL_TRUE; break;
     case GL_BLEND_DST_RGB:                      *params = mStateManager.GetFragmentOperationsState()->GetBlendingFactorDestinationRGB() == 0 ? GL_FALSE : GL_TRUE; break;
@@ -97,8 +210,8 @@ Context::GetBooleanv(GLenum pname, GLboolean* params)
     case GL_SAMPLE_COVERAGE:                    *params = mStateManager.GetFragmentOperationsState()->GetSampleCoverageEnabled(); break;
     case GL_SCISSOR_TEST:                       *params = mStateManager.GetFragmentOperationsState()->GetScissorTestEnabled(); break;
     case GL_STENCIL_TEST:                       *params = mStateManager.GetFragmentOperationsState()->GetStencilTestEnabled(); break;
-    case GL_SAMPLES:                            *params = mStateManager.GetFragmentOperationsState()->GetSampleCoverageBits() == 0 ? GL_FALSE : GL_TRUE; break;
-    case GL_SAMPLE_BUFFERS:                     *params = mStateManager.GetFragmentOperationsState()->GetMultiSamplingEnabled(); break;
+    case GL_SAMPLES:
+    case GL_SAMPLE_BUFFERS:                     *params = GetWriteFBOSamples() ? GL_TRUE : GL_FALSE; break;
     case GL_SCISSOR_BOX:                        mStateManager.GetFragmentOperationsState()->GetScissorRect(params); break;
     case GL_VIEWPORT:                           mStateManager.GetViewportTransformationState()->GetViewportRect(params); break;
     case GL_MAX_VIEWPORT_DIMS:                  params[0] = GL_TRUE;
@@ -111,8 +224,8 @@ Context::GetBooleanv(GLenum pname, GLboolean* params)
     case GL_BLUE_BITS:                          GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), nullptr, params, nullptr, nullptr, nullptr, nullptr); break;
     case GL_GREEN_BITS:                         GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), nullptr, nullptr, params, nullptr, nullptr, nullptr); break;
     case GL_ALPHA_BITS:                         GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), nullptr, nullptr, nullptr, params, nullptr, nullptr); break;
-    case GL_DEPTH_BITS:                         GlFormatToStorageBits(mWriteFBO->GetDepthAttachmentTexture()   ? mWriteFBO->GetDepthAttachmentTexture()->GetInternalFormat()   : GL_INVALID_VALUE, nullptr, nullptr, nullptr, nullptr, params, nullptr); break;
-    case GL_STENCIL_BITS:                       GlFormatToStorageBits(mWriteFBO->GetStencilAttachmentTexture() ? mWriteFBO->GetStencilAttachmentTexture()->GetInternalFormat() : GL_INVALID_VALUE, nullptr, nullptr, nullptr, nullptr, nullptr, params); break;
+    case GL_DEPTH_BITS:                         GlFormatToStorageBits(mWriteFBO->GetDepthInternalFormat(), nullptr, nullptr, nullptr, nullptr, params, nullptr); break;
+    case GL_STENCIL_BITS:                       GlFormatToStorageBits(mWriteFBO->GetStencilInternalFormat(), nullptr, nullptr, nullptr, nullptr, nullptr, params); break;
     case GL_SUBPIXEL_BITS:
     case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
     case GL_MAX_VERTEX_UNIFORM_VECTORS:
@@ -122,10 +235,21 @@ Context::GetBooleanv(GLenum pname, GLboolean* params)
     case GL_MAX_TEXTURE_IMAGE_UNITS:
     case GL_MAX_FRAGMENT_UNIFORM_VECTORS:
     case GL_MAX_RENDERBUFFER_SIZE:
+    case GL_MAX_SAMPLES_EXT:
+    case GL_MAX_VIEWS_OVR:
     case GL_MAX_TEXTURE_SIZE:
     case GL_MAX_CUBE_MAP_TEXTURE_SIZE:
+    case GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS:
+    case GL_MAX_UNIFORM_BUFFER_BINDINGS:
+    case GL_MAX_UNIFORM_BLOCK_SIZE:
+    case GL_MAX_COMPUTE_UNIFORM_BLOCKS:
+    case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS:
+    case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS:
+    case GL_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS:
     case GL_SHADER_COMPILER:
     case GL_TEXTURE_BINDING_EXTERNAL_OES:       *params = GL_TRUE; break;
+    case GL_MAX_SHADER_COMPILER_THREADS_KHR:    *params = mShaderCompileQueue->GetMaxThreads() ? GL_TRUE : GL_FALSE; break;
+    case GL_GPU_DISJOINT_EXT:                   *params = GL_FALSE; break;
     default:                                    RecordError(GL_INVALID_ENUM); break;
     }
 }
@@ -137,6 +261,15 @@ Context::GetIntegerv(GLenum pname, GLint* params)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    GLsizei count;
+    const GLint *values = FindQuery(pname, &count);
+    if(values) {
+        for(GLsizei i = 0; i < count; ++i) {
+            params[i] = values[i];
+        }
+        return;
+    }
+
     switch(pname) {
     case GL_MAX_VERTEX_ATTRIBS:                 *params = GLOVE_MAX_VERTEX_ATTRIBS; break;
     case GL_MAX_VERTEX_UNIFORM_VECTORS:         *params = GLOVE_MAX_VERTEX_UNIFORM_VECTORS; break;
@@ -146,23 +279,46 @@ Context::GetIntegerv(GLenum pname, GLint* params)
     case GL_MAX_TEXTURE_IMAGE_UNITS:            *params = GLOVE_MAX_TEXTURE_IMAGE_UNITS; break;
     case GL_MAX_FRAGMENT_UNIFORM_VECTORS:       *params = GLOVE_MAX_FRAGMENT_UNIFORM_VECTORS; break;
     case GL_MAX_RENDERBUFFER_SIZE:              *params = GLOVE_MAX_RENDERBUFFER_SIZE; break;
+    case GL_MAX_SAMPLES_EXT:                    *params = static_cast<GLint>(GetMaxVkSampleCount(mVkContext->vkFramebufferSampleCounts)); break;
+    case GL_MAX_VIEWS_OVR:                      *params = GetMaxViews(); break;
+    case GL_GPU_DISJOINT_EXT:                   *params = 0; break;
     case GL_MAX_TEXTURE_SIZE:                   *params = GLOVE_MAX_TEXTURE_SIZE; break;
     case GL_MAX_CUBE_MAP_TEXTURE_SIZE:          *params = GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE; break;
+    case GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS: *params = GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS; break;
+    case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS:      *params = GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS; break;
+    case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS:   *params = GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS; break;
+    case GL_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS: *params = GLOVE_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS; break;
+    case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT: *params = static_cast<GLint>(mVkContext->vkMinStorageBufferOffsetAlignment); break;
+    case GL_MAX_UNIFORM_BUFFER_BINDINGS:        *params = GLOVE_MAX_UNIFORM_BUFFER_BINDINGS; break;
+    case GL_MAX_UNIFORM_BLOCK_SIZE:             *params = static_cast<GLint>(std::min(mVkContext->vkMaxUniformBufferRange, static_cast<uint32_t>(INT32_MAX))); break;
+    case GL_MAX_COMPUTE_UNIFORM_BLOCKS:         *params = GLOVE_MAX_COMPUTE_UNIFORM_BLOCKS; break;
+    case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:    *params = static_cast<GLint>(mVkContext->vkMinUniformBufferOffsetAlignment); break;
     case GL_MAX_VIEWPORT_DIMS:                  params[0] = GLOVE_MAX_TEXTURE_SIZE;
                                                 params[1] = GLOVE_MAX_TEXTURE_SIZE; break;
     case GL_FRAMEBUFFER_BINDING:                *params = mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID(); break;
+    case GL_READ_FRAMEBUFFER_BINDING_ANGLE:     *params = mStateManager.GetActiveObjectsState()->GetActiveReadFramebufferObjectID(); break;
     case GL_RENDERBUFFER_BINDING:               *params = mStateManager.GetActiveObjectsState()->GetActiveRenderbufferObjectID(); break;
     case GL_CURRENT_PROGRAM:                    *params = GetProgramId(mStateManager.GetActiveShaderProgram()); break;
     case GL_IMPLEMENTATION_COLOR_READ_FORMAT:   *params = GL_RGBA; break;
-    case GL_IMPLEMENTATION_COLOR_READ_TYPE:     *params = GL_UNSIGNED_BYTE; break;
+    case GL_IMPLEMENTATION_COLOR_READ_TYPE:     *params = static_cast<GLint>(GetImplementationColorReadType()); break;
     case GL_ARRAY_BUFFER_BINDING:               *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER)         ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER))   : 0; break;
     case GL_ELEMENT_ARRAY_BUFFER_BINDING:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER)) : 0; break;
+    case GL_PIXEL_PACK_BUFFER_BINDING_NV:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV)) : 0; break;
+    case GL_PIXEL_UNPACK_BUFFER_BINDING_NV:     *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV)) : 0; break;
+    case GL_DRAW_INDIRECT_BUFFER_BINDING:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER)) : 0; break;
+    case GL_SHADER_STORAGE_BUFFER_BINDING:      *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_SHADER_STORAGE_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_SHADER_STORAGE_BUFFER)) : 0; break;
+    case GL_UNIFORM_BUFFER_BINDING:             *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_UNIFORM_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_UNIFORM_BUFFER)) : 0; break;
+    case GL_TRANSFORM_FEEDBACK_BUFFER_BINDING:  *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_TRANSFORM_FEEDBACK_BUFFER) ? mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_TRANSFORM_FEEDBACK_BUFFER)) : 0; break;
+    case GL_TRANSFORM_FEEDBACK_ACTIVE:          *params = mTransformFeedback.active ? GL_TRUE : GL_FALSE; break;
+    case GL_RASTERIZER_DISCARD:                 *params = mStateManager.GetRasterizationState()->GetRasterizerDiscardEnabled(); break;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX:      *params = mStateManager.GetInputAssemblyState()->GetPrimitiveRestartEnabled(); break;
+    case GL_VERTEX_ARRAY_BINDING_OES:           *params = static_cast<GLint>(mVertexArrayId); break;
     case GL_RED_BITS:                           GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), params, NULL, NULL, NULL, NULL, NULL); break;
     case GL_BLUE_BITS:                          GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), NULL, params, NULL, NULL, NULL, NULL); break;
     case GL_GREEN_BITS:                         GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), NULL, NULL, params, NULL, NULL, NULL); break;
     case GL_ALPHA_BITS:                         GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), NULL, NULL, NULL, params, NULL, NULL); break;
-    case GL_DEPTH_BITS:                         GlFormatToStorageBits(mWriteFBO->GetDepthAttachmentTexture()   ? mWriteFBO->GetDepthAttachmentTexture()->GetInternalFormat()   : GL_INVALID_VALUE, NULL, NULL, NULL, NULL, params, NULL); break;
-    case GL_STENCIL_BITS:                       GlFormatToStorageBits(mWriteFBO->GetStencilAttachmentTexture() ? mWriteFBO->GetStencilAttachmentTexture()->GetInternalFormat() : GL_INVALID_VALUE, NULL, NULL, NULL, NULL, NULL, params); break;
+    case GL_DEPTH_BITS:                         GlFormatToStorageBits(mWriteFBO->GetDepthInternalFormat(), NULL, NULL, NULL, NULL, params, NULL); break;
+    case GL_STENCIL_BITS:                       GlFormatToStorageBits(mWriteFBO->GetStencilInternalFormat(), NULL, NULL, NULL, NULL, NULL, params); break;
     case GL_GENERATE_MIPMAP_HINT:               *params = static_cast<GLint>(mStateManager.GetHintAspectsState()->GetMode(GL_GENERATE_MIPMAP_HINT)); break;
     case GL_BLEND:                              *params = mStateManager.GetFragmentOperationsState()->GetBlendingEnabled(); break;
     case GL_COLOR_CLEAR_VALUE:                  mStateManager.GetFramebufferOperationsState()->GetClearColor(params); break;
@@ -194,15 +350,18 @@ Context::GetIntegerv(GLenum pname, GLint* params)
                                                 params[1] = 1; break;
     case GL_ALIASED_POINT_SIZE_RANGE:           params[0] = 1;
                                                 params[1] = 1; break;
-    case GL_COMPRESSED_TEXTURE_FORMATS:         *params = 0; break;
-    case GL_NUM_COMPRESSED_TEXTURE_FORMATS:     *params = 0; break;
-    case GL_SAMPLES:                            *params = static_cast<GLint>(mStateManager.GetFragmentOperationsState()->GetSampleCoverageBits()); break;
-    case GL_SAMPLE_BUFFERS:                     *params = mStateManager.GetFragmentOperationsState()->GetMultiSamplingEnabled(); break;
+    case GL_COMPRESSED_TEXTURE_FORMATS:         { std::vector<GLenum> formats; GetCompressedTextureFormats(&formats);
+                                                  for(size_t i = 0; i < formats.size(); ++i) { params[i] = static_cast<GLint>(formats[i]); } } break;
+    case GL_NUM_COMPRESSED_TEXTURE_FORMATS:     { std::vector<GLenum> formats; GetCompressedTextureFormats(&formats);
+                                                  *params = static_cast<GLint>(formats.size()); } break;
+    case GL_SAMPLES:                            *params = GetWriteFBOSamples(); break;
+    case GL_SAMPLE_BUFFERS:                     *params = GetWriteFBOSamples() ? 1 : 0; break;
     case GL_SAMPLE_COVERAGE:                    *params = mStateManager.GetFragmentOperationsState()->GetSampleCoverageEnabled(); break;
     case GL_SAMPLE_COVERAGE_INVERT:             *params = static_cast<GLint>(mStateManager.GetFragmentOperationsState()->GetSampleCoverageInvert()); break;
     case GL_SAMPLE_COVERAGE_VALUE:              *params = static_cast<GLint>(roundf(mStateManager.GetFragmentOperationsState()->GetSampleCoverageValue())); break;
     case GL_SAMPLE_ALPHA_TO_COVERAGE:           *params = mStateManager.GetFragmentOperationsState()->GetSampleAlphaToCoverageEnabled(); break;
     case GL_SHADER_COMPILER:                    *params = 1; break;
+    case GL_MAX_SHADER_COMPILER_THREADS_KHR:    *params = static_cast<GLint>(mShaderCompileQueue->GetMaxThreads()); break;
     case GL_SUBPIXEL_BITS:                      *params = static_cast<GLint>(GLOVE_SUBPIXEL_BITS); break;
     case GL_TEXTURE_BINDING_2D:                 *params = static_cast<GLint>(mResourceManager->GetTextureID(mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_2D))); break;
     case GL_TEXTURE_BINDING_CUBE_MAP:           *params = static_cast<GLint>(mResourceManager->GetTextureID(mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_CUBE_MAP))); break;
@@ -241,6 +400,15 @@ Context::GetFloatv(GLenum pname, GLfloat* params)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    GLsizei count;
+    const GLint *values = FindQuery(pname, &count);
+    if(values) {
+        for(GLsizei i = 0; i < count; ++i) {
+            params[i] = static_cast<GLfloat>(values[i]);
+        }
+        return;
+    }
+
     switch(pname) {
     case GL_ARRAY_BUFFER_BINDING:               *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER))) : 0; break;
     case GL_BLEND:                              *params = static_cast<GLfloat>(mStateManager.GetFragmentOperationsState()->GetBlendingEnabled()); break;
@@ -262,21 +430,42 @@ Context::GetFloatv(GLenum pname, GLfloat* params)
     case GL_DEPTH_WRITEMASK:                    *params = static_cast<GLfloat>(mStateManager.GetFramebufferOperationsState()->GetDepthMask()); break;
     case GL_DITHER:                             *params = static_cast<GLfloat>(mStateManager.GetFragmentOperationsState()->GetDitheringEnabled()); break;
     case GL_ELEMENT_ARRAY_BUFFER_BINDING:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER))) : 0; break;
+    case GL_PIXEL_PACK_BUFFER_BINDING_NV:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_PACK_BUFFER_NV))) : 0; break;
+    case GL_PIXEL_UNPACK_BUFFER_BINDING_NV:     *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV))) : 0; break;
+    case GL_DRAW_INDIRECT_BUFFER_BINDING:       *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_DRAW_INDIRECT_BUFFER))) : 0; break;
+    case GL_SHADER_STORAGE_BUFFER_BINDING:      *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_SHADER_STORAGE_BUFFER) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_SHADER_STORAGE_BUFFER))) : 0; break;
+    case GL_UNIFORM_BUFFER_BINDING:             *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_UNIFORM_BUFFER) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_UNIFORM_BUFFER))) : 0; break;
+    case GL_TRANSFORM_FEEDBACK_BUFFER_BINDING:  *params = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_TRANSFORM_FEEDBACK_BUFFER) ? static_cast<GLfloat>(mResourceManager->GetBufferID(mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_TRANSFORM_FEEDBACK_BUFFER))) : 0; break;
+    case GL_TRANSFORM_FEEDBACK_ACTIVE:          *params = mTransformFeedback.active ? 1.0f : 0.0f; break;
+    case GL_RASTERIZER_DISCARD:                 *params = static_cast<GLfloat>(mStateManager.GetRasterizationState()->GetRasterizerDiscardEnabled()); break;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX:      *params = static_cast<GLfloat>(mStateManager.GetInputAssemblyState()->GetPrimitiveRestartEnabled()); break;
+    case GL_VERTEX_ARRAY_BINDING_OES:           *params = static_cast<GLfloat>(mVertexArrayId); break;
     case GL_FRAMEBUFFER_BINDING:                *params = static_cast<GLfloat>(mStateManager.GetActiveObjectsState()->GetActiveFramebufferObjectID()); break;
+    case GL_READ_FRAMEBUFFER_BINDING_ANGLE:     *params = static_cast<GLfloat>(mStateManager.GetActiveObjectsState()->GetActiveReadFramebufferObjectID()); break;
     case GL_FRONT_FACE:                         *params = static_cast<GLfloat>(mStateManager.GetRasterizationState()->GetFrontFace()); break;
     case GL_IMPLEMENTATION_COLOR_READ_FORMAT:   *params = GL_RGBA; break;
-    case GL_IMPLEMENTATION_COLOR_READ_TYPE:     *params = GL_UNSIGNED_BYTE; break;
+    case GL_IMPLEMENTATION_COLOR_READ_TYPE:     *params = static_cast<GLfloat>(GetImplementationColorReadType()); break;
     case GL_LINE_WIDTH:                         *params = mStateManager.GetRasterizationState()->GetLineWidth(); break;
     case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:   *params = GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS; break;
     case GL_MAX_CUBE_MAP_TEXTURE_SIZE:          *params = GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE; break;
     case GL_MAX_FRAGMENT_UNIFORM_VECTORS:       *params = GLOVE_MAX_FRAGMENT_UNIFORM_VECTORS; break;
     case GL_MAX_RENDERBUFFER_SIZE:              *params = GLOVE_MAX_RENDERBUFFER_SIZE; break;
+    case GL_MAX_SAMPLES_EXT:                    *params = static_cast<GLfloat>(GetMaxVkSampleCount(mVkContext->vkFramebufferSampleCounts)); break;
+    case GL_MAX_VIEWS_OVR:                      *params = static_cast<GLfloat>(GetMaxViews()); break;
+    case GL_GPU_DISJOINT_EXT:                   *params = 0.0f; break;
     case GL_MAX_TEXTURE_IMAGE_UNITS:            *params = GLOVE_MAX_TEXTURE_IMAGE_UNITS; break;
     case GL_MAX_TEXTURE_SIZE:                   *params = GLOVE_MAX_TEXTURE_SIZE; break;
     case GL_MAX_VARYING_VECTORS:                *params = GLOVE_MAX_VARYING_VECTORS; break;
     case GL_MAX_VERTEX_ATTRIBS:                 *params = GLOVE_MAX_VERTEX_ATTRIBS; break;
     case GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS:     *params = GLOVE_MAX_VERTEX_TEXTURE_IMAGE_UNITS; break;
     case GL_MAX_VERTEX_UNIFORM_VECTORS:         *params = GLOVE_MAX_VERTEX_UNIFORM_VECTORS; break;
+    case GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS: *params = GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS; break;
+    case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS:      *params = GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS; break;
+    case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS:   *params = GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS; break;
+    case GL_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS: *params = GLOVE_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS; break;
+    case GL_MAX_UNIFORM_BUFFER_BINDINGS:        *params = GLOVE_MAX_UNIFORM_BUFFER_BINDINGS; break;
+    case GL_MAX_UNIFORM_BLOCK_SIZE:             *params = static_cast<GLfloat>(mVkContext->vkMaxUniformBufferRange); break;
+    case GL_MAX_COMPUTE_UNIFORM_BLOCKS:         *params = GLOVE_MAX_COMPUTE_UNIFORM_BLOCKS; break;
     case GL_MAX_VIEWPORT_DIMS:                  params[0] = GLOVE_MAX_TEXTURE_SIZE;
                                                 params[1] = GLOVE_MAX_TEXTURE_SIZE; break;
     case GL_NUM_SHADER_BINARY_FORMATS:          *params = GLOVE_NUM_SHADER_BINARY_FORMATS; break;
@@ -297,22 +486,25 @@ Context::GetFloatv(GLenum pname, GLfloat* params)
     case GL_BLUE_BITS:                          GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), NULL, params, NULL, NULL, NULL, NULL); break;
     case GL_GREEN_BITS:                         GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), NULL, NULL, params, NULL, NULL, NULL); break;
     case GL_ALPHA_BITS:                         GlFormatToStorageBits(mWriteFBO->GetColorAttachmentTexture()->GetInternalFormat(), NULL, NULL, NULL, params, NULL, NULL); break;
-    case GL_DEPTH_BITS:                         GlFormatToStorageBits(mWriteFBO->GetDepthAttachmentTexture()   ? mWriteFBO->GetDepthAttachmentTexture()->GetInternalFormat()   : GL_INVALID_VALUE, NULL, NULL, NULL, NULL, params, NULL); break;
-    case GL_STENCIL_BITS:                       GlFormatToStorageBits(mWriteFBO->GetStencilAttachmentTexture() ? mWriteFBO->GetStencilAttachmentTexture()->GetInternalFormat() : GL_INVALID_VALUE, NULL, NULL, NULL, NULL, NULL, params); break;
+    case GL_DEPTH_BITS:                         GlFormatToStorageBits(mWriteFBO->GetDepthInternalFormat(), NULL, NULL, NULL, NULL, params, NULL); break;
+    case GL_STENCIL_BITS:                       GlFormatToStorageBits(mWriteFBO->GetStencilInternalFormat(), NULL, NULL, NULL, NULL, NULL, params); break;
     case GL_ALIASED_LINE_WIDTH_RANGE:           params[0] = 1.0f;
                                                 params[1] = 1.0f; break;
     case GL_ALIASED_POINT_SIZE_RANGE:           params[0] = 1.0f;
                                                 params[1] = 1.0f; break;
-    case GL_COMPRESSED_TEXTURE_FORMATS:         *params = 0.0f; break;
+    case GL_COMPRESSED_TEXTURE_FORMATS:         { std::vector<GLenum> formats; GetCompressedTextureFormats(&formats);
+                                                  for(size_t i = 0; i < formats.size(); ++i) { params[i] = static_cast<GLfloat>(formats[i]); } } break;
     case GL_DEPTH_RANGE:                        params[0] = mStateManager.GetViewportTransformationState()->GetMinDepthRange();
                                                 params[1] = mStateManager.GetViewportTransformationState()->GetMaxDepthRange(); break;
     case GL_GENERATE_MIPMAP_HINT:               *params = static_cast<GLfloat>(mStateManager.GetHintAspectsState()->GetMode(GL_GENERATE_MIPMAP_HINT)); break;
-    case GL_NUM_COMPRESSED_TEXTURE_FORMATS:     *params = 0.0f; break;
-    case GL_SAMPLES:                            *params = static_cast<GLfloat>(mStateManager.GetFragmentOperationsState()->GetSampleCoverageBits()); break;
-    case GL_SAMPLE_BUFFERS:                     *params = static_cast<GLfloat>(mStateManager.GetFragmentOperationsState()->GetMultiSamplingEnabled()); break;
+    case GL_NUM_COMPRESSED_TEXTURE_FORMATS:     { std::vector<GLenum> formats; GetCompressedTextureFormats(&formats);
+                                                  *params = static_cast<GLfloat>(formats.size()); } break;
+    case GL_SAMPLES:                            *params = static_cast<GLfloat>(GetWriteFBOSamples()); break;
+    case GL_SAMPLE_BUFFERS:                     *params = GetWriteFBOSamples() ? 1.0f : 0.0f; break;
     case GL_SAMPLE_COVERAGE_INVERT:             *params = static_cast<GLfloat>(mStateManager.GetFragmentOperationsState()->GetSampleCoverageInvert()); break;
     case GL_SAMPLE_COVERAGE_VALUE:              *params = mStateManager.GetFragmentOperationsState()->GetSampleCoverageValue(); break;
     case GL_SHADER_COMPILER:                    *params = 1.0f; break;
+    case GL_MAX_SHADER_COMPILER_THREADS_KHR:    *params = static_cast<GLfloat>(mShaderCompileQueue->GetMaxThreads()); break;
     case GL_SUBPIXEL_BITS:                      *params = static_cast<GLfloat>(GLOVE_SUBPIXEL_BITS);; break;
     case GL_TEXTURE_BINDING_2D:                 *params = static_cast<GLfloat>(mResourceManager->GetTextureID(mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_2D))); break;
     case GL_TEXTURE_BINDING_CUBE_MAP:           *params = static_cast<GLfloat>(mResourceManager->GetTextureID(mStateManager.GetActiveObjectsState()->GetActiveTexture(GL_TEXTURE_CUBE_MAP))); break;
@@ -349,7 +541,9 @@ Context::IsEnabled(GLenum cap)
        (cap != GL_SAMPLE_ALPHA_TO_COVERAGE) &&
        (cap != GL_SAMPLE_COVERAGE)          &&
        (cap != GL_SCISSOR_TEST)             &&
-       (cap != GL_STENCIL_TEST) ){
+       (cap != GL_STENCIL_TEST)             &&
+       (cap != GL_PRIMITIVE_RESTART_FIXED_INDEX) &&
+       (cap != GL_RASTERIZER_DISCARD || !mVkContext->mIsTransformFeedbackSupported)) {
          RecordError(GL_INVALID_ENUM);
          return GL_FALSE;
     }
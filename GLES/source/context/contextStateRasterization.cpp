@@ -34,8 +34,7 @@ Context::CullFace(GLenum mode)
     }
 
     if(mStateManager.GetRasterizationState()->UpdateCullFace(mode)) {
-        mPipeline->SetRasterizationCullMode(GlBooleanToVkBool(mStateManager.GetRasterizationState()->GetCullEnabled()),
-                                            GlCullModeToVkCullMode(mStateManager.GetRasterizationState()->GetCullFace()));
+        mStateManager.SetDirtyState(STATE_DIRTY_CULL);
     }
 }
 
@@ -50,7 +49,7 @@ Context::FrontFace(GLenum mode)
     }
 
     if(mStateManager.GetRasterizationState()->UpdateFrontFace(mode)) {
-        mPipeline->SetRasterizationFrontFace(GlFrontFaceToVkFrontFace(mStateManager.GetRasterizationState()->GetFrontFace()));
+        mStateManager.SetDirtyState(STATE_DIRTY_CULL);
     }
 }
 
@@ -73,10 +72,10 @@ Context::PolygonOffset(GLfloat factor, GLfloat units)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mStateManager.GetRasterizationState()->UpdatePolygonOffsetFactor(factor)) {
-         mPipeline->SetRasterizationDepthBiasConstantFactor(mStateManager.GetRasterizationState()->GetPolygonOffsetFactor());
+         mStateManager.SetDirtyState(STATE_DIRTY_POLYGON_OFFSET);
     }
 
     if(mStateManager.GetRasterizationState()->UpdatePolygonOffsetUnits(units)) {
-         mPipeline->SetRasterizationDepthBiasSlopeFactor(mStateManager.GetRasterizationState()->GetPolygonOffsetUnits());
+         mStateManager.SetDirtyState(STATE_DIRTY_POLYGON_OFFSET);
     }
 }
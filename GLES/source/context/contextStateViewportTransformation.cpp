@@ -45,5 +45,6 @@ Context::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
 
     if(mStateManager.GetViewportTransformationState()->UpdateViewportRect(x, y, width, height)) {
         mPipeline->SetUpdateViewportState(true);
+        InvalidateQueryBlock();
     }
 }
@@ -23,13 +23,125 @@
 
 #include "context.h"
 #include "resources/texture.h"
+#include "GLES2/gl2ext_glove.h"
+#include "utils/textureDecoder.h"
+#include "vulkan/capabilityCache.h"
+#include "vulkan/utils.h"
+
+static const GLenum compressedTextureFormats[] = {
+    GL_ETC1_RGB8_OES,
+    GL_COMPRESSED_RGB8_ETC2,
+    GL_COMPRESSED_SRGB8_ETC2,
+    GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+    GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+    GL_COMPRESSED_RGBA8_ETC2_EAC,
+    GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC,
+    GL_COMPRESSED_R11_EAC,
+    GL_COMPRESSED_SIGNED_R11_EAC,
+    GL_COMPRESSED_RG11_EAC,
+    GL_COMPRESSED_SIGNED_RG11_EAC,
+    GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
+    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+    GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,
+    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,
+    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,
+    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
+    GL_COMPRESSED_RED_RGTC1_EXT,
+    GL_COMPRESSED_SIGNED_RED_RGTC1_EXT,
+    GL_COMPRESSED_RED_GREEN_RGTC2_EXT,
+    GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT,
+    GL_COMPRESSED_RGBA_ASTC_4x4_KHR,
+    GL_COMPRESSED_RGBA_ASTC_5x4_KHR,
+    GL_COMPRESSED_RGBA_ASTC_5x5_KHR,
+    GL_COMPRESSED_RGBA_ASTC_6x5_KHR,
+    GL_COMPRESSED_RGBA_ASTC_6x6_KHR,
+    GL_COMPRESSED_RGBA_ASTC_8x5_KHR,
+    GL_COMPRESSED_RGBA_ASTC_8x6_KHR,
+    GL_COMPRESSED_RGBA_ASTC_8x8_KHR,
+    GL_COMPRESSED_RGBA_ASTC_10x5_KHR,
+    GL_COMPRESSED_RGBA_ASTC_10x6_KHR,
+    GL_COMPRESSED_RGBA_ASTC_10x8_KHR,
+    GL_COMPRESSED_RGBA_ASTC_10x10_KHR,
+    GL_COMPRESSED_RGBA_ASTC_12x10_KHR,
+    GL_COMPRESSED_RGBA_ASTC_12x12_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR,
+    GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR
+};
+
+bool
+Context::IsCompressedTextureFormatNative(GLenum format)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!GlFormatIsCompressed(format)) {
+        return false;
+    }
+
+    const VkFormat vkformat = GlCompressedFormatToVkFormat(format);
+
+    bool featureEnabled;
+    if(vkformat >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && vkformat <= VK_FORMAT_BC7_SRGB_BLOCK) {
+        featureEnabled = mVkContext->mIsTextureCompressionBCSupported;
+    } else if(vkformat >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && vkformat <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK) {
+        featureEnabled = mVkContext->mIsTextureCompressionETC2Supported;
+    } else if(vkformat >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && vkformat <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+        featureEnabled = mVkContext->mIsTextureCompressionASTCSupported;
+    } else {
+        return false;
+    }
+
+    if(!featureEnabled) {
+        return false;
+    }
+
+    // the device feature covers the whole family, still check the format itself
+    const VkFormatProperties props = mVkContext->capabilityCache->GetFormatProperties(vkformat);
+
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (props.optimalTilingFeatures & required) == required;
+}
+
+bool
+Context::IsCompressedTextureFormatSupported(GLenum format)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return IsCompressedTextureFormatNative(format) || GlCompressedFormatIsDecodable(format);
+}
+
+void
+Context::GetCompressedTextureFormats(std::vector<GLenum> *formats)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    formats->clear();
+    for(GLenum format : compressedTextureFormats) {
+        if(IsCompressedTextureFormatSupported(format)) {
+            formats->push_back(format);
+        }
+    }
+}
 
 void
 Context::ActiveTexture(GLenum texture)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(texture < GL_TEXTURE0 || texture >= GL_TEXTURE0 + GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS) {
+    if(!mNoError && (texture < GL_TEXTURE0 || texture >= GL_TEXTURE0 + GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -42,7 +154,7 @@ Context::BindTexture(GLenum target, GLuint texture)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(target != GL_TEXTURE_2D && target != GL_TEXTURE_CUBE_MAP) {
+    if(!mNoError && target != GL_TEXTURE_2D && target != GL_TEXTURE_CUBE_MAP) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -61,7 +173,8 @@ Context::BindTexture(GLenum target, GLuint texture)
         if(tex->GetTarget() == GL_INVALID_VALUE) {
             tex->SetVkContext(mVkContext);
             tex->SetTarget(target);
-            tex->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+            tex->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+                                                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
             tex->SetVkImageTarget(target == GL_TEXTURE_2D ? vulkanAPI::Image::VK_IMAGE_TARGET_2D : vulkanAPI::Image::VK_IMAGE_TARGET_CUBE);
             tex->SetVkImageTiling();
 
@@ -103,7 +216,11 @@ Context::DeleteTextures(GLsizei n, const GLuint* textures)
 
         if (texture && mResourceManager->TextureExists(texture)) {
 
-            if(mWriteFBO->IsInDrawState()) {
+            // only a pending framebuffer it is attached to needs to complete, other references retire with their frames
+            if(IsFramebufferPending(mWriteFBO) &&
+               ((texture == mWriteFBO->GetColorAttachmentName()   && GL_TEXTURE == mWriteFBO->GetColorAttachmentType())   ||
+                (texture == mWriteFBO->GetDepthAttachmentName()   && GL_TEXTURE == mWriteFBO->GetDepthAttachmentType())   ||
+                (texture == mWriteFBO->GetStencilAttachmentName() && GL_TEXTURE == mWriteFBO->GetStencilAttachmentType()))) {
                 if(texture == mWriteFBO->GetColorAttachmentName() && GL_TEXTURE == mWriteFBO->GetColorAttachmentType()) {
                     mWriteFBO->SetStateDelete();
                 }
@@ -173,6 +290,7 @@ Context::GenerateMipmap(GLenum target)
         return;
     }
 
+    FinishTextureCommands(activeTexture);
     activeTexture->GenerateMipmaps(mStateManager.GetHintAspectsState()->GetMode(GL_GENERATE_MIPMAP_HINT));
 }
 
@@ -223,7 +341,9 @@ Context::TexParameteri(GLenum target, GLenum pname, GLint param)
     }
 
     if(pname != GL_TEXTURE_WRAP_S     && pname != GL_TEXTURE_WRAP_T &&
-       pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER) {
+       pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER &&
+       pname != GL_TEXTURE_COMPARE_MODE_EXT && pname != GL_TEXTURE_COMPARE_FUNC_EXT &&
+       pname != GL_TEXTURE_TRANSIENT_GLOVE) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -260,6 +380,33 @@ Context::TexParameteri(GLenum target, GLenum pname, GLint param)
         }
         activeTexture->SetMagFilter(param);
         break;
+    case GL_TEXTURE_COMPARE_MODE_EXT:
+        if(param != GL_NONE && param != GL_COMPARE_REF_TO_TEXTURE_EXT) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+        activeTexture->SetCompareMode(param);
+        break;
+    case GL_TEXTURE_COMPARE_FUNC_EXT:
+        if(param != GL_NEVER   && param != GL_LESS     && param != GL_EQUAL  && param != GL_LEQUAL &&
+           param != GL_GREATER && param != GL_NOTEQUAL && param != GL_GEQUAL && param != GL_ALWAYS) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+        activeTexture->SetCompareFunc(param);
+        break;
+    case GL_TEXTURE_TRANSIENT_GLOVE:
+        if(param != GL_TRUE && param != GL_FALSE) {
+            RecordError(GL_INVALID_VALUE);
+            return;
+        }
+        // the default textures are shared by every unit and keep memory of their own
+        if(!mResourceManager->GetTextureID(activeTexture)) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+        activeTexture->SetTransientPool(param ? mResourceManager->GetTransientTexturePool() : nullptr);
+        break;
     default:
         break;
     }
@@ -284,7 +431,9 @@ Context::GetTexParameterfv(GLenum target, GLenum pname, GLfloat* params)
     }
 
     if(pname != GL_TEXTURE_WRAP_S     && pname != GL_TEXTURE_WRAP_T &&
-       pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER) {
+       pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER &&
+       pname != GL_TEXTURE_COMPARE_MODE_EXT && pname != GL_TEXTURE_COMPARE_FUNC_EXT &&
+       pname != GL_TEXTURE_TRANSIENT_GLOVE && pname != GL_TEXTURE_IMMUTABLE_FORMAT_EXT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -296,6 +445,10 @@ Context::GetTexParameterfv(GLenum target, GLenum pname, GLfloat* params)
     case GL_TEXTURE_WRAP_T:                     *params = static_cast<GLfloat>(activeTexture->GetWrapT());      break;
     case GL_TEXTURE_MIN_FILTER:                 *params = static_cast<GLfloat>(activeTexture->GetMinFilter());  break;
     case GL_TEXTURE_MAG_FILTER:                 *params = static_cast<GLfloat>(activeTexture->GetMagFilter());  break;
+    case GL_TEXTURE_COMPARE_MODE_EXT:           *params = static_cast<GLfloat>(activeTexture->GetCompareMode()); break;
+    case GL_TEXTURE_COMPARE_FUNC_EXT:           *params = static_cast<GLfloat>(activeTexture->GetCompareFunc()); break;
+    case GL_TEXTURE_TRANSIENT_GLOVE:            *params = activeTexture->IsTransient() ? 1.0f : 0.0f;           break;
+    case GL_TEXTURE_IMMUTABLE_FORMAT_EXT:       *params = activeTexture->IsImmutable() ? 1.0f : 0.0f;           break;
     default:                                    break;
     }
 }
@@ -311,7 +464,9 @@ Context::GetTexParameteriv(GLenum target, GLenum pname, GLint* params)
     }
 
     if(pname != GL_TEXTURE_WRAP_S     && pname != GL_TEXTURE_WRAP_T &&
-       pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER) {
+       pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER &&
+       pname != GL_TEXTURE_COMPARE_MODE_EXT && pname != GL_TEXTURE_COMPARE_FUNC_EXT &&
+       pname != GL_TEXTURE_TRANSIENT_GLOVE && pname != GL_TEXTURE_IMMUTABLE_FORMAT_EXT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -323,6 +478,10 @@ Context::GetTexParameteriv(GLenum target, GLenum pname, GLint* params)
     case GL_TEXTURE_WRAP_T:                     *params = activeTexture->GetWrapT();      break;
     case GL_TEXTURE_MIN_FILTER:                 *params = activeTexture->GetMinFilter();  break;
     case GL_TEXTURE_MAG_FILTER:                 *params = activeTexture->GetMagFilter();  break;
+    case GL_TEXTURE_COMPARE_MODE_EXT:           *params = activeTexture->GetCompareMode(); break;
+    case GL_TEXTURE_COMPARE_FUNC_EXT:           *params = activeTexture->GetCompareFunc(); break;
+    case GL_TEXTURE_TRANSIENT_GLOVE:            *params = activeTexture->IsTransient() ? GL_TRUE : GL_FALSE; break;
+    case GL_TEXTURE_IMMUTABLE_FORMAT_EXT:       *params = activeTexture->IsImmutable() ? GL_TRUE : GL_FALSE; break;
     default:                                    break;
     }
 }
@@ -346,13 +505,15 @@ Context::TexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei w
     }
 
     if(format != GL_ALPHA     && format != GL_RGB && format != GL_RGBA &&
-       format != GL_LUMINANCE && format != GL_LUMINANCE_ALPHA) {
+       format != GL_LUMINANCE && format != GL_LUMINANCE_ALPHA && format != GL_DEPTH_COMPONENT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
     if(type != GL_UNSIGNED_BYTE          && type != GL_UNSIGNED_SHORT_5_6_5 &&
-       type != GL_UNSIGNED_SHORT_4_4_4_4 && type != GL_UNSIGNED_SHORT_5_5_5_1) {
+       type != GL_UNSIGNED_SHORT_4_4_4_4 && type != GL_UNSIGNED_SHORT_5_5_5_1 &&
+       type != GL_HALF_FLOAT_OES         && type != GL_FLOAT &&
+       type != GL_UNSIGNED_SHORT         && type != GL_UNSIGNED_INT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -363,7 +524,7 @@ Context::TexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei w
     }
 
     if(internalformat != GL_ALPHA     && internalformat != GL_RGB && internalformat != GL_RGBA &&
-       internalformat != GL_LUMINANCE && internalformat != GL_LUMINANCE_ALPHA) {
+       internalformat != GL_LUMINANCE && internalformat != GL_LUMINANCE_ALPHA && internalformat != GL_DEPTH_COMPONENT) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
@@ -389,29 +550,84 @@ Context::TexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei w
     if((type == GL_UNSIGNED_BYTE && format != GL_RGBA && format != GL_RGB &&
         format != GL_LUMINANCE_ALPHA && format != GL_LUMINANCE && format != GL_ALPHA) ||
         (type == GL_UNSIGNED_SHORT_5_6_5                                          && format != GL_RGB) ||
-        ((type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1) && format != GL_RGBA)) {
+        ((type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1) && format != GL_RGBA) ||
+        ((type == GL_UNSIGNED_SHORT || type == GL_UNSIGNED_INT) != (format == GL_DEPTH_COMPONENT))) {
         RecordError(GL_INVALID_OPERATION);
         return;
      }
 
+    // depth textures (GL_OES_depth_texture) are 2D and single level, and only get their contents by rendering
+    if(format == GL_DEPTH_COMPONENT && (target != GL_TEXTURE_2D || level || pixels)) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // the storage of immutable textures is never redefined
+    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
+    if(activeTexture->IsImmutable()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+
+    // with an unpack buffer bound, pixels is an offset into it
+    std::vector<uint8_t> unpackPixels;
+    BufferObject *pbo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV);
+    if(pbo && format != GL_DEPTH_COMPONENT) {
+        const size_t unpackOffset = reinterpret_cast<uintptr_t>(pixels);
+        const ImageRect unpackRect(0, 0, width, height,
+                                   GlInternalFormatTypeToNumElements(GlFormatToGlInternalFormat(format, type), type),
+                                   GlTypeToElementSize(type),
+                                   mStateManager.GetPixelStorageState()->GetPixelStoreUnpack());
+        if(pbo->IsMapped() || unpackOffset + unpackRect.GetRectBufferSize() > pbo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+
+        if(!width || !height) {
+            return;
+        }
+
+        // a level specified again as it was only gets new contents, copied on the device
+        const Rect rect(0, 0, width, height);
+        if(activeTexture->IsLevelSpecified(level, layer, width, height, format, type) &&
+           UnpackBufferToTexture(pbo, activeTexture, &rect, level, layer, format, type, unpackOffset)) {
+            return;
+        }
+
+        // otherwise the texels are taken from the host copy of the buffer
+        pixels = ReadUnpackBuffer(pbo, unpackOffset, unpackRect.GetRectBufferSize(), &unpackPixels);
+    }
+
     if(!width || !height) {
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
+    if(HasPendingCommands()) {
         Finish();
     }
 
     // copy the buffer contents to the texture
-    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
-    GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
     activeTexture->SetState(width, height, level, layer, format, type, mStateManager.GetPixelStorageState()->GetPixelStoreUnpack(), pixels);
 
     if(activeTexture->IsCompleted()) {
         // pass contents to the driver
-        VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(format, type));
+        VkFormat vkformat;
+        if(format == GL_DEPTH_COMPONENT) {
+            vkformat = GlInternalFormatToVkFormat(GlFormatToGlInternalFormat(format, type));
+            vkformat = FindSupportedDepthStencilFormat(mVkContext->capabilityCache, GetVkFormatDepthBits(vkformat), 0,
+                                                       VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+        } else {
+            vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(format, type));
+        }
         activeTexture->SetVkFormat(vkformat);
-        activeTexture->Allocate();
+        activeTexture->RequestAllocation();
+
+        // framebuffers render to the depth texture itself, so they move to its new image
+        if(format == GL_DEPTH_COMPONENT) {
+            mResourceManager->UpdateFramebufferObjects(mResourceManager->GetTextureID(activeTexture), GL_TEXTURE);
+        }
     }
 }
 
@@ -437,7 +653,8 @@ Context::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
     }
 
     if(type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT_5_6_5 &&
-       type != GL_UNSIGNED_SHORT_4_4_4_4 && type != GL_UNSIGNED_SHORT_5_5_5_1) {
+       type != GL_UNSIGNED_SHORT_4_4_4_4 && type != GL_UNSIGNED_SHORT_5_5_5_1 &&
+       type != GL_HALF_FLOAT_OES && type != GL_FLOAT) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -462,23 +679,71 @@ Context::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
         return;
     }
 
+    // depth textures only get their contents by rendering
+    if(activeTexture->IsDepthTexture()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // immutable textures convert the texels to the format they were given storage with
+    if(activeTexture->IsImmutable() && format != activeTexture->GetFormat()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // float texels are stored as given, so they are only updated with texels of the same type
+    const bool floatType = (type == GL_HALF_FLOAT_OES || type == GL_FLOAT);
+    const bool floatTexture = (activeTexture->GetType() == GL_HALF_FLOAT_OES || activeTexture->GetType() == GL_FLOAT);
+    if((floatType || floatTexture) && (type != activeTexture->GetType() || format != activeTexture->GetFormat())) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+
+    // with an unpack buffer bound, pixels is an offset into it, and the texels
+    // are copied on the device whenever the image stores them as they are given
+    std::vector<uint8_t> unpackPixels;
+    BufferObject *pbo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV);
+    if(pbo) {
+        const size_t unpackOffset = reinterpret_cast<uintptr_t>(pixels);
+        const ImageRect unpackRect(0, 0, width, height,
+                                   GlInternalFormatTypeToNumElements(GlFormatToGlInternalFormat(format, type), type),
+                                   GlTypeToElementSize(type),
+                                   mStateManager.GetPixelStorageState()->GetPixelStoreUnpack());
+        if(pbo->IsMapped() || unpackOffset + unpackRect.GetRectBufferSize() > pbo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+
+        if(!width || !height) {
+            return;
+        }
+
+        const Rect rect(xoffset, yoffset, width, height);
+        if(UnpackBufferToTexture(pbo, activeTexture, &rect, level, layer, format, type, unpackOffset)) {
+            return;
+        }
+
+        // otherwise the texels are taken from the host copy of the buffer
+        pixels = ReadUnpackBuffer(pbo, unpackOffset, unpackRect.GetRectBufferSize(), &unpackPixels);
+    }
+
     // TODO:: We could pass a default subtexture instead
     if(pixels == nullptr) {
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
+    if(HasPendingCommands()) {
         Finish();
     }
 
-    if(mWriteFBO != mSystemFBO && GetResourceManager()->IsTextureAttachedToFBO(activeTexture)) {
-        activeTexture->SetFboColorAttached(true);
+    if(mWriteFBO != mSystemFBO && !activeTexture->IsImmutable() && GetResourceManager()->IsTextureAttachedToFBO(activeTexture)) {
+        activeTexture->SetFboColorAttached(!mWriteFBO->IsStoredUpright());
         activeTexture->SetDataNoInvertion(true);
         CopyTexImage2D(target, level, format, 0, 0, activeTexture->GetWidth(), activeTexture->GetHeight(), 0);
     }
 
-    GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
-
     GLenum srcInternalFormat = GlFormatToGlInternalFormat(format, type);
     GLenum dstInternalFormat = activeTexture->GetInternalFormat();
     ImageRect srcRect(0,       0,       width, height,
@@ -490,15 +755,124 @@ Context::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
                       GlTypeToElementSize(activeTexture->GetType()),
                       Texture::GetDefaultInternalAlignment());
 
+    // textures without a host copy only upload the sub-rectangle
+    VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(format, type));
+    if(activeTexture->SubmitSubState(&srcRect, &dstRect, level, layer, srcInternalFormat, vkformat, pixels)) {
+        return;
+    }
+
     // copy the buffer contents to the texture
     activeTexture->SetSubState(&srcRect, &dstRect, level, layer, srcInternalFormat, pixels);
 
     if(activeTexture->IsCompleted()) {
         // pass contents to the driver
-        VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(format, type));
         activeTexture->SetVkFormat(vkformat);
-        activeTexture->Allocate();
+        activeTexture->RequestAllocation();
+    }
+}
+
+void
+Context::FinishTextureCommands(const Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // commands recorded but not yet submitted may still refer to the texture's image
+    if(HasPendingCommands() && texture->GetLastUsedSerial(mShareGroupSlot) >= mCommandBufferManager->GetSubmitSerial()) {
+        Finish();
+    }
+}
+
+const void *
+Context::ReadUnpackBuffer(BufferObject *pbo, size_t offset, size_t size, std::vector<uint8_t> *data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // what the device has written into the buffer is only in its host copy once read back
+    FinishBufferDeviceWrites(pbo);
+    FinishBufferReadbacks(pbo);
+
+    data->resize(size);
+    if(!pbo->GetData(size, offset, data->data())) {
+        return nullptr;
+    }
+
+    return data->data();
+}
+
+bool
+Context::UnpackBufferToTexture(BufferObject *pbo, Texture *texture, const Rect *rect, GLint level, GLint layer, GLenum format, GLenum type, size_t offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the device copies the texels straight out of the buffer, which it has to hold
+    // as the application wrote them, and in the very format of the image
+    const VkFormat vkformat = GlColorFormatToVkColorFormat(format, type);
+    if(pbo->HasPendingReadbacks() || pbo->IsDeviceWritten() ||
+       GlFormatToGlInternalFormat(format, type) != texture->GetExplicitInternalFormat() || type != texture->GetExplicitType()) {
+        return false;
+    }
+
+    // rows are given in texels, and copies on a transfer queue start at multiples of 4 bytes
+    const ImageRect unpackRect(0, 0, rect->width, rect->height,
+                               GlInternalFormatTypeToNumElements(GlFormatToGlInternalFormat(format, type), type),
+                               GlTypeToElementSize(type),
+                               mStateManager.GetPixelStorageState()->GetPixelStoreUnpack());
+    const uint32_t texelSize = unpackRect.GetPixelByteOffset();
+    const uint32_t rowBytes  = unpackRect.GetRectAlignedRowInBytes();
+    if(!texelSize || (rowBytes % texelSize) || (offset % texelSize) || (offset % 4)) {
+        return false;
+    }
+
+    // uploads execute ahead of the frame being recorded, which must not see the new contents
+    FinishTextureCommands(texture);
+    if(!texture->SubmitSubStateFromBuffer(rect, level, layer, vkformat, pbo->GetVkBuffer(), offset, rowBytes / texelSize)) {
+        return false;
+    }
+
+    // later updates of the buffer go to a new backing, this one is read until the copy has executed
+    pbo->SetUsed(true);
+
+    return true;
+}
+
+bool
+Context::CopyFramebufferToTexture(Texture *texture, GLint x, GLint y, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLint level, GLint layer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Texture   *fbTexture = mWriteFBO->GetColorAttachmentTexture();
+    const bool invertY   = !mWriteFBO->IsStoredUpright();
+    if(width <= 0 || height <= 0 || x < 0 || y < 0 ||
+       x + width > mWriteFBO->GetWidth() || y + height > mWriteFBO->GetHeight() ||
+       !texture->CanCopyFromVkImage(fbTexture, invertY, level)) {
+        return false;
+    }
+
+    // the copy is recorded right after the draws it has to see, so the render pass
+    // is split around it instead of submitting and waiting for the queue to idle
+    FlushDrawBatch();
+    ResolvePendingClear();
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
+    }
+
+    Rect srcRect(x, y, width, height);
+    if(invertY) {
+        srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
     }
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    texture->CopyFromVkImage(&activeCmdBuffer, fbTexture, &srcRect, invertY, xoffset, yoffset, level, layer);
+    texture->SetLastUsedSerial(mShareGroupSlot, mCommandBufferManager->GetSubmitSerial());
+
+    // rendering resumes on the same attachments
+    mWriteFBO->SetStateDraw();
+    SetClearRect();
+    BeginRendering(false, false, false);
+
+    return true;
 }
 
 void
@@ -540,16 +914,16 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
-        Finish();
-    }
-
     Texture *fbTexture = mWriteFBO->GetColorAttachmentTexture();
     if(fbTexture == nullptr) {
         return;
     }
 
     Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
+    if(activeTexture->IsImmutable()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
 
     const GLenum fbFormat = fbTexture->GetFormat();
     if((fbFormat == GL_ALPHA  && internalformat != GL_ALPHA) ||
@@ -558,6 +932,26 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
        return;
     }
 
+    const GLint    layer   = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+
+    // color framebuffer contents are copied on the GPU into the redefined level
+    if(internalformat == GL_RGBA && activeTexture != fbTexture) {
+        FinishTextureCommands(activeTexture);
+
+        activeTexture->SetState(width, height, level, layer, GL_RGBA, GL_UNSIGNED_BYTE, Texture::GetDefaultInternalAlignment(), nullptr);
+        if(activeTexture->IsCompleted()) {
+            VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(GL_RGBA, GL_UNSIGNED_BYTE));
+            activeTexture->SetVkFormat(vkformat);
+            if(activeTexture->Allocate() && CopyFramebufferToTexture(activeTexture, x, y, 0, 0, width, height, level, layer)) {
+                return;
+            }
+        }
+    }
+
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
     // transfer the data to the cpu and upload it to a new texture
     GLenum srcInternalFormat = fbTexture->GetExplicitInternalFormat();
     GLenum dstInternalFormat = internalformat;
@@ -571,11 +965,14 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
                       GlTypeToElementSize(dstType),
                       Texture::GetDefaultInternalAlignment());
 
-    const GLint    layer   = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
 
     const size_t stageSize = dstRect.GetRectBufferSize();
     uint8_t *stagePixels = new uint8_t[stageSize];
-    srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
+    if(mWriteFBO->IsStoredUpright()) {
+        fbTexture->SetDataNoInvertion(true);
+    } else {
+        srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
+    }
 
     // copy the framebuffer contents to the temp buffer
     // and convert them to the texture's internal format
@@ -589,7 +986,7 @@ Context::CopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint
         // pass contents to the driver
         VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(activeTexture->GetFormat(), activeTexture->GetType()));
         activeTexture->SetVkFormat(vkformat);
-        activeTexture->Allocate();
+        activeTexture->RequestAllocation();
     }
 }
 
@@ -623,10 +1020,6 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
         return;
     }
 
-    if(mWriteFBO->IsInDrawState()) {
-        Finish();
-    }
-
     Texture *fbTexture = mWriteFBO->GetColorAttachmentTexture();
     if(fbTexture == nullptr) {
         return;
@@ -635,13 +1028,24 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
     const GLenum fbFormat       = fbTexture->GetFormat();
     const GLenum internalformat = activeTexture->GetInternalFormat();
     if((fbFormat == GL_ALPHA &&  internalformat != GL_ALPHA) ||
-       (fbFormat == GL_RGB   && (internalformat != GL_LUMINANCE && internalformat != GL_RGB))) {
+       (fbFormat == GL_RGB   && (internalformat != GL_LUMINANCE && internalformat != GL_RGB)) ||
+       activeTexture->IsDepthTexture()) {
        RecordError(GL_INVALID_OPERATION);
        return;
     }
 
     GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
 
+    // color framebuffer contents are copied on the GPU into the existing level
+    if(activeTexture != fbTexture && activeTexture->AllocatePending() &&
+       CopyFramebufferToTexture(activeTexture, x, y, xoffset, yoffset, width, height, level, layer)) {
+        return;
+    }
+
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
     GLenum srcInternalFormat = fbTexture->GetExplicitInternalFormat();
     GLenum dstInternalFormat = internalformat;
     ImageRect srcRect(x,       y,       width, height,
@@ -655,7 +1059,11 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
 
     const size_t stageSize = dstRect.GetRectBufferSize();
     uint8_t *stagePixels = new uint8_t[stageSize];
-    srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
+    if(mWriteFBO->IsStoredUpright()) {
+        fbTexture->SetDataNoInvertion(true);
+    } else {
+        srcRect.y = fbTexture->GetInvertedYOrigin(&srcRect);
+    }
 
     // copy the framebuffer subcontents to the temp buffer
     // and convert them to the texture's internal format
@@ -665,13 +1073,18 @@ Context::CopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoff
     srcRect.x = 0; srcRect.y = 0;
     // now copy the temp buffer contents to the texture
     // source and destination rectangles have now similar properties except from their x,y offsets
+    VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(activeTexture->GetFormat(), activeTexture->GetType()));
+    if(activeTexture->SubmitSubState(&srcRect, &dstRect, level, layer, dstInternalFormat, vkformat, stagePixels)) {
+        delete[] stagePixels;
+        return;
+    }
+
     activeTexture->SetSubState(&srcRect, &dstRect, level, layer, dstInternalFormat, stagePixels);
     delete[] stagePixels;
 
     if(activeTexture->IsCompleted()) {
-        VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(activeTexture->GetFormat(), activeTexture->GetType()));
         activeTexture->SetVkFormat(vkformat);
-        activeTexture->Allocate();
+        activeTexture->RequestAllocation();
     }
 }
 
@@ -685,8 +1098,7 @@ Context::CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat,
         return;
     }
 
-    if(internalformat != GL_ALPHA     && internalformat != GL_RGB && internalformat != GL_RGBA &&
-       internalformat != GL_LUMINANCE && internalformat != GL_LUMINANCE_ALPHA) {
+    if(!IsCompressedTextureFormatSupported(internalformat)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
@@ -704,15 +1116,71 @@ Context::CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat,
         return;
      }
 
+    if(target != GL_TEXTURE_2D && width != height) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(imageSize != GlCompressedImageSize(internalformat, width, height)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // with an unpack buffer bound, data is an offset into it, the blocks are taken from its host copy
+    std::vector<uint8_t> unpackData;
+    BufferObject *pbo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV);
+    if(pbo) {
+        const size_t unpackOffset = reinterpret_cast<uintptr_t>(data);
+        if(pbo->IsMapped() || unpackOffset + imageSize > pbo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+        data = ReadUnpackBuffer(pbo, unpackOffset, imageSize, &unpackData);
+    }
+
+    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
+    if(activeTexture->IsImmutable()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
     if(width == 0 || height == 0) {
         return;
     }
 
-    // TODO:
-    //GL_INVALID_VALUE is generated if imageSize is not consistent with the format, dimensions, and contents of the specified compressed image data.
-    //GL_INVALID_OPERATION is generated if parameter combinations are not supported by the specific compressed internal format as specified in the specific texture compression extension.
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    GLint    layer         = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+
+    if(!IsCompressedTextureFormatNative(internalformat)) {
+        // the device cannot sample this format, decode it to RGBA8 on the CPU
+        uint8_t *pixels = nullptr;
+        if(data) {
+            pixels = new uint8_t[width * height * 4];
+            DecodeCompressedImage(internalformat, width, height, data, pixels);
+        }
+
+        activeTexture->SetState(width, height, level, layer, GL_RGBA, GL_UNSIGNED_BYTE, 4, pixels);
+        activeTexture->SetCompressedFormat(internalformat);
+        delete[] pixels;
 
-    NOT_IMPLEMENTED();
+        if(activeTexture->IsCompleted()) {
+            VkFormat vkformat = activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(GL_RGBA, GL_UNSIGNED_BYTE));
+            activeTexture->SetVkFormat(vkformat);
+            activeTexture->RequestAllocation();
+        }
+        return;
+    }
+
+    // the compressed blocks are passed to the driver as they are
+    activeTexture->SetCompressedState(width, height, level, layer, internalformat, imageSize, data);
+
+    if(activeTexture->IsCompleted()) {
+        activeTexture->SetVkFormat(GlCompressedFormatToVkFormat(internalformat));
+        activeTexture->RequestAllocation();
+    }
 }
 
 void
@@ -725,13 +1193,12 @@ Context::CompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLin
         return;
     }
 
-    if(format != GL_ALPHA     && format != GL_RGB && format != GL_RGBA &&
-       format != GL_LUMINANCE && format != GL_LUMINANCE_ALPHA) {
+    if(!IsCompressedTextureFormatSupported(format)) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    if(level < 0 || width < 0 || height < 0 ||
+    if(level < 0 || width < 0 || height < 0 || xoffset < 0 || yoffset < 0 ||
        ((width > GLOVE_MAX_TEXTURE_SIZE || height > GLOVE_MAX_TEXTURE_SIZE) && target == GL_TEXTURE_2D) ||
        ((width > GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE || height > GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE) && target != GL_TEXTURE_2D)) {
         RecordError(GL_INVALID_VALUE);
@@ -745,14 +1212,166 @@ Context::CompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLin
         return;
     }
 
-    if(tex->GetFormat() != format) {
+    if(tex->GetCompressedFormat() != format) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // updates must cover whole blocks, except at the right and bottom edges of the level
+    GLint blockWidth, blockHeight;
+    GlCompressedFormatToBlockSize(format, &blockWidth, &blockHeight, nullptr);
+    const GLint levelWidth  = std::max(1, tex->GetWidth()  >> level);
+    const GLint levelHeight = std::max(1, tex->GetHeight() >> level);
+    if((xoffset % blockWidth) || (yoffset % blockHeight) ||
+       ((width  % blockWidth ) && xoffset + width  != levelWidth ) ||
+       ((height % blockHeight) && yoffset + height != levelHeight)) {
         RecordError(GL_INVALID_OPERATION);
         return;
     }
 
-    // TODO:
-    //GL_INVALID_VALUE is generated if imageSize is not consistent with the format, dimensions, and contents of the specified compressed image data.
-    //GL_INVALID_OPERATION is generated if parameter combinations are not supported by the specific compressed internal format as specified in the specific texture compression extension.
+    if(imageSize != GlCompressedImageSize(format, width, height)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    std::vector<uint8_t> unpackData;
+    BufferObject *pbo = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_PIXEL_UNPACK_BUFFER_NV);
+    if(pbo) {
+        const size_t unpackOffset = reinterpret_cast<uintptr_t>(data);
+        if(pbo->IsMapped() || unpackOffset + imageSize > pbo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+        data = ReadUnpackBuffer(pbo, unpackOffset, imageSize, &unpackData);
+    }
+
+    if(width == 0 || height == 0 || data == nullptr) {
+        return;
+    }
+
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    GLint layer = (target == GL_TEXTURE_2D) ? 0 : target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+
+    if(!IsCompressedTextureFormatNative(format)) {
+        // the texture holds the decoded RGBA8 contents, decode the update likewise
+        uint8_t *pixels = new uint8_t[width * height * 4];
+        DecodeCompressedImage(format, width, height, data, pixels);
+
+        const GLenum srcInternalFormat = GlFormatToGlInternalFormat(GL_RGBA, GL_UNSIGNED_BYTE);
+        const GLenum dstInternalFormat = tex->GetInternalFormat();
+        ImageRect srcRect(0,       0,       width, height, 4, 1, 4);
+        ImageRect dstRect(xoffset, yoffset, width, height,
+                          GlInternalFormatTypeToNumElements(dstInternalFormat, tex->GetType()),
+                          GlTypeToElementSize(tex->GetType()),
+                          Texture::GetDefaultInternalAlignment());
+
+        VkFormat vkformat = tex->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(GL_RGBA, GL_UNSIGNED_BYTE));
+        if(!tex->SubmitSubState(&srcRect, &dstRect, level, layer, srcInternalFormat, vkformat, pixels)) {
+            tex->SetSubState(&srcRect, &dstRect, level, layer, srcInternalFormat, pixels);
+            if(tex->IsCompleted()) {
+                tex->SetVkFormat(vkformat);
+                tex->RequestAllocation();
+            }
+        }
+        delete[] pixels;
+        return;
+    }
+
+    Rect rect(xoffset, yoffset, width, height);
+    if(!tex->SubmitCompressedSubState(&rect, level, layer, imageSize, data) && tex->IsCompleted()) {
+        tex->SetVkFormat(GlCompressedFormatToVkFormat(format));
+        tex->RequestAllocation();
+    }
+}
+
+static bool
+TexStorageFormatToGlFormatType(GLenum internalformat, GLenum *format, GLenum *type)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    switch(internalformat) {
+    case GL_ALPHA8_EXT:             *format = GL_ALPHA;           *type = GL_UNSIGNED_BYTE; return true;
+    case GL_LUMINANCE8_EXT:         *format = GL_LUMINANCE;       *type = GL_UNSIGNED_BYTE; return true;
+    case GL_LUMINANCE8_ALPHA8_EXT:  *format = GL_LUMINANCE_ALPHA; *type = GL_UNSIGNED_BYTE; return true;
+    case GL_RGB565:
+    case GL_RGBA4:
+    case GL_RGB5_A1:
+    case GL_RGB8_OES:
+    case GL_RGBA8_OES:
+    case GL_RGBA16F_EXT:
+    case GL_RGB16F_EXT:
+    case GL_ALPHA16F_EXT:
+    case GL_LUMINANCE16F_EXT:
+    case GL_LUMINANCE_ALPHA16F_EXT:
+    case GL_RGBA32F_EXT:
+    case GL_RGB32F_EXT:
+    case GL_ALPHA32F_EXT:
+    case GL_LUMINANCE32F_EXT:
+    case GL_LUMINANCE_ALPHA32F_EXT:
+        *format = GlInternalFormatToGlFormat(internalformat);
+        *type   = GlInternalFormatToGlType(internalformat);
+        return true;
+    default:                        return false;
+    }
+}
+
+void
+Context::TexStorage2DEXT(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(target != GL_TEXTURE_2D && target != GL_TEXTURE_CUBE_MAP) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(levels < 1 || width < 1 || height < 1 ||
+       ((width > GLOVE_MAX_TEXTURE_SIZE || height > GLOVE_MAX_TEXTURE_SIZE) && target == GL_TEXTURE_2D) ||
+       ((width > GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE || height > GLOVE_MAX_CUBE_MAP_TEXTURE_SIZE) && target != GL_TEXTURE_2D) ||
+       (target == GL_TEXTURE_CUBE_MAP && width != height)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(levels > NUMBER_OF_MIP_LEVELS(width, height)) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // compressed storage is only given to the formats the device samples natively, the decoded ones keep a host copy
+    GLenum format, type;
+    const bool compressed = GlFormatIsCompressed(internalformat);
+    if(compressed) {
+        if(!IsCompressedTextureFormatNative(internalformat)) {
+            RecordError(GL_INVALID_ENUM);
+            return;
+        }
+        format = internalformat;
+        type   = GL_UNSIGNED_BYTE;
+    } else if(!TexStorageFormatToGlFormatType(internalformat, &format, &type)) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    Texture *activeTexture = mStateManager.GetActiveObjectsState()->GetActiveTexture(target);
+    if(!mResourceManager->GetTextureID(activeTexture) || activeTexture->IsImmutable()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(HasPendingCommands()) {
+        Finish();
+    }
+
+    const VkFormat vkformat = compressed ? GlCompressedFormatToVkFormat(internalformat) :
+                                           activeTexture->FindSupportedVkColorFormat(GlColorFormatToVkColorFormat(format, type));
+    if(!activeTexture->AllocateStorage(levels, width, height, format, type, vkformat)) {
+        RecordError(GL_OUT_OF_MEMORY);
+        return;
+    }
 
-    NOT_IMPLEMENTED();
+    mStateManager.GetActiveShaderProgram()->EnableUpdateOfDescriptorSets();
 }
@@ -0,0 +1,240 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       contextTransformFeedback.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      OpenGL ES API calls related to Transform Feedback (GL_GLOVE_transform_feedback)
+ *
+ *  @section
+ *
+ *  The user defined outputs of the vertex shader that a program names are
+ *  given xfb offsets and strides when it is linked, and each draw issued
+ *  while capturing binds the buffers at the offsets the previous ones have
+ *  left them and captures what it draws with VK_EXT_transform_feedback.
+ *  Beginning and ending the capture split the render pass of the framebuffer,
+ *  as a dispatch does, so that the buffers are not written while earlier
+ *  commands read them, and what was written is seen by every later use.
+ *
+ */
+
+#include "context.h"
+
+void
+Context::TransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mVkContext->mIsTransformFeedbackSupported) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    ShaderProgram *progPtr = GetProgramPtr(program);
+    if(!progPtr) {
+        return;
+    }
+
+    if(bufferMode != GL_INTERLEAVED_ATTRIBS && bufferMode != GL_SEPARATE_ATTRIBS) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    if(count < 0 || (bufferMode == GL_SEPARATE_ATTRIBS && count > GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS)) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    // the names take effect with the next link
+    std::vector<std::string> names;
+    for(GLsizei i = 0; i < count; ++i) {
+        names.push_back(varyings[i] ? varyings[i] : "");
+    }
+    progPtr->SetTransformFeedbackVaryings(names, bufferMode);
+}
+
+void
+Context::BeginTransformFeedback(GLenum primitiveMode)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mVkContext->mIsTransformFeedbackSupported) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    if(primitiveMode != GL_POINTS && primitiveMode != GL_LINES && primitiveMode != GL_TRIANGLES) {
+        RecordError(GL_INVALID_ENUM);
+        return;
+    }
+
+    // what is captured into a bundle executes in render passes of its own
+    ShaderProgram *program = mStateManager.GetActiveShaderProgram();
+    if(mTransformFeedback.active || mCommandBundle || !program || !program->IsLinked() || !program->HasTransformFeedback()) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // every buffer the program writes to has to be bound, to a range within it
+    StateActiveObjects *activeObjects = mStateManager.GetActiveObjectsState();
+    const uint32_t bufferCount = program->GetTransformFeedbackBufferCount();
+    for(uint32_t i = 0; i < bufferCount; ++i) {
+        const BufferObject *bo = activeObjects->GetTransformFeedbackBuffer(i);
+        const size_t offset = static_cast<size_t>(activeObjects->GetTransformFeedbackOffset(i));
+        const size_t size   = static_cast<size_t>(activeObjects->GetTransformFeedbackSize(i));
+        if(!bo || !bo->HasData() || bo->IsMapped() || offset >= bo->GetSize() || offset + size > bo->GetSize()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+    }
+
+    mTransformFeedback.active        = true;
+    mTransformFeedback.primitiveMode = primitiveMode;
+    mTransformFeedback.bufferCount   = bufferCount;
+    for(uint32_t i = 0; i < bufferCount; ++i) {
+        BufferObject *bo = activeObjects->GetTransformFeedbackBuffer(i);
+        const VkDeviceSize offset = static_cast<VkDeviceSize>(activeObjects->GetTransformFeedbackOffset(i));
+        const VkDeviceSize size   = static_cast<VkDeviceSize>(activeObjects->GetTransformFeedbackSize(i));
+        mTransformFeedback.buffers[i] = bo;
+        mTransformFeedback.offsets[i] = offset;
+        mTransformFeedback.ends[i]    = size ? offset + size : static_cast<VkDeviceSize>(bo->GetSize());
+        mTransformFeedback.strides[i] = program->GetTransformFeedbackStride(i);
+    }
+
+    // the captured draws do not overwrite what earlier commands are still reading
+    SplitRenderPassForTransformFeedback(true);
+}
+
+void
+Context::EndTransformFeedback(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mTransformFeedback.active) {
+        RecordError(GL_INVALID_OPERATION);
+        return;
+    }
+
+    // and what they have written is seen by whatever reads it next
+    SplitRenderPassForTransformFeedback(false);
+
+    // the buffers are referred to by the frame, and their host copies lag behind the ones written
+    for(uint32_t i = 0; i < mTransformFeedback.bufferCount; ++i) {
+        mTransformFeedback.buffers[i]->SetDeviceWritten();
+        mTransformFeedback.buffers[i] = nullptr;
+    }
+    mTransformFeedback.bufferCount = 0;
+    mTransformFeedback.active      = false;
+}
+
+void
+Context::SplitRenderPassForTransformFeedback(bool incoming)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    FlushDrawBatch();
+    ResolvePendingClear();
+    if(mWriteFBO->IsInIdleState()) {
+        AcquireDrawCommandBuffer();
+    } else {
+        mWriteFBO->EndVkRenderPass();
+    }
+
+#ifdef VK_EXT_transform_feedback
+    // the buffers are read and written at any of these stages, by draws, dispatches and copies
+    const VkPipelineStageFlags bufferStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT   |
+                                              VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    VkMemoryBarrier barrier;
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+
+    VkCommandBuffer activeCmdBuffer = mCommandBufferManager->GetActiveCommandBuffer();
+    if(incoming) {
+        // uploads into the buffers land before they are written on top of
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT;
+        vkCmdPipelineBarrier(activeCmdBuffer, bufferStages, VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    } else {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(activeCmdBuffer, VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, bufferStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+#endif // VK_EXT_transform_feedback
+
+    // rendering resumes on the same attachments
+    mWriteFBO->SetStateDraw();
+    SetClearRect();
+    mWriteFBO->ResetDiscardedAttachments();
+    BeginRendering(false, false, false);
+}
+
+bool
+Context::PrepareTransformFeedbackGeometry(uint32_t vertCount, uint32_t instanceCount, uint32_t *capturedCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the primitives drawn are those captured, and only whole ones are
+    const GLenum mode = mStateManager.GetInputAssemblyState()->GetPrimitiveMode();
+    if(mode != mTransformFeedback.primitiveMode) {
+        RecordError(GL_INVALID_OPERATION);
+        return false;
+    }
+
+    const uint32_t verticesPerPrimitive = mode == GL_TRIANGLES ? 3 : mode == GL_LINES ? 2 : 1;
+    *capturedCount = (vertCount / verticesPerPrimitive) * verticesPerPrimitive * instanceCount;
+
+    // a draw that would write past the end of any of the buffers is not issued
+    for(uint32_t i = 0; i < mTransformFeedback.bufferCount; ++i) {
+        const VkDeviceSize size = static_cast<VkDeviceSize>(*capturedCount) * mTransformFeedback.strides[i];
+        if(mTransformFeedback.offsets[i] + size > mTransformFeedback.ends[i]) {
+            RecordError(GL_INVALID_OPERATION);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+Context::DrawTransformFeedbackGeometry(VkCommandBuffer *CmdBuffer, uint32_t vertCount, uint32_t instanceCount, uint32_t capturedCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_EXT_transform_feedback
+    // without counter buffers, each capture starts writing at the offsets it binds
+    VkBuffer     buffers[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+    VkDeviceSize sizes[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+    for(uint32_t i = 0; i < mTransformFeedback.bufferCount; ++i) {
+        buffers[i] = mTransformFeedback.buffers[i]->GetVkBuffer();
+        sizes[i]   = mTransformFeedback.ends[i] - mTransformFeedback.offsets[i];
+    }
+
+    mVkContext->fpCmdBindTransformFeedbackBuffersEXT(*CmdBuffer, 0, mTransformFeedback.bufferCount, buffers, mTransformFeedback.offsets, sizes);
+    mVkContext->fpCmdBeginTransformFeedbackEXT(*CmdBuffer, 0, 0, nullptr, nullptr);
+    vkCmdDraw(*CmdBuffer, vertCount, instanceCount, 0, 0);
+    mVkContext->fpCmdEndTransformFeedbackEXT(*CmdBuffer, 0, 0, nullptr, nullptr);
+#else
+    vkCmdDraw(*CmdBuffer, vertCount, instanceCount, 0, 0);
+#endif // VK_EXT_transform_feedback
+
+    for(uint32_t i = 0; i < mTransformFeedback.bufferCount; ++i) {
+        mTransformFeedback.offsets[i] += static_cast<VkDeviceSize>(capturedCount) * mTransformFeedback.strides[i];
+    }
+}
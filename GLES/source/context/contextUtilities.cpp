@@ -22,6 +22,8 @@
  */
 
 #include "context.h"
+#include "vulkan/capabilityCache.h"
+#include "vulkan/utils.h"
 
 GLenum
 Context::GetError(void)
@@ -35,6 +37,109 @@ Context::GetError(void)
     return result;
 }
 
+const char *
+Context::GetExtensionsString(const char *baseExtensions)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the compressed texture extensions depend on the device, so they are appended once it is known
+    static std::string extensions;
+    if(!extensions.empty()) {
+        return extensions.c_str();
+    }
+
+    extensions = baseExtensions;
+
+    if(IsCompressedTextureFormatSupported(GL_ETC1_RGB8_OES)) {
+        extensions += " GL_OES_compressed_ETC1_RGB8_texture GL_OES_compressed_ETC1_RGB8_sub_texture";
+    }
+
+    if(IsCompressedTextureFormatSupported(GL_COMPRESSED_RGB_S3TC_DXT1_EXT) &&
+       IsCompressedTextureFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)) {
+        extensions += " GL_EXT_texture_compression_dxt1";
+
+        if(IsCompressedTextureFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT) &&
+           IsCompressedTextureFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)) {
+            extensions += " GL_EXT_texture_compression_s3tc";
+        }
+    }
+
+    if(IsCompressedTextureFormatNative(GL_COMPRESSED_SRGB_S3TC_DXT1_EXT)       &&
+       IsCompressedTextureFormatNative(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT) &&
+       IsCompressedTextureFormatNative(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT) &&
+       IsCompressedTextureFormatNative(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT)) {
+        extensions += " GL_EXT_texture_compression_s3tc_srgb";
+    }
+
+    if(IsCompressedTextureFormatNative(GL_COMPRESSED_RED_RGTC1_EXT)              &&
+       IsCompressedTextureFormatNative(GL_COMPRESSED_SIGNED_RED_RGTC1_EXT)       &&
+       IsCompressedTextureFormatNative(GL_COMPRESSED_RED_GREEN_RGTC2_EXT)        &&
+       IsCompressedTextureFormatNative(GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT)) {
+        extensions += " GL_EXT_texture_compression_rgtc";
+    }
+
+    bool astcSupported = true;
+    for(GLenum format = GL_COMPRESSED_RGBA_ASTC_4x4_KHR; format <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR; ++format) {
+        astcSupported = astcSupported && IsCompressedTextureFormatNative(format);
+    }
+    for(GLenum format = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR; format <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR; ++format) {
+        astcSupported = astcSupported && IsCompressedTextureFormatNative(format);
+    }
+    if(astcSupported) {
+        extensions += " GL_KHR_texture_compression_astc_ldr";
+    }
+
+    // float textures are stored in images of their own precision, so they depend on what the device samples and renders
+    const VkFormatFeatureFlags halfFeatures  = mVkContext->capabilityCache->GetFormatProperties(VK_FORMAT_R16G16B16A16_SFLOAT).optimalTilingFeatures;
+    const VkFormatFeatureFlags floatFeatures = mVkContext->capabilityCache->GetFormatProperties(VK_FORMAT_R32G32B32A32_SFLOAT).optimalTilingFeatures;
+    if(halfFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) {
+        extensions += " GL_OES_texture_half_float";
+
+        if(halfFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) {
+            extensions += " GL_OES_texture_half_float_linear";
+        }
+        if(halfFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT) {
+            extensions += " GL_EXT_color_buffer_half_float";
+        }
+    }
+    if(floatFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) {
+        extensions += " GL_OES_texture_float";
+
+        if(floatFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) {
+            extensions += " GL_OES_texture_float_linear";
+        }
+    }
+
+    // depth textures are sampled from the image they were rendered to, which is only upright with the maintenance extension
+    if(mVkContext->mIsMaintenanceExtSupported &&
+       FindSupportedDepthStencilFormat(mVkContext->capabilityCache, 16, 0,
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != VK_FORMAT_UNDEFINED) {
+        extensions += " GL_OES_depth_texture GL_EXT_shadow_samplers";
+    }
+
+    // EGLImages are only created from client buffers whose memory the device can import
+    if(mVkContext->mIsExternalMemoryDmaBufSupported || mVkContext->mIsAndroidHardwareBufferSupported) {
+        extensions += " GL_OES_EGL_image";
+    }
+
+    // elapsed times and timestamps come from the timestamp queries of the graphics queue
+    if(mVkContext->vkTimestampValidBits) {
+        extensions += " GL_EXT_disjoint_timer_query";
+    }
+
+    // vertex outputs are only captured by devices that write them out while drawing
+    if(mVkContext->mIsTransformFeedbackSupported) {
+        extensions += " GL_GLOVE_transform_feedback";
+    }
+
+    // the views of a framebuffer are drawn by a single multiview render pass
+    if(mVkContext->mIsMultiviewSupported) {
+        extensions += " GL_OVR_multiview GL_OVR_multiview2";
+    }
+
+    return extensions.c_str();
+}
+
 const GLubyte*
 Context::GetString(GLenum name)
 {
@@ -44,13 +149,13 @@ Context::GetString(GLenum name)
                                   "OpenGL ES 2.0 Over Vulkan\0",
                                   "OpenGL ES 2.0\0",
                                   "OpenGL ES GLSL ES 1.00\0",
-                                  "GL_OES_get_program_binary GL_OES_rgb8_rgba8 GL_OES_depth24 GL_OES_depth32 GL_OES_stencil4 GL_OES_texture_stencil8 GL_OES_required_internalformat GL_OES_packed_depth_stencil GL_APPLE_texture_format_BGRA8888\0"};
+                                  "GL_OES_get_program_binary GL_OES_rgb8_rgba8 GL_OES_element_index_uint GL_OES_vertex_half_float GL_OES_vertex_type_10_10_10_2 GL_OES_depth24 GL_OES_depth32 GL_OES_stencil4 GL_OES_texture_stencil8 GL_OES_required_internalformat GL_OES_packed_depth_stencil GL_APPLE_texture_format_BGRA8888 GL_EXT_draw_instanced GL_EXT_instanced_arrays GL_EXT_multi_draw_arrays GL_EXT_multi_draw_indirect GL_EXT_discard_framebuffer GL_EXT_texture_storage GL_EXT_multisampled_render_to_texture GL_EXT_shader_framebuffer_fetch GL_ANGLE_framebuffer_blit GL_NV_framebuffer_blit GL_NV_pixel_buffer_object GL_OES_mapbuffer GL_EXT_map_buffer_range GL_KHR_parallel_shader_compile GL_AMD_performance_monitor GL_EXT_debug_marker GL_EXT_occlusion_query_boolean GL_KHR_no_error GL_OES_vertex_array_object GL_GLOVE_transient_texture GL_GLOVE_command_bundle GL_GLOVE_compute_shader GL_GLOVE_primitive_restart GL_GLOVE_uniform_buffer_object\0"};
     switch(name) {
     case GL_VENDOR:                     return (const GLubyte *)strings[0];
     case GL_RENDERER:                   return (const GLubyte *)strings[1];
     case GL_VERSION:                    return (const GLubyte *)strings[2];
     case GL_SHADING_LANGUAGE_VERSION:   return (const GLubyte *)strings[3];
-    case GL_EXTENSIONS:                 return (const GLubyte *)strings[4];
+    case GL_EXTENSIONS:                 return (const GLubyte *)GetExtensionsString(strings[4]);
     default:                            RecordError(GL_INVALID_ENUM); return nullptr; 
     }
 }
@@ -33,7 +33,7 @@ Context::GetVertexAttribfv(GLuint index, GLenum pname, GLfloat* params)
         return;
     }
 
-    const GenericVertexAttribute* gVertexAttrib = mResourceManager->GetGenericVertexAttribute(index);
+    const GenericVertexAttribute* gVertexAttrib = &mVertexArray->GetAttribute(index);
 
     switch(pname) {
     case GL_VERTEX_ATTRIB_ARRAY_ENABLED:        *params = static_cast<GLfloat>(gVertexAttrib->IsEnabled());     break;
@@ -41,6 +41,7 @@ Context::GetVertexAttribfv(GLuint index, GLenum pname, GLfloat* params)
     case GL_VERTEX_ATTRIB_ARRAY_STRIDE:         *params = static_cast<GLfloat>(gVertexAttrib->GetStride());      break;
     case GL_VERTEX_ATTRIB_ARRAY_TYPE:           *params = static_cast<GLfloat>(gVertexAttrib->GetType());        break;
     case GL_VERTEX_ATTRIB_ARRAY_NORMALIZED:     *params = static_cast<GLfloat>(gVertexAttrib->GetNormalized());  break;
+    case GL_VERTEX_ATTRIB_ARRAY_DIVISOR_EXT:    *params = static_cast<GLfloat>(gVertexAttrib->GetDivisor());     break;
     case GL_CURRENT_VERTEX_ATTRIB:              gVertexAttrib->GetGenericValue(params);                          break;
     case GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING: { const BufferObject *vbo = gVertexAttrib->GetExternalVbo();
                                                   *params = vbo ? static_cast<GLfloat>(mResourceManager->GetBufferID(vbo)) : 0.0f;
@@ -60,7 +61,7 @@ Context::GetVertexAttribiv(GLuint index, GLenum pname, GLint* params)
         return;
     }
 
-    const GenericVertexAttribute* gVertexAttrib = mResourceManager->GetGenericVertexAttribute(index);
+    const GenericVertexAttribute* gVertexAttrib = &mVertexArray->GetAttribute(index);
 
     switch(pname) {
     case GL_VERTEX_ATTRIB_ARRAY_ENABLED:        *params = static_cast<GLint>(gVertexAttrib->IsEnabled());          break;
@@ -68,6 +69,7 @@ Context::GetVertexAttribiv(GLuint index, GLenum pname, GLint* params)
     case GL_VERTEX_ATTRIB_ARRAY_STRIDE:         *params = static_cast<GLint>(gVertexAttrib->GetStride());           break;
     case GL_VERTEX_ATTRIB_ARRAY_TYPE:           *params = static_cast<GLint>(gVertexAttrib->GetType());             break;
     case GL_VERTEX_ATTRIB_ARRAY_NORMALIZED:     *params = static_cast<GLint>(gVertexAttrib->GetNormalized());       break;
+    case GL_VERTEX_ATTRIB_ARRAY_DIVISOR_EXT:    *params = static_cast<GLint>(gVertexAttrib->GetDivisor());          break;
     case GL_CURRENT_VERTEX_ATTRIB:              gVertexAttrib->GetGenericValue(params); break;
     case GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING: { const BufferObject *vbo = gVertexAttrib->GetExternalVbo();
                                                   *params = vbo ? static_cast<GLint>(mResourceManager->GetBufferID(vbo)) : 0;
@@ -92,7 +94,7 @@ Context::GetVertexAttribPointerv(GLuint index, GLenum pname, void **pointer)
         return;
     }
 
-    *pointer = reinterpret_cast<void *>(mResourceManager->GetGenericVertexAttribute(index)->GetPointer());
+    *pointer = reinterpret_cast<void *>(mVertexArray->GetAttribute(index).GetPointer());
 }
 
 void
@@ -106,8 +108,7 @@ Context::VertexAttrib1f(GLuint index, GLfloat x)
     }
 
     GLfloat vals[4] = {x, 0.0f, 0.0f, 1.0f};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -121,8 +122,7 @@ Context::VertexAttrib1fv(GLuint index, const GLfloat* values)
     }
 
     GLfloat vals[4] = {values[0], 0.0f, 0.0f, 1.0f};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -136,8 +136,7 @@ Context::VertexAttrib2f(GLuint index, GLfloat x, GLfloat y)
     }
 
     GLfloat vals[4] = {x, y, 0.0f, 1.0f};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -151,8 +150,7 @@ Context::VertexAttrib2fv(GLuint index, const GLfloat* values)
     }
 
     GLfloat vals[4] = {values[0], values[1], 0.0f, 1.0f};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -166,8 +164,7 @@ Context::VertexAttrib3f(GLuint index, GLfloat x, GLfloat y, GLfloat z)
     }
 
     GLfloat vals[4] = {x, y, z, 1.0f};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -181,8 +178,7 @@ Context::VertexAttrib3fv(GLuint index, const GLfloat* values)
     }
 
     GLfloat vals[4] = {values[0], values[1], values[2], 1.0f};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -196,8 +192,7 @@ Context::VertexAttrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w
     }
 
     GLfloat vals[4] = {x, y, z, w};
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(vals);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(vals);
 }
 
 void
@@ -210,8 +205,7 @@ Context::VertexAttrib4fv(GLuint index, const GLfloat* values)
         return;
     }
 
-    mResourceManager->GetGenericVertexAttribute(index)->SetGenericValue(values);
-    mPipeline->SetUpdateVertexAttribVBOs(true);
+    mVertexArray->GetAttribute(index).SetGenericValue(values);
 }
 
 void
@@ -219,15 +213,16 @@ Context::EnableVertexAttribArray(GLuint index)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(index >= GLOVE_MAX_VERTEX_ATTRIBS) {
+    if(!mNoError && index >= GLOVE_MAX_VERTEX_ATTRIBS) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    GenericVertexAttribute *gVertexAttrib = mResourceManager->GetGenericVertexAttribute(index);
+    GenericVertexAttribute *gVertexAttrib = &mVertexArray->GetAttribute(index);
 
     if(!gVertexAttrib->IsEnabled()) {
         gVertexAttrib->SetEnabled(true);
+        mVertexArray->InvalidateLayout();
         mPipeline->SetUpdateVertexAttribVBOs(true);
     }
 }
@@ -237,15 +232,16 @@ Context::DisableVertexAttribArray(GLuint index)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(index >= GLOVE_MAX_VERTEX_ATTRIBS) {
+    if(!mNoError && index >= GLOVE_MAX_VERTEX_ATTRIBS) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
-    GenericVertexAttribute *gVertexAttrib = mResourceManager->GetGenericVertexAttribute(index);
+    GenericVertexAttribute *gVertexAttrib = &mVertexArray->GetAttribute(index);
 
     if(gVertexAttrib->IsEnabled()) {
         gVertexAttrib->SetEnabled(false);
+        mVertexArray->InvalidateLayout();
         mPipeline->SetUpdateVertexAttribVBOs(true);
     }
 }
@@ -255,18 +251,146 @@ Context::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean no
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(type != GL_BYTE && type != GL_UNSIGNED_BYTE && type != GL_SHORT && type != GL_UNSIGNED_SHORT && type != GL_FIXED && type != GL_FLOAT) {
+    // see GL_OES_vertex_half_float and GL_OES_vertex_type_10_10_10_2
+    const bool packed = type == GL_UNSIGNED_INT_10_10_10_2_OES || type == GL_INT_10_10_10_2_OES;
+    if(!mNoError && type != GL_BYTE && type != GL_UNSIGNED_BYTE && type != GL_SHORT && type != GL_UNSIGNED_SHORT && type != GL_FIXED && type != GL_FLOAT &&
+       type != GL_HALF_FLOAT_OES && !packed) {
         RecordError(GL_INVALID_ENUM);
         return;
     }
 
-    if((size < 1 || size > 4) || (stride < 0) || (index >= GLOVE_MAX_VERTEX_ATTRIBS)) {
+    if(!mNoError && ((size < 1 || size > 4) || (packed && size < 3) || (stride < 0) || (index >= GLOVE_MAX_VERTEX_ATTRIBS))) {
         RecordError(GL_INVALID_VALUE);
         return;
     }
 
     BufferObject* attachedVBO = mStateManager.GetActiveObjectsState()->GetActiveBufferObject(GL_ARRAY_BUFFER);
     bool requiresInternalVBO = attachedVBO == nullptr;
-    mResourceManager->GetGenericVertexAttribute(index)->Set(size, type, normalized, stride, ptr, attachedVBO, requiresInternalVBO);
+    mVertexArray->GetAttribute(index).Set(size, type, normalized, stride, ptr, attachedVBO, requiresInternalVBO);
+    mVertexArray->InvalidateLayout();
     mPipeline->SetUpdateVertexAttribVBOs(true);
 }
+
+void
+Context::VertexAttribDivisorEXT(GLuint index, GLuint divisor)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mNoError && index >= GLOVE_MAX_VERTEX_ATTRIBS) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    GenericVertexAttribute *gVertexAttrib = &mVertexArray->GetAttribute(index);
+
+    if(gVertexAttrib->GetDivisor() != divisor) {
+        gVertexAttrib->SetDivisor(divisor);
+        mVertexArray->InvalidateLayout();
+        mPipeline->SetUpdateVertexAttribVBOs(true);
+    }
+}
+
+void
+Context::GenVertexArraysOES(GLsizei n, GLuint *arrays)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(arrays == nullptr) {
+        return;
+    }
+
+    // the names are reserved, the objects are created by their first bind
+    for(GLsizei i = 0; i < n; ++i) {
+        arrays[i] = mNextVertexArrayId++;
+        mVertexArrays[arrays[i]] = nullptr;
+    }
+}
+
+void
+Context::DeleteVertexArraysOES(GLsizei n, const GLuint *arrays)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(n < 0) {
+        RecordError(GL_INVALID_VALUE);
+        return;
+    }
+
+    if(arrays == nullptr) {
+        return;
+    }
+
+    for(GLsizei i = 0; i < n; ++i) {
+        auto it = mVertexArrays.find(arrays[i]);
+        if(arrays[i] == 0 || it == mVertexArrays.end()) {
+            continue;
+        }
+
+        // deleting the bound vertex array binds the default one
+        VertexArray *vertexArray = it->second;
+        if(vertexArray != nullptr && vertexArray == mVertexArray) {
+            BindVertexArrayOES(0);
+        }
+
+        // the element array buffer is released along with the vertex array holding it
+        if(vertexArray != nullptr) {
+            if(vertexArray->GetElementArrayBuffer()) {
+                vertexArray->GetElementArrayBuffer()->Unbind();
+            }
+            delete vertexArray;
+        }
+        mVertexArrays.erase(it);
+    }
+    mResourceManager->CleanPurgeList();
+}
+
+GLboolean
+Context::IsVertexArrayOES(GLuint array)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mVertexArrays.find(array);
+    return (it != mVertexArrays.end() && it->second != nullptr) ? GL_TRUE : GL_FALSE;
+}
+
+void
+Context::BindVertexArrayOES(GLuint array)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VertexArray *vertexArray = mDefaultVertexArray;
+    if(array) {
+        auto it = mVertexArrays.find(array);
+        if(it == mVertexArrays.end()) {
+            RecordError(GL_INVALID_OPERATION);
+            return;
+        }
+
+        if(it->second == nullptr) {
+            it->second = new VertexArray(mVkContext, mCacheManager);
+        }
+        vertexArray = it->second;
+    }
+
+    if(vertexArray == mVertexArray) {
+        return;
+    }
+
+    // The element array buffer binding is part of the vertex array, which keeps the reference of
+    // the bound buffer while another one is bound. The attribute layouts programs have built from
+    // the arrays are told apart by their serials, so a bind needs no update of the pipeline.
+    StateActiveObjects *activeObjects = mStateManager.GetActiveObjectsState();
+    mVertexArray->SetElementArrayBuffer(activeObjects->GetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER));
+    activeObjects->SetActiveBufferObject(GL_ELEMENT_ARRAY_BUFFER, vertexArray->GetElementArrayBuffer());
+    vertexArray->SetElementArrayBuffer(nullptr);
+    vertexArray->CopyGenericValues(mVertexArray);
+
+    mVertexArray   = vertexArray;
+    mVertexArrayId = array;
+    mPipeline->SetUpdateIndexBuffer(true);
+}
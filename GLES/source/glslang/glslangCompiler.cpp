@@ -139,6 +139,18 @@ GlslangCompiler::Release()
     mShaderMap.clear();
 }
 
+void
+GlslangCompiler::ReleaseShader(ESSL_VERSION version)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mShaderMap.find(version);
+    if(it != mShaderMap.end()) {
+        SafeDelete(it->second);
+        mShaderMap.erase(it);
+    }
+}
+
 bool
 GlslangCompiler::IsManageableError(const char* errors)
 {
@@ -53,6 +53,9 @@ public:
 
     /// Compile Functions
     bool                 CompileShader(const char* const* source, const TBuiltInResource* resources, EShLanguage language, ESSL_VERSION version);
+
+    /// Release Functions
+    void                 ReleaseShader(ESSL_VERSION version);
     
     /// Get Functions
     glslang::TShader    *GetShader(ESSL_VERSION version);
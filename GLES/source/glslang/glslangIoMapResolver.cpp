@@ -22,8 +22,10 @@
  */
 
 #include "glslangIoMapResolver.h"
+#include "utils/globals.h"
 
 GlslangIoMapResolver::GlslangIoMapResolver()
+: mOtherBindings(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -42,6 +44,57 @@ GlslangIoMapResolver::Release(void)
 
     mVaryingINMap.clear();
     mVaryingOUTMap.clear();
+    mStorageBlocks.clear();
+    mUniformBlocks.clear();
+    mOtherBindings = 0;
+
+    // the captured varyings are given by the program, only what was found of them is gathered again
+    for(auto &varying : mXfbVaryings) {
+        varying.components = -1;
+        varying.buffer     = -1;
+        varying.offset     = -1;
+    }
+}
+
+void
+GlslangIoMapResolver::notifyBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!is_live || type.getQualifier().layoutPushConstant) {
+        return;
+    }
+
+    if(type.getQualifier().storage == glslang::EvqBuffer && type.getBasicType() == glslang::EbtBlock) {
+        StorageBlockInfo block;
+        block.name     = type.getTypeName().c_str();
+        block.binding  = type.getQualifier().hasBinding() ? static_cast<int>(type.getQualifier().layoutBinding) : 0;
+        block.readOnly = type.getQualifier().readonly;
+        mStorageBlocks.push_back(block);
+    } else if(stage == EShLangCompute && type.getQualifier().storage == glslang::EvqUniform && type.getBasicType() == glslang::EbtBlock) {
+        StorageBlockInfo block;
+        block.name     = type.getTypeName().c_str();
+        block.binding  = type.getQualifier().hasBinding() ? static_cast<int>(type.getQualifier().layoutBinding) : 0;
+        block.readOnly = true;
+        mUniformBlocks.push_back(block);
+    } else {
+        ++mOtherBindings;
+    }
+}
+
+int
+GlslangIoMapResolver::resolveBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // GL numbers the bindings of uniform blocks apart from those of storage blocks, so the uniform blocks of
+    // compute shaders are moved past the storage ones in the descriptor set. the other blocks keep theirs
+    if(stage != EShLangCompute || type.getQualifier().layoutPushConstant ||
+       type.getQualifier().storage != glslang::EvqUniform || type.getBasicType() != glslang::EbtBlock) {
+        return -1;
+    }
+
+    return GLOVE_UNIFORM_BUFFER_FIRST_VK_BINDING + (type.getQualifier().hasBinding() ? static_cast<int>(type.getQualifier().layoutBinding) : 0);
 }
 
 void
@@ -99,6 +152,92 @@ GlslangIoMapResolver::CreateVaryingLocationMap(std::map<std::string, std::pair<i
             }
         }
     }
+
+    // outputs the fragment shader does not read stay outputs when transform feedback captures them
+    for(uint32_t out = 0; out < GetVaryingOutNum(); ++out) {
+        const char *outName = GetVaryingOutName(out);
+        if(FindTransformFeedbackVarying(outName) >= 0 && location_map->find(string(outName)) == location_map->end()) {
+            (*location_map)[std::string(outName)] = std::make_pair(location, true);
+            location += GetVaryingOutMatrixCols(out);
+        }
+    }
+}
+
+void
+GlslangIoMapResolver::SetTransformFeedbackVaryings(const std::vector<std::string> &varyings)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mXfbVaryings.clear();
+    for(const auto &name : varyings) {
+        XfbVaryingInfo varying;
+        varying.name       = name;
+        varying.components = -1;
+        varying.buffer     = -1;
+        varying.offset     = -1;
+        mXfbVaryings.push_back(varying);
+    }
+}
+
+int
+GlslangIoMapResolver::FindTransformFeedbackVarying(const char *name) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(size_t i = 0; i < mXfbVaryings.size(); ++i) {
+        if(mXfbVaryings[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+bool
+GlslangIoMapResolver::AssignTransformFeedbackLayout(bool separate, uint32_t *strides, std::string *infoLog)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // interleaved varyings follow each other in the first buffer, separate ones start a buffer each.
+    // every component captured is 32 bits wide
+    int components = 0;
+    for(size_t i = 0; i < mXfbVaryings.size(); ++i) {
+        XfbVaryingInfo &varying = mXfbVaryings[i];
+
+        if(varying.components < 0) {
+            *infoLog = "ERROR: Transform feedback varying " + varying.name + " is not a user defined output of the vertex shader\n";
+            return false;
+        }
+
+        if(static_cast<size_t>(FindTransformFeedbackVarying(varying.name.c_str())) != i) {
+            *infoLog = "ERROR: Transform feedback varying " + varying.name + " is given more than once\n";
+            return false;
+        }
+
+        if(separate) {
+            if(varying.components > GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS) {
+                *infoLog = "ERROR: Transform feedback varying " + varying.name + " has too many components\n";
+                return false;
+            }
+            varying.buffer = static_cast<int>(i);
+            varying.offset = 0;
+            strides[i]     = static_cast<uint32_t>(varying.components) * sizeof(uint32_t);
+        } else {
+            varying.buffer = 0;
+            varying.offset = components * static_cast<int>(sizeof(uint32_t));
+        }
+        components += varying.components;
+    }
+
+    if(!separate) {
+        if(components > GLOVE_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS) {
+            *infoLog = "ERROR: Too many interleaved transform feedback components\n";
+            return false;
+        }
+        strides[0] = static_cast<uint32_t>(components) * sizeof(uint32_t);
+    }
+
+    return true;
 }
 
 void
@@ -106,6 +245,14 @@ GlslangIoMapResolver::notifyInOut(EShLanguage stage, const char* name, const gls
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // captured outputs are written to their buffers whether the fragment shader reads them or not
+    if(stage == EShLangVertex && glslang::EvqVaryingOut == type.getQualifier().storage) {
+        const int index = FindTransformFeedbackVarying(name);
+        if(index >= 0) {
+            mXfbVaryings[index].components = type.computeNumComponents();
+        }
+    }
+
     // Do not store inactive varyings
     if(!is_live) {
         return;
@@ -39,8 +39,28 @@ private:
         int         matrixCols;
     } VaryingInfo;
 
+    /// live buffer and uniform blocks of a compute shader, at the bindings of their layout qualifiers
+    typedef struct StorageBlockInfo {
+        std::string name;
+        int         binding;
+        bool        readOnly;
+    } StorageBlockInfo;
+
+    /// outputs of the vertex shader captured by transform feedback, in the order they were given,
+    /// with their components once they are found and where they are written to once laid out
+    typedef struct XfbVaryingInfo {
+        std::string name;
+        int         components;
+        int         buffer;
+        int         offset;
+    } XfbVaryingInfo;
+
     std::vector<VaryingInfo>    mVaryingINMap;
     std::vector<VaryingInfo>    mVaryingOUTMap;
+    std::vector<StorageBlockInfo> mStorageBlocks;
+    std::vector<StorageBlockInfo> mUniformBlocks;
+    std::vector<XfbVaryingInfo> mXfbVaryings;
+    uint32_t                    mOtherBindings;
 
     void               FillInVaryingInfo(VaryingInfo *varyinginfo, const glslang::TType& type, const char *name);
 
@@ -50,14 +70,14 @@ public:
     ~GlslangIoMapResolver();
 
     bool               validateBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)           override { return true; }
-    int                resolveBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)            override { return -1;   }
+    int                resolveBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)            override;
     int                resolveSet(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)                override { return -1;   }
     int                resolveUniformLocation(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)    override { return -1;   }
     bool               validateInOut(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)             override { return true; }
     int                resolveInOutLocation(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)      override { return -1;   }
     int                resolveInOutComponent(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)     override { return -1;   }
     int                resolveInOutIndex(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)         override { return -1;   }
-    void               notifyBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)             override { }
+    void               notifyBinding(EShLanguage stage, const char* name, const glslang::TType& type, bool is_live)             override;
     void               endNotifications(EShLanguage stage)                                                                      override { }
     void               beginNotifications(EShLanguage stage)                                                                    override { }
     void               beginResolve(EShLanguage stage)                                                                          override { }
@@ -73,6 +93,11 @@ public:
 /// Create Functions
     void               CreateVaryingLocationMap(std::map<std::string, std::pair<int,bool>> *location_map);
 
+/// Transform Feedback Functions
+    void               SetTransformFeedbackVaryings(const std::vector<std::string> &varyings);
+    bool               AssignTransformFeedbackLayout(bool separate, uint32_t *strides, std::string *infoLog);
+    int                FindTransformFeedbackVarying(const char *name) const;
+
 /// Get Functions
     inline uint32_t    GetVaryingInNum(void)                        const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mVaryingINMap.size()); }
     inline const char *GetVaryingInName(uint32_t index)             const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingINMap.size() - 1) ? "" : mVaryingINMap[index].name;        }
@@ -83,12 +108,28 @@ public:
     inline int         GetVaryingInMatrixCols(uint32_t index)       const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingINMap.size() - 1) ? -1 : mVaryingINMap[index].vectorSize == 0 ?
                                                                                                                                                       mVaryingINMap[index].matrixCols : 1; }
 
+    inline uint32_t    GetStorageBlockNum(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mStorageBlocks.size()); }
+    inline const char *GetStorageBlockName(uint32_t index)          const { FUN_ENTRY(GL_LOG_TRACE); return mStorageBlocks[index].name.c_str(); }
+    inline int         GetStorageBlockBinding(uint32_t index)       const { FUN_ENTRY(GL_LOG_TRACE); return mStorageBlocks[index].binding;  }
+    inline bool        GetStorageBlockReadOnly(uint32_t index)      const { FUN_ENTRY(GL_LOG_TRACE); return mStorageBlocks[index].readOnly; }
+    inline uint32_t    GetUniformBlockNum(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mUniformBlocks.size()); }
+    inline const char *GetUniformBlockName(uint32_t index)          const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlocks[index].name.c_str(); }
+    inline int         GetUniformBlockBinding(uint32_t index)       const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlocks[index].binding;  }
+    /// descriptors other than buffer and uniform blocks, i.e., samplers and images
+    inline uint32_t    GetOtherBindingNum(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mOtherBindings; }
+
     inline uint32_t    GetVaryingOutNum(void)                       const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mVaryingOUTMap.size()); }
     inline const char *GetVaryingOutName(uint32_t index)            const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingOUTMap.size() - 1) ? "" : mVaryingOUTMap[index].name;        }
     inline const char *GetVaryingOutType(uint32_t index)            const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingOUTMap.size() - 1) ? "" : mVaryingOUTMap[index].type;        }
     inline int         GetVaryingOutLocation(uint32_t index)        const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingOUTMap.size() - 1) ? -1 : mVaryingOUTMap[index].location;    }
     inline int         GetVaryingOutHasLocation(uint32_t index)     const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingOUTMap.size() - 1) ? -1 : mVaryingOUTMap[index].hasLocation; }
     inline int         GetVaryingOutVectorSize(uint32_t index)      const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingOUTMap.size() - 1) ? -1 : mVaryingOUTMap[index].vectorSize;  }
+    inline int         GetVaryingOutMatrixCols(uint32_t index)      const { FUN_ENTRY(GL_LOG_TRACE); return (index > mVaryingOUTMap.size() - 1) ? -1 : mVaryingOUTMap[index].vectorSize == 0 ?
+                                                                                                                                                      mVaryingOUTMap[index].matrixCols : 1; }
+
+    inline size_t      GetTransformFeedbackVaryingNum(void)         const { FUN_ENTRY(GL_LOG_TRACE); return mXfbVaryings.size(); }
+    inline int         GetTransformFeedbackBuffer(uint32_t index)   const { FUN_ENTRY(GL_LOG_TRACE); return mXfbVaryings[index].buffer; }
+    inline int         GetTransformFeedbackOffset(uint32_t index)   const { FUN_ENTRY(GL_LOG_TRACE); return mXfbVaryings[index].offset; }
 };
 
 #endif // __GLSLANGIOMAPRESOLVER_H__
@@ -22,6 +22,37 @@
  */
 
 #include "glslangLinker.h"
+#include "utils/globals.h"
+
+#include "glslang/MachineIndependent/localintermediate.h"
+
+#if GLOVE_SPIRV_OPTIMIZATION_LEVEL > 0
+#include "spirv-tools/optimizer.hpp"
+#endif
+
+/// Gives the captured outputs of a vertex shader the xfb layout the resolver has assigned them,
+/// on every node that refers to them, as SPIR-V is generated from whichever is met first
+class XfbLayoutTraverser : public glslang::TIntermTraverser {
+private:
+    const GlslangIoMapResolver         *mIoMapResolver;
+
+public:
+    XfbLayoutTraverser(const GlslangIoMapResolver *ioMapResolver) : mIoMapResolver(ioMapResolver) { }
+
+    virtual void visitSymbol(glslang::TIntermSymbol *symbol)
+    {
+        glslang::TQualifier &qualifier = symbol->getWritableType().getQualifier();
+        if(qualifier.storage != glslang::EvqVaryingOut) {
+            return;
+        }
+
+        const int index = mIoMapResolver->FindTransformFeedbackVarying(symbol->getName().c_str());
+        if(index >= 0) {
+            qualifier.layoutXfbBuffer = mIoMapResolver->GetTransformFeedbackBuffer(index);
+            qualifier.layoutXfbOffset = mIoMapResolver->GetTransformFeedbackOffset(index);
+        }
+    }
+};
 
 GlslangLinker::GlslangLinker()
 {
@@ -66,7 +97,38 @@ GlslangLinker::GenerateSPV(std::vector<unsigned int>& spv, EShLanguage language,
 
     spv.clear();
     glslang::GlslangToSpv(*mProgramMap[version]->getIntermediate(language), spv);
+
+#if GLOVE_SPIRV_OPTIMIZATION_LEVEL > 0
+    OptimizeSPV(spv);
+#endif
+}
+
+#if GLOVE_SPIRV_OPTIMIZATION_LEVEL > 0
+void
+GlslangLinker::OptimizeSPV(std::vector<unsigned int>& spv)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_0);
+    optimizer.SetMessageConsumer([](spv_message_level_t level, const char *, const spv_position_t &position, const char *message) {
+        if(level <= SPV_MSG_ERROR) {
+            GLOVE_PRINT_ERR("SPIR-V optimizer (word %zu): %s\n", position.index, message);
+        }
+    });
+
+    if(GLOVE_SPIRV_OPTIMIZATION_LEVEL == 1) {
+        optimizer.RegisterSizePasses();
+    } else {
+        optimizer.RegisterPerformancePasses();
+    }
+
+    /// the module is kept as generated if any pass fails
+    std::vector<unsigned int> optimized;
+    if(optimizer.Run(spv.data(), spv.size(), &optimized)) {
+        spv.swap(optimized);
+    }
 }
+#endif
 
 bool
 GlslangLinker::LinkProgram(glslang::TShader* vertShader, glslang::TShader* fragShader, ESSL_VERSION version)
@@ -100,3 +162,28 @@ GlslangLinker::ValidateProgram(glslang::TShader* vertShader, glslang::TShader* f
 
     return true;
 }
+
+bool
+GlslangLinker::MapTransformFeedback(bool separate, ESSL_VERSION version, uint32_t *strides, std::string *infoLog)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the outputs are looked up in the linked program, as they end up declared once converted
+    mIoMapResolver.Release();
+    mProgramMap[version]->mapIO(&mIoMapResolver);
+    if(!mIoMapResolver.AssignTransformFeedbackLayout(separate, strides, infoLog)) {
+        return false;
+    }
+
+    glslang::TIntermediate *intermediate = mProgramMap[version]->getIntermediate(EShLangVertex);
+    XfbLayoutTraverser traverser(&mIoMapResolver);
+    intermediate->getTreeRoot()->traverse(&traverser);
+
+    intermediate->setXfbMode();
+    const uint32_t bufferCount = separate ? static_cast<uint32_t>(mIoMapResolver.GetTransformFeedbackVaryingNum()) : 1;
+    for(uint32_t i = 0; i < bufferCount; ++i) {
+        intermediate->setXfbBufferStride(static_cast<int>(i), strides[i]);
+    }
+
+    return true;
+}
@@ -48,8 +48,13 @@ public:
     bool                                LinkProgram    (glslang::TShader* vertShader, glslang::TShader* fragShader, ESSL_VERSION version);
     bool                                ValidateProgram(glslang::TShader* vertShader, glslang::TShader* fragShader, ESSL_VERSION version);
 
+// Transform Feedback Functions
+    inline void                         SetTransformFeedbackVaryings(const std::vector<std::string> &varyings) { FUN_ENTRY(GL_LOG_TRACE); mIoMapResolver.SetTransformFeedbackVaryings(varyings); }
+    bool                                MapTransformFeedback(bool separate, ESSL_VERSION version, uint32_t *strides, std::string *infoLog);
+
 // Generate Functions
     void                                GenerateSPV(std::vector<unsigned int>& spv, EShLanguage language, ESSL_VERSION version);
+    static void                         OptimizeSPV(std::vector<unsigned int>& spv);
 
 // Get Functions
     inline GlslangIoMapResolver        *GetIoMapResolver(void)                       { FUN_ENTRY(GL_LOG_TRACE); return &mIoMapResolver; }
@@ -21,6 +21,8 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <sstream>
 #include "glslang/Include/intermediate.h"
@@ -30,23 +32,27 @@
 #include "utils/glLogger.h"
 #include "utils/parser_helpers.h"
 
-bool             GlslangShaderCompiler::mInitialized = false;
+uint32_t         GlslangShaderCompiler::mInstances = 0;
+std::mutex       GlslangShaderCompiler::mInstancesMutex;
 TBuiltInResource GlslangShaderCompiler::mTBuiltInResource;
 
 GlslangShaderCompiler::GlslangShaderCompiler()
-: mProgramLinker(nullptr), mShaderConverter(nullptr), mShaderReflection(nullptr),
+: mInitialized(false), mProgramLinker(nullptr), mShaderConverter(nullptr), mShaderReflection(nullptr),
+  mComputeShader(nullptr), mComputeProgram(nullptr),
   mPrintConvertedShader(false), mPrintSpv(false),
-  mSaveBinaryToFiles(false), mSaveSourceToFiles(false), mSaveSpvTextToFile(false)
+  mSaveBinaryToFiles(false), mSaveSourceToFiles(false), mSaveSpvTextToFile(false), mBindlessTextures(false),
+  mTransformFeedbackSeparate(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    memset(static_cast<void *>(mTransformFeedbackStrides), 0, sizeof(mTransformFeedbackStrides));
+
     mShaderCompiler[SHADER_COMPILER_VERTEX]   = nullptr;
     mShaderCompiler[SHADER_COMPILER_FRAGMENT] = nullptr;
 
     mPrintReflection[ESSL_VERSION_100] = false;
     mPrintReflection[ESSL_VERSION_400] = false;
 
-    InitCompiler();
     InitReflection();
 }
 
@@ -54,8 +60,9 @@ GlslangShaderCompiler::~GlslangShaderCompiler()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    TerminateCompiler();
+    // the glslang objects go before glslang itself is torn down
     Release();
+    TerminateCompiler();
 }
 
 void
@@ -66,17 +73,54 @@ GlslangShaderCompiler::Release()
     SafeDelete(mShaderCompiler[SHADER_COMPILER_VERTEX]);
     SafeDelete(mShaderCompiler[SHADER_COMPILER_FRAGMENT]);
     SafeDelete(mProgramLinker);
+    SafeDelete(mComputeProgram);
+    SafeDelete(mComputeShader);
     SafeDelete(mShaderReflection);
 }
 
+ShaderCompiler *
+GlslangShaderCompiler::CreateCompiler(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the compilers of the jobs come and go, glslang stays up as long as the one they were created from
+    InitCompiler();
+
+    return new GlslangShaderCompiler();
+}
+
 void
-GlslangShaderCompiler::InitCompiler()
+GlslangShaderCompiler::ReleaseCompiler(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!mInitialized) {
-        mInitialized = glslang::InitializeProcess();
-        assert(mInitialized);
+    SafeDelete(mShaderCompiler[SHADER_COMPILER_VERTEX]);
+    SafeDelete(mShaderCompiler[SHADER_COMPILER_FRAGMENT]);
+    SafeDelete(mProgramLinker);
+    SafeDelete(mComputeProgram);
+    SafeDelete(mComputeShader);
+    mSourceMap.clear();
+    mComputeSource.clear();
+
+    TerminateCompiler();
+}
+
+void
+GlslangShaderCompiler::InitCompiler() const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mInitialized) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mInstancesMutex);
+
+    mInitialized = true;
+    if(mInstances++ == 0) {
+        bool initialized = glslang::InitializeProcess();
+        assert(initialized);
+        (void)initialized;
 
         InitCompilerResources();
     }
@@ -95,6 +139,14 @@ GlslangShaderCompiler::InitCompilerResources(void)
     mTBuiltInResource.maxTextureUnits               = GLOVE_MAX_TEXTURE_IMAGE_UNITS;
     mTBuiltInResource.maxCombinedTextureImageUnits  = GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS;
     mTBuiltInResource.maxDrawBuffers                = GLOVE_MAX_DRAW_BUFFERS;
+
+    // the minimum limits of Vulkan, for the internal kernels
+    mTBuiltInResource.maxComputeWorkGroupCountX     = 65535;
+    mTBuiltInResource.maxComputeWorkGroupCountY     = 65535;
+    mTBuiltInResource.maxComputeWorkGroupCountZ     = 65535;
+    mTBuiltInResource.maxComputeWorkGroupSizeX      = 128;
+    mTBuiltInResource.maxComputeWorkGroupSizeY      = 128;
+    mTBuiltInResource.maxComputeWorkGroupSizeZ      = 64;
 }
 
 void
@@ -110,24 +162,126 @@ GlslangShaderCompiler::TerminateCompiler()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mInitialized) {
+    if(!mInitialized) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mInstancesMutex);
+
+    mInitialized = false;
+    if(--mInstances == 0) {
         glslang::FinalizeProcess();
-        mInitialized = false;
     }
 }
 
+/// gl_LastFragData[i] is validated as a plain vec4, which still requires the index to be an int
+static void
+ReplaceLastFragData(string &source)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const string token("gl_LastFragData");
+
+    size_t pos = FindToken(token, source, 0);
+    while(pos != string::npos) {
+        size_t open = pos + token.size();
+        while(open < source.size() && (source[open] == ' ' || source[open] == '\t')) {
+            ++open;
+        }
+
+        size_t close = open;
+        for(int depth = 0; open < source.size() && source[open] == '[' && close < source.size(); ++close) {
+            depth += (source[close] == '[') - (source[close] == ']');
+            if(!depth) {
+                break;
+            }
+        }
+
+        // the compiler reports whatever is not an element of it
+        if(open >= source.size() || source[open] != '[' || close >= source.size()) {
+            pos = FindToken(token, source, open);
+            continue;
+        }
+
+        const string element = "(vec4(0.0) * float(" + source.substr(open + 1, close - open - 1) + "))";
+        source.replace(pos, close + 1 - pos, element);
+        pos = FindToken(token, source, pos + element.size());
+    }
+}
+
+/// GL_OVR_multiview is unknown to ESSL 1.00 too, whether the shader enables it or reads the view index
+static bool
+UsesMultiview(const string &source)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return FindToken("gl_ViewID_OVR", source, 0)     != string::npos ||
+           FindToken("GL_OVR_multiview", source, 0)  != string::npos ||
+           FindToken("GL_OVR_multiview2", source, 0) != string::npos;
+}
+
+bool
+GlslangShaderCompiler::UsesFramebufferFetch(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const auto source = mSourceMap.find(ESSL_VERSION_100);
+    return source != mSourceMap.cend() && FindToken("gl_LastFragData", source->second[SHADER_COMPILER_FRAGMENT], 0) != string::npos;
+}
+
 bool
 GlslangShaderCompiler::CompileShader(const char* const* source, shader_type_t shaderType, ESSL_VERSION version)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(shaderType == SHADER_TYPE_COMPUTE) {
+        return CompileComputeShader(*source);
+    }
+
     shader_compiler_type_t  type = (shaderType == SHADER_TYPE_VERTEX) ? SHADER_COMPILER_VERTEX : SHADER_COMPILER_FRAGMENT;
     EShLanguage             lang = (shaderType == SHADER_TYPE_VERTEX) ? EShLangVertex          : EShLangFragment;
 
+    InitCompiler();
+
     SafeDelete(mShaderCompiler[type]);
     mSourceMap[version][type] = string(*source);
     mShaderCompiler[type]     = new GlslangCompiler();
-    return mShaderCompiler[type]->CompileShader(source, &mTBuiltInResource, lang, version);
+
+    // ESSL 1.00 knows no GL_EXT_draw_instanced, so gl_InstanceIDEXT is validated as a plain int.
+    // The original source is kept, to be converted to gl_InstanceIndex.
+    const string &originalSource = mSourceMap[version][type];
+    const bool    instanced      = version == ESSL_VERSION_100 && shaderType == SHADER_TYPE_VERTEX &&
+                                   FindToken("gl_InstanceIDEXT", originalSource, 0) != string::npos;
+
+    // neither knows it GL_EXT_shader_framebuffer_fetch, gl_LastFragData is converted to a read of the input attachment
+    const bool    fetch          = version == ESSL_VERSION_100 && shaderType == SHADER_TYPE_FRAGMENT &&
+                                   FindToken("gl_LastFragData", originalSource, 0) != string::npos;
+
+    // nor GL_OVR_multiview, gl_ViewID_OVR is validated as a plain int and converted to gl_ViewIndex
+    const bool    multiview      = version == ESSL_VERSION_100 && UsesMultiview(originalSource);
+
+    if(!instanced && !fetch && !multiview) {
+        return mShaderCompiler[type]->CompileShader(source, &mTBuiltInResource, lang, version);
+    }
+
+    string validatedSource(*source);
+    if(instanced) {
+        RemoveExtensionDirective(validatedSource, "GL_EXT_draw_instanced");
+        ReplaceAll(validatedSource, "gl_InstanceIDEXT", "int(0)");
+    }
+    if(fetch) {
+        RemoveExtensionDirective(validatedSource, "GL_EXT_shader_framebuffer_fetch");
+        ReplaceLastFragData(validatedSource);
+    }
+    if(multiview) {
+        RemoveExtensionDirective(validatedSource, "GL_OVR_multiview2");
+        RemoveExtensionDirective(validatedSource, "GL_OVR_multiview");
+        RemoveLayoutDeclaration(validatedSource, "num_views");
+        ReplaceAll(validatedSource, "gl_ViewID_OVR", "int(0)");
+    }
+
+    const char *validatedSourcePtr = validatedSource.c_str();
+    return mShaderCompiler[type]->CompileShader(&validatedSourcePtr, &mTBuiltInResource, lang, version);
 }
 
 const char*
@@ -159,6 +313,48 @@ GlslangShaderCompiler::ConvertShader(uintptr_t program_ptr, shader_type_t shader
     return mSourceMap[version_out][type].c_str();
 }
 
+bool
+GlslangShaderCompiler::TranslateShader(uintptr_t program_ptr, shader_type_t shaderType, ESSL_VERSION version_in, ESSL_VERSION version_out, bool isYInverted, bool *translated)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    shader_compiler_type_t type = (shaderType == SHADER_TYPE_VERTEX) ? SHADER_COMPILER_VERTEX : SHADER_COMPILER_FRAGMENT;
+
+    *translated = false;
+
+    /// the converted source is needed to be printed, gl_InstanceIDEXT, gl_ViewID_OVR and gl_LastFragData were validated as constants,
+    /// and the pre-rotation of vertex shaders reads a specialization constant only the source conversion declares
+    if(!GLOVE_TRANSLATE_SHADERS_ON_AST || mPrintConvertedShader || (shaderType == SHADER_TYPE_VERTEX && GLOVE_USE_PRE_ROTATION) ||
+       (shaderType == SHADER_TYPE_VERTEX && FindToken("gl_InstanceIDEXT", mSourceMap[version_in][type], 0) != string::npos) ||
+       (version_in == ESSL_VERSION_100 && UsesMultiview(mSourceMap[version_in][type]))) {
+        return false;
+    }
+
+    /// specialization constants, the bindless texture table and the input attachment are declared by the source conversion only
+    for(const auto &block : mUniformBlocks) {
+        if(block.second.isSpecConstant || block.second.isBindless || block.second.isInputAttachment) {
+            return false;
+        }
+    }
+
+    GlslangTranslator translator;
+    translator.Initialize(shaderType, mShaderCompiler[type]->GetShader(version_in));
+    translator.SetIoMapResolver(mProgramLinker->GetIoMapResolver());
+    if(!translator.CanTranslate()) {
+        return false;
+    }
+
+    if(mSaveSourceToFiles) {
+        SaveShaderSourceToFile(program_ptr, false, mSourceMap[version_in][type].c_str(), type);
+    }
+
+    /// the shader is linked from its translated ESSL 1.00 tree, see GetLinkedShader()
+    mShaderCompiler[type]->ReleaseShader(version_out);
+    *translated = true;
+
+    return translator.Translate(mUniformBlocks, mShaderReflection, isYInverted);
+}
+
 bool
 GlslangShaderCompiler::PreprocessShader(uintptr_t program_ptr, shader_type_t shaderType, ESSL_VERSION version_in, ESSL_VERSION version_out, bool isYInverted)
 {
@@ -167,16 +363,237 @@ GlslangShaderCompiler::PreprocessShader(uintptr_t program_ptr, shader_type_t sha
     shader_compiler_type_t type = (shaderType == SHADER_TYPE_VERTEX) ? SHADER_COMPILER_VERTEX : SHADER_COMPILER_FRAGMENT;
     EShLanguage            lang = (shaderType == SHADER_TYPE_VERTEX) ? EShLangVertex          : EShLangFragment;
 
+    bool translated;
+    bool result = TranslateShader(program_ptr, shaderType, version_in, version_out, isYInverted, &translated);
+    if(translated) {
+        return result;
+    }
+
+    /// fall back to converting the source and compiling it again
     mSourceMap[version_out][type] = string(mSourceMap[version_in][type]);
     const char* source = ConvertShader(program_ptr, shaderType, version_in, version_out, isYInverted);
     return mShaderCompiler[type]->CompileShader(&source, &mTBuiltInResource, lang, version_out);
 }
 
+bool
+GlslangShaderCompiler::CompileKernel(const char* source, vector<uint32_t> &spv)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    InitCompiler();
+
+    // the kernels are written for Vulkan already, they skip the conversion of the application shaders
+    const EShMessages messages = static_cast<EShMessages>(EShMsgVulkanRules | EShMsgSpvRules);
+    glslang::TShader shader(EShLangCompute);
+    shader.setStrings(&source, 1);
+    if(!shader.parse(&mTBuiltInResource, 310, EEsProfile, false, false, messages)) {
+        GLOVE_PRINT_ERR("Compute Shader Compiler :\n %s\n", shader.getInfoLog());
+        return false;
+    }
+
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if(!program.link(messages)) {
+        GLOVE_PRINT_ERR("Compute Shader Linker :\n %s\n", program.getInfoLog());
+        return false;
+    }
+
+    spv.clear();
+    glslang::GlslangToSpv(*program.getIntermediate(EShLangCompute), spv);
+
+    return !spv.empty();
+}
+
+bool
+GlslangShaderCompiler::CompileComputeShader(const char* source)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    InitCompiler();
+
+    SafeDelete(mComputeProgram);
+    SafeDelete(mComputeShader);
+
+    // the uniforms of the default block are the only part Vulkan does not know of
+    mComputeSource = string(source);
+    ShaderConverter::ConvertComputeUniforms(mComputeSource);
+
+    const EShMessages messages = static_cast<EShMessages>(EShMsgVulkanRules | EShMsgSpvRules);
+    const char *computeSource  = mComputeSource.c_str();
+    mComputeShader = new glslang::TShader(EShLangCompute);
+    mComputeShader->setStrings(&computeSource, 1);
+    const bool result = mComputeShader->parse(&mTBuiltInResource, 310, EEsProfile, false, false, messages);
+    mComputeInfoLog   = mComputeShader->getInfoLog();
+
+    return result;
+}
+
+bool
+GlslangShaderCompiler::LinkComputeProgram(vector<uint32_t> &spv)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mComputeShader) {
+        mComputeInfoLog = "ERROR: No compiled compute shader\n";
+        return false;
+    }
+
+    const EShMessages messages = static_cast<EShMessages>(EShMsgVulkanRules | EShMsgSpvRules);
+    SafeDelete(mComputeProgram);
+    mComputeProgram = new glslang::TProgram();
+    mComputeProgram->addShader(mComputeShader);
+    if(!mComputeProgram->link(messages)) {
+        mComputeInfoLog = mComputeProgram->getInfoLog();
+        return false;
+    }
+
+    GlslangIoMapResolver ioMapResolver;
+    if(!mComputeProgram->buildReflection() || !mComputeProgram->mapIO(&ioMapResolver)) {
+        mComputeInfoLog = mComputeProgram->getInfoLog();
+        return false;
+    }
+
+    if(!SetComputeReflection(ioMapResolver)) {
+        return false;
+    }
+
+    spv.clear();
+    glslang::GlslangToSpv(*mComputeProgram->getIntermediate(EShLangCompute), spv);
+#if GLOVE_SPIRV_OPTIMIZATION_LEVEL > 0
+    GlslangLinker::OptimizeSPV(spv);
+#endif
+
+    if(mPrintReflection[ESSL_VERSION_400]) {
+        mShaderReflection->Print();
+    }
+
+    return !spv.empty();
+}
+
+bool
+GlslangShaderCompiler::SetComputeReflection(const GlslangIoMapResolver &ioMapResolver)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mShaderReflection->Reset();
+
+    // the storage and uniform buffers, and the uniforms pushed as constants, are all a compute program reads
+    if(ioMapResolver.GetOtherBindingNum()) {
+        mComputeInfoLog = "ERROR: Compute shaders support no samplers or images\n";
+        return false;
+    }
+    if(ioMapResolver.GetStorageBlockNum() > GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS) {
+        mComputeInfoLog = "ERROR: Too many shader storage blocks\n";
+        return false;
+    }
+    for(uint32_t i = 0; i < ioMapResolver.GetStorageBlockNum(); ++i) {
+        if(ioMapResolver.GetStorageBlockBinding(i) >= GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS ||
+           strlen(ioMapResolver.GetStorageBlockName(i)) >= GLSLANG_MAX_UNIFORM_BLOCK_NAME_LENGTH) {
+            mComputeInfoLog = "ERROR: Unsupported shader storage block " + string(ioMapResolver.GetStorageBlockName(i)) + "\n";
+            return false;
+        }
+    }
+    if(ioMapResolver.GetUniformBlockNum() > GLOVE_MAX_COMPUTE_UNIFORM_BLOCKS) {
+        mComputeInfoLog = "ERROR: Too many uniform blocks\n";
+        return false;
+    }
+    for(uint32_t i = 0; i < ioMapResolver.GetUniformBlockNum(); ++i) {
+        if(ioMapResolver.GetUniformBlockBinding(i) >= GLOVE_MAX_UNIFORM_BUFFER_BINDINGS ||
+           strlen(ioMapResolver.GetUniformBlockName(i)) >= GLSLANG_MAX_UNIFORM_BLOCK_NAME_LENGTH) {
+            mComputeInfoLog = "ERROR: Unsupported uniform block " + string(ioMapResolver.GetUniformBlockName(i)) + "\n";
+            return false;
+        }
+    }
+
+    int pushConstantBlock = -1;
+    for(int i = 0; i < mComputeProgram->getNumLiveUniformBlocks(); ++i) {
+        if(!strcmp(mComputeProgram->getUniformBlockName(i), GLOVE_COMPUTE_UNIFORM_BLOCK_NAME)) {
+            pushConstantBlock = i;
+        }
+    }
+
+    uint32_t uniformBlockIndex = 0;
+    if(pushConstantBlock >= 0) {
+        const size_t blockSize = static_cast<size_t>(mComputeProgram->getUniformBlockSize(pushConstantBlock));
+        if(blockSize > GLOVE_MAX_PUSH_CONSTANTS_SIZE) {
+            mComputeInfoLog = "ERROR: The uniforms of the default block exceed " STRINGIFY_MACRO(GLOVE_MAX_PUSH_CONSTANTS_SIZE) " bytes\n";
+            return false;
+        }
+
+        uint32_t uniformIndex = 0;
+        uint32_t location     = 0;
+        for(int i = 0; i < mComputeProgram->getNumLiveUniformVariables(); ++i) {
+            if(mComputeProgram->getUniformBlockIndex(i) != pushConstantBlock) {
+                continue;
+            }
+
+            const GLenum type = static_cast<GLenum>(mComputeProgram->getUniformType(i));
+            string name = string(mComputeProgram->getUniformName(i));
+            RemoveBrackets(name);
+            if(!GlslTypeToSize(type) || uniformIndex >= GLSLANG_MAX_UNIFORMS || name.size() >= GLSLANG_MAX_UNIFORM_NAME_LENGTH) {
+                mComputeInfoLog = "ERROR: Unsupported uniform " + name + "\n";
+                return false;
+            }
+
+            const int arraySize = std::max(mComputeProgram->getUniformArraySize(i), 1);
+            mShaderReflection->SetUniformReflectionName(name.c_str(), uniformIndex);
+            mShaderReflection->SetUniformLocation(location, uniformIndex);
+            mShaderReflection->SetUniformBlockIndex(uniformBlockIndex, uniformIndex);
+            mShaderReflection->SetUniformArraySize(arraySize, uniformIndex);
+            mShaderReflection->SetUniformType(type, uniformIndex);
+            mShaderReflection->SetUniformOffset(GetUniformOffset(mComputeProgram, name), uniformIndex);
+            location += arraySize;
+            ++uniformIndex;
+        }
+        mShaderReflection->SetLiveUniforms(uniformIndex);
+
+        mShaderReflection->SetUniformBlockGlslBlockName(GLOVE_COMPUTE_UNIFORM_BLOCK_NAME, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBinding(0, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBlockSize(blockSize, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBlockStage(SHADER_TYPE_COMPUTE, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockPushConstant(true, uniformBlockIndex);
+        ++uniformBlockIndex;
+    }
+
+    for(uint32_t i = 0; i < ioMapResolver.GetStorageBlockNum(); ++i) {
+        mShaderReflection->SetUniformBlockGlslBlockName(ioMapResolver.GetStorageBlockName(i), uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBinding(static_cast<uint32_t>(ioMapResolver.GetStorageBlockBinding(i)), uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBlockStage(SHADER_TYPE_COMPUTE, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockStorageBuffer(true, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockReadOnly(ioMapResolver.GetStorageBlockReadOnly(i), uniformBlockIndex);
+        ++uniformBlockIndex;
+    }
+
+    // the uniform blocks read the buffers bound to GL_UNIFORM_BUFFER, past the storage bindings
+    for(uint32_t i = 0; i < ioMapResolver.GetUniformBlockNum(); ++i) {
+        int liveBlock = -1;
+        for(int j = 0; j < mComputeProgram->getNumLiveUniformBlocks(); ++j) {
+            if(j != pushConstantBlock && !strcmp(mComputeProgram->getUniformBlockName(j), ioMapResolver.GetUniformBlockName(i))) {
+                liveBlock = j;
+            }
+        }
+        if(liveBlock < 0) {
+            mComputeInfoLog = "ERROR: Unsupported uniform block " + string(ioMapResolver.GetUniformBlockName(i)) + "\n";
+            return false;
+        }
+
+        mShaderReflection->SetUniformBlockGlslBlockName(ioMapResolver.GetUniformBlockName(i), uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBinding(GLOVE_UNIFORM_BUFFER_FIRST_VK_BINDING + static_cast<uint32_t>(ioMapResolver.GetUniformBlockBinding(i)), uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBlockSize(static_cast<size_t>(mComputeProgram->getUniformBlockSize(liveBlock)), uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBlockStage(SHADER_TYPE_COMPUTE, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockUniformBuffer(true, uniformBlockIndex);
+        ++uniformBlockIndex;
+    }
+    mShaderReflection->SetLiveUniformBlocks(uniformBlockIndex);
+
+    return true;
+}
+
 bool
 GlslangShaderCompiler::LinkProgram(uintptr_t program_ptr, ESSL_VERSION version, vector<uint32_t> &vertSpv, vector<uint32_t> &fragSpv)
 {
-    bool result = mProgramLinker->LinkProgram(mShaderCompiler[SHADER_COMPILER_VERTEX]->GetShader(version),
-                                              mShaderCompiler[SHADER_COMPILER_FRAGMENT]->GetShader(version),
+    bool result = mProgramLinker->LinkProgram(GetLinkedShader(SHADER_COMPILER_VERTEX  , version),
+                                              GetLinkedShader(SHADER_COMPILER_FRAGMENT, version),
                                               version);
     if(!result) {
         return false;
@@ -189,6 +606,12 @@ GlslangShaderCompiler::LinkProgram(uintptr_t program_ptr, ESSL_VERSION version,
     SetUniformOffsets(version);
     SetUniformsReflection();
 
+    mTransformFeedbackInfoLog.clear();
+    if(!mTransformFeedbackVaryings.empty() &&
+       !mProgramLinker->MapTransformFeedback(mTransformFeedbackSeparate, version, mTransformFeedbackStrides, &mTransformFeedbackInfoLog)) {
+        return false;
+    }
+
     mProgramLinker->GenerateSPV(vertSpv, EShLangVertex  , version);
     mProgramLinker->GenerateSPV(fragSpv, EShLangFragment, version);
 
@@ -218,6 +641,16 @@ GlslangShaderCompiler::LinkProgram(uintptr_t program_ptr, ESSL_VERSION version,
     return result;
 }
 
+glslang::TShader *
+GlslangShaderCompiler::GetLinkedShader(shader_compiler_type_t type, ESSL_VERSION version)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// translated shaders have no source of their own in the target version
+    glslang::TShader *shader = mShaderCompiler[type]->GetShader(version);
+    return shader ? shader : mShaderCompiler[type]->GetShader(ESSL_VERSION_100);
+}
+
 bool
 GlslangShaderCompiler::ValidateProgram(ESSL_VERSION version)
 {
@@ -226,6 +659,8 @@ GlslangShaderCompiler::ValidateProgram(ESSL_VERSION version)
     SafeDelete(mProgramLinker);
 
     mProgramLinker = new GlslangLinker();
+    // captured outputs keep a location of their own when converted, read by the fragment shader or not
+    mProgramLinker->SetTransformFeedbackVaryings(mTransformFeedbackVaryings);
     bool result = mProgramLinker->ValidateProgram(mShaderCompiler[SHADER_COMPILER_VERTEX]->GetShader(version),
                                                   mShaderCompiler[SHADER_COMPILER_FRAGMENT]->GetShader(version),
                                                   version);
@@ -368,6 +803,10 @@ GlslangShaderCompiler::GetShaderInfoLog(shader_type_t shaderType, ESSL_VERSION v
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(shaderType == SHADER_TYPE_COMPUTE) {
+        return mComputeInfoLog.c_str();
+    }
+
     shader_compiler_type_t type = (shaderType == SHADER_TYPE_VERTEX) ? SHADER_COMPILER_VERTEX : SHADER_COMPILER_FRAGMENT;
     return mShaderCompiler[type] ? mShaderCompiler[type]->GetCompileInfoLog(version) : "";
 }
@@ -377,7 +816,11 @@ GlslangShaderCompiler::GetProgramInfoLog(ESSL_VERSION version)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    return mProgramLinker ? mProgramLinker->GetLinkInfoLog(version) : "";
+    if(!mTransformFeedbackInfoLog.empty()) {
+        return mTransformFeedbackInfoLog.c_str();
+    }
+
+    return mProgramLinker ? mProgramLinker->GetLinkInfoLog(version) : mComputeInfoLog.c_str();
 }
 
 void
@@ -446,18 +889,99 @@ GlslangShaderCompiler::CreateUniformBlocks(void)
     for(auto &uni : mUniforms) {
         if(!uni.aggregatePairList[0].first) {
 
+            /// specialization constants do not exist in the [400] reflection, so their size is set here
+            const bool isSpecConstant = IsSpecializationUniform(uni);
             mUniformBlocks[uni.name] = {  uni.name,                                 /// Copy name for debugging
                                           string("uni") + to_string(binding),       /// Construct uniform block's name
-                                          binding,                                  /// Binding index
+                                          binding,                                  /// Binding index (constant id of specialization constants)
                                           IsGlSampler(uni.type),                    /// true for samplers
-                                          0,                                        /// memorySize (not known yet)
+                                          isSpecConstant ? sizeof(uint32_t) : 0,    /// memorySize (not known yet)
                                           0,                                        /// arraySize (not known yet)
                                           uni.stage,                                /// stage
-                                          nullptr
+                                          nullptr,
+                                          false,                                    /// push constant (selected later)
+                                          isSpecConstant
                                        };
             ++binding;
         }
     }
+
+    /// gl_LastFragData reads the color attachment as an input attachment, which is bound along with the samplers
+    if(UsesFramebufferFetch()) {
+        uniformBlock_t &block = mUniformBlocks[STRINGIFY_MACRO(GLOVE_VULKAN_LAST_FRAG_DATA)];
+        block = {  STRINGIFY_MACRO(GLOVE_VULKAN_LAST_FRAG_DATA),              /// Copy name for debugging
+                   string("uni") + to_string(binding),                        /// Construct uniform block's name
+                   binding,                                                   /// Binding index
+                   true,                                                      /// opaque, like the samplers
+                   0,                                                         /// memorySize
+                   0,                                                         /// arraySize
+                   SHADER_TYPE_FRAGMENT,                                      /// stage
+                   nullptr
+                };
+        block.isInputAttachment = true;
+        ++binding;
+    }
+
+    /// single samplers are read from the bindless texture table with an index given through the push constants,
+    /// which leaves no room for a push constant block. Their binding is their position in those indices
+    uint32_t bindlessIndex = 0;
+    if(mBindlessTextures) {
+        auto isBindless = [](const uniform_t &uni) {
+            return !uni.aggregatePairList[0].first && (uni.type == GL_SAMPLER_2D || uni.type == GL_SAMPLER_CUBE) && uni.arraySize == 1;
+        };
+
+        /// all the indices have to fit in the push constants, or none of the samplers is bindless
+        const size_t nBindless = std::count_if(mUniforms.cbegin(), mUniforms.cend(), isBindless);
+        for(const auto &uni : mUniforms) {
+            if(nBindless * sizeof(uint32_t) <= GLOVE_MAX_PUSH_CONSTANTS_SIZE && isBindless(uni)) {
+                uniformBlock_t &block = mUniformBlocks[uni.name];
+                block.isBindless      = true;
+                block.binding         = bindlessIndex++;
+            }
+        }
+    }
+
+    if(GLOVE_USE_PUSH_CONSTANTS && !bindlessIndex) {
+        SelectPushConstantBlock();
+    }
+}
+
+bool
+GlslangShaderCompiler::IsSpecializationUniform(const uniform_t &uni)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// only scalar switches can be specialization constants, which must be declared outside of any aggregate
+    return GLOVE_USE_SPECIALIZATION_CONSTANTS &&
+           (uni.type == GL_BOOL || uni.type == GL_INT) && uni.arraySize == 1 && !uni.aggregatePairList[0].first &&
+           !uni.name.compare(0, sizeof(GLOVE_SPECIALIZATION_UNIFORM_PREFIX) - 1, GLOVE_SPECIALIZATION_UNIFORM_PREFIX);
+}
+
+void
+GlslangShaderCompiler::SelectPushConstantBlock(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// A program has a single push constant block, which is given to the largest plain uniform that fits,
+    /// as matrices (e.g., the object transformation) are the ones most likely to change on every draw.
+    /// Sizes are not known before the block is compiled, so the std140 size of the type bounds them.
+    uniformBlock_t *pushConstantBlock = nullptr;
+    size_t          pushConstantSize  = 0;
+    for(const auto &uni : mUniforms) {
+        if(uni.aggregatePairList[0].first || IsGlSampler(uni.type) || IsBuildInUniform(uni.name) || IsSpecializationUniform(uni)) {
+            continue;
+        }
+
+        const size_t size = GlslTypeToAllignment(uni.type) * uni.arraySize;
+        if(size > pushConstantSize && size <= GLOVE_MAX_PUSH_CONSTANTS_SIZE) {
+            pushConstantBlock = &mUniformBlocks[uni.name];
+            pushConstantSize  = size;
+        }
+    }
+
+    if(pushConstantBlock) {
+        pushConstantBlock->isPushConstant = true;
+    }
 }
 
 void
@@ -728,7 +1252,7 @@ GlslangShaderCompiler::CreateUniforms(ESSL_VERSION version)
 
         /// Create Aggregate
         aggregatePairList_t aggregatePairList;
-        if(type == GL_SAMPLER_2D || type == GL_SAMPLER_CUBE) {
+        if(IsGlSampler(type)) {
             aggregatePairList.push_back(make_pair(nullptr, -1));
         } else {
             aggregatePairList = CreateAggregates(name);
@@ -779,6 +1303,10 @@ GlslangShaderCompiler::SetUniformsReflection(void)
         mShaderReflection->SetUniformBlockBlockSize(block.second.memorySize, uniformBlockIndex);
         mShaderReflection->SetUniformBlockBlockStage(block.second.stage, uniformBlockIndex);
         mShaderReflection->SetUniformBlockOpaque(block.second.isOpaque, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockPushConstant(block.second.isPushConstant, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockSpecConstant(block.second.isSpecConstant, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockBindless(block.second.isBindless, uniformBlockIndex);
+        mShaderReflection->SetUniformBlockInputAttachment(block.second.isInputAttachment, uniformBlockIndex);
         ++uniformBlockIndex;
     }
 
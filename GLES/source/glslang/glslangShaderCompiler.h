@@ -24,8 +24,10 @@
 #ifndef __GLSLANGSHADERCOMPILER_H__
 #define __GLSLANGSHADERCOMPILER_H__
 
+#include <mutex>
 #include "resources/shaderCompiler.h"
 #include "shaderConverter.h"
+#include "glslangTranslator.h"
 #include "glslangCompiler.h"
 #include "glslangLinker.h"
 #include "resources/shaderReflection.h"
@@ -40,14 +42,25 @@ private:
         SHADER_COMPILER_TYPE_MAX
     } shader_compiler_type_t;
 
-    static bool             mInitialized;
+    /// glslang is set up once for all the compilers alive, which may run on different threads
+    static uint32_t         mInstances;
+    static std::mutex       mInstancesMutex;
     static TBuiltInResource mTBuiltInResource;
 
+    /// glslang is initialized on the first compile, contexts that only load binaries never pay for it
+    mutable bool            mInitialized;
+
     GlslangCompiler*        mShaderCompiler[SHADER_COMPILER_TYPE_MAX];
     GlslangLinker*          mProgramLinker;
     ShaderConverter*        mShaderConverter;
     ShaderReflection*       mShaderReflection;
 
+    /// compute shaders are written in ESSL 3.10 for Vulkan already, they are neither converted nor linked with others
+    glslang::TShader*       mComputeShader;
+    glslang::TProgram*      mComputeProgram;
+    std::string             mComputeSource;
+    std::string             mComputeInfoLog;
+
     std::map<ESSL_VERSION, std::string[SHADER_COMPILER_TYPE_MAX]> 
                             mSourceMap;
     std::vector<uint32_t>   mSpv[SHADER_COMPILER_TYPE_MAX];
@@ -60,6 +73,15 @@ private:
     bool                    mSaveSourceToFiles;
     bool                    mSaveSpvTextToFile;
 
+    /// single samplers are read from the bindless texture table instead of their own descriptors
+    bool                    mBindlessTextures;
+
+    /// vertex outputs the link captures, and the bytes each buffer advances by per vertex
+    std::vector<std::string> mTransformFeedbackVaryings;
+    bool                    mTransformFeedbackSeparate;
+    uint32_t                mTransformFeedbackStrides[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+    std::string             mTransformFeedbackInfoLog;
+
     /// All active uniform variables as reported by glslang
     std::vector<uniform_t>  mUniforms;
 
@@ -76,7 +98,7 @@ private:
     uniformBlockMap_t       mUniformBlocks;
 
 /// Init Functions
-    void                    InitCompiler(void);
+    void                    InitCompiler(void) const;
     void                    InitCompilerResources(void);
     void                    InitReflection(void);
 
@@ -88,6 +110,14 @@ private:
 
 /// Convert Functions
     const char             *ConvertShader(uintptr_t program_ptr, shader_type_t shaderType, ESSL_VERSION version_in, ESSL_VERSION version_out, bool isYInverted);
+    bool                    TranslateShader(uintptr_t program_ptr, shader_type_t shaderType, ESSL_VERSION version_in, ESSL_VERSION version_out, bool isYInverted, bool *translated);
+
+/// Compute Functions
+    bool                    CompileComputeShader(const char* source);
+    bool                    SetComputeReflection(const GlslangIoMapResolver &ioMapResolver);
+
+/// Get Functions
+    glslang::TShader       *GetLinkedShader(shader_compiler_type_t type, ESSL_VERSION version);
 
 /// In/Out File Functions
     void                    PrintReadableSPV(shader_compiler_type_t type, ESSL_VERSION version);
@@ -98,6 +128,9 @@ private:
 /// Reflection Functions (IN)
     void                    CreateUniforms(ESSL_VERSION version);
     void                    CreateUniformBlocks(void);
+    bool                    UsesFramebufferFetch(void) const;
+    void                    SelectPushConstantBlock(void);
+    static bool             IsSpecializationUniform(const uniform_t &uni);
     aggregatePairList_t     CreateAggregates(const std::string uniformName);
     void                    LinkUniformsToUniformBlocks(void);
     void                    SetAttributesReflection(ESSL_VERSION version);
@@ -118,12 +151,19 @@ public:
     GlslangShaderCompiler();
     ~GlslangShaderCompiler() override;
 
+/// Create Functions
+    ShaderCompiler          *CreateCompiler(void)                       const override;
+
+/// Release Functions
+    void                     ReleaseCompiler(void)                            override;
+
 /// Linking Functions
     bool                     LinkProgram(uintptr_t program_ptr,
                                          ESSL_VERSION version,
                                          vector<uint32_t> &vertSpv, 
                                          vector<uint32_t> &fragSpv)           override;
     bool                     ValidateProgram(ESSL_VERSION version)            override;
+    bool                     LinkComputeProgram(vector<uint32_t> &spv)        override;
     
 /// Reflection Functions
     void                     PrepareReflection(ESSL_VERSION version)          override;
@@ -140,6 +180,10 @@ public:
                                            shader_type_t shaderType,
                                            ESSL_VERSION version)              override;
 
+/// Kernel Functions
+    bool                     CompileKernel(const char* source,
+                                           vector<uint32_t> &spv)             override;
+
 /// Print Functions
     void                     PrintUniformReflection(void)                     override;
 
@@ -156,6 +200,13 @@ public:
     inline void              EnableSaveBinaryToFiles(void)                    override { FUN_ENTRY(GL_LOG_TRACE); mSaveBinaryToFiles          = true; }
     inline void              EnableSaveSourceToFiles(void)                    override { FUN_ENTRY(GL_LOG_TRACE); mSaveSourceToFiles          = true; }
     inline void              EnableSaveSpvTextToFile(void)                    override { FUN_ENTRY(GL_LOG_TRACE); mSaveSpvTextToFile          = true; }
+    inline void              EnableBindlessTextures(void)                     override { FUN_ENTRY(GL_LOG_TRACE); mBindlessTextures           = true; }
+
+/// Transform Feedback Functions
+    inline void              EnableTransformFeedback(const vector<string> &varyings,
+                                                     bool separate)           override { FUN_ENTRY(GL_LOG_TRACE); mTransformFeedbackVaryings  = varyings;
+                                                                                                                  mTransformFeedbackSeparate  = separate; }
+    inline uint32_t          GetTransformFeedbackStride(uint32_t buffer) const override { FUN_ENTRY(GL_LOG_TRACE); return mTransformFeedbackStrides[buffer]; }
 };
 
 #endif // __GLSLANGSHADERCOMPILER_H__
@@ -0,0 +1,492 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glslangTranslator.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      ESSL to Vulkan GLSL translation performed on the glslang AST
+ *
+ *  @section
+ *
+ *  The ESSL 1.00 tree that validated the shader is rewritten in place with
+ *  the same decorations the source converter spells out in text: loose
+ *  uniforms are wrapped into std140 blocks, samplers, attributes and varyings
+ *  get their bindings and locations, and the vertex position is moved into
+ *  Vulkan's clip space. The rewritten tree is linked and emitted as SPIR-V
+ *  directly, so the shader is parsed only once.
+ *
+ */
+
+#include "glslangTranslator.h"
+#include "utils/glUtils.h"
+#include <algorithm>
+
+using namespace glslang;
+
+namespace {
+
+/// Read-only pass over the tree, gathering what decides and drives the translation
+class TranslatorScanner : public TIntermTraverser {
+public:
+    TranslatorScanner()
+    : mMaxSymbolId(0), mPosition(nullptr), mUnsupported(false)
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+    }
+
+    void visitSymbol(TIntermSymbol *symbol) override
+    {
+        FUN_ENTRY(GL_LOG_TRACE);
+
+        const TType &type = symbol->getType();
+
+        mMaxSymbolId = std::max(mMaxSymbolId, symbol->getId());
+
+        if(type.getQualifier().builtIn == EbvPosition && mPosition == nullptr) {
+            mPosition = symbol;
+        }
+
+        /// gl_DepthRange and samplers inside structs are served by the source converter only
+        if(symbol->getName() == "gl_DepthRange" ||
+          (type.getQualifier().storage == EvqUniform && type.getBasicType() == EbtStruct && type.containsOpaque())) {
+            mUnsupported = true;
+        }
+    }
+
+    inline long long      GetMaxSymbolId(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mMaxSymbolId; }
+    inline TIntermSymbol *GetPosition(void)                             const { FUN_ENTRY(GL_LOG_TRACE); return mPosition;    }
+    inline bool           IsUnsupported(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mUnsupported; }
+
+private:
+    long long             mMaxSymbolId;
+    TIntermSymbol        *mPosition;
+    bool                  mUnsupported;
+};
+
+}
+
+GlslangTranslator::GlslangTranslator()
+: mShaderType(SHADER_TYPE_INVALID),
+  mIntermediate(nullptr),
+  mIoMapResolver(nullptr),
+  mUniformBlockMap(nullptr),
+  mNextSymbolId(0),
+  mUnusedBinding(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+GlslangTranslator::~GlslangTranslator()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+void
+GlslangTranslator::Initialize(shader_type_t shaderType, TShader *shader)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mShaderType   = shaderType;
+    mIntermediate = shader ? shader->getIntermediate() : nullptr;
+}
+
+bool
+GlslangTranslator::CanTranslate(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// shaders validated with relaxed errors come without a tree
+    if(mIntermediate == nullptr || mIntermediate->getTreeRoot() == nullptr || mIntermediate->getTreeRoot()->getAsAggregate() == nullptr) {
+        return false;
+    }
+
+    TranslatorScanner scanner;
+    mIntermediate->getTreeRoot()->traverse(&scanner);
+
+    return !scanner.IsUnsupported();
+}
+
+bool
+GlslangTranslator::Translate(const uniformBlockMap_t &uniformBlockMap, ShaderReflection* reflection, bool isYInverted)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    TranslatorScanner scanner;
+    mIntermediate->getTreeRoot()->traverse(&scanner);
+
+    mUniformBlockMap = &uniformBlockMap;
+    mNextSymbolId    = scanner.GetMaxSymbolId() + 1;
+    /// Start of dead uniform blocks where the active end
+    mUnusedBinding   = static_cast<uint32_t>(uniformBlockMap.size());
+
+    TIntermSequence &sequence = mIntermediate->getTreeRoot()->getAsAggregate()->getSequence();
+
+    /// declarations go first, so that bindings are handed out in declaration order
+    for(auto node : sequence) {
+        TIntermAggregate *aggregate = node->getAsAggregate();
+        if(aggregate && aggregate->getOp() == EOpLinkerObjects && !ProcessLinkerObjects(aggregate, reflection)) {
+            return false;
+        }
+    }
+
+    for(auto &node : sequence) {
+        node = ProcessNode(node);
+    }
+
+    if(mShaderType == SHADER_TYPE_VERTEX) {
+        if(scanner.GetPosition()) {
+            ConvertGLToVulkanPosition(scanner.GetPosition(), isYInverted);
+        }
+    } else {
+        mIntermediate->setOriginUpperLeft();
+    }
+
+    SpvVersion spvVersion;
+    spvVersion.spv        = EShTargetSpv_1_0;
+    spvVersion.vulkan     = EShTargetVulkan_1_0;
+    spvVersion.vulkanGlsl = 100;
+    mIntermediate->setSpv(spvVersion);
+
+    return true;
+}
+
+bool
+GlslangTranslator::ProcessLinkerObjects(TIntermAggregate *linkerObjects, ShaderReflection* reflection)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::map<std::string, std::pair<int,bool>> varyingsLocationMap;
+    mIoMapResolver->CreateVaryingLocationMap(&varyingsLocationMap);
+
+    std::vector<int> attributeLocations;
+
+    for(auto &node : linkerObjects->getSequence()) {
+        TIntermSymbol *symbol = node->getAsSymbolNode();
+        if(symbol == nullptr) {
+            continue;
+        }
+
+        const std::string       name(symbol->getName().c_str());
+        const TStorageQualifier storage = symbol->getQualifier().storage;
+
+        if(IsLooseUniform(symbol)) {
+            node = GetUniformBlock(symbol).symbol;
+            continue;
+        }
+
+        if(storage == EvqUniform && symbol->getBasicType() == EbtSampler) {
+            uniformBlockMap_t::const_iterator it = mUniformBlockMap->find(name);
+            mSamplerBindings[name] = (it != mUniformBlockMap->cend()) ? it->second.binding : mUnusedBinding++;
+        } else if(mShaderType == SHADER_TYPE_VERTEX && storage == EvqVaryingIn) {
+            int location = reflection->GetLiveAttributes() ? reflection->GetAttributeLocation(name.c_str()) : -1;
+            if(location >= 0 && std::find(attributeLocations.begin(), attributeLocations.end(), location) == attributeLocations.end()) {
+                for(int j = 0; j < (int)OccupiedLocationsPerGlType(reflection->GetAttributeType(name.c_str())); j++) {
+                    attributeLocations.push_back(location + j);
+                }
+            } else {
+                location = -1;
+            }
+            mInOutLocations[name] = location;
+        } else if(storage == EvqVaryingIn || storage == EvqVaryingOut) {
+            auto it = varyingsLocationMap.find(name);
+            if(it == varyingsLocationMap.end()) {
+                mInOutLocations[name] = -1;
+            } else if(mShaderType == SHADER_TYPE_FRAGMENT && !it->second.second) {
+                /// varying type mismatch fails the link
+                return false;
+            } else {
+                mInOutLocations[name] = it->second.first;
+            }
+        }
+
+        ProcessSymbol(symbol);
+    }
+
+    return true;
+}
+
+void
+GlslangTranslator::ProcessSymbol(TIntermSymbol *symbol)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    TType      &type      = symbol->getWritableType();
+    TQualifier &qualifier = type.getQualifier();
+
+    if(type.getBasicType() == EbtSampler) {
+        /// samplerExternalOES is sampled as a plain sampler2D
+        type.getSampler().external = false;
+
+        if(qualifier.storage == EvqUniform) {
+            auto it = mSamplerBindings.find(std::string(symbol->getName().c_str()));
+            if(it != mSamplerBindings.end()) {
+                qualifier.layoutSet     = 0;
+                qualifier.layoutBinding = it->second;
+            }
+        }
+        return;
+    }
+
+    if(qualifier.storage != EvqVaryingIn && qualifier.storage != EvqVaryingOut) {
+        return;
+    }
+
+    /// inputs and outputs without a counterpart become plain globals
+    auto it = mInOutLocations.find(std::string(symbol->getName().c_str()));
+    if(it == mInOutLocations.end() || it->second < 0) {
+        qualifier.storage   = EvqGlobal;
+        qualifier.invariant = false;
+        return;
+    }
+
+    qualifier.layoutLocation = static_cast<unsigned int>(it->second);
+    if(mShaderType == SHADER_TYPE_FRAGMENT) {
+        qualifier.invariant = false;
+    }
+}
+
+TIntermTyped *
+GlslangTranslator::ProcessTyped(TIntermTyped *node)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    TIntermNode *processed = ProcessNode(node);
+    return processed ? processed->getAsTyped() : nullptr;
+}
+
+TIntermNode *
+GlslangTranslator::ProcessNode(TIntermNode *node)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(node == nullptr) {
+        return nullptr;
+    }
+
+    if(TIntermSymbol *symbol = node->getAsSymbolNode()) {
+        if(IsLooseUniform(symbol)) {
+            return CreateUniformBlockAccess(symbol);
+        }
+        ProcessSymbol(symbol);
+        return symbol;
+    }
+
+    if(TIntermBinary *binary = node->getAsBinaryNode()) {
+        binary->setLeft(ProcessTyped(binary->getLeft()));
+        binary->setRight(ProcessTyped(binary->getRight()));
+        return binary;
+    }
+
+    if(TIntermUnary *unary = node->getAsUnaryNode()) {
+        unary->setOperand(ProcessTyped(unary->getOperand()));
+        return unary;
+    }
+
+    if(TIntermAggregate *aggregate = node->getAsAggregate()) {
+        /// declarations are rewritten by ProcessLinkerObjects
+        if(aggregate->getOp() != EOpLinkerObjects) {
+            for(auto &child : aggregate->getSequence()) {
+                child = ProcessNode(child);
+            }
+        }
+        return aggregate;
+    }
+
+    /// the remaining nodes do not expose their children for writing, so they are rebuilt when one changes
+    if(TIntermSelection *selection = node->getAsSelectionNode()) {
+        TIntermTyped *condition  = ProcessTyped(selection->getCondition());
+        TIntermNode  *trueBlock  = ProcessNode(selection->getTrueBlock());
+        TIntermNode  *falseBlock = ProcessNode(selection->getFalseBlock());
+        if(condition == selection->getCondition() && trueBlock == selection->getTrueBlock() && falseBlock == selection->getFalseBlock()) {
+            return selection;
+        }
+
+        TIntermSelection *rebuilt = new TIntermSelection(condition, trueBlock, falseBlock, selection->getType());
+        rebuilt->setLoc(selection->getLoc());
+        return rebuilt;
+    }
+
+    if(TIntermLoop *loop = node->getAsLoopNode()) {
+        TIntermNode  *body     = ProcessNode(loop->getBody());
+        TIntermTyped *test     = ProcessTyped(loop->getTest());
+        TIntermTyped *terminal = ProcessTyped(loop->getTerminal());
+        if(body == loop->getBody() && test == loop->getTest() && terminal == loop->getTerminal()) {
+            return loop;
+        }
+
+        TIntermLoop *rebuilt = new TIntermLoop(body, test, terminal, loop->testFirst());
+        rebuilt->setLoc(loop->getLoc());
+        return rebuilt;
+    }
+
+    if(TIntermBranch *branch = node->getAsBranchNode()) {
+        TIntermTyped *expression = ProcessTyped(branch->getExpression());
+        if(expression == branch->getExpression()) {
+            return branch;
+        }
+
+        TIntermBranch *rebuilt = new TIntermBranch(branch->getFlowOp(), expression);
+        rebuilt->setLoc(branch->getLoc());
+        return rebuilt;
+    }
+
+    return node;
+}
+
+bool
+GlslangTranslator::IsLooseUniform(const TIntermSymbol *symbol) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return symbol->getQualifier().storage == EvqUniform &&
+           symbol->getBasicType() != EbtSampler          &&
+           symbol->getBasicType() != EbtBlock;
+}
+
+GlslangTranslator::uniformBlockSymbol_t &
+GlslangTranslator::GetUniformBlock(const TIntermSymbol *uniform)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const std::string name(uniform->getName().c_str());
+
+    auto blockSymbolIt = mUniformBlockSymbols.find(name);
+    if(blockSymbolIt != mUniformBlockSymbols.end()) {
+        return blockSymbolIt->second;
+    }
+
+    TQualifier qualifier;
+    qualifier.clear();
+    qualifier.storage       = EvqUniform;
+    qualifier.layoutPacking = ElpStd140;
+    qualifier.layoutMatrix  = ElmColumnMajor;
+
+    std::string blockName;
+    uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(name);
+    if(uniBlockIt != mUniformBlockMap->cend()) {
+        const uniformBlock_t &block = uniBlockIt->second;
+        if(block.isPushConstant) {
+            qualifier.layoutPushConstant = true;
+        } else {
+            qualifier.layoutSet     = 0;
+            qualifier.layoutBinding = block.binding;
+        }
+        blockName = block.glslName;
+    } else {
+        /// inactive uniform
+        qualifier.layoutSet     = 0;
+        qualifier.layoutBinding = mUnusedBinding;
+        blockName = string("uni") + to_string(mUnusedBinding);
+        ++mUnusedBinding;
+    }
+
+    TType *memberType = new TType();
+    memberType->shallowCopy(uniform->getType());
+    memberType->setFieldName(uniform->getName());
+
+    TTypeList *members = new TTypeList();
+    members->push_back({memberType, uniform->getLoc()});
+
+    /// anonymous block, so that reflection reports its member by the uniform's own name
+    TType blockType(members, TString(blockName.c_str()), qualifier);
+    TIntermSymbol *blockSymbol = new TIntermSymbol(mNextSymbolId++,
+                                                   TString("anon@") + String(static_cast<int>(mUniformBlockSymbols.size())),
+                                                   blockType);
+    blockSymbol->setLoc(uniform->getLoc());
+
+    uniformBlockSymbol_t &blockSymbolEntry = mUniformBlockSymbols[name];
+    blockSymbolEntry.memberType = memberType;
+    blockSymbolEntry.symbol     = blockSymbol;
+
+    return blockSymbolEntry;
+}
+
+TIntermTyped *
+GlslangTranslator::CreateUniformBlockAccess(const TIntermSymbol *uniform)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const uniformBlockSymbol_t &block = GetUniformBlock(uniform);
+    const TSourceLoc           &loc   = uniform->getLoc();
+
+    TIntermSymbol *container = new TIntermSymbol(block.symbol->getId(), block.symbol->getName(), block.symbol->getType());
+    container->setLoc(loc);
+
+    TIntermTyped *access = mIntermediate->addIndex(EOpIndexDirectStruct, container, mIntermediate->addConstantUnion(0, loc), loc);
+    access->setType(*block.memberType);
+
+    return access;
+}
+
+TIntermTyped *
+GlslangTranslator::CreatePositionComponent(const TIntermSymbol *position, int component)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const TSourceLoc &loc = position->getLoc();
+
+    TIntermSymbol *symbol = new TIntermSymbol(position->getId(), position->getName(), position->getType());
+    symbol->setLoc(loc);
+
+    TIntermTyped *access = mIntermediate->addIndex(EOpIndexDirect, symbol, mIntermediate->addConstantUnion(component, loc), loc);
+    access->setType(TType(EbtFloat, EvqTemporary, position->getQualifier().precision));
+
+    return access;
+}
+
+void
+GlslangTranslator::ConvertGLToVulkanPosition(const TIntermSymbol *position, bool isYInverted)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    TIntermAggregate *body = nullptr;
+    for(auto node : mIntermediate->getTreeRoot()->getAsAggregate()->getSequence()) {
+        TIntermAggregate *function = node->getAsAggregate();
+        if(function == nullptr || function->getOp() != EOpFunction || function->getName().compare(mIntermediate->getEntryPointMangledName().c_str())) {
+            continue;
+        }
+
+        /// an empty main() comes without a body
+        TIntermSequence &definition = function->getSequence();
+        if(definition.size() < 2) {
+            body = new TIntermAggregate(EOpSequence);
+            definition.push_back(body);
+        } else {
+            body = definition[1]->getAsAggregate();
+        }
+        break;
+    }
+
+    if(body == nullptr) {
+        return;
+    }
+
+    const TSourceLoc &loc = position->getLoc();
+
+    //If the "VK_KHR_maintenance1" is not supported, so we have to invert the y coordinates here
+    if(isYInverted) {
+        /// gl_Position.y = -gl_Position.y;
+        body->getSequence().push_back(mIntermediate->addAssign(EOpAssign,
+                                                               CreatePositionComponent(position, 1),
+                                                               mIntermediate->addUnaryMath(EOpNegative, CreatePositionComponent(position, 1), loc),
+                                                               loc));
+    }
+
+    /// gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;
+    TIntermTyped *depth = mIntermediate->addBinaryMath(EOpAdd, CreatePositionComponent(position, 2), CreatePositionComponent(position, 3), loc);
+    depth = mIntermediate->addBinaryMath(EOpDiv, depth, mIntermediate->addConstantUnion(2.0, EbtFloat, loc), loc);
+    body->getSequence().push_back(mIntermediate->addAssign(EOpAssign, CreatePositionComponent(position, 2), depth, loc));
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glslangTranslator.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      ESSL to Vulkan GLSL translation performed on the glslang AST
+ *
+ */
+
+#ifndef __GLSLANGTRANSLATOR_H__
+#define __GLSLANGTRANSLATOR_H__
+
+#include "resources/shaderReflection.h"
+#include "glslang/Include/ShHandle.h"
+#include "glslang/MachineIndependent/localintermediate.h"
+#include "glslangIoMapResolver.h"
+#include "glslangUtils.h"
+
+class GlslangTranslator {
+public:
+    GlslangTranslator();
+    ~GlslangTranslator();
+
+           void Initialize(shader_type_t shaderType, glslang::TShader *shader);
+           bool CanTranslate(void) const;
+           bool Translate(const uniformBlockMap_t &uniformBlockMap, ShaderReflection* reflection, bool isYInverted);
+
+/// Set Functions
+    inline void SetIoMapResolver(GlslangIoMapResolver *ioMapResolver)      { FUN_ENTRY(GL_LOG_TRACE); mIoMapResolver = ioMapResolver; }
+
+private:
+    typedef struct {
+        glslang::TType         *memberType;
+        glslang::TIntermSymbol *symbol;
+    } uniformBlockSymbol_t;
+
+    shader_type_t                                   mShaderType;
+    glslang::TIntermediate                         *mIntermediate;
+    GlslangIoMapResolver                           *mIoMapResolver;
+    const uniformBlockMap_t                        *mUniformBlockMap;
+
+    long long                                       mNextSymbolId;
+    uint32_t                                        mUnusedBinding;
+    std::map<std::string, uniformBlockSymbol_t>     mUniformBlockSymbols;
+    std::map<std::string, uint32_t>                 mSamplerBindings;
+    std::map<std::string, int>                      mInOutLocations;    /// negative for inputs and outputs without a counterpart
+
+/// Process Functions
+    bool                    ProcessLinkerObjects(glslang::TIntermAggregate *linkerObjects, ShaderReflection* reflection);
+    void                    ProcessSymbol(glslang::TIntermSymbol *symbol);
+    glslang::TIntermNode   *ProcessNode(glslang::TIntermNode *node);
+    glslang::TIntermTyped  *ProcessTyped(glslang::TIntermTyped *node);
+
+/// Uniform Functions
+    bool                    IsLooseUniform(const glslang::TIntermSymbol *symbol) const;
+    uniformBlockSymbol_t   &GetUniformBlock(const glslang::TIntermSymbol *uniform);
+    glslang::TIntermTyped  *CreateUniformBlockAccess(const glslang::TIntermSymbol *uniform);
+
+/// Convert Functions
+    void                    ConvertGLToVulkanPosition(const glslang::TIntermSymbol *position, bool isYInverted);
+    glslang::TIntermTyped  *CreatePositionComponent(const glslang::TIntermSymbol *position, int component);
+};
+
+#endif // __GLSLANGTRANSLATOR_H__
@@ -54,6 +54,10 @@ struct uniformBlock_t {
     int32_t                         arraySize;      /// Uniform block's Array size 
     shader_type_t                   stage;          /// Uniform block's shader stage
     const aggregate_t *             pAggregate;
+    bool                            isPushConstant; /// true for the block declared as push constants
+    bool                            isSpecConstant; /// true for the uniform declared as a specialization constant, its binding is the constant id
+    bool                            isBindless;     /// true for the sampler read from the bindless texture table, its binding is its index in the push constant indices
+    bool                            isInputAttachment; /// true for the color attachment read back through gl_LastFragData
 
     uniformBlock_t():
         binding(0),
@@ -61,12 +65,16 @@ struct uniformBlock_t {
         memorySize(0),
         arraySize(0),
         stage(SHADER_TYPE_INVALID),
-        pAggregate(nullptr)
+        pAggregate(nullptr),
+        isPushConstant(false),
+        isSpecConstant(false),
+        isBindless(false),
+        isInputAttachment(false)
     {
         FUN_ENTRY(GL_LOG_TRACE);
     }
 
-    uniformBlock_t(string n, string gbn, uint32_t b, bool io, size_t bs, int32_t ba, shader_type_t bStage, const aggregate_t *pAggr)
+    uniformBlock_t(string n, string gbn, uint32_t b, bool io, size_t bs, int32_t ba, shader_type_t bStage, const aggregate_t *pAggr, bool pc = false, bool sc = false)
      : name(n),
        glslName(gbn),
        binding(b),
@@ -74,7 +82,11 @@ struct uniformBlock_t {
        memorySize(bs),
        arraySize(ba),
        stage(bStage),
-       pAggregate(pAggr)
+       pAggregate(pAggr),
+       isPushConstant(pc),
+       isSpecConstant(sc),
+       isBindless(false),
+       isInputAttachment(false)
     {
         FUN_ENTRY(GL_LOG_TRACE);
     }
@@ -25,6 +25,8 @@
 #include "resources/shaderProgram.h"
 #include "utils/glUtils.h"
 #include "utils/glLogger.h"
+#include <algorithm>
+#include <cstring>
 
 const char * const ShaderConverter::shaderVersion    = "#version 400\n";
 const char * const ShaderConverter::shaderExtensions = "#extension GL_ARB_shading_language_420pack : enable\n"
@@ -32,11 +34,28 @@ const char * const ShaderConverter::shaderExtensions = "#extension GL_ARB_shadin
                                                        "#extension GL_OES_EGL_image_external : enable\n"
                                                        "\n";
 
-const char * const ShaderConverter::shaderPrecision  = "#ifdef GL_ES\n"
-                                                       "    precision highp float;\n"
-                                                       "#endif\n"
+/// GL_OVR_multiview is served by GL_EXT_multiview, whose directive has to precede the default precisions
+const char * const ShaderConverter::shaderMultiview  = "#extension GL_EXT_multiview : require\n"
+                                                       "#define GL_OVR_multiview 1\n"
+                                                       "#define GL_OVR_multiview2 1\n"
+                                                       "#define gl_ViewID_OVR int(gl_ViewIndex)\n"
                                                        "\n";
 
+/// The predeclared default precisions of ESSL 1.00, desktop GLSL would otherwise make everything highp.
+/// GL_ES itself is reserved, so the directives of the source test GLOVE_GL_ES instead
+const char * const ShaderConverter::shaderPrecisionVertex   = "#define GLOVE_GL_ES 1\n"
+                                                              "precision highp float;\n"
+                                                              "precision highp int;\n"
+                                                              "precision lowp sampler2D;\n"
+                                                              "precision lowp samplerCube;\n"
+                                                              "\n";
+
+const char * const ShaderConverter::shaderPrecisionFragment = "#define GLOVE_GL_ES 1\n"
+                                                              "precision mediump int;\n"
+                                                              "precision lowp sampler2D;\n"
+                                                              "precision lowp samplerCube;\n"
+                                                              "\n";
+
 const char * const ShaderConverter::shaderTexture2d  = "/// GL_KHR_vulkan_glsl removed texture2D(), texture2DProj(), textureLod(), textureProjLod()\n"
                                                        "#define texture2D texture\n"
                                                        "#define texture2DLod textureLod\n"
@@ -50,6 +69,27 @@ const char * const ShaderConverter::shaderTextureCube= "/// GL_KHR_vulkan_glsl r
                                                       "#define textureCubeLod textureLod\n"
                                                       "\n";
 
+const char * const ShaderConverter::shaderDrawInstanced = "/// GL_EXT_draw_instanced is served by gl_InstanceIndex, as draws never have a base instance\n"
+                                                          "#define GL_EXT_draw_instanced 1\n"
+                                                          "#define gl_InstanceIDEXT gl_InstanceIndex\n"
+                                                          "\n";
+
+const char * const ShaderConverter::shaderShadowSamplers = "/// GL_EXT_shadow_samplers is core, its functions are the overloads of texture() and textureProj()\n"
+                                                           "#define GL_EXT_shadow_samplers 1\n"
+                                                           "#define shadow2DEXT texture\n"
+                                                           "#define shadow2DProjEXT textureProj\n"
+                                                           "\n";
+
+const char * const ShaderConverter::shaderFramebufferFetch = "/// GL_EXT_shader_framebuffer_fetch reads the color attachment, which is the input attachment of the subpass\n"
+                                                             "#define GL_EXT_shader_framebuffer_fetch 1\n"
+                                                             "layout(input_attachment_index = 0) uniform subpassInput " STRINGIFY_MACRO(GLOVE_VULKAN_LAST_FRAG_DATA) ";\n"
+                                                             "#define gl_LastFragData vec4[1](subpassLoad(" STRINGIFY_MACRO(GLOVE_VULKAN_LAST_FRAG_DATA) "))\n"
+                                                             "\n";
+
+const char * const ShaderConverter::shaderPreRotation = "/// quarter turns the default framebuffer is drawn with towards the display, 0 for any other framebuffer\n"
+                                                        "layout(constant_id = " STRINGIFY_MACRO(GLOVE_PRE_ROTATION_CONSTANT_ID) ") const int glove_PreRotation = 0;\n"
+                                                        "\n";
+
 const char * const ShaderConverter::shaderDepthRange = "/// GL_KHR_vulkan_glsl removed gl_DepthRange as well\n"
                                                        "struct gl_DepthRangeParameters {\n"
                                                        "    float near;\n"
@@ -74,12 +114,117 @@ const char * const ShaderConverter::shaderLimitsBuiltIns = "#define gl_MaxVertex
                                                            "#define gl_MaxDrawBuffers "                STRINGIFY_MACRO(GLOVE_MAX_DRAW_BUFFERS) "\n"
                                                            "\n";
 
+namespace {
+
+inline bool
+IsIdentifierChar(char c)
+{
+    return ((c >= 'a' && c <= 'z') ||
+            (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') ||
+            (c == '_'));
+}
+
+inline bool
+IsBlank(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\r');
+}
+
+inline size_t
+SkipBlanks(const string &source, size_t pos)
+{
+    while(pos < source.size() && IsBlank(source[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+inline size_t
+SkipSpaces(const string &source, size_t pos)
+{
+    while(pos < source.size() && (IsBlank(source[pos]) || source[pos] == '\n')) {
+        ++pos;
+    }
+    return pos;
+}
+
+inline size_t
+ReadIdentifier(const string &source, size_t pos)
+{
+    while(pos < source.size() && IsIdentifierChar(source[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+inline bool
+IsToken(const string &source, size_t start, size_t end, const char *token)
+{
+    const size_t length = strlen(token);
+    return (end - start == length) && !source.compare(start, length, token);
+}
+
+/// "[precision] type name" following a storage qualifier
+void
+ReadDeclaration(const string &source, size_t pos, string *type, string *name, size_t *nameStart, size_t *nameEnd)
+{
+    size_t start = SkipSpaces(source, pos);
+    size_t end   = ReadIdentifier(source, start);
+    if(IsPrecisionQualifier(string(source, start, end - start))) {
+        start = SkipSpaces(source, end);
+        end   = ReadIdentifier(source, start);
+    }
+    *type      = string(source, start, end - start);
+
+    *nameStart = SkipSpaces(source, end);
+    *nameEnd   = ReadIdentifier(source, *nameStart);
+    *name      = string(source, *nameStart, *nameEnd - *nameStart);
+}
+
+/// #version must come first, after nothing else but comments
+bool
+StartsWithVersionDirective(const string &source)
+{
+    size_t pos = SkipSpaces(source, 0);
+    while(pos < source.size()) {
+        if(!source.compare(pos, 2, "//")) {
+            pos = source.find('\n', pos);
+        } else if(!source.compare(pos, 2, "/*")) {
+            pos = source.find("*/", pos + 2);
+            pos = (pos == string::npos) ? pos : pos + 2;
+        } else {
+            break;
+        }
+        if(pos == string::npos) {
+            return false;
+        }
+        pos = SkipSpaces(source, pos);
+    }
+
+    if(pos >= source.size() || source[pos] != '#') {
+        return false;
+    }
+    pos = SkipBlanks(source, pos + 1);
+    return IsToken(source, pos, ReadIdentifier(source, pos), "version");
+}
+
+}
+
 ShaderConverter::ShaderConverter()
 : mConversionType(SHADER_CONVERSION_INVALID),
   mShaderType(SHADER_TYPE_INVALID),
   mMemLayoutQualifier("std140"),
   mSlangProg(nullptr),
-  mIoMapResolver(nullptr)
+  mIoMapResolver(nullptr),
+  mUniformBlockMap(nullptr),
+  mReflection(nullptr),
+  mUnusedBlockBindings(0),
+  mBindlessSamplerCount(0),
+  mLineDirectiveEnabled(false),
+  mHeaderPending(false),
+  mHeaderLines(0),
+  mLastBracket(string::npos)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -106,25 +251,68 @@ ShaderConverter::Convert100To400(std::string& source, const uniformBlockMap_t &u
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // Replace each tab with 4 spaces. It makes parsing result easy to use.
-    ReplaceAll(source, "\t", "    ");
-    ProcessMacros(source);
-    ProcessHeader(source, uniformBlockMap);
-    ProcessUniforms(source, uniformBlockMap);
+    mUniformBlockMap      = &uniformBlockMap;
+    mReflection           = reflection;
+    /// Start of dead uniform blocks where the active end
+    mUnusedBlockBindings  = static_cast<uint32_t>(uniformBlockMap.size());
+    mLineDirectiveEnabled = FindToken("#line", source, 0) != string::npos;
+    mLastBracket          = string::npos;
+    mRenamedUniforms.clear();
+    mBindlessSamplers.clear();
+    mBindlessSamplerCount = static_cast<uint32_t>(std::count_if(uniformBlockMap.cbegin(), uniformBlockMap.cend(),
+                                                                [](const uniformBlockMap_t::value_type &block) { return block.second.isBindless; }));
+    mAttributeLocations.clear();
+    mVaryingsLocationMap.clear();
+    mIoMapResolver->CreateVaryingLocationMap(&mVaryingsLocationMap);
 
-    if(mShaderType == SHADER_TYPE_FRAGMENT) {
-        ProcessInvariantQualifier(source);
+    /// Do not add vulkan_DepthRange declaration if gl_DepthRange is not active in the input shader
+    const bool depthRangeActive = uniformBlockMap.find(string("gl_DepthRange")) != uniformBlockMap.cend();
+    /// Nor the input attachment, if gl_LastFragData is not read
+    const bool fetchActive      = mShaderType == SHADER_TYPE_FRAGMENT &&
+                                  uniformBlockMap.find(string(STRINGIFY_MACRO(GLOVE_VULKAN_LAST_FRAG_DATA))) != uniformBlockMap.cend();
+    /// Nor GL_EXT_multiview, which requires the device to draw multiple views, if GL_OVR_multiview is not used
+    const bool multiviewActive  = FindToken("gl_ViewID_OVR", source, 0)     != string::npos ||
+                                  FindToken("GL_OVR_multiview", source, 0)  != string::npos ||
+                                  FindToken("GL_OVR_multiview2", source, 0) != string::npos;
+    if(multiviewActive) {
+        /// the number of views is that of the render pass, the declaration is left to the validation
+        RemoveLayoutDeclaration(source, "num_views");
+    }
+    mHeader = string(shaderVersion) +
+              string(shaderExtensions) +
+              (multiviewActive ? string(shaderMultiview) : string("")) +
+              string(mShaderType == SHADER_TYPE_VERTEX ? shaderPrecisionVertex : shaderPrecisionFragment) +
+              string(shaderTexture2d) +
+              string(shaderTextureCube) +
+              string(shaderDrawInstanced) +
+              string(shaderShadowSamplers) +
+              (depthRangeActive ? string(shaderDepthRange) : string("")) +
+              (fetchActive ? string(shaderFramebufferFetch) : string("")) +
+              (GLOVE_USE_PRE_ROTATION && mShaderType == SHADER_TYPE_VERTEX ? string(shaderPreRotation) : string("")) +
+              string(shaderLimitsBuiltIns);
+    mHeaderLines = static_cast<uint32_t>(std::count(mHeader.begin(), mHeader.end(), '\n'));
+
+    /// rewrites happen while the source is copied, so the output only ever grows at its end
+    mOutput.clear();
+    mOutput.reserve(mHeader.size() + source.size() + source.size() / 2);
+
+    /// The header replaces #version if present
+    mHeaderPending = true;
+    if(!StartsWithVersionDirective(source)) {
+        EmitHeader();
     }
 
-    ProcessVaryings(source);
-    ProcessVertexAttributes(source, reflection);
+    ProcessSource(source, true);
+    if(mHeaderPending) {
+        EmitHeader();
+    }
 
     if(mShaderType == SHADER_TYPE_VERTEX) {
-        if(isYInverted) {
-            ConvertGLToVulkanCoordSystem(source);
-        }
-        ConvertGLToVulkanDepthRange(source);
+        ConvertGLToVulkanPosition(isYInverted);
     }
+
+    source.swap(mOutput);
+    mOutput.clear();
 }
 
 void
@@ -137,375 +325,557 @@ ShaderConverter::Initialize(shader_type_t shaderType, ESSL_VERSION version_in, E
 }
 
 void
-ShaderConverter::ProcessHeader(std::string& source, const uniformBlockMap_t &uniformBlockMap)
+ShaderConverter::ProcessSource(const string& source, bool userSource)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    /// Do not add vulkan_DepthRange declaration if gl_DepthRange is not active in the input shader
-    const bool depthRangeActive = uniformBlockMap.find(string("gl_DepthRange")) != uniformBlockMap.cend();
-    const string sourceHeader = string(shaderVersion) +
-                                string(shaderExtensions) +
-                                string(shaderPrecision) +
-                                string(shaderTexture2d) +
-                                string(shaderTextureCube) +
-                                (depthRangeActive ? string(shaderDepthRange) : string("")) +
-                                string(shaderLimitsBuiltIns);
-
-    /// If #version is present
-    size_t found = source.find("#version");
-    if(found != string::npos) {
-        size_t f1 = source.find("\n", found);
-        source.replace(found, f1 - found, sourceHeader);
-    } else {
-        source.insert(0, sourceHeader);
+    bool   lineStart = true;
+    size_t pos       = 0;
+    while(pos < source.size()) {
+        const char c = source[pos];
+
+        if(c == '/' && !source.compare(pos, 2, "//")) {
+            size_t end = source.find('\n', pos);
+            end = (end == string::npos) ? source.size() : end;
+            Emit(source, pos, end);
+            pos = end;
+        } else if(c == '/' && !source.compare(pos, 2, "/*")) {
+            size_t end = source.find("*/", pos + 2);
+            end = (end == string::npos) ? source.size() : end + 2;
+            Emit(source, pos, end);
+            pos = end;
+        } else if(c == '#' && lineStart) {
+            pos = ProcessDirective(source, pos, userSource);
+            lineStart = false;
+        } else if(IsIdentifierChar(c)) {
+            pos = ProcessIdentifier(source, pos, userSource);
+            lineStart = false;
+        } else {
+            if(c == '}') {
+                mLastBracket = mOutput.size();
+            }
+            if(c == '\n') {
+                lineStart = true;
+            } else if(!IsBlank(c)) {
+                lineStart = false;
+            }
+            EmitChar(c);
+            ++pos;
+        }
     }
 }
 
-void
-ShaderConverter::ProcessInvariantQualifier(std::string& source)
+size_t
+ShaderConverter::ProcessDirective(const string& source, size_t pos, bool userSource)
 {
-    FUN_ENTRY(GL_LOG_DEBUG);
-
-    size_t found;
-
-    const string invariantStr("invariant");
-    const string invariantVaryingStr("invariant varying");
-    found = FindToken(invariantVaryingStr, source, 0);
-    while(found != string::npos) {
-
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + invariantStr.length());
-
-        // remove 'invariant' when found before varying (in fragment shaders)
-        source.replace(f1, invariantStr.length(), "");
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        found = FindToken(invariantVaryingStr, source, found);
+    /// A directive ends with its line, unless the line is continued
+    size_t end = source.find('\n', pos);
+    while(end != string::npos) {
+        size_t last = end - 1;
+        if(source[last] == '\r') {
+            --last;
+        }
+        if(source[last] != '\\') {
+            break;
+        }
+        end = source.find('\n', end + 1);
     }
-}
-
-void
-ShaderConverter::ProcessMacros(std::string& source)
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
+    end = (end == string::npos) ? source.size() : end;
 
-    size_t found;
+    const size_t nameStart = SkipBlanks(source, pos + 1);
+    const size_t nameEnd   = ReadIdentifier(source, nameStart);
 
-    bool linedirectiveEnabled=false;
-    const string linedirective("#line");
-    found = FindToken(linedirective, source, 0);
-    if(found != string::npos) {
-        linedirectiveEnabled = true;
+    if(userSource && IsToken(source, nameStart, nameEnd, "version")) {
+        if(mHeaderPending) {
+            EmitHeader();
+        }
+        return end;
     }
 
-    const string lineStr("__LINE__");
-    found = FindToken(lineStr, source, 0);
-    while(found != string::npos) {
-
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + lineStr.length());
+    if(userSource && IsToken(source, nameStart, nameEnd, "extension")) {
+        // the header defines the extension, which is unknown to the Vulkan GLSL compiler
+        // only the directive itself is removed, its line is kept so that line numbers do not change
+        const size_t extensionStart = SkipBlanks(source, nameEnd);
+        const size_t extensionEnd   = ReadIdentifier(source, extensionStart);
+        if(IsToken(source, extensionStart, extensionEnd, "GL_EXT_draw_instanced") ||
+           IsToken(source, extensionStart, extensionEnd, "GL_EXT_shadow_samplers") ||
+           IsToken(source, extensionStart, extensionEnd, "GL_EXT_shader_framebuffer_fetch") ||
+           IsToken(source, extensionStart, extensionEnd, "GL_OVR_multiview") ||
+           IsToken(source, extensionStart, extensionEnd, "GL_OVR_multiview2")) {
+            return end;
+        }
+    }
 
-        int firstNL  = static_cast<int>(source.rfind('\n', f1));
-        int secondNL = static_cast<int>(source.rfind('#' , f1));
+    Emit(source, pos, nameEnd);
+    pos = nameEnd;
+    while(pos < end) {
+        if(!source.compare(pos, 2, "//")) {
+            Emit(source, pos, end);
+            break;
+        }
 
-        // check if is used in a define function & linedirective is not used
-        if(firstNL >= secondNL && !linedirectiveEnabled) {
-            // we have inserted 29 additional lines
-            source.replace(f1, lineStr.length(), "__LINE__ - 29");
+        if(!IsIdentifierChar(source[pos])) {
+            EmitChar(source[pos++]);
+            continue;
         }
 
-        found = FindToken(lineStr, source, found);
+        const size_t tokenEnd = ReadIdentifier(source, pos);
+        if(userSource && IsToken(source, pos, tokenEnd, "__VERSION__")) {
+            // the actual value is 100 = 400/4
+            mOutput.append("__VERSION__ / 4");
+        } else if(userSource && IsToken(source, pos, tokenEnd, "GL_ES")) {
+            // precision statements are commonly guarded by #ifdef GL_ES, they must not be skipped
+            mOutput.append("GLOVE_GL_ES");
+        } else {
+            EmitIdentifier(source, pos, tokenEnd);
+        }
+        pos = tokenEnd;
     }
 
-    const string versionStr("__VERSION__");
-    found = FindToken(versionStr, source, 0);
-    while(found != string::npos) {
+    return end;
+}
 
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + versionStr.length());
+size_t
+ShaderConverter::ProcessIdentifier(const string& source, size_t pos, bool userSource)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        // the actual value is 100 = 400/4
-        source.replace(f1, versionStr.length(), "__VERSION__ / 4");
+    const size_t end = ReadIdentifier(source, pos);
 
-        found = FindToken(versionStr, source, found);
+    if(IsToken(source, pos, end, "uniform")) {
+        return ProcessUniform(source, pos, end);
     }
 
-    const  string glStr("GL_ES");
-    found = FindToken(glStr, source, 0);
-    while(found != string::npos) {
+    if(IsToken(source, pos, end, "varying")) {
+        return ProcessVarying(source, end);
+    }
 
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + glStr.length());
+    if(mShaderType == SHADER_TYPE_VERTEX && IsToken(source, pos, end, "attribute") && mReflection->GetLiveAttributes()) {
+        return ProcessVertexAttribute(source, end);
+    }
 
-        // check if is used in a ifdef function
-        int firstNL  = static_cast<int>(source.rfind('\n', f1));
-        int secondNL = static_cast<int>(source.rfind("#ifdef" , f1));
-        if(firstNL >= secondNL) {
-            // replace with '1' value
-            source.replace(f1, glStr.length(), "1");
+    if(mShaderType == SHADER_TYPE_FRAGMENT && IsToken(source, pos, end, "invariant")) {
+        // remove 'invariant' when found before varying (in fragment shaders)
+        const size_t next = SkipSpaces(source, end);
+        if(IsToken(source, next, ReadIdentifier(source, next), "varying")) {
+            return end;
         }
+    }
 
-        found = FindToken(glStr, source, found);
+    if(userSource) {
+        if(IsToken(source, pos, end, "__LINE__")) {
+            // the lines of the header come first
+            mOutput.append(mLineDirectiveEnabled ? "__LINE__" : "__LINE__ - " + to_string(mHeaderLines));
+            return end;
+        }
+        if(IsToken(source, pos, end, "__VERSION__")) {
+            // the actual value is 100 = 400/4
+            mOutput.append("__VERSION__ / 4");
+            return end;
+        }
+        if(IsToken(source, pos, end, "GL_ES")) {
+            mOutput.push_back('1');
+            return end;
+        }
     }
+
+    EmitIdentifier(source, pos, end);
+    return end;
 }
 
-void
-ShaderConverter::ProcessUniforms(std::string& source, const uniformBlockMap_t &uniformBlockMap)
+size_t
+ShaderConverter::ProcessUniform(const string& source, size_t pos, size_t end)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    /// Start of dead uniform blocks where the active end
-    uint32_t unusedBlockBindings = static_cast<uint32_t>(uniformBlockMap.size());
-    uniformBlockMap_t::const_iterator uniBlockIt;
-    string layoutSyntax;
-    string blockSyntax;
-
-    /// Convert uniforms into uniform blocks
-    string token;
-    const string uniformLiteralStr("uniform");
-
-    size_t found = FindToken(uniformLiteralStr, source, 0);
-    while(found != string::npos) {
-        size_t firstNL = source.rfind("\n", found);
-        string commentLine = source.substr(firstNL, found - firstNL);
-        if(commentLine.find("//") != string::npos) {
-            found = FindToken(uniformLiteralStr, source, found + uniformLiteralStr.length());
-            continue;
+    string type, name;
+    size_t nameStart, nameEnd;
+    ReadDeclaration(source, end, &type, &name, &nameStart, &nameEnd);
+
+    if(!CanTypeBeInUniformBlock(type)) {
+        /// Sampler type
+        if(mBindlessSamplerCount) {
+            const size_t declarationEnd = ProcessBindlessSampler(source, type, nameStart);
+            if(declarationEnd != string::npos) {
+                return declarationEnd;
+            }
         }
 
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + uniformLiteralStr.length());
+        uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(name);
+        const uint32_t binding = (uniBlockIt != mUniformBlockMap->cend()) ? uniBlockIt->second.binding : mUnusedBlockBindings++;
+
+        mOutput.append("layout(binding = " + to_string(binding) + ") ");
+        mOutput.append(source, pos, end - pos);
+        return end;
+    }
 
-        /// Either type or precision qualifier
-        token = GetNextToken(source, found);
-        string tokenTypeStr = token;
-        string tokenPrecisionStr = "";
+    const size_t declarationEnd = source.find(';', nameEnd);
+    if(declarationEnd == string::npos) {
+        mOutput.append(source, pos, end - pos);
+        return end;
+    }
 
-        if(IsPrecisionQualifier(token)) {
-            found = SkipWhiteSpaces(source, found + token.length());
-            token = GetNextToken(source, found);
-            tokenPrecisionStr = token;
+    /// Every declarator of a multiple inline declaration gets its own block, with the type shared
+    const size_t typeStart  = SkipSpaces(source, end);
+    size_t declaratorStart  = nameStart;
+    int    depth            = 0;
+    for(size_t i = nameStart; i <= declarationEnd; ++i) {
+        const char c = source[i];
+        if(c == '[' || c == '(') {
+            ++depth;
+        } else if(c == ']' || c == ')') {
+            --depth;
+        } else if((c == ',' && depth == 0) || i == declarationEnd) {
+            EmitUniformBlock(source, typeStart, nameStart, declaratorStart, i);
+            declaratorStart = i + 1;
         }
+    }
 
-        /// Definitely type now
-        if(!CanTypeBeInUniformBlock(token)) {
-            /// Sampler type
-            found = SkipWhiteSpaces(source, found + token.length());
-            /// Variable name
-            token = GetNextToken(source, found);
-
-            uniBlockIt = uniformBlockMap.find(token);
-            if(uniBlockIt != uniformBlockMap.cend()) {
-                layoutSyntax = "layout(binding = " + to_string(uniBlockIt->second.binding) + string(") ");
-            } else {
-                layoutSyntax = "layout(binding = " + to_string(unusedBlockBindings) + string(") ");
-                ++unusedBlockBindings;
-            }
-            source.insert(f1, layoutSyntax);
+    return declarationEnd + 1;
+}
 
-            found = FindToken(uniformLiteralStr, source, found + token.length() + layoutSyntax.length());
+size_t
+ShaderConverter::ProcessBindlessSampler(const string& source, const string& type, size_t nameStart)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-            continue;
-        }
+    const size_t declarationEnd = source.find(';', nameStart);
+    if(declarationEnd == string::npos) {
+        return string::npos;
+    }
 
-        found = SkipWhiteSpaces(source, found + token.length());
+    /// the declarators are separated by the commas outside of array sizes
+    std::vector<std::pair<size_t, size_t>> declarators;
+    bool   hasBindless     = false;
+    size_t declaratorStart = nameStart;
+    int    depth           = 0;
+    for(size_t i = nameStart; i <= declarationEnd; ++i) {
+        const char c = source[i];
+        if(c == '[' || c == '(') {
+            ++depth;
+        } else if(c == ']' || c == ')') {
+            --depth;
+        } else if((c == ',' && depth == 0) || i == declarationEnd) {
+            const size_t start = SkipSpaces(source, declaratorStart);
+            uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(string(source, start, ReadIdentifier(source, start) - start));
+            hasBindless |= uniBlockIt != mUniformBlockMap->cend() && uniBlockIt->second.isBindless;
+            declarators.emplace_back(declaratorStart, i);
+            declaratorStart = i + 1;
+        }
+    }
 
-        /// Variable name
-        token = GetNextToken(source, found);
+    if(!hasBindless) {
+        return string::npos;
+    }
 
-        /// Check for multiple inline variable declaration
-        bool   multiple_declaration = false;
-        size_t f2  = source.find (",", found + token.length());
-        size_t fNL = source.find (';', found + token.length());
-        blockSyntax = string(";\n") + uniformLiteralStr + " " + tokenTypeStr + " " + tokenPrecisionStr;
-        while(f2 <= fNL) {
-            /// Move every variable on a new line
-            source.replace(found + token.length(), 1, blockSyntax);
-            found = SkipWhiteSpaces(source, found + token.length() + blockSyntax.length() + 1);
-            token = GetNextToken(source, found);
-            f2    = source.find (",", found + token.length());
+    /// the table and the indices into it are declared along with the first of the samplers, on the same line
+    if(mBindlessSamplers.empty()) {
+        mOutput.append("layout(set = " + to_string(GLOVE_BINDLESS_TEXTURE_SET) + ", binding = 0) uniform sampler2D glove_BindlessTextures2D[" +
+                       to_string(GLOVE_BINDLESS_TEXTURE_COUNT) + "]; ");
+        mOutput.append("layout(set = " + to_string(GLOVE_BINDLESS_TEXTURE_SET) + ", binding = 1) uniform samplerCube glove_BindlessTexturesCube[" +
+                       to_string(GLOVE_BINDLESS_TEXTURE_COUNT) + "]; ");
+        mOutput.append("layout(push_constant) uniform glove_BindlessTextureIndicesBlock { uint index[" + to_string(mBindlessSamplerCount) +
+                       "]; } glove_BindlessTextureIndices;");
+    }
 
-            multiple_declaration = true;
+    /// each sampler of the declaration is replaced by its element of the table wherever it is used,
+    /// the others (arrays, inactive samplers) keep declarations of their own
+    const string table = !type.compare("samplerCube") ? "glove_BindlessTexturesCube" : "glove_BindlessTextures2D";
+    for(const auto &declarator : declarators) {
+        const size_t start = SkipSpaces(source, declarator.first);
+        const string name(source, start, ReadIdentifier(source, start) - start);
+
+        uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(name);
+        if(uniBlockIt != mUniformBlockMap->cend() && uniBlockIt->second.isBindless) {
+            mBindlessSamplers[name] = table + "[glove_BindlessTextureIndices.index[" + to_string(uniBlockIt->second.binding) + "]]";
+            /// line numbers must not change
+            mOutput.append(static_cast<size_t>(std::count(source.cbegin() + declarator.first, source.cbegin() + declarator.second, '\n')), '\n');
+        } else {
+            const uint32_t binding = (uniBlockIt != mUniformBlockMap->cend()) ? uniBlockIt->second.binding : mUnusedBlockBindings++;
+            mOutput.append(" layout(binding = " + to_string(binding) + ") uniform " + type);
+            Emit(source, declarator.first, declarator.second);
+            mOutput.push_back(';');
         }
+    }
 
-        /// if yes, then goto back to the beginning
-        if(multiple_declaration) {
-            found = f1;
-            continue;
-        }
+    return declarationEnd + 1;
+}
 
-        // Rename uni* variable cases
-        const string uniStr("uni");
-        const size_t uni_count = (mShaderType == SHADER_TYPE_VERTEX) ? GLOVE_MAX_VERTEX_UNIFORM_VECTORS : GLOVE_MAX_FRAGMENT_UNIFORM_VECTORS;
-        for (size_t i = 0; i < uni_count; i++) {
-            const string uniformStr(uniStr + to_string(i));
-            if(!token.compare(uniformStr)) {
-                size_t f1 = FindToken(uniformStr, source, found);
-                while(f1 != string::npos) {
+void
+ShaderConverter::EmitUniformBlock(const string& source, size_t typeStart, size_t typeEnd, size_t declaratorStart, size_t declaratorEnd)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-                    size_t f2 = f1;
-                    f1 = SkipWhiteSpaces(source, f1 + uniformStr.length());
+    /// whitespace ahead of a following declarator is kept, so that line numbers do not change
+    const size_t nameStart = SkipSpaces(source, declaratorStart);
+    const size_t nameEnd   = ReadIdentifier(source, nameStart);
+    Emit(source, declaratorStart, nameStart);
 
-                    source.replace(f2, uniformStr.length(), uniformStr + "_");
+    string name(source, nameStart, nameEnd - nameStart);
+    string memberName(name);
 
-                    f1 = FindToken(uniformStr, source, f1);
-                }
-                break;
-            }
-        }
+    // Rename uni* variable cases
+    if(IsGeneratedBlockName(name)) {
+        mRenamedUniforms.insert(name);
+        memberName.push_back('_');
+    }
 
-        if(!token.compare(STRINGIFY_MACRO(GLOVE_VULKAN_DEPTH_RANGE))) {
-            token = std::string("gl_DepthRange");
-        }
+    if(!name.compare(STRINGIFY_MACRO(GLOVE_VULKAN_DEPTH_RANGE))) {
+        name = std::string("gl_DepthRange");
+    }
 
-        /// Construct uniform block
-        uniBlockIt = uniformBlockMap.find(token);
-        if(uniBlockIt != uniformBlockMap.cend()) {
-            const uniformBlock_t &block = uniBlockIt->second;
-            layoutSyntax = "layout(" + mMemLayoutQualifier + ", binding = " + to_string(block.binding) + string(") ");
-            source.insert(f1, layoutSyntax);
-            f1 += layoutSyntax.length();
+    /// Construct uniform block
+    uniformBlockMap_t::const_iterator uniBlockIt = mUniformBlockMap->find(name);
+    if(uniBlockIt != mUniformBlockMap->cend() && uniBlockIt->second.isSpecConstant) {
+        /// the value of the switch is given by the pipeline, the default one matches zeroed uniform data
+        const bool isBool = !source.compare(typeStart, sizeof("bool") - 1, "bool");
+        mOutput.append("layout(constant_id = " + to_string(uniBlockIt->second.binding) + string(") const "));
+        Emit(source, typeStart, typeEnd);
+        mOutput.append(memberName);
+        mOutput.append(isBool ? " = false;" : " = 0;");
+        return;
+    }
 
-            blockSyntax = block.glslName + string(" {");
-            source.insert(f1 + strlen("uniform\0") + 1, blockSyntax);
+    if(uniBlockIt != mUniformBlockMap->cend()) {
+        const uniformBlock_t &block = uniBlockIt->second;
+        if(block.isPushConstant) {
+            mOutput.append("layout(push_constant, " + mMemLayoutQualifier + string(") "));
         } else {
-            /// inactive uniform
-            layoutSyntax = "layout(" + mMemLayoutQualifier + ", binding = " + to_string(unusedBlockBindings) + string(") ");
-            source.insert(f1, layoutSyntax);
-            f1 += layoutSyntax.length();
-
-            blockSyntax = string("uni") + to_string(unusedBlockBindings) + string(" {");
-            source.insert(f1 + strlen("uniform\0") + 1, blockSyntax);
-            ++unusedBlockBindings;
+            mOutput.append("layout(" + mMemLayoutQualifier + ", binding = " + to_string(block.binding) + string(") "));
         }
+        mOutput.append("uniform " + block.glslName + string(" {"));
+    } else {
+        /// inactive uniform
+        mOutput.append("layout(" + mMemLayoutQualifier + ", binding = " + to_string(mUnusedBlockBindings) + string(") "));
+        mOutput.append("uniform uni" + to_string(mUnusedBlockBindings) + string(" {"));
+        ++mUnusedBlockBindings;
+    }
 
-        /// Close brackets and add block name
-        found = source.find(";", found);
-        blockSyntax = string("};");
-        source.insert(found + 1, blockSyntax);
+    Emit(source, typeStart, typeEnd);
+    mOutput.append(memberName);
+    Emit(source, nameEnd, declaratorEnd);
 
-        found = FindToken(uniformLiteralStr, source, found);
-    }
+    /// Close brackets
+    mOutput.append(";};");
 }
 
-void
-ShaderConverter::ProcessVaryings(std::string& source)
+size_t
+ShaderConverter::ProcessVarying(const string& source, size_t end)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    const string varyingLiteralStr("varying");
+    string type, name;
+    size_t nameStart, nameEnd;
+    ReadDeclaration(source, end, &type, &name, &nameStart, &nameEnd);
 
-    std::map<std::string, std::pair<int,bool>> varyingsLocationMap;
-    mIoMapResolver->CreateVaryingLocationMap(&varyingsLocationMap);
+    /// varyings without a counterpart become plain globals
+    auto varyingIt = mVaryingsLocationMap.find(name);
+    if(varyingIt == mVaryingsLocationMap.end()) {
+        return end;
+    }
 
-    size_t found = FindToken(varyingLiteralStr, source, 0);
-    while(found != string::npos) {
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + varyingLiteralStr.length());
+    //  Check for varying type mismatch
+    //  replace line with dummy word in order to make compilation fail.
+    //  TODO: This is a process that should be executed in the linking step! Not here.
+    if(mShaderType == SHADER_TYPE_FRAGMENT && !varyingIt->second.second) {
+        mOutput.append("xxx");
+    } else {
+        mOutput.append(string("layout(location = ") +
+                              to_string(varyingIt->second.first) +
+                              (mShaderType == SHADER_TYPE_VERTEX ? string(") out") : string(") in")));
+    }
 
-        /// Either type or precision qualifier
-        string token = GetNextToken(source, found);
-        if(IsPrecisionQualifier(token)) {
-            found = SkipWhiteSpaces(source, found + token.length());
-            token = GetNextToken(source, found);
-        }
-        /// Definitely type now
-        found = SkipWhiteSpaces(source, found + token.length());
-
-        /// Variable name
-        token = GetNextToken(source, found);
-
-        if(varyingsLocationMap.find(token) != varyingsLocationMap.end()) {
-            string layoutSyntax = string("layout(location = ") +
-                                  to_string(varyingsLocationMap[token].first) +
-                                  (mShaderType == SHADER_TYPE_VERTEX ? string(") out") : string(") in"));
-
-            //  Check for varying type mismatch
-            //  replace line with dummy word in order to make compilation fail.
-            //  TODO: This is a process that should be executed in the linking step! Not here.
-            if(mShaderType == SHADER_TYPE_FRAGMENT && !varyingsLocationMap[token].second) {
-                source.replace(f1, varyingLiteralStr.length(), "xxx");
-            } else {
-                source.replace(f1, varyingLiteralStr.length(), layoutSyntax);
-            }
-        } else {
-            source.replace(f1, varyingLiteralStr.length(), "");
+    return end;
+}
+
+size_t
+ShaderConverter::ProcessVertexAttribute(const string& source, size_t end)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    string type, name;
+    size_t nameStart, nameEnd;
+    ReadDeclaration(source, end, &type, &name, &nameStart, &nameEnd);
+
+    int location = mReflection->GetAttributeLocation(name.c_str());
+
+    std::vector<int>::iterator it = std::find(mAttributeLocations.begin(), mAttributeLocations.end(), location);
+    if(location >= 0 && it == mAttributeLocations.end()) {
+        mOutput.append(string("layout(location = ") + to_string(location) + string(") in"));
+        for(int j = 0; j < (int)OccupiedLocationsPerGlType(mReflection->GetAttributeType(name.c_str())); j++) {
+            mAttributeLocations.push_back(location + j);
         }
+    }
+
+    return end;
+}
+
+bool
+ShaderConverter::IsGeneratedBlockName(const string& name) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        found = FindToken(varyingLiteralStr, source, found);
+    /// inactive uniforms are wrapped into blocks named uni0, uni1, ...
+    if(name.size() <= 3 || name.size() > 6 || name.compare(0, 3, "uni") || name.find_first_not_of("0123456789", 3) != string::npos) {
+        return false;
     }
+
+    const size_t uni_count = (mShaderType == SHADER_TYPE_VERTEX) ? GLOVE_MAX_VERTEX_UNIFORM_VECTORS : GLOVE_MAX_FRAGMENT_UNIFORM_VECTORS;
+    return static_cast<size_t>(stoi(name.substr(3))) < uni_count;
 }
 
 void
-ShaderConverter::ProcessVertexAttributes(std::string& source, ShaderReflection* reflection)
+ShaderConverter::EmitHeader(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    std::vector<int> loc;
-
-    if(!reflection->GetLiveAttributes()) {
-        return;
-    }
-
-    /// Handle vertex attributes
-    const string attributeLiteralStr("attribute");
+    /// the header's own declarations go through the same conversion, without the macro rewrites of the user source
+    mHeaderPending = false;
+    ProcessSource(mHeader, false);
+}
 
-    size_t found = FindToken(attributeLiteralStr, source, 0);
-    while(found != string::npos) {
-        size_t f1 = found;
-        found = SkipWhiteSpaces(source, found + attributeLiteralStr.length());
+void
+ShaderConverter::Emit(const string& source, size_t start, size_t end)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        /// Either type or precision qualifier
-        string token = GetNextToken(source, found);
-        if(IsPrecisionQualifier(token)) {
-            found = SkipWhiteSpaces(source, found + token.length());
-            token = GetNextToken(source, found);
+    while(start < end) {
+        // Replace each tab with 4 spaces. It makes parsing result easy to use.
+        const size_t tab = source.find('\t', start);
+        if(tab == string::npos || tab >= end) {
+            mOutput.append(source, start, end - start);
+            return;
         }
+        mOutput.append(source, start, tab - start);
+        mOutput.append("    ");
+        start = tab + 1;
+    }
+}
 
-        /// Definitely type now
-        found = SkipWhiteSpaces(source, found + token.length());
-        /// Variable name
-        token = GetNextToken(source, found);
-
-        int location = reflection->GetAttributeLocation(token.c_str());
+void
+ShaderConverter::EmitIdentifier(const string& source, size_t start, size_t end)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        std::vector<int>::iterator it = std::find (loc.begin(), loc.end(), location);
-        if(location >=0 && it == loc.end()) {
-            string layoutSyntax = string("layout(location = ") + to_string(location) + string(") in");
-            source.replace(f1, attributeLiteralStr.length(), layoutSyntax);
-            for (int j = 0; j < (int)OccupiedLocationsPerGlType(reflection->GetAttributeType(token.c_str())); j++) {
-                loc.push_back(location + j);
-            }
-        } else {
-            source.erase(f1, attributeLiteralStr.length() + 1);
-            found = f1;
+    if(!mBindlessSamplers.empty()) {
+        auto it = mBindlessSamplers.find(string(source, start, end - start));
+        if(it != mBindlessSamplers.end()) {
+            mOutput.append(it->second);
+            return;
         }
-        found = FindToken(attributeLiteralStr, source, found);
     }
 
+    mOutput.append(source, start, end - start);
+
+    if(!mRenamedUniforms.empty() && end - start > 3 && !source.compare(start, 3, "uni") &&
+        mRenamedUniforms.find(string(source, start, end - start)) != mRenamedUniforms.end()) {
+        mOutput.push_back('_');
+    }
 }
 
 void
-ShaderConverter::ConvertGLToVulkanCoordSystem(string& source)
+ShaderConverter::ConvertGLToVulkanPosition(bool isYInverted)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // Find last "}"
-    size_t pos = source.rfind("}");
+    // Insert before the last "}"
+    if(mLastBracket == string::npos) {
+        return;
+    }
+
+    string conversion;
+    // a pre-rotated framebuffer is drawn with a viewport that is never flipped, see Framebuffer::PreRotateRect
+    if(GLOVE_USE_PRE_ROTATION) {
+        conversion.append("    if(glove_PreRotation == 1) {\n"
+                          "        gl_Position.xy = gl_Position.yx;\n"
+                          "    } else if(glove_PreRotation == 2) {\n"
+                          "        gl_Position.x = -gl_Position.x;\n"
+                          "    } else if(glove_PreRotation == 3) {\n"
+                          "        gl_Position.xy = -gl_Position.yx;\n"
+                          "    }\n");
+    }
     //If the "VK_KHR_maintenance1" is not supported, so we have to invert the y coordinates here
-    string GlToVkViewportConversion   = string("    gl_Position.y = -gl_Position.y;\n");
-    source.insert(pos, GlToVkViewportConversion);
+    if(isYInverted) {
+        conversion.append(GLOVE_USE_PRE_ROTATION ? "    if(glove_PreRotation == 0) gl_Position.y = -gl_Position.y;\n" :
+                                                   "    gl_Position.y = -gl_Position.y;\n");
+    }
+    conversion.append("    gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;\n");
+
+    mOutput.insert(mLastBracket, conversion);
 }
 
+/// Vulkan has no default uniform block, so the uniforms of a compute shader declared outside of any block, but for
+/// the opaque ones, are gathered into a push constant block at the place of the first of them. Their lines are
+/// blanked instead of removed, so that the compiler reports the lines of the source
 void
-ShaderConverter::ConvertGLToVulkanDepthRange(string& source)
+ShaderConverter::ConvertComputeUniforms(string& source)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // Find last "}"
-    size_t pos = source.rfind("}");
+    string  members;
+    size_t  blockPos  = string::npos;
+    int     depth     = 0;
+    bool    lineStart = true;
+    size_t  pos       = 0;
+    while(pos < source.size()) {
+        const char c = source[pos];
+
+        if(c == '/' && !source.compare(pos, 2, "//")) {
+            pos = source.find('\n', pos);
+            pos = (pos == string::npos) ? source.size() : pos;
+        } else if(c == '/' && !source.compare(pos, 2, "/*")) {
+            pos = source.find("*/", pos + 2);
+            pos = (pos == string::npos) ? source.size() : pos + 2;
+        } else if(c == '#' && lineStart) {
+            pos = source.find('\n', pos);
+            pos = (pos == string::npos) ? source.size() : pos;
+        } else if(IsIdentifierChar(c)) {
+            const size_t start = pos;
+            pos = ReadIdentifier(source, pos);
+            lineStart = false;
+            if(depth || !IsToken(source, start, pos, "uniform")) {
+                continue;
+            }
+
+            string type, name;
+            size_t nameStart, nameEnd;
+            ReadDeclaration(source, pos, &type, &name, &nameStart, &nameEnd);
+            const size_t end = source.find(';', pos);
+            /// blocks, which have no name after theirs, and samplers and images stay where they are
+            if(end == string::npos || name.empty() || !CanTypeBeInUniformBlock(type)) {
+                continue;
+            }
 
-    string GlToVkDepthRangeConversion = string("    gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;\n");
-    source.insert(pos, GlToVkDepthRangeConversion);
+            string member(source, pos, end + 1 - pos);
+            std::replace(member.begin(), member.end(), '\n', ' ');
+            members.append(member);
+
+            for(size_t i = start; i <= end; ++i) {
+                if(source[i] != '\n') {
+                    source[i] = ' ';
+                }
+            }
+            blockPos = (blockPos == string::npos) ? start : blockPos;
+            pos = end + 1;
+        } else {
+            depth    += (c == '{') - (c == '}');
+            lineStart = (c == '\n') || (lineStart && IsBlank(c));
+            ++pos;
+        }
+    }
+
+    if(blockPos == string::npos) {
+        return;
+    }
+
+    const string block = "layout(push_constant, std140) uniform " GLOVE_COMPUTE_UNIFORM_BLOCK_NAME " {" + members + " };";
+    size_t blockEnd = blockPos;
+    while(blockEnd < source.size() && source[blockEnd] == ' ' && blockEnd - blockPos < block.size()) {
+        ++blockEnd;
+    }
+    source.replace(blockPos, blockEnd - blockPos, block);
 }
 
 ShaderConverter::shader_conversion_type_t 
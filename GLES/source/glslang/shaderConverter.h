@@ -24,12 +24,16 @@
 #ifndef __SHADER_CONVERTER_H__
 #define __SHADER_CONVERTER_H__
 
+#include <set>
 #include "resources/shaderReflection.h"
 #include "glslang/Include/ShHandle.h"
 #include "glslangIoMapResolver.h"
 #include "utils/parser_helpers.h"
 #include "glslangUtils.h"
 
+/// Push constant block the uniforms of the default block of a compute shader are moved into
+#define GLOVE_COMPUTE_UNIFORM_BLOCK_NAME                "glove_ComputeUniforms"
+
 class ShaderConverter {
 public:
     ShaderConverter();
@@ -37,6 +41,7 @@ public:
 
            void Initialize(shader_type_t shaderType, ESSL_VERSION version_in, ESSL_VERSION version_out);
            void Convert(string& source, const uniformBlockMap_t &uniformBlockMap, ShaderReflection* reflection, bool isYInverted);
+    static void ConvertComputeUniforms(string& source);
 
 /// Set Functions
     inline void SetProgram(glslang::TProgram* slangProgram)                { FUN_ENTRY(GL_LOG_TRACE); mSlangProg     = slangProgram;  }
@@ -50,9 +55,15 @@ private:
 
     static const char * const   shaderVersion;
     static const char * const   shaderExtensions;
-    static const char * const   shaderPrecision;
+    static const char * const   shaderMultiview;
+    static const char * const   shaderPrecisionVertex;
+    static const char * const   shaderPrecisionFragment;
     static const char * const   shaderTexture2d;
     static const char * const   shaderTextureCube;
+    static const char * const   shaderDrawInstanced;
+    static const char * const   shaderShadowSamplers;
+    static const char * const   shaderFramebufferFetch;
+    static const char * const   shaderPreRotation;
     static const char * const   shaderDepthRange;
     static const char * const   shaderLimitsBuiltIns;
 
@@ -62,18 +73,43 @@ private:
     glslang::TProgram*          mSlangProg;
     GlslangIoMapResolver       *mIoMapResolver;
 
+    /// State of the conversion pass
+    const uniformBlockMap_t    *mUniformBlockMap;
+    ShaderReflection           *mReflection;
+    std::map<std::string, std::pair<int,bool>> mVaryingsLocationMap;
+    std::vector<int>            mAttributeLocations;
+    std::set<string>            mRenamedUniforms;
+    /// samplers of the bindless texture table, and the element of the table each one is replaced with
+    std::map<string, string>    mBindlessSamplers;
+    uint32_t                    mBindlessSamplerCount;
+    uint32_t                    mUnusedBlockBindings;
+    bool                        mLineDirectiveEnabled;
+    bool                        mHeaderPending;
+    string                      mHeader;
+    uint32_t                    mHeaderLines;
+    string                      mOutput;
+    size_t                      mLastBracket;           /// where the position fixes go in mOutput
+
 /// Process Functions
-    void ProcessMacros(std::string& source);
-    void ProcessHeader(string& source, const uniformBlockMap_t &uniformBlockMap);
-    void ProcessUniforms(string& source, const uniformBlockMap_t &uniformBlockMap);
-    void ProcessInvariantQualifier(std::string& source);
-    void ProcessVaryings(string& source);
-    void ProcessVertexAttributes(string& source, ShaderReflection* reflection);
+    void   ProcessSource(const string& source, bool userSource);
+    size_t ProcessDirective(const string& source, size_t pos, bool userSource);
+    size_t ProcessIdentifier(const string& source, size_t pos, bool userSource);
+    size_t ProcessUniform(const string& source, size_t pos, size_t end);
+    size_t ProcessBindlessSampler(const string& source, const string& type, size_t nameStart);
+    size_t ProcessVarying(const string& source, size_t end);
+    size_t ProcessVertexAttribute(const string& source, size_t end);
+    bool   IsGeneratedBlockName(const string& name) const;
+
+/// Emit Functions
+    void   EmitHeader(void);
+    void   EmitUniformBlock(const string& source, size_t typeStart, size_t typeEnd, size_t declaratorStart, size_t declaratorEnd);
+    void   EmitIdentifier(const string& source, size_t start, size_t end);
+    void   Emit(const string& source, size_t start, size_t end);
+    inline void EmitChar(char c)                                           { if(c == '\t') { mOutput.append("    "); } else { mOutput.push_back(c); } }
 
 /// Convert Functions
     void Convert100To400(string& source, const uniformBlockMap_t &uniformBlockMap, ShaderReflection* reflection, bool isYInverted);
-    void ConvertGLToVulkanCoordSystem(string& source);
-    void ConvertGLToVulkanDepthRange(string& source);
+    void ConvertGLToVulkanPosition(bool isYInverted);
 
     shader_conversion_type_t EsslVersionToShaderConversionType(ESSL_VERSION version_in, ESSL_VERSION version_out);
 };
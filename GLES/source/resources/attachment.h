@@ -33,6 +33,10 @@ private:
     uint32_t                mName;
     GLint                   mLevel;
     GLenum                  mLayer;
+    GLsizei                 mSamples;
+    /// consecutive faces drawn at once from mLayer on, as views (GL_OVR_multiview)
+    GLint                   mBaseViewIndex;
+    GLsizei                 mNumViews;
     Texture *               mTexture;
 
 public:
@@ -44,6 +48,9 @@ public:
     inline uint32_t         GetName(void)                               const   { FUN_ENTRY(GL_LOG_TRACE); return mName;     }
     inline GLint            GetLevel(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mLevel;    }
     inline GLenum           GetLayer(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mLayer;    }
+    inline GLsizei          GetSamples(void)                            const   { FUN_ENTRY(GL_LOG_TRACE); return mSamples;  }
+    inline GLint            GetBaseViewIndex(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mBaseViewIndex; }
+    inline GLsizei          GetNumViews(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mNumViews; }
     inline Texture *        GetTexture(void)                            const   { FUN_ENTRY(GL_LOG_TRACE); return mTexture;  }
 
 // Set Functions
@@ -51,6 +58,8 @@ public:
     inline void             SetName(uint32_t name)                              { FUN_ENTRY(GL_LOG_TRACE); mName    = name;  }
     inline void             SetLevel(GLint level)                               { FUN_ENTRY(GL_LOG_TRACE); mLevel   = level; }
     inline void             SetLayer(GLenum layer)                              { FUN_ENTRY(GL_LOG_TRACE); mLayer   = layer; }
+    inline void             SetSamples(GLsizei samples)                         { FUN_ENTRY(GL_LOG_TRACE); mSamples = samples; }
+    inline void             SetViews(GLint baseViewIndex, GLsizei numViews)     { FUN_ENTRY(GL_LOG_TRACE); mBaseViewIndex = baseViewIndex; mNumViews = numViews; }
     inline void             SetTexture(Texture *tex)                            { FUN_ENTRY(GL_LOG_TRACE); mTexture = tex;   }
 };
 
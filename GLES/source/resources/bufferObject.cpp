@@ -27,10 +27,31 @@
  *
  */
 
+#include <algorithm>
 #include "bufferObject.h"
+#include "context/context.h"
+#include "utils/glUtils.h"
+
+/// Usage flags of GL buffers, which are copied into and out of on the upload queue
+#define GLOVE_GL_BUFFER_TRANSFER_FLAGS                  (VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+
+/// Number of orphaned backings, no longer used by any frame in flight, that a buffer keeps for reuse
+#define GLOVE_MAX_IDLE_BUFFER_BACKINGS                  4
+
+/// Number of index ranges a buffer remembers before they are recomputed
+#define GLOVE_MAX_CACHED_INDEX_RANGES                   64
+
+/// Number of widened copies of byte index ranges a buffer keeps before they are recreated
+#define GLOVE_MAX_CACHED_INDEX_CONVERSIONS              16
+
+/// Number of converted copies of vertex attributes a buffer keeps before they are recreated
+#define GLOVE_MAX_CACHED_VERTEX_CONVERSIONS             8
 
 BufferObject::BufferObject(const vulkanAPI::vkContext_t *vkContext, const VkBufferUsageFlags vkBufferUsageFlags, const VkSharingMode vkSharingMode, const VkFlags vkFlags)
-: mVkContext(vkContext), mUsage(GL_STATIC_DRAW), mTarget(GL_INVALID_VALUE), mAllocated(false)
+: mVkContext(vkContext), mCacheManager(nullptr), mUsage(GL_STATIC_DRAW), mTarget(GL_INVALID_VALUE), mAllocated(false),
+  mIndexBuffer((vkBufferUsageFlags & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) != 0),
+  mDeviceLocal(false), mShadowData(nullptr), mUsed(false), mUploadBatchId(0), mDeviceWritten(false),
+  mIdleReadbackStaging(nullptr), mMapAccess(0), mMapOffset(0), mMapLength(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -42,18 +63,90 @@ BufferObject::~BufferObject()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    Release();
+
+    delete mIdleReadbackStaging;
     delete mBuffer;
     delete mMemory;
 }
 
+void
+BufferObject::WaitVkUploads(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the buffer may still be referred to by a pending upload batch
+    if(!mDeviceLocal || !GetCurrentContext()) {
+        return;
+    }
+
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    if(uploadManager) {
+        uploadManager->WaitVkUploadBatch(mUploadBatchId);
+    }
+}
+
+void
+BufferObject::RetireBacking(Backing_t *backing)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // backings still referred to by frames in flight are handed over to a shell
+    // object that the cache manager releases along with the current frame
+    Context *context = GetCurrentContext();
+    if(mCacheManager && context && backing->serial > context->GetVkCommandBufferManager()->UpdateCompletedSerial()) {
+        BufferObject *retired = new BufferObject(mVkContext);
+        delete retired->mBuffer;
+        delete retired->mMemory;
+        retired->mBuffer        = backing->buffer;
+        retired->mMemory        = backing->memory;
+        retired->mDeviceLocal   = true;
+        retired->mUploadBatchId = mUploadBatchId;
+        mCacheManager->CacheVBO(retired);
+    } else {
+        WaitVkUploads();
+        delete backing->buffer;
+        delete backing->memory;
+    }
+
+    backing->buffer = nullptr;
+    backing->memory = nullptr;
+}
+
 void
 BufferObject::Release()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mBuffer->Release();
-    mMemory->Release();
-    mAllocated = false;
+    Context *context = GetCurrentContext();
+    if(mDeviceLocal && mUsed && context) {
+        Backing_t backing = {mBuffer, mMemory, context->GetVkCommandBufferManager()->GetSubmitSerial()};
+        mBuffer = new vulkanAPI::Buffer(mVkContext, backing.buffer->GetFlags(), VK_SHARING_MODE_EXCLUSIVE);
+        mMemory = new vulkanAPI::Memory(mVkContext, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        RetireBacking(&backing);
+    } else {
+        if(mBuffer->GetVkBuffer() != VK_NULL_HANDLE) {
+            WaitVkUploads();
+        }
+        mBuffer->Release();
+        mMemory->Release();
+    }
+
+    for(auto &backing : mOrphanedBackings) {
+        RetireBacking(&backing);
+    }
+    mOrphanedBackings.clear();
+    DiscardReadbacks();
+
+    mAllocated     = false;
+    mUsed          = false;
+    mDeviceWritten = false;
+    mMapAccess     = 0;
+    mFlushedRanges.clear();
+    InvalidateContentCaches();
+
+    delete[] mShadowData;
+    mShadowData = nullptr;
 }
 
 bool
@@ -62,29 +155,660 @@ BufferObject::Allocate(size_t size, const void *data)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mBuffer->SetSize(size);
+    InvalidateContentCaches();
 
+    if(!mDeviceLocal) {
+        mAllocated = mBuffer->Create()                                            &&
+                     mMemory->GetBufferMemoryRequirements(mBuffer->GetVkBuffer()) &&
+                     mMemory->Create()                                            &&
+                     mMemory->SetData(size, 0, data)                              &&
+                     mMemory->BindBufferMemory(mBuffer->GetVkBuffer());
+        return mAllocated;
+    }
+
+    SetVkMemoryPolicy(mMemory);
     mAllocated = mBuffer->Create()                                            &&
                  mMemory->GetBufferMemoryRequirements(mBuffer->GetVkBuffer()) &&
                  mMemory->Create()                                            &&
-                 mMemory->SetData(size, 0, data)                              &&
                  mMemory->BindBufferMemory(mBuffer->GetVkBuffer());
+    if(!mAllocated) {
+        return false;
+    }
+
+    delete[] mShadowData;
+    mShadowData    = new uint8_t[size];
+    mUsed          = false;
+    mDeviceWritten = false;
+
+    if(!data) {
+        memset(mShadowData, 0, size);
+        return true;
+    }
+
+    memcpy(mShadowData, data, size);
+    mAllocated = StageData(size, 0, data);
+
     return mAllocated;
 }
 
+bool
+BufferObject::Respecify(size_t size, const void *data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mDeviceLocal || !mAllocated || size != GetSize()) {
+        Release();
+        return Allocate(size, data);
+    }
+
+    // the previous contents may still be read by frames in flight
+    if(mUsed && !OrphanVkBuffer()) {
+        return false;
+    }
+    InvalidateContentCaches();
+    DiscardReadbacks();
+    mDeviceWritten = false;
+    mMapAccess     = 0;
+    mFlushedRanges.clear();
+
+    if(!data) {
+        memset(mShadowData, 0, size);
+        return true;
+    }
+
+    memcpy(mShadowData, data, size);
+
+    return StageData(size, 0, data);
+}
+
+void
+BufferObject::SetVkMemoryPolicy(vulkanAPI::Memory *memory) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // static contents are only ever read by the device, while contents respecified or updated over
+    // and over are written in place when device local memory is host visible as well (UMA or BAR)
+    memory->SetPreferredFlags(mUsage == GL_STATIC_DRAW ? 0 : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+bool
+BufferObject::StageData(size_t size, size_t offset, const void *data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!size) {
+        return true;
+    }
+
+    // host visible backings are written in place, the upload queue never refers to them
+    if(mMemory->IsHostVisible()) {
+        return mMemory->SetData(size, offset, data);
+    }
+
+    // the staging space is owned by the upload batch and recycled once it retires
+    assert(GetCurrentContext());
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    VkDeviceSize stagingOffset = 0;
+    VkBuffer stagingBuffer = uploadManager->AllocateStagingBuffer(size, data, 1, &stagingOffset);
+    if(stagingBuffer == VK_NULL_HANDLE ||
+       !uploadManager->CopyBuffer(stagingBuffer, stagingOffset, mBuffer->GetVkBuffer(), offset, size)) {
+        return false;
+    }
+
+    mUploadBatchId = uploadManager->GetActiveBatchId();
+
+    return true;
+}
+
+bool
+BufferObject::OrphanVkBuffer(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(GetCurrentContext());
+    vulkanAPI::CommandBufferManager *commandBufferManager = GetCurrentContext()->GetVkCommandBufferManager();
+    const uint64_t completedSerial = commandBufferManager->UpdateCompletedSerial();
+
+    // orphans are queued in submission order and all share the size and usage of the buffer
+    Backing_t orphan = {mBuffer, mMemory, commandBufferManager->GetSubmitSerial()};
+
+    if(!mOrphanedBackings.empty() && mOrphanedBackings.front().serial <= completedSerial) {
+        mBuffer = mOrphanedBackings.front().buffer;
+        mMemory = mOrphanedBackings.front().memory;
+        mOrphanedBackings.pop_front();
+    } else {
+        mBuffer = new vulkanAPI::Buffer(mVkContext, orphan.buffer->GetFlags(), VK_SHARING_MODE_EXCLUSIVE);
+        mMemory = new vulkanAPI::Memory(mVkContext, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        mBuffer->SetSize(orphan.buffer->GetSize());
+        SetVkMemoryPolicy(mMemory);
+
+        if(!mBuffer->Create()                                            ||
+           !mMemory->GetBufferMemoryRequirements(mBuffer->GetVkBuffer()) ||
+           !mMemory->Create()                                            ||
+           !mMemory->BindBufferMemory(mBuffer->GetVkBuffer())) {
+            delete mBuffer;
+            delete mMemory;
+            mBuffer = orphan.buffer;
+            mMemory = orphan.memory;
+            return false;
+        }
+    }
+
+    mOrphanedBackings.push_back(orphan);
+    mUsed = false;
+
+    // only a few idle backings are kept around for the next respecification
+    uint32_t idleBackings = 0;
+    while(idleBackings < mOrphanedBackings.size() && mOrphanedBackings[idleBackings].serial <= completedSerial) {
+        ++idleBackings;
+    }
+    while(idleBackings-- > GLOVE_MAX_IDLE_BUFFER_BACKINGS) {
+        RetireBacking(&mOrphanedBackings.front());
+        mOrphanedBackings.pop_front();
+    }
+
+    return true;
+}
+
 bool
 BufferObject::GetData(size_t size, size_t offset, void *data) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mDeviceLocal) {
+        if(!mShadowData) {
+            return false;
+        }
+        memcpy(data, mShadowData + offset, size);
+        return true;
+    }
+
     return mMemory->GetData(size, offset, data);
 }
 
+bool
+BufferObject::GetIndexRange(size_t offset, uint32_t count, GLenum type, bool primitiveRestart, uint32_t *minIndex, uint32_t *maxIndex)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const INDEX_SCAN_KEY key(offset, count, type, primitiveRestart);
+    auto it = mIndexRangeCache.find(key);
+    if(it != mIndexRangeCache.end()) {
+        *minIndex = it->second.minIndex;
+        *maxIndex = it->second.maxIndex;
+        return true;
+    }
+
+    const size_t size = count * (type == GL_UNSIGNED_INT   ? sizeof(GLuint)   :
+                                 type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLubyte));
+    if(offset + size > GetSize()) {
+        return false;
+    }
+
+    // device local buffers are scanned in their host copy, without any readback
+    if(mDeviceLocal) {
+        if(!mShadowData) {
+            return false;
+        }
+        GlIndexRange(mShadowData + offset, count, type, primitiveRestart, minIndex, maxIndex);
+    } else {
+        uint8_t *srcData = new uint8_t[size];
+        bool res = GetData(size, offset, srcData);
+        if(res) {
+            GlIndexRange(srcData, count, type, primitiveRestart, minIndex, maxIndex);
+        }
+        delete[] srcData;
+
+        if(!res) {
+            return false;
+        }
+    }
+
+    if(mIndexRangeCache.size() >= GLOVE_MAX_CACHED_INDEX_RANGES) {
+        mIndexRangeCache.clear();
+    }
+    IndexRange_t range = {*minIndex, *maxIndex};
+    mIndexRangeCache[key] = range;
+
+    return true;
+}
+
+void
+BufferObject::InvalidateContentCaches(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mIndexRangeCache.clear();
+
+    // converted copies may still be read by the frame being recorded
+    for(auto &conversion : mConvertedIndexBuffers) {
+        if(mCacheManager) {
+            mCacheManager->CacheVBO(conversion.second);
+        } else {
+            delete conversion.second;
+        }
+    }
+    mConvertedIndexBuffers.clear();
+
+    for(auto &conversion : mTriangleListIndexBuffers) {
+        if(mCacheManager) {
+            mCacheManager->CacheVBO(conversion.second);
+        } else {
+            delete conversion.second;
+        }
+    }
+    mTriangleListIndexBuffers.clear();
+
+    for(auto &conversion : mConvertedVertexBuffers) {
+        if(mCacheManager) {
+            mCacheManager->CacheVBO(conversion.second);
+        } else {
+            delete conversion.second;
+        }
+    }
+    mConvertedVertexBuffers.clear();
+}
+
+BufferObject *
+BufferObject::GetUint16IndexBuffer(size_t offset, uint32_t count, bool primitiveRestart)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const CONVERSION_KEY key(offset, count, primitiveRestart);
+    auto it = mConvertedIndexBuffers.find(key);
+    if(it != mConvertedIndexBuffers.end()) {
+        return it->second;
+    }
+
+    if(offset + count > GetSize()) {
+        return nullptr;
+    }
+
+    uint8_t  *srcData = new uint8_t[count];
+    uint16_t *dstData = new uint16_t[count];
+
+    bool res = GetData(count, offset, srcData);
+    if(res) {
+        std::copy(srcData, srcData + count, dstData);
+        // the restart index is the highest of its type, in the copy as well
+        if(primitiveRestart) {
+            std::replace(dstData, dstData + count, static_cast<uint16_t>(UINT8_MAX), static_cast<uint16_t>(UINT16_MAX));
+        }
+    }
+
+    BufferObject *ibo = nullptr;
+    if(res) {
+        ibo = new IndexBufferObject(mVkContext);
+        if(!ibo->Allocate(count * sizeof(uint16_t), dstData)) {
+            delete ibo;
+            ibo = nullptr;
+        }
+    }
+
+    delete[] srcData;
+    delete[] dstData;
+
+    if(!ibo) {
+        return nullptr;
+    }
+
+    if(mConvertedIndexBuffers.size() >= GLOVE_MAX_CACHED_INDEX_CONVERSIONS) {
+        InvalidateContentCaches();
+    }
+    mConvertedIndexBuffers[key] = ibo;
+
+    return ibo;
+}
+
+BufferObject *
+BufferObject::GetTriangleListIndexBuffer(size_t offset, uint32_t count, GLenum type, GLenum dstType)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const INDEX_RANGE_KEY key(offset, count, type);
+    auto it = mTriangleListIndexBuffers.find(key);
+    if(it != mTriangleListIndexBuffers.end()) {
+        return it->second;
+    }
+
+    const uint32_t dstCount = GlTriangleFanToListCount(count);
+    const size_t   srcSize  = count    * (type    == GL_UNSIGNED_INT   ? sizeof(GLuint)   :
+                                          type    == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLubyte));
+    const size_t   dstSize  = dstCount * (dstType == GL_UNSIGNED_INT   ? sizeof(GLuint)   :
+                                          dstType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLubyte));
+    if(offset + srcSize > GetSize() || !dstCount) {
+        return nullptr;
+    }
+
+    uint8_t *srcData = new uint8_t[srcSize];
+    uint8_t *dstData = new uint8_t[dstSize];
+
+    bool res = GetData(srcSize, offset, srcData);
+    if(res) {
+        GlTriangleFanToList(srcData, count, type, dstData, dstType);
+    }
+
+    BufferObject *ibo = nullptr;
+    if(res) {
+        ibo = new IndexBufferObject(mVkContext);
+        if(!ibo->Allocate(dstSize, dstData)) {
+            delete ibo;
+            ibo = nullptr;
+        }
+    }
+
+    delete[] srcData;
+    delete[] dstData;
+
+    if(!ibo) {
+        return nullptr;
+    }
+
+    if(mTriangleListIndexBuffers.size() >= GLOVE_MAX_CACHED_INDEX_CONVERSIONS) {
+        InvalidateContentCaches();
+    }
+    mTriangleListIndexBuffers[key] = ibo;
+
+    return ibo;
+}
+
+BufferObject *
+BufferObject::GetConvertedVertexBuffer(const VERTEX_CONVERSION_KEY &key) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    auto it = mConvertedVertexBuffers.find(key);
+    return it != mConvertedVertexBuffers.end() ? it->second : nullptr;
+}
+
+void
+BufferObject::SetConvertedVertexBuffer(const VERTEX_CONVERSION_KEY &key, BufferObject *vbo)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // kept until the contents change, like the converted index copies
+    if(mConvertedVertexBuffers.size() >= GLOVE_MAX_CACHED_VERTEX_CONVERSIONS) {
+        InvalidateContentCaches();
+    }
+    mConvertedVertexBuffers[key] = vbo;
+}
+
 void
 BufferObject::UpdateData(size_t size, size_t offset, const void *data)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mMemory->UpdateData(size, offset, data);
+    InvalidateContentCaches();
+
+    if(!mDeviceLocal) {
+        mMemory->UpdateData(size, offset, data);
+        return;
+    }
+
+    if(!size) {
+        return;
+    }
+
+    memcpy(mShadowData + offset, data, size);
+    CommitShadowData(size, offset);
+}
+
+void
+BufferObject::CommitShadowData(size_t size, size_t offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // draws recorded earlier must keep reading the old contents, and copies on
+    // the upload queue execute ahead of them, so such buffers are renamed first,
+    // unless the application has mapped it unsynchronized and vouches for them
+    if(mUsed && !(mMapAccess & GL_MAP_UNSYNCHRONIZED_BIT_EXT)) {
+        VkBuffer oldBuffer = mBuffer->GetVkBuffer();
+        if(!OrphanVkBuffer()) {
+            return;
+        }
+
+        // carry the old contents over on the GPU, after any upload still pending on them,
+        // unless the new backing is written in place, which it is with the whole host copy
+        if(size != GetSize() && mMemory->IsHostVisible()) {
+            size   = GetSize();
+            offset = 0;
+        } else if(size != GetSize()) {
+            assert(GetCurrentContext());
+            vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+            uploadManager->CopyBuffer(oldBuffer, 0, mBuffer->GetVkBuffer(), 0, GetSize());
+        }
+    }
+
+    StageData(size, offset, mShadowData + offset);
+}
+
+void
+BufferObject::RetireReadbackStaging(BufferObject *staging, uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the copy into the staging buffer may still be executing,
+    // otherwise the largest one is kept for the next readback
+    Context *context = GetCurrentContext();
+    if(mCacheManager && context && serial > context->GetVkCommandBufferManager()->UpdateCompletedSerial()) {
+        mCacheManager->CacheVBO(staging);
+    } else if(!mIdleReadbackStaging || mIdleReadbackStaging->GetSize() < staging->GetSize()) {
+        delete mIdleReadbackStaging;
+        mIdleReadbackStaging = staging;
+    } else {
+        delete staging;
+    }
+}
+
+void
+BufferObject::DiscardReadbacks(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(auto &readback : mPendingReadbacks) {
+        RetireReadbackStaging(readback.staging, readback.serial);
+    }
+    mPendingReadbacks.clear();
+}
+
+VkBuffer
+BufferObject::QueueReadback(const ImageRect *srcRect, GLenum srcFormat,
+                            const ImageRect *dstRect, GLenum dstFormat,
+                            bool invertY, size_t offset, uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mDeviceLocal || !mShadowData || offset + dstRect->GetRectBufferSize() > GetSize()) {
+        return VK_NULL_HANDLE;
+    }
+
+    // the texels land in host visible memory as they are stored in the image
+    const size_t stagingSize = srcRect->GetRectBufferSize();
+    BufferObject *staging = nullptr;
+    if(mIdleReadbackStaging && mIdleReadbackStaging->GetSize() >= stagingSize) {
+        staging = mIdleReadbackStaging;
+    } else {
+        delete mIdleReadbackStaging;
+        staging = new TransferDstBufferObject(mVkContext);
+        if(!staging->Allocate(stagingSize, nullptr)) {
+            delete staging;
+            staging = nullptr;
+        }
+    }
+    mIdleReadbackStaging = nullptr;
+
+    if(!staging) {
+        return VK_NULL_HANDLE;
+    }
+
+    Readback_t readback = {staging, *srcRect, *dstRect, srcFormat, dstFormat, invertY, offset, serial, false};
+    mPendingReadbacks.push_back(readback);
+
+    return staging->GetVkBuffer();
+}
+
+VkBuffer
+BufferObject::QueueDeviceReadback(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mDeviceLocal || !mShadowData) {
+        return VK_NULL_HANDLE;
+    }
+
+    // the contents are copied as they are, into a staging buffer of the size of the buffer
+    const size_t stagingSize = GetSize();
+    BufferObject *staging = nullptr;
+    if(mIdleReadbackStaging && mIdleReadbackStaging->GetSize() >= stagingSize) {
+        staging = mIdleReadbackStaging;
+    } else {
+        delete mIdleReadbackStaging;
+        staging = new TransferDstBufferObject(mVkContext);
+        if(!staging->Allocate(stagingSize, nullptr)) {
+            delete staging;
+            staging = nullptr;
+        }
+    }
+    mIdleReadbackStaging = nullptr;
+
+    if(!staging) {
+        return VK_NULL_HANDLE;
+    }
+
+    Readback_t readback = {staging, ImageRect(), ImageRect(), GL_NONE, GL_NONE, false, 0, serial, true};
+    mPendingReadbacks.push_back(readback);
+
+    return staging->GetVkBuffer();
+}
+
+bool
+BufferObject::ResolveReadbacks(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the copies have completed, their texels are converted
+    // and flipped into the host copy only now that it is read
+    bool res = true;
+    for(auto &readback : mPendingReadbacks) {
+        // what compute shaders have written is already in the buffer, only its host copy lags behind
+        if(readback.raw) {
+            if(readback.staging->GetData(GetSize(), 0, mShadowData)) {
+                mDeviceWritten = false;
+            } else {
+                res = false;
+            }
+            RetireReadbackStaging(readback.staging, 0);
+            continue;
+        }
+
+        const size_t srcSize = readback.srcRect.GetRectBufferSize();
+        uint8_t *srcData = new uint8_t[srcSize];
+
+        if(readback.staging->GetData(srcSize, 0, srcData)) {
+            ImageRect srcRect = readback.srcRect;
+            ImageRect dstRect = readback.dstRect;
+            srcRect.x = 0; srcRect.y = 0;
+            dstRect.x = 0; dstRect.y = 0;
+
+            uint8_t *dstData = mShadowData + readback.offset;
+            ConvertPixels(readback.srcFormat, readback.dstFormat,
+                          &srcRect, srcData,
+                          &dstRect, dstData);
+            if(readback.invertY) {
+                InvertImageYAxis(dstData, &dstRect);
+            }
+            CommitShadowData(dstRect.GetRectBufferSize(), readback.offset);
+        } else {
+            res = false;
+        }
+
+        delete[] srcData;
+        RetireReadbackStaging(readback.staging, 0);
+    }
+    mPendingReadbacks.clear();
+    InvalidateContentCaches();
+
+    return res;
+}
+
+void *
+BufferObject::Map(size_t offset, size_t length, GLbitfield access)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // GL buffers are mapped through their host copy, which is written back on unmap or flush
+    if(!mDeviceLocal || !mShadowData) {
+        return nullptr;
+    }
+
+    // the previous contents are not needed, so that draws still reading them keep
+    // the backing they refer to and nothing is carried over to the new one
+    const bool invalidate = (access & GL_MAP_INVALIDATE_BUFFER_BIT_EXT) ||
+                            ((access & GL_MAP_INVALIDATE_RANGE_BIT_EXT) && !offset && length == GetSize());
+    if(invalidate && mUsed && !(access & GL_MAP_UNSYNCHRONIZED_BIT_EXT) && !OrphanVkBuffer()) {
+        return nullptr;
+    }
+
+    mMapAccess = access;
+    mMapOffset = offset;
+    mMapLength = length;
+    mFlushedRanges.clear();
+
+    return mShadowData + offset;
+}
+
+void
+BufferObject::FlushMappedRange(size_t offset, size_t length)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!length) {
+        return;
+    }
+
+    // mapped buffers may not be read by draws, so the flushed ranges only need to reach the buffer on unmap
+    if(mMapAccess & GL_MAP_FLUSH_EXPLICIT_BIT_EXT) {
+        MapRange_t range = {mMapOffset + offset, length};
+        mFlushedRanges.push_back(range);
+        return;
+    }
+
+    InvalidateContentCaches();
+    CommitShadowData(length, mMapOffset + offset);
+}
+
+void
+BufferObject::Unmap(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if((mMapAccess & GL_MAP_WRITE_BIT_EXT) && !(mMapAccess & GL_MAP_FLUSH_EXPLICIT_BIT_EXT)) {
+        FlushMappedRange(0, mMapLength);
+    }
+
+    // overlapping and adjacent flushes are merged, each merged range is staged once
+    if(!mFlushedRanges.empty()) {
+        std::sort(mFlushedRanges.begin(), mFlushedRanges.end(),
+                  [](const MapRange_t &a, const MapRange_t &b) { return a.offset < b.offset; });
+
+        InvalidateContentCaches();
+        MapRange_t merged = mFlushedRanges.front();
+        for(size_t i = 1; i < mFlushedRanges.size(); ++i) {
+            const MapRange_t &range = mFlushedRanges[i];
+            if(range.offset <= merged.offset + merged.length) {
+                merged.length = std::max(merged.length, range.offset + range.length - merged.offset);
+            } else {
+                CommitShadowData(merged.length, merged.offset);
+                merged = range;
+            }
+        }
+        CommitShadowData(merged.length, merged.offset);
+        mFlushedRanges.clear();
+    }
+
+    mMapAccess = 0;
+    mMapOffset = 0;
+    mMapLength = 0;
 }
 
 void
@@ -92,24 +816,26 @@ BufferObject::SetTarget(GLenum target)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // realloc with combined flags in case GL specifies at a later state that an
-    // already allocated, e.g., vertex buffer is also an index buffer and vice-versa
-    if(mTarget != target && mTarget != GL_INVALID_VALUE) {
-        VkBufferUsageFlags combinedBuffers =
-                static_cast<VkBufferUsageFlags>(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
-        if(mBuffer->GetFlags() != combinedBuffers && mAllocated == true) {
-            size_t size = mBuffer->GetSize();
-            uint8_t *srcData = new uint8_t[size];
-            this->GetData(size, 0, srcData);
-            this->Release();
-            mBuffer->SetFlags(combinedBuffers);
-            this->Allocate(size, srcData);
-            delete[] srcData;
-        }
-    } else if(target == GL_ARRAY_BUFFER) {
-        mBuffer->SetFlags(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
-    } else if(target == GL_ELEMENT_ARRAY_BUFFER) {
-        mBuffer->SetFlags(VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    // GL buffers are only ever bound to these targets and are kept in device local memory.
+    // They are created with combined flags up front, as GL may specify at a later state that
+    // an already allocated, e.g., vertex buffer is also an index buffer and vice-versa
+    if((target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER || target == GL_PIXEL_PACK_BUFFER_NV || target == GL_PIXEL_UNPACK_BUFFER_NV ||
+        target == GL_DRAW_INDIRECT_BUFFER || target == GL_SHADER_STORAGE_BUFFER || target == GL_UNIFORM_BUFFER || target == GL_TRANSFORM_FEEDBACK_BUFFER) && !mDeviceLocal) {
+        VkBufferUsageFlags flags = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | GLOVE_GL_BUFFER_TRANSFER_FLAGS;
+#ifdef VK_EXT_transform_feedback
+        if(mVkContext && mVkContext->mIsTransformFeedbackSupported) {
+            flags |= VK_BUFFER_USAGE_TRANSFORM_FEEDBACK_BUFFER_BIT_EXT;
+        }
+#endif // VK_EXT_transform_feedback
+
+        mDeviceLocal = true;
+        mMemory->SetFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        mBuffer->SetFlags(flags);
+    }
+
+    if(target == GL_ELEMENT_ARRAY_BUFFER) {
+        mIndexBuffer = true;
     }
     mTarget = target;
 }
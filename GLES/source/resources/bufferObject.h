@@ -24,25 +24,115 @@
 #ifndef __BUFFEROBJECT_H__
 #define __BUFFEROBJECT_H__
 
+#include <deque>
+#include <map>
+#include <tuple>
+#include <vector>
 #include "GLES2/gl2.h"
 #include "GLES2/gl2ext.h"
+#include "GLES2/gl2ext_glove.h"
 #include "vulkan/buffer.h"
 #include "vulkan/memory.h"
 #include "refObject.h"
+#include "utils/arrays.hpp"
+#include "rect.h"
+
+class CacheManager;
+
+class BufferObject : public refObject, public ArrayObject {
+public:
+    /// (offset, stride, format) of the attribute a vertex buffer copy has been converted from
+    typedef std::tuple<size_t, GLsizei, uint32_t> VERTEX_CONVERSION_KEY;
 
-class BufferObject : public refObject {
 private:
+    typedef struct Backing_t {
+        vulkanAPI::Buffer*  buffer;
+        vulkanAPI::Memory*  memory;
+        uint64_t            serial;                                 // draw submission that last may refer to it
+    } Backing_t;
+
+    typedef struct Readback_t {
+        BufferObject*       staging;                                // texels as copied out of the image
+        ImageRect           srcRect;
+        ImageRect           dstRect;
+        GLenum              srcFormat;
+        GLenum              dstFormat;
+        bool                invertY;
+        size_t              offset;
+        uint64_t            serial;                                 // draw submission the copy is recorded in
+        bool                raw;                                    // the whole buffer as the device has written it
+    } Readback_t;
+
+    typedef struct MapRange_t {
+        size_t              offset;
+        size_t              length;
+    } MapRange_t;
+
+    typedef struct IndexRange_t {
+        uint32_t            minIndex;
+        uint32_t            maxIndex;
+    } IndexRange_t;
+
+    typedef std::tuple<size_t, uint32_t, GLenum> INDEX_RANGE_KEY;
+    typedef std::tuple<size_t, uint32_t, GLenum, bool> INDEX_SCAN_KEY;
+    typedef std::tuple<size_t, uint32_t, bool>   CONVERSION_KEY;
+
     const
     vulkanAPI::vkContext_t* mVkContext;
+    CacheManager*           mCacheManager;
 
     GLenum                  mUsage;
     GLenum                  mTarget;
     bool                    mAllocated;
-
-    vulkanAPI::Memory*      mMemory;
+    bool                    mIndexBuffer;
+
+    /// GL buffers live in device local memory, filled through the staging ring,
+    /// with a copy of their contents kept on the host for reading them back
+    bool                    mDeviceLocal;
+    uint8_t*                mShadowData;
+    bool                    mUsed;
+    uint64_t                mUploadBatchId;
+    /// compute shaders have written the buffer since its host copy was, which is read back only once it is read
+    bool                    mDeviceWritten;
+
+    /// backings replaced while frames in flight may still read them, oldest first
+    std::deque<Backing_t>   mOrphanedBackings;
+
+    /// index ranges found for (offset, count, type, restart), valid until the contents change
+    std::map<INDEX_SCAN_KEY, IndexRange_t> mIndexRangeCache;
+
+    /// uint16 copies of byte index ranges for (offset, count, restart), for devices without uint8 indices
+    std::map<CONVERSION_KEY, BufferObject *> mConvertedIndexBuffers;
+
+    /// triangle lists of fans for (offset, count, type), for devices without triangle fans
+    std::map<INDEX_RANGE_KEY, BufferObject *> mTriangleListIndexBuffers;
+
+    /// copies of vertex attributes in layouts the device reads, see GenericVertexAttribute
+    std::map<VERTEX_CONVERSION_KEY, BufferObject *> mConvertedVertexBuffers;
+
+    /// framebuffer copies recorded into the frame, converted into the host copy once it is read
+    std::vector<Readback_t> mPendingReadbacks;
+    BufferObject*           mIdleReadbackStaging;
+
+    /// range of the host copy handed out to the application, see GL_EXT_map_buffer_range
+    GLbitfield              mMapAccess;
+    size_t                  mMapOffset;
+    size_t                  mMapLength;
+    /// ranges of the mapping flushed explicitly, written back together on unmap
+    std::vector<MapRange_t> mFlushedRanges;
+
+    void                    SetVkMemoryPolicy(vulkanAPI::Memory *memory) const;
+    bool                    StageData(size_t size, size_t offset, const void *data);
+    bool                    OrphanVkBuffer(void);
+    void                    RetireBacking(Backing_t *backing);
+    void                    WaitVkUploads(void);
+    void                    InvalidateContentCaches(void);
+    void                    CommitShadowData(size_t size, size_t offset);
+    void                    RetireReadbackStaging(BufferObject *staging, uint64_t serial);
 
 protected:
     vulkanAPI::Buffer*      mBuffer;
+    vulkanAPI::Memory*      mMemory;
 
 public:
     explicit                BufferObject(const vulkanAPI::vkContext_t *vkContext          = nullptr,
@@ -56,27 +146,57 @@ public:
 
 // Release Functions
     void                    Release(void);
+    void                    DiscardReadbacks(void);
 
 // Update Functions
     void                    UpdateData(size_t size, size_t offset, const void *data);
+    bool                    Respecify(size_t size, const void *data);
+    VkBuffer                QueueReadback(const ImageRect *srcRect, GLenum srcFormat,
+                                          const ImageRect *dstRect, GLenum dstFormat,
+                                          bool invertY, size_t offset, uint64_t serial);
+    VkBuffer                QueueDeviceReadback(uint64_t serial);
+    bool                    ResolveReadbacks(void);
+
+// Map Functions
+    void*                   Map(size_t offset, size_t length, GLbitfield access);
+    void                    FlushMappedRange(size_t offset, size_t length);
+    void                    Unmap(void);
 
 // Get Functions
     bool                    GetData(size_t size,
                                     size_t offset, void *data)          const;
+    bool                    GetIndexRange(size_t offset, uint32_t count, GLenum type, bool primitiveRestart,
+                                          uint32_t *minIndex, uint32_t *maxIndex);
+    BufferObject*           GetUint16IndexBuffer(size_t offset, uint32_t count, bool primitiveRestart);
+    BufferObject*           GetTriangleListIndexBuffer(size_t offset, uint32_t count, GLenum type, GLenum dstType);
+    BufferObject*           GetConvertedVertexBuffer(const VERTEX_CONVERSION_KEY &key) const;
     inline GLenum           GetUsage(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mUsage;  }
     inline GLenum           GetTarget(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mTarget; }
+    inline CacheManager    *GetCacheManager(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mCacheManager; }
     inline size_t           GetSize(void)                               const   { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetSize(); }
     inline VkBuffer         GetVkBuffer(void)                                   { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetVkBuffer(); }
+    inline bool             GetUsed(void)                               const   { FUN_ENTRY(GL_LOG_TRACE); return mUsed;   }
+    inline uint64_t         GetReadbackSerial(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mPendingReadbacks.empty() ? 0 : mPendingReadbacks.back().serial; }
+    inline GLbitfield       GetMapAccess(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return mMapAccess; }
+    inline size_t           GetMapLength(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return mMapLength; }
+    inline void*            GetMapPointer(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return IsMapped() ? mShadowData + mMapOffset : nullptr; }
 
 // Set Functions
     void                    SetTarget(GLenum target);
+    void                    SetConvertedVertexBuffer(const VERTEX_CONVERSION_KEY &key, BufferObject *vbo);
     inline void             SetUsage(GLenum usage)                                { FUN_ENTRY(GL_LOG_TRACE); mUsage     = usage; }
+    inline void             SetUsed(bool used)                                    { FUN_ENTRY(GL_LOG_TRACE); mUsed      = used;  }
+    inline void             SetDeviceWritten(void)                                { FUN_ENTRY(GL_LOG_TRACE); mDeviceWritten = mDeviceLocal; mUsed = true; }
+    inline void             SetCacheManager(CacheManager *cacheManager)           { FUN_ENTRY(GL_LOG_TRACE); mCacheManager = cacheManager; }
     inline void             SetVkContext(const vulkanAPI::vkContext_t *vkContext) { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext;
                                                                                                              mBuffer->SetContext(vkContext);
                                                                                                              mMemory->SetContext(vkContext); }
 // Has/Is Functions
     inline bool             HasData(void)                               const   { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetVkBuffer() != VK_NULL_HANDLE; }
-    inline bool             IsIndexBuffer(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mBuffer->GetFlags() & VK_BUFFER_USAGE_INDEX_BUFFER_BIT; }
+    inline bool             IsIndexBuffer(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mIndexBuffer; }
+    inline bool             IsMapped(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mMapAccess != 0; }
+    inline bool             HasPendingReadbacks(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return !mPendingReadbacks.empty(); }
+    inline bool             IsDeviceWritten(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mDeviceWritten; }
 };
 
 class IndexBufferObject : public BufferObject
@@ -99,7 +219,9 @@ class TransferDstBufferObject : public BufferObject
 {
 
 public:
-    explicit                TransferDstBufferObject(const vulkanAPI::vkContext_t *vkContext)  : BufferObject(vkContext, VK_BUFFER_USAGE_TRANSFER_DST_BIT) { FUN_ENTRY(GL_LOG_TRACE); }
+    explicit                TransferDstBufferObject(const vulkanAPI::vkContext_t *vkContext)  : BufferObject(vkContext, VK_BUFFER_USAGE_TRANSFER_DST_BIT) { FUN_ENTRY(GL_LOG_TRACE);
+                                                                                                                                                      // copies out of the device are read by the host
+                                                                                                                                                      mMemory->SetPreferredFlags(VK_MEMORY_PROPERTY_HOST_CACHED_BIT); }
 
 };
 
@@ -34,14 +34,24 @@
 Framebuffer::Framebuffer(const vulkanAPI::vkContext_t *vkContext)
 : mVkContext(vkContext),
 mTarget(GL_INVALID_VALUE), mState(IDLE),
-mUpdated(true), mSizeUpdated(false), mDepthStencilTexture(nullptr),
+mUpdated(true), mSizeUpdated(false), mGeneration(0), mLastUsedSerial(0), mColorFetch(false), mDepthStencilTexture(nullptr), mDepthStencilTextureAttached(false),
+mDeferredDepthStencilFormat(VK_FORMAT_UNDEFINED),
+mSamples(VK_SAMPLE_COUNT_1_BIT), mMultisampleColorTexture(nullptr),
 mBindToTexture(false), mSurfaceType(GLOVE_SURFACE_INVALID),
-mIsSystem(false), mEGLSurfaceInterface(nullptr),
+mIsSystem(false), mEGLSurfaceInterface(nullptr), mHasDamageArea(false), mPreRotation(0),
 mCacheColorTexture(nullptr), mCacheDepthTexture(nullptr), mCacheStencilTexture(nullptr),
 mCacheColorRenderbuffer(nullptr), mCacheDepthRenderbuffer(nullptr), mCacheStencilRenderbuffer(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    ResetDiscardedAttachments();
+    InvalidateAttachments();
+
+    mDeferredClear.depth        = false;
+    mDeferredClear.stencil      = false;
+    mDeferredClear.depthValue   = 1.0f;
+    mDeferredClear.stencilValue = 0u;
+
     mRenderPass           = new vulkanAPI::RenderPass(vkContext);
     mAttachmentDepth      = new Attachment();
     mAttachmentStencil    = new Attachment();
@@ -51,17 +61,18 @@ Framebuffer::~Framebuffer()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    ReleaseVkRenderPasses();
     delete mRenderPass;
     delete mAttachmentDepth;
     delete mAttachmentStencil;
 
-    if(!mIsSystem && mDepthStencilTexture != nullptr) {
-        if(mDepthStencilTexture->GetDepthStencilTextureRefCount() == 1) {
-            delete mDepthStencilTexture;
-        } else {
-            mDepthStencilTexture->DecreaseDepthStencilTextureRefCount();
-        }
-        mDepthStencilTexture = nullptr;
+    if(!mIsSystem) {
+        ReleaseDepthStencilTexture();
+    }
+
+    if(mMultisampleColorTexture != nullptr) {
+        delete mMultisampleColorTexture;
+        mMultisampleColorTexture = nullptr;
     }
 
     for(auto color : mAttachmentColors) {
@@ -85,6 +96,28 @@ Framebuffer::Release(void)
         fb = nullptr;
     }
     mFramebuffers.clear();
+
+    for(auto imageView : mMultiviewImageViews) {
+        delete imageView;
+    }
+    mMultiviewImageViews.clear();
+}
+
+void
+Framebuffer::ReleaseVkRenderPasses(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    bool activeReleased = false;
+    for(auto &entry : mRenderPasses) {
+        activeReleased |= (entry.second == mRenderPass);
+        delete entry.second;
+    }
+    mRenderPasses.clear();
+
+    if(activeReleased) {
+        mRenderPass = new vulkanAPI::RenderPass(mVkContext);
+    }
 }
 
 size_t
@@ -158,6 +191,33 @@ Framebuffer::GetDepthAttachmentTexture(void) const
     return tex;
 }
 
+GLenum
+Framebuffer::GetDepthInternalFormat(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the bits are those of the config, whether or not the buffer has been allocated yet
+    if(IsDepthStencilDeferred()) {
+        return VkFormatToGlInternalformat(mDeferredDepthStencilFormat);
+    }
+
+    const Texture *tex = GetDepthAttachmentTexture();
+    return tex ? tex->GetInternalFormat() : GL_INVALID_VALUE;
+}
+
+GLenum
+Framebuffer::GetStencilInternalFormat(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(IsDepthStencilDeferred()) {
+        return VkFormatToGlInternalformat(mDeferredDepthStencilFormat);
+    }
+
+    const Texture *tex = GetStencilAttachmentTexture();
+    return tex ? tex->GetInternalFormat() : GL_INVALID_VALUE;
+}
+
 Texture *
 Framebuffer::GetStencilAttachmentTexture(void) const
 {
@@ -190,6 +250,67 @@ Framebuffer::GetStencilAttachmentTexture(void) const
     return tex;
 }
 
+GLsizei
+Framebuffer::GetAttachmentSamples(GLenum attachment) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mIsSystem) {
+        return static_cast<GLsizei>(mEGLSurfaceInterface->samples);
+    }
+
+    const Attachment   *att;
+    const Renderbuffer *cachedRenderbuffer;
+    switch(attachment) {
+    case GL_COLOR_ATTACHMENT0:
+        if(!mAttachmentColors.size()) {
+            return 0;
+        }
+        att                = mAttachmentColors[0];
+        cachedRenderbuffer = mCacheColorRenderbuffer;
+        break;
+    case GL_DEPTH_ATTACHMENT:
+        att                = mAttachmentDepth;
+        cachedRenderbuffer = mCacheDepthRenderbuffer;
+        break;
+    case GL_STENCIL_ATTACHMENT:
+        att                = mAttachmentStencil;
+        cachedRenderbuffer = mCacheStencilRenderbuffer;
+        break;
+    default:
+        return 0;
+    }
+
+    // renderbuffers carry their own sample count, textures get it from the attachment point
+    if(att->GetType() == GL_RENDERBUFFER && att->GetName()) {
+        return cachedRenderbuffer ? cachedRenderbuffer->GetSamples() : mRenderbufferArray->GetObject(att->GetName())->GetSamples();
+    }
+
+    return att->GetType() == GL_TEXTURE ? att->GetSamples() : 0;
+}
+
+bool
+Framebuffer::UpdateSamples(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // complete framebuffers have the same count at every attachment
+    const GLsizei samples = std::max(GetAttachmentSamples(GL_COLOR_ATTACHMENT0),
+                            std::max(GetAttachmentSamples(GL_DEPTH_ATTACHMENT), GetAttachmentSamples(GL_STENCIL_ATTACHMENT)));
+
+    const VkSampleCountFlagBits vkSamples = FindSupportedVkSampleCount(mVkContext->vkFramebufferSampleCounts, static_cast<uint32_t>(samples));
+    if(vkSamples == mSamples) {
+        return false;
+    }
+
+    // the multisampled attachments have to be recreated
+    mSamples     = vkSamples;
+    mUpdated     = true;
+    mSizeUpdated = true;
+
+    return true;
+}
+
 void
 Framebuffer::AddColorAttachment(Texture *texture)
 {
@@ -202,6 +323,7 @@ Framebuffer::AddColorAttachment(Texture *texture)
     SetHeight(texture->GetHeight());
 
     mUpdated = true;
+    InvalidateAttachments();
 }
 
 void
@@ -218,12 +340,65 @@ Framebuffer::SetColorAttachment(int width, int height)
     SetHeight(height);
 
 
+    InvalidateAttachments();
     mUpdated     = true;
     mSizeUpdated = (mDepthStencilTexture == nullptr) || (mDepthStencilTexture->GetWidth() != GetWidth() || mDepthStencilTexture->GetHeight() != GetHeight());
 }
 
+void
+Framebuffer::SetColorAttachmentViews(GLint baseViewIndex, GLsizei numViews)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mAttachmentColors[0]->SetViews(baseViewIndex, numViews);
+
+    // the depth/stencil of multiview passes has a layer for each face the views may be drawn to
+    InvalidateAttachments();
+    mUpdated      = true;
+    mSizeUpdated |= (mDepthStencilTexture == nullptr) || (mDepthStencilTexture->IsCubeMap() != (GetViewCount() > 1));
+}
+
+void
+Framebuffer::UpdateAttachmentTextures(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mAttachmentTexturesValid) {
+        return;
+    }
+
+    mAttachmentTextures[0]  = GetColorAttachmentTexture();
+    mAttachmentTextures[1]  = GetDepthAttachmentTexture();
+    mAttachmentTextures[2]  = GetStencilAttachmentTexture();
+    mAttachmentTexturesValid = true;
+}
+
 GLenum
 Framebuffer::CheckStatus(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the status only changes along with the attachments or the storage of the attached textures,
+    // which gets a new generation every time it is specified again
+    UpdateAttachmentTextures();
+
+    uint64_t generations[3];
+    for(int i = 0; i < 3; ++i) {
+        generations[i] = mAttachmentTextures[i] ? mAttachmentTextures[i]->GetGeneration() : 0;
+    }
+
+    if(mStatus != GL_NONE && !memcmp(generations, mStatusGenerations, sizeof(generations))) {
+        return mStatus;
+    }
+
+    mStatus = EvaluateStatus();
+    memcpy(mStatusGenerations, generations, sizeof(generations));
+
+    return mStatus;
+}
+
+GLenum
+Framebuffer::EvaluateStatus(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -272,6 +447,23 @@ Framebuffer::CheckStatus(void)
         }
     }
 
+    const GLsizei colorSamples   = GetAttachmentSamples(GL_COLOR_ATTACHMENT0);
+    const GLsizei depthSamples   = GetAttachmentSamples(GL_DEPTH_ATTACHMENT);
+    const GLsizei stencilSamples = GetAttachmentSamples(GL_STENCIL_ATTACHMENT);
+    if((GetColorAttachmentType() != GL_NONE && GetDepthAttachmentType()   != GL_NONE && colorSamples != depthSamples)   ||
+       (GetColorAttachmentType() != GL_NONE && GetStencilAttachmentType() != GL_NONE && colorSamples != stencilSamples) ||
+       (GetDepthAttachmentType() != GL_NONE && GetStencilAttachmentType() != GL_NONE && depthSamples != stencilSamples)) {
+        return GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE_EXT;
+    }
+
+    // the views are faces of the color texture, the depth and stencil of each are kept by renderbuffers
+    // only, which get a layer for every view. Multisampled views are not rendered
+    if(GetViewCount() > 1 &&
+       (GetDepthAttachmentType() == GL_TEXTURE || GetStencilAttachmentType() == GL_TEXTURE ||
+        colorSamples > 1 || depthSamples > 1 || stencilSamples > 1)) {
+        return GL_FRAMEBUFFER_INCOMPLETE_VIEW_TARGETS_OVR;
+    }
+
     return GL_FRAMEBUFFER_COMPLETE;
 }
 
@@ -281,18 +473,113 @@ Framebuffer::CreateVkRenderPass(bool clearColorEnabled, bool clearDepthEnabled,
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mRenderPass->SetColorClearEnabled(clearColorEnabled);
-    mRenderPass->SetDepthClearEnabled(clearDepthEnabled);
-    mRenderPass->SetStencilClearEnabled(clearStencilEnabled);
+    /// the attachment formats are fixed until the attachments are updated,
+    /// so the load/store configuration is enough to identify a render pass
+    const bool     colorFetch = mColorFetch && CanFetchColor();
+    const uint32_t key = (clearColorEnabled   << 0) | (clearDepthEnabled << 1) | (clearStencilEnabled << 2) |
+                         (writeColorEnabled   << 3) | (writeDepthEnabled << 4) | (writeStencilEnabled << 5) |
+                         (mDiscarded.color    << 6) | (mDiscarded.depth  << 7) | (mDiscarded.stencil  << 8) |
+                         (colorFetch          << 9);
+
+    auto it = mRenderPasses.find(key);
+    if(it != mRenderPasses.end()) {
+        mRenderPass = it->second;
+        return true;
+    }
+
+    // reuse the render pass object that has not been created yet
+    vulkanAPI::RenderPass *renderPass = !mRenderPass->IsCreated() ? mRenderPass : new vulkanAPI::RenderPass(mVkContext);
+
+    renderPass->SetColorClearEnabled(clearColorEnabled);
+    renderPass->SetDepthClearEnabled(clearDepthEnabled);
+    renderPass->SetStencilClearEnabled(clearStencilEnabled);
+
+    renderPass->SetColorWriteEnabled(writeColorEnabled);
+    renderPass->SetDepthWriteEnabled(writeDepthEnabled);
+    renderPass->SetStencilWriteEnabled(writeStencilEnabled);
+
+    renderPass->SetColorLoadEnabled(!mDiscarded.color);
+    renderPass->SetDepthLoadEnabled(!mDiscarded.depth);
+    renderPass->SetStencilLoadEnabled(!mDiscarded.stencil);
+
+    renderPass->SetMultisampleColorTransient(IsMultisampleColorTransient());
+    renderPass->SetColorFetchEnabled(colorFetch);
+    renderPass->SetViewCount(GetViewCount());
+
+    if(!renderPass->Create(GetColorAttachmentTexture() ?
+                           GetColorAttachmentTexture()->GetVkFormat() : VK_FORMAT_UNDEFINED,
+                           mDepthStencilTexture ?
+                           mDepthStencilTexture->GetVkFormat() : VK_FORMAT_UNDEFINED,
+                           mSamples)) {
+        if(renderPass != mRenderPass) {
+            delete renderPass;
+        }
+        return false;
+    }
+
+    mRenderPasses[key] = renderPass;
+    mRenderPass        = renderPass;
+
+    return true;
+}
+
+bool
+Framebuffer::CanFetchColor(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the samples of a multisampled attachment are resolved away before a draw could read them,
+    // and only the images created for it can be bound as input attachments
+    const Texture *colorTexture = GetColorAttachmentTexture();
+    return colorTexture && mSamples == VK_SAMPLE_COUNT_1_BIT &&
+           (colorTexture->GetVkImageUsage() & VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+}
+
+Rect
+Framebuffer::PreRotateRect(const Rect &rect) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the rectangle is given from the top-left corner the client sees, and returned from the one of the images
+    switch(mPreRotation) {
+    case 1:  return Rect(GetHeight() - rect.y - rect.height, rect.x, rect.height, rect.width);
+    case 2:  return Rect(GetWidth()  - rect.x - rect.width, GetHeight() - rect.y - rect.height, rect.width, rect.height);
+    case 3:  return Rect(rect.y, GetWidth() - rect.x - rect.width, rect.height, rect.width);
+    default: return rect;
+    }
+}
+
+Texture *
+Framebuffer::GetRenderedDepthTexture(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the texture cannot stand in for a combined depth/stencil, a multisampled or a multiview attachment
+    if(mIsSystem || GetDepthAttachmentType() != GL_TEXTURE || GetStencilAttachmentType() != GL_NONE || mSamples != VK_SAMPLE_COUNT_1_BIT ||
+       GetViewCount() > 1) {
+        return nullptr;
+    }
+
+    Texture *tex = GetDepthAttachmentTexture();
+    return (tex && tex->IsDepthTexture()) ? tex : nullptr;
+}
 
-    mRenderPass->SetColorWriteEnabled(writeColorEnabled);
-    mRenderPass->SetDepthWriteEnabled(writeDepthEnabled);
-    mRenderPass->SetStencilWriteEnabled(writeStencilEnabled);
+void
+Framebuffer::ReleaseDepthStencilTexture(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // an attached depth texture belongs to the application
+    if(mDepthStencilTexture != nullptr && !mDepthStencilTextureAttached) {
+        if(mDepthStencilTexture->GetDepthStencilTextureRefCount() <= 1) {
+            delete mDepthStencilTexture;
+        } else {
+            mDepthStencilTexture->DecreaseDepthStencilTextureRefCount();
+        }
+    }
 
-    return mRenderPass->Create(GetColorAttachmentTexture() ?
-                               GetColorAttachmentTexture()->GetVkFormat() : VK_FORMAT_UNDEFINED,
-                               mDepthStencilTexture ?
-                               mDepthStencilTexture->GetVkFormat() : VK_FORMAT_UNDEFINED);
+    mDepthStencilTexture         = nullptr;
+    mDepthStencilTextureAttached = false;
 }
 
 void
@@ -300,29 +587,44 @@ Framebuffer::CreateDepthStencilTexture(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // shadow maps are sampled straight from the image they were rendered to, without any copy
+    Texture *renderedDepthTexture = GetRenderedDepthTexture();
+    if(renderedDepthTexture || mDepthStencilTextureAttached) {
+        ReleaseDepthStencilTexture();
+    }
+
+    if(renderedDepthTexture) {
+        renderedDepthTexture->AllocatePending();
+        mDepthStencilTexture         = renderedDepthTexture;
+        mDepthStencilTextureAttached = true;
+        return;
+    }
+
     if(GetDepthAttachmentTexture() || GetStencilAttachmentTexture()) {
        
-        if(!mIsSystem && GetDepthAttachmentTexture() && GetDepthAttachmentTexture()->GetDepthStencilTexture()) {
+        // renderbuffers share the depth/stencil of single view passes only
+        const bool multiview = GetViewCount() > 1;
+        if(!mIsSystem && !multiview && GetDepthAttachmentTexture() && GetDepthAttachmentTexture()->GetDepthStencilTexture() &&
+           GetDepthAttachmentTexture()->GetDepthStencilTexture()->GetVkSampleCount() == mSamples) {
            mDepthStencilTexture = GetDepthAttachmentTexture()->GetDepthStencilTexture();
            mDepthStencilTexture->IncreaseDepthStencilTextureRefCount();
            return;
         }
 
-        if(mDepthStencilTexture != nullptr) {
-            delete mDepthStencilTexture;
-            mDepthStencilTexture = nullptr;
-        }
-        
+        ReleaseDepthStencilTexture();
+
         mDepthStencilTexture = new Texture(mVkContext);
-        mDepthStencilTexture->SetTarget(GL_TEXTURE_2D);
+        mDepthStencilTexture->SetTarget(multiview ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D);
+        mDepthStencilTexture->SetVkImageTarget(multiview ? vulkanAPI::Image::VK_IMAGE_TARGET_CUBE : vulkanAPI::Image::VK_IMAGE_TARGET_2D);
 
         VkFormat vkformat = GlInternalFormatToVkFormat(
             GetDepthAttachmentTexture()   ? GetDepthAttachmentTexture()->GetInternalFormat()   : GL_INVALID_VALUE,
             GetStencilAttachmentTexture() ? GetStencilAttachmentTexture()->GetInternalFormat() : GL_INVALID_VALUE);
 
         // convert to supported format
-        vkformat = FindSupportedDepthStencilFormat(mVkContext->vkGpus[0], GetVkFormatDepthBits(vkformat), GetVkFormatStencilBits(vkformat));
+        vkformat = FindSupportedDepthStencilFormat(mVkContext->capabilityCache, GetVkFormatDepthBits(vkformat), GetVkFormatStencilBits(vkformat));
         mDepthStencilTexture->SetVkFormat(vkformat);
+        mDepthStencilTexture->SetVkSampleCount(mSamples);
         mDepthStencilTexture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
         mDepthStencilTexture->SetVkImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
         mDepthStencilTexture->SetVkImageTiling();
@@ -332,7 +634,7 @@ Framebuffer::CreateDepthStencilTexture(void)
                                        GlInternalFormatToGlType(glformat), Texture::GetDefaultInternalAlignment(), nullptr);
         mDepthStencilTexture->Allocate();
 
-        if(!mIsSystem && GetDepthAttachmentTexture()) {
+        if(!mIsSystem && !multiview && GetDepthAttachmentTexture()) {
             GetDepthAttachmentTexture()->SetDepthStencilTexture(mDepthStencilTexture);
             mDepthStencilTexture->IncreaseDepthStencilTextureRefCount();
         }
@@ -340,72 +642,42 @@ Framebuffer::CreateDepthStencilTexture(void)
 }
 
 void
-Framebuffer::UpdateClearDepthStencilTexture(uint32_t clearStencil, uint32_t stencilMaskFront, const Rect& clearRect)
+Framebuffer::CheckForUpdatedResources()
 {
-    GLenum glFormat = VkFormatToGlInternalformat(mDepthStencilTexture->GetVkFormat());
-    size_t numElements = GlInternalFormatTypeToNumElements(glFormat, mDepthStencilTexture->GetExplicitType());
-    ImageRect srcRect(clearRect, numElements, 1, Texture::GetDefaultInternalAlignment());
-
-    ImageRect dstRect = srcRect;
-    dstRect.x = 0;
-    dstRect.y = 0;
-    size_t dstByteSize = dstRect.GetRectBufferSize();
-    uint8_t* dstData = new uint8_t[dstByteSize];
-
-    //retrieve the stored stencil data
-    mDepthStencilTexture->SetDataNoInvertion(true);
-    mDepthStencilTexture->SetImageBufferCopyStencil(true);
-    mDepthStencilTexture->CopyPixelsToHost(&srcRect, &dstRect, 0, 0, glFormat, dstData);
-
-    // size of an entire row in bytes
-    uint32_t dataRowStride = dstRect.GetRectAlignedRowInBytes();
-
-    // rectangle offset in the memory block
-    uint32_t dataCurrentRowIndex = dstRect.GetStartRowIndex(dataRowStride);
-
-    // obtain ptr locations with the byte offset
-    uint8_t* dataPtr = static_cast<uint8_t*>(dstData) + dataCurrentRowIndex;
-
-    GLint depthBits = 0;
-    GLint stencilBits = 0;
-    GlFormatToStorageBits(glFormat, nullptr, nullptr, nullptr, nullptr, &depthBits, &stencilBits);
-    assert(stencilBits > 0);
-
-    // perform the conversion
-    for(int row = 0; row < srcRect.height; ++row) {
-        for(int col = 0; col < srcRect.width; ++col) {
-            uint32_t dataIndex = col * srcRect.GetPixelByteOffset();
-            uint8_t oldStencilValue = dataPtr[dataIndex];
-            uint8_t newStencilValue = (clearStencil & 0xFF) | ((oldStencilValue & 0xFF) & (~(stencilMaskFront & 0xFF)));
+    FUN_ENTRY(GL_LOG_TRACE);
 
-            dataPtr[dataIndex] = newStencilValue;
-        }
-        // offset by the number of bytes per row
-        dataPtr = dataPtr + dataRowStride;
+    // the system framebuffer switches color textures with every presented image
+    Texture *colorTexture;
+    if(mIsSystem) {
+        colorTexture = GetColorAttachmentTexture();
+    } else {
+        UpdateAttachmentTextures();
+        colorTexture = mAttachmentTextures[0];
     }
 
-    //update the stencil data
-    mDepthStencilTexture->CopyPixelsFromHost(&dstRect, &srcRect, 0, 0, glFormat, dstData);
-    mDepthStencilTexture->SetImageBufferCopyStencil(false);
+    if(colorTexture) {
 
-    delete[] dstData;
-}
+        mUpdated |= colorTexture->GetDataUpdated();
+        if( colorTexture->GetWidth()  != GetWidth()  ||
+            colorTexture->GetHeight() != GetHeight() ) {
 
-void
-Framebuffer::CheckForUpdatedResources()
-{
-    if(GetColorAttachmentTexture()) {
+            SetWidth (colorTexture->GetWidth());
+            SetHeight(colorTexture->GetHeight());
 
-        mUpdated |= GetColorAttachmentTexture()->GetDataUpdated();
-        if( GetColorAttachmentTexture()->GetWidth()  != GetWidth()  ||
-            GetColorAttachmentTexture()->GetHeight() != GetHeight() ) {
+            mSizeUpdated = true;
+        }
+        colorTexture->SetDataUpdated(false);
+    } else if(GetRenderedDepthTexture()) {
+        // a respecified depth texture resizes the depth only framebuffer it is attached to
+        Texture *depthTexture = mAttachmentTextures[1];
+        if(depthTexture->GetWidth()  != GetWidth()  ||
+           depthTexture->GetHeight() != GetHeight()) {
 
-            SetWidth (GetColorAttachmentTexture()->GetWidth());
-            SetHeight(GetColorAttachmentTexture()->GetHeight());
+            SetWidth (depthTexture->GetWidth());
+            SetHeight(depthTexture->GetHeight());
 
             mSizeUpdated = true;
         }
-        GetColorAttachmentTexture()->SetDataUpdated(false);
     }
 }
 
@@ -448,6 +720,8 @@ Framebuffer::CleanCachedAttachment(GLenum attachment)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    InvalidateAttachments();
+
     switch(attachment) {
     case GL_COLOR_ATTACHMENT0: {
         uint32_t index = GetColorAttachmentName();
@@ -508,11 +782,9 @@ Framebuffer::UnrefAttachment(GLenum attachment)
         if(index) {
             GLenum type  = GetColorAttachmentType();
             if(type == GL_TEXTURE) {
-                if(mCacheColorTexture) {
-                    mCacheColorTexture->Unbind();
-                } else {
-                    mTextureArray->GetObject(index)->Unbind();
-                }
+                Texture *tex = mCacheColorTexture ? mCacheColorTexture : mTextureArray->GetObject(index);
+                tex->DecreaseColorAttachmentRefCount();
+                tex->Unbind();
             } else if(type == GL_RENDERBUFFER) {
                 if(mCacheColorRenderbuffer) {
                     mCacheColorRenderbuffer->Unbind();
@@ -574,7 +846,9 @@ Framebuffer::RefAttachment(GLenum attachment)
         if(index) {
             GLenum type  = GetColorAttachmentType();
             if(type == GL_TEXTURE) {
+                mTextureArray->GetObject(index)->IncreaseColorAttachmentRefCount();
                 mTextureArray->GetObject(index)->Bind();
+                mTextureArray->GetObject(index)->AllocatePending();
             } else if(type == GL_RENDERBUFFER) {
                 mRenderbufferArray->GetObject(index)->Bind();
             }
@@ -586,6 +860,7 @@ Framebuffer::RefAttachment(GLenum attachment)
             GLenum type  = GetDepthAttachmentType();
             if(type == GL_TEXTURE) {
                 mTextureArray->GetObject(index)->Bind();
+                mTextureArray->GetObject(index)->AllocatePending();
             } else if(type == GL_RENDERBUFFER) {
                 mRenderbufferArray->GetObject(index)->Bind();
             }
@@ -597,6 +872,7 @@ Framebuffer::RefAttachment(GLenum attachment)
             GLenum type  = GetStencilAttachmentType();
             if(type == GL_TEXTURE) {
                 mTextureArray->GetObject(index)->Bind();
+                mTextureArray->GetObject(index)->AllocatePending();
             } else if(type == GL_RENDERBUFFER) {
                 mRenderbufferArray->GetObject(index)->Bind();
             }
@@ -622,28 +898,55 @@ Framebuffer::CreateRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bo
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mUpdated || mSizeUpdated ||
+    UpdateSamples();
+
+    const bool attachmentsUpdated = mUpdated || mSizeUpdated;
+
+    if(attachmentsUpdated) {
+        // attached depth textures are followed along with the attachments, not only with the size
+        if(!mIsSystem && (mSizeUpdated || mDepthStencilTextureAttached || GetRenderedDepthTexture())) {
+            CreateDepthStencilTexture();
+            mSizeUpdated = false;
+        }
+        // cached render passes may no longer match the attachment formats
+        ReleaseVkRenderPasses();
+    }
+
+    if(attachmentsUpdated ||
        static_cast<bool>(mRenderPass->GetColorClearEnabled())   != clearColorEnabled    ||
        static_cast<bool>(mRenderPass->GetDepthClearEnabled())   != clearDepthEnabled    ||
        static_cast<bool>(mRenderPass->GetStencilClearEnabled()) != clearStencilEnabled  ||
        static_cast<bool>(mRenderPass->GetColorWriteEnabled())   != writeColorEnabled    ||
        static_cast<bool>(mRenderPass->GetDepthWriteEnabled())   != writeDepthEnabled    ||
-       static_cast<bool>(mRenderPass->GetStencilWriteEnabled()) != writeStencilEnabled) {
-
-        if(!mIsSystem && mSizeUpdated) {
-            CreateDepthStencilTexture();
-            mSizeUpdated = false;
-        }
+       static_cast<bool>(mRenderPass->GetStencilWriteEnabled()) != writeStencilEnabled  ||
+       static_cast<bool>(mRenderPass->GetColorLoadEnabled())    == mDiscarded.color     ||
+       static_cast<bool>(mRenderPass->GetDepthLoadEnabled())    == mDiscarded.depth     ||
+       static_cast<bool>(mRenderPass->GetStencilLoadEnabled())  == mDiscarded.stencil) {
         CreateVkRenderPass(clearColorEnabled, clearDepthEnabled, clearStencilEnabled,
                            writeColorEnabled, writeDepthEnabled, writeStencilEnabled);
-        Create();
+    }
 
+    // framebuffers only depend on the image views and the render pass
+    // compatibility, which a change of load/store ops leaves untouched
+    if(attachmentsUpdated) {
+        Create();
         mUpdated = false;
     }
 
 
-    const VkRect2D clearRect2D = { {clearRect->x, clearRect->y},
-                                   {(uint32_t)clearRect->width, (uint32_t)clearRect->height}};
+    VkRect2D clearRect2D = { {clearRect->x, clearRect->y},
+                             {(uint32_t)clearRect->width, (uint32_t)clearRect->height}};
+
+    // nothing outside the damage is rendered, the pass keeps the rest of the presented buffer
+    if(mHasDamageArea) {
+        int32_t x0 = std::max(clearRect->x, mDamageArea.x);
+        int32_t y0 = std::max(clearRect->y, mDamageArea.y);
+        int32_t x1 = std::min(clearRect->x + clearRect->width,  mDamageArea.x + mDamageArea.width);
+        int32_t y1 = std::min(clearRect->y + clearRect->height, mDamageArea.y + mDamageArea.height);
+        if(x1 > x0 && y1 > y0) {
+            clearRect2D = { {x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)} };
+        }
+    }
 
     mRenderPass->SetClearArea(&clearRect2D);
     mRenderPass->SetClearColorValue(colorValue);
@@ -651,15 +954,39 @@ Framebuffer::CreateRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bo
 }
 
 void
-Framebuffer::BeginVkRenderPass()
+Framebuffer::BeginVkRenderPass(bool hasSecondary)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     assert(GetCurrentContext());
     vulkanAPI::CommandBufferManager *commandBufferManager = GetCurrentContext()->GetVkCommandBufferManager();
     VkCommandBuffer activeCmdBuffer = commandBufferManager->GetActiveCommandBuffer();
-    size_t bufferIndex = GetCurrentBufferIndex();
-    mRenderPass->Begin(&activeCmdBuffer, mFramebuffers[bufferIndex]->GetFramebuffer(), true);
+
+    // attachment transitions are recorded right before the render pass begins, all in one barrier
+    vulkanAPI::ImageBarrierBatch barriers;
+    PrepareVkImage(&barriers, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    PrepareVkImage(&barriers, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    barriers.Record(&activeCmdBuffer);
+
+    // programs sampling the color texture must pick up whatever this pass renders
+    ++mGeneration;
+    mLastUsedSerial = commandBufferManager->GetSubmitSerial();
+    if(!mIsSystem && GetColorAttachmentType() == GL_TEXTURE && GetColorAttachmentTexture()) {
+        GetColorAttachmentTexture()->BumpGeneration();
+    }
+
+    // passes begun dynamically render to the image views, the others need a framebuffer object,
+    // which is created against the first of them that is begun
+    vulkanAPI::Framebuffer *framebuffer = mFramebuffers[GetCurrentBufferIndex()];
+    if(!mRenderPass->IsDynamic() && *framebuffer->GetFramebuffer() == VK_NULL_HANDLE) {
+        framebuffer->CreateVkFramebuffer(mRenderPass->GetRenderPass());
+    }
+
+    commandBufferManager->BeginVkRenderPassQueries();
+    mRenderPass->Begin(&activeCmdBuffer, framebuffer, hasSecondary);
+
+    // the render pass has consumed the discards
+    ResetDiscardedAttachments();
 }
 
 bool
@@ -670,18 +997,38 @@ Framebuffer::EndVkRenderPass(void)
     assert(GetCurrentContext());
     vulkanAPI::CommandBufferManager *commandBufferManager = GetCurrentContext()->GetVkCommandBufferManager();
     VkCommandBuffer activeCmdBuffer = commandBufferManager->GetActiveCommandBuffer();
-    return mRenderPass->End(&activeCmdBuffer);
+    // queries begun inside the render pass end inside it, the others right after it
+    commandBufferManager->EndVkRenderPassQueries(false);
+    if(!mRenderPass->End(&activeCmdBuffer)) {
+        return false;
+    }
+
+    commandBufferManager->EndVkRenderPassQueries(true);
+    return true;
+}
+
+void
+Framebuffer::PrepareVkImage(VkCommandBuffer *cmdBuffer, VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vulkanAPI::ImageBarrierBatch barriers;
+    PrepareVkImage(&barriers, newImageLayout);
+    barriers.Record(cmdBuffer);
 }
 
 void
-Framebuffer::PrepareVkImage(VkImageLayout newImageLayout)
+Framebuffer::PrepareVkImage(vulkanAPI::ImageBarrierBatch *barriers, VkImageLayout newImageLayout)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(GetColorAttachmentTexture() && newImageLayout != VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-        GetColorAttachmentTexture()->PrepareVkImageLayout(newImageLayout);
+        GetColorAttachmentTexture()->PrepareVkImageLayout(barriers, newImageLayout);
+        if(mMultisampleColorTexture && newImageLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+            mMultisampleColorTexture->PrepareVkImageLayout(barriers, newImageLayout);
+        }
     } else if(GetDepthStencilAttachmentTexture() && newImageLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-        GetDepthStencilAttachmentTexture()->PrepareVkImageLayout(newImageLayout);
+        GetDepthStencilAttachmentTexture()->PrepareVkImageLayout(barriers, newImageLayout);
     }
 }
 
@@ -692,18 +1039,34 @@ Framebuffer::Create(void)
 
     Release();
 
+    if(!CreateMultisampleColorTexture()) {
+        return false;
+    }
+
+    // same order as the attachments of the render pass
     for(uint32_t i = 0; i < mAttachmentColors.size(); ++i) {
         vulkanAPI::Framebuffer *frameBuffer = new vulkanAPI::Framebuffer(mVkContext);
 
         vector<VkImageView> imageViews;
-        if(GetColorAttachmentTexture(i)) {
-            imageViews.push_back(GetColorAttachmentTexture(i)->GetVkImageView());
-        }
-        if(mDepthStencilTexture) {
-            imageViews.push_back(mDepthStencilTexture->GetVkImageView());
+        if(GetViewCount() > 1) {
+            // user framebuffers have a single color attachment, never multisampled along with views
+            if(!CreateMultiviewImageViews(&imageViews)) {
+                delete frameBuffer;
+                return false;
+            }
+        } else {
+            if(GetColorAttachmentTexture(i)) {
+                imageViews.push_back(mMultisampleColorTexture ? mMultisampleColorTexture->GetVkImageView() : GetColorAttachmentTexture(i)->GetVkImageView());
+            }
+            if(mDepthStencilTexture) {
+                imageViews.push_back(mDepthStencilTexture->GetVkImageView());
+            }
+            if(GetColorAttachmentTexture(i) && mMultisampleColorTexture) {
+                imageViews.push_back(GetColorAttachmentTexture(i)->GetVkImageView());
+            }
         }
 
-        if(!frameBuffer->Create(&imageViews, GetVkRenderPass(), GetWidth(), GetHeight())) {
+        if(!frameBuffer->Create(&imageViews, GetVkRenderPass(), GetStorageWidth(), GetStorageHeight())) {
             delete frameBuffer;
             return false;
         }
@@ -713,3 +1076,87 @@ Framebuffer::Create(void)
 
     return true;
 }
+
+bool
+Framebuffer::CreateMultiviewImageViews(vector<VkImageView> *imageViews)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the color is drawn into the faces of the views, the depth/stencil into its first layers
+    const uint32_t viewCount = GetViewCount();
+    Texture *textures[2]     = { GetColorAttachmentTexture(), mDepthStencilTexture };
+    uint32_t baseLayers[2]   = { static_cast<uint32_t>(GetColorAttachmentBaseViewIndex()), 0 };
+
+    for(uint32_t i = 0; i < 2; ++i) {
+        if(!textures[i]) {
+            continue;
+        }
+
+        vulkanAPI::ImageView *imageView = new vulkanAPI::ImageView(mVkContext);
+        if(!imageView->Create(textures[i]->GetImage(), baseLayers[i], viewCount)) {
+            delete imageView;
+            return false;
+        }
+
+        mMultiviewImageViews.push_back(imageView);
+        imageViews->push_back(imageView->GetImageView());
+    }
+
+    return true;
+}
+
+bool
+Framebuffer::CreateMultisampleColorTexture(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Texture *colorTexture = mAttachmentColors.size() ? GetColorAttachmentTexture(0) : nullptr;
+    const bool transient  = IsMultisampleColorTransient();
+
+    if(mMultisampleColorTexture != nullptr) {
+        const bool wasTransient = (mMultisampleColorTexture->GetImage()->GetImageUsage() & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+        if(colorTexture && mSamples != VK_SAMPLE_COUNT_1_BIT                     &&
+           mMultisampleColorTexture->GetVkSampleCount() == mSamples                &&
+           mMultisampleColorTexture->GetVkFormat()      == colorTexture->GetVkFormat() &&
+           mMultisampleColorTexture->GetWidth()         == GetStorageWidth()       &&
+           mMultisampleColorTexture->GetHeight()        == GetStorageHeight()      &&
+           wasTransient == transient) {
+            return true;
+        }
+
+        delete mMultisampleColorTexture;
+        mMultisampleColorTexture = nullptr;
+    }
+
+    if(!colorTexture || mSamples == VK_SAMPLE_COUNT_1_BIT) {
+        return true;
+    }
+
+    // contents that never leave the tile memory do not need any memory behind them on tilers
+    const VkFlags memoryFlags = transient ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT :
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    const VkImageUsageFlagBits usage = static_cast<VkImageUsageFlagBits>(transient ?
+                                       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT :
+                                       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+
+    mMultisampleColorTexture = new Texture(mVkContext, memoryFlags);
+    mMultisampleColorTexture->SetTarget(GL_TEXTURE_2D);
+    mMultisampleColorTexture->SetVkFormat(colorTexture->GetVkFormat());
+    mMultisampleColorTexture->SetVkSampleCount(mSamples);
+    mMultisampleColorTexture->SetVkImageUsage(usage);
+    mMultisampleColorTexture->SetVkImageLayout(VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    mMultisampleColorTexture->SetVkImageTiling();
+    mMultisampleColorTexture->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
+    GLenum glformat = VkFormatToGlInternalformat(colorTexture->GetVkFormat());
+    mMultisampleColorTexture->InitState();
+    mMultisampleColorTexture->SetState(GetStorageWidth(), GetStorageHeight(), 0, 0, GlInternalFormatToGlFormat(glformat),
+                                       GlInternalFormatToGlType(glformat), Texture::GetDefaultInternalAlignment(), nullptr);
+
+    if(!mMultisampleColorTexture->Allocate()) {
+        delete mMultisampleColorTexture;
+        mMultisampleColorTexture = nullptr;
+        return false;
+    }
+
+    return true;
+}
@@ -29,6 +29,8 @@
 #include "vulkan/renderPass.h"
 #include "vulkan/framebuffer.h"
 #include "utils/arrays.hpp"
+#include "utils/globals.h"
+#include <map>
 
 typedef enum {
     GLOVE_SURFACE_INVALID,
@@ -36,7 +38,7 @@ typedef enum {
     GLOVE_SURFACE_PBUFFER
 } glove_surface_type;
 
-class Framebuffer {
+class Framebuffer : public ArrayObject {
 private:
     enum State {
         IDLE,
@@ -57,19 +59,74 @@ private:
     bool                            mUpdated;
     bool                            mSizeUpdated;
 
+    /// increased every time a render pass may write the attachments
+    uint64_t                        mGeneration;
+    /// submit serial of the last command buffer a render pass of it was recorded in
+    uint64_t                        mLastUsedSerial;
+
+    /// attachments whose contents are undefined, so that the next render pass does not load them
+    struct {
+    bool                            color;
+    bool                            depth;
+    bool                            stencil;
+    }                               mDiscarded;
+
+    /// the render passes let draws read the color attachment (GL_EXT_shader_framebuffer_fetch)
+    bool                            mColorFetch;
+
+    /// attachment textures as last looked up, valid until an attachment changes
+    bool                            mAttachmentTexturesValid;
+    Texture*                        mAttachmentTextures[3];
+    /// completeness status with the generations of the attachment textures it was evaluated for
+    GLenum                          mStatus;
+    uint64_t                        mStatusGenerations[3];
+
     vulkanAPI::RenderPass*          mRenderPass;
+    map<uint32_t, vulkanAPI::RenderPass*> mRenderPasses;
     vector<vulkanAPI::Framebuffer*> mFramebuffers;
+    /// multiview passes draw into the faces of the attachments through views of several layers
+    vector<vulkanAPI::ImageView*>   mMultiviewImageViews;
 
     vector<Attachment*>             mAttachmentColors;
     Attachment*                     mAttachmentDepth;
     Attachment*                     mAttachmentStencil;
     Texture*                        mDepthStencilTexture;
+    /// depth textures are rendered to in place, mDepthStencilTexture is then the attached texture itself
+    bool                            mDepthStencilTextureAttached;
+
+    /// format of the depth/stencil buffer of a system framebuffer that is allocated once it is first used,
+    /// undefined once it is, or if its config has none
+    VkFormat                        mDeferredDepthStencilFormat;
+
+    /// the last clears of the deferred buffer, which nothing else writes until a test is enabled,
+    /// so that they are replayed on it once it is allocated
+    struct {
+    bool                            depth;
+    bool                            stencil;
+    GLfloat                         depthValue;
+    uint32_t                        stencilValue;
+    }                               mDeferredClear;
+
+    /// multisampled framebuffers render to mMultisampleColorTexture and resolve it
+    /// into the color attachment at the end of every render pass
+    VkSampleCountFlagBits           mSamples;
+    Texture*                        mMultisampleColorTexture;
+
     bool                            mBindToTexture;
     GLenum                          mSurfaceType;
 
     bool                            mIsSystem;
     const EGLSurfaceInterface      *mEGLSurfaceInterface;
 
+    /// region of a system framebuffer that the frame updates (EGL_KHR_partial_update),
+    /// render passes are confined to it and leave the rest of the buffer as presented
+    Rect                            mDamageArea;
+    bool                            mHasDamageArea;
+
+    /// quarter turns clockwise the images of a system framebuffer are stored with, so that they are presented
+    /// without the compositor rotating them, the dimensions stay the ones the client sees
+    uint32_t                        mPreRotation;
+
     //Cache for possible deleted textures and renderbuffers
     Texture*                        mCacheColorTexture;
     Texture*                        mCacheDepthTexture;
@@ -79,7 +136,17 @@ private:
     Renderbuffer*                   mCacheStencilRenderbuffer;
 
     void                            Release(void);
+    void                            ReleaseVkRenderPasses(void);
     size_t                          GetCurrentBufferIndex(void) const;
+    bool                            CreateMultisampleColorTexture(void);
+    bool                            CreateMultiviewImageViews(vector<VkImageView> *imageViews);
+    void                            UpdateAttachmentTextures(void);
+    Texture *                       GetRenderedDepthTexture(void) const;
+    void                            ReleaseDepthStencilTexture(void);
+    GLenum                          EvaluateStatus(void);
+    inline void                     InvalidateAttachments(void)         { FUN_ENTRY(GL_LOG_TRACE); mAttachmentTexturesValid = false; mStatus = GL_NONE; }
+    /// textures attached with glFramebufferTexture2DMultisampleEXT only keep the resolved samples
+    inline bool                     IsMultisampleColorTransient(void) const { FUN_ENTRY(GL_LOG_TRACE); return !mIsSystem && GetColorAttachmentType() == GL_TEXTURE; }
 
 public:
     Framebuffer(const vulkanAPI::vkContext_t *vkContext = nullptr);
@@ -88,7 +155,6 @@ public:
 // Create Functions
     bool                    Create(void);
     void                    CreateDepthStencilTexture(void);
-    void                    UpdateClearDepthStencilTexture(uint32_t clearStencil, uint32_t stencilMaskFront, const Rect& clearRect);
 
 // RenderPass Functions
     bool                    CreateVkRenderPass(bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled,
@@ -96,9 +162,10 @@ public:
     void                    CreateRenderPass (bool clearColorEnabled, bool clearDepthEnabled, bool clearStencilEnabled,
                                                bool writeColorEnabled, bool writeDepthEnabled, bool writeStencilEnabled,
                                                const float *colorValue, float depthValue, uint32_t stencilValue, const Rect *clearRect);
-    void                    BeginVkRenderPass(void);
+    void                    BeginVkRenderPass(bool hasSecondary = GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS);
     bool                    EndVkRenderPass(void);
-    void                    PrepareVkImage(VkImageLayout newImageLayout);
+    void                    PrepareVkImage(VkCommandBuffer *cmdBuffer, VkImageLayout newImageLayout);
+    void                    PrepareVkImage(vulkanAPI::ImageBarrierBatch *barriers, VkImageLayout newImageLayout);
 
 // Add Functions
     void                    AddColorAttachment(Texture *texture);
@@ -108,6 +175,7 @@ public:
 
 // Update Functions
     void                    CheckForUpdatedResources(void);
+    bool                    UpdateSamples(void);
 
 //Attachment Reference Functions
     void                    CacheAttachement(Texture *bTexture, GLuint index);
@@ -124,6 +192,10 @@ public:
     inline int              GetY(void)                                  const   { FUN_ENTRY(GL_LOG_TRACE); return mDims.y; }
     inline int              GetWidth(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mDims.width; }
     inline int              GetHeight(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mDims.height; }
+    inline uint32_t         GetPreRotation(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mPreRotation; }
+    inline int              GetStorageWidth(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return (mPreRotation & 1) ? mDims.height : mDims.width;  }
+    inline int              GetStorageHeight(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return (mPreRotation & 1) ? mDims.width  : mDims.height; }
+           Rect             PreRotateRect(const Rect &rect)             const;
     inline GLenum           GetTarget(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mTarget; }
     inline vulkanAPI::RenderPass *     GetRenderPass(void)              const   { FUN_ENTRY(GL_LOG_TRACE); return mRenderPass; }
     inline VkRenderPass *   GetVkRenderPass(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mRenderPass->GetRenderPass(); }
@@ -135,13 +207,22 @@ public:
                                                                                                            default:                     return 0;}}
 
     inline GLenum           GetColorAttachmentType(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetType()  : GL_NONE; }
+    inline uint64_t         GetGeneration(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mGeneration; }
+    inline uint64_t         GetLastUsedSerial(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mLastUsedSerial; }
     inline uint32_t         GetColorAttachmentName(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetName()  : 0; }
     inline GLint            GetColorAttachmentLevel(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetLevel() : 0; }
     inline GLenum           GetColorAttachmentLayer(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetLayer() : GL_TEXTURE_CUBE_MAP_POSITIVE_X; }
+    inline GLint            GetColorAttachmentBaseViewIndex(void)       const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetBaseViewIndex() : 0; }
+    inline GLsizei          GetColorAttachmentNumViews(void)            const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentColors.size() ? mAttachmentColors[0]->GetNumViews() : 1; }
+    /// views each render pass draws, only textures are attached with more than one
+    inline uint32_t         GetViewCount(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return !mIsSystem && GetColorAttachmentType() == GL_TEXTURE ?
+                                                                                                                  static_cast<uint32_t>(GetColorAttachmentNumViews()) : 1; }
     inline Texture *        GetColorAttachmentTexture(uint32_t i)       const   { FUN_ENTRY(GL_LOG_TRACE); return mIsSystem ? mAttachmentColors[i]->GetTexture() :
                                                                                                                               GetColorAttachmentTexture(); }
            Texture *        GetColorAttachmentTexture(void)             const;
            Texture *        GetDepthStencilAttachmentTexture(void)      const   { FUN_ENTRY(GL_LOG_TRACE); return mDepthStencilTexture;            }
+           GLsizei          GetAttachmentSamples(GLenum attachment)     const;
+    inline VkSampleCountFlagBits GetSamples(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mSamples;                        }
     inline GLenum           GetDepthAttachmentType(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentDepth->GetType();     }
     inline uint32_t         GetDepthAttachmentName(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentDepth->GetName();     }
     inline GLint            GetDepthAttachmentLevel(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentDepth->GetLevel();    }
@@ -153,8 +234,16 @@ public:
     inline GLint            GetStencilAttachmentLevel(void)             const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentStencil->GetLevel();  }
     inline GLenum           GetStencilAttachmentLayer(void)             const   { FUN_ENTRY(GL_LOG_TRACE); return mAttachmentStencil->GetLayer();  }
            Texture *        GetStencilAttachmentTexture(void)           const;
+           GLenum           GetDepthInternalFormat(void)                const;
+           GLenum           GetStencilInternalFormat(void)              const;
+    inline VkFormat         GetDeferredDepthStencilFormat(void)         const   { FUN_ENTRY(GL_LOG_TRACE); return mDeferredDepthStencilFormat;     }
+    inline bool             HasDeferredDepthClear(void)                 const   { FUN_ENTRY(GL_LOG_TRACE); return mDeferredClear.depth;            }
+    inline bool             HasDeferredStencilClear(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return mDeferredClear.stencil;          }
+    inline GLfloat          GetDeferredDepthClearValue(void)            const   { FUN_ENTRY(GL_LOG_TRACE); return mDeferredClear.depthValue;       }
+    inline uint32_t         GetDeferredStencilClearValue(void)          const   { FUN_ENTRY(GL_LOG_TRACE); return mDeferredClear.stencilValue;     }
     inline GLint            GetBindToTexture(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mBindToTexture;                  }
     inline GLint            GetSurfaceType(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mSurfaceType;                    }
+    inline const EGLSurfaceInterface *GetEGLSurfaceInterface(void)      const   { FUN_ENTRY(GL_LOG_TRACE); return mEGLSurfaceInterface;            }
 
 // Set Functions
     inline void             SetEGLSurfaceInterface(const EGLSurfaceInterface_t* eglSurfaceInterface) { FUN_ENTRY(GL_LOG_TRACE); mEGLSurfaceInterface = eglSurfaceInterface; }
@@ -165,37 +254,54 @@ public:
                             ObjectArray<Renderbuffer>       *rbArray)           { FUN_ENTRY(GL_LOG_TRACE); mTextureArray = texArray; mRenderbufferArray = rbArray; }
 
     inline void             SetUpdated(void)                                    { FUN_ENTRY(GL_LOG_TRACE); mUpdated     = true;   }
+    inline void             SetColorFetchEnabled(void)                          { FUN_ENTRY(GL_LOG_TRACE); mColorFetch  = true;   mUpdated = true; }
     inline void             SetIsSystem(void)                                   { FUN_ENTRY(GL_LOG_TRACE); mIsSystem    = true;   }
     inline void             SetStateIdle(void)                                  { FUN_ENTRY(GL_LOG_TRACE); mState       = IDLE;   }
     inline void             SetStateClear(void)                                 { FUN_ENTRY(GL_LOG_TRACE); mState       = CLEAR;  }
     inline void             SetStateClearDraw(void)                             { FUN_ENTRY(GL_LOG_TRACE); mState       = CLEAR_DRAW;  }
     inline void             SetStateDraw(void)                                  { FUN_ENTRY(GL_LOG_TRACE); mState       = DRAW;   }
     inline void             SetStateDelete(void)                                { FUN_ENTRY(GL_LOG_TRACE); mState       = IN_DELETE; }
+    inline void             SetLastUsedSerial(uint64_t serial)                  { FUN_ENTRY(GL_LOG_TRACE); mLastUsedSerial = serial; }
+    inline void             DiscardAttachments(bool color, bool depth, bool stencil) { FUN_ENTRY(GL_LOG_TRACE); mDiscarded.color |= color; mDiscarded.depth |= depth; mDiscarded.stencil |= stencil; }
+    /// anything written after a discard defines the contents again
+    inline void             ResetDiscardedAttachments(void)                     { FUN_ENTRY(GL_LOG_TRACE); mDiscarded.color = mDiscarded.depth = mDiscarded.stencil = false; }
     inline void             SetTarget(GLenum target)                            { FUN_ENTRY(GL_LOG_TRACE); mTarget      = target; }
     inline void             SetWidth(int32_t width)                             { FUN_ENTRY(GL_LOG_TRACE); mDims.width  = width;  }
     inline void             SetHeight(int32_t height)                           { FUN_ENTRY(GL_LOG_TRACE); mDims.height = height; }
 
            void             SetColorAttachment(int width, int height);
-    inline void             SetColorAttachmentType(GLenum type)                 { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetType(type);   }
-    inline void             SetColorAttachmentName(uint32_t name)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetName(name);   }
+    inline void             SetColorAttachmentType(GLenum type)                 { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetType(type);   InvalidateAttachments(); }
+    inline void             SetColorAttachmentName(uint32_t name)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetName(name);   InvalidateAttachments(); }
     inline void             SetColorAttachmentLevel(GLint level)                { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetLevel(level); }
     inline void             SetColorAttachmentLayer(GLenum layer)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetLayer(layer); }
+    inline void             SetColorAttachmentSamples(GLsizei samples)          { FUN_ENTRY(GL_LOG_TRACE); mAttachmentColors[0]->SetSamples(samples); mUpdated = true; InvalidateAttachments(); }
+           void             SetColorAttachmentViews(GLint baseViewIndex, GLsizei numViews);
 
-    inline void             SetDepthAttachmentName(uint32_t name)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentDepth->SetName(name);   mUpdated = true;}
-    inline void             SetDepthAttachmentType(GLenum type)                 { FUN_ENTRY(GL_LOG_TRACE); mAttachmentDepth->SetType(type);   }
+    inline void             SetDepthAttachmentName(uint32_t name)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentDepth->SetName(name);   mUpdated = true; InvalidateAttachments(); }
+    inline void             SetDepthAttachmentType(GLenum type)                 { FUN_ENTRY(GL_LOG_TRACE); mAttachmentDepth->SetType(type);   InvalidateAttachments(); }
     inline void             SetDepthAttachmentLevel(GLint level)                { FUN_ENTRY(GL_LOG_TRACE); mAttachmentDepth->SetLevel(level); }
     inline void             SetDepthAttachmentLayer(GLenum layer)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentDepth->SetLayer(layer); }
 
-    inline void             SetStencilAttachmentName(uint32_t name)             { FUN_ENTRY(GL_LOG_TRACE); mAttachmentStencil->SetName(name); mUpdated = true;}
-    inline void             SetStencilAttachmentType(GLenum type)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentStencil->SetType(type);   }
+    inline void             SetStencilAttachmentName(uint32_t name)             { FUN_ENTRY(GL_LOG_TRACE); mAttachmentStencil->SetName(name); mUpdated = true; InvalidateAttachments(); }
+    inline void             SetStencilAttachmentType(GLenum type)               { FUN_ENTRY(GL_LOG_TRACE); mAttachmentStencil->SetType(type);   InvalidateAttachments(); }
     inline void             SetStencilAttachmentLevel(GLint level)              { FUN_ENTRY(GL_LOG_TRACE); mAttachmentStencil->SetLevel(level); }
     inline void             SetStencilAttachmentLayer(GLenum layer)             { FUN_ENTRY(GL_LOG_TRACE); mAttachmentStencil->SetLayer(layer); }
 
     inline void             SetDepthStencilAttachmentTexture(Texture *texture)  { FUN_ENTRY(GL_LOG_TRACE); mDepthStencilTexture = texture; }
+    inline void             SetDeferredDepthStencilFormat(VkFormat format)      { FUN_ENTRY(GL_LOG_TRACE); mDeferredDepthStencilFormat = format; }
+    inline void             SetDeferredDepthClear(GLfloat value)                { FUN_ENTRY(GL_LOG_TRACE); mDeferredClear.depth   = true; mDeferredClear.depthValue   = value; }
+    inline void             SetDeferredStencilClear(uint32_t value)             { FUN_ENTRY(GL_LOG_TRACE); mDeferredClear.stencil = true; mDeferredClear.stencilValue = value; }
     inline void             SetBindToTexture(GLint bindToTexture)               { FUN_ENTRY(GL_LOG_TRACE); mBindToTexture = bindToTexture;      }
     inline void             SetSurfaceType(GLint surfacetype)                   { FUN_ENTRY(GL_LOG_TRACE); mSurfaceType = surfacetype;          }
+    inline void             SetPreRotation(uint32_t preRotation)                { FUN_ENTRY(GL_LOG_TRACE); mPreRotation = preRotation; mUpdated = true; }
+    inline void             SetDamageArea(const Rect *rect)                     { FUN_ENTRY(GL_LOG_TRACE); mHasDamageArea = rect != nullptr; if(rect) { mDamageArea = *rect; } }
 
     inline bool             IsSizeUpdated(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mSizeUpdated; }
+    /// user framebuffers are rendered without the Y flip, so that their textures keep the row order of uploaded ones,
+    /// and so are the pbuffers whose frames are not streamed to the host, which eglBindTexImage samples in place
+    inline bool             IsStoredUpright(void)                         const { FUN_ENTRY(GL_LOG_TRACE); return (!mIsSystem || (mSurfaceType == GLOVE_SURFACE_PBUFFER &&
+                                                                                                                              mEGLSurfaceInterface->readbackBuffers == nullptr)) &&
+                                                                                                                             mVkContext->mIsMaintenanceExtSupported; }
 
 // Is Functions
     inline bool             IsInIdleState(void)                                 { FUN_ENTRY(GL_LOG_TRACE); return (mState == IDLE); }
@@ -203,6 +309,10 @@ public:
     inline bool             IsInClearDrawState(void)                            { FUN_ENTRY(GL_LOG_TRACE); return (mState == CLEAR_DRAW); }
     inline bool             IsInDeleteState(void)                               { FUN_ENTRY(GL_LOG_TRACE); return (mState == IN_DELETE); }
     inline bool             IsInDrawState(void)                                 { FUN_ENTRY(GL_LOG_TRACE); return !IsInIdleState(); }
+    inline bool             IsColorFetchEnabled(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mColorFetch; }
+    inline bool             IsDepthStencilDeferred(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mDeferredDepthStencilFormat != VK_FORMAT_UNDEFINED; }
+    inline bool             IsPreRotated(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return mPreRotation != 0; }
+           bool             CanFetchColor(void)                         const;
 };
 
 #endif // __FRAMEBUFFER_H__
@@ -25,14 +25,49 @@
  *  and used to compute values for consumption by later processing stages.
  */
 
+#include <algorithm>
 #include "genericVertexAttribute.h"
 #include "utils/glUtils.h"
 
+/// a component as the device reads it from a format of its type, signed ones normalized as by Vulkan
+static GLfloat
+DecodeComponent(const uint8_t *src, GLenum type, bool normalized)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(type) {
+    case GL_BYTE:           { GLbyte   v; memcpy(&v, src, sizeof(v)); return normalized ? std::max(v / 127.0f, -1.0f)   : static_cast<GLfloat>(v); }
+    case GL_UNSIGNED_BYTE:  { GLubyte  v; memcpy(&v, src, sizeof(v)); return normalized ? v / 255.0f                    : static_cast<GLfloat>(v); }
+    case GL_SHORT:          { GLshort  v; memcpy(&v, src, sizeof(v)); return normalized ? std::max(v / 32767.0f, -1.0f) : static_cast<GLfloat>(v); }
+    case GL_UNSIGNED_SHORT: { GLushort v; memcpy(&v, src, sizeof(v)); return normalized ? v / 65535.0f                  : static_cast<GLfloat>(v); }
+    case GL_FIXED:          { GLfixed  v; memcpy(&v, src, sizeof(v)); return static_cast<GLfloat>(v) / 65536.0f; }
+    case GL_HALF_FLOAT_OES: { GLushort v; memcpy(&v, src, sizeof(v)); return GlHalfToFloat(v); }
+    case GL_FLOAT:          { GLfloat  v; memcpy(&v, src, sizeof(v)); return v; }
+    default:                NOT_FOUND_ENUM(type); return 0.0f;
+    }
+}
+
+/// a component of bits bits at shift within a packed element
+static GLfloat
+DecodePackedComponent(GLuint element, uint32_t shift, uint32_t bits, bool isSigned, bool normalized)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const GLuint  mask  = (1u << bits) - 1;
+    const GLint   value = isSigned ? static_cast<GLint>(element << (32 - shift - bits)) >> (32 - bits) :
+                                     static_cast<GLint>((element >> shift) & mask);
+    if(!normalized) {
+        return static_cast<GLfloat>(value);
+    }
+    return isSigned ? std::max(value / static_cast<GLfloat>(mask >> 1), -1.0f) : value / static_cast<GLfloat>(mask);
+}
+
 GenericVertexAttribute::GenericVertexAttribute()
-: mElements(4), mType(GL_FLOAT), mNormalized(false), mStride(0), mEnabled(false),
+: mElements(4), mType(GL_FLOAT), mNormalized(false), mStride(0), mDivisor(0), mEnabled(false),
   mOffset(0), mPtr(0),
   mInternalVbo(nullptr), mExternalVbo(nullptr),
-  mInternalVBOStatus(true), mCacheManager(nullptr)
+  mInternalVBOStatus(true), mCacheManager(nullptr),
+  mGenericValueDirty(true), mGenericValueRingOffset(0), mGenericValueRingSerial(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -49,127 +84,309 @@ GenericVertexAttribute::~GenericVertexAttribute()
     Release();
 }
 
-BufferObject*
-GenericVertexAttribute::UpdateVertexAttribute(uint32_t numVertices, bool& updatedVBO)
+bool
+GenericVertexAttribute::UpdateVertexAttribute(uint32_t firstVertex, uint32_t numVertices, uint32_t numInstances, VkBuffer *vkBuffer, VkDeviceSize *bindOffset)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    updatedVBO = false;
-
     // if disabled, use the generic vertex attribute value registered to that location
     // Otherwise, generate the appropriate vertex data
-    if(IsEnabled()) {
-        // Calculate stride if not given from user based on the actual data type
-        GLsizei stride = GetStride() > 0 ? GetStride() : GetNumElements() * GlAttribTypeToElementSize(GetType());
-        SetStride(stride);
+    if(!IsEnabled()) {
+        return StreamGenericValue(vkBuffer, bindOffset);
+    }
+
+    // Calculate stride if not given from user based on the actual data type
+    GLsizei stride = GetStride() > 0 ? GetStride() : static_cast<GLsizei>(GetElementSize());
+    SetStride(stride);
+
+    // Instanced arrays are read from their first element on, once per instance. Vulkan alone
+    // cannot advance an attribute every few instances, so those arrays are expanded to one
+    // element per instance instead.
+    if(GetDivisor() > 1) {
+        return StreamInstancedData(numInstances, vkBuffer, bindOffset);
+    }
+    if(GetDivisor() == 1) {
+        firstVertex = 0;
+        numVertices = numInstances;
+    }
 
-        // Create a vbo located on client-space (e.g, glVertexAttribPointer) or
-        // attach a vbo lotated on server-space (e.g., glBindBuffer)
-        return IsInternalVBO() ? GenerateUserSpaceVBO(numVertices, updatedVBO) : AttachDeviceSpaceVBO(numVertices, updatedVBO);
-     } else {
-        return UpdateGenericValueVBO(updatedVBO);
+    // Stream data located on client-space (e.g, glVertexAttribPointer) or
+    // attach a vbo lotated on server-space (e.g., glBindBuffer)
+    if(IsInternalVBO()) {
+        return StreamUserSpaceData(firstVertex, numVertices, vkBuffer, bindOffset);
+    }
+    BufferObject *vbo = AttachDeviceSpaceVBO();
+    if(vbo == nullptr) {
+        return false;
     }
+
+    // the attribute offset and the first vertex are applied through the binding offset, as for streamed data,
+    // converted copies begin with the first element of the attribute
+    *vkBuffer   = vbo->GetVkBuffer();
+    *bindOffset = vbo == mExternalVbo ? GetOffset() + static_cast<VkDeviceSize>(firstVertex) * GetStride() :
+                                        static_cast<VkDeviceSize>(firstVertex) * GetVkStride();
+    vbo->SetUsed(true);
+
+    return true;
 }
 
-BufferObject*
-GenericVertexAttribute::GenerateUserSpaceVBO(uint32_t numVertices, bool& updatedVBO)
+bool
+GenericVertexAttribute::StreamUserSpaceData(uint32_t firstVertex, uint32_t numVertices, VkBuffer *vkBuffer, VkDeviceSize *bindOffset)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    BufferObject *vbo = new VertexBufferObject(mVkContext);
-    void *srcData = reinterpret_cast<void*>(GetPointer());
-    size_t byteSize = numVertices * GetStride();
+    assert(numVertices);
 
-    // explicitly convert GL_FIXED to GL_FLOAT
-    if(GetType() != GL_FIXED) {
-        vbo->Allocate(byteSize, srcData);
-    }
-    else {
-        ConvertFixedBufferToFloat(vbo, byteSize, srcData, numVertices);
-    }
+    // only the vertices of the draw are copied, up to the last element read
+    const size_t stride    = static_cast<size_t>(GetStride());
+    size_t byteSize        = (numVertices - 1) * stride + GetElementSize();
+    const uint8_t *srcData = reinterpret_cast<const uint8_t *>(GetPointer()) + firstVertex * stride;
 
     SetOffset(0);
     SetInternalVBOStatus(true);
-    SetCurrentVbo(vbo);
-    updatedVBO = true;
-    return vbo;
+    SetCurrentVbo(nullptr);
+
+    // layouts the device cannot read are converted on their way into the ring, tightly packed
+    FrameArena::Scope scope(mCacheManager->GetFrameArena());
+    if(GetConversion() != VERTEX_CONVERSION_NONE) {
+        byteSize = numVertices * GetVkStride();
+        uint8_t *convertedData = static_cast<uint8_t *>(mCacheManager->GetFrameArena()->Allocate(byteSize, sizeof(GLuint)));
+        ConvertVertices(convertedData, srcData, stride, numVertices);
+        srcData = convertedData;
+    }
+
+    vulkanAPI::UniformRing *vertexRing = mCacheManager->GetVertexRing();
+    uint32_t ringOffset = 0;
+    if(!vertexRing->Allocate(byteSize, srcData, &ringOffset)) {
+        return false;
+    }
+
+    *vkBuffer   = vertexRing->GetVkBuffer();
+    *bindOffset = ringOffset;
+
+    return true;
+}
+
+bool
+GenericVertexAttribute::StreamInstancedData(uint32_t numInstances, VkBuffer *vkBuffer, VkDeviceSize *bindOffset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(numInstances);
+
+    // converted elements are expanded in the layout they are converted to
+    const bool   converted   = GetConversion() != VERTEX_CONVERSION_NONE;
+    const size_t stride      = static_cast<size_t>(GetStride());
+    const size_t elementSize = GetElementSize();
+    const size_t dstStride   = converted ? GetVkStride() : stride;
+    const size_t numElements = (numInstances + GetDivisor() - 1) / GetDivisor();
+    const size_t srcSize     = (numElements - 1) * stride + elementSize;
+    const size_t byteSize    = (numInstances - 1) * dstStride + (converted ? dstStride : elementSize);
+
+    FrameArena *arena = mCacheManager->GetFrameArena();
+    FrameArena::Scope scope(arena);
+
+    // the elements read are either in client space or in the shadow copy of the vbo
+    const uint8_t *srcData = reinterpret_cast<const uint8_t *>(GetPointer());
+    if(!IsInternalVBO()) {
+        if(GetOffset() + srcSize > mExternalVbo->GetSize()) {
+            return false;
+        }
+        uint8_t *vboData = arena->Allocate<uint8_t>(srcSize);
+        if(!mExternalVbo->GetData(srcSize, GetOffset(), vboData)) {
+            return false;
+        }
+        srcData = vboData;
+    }
+
+    uint8_t *dstData = static_cast<uint8_t *>(arena->Allocate(byteSize, sizeof(GLuint)));
+    for(size_t i = 0; i < numInstances; ++i) {
+        const uint8_t *element = srcData + (i / GetDivisor()) * stride;
+        if(converted) {
+            ConvertVertices(dstData + i * dstStride, element, stride, 1);
+        } else {
+            memcpy(dstData + i * dstStride, element, elementSize);
+        }
+    }
+
+    vulkanAPI::UniformRing *vertexRing = mCacheManager->GetVertexRing();
+    uint32_t ringOffset = 0;
+    if(!vertexRing->Allocate(byteSize, dstData, &ringOffset)) {
+        return false;
+    }
+
+    *vkBuffer   = vertexRing->GetVkBuffer();
+    *bindOffset = ringOffset;
+
+    return true;
 }
 
 BufferObject*
-GenericVertexAttribute::AttachDeviceSpaceVBO(uint32_t numVertices, bool& updatedVBO)
+GenericVertexAttribute::AttachDeviceSpaceVBO(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    BufferObject *vbo = mExternalVbo;
-    updatedVBO = false;
-    // explicitly convert GL_FIXED to GL_FLOAT from a buffer object
-    // NOTE: this is an inefficient operation and, thus, not a recommended good practice
-    if(GetType() == GL_FIXED) {
-        size_t byteSize = vbo->GetSize();
-        uint8_t *srcData = new uint8_t[byteSize];
-        vbo->GetData(byteSize, 0, srcData);
-        vbo = new VertexBufferObject(mVkContext);
-        ConvertFixedBufferToFloat(vbo, byteSize, srcData, numVertices);
-        delete[] srcData;
-        mCacheManager->CacheVBO(vbo);
-        updatedVBO = true;
+    if(GetConversion() == VERTEX_CONVERSION_NONE) {
+        return mExternalVbo;
+    }
+
+    // Layouts the device cannot read are converted from the attribute offset to the end of the
+    // buffer at once, and the copy is kept with the buffer until its contents change, rather
+    // than converted again with every draw.
+    const size_t stride      = static_cast<size_t>(GetStride());
+    const size_t elementSize = GetElementSize();
+    const size_t size        = mExternalVbo->GetSize();
+    if(GetOffset() + elementSize > size) {
+        return nullptr;
     }
+
+    const uint32_t format = (static_cast<uint32_t>(GetType()) << 8) | (static_cast<uint32_t>(GetNumElements()) << 1) | (GetNormalized() ? 1 : 0);
+    const BufferObject::VERTEX_CONVERSION_KEY key(GetOffset(), GetStride(), format);
+    BufferObject *vbo = mExternalVbo->GetConvertedVertexBuffer(key);
+    if(vbo != nullptr) {
+        return vbo;
+    }
+
+    const size_t numVertices = (size - GetOffset() - elementSize) / stride + 1;
+    const size_t srcSize     = (numVertices - 1) * stride + elementSize;
+    const size_t byteSize    = numVertices * GetVkStride();
+
+    FrameArena *arena = mCacheManager->GetFrameArena();
+    FrameArena::Scope scope(arena);
+    uint8_t *srcData = arena->Allocate<uint8_t>(srcSize);
+    uint8_t *dstData = static_cast<uint8_t *>(arena->Allocate(byteSize, sizeof(GLuint)));
+    if(!mExternalVbo->GetData(srcSize, GetOffset(), srcData)) {
+        return nullptr;
+    }
+    ConvertVertices(dstData, srcData, stride, numVertices);
+
+    vbo = new VertexBufferObject(mVkContext);
+    if(!vbo->Allocate(byteSize, dstData)) {
+        delete vbo;
+        return nullptr;
+    }
+    mExternalVbo->SetConvertedVertexBuffer(key, vbo);
+
     return vbo;
 }
 
-BufferObject*
-GenericVertexAttribute::UpdateGenericValueVBO(bool& updatedVBO)
+bool
+GenericVertexAttribute::StreamGenericValue(VkBuffer *vkBuffer, VkDeviceSize *bindOffset)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // TODO: do not recreate the VBO
-    BufferObject *vbo = new VertexBufferObject(mVkContext);
-    GLfloat genericValue[4];
-    GetGenericValue(genericValue);
-    vbo->Allocate(4 * sizeof(float), static_cast<const void *>(genericValue));
     SetNumElements(4);
     SetType(GL_FLOAT);
     SetStride(0);
+    SetOffset(0);
     SetInternalVBOStatus(true);
-    SetCurrentVbo(vbo);
-    updatedVBO = true;
-    return vbo;
+    SetCurrentVbo(nullptr);
+
+    // the value is written once into the vertex ring and bound with a zero stride, until either
+    // it changes or the ring moves on to another frame, so that its layout never changes
+    vulkanAPI::UniformRing *vertexRing = mCacheManager->GetVertexRing();
+    if(mGenericValueDirty || mGenericValueRingSerial != vertexRing->GetSerial()) {
+        if(!vertexRing->Allocate(sizeof(mGenericValue), mGenericValue, &mGenericValueRingOffset)) {
+            return false;
+        }
+        mGenericValueRingSerial = vertexRing->GetSerial();
+        mGenericValueDirty      = false;
+    }
+
+    *vkBuffer   = vertexRing->GetVkBuffer();
+    *bindOffset = mGenericValueRingOffset;
+
+    return true;
+}
+
+GenericVertexAttribute::VertexConversion_t
+GenericVertexAttribute::GetConversion(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // GL_FIXED has no Vulkan format at all, and the packed types are read once repacked
+    const VkFormat format = GlAttribPointerToVkFormat(mElements, mType, mNormalized);
+    const bool supported  = mVkContext == nullptr ||
+                            (static_cast<size_t>(format) < mVkContext->vkVertexFormats.size() && mVkContext->vkVertexFormats[format]);
+    if(mType == GL_FIXED || !supported) {
+        return VERTEX_CONVERSION_FLOAT;
+    }
+
+    return mType == GL_UNSIGNED_INT_10_10_10_2_OES || mType == GL_INT_10_10_10_2_OES ? VERTEX_CONVERSION_REPACK : VERTEX_CONVERSION_NONE;
+}
+
+size_t
+GenericVertexAttribute::GetElementSize(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const size_t typeSize = static_cast<size_t>(GlAttribTypeToElementSize(mType));
+    return mType == GL_UNSIGNED_INT_10_10_10_2_OES || mType == GL_INT_10_10_10_2_OES ? typeSize : mElements * typeSize;
+}
+
+VkFormat
+GenericVertexAttribute::GetVkFormat(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return GetConversion() == VERTEX_CONVERSION_FLOAT ? GlAttribPointerToVkFormat(mElements, GL_FLOAT, GL_FALSE) :
+                                                        GlAttribPointerToVkFormat(mElements, mType, mNormalized);
+}
+
+uint32_t
+GenericVertexAttribute::GetVkStride(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(GetConversion()) {
+    case VERTEX_CONVERSION_REPACK:  return sizeof(GLuint);
+    case VERTEX_CONVERSION_FLOAT:   return static_cast<uint32_t>(mElements * sizeof(GLfloat));
+    default:                        return static_cast<uint32_t>(mStride);
+    }
 }
 
 void
-GenericVertexAttribute::ConvertFixedBufferToFloat(BufferObject* vbo, size_t byteSize,
-                                                  void *srcData, size_t numVertices)
+GenericVertexAttribute::ConvertVertices(uint8_t *dstData, const uint8_t *srcData, size_t srcStride, size_t numVertices) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    const uint8_t* srcBuffer = static_cast<const uint8_t*>(srcData);
-    uint8_t* dstBuffer = new uint8_t[byteSize];
-
-    // this is needed to preserve data in case the buffer contains
-    // other data as well. For efficiency it can be commented out.
-    memcpy(dstBuffer, srcBuffer, byteSize);
+    const size_t numElements = static_cast<size_t>(mElements);
+    const bool   normalized  = mNormalized == GL_TRUE;
+    const bool   packed      = mType == GL_UNSIGNED_INT_10_10_10_2_OES || mType == GL_INT_10_10_10_2_OES;
+    const bool   isSigned    = mType == GL_INT_10_10_10_2_OES;
 
-    // move the buffers by the corresponding offset (if any)
-    const size_t offset = GetOffset();
-    const size_t numElements = static_cast<size_t>(GetNumElements());
-    const size_t stride = static_cast<size_t>(GetStride());
+    // x, y, z and w from the most significant bits down become x, y, z and w from the least
+    // significant ones up, a missing w is set to the bits read as 1
+    if(GetConversion() == VERTEX_CONVERSION_REPACK) {
+        const GLuint one = normalized && !isSigned ? 3 : 1;
+        for(size_t ver = 0; ver < numVertices; ++ver) {
+            GLuint src;
+            memcpy(&src, srcData + ver * srcStride, sizeof(GLuint));
+            const GLuint dst = ((src >> 22) & 0x3ff) | (((src >> 12) & 0x3ff) << 10) | (((src >> 2) & 0x3ff) << 20) |
+                               ((numElements == 4 ? src & 0x3 : one) << 30);
+            memcpy(dstData + ver * sizeof(GLuint), &dst, sizeof(GLuint));
+        }
+        return;
+    }
 
+    const size_t typeSize = static_cast<size_t>(GlAttribTypeToElementSize(mType));
+    GLfloat *dst = reinterpret_cast<GLfloat *>(dstData);
     for(size_t ver = 0; ver < numVertices; ++ver) {
-        size_t vertexIndex = offset + ver * stride;
-        for(size_t el = 0; el < numElements; ++el) {
-            size_t srcIndex = vertexIndex + el * sizeof(GLfixed);
-            size_t dstIndex = vertexIndex + el * sizeof(float);
-            const GLfixed* val = reinterpret_cast<const GLfixed*>(&srcBuffer[srcIndex]);
-            float fval = static_cast<float>(*val) / float(1<<16);
-            uint8_t* fvalp = reinterpret_cast<uint8_t*>(&fval);
-            for(size_t b = 0; b < sizeof(GLfloat); ++b) {
-                dstBuffer[dstIndex + b] = fvalp[b];
+        const uint8_t *src = srcData + ver * srcStride;
+        if(packed) {
+            GLuint element;
+            memcpy(&element, src, sizeof(GLuint));
+            for(size_t el = 0; el < numElements; ++el) {
+                dst[el] = el < 3 ? DecodePackedComponent(element, static_cast<uint32_t>(22 - 10 * el), 10, isSigned, normalized) :
+                                   DecodePackedComponent(element, 0, 2, isSigned, normalized);
+            }
+        } else {
+            for(size_t el = 0; el < numElements; ++el) {
+                dst[el] = DecodeComponent(src + el * typeSize, mType, normalized);
             }
         }
+        dst += numElements;
     }
-
-    vbo->Allocate(byteSize, dstBuffer);
-    delete[] dstBuffer;
 }
 
 void
@@ -30,11 +30,19 @@
 
 class GenericVertexAttribute {
 private:
+    /// how the elements are brought into a layout the device reads
+    typedef enum {
+        VERTEX_CONVERSION_NONE = 0,
+        VERTEX_CONVERSION_REPACK,
+        VERTEX_CONVERSION_FLOAT
+    } VertexConversion_t;
+
     const vulkanAPI::vkContext_t *      mVkContext;
     GLint                               mElements;
     GLenum                              mType;
     GLboolean                           mNormalized;
     GLsizei                             mStride;
+    GLuint                              mDivisor;
     GLfloat                             mGenericValue[4];
     bool                                mEnabled;
 
@@ -45,15 +53,24 @@ private:
     bool                                mInternalVBOStatus;
     CacheManager                       *mCacheManager;
 
+    /// where the generic value was last written into the vertex ring
+    bool                                mGenericValueDirty;
+    uint32_t                            mGenericValueRingOffset;
+    uint64_t                            mGenericValueRingSerial;
+
+    VertexConversion_t                  GetConversion(void)               const;
+    size_t                              GetElementSize(void)              const;
+    void                                ConvertVertices(uint8_t *dstData, const uint8_t *srcData, size_t srcStride, size_t numVertices) const;
+
 public:
     GenericVertexAttribute();
     ~GenericVertexAttribute();
 
-    void                                ConvertFixedBufferToFloat(BufferObject* vbo, size_t byteSize, void *srcData, size_t numVertices);
-    BufferObject                       *UpdateVertexAttribute(uint32_t numVertices, bool &updatedVBO);
-    BufferObject                       *UpdateGenericValueVBO(bool &updatedVBO);
-    BufferObject                       *GenerateUserSpaceVBO(uint32_t numVertices, bool &updatedVBO);
-    BufferObject                       *AttachDeviceSpaceVBO(uint32_t numVertices, bool &updatedVBO);
+    bool                                UpdateVertexAttribute(uint32_t firstVertex, uint32_t numVertices, uint32_t numInstances, VkBuffer *vkBuffer, VkDeviceSize *bindOffset);
+    bool                                StreamGenericValue(VkBuffer *vkBuffer, VkDeviceSize *bindOffset);
+    bool                                StreamUserSpaceData(uint32_t firstVertex, uint32_t numVertices, VkBuffer *vkBuffer, VkDeviceSize *bindOffset);
+    bool                                StreamInstancedData(uint32_t numInstances, VkBuffer *vkBuffer, VkDeviceSize *bindOffset);
+    BufferObject                       *AttachDeviceSpaceVBO(void);
 
     // Release Functions
     void                                Release(void);
@@ -64,12 +81,14 @@ public:
     inline GLenum                       GetType(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mType;       }
     inline GLboolean                    GetNormalized(void)               const { FUN_ENTRY(GL_LOG_TRACE); return mNormalized; }
     inline GLsizei                      GetStride(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mStride;     }
+    inline GLuint                       GetDivisor(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mDivisor;    }
     inline uint32_t                     GetOffset(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return
                                                                                                 static_cast<uint32_t>(mOffset);}
     inline uintptr_t                    GetPointer(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mPtr;        }
     inline const BufferObject *         GetExternalVbo(void)              const { FUN_ENTRY(GL_LOG_TRACE); return mExternalVbo;}
 
-    inline VkFormat                     GetVkFormat(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return GlAttribPointerToVkFormat(mElements, mType, mNormalized); }
+    VkFormat                            GetVkFormat(void)                 const;
+    uint32_t                            GetVkStride(void)                 const;
     inline bool                         IsInternalVBO(void)        const { FUN_ENTRY(GL_LOG_TRACE); return mInternalVBOStatus;}
     inline void                         GetGenericValue(GLint *ptr)       const { FUN_ENTRY(GL_LOG_TRACE); ptr[0] = static_cast<GLint>(mGenericValue[0]);
                                                                                                            ptr[1] = static_cast<GLint>(mGenericValue[1]);
@@ -89,6 +108,7 @@ public:
     inline void                         SetType(GLenum type)                        { FUN_ENTRY(GL_LOG_TRACE); mType            = type;        }
     inline void                         SetNormalized(GLboolean normalized)         { FUN_ENTRY(GL_LOG_TRACE); mNormalized      = normalized;  }
     inline void                         SetStride(GLsizei stride)                   { FUN_ENTRY(GL_LOG_TRACE); mStride          = stride;      }
+    inline void                         SetDivisor(GLuint divisor)                  { FUN_ENTRY(GL_LOG_TRACE); mDivisor         = divisor;     }
     inline void                         SetOffset(uintptr_t offset)                 { FUN_ENTRY(GL_LOG_TRACE); mOffset          = offset;      }
     inline void                         SetPointer(uintptr_t ptr)                   { FUN_ENTRY(GL_LOG_TRACE); mPtr             = ptr;         }
     inline void                         SetInternalVBOStatus(bool internalVBO)      { FUN_ENTRY(GL_LOG_TRACE); mInternalVBOStatus     = internalVBO; }
@@ -96,7 +116,8 @@ public:
     inline void                         SetGenericValue(const GLfloat *ptr)         { FUN_ENTRY(GL_LOG_TRACE); mGenericValue[0] = ptr[0];
                                                                                                                mGenericValue[1] = ptr[1];
                                                                                                                mGenericValue[2] = ptr[2];
-                                                                                                               mGenericValue[3] = ptr[3]; }
+                                                                                                               mGenericValue[3] = ptr[3];
+                                                                                                               mGenericValueDirty = true; }
 };
 
 #endif // __GENERICVERTEXATTRIBUTE_H__
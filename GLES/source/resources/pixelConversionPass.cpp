@@ -0,0 +1,405 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pixelConversionPass.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Conversion of uploaded pixels to RGBA8 by a compute dispatch over the staging ring
+ *
+ *  @scope
+ *
+ *  Formats without a Vulkan counterpart are expanded to RGBA8 before they are
+ *  copied to their image. Large images are staged as they are given, and a
+ *  compute kernel recorded into the upload batch unpacks them into another
+ *  part of the staging ring, which the copy to the image then reads. The
+ *  kernel unpacks every pixel the same way the host conversion does in
+ *  Color, so that both give identical texels.
+ *
+ */
+
+#include "pixelConversionPass.h"
+#include "vulkan/hostAllocator.h"
+#include "glslang/glslangShaderCompiler.h"
+
+std::vector<uint32_t> PixelConversionPass::mKernelSpv;
+std::once_flag        PixelConversionPass::mKernelCompiled;
+
+static const char *pixelConversionKernel =
+"#version 310 es\n"
+"layout(local_size_x = 64) in;\n"
+"layout(std430, set = 0, binding = 0) buffer StagingRing { uint words[]; } ring;\n"
+"layout(push_constant) uniform Params {\n"
+"    uint srcOffset;\n"
+"    uint srcRowPitch;\n"
+"    uint dstOffset;\n"
+"    uint width;\n"
+"    uint height;\n"
+"    uint conversion;\n"
+"} params;\n"
+"uint ReadByte(uint offset) { return (ring.words[offset >> 2u] >> ((offset & 3u) << 3u)) & 0xFFu; }\n"
+"uint ReadShort(uint offset) { return ReadByte(offset) | (ReadByte(offset + 1u) << 8u); }\n"
+"void main() {\n"
+"    uint pixel = gl_GlobalInvocationID.x;\n"
+"    if(pixel >= params.width * params.height) { return; }\n"
+"    uint src = params.srcOffset + (pixel / params.width) * params.srcRowPitch;\n"
+"    uint x = pixel % params.width;\n"
+"    uint r = 0u, g = 0u, b = 0u, a = 0xFFu, v;\n"
+"    switch(params.conversion) {\n"
+"    case 0u:\n"
+"        src += x * 3u; r = ReadByte(src); g = ReadByte(src + 1u); b = ReadByte(src + 2u);\n"
+"        break;\n"
+"    case 1u:\n"
+"        v = ReadShort(src + x * 2u);\n"
+"        r = (v & 0xF800u) >> 8u; g = (v & 0x07E0u) >> 3u; b = (v & 0x001Fu) << 3u;\n"
+"        r |= r >> 5u; g |= g >> 6u; b |= b >> 5u;\n"
+"        break;\n"
+"    case 2u:\n"
+"        v = ReadShort(src + x * 2u);\n"
+"        r = (v >> 12u) & 0xFu; g = (v >> 8u) & 0xFu; b = (v >> 4u) & 0xFu; a = v & 0xFu;\n"
+"        r |= r << 4u; g |= g << 4u; b |= b << 4u; a |= a << 4u;\n"
+"        break;\n"
+"    case 3u:\n"
+"        v = ReadShort(src + x * 2u);\n"
+"        r = (v & 0xF800u) >> 8u; g = (v & 0x07C0u) >> 3u; b = (v & 0x003Eu) << 2u; a = (v & 0x0001u) << 7u;\n"
+"        r |= r >> 5u; g |= g >> 5u; b |= b >> 5u; if(a != 0u) { a |= 0x7Fu; }\n"
+"        break;\n"
+"    case 4u:\n"
+"        r = g = b = ReadByte(src + x);\n"
+"        break;\n"
+"    case 5u:\n"
+"        src += x * 2u; r = g = b = ReadByte(src); a = ReadByte(src + 1u);\n"
+"        break;\n"
+"    default:\n"
+"        a = ReadByte(src + x);\n"
+"        break;\n"
+"    }\n"
+"    ring.words[(params.dstOffset >> 2u) + pixel] = r | (g << 8u) | (b << 16u) | (a << 24u);\n"
+"}\n";
+
+PixelConversionPass::PixelConversionPass(const vulkanAPI::vkContext_t *vkContext)
+: mVkContext(vkContext), mVkDescriptorSetLayout(VK_NULL_HANDLE), mVkPipelineLayout(VK_NULL_HANDLE),
+  mVkPipeline(VK_NULL_HANDLE), mVkDescriptorPool(VK_NULL_HANDLE), mVkDescriptorSet(VK_NULL_HANDLE),
+  mVkStagingRing(VK_NULL_HANDLE), mFailed(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+PixelConversionPass::~PixelConversionPass()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+void
+PixelConversionPass::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(mVkContext->vkDevice, mVkPipeline, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        mVkPipeline = VK_NULL_HANDLE;
+    }
+
+    if(mVkPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(mVkContext->vkDevice, mVkPipelineLayout, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        mVkPipelineLayout = VK_NULL_HANDLE;
+    }
+
+    // the set goes along with its pool
+    if(mVkDescriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(mVkContext->vkDevice, mVkDescriptorPool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+        mVkDescriptorPool = VK_NULL_HANDLE;
+        mVkDescriptorSet  = VK_NULL_HANDLE;
+    }
+
+    if(mVkDescriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(mVkContext->vkDevice, mVkDescriptorSetLayout, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+        mVkDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+
+    mVkStagingRing = VK_NULL_HANDLE;
+}
+
+void
+PixelConversionPass::CompileKernel(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ShaderCompiler *shaderCompiler = new GlslangShaderCompiler();
+    if(!shaderCompiler->CompileKernel(pixelConversionKernel, mKernelSpv)) {
+        mKernelSpv.clear();
+    }
+    delete shaderCompiler;
+}
+
+PixelConversionPass::PixelConversion_t
+PixelConversionPass::GetConversion(GLenum srcFormat, GLenum dstFormat)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the pairs that ConvertPixels expands to RGBA8
+    const bool rgba = (dstFormat == GL_RGBA || dstFormat == GL_RGBA8_OES);
+    switch(srcFormat) {
+    case GL_RGB:
+    case GL_RGB8_OES:           return dstFormat == GL_RGBA8_OES ? PIXEL_CONVERSION_RGB8 : PIXEL_CONVERSION_INVALID;
+    case GL_RGB565:             return rgba ? PIXEL_CONVERSION_RGB565          : PIXEL_CONVERSION_INVALID;
+    case GL_RGBA4:              return rgba ? PIXEL_CONVERSION_RGBA4           : PIXEL_CONVERSION_INVALID;
+    case GL_RGB5_A1:            return rgba ? PIXEL_CONVERSION_RGB5_A1         : PIXEL_CONVERSION_INVALID;
+    case GL_LUMINANCE:          return rgba ? PIXEL_CONVERSION_LUMINANCE       : PIXEL_CONVERSION_INVALID;
+    case GL_LUMINANCE_ALPHA:    return rgba ? PIXEL_CONVERSION_LUMINANCE_ALPHA : PIXEL_CONVERSION_INVALID;
+    case GL_ALPHA:              return rgba ? PIXEL_CONVERSION_ALPHA           : PIXEL_CONVERSION_INVALID;
+    default:                    return PIXEL_CONVERSION_INVALID;
+    }
+}
+
+uint32_t
+PixelConversionPass::GetSourcePixelSize(PixelConversion_t conversion)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(conversion) {
+    case PIXEL_CONVERSION_RGB8:             return 3;
+    case PIXEL_CONVERSION_RGB565:
+    case PIXEL_CONVERSION_RGBA4:
+    case PIXEL_CONVERSION_RGB5_A1:
+    case PIXEL_CONVERSION_LUMINANCE_ALPHA:  return 2;
+    case PIXEL_CONVERSION_LUMINANCE:
+    case PIXEL_CONVERSION_ALPHA:            return 1;
+    default:                                return 0;
+    }
+}
+
+bool
+PixelConversionPass::Create(VkBuffer stagingRing)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::call_once(mKernelCompiled, CompileKernel);
+    if(mKernelSpv.empty()) {
+        return false;
+    }
+
+    VkDescriptorSetLayoutBinding binding;
+    binding.binding            = 0;
+    binding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount    = 1;
+    binding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+    binding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo;
+    layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext        = nullptr;
+    layoutInfo.flags        = 0;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings    = &binding;
+
+    if(vkCreateDescriptorSetLayout(mVkContext->vkDevice, &layoutInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &mVkDescriptorSetLayout) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkPushConstantRange pushConstantRange;
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset     = 0;
+    pushConstantRange.size       = sizeof(PushConstants_t);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo;
+    pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pNext                  = nullptr;
+    pipelineLayoutInfo.flags                  = 0;
+    pipelineLayoutInfo.setLayoutCount         = 1;
+    pipelineLayoutInfo.pSetLayouts            = &mVkDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+    if(vkCreatePipelineLayout(mVkContext->vkDevice, &pipelineLayoutInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &mVkPipelineLayout) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkShaderModuleCreateInfo moduleInfo;
+    moduleInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.pNext    = nullptr;
+    moduleInfo.flags    = 0;
+    moduleInfo.codeSize = mKernelSpv.size() * sizeof(uint32_t);
+    moduleInfo.pCode    = mKernelSpv.data();
+
+    VkShaderModule module;
+    if(vkCreateShaderModule(mVkContext->vkDevice, &moduleInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &module) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo;
+    pipelineInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext                     = nullptr;
+    pipelineInfo.flags                     = 0;
+    pipelineInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.pNext               = nullptr;
+    pipelineInfo.stage.flags               = 0;
+    pipelineInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module              = module;
+    pipelineInfo.stage.pName               = "main";
+    pipelineInfo.stage.pSpecializationInfo = nullptr;
+    pipelineInfo.layout                    = mVkPipelineLayout;
+    pipelineInfo.basePipelineHandle        = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex         = -1;
+
+    // the pipeline is kept in the pipeline cache of the device, as the ones of the programs are
+    VkResult err = vkCreateComputePipelines(mVkContext->vkDevice, mVkContext->vkPipelineCache, 1, &pipelineInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &mVkPipeline);
+    vkDestroyShaderModule(mVkContext->vkDevice, module, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+    if(err != VK_SUCCESS) {
+        mVkPipeline = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkDescriptorPoolSize poolSize;
+    poolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo;
+    poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.pNext         = nullptr;
+    poolInfo.flags         = 0;
+    poolInfo.maxSets       = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes    = &poolSize;
+
+    if(vkCreateDescriptorPool(mVkContext->vkDevice, &poolInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &mVkDescriptorPool) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo;
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.pNext              = nullptr;
+    allocInfo.descriptorPool     = mVkDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts        = &mVkDescriptorSetLayout;
+
+    if(vkAllocateDescriptorSets(mVkContext->vkDevice, &allocInfo, &mVkDescriptorSet) != VK_SUCCESS) {
+        return false;
+    }
+
+    // the whole ring is bound once, every dispatch addresses its part of it through the push constants
+    VkDescriptorBufferInfo bufferInfo;
+    bufferInfo.buffer = stagingRing;
+    bufferInfo.offset = 0;
+    bufferInfo.range  = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet write;
+    write.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.pNext            = nullptr;
+    write.dstSet           = mVkDescriptorSet;
+    write.dstBinding       = 0;
+    write.dstArrayElement  = 0;
+    write.descriptorCount  = 1;
+    write.descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pImageInfo       = nullptr;
+    write.pBufferInfo      = &bufferInfo;
+    write.pTexelBufferView = nullptr;
+
+    vkUpdateDescriptorSets(mVkContext->vkDevice, 1, &write, 0, nullptr);
+
+    mVkStagingRing = stagingRing;
+
+    return true;
+}
+
+bool
+PixelConversionPass::CanConvert(GLenum srcFormat, GLenum dstFormat, const ImageRect *srcRect, const ImageRect *dstRect) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const PixelConversion_t conversion = GetConversion(srcFormat, dstFormat);
+    const uint32_t width  = static_cast<uint32_t>(dstRect->width);
+    const uint32_t height = static_cast<uint32_t>(dstRect->height);
+
+    return !mFailed && conversion != PIXEL_CONVERSION_INVALID &&
+           (mVkContext->vkTransferQueueFlags & VK_QUEUE_COMPUTE_BIT) &&
+           dstRect->GetRectBufferSize() >= GLOVE_DEVICE_PIXEL_CONVERSION_SIZE &&
+           dstRect->GetPixelByteOffset() == 4 && dstRect->GetRectAlignedRowInBytes() == width * 4 &&
+           srcRect->GetPixelByteOffset() == GetSourcePixelSize(conversion) &&
+           static_cast<uint32_t>(srcRect->width) == width && static_cast<uint32_t>(srcRect->height) == height;
+}
+
+VkBuffer
+PixelConversionPass::Convert(vulkanAPI::UploadManager *uploadManager, GLenum srcFormat, GLenum dstFormat,
+                             const ImageRect *srcRect, const void *srcData, const ImageRect *dstRect, VkDeviceSize *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the kernel runs on the queue of the uploads, ahead of the copy to the image
+    const PixelConversion_t conversion = GetConversion(srcFormat, dstFormat);
+    const uint32_t width  = static_cast<uint32_t>(dstRect->width);
+    const uint32_t height = static_cast<uint32_t>(dstRect->height);
+    if(!CanConvert(srcFormat, dstFormat, srcRect, dstRect)) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkBuffer stagingRing = uploadManager->GetStagingRingBuffer();
+    if(stagingRing == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    if(mVkStagingRing != stagingRing) {
+        Release();
+        if(!Create(stagingRing)) {
+            Release();
+            mFailed = true;
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    // both the pixels as given and the converted ones have to fit in the ring
+    const VkDeviceSize srcSize = srcRect->GetRectBufferSize();
+    const VkDeviceSize dstSize = dstRect->GetRectBufferSize();
+    VkDeviceSize srcOffset = 0;
+    VkDeviceSize dstOffset = 0;
+    if(uploadManager->AllocateStagingRing(srcSize, srcData, 4, &srcOffset) == VK_NULL_HANDLE ||
+       uploadManager->AllocateStagingRing(dstSize, nullptr, 4, &dstOffset) == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkCommandBuffer *cmdBuffer = uploadManager->GetVkUploadCommandBuffer();
+    if(!cmdBuffer) {
+        return VK_NULL_HANDLE;
+    }
+
+    PushConstants_t params;
+    params.srcOffset   = static_cast<uint32_t>(srcOffset);
+    params.srcRowPitch = srcRect->GetRectAlignedRowInBytes();
+    params.dstOffset   = static_cast<uint32_t>(dstOffset);
+    params.width       = width;
+    params.height      = height;
+    params.conversion  = static_cast<uint32_t>(conversion);
+
+    vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mVkPipeline);
+    vkCmdBindDescriptorSets(*cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mVkPipelineLayout, 0, 1, &mVkDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(*cmdBuffer, mVkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(*cmdBuffer, (width * height + GLOVE_PIXEL_CONVERSION_GROUP_SIZE - 1) / GLOVE_PIXEL_CONVERSION_GROUP_SIZE, 1, 1);
+
+    // the copy to the image reads what the kernel wrote
+    VkMemoryBarrier memoryBarrier;
+    memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.pNext         = nullptr;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(*cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    *offset = dstOffset;
+
+    return stagingRing;
+}
@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pixelConversionPass.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Conversion of uploaded pixels to RGBA8 by a compute dispatch over the staging ring
+ *
+ */
+
+#ifndef __PIXELCONVERSIONPASS_H__
+#define __PIXELCONVERSIONPASS_H__
+
+#include <mutex>
+#include <vector>
+#include "utils/glUtils.h"
+#include "utils/glLogger.h"
+#include "vulkan/context.h"
+#include "vulkan/uploadManager.h"
+#include "rect.h"
+
+/// Converted images at least this large (in bytes) are converted on the device instead of the host
+#define GLOVE_DEVICE_PIXEL_CONVERSION_SIZE              (256 * 1024)
+
+/// Invocations of a work group of the conversion kernel, one per pixel
+#define GLOVE_PIXEL_CONVERSION_GROUP_SIZE               64
+
+class PixelConversionPass {
+private:
+
+    /// source layouts the kernel unpacks, in the order of its switch
+    typedef enum {
+        PIXEL_CONVERSION_RGB8 = 0,
+        PIXEL_CONVERSION_RGB565,
+        PIXEL_CONVERSION_RGBA4,
+        PIXEL_CONVERSION_RGB5_A1,
+        PIXEL_CONVERSION_LUMINANCE,
+        PIXEL_CONVERSION_LUMINANCE_ALPHA,
+        PIXEL_CONVERSION_ALPHA,
+        PIXEL_CONVERSION_INVALID
+    } PixelConversion_t;
+
+    typedef struct PushConstants_t {
+        uint32_t                    srcOffset;
+        uint32_t                    srcRowPitch;
+        uint32_t                    dstOffset;
+        uint32_t                    width;
+        uint32_t                    height;
+        uint32_t                    conversion;
+    } PushConstants_t;
+
+    /// the kernel is compiled once for all the contexts
+    static std::vector<uint32_t>    mKernelSpv;
+    static std::once_flag           mKernelCompiled;
+
+    const
+    vulkanAPI::vkContext_t         *mVkContext;
+
+    VkDescriptorSetLayout           mVkDescriptorSetLayout;
+    VkPipelineLayout                mVkPipelineLayout;
+    VkPipeline                      mVkPipeline;
+    VkDescriptorPool                mVkDescriptorPool;
+    VkDescriptorSet                 mVkDescriptorSet;
+
+    /// the staging ring the descriptor set refers to, both for the source and the converted pixels
+    VkBuffer                        mVkStagingRing;
+    bool                            mFailed;
+
+    static void                     CompileKernel(void);
+    static PixelConversion_t        GetConversion(GLenum srcFormat, GLenum dstFormat);
+    static uint32_t                 GetSourcePixelSize(PixelConversion_t conversion);
+    bool                            Create(VkBuffer stagingRing);
+
+public:
+// Constructor
+    PixelConversionPass(const vulkanAPI::vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~PixelConversionPass();
+
+// Release Functions
+    void                            Release(void);
+
+// Convert Functions
+    bool                            CanConvert(GLenum srcFormat, GLenum dstFormat, const ImageRect *srcRect, const ImageRect *dstRect) const;
+    VkBuffer                        Convert(vulkanAPI::UploadManager *uploadManager, GLenum srcFormat, GLenum dstFormat,
+                                            const ImageRect *srcRect, const void *srcData, const ImageRect *dstRect, VkDeviceSize *offset);
+};
+
+#endif // __PIXELCONVERSIONPASS_H__
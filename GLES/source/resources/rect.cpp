@@ -27,8 +27,22 @@
  *
  */
 
+#include <cstring>
+#include <functional>
+#include <vector>
 #include "rect.h"
 #include "utils/glLogger.h"
+#include "utils/glUtils.h"
+#include "utils/workerPool.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define GLOVE_PIXEL_KERNELS_NEON                     1
+#   include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#   define GLOVE_PIXEL_KERNELS_SSSE3                    1
+#   include <immintrin.h>
+#   include <tmmintrin.h>
+#endif
 
 Rect::Rect(int _x, int _y, int _width, int _height)
 : x(_x), y(_y), width(_width), height(_height)
@@ -117,16 +131,449 @@ InvertImageYAxis(uint8_t *image, const ImageRect* rect)
     delete[] tmpRow;
 }
 
+// row kernels for the most frequent conversions, chosen once per process
+typedef void (*ConvertRowFunPtr)(const uint8_t *srcRow, uint8_t *dstRow, int width);
+
+typedef struct RowKernels_t {
+    ConvertRowFunPtr swizzleRB;                 // RGBA <-> BGRA
+    ConvertRowFunPtr expandRGBToRGBA;
+    ConvertRowFunPtr packRGBAToRGB;
+    ConvertRowFunPtr halfToFloat;               // RGBA16F -> RGBA32F
+    ConvertRowFunPtr floatToHalf;               // RGBA32F -> RGBA16F
+    ConvertRowFunPtr halfToUnorm;               // RGBA16F -> RGBA8
+} RowKernels_t;
+
+static void
+SwizzleRowRB(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int col = 0; col < width; ++col) {
+        dstRow[0] = srcRow[2];
+        dstRow[1] = srcRow[1];
+        dstRow[2] = srcRow[0];
+        dstRow[3] = srcRow[3];
+        srcRow += 4;
+        dstRow += 4;
+    }
+}
+
+static void
+ExpandRowRGBToRGBA(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int col = 0; col < width; ++col) {
+        dstRow[0] = srcRow[0];
+        dstRow[1] = srcRow[1];
+        dstRow[2] = srcRow[2];
+        dstRow[3] = 0xff;
+        srcRow += 3;
+        dstRow += 4;
+    }
+}
+
+static void
+PackRowRGBAToRGB(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int col = 0; col < width; ++col) {
+        dstRow[0] = srcRow[0];
+        dstRow[1] = srcRow[1];
+        dstRow[2] = srcRow[2];
+        srcRow += 4;
+        dstRow += 3;
+    }
+}
+
+static void
+ExpandRowRGB16FToRGBA16F(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    const GLushort alpha = 0x3c00;
+    for(int col = 0; col < width; ++col) {
+        memcpy(dstRow, srcRow, 3 * sizeof(GLushort));
+        memcpy(dstRow + 3 * sizeof(GLushort), &alpha, sizeof(GLushort));
+        srcRow += 3 * sizeof(GLushort);
+        dstRow += 4 * sizeof(GLushort);
+    }
+}
+
+static void
+PackRowRGBA16FToRGB16F(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int col = 0; col < width; ++col) {
+        memcpy(dstRow, srcRow, 3 * sizeof(GLushort));
+        srcRow += 4 * sizeof(GLushort);
+        dstRow += 3 * sizeof(GLushort);
+    }
+}
+
+static void
+ExpandRowRGB32FToRGBA32F(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    const GLfloat alpha = 1.0f;
+    for(int col = 0; col < width; ++col) {
+        memcpy(dstRow, srcRow, 3 * sizeof(GLfloat));
+        memcpy(dstRow + 3 * sizeof(GLfloat), &alpha, sizeof(GLfloat));
+        srcRow += 3 * sizeof(GLfloat);
+        dstRow += 4 * sizeof(GLfloat);
+    }
+}
+
+static void
+PackRowRGBA32FToRGB32F(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int col = 0; col < width; ++col) {
+        memcpy(dstRow, srcRow, 3 * sizeof(GLfloat));
+        srcRow += 4 * sizeof(GLfloat);
+        dstRow += 3 * sizeof(GLfloat);
+    }
+}
+
+static void
+ConvertRowHalfToFloat(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int i = 0; i < width * 4; ++i) {
+        GLushort half;
+        memcpy(&half, srcRow, sizeof(GLushort));
+        const GLfloat value = GlHalfToFloat(half);
+        memcpy(dstRow, &value, sizeof(GLfloat));
+        srcRow += sizeof(GLushort);
+        dstRow += sizeof(GLfloat);
+    }
+}
+
+static void
+ConvertRowFloatToHalf(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int i = 0; i < width * 4; ++i) {
+        GLfloat value;
+        memcpy(&value, srcRow, sizeof(GLfloat));
+        const GLushort half = GlFloatToHalf(value);
+        memcpy(dstRow, &half, sizeof(GLushort));
+        srcRow += sizeof(GLfloat);
+        dstRow += sizeof(GLushort);
+    }
+}
+
+// clamped to [0, 1] like a fixed point color buffer would, NaNs become 0
+static inline uint8_t
+FloatToUnorm8(GLfloat value)
+{
+    return static_cast<uint8_t>((value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f) * 255.0f + 0.5f);
+}
+
+static void
+ConvertRowHalfToUnorm(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int i = 0; i < width * 4; ++i) {
+        GLushort half;
+        memcpy(&half, srcRow, sizeof(GLushort));
+        dstRow[i] = FloatToUnorm8(GlHalfToFloat(half));
+        srcRow   += sizeof(GLushort);
+    }
+}
+
+static void
+ConvertRowFloatToUnorm(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    for(int i = 0; i < width * 4; ++i) {
+        GLfloat value;
+        memcpy(&value, srcRow, sizeof(GLfloat));
+        dstRow[i] = FloatToUnorm8(value);
+        srcRow   += sizeof(GLfloat);
+    }
+}
+
+#if GLOVE_PIXEL_KERNELS_NEON
+
+// 16 pixels per iteration, the de-interleaving loads do the format change
+static void
+SwizzleRowRBNEON(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 16 <= width; col += 16) {
+        uint8x16x4_t pixels = vld4q_u8(srcRow + col * 4);
+        uint8x16_t   red    = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = red;
+        vst4q_u8(dstRow + col * 4, pixels);
+    }
+    SwizzleRowRB(srcRow + col * 4, dstRow + col * 4, width - col);
+}
+
+static void
+ExpandRowRGBToRGBANEON(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 16 <= width; col += 16) {
+        uint8x16x3_t rgb = vld3q_u8(srcRow + col * 3);
+        uint8x16x4_t rgba;
+        rgba.val[0] = rgb.val[0];
+        rgba.val[1] = rgb.val[1];
+        rgba.val[2] = rgb.val[2];
+        rgba.val[3] = vdupq_n_u8(0xff);
+        vst4q_u8(dstRow + col * 4, rgba);
+    }
+    ExpandRowRGBToRGBA(srcRow + col * 3, dstRow + col * 4, width - col);
+}
+
+static void
+PackRowRGBAToRGBNEON(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 16 <= width; col += 16) {
+        uint8x16x4_t rgba = vld4q_u8(srcRow + col * 4);
+        uint8x16x3_t rgb;
+        rgb.val[0] = rgba.val[0];
+        rgb.val[1] = rgba.val[1];
+        rgb.val[2] = rgba.val[2];
+        vst3q_u8(dstRow + col * 3, rgb);
+    }
+    PackRowRGBAToRGB(srcRow + col * 4, dstRow + col * 3, width - col);
+}
+
+#if defined(__aarch64__)
+
+// 2 pixels per iteration, the conversions round to the nearest even as the scalar ones do
+static void
+ConvertRowHalfToFloatNEON(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 2 <= width; col += 2) {
+        float16x8_t halves = vreinterpretq_f16_u8(vld1q_u8(srcRow + col * 8));
+        vst1q_u8(dstRow + col * 16,      vreinterpretq_u8_f32(vcvt_f32_f16(vget_low_f16(halves))));
+        vst1q_u8(dstRow + col * 16 + 16, vreinterpretq_u8_f32(vcvt_high_f32_f16(halves)));
+    }
+    ConvertRowHalfToFloat(srcRow + col * 8, dstRow + col * 16, width - col);
+}
+
+static void
+ConvertRowFloatToHalfNEON(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 2 <= width; col += 2) {
+        float16x4_t low = vcvt_f16_f32(vreinterpretq_f32_u8(vld1q_u8(srcRow + col * 16)));
+        vst1q_u8(dstRow + col * 8, vreinterpretq_u8_f16(vcvt_high_f16_f32(low, vreinterpretq_f32_u8(vld1q_u8(srcRow + col * 16 + 16)))));
+    }
+    ConvertRowFloatToHalf(srcRow + col * 16, dstRow + col * 8, width - col);
+}
+
+static void
+ConvertRowHalfToUnormNEON(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one  = vdupq_n_f32(1.0f);
+    const float32x4_t bias = vdupq_n_f32(0.5f);
+
+    int col = 0;
+    for(; col + 2 <= width; col += 2) {
+        float16x8_t halves = vreinterpretq_f16_u8(vld1q_u8(srcRow + col * 8));
+        float32x4_t low    = vminq_f32(vmaxnmq_f32(vcvt_f32_f16(vget_low_f16(halves)), zero), one);
+        float32x4_t high   = vminq_f32(vmaxnmq_f32(vcvt_high_f32_f16(halves), zero), one);
+        uint16x8_t  words  = vcombine_u16(vmovn_u32(vcvtq_u32_f32(vmlaq_n_f32(bias, low,  255.0f))),
+                                          vmovn_u32(vcvtq_u32_f32(vmlaq_n_f32(bias, high, 255.0f))));
+        vst1_u8(dstRow + col * 4, vmovn_u16(words));
+    }
+    ConvertRowHalfToUnorm(srcRow + col * 8, dstRow + col * 4, width - col);
+}
+
+#endif // __aarch64__
+
+#elif GLOVE_PIXEL_KERNELS_SSSE3
+
+// 4 pixels per iteration with a byte shuffle; the 16-byte loads and stores of
+// the 3-byte formats stop early enough to stay inside the row
+__attribute__((target("ssse3"))) static void
+SwizzleRowRBSSSE3(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    int col = 0;
+    for(; col + 4 <= width; col += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + col * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + col * 4), _mm_shuffle_epi8(pixels, shuffle));
+    }
+    SwizzleRowRB(srcRow + col * 4, dstRow + col * 4, width - col);
+}
+
+__attribute__((target("ssse3"))) static void
+ExpandRowRGBToRGBASSSE3(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha   = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+    int col = 0;
+    for(; col + 6 <= width; col += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + col * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + col * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+    }
+    ExpandRowRGBToRGBA(srcRow + col * 3, dstRow + col * 4, width - col);
+}
+
+__attribute__((target("ssse3"))) static void
+PackRowRGBAToRGBSSSE3(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    int col = 0;
+    for(; col + 6 <= width; col += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + col * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + col * 3), _mm_shuffle_epi8(pixels, shuffle));
+    }
+    PackRowRGBAToRGB(srcRow + col * 4, dstRow + col * 3, width - col);
+}
+
+// 2 pixels per iteration, 8 halves in and out of a register
+__attribute__((target("f16c"))) static void
+ConvertRowHalfToFloatF16C(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 2 <= width; col += 2) {
+        __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + col * 8));
+        _mm_storeu_ps(reinterpret_cast<float *>(dstRow + col * 16),      _mm_cvtph_ps(halves));
+        _mm_storeu_ps(reinterpret_cast<float *>(dstRow + col * 16 + 16), _mm_cvtph_ps(_mm_unpackhi_epi64(halves, halves)));
+    }
+    ConvertRowHalfToFloat(srcRow + col * 8, dstRow + col * 16, width - col);
+}
+
+__attribute__((target("f16c"))) static void
+ConvertRowFloatToHalfF16C(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 2 <= width; col += 2) {
+        __m128i low  = _mm_cvtps_ph(_mm_loadu_ps(reinterpret_cast<const float *>(srcRow + col * 16)),      _MM_FROUND_TO_NEAREST_INT);
+        __m128i high = _mm_cvtps_ph(_mm_loadu_ps(reinterpret_cast<const float *>(srcRow + col * 16 + 16)), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + col * 8), _mm_unpacklo_epi64(low, high));
+    }
+    ConvertRowFloatToHalf(srcRow + col * 16, dstRow + col * 8, width - col);
+}
+
+// 4 pixels per iteration, max returns its second operand for NaNs, so they become 0 as in the scalar kernel
+__attribute__((target("f16c"))) static inline __m128i
+HalvesToUnormF16C(__m128i halves)
+{
+    const __m128 value = _mm_min_ps(_mm_max_ps(_mm_cvtph_ps(halves), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+__attribute__((target("f16c"))) static void
+ConvertRowHalfToUnormF16C(const uint8_t *srcRow, uint8_t *dstRow, int width)
+{
+    int col = 0;
+    for(; col + 4 <= width; col += 4) {
+        __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + col * 8));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcRow + col * 8 + 16));
+        __m128i lowWords  = _mm_packs_epi32(HalvesToUnormF16C(low),  HalvesToUnormF16C(_mm_unpackhi_epi64(low,  low)));
+        __m128i highWords = _mm_packs_epi32(HalvesToUnormF16C(high), HalvesToUnormF16C(_mm_unpackhi_epi64(high, high)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + col * 4), _mm_packus_epi16(lowWords, highWords));
+    }
+    ConvertRowHalfToUnorm(srcRow + col * 8, dstRow + col * 4, width - col);
+}
+
+#endif
+
+static RowKernels_t
+InitRowKernels(void)
+{
+    RowKernels_t kernels = { &SwizzleRowRB, &ExpandRowRGBToRGBA, &PackRowRGBAToRGB,
+                             &ConvertRowHalfToFloat, &ConvertRowFloatToHalf, &ConvertRowHalfToUnorm };
+
+#if GLOVE_PIXEL_KERNELS_NEON
+    kernels.swizzleRB       = &SwizzleRowRBNEON;
+    kernels.expandRGBToRGBA = &ExpandRowRGBToRGBANEON;
+    kernels.packRGBAToRGB   = &PackRowRGBAToRGBNEON;
+#   if defined(__aarch64__)
+    kernels.halfToFloat     = &ConvertRowHalfToFloatNEON;
+    kernels.floatToHalf     = &ConvertRowFloatToHalfNEON;
+    kernels.halfToUnorm     = &ConvertRowHalfToUnormNEON;
+#   endif
+#elif GLOVE_PIXEL_KERNELS_SSSE3
+    if(__builtin_cpu_supports("ssse3")) {
+        kernels.swizzleRB       = &SwizzleRowRBSSSE3;
+        kernels.expandRGBToRGBA = &ExpandRowRGBToRGBASSSE3;
+        kernels.packRGBAToRGB   = &PackRowRGBAToRGBSSSE3;
+    }
+    if(__builtin_cpu_supports("f16c")) {
+        kernels.halfToFloat     = &ConvertRowHalfToFloatF16C;
+        kernels.floatToHalf     = &ConvertRowFloatToHalfF16C;
+        kernels.halfToUnorm     = &ConvertRowHalfToUnormF16C;
+    }
+#endif
+
+    return kernels;
+}
+
+static const RowKernels_t &
+GetRowKernels(void)
+{
+    static const RowKernels_t kernels = InitRowKernels();
+
+    return kernels;
+}
+
+static ConvertRowFunPtr
+FindRowKernel(Color (*SrcColorFunPtr)(const uint8_t*), void (*DstColorFunPtr)(Color&, uint8_t*),
+              uint32_t srcPixelSize, uint32_t dstPixelSize)
+{
+    const RowKernels_t &kernels = GetRowKernels();
+
+    if(srcPixelSize == 4 && dstPixelSize == 4 &&
+       ((SrcColorFunPtr == &Color::FromBGRA && DstColorFunPtr == &Color::ConvertToRGBA) ||
+        (SrcColorFunPtr == &Color::FromRGBA && DstColorFunPtr == &Color::ConvertToBGRA))) {
+        return kernels.swizzleRB;
+    }
+
+    if(srcPixelSize == 3 && dstPixelSize == 4 && SrcColorFunPtr == &Color::FromRGB && DstColorFunPtr == &Color::ConvertToRGBA) {
+        return kernels.expandRGBToRGBA;
+    }
+
+    if(srcPixelSize == 4 && dstPixelSize == 3 && SrcColorFunPtr == &Color::FromRGBA && DstColorFunPtr == &Color::ConvertToRGB) {
+        return kernels.packRGBAToRGB;
+    }
+
+    return nullptr;
+}
+
+// converts the rows of large images in parallel slices
+static void
+ForEachRowSlice(int height, size_t imageSize, const std::function<void(int, int)> &convertRows)
+{
+    WorkerPool *workerPool = WorkerPool::GetInstance();
+    uint32_t    slices     = 1;
+
+    if(imageSize >= GLOVE_PARALLEL_PIXEL_CONVERSION_SIZE && height > 1) {
+        slices = std::min(static_cast<uint32_t>(height), workerPool->GetConcurrency());
+    }
+
+    if(slices == 1) {
+        convertRows(0, height);
+        return;
+    }
+
+    workerPool->Run(slices, [height, slices, &convertRows](uint32_t slice) {
+        convertRows(static_cast<int>(static_cast<uint64_t>(height) *  slice      / slices),
+                    static_cast<int>(static_cast<uint64_t>(height) * (slice + 1) / slices));
+    });
+}
+
+// generic row conversion through a Color, with both color functions inlined
+template<Color (*SrcColorFunPtr)(const uint8_t*), void (*DstColorFunPtr)(Color&, uint8_t*)>
+static void
+ConvertRow(const uint8_t *srcRow, uint8_t *dstRow, int width, uint32_t srcPixelSize, uint32_t dstPixelSize)
+{
+    for(int col = 0; col < width; ++col) {
+        Color color = SrcColorFunPtr(srcRow);
+        DstColorFunPtr(color, dstRow);
+        srcRow += srcPixelSize;
+        dstRow += dstPixelSize;
+    }
+}
+
 // converts and copies pixels between two buffers with different formats
 // e.g., copies RGB565 pixels to BGRA8888
+template<Color (*SrcColorFunPtr)(const uint8_t*), void (*DstColorFunPtr)(Color&, uint8_t*)>
 void
 CopyPixelsConvert(
             const ImageRect* srcRect,
             const void* srcData,
             const ImageRect* dstRect,
-            void* dstData,
-            Color (*SrcColorFunPtr)(const uint8_t*),
-            void (*DstColorFunPtr)(Color&, uint8_t*))
+            void* dstData)
 {
 
     // size of an entire row in bytes
@@ -141,18 +588,27 @@ CopyPixelsConvert(
     const uint8_t* srcPtr = static_cast<const uint8_t*>(srcData) + srcCurrentRowIndex;
     uint8_t* dstPtr = static_cast<uint8_t*>(dstData) + dstCurrentRowIndex;
 
+    const uint32_t srcPixelSize = srcRect->GetPixelByteOffset();
+    const uint32_t dstPixelSize = dstRect->GetPixelByteOffset();
+    const ConvertRowFunPtr rowKernel = FindRowKernel(SrcColorFunPtr, DstColorFunPtr, srcPixelSize, dstPixelSize);
+    const int width = srcRect->width;
+
     // perform the conversion
-    for(int row = 0; row < srcRect->height; ++row) {
-        for(int col = 0; col < srcRect->width; ++col) {
-            const uint32_t srcIndex = col * srcRect->GetPixelByteOffset();
-            const uint32_t dstIndex = col * dstRect->GetPixelByteOffset();
-            Color color = SrcColorFunPtr(&srcPtr[srcIndex]);
-            DstColorFunPtr(color, &dstPtr[dstIndex]);
+    ForEachRowSlice(srcRect->height, dstRect->GetRectBufferSize(), [=](int beginRow, int endRow) {
+        const uint8_t* srcRow = srcPtr + beginRow * srcRowStride;
+        uint8_t* dstRow = dstPtr + beginRow * dstRowStride;
+
+        for(int row = beginRow; row < endRow; ++row) {
+            if(rowKernel) {
+                rowKernel(srcRow, dstRow, width);
+            } else {
+                ConvertRow<SrcColorFunPtr, DstColorFunPtr>(srcRow, dstRow, width, srcPixelSize, dstPixelSize);
+            }
+            // offset by the number of bytes per row
+            dstRow = dstRow + dstRowStride;
+            srcRow = srcRow + srcRowStride;
         }
-        // offset by the number of bytes per row
-        dstPtr = dstPtr + dstRowStride;
-        srcPtr = srcPtr + srcRowStride;
-    }
+    });
 }
 
 // copies pixels between two buffers
@@ -183,12 +639,55 @@ CopyPixelsNoConversion(
     const uint32_t dataRowSize = srcRect->GetDataRowSize();
 
     // copy each row separately
-    for(int row = 0; row < srcRect->height; ++row) {
-        memcpy(static_cast<void*>(dstPtr), static_cast<const void*>(srcPtr), dataRowSize);
-        // offset by the number of bytes per row
-        srcPtr += srcRowStride;
-        dstPtr += dstRowStride;
-    }
+    ForEachRowSlice(srcRect->height, dstRect->GetRectBufferSize(), [=](int beginRow, int endRow) {
+        const uint8_t* srcRow = srcPtr + beginRow * srcRowStride;
+        uint8_t* dstRow = dstPtr + beginRow * dstRowStride;
+
+        for(int row = beginRow; row < endRow; ++row) {
+            memcpy(static_cast<void*>(dstRow), static_cast<const void*>(srcRow), dataRowSize);
+            // offset by the number of bytes per row
+            srcRow += srcRowStride;
+            dstRow += dstRowStride;
+        }
+    });
+}
+
+// converts and copies pixels with a row kernel made for both formats
+static void
+CopyPixelsConvertRows(
+            const ImageRect* srcRect,
+            const void* srcData,
+            const ImageRect* dstRect,
+            void* dstData,
+            ConvertRowFunPtr rowKernel)
+{
+    const uint32_t srcRowStride = srcRect->GetRectAlignedRowInBytes();
+    const uint32_t dstRowStride = dstRect->GetRectAlignedRowInBytes();
+
+    const uint8_t* srcPtr = static_cast<const uint8_t*>(srcData) + srcRect->GetStartRowIndex(srcRowStride);
+    uint8_t* dstPtr = static_cast<uint8_t*>(dstData) + dstRect->GetStartRowIndex(dstRowStride);
+    const int width = srcRect->width;
+
+    ForEachRowSlice(srcRect->height, dstRect->GetRectBufferSize(), [=](int beginRow, int endRow) {
+        for(int row = beginRow; row < endRow; ++row) {
+            rowKernel(srcPtr + row * srcRowStride, dstPtr + row * dstRowStride, width);
+        }
+    });
+}
+
+// float texels read back in the fixed point formats other than RGBA8 go through it
+static void
+ConvertPixelsThroughRGBA8(GLenum srcFormat, GLenum dstFormat,
+                          ImageRect* srcRect,
+                          const void* srcData,
+                          ImageRect* dstRect,
+                          void* dstData)
+{
+    ImageRect tmpRect(0, 0, srcRect->width, srcRect->height, 4, 1, 1);
+    std::vector<uint8_t> tmpData(tmpRect.GetRectBufferSize());
+
+    ConvertPixels(srcFormat, GL_RGBA8_OES, srcRect, srcData, &tmpRect, tmpData.data());
+    ConvertPixels(GL_RGBA8_OES, dstFormat, &tmpRect, tmpData.data(), dstRect, dstData);
 }
 
 // copies and converts pixels between buffers
@@ -211,20 +710,20 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::FromBGRA, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToLuminanceAlpha);
+            CopyPixelsConvert<&Color::FromBGRA, &Color::ConvertToLuminanceAlpha>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToLuminance);
+            CopyPixelsConvert<&Color::FromBGRA, &Color::ConvertToLuminance>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToAlpha);
+            CopyPixelsConvert<&Color::FromBGRA, &Color::ConvertToAlpha>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_RGB:
         case GL_RGB8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromBGRA, &Color::ConvertToRGB);
+            CopyPixelsConvert<&Color::FromBGRA, &Color::ConvertToRGB>(srcRect, srcData, dstRect, dstData);
             break;
 
         default: NOT_FOUND_ENUM(dstFormat); break;
@@ -239,10 +738,16 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGB:
         case GL_RGB8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromRGBA, &Color::ConvertToRGB);
+            CopyPixelsConvert<&Color::FromRGBA, &Color::ConvertToRGB>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromRGBA, &Color::ConvertToAlpha);
+            CopyPixelsConvert<&Color::FromRGBA, &Color::ConvertToAlpha>(srcRect, srcData, dstRect, dstData);
+            break;
+        case GL_LUMINANCE:
+            CopyPixelsConvert<&Color::FromRGBA, &Color::ConvertToLuminance>(srcRect, srcData, dstRect, dstData);
+            break;
+        case GL_LUMINANCE_ALPHA:
+            CopyPixelsConvert<&Color::FromRGBA, &Color::ConvertToLuminanceAlpha>(srcRect, srcData, dstRect, dstData);
             break;
 
         default: NOT_FOUND_ENUM(dstFormat); break;
@@ -257,7 +762,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
             break;
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromRGB, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::FromRGB, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -269,11 +774,11 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminanceAlpha, &Color::ConvertToLuminance);
+            CopyPixelsConvert<&Color::FromLuminanceAlpha, &Color::ConvertToLuminance>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminanceAlpha, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::FromLuminanceAlpha, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -285,11 +790,11 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE_ALPHA:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminance, &Color::ConvertToLuminanceAlpha);
+            CopyPixelsConvert<&Color::FromLuminance, &Color::ConvertToLuminanceAlpha>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromLuminance, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::FromLuminance, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -302,7 +807,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::FromAlpha, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::FromAlpha, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -315,7 +820,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From4444, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::From4444, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -328,7 +833,7 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
             break;
         case GL_RGBA:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From5551, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::From5551, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -342,10 +847,10 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
         case GL_RGBA:
         case GL_RGB8_OES:
         case GL_RGBA8_OES:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From565, &Color::ConvertToRGBA);
+            CopyPixelsConvert<&Color::From565, &Color::ConvertToRGBA>(srcRect, srcData, dstRect, dstData);
             break;
         case GL_LUMINANCE:
-            CopyPixelsConvert(srcRect, srcData, dstRect, dstData, &Color::From565, &Color::ConvertToLuminance);
+            CopyPixelsConvert<&Color::From565, &Color::ConvertToLuminance>(srcRect, srcData, dstRect, dstData);
             break;
         default: NOT_FOUND_ENUM(dstFormat); break;
         }
@@ -362,6 +867,87 @@ ConvertPixels(GLenum srcFormat, GLenum dstFormat,
         }
         break;
 
+    // float texels are kept at the precision they were given in, they are
+    // only converted when read back in another format
+    case GL_RGBA16F_EXT:
+        switch(dstFormat) {
+        case GL_RGBA16F_EXT:
+            CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
+            break;
+        case GL_RGB16F_EXT:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, &PackRowRGBA16FToRGB16F);
+            break;
+        case GL_RGBA32F_EXT:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, GetRowKernels().halfToFloat);
+            break;
+        case GL_RGBA:
+        case GL_RGBA8_OES:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, GetRowKernels().halfToUnorm);
+            break;
+        default:
+            ConvertPixelsThroughRGBA8(srcFormat, dstFormat, srcRect, srcData, dstRect, dstData);
+            break;
+        }
+        break;
+
+    case GL_RGB16F_EXT:
+        switch(dstFormat) {
+        case GL_RGB16F_EXT:
+            CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
+            break;
+        case GL_RGBA16F_EXT:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, &ExpandRowRGB16FToRGBA16F);
+            break;
+        default: NOT_FOUND_ENUM(dstFormat); break;
+        }
+        break;
+
+    case GL_RGBA32F_EXT:
+        switch(dstFormat) {
+        case GL_RGBA32F_EXT:
+            CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
+            break;
+        case GL_RGB32F_EXT:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, &PackRowRGBA32FToRGB32F);
+            break;
+        case GL_RGBA16F_EXT:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, GetRowKernels().floatToHalf);
+            break;
+        case GL_RGBA:
+        case GL_RGBA8_OES:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, &ConvertRowFloatToUnorm);
+            break;
+        default:
+            ConvertPixelsThroughRGBA8(srcFormat, dstFormat, srcRect, srcData, dstRect, dstData);
+            break;
+        }
+        break;
+
+    case GL_RGB32F_EXT:
+        switch(dstFormat) {
+        case GL_RGB32F_EXT:
+            CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
+            break;
+        case GL_RGBA32F_EXT:
+            CopyPixelsConvertRows(srcRect, srcData, dstRect, dstData, &ExpandRowRGB32FToRGBA32F);
+            break;
+        default: NOT_FOUND_ENUM(dstFormat); break;
+        }
+        break;
+
+    case GL_ALPHA16F_EXT:
+    case GL_LUMINANCE16F_EXT:
+    case GL_LUMINANCE_ALPHA16F_EXT:
+    case GL_ALPHA32F_EXT:
+    case GL_LUMINANCE32F_EXT:
+    case GL_LUMINANCE_ALPHA32F_EXT:
+        if(dstFormat == srcFormat) {
+            CopyPixelsNoConversion(srcRect, srcData, dstRect, dstData);
+        } else {
+            NOT_FOUND_ENUM(dstFormat);
+        }
+        break;
+
     case GL_STENCIL_INDEX8_OES:
        switch(dstFormat) {
        case GL_STENCIL_INDEX8_OES:
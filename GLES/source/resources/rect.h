@@ -30,6 +30,9 @@
 #include <algorithm>
 #include "utils/color.hpp"
 
+/// Images at least this large (in bytes) are converted by several threads
+#define GLOVE_PARALLEL_PIXEL_CONVERSION_SIZE            (1024 * 1024)
+
 class Rect {
 
 public:
@@ -78,13 +81,12 @@ void                    CopyPixelsNoConversion(
                         const void* srcData,
                         const ImageRect* dstRect,
                         void* dstData);
+template<Color (*SrcColorFunPtr)(const uint8_t*), void (*DstColorFunPtr)(Color&, uint8_t*)>
 void                    CopyPixelsConvert(
                         const ImageRect* srcRect,
                         const void* srcData,
                         const ImageRect* dstRect,
-                        void* dstData,
-                        Color (*SrcColorFunPtr)(const uint8_t*),
-                                          void (*DstColorFunPtr)(struct Color&, uint8_t*));
+                        void* dstData);
 void                    ConvertPixels(GLenum srcFormat , GLenum dstFormat,
                         ImageRect* srcRect,
                         const void* srcData,
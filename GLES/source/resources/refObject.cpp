@@ -39,8 +39,7 @@ refObject::Bind()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    //TODO: mutex lock
-    refCount++;
+    refCount.fetch_add(1, std::memory_order_relaxed);
     return 0;
 }
 
@@ -49,8 +48,9 @@ refObject::Unbind()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    //TODO: mutex lock
-    refCount--;
-    assert(refCount >= 0);
+    // the last unbind publishes the writes made through the binding to whoever deletes the object
+    const int count = refCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    assert(count >= 0);
+    (void)count;
     return 0;
 }
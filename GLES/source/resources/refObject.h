@@ -25,11 +25,13 @@
 #define __REFOBJECT_H_
 
 #include "utils/glLogger.h"
+#include <atomic>
 
+/// The counts are atomic, as the contexts of a share group bind the same objects from different threads
 class refObject {
 private:
-    int   refCount;
-    int   markForDeletion;
+    std::atomic<int>  refCount;
+    std::atomic<bool> markForDeletion;
 
 public:
 // Constructor
@@ -40,10 +42,10 @@ public:
 
     int Bind();
     int Unbind();
-    int GetRefCount()                             { FUN_ENTRY(GL_LOG_TRACE); return refCount; }
-    bool FreeForDeletion()                  const { FUN_ENTRY(GL_LOG_TRACE); return refCount == 0; }
-    bool GetMarkForDeletion()                     { FUN_ENTRY(GL_LOG_TRACE); return markForDeletion; }
-    void SetMarkForDeletion(bool flag)            { FUN_ENTRY(GL_LOG_TRACE); markForDeletion = flag;}
+    int GetRefCount()                             { FUN_ENTRY(GL_LOG_TRACE); return refCount.load(std::memory_order_acquire); }
+    bool FreeForDeletion()                  const { FUN_ENTRY(GL_LOG_TRACE); return refCount.load(std::memory_order_acquire) == 0; }
+    bool GetMarkForDeletion()                     { FUN_ENTRY(GL_LOG_TRACE); return markForDeletion.load(std::memory_order_acquire); }
+    void SetMarkForDeletion(bool flag)            { FUN_ENTRY(GL_LOG_TRACE); markForDeletion.store(flag, std::memory_order_release); }
 };
 
 #endif // __REFOBJECT_H_
@@ -28,11 +28,12 @@
 
 #include "renderbuffer.h"
 #include "utils/glUtils.h"
+#include "utils/VkToGlConverter.h"
 #include "vulkan/utils.h"
 
 Renderbuffer::Renderbuffer(const vulkanAPI::vkContext_t *vkContext)
 : mVkContext(vkContext),
-mInternalFormat(GL_RGBA4), mTarget(GL_INVALID_VALUE), mTexture(nullptr)
+mInternalFormat(GL_RGBA4), mTarget(GL_INVALID_VALUE), mSamples(0), mTexture(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -66,24 +67,27 @@ Renderbuffer::InitTexture(void)
 }
 
 bool
-Renderbuffer::Allocate(GLint width, GLint height, GLenum internalformat)
+Renderbuffer::Allocate(GLint width, GLint height, GLenum internalformat, GLsizei samples)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mDims.width     = width;
     mDims.height    = height;
     mInternalFormat = internalformat;
+    mSamples        = samples;
 
     mTexture->SetTarget(GL_TEXTURE_2D);
 
     VkFormat vkformat = GlInternalFormatToVkFormat(mInternalFormat);
 
     if(GlFormatIsColorRenderable(mInternalFormat)) {
-        mTexture->SetVkFormat(vkformat);
-        mTexture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+        // three channel formats may only be renderable with a fourth channel
+        mTexture->SetVkFormat(mTexture->FindSupportedVkColorFormat(vkformat));
+        // framebuffer fetch reads the color attachment as an input attachment
+        mTexture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
     } else {
         // convert to supported format
-        vkformat = FindSupportedDepthStencilFormat(mVkContext->vkGpus[0], GetVkFormatDepthBits(vkformat), GetVkFormatStencilBits(vkformat));
+        vkformat = FindSupportedDepthStencilFormat(mVkContext->capabilityCache, GetVkFormatDepthBits(vkformat), GetVkFormatStencilBits(vkformat));
         mTexture->SetVkFormat(vkformat);
         mTexture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
     }
@@ -94,3 +98,19 @@ Renderbuffer::Allocate(GLint width, GLint height, GLenum internalformat)
 
     return mTexture->Allocate();
 }
+
+bool
+Renderbuffer::ImportEGLImage(const EGLImageInterface *eglImage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mDims.width     = eglImage->width;
+    mDims.height    = eglImage->height;
+    mInternalFormat = VkFormatToGlInternalformat(eglImage->vkFormat);
+    mSamples        = 0;
+
+    mTexture->SetTarget(GL_TEXTURE_2D);
+    mTexture->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
+
+    return mTexture->ImportEGLImage(eglImage, static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+}
@@ -26,7 +26,7 @@
 
 #include "texture.h"
 
-class Renderbuffer : public refObject
+class Renderbuffer : public refObject, public ArrayObject
 {
 private:
     const
@@ -35,6 +35,8 @@ private:
     Rect                             mDims;
     GLenum                           mInternalFormat;
     GLenum                           mTarget;
+    /// sample count the framebuffers it is attached to render with, resolving into mTexture
+    GLsizei                          mSamples;
     Texture *                        mTexture;
 
 public:
@@ -42,7 +44,8 @@ public:
     ~Renderbuffer();
 
 // Allocate Functions
-           bool        Allocate(GLint width, GLint height, GLenum internalformat);
+           bool        Allocate(GLint width, GLint height, GLenum internalformat, GLsizei samples = 0);
+           bool        ImportEGLImage(const EGLImageInterface *eglImage);
 
 // Release Functions
            void        Release(void);
@@ -52,6 +55,7 @@ public:
     inline int32_t     GetHeight(void)                                    const { FUN_ENTRY(GL_LOG_TRACE); return mDims.height;    }
     inline GLenum      GetTarget(void)                                    const { FUN_ENTRY(GL_LOG_TRACE); return mTarget;         }
     inline GLenum      GetInternalFormat(void)                            const { FUN_ENTRY(GL_LOG_TRACE); return mInternalFormat; }
+    inline GLsizei     GetSamples(void)                                   const { FUN_ENTRY(GL_LOG_TRACE); return mSamples;        }
     inline Texture *   GetTexture(void)                                   const { FUN_ENTRY(GL_LOG_TRACE); return mTexture;        }
 
 // Set Functions
@@ -22,24 +22,40 @@
  *  @section
  *
  *  OpenGL ES allows developers to allocate, edit and delete a variety of
- *  resources. These include Generic Vertex Attributes, Buffers, Renderbuffers,
- *  Framebuffers, Textures, Shaders, and Shader Programs.
+ *  resources. These include Buffers, Renderbuffers, Framebuffers, Textures,
+ *  Shaders, and Shader Programs, which are shared by the contexts of a share group.
  */
 
 #include "resourceManager.h"
+#include "context/context.h"
+
+/// retired objects wait in the caches of the context that deletes them
+static CacheManager *
+GetRetireCacheManager(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Context *context = GetCurrentContext();
+    return context ? context->GetCacheManager() : nullptr;
+}
 
 ResourceManager::ResourceManager(const vulkanAPI::vkContext_t *vkContext):
     mVkContext(vkContext),
+    mRefCount(1),
+    mTransientTexturePool(vkContext),
     mShadingObjectCount(1),
-    mGenericVertexAttributes(GLOVE_MAX_VERTEX_ATTRIBS)
+    mIncompleteTexture2D(nullptr),
+    mIncompleteTextureCubeMap(nullptr),
+    mContextSlotMask(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    CreateDefaultTextures();
-
-    for(auto& gva : mGenericVertexAttributes) {
-        gva.SetVkContext(vkContext);
+    for(uint32_t i = 0; i < GLOVE_MAX_SHARE_GROUP_CONTEXTS; ++i) {
+        mContextCompletedSerials[i].store(0, std::memory_order_relaxed);
+        mContextSubmitSerials[i].store(0, std::memory_order_relaxed);
     }
+
+    CreateDefaultTextures();
 }
 
 ResourceManager::~ResourceManager()
@@ -49,17 +65,32 @@ ResourceManager::~ResourceManager()
     delete mDefaultTexture2D;
     delete mDefaultTextureCubeMap;
 
-    for(auto& gva : mGenericVertexAttributes) {
-        gva.Release();
-    }
-    mGenericVertexAttributes.clear();
+    // the view goes before the image it was created from
+    delete mIncompleteTexture2D;
+    delete mIncompleteTextureCubeMap;
 }
 
 void
-ResourceManager::SetCacheManager(CacheManager *cacheManager)
+ResourceManager::DetachCacheManager(const CacheManager *cacheManager)
 {
-    for(auto& gva : mGenericVertexAttributes) {
-        gva.SetCacheManager(cacheManager);
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // objects last used by a context that goes away, while the rest of the share group lives on
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    for(typename vector<BufferObject *>::const_iterator it =
+        mBuffers.GetObjects()->begin(); it != mBuffers.GetObjects()->end(); it++) {
+
+        if((*it)->GetCacheManager() == cacheManager) {
+            (*it)->SetCacheManager(nullptr);
+        }
+    }
+
+    for(typename vector<ShaderProgram *>::const_iterator it =
+        mShaderPrograms.GetObjects()->begin(); it != mShaderPrograms.GetObjects()->end(); it++) {
+
+        if((*it)->GetCacheManager() == cacheManager) {
+            (*it)->SetCacheManager(nullptr);
+        }
     }
 }
 
@@ -85,12 +116,58 @@ ResourceManager::CreateDefaultTextures()
     mDefaultTextureCubeMap->InitState();
 }
 
+Texture *
+ResourceManager::GetIncompleteTexture(GLenum target)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    if(mIncompleteTextureCubeMap == nullptr) {
+        // a single 1x1 image for the whole share group, instead of one filled into every incomplete texture
+        const uint8_t pixels[4] = {0, 0, 0, 255};
+
+        Texture *cubeMap = new Texture(mVkContext);
+        cubeMap->SetTarget(GL_TEXTURE_CUBE_MAP);
+        cubeMap->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
+        cubeMap->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+        cubeMap->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_CUBE);
+        cubeMap->SetVkImageTiling();
+        cubeMap->InitState();
+        for(GLint layer = 0; layer < cubeMap->GetLayersCount(); ++layer) {
+            cubeMap->SetState(1, 1, 0, layer, GL_RGBA, GL_UNSIGNED_BYTE, Texture::GetDefaultInternalAlignment(), pixels);
+        }
+
+        if(!cubeMap->IsCompleted() || !cubeMap->Allocate()) {
+            delete cubeMap;
+            return nullptr;
+        }
+        cubeMap->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        Texture *texture2D = new Texture(mVkContext);
+        texture2D->SetTarget(GL_TEXTURE_2D);
+        texture2D->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
+        if(!texture2D->ViewImageOf(cubeMap)) {
+            delete texture2D;
+            delete cubeMap;
+            return nullptr;
+        }
+
+        mIncompleteTexture2D      = texture2D;
+        mIncompleteTextureCubeMap = cubeMap;
+    }
+
+    return target == GL_TEXTURE_CUBE_MAP ? mIncompleteTextureCubeMap : mIncompleteTexture2D;
+}
+
 
 uint32_t
 ResourceManager::PushShadingObject(const ShadingNamespace_t& obj)
 {
     FUN_ENTRY(GL_LOG_TRACE);
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     mShadingObjectPool[mShadingObjectCount] = obj;
+    mShadingObjectNames[std::make_pair(obj.type, obj.arrayIndex)] = mShadingObjectCount;
     return mShadingObjectCount++;
 }
 
@@ -98,7 +175,17 @@ void
 ResourceManager::EraseShadingObject(uint32_t id)
 {
     FUN_ENTRY(GL_LOG_TRACE);
-    mShadingObjectPool.erase(id);
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    shadingPoolIDs_t::iterator it = mShadingObjectPool.find(id);
+    if(it == mShadingObjectPool.end()) {
+        return;
+    }
+
+    shadingPoolNames_t::iterator name = mShadingObjectNames.find(std::make_pair(it->second.type, it->second.arrayIndex));
+    if(name != mShadingObjectNames.end() && name->second == id) {
+        mShadingObjectNames.erase(name);
+    }
+    mShadingObjectPool.erase(it);
 }
 
 GLboolean
@@ -106,6 +193,7 @@ ResourceManager::IsShadingObject(GLuint index, shadingNamespaceType_t type) cons
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
     if(!index || index >= mShadingObjectCount || !ShadingObjectExists(index)) {
         return GL_FALSE;
     }
@@ -119,12 +207,9 @@ ResourceManager::FindShaderID(const Shader *shader)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(shadingPoolIDs_t::iterator it = mShadingObjectPool.begin(); it != mShadingObjectPool.end(); ++it) {
-        if(it->second.type == SHADER_ID && GetShaderID(shader) == it->second.arrayIndex) {
-            return it->first;
-        }
-    }
-    return 0;
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    shadingPoolNames_t::const_iterator it = mShadingObjectNames.find(std::make_pair(SHADER_ID, GetShaderID(shader)));
+    return it != mShadingObjectNames.end() ? it->second : 0;
 }
 
 uint32_t
@@ -132,12 +217,9 @@ ResourceManager::FindShaderProgramID(const ShaderProgram *program)
 {
    FUN_ENTRY(GL_LOG_DEBUG);
 
-   for(shadingPoolIDs_t::iterator it = mShadingObjectPool.begin(); it != mShadingObjectPool.end(); ++it) {
-        if(it->second.type == SHADER_PROGRAM_ID && GetShaderProgramID(program) == it->second.arrayIndex) {
-            return it->first;
-        }
-    }
-    return 0;
+   std::lock_guard<std::recursive_mutex> lock(mMutex);
+   shadingPoolNames_t::const_iterator it = mShadingObjectNames.find(std::make_pair(SHADER_PROGRAM_ID, GetShaderProgramID(program)));
+   return it != mShadingObjectNames.end() ? it->second : 0;
 }
 
 
@@ -146,10 +228,10 @@ ResourceManager::UpdateFramebufferObjects(GLuint index, GLenum target)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(typename map<uint32_t, Framebuffer *>::const_iterator it =
+    for(typename vector<Framebuffer *>::const_iterator it =
         mFramebuffers.GetObjects()->begin(); it != mFramebuffers.GetObjects()->end(); it++) {
 
-        Framebuffer *fb = it->second;
+        Framebuffer *fb = *it;
         if((fb->GetColorAttachmentType()   == target && index == fb->GetColorAttachmentName()) ||
            (fb->GetDepthAttachmentType()   == target && index == fb->GetDepthAttachmentName()) ||
            (fb->GetStencilAttachmentType() == target && index == fb->GetStencilAttachmentName())) {
@@ -158,15 +240,134 @@ ResourceManager::UpdateFramebufferObjects(GLuint index, GLenum target)
     }
 }
 
+uint32_t
+ResourceManager::AcquireContextSlot(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    for(uint32_t i = 0; i < GLOVE_MAX_SHARE_GROUP_CONTEXTS; ++i) {
+        if(!(mContextSlotMask & (1u << i))) {
+            mContextSlotMask |= 1u << i;
+            mContextCompletedSerials[i].store(0, std::memory_order_release);
+            mContextSubmitSerials[i].store(0, std::memory_order_release);
+            return i;
+        }
+    }
+
+    return GLOVE_UNTRACKED_SHARE_GROUP_SLOT;
+}
+
+void
+ResourceManager::ReleaseContextSlot(uint32_t slot)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(slot == GLOVE_UNTRACKED_SHARE_GROUP_SLOT) {
+        return;
+    }
+
+    // the stamps of the context are dropped, so that the next one given the slot does not read them as its own
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+    mTextures.ForEachObject([slot](Texture *texture) { texture->ReleaseContextSlot(slot); });
+    for(Texture *texture : { mDefaultTexture2D, mDefaultTextureCubeMap, mIncompleteTexture2D, mIncompleteTextureCubeMap }) {
+        if(texture) {
+            texture->ReleaseContextSlot(slot);
+        }
+    }
+
+    mContextSlotMask &= ~(1u << slot);
+}
+
+void
+ResourceManager::SetContextSerials(uint32_t slot, uint64_t completedSerial, uint64_t submitSerial)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(slot == GLOVE_UNTRACKED_SHARE_GROUP_SLOT) {
+        return;
+    }
+
+    mContextCompletedSerials[slot].store(completedSerial, std::memory_order_release);
+    mContextSubmitSerials[slot].store(submitSerial, std::memory_order_release);
+}
+
+bool
+ResourceManager::IsTextureIdle(const Texture *texture, uint32_t slot, uint64_t completedSerial, uint64_t submitSerial, uint64_t idleSubmits) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // what the contexts without a slot do with the texture is not known
+    if(slot == GLOVE_UNTRACKED_SHARE_GROUP_SLOT || texture->IsUsedUntracked()) {
+        return false;
+    }
+
+    // the serials of a slot only compare against what its own context has seen, the other contexts
+    // are judged by what they have last published, which may only lag behind their submissions
+    for(uint32_t i = 0; i < GLOVE_MAX_SHARE_GROUP_CONTEXTS; ++i) {
+        const uint64_t lastUsedSerial = texture->GetLastUsedSerial(i);
+        if(i != slot && !lastUsedSerial) {
+            continue;
+        }
+
+        const uint64_t completed = i == slot ? completedSerial : mContextCompletedSerials[i].load(std::memory_order_acquire);
+        const uint64_t submitted = i == slot ? submitSerial    : mContextSubmitSerials[i].load(std::memory_order_acquire);
+        if(lastUsedSerial > completed || submitted - lastUsedSerial < idleSubmits) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t
+ResourceManager::EvictIdleTextures(uint32_t slot, vulkanAPI::CommandBufferManager *commandBufferManager)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const uint64_t completedSerial = commandBufferManager->UpdateCompletedSerial();
+    const uint64_t submitSerial    = commandBufferManager->GetSubmitSerial();
+
+    // the other contexts of the group may create and delete textures meanwhile
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    uint32_t evicted = 0;
+    mTextures.ForEachObject([&](Texture *texture) {
+        // only textures no context's GPU work refers to anymore and that none has sampled for a while are demoted
+        if(IsTextureIdle(texture, slot, completedSerial, submitSerial, GLOVE_TEXTURE_EVICTION_IDLE_SUBMITS) &&
+           texture->IsUploadCompleted(slot, commandBufferManager->GetUploadManager()) &&
+           texture->EvictVkResources()) {
+            ++evicted;
+        }
+    });
+
+    return evicted;
+}
+
+void
+ResourceManager::EndTransientTextureFrame(vulkanAPI::CommandBufferManager *commandBufferManager)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    // textures moved to other memory are created anew on their next use, through the framebuffers they are attached to
+    std::vector<Texture *> released = mTransientTexturePool.EndFrame(commandBufferManager);
+    for(Texture *texture : released) {
+        texture->DropVkResources();
+        UpdateFramebufferObjects(GetTextureID(texture), GL_TEXTURE);
+    }
+}
+
 bool
 ResourceManager::IsTextureAttachedToFBO(const Texture *texture)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(typename map<uint32_t, Framebuffer *>::const_iterator it =
+    for(typename vector<Framebuffer *>::const_iterator it =
         mFramebuffers.GetObjects()->begin(); it != mFramebuffers.GetObjects()->end(); it++) {
 
-        if(it->second->GetColorAttachmentType() == GL_TEXTURE && texture == it->second->GetColorAttachmentTexture()) {
+        if((*it)->GetColorAttachmentType() == GL_TEXTURE && texture == (*it)->GetColorAttachmentTexture()) {
             return true;
         }
     }
@@ -174,62 +375,104 @@ ResourceManager::IsTextureAttachedToFBO(const Texture *texture)
     return false;
 }
 
+/// removes the objects of the purge list that retire in a single pass, keeping the order of the rest
+template<typename T, typename RETIRE>
+static void
+RetirePurgeList(std::vector<T *> *purgeList, RETIRE retire)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    typename std::vector<T *>::iterator kept = purgeList->begin();
+    for(typename std::vector<T *>::iterator it = purgeList->begin(); it != purgeList->end(); ++it) {
+        if(!retire(*it)) {
+            *kept++ = *it;
+        }
+    }
+    purgeList->erase(kept, purgeList->end());
+}
+
 void
 ResourceManager::CleanPurgeList()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    std::lock_guard<std::recursive_mutex> lock(mMutex);
+
+    if(mPurgeListBufferObject.empty() && mPurgeListTexture.empty() && mPurgeListShaderPrograms.empty() &&
+       mPurgeListShaders.empty() && mPurgeListRenderbuffers.empty()) {
+        return;
+    }
+
+    CacheManager *cacheManager = GetRetireCacheManager();
+
     //Buffers
-    for (auto it = mPurgeListBufferObject.begin(); it != mPurgeListBufferObject.end(); ) {
-        if ((*it)->GetRefCount() == 0) {
-            delete *it;
-            it = mPurgeListBufferObject.erase(it);
-        } else {
-            ++it;
+    RetirePurgeList(&mPurgeListBufferObject, [](BufferObject *buffer) -> bool {
+        if(buffer->GetRefCount()) {
+            return false;
         }
-    }
+        delete buffer;
+        return true;
+    });
     //Textures
-    for (auto it = mPurgeListTexture.begin(); it != mPurgeListTexture.end(); ) {
-        if ((*it)->GetRefCount() == 0) {
-            delete *it;
-            it = mPurgeListTexture.erase(it);
+    // command buffers in flight may still refer to their images, so they retire along with them
+    RetirePurgeList(&mPurgeListTexture, [cacheManager](Texture *texture) -> bool {
+        if(texture->GetRefCount()) {
+            return false;
+        }
+        if(cacheManager) {
+            cacheManager->CacheTexture(texture);
         } else {
-            ++it;
+            delete texture;
         }
-    }
+        return true;
+    });
     //Shader Programs
-    for (auto it = mPurgeListShaderPrograms.begin(); it != mPurgeListShaderPrograms.end();) {
-        ShaderProgram* shaderProgramPtr = *it;
-        if (shaderProgramPtr->FreeForDeletion()) {
-            shaderProgramPtr->DetachShaders();
-            uint32_t id = FindShaderProgramID(shaderProgramPtr);
-            EraseShadingObject(id);
-            DeallocateShaderProgram(shaderProgramPtr);
-            it = mPurgeListShaderPrograms.erase(it);
-        } else {
-            ++it;
+    RetirePurgeList(&mPurgeListShaderPrograms, [this](ShaderProgram *shaderProgramPtr) -> bool {
+        if(!shaderProgramPtr->FreeForDeletion()) {
+            return false;
         }
-    }
+        shaderProgramPtr->DetachShaders();
+        uint32_t id = FindShaderProgramID(shaderProgramPtr);
+        EraseShadingObject(id);
+        RetireShaderProgram(shaderProgramPtr);
+        return true;
+    });
     //Shaders
-    for (auto it = mPurgeListShaders.begin(); it != mPurgeListShaders.end();) {
-        Shader* shaderPtr = *it;
-        if (shaderPtr->FreeForDeletion()) {
-            uint32_t id = FindShaderID(shaderPtr);
-            EraseShadingObject(id);
-            DeallocateShader(shaderPtr);
-            it = mPurgeListShaders.erase(it);
-        } else {
-            ++it;
+    RetirePurgeList(&mPurgeListShaders, [this](Shader *shaderPtr) -> bool {
+        if(!shaderPtr->FreeForDeletion()) {
+            return false;
         }
-    }
+        uint32_t id = FindShaderID(shaderPtr);
+        EraseShadingObject(id);
+        DeallocateShader(shaderPtr);
+        return true;
+    });
     //Renderbuffer
-    for (auto it = mPurgeListRenderbuffers.begin(); it != mPurgeListRenderbuffers.end(); ) {
-        if ((*it)->GetRefCount() == 0) {
-            delete *it;
-            it = mPurgeListRenderbuffers.erase(it);
+    RetirePurgeList(&mPurgeListRenderbuffers, [cacheManager](Renderbuffer *renderbuffer) -> bool {
+        if(renderbuffer->GetRefCount()) {
+            return false;
+        }
+        if(cacheManager) {
+            cacheManager->CacheRenderbuffer(renderbuffer);
         } else {
-            ++it;
+            delete renderbuffer;
         }
+        return true;
+    });
+}
+
+void
+ResourceManager::RetireShaderProgram(ShaderProgram *program)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // its pipeline layout and descriptor sets may still be used by command buffers in flight
+    mShaderPrograms.RemoveFromList(mShaderPrograms.GetObjectId(program));
+    CacheManager *cacheManager = GetRetireCacheManager();
+    if(cacheManager) {
+        cacheManager->CacheShaderProgram(program);
+    } else {
+        delete program;
     }
 }
 
@@ -238,10 +481,10 @@ ResourceManager::FramebufferCacheAttachement(Texture *texture, GLuint index)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(typename map<uint32_t, Framebuffer *>::const_iterator it =
+    for(typename vector<Framebuffer *>::const_iterator it =
         mFramebuffers.GetObjects()->begin(); it != mFramebuffers.GetObjects()->end(); it++) {
 
-        it->second->CacheAttachement(texture, index);
+        (*it)->CacheAttachement(texture, index);
     }
 }
 
@@ -250,9 +493,9 @@ ResourceManager::FramebufferCacheAttachement(Renderbuffer *renderbuffer, GLuint
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(typename map<uint32_t, Framebuffer *>::const_iterator it =
+    for(typename vector<Framebuffer *>::const_iterator it =
         mFramebuffers.GetObjects()->begin(); it != mFramebuffers.GetObjects()->end(); it++) {
 
-        it->second->CacheAttachement(renderbuffer, index);
+        (*it)->CacheAttachement(renderbuffer, index);
     }
 }
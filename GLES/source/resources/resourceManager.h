@@ -31,6 +31,8 @@
 #include "resources/shader.h"
 #include "resources/texture.h"
 #include "utils/cacheManager.h"
+#include <atomic>
+#include <mutex>
 
 typedef enum {
     NO_ID,
@@ -43,10 +45,13 @@ typedef struct {
     uint32_t                               arrayIndex;
 } ShadingNamespace_t;
 
+/// Shared by all the contexts of a share group, which may be current to different threads
 class ResourceManager {
 private:
 
     const vulkanAPI::vkContext_t              *mVkContext;
+    uint32_t                                   mRefCount;
+    mutable std::recursive_mutex               mMutex;
     typedef ObjectArray<Texture>               TextureArray;
     typedef ObjectArray<BufferObject>          BufferArray;
     typedef ObjectArray<Shader>                ShaderArray;
@@ -54,6 +59,10 @@ private:
     typedef ObjectArray<Renderbuffer>          RenderbufferArray;
     typedef ObjectArray<Framebuffer>           FramebufferArray;
     typedef map<uint32_t, ShadingNamespace_t>  shadingPoolIDs_t;
+    typedef map<std::pair<shadingNamespaceType_t, uint32_t>, uint32_t> shadingPoolNames_t;
+
+    /// outlives the textures, which leave it when they are deleted
+    TransientTexturePool                       mTransientTexturePool;
 
     BufferArray                                mBuffers;
     RenderbufferArray                          mRenderbuffers;
@@ -62,22 +71,41 @@ private:
 
     uint32_t                                   mShadingObjectCount;
     shadingPoolIDs_t                           mShadingObjectPool;
+    /// the GL names of the shading objects by their type and array index, so that the name of an object is found back from it
+    shadingPoolNames_t                         mShadingObjectNames;
     ShaderArray                                mShaders;
     ShaderProgramArray                         mShaderPrograms;
 
     Texture                                   *mDefaultTexture2D;
     Texture                                   *mDefaultTextureCubeMap;
-    std::vector<GenericVertexAttribute>        mGenericVertexAttributes;
+    /// what incomplete textures are sampled as, created on first use, the 2D one views the first face of the cube map
+    Texture                                   *mIncompleteTexture2D;
+    Texture                                   *mIncompleteTextureCubeMap;
     std::vector<BufferObject*>                 mPurgeListBufferObject;
     std::vector<Texture*>                      mPurgeListTexture;
     std::vector<Shader*>                       mPurgeListShaders;
     std::vector<ShaderProgram*>                mPurgeListShaderPrograms;
     std::vector<Renderbuffer*>                 mPurgeListRenderbuffers;
 
+    /// the contexts of the group that hold a slot, and the serials each has last seen its submissions reach,
+    /// against which the use of the textures by the other contexts is judged
+    uint32_t                                   mContextSlotMask;
+    std::atomic<uint64_t>                      mContextCompletedSerials[GLOVE_MAX_SHARE_GROUP_CONTEXTS];
+    std::atomic<uint64_t>                      mContextSubmitSerials[GLOVE_MAX_SHARE_GROUP_CONTEXTS];
+
 public:
     ResourceManager(const vulkanAPI::vkContext_t *vkContext);
     ~ResourceManager();
 
+// Share Group Functions
+    inline void                Retain(void)                                     { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); ++mRefCount; }
+    inline uint32_t            Release(void)                                    { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); return --mRefCount; }
+    inline bool                IsShared(void)                             const { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); return mRefCount > 1; }
+           void                DetachCacheManager(const CacheManager *cacheManager);
+           uint32_t            AcquireContextSlot(void);
+           void                ReleaseContextSlot(uint32_t slot);
+           void                SetContextSerials(uint32_t slot, uint64_t completedSerial, uint64_t submitSerial);
+
 // Allocate/Deallocate Functions
     inline GLuint              AllocateTexture(void)                            { FUN_ENTRY(GL_LOG_TRACE); return mTextures.Allocate(); }
     inline GLuint              AllocateBuffer(void)                             { FUN_ENTRY(GL_LOG_TRACE); return mBuffers.Allocate(); }
@@ -94,11 +122,9 @@ public:
     inline void                RemoveFromListTexture(uint32_t index)            { FUN_ENTRY(GL_LOG_TRACE); mTextures.RemoveFromList(index); }
     inline void                RemoveFromListBuffer(uint32_t index)             { FUN_ENTRY(GL_LOG_TRACE); mBuffers.RemoveFromList(index); }
     inline void                RemoveFromListRenderbuffer(uint32_t index)       { FUN_ENTRY(GL_LOG_TRACE); mRenderbuffers.RemoveFromList(index); }
+           void                RetireShaderProgram(ShaderProgram *program);
 
 // Get Functions
-    inline std::vector<GenericVertexAttribute>& GetGenericVertexAttributes(void) { FUN_ENTRY(GL_LOG_TRACE); return mGenericVertexAttributes; }
-    inline GenericVertexAttribute* GetGenericVertexAttribute(size_t index)      { FUN_ENTRY(GL_LOG_TRACE); return &mGenericVertexAttributes[index]; }
-
     inline TextureArray       *GetTextureArray(void)                            { FUN_ENTRY(GL_LOG_TRACE); return &mTextures; }
     inline ShaderArray        *GetShaderArray(void)                             { FUN_ENTRY(GL_LOG_TRACE); return &mShaders;  }
     inline ShaderProgramArray *GetShaderProgramArray(void)                      { FUN_ENTRY(GL_LOG_TRACE); return &mShaderPrograms; }
@@ -106,6 +132,7 @@ public:
 
     inline Texture *           GetTexture(GLuint index)                         { FUN_ENTRY(GL_LOG_TRACE); return mTextures.GetObject(index); }
     inline Texture *           GetDefaultTexture(GLenum target)                 { FUN_ENTRY(GL_LOG_TRACE); return target == GL_TEXTURE_2D ? mDefaultTexture2D : mDefaultTextureCubeMap; }
+           Texture *           GetIncompleteTexture(GLenum target);
     inline Framebuffer *       GetFramebuffer(GLuint index)                     { FUN_ENTRY(GL_LOG_TRACE); return mFramebuffers.GetObject(index); }
     inline Renderbuffer *      GetRenderbuffer(GLuint index)                    { FUN_ENTRY(GL_LOG_TRACE); return mRenderbuffers.GetObject(index); }
     inline BufferObject *      GetBuffer(GLuint index)                          { FUN_ENTRY(GL_LOG_TRACE); return mBuffers.GetObject(index); }
@@ -115,11 +142,8 @@ public:
     inline ShaderProgram *     GetShaderProgram(GLuint index)                   { FUN_ENTRY(GL_LOG_TRACE); return mShaderPrograms.GetObject(index); }
     inline uint32_t            GetShaderID(const Shader *shader)                { FUN_ENTRY(GL_LOG_TRACE); return mShaders.GetObjectId(shader); }
     inline uint32_t            GetShaderProgramID(const ShaderProgram *program) { FUN_ENTRY(GL_LOG_TRACE); return mShaderPrograms.GetObjectId(program); }
-    inline uint32_t            GetShadingObjectCount(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mShadingObjectCount; }
-    inline ShadingNamespace_t  GetShadingObject(GLuint index)                   { FUN_ENTRY(GL_LOG_TRACE); return mShadingObjectPool[index]; }
-    
-// Set Functions
-    void                       SetCacheManager(CacheManager *cacheManager);
+    inline uint32_t            GetShadingObjectCount(void)                const { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); return mShadingObjectCount; }
+    inline ShadingNamespace_t  GetShadingObject(GLuint index)                   { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); return mShadingObjectPool[index]; }
 
 // Map Functions
            uint32_t            PushShadingObject(const ShadingNamespace_t& obj);
@@ -129,7 +153,7 @@ public:
     inline bool                BufferExists(GLuint index)                 const { FUN_ENTRY(GL_LOG_TRACE); return mBuffers.ObjectExists(index); }
     inline bool                RenderbufferExists(GLuint index)           const { FUN_ENTRY(GL_LOG_TRACE); return mRenderbuffers.ObjectExists(index); }
     inline bool                FramebufferExists(GLuint index)            const { FUN_ENTRY(GL_LOG_TRACE); return mFramebuffers.ObjectExists(index); }
-    inline bool                ShadingObjectExists(GLuint index)          const { FUN_ENTRY(GL_LOG_TRACE); return mShadingObjectPool.find(index) != mShadingObjectPool.end(); }
+    inline bool                ShadingObjectExists(GLuint index)          const { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); return mShadingObjectPool.find(index) != mShadingObjectPool.end(); }
 
            GLboolean           IsShadingObject(GLuint index, shadingNamespaceType_t type) const;
     bool                       IsTextureAttachedToFBO(const Texture *texture);
@@ -138,13 +162,19 @@ public:
 
     void                       UpdateFramebufferObjects(GLuint index, GLenum target);
     void                       CreateDefaultTextures(void);
+    uint32_t                   EvictIdleTextures(uint32_t slot, vulkanAPI::CommandBufferManager *commandBufferManager);
+    bool                       IsTextureIdle(const Texture *texture, uint32_t slot, uint64_t completedSerial, uint64_t submitSerial, uint64_t idleSubmits) const;
+    /// whether the submissions of the other contexts may still refer to the texture
+    inline bool                IsTextureUsedByOtherContexts(const Texture *texture, uint32_t slot) const { FUN_ENTRY(GL_LOG_TRACE); return !IsTextureIdle(texture, slot, UINT64_MAX, UINT64_MAX, 0); }
+    void                       EndTransientTextureFrame(vulkanAPI::CommandBufferManager *commandBufferManager);
+    inline TransientTexturePool *GetTransientTexturePool(void)                  { FUN_ENTRY(GL_LOG_TRACE); return &mTransientTexturePool; }
 
 //PurgeList Functions
-    void                       AddToPurgeList(BufferObject *object)             { FUN_ENTRY(GL_LOG_TRACE); mPurgeListBufferObject.push_back(object); }
-    void                       AddToPurgeList(Texture *object)                  { FUN_ENTRY(GL_LOG_TRACE); mPurgeListTexture.push_back(object); }
-    void                       AddToPurgeList(Shader *object)                   { FUN_ENTRY(GL_LOG_TRACE); mPurgeListShaders.push_back(object); }
-    void                       AddToPurgeList(ShaderProgram *object)            { FUN_ENTRY(GL_LOG_TRACE); mPurgeListShaderPrograms.push_back(object); }
-    void                       AddToPurgeList(Renderbuffer *object)             { FUN_ENTRY(GL_LOG_TRACE); mPurgeListRenderbuffers.push_back(object); }
+    void                       AddToPurgeList(BufferObject *object)             { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); mPurgeListBufferObject.push_back(object); }
+    void                       AddToPurgeList(Texture *object)                  { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); mPurgeListTexture.push_back(object); }
+    void                       AddToPurgeList(Shader *object)                   { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); mPurgeListShaders.push_back(object); }
+    void                       AddToPurgeList(ShaderProgram *object)            { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); mPurgeListShaderPrograms.push_back(object); }
+    void                       AddToPurgeList(Renderbuffer *object)             { FUN_ENTRY(GL_LOG_TRACE); std::lock_guard<std::recursive_mutex> lock(mMutex); mPurgeListRenderbuffers.push_back(object); }
     void                       CleanPurgeList();
     void                       FramebufferCacheAttachement(Texture *texture, GLuint index);
     void                       FramebufferCacheAttachement(Renderbuffer *renderbuffer, GLuint index);
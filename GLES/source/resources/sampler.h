@@ -33,6 +33,8 @@ private:
     GLenum                  mMagFilter;
     GLenum                  mWrapS;
     GLenum                  mWrapT;
+    GLenum                  mCompareMode;
+    GLenum                  mCompareFunc;
 
 public:
     Sampler();
@@ -43,6 +45,8 @@ public:
     inline GLenum           GetMagFilter(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return mMagFilter; }
     inline GLenum           GetWrapS(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mWrapS; }
     inline GLenum           GetWrapT(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mWrapT; }
+    inline GLenum           GetCompareMode(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mCompareMode; }
+    inline GLenum           GetCompareFunc(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mCompareFunc; }
 
 // Update Functions
     inline bool             UpdateMinFilter(GLenum mode)                        { FUN_ENTRY(GL_LOG_TRACE); bool res = mMinFilter != mode;
@@ -57,6 +61,12 @@ public:
     inline bool             UpdateWrapT(GLenum mode)                            { FUN_ENTRY(GL_LOG_TRACE); bool res = mWrapT != mode;
                                                                                                            mWrapT = mode;
                                                                                                            return res; }
+    inline bool             UpdateCompareMode(GLenum mode)                      { FUN_ENTRY(GL_LOG_TRACE); bool res = mCompareMode != mode;
+                                                                                                           mCompareMode = mode;
+                                                                                                           return res; }
+    inline bool             UpdateCompareFunc(GLenum func)                      { FUN_ENTRY(GL_LOG_TRACE); bool res = mCompareFunc != func;
+                                                                                                           mCompareFunc = func;
+                                                                                                           return res; }
 };
 
 #endif // __SAMPLER_H__
@@ -169,10 +169,16 @@ ScreenSpacePass::ShaderData::Generate(const std::string& vertexSource, const std
     const char *vertexSourcec100Str = vertexSource.c_str();
     const char *fragmentSourcec100Str = fragmentSource.c_str();
 
+    // a queue without threads compiles on this thread, the pass is needed right away
+    TaskQueue compileQueue;
+    compileQueue.SetMaxThreads(0);
+
     vertShader->SetShaderType(SHADER_TYPE_VERTEX);
     GLint vertexLength = static_cast<GLint>(vertexSource.length());
     vertShader->SetShaderSource(1, &vertexSourcec100Str, &vertexLength);
-    if(!vertShader->CompileShader()) {
+    vertShader->CompileShader(&compileQueue);
+    vertShader->CompleteCompile();
+    if(!vertShader->IsCompiled()) {
         GLOVE_PRINT_ERR("Could not compile vertex shader for screen-space pass\n");
         return false;
     }
@@ -180,14 +186,18 @@ ScreenSpacePass::ShaderData::Generate(const std::string& vertexSource, const std
     fragShader->SetShaderType(SHADER_TYPE_FRAGMENT);
     GLint fragmentLength = static_cast<GLint>(fragmentSource.length());
     fragShader->SetShaderSource(1, &fragmentSourcec100Str, &fragmentLength);
-    if(!fragShader->CompileShader()) {
+    fragShader->CompileShader(&compileQueue);
+    fragShader->CompleteCompile();
+    if(!fragShader->IsCompiled()) {
         GLOVE_PRINT_ERR("Could not compile fragment shader for screen-space pass\n");
         return false;
     }
 
     shaderProgram->AttachShader(vertShader);
     shaderProgram->AttachShader(fragShader);
-    if(!shaderProgram->LinkProgram()) {
+    shaderProgram->LinkProgram(&compileQueue);
+    shaderProgram->CompleteLink();
+    if(!shaderProgram->IsLinked()) {
         GLOVE_PRINT_ERR("Could not link shader program for screen-space pass\n");
         return false;
     }
@@ -284,8 +294,11 @@ ScreenSpacePass::CreateDefaultPipelineStates()
 
     mPipeline->SetVertexInputState(&mVertexInputInfo);
 
+    // stencil clears differ only in their mask and value, so they share one VkPipeline
     std::vector<VkDynamicState> states = {VK_DYNAMIC_STATE_VIEWPORT,
-                                          VK_DYNAMIC_STATE_SCISSOR};
+                                          VK_DYNAMIC_STATE_SCISSOR,
+                                          VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+                                          VK_DYNAMIC_STATE_STENCIL_REFERENCE};
     mPipeline->CreateDynamicState(states);
 
     mPipeline->SetDepthTestEnable(false);
@@ -293,6 +306,47 @@ ScreenSpacePass::CreateDefaultPipelineStates()
     return true;
 }
 
+void
+ScreenSpacePass::WarmUp(VkFormat colorFormat, VkFormat depthStencilFormat, VkSampleCountFlagBits samples)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!Initialize() || !mValid || !mWarmedUp.emplace(colorFormat, depthStencilFormat, samples).second) {
+        return;
+    }
+
+    // the masks that clears are most often drawn with: the color without its alpha, the stencil alone and both,
+    // compiled by the pipeline warmer into the pipeline cache, so that the first such clear finds them there
+    const VkColorComponentFlags colorRGB = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+    const struct {
+        VkColorComponentFlags                   colorMask;
+        bool                                    stencil;
+    } variants[] = {{colorRGB, false}, {0, true}, {colorRGB, true}};
+
+    // the stencil operations are the ones that clears drawing the stencil leave behind for all that follow
+    const bool hasStencil = VkFormatIsStencil(depthStencilFormat);
+    mPipeline->SetMultisampleRasterizationSamples(samples);
+    mPipeline->SetStencilFrontCompareOp(VK_COMPARE_OP_ALWAYS);
+    mPipeline->SetStencilFrontPassOp(VK_STENCIL_OP_REPLACE);
+    mPipeline->SetStencilBackCompareOp(VK_COMPARE_OP_ALWAYS);
+    mPipeline->SetStencilBackPassOp(VK_STENCIL_OP_REPLACE);
+    for(const auto &variant : variants) {
+        if(variant.stencil && !hasStencil) {
+            continue;
+        }
+
+        mPipeline->SetColorBlendAttachmentWriteMask(variant.colorMask);
+        mPipeline->SetStencilTestEnable(variant.stencil);
+
+        vulkanAPI::PipelineWarmer::StateRecord_t record;
+        mPipeline->GetStateRecord(colorFormat, depthStencilFormat, VK_FALSE, &record);
+        mShaderData.shaderProgram->WarmUpVkPipeline(record);
+    }
+
+    // the clears set every state they depend on before they create their pipeline
+    mPipeline->SetUpdatePipeline(true);
+}
+
 bool
 ScreenSpacePass::Destroy()
 {
@@ -349,10 +403,18 @@ ScreenSpacePass::BindUniformDescriptors(const VkCommandBuffer *cmdBuffer) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mShaderData.shaderProgram->UpdateDescriptorSet();
     mShaderData.shaderProgram->UpdateBuiltInUniformData(0.0f, 1.0f);
-    vkCmdBindDescriptorSets(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShaderData.shaderProgram->GetVkPipelineLayout(), 0, 1,
-                            mShaderData.shaderProgram->GetVkDescSet(), 0, nullptr);
+    mShaderData.shaderProgram->UpdateDescriptorSet();
+    if(*mShaderData.shaderProgram->GetVkDescSet()) {
+        vkCmdBindDescriptorSets(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShaderData.shaderProgram->GetVkPipelineLayout(), 0, 1,
+                                mShaderData.shaderProgram->GetVkDescSet(), mShaderData.shaderProgram->GetVkDynamicOffsetCount(),
+                                mShaderData.shaderProgram->GetVkDynamicOffsets());
+    }
+    if(mShaderData.shaderProgram->UsesBindlessTextures() && *mCacheManager->GetBindlessTextureTable()->GetVkDescSet()) {
+        vkCmdBindDescriptorSets(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mShaderData.shaderProgram->GetVkPipelineLayout(), GLOVE_BINDLESS_TEXTURE_SET, 1,
+                                mCacheManager->GetBindlessTextureTable()->GetVkDescSet(), 0, nullptr);
+    }
+    mShaderData.shaderProgram->PushConstants(cmdBuffer);
 }
 
 void
@@ -34,6 +34,8 @@
 #include <string>
 #include <utility>
 #include <map>
+#include <set>
+#include <tuple>
 
 class ScreenSpacePass {
 private:
@@ -81,6 +83,9 @@ struct ShaderData {
     vulkanAPI::PipelineCache                   *mPipelineCache;
     vulkanAPI::Pipeline*                        mPipeline;
 
+    // attachment formats and sample counts whose pipelines have been compiled ahead of the first masked clear
+    std::set<std::tuple<VkFormat, VkFormat, VkSampleCountFlagBits>> mWarmedUp;
+
     // buffers
 
     bool                                        mInitialized;
@@ -114,6 +119,7 @@ public:
 
     bool                                        Initialize();
     bool                                        CreateDefaultPipelineStates();
+    void                                        WarmUp(VkFormat colorFormat, VkFormat depthStencilFormat, VkSampleCountFlagBits samples);
     void                                        BindVertexBuffers(const VkCommandBuffer *cmdBuffer) const;
     void                                        BindUniformDescriptors(const VkCommandBuffer *cmdBuffer) const;
     void                                        BindPipeline(const VkCommandBuffer *cmdBuffer) const;
@@ -30,7 +30,7 @@
 #include "shader.h"
 
 Shader::Shader(const vulkanAPI::vkContext_t *vkContext)
-: mVkContext(vkContext), mVkShaderModule(VK_NULL_HANDLE), mShaderCompiler(nullptr), mSource(nullptr),
+: mVkContext(vkContext), mShaderCompiler(nullptr), mSource(nullptr),
   mSourceLength(0), mShaderType(SHADER_TYPE_INVALID), mShaderVersion(ESSL_VERSION_100), mCompiled(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
@@ -41,7 +41,6 @@ Shader::~Shader()
     FUN_ENTRY(GL_LOG_TRACE);
 
     FreeSources();
-    DestroyVkShader();
 }
 
 int
@@ -49,7 +48,7 @@ Shader::GetInfoLogLength(void) const
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    return mShaderCompiler->GetShaderInfoLog(mShaderType, mShaderVersion) ? (int)strlen(mShaderCompiler->GetShaderInfoLog(mShaderType, mShaderVersion)) : 0;
+    return static_cast<int>(mInfoLog.size());
 }
 
 void
@@ -70,7 +69,9 @@ Shader::SetShaderSource(GLsizei count, const GLchar *const *source, const GLint
     FUN_ENTRY(GL_LOG_DEBUG);
 
     FreeSources();
+    mCompileJob.reset();
     mCompiled = false;
+    mInfoLog.clear();
 
     if(!source || !count) {
         return;
@@ -155,67 +156,54 @@ Shader::GetInfoLog(void) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    char *log = nullptr;
-
-    if(mShaderCompiler) {
-        uint32_t len = strlen(mShaderCompiler->GetShaderInfoLog(mShaderType, mShaderVersion)) + 1;
-        log = new char[len];
-
-        memcpy(log, mShaderCompiler->GetShaderInfoLog(mShaderType, mShaderVersion), len);
-
-        /// NULL terminate it
-        if(log[len - 1] != '\0') {
-            log[len] = '\0';
-        }
-    }
+    char *log = new char[mInfoLog.size() + 1];
+    memcpy(log, mInfoLog.c_str(), mInfoLog.size() + 1);
 
     return log;
 }
 
-bool
-Shader::CompileShader(void)
+void
+Shader::CompileShader(TaskQueue *compileQueue)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mCompiled = mShaderCompiler->CompileShader(&mSource, mShaderType, mShaderVersion);
+    mCompiled = false;
+    mInfoLog.clear();
 
-    return mCompiled;
-}
+    std::shared_ptr<CompileJob_t> job = std::make_shared<CompileJob_t>();
+    job->compiler = mShaderCompiler->CreateCompiler();
+    job->source   = std::string(mSource);
+    job->compiled = false;
 
-void
-Shader::DestroyVkShader(void)
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
+    const shader_type_t type    = mShaderType;
+    const ESSL_VERSION  version = mShaderVersion;
+
+    // glslang keeps its allocations per thread, so the compiler is used and released on the worker only
+    job->done = compileQueue->Submit([job, type, version]() {
+        CHROME_TRACE_SPAN("compile shader", "shader");
+        const char *source = job->source.c_str();
+        job->compiled = job->compiler->CompileShader(&source, type, version);
+        const char *infoLog = job->compiler->GetShaderInfoLog(type, version);
+        job->infoLog  = infoLog ? infoLog : "";
+
+        delete job->compiler;
+        job->compiler = nullptr;
+    });
 
-     if(mVkShaderModule != VK_NULL_HANDLE) {
-         vkDestroyShaderModule(mVkContext->vkDevice, mVkShaderModule, nullptr);
-         mVkShaderModule = VK_NULL_HANDLE;
-     }
+    mCompileJob = job;
 }
 
-VkShaderModule
-Shader::CreateVkShaderModule(void)
+void
+Shader::CompleteCompile(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    assert(mShaderType == SHADER_TYPE_VERTEX || mShaderType == SHADER_TYPE_FRAGMENT);
-
-    DestroyVkShader();
-
-    if(!mSpv.size()) {
-        return VK_NULL_HANDLE;
-    }
-
-    VkShaderModuleCreateInfo moduleCreateInfo;
-    moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    moduleCreateInfo.pNext = nullptr;
-    moduleCreateInfo.flags = 0;
-    moduleCreateInfo.codeSize = mSpv.size() * sizeof(uint32_t);
-    moduleCreateInfo.pCode = mSpv.data();
-
-    if(vkCreateShaderModule(mVkContext->vkDevice, &moduleCreateInfo, nullptr, &mVkShaderModule)) {
-        return VK_NULL_HANDLE;
+    if(!mCompileJob) {
+        return;
     }
 
-    return mVkShaderModule;
+    mCompileJob->done.wait();
+    mCompiled = mCompileJob->compiled;
+    mInfoLog  = mCompileJob->infoLog;
+    mCompileJob.reset();
 }
@@ -24,13 +24,16 @@
 #ifndef __SHADER_H__
 #define __SHADER_H__
 
+#include <memory>
+#include <string>
 #include "shaderCompiler.h"
 #include "refObject.h"
+#include "utils/arrays.hpp"
+#include "utils/taskQueue.h"
 
-class Shader : public refObject {
+class Shader : public refObject, public ArrayObject {
 private:
     const vulkanAPI::vkContext_t *      mVkContext;
-    VkShaderModule                      mVkShaderModule;
     ShaderCompiler *                    mShaderCompiler;
 
     char *                              mSource;
@@ -40,16 +43,28 @@ private:
     shader_type_t                       mShaderType;
     ESSL_VERSION                        mShaderVersion;
     bool                                mCompiled;
+    std::string                         mInfoLog;
+
+    /// compile run on the shader compile queue with a compiler of its own,
+    /// its result is taken over by the first call that needs it
+    typedef struct CompileJob_t {
+        ShaderCompiler *                compiler;
+        std::string                     source;
+        bool                            compiled;
+        std::string                     infoLog;
+        std::shared_future<void>        done;
+    } CompileJob_t;
+
+    std::shared_ptr<CompileJob_t>       mCompileJob;
 
     void                                FreeSources(void);
-    void                                DestroyVkShader(void);
 
 public:
     Shader(const vulkanAPI::vkContext_t *vkContext = nullptr);
     ~Shader();
 
-    bool                                CompileShader(void);
-    VkShaderModule                      CreateVkShaderModule(void);
+    void                                CompileShader(TaskQueue *compileQueue);
+    void                                CompleteCompile(void);
 
 // Get Functions
     char *                              GetInfoLog(void)                        const;
@@ -67,6 +82,7 @@ public:
 
 // Is/Has Functions
     bool                                IsCompiled(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mCompiled; }
+    bool                                IsCompilePending(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return mCompileJob && !TaskQueue::IsDone(mCompileJob->done); }
     bool                                IsVertex(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return (mShaderType == SHADER_TYPE_VERTEX) ? true : false; }
     bool                                HasSource(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return (bool)mSource; }
 };
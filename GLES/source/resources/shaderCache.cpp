@@ -0,0 +1,118 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       shaderCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      On-disk cache of linked shader programs, keyed by their sources
+ *
+ *  @scope
+ *
+ *  Every entry is a file named after the hash of its key. The key is stored
+ *  in the file as well, so that a hash collision reads as a miss.
+ *
+ */
+
+#include "shaderCache.h"
+#include "utils/glLogger.h"
+#include "utils/atomicFileWriter.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+std::string
+ShaderCache::GetEntryPath(const std::string &key)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const char *dir = getenv(GLOVE_SHADER_CACHE_PATH_ENV);
+    std::string path = (dir != nullptr && dir[0] != '\0') ? std::string(dir) : std::string(GLOVE_SHADER_CACHE_DEFAULT_PATH);
+    if(path.empty()) {
+        return path;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < key.size(); ++i) {
+        hash = (hash ^ static_cast<uint8_t>(key[i])) * 0x100000001b3ULL;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.glsc", static_cast<unsigned long long>(hash));
+
+    return path + name;
+}
+
+bool
+ShaderCache::Load(const std::string &key, std::vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::string path = GetEntryPath(key);
+    if(path.empty()) {
+        return false;
+    }
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if(file == nullptr) {
+        return false;
+    }
+
+    bool loaded = false;
+    FileHeader_t header;
+    if(fread(&header, sizeof(FileHeader_t), 1, file) == 1 &&
+       header.magic   == GLOVE_SHADER_CACHE_FILE_MAGIC   &&
+       header.version == GLOVE_SHADER_CACHE_FILE_VERSION &&
+       header.keySize == key.size() && header.dataSize) {
+        std::vector<char> storedKey(key.size());
+        data.resize(static_cast<size_t>(header.dataSize));
+        loaded = fread(storedKey.data(), 1, storedKey.size(), file) == storedKey.size() &&
+                 !memcmp(storedKey.data(), key.data(), key.size()) &&
+                 fread(data.data(), 1, data.size(), file) == data.size();
+    }
+
+    fclose(file);
+
+    if(!loaded) {
+        data.clear();
+    }
+
+    return loaded;
+}
+
+bool
+ShaderCache::Store(const std::string &key, const std::vector<uint8_t> &data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::string path = GetEntryPath(key);
+    if(path.empty() || data.empty()) {
+        return false;
+    }
+
+    FileHeader_t header;
+    memset(static_cast<void *>(&header), 0, sizeof(FileHeader_t));
+    header.magic    = GLOVE_SHADER_CACHE_FILE_MAGIC;
+    header.version  = GLOVE_SHADER_CACHE_FILE_VERSION;
+    header.keySize  = key.size();
+    header.dataSize = data.size();
+
+    // background compile jobs may store the same entry at once
+    return AtomicFileWriter::Write(path, [&](FILE *file) {
+        return fwrite(&header, sizeof(FileHeader_t), 1, file) == 1 &&
+               fwrite(key.data(), 1, key.size(), file) == key.size() &&
+               fwrite(data.data(), 1, data.size(), file) == data.size();
+    });
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       shaderCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      On-disk cache of linked shader programs, keyed by their sources
+ *
+ */
+
+#ifndef __SHADERCACHE_H__
+#define __SHADERCACHE_H__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// Environment variable holding the directory of the on-disk shader cache
+#define GLOVE_SHADER_CACHE_PATH_ENV                     "GLOVE_SHADER_CACHE_PATH"
+/// Directory used when the environment variable is not set (empty disables the cache)
+#define GLOVE_SHADER_CACHE_DEFAULT_PATH                 ""
+#define GLOVE_SHADER_CACHE_FILE_MAGIC                   0x43535047  // "GPSC"
+/// Bump whenever the shader conversion, the compiler or the layout of the stored
+/// reflection changes, so that entries produced by an older build are not loaded
+#define GLOVE_SHADER_CACHE_FILE_VERSION                 7
+
+class ShaderCache {
+private:
+    typedef struct FileHeader_t {
+        uint32_t                magic;
+        uint32_t                version;
+        uint64_t                keySize;
+        uint64_t                dataSize;
+    } FileHeader_t;
+
+    static std::string          GetEntryPath(const std::string &key);
+
+public:
+    /// The key holds everything the result of a link depends on, compared in full on load
+    static bool                 Load(const std::string &key, std::vector<uint8_t> &data);
+    static bool                 Store(const std::string &key, const std::vector<uint8_t> &data);
+};
+
+#endif // __SHADERCACHE_H__
@@ -32,13 +32,27 @@ public:
     ShaderCompiler() {}
     virtual ~ShaderCompiler() {}
 
+/// Create Functions
+    /// a compiler of the same kind that keeps its own state, for a compile or link run on another thread
+    virtual ShaderCompiler*     CreateCompiler(void) const = 0;
+
+/// Release Functions
+    /// frees the front-end resources, they are set up again by the next compile
+    virtual void                ReleaseCompiler(void) = 0;
+
 /// Shader Functions
     virtual bool                PreprocessShader(uintptr_t program_ptr, shader_type_t shaderType, ESSL_VERSION version_in, ESSL_VERSION version_out, bool isYInverted) = 0;
     virtual bool                CompileShader(const char* const* source, shader_type_t shaderType, ESSL_VERSION version) = 0;
 
+/// Kernel Functions
+    /// compiles an internal compute shader, written for Vulkan, to SPIR-V
+    virtual bool                CompileKernel(const char* source, vector<uint32_t> &spv) = 0;
+
 /// Shader Program Functions
     virtual bool                LinkProgram(uintptr_t program_ptr, ESSL_VERSION version, vector<uint32_t> &vertSpv, vector<uint32_t> &fragSpv) = 0;
     virtual bool                ValidateProgram(ESSL_VERSION version) = 0;
+    /// links the compute shader compiled last, into a program of its own
+    virtual bool                LinkComputeProgram(vector<uint32_t> &spv) = 0;
     
 /// Reflection Functions
     virtual void                PrepareReflection(ESSL_VERSION version) = 0;
@@ -59,6 +73,12 @@ public:
     virtual void                EnableSaveBinaryToFiles(void) = 0;
     virtual void                EnableSaveSourceToFiles(void) = 0;
     virtual void                EnableSaveSpvTextToFile(void) = 0;
+    virtual void                EnableBindlessTextures(void) = 0;
+
+/// Transform Feedback Functions
+    /// the vertex outputs the next link captures, interleaved in one buffer or each in its own
+    virtual void                EnableTransformFeedback(const vector<string> &varyings, bool separate) = 0;
+    virtual uint32_t            GetTransformFeedbackStride(uint32_t buffer) const = 0;
 };
 
 #endif // __SHADERCOMPILER_H__
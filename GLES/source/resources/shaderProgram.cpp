@@ -26,9 +26,19 @@
  *
  */
 
+#include <algorithm>
 #include "shaderProgram.h"
+#include "shaderCache.h"
+#include "vulkan/shaderModuleCache.h"
+#include "vulkan/pipelineLayoutCache.h"
+#include "vulkan/perfCounters.h"
+#include "vulkan/hostAllocator.h"
 #include "context/context.h"
 
+/// Number of generated line loop index buffers, one per vertex count, a program keeps before they are recreated
+#define GLOVE_MAX_CACHED_LINE_LOOP_INDEX_BUFFERS        32
+#define GLOVE_MAX_CACHED_TRIANGLE_FAN_INDEX_BUFFERS     32
+
 ShaderProgram::ShaderProgram(const vulkanAPI::vkContext_t *vkContext)
 : refObject()
 {
@@ -42,30 +52,51 @@ ShaderProgram::ShaderProgram(const vulkanAPI::vkContext_t *vkContext)
     mStagesIDs[0] = -1;
     mStagesIDs[1] = -1;
 
+    mComputeShader     = nullptr;
+    mIsCompute         = false;
+    mVkComputePipeline = VK_NULL_HANDLE;
+
+    mTransformFeedbackBufferMode       = GL_INTERLEAVED_ATTRIBS;
+    mLinkedTransformFeedbackBufferMode = GL_INTERLEAVED_ATTRIBS;
+    memset(static_cast<void *>(mTransformFeedbackStrides), 0, sizeof(mTransformFeedbackStrides));
+
     mMinDepthRange = 1.f;
     mMaxDepthRange = 0.f;
+    mDepthRangeLocations[0] = -1;
+    mDepthRangeLocations[1] = -1;
+    mDepthRangeLocations[2] = -1;
+    mDepthRangeValid = false;
 
     mVkShaderModules[0] = VK_NULL_HANDLE;
     mVkShaderModules[1] = VK_NULL_HANDLE;
+    mShaderSPVhash      = 0;
 
     mVkDescSetLayout = VK_NULL_HANDLE;
     mVkDescSetLayoutBind = nullptr;
-    mVkDescPool = VK_NULL_HANDLE;
     mVkDescSet = VK_NULL_HANDLE;
+#ifdef VK_KHR_descriptor_update_template
+    mVkDescUpdateTemplate = VK_NULL_HANDLE;
+#endif // VK_KHR_descriptor_update_template
+    mDescriptorPoolSerial = 0;
+    mHasTransientTextures = false;
+    mBindlessTableSerial = 0;
     mVkPipelineLayout = VK_NULL_HANDLE;
+    mUniformRingGeneration = 0;
+    memset(static_cast<void *>(&mVkPushConstantRange), 0, sizeof(mVkPushConstantRange));
+    memset(static_cast<void *>(&mVkSpecializationInfo), 0, sizeof(mVkSpecializationInfo));
 
     mPipelineCache = new vulkanAPI::PipelineCache(mVkContext);
 
     mStageCount = 0;
 
     mUpdateDescriptorSets = false;
-    mUpdateDescriptorData = false;
     mLinked = false;
     mIsPrecompiled = false;
     mValidated = false;
     mActiveVertexVkBuffersCount = 0;
+    mVertexInputLayoutSerial = 0;
     mActiveIndexVkBuffer = VK_NULL_HANDLE;
-    mExplicitIbo = nullptr;
+    mActiveIndexVkType = VK_INDEX_TYPE_UINT16;
 
     SetPipelineVertexInputStateInfo();
 }
@@ -81,10 +112,15 @@ ShaderProgram::~ShaderProgram()
         mPipelineCache = nullptr;
     }
 
-    if(mExplicitIbo != nullptr) {
-        delete mExplicitIbo;
-        mExplicitIbo = nullptr;
+    for(auto &iter : mLineLoopIndexBuffers) {
+        delete iter.second;
+    }
+    mLineLoopIndexBuffers.clear();
+
+    for(auto &iter : mTriangleFanIndexBuffers) {
+        delete iter.second;
     }
+    mTriangleFanIndexBuffers.clear();
 }
 
 bool
@@ -94,15 +130,18 @@ ShaderProgram::SetPipelineShaderStage(uint32_t &pipelineShaderStageCount, int *p
 
     bool linked = true;
 
+    // compute programs have no graphics pipelines
     pipelineShaderStageCount = GetStageCount();
-    if(pipelineShaderStageCount == 1) {
+    if(IsCompute()) {
+        linked = false;
+    } else if(pipelineShaderStageCount == 1) {
         pipelineShaderStages[0].flags  = 0;
         pipelineShaderStages[0].pNext  = nullptr;
         pipelineShaderStages[0].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         pipelineShaderStages[0].stage  = GetShaderStage();
         pipelineShaderStages[0].module = GetShaderModule();
         pipelineShaderStages[0].pName  = "main\0";
-        pipelineShaderStages[0].pSpecializationInfo = nullptr;
+        pipelineShaderStages[0].pSpecializationInfo = GetVkSpecializationInfo();
         pipelineShaderStagesIDs[0]     = GetStagesIDs(0);
 
         if(GetShaderModule() == VK_NULL_HANDLE) {
@@ -115,7 +154,7 @@ ShaderProgram::SetPipelineShaderStage(uint32_t &pipelineShaderStageCount, int *p
         pipelineShaderStages[0].stage  = VK_SHADER_STAGE_VERTEX_BIT;
         pipelineShaderStages[0].module = GetVertexShaderModule();
         pipelineShaderStages[0].pName  = "main\0";
-        pipelineShaderStages[0].pSpecializationInfo = nullptr;
+        pipelineShaderStages[0].pSpecializationInfo = GetVkSpecializationInfo();
         pipelineShaderStagesIDs[0]     = GetStagesIDs(0);
 
         if(GetVertexShaderModule() == VK_NULL_HANDLE) {
@@ -128,7 +167,7 @@ ShaderProgram::SetPipelineShaderStage(uint32_t &pipelineShaderStageCount, int *p
         pipelineShaderStages[1].stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
         pipelineShaderStages[1].module = GetFragmentShaderModule();
         pipelineShaderStages[1].pName  = "main\0";
-        pipelineShaderStages[1].pSpecializationInfo = nullptr;
+        pipelineShaderStages[1].pSpecializationInfo = GetVkSpecializationInfo();
         pipelineShaderStagesIDs[1]     = GetStagesIDs(1);
 
         if(GetFragmentShaderModule() == VK_NULL_HANDLE) {
@@ -160,7 +199,7 @@ ShaderProgram::GetInfoLogLength(void) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    return mShaderCompiler->GetProgramInfoLog(ESSL_VERSION_100) ? (int)strlen(mShaderCompiler->GetProgramInfoLog(ESSL_VERSION_100)) + 1 : 0;
+    return mInfoLog.empty() ? 0 : static_cast<int>(mInfoLog.size()) + 1;
 }
 
 Shader *
@@ -170,7 +209,8 @@ ShaderProgram::IsShaderAttached(Shader *shader) const
 
     if(shader &&
       ((shader->GetShaderType() == SHADER_TYPE_VERTEX   && mShaders[0] == shader) ||
-       (shader->GetShaderType() == SHADER_TYPE_FRAGMENT && mShaders[1] == shader))) {
+       (shader->GetShaderType() == SHADER_TYPE_FRAGMENT && mShaders[1] == shader) ||
+       (shader->GetShaderType() == SHADER_TYPE_COMPUTE  && mComputeShader == shader))) {
         return shader;
     }
 
@@ -183,7 +223,11 @@ ShaderProgram::AttachShader(Shader *shader)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     shader->Bind();
-    mShaders[shader->GetShaderType() == SHADER_TYPE_VERTEX ? 0 : 1] = shader;
+    if(shader->GetShaderType() == SHADER_TYPE_COMPUTE) {
+        mComputeShader = shader;
+    } else {
+        mShaders[shader->GetShaderType() == SHADER_TYPE_VERTEX ? 0 : 1] = shader;
+    }
 }
 
 void
@@ -199,6 +243,8 @@ ShaderProgram::DetachShader(Shader *shader)
         mShaders[0] = nullptr;
     } else if(shader->GetShaderType() == SHADER_TYPE_FRAGMENT) {
         mShaders[1] = nullptr;
+    } else if(shader->GetShaderType() == SHADER_TYPE_COMPUTE) {
+        mComputeShader = nullptr;
     }
 
     shader->Unbind();
@@ -220,6 +266,11 @@ ShaderProgram::DetachShaders()
     if(shaderPtr) {
         DetachShader(shaderPtr);
     }
+
+    shaderPtr = GetComputeShader();
+    if(shaderPtr) {
+        DetachShader(shaderPtr);
+    }
 }
 
 uint32_t
@@ -275,6 +326,92 @@ ShaderProgram::DeserializeShadersSpirv(const void *binary)
     return 2 * sizeof(uint32_t) + vsSpirvSize + fsSpirvSize;
 }
 
+std::string
+ShaderProgram::GetShaderCacheKey(bool isYInverted) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mShaders[0] || !mShaders[1]) {
+        return std::string();
+    }
+
+    /// the optimization level decides the stored SPIR-V, optimized modules are what gets cached
+    std::string key = std::to_string(GLOVE_SHADER_CACHE_FILE_VERSION) + 'O' + std::to_string(GLOVE_SPIRV_OPTIMIZATION_LEVEL) + (isYInverted ? "Y" : "N") +
+                      (mVkContext->mUseBindlessTextures ? "B" : "");
+
+    for(uint32_t i = 0; i < MAX_SHADERS; ++i) {
+        char *source = mShaders[i]->GetShaderSource();
+        int   length = source ? mShaders[i]->GetShaderSourceLength() : 0;
+        key += std::to_string(length) + ':';
+        key.append(source ? source : "", length);
+        delete[] source;
+    }
+
+    /// locations bound before linking decide the attribute layout, which is part of the stored reflection
+    for(const auto &it : mShaderResourceInterface.GetCustomAttribsLayout()) {
+        key += it.first + '=' + std::to_string(it.second) + ';';
+    }
+
+    return key;
+}
+
+bool
+ShaderProgram::LoadFromShaderCache(LinkJob_t *job)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vector<uint8_t> data;
+    if(job->cacheKey.empty() || !ShaderCache::Load(job->cacheKey, data)) {
+        return false;
+    }
+
+    /// the entry is reflection followed by the SPIR-V of both stages, each prefixed with its size
+    size_t reflectionSize = job->compiler->GetShaderReflection()->GetReflectionSize();
+    size_t offset         = reflectionSize;
+    for(uint32_t i = 0; i < MAX_SHADERS; ++i) {
+        uint32_t spirvSize = 0;
+        if(offset + sizeof(uint32_t) > data.size()) {
+            return false;
+        }
+        memcpy(&spirvSize, data.data() + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if(offset + spirvSize > data.size() || spirvSize % sizeof(uint32_t)) {
+            return false;
+        }
+        job->spirv[i].resize(spirvSize / sizeof(uint32_t));
+        memcpy(job->spirv[i].data(), data.data() + offset, spirvSize);
+        offset += spirvSize;
+    }
+    if(offset != data.size()) {
+        return false;
+    }
+
+    job->reflection.assign(data.begin(), data.begin() + reflectionSize);
+
+    return true;
+}
+
+void
+ShaderProgram::StoreToShaderCache(const LinkJob_t *job)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(job->cacheKey.empty()) {
+        return;
+    }
+
+    vector<uint8_t> data(job->reflection);
+    for(uint32_t i = 0; i < MAX_SHADERS; ++i) {
+        uint32_t spirvSize = static_cast<uint32_t>(sizeof(uint32_t) * job->spirv[i].size());
+        const uint8_t *sizePtr  = reinterpret_cast<const uint8_t *>(&spirvSize);
+        const uint8_t *spirvPtr = reinterpret_cast<const uint8_t *>(job->spirv[i].data());
+        data.insert(data.end(), sizePtr, sizePtr + sizeof(uint32_t));
+        data.insert(data.end(), spirvPtr, spirvPtr + spirvSize);
+    }
+
+    ShaderCache::Store(job->cacheKey, data);
+}
+
 const ShaderResourceInterface::attribute *
 ShaderProgram::GetVertexAttribute(int index) const
 {
@@ -307,11 +444,30 @@ ShaderProgram::GetAttributeLocation(const char *name) const
     return mShaderResourceInterface.GetAttributeLocation(name);
 }
 
+size_t
+ShaderProgram::GetTransformFeedbackVaryingMaxLen(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the length includes the null terminator, as for the active uniforms and attributes
+    size_t maxLen = 0;
+    for(const auto &varying : mLinkedTransformFeedbackVaryings) {
+        maxLen = std::max(maxLen, varying.length() + 1);
+    }
+
+    return maxLen;
+}
+
 VkPipelineCache
 ShaderProgram::GetVkPipelineCache(void)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    /// Pipelines go to the context-wide cache, which persists across launches
+    if(mVkContext->vkPipelineCache != VK_NULL_HANDLE) {
+        return mVkContext->vkPipelineCache;
+    }
+
     if(mPipelineCache->GetPipelineCache() == VK_NULL_HANDLE) {
         mPipelineCache->Create(nullptr, 0);
     }
@@ -319,6 +475,23 @@ ShaderProgram::GetVkPipelineCache(void)
     return mPipelineCache->GetPipelineCache();
 }
 
+bool
+ShaderProgram::GetVkPipelineCacheData(void *data, size_t *size) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mPipelineCache->GetPipelineCache() != VK_NULL_HANDLE) {
+        return mPipelineCache->GetData(data, size);
+    }
+
+    if(mVkContext->vkPipelineCache != VK_NULL_HANDLE) {
+        VkResult err = vkGetPipelineCacheData(mVkContext->vkDevice, mVkContext->vkPipelineCache, size, data);
+        return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    }
+
+    return false;
+}
+
 const std::string&
 ShaderProgram::GetAttributeName(int index) const
 {
@@ -341,75 +514,204 @@ ShaderProgram::Validate()
 }
 
 bool
-ShaderProgram::ValidateProgram(void)
+ShaderProgram::LinkProgram(TaskQueue *compileQueue)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    
-    const Shader *vs = mShaders[0];
-    const Shader *fs = mShaders[1];
+    mLinkJob.reset();
+    mInfoLog.clear();
+    mLinked = false;
+
+    for(uint32_t i = 0; i < MAX_SHADERS; ++i) {
+        if(mShaders[i]) {
+            mShaders[i]->CompleteCompile();
+        }
+    }
 
-    if((!vs || !fs) ||
-       (!vs->IsCompiled() || !fs->IsCompiled())) {
+    /// a compute shader is linked alone
+    if(mComputeShader) {
+        mComputeShader->CompleteCompile();
+        if(mShaders[0] || mShaders[1]) {
+            mInfoLog = "ERROR: A compute shader cannot be linked with other shaders\n";
+            return false;
+        }
+        if(!mComputeShader->IsCompiled()) {
+            return false;
+        }
+    } else if((!mShaders[0] || !mShaders[1]) ||
+       (!mShaders[0]->IsCompiled() || !mShaders[1]->IsCompiled())) {
         return false;
     }
 
-    if(GLOVE_DUMP_INPUT_SHADER_REFLECTION) {
-        mShaderCompiler->EnablePrintReflection(ESSL_VERSION_100);
+    Context *context = GetCurrentContext();
+    assert(context);
+
+    /// everything the job reads is copied, so the shaders may be recompiled or deleted while it runs
+    std::shared_ptr<LinkJob_t> job = std::make_shared<LinkJob_t>();
+    job->compiler      = mShaderCompiler->CreateCompiler();
+    job->attribsLayout = mShaderResourceInterface.GetCustomAttribsLayout();
+    job->isYInverted   = context->IsYInverted();
+    job->isCompute     = mComputeShader != nullptr;
+    job->program       = reinterpret_cast<uintptr_t>(this);
+    job->cacheKey      = GetShaderCacheKey(job->isYInverted);
+    job->linked        = false;
+    job->xfbVaryings   = job->isCompute ? std::vector<std::string>() : mTransformFeedbackVaryings;
+    job->xfbSeparate   = mTransformFeedbackBufferMode == GL_SEPARATE_ATTRIBS;
+    memset(static_cast<void *>(job->xfbStrides), 0, sizeof(job->xfbStrides));
+
+    /// the layout of the captured outputs is not part of what the shader cache stores
+    if(!job->xfbVaryings.empty()) {
+        job->cacheKey.clear();
+        job->compiler->EnableTransformFeedback(job->xfbVaryings, job->xfbSeparate);
     }
-    
-    return mShaderCompiler->ValidateProgram(ESSL_VERSION_100);
-}
 
-bool
-ShaderProgram::LinkProgram()
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
+    for(uint32_t i = 0; i < MAX_SHADERS; ++i) {
+        Shader *shader = job->isCompute ? (i ? nullptr : mComputeShader) : mShaders[i];
+        char *source   = shader ? shader->GetShaderSource() : nullptr;
+        job->source[i] = source ? source : "";
+        delete[] source;
+    }
 
-    if(!(mLinked = ValidateProgram())) {
-        return false;
+    if(GLOVE_DUMP_INPUT_SHADER_REFLECTION) {
+        job->compiler->EnablePrintReflection(ESSL_VERSION_100);
     }
 
     if(GLOVE_SAVE_SHADER_SOURCES_TO_FILES) {
-        mShaderCompiler->EnableSaveSourceToFiles();
+        job->compiler->EnableSaveSourceToFiles();
     }
 
     if(GLOVE_SAVE_SPIRV_BINARY_TO_FILES) {
-        mShaderCompiler->EnableSaveBinaryToFiles();
+        job->compiler->EnableSaveBinaryToFiles();
     }
 
     if(GLOVE_SAVE_SPIRV_TEXT_TO_FILE) {
-        mShaderCompiler->EnableSaveSpvTextToFile();
+        job->compiler->EnableSaveSpvTextToFile();
     }
 
     if(GLOVE_DUMP_PROCESSED_SHADER_SOURCE) {
-        mShaderCompiler->EnablePrintConvertedShader();
+        job->compiler->EnablePrintConvertedShader();
     }
 
     if(GLOVE_DUMP_VULKAN_SHADER_REFLECTION) {
-        mShaderCompiler->EnablePrintReflection(ESSL_VERSION_400);
+        job->compiler->EnablePrintReflection(ESSL_VERSION_400);
     }
 
     if(GLOVE_DUMP_SPIRV_SHADER_SOURCE) {
-        mShaderCompiler->EnablePrintSpv();
+        job->compiler->EnablePrintSpv();
     }
 
-    ResetVulkanVertexInput();
+    if(mVkContext->mUseBindlessTextures) {
+        job->compiler->EnableBindlessTextures();
+    }
 
-    mShaderCompiler->PrepareReflection(ESSL_VERSION_100);
-    UpdateAttributeInterface();
+    mLinkJob       = job;
+    mLinkJob->done = compileQueue->Submit([job]() { RunLinkJob(job.get()); });
 
-    Context *context = GetCurrentContext();
-    assert(context);
-    mLinked = mShaderCompiler->PreprocessShader((uintptr_t)this, SHADER_TYPE_VERTEX  , ESSL_VERSION_100, ESSL_VERSION_400, context->IsYInverted()) &&
-              mShaderCompiler->PreprocessShader((uintptr_t)this, SHADER_TYPE_FRAGMENT, ESSL_VERSION_100, ESSL_VERSION_400, context->IsYInverted());
-    if(!mLinked) {
-        return false;
+    return true;
+}
+
+void
+ShaderProgram::RunLinkJob(LinkJob_t *job)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("link program", "shader");
+
+    ShaderCompiler *compiler = job->compiler;
+
+    /// programs that passed every check in an earlier run are read back as reflection and SPIR-V
+    if(LoadFromShaderCache(job)) {
+        job->linked = true;
+    } else if(job->isCompute) {
+        const char *csSource = job->source[0].c_str();
+        job->linked = compiler->CompileShader(&csSource, SHADER_TYPE_COMPUTE, ESSL_VERSION_100) &&
+                      compiler->LinkComputeProgram(job->spirv[0]);
+
+        if(job->linked) {
+            job->reflection.resize(compiler->GetShaderReflection()->GetReflectionSize());
+            compiler->SerializeReflection(job->reflection.data());
+        }
+
+        const char *infoLog = compiler->GetProgramInfoLog(ESSL_VERSION_100);
+        job->infoLog = infoLog ? infoLog : "";
+    } else {
+        /// the job compiles its own copy of the sources, so the result does not depend on what else was compiled meanwhile
+        const char *vsSource = job->source[0].c_str();
+        const char *fsSource = job->source[1].c_str();
+        job->linked = compiler->CompileShader(&vsSource, SHADER_TYPE_VERTEX  , ESSL_VERSION_100) &&
+                      compiler->CompileShader(&fsSource, SHADER_TYPE_FRAGMENT, ESSL_VERSION_100) &&
+                      compiler->ValidateProgram(ESSL_VERSION_100);
+
+        if(job->linked) {
+            compiler->PrepareReflection(ESSL_VERSION_100);
+
+            /// locations bound with glBindAttribLocation are resolved in the reflection the sources are converted with
+            ShaderResourceInterface attributeInterface;
+            for(const auto &it : job->attribsLayout) {
+                attributeInterface.SetCustomAttribsLayout(it.first.c_str(), it.second);
+            }
+            attributeInterface.SetReflection(compiler->GetShaderReflection());
+            attributeInterface.UpdateAttributeInterface();
+            attributeInterface.SetReflection(nullptr);
+
+            job->linked = compiler->PreprocessShader(job->program, SHADER_TYPE_VERTEX  , ESSL_VERSION_100, ESSL_VERSION_400, job->isYInverted) &&
+                          compiler->PreprocessShader(job->program, SHADER_TYPE_FRAGMENT, ESSL_VERSION_100, ESSL_VERSION_400, job->isYInverted) &&
+                          compiler->LinkProgram(job->program, ESSL_VERSION_400, job->spirv[0], job->spirv[1]);
+        }
+
+        if(job->linked) {
+            job->reflection.resize(compiler->GetShaderReflection()->GetReflectionSize());
+            compiler->SerializeReflection(job->reflection.data());
+            StoreToShaderCache(job);
+
+            for(uint32_t i = 0; i < GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS; ++i) {
+                job->xfbStrides[i] = job->xfbVaryings.empty() ? 0 : compiler->GetTransformFeedbackStride(i);
+            }
+        }
+
+        const char *infoLog = compiler->GetProgramInfoLog(ESSL_VERSION_100);
+        job->infoLog = infoLog ? infoLog : "";
+    }
+
+    delete compiler;
+    job->compiler = nullptr;
+}
+
+void
+ShaderProgram::CompleteLink(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mLinkJob) {
+        return;
     }
-    mLinked = mShaderCompiler->LinkProgram((uintptr_t)this, ESSL_VERSION_400, GetVertexShader()->GetSPV(), GetFragmentShader()->GetSPV());
+
+    std::shared_ptr<LinkJob_t> job = mLinkJob;
+    mLinkJob.reset();
+
+    job->done.wait();
+
+    mInfoLog   = job->infoLog;
+    mLinked    = job->linked;
+    mIsCompute = job->isCompute;
     if(!mLinked) {
-        return false;
+        return;
+    }
+
+    mLinkedTransformFeedbackVaryings   = job->xfbVaryings;
+    mLinkedTransformFeedbackBufferMode = job->xfbSeparate ? GL_SEPARATE_ATTRIBS : GL_INTERLEAVED_ATTRIBS;
+    memcpy(mTransformFeedbackStrides, job->xfbStrides, sizeof(mTransformFeedbackStrides));
+
+    ResetVulkanVertexInput();
+
+    /// program binaries and the reflection dumps read the reflection from the compiler of the context
+    mShaderCompiler->DeserializeReflection(job->reflection.data());
+    if(mIsCompute) {
+        GetComputeShader()->GetSPV().swap(job->spirv[0]);
+    } else {
+        GetVertexShader()->GetSPV().swap(job->spirv[0]);
+        GetFragmentShader()->GetSPV().swap(job->spirv[1]);
     }
+
     BuildShaderResourceInterface();
 
     /// A program object will fail to link if the number of active vertex attributes exceeds GL_MAX_VERTEX_ATTRIBS
@@ -418,7 +720,7 @@ ShaderProgram::LinkProgram()
        GetNumberOfActiveUniforms() > GLOVE_MAX_FRAGMENT_UNIFORM_VECTORS ||
        GetNumberOfActiveAttributes() > GLOVE_MAX_VERTEX_ATTRIBS) {
         mLinked = false;
-        return false;
+        return;
     }
 
     if(GLOVE_DUMP_VULKAN_SHADER_REFLECTION) {
@@ -426,42 +728,152 @@ ShaderProgram::LinkProgram()
         mShaderCompiler->PrintUniformReflection();
         printf("-------------------------------------------------\n\n");
     }
+}
+
+static uint32_t
+WidenIndices(const uint8_t *src, uint16_t *dst, uint32_t indexCount, bool primitiveRestart)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the restart index is the highest of its type, in the widened indices as well
+    uint8_t maxIndex = 0;
+    for(uint32_t i = 0; i < indexCount; ++i) {
+        if(primitiveRestart && src[i] == UINT8_MAX) {
+            dst[i] = UINT16_MAX;
+            continue;
+        }
+        dst[i]   = src[i];
+        maxIndex = std::max(maxIndex, src[i]);
+    }
 
-    return mLinked;
+    return maxIndex;
 }
 
 bool
-ShaderProgram::AllocateExplicitIndexBuffer(const void* data, size_t size, BufferObject** ibo)
+ShaderProgram::StreamIndices(const void* indices, uint32_t indexCount, GLenum type, bool widen, bool closeLoop, VkDeviceSize* offset, uint32_t* maxIndex)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // Indices are appended to the vertex ring of the context, which retires with the frame.
+    // They are copied to the frame arena first only when they are widened or their loop is
+    // closed, and the max index is found while they are widened.
+    const size_t srcIndexSize = type == GL_UNSIGNED_INT ? sizeof(GLuint) : type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLubyte);
+    const size_t dstIndexSize = widen ? sizeof(GLushort) : srcIndexSize;
+    const size_t size         = (indexCount + (closeLoop ? 1 : 0)) * dstIndexSize;
+
+    FrameArena::Scope scope(mCacheManager->GetFrameArena());
+    const void *data  = indices;
+    if(widen || closeLoop) {
+        void *copy = mCacheManager->GetFrameArena()->Allocate(size, sizeof(GLuint));
+        if(widen) {
+            const uint32_t widenedMaxIndex = WidenIndices(static_cast<const uint8_t *>(indices), static_cast<uint16_t *>(copy), indexCount,
+                                                          GetCurrentContext()->IsPrimitiveRestart());
+            if(maxIndex) {
+                *maxIndex = widenedMaxIndex;
+            }
+        } else {
+            memcpy(copy, indices, indexCount * srcIndexSize);
+        }
+        if(closeLoop) {
+            LineLoopConversion(copy, indexCount + 1, dstIndexSize);
+        }
+        data = copy;
+    }
+
+    if(!widen && maxIndex) {
+        *maxIndex = GetMaxIndex(nullptr, indexCount, type, indices);
+    }
+
+    vulkanAPI::UniformRing *vertexRing = mCacheManager->GetVertexRing();
+    uint32_t ringOffset = 0;
+    if(!vertexRing->Allocate(size, data, &ringOffset)) {
+        return false;
+    }
+
+    *offset              = ringOffset;
+    mActiveIndexVkBuffer = vertexRing->GetVkBuffer();
+
+    return true;
+}
+
+void
+ShaderProgram::ReleaseGeneratedIndexBuffers(std::map<uint32_t, BufferObject *> *indexBuffers)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(mExplicitIbo != nullptr) {
-        mCacheManager->CacheVBO(mExplicitIbo);
-        mExplicitIbo = nullptr;
+    // command buffers in flight may still refer to them
+    for(auto &iter : *indexBuffers) {
+        if(mCacheManager) {
+            mCacheManager->CacheVBO(iter.second);
+        } else {
+            delete iter.second;
+        }
     }
+    indexBuffers->clear();
+}
 
-    mExplicitIbo = new IndexBufferObject(mVkContext);
-    mExplicitIbo->SetTarget(GL_ELEMENT_ARRAY_BUFFER);
-    *ibo = mExplicitIbo;
+template<typename T>
+static void
+GenerateLineLoopIndices(T *indices, uint32_t vertCount)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    return mExplicitIbo->Allocate(size, data);
+    for(uint32_t i = 0; i < vertCount; ++i) {
+        indices[i] = static_cast<T>(i);
+    }
+    indices[vertCount] = 0;
 }
 
 bool
-ShaderProgram::ConvertIndexBufferToUint16(const void* srcData, size_t elementCount, BufferObject** ibo)
+ShaderProgram::PrepareGeneratedIndexBufferObject(GLenum mode, uint32_t vertCount)
 {
-    FUN_ENTRY(GL_LOG_TRACE);
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // indices 0..vertCount-1 followed by 0 close the loop, and the triangles of a fan are
+    // listed one by one, while the vertex buffer offsets select the first vertex
+    const bool lineLoop  = mode == GL_LINE_LOOP;
+    const bool useUint16 = vertCount <= UINT16_MAX + 1;
+    mActiveIndexVkType   = useUint16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    mActiveIndexVkBuffer = VK_NULL_HANDLE;
 
-    uint16_t* convertedIndicesU16 = new uint16_t[elementCount];
-    size_t actualSize = elementCount * sizeof(uint16_t);
+    std::map<uint32_t, BufferObject *> &indexBuffers = lineLoop ? mLineLoopIndexBuffers : mTriangleFanIndexBuffers;
+    const size_t maxCachedBuffers = lineLoop ? GLOVE_MAX_CACHED_LINE_LOOP_INDEX_BUFFERS : GLOVE_MAX_CACHED_TRIANGLE_FAN_INDEX_BUFFERS;
 
-    bool validatedBuffer = ConvertBuffer<uint8_t, uint16_t>(srcData, convertedIndicesU16, elementCount);
-    if(validatedBuffer) {
-        validatedBuffer = AllocateExplicitIndexBuffer(convertedIndicesU16, actualSize, ibo);
+    BufferObject *ibo = nullptr;
+    auto it = indexBuffers.find(vertCount);
+    if(it != indexBuffers.end()) {
+        ibo = it->second;
+    } else {
+        if(indexBuffers.size() >= maxCachedBuffers) {
+            ReleaseGeneratedIndexBuffers(&indexBuffers);
+        }
+
+        size_t indexSize = useUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        size_t size      = (lineLoop ? vertCount + 1 : GlTriangleFanToListCount(vertCount)) * indexSize;
+        uint8_t *indices = new uint8_t[size];
+        if(!lineLoop) {
+            GlTriangleFanToList(nullptr, vertCount, GL_NONE, indices, useUint16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+        } else if(useUint16) {
+            GenerateLineLoopIndices(reinterpret_cast<uint16_t *>(indices), vertCount);
+        } else {
+            GenerateLineLoopIndices(reinterpret_cast<uint32_t *>(indices), vertCount);
+        }
+
+        ibo = new IndexBufferObject(mVkContext);
+        bool res = ibo->Allocate(size, indices);
+        delete[] indices;
+
+        if(!res) {
+            delete ibo;
+            return false;
+        }
+        indexBuffers[vertCount] = ibo;
     }
-    delete[] convertedIndicesU16;
 
-    return validatedBuffer;
+    mActiveIndexVkBuffer = ibo->GetVkBuffer();
+    ibo->SetUsed(true);
+
+    return true;
 }
 
 void
@@ -473,21 +885,27 @@ ShaderProgram::LineLoopConversion(void* data, uint32_t indexCount, size_t elemen
 }
 
 uint32_t
-ShaderProgram::GetMaxIndex(BufferObject* ibo, uint32_t indexCount, size_t actualSize, VkDeviceSize offset)
+ShaderProgram::GetMaxIndex(BufferObject* ibo, uint32_t indexCount, GLenum type, const void* indices)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint16_t* srcData = new uint16_t[actualSize];
-    ibo->GetData(actualSize, offset, srcData);
+    // glDrawRangeElements names the highest vertex itself
+    assert(GetCurrentContext());
+    if(GetCurrentContext()->IsDrawRange()) {
+        return GetCurrentContext()->GetDrawRangeEnd();
+    }
 
-    uint16_t maxIndex = srcData[0];
-    for(uint32_t i = indexCount - 1; i > 0; --i) {
-        uint16_t index = srcData[i];
-        if(maxIndex < index) {
-            maxIndex = index;
-        }
+    uint32_t minIndex = 0;
+    uint32_t maxIndex = 0;
+    const bool primitiveRestart = GetCurrentContext()->IsPrimitiveRestart();
+
+    // the range of bound buffers is cached until their contents change,
+    // client side indices are scanned directly in client memory
+    if(ibo) {
+        ibo->GetIndexRange(reinterpret_cast<size_t>(indices), indexCount, type, primitiveRestart, &minIndex, &maxIndex);
+    } else {
+        GlIndexRange(indices, indexCount, type, primitiveRestart, &minIndex, &maxIndex);
     }
-    delete[] srcData;
 
     return maxIndex;
 }
@@ -498,87 +916,164 @@ ShaderProgram::PrepareIndexBufferObject(uint32_t* firstIndex, uint32_t* maxIndex
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mActiveIndexVkBuffer = VK_NULL_HANDLE;
-    size_t actualSize = indexCount * (type == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort));
+    mActiveIndexVkType   = GlToVkIndexType(type);
+#ifdef VK_EXT_index_type_uint8
+    if(type == GL_UNSIGNED_BYTE && mVkContext->mIsIndexTypeUint8Supported) {
+        mActiveIndexVkType = VK_INDEX_TYPE_UINT8_EXT;
+    }
+#endif // VK_EXT_index_type_uint8
+    const bool widenIndices = type == GL_UNSIGNED_BYTE && mActiveIndexVkType == VK_INDEX_TYPE_UINT16;
+    size_t indexSize  = type == GL_UNSIGNED_INT ? sizeof(GLuint) : (type == GL_UNSIGNED_SHORT || widenIndices) ? sizeof(GLushort) : sizeof(GLubyte);
+    size_t actualSize = indexCount * indexSize;
     VkDeviceSize offset = 0;
     bool validatedBuffer = true;
 
+    // the closing index of line loops is not part of the source indices
+    assert(GetCurrentContext());
+    const bool lineLoop = GetCurrentContext()->IsModeLineLoop();
+    uint32_t sourceIndexCount = lineLoop ? indexCount - 1 : indexCount;
+    uint32_t sourceMaxIndex   = 0;
+
+    // Fans the device does not draw are drawn as lists of the same index type. The lists of
+    // bound buffers are kept by them until their contents change, client ones are streamed.
+    if(GetCurrentContext()->IsModeTriangleFan()) {
+        const GLenum dstType = widenIndices ? GL_UNSIGNED_SHORT : type;
+        if(ibo) {
+            sourceMaxIndex = GetMaxIndex(ibo, indexCount, type, indices);
+            ibo = ibo->GetTriangleListIndexBuffer(reinterpret_cast<size_t>(indices), indexCount, type, dstType);
+            if(ibo) {
+                *firstIndex = 0;
+                *maxIndex   = sourceMaxIndex;
+                mActiveIndexVkBuffer = ibo->GetVkBuffer();
+                ibo->SetUsed(true);
+            }
+            return;
+        }
+
+        FrameArena::Scope scope(mCacheManager->GetFrameArena());
+        const uint32_t listCount = GlTriangleFanToListCount(indexCount);
+        void *list = mCacheManager->GetFrameArena()->Allocate(listCount * indexSize, sizeof(GLuint));
+        GlTriangleFanToList(indices, indexCount, type, list, dstType);
+
+        sourceMaxIndex = GetMaxIndex(nullptr, indexCount, type, indices);
+        if(StreamIndices(list, listCount, dstType, false, false, &offset, nullptr)) {
+            *firstIndex = offset;
+            *maxIndex   = sourceMaxIndex;
+        }
+        return;
+    }
+
     // Index buffer requires special handling for passing data and handling unsigned bytes:
     // - If there is a index buffer bound, use the indices parameter as offset.
-    // - Otherwise, indices contains the index buffer data. Therefore create a temporary object and store the data there.
-    // If the data format is GL_UNSIGNED_BYTE (not supported by Vulkan), convert the data to uint16 and pass this instead.
-    if(ibo) {
-        offset = reinterpret_cast<VkDeviceSize>(indices);
-
-        if(type == GL_UNSIGNED_BYTE) {
-            assert(indexCount <= ibo->GetSize());
-            uint8_t* srcData = new uint8_t[indexCount];
-            ibo->GetData(indexCount, offset, srcData);
-            offset = 0;
-            validatedBuffer = ConvertIndexBufferToUint16(srcData, indexCount, &ibo);
-            delete[] srcData;
-        }
-    } else {
-        if(type == GL_UNSIGNED_BYTE) {
-            validatedBuffer = ConvertIndexBufferToUint16(indices, indexCount, &ibo);
-        } else {
-            validatedBuffer = AllocateExplicitIndexBuffer(indices, actualSize, &ibo);
+    // - Otherwise, indices contains the index buffer data, which is streamed through the vertex ring.
+    // If the data format is GL_UNSIGNED_BYTE and the device cannot consume uint8 indices, convert the data to uint16 and pass this instead.
+    if(!ibo) {
+        if(StreamIndices(indices, sourceIndexCount, type, widenIndices, lineLoop, &offset, &sourceMaxIndex)) {
+            *firstIndex = offset;
+            *maxIndex   = sourceMaxIndex;
         }
+        return;
     }
 
-    assert(GetCurrentContext());
-    if(GetCurrentContext()->IsModeLineLoop()) {
-        size_t sizeOne = type == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
-        uint8_t* srcData = new uint8_t[indexCount * sizeOne];
+    sourceMaxIndex = GetMaxIndex(ibo, sourceIndexCount, type, indices);
+    offset = reinterpret_cast<VkDeviceSize>(indices);
 
-        ibo->GetData(actualSize - sizeOne, offset, srcData);
-        LineLoopConversion(srcData, indexCount, sizeOne);
+    // the converted copy is kept by the source buffer until its contents change
+    if(widenIndices) {
+        assert(offset + indexCount <= ibo->GetSize());
+        ibo = ibo->GetUint16IndexBuffer(offset, indexCount, GetCurrentContext()->IsPrimitiveRestart());
+        offset = 0;
+        validatedBuffer = ibo != nullptr;
+    }
 
-        validatedBuffer = AllocateExplicitIndexBuffer(srcData, actualSize, &ibo);
-        delete[] srcData;
+    // the indices of a loop are read back and streamed with their closing one, like client indices
+    if(validatedBuffer && lineLoop) {
+        FrameArena::Scope scope(mCacheManager->GetFrameArena());
+        uint8_t* srcData = mCacheManager->GetFrameArena()->Allocate<uint8_t>(actualSize);
+        validatedBuffer = ibo->GetData(actualSize - indexSize, offset, srcData);
+        if(validatedBuffer) {
+            LineLoopConversion(srcData, indexCount, indexSize);
+            validatedBuffer = StreamIndices(srcData, indexCount, widenIndices ? GL_UNSIGNED_SHORT : type, false, false, &offset, nullptr);
+        }
+        if(validatedBuffer) {
+            *firstIndex = offset;
+            *maxIndex   = sourceMaxIndex;
+        }
+        return;
     }
 
     if(validatedBuffer) {
         *firstIndex = offset;
-        *maxIndex = GetMaxIndex(ibo, indexCount, actualSize, offset);
+        *maxIndex = sourceMaxIndex;
         mActiveIndexVkBuffer = ibo->GetVkBuffer();
+        ibo->SetUsed(true);
     }
 }
 
 bool
-ShaderProgram::PrepareVertexAttribBufferObjects(size_t vertCount, uint32_t firstVertex,
-                                                std::vector<GenericVertexAttribute>& genericVertAttribs,
-                                                bool updatedVertexAttrib)
+ShaderProgram::PrepareVertexAttribBufferObjects(size_t vertCount, uint32_t firstVertex, uint32_t instanceCount,
+                                                VertexArray *vertexArray, bool updatedVertexAttrib)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    // store the location-binding associations for faster lookup
-    std::map<uint32_t, uint32_t> vboLocationBindings;
-
-    if(UpdateVertexAttribProperties(vertCount, firstVertex, genericVertAttribs, vboLocationBindings, updatedVertexAttrib)) {
-        GenerateVertexInputProperties(genericVertAttribs, vboLocationBindings);
-        return true;
+    // the layout built from the same attribute state is still the one of the pipeline,
+    // so that only the buffers of its bindings are looked up again
+    if(mVertexInputLayoutSerial == vertexArray->GetLayoutSerial()) {
+        UpdateVertexAttribBuffers(vertCount, firstVertex, instanceCount, vertexArray);
+        return false;
     }
-    return false;
+
+    return UpdateVertexAttribProperties(vertCount, firstVertex, instanceCount, vertexArray, updatedVertexAttrib);
 }
 
 bool
-ShaderProgram::UpdateVertexAttribProperties(size_t vertCount, uint32_t firstVertex,
-                                              std::vector<GenericVertexAttribute>& genericVertAttribs,
-                                              std::map<uint32_t, uint32_t>& vboLocationBindings, bool updatedVertexAttrib)
+ShaderProgram::UpdateVertexAttribBuffers(size_t vertCount, uint32_t firstVertex, uint32_t instanceCount, VertexArray *vertexArray)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    assert(GetCurrentContext());
-    if(GetCurrentContext()->IsModeLineLoop()) {
-        --vertCount;
+    // every binding is bound at the offset of its first attribute, which is at 0 within it
+    for(uint32_t i = 0; i < mVkPipelineVertexInput.vertexAttributeDescriptionCount; ++i) {
+        const VkVertexInputAttributeDescription &attribute = mVkVertexInputAttribute[i];
+
+        GenericVertexAttribute& gva = vertexArray->GetAttribute(attribute.location);
+        VkBuffer bo             = VK_NULL_HANDLE;
+        VkDeviceSize bindOffset = 0;
+        if(!gva.UpdateVertexAttribute(firstVertex, static_cast<uint32_t>(vertCount), instanceCount, &bo, &bindOffset)) {
+            return false;
+        }
+
+        if(!attribute.offset) {
+            mActiveVertexVkBuffers[attribute.binding]       = bo;
+            mActiveVertexVkBufferOffsets[attribute.binding] = bindOffset;
+        }
     }
 
-    // store attribute locations containing the same VkBuffer and stride
-    // as they are directly associated with vertex input bindings
-    typedef std::pair<VkBuffer, int32_t> BUFFER_STRIDE_PAIR;
-    std::map<BUFFER_STRIDE_PAIR, std::vector<uint32_t>> unique_buffer_stride_map;
+    return true;
+}
+
+bool
+ShaderProgram::UpdateVertexAttribProperties(size_t vertCount, uint32_t firstVertex, uint32_t instanceCount,
+                                              VertexArray *vertexArray, bool updatedVertexAttrib)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // The vertex input layout (formats, strides, offsets and the bindings they are sourced from)
+    // is kept apart from the concrete VkBuffers and binding offsets, which are rebound with
+    // every draw. Only a change of the layout itself requires a pipeline update.
+    VkVertexInputBindingDescription   bindings[GLOVE_MAX_VERTEX_ATTRIBS];
+    VkVertexInputAttributeDescription attributes[GLOVE_MAX_VERTEX_ATTRIBS];
+    const BufferObject               *bindingSources[GLOVE_MAX_VERTEX_ATTRIBS];
+    bool                              locationUsed[GLOVE_MAX_VERTEX_ATTRIBS] = { false };
+    uint32_t                          bindingCount   = 0;
+    uint32_t                          attributeCount = 0;
+    bool                              dynamicStride  = false;
+#ifdef VK_EXT_extended_dynamic_state
+    dynamicStride = mVkContext->mIsExtendedDynamicStateSupported;
+#endif // VK_EXT_extended_dynamic_state
+
+    memset(static_cast<void *>(bindings), 0, sizeof(bindings));
+    memset(static_cast<void *>(attributes), 0, sizeof(attributes));
 
-    std::vector<uint32_t> locationUsed;
     for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveAttributes(); ++i) {
         const uint32_t attributelocation  = mShaderResourceInterface.GetAttributeLocation(i);
         const uint32_t occupiedLocations = OccupiedLocationsPerGlType(mShaderResourceInterface.GetAttributeType(i));
@@ -587,147 +1082,209 @@ ShaderProgram::UpdateVertexAttribProperties(size_t vertCount, uint32_t firstVert
             const uint32_t location = attributelocation + j;
 
             // if location is currently used then ommit it
-            if (std::find(locationUsed.begin(), locationUsed.end(), location) != locationUsed.end()) {
+            if(locationUsed[location]) {
                 continue;
             }
+            locationUsed[location] = true;
 
-            GenericVertexAttribute& gva = genericVertAttribs[location];
-            bool updatedVBO   = false;
-            BufferObject *vbo = gva.UpdateVertexAttribute(static_cast<uint32_t>(firstVertex + vertCount), updatedVBO);
-            if(updatedVBO) {
-                updatedVertexAttrib = true;
+            GenericVertexAttribute& gva = vertexArray->GetAttribute(location);
+            VkBuffer bo             = VK_NULL_HANDLE;
+            VkDeviceSize bindOffset = 0;
+            if(!gva.UpdateVertexAttribute(firstVertex, static_cast<uint32_t>(vertCount), instanceCount, &bo, &bindOffset)) {
+                return false;
             }
-            VkBuffer bo       = vbo->GetVkBuffer();
-
-            // If the primitives are rendered with GL_LINE_LOOP, which is not
-            // supported in Vulkan, we have to modify the vbo and add the first vertex at the end.
-            if(GetCurrentContext()->IsModeLineLoop() && !mActiveIndexVkBuffer) {
-                BufferObject* vboLineLoopUpdated = new VertexBufferObject(mVkContext);
-
-                size_t sizeOld = vbo->GetSize();
-                size_t sizeOne = gva.GetStride();
-                size_t sizeNew = sizeOld + sizeOne;
 
-                uint8_t *dataNew = new uint8_t[sizeNew];
-
-                vbo->GetData(sizeOld, 0, dataNew);
-                memcpy(dataNew + sizeOld, dataNew, sizeOne);
-                vboLineLoopUpdated->Allocate(sizeNew, dataNew);
+            // Attributes of the same GL buffer and stride that start within the same vertex share a
+            // binding, bound at the offset of its first attribute, so that only their offsets relative
+            // to it remain in the layout, e.g., meshes interleaved in one VBO at different offsets.
+            // Streamed client arrays and constant values always get a binding of their own, and so do
+            // instanced arrays expanded to one element per instance. Converted attributes are read
+            // tightly packed from copies of their own.
+            const uint32_t stride          = gva.GetVkStride();
+            const bool instanced           = gva.IsEnabled() && gva.GetDivisor();
+            const VkVertexInputRate rate   = instanced ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX;
+            const BufferObject *source     = gva.IsEnabled() && gva.GetDivisor() <= 1 ? gva.GetExternalVbo() : nullptr;
+            uint32_t binding = bindingCount;
+            for(uint32_t b = 0; source && b < bindingCount; ++b) {
+                if(bindingSources[b] == source && bindings[b].inputRate == rate &&
+                   mActiveVertexVkBufferStrides[b] == stride && mActiveVertexVkBuffers[b] == bo &&
+                   bindOffset >= mActiveVertexVkBufferOffsets[b] && bindOffset < mActiveVertexVkBufferOffsets[b] + stride) {
+                    binding = b;
+                    break;
+                }
+            }
 
-                delete[] dataNew;
-                bo          = vboLineLoopUpdated->GetVkBuffer();
-                mCacheManager->CacheVBO(vboLineLoopUpdated);
-                updatedVertexAttrib = true;
+            if(binding == bindingCount) {
+                bindings[binding].binding   = binding;
+                bindings[binding].stride    = dynamicStride ? 0 : stride;
+                bindings[binding].inputRate = rate;
+                bindingSources[binding]     = source;
+                mActiveVertexVkBuffers[binding]       = bo;
+                mActiveVertexVkBufferOffsets[binding] = bindOffset;
+                mActiveVertexVkBufferStrides[binding] = stride;
+                ++bindingCount;
             }
 
-            // store each location
-            int32_t stride      = gva.GetStride();
-            BUFFER_STRIDE_PAIR p = {bo, stride};
-            unique_buffer_stride_map[p].push_back(location);
-            locationUsed.push_back(location);
+            attributes[attributeCount].location = location;
+            attributes[attributeCount].binding  = binding;
+            attributes[attributeCount].format   = gva.GetVkFormat();
+            attributes[attributeCount].offset   = static_cast<uint32_t>(bindOffset - mActiveVertexVkBufferOffsets[binding]);
+            ++attributeCount;
         }
     }
+    mActiveVertexVkBuffersCount = bindingCount;
+    mVertexInputLayoutSerial    = vertexArray->GetLayoutSerial();
 
-    if(!updatedVertexAttrib) {
+    // strides set with the vertex buffers are not part of the layout
+    if(!updatedVertexAttrib &&
+       bindingCount   == mVkPipelineVertexInput.vertexBindingDescriptionCount   &&
+       attributeCount == mVkPipelineVertexInput.vertexAttributeDescriptionCount &&
+       !memcmp(bindings, mVkVertexInputBinding, bindingCount * sizeof(VkVertexInputBindingDescription)) &&
+       !memcmp(attributes, mVkVertexInputAttribute, attributeCount * sizeof(VkVertexInputAttributeDescription))) {
         return false;
     }
 
-    memset(mActiveVertexVkBuffers, VK_NULL_HANDLE, sizeof(VkBuffer) * mActiveVertexVkBuffersCount);
-    mActiveVertexVkBuffersCount = 0;
+    memcpy(mVkVertexInputBinding, bindings, bindingCount * sizeof(VkVertexInputBindingDescription));
+    memcpy(mVkVertexInputAttribute, attributes, attributeCount * sizeof(VkVertexInputAttributeDescription));
+    mVkPipelineVertexInput.vertexBindingDescriptionCount   = bindingCount;
+    mVkPipelineVertexInput.vertexAttributeDescriptionCount = attributeCount;
 
-    // generate unique bindings for each VKbuffer/stride pair
-    uint32_t current_binding = 0;
-    for(const auto& iter : unique_buffer_stride_map) {
-        VkBuffer bo = iter.first.first;
-        for(const auto& loc_str_iter : iter.second) {
-            vboLocationBindings[loc_str_iter] = current_binding;
-        }
-        mActiveVertexVkBuffers[current_binding] = bo;
-        ++current_binding;
-    }
-    mActiveVertexVkBuffersCount = current_binding;
     return true;
 }
 
-void
-ShaderProgram::GenerateVertexInputProperties(std::vector<GenericVertexAttribute>& genericVertAttribs, const std::map<uint32_t, uint32_t>& vboLocationBindings)
+uint64_t
+ShaderProgram::HashBinary(const uint8_t *data, size_t size)
 {
-    // create vertex input bindings and attributes
-    uint32_t count = 0;
-    std::vector<uint32_t> locationUsed;
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveAttributes(); ++i) {
-        const uint32_t attributelocation  = mShaderResourceInterface.GetAttributeLocation(i);
-        const uint32_t occupiedLocations = OccupiedLocationsPerGlType(mShaderResourceInterface.GetAttributeType(i));
+    // FNV-1a, a word at a time as the sections are mostly word sized
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t   i    = 0;
+    for(; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, data + i, sizeof(uint32_t));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    for(; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
 
-        for(uint32_t j = 0; j < occupiedLocations; ++j) {
-            const uint32_t location = attributelocation + j;
-            const uint32_t binding  = vboLocationBindings.at(location);
+    return hash;
+}
 
-            // if location is currently used then ommit it
-            if (std::find(locationUsed.begin(), locationUsed.end(), location) != locationUsed.end()) {
-                continue;
-            }
+uint32_t
+ShaderProgram::GetBinaryVersion(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-            GenericVertexAttribute& gva = genericVertAttribs[location];
-            mVkVertexInputBinding[binding].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-            mVkVertexInputBinding[binding].binding   = binding;
-            mVkVertexInputBinding[binding].stride    = static_cast<uint32_t>(gva.GetStride());
+    /// the reflection and SPIR-V of the samplers differ with the bindless texture table, which is chosen per device
+    return mVkContext->mUseBindlessTextures ? GLOVE_PROGRAM_BINARY_VERSION | GLOVE_PROGRAM_BINARY_BINDLESS : GLOVE_PROGRAM_BINARY_VERSION;
+}
 
-            mVkVertexInputAttribute[count].binding  = binding;
-            mVkVertexInputAttribute[count].location = location;
-            mVkVertexInputAttribute[count].format   = gva.GetVkFormat();
-            mVkVertexInputAttribute[count].offset   = gva.GetOffset();
+bool
+ShaderProgram::ValidateBinary(const void *binary, size_t binarySize) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-            ++count;
+    BinaryHeader_t header;
+    if(!binary || binarySize < sizeof(BinaryHeader_t)) {
+        return false;
+    }
+    memcpy(&header, binary, sizeof(BinaryHeader_t));
 
-            locationUsed.push_back(location);
+    const uint8_t *payload     = reinterpret_cast<const uint8_t *>(binary) + sizeof(BinaryHeader_t);
+    const size_t   payloadSize = binarySize - sizeof(BinaryHeader_t);
+    if(header.magic != GLOVE_PROGRAM_BINARY_MAGIC || header.version != GetBinaryVersion() ||
+       header.reflectionSize != mShaderCompiler->GetShaderReflection()->GetReflectionSize() ||
+       static_cast<uint64_t>(header.reflectionSize) + header.spirvSize + header.pipelineCacheSize != payloadSize ||
+       HashBinary(payload, payloadSize) != header.hash) {
+        return false;
+    }
+
+    /// the SPIR-V of each stage is prefixed with its size, which must add up to the section
+    const uint8_t *spirv  = payload + header.reflectionSize;
+    size_t         offset = 0;
+    for(uint32_t i = 0; i < MAX_SHADERS; ++i) {
+        uint32_t spirvSize;
+        if(offset + sizeof(uint32_t) > header.spirvSize) {
+            return false;
+        }
+        memcpy(&spirvSize, spirv + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if(!spirvSize || spirvSize % sizeof(uint32_t) || offset + spirvSize > header.spirvSize) {
+            return false;
         }
+        offset += spirvSize;
     }
 
-    mVkPipelineVertexInput.vertexBindingDescriptionCount   = mActiveVertexVkBuffersCount;
-    mVkPipelineVertexInput.vertexAttributeDescriptionCount = count;
+    return offset == header.spirvSize;
 }
 
-void
+bool
 ShaderProgram::UsePrecompiledBinary(const void *binary, size_t binarySize)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mLinked = true;
+    // a binary the implementation does not accept leaves the program unlinked, without an error
+    mLinked    = ValidateBinary(binary, binarySize);
+    mIsCompute = false;
+    mLinkedTransformFeedbackVaryings.clear();
+    if(!mLinked) {
+        mInfoLog = "Program binary is invalid or was saved by a different build\n";
+        return false;
+    }
 
     ResetVulkanVertexInput();
 
-    uint32_t reflectionOffset = mShaderCompiler->DeserializeReflection(binary);
-    uint32_t spirvOffset = DeserializeShadersSpirv(reinterpret_cast<const uint8_t *>(binary) + reflectionOffset);
-    const uint8_t *vulkanDataPtr = reinterpret_cast<const uint8_t *>(binary) + reflectionOffset + spirvOffset;
+    BinaryHeader_t header;
+    memcpy(&header, binary, sizeof(BinaryHeader_t));
+
+    /// restoring only reads the reflection back, glslang is never involved
+    const uint8_t *reflectionDataPtr = reinterpret_cast<const uint8_t *>(binary) + sizeof(BinaryHeader_t);
+    mShaderCompiler->DeserializeReflection(reflectionDataPtr);
+    DeserializeShadersSpirv(reflectionDataPtr + header.reflectionSize);
+    const uint8_t *vulkanDataPtr = reflectionDataPtr + header.reflectionSize + header.spirvSize;
 
     BuildShaderResourceInterface();
 
-    mPipelineCache->Create(vulkanDataPtr, binarySize - reflectionOffset);
+    mPipelineCache->Create(vulkanDataPtr, header.pipelineCacheSize);
+    mPipelineCache->MergeInto(mVkContext->vkPipelineCache);
 
+    mInfoLog.clear();
     mIsPrecompiled = true;
+
+    return true;
 }
 
 void
-ShaderProgram::GetBinaryData(void *binary, GLsizei *binarySize)
+ShaderProgram::GetBinaryData(void *binary, GLsizei bufSize, GLsizei *binarySize)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint32_t reflectionOffset = mShaderCompiler->SerializeReflection(binary);
+    BinaryHeader_t header;
+    memset(static_cast<void *>(&header), 0, sizeof(header));
+    header.magic   = GLOVE_PROGRAM_BINARY_MAGIC;
+    header.version = GetBinaryVersion();
 
-    uint8_t *spirvDataPtr = reinterpret_cast<uint8_t *>(binary) + reflectionOffset;
-    uint32_t spirvOffset = SerializeShadersSpirv(spirvDataPtr);
+    uint8_t *reflectionDataPtr = reinterpret_cast<uint8_t *>(binary) + sizeof(BinaryHeader_t);
+    header.reflectionSize = mShaderCompiler->SerializeReflection(reflectionDataPtr);
 
-    uint8_t *vulkanDataPtr = reinterpret_cast<uint8_t *>(binary) + reflectionOffset + spirvOffset;
-    size_t vulkanDataSize = *binarySize;
+    uint8_t *spirvDataPtr = reflectionDataPtr + header.reflectionSize;
+    header.spirvSize = SerializeShadersSpirv(spirvDataPtr);
 
-    if(mPipelineCache->GetPipelineCache() != VK_NULL_HANDLE) {
-        mPipelineCache->GetData(reinterpret_cast<void *>(vulkanDataPtr), &vulkanDataSize);
-        *binarySize = vulkanDataSize + reflectionOffset + spirvOffset;
-    } else {
-        *binarySize = 0;
+    /// the pipeline cache may have grown since its length was queried, so it gets the space that is left at most
+    uint8_t *vulkanDataPtr  = spirvDataPtr + header.spirvSize;
+    size_t   vulkanDataSize = bufSize - (sizeof(BinaryHeader_t) + header.reflectionSize + header.spirvSize);
+    if(!GetVkPipelineCacheData(reinterpret_cast<void *>(vulkanDataPtr), &vulkanDataSize)) {
+        vulkanDataSize = 0;
     }
+    header.pipelineCacheSize = static_cast<uint32_t>(vulkanDataSize);
+
+    const size_t payloadSize = header.reflectionSize + header.spirvSize + header.pipelineCacheSize;
+    header.hash = HashBinary(reflectionDataPtr, payloadSize);
+    memcpy(binary, &header, sizeof(BinaryHeader_t));
+
+    *binarySize = static_cast<GLsizei>(sizeof(BinaryHeader_t) + payloadSize);
 }
 
 GLsizei
@@ -735,14 +1292,19 @@ ShaderProgram::GetBinaryLength(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // compute programs and those capturing outputs are always linked from their source
+    if(IsCompute() || HasTransformFeedback()) {
+        return 0;
+    }
+
     size_t vkPipelineCacheDataLength = 0;
     uint32_t spirvSize = 2 * sizeof(uint32_t) + 4 * (mShaderSPVsize[0] + mShaderSPVsize[1]);
 
-    if(mPipelineCache->GetPipelineCache() != VK_NULL_HANDLE) {
-        mPipelineCache->GetData(nullptr, &vkPipelineCacheDataLength);
+    if(!GetVkPipelineCacheData(nullptr, &vkPipelineCacheDataLength)) {
+        vkPipelineCacheDataLength = 0;
     }
 
-    return vkPipelineCacheDataLength + mShaderResourceInterface.GetReflectionSize() + spirvSize;
+    return sizeof(BinaryHeader_t) + vkPipelineCacheDataLength + mShaderResourceInterface.GetReflectionSize() + spirvSize;
 }
 
 char *
@@ -750,15 +1312,8 @@ ShaderProgram::GetInfoLog(void) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    char *log = nullptr;
-
-    if(mShaderCompiler) {
-        uint32_t len = strlen(mShaderCompiler->GetProgramInfoLog(ESSL_VERSION_100)) + 1;
-        log = new char[len];
-
-        memcpy(log, mShaderCompiler->GetProgramInfoLog(ESSL_VERSION_100), len);
-        log[len - 1] = '\0';
-    }
+    char *log = new char[mInfoLog.size() + 1];
+    memcpy(log, mInfoLog.c_str(), mInfoLog.size() + 1);
 
     return log;
 }
@@ -777,7 +1332,14 @@ ShaderProgram::SetUniformData(uint32_t location, size_t size, const void *ptr)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mShaderResourceInterface.SetUniformClientData(location, size, ptr);
-    mUpdateDescriptorData = true;
+}
+
+void
+ShaderProgram::SetUniformColumns(uint32_t location, uint32_t count, uint32_t columns, uint32_t rows, bool transpose, const float *ptr)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mShaderResourceInterface.SetUniformClientColumns(location, count, columns, rows, transpose, ptr);
 }
 
 void
@@ -794,6 +1356,13 @@ ShaderProgram::SetCacheManager(CacheManager *cacheManager)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // a program of a share group draws with the rings of the context it is used in,
+    // so a set allocated from the pools of another context is not reused
+    if(mCacheManager != cacheManager) {
+        mDescriptorPoolSerial = 0;
+        mUpdateDescriptorSets = true;
+    }
+
     mCacheManager = cacheManager;
     mShaderResourceInterface.SetCacheManager(cacheManager);
 }
@@ -803,41 +1372,104 @@ ShaderProgram::ReleaseVkObjects(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkPipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(mVkContext->vkDevice, mVkPipelineLayout, nullptr);
-        mVkPipelineLayout = VK_NULL_HANDLE;
-    }
-
-    if(mVkDescSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(mVkContext->vkDevice, mVkDescSetLayout, nullptr);
-        mVkDescSetLayout = VK_NULL_HANDLE;
+    // dispatches in flight may still use the compute pipeline, it goes with the frame
+    if(mVkComputePipeline != VK_NULL_HANDLE) {
+        if(mCacheManager) {
+            mCacheManager->CacheVkPipelineObject(mVkComputePipeline);
+        } else {
+            vkDestroyPipeline(mVkContext->vkDevice, mVkComputePipeline, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        }
+        mVkComputePipeline = VK_NULL_HANDLE;
     }
+    mStorageBlocks.clear();
+    mUniformBufferBlocks.clear();
+    mUniformBufferBindings.clear();
 
-    if(mVkDescSet != VK_NULL_HANDLE) {
-        vkFreeDescriptorSets(mVkContext->vkDevice, mVkDescPool, 1, &mVkDescSet);
-        mVkDescSet = VK_NULL_HANDLE;
+    // the layouts are shared with every program of the same bindings, whose pipelines stay cached
+    if(mVkPipelineLayout != VK_NULL_HANDLE) {
+        if(!mVkContext->pipelineLayoutCache->Release(mVkPipelineLayout) && mCacheManager) {
+            mCacheManager->EvictVkPipelines(mVkPipelineLayout);
+        }
+        mVkPipelineLayout = VK_NULL_HANDLE;
+        mVkDescSetLayout  = VK_NULL_HANDLE;
     }
 
-    if(mVkDescPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(mVkContext->vkDevice, mVkDescPool, nullptr);
-        mVkDescPool = VK_NULL_HANDLE;
+#ifdef VK_KHR_descriptor_update_template
+    if(mVkDescUpdateTemplate != VK_NULL_HANDLE) {
+        mVkContext->fpDestroyDescriptorUpdateTemplateKHR(mVkContext->vkDevice, mVkDescUpdateTemplate, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+        mVkDescUpdateTemplate = VK_NULL_HANDLE;
     }
+#endif // VK_KHR_descriptor_update_template
 
+    // descriptor sets belong to the per frame pools of the cache manager, which reset them
+    mVkDescSet = VK_NULL_HANDLE;
+    mDescriptorPoolSerial = 0;
+    mHasTransientTextures = false;
+    mVkDescriptorWrites.clear();
+    mDescriptorWriteIndices.clear();
+    mDirtyDescriptorWrites.clear();
+    mVkPartialDescriptorWrites.clear();
+    mVkDescriptorCopies.clear();
+    mDescriptorDataOffsets.clear();
+    mDescriptorData.clear();
+    mSamplerUniforms.clear();
+    mSamplerGenerations.clear();
+    mBindlessSamplerUniforms.clear();
+    mBindlessSamplerGenerations.clear();
+    mBindlessTextureIndices.clear();
+    mBindlessTableSerial = 0;
+
+    ReleaseShaderModules();
     for(int32_t i = 0; i < MAX_SHADERS; ++i) {
         mShaderSPVsize[i] = 0;
         mShaderSPVdata[i] = nullptr;
-        mVkShaderModules[i] = VK_NULL_HANDLE;
         mVkShaderStages[i] = VK_SHADER_STAGE_ALL;
     }
+    mShaderSPVhash = 0;
 
     mPipelineCache->Release();
 }
 
+void
+ShaderProgram::ReleaseShaderModules(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(int32_t i = 0; i < MAX_SHADERS; ++i) {
+        if(mVkShaderModules[i] != VK_NULL_HANDLE) {
+            mVkContext->shaderModuleCache->Release(mVkShaderModules[i]);
+            mVkShaderModules[i] = VK_NULL_HANDLE;
+        }
+    }
+}
+
+VkShaderModule
+ShaderProgram::AcquireShaderModule(Shader *shader)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const vector<uint32_t> &spv = shader->GetSPV();
+
+    /// programs producing the same SPIR-V for a stage share its module
+    return mVkContext->shaderModuleCache->Acquire(spv.data(), spv.size());
+}
+
 void
 ShaderProgram::SetShaderModules(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    ReleaseShaderModules();
+
+    if(IsCompute()) {
+        mStageCount         = 1;
+        mVkShaderModules[0] = AcquireShaderModule(GetComputeShader());
+        mShaderSPVsize[0]   = GetComputeShader()->GetSPV().size();
+        mShaderSPVdata[0]   = GetComputeShader()->GetSPV().data();
+        mVkShaderStages[0]  = VK_SHADER_STAGE_COMPUTE_BIT;
+        return;
+    }
+
     mStageCount = HasVertexShader() + HasFragmentShader();
     assert(mStageCount == 0 || mStageCount == 1 || mStageCount == 2);
 
@@ -845,135 +1477,220 @@ ShaderProgram::SetShaderModules(void)
 
         Shader* shader = HasVertexShader() ? GetVertexShader() : GetFragmentShader();
 
-        mVkShaderModules[0] = shader->CreateVkShaderModule();
+        mVkShaderModules[0] = AcquireShaderModule(shader);
         mVkShaderStages[0]  = HasVertexShader() ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
 
     } else if(mStageCount == 2) {
 
         Shader* shader = GetVertexShader();
 
-        mVkShaderModules[0] = shader->CreateVkShaderModule();
+        mVkShaderModules[0] = AcquireShaderModule(shader);
         mShaderSPVsize[0]  = shader->GetSPV().size();
         mShaderSPVdata[0]  = shader->GetSPV().data();
         mVkShaderStages[0] = VK_SHADER_STAGE_VERTEX_BIT;
 
         shader = GetFragmentShader();
 
-        mVkShaderModules[1] = shader->CreateVkShaderModule();
+        mVkShaderModules[1] = AcquireShaderModule(shader);
         mShaderSPVsize[1]  = shader->GetSPV().size();
         mShaderSPVdata[1]  = shader->GetSPV().data();
         mVkShaderStages[1] = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        /// identifies the program across launches in the recorded pipeline states (FNV-1a)
+        mShaderSPVhash = 0xcbf29ce484222325ULL;
+        for(int32_t i = 0; i < MAX_SHADERS; ++i) {
+            for(size_t word = 0; word < mShaderSPVsize[i]; ++word) {
+                mShaderSPVhash = (mShaderSPVhash ^ mShaderSPVdata[i][word]) * 0x100000001b3ULL;
+            }
+        }
     }
 }
 
+uint32_t
+ShaderProgram::WarmUpVkPipelines(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mCacheManager || !mShaderSPVhash) {
+        return 0;
+    }
+
+    return mCacheManager->GetPipelineWarmer()->WarmUp(mShaderSPVhash, mVkPipelineLayout, GetVkPipelineCache(),
+                                                      mShaderSPVdata[0], mShaderSPVsize[0],
+                                                      mShaderSPVdata[1], mShaderSPVsize[1]);
+}
+
+bool
+ShaderProgram::WarmUpVkPipeline(const vulkanAPI::PipelineWarmer::StateRecord_t &record)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mCacheManager) {
+        return false;
+    }
+
+    return mCacheManager->GetPipelineWarmer()->Compile(record, mVkPipelineLayout, GetVkPipelineCache(),
+                                                       mShaderSPVdata[0], mShaderSPVsize[0],
+                                                       mShaderSPVdata[1], mShaderSPVsize[1]);
+}
+
+static VkShaderStageFlags
+ShaderTypeToVkShaderStageFlags(shader_type_t stage)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return stage == (SHADER_TYPE_VERTEX | SHADER_TYPE_FRAGMENT) ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT :
+           stage ==  SHADER_TYPE_VERTEX  ? VK_SHADER_STAGE_VERTEX_BIT  :
+           stage ==  SHADER_TYPE_COMPUTE ? VK_SHADER_STAGE_COMPUTE_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+}
+
+VkDescriptorType
+ShaderProgram::GetUniformBlockDescriptorType(uint32_t block) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return mShaderResourceInterface.IsUniformBlockInputAttachment(block) ? VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT       :
+           mShaderResourceInterface.IsUniformBlockStorageBuffer(block)   ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER         :
+           mShaderResourceInterface.IsUniformBlockUniformBuffer(block)   ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER         :
+           mShaderResourceInterface.IsUniformBlockOpaque(block)          ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER :
+                                                                           VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+}
+
 bool
 ShaderProgram::CreateDescriptorSetLayout(uint32_t nLiveUniformBlocks)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // the push constant block is part of the pipeline layout only, specialization constants of the pipeline
+    uint32_t nBindings = 0;
     if(nLiveUniformBlocks) {
         mVkDescSetLayoutBind = new VkDescriptorSetLayoutBinding[nLiveUniformBlocks];
         assert(mVkDescSetLayoutBind);
 
         for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniformBlocks(); ++i) {
-            mVkDescSetLayoutBind[i].binding = mShaderResourceInterface.GetUniformBlockBinding(i);
-            mVkDescSetLayoutBind[i].descriptorType = mShaderResourceInterface.IsUniformBlockOpaque(i) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            mVkDescSetLayoutBind[i].descriptorCount = 1;
-            mVkDescSetLayoutBind[i].stageFlags = mShaderResourceInterface.GetUniformBlockStage(i) == (SHADER_TYPE_VERTEX | SHADER_TYPE_FRAGMENT) ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT :
-                                                 mShaderResourceInterface.GetUniformBlockStage(i) ==  SHADER_TYPE_VERTEX ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
-            mVkDescSetLayoutBind[i].pImmutableSamplers = nullptr;
-        }
-    }
-
-    VkDescriptorSetLayoutCreateInfo descLayoutInfo;
-    memset(static_cast<void *>(&descLayoutInfo), 0, sizeof(descLayoutInfo));
-    descLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    descLayoutInfo.pNext = nullptr;
-    descLayoutInfo.flags = 0;
-    descLayoutInfo.bindingCount = nLiveUniformBlocks;
-    descLayoutInfo.pBindings = mVkDescSetLayoutBind;
+            if(!mShaderResourceInterface.IsUniformBlockDescriptor(i)) {
+                continue;
+            }
 
-    if(vkCreateDescriptorSetLayout(mVkContext->vkDevice, &descLayoutInfo, 0, &mVkDescSetLayout) != VK_SUCCESS) {
-        assert(0);
-        return false;
+            mVkDescSetLayoutBind[nBindings].binding = mShaderResourceInterface.GetUniformBlockBinding(i);
+            mVkDescSetLayoutBind[nBindings].descriptorType = GetUniformBlockDescriptorType(i);
+            mVkDescSetLayoutBind[nBindings].descriptorCount = 1;
+            mVkDescSetLayoutBind[nBindings].stageFlags = ShaderTypeToVkShaderStageFlags(mShaderResourceInterface.GetUniformBlockStage(i));
+            mVkDescSetLayoutBind[nBindings].pImmutableSamplers = nullptr;
+            ++nBindings;
+        }
     }
-    assert(mVkDescSetLayout != VK_NULL_HANDLE);
 
-    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
-    memset(static_cast<void *>(&pipelineLayoutCreateInfo), 0, sizeof(pipelineLayoutCreateInfo));
-    pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutCreateInfo.pNext                  = nullptr;
-    pipelineLayoutCreateInfo.flags                  = 0;
-    pipelineLayoutCreateInfo.setLayoutCount         = 1;
-    pipelineLayoutCreateInfo.pSetLayouts            = &mVkDescSetLayout;
-    pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-    pipelineLayoutCreateInfo.pPushConstantRanges    = nullptr;
+    // programs with the same bindings get the same, hence compatible, layouts
+    const bool created = mVkContext->pipelineLayoutCache->Acquire(mVkDescSetLayoutBind, nBindings,
+                                                                  HasPushConstants() ? &mVkPushConstantRange : nullptr,
+                                                                  UsesBindlessTextures() ? mVkContext->vkBindlessDescSetLayout : VK_NULL_HANDLE,
+                                                                  &mVkDescSetLayout, &mVkPipelineLayout);
 
-    if(vkCreatePipelineLayout(mVkContext->vkDevice, &pipelineLayoutCreateInfo, 0, &mVkPipelineLayout) != VK_SUCCESS) {
-        assert(0);
-        return false;
-    }
-    
     if(nLiveUniformBlocks) {
         delete[] mVkDescSetLayoutBind;
         mVkDescSetLayoutBind = nullptr;
     }
 
-    return true;
+    return created;
 }
 
 bool
-ShaderProgram::CreateDescriptorPool(uint32_t nLiveUniformBlocks)
+ShaderProgram::CreateDescriptorUpdates(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkDescriptorPoolSize *descTypeCounts = new VkDescriptorPoolSize[nLiveUniformBlocks];
-    assert(descTypeCounts);
-    memset(static_cast<void *>(descTypeCounts), 0, nLiveUniformBlocks * sizeof(*descTypeCounts));
+    const uint32_t nLiveUniformBlocks = mShaderResourceInterface.GetLiveUniformBlocks();
 
-    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniformBlocks(); ++i) {
-        descTypeCounts[i].descriptorCount = 1;
-        descTypeCounts[i].type = mShaderResourceInterface.IsUniformBlockOpaque(i) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    /// Samplers are bound as arrays of image descriptors, one per element of the sampler uniform
+    std::vector<uint32_t> descriptorCounts(nLiveUniformBlocks, 1);
+    size_t nSamplers = 0;
+    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniforms(); ++i) {
+        if(IsGlSampler(mShaderResourceInterface.GetUniformType(i)) &&
+           !mShaderResourceInterface.IsUniformBlockBindless(mShaderResourceInterface.GetUniformBlockIndex(i))) {
+            descriptorCounts[mShaderResourceInterface.GetUniformBlockIndex(i)] = mShaderResourceInterface.GetUniformArraySize(i);
+            mSamplerUniforms.push_back(i);
+            nSamplers += mShaderResourceInterface.GetUniformArraySize(i);
+        }
     }
+    mSamplerGenerations.assign(nSamplers, 0);
 
-    VkDescriptorPoolCreateInfo descriptorPoolInfo;
-    memset(static_cast<void *>(&descriptorPoolInfo), 0, sizeof(descriptorPoolInfo));
-    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = nLiveUniformBlocks;
-    descriptorPoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-    descriptorPoolInfo.maxSets = 1;
-    descriptorPoolInfo.pPoolSizes = descTypeCounts;
+    size_t dataSize = 0;
+    mDescriptorDataOffsets.assign(nLiveUniformBlocks, GLOVE_INVALID_OFFSET);
+    for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
+        if(!mShaderResourceInterface.IsUniformBlockDescriptor(i)) {
+            continue;
+        }
 
-    if(vkCreateDescriptorPool(mVkContext->vkDevice, &descriptorPoolInfo, 0, &mVkDescPool) != VK_SUCCESS) {
-        assert(0);
-        return false;
+        mDescriptorDataOffsets[i] = dataSize;
+        dataSize += mShaderResourceInterface.IsUniformBlockOpaque(i) ? descriptorCounts[i] * sizeof(VkDescriptorImageInfo) : sizeof(VkDescriptorBufferInfo);
     }
-    assert(mVkDescPool != VK_NULL_HANDLE);
-
-    delete[] descTypeCounts;
-
-    return true;
-}
+    mDescriptorData.assign(dataSize, 0);
+    mDescriptorWriteIndices.assign(nLiveUniformBlocks, 0);
 
-bool
-ShaderProgram::CreateDescriptorSet(void)
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
-
-    VkDescriptorSetAllocateInfo descAllocInfo;
-    memset(static_cast<void *>(&descAllocInfo), 0, sizeof(descAllocInfo));
-    descAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    descAllocInfo.pNext = nullptr;
-    descAllocInfo.descriptorPool = mVkDescPool;
-    descAllocInfo.descriptorSetCount = 1;
-    descAllocInfo.pSetLayouts = &mVkDescSetLayout;
+    /// The writes point into the blob, which never grows after this point
+#ifdef VK_KHR_descriptor_update_template
+    std::vector<VkDescriptorUpdateTemplateEntryKHR> templateEntries;
+#endif // VK_KHR_descriptor_update_template
+    for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
+        if(!mShaderResourceInterface.IsUniformBlockDescriptor(i)) {
+            continue;
+        }
 
-    if(vkAllocateDescriptorSets(mVkContext->vkDevice, &descAllocInfo, &mVkDescSet) != VK_SUCCESS) {
-        assert(0);
-        return false;
+        const bool opaque = mShaderResourceInterface.IsUniformBlockOpaque(i);
+
+        mDescriptorWriteIndices[i] = static_cast<uint32_t>(mVkDescriptorWrites.size());
+
+        VkWriteDescriptorSet write;
+        memset(static_cast<void *>(&write), 0, sizeof(write));
+        write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.pNext           = nullptr;
+        write.dstSet          = VK_NULL_HANDLE;
+        write.dstBinding      = mShaderResourceInterface.GetUniformBlockBinding(i);
+        write.descriptorCount = opaque ? descriptorCounts[i] : 1;
+        write.descriptorType  = GetUniformBlockDescriptorType(i);
+        write.pImageInfo      = opaque ? reinterpret_cast<const VkDescriptorImageInfo  *>(&mDescriptorData[mDescriptorDataOffsets[i]]) : nullptr;
+        write.pBufferInfo     = opaque ? nullptr : reinterpret_cast<const VkDescriptorBufferInfo *>(&mDescriptorData[mDescriptorDataOffsets[i]]);
+        mVkDescriptorWrites.push_back(write);
+
+#ifdef VK_KHR_descriptor_update_template
+        VkDescriptorUpdateTemplateEntryKHR entry;
+        entry.dstBinding      = write.dstBinding;
+        entry.dstArrayElement = 0;
+        entry.descriptorCount = write.descriptorCount;
+        entry.descriptorType  = write.descriptorType;
+        entry.offset          = mDescriptorDataOffsets[i];
+        entry.stride          = opaque ? sizeof(VkDescriptorImageInfo) : sizeof(VkDescriptorBufferInfo);
+        templateEntries.push_back(entry);
+#endif // VK_KHR_descriptor_update_template
+    }
+
+    /// every write is dirty until the first set has been written
+    mDirtyDescriptorWrites.assign(mVkDescriptorWrites.size(), 1);
+    mVkPartialDescriptorWrites.reserve(mVkDescriptorWrites.size());
+    mVkDescriptorCopies.reserve(mVkDescriptorWrites.size());
+
+#ifdef VK_KHR_descriptor_update_template
+    if(mVkContext->mIsDescriptorUpdateTemplateSupported && !templateEntries.empty()) {
+        VkDescriptorUpdateTemplateCreateInfoKHR templateInfo;
+        memset(static_cast<void *>(&templateInfo), 0, sizeof(templateInfo));
+        templateInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+        templateInfo.pNext                      = nullptr;
+        templateInfo.flags                      = 0;
+        templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size());
+        templateInfo.pDescriptorUpdateEntries   = templateEntries.data();
+        templateInfo.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+        templateInfo.descriptorSetLayout        = mVkDescSetLayout;
+        templateInfo.pipelineBindPoint          = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        templateInfo.pipelineLayout             = mVkPipelineLayout;
+        templateInfo.set                        = 0;
+
+        // without a template the prebuilt writes are used instead
+        if(mVkContext->fpCreateDescriptorUpdateTemplateKHR(mVkContext->vkDevice, &templateInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &mVkDescUpdateTemplate) != VK_SUCCESS) {
+            mVkDescUpdateTemplate = VK_NULL_HANDLE;
+        }
     }
-    assert(mVkDescSet != VK_NULL_HANDLE);
+#endif // VK_KHR_descriptor_update_template
 
     return true;
 }
@@ -987,21 +1704,95 @@ ShaderProgram::AllocateVkDescriptoSet(void)
 
     ReleaseVkObjects();
 
-    if(!CreateDescriptorSetLayout(nLiveUniformBlocks)) {
-        assert(0);
-        return false;
+    // dynamic offsets are consumed in increasing binding order
+    mDynamicOffsetBlocks.clear();
+    for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
+        if(mShaderResourceInterface.IsUniformBlockStorageBuffer(i)) {
+            mStorageBlocks.push_back(i);
+        } else if(mShaderResourceInterface.IsUniformBlockUniformBuffer(i)) {
+            // each block reads the binding of its layout qualifier until glUniformBlockBinding gives it another
+            mUniformBufferBlocks.push_back(i);
+            mUniformBufferBindings.push_back(mShaderResourceInterface.GetUniformBlockBinding(i) - GLOVE_UNIFORM_BUFFER_FIRST_VK_BINDING);
+        } else if(!mShaderResourceInterface.IsUniformBlockOpaque(i) && mShaderResourceInterface.IsUniformBlockDescriptor(i)) {
+            mDynamicOffsetBlocks.push_back(i);
+        }
     }
+    std::sort(mDynamicOffsetBlocks.begin(), mDynamicOffsetBlocks.end(), [this](uint32_t a, uint32_t b) {
+        return mShaderResourceInterface.GetUniformBlockBinding(a) < mShaderResourceInterface.GetUniformBlockBinding(b);
+    });
+    mVkDynamicOffsets.assign(mDynamicOffsetBlocks.size(), 0);
+    mUniformRingGeneration = 0;
 
-    if(!nLiveUniformBlocks) {
-        return true;
+    memset(static_cast<void *>(&mVkPushConstantRange), 0, sizeof(mVkPushConstantRange));
+    const uint32_t pushConstantBlock = mShaderResourceInterface.GetPushConstantBlock();
+    if(pushConstantBlock != GLOVE_INVALID_OFFSET) {
+        mVkPushConstantRange.stageFlags = ShaderTypeToVkShaderStageFlags(mShaderResourceInterface.GetUniformBlockStage(pushConstantBlock));
+        mVkPushConstantRange.offset     = 0;
+        mVkPushConstantRange.size       = static_cast<uint32_t>(mShaderResourceInterface.GetUniformBlockSize(pushConstantBlock));
+        assert(mVkPushConstantRange.size && mVkPushConstantRange.size <= GLOVE_MAX_PUSH_CONSTANTS_SIZE);
     }
 
-    if(!CreateDescriptorPool(nLiveUniformBlocks)) {
+    // samplers read from the bindless texture table take the push constants for their indices into it
+    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniforms(); ++i) {
+        const int32_t block = mShaderResourceInterface.GetUniformBlockIndex(i);
+        if(block >= 0 && mShaderResourceInterface.IsUniformBlockBindless(block)) {
+            mBindlessSamplerUniforms.push_back(i);
+            mVkPushConstantRange.stageFlags |= ShaderTypeToVkShaderStageFlags(mShaderResourceInterface.GetUniformBlockStage(block));
+        }
+    }
+    if(UsesBindlessTextures()) {
+        assert(pushConstantBlock == GLOVE_INVALID_OFFSET);
+        std::sort(mBindlessSamplerUniforms.begin(), mBindlessSamplerUniforms.end(), [this](uint32_t a, uint32_t b) {
+            return mShaderResourceInterface.GetUniformBlockBinding(mShaderResourceInterface.GetUniformBlockIndex(a)) <
+                   mShaderResourceInterface.GetUniformBlockBinding(mShaderResourceInterface.GetUniformBlockIndex(b));
+        });
+        mBindlessSamplerGenerations.assign(mBindlessSamplerUniforms.size(), 0);
+        mBindlessTextureIndices.assign(mBindlessSamplerUniforms.size(), 0);
+        mVkPushConstantRange.offset = 0;
+        mVkPushConstantRange.size   = static_cast<uint32_t>(mBindlessTextureIndices.size() * sizeof(uint32_t));
+        assert(mVkPushConstantRange.size <= GLOVE_MAX_PUSH_CONSTANTS_SIZE);
+    }
+
+    // each switch turned into a specialization constant takes a word of the specialization data
+    uint32_t nDescriptorBlocks = 0;
+    mSpecializationBlocks.clear();
+    mVkSpecializationMapEntries.clear();
+    for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
+        if(mShaderResourceInterface.IsUniformBlockDescriptor(i)) {
+            ++nDescriptorBlocks;
+        } else if(mShaderResourceInterface.IsUniformBlockSpecConstant(i)) {
+            VkSpecializationMapEntry entry;
+            entry.constantID = mShaderResourceInterface.GetUniformBlockBinding(i);
+            entry.offset     = static_cast<uint32_t>(mSpecializationBlocks.size() * sizeof(uint32_t));
+            entry.size       = sizeof(uint32_t);
+            mVkSpecializationMapEntries.push_back(entry);
+            mSpecializationBlocks.push_back(i);
+        }
+    }
+    // the rotation of the framebuffer drawn to follows the switches
+    if(GLOVE_USE_PRE_ROTATION && !IsCompute()) {
+        VkSpecializationMapEntry entry;
+        entry.constantID = GLOVE_PRE_ROTATION_CONSTANT_ID;
+        entry.offset     = static_cast<uint32_t>(mSpecializationBlocks.size() * sizeof(uint32_t));
+        entry.size       = sizeof(uint32_t);
+        mVkSpecializationMapEntries.push_back(entry);
+    }
+    mSpecializationData.assign(mVkSpecializationMapEntries.size(), 0);
+    mVkSpecializationInfo.mapEntryCount = static_cast<uint32_t>(mVkSpecializationMapEntries.size());
+    mVkSpecializationInfo.pMapEntries   = mVkSpecializationMapEntries.data();
+    mVkSpecializationInfo.dataSize      = mSpecializationData.size() * sizeof(uint32_t);
+    mVkSpecializationInfo.pData         = mSpecializationData.data();
+
+    if(!CreateDescriptorSetLayout(nLiveUniformBlocks)) {
         assert(0);
         return false;
     }
 
-    if(!CreateDescriptorSet()) {
+    if(!nDescriptorBlocks) {
+        return true;
+    }
+
+    if(!CreateDescriptorUpdates()) {
         assert(0);
         return false;
     }
@@ -1014,25 +1805,56 @@ ShaderProgram::UpdateBuiltInUniformData(float minDepthRange, float maxDepthRange
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mMinDepthRange == minDepthRange && mMaxDepthRange == maxDepthRange) {
+    if(mDepthRangeValid && mMinDepthRange == minDepthRange && mMaxDepthRange == maxDepthRange) {
         return;
     }
 
-    mMinDepthRange = minDepthRange;
-    mMaxDepthRange = maxDepthRange;
+    mMinDepthRange   = minDepthRange;
+    mMaxDepthRange   = maxDepthRange;
+    mDepthRangeValid = true;
+
+    const float depthRange[3] = { mMinDepthRange, mMaxDepthRange, mMaxDepthRange - mMinDepthRange };
+    for(int i = 0; i < 3; ++i) {
+        if(mDepthRangeLocations[i] != -1) {
+            SetUniformData(mDepthRangeLocations[i], sizeof(float), &depthRange[i]);
+        }
+    }
+}
+
+bool
+ShaderProgram::UpdateSpecializationData(uint32_t preRotation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    int location;
-    if((location = GetUniformLocation("gl_DepthRange.near")) != -1) {
-        SetUniformData(location, sizeof(float), &mMinDepthRange);
+    // a different value of a switch selects another pipeline variant
+    bool updated = false;
+    for(size_t i = 0; i < mSpecializationBlocks.size(); ++i) {
+        uint32_t value;
+        memcpy(&value, mShaderResourceInterface.GetUniformBlockClientData(mSpecializationBlocks[i]), sizeof(uint32_t));
+        if(mSpecializationData[i] != value) {
+            mSpecializationData[i] = value;
+            updated = true;
+        }
     }
 
-    if((location = GetUniformLocation("gl_DepthRange.far")) != -1) {
-        SetUniformData(location, sizeof(float), &mMaxDepthRange);
+    // and so does a different rotation
+    if(GLOVE_USE_PRE_ROTATION && mSpecializationData.size() > mSpecializationBlocks.size() &&
+       mSpecializationData.back() != preRotation) {
+        mSpecializationData.back() = preRotation;
+        updated = true;
     }
 
-    if((location = GetUniformLocation("gl_DepthRange.diff")) != -1) {
-        float diffDepthRange = mMaxDepthRange - mMinDepthRange;
-        SetUniformData(location, sizeof(float), &diffDepthRange);
+    return updated;
+}
+
+void
+ShaderProgram::PushConstants(const VkCommandBuffer *cmdBuffer) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(HasPushConstants()) {
+        vkCmdPushConstants(*cmdBuffer, mVkPipelineLayout, mVkPushConstantRange.stageFlags,
+                           mVkPushConstantRange.offset, mVkPushConstantRange.size, GetPushConstantData());
     }
 }
 
@@ -1041,212 +1863,477 @@ ShaderProgram::UpdateDescriptorSet(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    Context *context = GetCurrentContext();
-    assert(context);
-    assert(mVkDescSet);
+    assert(HasUniformData());
     assert(mVkContext);
 
     if(mShaderResourceInterface.GetLiveUniformBlocks() == 0) {
         return;
     }
 
-    /// Transfer any new local uniform data into the buffer objects
-    if(mUpdateDescriptorData) {
-        bool allocatedNewBufferObject = false;
-        mShaderResourceInterface.UpdateUniformBufferData(mVkContext, &allocatedNewBufferObject);
-        if(allocatedNewBufferObject) {
-            mUpdateDescriptorSets = true;
+    /// Write the blocks into fresh space of the uniform ring; only the dynamic offsets change per draw.
+    /// Nothing is done while no uniform has changed since the blocks were written into the current ring
+    vulkanAPI::UniformRing *uniformRing = mCacheManager->GetUniformRing();
+    if(!mDynamicOffsetBlocks.empty() && !mShaderResourceInterface.IsUniformBlockDataWritten(uniformRing)) {
+        if(!mShaderResourceInterface.WriteUniformBlockData(uniformRing)) {
+            assert(0);
+            return;
         }
 
-        mUpdateDescriptorData = false;
-    }
+        for(uint32_t i = 0; i < mDynamicOffsetBlocks.size(); ++i) {
+            mVkDynamicOffsets[i] = mShaderResourceInterface.GetUniformBlockDynamicOffset(mDynamicOffsetBlocks[i]);
+        }
 
-    // Check if any texture is attached to a user-based FBO
-    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniforms(); ++i) {
-        if(mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D || mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_CUBE) {
-            for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
-                const glsl_sampler_t textureUnit = *(glsl_sampler_t *)mShaderResourceInterface.GetUniformClientData(i);
-
-                /// Sampler might need an update
-                Texture *activeTexture = context->GetStateManager()->GetActiveObjectsState()->GetActiveTexture(
-                mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP, textureUnit); // TODO remove mGlContext
-                if(context->GetResourceManager()->IsTextureAttachedToFBO(activeTexture)) {
-                    mUpdateDescriptorSets = true;
-                    break;
-                }
-            }
+        if(mUniformRingGeneration != uniformRing->GetGeneration()) {
+            mUniformRingGeneration = uniformRing->GetGeneration();
+            mUpdateDescriptorSets  = true;
         }
     }
 
-    /// This can be true only in three occasions:
+    /// Marked first, a transient texture that has to discard its contents changes its generation
+    MarkSamplerTexturesUsed();
+
+    if(!mUpdateDescriptorSets && HasSamplerTexturesUpdated()) {
+        mUpdateDescriptorSets = true;
+    }
+
+    /// This can be true only in five occasions, in which the descriptors are gathered again
+    /// and only the bindings whose descriptors differ are written:
     /// 1. This is a freshly linked shader. So the descriptor sets need to be created
     /// 2. There has been an update in a sampler via the glUniform1i()
     /// 3. glBindTexture has been called
-    /// 4. Texture is attached to a user-based FBO
-    if(!mUpdateDescriptorSets) {
-        return;
+    /// 4. A sampled texture has changed, or a framebuffer it is attached to has been rendered to
+    /// 5. The uniform ring has been replaced by a larger buffer
+    /// Samplers of the bindless texture table look their indices up again instead, and a program
+    /// whose only block is the push constant one has no descriptor set to update.
+    if(mUpdateDescriptorSets) {
+        mHasTransientTextures = false;
+        UpdateBindlessTextureIndices();
+        if(HasDescriptorSet()) {
+            UpdateSamplerDescriptors();
+        }
     }
 
-    UpdateSamplerDescriptors();
+    /// The color read back through gl_LastFragData is the one of the framebuffer drawn to, which may
+    /// have been bound, or the presented image switched, without anything else of the program changing
+    if(HasDescriptorSet() && UsesFramebufferFetch() && UpdateInputAttachmentDescriptor()) {
+        mUpdateDescriptorSets = true;
+    }
+
+    /// A set that a submitted command buffer may refer to is never written again; a fresh one
+    /// is allocated when a binding changes, and once per frame as the pools are recycled per frame
+    if(HasDescriptorSet() &&
+       (mVkDescSet == VK_NULL_HANDLE || mUpdateDescriptorSets ||
+        mDescriptorPoolSerial != mCacheManager->GetDescriptorPoolRing()->GetSerial())) {
+        WriteDescriptorSet();
+    }
 
     mUpdateDescriptorSets = false;
 }
 
+bool
+ShaderProgram::HasSamplerTexturesUpdated(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mHasTransientTextures && mDescriptorPoolSerial != mCacheManager->GetDescriptorPoolRing()->GetSerial()) {
+        return true;
+    }
+
+    /// the table may have evicted the slots of the textures that were not sampled during the last frame
+    if(UsesBindlessTextures() && mBindlessTableSerial != mCacheManager->GetBindlessTextureTable()->GetSerial()) {
+        return true;
+    }
+
+    size_t sampler = 0;
+    for(uint32_t i : mSamplerUniforms) {
+        const uint64_t generation = GetSamplerTexture(i)->GetGeneration();
+
+        for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
+            if(mSamplerGenerations[sampler++] != generation) {
+                return true;
+            }
+        }
+    }
+
+    for(size_t i = 0; i < mBindlessSamplerUniforms.size(); ++i) {
+        if(mBindlessSamplerGenerations[i] != GetSamplerTexture(mBindlessSamplerUniforms[i])->GetGeneration()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void
-ShaderProgram::UpdateSamplerDescriptors(void)
+ShaderProgram::MarkSamplerTexturesUsed(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mSamplerUniforms.empty() && mBindlessSamplerUniforms.empty()) {
+        return;
+    }
+
     Context *context = GetCurrentContext();
     assert(context);
 
-    const uint32_t nLiveUniformBlocks = mShaderResourceInterface.GetLiveUniformBlocks();
-    uint32_t nSamplers = 0;
-    for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
-        if(mShaderResourceInterface.IsUniformBlockOpaque(i)) {
-            nSamplers += mShaderResourceInterface.GetUniformArraySize(i);
+    /// The textures are referred to by the command buffer being recorded, which is submitted with this serial
+    const uint64_t serial = context->GetVkCommandBufferManager()->GetSubmitSerial();
+    const uint32_t slot   = context->GetShareGroupSlot();
+    for(const std::vector<uint32_t> *uniforms : { &mSamplerUniforms, &mBindlessSamplerUniforms }) {
+        for(uint32_t i : *uniforms) {
+            Texture *texture = GetSamplerTexture(i);
+            texture->SetLastUsedSerial(slot, serial);
+            texture->TouchTransient(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+    }
+}
+
+Texture *
+ShaderProgram::GetSamplerTexture(uint32_t uniform) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Context *context = GetCurrentContext();
+    assert(context);
+
+    const glsl_sampler_t textureUnit = *(glsl_sampler_t *)mShaderResourceInterface.GetUniformClientData(uniform);
+    const GLenum target = mShaderResourceInterface.GetUniformType(uniform) == GL_SAMPLER_CUBE ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    return context->GetStateManager()->GetActiveObjectsState()->GetActiveTexture(target, textureUnit);
+}
+
+Texture *
+ShaderProgram::PrepareSampledTexture(Texture *activeTexture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // Calling a sampler from a fragment shader must return (0, 0, 0, 1) 
+    // when the sampler’s associated texture object is not complete.
+    // It is sampled from the image the share group keeps for it, while the texture is left as the application specified it
+    if( !activeTexture->IsCompleted() || !activeTexture->IsNPOTAccessCompleted()) {
+        Texture *incompleteTexture = GetCurrentContext()->GetResourceManager()->GetIncompleteTexture(activeTexture->GetTarget());
+        if(incompleteTexture != nullptr) {
+            activeTexture = incompleteTexture;
+        }
+    }
+    else if(activeTexture->IsDepthTexture()) {
+        // sampled in place once its depth writes are made visible
+        activeTexture->AllocatePending();
+        if(activeTexture->GetVkImageLayout() != VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL) {
+            activeTexture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+        }
+    }
+    else if((activeTexture->IsColorAttachment() && mVkContext->mIsMaintenanceExtSupported) || activeTexture->IsSurfaceStoredUpright()) {
+        // rendered upright, so the attachment, or the pbuffer bound to the texture, is sampled in place once its writes are made visible
+        if(activeTexture->GetVkImageLayout() != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+            activeTexture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+    }
+    else if(activeTexture->IsColorAttachment() || activeTexture->IsSurfaceBound()) {
+
+        // Get Inverted Data from FBO's Color Attachment Texture
+        GLenum dstInternalFormat = activeTexture->GetExplicitInternalFormat();
+        ImageRect srcRect(0, 0, activeTexture->GetWidth(), activeTexture->GetHeight(),
+            GlInternalFormatTypeToNumElements(dstInternalFormat, activeTexture->GetExplicitType()),
+            GlTypeToElementSize(activeTexture->GetExplicitType()),
+            Texture::GetDefaultInternalAlignment());
+        ImageRect dstRect(0, 0, activeTexture->GetWidth(), activeTexture->GetHeight(),
+            GlInternalFormatTypeToNumElements(dstInternalFormat, activeTexture->GetExplicitType()),
+            GlTypeToElementSize(activeTexture->GetExplicitType()),
+            Texture::GetDefaultInternalAlignment());
+
+        uint8_t* dstData = new uint8_t[dstRect.GetRectBufferSize()];
+        srcRect.y = activeTexture->GetInvertedYOrigin(&srcRect);
+        activeTexture->CopyPixelsToHost  (&srcRect, &dstRect, 0, 0, dstInternalFormat, static_cast<void *>(dstData));
+
+        // Create new Texture with this data 
+        Texture *inverted_texture = new Texture(mVkContext);
+        inverted_texture->SetTarget(GL_TEXTURE_2D);
+        inverted_texture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+        inverted_texture->SetVkImageTiling();
+        inverted_texture->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
+        inverted_texture->InitState();
+
+        inverted_texture->SetVkFormat(activeTexture->GetVkFormat());
+        inverted_texture->SetState(activeTexture->GetWidth(), activeTexture->GetHeight(),
+                    0, 0,
+                    GlInternalFormatToGlFormat(dstInternalFormat),
+                    GlInternalFormatToGlType(dstInternalFormat),
+                    Texture::GetDefaultInternalAlignment(),
+                    dstData);
+        
+        if(inverted_texture->IsCompleted()) {
+            inverted_texture->Allocate();
+            inverted_texture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            mCacheManager->CacheTexture(inverted_texture);
         }
+
+        mHasTransientTextures = true;
+        activeTexture = inverted_texture;
+
+        delete[] dstData;
     }
 
+    /// Textures get their image on the first draw that samples them
+    activeTexture->AllocatePending();
+    activeTexture->CreateVkSampler();
+
+    return activeTexture;
+}
+
+void
+ShaderProgram::UpdateSamplerDescriptors(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
     /// Get texture units from samplers
-    uint32_t samp = 0;
-    std::map<uint32_t, uint32_t> map_block_texDescriptor;
-    VkDescriptorImageInfo *textureDescriptors = nullptr;
-    if(nSamplers) {
-        textureDescriptors = new VkDescriptorImageInfo[nSamplers];
-        memset(static_cast<void *>(textureDescriptors), 0, nSamplers * sizeof(*textureDescriptors));
-
-        for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniforms(); ++i) {
-            if(mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D || mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_CUBE) {
-                for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
-                    const glsl_sampler_t textureUnit = *(glsl_sampler_t *)mShaderResourceInterface.GetUniformClientData(i);
-
-                    /// Sampler might need an update
-                    Texture *activeTexture = context->GetStateManager()->GetActiveObjectsState()->GetActiveTexture(
-                    mShaderResourceInterface.GetUniformType(i) == GL_SAMPLER_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP, textureUnit); // TODO remove mGlContext
-                    // Calling a sampler from a fragment shader must return (0, 0, 0, 1) 
-                    // when the sampler’s associated texture object is not complete.
-                    if( !activeTexture->IsCompleted() || !activeTexture->IsNPOTAccessCompleted()) {
-                        uint8_t pixels[4] = {0,0,0,255};
-                        for(GLint layer = 0; layer < activeTexture->GetLayersCount(); ++layer) {
-                            for(GLint level = 0; level < activeTexture->GetMipLevelsCount(); ++level) {
-                                activeTexture->SetState(1, 1, level, layer, GL_RGBA, GL_UNSIGNED_BYTE, Texture::GetDefaultInternalAlignment(), pixels);
-                            }
-                        }
-
-                        if(activeTexture->IsCompleted()) {
-                            activeTexture->SetVkFormat(VK_FORMAT_R8G8B8A8_UNORM);
-                            activeTexture->Allocate();
-                            activeTexture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-                        }
-                    }
-                    else if(context->GetResourceManager()->IsTextureAttachedToFBO(activeTexture)) {
-
-                        // Get Inverted Data from FBO's Color Attachment Texture
-                        GLenum dstInternalFormat = activeTexture->GetExplicitInternalFormat();
-                        ImageRect srcRect(0, 0, activeTexture->GetWidth(), activeTexture->GetHeight(),
-                            GlInternalFormatTypeToNumElements(dstInternalFormat, activeTexture->GetExplicitType()),
-                            GlTypeToElementSize(activeTexture->GetExplicitType()),
-                            Texture::GetDefaultInternalAlignment());
-                        ImageRect dstRect(0, 0, activeTexture->GetWidth(), activeTexture->GetHeight(),
-                            GlInternalFormatTypeToNumElements(dstInternalFormat, activeTexture->GetExplicitType()),
-                            GlTypeToElementSize(activeTexture->GetExplicitType()),
-                            Texture::GetDefaultInternalAlignment());
-
-                        uint8_t* dstData = new uint8_t[dstRect.GetRectBufferSize()];
-                        srcRect.y = activeTexture->GetInvertedYOrigin(&srcRect);
-                        activeTexture->CopyPixelsToHost  (&srcRect, &dstRect, 0, 0, dstInternalFormat, static_cast<void *>(dstData));
-
-                        // Create new Texture with this data 
-                        Texture *inverted_texture = new Texture(mVkContext);
-                        inverted_texture->SetTarget(GL_TEXTURE_2D);
-                        inverted_texture->SetVkImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
-                        inverted_texture->SetVkImageTiling();
-                        inverted_texture->SetVkImageTarget(vulkanAPI::Image::VK_IMAGE_TARGET_2D);
-                        inverted_texture->InitState();
-
-                        inverted_texture->SetVkFormat(activeTexture->GetVkFormat());
-                        inverted_texture->SetState(activeTexture->GetWidth(), activeTexture->GetHeight(),
-                                    0, 0,
-                                    GlInternalFormatToGlFormat(dstInternalFormat),
-                                    GlInternalFormatToGlType(dstInternalFormat),
-                                    Texture::GetDefaultInternalAlignment(),
-                                    dstData);
-                        
-                        if(inverted_texture->IsCompleted()) {
-                            inverted_texture->Allocate();
-                            inverted_texture->PrepareVkImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-                            mCacheManager->CacheTexture(inverted_texture);
-                        }
-
-                        activeTexture = inverted_texture;
-
-                        delete[] dstData;
-                    }
-
-                    activeTexture->CreateVkSampler();
-
-                    textureDescriptors[samp].sampler     = activeTexture->GetVkSampler();
-                    textureDescriptors[samp].imageLayout = activeTexture->GetVkImageLayout();
-                    textureDescriptors[samp].imageView   = activeTexture->GetVkImageView();
-
-                    if(j == 0) {
-                        map_block_texDescriptor[mShaderResourceInterface.GetUniformBlockIndex(i)] = samp;
-                    }
-                    ++samp;
-                }
-            }
+    size_t sampler = 0;
+    for(uint32_t i : mSamplerUniforms) {
+        for(int32_t j = 0; j < mShaderResourceInterface.GetUniformArraySize(i); ++j) {
+            /// Sampler might need an update
+            Texture *sampledTexture = GetSamplerTexture(i);
+            Texture *activeTexture  = PrepareSampledTexture(sampledTexture);
+
+            VkDescriptorImageInfo imageInfo;
+            imageInfo.sampler     = activeTexture->GetVkSampler();
+            imageInfo.imageView   = activeTexture->GetVkImageView();
+            imageInfo.imageLayout = activeTexture->GetVkImageLayout();
+            SetDescriptorImageInfo(mShaderResourceInterface.GetUniformBlockIndex(i), j, imageInfo);
+
+            mSamplerGenerations[sampler++] = sampledTexture->GetGeneration();
         }
     }
-    assert(samp == nSamplers);
 
-    VkWriteDescriptorSet *writes = new VkWriteDescriptorSet[nLiveUniformBlocks];
-    memset(static_cast<void*>(writes), 0, nLiveUniformBlocks * sizeof(*writes));
-    for(uint32_t i = 0; i < nLiveUniformBlocks; ++i) {
-        writes[i].sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[i].pNext      = nullptr;
-        writes[i].dstSet     = mVkDescSet;
-        writes[i].dstBinding = mShaderResourceInterface.GetUniformBlockBinding(i);
-
-        if(mShaderResourceInterface.IsUniformBlockOpaque(i)) {
-            writes[i].pImageInfo      = &textureDescriptors[map_block_texDescriptor[i]];
-            writes[i].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            writes[i].descriptorCount = mShaderResourceInterface.GetUniformArraySize(i);
-        } else {
-            writes[i].descriptorCount = 1;
-            writes[i].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            writes[i].pBufferInfo     = mShaderResourceInterface.GetUniformBufferObject(i)->GetBufferDescInfo();
+    for(uint32_t i = 0; i < mShaderResourceInterface.GetLiveUniformBlocks(); ++i) {
+        if(mShaderResourceInterface.IsUniformBlockOpaque(i) || mShaderResourceInterface.IsUniformBlockApplicationBuffer(i) ||
+          !mShaderResourceInterface.IsUniformBlockDescriptor(i)) {
+            continue;
         }
+
+        VkDescriptorBufferInfo bufferInfo;
+        bufferInfo.buffer = mCacheManager->GetUniformRing()->GetVkBuffer();
+        bufferInfo.offset = 0;
+        bufferInfo.range  = mShaderResourceInterface.GetUniformBlockSize(i);
+        SetDescriptorBufferInfo(i, bufferInfo);
     }
+}
 
-    vkUpdateDescriptorSets(mVkContext->vkDevice, nLiveUniformBlocks, writes, 0, nullptr);
+void
+ShaderProgram::UpdateBindlessTextureIndices(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    delete[] writes;
-    delete[] textureDescriptors;
+    if(!UsesBindlessTextures()) {
+        return;
+    }
 
-    mUpdateDescriptorSets = false;
+    /// the slots of the textures are kept by the table, only their indices are pushed with each draw
+    vulkanAPI::BindlessTextureTable *table = mCacheManager->GetBindlessTextureTable();
+    for(size_t i = 0; i < mBindlessSamplerUniforms.size(); ++i) {
+        const uint32_t uniform   = mBindlessSamplerUniforms[i];
+        Texture *sampledTexture  = GetSamplerTexture(uniform);
+        Texture *activeTexture   = PrepareSampledTexture(sampledTexture);
+
+        VkDescriptorImageInfo imageInfo;
+        imageInfo.sampler     = activeTexture->GetVkSampler();
+        imageInfo.imageView   = activeTexture->GetVkImageView();
+        imageInfo.imageLayout = activeTexture->GetVkImageLayout();
+        mBindlessTextureIndices[i] = table->GetIndex(mShaderResourceInterface.GetUniformType(uniform) == GL_SAMPLER_2D ? 0 : 1,
+                                                     activeTexture->GetGeneration(), imageInfo);
+
+        mBindlessSamplerGenerations[i] = sampledTexture->GetGeneration();
+    }
+    mBindlessTableSerial = table->GetSerial();
+}
+
+bool
+ShaderProgram::UpdateInputAttachmentDescriptor(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *context = GetCurrentContext();
+    assert(context);
+
+    const Texture *colorTexture = context->GetWriteFBO()->GetColorAttachmentTexture();
+    assert(colorTexture);
+
+    // the render pass keeps the attachment in the general layout for as long as it is read
+    VkDescriptorImageInfo imageInfo;
+    imageInfo.sampler     = VK_NULL_HANDLE;
+    imageInfo.imageView   = colorTexture->GetVkImageView();
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    const uint32_t block = mShaderResourceInterface.GetInputAttachmentBlock();
+    SetDescriptorImageInfo(block, 0, imageInfo);
+
+    return mDirtyDescriptorWrites[mDescriptorWriteIndices[block]] != 0;
 }
 
 void
-ShaderProgram::ResetVulkanVertexInput(void)
+ShaderProgram::SetDescriptorImageInfo(uint32_t block, int32_t element, const VkDescriptorImageInfo &info)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkDescriptorImageInfo *imageInfo = reinterpret_cast<VkDescriptorImageInfo *>(&mDescriptorData[mDescriptorDataOffsets[block]]) + element;
+    if(imageInfo->sampler != info.sampler || imageInfo->imageView != info.imageView || imageInfo->imageLayout != info.imageLayout) {
+        *imageInfo = info;
+        mDirtyDescriptorWrites[mDescriptorWriteIndices[block]] = 1;
+    }
+}
+
+void
+ShaderProgram::SetDescriptorBufferInfo(uint32_t block, const VkDescriptorBufferInfo &info)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkDescriptorBufferInfo *bufferInfo = reinterpret_cast<VkDescriptorBufferInfo *>(&mDescriptorData[mDescriptorDataOffsets[block]]);
+    if(bufferInfo->buffer != info.buffer || bufferInfo->offset != info.offset || bufferInfo->range != info.range) {
+        *bufferInfo = info;
+        mDirtyDescriptorWrites[mDescriptorWriteIndices[block]] = 1;
+    }
+}
+
+void
+ShaderProgram::SetBufferBlockDescriptor(uint32_t block, const VkDescriptorBufferInfo &info)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    assert(mShaderResourceInterface.IsUniformBlockApplicationBuffer(block));
+
+    // the next update writes a fresh set once a buffer bound to the program changes
+    SetDescriptorBufferInfo(block, info);
+    mUpdateDescriptorSets |= mDirtyDescriptorWrites[mDescriptorWriteIndices[block]] != 0;
+}
+
+GLuint
+ShaderProgram::GetUniformBufferBlockIndex(const char *name) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mVkPipelineVertexInput.vertexAttributeDescriptionCount = 0;
-    mVkPipelineVertexInput.vertexBindingDescriptionCount = 0;
-    mActiveVertexVkBuffersCount = 0;
-    memset(static_cast<void *>(mActiveVertexVkBuffers), 0, sizeof(mActiveVertexVkBuffers));
+    for(uint32_t i = 0; i < mUniformBufferBlocks.size(); ++i) {
+        if(mShaderResourceInterface.GetUniformBlockName(mUniformBufferBlocks[i]) == name) {
+            return i;
+        }
+    }
+
+    return GL_INVALID_INDEX;
+}
+
+VkPipeline
+ShaderProgram::GetVkComputePipeline(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkComputePipeline != VK_NULL_HANDLE || !IsCompute() || mVkShaderModules[0] == VK_NULL_HANDLE) {
+        return mVkComputePipeline;
+    }
+
+    // a compute program has a single pipeline, created on its first dispatch
+    VkComputePipelineCreateInfo info;
+    memset(static_cast<void *>(&info), 0, sizeof(info));
+    info.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    info.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    info.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+    info.stage.module              = mVkShaderModules[0];
+    info.stage.pName               = "main\0";
+    info.stage.pSpecializationInfo = GetVkSpecializationInfo();
+    info.layout                    = mVkPipelineLayout;
+    info.basePipelineIndex         = -1;
+
+    if(vkCreateComputePipelines(mVkContext->vkDevice, GetVkPipelineCache(), 1, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &mVkComputePipeline) != VK_SUCCESS) {
+        mVkComputePipeline = VK_NULL_HANDLE;
+    }
+
+    return mVkComputePipeline;
+}
+
+bool
+ShaderProgram::WriteDescriptorSet(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vulkanAPI::DescriptorPoolRing *descriptorPoolRing = mCacheManager->GetDescriptorPoolRing();
+
+    /// the set of this frame is kept for as long as none of its bindings changes, and it is
+    /// the source of the unchanged bindings of the next one otherwise
+    size_t nDirtyWrites = 0;
+    for(uint8_t dirty : mDirtyDescriptorWrites) {
+        nDirtyWrites += dirty;
+    }
+    const VkDescriptorSet previousSet = mDescriptorPoolSerial == descriptorPoolRing->GetSerial() ? mVkDescSet : VK_NULL_HANDLE;
+    if(previousSet != VK_NULL_HANDLE && nDirtyWrites == 0) {
+        return true;
+    }
+
+    if(!descriptorPoolRing->Allocate(mVkDescSetLayout, &mVkDescSet)) {
+        assert(0);
+        return false;
+    }
+    mDescriptorPoolSerial = descriptorPoolRing->GetSerial();
+
+    if(previousSet != VK_NULL_HANDLE && nDirtyWrites < mVkDescriptorWrites.size()) {
+        mVkPartialDescriptorWrites.clear();
+        mVkDescriptorCopies.clear();
+        for(size_t i = 0; i < mVkDescriptorWrites.size(); ++i) {
+            const VkWriteDescriptorSet &write = mVkDescriptorWrites[i];
+            if(mDirtyDescriptorWrites[i]) {
+                mVkPartialDescriptorWrites.push_back(write);
+                mVkPartialDescriptorWrites.back().dstSet = mVkDescSet;
+                mDirtyDescriptorWrites[i] = 0;
+                continue;
+            }
+
+            VkCopyDescriptorSet copy;
+            copy.sType           = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+            copy.pNext           = nullptr;
+            copy.srcSet          = previousSet;
+            copy.srcBinding      = write.dstBinding;
+            copy.srcArrayElement = 0;
+            copy.dstSet          = mVkDescSet;
+            copy.dstBinding      = write.dstBinding;
+            copy.dstArrayElement = 0;
+            copy.descriptorCount = write.descriptorCount;
+            mVkDescriptorCopies.push_back(copy);
+        }
+
+        mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_DESCRIPTOR_WRITES, mVkPartialDescriptorWrites.size());
+        vkUpdateDescriptorSets(mVkContext->vkDevice,
+                               static_cast<uint32_t>(mVkPartialDescriptorWrites.size()), mVkPartialDescriptorWrites.data(),
+                               static_cast<uint32_t>(mVkDescriptorCopies.size()),        mVkDescriptorCopies.data());
+        return true;
+    }
+
+    std::fill(mDirtyDescriptorWrites.begin(), mDirtyDescriptorWrites.end(), 0);
+
+    // an update template writes the same descriptors, in a single call
+    mVkContext->perfCounters->Add(vulkanAPI::PERF_COUNTER_DESCRIPTOR_WRITES, mVkDescriptorWrites.size());
+
+#ifdef VK_KHR_descriptor_update_template
+    if(mVkDescUpdateTemplate != VK_NULL_HANDLE) {
+        mVkContext->fpUpdateDescriptorSetWithTemplateKHR(mVkContext->vkDevice, mVkDescSet, mVkDescUpdateTemplate, mDescriptorData.data());
+        return true;
+    }
+#endif // VK_KHR_descriptor_update_template
+
+    for(auto &write : mVkDescriptorWrites) {
+        write.dstSet = mVkDescSet;
+    }
+    vkUpdateDescriptorSets(mVkContext->vkDevice, static_cast<uint32_t>(mVkDescriptorWrites.size()), mVkDescriptorWrites.data(), 0, nullptr);
+
+    return true;
 }
 
 void
-ShaderProgram::UpdateAttributeInterface(void)
+ShaderProgram::ResetVulkanVertexInput(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mShaderResourceInterface.SetReflection(mShaderCompiler->GetShaderReflection());
-    mShaderResourceInterface.UpdateAttributeInterface();
-    mShaderResourceInterface.SetReflectionSize();
-    mShaderResourceInterface.SetReflection(nullptr);
+    mVkPipelineVertexInput.vertexAttributeDescriptionCount = 0;
+    mVkPipelineVertexInput.vertexBindingDescriptionCount = 0;
+    mVertexInputLayoutSerial = 0;
+    mActiveVertexVkBuffersCount = 0;
+    memset(static_cast<void *>(mActiveVertexVkBuffers), 0, sizeof(mActiveVertexVkBuffers));
+    memset(static_cast<void *>(mActiveVertexVkBufferOffsets), 0, sizeof(mActiveVertexVkBufferOffsets));
+    memset(static_cast<void *>(mActiveVertexVkBufferStrides), 0, sizeof(mActiveVertexVkBufferStrides));
 }
 
 void
@@ -1256,14 +2343,20 @@ ShaderProgram::BuildShaderResourceInterface(void)
 
     mShaderResourceInterface.SetReflection(mShaderCompiler->GetShaderReflection());
     mShaderResourceInterface.CreateInterface();
+    mShaderResourceInterface.SetReflectionSize();
     mShaderResourceInterface.SetReflection(nullptr);
     mShaderResourceInterface.AllocateUniformClientData();
-    mShaderResourceInterface.AllocateUniformBufferObjects(mVkContext);
+    mShaderResourceInterface.AllocateUniformBlockClientData();
 
     mShaderResourceInterface.SetActiveUniformMaxLength();
     mShaderResourceInterface.SetActiveAttributeMaxLength();
 
+    /// the fresh client data holds no depth range yet
+    mDepthRangeLocations[0] = GetUniformLocation("gl_DepthRange.near");
+    mDepthRangeLocations[1] = GetUniformLocation("gl_DepthRange.far");
+    mDepthRangeLocations[2] = GetUniformLocation("gl_DepthRange.diff");
+    mDepthRangeValid        = false;
+
     AllocateVkDescriptoSet();
     mUpdateDescriptorSets = true;
-    mUpdateDescriptorData = true;
 }
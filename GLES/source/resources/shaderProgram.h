@@ -27,21 +27,80 @@
 #include "shader.h"
 #include "shaderResourceInterface.h"
 #include "utils/cacheManager.h"
-#include "genericVertexAttribute.h"
+#include "vertexArray.h"
 #include "vulkan/pipelineCache.h"
 #include "refObject.h"
+#include "utils/arrays.hpp"
+
+#define GLOVE_PROGRAM_BINARY_MAGIC                      0x42505047  // "GPPB"
+/// Bump whenever the layout of program binaries changes, so that binaries saved by an older build are rejected
+#define GLOVE_PROGRAM_BINARY_VERSION                    6
+/// Set in the version of binaries whose single samplers are read from the bindless texture table
+#define GLOVE_PROGRAM_BINARY_BINDLESS                   0x80000000
 
 class Context;
 
-class ShaderProgram : public refObject {
+class ShaderProgram : public refObject, public ArrayObject {
 private:
     const vulkanAPI::vkContext_t                       *mVkContext;
 
+    /// what every draw binds, kept together ahead of the interface and the data that only linking touches
+    VkPipelineLayout                                    mVkPipelineLayout;
+    VkDescriptorSet                                     mVkDescSet;
+    bool                                                mUpdateDescriptorSets;
+    /// range of the block declared as push constants, whose data is pushed instead of bound
+    VkPushConstantRange                                 mVkPushConstantRange;
+    VkBuffer                                            mActiveIndexVkBuffer;
+    VkIndexType                                         mActiveIndexVkType;
+    uint32_t                                            mActiveVertexVkBuffersCount;
+    VkBuffer                                            mActiveVertexVkBuffers[GLOVE_MAX_VERTEX_ATTRIBS];
+    VkDeviceSize                                        mActiveVertexVkBufferOffsets[GLOVE_MAX_VERTEX_ATTRIBS];
+    VkDeviceSize                                        mActiveVertexVkBufferStrides[GLOVE_MAX_VERTEX_ATTRIBS];
+    /// the uniform ring offsets the non-opaque blocks are bound at, in binding order
+    std::vector<uint32_t>                               mVkDynamicOffsets;
+
     VkDescriptorSetLayout                               mVkDescSetLayout;
     VkDescriptorSetLayoutBinding                       *mVkDescSetLayoutBind;
-    VkDescriptorPool                                    mVkDescPool;
-    VkDescriptorSet                                     mVkDescSet;
-    VkPipelineLayout                                    mVkPipelineLayout;
+
+    /// descriptors of every block gathered in one blob, laid out once per program, and the
+    /// writes (or update template) that copy them into each freshly allocated descriptor set
+    std::vector<uint8_t>                                mDescriptorData;
+    std::vector<size_t>                                 mDescriptorDataOffsets;
+    std::vector<VkWriteDescriptorSet>                   mVkDescriptorWrites;
+    std::vector<uint32_t>                               mDescriptorWriteIndices;
+
+    /// writes whose descriptors changed since the last set was written; the others are copied from that set,
+    /// through writes and copies kept between updates so that none allocates
+    std::vector<uint8_t>                                mDirtyDescriptorWrites;
+    std::vector<VkWriteDescriptorSet>                   mVkPartialDescriptorWrites;
+    std::vector<VkCopyDescriptorSet>                    mVkDescriptorCopies;
+#ifdef VK_KHR_descriptor_update_template
+    VkDescriptorUpdateTemplateKHR                       mVkDescUpdateTemplate;
+#endif // VK_KHR_descriptor_update_template
+    uint64_t                                            mDescriptorPoolSerial;
+
+    /// sampler uniforms, and the generation of every texture they sampled when the descriptors were gathered;
+    /// copies of framebuffer textures only live for one frame so they are gathered again on the next one
+    std::vector<uint32_t>                               mSamplerUniforms;
+    std::vector<uint64_t>                               mSamplerGenerations;
+    bool                                                mHasTransientTextures;
+
+    /// sampler uniforms read from the bindless texture table in the order of their indices, the generation of
+    /// the texture each one sampled, and the indices pushed for them as of the given serial of the table
+    std::vector<uint32_t>                               mBindlessSamplerUniforms;
+    std::vector<uint64_t>                               mBindlessSamplerGenerations;
+    std::vector<uint32_t>                               mBindlessTextureIndices;
+    uint64_t                                            mBindlessTableSerial;
+
+    /// non-opaque blocks in binding order
+    std::vector<uint32_t>                               mDynamicOffsetBlocks;
+    uint64_t                                            mUniformRingGeneration;
+
+    /// blocks declared as specialization constants, and the values the pipeline is specialized with
+    std::vector<uint32_t>                               mSpecializationBlocks;
+    std::vector<uint32_t>                               mSpecializationData;
+    std::vector<VkSpecializationMapEntry>               mVkSpecializationMapEntries;
+    VkSpecializationInfo                                mVkSpecializationInfo;
 
     vulkanAPI::PipelineCache                           *mPipelineCache;
     CacheManager                                       *mCacheManager;
@@ -49,55 +108,131 @@ private:
     VkPipelineVertexInputStateCreateInfo                mVkPipelineVertexInput;
     VkVertexInputBindingDescription                     mVkVertexInputBinding[GLOVE_MAX_VERTEX_ATTRIBS];
     VkVertexInputAttributeDescription                   mVkVertexInputAttribute[GLOVE_MAX_VERTEX_ATTRIBS];
+    /// layout serial of the vertex array the layout was built from, 0 until it is built
+    uint64_t                                            mVertexInputLayoutSerial;
 
-    uint32_t                                            mActiveVertexVkBuffersCount;
-    VkBuffer                                            mActiveVertexVkBuffers[GLOVE_MAX_VERTEX_ATTRIBS];
+    /// generated index buffers that emulate GL_LINE_LOOP, and GL_TRIANGLE_FAN where fans are missing, for non-indexed draws, per vertex count
+    std::map<uint32_t, BufferObject *>                  mLineLoopIndexBuffers;
+    std::map<uint32_t, BufferObject *>                  mTriangleFanIndexBuffers;
 
-    BufferObject                                       *mExplicitIbo;
-    VkBuffer                                            mActiveIndexVkBuffer;
-
-    bool                                                mUpdateDescriptorSets;
-    bool                                                mUpdateDescriptorData;
     bool                                                mLinked;
     bool                                                mIsPrecompiled;
     bool                                                mValidated;
 
     float                                               mMinDepthRange;
     float                                               mMaxDepthRange;
+    /// of gl_DepthRange.near, far and diff, resolved when the interface is built
+    int                                                 mDepthRangeLocations[3];
+    bool                                                mDepthRangeValid;
 
     uint32_t                                            mStageCount;
 #define MAX_SHADERS 2
     size_t                                              mShaderSPVsize[MAX_SHADERS];
     uint32_t                                           *mShaderSPVdata[MAX_SHADERS];
+    uint64_t                                            mShaderSPVhash;
     VkShaderModule                                      mVkShaderModules[MAX_SHADERS];
     VkShaderStageFlagBits                               mVkShaderStages[MAX_SHADERS];
     Shader                                             *mShaders[MAX_SHADERS];
     int                                                 mStagesIDs[MAX_SHADERS];
 
+    /// a compute program holds its shader alone, its module and SPIR-V take the first slot of the stages
+    Shader                                             *mComputeShader;
+    bool                                                mIsCompute;
+    VkPipeline                                          mVkComputePipeline;
+    /// storage blocks, whose buffers are bound by each dispatch
+    std::vector<uint32_t>                               mStorageBlocks;
+    /// uniform blocks read from the buffers of the application, in the order of their GL indices,
+    /// with the GL_UNIFORM_BUFFER binding given to each
+    std::vector<uint32_t>                               mUniformBufferBlocks;
+    std::vector<GLuint>                                 mUniformBufferBindings;
+
+    /// vertex outputs the next link captures with transform feedback, and those the last link did,
+    /// with the bytes each of its buffers advances by per vertex
+    std::vector<std::string>                            mTransformFeedbackVaryings;
+    GLenum                                              mTransformFeedbackBufferMode;
+    std::vector<std::string>                            mLinkedTransformFeedbackVaryings;
+    GLenum                                              mLinkedTransformFeedbackBufferMode;
+    uint32_t                                            mTransformFeedbackStrides[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+
     ShaderCompiler                                     *mShaderCompiler;
     ShaderResourceInterface                             mShaderResourceInterface;
 
-    bool                                                ValidateProgram(void);
+    /// a link running on the compile queue, with its own compiler and copies of everything it reads,
+    /// and what it produced; the program takes the result over on the GL thread the first time it is used
+    typedef struct LinkJob_t {
+        ShaderCompiler                                 *compiler;
+        std::string                                     source[MAX_SHADERS];
+        ShaderResourceInterface::attribsLayout_t        attribsLayout;
+        bool                                            isYInverted;
+        bool                                            isCompute;
+        std::vector<std::string>                        xfbVaryings;
+        bool                                            xfbSeparate;
+        uint32_t                                        xfbStrides[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
+        uintptr_t                                       program;
+        std::string                                     cacheKey;
+        bool                                            linked;
+        std::string                                     infoLog;
+        std::vector<uint32_t>                           spirv[MAX_SHADERS];
+        std::vector<uint8_t>                            reflection;
+        std::shared_future<void>                        done;
+    } LinkJob_t;
+
+    std::shared_ptr<LinkJob_t>                          mLinkJob;
+    std::string                                         mInfoLog;
+
     void                                                ReleaseVkObjects(void);
+    void                                                ReleaseShaderModules(void);
+    VkShaderModule                                      AcquireShaderModule(Shader *shader);
     bool                                                AllocateVkDescriptoSet(void);
     bool                                                CreateDescriptorSetLayout(uint32_t nLiveUniformBlocks);
-    bool                                                CreateDescriptorPool(uint32_t nLiveUniformBlocks);
-    bool                                                CreateDescriptorSet(void);
+    bool                                                CreateDescriptorUpdates(void);
+    Texture                                            *PrepareSampledTexture(Texture *activeTexture);
+    Texture                                            *GetSamplerTexture(uint32_t uniform) const;
     void                                                UpdateSamplerDescriptors(void);
+    void                                                UpdateBindlessTextureIndices(void);
+    bool                                                UpdateInputAttachmentDescriptor(void);
+    VkDescriptorType                                    GetUniformBlockDescriptorType(uint32_t block) const;
+    void                                                SetDescriptorImageInfo(uint32_t block, int32_t element, const VkDescriptorImageInfo &info);
+    void                                                SetDescriptorBufferInfo(uint32_t block, const VkDescriptorBufferInfo &info);
+    bool                                                HasSamplerTexturesUpdated(void);
+    void                                                MarkSamplerTexturesUsed(void);
+    bool                                                WriteDescriptorSet(void);
+
+    /// program binaries are a header followed by the reflection, the SPIR-V of both stages and the pipeline cache data,
+    /// the hash covers everything after the header
+    typedef struct BinaryHeader_t {
+        uint32_t                                        magic;
+        uint32_t                                        version;
+        uint32_t                                        reflectionSize;
+        uint32_t                                        spirvSize;
+        uint32_t                                        pipelineCacheSize;
+        uint32_t                                        reserved;
+        uint64_t                                        hash;
+    } BinaryHeader_t;
 
     uint32_t                                            SerializeShadersSpirv(void *binary);
     uint32_t                                            DeserializeShadersSpirv(const void *binary);
+    bool                                                ValidateBinary(const void *binary, size_t binarySize) const;
+    uint32_t                                            GetBinaryVersion(void) const;
+    static uint64_t                                     HashBinary(const uint8_t *data, size_t size);
+
+    /// the on-disk shader cache skips glslang for programs linked by an earlier run
+    std::string                                         GetShaderCacheKey(bool isYInverted) const;
+    static bool                                         LoadFromShaderCache(LinkJob_t *job);
+    static void                                         StoreToShaderCache(const LinkJob_t *job);
+
+    static void                                         RunLinkJob(LinkJob_t *job);
 
     void                                                ResetVulkanVertexInput(void);
-    void                                                UpdateAttributeInterface(void);
+    bool                                                GetVkPipelineCacheData(void *data, size_t *size) const;
     void                                                BuildShaderResourceInterface(void);
-    bool                                                UpdateVertexAttribProperties(size_t vertCount, uint32_t firstVertex, std::vector<GenericVertexAttribute>& genericVertAttribs, std::map<uint32_t, uint32_t>& vboLocationBindings, bool updatedVertexAttrib);
-    void                                                GenerateVertexInputProperties(std::vector<GenericVertexAttribute>& genericVertAttribs, const std::map<uint32_t, uint32_t>& vboLocationBindings);
+    bool                                                UpdateVertexAttribProperties(size_t vertCount, uint32_t firstVertex, uint32_t instanceCount, VertexArray *vertexArray, bool updatedVertexAttrib);
+    bool                                                UpdateVertexAttribBuffers(size_t vertCount, uint32_t firstVertex, uint32_t instanceCount, VertexArray *vertexArray);
 
     void                                                LineLoopConversion(void* data, uint32_t indexCount, size_t elementByteSize);
-    bool                                                ConvertIndexBufferToUint16(const void* srcData, size_t elementCount, BufferObject** ibo);
-    bool                                                AllocateExplicitIndexBuffer(const void* data, size_t size, BufferObject** ibo);
-    uint32_t                                            GetMaxIndex(BufferObject* ibo, uint32_t indexCount, size_t actualSize, VkDeviceSize offset);
+    void                                                ReleaseGeneratedIndexBuffers(std::map<uint32_t, BufferObject *> *indexBuffers);
+    bool                                                StreamIndices(const void* indices, uint32_t indexCount, GLenum type, bool widen, bool closeLoop, VkDeviceSize* offset, uint32_t* maxIndex);
+    uint32_t                                            GetMaxIndex(BufferObject* ibo, uint32_t indexCount, GLenum type, const void* indices);
 
 public:
     ShaderProgram(const vulkanAPI::vkContext_t *vkContext = nullptr);
@@ -106,13 +241,15 @@ public:
     void                                                SetPipelineVertexInputStateInfo(void);
     bool                                                SetPipelineShaderStage(uint32_t &pipelineShaderStageCount, int *pipelineStagesIDs, VkPipelineShaderStageCreateInfo *pipelineShaderStages);
     void                                                PrepareIndexBufferObject(uint32_t* firstIndex, uint32_t* maxIndex, uint32_t indexCount, GLenum type, const void* indices, BufferObject* ibo);
-    bool                                                PrepareVertexAttribBufferObjects(size_t vertCount, uint32_t firstVertex, std::vector<GenericVertexAttribute>& genericVertAttribs, bool updatedVertexAttrib);
+    bool                                                PrepareGeneratedIndexBufferObject(GLenum mode, uint32_t vertCount);
+    bool                                                PrepareVertexAttribBufferObjects(size_t vertCount, uint32_t firstVertex, uint32_t instanceCount, VertexArray *vertexArray, bool updatedVertexAttrib);
     Shader                                             *IsShaderAttached(Shader *shader) const;
     void                                                AttachShader(Shader *shader);
     void                                                DetachShader(Shader *shader);
     int                                                 GetInfoLogLength(void) const;
     char                                               *GetInfoLog(void) const;
-    bool                                                LinkProgram();
+    bool                                                LinkProgram(TaskQueue *compileQueue);
+    void                                                CompleteLink(void);
 
     void                                                DetachShaders(void);
 
@@ -120,9 +257,11 @@ public:
     bool                                                ValidateSamplers(void);
     void                                                EnableUpdateOfDescriptorSets(void)                  { FUN_ENTRY(GL_LOG_TRACE); mUpdateDescriptorSets = true; }
 
-    void                                                UsePrecompiledBinary(const void *binary, size_t binarySize);
-    void                                                GetBinaryData(void *binary, GLsizei *binarySize);
+    bool                                                UsePrecompiledBinary(const void *binary, size_t binarySize);
+    void                                                GetBinaryData(void *binary, GLsizei bufSize, GLsizei *binarySize);
     GLsizei                                             GetBinaryLength(void);
+    uint32_t                                            WarmUpVkPipelines(void);
+    bool                                                WarmUpVkPipeline(const vulkanAPI::PipelineWarmer::StateRecord_t &record);
 
     uint32_t                                            GetNumberOfActiveUniforms(void)             const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetLiveUniforms(); }
     int                                                 GetUniformLocation(const char *name)        const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetUniformLocation(name); }
@@ -131,32 +270,66 @@ public:
     uint32_t                                            GetStageCount(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mStageCount; }
     VkShaderStageFlagBits                               GetShaderStage(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mVkShaderStages[0]; }
     VkShaderModule                                      GetShaderModule(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mVkShaderModules[0]; }
+    uint64_t                                            GetShaderSpirvHash(void)                    const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderSPVhash; }
     VkShaderModule                                      GetVertexShaderModule(void)                 const   { FUN_ENTRY(GL_LOG_TRACE); return mVkShaderModules[0]; }
     VkShaderModule                                      GetFragmentShaderModule(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return mVkShaderModules[1]; }
 
     Shader                                             *GetVertexShader(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mShaders[0]; }
     Shader                                             *GetFragmentShader(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mShaders[1]; }
+    Shader                                             *GetComputeShader(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mComputeShader; }
+    const std::vector<uint32_t>                        &GetStorageBlocks(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mStorageBlocks; }
+    const std::vector<std::string>                     &GetTransformFeedbackVaryings(void)          const   { FUN_ENTRY(GL_LOG_TRACE); return mLinkedTransformFeedbackVaryings; }
+    GLenum                                              GetTransformFeedbackBufferMode(void)        const   { FUN_ENTRY(GL_LOG_TRACE); return mLinkedTransformFeedbackBufferMode; }
+    uint32_t                                            GetTransformFeedbackBufferCount(void)       const   { FUN_ENTRY(GL_LOG_TRACE); return mLinkedTransformFeedbackBufferMode == GL_SEPARATE_ATTRIBS ?
+                                                                                                                                          static_cast<uint32_t>(mLinkedTransformFeedbackVaryings.size()) : HasTransformFeedback() ? 1 : 0; }
+    uint32_t                                            GetTransformFeedbackStride(uint32_t buffer) const   { FUN_ENTRY(GL_LOG_TRACE); return mTransformFeedbackStrides[buffer]; }
+    size_t                                              GetTransformFeedbackVaryingMaxLen(void)     const;
+    uint32_t                                            GetStorageBlockBinding(uint32_t block)      const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetUniformBlockBinding(block); }
+    uint32_t                                            GetUniformBufferBlockCount(void)            const   { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mUniformBufferBlocks.size()); }
+    uint32_t                                            GetUniformBufferBlock(uint32_t index)       const   { FUN_ENTRY(GL_LOG_TRACE); return mUniformBufferBlocks[index]; }
+    GLuint                                              GetUniformBufferBlockIndex(const char *name) const;
+    size_t                                              GetUniformBufferBlockSize(uint32_t index)   const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetUniformBlockSize(mUniformBufferBlocks[index]); }
+    GLuint                                              GetUniformBufferBinding(uint32_t index)     const   { FUN_ENTRY(GL_LOG_TRACE); return mUniformBufferBindings[index]; }
+    bool                                                IsStorageBlockReadOnly(uint32_t block)      const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.IsUniformBlockReadOnly(block); }
     size_t                                              GetActiveUniformMaxLen(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetActiveUniformMaxLen(); }
     size_t                                              GetActiveAttribMaxLen(void)                 const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetActiveAttribMaxLen(); }
     VkPipelineVertexInputStateCreateInfo               *GetVkPipelineVertexInput(void)                      { FUN_ENTRY(GL_LOG_TRACE); return &mVkPipelineVertexInput; }
     VkPipelineLayout                                    GetVkPipelineLayout(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mVkPipelineLayout; }
+    CacheManager                                       *GetCacheManager(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mCacheManager; }
     int                                                 GetStagesIDs(uint32_t index)                const   { FUN_ENTRY(GL_LOG_TRACE); return mStagesIDs[index]; }
     const VkDescriptorSet                              *GetVkDescSet(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return &mVkDescSet; }
+    uint32_t                                            GetVkDynamicOffsetCount(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mVkDynamicOffsets.size()); }
+    const uint32_t                                     *GetVkDynamicOffsets(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mVkDynamicOffsets.data(); }
+    const VkPushConstantRange                          *GetVkPushConstantRange(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return &mVkPushConstantRange; }
+    const uint8_t                                      *GetPushConstantData(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return UsesBindlessTextures() ? reinterpret_cast<const uint8_t *>(mBindlessTextureIndices.data()) :
+                                                                                                                                          mShaderResourceInterface.GetUniformBlockClientData(mShaderResourceInterface.GetPushConstantBlock()); }
+    const VkSpecializationInfo                         *GetVkSpecializationInfo(void)               const   { FUN_ENTRY(GL_LOG_TRACE); return mVkSpecializationMapEntries.empty() ? nullptr : &mVkSpecializationInfo; }
     uint32_t                                            GetActiveVertexVkBuffersCount(void)         const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkBuffersCount; }
     const VkBuffer                                     *GetActiveVertexVkBuffers(void)              const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkBuffers; }
+    const VkDeviceSize                                 *GetActiveVertexVkBufferOffsets(void)        const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkBufferOffsets; }
+    const VkDeviceSize                                 *GetActiveVertexVkBufferStrides(void)        const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveVertexVkBufferStrides; }
     VkBuffer                                            GetActiveIndexVkBuffer(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveIndexVkBuffer; }
+    VkIndexType                                         GetActiveIndexVkType(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return mActiveIndexVkType; }
 
     void                                                SetVkContext(const vulkanAPI::vkContext_t *vkContext) { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; mPipelineCache->SetContext(mVkContext);}
     void                                                SetShaderCompiler(ShaderCompiler* shaderCompiler)   { FUN_ENTRY(GL_LOG_TRACE); assert(shaderCompiler != nullptr); mShaderCompiler = shaderCompiler; }
     void                                                SetStagesIDs(uint32_t index, uint32_t id)           { FUN_ENTRY(GL_LOG_TRACE); mStagesIDs[index] = id; }
 
     void                                                SetCustomAttribsLayout(const char *name, int index) { FUN_ENTRY(GL_LOG_TRACE); mShaderResourceInterface.SetCustomAttribsLayout(name, index); }
+    void                                                SetTransformFeedbackVaryings(const std::vector<std::string> &varyings, GLenum bufferMode) { FUN_ENTRY(GL_LOG_TRACE); mTransformFeedbackVaryings   = varyings;
+                                                                                                                                                mTransformFeedbackBufferMode = bufferMode; }
     void                                                SetUniformData(uint32_t location, size_t size, const void *ptr);
+    void                                                SetUniformColumns(uint32_t location, uint32_t count, uint32_t columns, uint32_t rows, bool transpose, const float *ptr);
     void                                                GetUniformData(uint32_t location, size_t size, void *ptr) const;
     void                                                SetUniformSampler(uint32_t location, int count, const int *textureUnit);
     void                                                SetCacheManager(CacheManager *cacheManager);
     void                                                UpdateDescriptorSet(void);
+    void                                                SetBufferBlockDescriptor(uint32_t block, const VkDescriptorBufferInfo &info);
+    void                                                SetUniformBufferBinding(uint32_t index, GLuint binding)   { FUN_ENTRY(GL_LOG_TRACE); mUniformBufferBindings[index] = binding; }
+    VkPipeline                                          GetVkComputePipeline(void);
     void                                                UpdateBuiltInUniformData(float minDepthRange, float maxDepthRange);
+    void                                                PushConstants(const VkCommandBuffer *cmdBuffer) const;
+    bool                                                UpdateSpecializationData(uint32_t preRotation);
 
     uint32_t                                            GetNumberOfActiveAttributes(void) const;
     const
@@ -169,9 +342,20 @@ public:
 
     bool                                                HasVertexShader(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return (bool)mShaders[0]; }
     bool                                                HasFragmentShader(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return (bool)mShaders[1]; }
+    bool                                                HasComputeShader(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return (bool)mComputeShader; }
+    /// linked from a compute shader, such a program is dispatched and never drawn with
+    bool                                                IsCompute(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mIsCompute; }
+    bool                                                HasTransformFeedback(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return !mLinkedTransformFeedbackVaryings.empty(); }
     bool                                                HasStages(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mStageCount; }
+    bool                                                HasPushConstants(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mVkPushConstantRange.size; }
+    bool                                                UsesBindlessTextures(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return !mBindlessSamplerUniforms.empty(); }
+    bool                                                UsesFramebufferFetch(void)                  const   { FUN_ENTRY(GL_LOG_TRACE); return mShaderResourceInterface.GetInputAttachmentBlock() != GLOVE_INVALID_OFFSET; }
+    bool                                                HasDescriptorSet(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return !mVkDescriptorWrites.empty(); }
+    bool                                                HasUniformData(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return HasDescriptorSet() || HasPushConstants(); }
     bool                                                HasStagesUpdated(int stageIDs[2])           const   { FUN_ENTRY(GL_LOG_TRACE); return (stageIDs[0] != GetStagesIDs(0) || stageIDs[1] != GetStagesIDs(1)) ? true : false; }
     bool                                                IsLinked(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mLinked; }
+    bool                                                HasLinkJob(void)                            const   { FUN_ENTRY(GL_LOG_TRACE); return (bool)mLinkJob; }
+    bool                                                IsLinkPending(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mLinkJob && !TaskQueue::IsDone(mLinkJob->done); }
     bool                                                IsPrecompiled(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mIsPrecompiled; }
     bool                                                IsValidated(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mValidated; }
 };
@@ -110,6 +110,20 @@ ShaderReflection::Serialize(void *binary) const
         rawDataPtr += sizeof(uint32_t);
         *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isOpaque;
         rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isPushConstant;
+        rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isSpecConstant;
+        rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isBindless;
+        rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isInputAttachment;
+        rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isStorageBuffer;
+        rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isReadOnly;
+        rawDataPtr += sizeof(bool);
+        *rawDataPtr = mReflectionData.mUniformBlockReflection[i].isUniformBuffer;
+        rawDataPtr += sizeof(bool);
     }
 
     return sizeof(reflectionData);
@@ -184,6 +198,20 @@ ShaderReflection::Deserialize(const void *binary)
         rawDataPtr += sizeof(uint32_t);
         mReflectionData.mUniformBlockReflection[i].isOpaque = *rawDataPtr;
         rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isPushConstant = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isSpecConstant = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isBindless = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isInputAttachment = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isStorageBuffer = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isReadOnly = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
+        mReflectionData.mUniformBlockReflection[i].isUniformBuffer = *rawDataPtr;
+        rawDataPtr += sizeof(bool);
     }
 
     return sizeof(reflectionData);
@@ -204,7 +232,11 @@ ShaderReflection::Print() const
     for(uint32_t i = 0; i < mReflectionData.mLiveUniformBlocks; ++i) {
         printf("%s , blockSize: %zu)\n", mReflectionData.mUniformBlockReflection[i].glslBlockName, mReflectionData.mUniformBlockReflection[i].blockSize);
         printf("blockStage: %u\n", mReflectionData.mUniformBlockReflection[i].blockStage);
-        printf("binding: %u, isOpaque: %u\n", mReflectionData.mUniformBlockReflection[i].binding, mReflectionData.mUniformBlockReflection[i].isOpaque);
+        printf("binding: %u, isOpaque: %u, isPushConstant: %u, isSpecConstant: %u, isBindless: %u, isInputAttachment: %u\n", mReflectionData.mUniformBlockReflection[i].binding, mReflectionData.mUniformBlockReflection[i].isOpaque,
+                                                                                                       mReflectionData.mUniformBlockReflection[i].isPushConstant, mReflectionData.mUniformBlockReflection[i].isSpecConstant,
+                                                                                                       mReflectionData.mUniformBlockReflection[i].isBindless, mReflectionData.mUniformBlockReflection[i].isInputAttachment);
+        printf("isStorageBuffer: %u, isReadOnly: %u, isUniformBuffer: %u\n", mReflectionData.mUniformBlockReflection[i].isStorageBuffer, mReflectionData.mUniformBlockReflection[i].isReadOnly,
+                                                                             mReflectionData.mUniformBlockReflection[i].isUniformBuffer);
     }
 
     printf("\nGL_ACTIVE_UNIFORMS: %d\n", mReflectionData.mLiveUniforms);
@@ -60,6 +60,13 @@ private:
         size_t        blockSize;
         shader_type_t blockStage;
         bool          isOpaque;
+        bool          isPushConstant;
+        bool          isSpecConstant;
+        bool          isBindless;
+        bool          isInputAttachment;
+        bool          isStorageBuffer;
+        bool          isReadOnly;
+        bool          isUniformBuffer;
     } uniformBlock;
 
     typedef struct {
@@ -106,6 +113,13 @@ public:
     inline size_t        GetUniformBlockBlockSize(uint32_t index)                      const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].blockSize; }
     inline shader_type_t GetUniformBlockBlockStage(uint32_t index)                     const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].blockStage; }
     inline bool          GetUniformBlockOpaque(uint32_t index)                         const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isOpaque; }
+    inline bool          GetUniformBlockPushConstant(uint32_t index)                   const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isPushConstant; }
+    inline bool          GetUniformBlockSpecConstant(uint32_t index)                   const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isSpecConstant; }
+    inline bool          GetUniformBlockBindless(uint32_t index)                       const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isBindless; }
+    inline bool          GetUniformBlockInputAttachment(uint32_t index)                const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isInputAttachment; }
+    inline bool          GetUniformBlockStorageBuffer(uint32_t index)                  const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isStorageBuffer; }
+    inline bool          GetUniformBlockReadOnly(uint32_t index)                       const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isReadOnly; }
+    inline bool          GetUniformBlockUniformBuffer(uint32_t index)                  const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionData.mUniformBlockReflection[index].isUniformBuffer; }
 
 /// Set Functions 
     inline void          SetLiveAttributes(uint32_t LiveAttributes)                          { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mLiveAttributes = LiveAttributes; }
@@ -128,6 +142,13 @@ public:
     inline void          SetUniformBlockBlockSize(size_t blockSize, uint32_t index)          { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].blockSize = blockSize; }
     inline void          SetUniformBlockBlockStage(shader_type_t blockStage, uint32_t index) { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].blockStage = blockStage; }
     inline void          SetUniformBlockOpaque(bool opaque, uint32_t index)                  { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isOpaque = opaque; }
+    inline void          SetUniformBlockPushConstant(bool pushConstant, uint32_t index)      { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isPushConstant = pushConstant; }
+    inline void          SetUniformBlockSpecConstant(bool specConstant, uint32_t index)      { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isSpecConstant = specConstant; }
+    inline void          SetUniformBlockBindless(bool bindless, uint32_t index)              { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isBindless = bindless; }
+    inline void          SetUniformBlockInputAttachment(bool input, uint32_t index)          { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isInputAttachment = input; }
+    inline void          SetUniformBlockStorageBuffer(bool storage, uint32_t index)          { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isStorageBuffer = storage; }
+    inline void          SetUniformBlockReadOnly(bool readOnly, uint32_t index)              { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isReadOnly = readOnly; }
+    inline void          SetUniformBlockUniformBuffer(bool uniform, uint32_t index)          { FUN_ENTRY(GL_LOG_TRACE); mReflectionData.mUniformBlockReflection[index].isUniformBuffer = uniform; }
 };
 
 #endif //__SHADERREFLECTION_H__
@@ -34,7 +34,9 @@
 
 ShaderResourceInterface::ShaderResourceInterface()
 : mLiveAttributes(0), mLiveUniforms(0), mLiveUniformBlocks(0),
-  mActiveAttributeMaxLength(0), mActiveUniformMaxLength(0), mReflectionSize(0), mCacheManager(nullptr)
+  mActiveAttributeMaxLength(0), mActiveUniformMaxLength(0), mReflectionSize(0), mPushConstantBlock(GLOVE_INVALID_OFFSET),
+  mInputAttachmentBlock(GLOVE_INVALID_OFFSET),
+  mUniformBlockDataDirty(true), mUniformRingSerial(0), mCacheManager(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -58,6 +60,32 @@ ShaderResourceInterface::Reset(void)
     mAttributeInterface.clear();
     mUniformInterface.clear();
     mUniformBlockInterface.clear();
+    mAttributeNameLocations.clear();
+    mUniformNameLocations.clear();
+
+    mUniformClientData.clear();
+    mUniformClientOffsets.clear();
+    mUniformLocations.clear();
+    mUniformBlockDataInterface.clear();
+    mPushConstantBlock = GLOVE_INVALID_OFFSET;
+    mInputAttachmentBlock = GLOVE_INVALID_OFFSET;
+    mUniformBlockDataDirty = true;
+}
+
+void
+ShaderResourceInterface::SetCacheManager(CacheManager *cacheManager)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the serials of the blocks refer to the uniform ring of the previous context
+    if(mCacheManager != cacheManager) {
+        for(auto &blockData : mUniformBlockDataInterface) {
+            blockData.clientDataDirty = true;
+        }
+        mUniformBlockDataDirty = true;
+    }
+
+    mCacheManager = cacheManager;
 }
 
 void
@@ -95,66 +123,113 @@ ShaderResourceInterface::CreateInterface(void)
                                             mShaderReflection->GetUniformBlockBinding(i),
                                             mShaderReflection->GetUniformBlockBlockSize(i),
                                             mShaderReflection->GetUniformBlockBlockStage(i),
-                                            mShaderReflection->GetUniformBlockOpaque(i));
+                                            mShaderReflection->GetUniformBlockOpaque(i),
+                                            mShaderReflection->GetUniformBlockPushConstant(i),
+                                            mShaderReflection->GetUniformBlockSpecConstant(i),
+                                            mShaderReflection->GetUniformBlockBindless(i),
+                                            mShaderReflection->GetUniformBlockInputAttachment(i),
+                                            mShaderReflection->GetUniformBlockStorageBuffer(i),
+                                            mShaderReflection->GetUniformBlockReadOnly(i),
+                                            mShaderReflection->GetUniformBlockUniformBuffer(i));
+
+        if(mShaderReflection->GetUniformBlockPushConstant(i)) {
+            mPushConstantBlock = i;
+        }
+        if(mShaderReflection->GetUniformBlockInputAttachment(i)) {
+            mInputAttachmentBlock = i;
+        }
     }
+
+    CreateNameLocationMaps();
 }
 
 void
-ShaderResourceInterface::AllocateUniformClientData(void)
+ShaderResourceInterface::CreateNameLocationMaps(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(auto& uni : mUniformInterface) {
-        size_t   size = uni.arraySize * GlslTypeToSize(uni.type);
-        uint8_t* data = new uint8_t[size];
-        memset(static_cast<void *>(data), 0, size);
+    mAttributeNameLocations.reserve(mAttributeInterface.size());
+    for(const auto &attrib : mAttributeInterface) {
+        mAttributeNameLocations.emplace(attrib.name, static_cast<int>(attrib.location));
+    }
 
-        mUniformDataInterface.insert(make_pair(uni.name, uniformData()));
-        map<std::string, uniformData>::iterator it = mUniformDataInterface.find(uni.name);
-        it->second.pClientData = data;
+    /// "name" and "name[i]" for each element, struct members being uniforms of their own ("name[i].field")
+    size_t names = 0;
+    for(const auto &uni : mUniformInterface) {
+        names += 1 + uni.arraySize;
+    }
+    mUniformNameLocations.reserve(names);
+    for(const auto &uni : mUniformInterface) {
+        mUniformNameLocations.emplace(uni.name, static_cast<int>(uni.location));
+        for(int32_t i = 0; i < uni.arraySize; ++i) {
+            mUniformNameLocations.emplace(uni.name + "[" + to_string(i) + "]", static_cast<int>(uni.location + i));
+        }
     }
 }
 
-bool
-ShaderResourceInterface::AllocateUniformBufferObjects(const vulkanAPI::vkContext_t *vkContext)
+void
+ShaderResourceInterface::AllocateUniformClientData(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(auto &uniBlock : mUniformBlockInterface) {
-        if(!uniBlock.isOpaque) {
+    size_t   dataSize      = 0;
+    uint32_t locationCount = 0;
+    mUniformClientOffsets.resize(mUniformInterface.size());
+    for(uint32_t i = 0; i < mUniformInterface.size(); ++i) {
+        const uniform &uni = mUniformInterface[i];
 
-            mUniformBlockDataInterface.insert(make_pair(uniBlock.name, uniformBlockData()));
-            map<std::string, uniformBlockData>::iterator it = mUniformBlockDataInterface.find(uniBlock.name);
+        mUniformClientOffsets[i] = dataSize;
+        dataSize     += uni.arraySize * GlslTypeToSize(uni.type);
+        locationCount = std::max(locationCount, uni.location + uni.arraySize);
+    }
 
-            it->second.pBufferObject = new UniformBufferObject(vkContext);
-            it->second.pBufferObject->Allocate(uniBlock.memorySize, nullptr);
+    mUniformClientData.assign(dataSize, 0);
+
+    mUniformLocations.assign(locationCount, uniformLocation());
+    for(uint32_t i = 0; i < mUniformInterface.size(); ++i) {
+        const uniform &uni = mUniformInterface[i];
+
+        // uniforms outside of a block hold client-side state only (e.g., sampler units)
+        const bool     inBlock = uni.index < mUniformBlockInterface.size() && !mUniformBlockInterface[uni.index].isOpaque;
+        const uint32_t size    = static_cast<uint32_t>(GlslTypeToSize(uni.type));
+        const uint32_t stride  = static_cast<uint32_t>(GlslTypeToAllignment(uni.type));
+
+        for(int32_t j = 0; j < uni.arraySize; ++j) {
+            uniformLocation &loc = mUniformLocations[uni.location + j];
+            loc.index        = i;
+            loc.block        = inBlock ? uni.index : GLOVE_INVALID_OFFSET;
+            loc.clientOffset = mUniformClientOffsets[i] + j * size;
+            loc.blockOffset  = uni.offset + j * stride;
+            loc.size         = size;
+            loc.stride       = stride;
+            loc.elements     = static_cast<uint32_t>(uni.arraySize - j);
         }
     }
-
-    return true;
 }
 
-UniformBufferObject *
-ShaderResourceInterface::GetUniformBufferObject(uint32_t index) const
+void
+ShaderResourceInterface::AllocateUniformBlockClientData(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    map<std::string, uniformBlockData>::const_iterator itBlock = mUniformBlockDataInterface.find(mUniformBlockInterface[index].name);
-    return itBlock->second.pBufferObject;
+    mUniformBlockDataInterface.clear();
+    mUniformBlockDataInterface.resize(mUniformBlockInterface.size());
+
+    for(uint32_t i = 0; i < mUniformBlockInterface.size(); ++i) {
+        if(!mUniformBlockInterface[i].isOpaque && !IsUniformBlockApplicationBuffer(i)) {
+            mUniformBlockDataInterface[i].clientData.assign(mUniformBlockInterface[i].memorySize, 0);
+            mUniformBlockDataInterface[i].clientDataDirty = true;
+        }
+    }
+    mUniformBlockDataDirty = true;
 }
 
-const ShaderResourceInterface::uniform *
-ShaderResourceInterface::GetUniformAtLocation(uint32_t loc) const
+uint32_t
+ShaderResourceInterface::GetUniformBlockDynamicOffset(uint32_t index) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(const auto &uniform : mUniformInterface) {
-        if(loc >= (uint32_t)uniform.location && loc < (uint32_t)(uniform.location + uniform.arraySize)) {
-            return &uniform;
-        }
-    }
-
-    return nullptr;
+    return mUniformBlockDataInterface[index].dynamicOffset;
 }
 
 int
@@ -162,31 +237,9 @@ ShaderResourceInterface::GetUniformLocation(const char *name) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(name[strlen(name) - 1] != ']') {
-        for(auto &uniIt : mUniformInterface) {
-            if(!strcmp(uniIt.name.c_str(), name)) {
-                return uniIt.location;
-            }
-        }
-    } else {
-        /// Adjust location according to the specific array index requested
-        string requestedName = string(name);
-        size_t leftBracketPos = requestedName.find_last_of("[");
-        int index = std::stoi(requestedName.substr(leftBracketPos + 1));
-
-        string ptrName = requestedName.substr(0, leftBracketPos);
-        for(auto &uniIt : mUniformInterface) {
-            if(!ptrName.compare(uniIt.name)) {
-                if(index >= uniIt.arraySize) {
-                    return -1;
-                } else {
-                    return uniIt.location + index;
-                }
-            }
-        }
-    }
+    auto it = mUniformNameLocations.find(name);
 
-    return -1;
+    return it != mUniformNameLocations.end() ? it->second : -1;
 }
 
 void
@@ -194,12 +247,7 @@ ShaderResourceInterface::GetUniformClientData(uint32_t location, size_t size, vo
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    const ShaderResourceInterface::uniform *uniform = GetUniformAtLocation(location);
-
-    size_t arrayOffset = (location - uniform->location) * GlslTypeToSize(uniform->type);
-
-    map<std::string, uniformData>::const_iterator it = mUniformDataInterface.find(uniform->name);
-    memcpy(ptr, static_cast<const void *>(it->second.pClientData + arrayOffset), size);
+    memcpy(ptr, static_cast<const void *>(mUniformClientData.data() + mUniformLocations[location].clientOffset), size);
 }
 
 const uint8_t*
@@ -207,8 +255,7 @@ ShaderResourceInterface::GetUniformClientData(uint32_t index) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    map<std::string, uniformData>::const_iterator it = mUniformDataInterface.find(mUniformInterface[index].name);
-    return it->second.pClientData;
+    return mUniformClientData.data() + mUniformClientOffsets[index];
 }
 
 int
@@ -216,13 +263,9 @@ ShaderResourceInterface::GetAttributeLocation(const char *name) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    for(auto &it : mAttributeInterface) {
-        if(!strcmp(it.name.c_str(), name)) {
-            return it.location;
-        }
-    }
+    auto it = mAttributeNameLocations.find(name);
 
-    return -1;
+    return it != mAttributeNameLocations.end() ? it->second : -1;
 }
 
 void
@@ -258,20 +301,75 @@ ShaderResourceInterface::SetUniformClientData(uint32_t location, size_t size, co
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    ShaderResourceInterface::uniform *uniform = nullptr;
-    for(auto &uni: mUniformInterface) {
-        if(location >= (uint32_t)uni.location && location < (uint32_t)(uni.location + uni.arraySize)) {
-            uniform = &uni;
-            break;
-        }
+    const uniformLocation &loc = mUniformLocations[location];
+
+    // writes never go beyond the end of the array
+    size = std::min(size, static_cast<size_t>(loc.elements) * loc.size);
+    memcpy(static_cast<void *>(mUniformClientData.data() + loc.clientOffset), ptr, size);
+
+    if(loc.block == GLOVE_INVALID_OFFSET) {
+        return;
     }
 
-    size_t arrayOffset = (location - uniform->location) * GlslTypeToSize(uniform->type);
+    uniformBlockData &blockData = mUniformBlockDataInterface[loc.block];
+    blockData.clientDataDirty = true;
+    mUniformBlockDataDirty    = true;
+
+    uint8_t       *dst = blockData.clientData.data() + loc.blockOffset;
+    const uint8_t *src = static_cast<const uint8_t *>(ptr);
+
+    // tightly packed types are laid out in the block as in client memory
+    if(loc.size == loc.stride) {
+        memcpy(static_cast<void *>(dst), src, size);
+        return;
+    }
+
+    // otherwise each array element goes to its aligned place in the block
+    for(size_t written = 0; written < size; written += loc.size) {
+        memcpy(static_cast<void *>(dst), src + written, std::min(static_cast<size_t>(loc.size), size - written));
+        dst += loc.stride;
+    }
+}
+
+void
+ShaderResourceInterface::SetUniformClientColumns(uint32_t location, uint32_t count, uint32_t columns, uint32_t rows, bool transpose, const float *ptr)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const uniformLocation &loc = mUniformLocations[location];
+    const size_t packedSize    = columns * rows * sizeof(float);
+    const size_t paddedSize    = columns * 4 * sizeof(float);
 
-    map<std::string, uniformData>::iterator it = mUniformDataInterface.find(uniform->name);
-    memcpy(static_cast<void *>(it->second.pClientData + arrayOffset), ptr, size);
+    // writes never go beyond the end of the array
+    count = std::min(count, loc.elements);
+
+    // the client data holds matrices with padded columns and vectors tightly packed
+    uint8_t *clientDst = mUniformClientData.data() + loc.clientOffset;
+    if(loc.size == packedSize && !transpose) {
+        memcpy(static_cast<void *>(clientDst), ptr, count * packedSize);
+    } else {
+        assert(loc.size == paddedSize);
+        GlPackUniformColumns(ptr, count, columns, rows, transpose, clientDst, loc.size);
+    }
 
-    it->second.clientDataDirty = true;
+    if(loc.block == GLOVE_INVALID_OFFSET) {
+        return;
+    }
+
+    uniformBlockData &blockData = mUniformBlockDataInterface[loc.block];
+    blockData.clientDataDirty = true;
+    mUniformBlockDataDirty    = true;
+
+    // the padding of the columns is only written where the block owns it, that is within matrices and
+    // arrays, the member after a single vector may begin right after its last component
+    uint8_t *blockDst = blockData.clientData.data() + loc.blockOffset;
+    if(loc.stride == packedSize && !transpose) {
+        memcpy(static_cast<void *>(blockDst), ptr, count * packedSize);
+    } else if(columns > 1 || loc.elements > 1) {
+        GlPackUniformColumns(ptr, count, columns, rows, transpose, blockDst, loc.stride);
+    } else {
+        memcpy(static_cast<void *>(blockDst), ptr, packedSize);
+    }
 }
 
 void
@@ -281,16 +379,13 @@ ShaderResourceInterface::SetUniformSampler(uint32_t location, int count, const i
 
     while(count--) {
 
-        const ShaderResourceInterface::uniform *uniformSampler = GetUniformAtLocation(location);
-        map<std::string, uniformData>::iterator it = mUniformDataInterface.find(uniformSampler->name);
-
-        size_t arrayOffset = (location - uniformSampler->location) * GlslTypeToSize(uniformSampler->type);
+        const size_t arrayOffset = mUniformLocations[location].clientOffset;
 
         /// Make sure textureUnit is inside [0, GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS)
         if(*textureUnit >= GL_TEXTURE0 && *textureUnit < GL_TEXTURE0 + GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS) {
-            *((glsl_sampler_t *)(it->second.pClientData + arrayOffset)) = (glsl_sampler_t)(*textureUnit - GL_TEXTURE0);
+            *((glsl_sampler_t *)(mUniformClientData.data() + arrayOffset)) = (glsl_sampler_t)(*textureUnit - GL_TEXTURE0);
         } else {
-            *((glsl_sampler_t *)(it->second.pClientData + arrayOffset)) = (glsl_sampler_t)(*textureUnit);
+            *((glsl_sampler_t *)(mUniformClientData.data() + arrayOffset)) = (glsl_sampler_t)(*textureUnit);
         }
 
         ++textureUnit;
@@ -348,85 +443,37 @@ ShaderResourceInterface::UpdateAttributeInterface(void)
 }
 
 bool
-ShaderResourceInterface::UpdateUniformBufferData(const vulkanAPI::vkContext_t *vkContext, bool *allocatedNewBufferObject)
+ShaderResourceInterface::WriteUniformBlockData(vulkanAPI::UniformRing *uniformRing)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint32_t blockIndex=0;
-    bool     blockDataDirty;
-
-    struct uniformDirty {
-        size_t       offset;
-        size_t       size;
-        const void * data;
-    };
-
-    for(auto &uniBlock : mUniformBlockInterface) {
+    // a block written into the ring since the last submission can be bound again as is,
+    // unless the ring has been replaced in the meantime, which invalidates every offset
+    uint64_t generation;
+    do {
+        generation = uniformRing->GetGeneration();
 
-        map<std::string, uniformBlockData>::iterator itBlock = mUniformBlockDataInterface.find(uniBlock.name);
-
-        blockDataDirty = false;
-        std::vector<struct uniformDirty> uniformInterfaceDirty;
-        for(auto &uniform : mUniformInterface) {
-
-            // if does not belong to Block
-            if(uniform.index != blockIndex) {
+        for(uint32_t i = 0; i < mUniformBlockInterface.size(); ++i) {
+            if(mUniformBlockInterface[i].isOpaque || IsUniformBlockApplicationBuffer(i) || !IsUniformBlockDescriptor(i)) {
                 continue;
             }
 
-            map<std::string, uniformData>::iterator itUniform = mUniformDataInterface.find(uniform.name);
-
-            // check if is updated
-            if(!itUniform->second.clientDataDirty) {
-               continue;
-            }
-            itUniform->second.clientDataDirty = false;
-
-            blockDataDirty = true;
-            if(IsBuildInUniform(uniform.name)) {
-                blockDataDirty = false;
-            }
-
-            // compute uniform size
-            for (size_t i = 0; i < (size_t)uniform.arraySize; i++) {
-                struct uniformDirty newUniformDirty;
-                newUniformDirty.size   = GlslTypeToSize(uniform.type);
-                newUniformDirty.offset = uniform.offset + i*GlslTypeToAllignment(uniform.type);
-                newUniformDirty.data   = static_cast<const void *>(itUniform->second.pClientData + i*newUniformDirty.size);
-                uniformInterfaceDirty.push_back(newUniformDirty);
-            }
-        }
-
-        if(blockDataDirty) {
-
-            size_t   srcSize = 0;
-            uint8_t *srcData = nullptr;
-
-            if(itBlock->second.pBufferObject && itBlock->second.pBufferObject->GetSize() > 0) {
-                mCacheManager->CacheUBO(itBlock->second.pBufferObject);
-
-                // memcopy data
-                srcSize = itBlock->second.pBufferObject->GetSize();
-                srcData = new uint8_t[srcSize];
-                itBlock->second.pBufferObject->GetData(srcSize, 0, srcData);
-
-                *allocatedNewBufferObject = true;
+            uniformBlockData &blockData = mUniformBlockDataInterface[i];
+            if(!blockData.clientDataDirty && blockData.ringSerial == uniformRing->GetSerial()) {
+                continue;
             }
 
-            itBlock->second.pBufferObject = new UniformBufferObject(vkContext);
-            itBlock->second.pBufferObject->Allocate(uniBlock.memorySize, srcData);
-
-            if(srcSize) {
-                delete[] srcData;
+            if(!uniformRing->Allocate(mUniformBlockInterface[i].memorySize, blockData.clientData.data(), &blockData.dynamicOffset)) {
+                return false;
             }
-        }
 
-        for (auto &u : uniformInterfaceDirty) {
-            itBlock->second.pBufferObject->UpdateData(u.size, u.offset, u.data);
+            blockData.ringSerial      = uniformRing->GetSerial();
+            blockData.clientDataDirty = false;
         }
+    } while(generation != uniformRing->GetGeneration());
 
-        ++blockIndex;
-    }
+    mUniformBlockDataDirty = false;
+    mUniformRingSerial     = uniformRing->GetSerial();
 
     return true;
 }
\ No newline at end of file
@@ -28,6 +28,7 @@
 #include "bufferObject.h"
 #include "utils/cacheManager.h"
 #include <vector>
+#include <unordered_map>
 
 class ShaderResourceInterface {
 public:
@@ -69,43 +70,33 @@ public:
     typedef struct uniform uniform;
     typedef vector<uniform>                 uniformInterface;
 
-    struct uniformData {
-        uint8_t                    *pClientData;
-        bool                        clientDataDirty;
-
-        uniformData()
-         : pClientData(nullptr),
-           clientDataDirty(false)
-        {
-            FUN_ENTRY(GL_LOG_TRACE);
-        }
-
-        ~uniformData()
-        {
-            FUN_ENTRY(GL_LOG_TRACE);
-
-            if(pClientData) {
-                delete[] pClientData;
-                pClientData = nullptr;
-            }
-        }
-    };
-    typedef struct uniformData              uniformData;
-    typedef map<string, uniformData>        uniformDataInterface;
-
     struct uniformBlock {
         string                      name;
         uint32_t                    binding;
         size_t                      memorySize;
         shader_type_t               stage;
         bool                        isOpaque;
-
-        uniformBlock(string n, uint32_t b, size_t m, shader_type_t s, bool o)
+        bool                        isPushConstant;
+        bool                        isSpecConstant;
+        bool                        isBindless;
+        bool                        isInputAttachment;
+        bool                        isStorageBuffer;
+        bool                        isReadOnly;
+        bool                        isUniformBuffer;
+
+        uniformBlock(string n, uint32_t b, size_t m, shader_type_t s, bool o, bool p, bool c, bool bl, bool ia, bool sb, bool ro, bool ub)
          : name(n),
            binding(b),
            memorySize(m),
            stage(s),
-           isOpaque(o)
+           isOpaque(o),
+           isPushConstant(p),
+           isSpecConstant(c),
+           isBindless(bl),
+           isInputAttachment(ia),
+           isStorageBuffer(sb),
+           isReadOnly(ro),
+           isUniformBuffer(ub)
         {
             FUN_ENTRY(GL_LOG_TRACE);
         }
@@ -114,28 +105,48 @@ public:
     typedef vector<uniformBlock>            uniformBlockInterface;
 
     struct uniformBlockData {
-        UniformBufferObject *       pBufferObject;
+        vector<uint8_t>             clientData;
+        bool                        clientDataDirty;
+        uint32_t                    dynamicOffset;
+        uint64_t                    ringSerial;
 
         uniformBlockData()
-         : pBufferObject(nullptr)
+         : clientDataDirty(false),
+           dynamicOffset(0),
+           ringSerial(0)
         {
             FUN_ENTRY(GL_LOG_TRACE);
         }
+    };
+    typedef struct uniformBlockData         uniformBlockData;
+    typedef vector<uniformBlockData>        uniformBlockDataInterface;
 
-        ~uniformBlockData()
+    /// where the array element of a location lives, both in the client data and in the client copy of its block
+    struct uniformLocation {
+        uint32_t                    index;
+        uint32_t                    block;
+        size_t                      clientOffset;
+        size_t                      blockOffset;
+        uint32_t                    size;
+        uint32_t                    stride;
+        uint32_t                    elements;
+
+        uniformLocation()
+         : index(GLOVE_INVALID_OFFSET),
+           block(GLOVE_INVALID_OFFSET),
+           clientOffset(0),
+           blockOffset(0),
+           size(0),
+           stride(0),
+           elements(0)
         {
             FUN_ENTRY(GL_LOG_TRACE);
-
-            if(pBufferObject) {
-                delete pBufferObject;
-                pBufferObject = nullptr;
-            }
         }
     };
-    typedef struct uniformBlockData         uniformBlockData;
-    typedef map<string, uniformBlockData>   uniformBlockDataInterface;
+    typedef struct uniformLocation          uniformLocation;
 
     typedef map<string, uint32_t>           attribsLayout_t;
+    typedef unordered_map<string, int>      nameLocationMap_t;
 
 private:
     uint32_t                                mLiveAttributes;
@@ -151,15 +162,32 @@ private:
     attributeInterface                      mAttributeInterface;
 
     uniformInterface                        mUniformInterface;
-    uniformDataInterface                    mUniformDataInterface;
 
+    /// client data of every uniform, packed one after the other and found through the uniform index,
+    /// each write also goes straight to the client copy of its block through the record of its location
+    vector<uint8_t>                         mUniformClientData;
+    vector<size_t>                          mUniformClientOffsets;
+    vector<uniformLocation>                 mUniformLocations;
+
+    /// indexed as mUniformBlockInterface
     uniformBlockInterface                   mUniformBlockInterface;
     uniformBlockDataInterface               mUniformBlockDataInterface;
+    uint32_t                                mPushConstantBlock;
+    uint32_t                                mInputAttachmentBlock;
+
+    /// no block has been written since they all were, into the ring with this serial
+    bool                                    mUniformBlockDataDirty;
+    uint64_t                                mUniformRingSerial;
+
+    /// every name a location can be queried with, array elements spelled out, filled along with the interface
+    nameLocationMap_t                       mAttributeNameLocations;
+    nameLocationMap_t                       mUniformNameLocations;
 
     attribsLayout_t                         mCustomAttributesLayout;
     CacheManager*                           mCacheManager;
 
     void                                    Reset(void);
+    void                                    CreateNameLocationMaps(void);
 
 public:
     ShaderResourceInterface();
@@ -175,6 +203,7 @@ public:
 
 
     inline uint32_t                         GetReflectionSize(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mReflectionSize; }
+    inline const attribsLayout_t           &GetCustomAttribsLayout(void)           const { FUN_ENTRY(GL_LOG_TRACE); return mCustomAttributesLayout; }
 
     const  string&                          GetAttributeName(int index)            const { FUN_ENTRY(GL_LOG_TRACE); return mAttributeInterface[index].name; }
     int                                     GetAttributeType(int index)            const { FUN_ENTRY(GL_LOG_TRACE); return mAttributeInterface[index].type; }
@@ -191,20 +220,38 @@ public:
                                                                  size_t size,
                                                                  void *ptr)        const;
 	const  uint8_t                         *GetUniformClientData(uint32_t index)   const;
-	UniformBufferObject                    *GetUniformBufferObject(uint32_t index) const;
+           uint32_t                         GetUniformBlockDynamicOffset(uint32_t index) const;
 
 
+    inline const string&                    GetUniformBlockName(uint32_t index)    const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].name; }
     inline uint32_t                         GetUniformBlockBinding(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].binding; }
+    inline size_t                           GetUniformBlockSize(uint32_t index)    const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].memorySize; }
     inline shader_type_t                    GetUniformBlockStage(uint32_t index)   const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].stage; }
     inline bool                             IsUniformBlockOpaque(uint32_t index)   const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isOpaque; }
-
-    const uniform                          *GetUniformAtLocation(uint32_t loc)     const;
+    inline bool                             IsUniformBlockPushConstant(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isPushConstant; }
+    inline uint32_t                         GetPushConstantBlock(void)             const { FUN_ENTRY(GL_LOG_TRACE); return mPushConstantBlock; }
+    inline bool                             IsUniformBlockSpecConstant(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isSpecConstant; }
+    inline bool                             IsUniformBlockBindless(uint32_t index)     const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isBindless; }
+    inline bool                             IsUniformBlockInputAttachment(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isInputAttachment; }
+    inline uint32_t                         GetInputAttachmentBlock(void)          const { FUN_ENTRY(GL_LOG_TRACE); return mInputAttachmentBlock; }
+    /// storage blocks of compute shaders, the buffers bound to GL_SHADER_STORAGE_BUFFER hold their data instead of the client
+    inline bool                             IsUniformBlockStorageBuffer(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isStorageBuffer; }
+    inline bool                             IsUniformBlockReadOnly(uint32_t index)     const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isReadOnly; }
+    /// uniform blocks of compute shaders, read from the buffers bound to GL_UNIFORM_BUFFER instead of the client
+    inline bool                             IsUniformBlockUniformBuffer(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isUniformBuffer; }
+    inline bool                             IsUniformBlockApplicationBuffer(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockInterface[index].isStorageBuffer || mUniformBlockInterface[index].isUniformBuffer; }
+    /// true for the blocks that are given to the shaders through the descriptor set
+    inline bool                             IsUniformBlockDescriptor(uint32_t index)   const { FUN_ENTRY(GL_LOG_TRACE); return !mUniformBlockInterface[index].isPushConstant && !mUniformBlockInterface[index].isSpecConstant &&
+                                                                                                                                   !mUniformBlockInterface[index].isBindless; }
+    inline const uint8_t                   *GetUniformBlockClientData(uint32_t index) const { FUN_ENTRY(GL_LOG_TRACE); return mUniformBlockDataInterface[index].clientData.data(); }
+
+    inline const uniform                   *GetUniformAtLocation(uint32_t loc)     const { FUN_ENTRY(GL_LOG_TRACE); return loc < mUniformLocations.size() && mUniformLocations[loc].index != GLOVE_INVALID_OFFSET ? mUniformInterface.data() + mUniformLocations[loc].index : nullptr; }
     const uniform                          *GetUniform(uint32_t index)             const { FUN_ENTRY(GL_LOG_TRACE); return index < mUniformInterface.size() ? mUniformInterface.data() + index : nullptr; }
 
     const attribute                        *GetVertexAttribute(int index)          const { FUN_ENTRY(GL_LOG_TRACE); return &(*(mAttributeInterface.cbegin() + index)); }
 
 /// Set Functions
-    inline void                             SetCacheManager(CacheManager *cacheManager)          { FUN_ENTRY(GL_LOG_TRACE); mCacheManager     = cacheManager; }
+    void                                    SetCacheManager(CacheManager *cacheManager);
     inline void                             SetReflection(ShaderReflection* reflection)          { FUN_ENTRY(GL_LOG_TRACE); mShaderReflection = reflection; };
     inline void                             SetReflectionSize(void)                              { FUN_ENTRY(GL_LOG_TRACE); mReflectionSize   = mShaderReflection->GetReflectionSize(); }
     inline void                             SetCustomAttribsLayout(const char *name, int index)  { FUN_ENTRY(GL_LOG_TRACE); mCustomAttributesLayout[std::string(name)] = index; }    
@@ -214,6 +261,12 @@ public:
     void                                    SetUniformClientData(uint32_t location,
                                                                  size_t size,
                                                                  const void *ptr);
+    void                                    SetUniformClientColumns(uint32_t location,
+                                                                    uint32_t count,
+                                                                    uint32_t columns,
+                                                                    uint32_t rows,
+                                                                    bool transpose,
+                                                                    const float *ptr);
     void                                    SetUniformSampler(uint32_t location,
                                                        int count,
                                                        const int *textureUnit);
@@ -221,11 +274,12 @@ public:
 /// Allocate Functions
     void                                    CreateInterface(void);
     void                                    AllocateUniformClientData(void);
-	bool                                    AllocateUniformBufferObjects(const vulkanAPI::vkContext_t *vkContext);
+    void                                    AllocateUniformBlockClientData(void);
 
 /// Update Functions    
-    bool                                    UpdateUniformBufferData(const vulkanAPI::vkContext_t *vkContext,
-                                                                    bool *allocatedNewBufferObject);
+    inline bool                             IsUniformBlockDataWritten(const vulkanAPI::UniformRing *uniformRing) const
+                                                                                         { FUN_ENTRY(GL_LOG_TRACE); return !mUniformBlockDataDirty && mUniformRingSerial == uniformRing->GetSerial(); }
+    bool                                    WriteUniformBlockData(vulkanAPI::UniformRing *uniformRing);
     void                                    UpdateAttributeInterface(void);
 
 
@@ -27,25 +27,78 @@
  *
  */
 
+#include <cstring>
+#include <vector>
 #include "texture.h"
 #include "utils/VkToGlConverter.h"
 #include "utils/glUtils.h"
 #include "context/context.h"
+#include "vulkan/capabilityCache.h"
 
 #define NUMBER_OF_MIP_LEVELS(w, h)                      (std::floor(std::log2(std::max((w),(h)))) + 1)
 
 // TODO:: this needs to be further discussed
 int Texture::mDefaultInternalAlignment = 1;
 
+std::atomic<uint64_t> Texture::mGenerationCounter(0);
+
+static bool
+VkImageHasFormatFeatures(const vulkanAPI::vkContext_t *vkContext, const vulkanAPI::Image *image, VkFormatFeatureFlags features)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const VkFormatProperties formatDeviceProps = vkContext->capabilityCache->GetFormatProperties(image->GetFormat());
+
+    const VkFormatFeatureFlags supported = image->GetImageTiling() == VK_IMAGE_TILING_LINEAR ? formatDeviceProps.linearTilingFeatures :
+                                                                                               formatDeviceProps.optimalTilingFeatures;
+    return (supported & features) == features;
+}
+
+/// luminance and alpha texels are kept as given in one and two channel images
+static bool
+VkFormatKeepsLuminanceAlpha(VkFormat format)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(format) {
+    case VK_FORMAT_R8_UNORM:
+    case VK_FORMAT_R8G8_UNORM:
+    case VK_FORMAT_R16_SFLOAT:
+    case VK_FORMAT_R16G16_SFLOAT:
+    case VK_FORMAT_R32_SFLOAT:
+    case VK_FORMAT_R32G32_SFLOAT:   return true;
+    default:                        return false;
+    }
+}
+
+static bool
+EvictIdleTextures(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Context *context = GetCurrentContext();
+    if(!context) {
+        return false;
+    }
+
+    vulkanAPI::CommandBufferManager *commandBufferManager = context->GetVkCommandBufferManager();
+    return context->GetResourceManager()->EvictIdleTextures(context->GetShareGroupSlot(), commandBufferManager) > 0;
+}
+
 Texture::Texture(const vulkanAPI::vkContext_t *vkContext, const VkFlags vkFlags)
-: mVkContext(vkContext),
+: mVkContext(vkContext), mVkMemoryFlags(vkFlags),
 mFormat(GL_INVALID_VALUE), mTarget(GL_INVALID_VALUE), mType(GL_INVALID_VALUE), mInternalFormat(GL_INVALID_VALUE),
-mExplicitType(GL_INVALID_VALUE), mExplicitInternalFormat(GL_INVALID_VALUE),
-mMipLevelsCount(1), mLayersCount(1), mState(nullptr), mDataUpdated(false), mDataNoInvertion(false), mFboColorAttached(false),
-mDepthStencilTexture(nullptr), mDepthStencilTextureRefCount(0u)
+mExplicitType(GL_INVALID_VALUE), mExplicitInternalFormat(GL_INVALID_VALUE), mCompressedFormat(GL_INVALID_VALUE),
+mMipLevelsCount(1), mLayersCount(1), mImmutableLevels(0), mState(nullptr), mDataUpdated(false), mDataNoInvertion(false), mFboColorAttached(false),
+mDepthStencilTexture(nullptr), mDepthStencilTextureRefCount(0u), mColorAttachmentRefCount(0u),
+mGeneration(++mGenerationCounter), mCompletenessGeneration(0u), mCompleted(false), mNPOTAccessCompleted(true), mUploadBatchId(0u), mUploadSlot(GLOVE_UNTRACKED_SHARE_GROUP_SLOT), mUploadRecorded(false), mAllocationPending(false), mUsedUntracked(false), mImported(false), mExported(false), mSurfaceBound(false), mSurfaceUpright(false), mTransientPool(nullptr)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    for(auto &serial : mLastUsedSerials) {
+        serial.store(0, std::memory_order_relaxed);
+    }
+
     mImage     = new vulkanAPI::Image(vkContext);
     mImageView = new vulkanAPI::ImageView(vkContext);
     mMemory    = new vulkanAPI::Memory(vkContext, vkFlags);
@@ -56,11 +109,17 @@ Texture::~Texture()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
+    WaitVkUploads();
+
     delete mSampler;
     delete mImageView;
     delete mImage;
     delete mMemory;
 
+    if(mTransientPool) {
+        mTransientPool->Unregister(this);
+    }
+
     if(mState != nullptr) {
         delete [] mState;
         mState = nullptr;
@@ -80,17 +139,20 @@ Texture::IsNPOT(void)
     return (!ISPOWEROFTWO(state->width) || !ISPOWEROFTWO(state->height));
 }
 
-bool
-Texture::IsNPOTAccessCompleted(void)
+void
+Texture::EvaluateCompleteness(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    return !(IsNPOT() && ((GetMinFilter() != GL_LINEAR         && GetMinFilter() != GL_NEAREST)    ||
-                          (GetWrapS()     != GL_CLAMP_TO_EDGE  || GetWrapT()     != GL_CLAMP_TO_EDGE)));
+    // walked once per change of the levels or parameters, instead of on every bind and draw
+    mCompleted              = EvaluateCompleted();
+    mNPOTAccessCompleted    = !(IsNPOT() && ((GetMinFilter() != GL_LINEAR         && GetMinFilter() != GL_NEAREST)    ||
+                                             (GetWrapS()     != GL_CLAMP_TO_EDGE  || GetWrapT()     != GL_CLAMP_TO_EDGE)));
+    mCompletenessGeneration = mGeneration;
 }
 
 bool
-Texture::IsCompleted(void)
+Texture::EvaluateCompleted(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -112,6 +174,12 @@ Texture::IsCompleted(void)
         return false;
     }
 
+    // immutable textures have all their levels from the start, as many as were asked for
+    if(mImmutableLevels) {
+        mMipLevelsCount = mImmutableLevels;
+        return true;
+    }
+
     GLenum format = state->format;
     GLenum type   = state->type;
     GLint  width  = state->width;
@@ -146,15 +214,82 @@ Texture::IsCompleted(void)
     return true;
 }
 
+void
+Texture::WaitVkUploads(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the image may still be referred to by a pending upload batch
+    if(mImage->GetImage() == VK_NULL_HANDLE || !GetCurrentContext()) {
+        return;
+    }
+
+    // the batches of another context are only known to its own upload manager, the application has
+    // synchronized with that context before it respecifies or deletes the texture here
+    const uint32_t slot = GetCurrentContext()->GetShareGroupSlot();
+    if(!mUploadRecorded || mUploadSlot != slot) {
+        return;
+    }
+
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    if(uploadManager) {
+        uploadManager->WaitVkUploadBatch(mUploadBatchId);
+    }
+}
+
+void
+Texture::RecordUploadBatch(vulkanAPI::UploadManager *uploadManager)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mUploadBatchId  = uploadManager->GetActiveBatchId();
+    mUploadSlot     = GetCurrentContext()->GetShareGroupSlot();
+    mUploadRecorded = true;
+}
+
+bool
+Texture::IsUploadCompleted(uint32_t slot, vulkanAPI::UploadManager *uploadManager)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(!mUploadRecorded) {
+        return true;
+    }
+
+    // whether a batch of another context has completed is not known here
+    return mUploadSlot == slot && slot != GLOVE_UNTRACKED_SHARE_GROUP_SLOT && uploadManager->IsBatchCompleted(mUploadBatchId);
+}
+
+void
+Texture::ReleaseContextSlot(uint32_t slot)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the context has waited for its submissions and uploads, the next one given the slot starts afresh
+    mLastUsedSerials[slot].store(0, std::memory_order_release);
+    if(mUploadSlot == slot) {
+        mUploadRecorded = false;
+    }
+}
+
 void
 Texture::ReleaseVkResources(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    WaitVkUploads();
+
     mSampler->Release();
     mImageView->Release();
     mImage->Release();
     mMemory->Release();
+    if(mTransientPool) {
+        mTransientPool->Unbind(this);
+    }
+
+    // respecified textures get storage of their own again
+    mImported     = false;
+    mSurfaceBound = false;
 }
 
 bool
@@ -162,10 +297,46 @@ Texture::CreateVkImage(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // uploaded textures with a mipmapped minification filter are likely to get
+    // glGenerateMipmap, so their chain is allocated up front instead of migrated later
+    GLint imageMipLevels = mMipLevelsCount;
+    if(!mImmutableLevels && mState && (mState[0][0].data || mState[0][0].onDevice) && GetWidth() > 0 && GetHeight() > 0 && !GlFormatIsCompressed(mFormat) &&
+       mParameters.GetMinFilter() != GL_NEAREST && mParameters.GetMinFilter() != GL_LINEAR) {
+        imageMipLevels = std::max(imageMipLevels, static_cast<GLint>(NUMBER_OF_MIP_LEVELS(GetWidth(), GetHeight())));
+    }
+
+    // block compressed images can only be sampled and copied, and get the default usage back once respecified
+    const VkImageUsageFlagBits compressedUsage = static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    // depth textures are rendered to and sampled in place, and get the color usage back once respecified
+    const VkImageUsageFlagBits depthUsage      = static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    if(GlFormatIsCompressed(mFormat)) {
+        mImage->SetImageUsage(compressedUsage);
+        mImage->SetImageTiling(VK_IMAGE_TILING_OPTIMAL);
+    } else if(IsDepthTexture()) {
+        mImage->SetImageUsage(depthUsage);
+        mImage->SetImageTiling();
+    } else if(mImage->GetImageUsage() == compressedUsage) {
+        mImage->SetImageUsage(VK_IMAGE_USAGE_FLAG_BITS_MAX_ENUM);
+        mImage->SetImageTiling();
+    } else if(mImage->GetImageUsage() == depthUsage) {
+        mImage->SetImageUsage(static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+                                                                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+        mImage->SetImageTiling();
+    }
+
+    // importers of the dma-buf read a single linear level
+    if(mExported) {
+        imageMipLevels = 1;
+        mImage->SetImageTiling(VK_IMAGE_TILING_LINEAR);
+    }
+
     mImage->SetWidth(GetWidth());
     mImage->SetHeight(GetHeight());
-    mImage->SetMipLevels(mMipLevelsCount);
+    mImage->SetMipLevels(imageMipLevels);
     mImage->SetImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+    mImage->SetExportable(mExported);
+    // sampled textures are written by the host where the format allows it, depth ones are rendered to
+    mImage->SetHostTransfer(!IsDepthTexture() && !mTransientPool && !mExported);
 
     mSampler->SetMaxLod((mParameters.GetMinFilter() == GL_NEAREST || mParameters.GetMinFilter() == GL_LINEAR) ? 0.25f : static_cast<float>(mMipLevelsCount-1));
     return mImage->Create();
@@ -176,11 +347,31 @@ Texture::AllocateVkMemory(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mTransientPool) {
+        return mTransientPool->Bind(this, mImage->GetImage());
+    }
+
+    if(mExported) {
+        return mMemory->Export(mImage->GetImage());
+    }
+
     mMemory->GetImageMemoryRequirements(mImage->GetImage());
 
     return mMemory->Create() && mMemory->BindImageMemory(mImage->GetImage());
 }
 
+bool
+Texture::CreateVkImageView(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // images of every other format are sampled as they are, imported ones included
+    mImageView->SetComponentMapping(GlInternalFormatToVkComponentMapping(VkFormatKeepsLuminanceAlpha(mImage->GetFormat()) ?
+                                                                         mInternalFormat : GL_RGBA));
+
+    return mImageView->Create(mImage);
+}
+
 bool
 Texture::CreateVkTexture(void)
 {
@@ -193,8 +384,12 @@ Texture::CreateVkTexture(void)
     }
 
     if(!AllocateVkMemory()) {
-        mImage->Release();
-        return false;
+        // under memory pressure, textures that have been idle for a while give their memory back
+        mMemory->Release();
+        if(!EvictIdleTextures() || !AllocateVkMemory()) {
+            mImage->Release();
+            return false;
+        }
     }
 
     if(!CreateVkImageView()) {
@@ -203,13 +398,31 @@ Texture::CreateVkTexture(void)
         return false;
     }
 
-    PrepareVkImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+    // images the host writes into are transitioned by it, with no command at all
+    if(mImage->IsHostTransfer() && mImage->ModifyImageLayoutOnHost(VK_IMAGE_LAYOUT_GENERAL)) {
+        BumpGeneration();
+        return true;
+    }
+
+    // the initial transition is batched together with the uploads that follow it
+    assert(GetCurrentContext());
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    VkCommandBuffer *uploadCmdBuffer = uploadManager->BeginVkUploadCommandBuffer();
+    if(!uploadCmdBuffer) {
+        return false;
+    }
+
+    PrepareVkImageLayout(uploadCmdBuffer, VK_IMAGE_LAYOUT_GENERAL);
+    RecordUploadBatch(uploadManager);
+
+    // image and view are new
+    BumpGeneration();
 
     return true;
 }
 
-bool
-Texture::Allocate(void)
+void
+Texture::UpdateBaseLevelProperties(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -221,22 +434,86 @@ Texture::Allocate(void)
     SetType  (state->type);
     SetInternalFormat(GlFormatToGlInternalFormat(state->format, state->type));
 
-    mExplicitInternalFormat = VkFormatToGlInternalformat(mImage->GetFormat());
+    const VkFormat vkFormat = mImage->GetFormat();
+    mExplicitInternalFormat = VkFormatKeepsLuminanceAlpha(vkFormat) ? mInternalFormat : VkFormatToGlInternalformat(vkFormat);
     mExplicitType           = GlInternalFormatToGlType(mExplicitInternalFormat);
 
+    // framebuffers evaluate their completeness again
+    BumpGeneration();
+}
+
+bool
+Texture::Allocate(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mAllocationPending = false;
+
+    // the image is about to be recreated, so levels living only on the GPU are read back first
+    ReadBackVkLevels();
+
+    UpdateBaseLevelProperties();
+
     if(!CreateVkTexture()) {
         return false;
     }
 
+    CopyLevelsFromHost();
+
+    return true;
+}
+
+void
+Texture::CopyLevelsFromHost(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    typedef struct LevelCopy_t {
+        GLint                   layer;
+        GLint                   level;
+        VkDeviceSize            offset;
+    } LevelCopy_t;
+
     // NOTE:: there is an implicit conversion of all textures to GL_RGBA
     // TODO:: this should definitely NOT be the case
-    GLenum srcInternalFormat = mInternalFormat;
-    GLenum dstInternalFormat = mExplicitInternalFormat;
-    GLenum dstType = mExplicitType;
+    const GLenum srcInternalFormat = mInternalFormat;
+    const GLenum dstInternalFormat = mExplicitInternalFormat;
+    const GLenum dstType           = mExplicitType;
+    const bool   compressed        = GlFormatIsCompressed(srcInternalFormat);
+
+    GLint blockWidth = 1, blockHeight = 1, blockBytes = 0;
+    if(compressed) {
+        GlCompressedFormatToBlockSize(mInternalFormat, &blockWidth, &blockHeight, &blockBytes);
+    } else {
+        blockBytes = GlInternalFormatTypeToNumElements(dstInternalFormat, dstType) * GlTypeToElementSize(dstType);
+    }
+    // offsets of the regions are multiples of the texel size, and of 4 for the transfer queue
+    const VkDeviceSize alignment = 4 * static_cast<VkDeviceSize>(blockBytes);
+
+    assert(GetCurrentContext());
+    const PixelConversionPass *pixelConversionPass = GetCurrentContext()->GetPixelConversionPass();
+
+    // levels and faces held on the host share one staging allocation, copied by a single command with a
+    // region for each, instead of an allocation and a copy apiece. Levels written by the host, or expanded
+    // on the device, still take their own path
+    std::vector<LevelCopy_t> copies;
+    VkDeviceSize stagingSize = 0;
     for(GLint layer = 0; layer < mLayersCount; ++layer) {
         for(GLint level = 0; level < mMipLevelsCount; ++level) {
-            state = &mState[layer][level];
-            if(state->data) {
+            const State_t *state = &mState[layer][level];
+            if(!state->data) {
+                continue;
+            }
+
+            VkDeviceSize size;
+            if(compressed) {
+                size = GlCompressedImageSize(srcInternalFormat, state->width, state->height);
+                if(CanCopyOnHost(level, layer)) {
+                    const Rect rect(0, 0, state->width, state->height);
+                    CopyCompressedFromHost(&rect, level, layer, static_cast<GLsizei>(size), state->data);
+                    continue;
+                }
+            } else {
                 ImageRect srcRect(0, 0, state->width, state->height,
                                   GlInternalFormatTypeToNumElements(srcInternalFormat, state->type),
                                   GlTypeToElementSize(state->type),
@@ -245,49 +522,577 @@ Texture::Allocate(void)
                                   GlInternalFormatTypeToNumElements(dstInternalFormat, dstType),
                                   GlTypeToElementSize(dstType),
                                   Texture::GetDefaultInternalAlignment());
-                CopyPixelsFromHost(&srcRect, &dstRect, level, layer, srcInternalFormat, static_cast<void *>(state->data));
+                if(CanCopyOnHost(level, layer) || pixelConversionPass->CanConvert(srcInternalFormat, dstInternalFormat, &srcRect, &dstRect)) {
+                    CopyPixelsFromHost(&srcRect, &dstRect, level, layer, srcInternalFormat, static_cast<void *>(state->data));
+                    continue;
+                }
+                size = dstRect.GetRectBufferSize();
             }
+
+            LevelCopy_t copy;
+            copy.layer  = layer;
+            copy.level  = level;
+            copy.offset = (stagingSize + alignment - 1) / alignment * alignment;
+            copies.push_back(copy);
+            stagingSize = copy.offset + size;
+        }
+    }
+
+    if(!copies.empty()) {
+        std::vector<uint8_t> stagingData(stagingSize);
+        for(const auto &copy : copies) {
+            const State_t *state = &mState[copy.layer][copy.level];
+            if(compressed) {
+                memcpy(stagingData.data() + copy.offset, state->data, GlCompressedImageSize(srcInternalFormat, state->width, state->height));
+                continue;
+            }
+
+            ImageRect srcRect(0, 0, state->width, state->height,
+                              GlInternalFormatTypeToNumElements(srcInternalFormat, state->type),
+                              GlTypeToElementSize(state->type),
+                              Texture::GetDefaultInternalAlignment());
+            ImageRect dstRect(0, 0, state->width, state->height,
+                              GlInternalFormatTypeToNumElements(dstInternalFormat, dstType),
+                              GlTypeToElementSize(dstType),
+                              Texture::GetDefaultInternalAlignment());
+            ConvertPixels(srcInternalFormat, dstInternalFormat, &srcRect, state->data, &dstRect, stagingData.data() + copy.offset);
+        }
+
+        // the regions all refer to one buffer and to distinct subresources, so the upload manager merges them
+        vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+        VkDeviceSize stagingOffset = 0;
+        VkBuffer stagingBuffer = uploadManager->AllocateStagingBuffer(stagingSize, stagingData.data(), alignment, &stagingOffset);
+        if(stagingBuffer != VK_NULL_HANDLE) {
+            for(const auto &copy : copies) {
+                const State_t *state = &mState[copy.layer][copy.level];
+                const Rect rect(0, 0, state->width, state->height);
+                SubmitCopyPixels(&rect, stagingBuffer, copy.level, copy.layer, dstInternalFormat, true, stagingOffset + copy.offset);
+            }
+        }
+    }
+
+    // the staging copies are taken, so the image holds the only copy from now on
+    if(compressed || !GLOVE_RELEASE_TEXTURE_HOST_DATA || !CanReleaseHostData()) {
+        return;
+    }
+
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(GLint level = 0; level < mMipLevelsCount; ++level) {
+            State_t *state = &mState[layer][level];
+            if(state->data) {
+                delete [] (uint8_t *)state->data;
+                state->data     = nullptr;
+                state->onDevice = true;
+            }
+        }
+    }
+}
+
+void
+Texture::RequestAllocation(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // framebuffer attachments are about to be rendered to, so they get their image right away
+    if(!GLOVE_LAZY_TEXTURE_ALLOCATION || GetRefCount() > 0) {
+        Allocate();
+        return;
+    }
+
+    // the previous image is released now instead of lingering until the next use
+    ReadBackVkLevels();
+    ReleaseVkResources();
+
+    UpdateBaseLevelProperties();
+    mAllocationPending = true;
+
+    // descriptors referring to the previous image are updated on the next draw, which allocates the new one
+    BumpGeneration();
+}
+
+bool
+Texture::AllocatePending(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return !mAllocationPending || Allocate();
+}
+
+bool
+Texture::EvictVkResources(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // rendered depth cannot be read back to the host
+    if(mAllocationPending || mImported || mExported || GetRefCount() > 0 || mImage->GetImage() == VK_NULL_HANDLE || IsDepthTexture()) {
+        return false;
+    }
+
+    // levels that cannot be brought back to the host keep the image alive
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(GLint level = 0; level < mMipLevelsCount; ++level) {
+            if(mState[layer][level].onDevice && !ReadBackVkLevel(layer, level)) {
+                return false;
+            }
+        }
+    }
+
+    ReleaseVkResources();
+    mAllocationPending = true;
+    BumpGeneration();
+
+    return true;
+}
+
+void
+Texture::DropVkResources(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mImage->GetImage() == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // transient contents are not kept, the image is created anew in the memory planned for it on its next use
+    ReleaseVkResources();
+    for(GLint layer = 0; mState && layer < mLayersCount; ++layer) {
+        for(auto &level : mState[layer]) {
+            level.second.onDevice = false;
+        }
+    }
+    mAllocationPending = true;
+    BumpGeneration();
+}
+
+void
+Texture::SetTransientPool(TransientTexturePool *pool)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(pool == mTransientPool) {
+        return;
+    }
+
+    // the image moves to memory of its own or of the pool on its next use
+    if(mImage->GetImage() != VK_NULL_HANDLE && !mImported && !mExported) {
+        ReadBackVkLevels();
+        ReleaseVkResources();
+        mAllocationPending = true;
+        BumpGeneration();
+    }
+
+    if(mTransientPool) {
+        mTransientPool->Unregister(this);
+    }
+    mTransientPool = pool;
+    if(mTransientPool) {
+        mTransientPool->Register(this);
+    }
+}
+
+void
+Texture::TouchTransient(VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(!mTransientPool) {
+        return;
+    }
+
+    const bool write = newImageLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL         ||
+                       newImageLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ||
+                       newImageLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL             ||
+                       newImageLayout == VK_IMAGE_LAYOUT_GENERAL;
+    if(mTransientPool->Touch(this, write)) {
+        mImage->DiscardContents();
+        BumpGeneration();
+    }
+}
+
+bool
+Texture::ImportEGLImage(const EGLImageInterface *eglImage, VkImageUsageFlagBits usage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ReleaseVkResources();
+
+    GLenum format = GL_RGBA;
+    GLenum type   = GL_UNSIGNED_BYTE;
+    if(eglImage->vkFormat == VK_FORMAT_R5G6B5_UNORM_PACK16) {
+        format = GL_RGB;
+        type   = GL_UNSIGNED_SHORT_5_6_5;
+    }
+
+    // the EGLImage replaces every level there was, its contents exist only in its memory
+    mTarget = GL_TEXTURE_2D;
+    delete [] mState;
+    InitState();
+    mMipLevelsCount    = 1;
+    mAllocationPending = false;
+    SetState(eglImage->width, eglImage->height, 0, 0, format, type, GetDefaultInternalAlignment(), nullptr);
+
+    mImage->SetImageUsage(usage);
+    if(!mImage->Import(eglImage)) {
+        return false;
+    }
+
+    if(!mMemory->Import(mImage->GetImage(), eglImage) || !CreateVkImageView()) {
+        mImageView->Release();
+        mImage->Release();
+        mMemory->Release();
+        return false;
+    }
+
+    mSampler->SetMaxLod((mParameters.GetMinFilter() == GL_NEAREST || mParameters.GetMinFilter() == GL_LINEAR) ? 0.25f : 0.0f);
+    UpdateBaseLevelProperties();
+
+    assert(GetCurrentContext());
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    VkCommandBuffer *uploadCmdBuffer = uploadManager->BeginVkUploadCommandBuffer();
+    if(!uploadCmdBuffer) {
+        ReleaseVkResources();
+        return false;
+    }
+
+    // the exporter filled the memory, drivers keep imported contents across the first transition
+    PrepareVkImageLayout(uploadCmdBuffer, VK_IMAGE_LAYOUT_GENERAL);
+    RecordUploadBatch(uploadManager);
+
+    // partial respecifications read the level back before the texture gets storage of its own
+    mState[0][0].onDevice = true;
+    mImported = true;
+    BumpGeneration();
+
+    return true;
+}
+
+bool
+Texture::ExportEGLImage(EGLImageInterface *eglImage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a single 2D level of a format that dma-bufs are imported with, in memory of the texture itself
+    const VkFormat vkFormat = GetVkFormat();
+    if(mTarget != GL_TEXTURE_2D || !IsCompleted() || mMipLevelsCount != 1 || mImported || mTransientPool ||
+       (vkFormat != VK_FORMAT_R8G8B8A8_UNORM && vkFormat != VK_FORMAT_B8G8R8A8_UNORM && vkFormat != VK_FORMAT_R5G6B5_UNORM_PACK16)) {
+        return false;
+    }
+
+    // the texture is rendered to and sampled in linear tiling from now on
+    const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+    if((mVkContext->capabilityCache->GetFormatProperties(vkFormat).linearTilingFeatures & features) != features) {
+        return false;
+    }
+
+    // the levels are moved into the new image, as for any reallocation
+    if(!mExported) {
+        mExported = true;
+        if(!Allocate()) {
+            mExported = false;
+            return false;
         }
+    } else if(!AllocatePending()) {
+        return false;
+    }
+
+    // importers expect the contents of a linear image in the general layout
+    if(mImage->GetImageLayout() != VK_IMAGE_LAYOUT_GENERAL) {
+        PrepareVkImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+    }
+
+    const int fd = mMemory->ExportFd();
+    if(fd < 0) {
+        return false;
     }
 
+    VkImageSubresource subresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0};
+    VkSubresourceLayout layout;
+    vkGetImageSubresourceLayout(mVkContext->vkDevice, mImage->GetImage(), &subresource, &layout);
+
+    eglImage->source      = EGL_IMAGE_SOURCE_DMA_BUF;
+    eglImage->width       = static_cast<uint32_t>(GetWidth());
+    eglImage->height      = static_cast<uint32_t>(GetHeight());
+    eglImage->vkFormat    = vkFormat;
+    eglImage->planeCount  = 1;
+    eglImage->fds[0]      = fd;
+    eglImage->offsets[0]  = static_cast<uint32_t>(layout.offset);
+    eglImage->pitches[0]  = static_cast<uint32_t>(layout.rowPitch);
+    eglImage->modifier    = GLOVE_DRM_FORMAT_MOD_LINEAR;
+    eglImage->hasModifier = true;
+
+    return true;
+}
+
+bool
+Texture::BindSurfaceImage(const Texture *surfaceTexture, bool upright)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ReleaseVkResources();
+
+    // the color buffer replaces every level there was, its contents exist only in the image of the surface
+    mTarget = GL_TEXTURE_2D;
+    delete [] mState;
+    InitState();
+    mMipLevelsCount    = 1;
+    mAllocationPending = false;
+    SetState(surfaceTexture->GetWidth(), surfaceTexture->GetHeight(), 0, 0, surfaceTexture->GetFormat(), surfaceTexture->GetType(),
+             GetDefaultInternalAlignment(), nullptr);
+
+    // the image is shared, not copied, and it is left in the layout the surface has put it in
+    vulkanAPI::Image *surfaceImage = surfaceTexture->mImage;
+    mImage->SetFormat(surfaceImage->GetFormat());
+    mImage->SetImageUsage(surfaceImage->GetImageUsage());
+    mImage->SetImageTiling(surfaceImage->GetImageTiling());
+    mImage->SetImageTarget(surfaceImage->GetImageTarget());
+    mImage->SetWidth(surfaceTexture->GetWidth());
+    mImage->SetHeight(surfaceTexture->GetHeight());
+    mImage->SetImageLayout(surfaceImage->GetImageLayout());
+    mImage->SetImage(surfaceImage->GetImage());
+    mImage->CreateImageSubresourceRange();
+
+    if(!CreateVkImageView()) {
+        ReleaseVkResources();
+        return false;
+    }
+
+    mSampler->SetMaxLod((mParameters.GetMinFilter() == GL_NEAREST || mParameters.GetMinFilter() == GL_LINEAR) ? 0.25f : 0.0f);
+    UpdateBaseLevelProperties();
+
+    mState[0][0].onDevice = true;
+    mImported       = true;
+    mSurfaceBound   = true;
+    mSurfaceUpright = upright;
+    BumpGeneration();
+
     return true;
 }
 
+void
+Texture::ReleaseSurfaceImage(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the surface keeps its image, the texture is left without any level
+    ReleaseVkResources();
+    delete [] mState;
+    InitState();
+    mMipLevelsCount = 1;
+}
+
+bool
+Texture::ViewImageOf(const Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ReleaseVkResources();
+
+    // the image stays with the texture that owns it, this one only views its base level and first layer
+    delete [] mState;
+    InitState();
+    mMipLevelsCount    = 1;
+    mAllocationPending = false;
+    SetState(texture->GetWidth(), texture->GetHeight(), 0, 0, texture->GetFormat(), texture->GetType(),
+             GetDefaultInternalAlignment(), nullptr);
+
+    vulkanAPI::Image *image = texture->mImage;
+    mImage->SetFormat(image->GetFormat());
+    mImage->SetImageUsage(image->GetImageUsage());
+    mImage->SetImageTiling(image->GetImageTiling());
+    mImage->SetWidth(texture->GetWidth());
+    mImage->SetHeight(texture->GetHeight());
+    mImage->SetImageLayout(image->GetImageLayout());
+    mImage->SetImage(image->GetImage());
+    mImage->CreateImageSubresourceRange();
+
+    if(!CreateVkImageView()) {
+        ReleaseVkResources();
+        return false;
+    }
+
+    UpdateBaseLevelProperties();
+
+    mState[0][0].onDevice = true;
+    mImported = true;
+    BumpGeneration();
+
+    return true;
+}
+
+bool
+Texture::AllocateStorage(GLsizei levels, GLsizei width, GLsizei height, GLenum format, GLenum type, VkFormat vkFormat)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ReleaseVkResources();
+
+    // every level of every face gets its size once, and has no host copy: the contents exist only in the image
+    delete [] mState;
+    InitState();
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        for(GLint level = 0; level < levels; ++level) {
+            State_t *state  = &mState[layer][level];
+            state->width    = std::max(width  >> level, 1);
+            state->height   = std::max(height >> level, 1);
+            state->format   = format;
+            state->type     = type;
+            state->onDevice = true;
+        }
+    }
+    mCompressedFormat  = GlFormatIsCompressed(format) ? format : GL_INVALID_VALUE;
+    mMipLevelsCount    = levels;
+    mImmutableLevels   = levels;
+    mAllocationPending = false;
+    BumpGeneration();
+
+    // the whole chain is allocated right away, in device local memory and the optimal layout of the device
+    mImage->SetFormat(vkFormat);
+    mImage->SetImageTiling(VK_IMAGE_TILING_OPTIMAL);
+    UpdateBaseLevelProperties();
+
+    return CreateVkTexture();
+}
+
+bool
+Texture::CanReleaseHostData(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the host copy must be recreatable from the image without loss, and compressed copies are small anyway
+    if(GlFormatIsCompressed(mInternalFormat)) {
+        return false;
+    }
+
+    if(mExplicitInternalFormat == mInternalFormat) {
+        return true;
+    }
+
+    // three channel float texels only gain a fourth channel
+    if((mExplicitInternalFormat == GL_RGBA16F_EXT && mInternalFormat == GL_RGB16F_EXT) ||
+       (mExplicitInternalFormat == GL_RGBA32F_EXT && mInternalFormat == GL_RGB32F_EXT)) {
+        return true;
+    }
+
+    if(mExplicitInternalFormat != GL_RGBA8_OES) {
+        return false;
+    }
+
+    switch(mInternalFormat) {
+    case GL_RGBA:
+    case GL_RGB:
+    case GL_RGB8_OES:
+    case GL_ALPHA:
+    case GL_LUMINANCE:
+    case GL_LUMINANCE_ALPHA:    return true;
+    default:                    return false;
+    }
+}
+
 void
 Texture::SetState(GLsizei width, GLsizei height, GLint level, GLint layer, GLenum format, GLenum type, GLint unpackAlignment, const void *pixels)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    mState[layer][level].width  = width;
-    mState[layer][level].height = height;
-    mState[layer][level].format = format;
-    mState[layer][level].type   = type;
+    mState[layer][level].width    = width;
+    mState[layer][level].height   = height;
+    mState[layer][level].format   = format;
+    mState[layer][level].type     = type;
+    mState[layer][level].onDevice = false;
+    mCompressedFormat             = GL_INVALID_VALUE;
+    BumpGeneration();
 
     if(mState[layer][level].data) {
         delete [] (uint8_t *)mState[layer][level].data;
         mState[layer][level].data = nullptr;
     }
 
-    if(pixels) {
-        // convert the pixel buffers to the internal alignment
-        // so that they can cooperate with any subsequent subimage calls
-        // even if a texture is not complete
-        GLenum srcInternalFormat = GlFormatToGlInternalFormat(format, type);
-        ImageRect srcRect(0, 0, width, height,
-                          GlInternalFormatTypeToNumElements(srcInternalFormat, type),
-                          GlTypeToElementSize(type),
-                          unpackAlignment);
-        ImageRect dstRect(0, 0, width, height,
-                          GlInternalFormatTypeToNumElements(srcInternalFormat, type),
-                          GlTypeToElementSize(type),
-                          Texture::GetDefaultInternalAlignment());
-        size_t size       = dstRect.GetRectBufferSize();
-        mState[layer][level].data = new uint8_t[size];
-        void *data = mState[layer][level].data;
-        ConvertPixels(srcInternalFormat, srcInternalFormat,
-                      &srcRect, pixels,
-                      &dstRect, data);
-    }
+    if(pixels) {
+        // convert the pixel buffers to the internal alignment
+        // so that they can cooperate with any subsequent subimage calls
+        // even if a texture is not complete
+        GLenum srcInternalFormat = GlFormatToGlInternalFormat(format, type);
+        ImageRect srcRect(0, 0, width, height,
+                          GlInternalFormatTypeToNumElements(srcInternalFormat, type),
+                          GlTypeToElementSize(type),
+                          unpackAlignment);
+        ImageRect dstRect(0, 0, width, height,
+                          GlInternalFormatTypeToNumElements(srcInternalFormat, type),
+                          GlTypeToElementSize(type),
+                          Texture::GetDefaultInternalAlignment());
+        size_t size       = dstRect.GetRectBufferSize();
+        mState[layer][level].data = new uint8_t[size];
+        void *data = mState[layer][level].data;
+        ConvertPixels(srcInternalFormat, srcInternalFormat,
+                      &srcRect, pixels,
+                      &dstRect, data);
+    }
+}
+
+void
+Texture::SetCompressedState(GLsizei width, GLsizei height, GLint level, GLint layer, GLenum format, GLsizei imageSize, const void *data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    State_t *state = &mState[layer][level];
+    state->width    = width;
+    state->height   = height;
+    state->format   = format;
+    state->type     = GL_UNSIGNED_BYTE;
+    state->onDevice = false;
+    BumpGeneration();
+
+    if(state->data) {
+        delete [] (uint8_t *)state->data;
+        state->data = nullptr;
+    }
+
+    // the blocks are kept as given, to be copied to an image of the same format
+    if(data) {
+        state->data = new uint8_t[imageSize];
+        memcpy(state->data, data, imageSize);
+    }
+
+    mCompressedFormat = format;
+}
+
+bool
+Texture::SubmitCompressedSubState(const Rect *rect, GLint level, GLint layer, GLsizei imageSize, const void *data)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    State_t *state = &mState[layer][level];
+
+    GLint blockWidth, blockHeight, blockBytes;
+    if(!GlCompressedFormatToBlockSize(state->format, &blockWidth, &blockHeight, &blockBytes)) {
+        return false;
+    }
+
+    // patch the host copy row of blocks by row of blocks, the offsets being block aligned
+    if(!state->data) {
+        const GLsizei levelSize = GlCompressedImageSize(state->format, state->width, state->height);
+        state->data = new uint8_t[levelSize];
+        memset(state->data, 0, levelSize);
+    }
+
+    const GLsizei levelRowBytes = ((state->width + blockWidth  - 1) / blockWidth) * blockBytes;
+    const GLsizei rectRowBytes  = ((rect->width  + blockWidth  - 1) / blockWidth) * blockBytes;
+    const GLsizei rectRows      =  (rect->height + blockHeight - 1) / blockHeight;
+    uint8_t *dstData       = static_cast<uint8_t *>(state->data) + (rect->y / blockHeight) * levelRowBytes + (rect->x / blockWidth) * blockBytes;
+    const uint8_t *srcData = static_cast<const uint8_t *>(data);
+    for(GLsizei row = 0; row < rectRows; ++row) {
+        memcpy(dstData + row * levelRowBytes, srcData + row * rectRowBytes, rectRowBytes);
+    }
+
+    // the sub-rectangle goes straight to the image, as long as the image holds every level already
+    if(mImage->GetImage() == VK_NULL_HANDLE || mImage->GetFormat() != GlCompressedFormatToVkFormat(state->format) ||
+       level >= static_cast<GLint>(mImage->GetMipLevels()) || !IsCompleted()) {
+        return false;
+    }
+
+    CopyCompressedFromHost(rect, level, layer, imageSize, data);
+    SetDataUpdated(true);
+
+    return true;
 }
 
 void
@@ -295,7 +1100,7 @@ Texture::SetSubState(ImageRect *srcRect, ImageRect *dstRect, GLint level, GLint
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mState[layer][level].data == nullptr) {
+    if(mState[layer][level].data == nullptr && !ReadBackVkLevel(layer, level)) {
         ImageRect srcRect(0, 0, mState[layer][level].width, mState[layer][level].height,
                           GlInternalFormatTypeToNumElements(GetInternalFormat(), GetType()),
                           GlTypeToElementSize(GetType()),
@@ -343,6 +1148,74 @@ Texture::SetSubState(ImageRect *srcRect, ImageRect *dstRect, GLint level, GLint
     SetDataUpdated(true);
 }
 
+bool
+Texture::SubmitSubState(ImageRect *srcRect, ImageRect *dstRect, GLint level, GLint layer, GLenum srcFormat, VkFormat vkFormat, const void *srcData)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the sub-rectangle goes straight to the image, as long as the image keeps its format and level,
+    // which immutable ones always do, their texels are converted on the way
+    State_t *state = &mState[layer][level];
+    if(!srcData || mFboColorAttached ||
+       mImage->GetImage() == VK_NULL_HANDLE || (!mImmutableLevels && mImage->GetFormat() != vkFormat) ||
+       level >= static_cast<GLint>(mImage->GetMipLevels())) {
+        return false;
+    }
+
+    // a host copy is updated as well, provided that the image already holds every level of it
+    if(state->data) {
+        if(!IsCompleted()) {
+            return false;
+        }
+        SetSubState(srcRect, dstRect, level, layer, srcFormat, srcData);
+    } else if(!state->onDevice) {
+        return false;
+    }
+
+    ImageRect imageRect(dstRect->x, dstRect->y, dstRect->width, dstRect->height,
+                        GlInternalFormatTypeToNumElements(mExplicitInternalFormat, mExplicitType),
+                        GlTypeToElementSize(mExplicitType),
+                        Texture::GetDefaultInternalAlignment());
+    CopyPixelsFromHost(srcRect, &imageRect, level, layer, srcFormat, srcData);
+    SetDataUpdated(true);
+
+    return true;
+}
+
+bool
+Texture::IsLevelSpecified(GLint level, GLint layer, GLsizei width, GLsizei height, GLenum format, GLenum type) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mState || layer >= mLayersCount) {
+        return false;
+    }
+
+    auto it = mState[layer].find(level);
+    return it != mState[layer].end() && it->second.width == width && it->second.height == height &&
+           it->second.format == format && it->second.type == type;
+}
+
+bool
+Texture::SubmitSubStateFromBuffer(const Rect *rect, GLint level, GLint layer, VkFormat vkFormat, VkBuffer buffer, VkDeviceSize bufferOffset, uint32_t bufferRowLength)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the texels are copied by the device as they are laid out in the buffer, so the image must
+    // store them in that same format, and hold the only copy of the level, there is no host copy to update
+    State_t *state = &mState[layer][level];
+    if(mFboColorAttached || mImage->GetImage() == VK_NULL_HANDLE || mImage->GetFormat() != vkFormat ||
+       level >= static_cast<GLint>(mImage->GetMipLevels()) || state->data || !state->onDevice ||
+       rect->x + rect->width > state->width || rect->y + rect->height > state->height) {
+        return false;
+    }
+
+    SubmitCopyPixels(rect, buffer, level, layer, mExplicitInternalFormat, true, bufferOffset, bufferRowLength);
+    SetDataUpdated(true);
+
+    return true;
+}
+
 void Texture::CopyPixelsToHost(ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum dstFormat, void *dstData)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
@@ -355,7 +1228,7 @@ void Texture::CopyPixelsToHost(ImageRect *srcRect, ImageRect *dstRect, GLint mip
     tbo->Allocate(srcSize, nullptr);
 
     // use the global rect offsets for transfering the subpixels from Vulkan
-    SubmitCopyPixels(srcRect, tbo, miplevel, layer, dstFormat, false);
+    SubmitCopyPixels(srcRect, tbo->GetVkBuffer(), miplevel, layer, dstFormat, false);
 
     // convert the destination buffer (both are similar dimensions) to the internal format
     uint8_t *srcData = new uint8_t[srcSize];
@@ -384,27 +1257,56 @@ void Texture::CopyPixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint m
 
     const GLenum dstFormat = mExplicitInternalFormat;
 
-    // create a buffer at the size of the requested subrectangle
-    const size_t dstSize   = dstRect->GetRectBufferSize();
-    uint8_t *dstData = new uint8_t[dstSize];
-
-    // convert the destination buffer (both are similar dimensions) to the internal format
     ImageRect tmp_srcRect = *srcRect;
     ImageRect tmp_dstRect = *dstRect;
     tmp_srcRect.x = 0; tmp_srcRect.y = 0;
     tmp_dstRect.x = 0; tmp_dstRect.y = 0;
-    ConvertPixels(srcFormat, dstFormat,
-                  &tmp_srcRect, srcData,
-                  &tmp_dstRect, dstData);
 
-    BufferObject *tbo = new TransferSrcBufferObject(mVkContext);
-    tbo->Allocate(dstSize, dstData);
+    // an idle image is written from the host, straight from the pixels as given when
+    // they need no conversion, and by a single conversion pass otherwise
+    if(CanCopyOnHost(miplevel, layer)) {
+        const uint32_t pixelSize = dstRect->GetPixelByteOffset();
+        const uint32_t srcStride = srcRect->GetRectAlignedRowInBytes();
+        if(srcFormat == dstFormat && srcRect->GetPixelByteOffset() == pixelSize && !(srcStride % pixelSize) &&
+           CopyMemoryToImage(dstRect, miplevel, layer, srcData, srcStride / pixelSize)) {
+            return;
+        }
 
-    // use the global rect offsets for transfering the subpixels to Vulkan
-    SubmitCopyPixels(dstRect, tbo, miplevel, layer, dstFormat, true);
+        ImageRect packedRect(0, 0, dstRect->width, dstRect->height, dstRect->mNumElements, dstRect->mSizeElement, 1);
+        std::vector<uint8_t> packedData(packedRect.GetRectBufferSize());
+        ConvertPixels(srcFormat, dstFormat, &tmp_srcRect, srcData, &packedRect, packedData.data());
+        if(CopyMemoryToImage(dstRect, miplevel, layer, packedData.data(), 0)) {
+            return;
+        }
+    }
 
-    delete    tbo;
-    delete[]  dstData;
+    // the staging space is owned by the upload batch and recycled once it retires
+    assert(GetCurrentContext());
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    VkDeviceSize stagingOffset = 0;
+
+    // large images are expanded on the device, from the pixels as given
+    VkBuffer stagingBuffer = GetCurrentContext()->GetPixelConversionPass()->Convert(uploadManager, srcFormat, dstFormat,
+                                                                                    &tmp_srcRect, srcData, &tmp_dstRect, &stagingOffset);
+    if(stagingBuffer == VK_NULL_HANDLE) {
+        // create a buffer at the size of the requested subrectangle
+        const size_t dstSize   = dstRect->GetRectBufferSize();
+        uint8_t *dstData = new uint8_t[dstSize];
+
+        // convert the destination buffer (both are similar dimensions) to the internal format
+        ConvertPixels(srcFormat, dstFormat,
+                      &tmp_srcRect, srcData,
+                      &tmp_dstRect, dstData);
+
+        stagingBuffer = uploadManager->AllocateStagingBuffer(dstSize, dstData, dstRect->GetPixelByteOffset(), &stagingOffset);
+
+        delete[]  dstData;
+    }
+
+    // use the global rect offsets for transfering the subpixels to Vulkan
+    if(stagingBuffer != VK_NULL_HANDLE) {
+        SubmitCopyPixels(dstRect, stagingBuffer, miplevel, layer, dstFormat, true, stagingOffset);
+    }
 
 #if GLOVE_SAVE_TEXTURES_TO_FILE == true
     // TODO:: adjust for lod levels
@@ -427,11 +1329,36 @@ void Texture::CopyPixelsFromHost(ImageRect *srcRect, ImageRect *dstRect, GLint m
  #endif
 }
 
-void Texture::SubmitCopyPixels(const Rect *rect, BufferObject *tbo, GLint miplevel, GLint layer, GLenum srcFormat, bool copyToImage)
+void
+Texture::CopyCompressedFromHost(const Rect *rect, GLint miplevel, GLint layer, GLsizei imageSize, const void *srcData)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GLint blockWidth, blockHeight, blockBytes;
+    GlCompressedFormatToBlockSize(mInternalFormat, &blockWidth, &blockHeight, &blockBytes);
+
+    if(CanCopyOnHost(miplevel, layer) && CopyMemoryToImage(rect, miplevel, layer, srcData, 0)) {
+        return;
+    }
+
+    // blocks need no conversion, and their staging offset must be a multiple of the block size
+    assert(GetCurrentContext());
+    vulkanAPI::UploadManager *uploadManager = GetCurrentContext()->GetVkCommandBufferManager()->GetUploadManager();
+    VkDeviceSize stagingOffset = 0;
+    VkBuffer stagingBuffer = uploadManager->AllocateStagingBuffer(imageSize, srcData, blockBytes, &stagingOffset);
+
+    if(stagingBuffer != VK_NULL_HANDLE) {
+        SubmitCopyPixels(rect, stagingBuffer, miplevel, layer, mExplicitInternalFormat, true, stagingOffset);
+    }
+}
+
+void Texture::SubmitCopyPixels(const Rect *rect, VkBuffer buffer, GLint miplevel, GLint layer, GLenum srcFormat, bool copyToImage, VkDeviceSize bufferOffset, uint32_t bufferRowLength)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     mImage->CreateBufferImageCopy(rect->x, rect->y, rect->width, rect->height, miplevel, layer, 1);
+    mImage->GetBufferImageCopy()->bufferOffset    = bufferOffset;
+    mImage->GetBufferImageCopy()->bufferRowLength = bufferRowLength;
     mImage->ModifyImageSubresourceRange(miplevel, 1, layer, 1);
 
     VkImageLayout oldImageLayout = mImage->GetImageLayout();
@@ -439,16 +1366,39 @@ void Texture::SubmitCopyPixels(const Rect *rect, BufferObject *tbo, GLint miplev
                       oldImageLayout != VK_IMAGE_LAYOUT_PREINITIALIZED) ? oldImageLayout : VK_IMAGE_LAYOUT_GENERAL;
     VkImageLayout newImageLayout = copyToImage ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
-    assert(GetCurrentContext());
-    vulkanAPI::CommandBufferManager *commandBufferManager = GetCurrentContext()->GetVkCommandBufferManager();
+    Context *context = GetCurrentContext();
+    assert(context);
+    vulkanAPI::CommandBufferManager *commandBufferManager = context->GetVkCommandBufferManager();
+    const uint32_t slot = context->GetShareGroupSlot();
+
+    // only transfer stages may be used on the upload queue, so images in
+    // attachment or shader read layouts are still updated on the graphics queue,
+    // as are those other contexts may still sample, whose submissions only that queue is ordered after
+    if(copyToImage && oldImageLayout == VK_IMAGE_LAYOUT_GENERAL && !context->GetResourceManager()->IsTextureUsedByOtherContexts(this, slot)) {
+        vulkanAPI::UploadManager *uploadManager = commandBufferManager->GetUploadManager();
+
+        // once a batch touching this image has been flushed, draws in flight may sample it
+        if(!mUploadRecorded || mUploadSlot != slot || uploadManager->IsBatchSubmitted(mUploadBatchId)) {
+            STALL_REASON(STALL_REASON_TEXTURE_UPDATE);
+            commandBufferManager->WaitLastSubmition();
+        }
+
+        // uploads are batched and waited upon by the next graphics submission,
+        // and sub-rectangles of one image are merged into a single copy command
+        if(uploadManager->CopyBufferToImage(buffer, mImage->GetImage(), mImage->GetBufferImageCopy())) {
+            RecordUploadBatch(uploadManager);
+        }
+        return;
+    }
+
     commandBufferManager->BeginVkAuxCommandBuffer();
     VkCommandBuffer activeCmdBuffer = commandBufferManager->GetAuxCommandBuffer();
     {
         mImage->ModifyImageLayout(&activeCmdBuffer, newImageLayout);
         if(copyToImage) {
-            mImage->CopyBufferToImage(&activeCmdBuffer, tbo->GetVkBuffer());
+            mImage->CopyBufferToImage(&activeCmdBuffer, buffer);
         } else {
-            mImage->CopyImageToBuffer(&activeCmdBuffer, tbo->GetVkBuffer());
+            mImage->CopyImageToBuffer(&activeCmdBuffer, buffer);
         }
         mImage->ModifyImageLayout(&activeCmdBuffer, oldImageLayout);
     }
@@ -457,6 +1407,249 @@ void Texture::SubmitCopyPixels(const Rect *rect, BufferObject *tbo, GLint miplev
     commandBufferManager->WaitVkAuxCommandBuffer();
 }
 
+bool
+Texture::CanCopyOnHost(GLint miplevel, GLint layer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mImage->IsHostTransfer() || mTransientPool || IsColorAttachment() ||
+       mImage->GetImageLayout(miplevel, layer) != VK_IMAGE_LAYOUT_GENERAL) {
+        return false;
+    }
+
+    // the host writes while nothing on the device may touch the image, in any context of the share group;
+    // busy ones, and those whose use by another context is not known, are still updated through the queues
+    Context *context = GetCurrentContext();
+    assert(context);
+    vulkanAPI::CommandBufferManager *commandBufferManager = context->GetVkCommandBufferManager();
+    const uint32_t slot = context->GetShareGroupSlot();
+
+    return IsUploadCompleted(slot, commandBufferManager->GetUploadManager()) &&
+           context->GetResourceManager()->IsTextureIdle(this, slot, commandBufferManager->UpdateCompletedSerial(), commandBufferManager->GetSubmitSerial(), 0);
+}
+
+bool
+Texture::CopyMemoryToImage(const Rect *rect, GLint miplevel, GLint layer, const void *srcData, uint32_t rowLength)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mImage->CreateBufferImageCopy(rect->x, rect->y, rect->width, rect->height, miplevel, layer, 1);
+    mImage->ModifyImageSubresourceRange(miplevel, 1, layer, 1);
+
+    return mImage->CopyMemoryToImage(srcData, rowLength);
+}
+
+bool
+Texture::CanCopyFromVkImage(const Texture *srcTexture, bool invertY, GLint miplevel) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the image holds the texels as they are sampled only when no conversion took place on the way in
+    if(mImage->GetImage() == VK_NULL_HANDLE || srcTexture->mImage->GetImage() == VK_NULL_HANDLE ||
+       mInternalFormat != GL_RGBA8_OES || mExplicitInternalFormat != GL_RGBA8_OES ||
+       miplevel >= static_cast<GLint>(mImage->GetMipLevels())) {
+        return false;
+    }
+
+    if(!invertY && srcTexture->mImage->GetFormat() == mImage->GetFormat()) {
+        return true;
+    }
+
+    return VkImageHasFormatFeatures(mVkContext, srcTexture->mImage, VK_FORMAT_FEATURE_BLIT_SRC_BIT) &&
+           VkImageHasFormatFeatures(mVkContext, mImage,             VK_FORMAT_FEATURE_BLIT_DST_BIT);
+}
+
+void
+Texture::CopyFromVkImage(VkCommandBuffer *cmdBuffer, Texture *srcTexture, const Rect *srcRect, bool invertY, GLint xoffset, GLint yoffset, GLint miplevel, GLint layer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vulkanAPI::Image *srcImage       = srcTexture->mImage;
+    VkImageLayout     oldImageLayout = mImage->GetImageLayout();
+
+    // draws recorded earlier may still be sampling the contents about to be overwritten
+    vkCmdPipelineBarrier(*cmdBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vulkanAPI::ImageBarrierBatch barriers;
+    srcTexture->PrepareVkImageLayout(&barriers, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    PrepareVkImageLayout(&barriers, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    barriers.Record(cmdBuffer);
+
+    VkImageSubresourceLayers srcSubresource;
+    srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    srcSubresource.mipLevel       = 0;
+    srcSubresource.baseArrayLayer = 0;
+    srcSubresource.layerCount     = 1;
+
+    VkImageSubresourceLayers dstSubresource;
+    dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    dstSubresource.mipLevel       = miplevel;
+    dstSubresource.baseArrayLayer = layer;
+    dstSubresource.layerCount     = 1;
+
+    // identical formats are copied as they are, a format change or a flip goes through the blit engine
+    if(!invertY && srcImage->GetFormat() == mImage->GetFormat()) {
+        VkImageCopy imageCopy;
+        memset(static_cast<void *>(&imageCopy), 0, sizeof(imageCopy));
+        imageCopy.srcSubresource = srcSubresource;
+        imageCopy.srcOffset.x    = srcRect->x;
+        imageCopy.srcOffset.y    = srcRect->y;
+        imageCopy.dstSubresource = dstSubresource;
+        imageCopy.dstOffset.x    = xoffset;
+        imageCopy.dstOffset.y    = yoffset;
+        imageCopy.extent.width   = srcRect->width;
+        imageCopy.extent.height  = srcRect->height;
+        imageCopy.extent.depth   = 1;
+
+        srcImage->CopyImage(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       mImage->GetImage(),
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       &imageCopy);
+    } else {
+        VkImageBlit imageBlit;
+        memset(static_cast<void *>(&imageBlit), 0, sizeof(imageBlit));
+        imageBlit.srcSubresource  = srcSubresource;
+        imageBlit.srcOffsets[0].x = srcRect->x;
+        imageBlit.srcOffsets[0].y = invertY ? srcRect->y + srcRect->height : srcRect->y;
+        imageBlit.srcOffsets[1].x = srcRect->x + srcRect->width;
+        imageBlit.srcOffsets[1].y = invertY ? srcRect->y : srcRect->y + srcRect->height;
+        imageBlit.srcOffsets[1].z = 1;
+        imageBlit.dstSubresource  = dstSubresource;
+        imageBlit.dstOffsets[0].x = xoffset;
+        imageBlit.dstOffsets[0].y = yoffset;
+        imageBlit.dstOffsets[1].x = xoffset + srcRect->width;
+        imageBlit.dstOffsets[1].y = yoffset + srcRect->height;
+        imageBlit.dstOffsets[1].z = 1;
+
+        srcImage->BlitImage(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       mImage->GetImage(),
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       &imageBlit, VK_FILTER_NEAREST);
+    }
+
+    PrepareVkImageLayout(cmdBuffer, oldImageLayout != VK_IMAGE_LAYOUT_UNDEFINED ? oldImageLayout : VK_IMAGE_LAYOUT_GENERAL);
+
+    // and the draws recorded next sample the copied texels
+    VkMemoryBarrier memoryBarrier;
+    memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.pNext         = nullptr;
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(*cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    // the level lives only in the image from now on, it is read back if the host ever needs it
+    State_t *state = &mState[layer][miplevel];
+    if(state->data) {
+        delete [] (uint8_t *)state->data;
+        state->data = nullptr;
+    }
+    state->onDevice = true;
+}
+
+bool
+Texture::BlitFromVkImage(VkCommandBuffer *cmdBuffer, Texture *srcTexture, const VkImageBlit *imageBlit, VkFilter filter)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vulkanAPI::Image *srcImage = srcTexture->mImage;
+    if(mImage->GetImage() == VK_NULL_HANDLE || srcImage->GetImage() == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    // blits that neither scale nor mirror between images of the same format are plain copies
+    const VkOffset3D *src = imageBlit->srcOffsets;
+    const VkOffset3D *dst = imageBlit->dstOffsets;
+    const bool copy = srcImage->GetFormat() == mImage->GetFormat() &&
+                      src[1].x > src[0].x && src[1].y > src[0].y &&
+                      src[1].x - src[0].x == dst[1].x - dst[0].x &&
+                      src[1].y - src[0].y == dst[1].y - dst[0].y;
+    if(!copy && (!VkImageHasFormatFeatures(mVkContext, srcImage, VK_FORMAT_FEATURE_BLIT_SRC_BIT) ||
+                 !VkImageHasFormatFeatures(mVkContext, mImage,   VK_FORMAT_FEATURE_BLIT_DST_BIT))) {
+        return false;
+    }
+    if(filter == VK_FILTER_LINEAR && !VkImageHasFormatFeatures(mVkContext, srcImage, VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+        filter = VK_FILTER_NEAREST;
+    }
+
+    // an image blitted onto itself is both the source and the destination of the transfer
+    const VkImageLayout srcImageLayout = srcTexture->GetVkImageLayout();
+    const VkImageLayout dstImageLayout = GetVkImageLayout();
+    const VkImageLayout srcLayout      = srcTexture == this ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    const VkImageLayout dstLayout      = srcTexture == this ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+    // draws recorded earlier may still be sampling the contents about to be overwritten
+    vkCmdPipelineBarrier(*cmdBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vulkanAPI::ImageBarrierBatch barriers;
+    srcTexture->PrepareVkImageLayout(&barriers, srcLayout);
+    PrepareVkImageLayout(&barriers, dstLayout);
+    barriers.Record(cmdBuffer);
+
+    if(copy) {
+        VkImageCopy imageCopy;
+        memset(static_cast<void *>(&imageCopy), 0, sizeof(imageCopy));
+        imageCopy.srcSubresource = imageBlit->srcSubresource;
+        imageCopy.srcOffset      = src[0];
+        imageCopy.dstSubresource = imageBlit->dstSubresource;
+        imageCopy.dstOffset      = dst[0];
+        imageCopy.extent.width   = static_cast<uint32_t>(src[1].x - src[0].x);
+        imageCopy.extent.height  = static_cast<uint32_t>(src[1].y - src[0].y);
+        imageCopy.extent.depth   = 1;
+
+        srcImage->CopyImage(cmdBuffer, srcLayout, mImage->GetImage(), dstLayout, &imageCopy);
+    } else {
+        srcImage->BlitImage(cmdBuffer, srcLayout, mImage->GetImage(), dstLayout, imageBlit, filter);
+    }
+
+    // both images return to the layout their next consumer expects, the ones that had
+    // none are left for that consumer to move out of the transfer layout
+    if(srcTexture != this && srcImageLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+        srcTexture->PrepareVkImageLayout(&barriers, srcImageLayout);
+    }
+    if(dstImageLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+        PrepareVkImageLayout(&barriers, dstImageLayout);
+    }
+    barriers.Record(cmdBuffer);
+
+    return true;
+}
+
+void
+Texture::CopyToVkBuffer(VkCommandBuffer *cmdBuffer, const Rect *srcRect, VkBuffer buffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mImage->ModifyImageSubresourceRange(0, 1, 0, 1);
+
+    VkImageLayout oldImageLayout = mImage->GetImageLayout();
+    oldImageLayout = (oldImageLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+                      oldImageLayout != VK_IMAGE_LAYOUT_PREINITIALIZED) ? oldImageLayout : VK_IMAGE_LAYOUT_GENERAL;
+
+    // the texels are read after the draws recorded earlier have written them
+    VkMemoryBarrier memoryBarrier;
+    memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.pNext         = nullptr;
+    memoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(*cmdBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    mImage->CreateBufferImageCopy(srcRect->x, srcRect->y, srcRect->width, srcRect->height, 0, 0, 1);
+    mImage->ModifyImageLayout(cmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    mImage->CopyImageToBuffer(cmdBuffer, buffer);
+    mImage->ModifyImageLayout(cmdBuffer, oldImageLayout);
+    mImage->ModifyImageSubresourceRange(0, mImage->GetMipLevels(), 0, mLayersCount);
+
+    // and the host reads them once the submission has signaled its fence
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(*cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
 void
 Texture::PrepareVkImageLayout(VkImageLayout newImageLayout)
 {
@@ -467,14 +1660,37 @@ Texture::PrepareVkImageLayout(VkImageLayout newImageLayout)
     commandBufferManager->BeginVkAuxCommandBuffer();
     VkCommandBuffer cmdBuffer = commandBufferManager->GetAuxCommandBuffer();
 
-    mImage->ModifyImageSubresourceRange(0, mMipLevelsCount, 0, mLayersCount);
-    mImage->ModifyImageLayout(&cmdBuffer, newImageLayout);
+    PrepareVkImageLayout(&cmdBuffer, newImageLayout);
 
     commandBufferManager->EndVkAuxCommandBuffer();
     commandBufferManager->SubmitVkAuxCommandBuffer();
     commandBufferManager->WaitVkAuxCommandBuffer();
 }
 
+void
+Texture::PrepareVkImageLayout(VkCommandBuffer *cmdBuffer, VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    TouchTransient(newImageLayout);
+    mImage->ModifyImageSubresourceRange(0, mImage->GetMipLevels(), 0, mLayersCount);
+    if(mImage->ModifyImageLayout(cmdBuffer, newImageLayout)) {
+        BumpGeneration();
+    }
+}
+
+void
+Texture::PrepareVkImageLayout(vulkanAPI::ImageBarrierBatch *barriers, VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    TouchTransient(newImageLayout);
+    mImage->ModifyImageSubresourceRange(0, mImage->GetMipLevels(), 0, mLayersCount);
+    if(mImage->ModifyImageLayout(barriers, newImageLayout)) {
+        BumpGeneration();
+    }
+}
+
 void
 Texture::InvertPixels()
 {
@@ -498,35 +1714,120 @@ Texture::InvertPixels()
     }
 }
 
+Texture *
+Texture::DetachVkResources(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the returned texture owns the current image, while this one gets fresh objects of the same kind
+    Texture *texture = new Texture(mVkContext, mVkMemoryFlags);
+    std::swap(mImage         , texture->mImage);
+    std::swap(mMemory        , texture->mMemory);
+    std::swap(mImageView     , texture->mImageView);
+    std::swap(mUploadBatchId , texture->mUploadBatchId);
+    std::swap(mUploadSlot    , texture->mUploadSlot);
+    std::swap(mUploadRecorded, texture->mUploadRecorded);
+
+    mImage->SetFormat(texture->mImage->GetFormat());
+    mImage->SetImageUsage(texture->mImage->GetImageUsage());
+    mImage->SetImageTiling(texture->mImage->GetImageTiling());
+    mImage->SetImageTarget(texture->mImage->GetImageTarget());
+
+    return texture;
+}
+
 void
-Texture::GenerateMipmaps(GLenum hintMipmapMode)
+Texture::AttachVkResources(Texture *texture)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    int numElements = GlInternalFormatTypeToNumElements(GetExplicitInternalFormat(), GetExplicitType());
-    int sizeElement = GlTypeToElementSize(GetExplicitType());
-    int alignment   = Texture::GetDefaultInternalAlignment();
-    ImageRect srcRect(0, 0, GetWidth(), GetHeight(), numElements, sizeElement, alignment);
-    ImageRect dstRect(0, 0, GetWidth(), GetHeight(), numElements, sizeElement, alignment);
+    std::swap(mImage         , texture->mImage);
+    std::swap(mMemory        , texture->mMemory);
+    std::swap(mImageView     , texture->mImageView);
+    std::swap(mUploadBatchId , texture->mUploadBatchId);
+    std::swap(mUploadSlot    , texture->mUploadSlot);
+    std::swap(mUploadRecorded, texture->mUploadRecorded);
 
-    const size_t     baseLevel  = 0;
-    const size_t     baseSize   = dstRect.GetRectBufferSize();
-    std::vector<uint8_t*> basePixels(mLayersCount);
+    delete texture;
+}
+
+bool
+Texture::ReadBackVkLevels(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    bool readBack = false;
     for(GLint layer = 0; layer < mLayersCount; ++layer) {
-        basePixels[layer] = new uint8_t[baseSize];
-        CopyPixelsToHost(&srcRect, &dstRect, baseLevel, layer, GetExplicitInternalFormat(), basePixels[layer]);
+        for(GLint level = 0; level < mMipLevelsCount; ++level) {
+            readBack |= ReadBackVkLevel(layer, level);
+        }
     }
 
-    // create Mipmapped Texture
-    mMipLevelsCount = NUMBER_OF_MIP_LEVELS(GetWidth(), GetHeight());
-    CreateVkTexture();
+    return readBack;
+}
 
-    // set back base mipLevel for all layers
-    for(GLint layer = 0; layer < mLayersCount; ++layer) {
-        InvertImageYAxis(static_cast<uint8_t *>(basePixels[layer]), &srcRect);
-        CopyPixelsFromHost(&srcRect, &dstRect, baseLevel, layer, GetExplicitInternalFormat(), basePixels[layer]);
-        delete[] basePixels[layer];
+bool
+Texture::ReadBackVkLevel(GLint layer, GLint level)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    State_t *state = &mState[layer][level];
+    if(!state->onDevice || state->data || mImage->GetImage() == VK_NULL_HANDLE ||
+       level >= static_cast<GLint>(mImage->GetMipLevels())) {
+        return false;
+    }
+
+    ImageRect srcRect(0, 0, state->width, state->height,
+                      GlInternalFormatTypeToNumElements(mExplicitInternalFormat, mExplicitType),
+                      GlTypeToElementSize(mExplicitType),
+                      Texture::GetDefaultInternalAlignment());
+    ImageRect dstRect(0, 0, state->width, state->height,
+                      GlInternalFormatTypeToNumElements(mInternalFormat, state->type),
+                      GlTypeToElementSize(state->type),
+                      Texture::GetDefaultInternalAlignment());
+
+    state->data = new uint8_t[dstRect.GetRectBufferSize()];
+
+    // generated levels are stored upright like the uploaded ones
+    mDataNoInvertion = true;
+    CopyPixelsToHost(&srcRect, &dstRect, level, layer, mInternalFormat, state->data);
+    state->onDevice = false;
+
+    return true;
+}
+
+void
+Texture::GenerateMipmaps(GLenum hintMipmapMode)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the chain is generated from the base level on the GPU
+    if(!AllocatePending()) {
+        return;
+    }
+
+    // immutable textures only get the levels they were given storage for
+    const GLint   mipLevelsCount = mImmutableLevels ? mImmutableLevels : NUMBER_OF_MIP_LEVELS(GetWidth(), GetHeight());
+    VkImageLayout oldImageLayout = mImage->GetImageLayout();
+    if(mipLevelsCount < 2) {
+        return;
+    }
+
+    // images allocated without the whole chain are migrated to a mipmapped one,
+    // the base level is copied on the GPU and the old image lives on until its frames retire
+    Texture *baseTexture = nullptr;
+    if(static_cast<GLint>(mImage->GetMipLevels()) < mipLevelsCount) {
+        const GLint baseMipLevelsCount = mMipLevelsCount;
+
+        baseTexture     = DetachVkResources();
+        mMipLevelsCount = mipLevelsCount;
+        if(!CreateVkTexture()) {
+            AttachVkResources(baseTexture);
+            mMipLevelsCount = baseMipLevelsCount;
+            return;
+        }
     }
+    mMipLevelsCount = mipLevelsCount;
 
     // Blit LoD Level '0' to rest layers
     VkImageBlit imageBlit;
@@ -547,24 +1848,53 @@ Texture::GenerateMipmaps(GLenum hintMipmapMode)
     imageBlit.dstOffsets[1].y               = static_cast<int32_t>(std::max(std::floor(imageBlit.srcOffsets[1].y >> 1), 1.0));
     imageBlit.dstOffsets[1].z               = 1;
 
+    // blits need a graphics queue, so they go through a single auxiliary
+    // submission that also waits for the uploads of the new image
     assert(GetCurrentContext());
     vulkanAPI::CommandBufferManager *commandBufferManager = GetCurrentContext()->GetVkCommandBufferManager();
     commandBufferManager->BeginVkAuxCommandBuffer();
     VkCommandBuffer activeCmdBuffer = commandBufferManager->GetAuxCommandBuffer();
     {
         VkFilter      filter         = hintMipmapMode == GL_FASTEST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
-        VkImageLayout oldImageLayout = mImage->GetImageLayout();
 
-        mImage->ModifyImageSubresourceRange(0, mMipLevelsCount, 0, mLayersCount);
-        mImage->ModifyImageLayout(&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        vulkanAPI::ImageBarrierBatch barriers;
+        if(baseTexture) {
+            VkImageCopy imageCopy;
+            memset(static_cast<void *>(&imageCopy), 0, sizeof(imageCopy));
+            imageCopy.srcSubresource = imageBlit.srcSubresource;
+            imageCopy.dstSubresource = imageBlit.srcSubresource;
+            imageCopy.extent.width   = GetWidth();
+            imageCopy.extent.height  = GetHeight();
+            imageCopy.extent.depth   = 1;
+
+            vulkanAPI::Image *baseImage = baseTexture->mImage;
+            baseImage->ModifyImageSubresourceRange(0, baseImage->GetMipLevels(), 0, mLayersCount);
+            baseImage->ModifyImageLayout(&barriers, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            mImage->ModifyImageSubresourceRange(0, 1, 0, mLayersCount);
+            mImage->ModifyImageLayout(&barriers, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            barriers.Record(&activeCmdBuffer);
+            baseImage->CopyImage     (&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                        mImage->GetImage(),
+                                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                        &imageCopy);
+        }
+
+        // the base level is read and every other level written behind a single barrier,
+        // afterwards each level only has to turn into the source of the next one
+        mImage->ModifyImageSubresourceRange(0, 1, 0, mLayersCount);
+        mImage->ModifyImageLayout(&barriers, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        mImage->ModifyImageSubresourceRange(1, mMipLevelsCount - 1, 0, mLayersCount);
+        mImage->ModifyImageLayout(&barriers, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        barriers.Record(&activeCmdBuffer);
         for(GLint mipLevel = 1; mipLevel < mMipLevelsCount; ++mipLevel) {
-            mImage->ModifyImageSubresourceRange(mipLevel, 1, 0, mLayersCount);
-            mImage->ModifyImageLayout(&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
             mImage->BlitImage        (&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                                                         mImage->GetImage(),
                                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                                         &imageBlit, filter);
-            mImage->ModifyImageLayout(&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            if(mipLevel + 1 < mMipLevelsCount) {
+                mImage->ModifyImageSubresourceRange(mipLevel, 1, 0, mLayersCount);
+                mImage->ModifyImageLayout(&activeCmdBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            }
 
             imageBlit.srcSubresource.mipLevel = imageBlit.dstSubresource.mipLevel;
             imageBlit.srcOffsets[1].x         = imageBlit.dstOffsets[1].x;
@@ -581,5 +1911,28 @@ Texture::GenerateMipmaps(GLenum hintMipmapMode)
     commandBufferManager->SubmitVkAuxCommandBuffer();
     commandBufferManager->WaitVkAuxCommandBuffer();
 
-    // TODO: Fill the 'State_t' with the rest mipLevels
+    // draws recorded but not yet submitted may still refer to the old image
+    if(baseTexture) {
+        GetCurrentContext()->GetCacheManager()->CacheTexture(baseTexture);
+    }
+
+    // the generated levels are read back only if the host ever needs them
+    for(GLint layer = 0; layer < mLayersCount; ++layer) {
+        const State_t *baseState = &mState[layer][0];
+        for(GLint level = 1; level < mMipLevelsCount; ++level) {
+            State_t *state = &mState[layer][level];
+            if(state->data) {
+                delete [] (uint8_t *)state->data;
+                state->data = nullptr;
+            }
+            state->width    = std::max(baseState->width  >> level, 1);
+            state->height   = std::max(baseState->height >> level, 1);
+            state->format   = baseState->format;
+            state->type     = baseState->type;
+            state->onDevice = true;
+        }
+    }
+
+    mSampler->SetMaxLod((mParameters.GetMinFilter() == GL_NEAREST || mParameters.GetMinFilter() == GL_LINEAR) ? 0.25f : static_cast<float>(mMipLevelsCount-1));
+    BumpGeneration();
 }
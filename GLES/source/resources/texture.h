@@ -24,17 +24,25 @@
 #ifndef __TEXTURE_H__
 #define __TEXTURE_H__
 
+#include <atomic>
 #include "rect.h"
 #include "sampler.h"
 #include "bufferObject.h"
 #include "refObject.h"
+#include "utils/arrays.hpp"
+#include "utils/globals.h"
 #include "vulkan/sampler.h"
 #include "vulkan/imageView.h"
 #include "utils/GlToVkConverter.h"
+#include "transientTexturePool.h"
+
+namespace vulkanAPI {
+    class UploadManager;
+}
 
 #define ISPOWEROFTWO(x)           ((x != 0) && !(x & (x - 1)))
 
-class Texture : public refObject {
+class Texture : public refObject, public ArrayObject {
 
     struct State {
         GLint                      width;
@@ -42,9 +50,10 @@ class Texture : public refObject {
         GLenum                     format;
         GLenum                     type;
         void                       *data;
+        bool                       onDevice;       // contents exist only in the Vulkan image
 
         State() : width(-1), height(-1), format(GL_INVALID_VALUE), type(GL_INVALID_VALUE),
-            data(nullptr) { FUN_ENTRY(GL_LOG_TRACE); }
+            data(nullptr), onDevice(false) { FUN_ENTRY(GL_LOG_TRACE); }
         ~State() { FUN_ENTRY(GL_LOG_TRACE); if(data) {delete [] (uint8_t *)data; data = nullptr;}}
     };
     typedef State                  State_t;
@@ -52,6 +61,7 @@ class Texture : public refObject {
 
 private:
     const vulkanAPI::vkContext_t *mVkContext;
+    VkFlags                     mVkMemoryFlags;
 
     GLenum                      mFormat;
     GLenum                      mTarget;
@@ -62,8 +72,13 @@ private:
     GLenum                      mExplicitType;
     GLenum                      mExplicitInternalFormat;
 
+    // compressed format the texture was specified in, also when it had to be decoded on the CPU
+    GLenum                      mCompressedFormat;
+
     GLint                       mMipLevelsCount;
     GLint                       mLayersCount;
+    // levels given once by glTexStorage2DEXT, the image is never recreated for them, 0 if mutable
+    GLint                       mImmutableLevels;
 
     Rect                        mDims;
     Sampler                     mParameters;
@@ -74,55 +89,130 @@ private:
 
     Texture                    *mDepthStencilTexture;
     uint32_t                    mDepthStencilTextureRefCount;
+    uint32_t                    mColorAttachmentRefCount;
+
+    // changes whenever anything a descriptor of this texture refers to does, unique across textures
+    uint64_t                    mGeneration;
+    static std::atomic<uint64_t> mGenerationCounter;
+
+    /// completeness as evaluated at mCompletenessGeneration, every change it depends on bumps the generation
+    uint64_t                    mCompletenessGeneration;
+    bool                        mCompleted;
+    bool                        mNPOTAccessCompleted;
 
     vulkanAPI::Image*           mImage;
     vulkanAPI::Memory*          mMemory;
     vulkanAPI::Sampler*         mSampler;
     vulkanAPI::ImageView*       mImageView;
 
+    // last upload batch that recorded commands on mImage, in the upload manager of the context of mUploadSlot
+    uint64_t                    mUploadBatchId;
+    uint32_t                    mUploadSlot;
+    bool                        mUploadRecorded;
+
+    // the image is created on first use, the levels wait in the host copy until then
+    bool                        mAllocationPending;
+    // submit serial of the last command buffer that sampled the texture, per context of the share group,
+    // each context stamps its own slot only, those without a slot mark the texture as untracked instead
+    std::atomic<uint64_t>       mLastUsedSerials[GLOVE_MAX_SHARE_GROUP_CONTEXTS];
+    std::atomic<bool>           mUsedUntracked;
+    // the image lives in memory of an EGLImage, which has no host copy to fall back to
+    bool                        mImported;
+    // the image lives in memory exported as a dma-buf, it is created in such memory for as long as the texture lives
+    bool                        mExported;
+    // the image is the color buffer of a pbuffer bound with eglBindTexImage, which the surface owns
+    bool                        mSurfaceBound;
+    bool                        mSurfaceUpright;
+    // the image is bound to memory the pool aliases with other transient textures
+    TransientTexturePool       *mTransientPool;
+
     static int                  mDefaultInternalAlignment;
 
     bool                        AllocateVkMemory(void);
     void                        ReleaseVkResources(void);
+    void                        WaitVkUploads(void);
+    void                        RecordUploadBatch(vulkanAPI::UploadManager *uploadManager);
+    Texture                    *DetachVkResources(void);
+    void                        AttachVkResources(Texture *texture);
+    bool                        ReadBackVkLevel(GLint layer, GLint level);
+    bool                        ReadBackVkLevels(void);
+    void                        UpdateBaseLevelProperties(void);
+    bool                        CanReleaseHostData(void)                const;
+    void                        CopyCompressedFromHost(const Rect *rect, GLint miplevel, GLint layer, GLsizei imageSize, const void *srcData);
 
 public:
     Texture(const vulkanAPI::vkContext_t  *vkContext = nullptr,
-            const VkFlags       vkFlags   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            const VkFlags       vkFlags   = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
     ~Texture();
 
 // Generate Functions
     bool                    Allocate();
+    void                    RequestAllocation(void);
+    bool                    AllocatePending(void);
+    bool                    EvictVkResources(void);
+    void                    DropVkResources(void);
+    void                    ReleaseContextSlot(uint32_t slot);
+    void                    SetTransientPool(TransientTexturePool *pool);
+    void                    TouchTransient(VkImageLayout newImageLayout);
+    bool                    ImportEGLImage(const EGLImageInterface *eglImage, VkImageUsageFlagBits usage);
+    bool                    ExportEGLImage(EGLImageInterface *eglImage);
+    bool                    BindSurfaceImage(const Texture *surfaceTexture, bool upright);
+    void                    ReleaseSurfaceImage(void);
+    bool                    ViewImageOf(const Texture *texture);
+    bool                    AllocateStorage(GLsizei levels, GLsizei width, GLsizei height, GLenum format, GLenum type, VkFormat vkFormat);
     void                    SetState(GLsizei width, GLsizei height, GLint level, GLint layer, GLenum format, GLenum type, GLint unpackAlignment, const void *pixels);
+    void                    SetCompressedState(GLsizei width, GLsizei height, GLint level, GLint layer, GLenum format, GLsizei imageSize, const void *data);
     void                    SetSubState(ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum srcFormat, const void *srcData);
+    bool                    SubmitSubState(ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum srcFormat, VkFormat vkFormat, const void *srcData);
+    bool                    SubmitCompressedSubState(const Rect *rect, GLint miplevel, GLint layer, GLsizei imageSize, const void *data);
+    bool                    IsLevelSpecified(GLint miplevel, GLint layer, GLsizei width, GLsizei height, GLenum format, GLenum type) const;
+    bool                    SubmitSubStateFromBuffer(const Rect *rect, GLint miplevel, GLint layer, VkFormat vkFormat, VkBuffer buffer, VkDeviceSize bufferOffset, uint32_t bufferRowLength);
     void                    GenerateMipmaps(GLenum hintMipmapMode);
 
 // Init Functions
     inline void             InitState(void)                                     { FUN_ENTRY(GL_LOG_TRACE); mLayersCount  = mTarget == GL_TEXTURE_2D ? TEXTURE_2D_LAYERS : TEXTURE_CUBE_MAP_LAYERS;
-                                                                                                           mState        = new StateMap_t[mLayersCount]; }
+                                                                                                           mState        = new StateMap_t[mLayersCount];
+                                                                                                           BumpGeneration(); }
 
 // Helper Functions
     static int              GetDefaultInternalAlignment()                       { FUN_ENTRY(GL_LOG_TRACE); return mDefaultInternalAlignment; }
     inline int              GetInvertedYOrigin(const Rect* rect)                { FUN_ENTRY(GL_LOG_TRACE); return mDims.height - rect->height - rect->y; }
     void                    PrepareVkImageLayout(VkImageLayout newImageLayout);
+    void                    PrepareVkImageLayout(VkCommandBuffer *cmdBuffer, VkImageLayout newImageLayout);
+    void                    PrepareVkImageLayout(vulkanAPI::ImageBarrierBatch *barriers, VkImageLayout newImageLayout);
 
 // Create Functions
     bool                    CreateVkTexture(void);
     bool                    CreateVkImage(void);
-    bool                    CreateVkImageView(void)                             { FUN_ENTRY(GL_LOG_TRACE); return mImageView->Create(mImage); }
+    bool                    CreateVkImageView(void);
     bool                    CreateVkSampler(void)                               { FUN_ENTRY(GL_LOG_TRACE); return mSampler->Create(); }
     void                    CreateVkImageSubResourceRange(void)                 { FUN_ENTRY(GL_LOG_TRACE); return mImage->CreateImageSubresourceRange(); }
 
 // Copy Functions
      void                   CopyPixelsFromHost (ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum srcFormat, const void *srcData);
      void                   CopyPixelsToHost   (ImageRect *srcRect, ImageRect *dstRect, GLint miplevel, GLint layer, GLenum dstFormat, void *dstData);
-     void                   SubmitCopyPixels   (const Rect *rect, BufferObject *tbo, GLint miplevel, GLint layer, GLenum dstFormat, bool copyToImage);
+     void                   SubmitCopyPixels   (const Rect *rect, VkBuffer buffer, GLint miplevel, GLint layer, GLenum dstFormat, bool copyToImage, VkDeviceSize bufferOffset = 0, uint32_t bufferRowLength = 0);
+     bool                   CanCopyOnHost      (GLint miplevel, GLint layer);
+     void                   CopyLevelsFromHost (void);
+
+// Update Functions
+    inline void             UpdateCompleteness(void)                            { FUN_ENTRY(GL_LOG_TRACE); if(mCompletenessGeneration != mGeneration) { EvaluateCompleteness(); } }
+           void             EvaluateCompleteness(void);
+           bool             EvaluateCompleted(void);
+     bool                   CopyMemoryToImage  (const Rect *rect, GLint miplevel, GLint layer, const void *srcData, uint32_t rowLength);
      void                   InvertPixels       (void);
+     bool                   CanCopyFromVkImage (const Texture *srcTexture, bool invertY, GLint miplevel) const;
+     void                   CopyFromVkImage    (VkCommandBuffer *cmdBuffer, Texture *srcTexture, const Rect *srcRect, bool invertY, GLint xoffset, GLint yoffset, GLint miplevel, GLint layer);
+     void                   CopyToVkBuffer     (VkCommandBuffer *cmdBuffer, const Rect *srcRect, VkBuffer buffer);
+     bool                   BlitFromVkImage    (VkCommandBuffer *cmdBuffer, Texture *srcTexture, const VkImageBlit *imageBlit, VkFilter filter);
 
 // Get Functions
     inline GLenum           GetWrapS(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetWrapS(); }
     inline GLenum           GetWrapT(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetWrapT(); }
     inline GLenum           GetMinFilter(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetMinFilter(); }
     inline GLenum           GetMagFilter(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetMagFilter(); }
+    inline GLenum           GetCompareMode(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetCompareMode(); }
+    inline GLenum           GetCompareFunc(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mParameters.GetCompareFunc(); }
     inline int              GetWidth(void)                              const   { FUN_ENTRY(GL_LOG_TRACE); return mDims.width; }
     inline int              GetHeight(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mDims.height; }
     inline GLenum           GetType(void)                               const   { FUN_ENTRY(GL_LOG_TRACE); return mType; }
@@ -130,6 +220,7 @@ public:
     inline GLenum           GetFormat(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mFormat; }
     inline GLenum           GetTarget(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mTarget; }
     inline GLenum           GetInternalFormat(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mInternalFormat; }
+    inline GLenum           GetCompressedFormat(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mCompressedFormat; }
     inline GLenum           GetExplicitInternalFormat(void)             const   { FUN_ENTRY(GL_LOG_TRACE); return mExplicitInternalFormat; }
     inline GLint            GetLayersCount(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mLayersCount; }
     inline GLint            GetMipLevelsCount(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mMipLevelsCount; }
@@ -137,6 +228,8 @@ public:
     
     inline Texture         *GetDepthStencilTexture(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mDepthStencilTexture;}
     inline uint32_t         GetDepthStencilTextureRefCount(void)        const   { FUN_ENTRY(GL_LOG_TRACE); return mDepthStencilTextureRefCount; }
+    inline uint64_t         GetGeneration(void)                         const   { FUN_ENTRY(GL_LOG_TRACE); return mGeneration; }
+    inline uint64_t         GetLastUsedSerial(uint32_t slot)            const   { FUN_ENTRY(GL_LOG_TRACE); return slot < GLOVE_MAX_SHARE_GROUP_CONTEXTS ? mLastUsedSerials[slot].load(std::memory_order_acquire) : UINT64_MAX; }
 
     inline vulkanAPI::Image* GetImage(void)                                     { FUN_ENTRY(GL_LOG_TRACE); return mImage; }
 
@@ -144,6 +237,8 @@ public:
     inline VkFormat         GetVkFormat(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mImage->GetFormat(); }
     inline VkImageLayout    GetVkImageLayout(void)                      const   { FUN_ENTRY(GL_LOG_TRACE); return mImage->GetImageLayout(); }
     inline VkImageView      GetVkImageView(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mImageView->GetImageView(); }
+    inline VkImageUsageFlagBits GetVkImageUsage(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mImage->GetImageUsage(); }
+    inline VkSampleCountFlagBits GetVkSampleCount(void)                 const   { FUN_ENTRY(GL_LOG_TRACE); return mImage->GetSampleCount(); }
     VkFormat                FindSupportedVkColorFormat(VkFormat format)         { FUN_ENTRY(GL_LOG_TRACE); return mImage->FindSupportedVkColorFormat(format); }
 
 // Set Functions
@@ -153,15 +248,20 @@ public:
                                                                                                            mImageView->SetContext(vkContext);
                                                                                                            mImage->SetContext(vkContext); }
     inline void             SetWrapS(GLenum mode)                               { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateWrapS(mode)) { \
-                                                                                                           mSampler->SetAddressModeU(GlTexAddressToVkTexAddress(mode));}}
+                                                                                                           mSampler->SetAddressModeU(GlTexAddressToVkTexAddress(mode)); BumpGeneration();}}
     inline void             SetWrapT(GLenum mode)                               { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateWrapT(mode)) { \
-                                                                                                           mSampler->SetAddressModeV(GlTexAddressToVkTexAddress(mode));}}
+                                                                                                           mSampler->SetAddressModeV(GlTexAddressToVkTexAddress(mode)); BumpGeneration();}}
     inline void             SetMinFilter(GLenum mode)                           { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateMinFilter(mode)){ \
                                                                                                            mSampler->SetMinFilter(GlTexFilterToVkTexFilter(mode)); \
                                                                                                            mSampler->SetMipmapMode(GlTexMipMapModeToVkMipMapMode(mode));
-                                                                                                           mSampler->SetMaxLod((mode == GL_NEAREST || mode == GL_LINEAR) ? 0.25f : static_cast<float>(mMipLevelsCount-1));}}
+                                                                                                           mSampler->SetMaxLod((mode == GL_NEAREST || mode == GL_LINEAR) ? 0.25f : static_cast<float>(mMipLevelsCount-1)); BumpGeneration();}}
     inline void             SetMagFilter(GLenum mode)                           { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateMagFilter(mode)) { \
-                                                                                                           mSampler->SetMagFilter(GlTexFilterToVkTexFilter(mode));} }
+                                                                                                           mSampler->SetMagFilter(GlTexFilterToVkTexFilter(mode)); BumpGeneration();} }
+    inline void             SetCompareMode(GLenum mode)                         { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateCompareMode(mode)) { \
+                                                                                                           mSampler->SetCompareEnabled(mode == GL_COMPARE_REF_TO_TEXTURE_EXT ? VK_TRUE : VK_FALSE); \
+                                                                                                           mSampler->SetCompareOp(GlCompareFuncToVkCompareOp(GetCompareFunc())); BumpGeneration();} }
+    inline void             SetCompareFunc(GLenum func)                         { FUN_ENTRY(GL_LOG_TRACE); if(mParameters.UpdateCompareFunc(func)) { \
+                                                                                                           mSampler->SetCompareOp(GlCompareFuncToVkCompareOp(func)); BumpGeneration();} }
     inline void             SetWidth(int width)                                 { FUN_ENTRY(GL_LOG_TRACE); mDims.width  = width;  }
     inline void             SetHeight(int height)                               { FUN_ENTRY(GL_LOG_TRACE); mDims.height = height; }
     inline void             SetTarget(GLenum target)                            { FUN_ENTRY(GL_LOG_TRACE); mTarget      = target; }
@@ -169,17 +269,21 @@ public:
     inline void             SetType(GLenum type)                                { FUN_ENTRY(GL_LOG_TRACE); mType        = type;   }
     inline void             SetExplicitType(GLenum type)                        { FUN_ENTRY(GL_LOG_TRACE); mExplicitType = type;  }
     inline void             SetInternalFormat(GLenum format)                    { FUN_ENTRY(GL_LOG_TRACE); mInternalFormat         = format;  }
+    inline void             SetCompressedFormat(GLenum format)                  { FUN_ENTRY(GL_LOG_TRACE); mCompressedFormat       = format;  }
     inline void             SetExplicitInternalFormat(GLenum format)            { FUN_ENTRY(GL_LOG_TRACE); mExplicitInternalFormat = format;  }
     inline void             SetDataUpdated(bool updated)                        { FUN_ENTRY(GL_LOG_TRACE); mDataUpdated = updated; }
     inline void             SetDataNoInvertion(bool updated)                    { FUN_ENTRY(GL_LOG_TRACE); mDataNoInvertion = updated; }
     inline void             SetFboColorAttached(bool updated)                   { FUN_ENTRY(GL_LOG_TRACE); mFboColorAttached = updated; }
     inline void             SetDepthStencilTexture(Texture *tex)                { FUN_ENTRY(GL_LOG_TRACE); mDepthStencilTexture = tex;}
+    inline void             SetLastUsedSerial(uint32_t slot, uint64_t serial)   { FUN_ENTRY(GL_LOG_TRACE); if(slot < GLOVE_MAX_SHARE_GROUP_CONTEXTS) { mLastUsedSerials[slot].store(serial, std::memory_order_release); }
+                                                                                                           else if(!mUsedUntracked.load(std::memory_order_relaxed)) { mUsedUntracked.store(true, std::memory_order_release); } }
 
     inline void             SetImageBufferCopyStencil(bool copy)                { FUN_ENTRY(GL_LOG_TRACE); mImage->SetCopyStencil(copy);   }
     inline void             SetVkFormat(VkFormat format)                        { FUN_ENTRY(GL_LOG_TRACE); mImage->SetFormat(format);      }
     inline void             SetVkImage(VkImage image)                           { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImage(image);        }
     inline void             SetVkImageUsage(VkImageUsageFlagBits usage)         { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageUsage(usage);   }
     inline void             SetVkImageLayout(VkImageLayout layout)              { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageLayout(layout); }
+    inline void             SetVkSampleCount(VkSampleCountFlagBits samples)     { FUN_ENTRY(GL_LOG_TRACE); mImage->SetSampleCount(samples); }
     inline void             SetVkImageTiling(VkImageTiling tiling)              { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageTiling(tiling); }
     inline void             SetVkImageTiling(void)                              { FUN_ENTRY(GL_LOG_TRACE); mImage->SetImageTiling();       }
     inline void             SetVkImageTarget(vulkanAPI::Image::VkImageTarget
@@ -188,18 +292,35 @@ public:
 // Increase/Decrease Functions
     inline void             IncreaseDepthStencilTextureRefCount(void)                              { FUN_ENTRY(GL_LOG_TRACE); ++mDepthStencilTextureRefCount; }
     inline void             DecreaseDepthStencilTextureRefCount(void)                              { FUN_ENTRY(GL_LOG_TRACE); --mDepthStencilTextureRefCount; }
+    inline void             IncreaseColorAttachmentRefCount(void)                                  { FUN_ENTRY(GL_LOG_TRACE); ++mColorAttachmentRefCount; BumpGeneration(); }
+    inline void             DecreaseColorAttachmentRefCount(void)                                  { FUN_ENTRY(GL_LOG_TRACE); if(mColorAttachmentRefCount) { --mColorAttachmentRefCount; } BumpGeneration(); }
+    inline void             BumpGeneration(void)                                                   { FUN_ENTRY(GL_LOG_TRACE); mGeneration = ++mGenerationCounter; }
 
 // Is Functions
     inline bool             IsCubeMap(void)                             const   { FUN_ENTRY(GL_LOG_TRACE); return mTarget  == GL_TEXTURE_CUBE_MAP; }
-    inline bool             IsCompressed(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return (mFormat != GL_ALPHA           &&
+    inline bool             IsColorAttachment(void)                     const   { FUN_ENTRY(GL_LOG_TRACE); return mColorAttachmentRefCount > 0; }
+    /// specified with GL_DEPTH_COMPONENT, rendered to as a depth attachment and sampled in place
+    inline bool             IsDepthTexture(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mFormat == GL_DEPTH_COMPONENT; }
+    inline bool             IsAllocationPending(void)                   const   { FUN_ENTRY(GL_LOG_TRACE); return mAllocationPending; }
+    inline bool             IsImported(void)                            const   { FUN_ENTRY(GL_LOG_TRACE); return mImported; }
+    inline bool             IsExported(void)                            const   { FUN_ENTRY(GL_LOG_TRACE); return mExported; }
+    inline bool             IsSurfaceBound(void)                        const   { FUN_ENTRY(GL_LOG_TRACE); return mSurfaceBound; }
+    inline bool             IsImmutable(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mImmutableLevels != 0; }
+    /// bound to a pbuffer rendered without the Y flip, whose image is sampled in place
+    inline bool             IsSurfaceStoredUpright(void)                const   { FUN_ENTRY(GL_LOG_TRACE); return mSurfaceBound && mSurfaceUpright; }
+    inline bool             IsTransient(void)                           const   { FUN_ENTRY(GL_LOG_TRACE); return mTransientPool != nullptr; }
+    inline bool             IsUsedUntracked(void)                       const   { FUN_ENTRY(GL_LOG_TRACE); return mUsedUntracked.load(std::memory_order_acquire); }
+           bool             IsUploadCompleted(uint32_t slot, vulkanAPI::UploadManager *uploadManager);
+    inline bool             IsCompressed(void)                          const   { FUN_ENTRY(GL_LOG_TRACE); return  mCompressedFormat != GL_INVALID_VALUE ||
+                                                                                                                  (mFormat != GL_ALPHA           &&
                                                                                                                    mFormat != GL_RGB             &&
                                                                                                                    mFormat != GL_RGBA            &&
                                                                                                                    mFormat != GL_LUMINANCE       &&
                                                                                                                    mFormat != GL_LUMINANCE_ALPHA &&
                                                                                                                    mFormat != GL_BGRA8_EXT); }
            bool             IsNPOT(void);
-           bool             IsNPOTAccessCompleted(void);
-           bool             IsCompleted(void);
+    inline bool             IsNPOTAccessCompleted(void)                         { FUN_ENTRY(GL_LOG_TRACE); UpdateCompleteness(); return mNPOTAccessCompleted; }
+    inline bool             IsCompleted(void)                                   { FUN_ENTRY(GL_LOG_TRACE); UpdateCompleteness(); return mCompleted; }
 };
 
 #endif // __TEXTURE_H__
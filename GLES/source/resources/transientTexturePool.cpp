@@ -0,0 +1,415 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       transientTexturePool.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Aliasing of the memory of transient textures whose uses within a frame do not overlap
+ *
+ *  @section
+ *
+ *  Textures marked with GL_TEXTURE_TRANSIENT_GLOVE do not need their contents
+ *  from one frame to the next, like the intermediates of a post-processing
+ *  chain. Each one is bound to a slot of memory, at first of its own. The pool
+ *  keeps the interval between the first and the last use of every texture
+ *  within the frame, and once a few successive frames have used them in the
+ *  same order, the textures whose intervals do not overlap are planned to
+ *  share slots. The planned textures release their images, which are bound to
+ *  the shared slots when they are next used.
+ *
+ *  A texture that is used after another one of its slot discards the contents
+ *  of its image, whose next barrier then waits on all the prior work of the
+ *  queue, the accesses of the other images of the slot included. A texture
+ *  that is read instead, so its contents were still needed, has been aliased
+ *  wrongly: it is given a slot of its own at the end of the frame, for good.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "transientTexturePool.h"
+#include "texture.h"
+#include "vulkan/commandBufferManager.h"
+
+TransientTexturePool::TransientTexturePool(const vulkanAPI::vkContext_t *vkContext)
+: mVkContext(vkContext), mClock(0), mConflict(false), mStableFrames(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+TransientTexturePool::~TransientTexturePool()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto slot : mSlots) {
+        delete slot->memory;
+        delete slot;
+    }
+    mSlots.clear();
+}
+
+TransientTexturePool::Slot_t *
+TransientTexturePool::CreateSlot(const VkMemoryRequirements *requirements)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vulkanAPI::Memory *memory = new vulkanAPI::Memory(mVkContext, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    memory->SetImageMemoryRequirements(requirements);
+    if(!memory->Create()) {
+        delete memory;
+        return nullptr;
+    }
+
+    Slot_t *slot         = new Slot_t();
+    slot->memory         = memory;
+    slot->size           = requirements->size;
+    slot->memoryTypeBits = requirements->memoryTypeBits;
+    slot->owner          = nullptr;
+    slot->users          = 0;
+    slot->planned        = 0;
+    mSlots.push_back(slot);
+
+    return slot;
+}
+
+void
+TransientTexturePool::ReleaseSlot(Slot_t *slot)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mSlots.erase(std::find(mSlots.begin(), mSlots.end(), slot));
+    delete slot->memory;
+    delete slot;
+}
+
+void
+TransientTexturePool::ReleaseUnusedSlots(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(size_t i = mSlots.size(); i-- > 0;) {
+        if(!mSlots[i]->users && !mSlots[i]->planned) {
+            ReleaseSlot(mSlots[i]);
+        }
+    }
+}
+
+void
+TransientTexturePool::Register(Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Entry_t &entry   = mEntries[texture];
+    entry.slot       = nullptr;
+    entry.planned    = nullptr;
+    entry.first      = 0;
+    entry.last       = 0;
+    entry.used       = false;
+    entry.persistent = false;
+    memset(static_cast<void *>(&entry.requirements), 0, sizeof(entry.requirements));
+
+    // the plans refer to the textures by their order
+    mCurrentPlan.clear();
+    mPendingPlan.clear();
+}
+
+void
+TransientTexturePool::Unregister(Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(texture);
+    if(it == mEntries.end()) {
+        return;
+    }
+
+    if(it->second.slot) {
+        Unbind(&it->second, texture);
+    }
+    if(it->second.planned) {
+        --it->second.planned->planned;
+    }
+    mEntries.erase(it);
+    ReleaseUnusedSlots();
+
+    mCurrentPlan.clear();
+    mPendingPlan.clear();
+}
+
+bool
+TransientTexturePool::Bind(Texture *texture, VkImage image)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(texture);
+    if(it == mEntries.end()) {
+        return false;
+    }
+
+    Entry_t &entry = it->second;
+    if(entry.slot) {
+        Unbind(&entry, texture);
+    }
+
+    vkGetImageMemoryRequirements(mVkContext->vkDevice, image, &entry.requirements);
+
+    // the image may have been specified anew since its slot was planned, memory is aliased from offset 0 so any alignment fits
+    Slot_t *slot = entry.planned;
+    if(!slot || slot->size < entry.requirements.size ||
+       (entry.requirements.memoryTypeBits & slot->memoryTypeBits) != slot->memoryTypeBits) {
+        slot = CreateSlot(&entry.requirements);
+        if(!slot) {
+            return false;
+        }
+    }
+
+    if(!slot->memory->BindImageMemory(image)) {
+        ReleaseUnusedSlots();
+        return false;
+    }
+
+    // a new image starts out undefined, there is nothing to discard
+    ++slot->users;
+    slot->owner = texture;
+    entry.slot  = slot;
+
+    return true;
+}
+
+void
+TransientTexturePool::Unbind(Entry_t *entry, Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Slot_t *slot = entry->slot;
+    entry->slot  = nullptr;
+
+    --slot->users;
+    if(slot->owner == texture) {
+        slot->owner = nullptr;
+    }
+    if(!slot->users && !slot->planned) {
+        ReleaseSlot(slot);
+    }
+}
+
+void
+TransientTexturePool::Unbind(Texture *texture)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(texture);
+    if(it != mEntries.end() && it->second.slot) {
+        Unbind(&it->second, texture);
+    }
+}
+
+bool
+TransientTexturePool::Touch(Texture *texture, bool write)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(texture);
+    if(it == mEntries.end() || !it->second.slot) {
+        return false;
+    }
+
+    Entry_t &entry = it->second;
+    entry.last = ++mClock;
+    if(!entry.used) {
+        entry.first = entry.last;
+        entry.used  = true;
+    }
+
+    Slot_t *slot = entry.slot;
+    if(slot->owner == texture) {
+        return false;
+    }
+
+    // the memory holds what another texture of the slot left there
+    if(!write) {
+        entry.persistent = true;
+        mConflict        = true;
+    }
+    slot->owner = texture;
+
+    return true;
+}
+
+void
+TransientTexturePool::PlanSlots(std::vector<uint32_t> *plan, std::vector<VkMemoryRequirements> *slots)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::vector<Entry_t *> entries;
+    std::vector<uint32_t>  order;
+    for(auto &it : mEntries) {
+        if(it.second.used && !it.second.persistent && it.second.requirements.size) {
+            order.push_back(static_cast<uint32_t>(entries.size()));
+        }
+        entries.push_back(&it.second);
+    }
+    std::sort(order.begin(), order.end(), [&entries](uint32_t a, uint32_t b) { return entries[a]->first < entries[b]->first; });
+
+    // textures unused in the frame, or whose contents survive it, keep a slot of their own
+    plan->assign(entries.size(), UINT32_MAX);
+    slots->clear();
+
+    // in the order of their first use, textures join the slot closest in size to them among
+    // those whose textures are all done with by then, or get a new one
+    std::vector<uint32_t> slotEnds;
+    for(uint32_t index : order) {
+        const Entry_t              *entry        = entries[index];
+        const VkMemoryRequirements &requirements = entry->requirements;
+
+        uint32_t     best     = UINT32_MAX;
+        VkDeviceSize bestCost = 0;
+        for(uint32_t i = 0; i < slots->size(); ++i) {
+            if(slotEnds[i] >= entry->first || !((*slots)[i].memoryTypeBits & requirements.memoryTypeBits)) {
+                continue;
+            }
+
+            const VkDeviceSize cost = (*slots)[i].size > requirements.size ? (*slots)[i].size - requirements.size :
+                                                                             requirements.size - (*slots)[i].size;
+            if(best == UINT32_MAX || cost < bestCost) {
+                best     = i;
+                bestCost = cost;
+            }
+        }
+
+        if(best == UINT32_MAX) {
+            best = static_cast<uint32_t>(slots->size());
+            slots->push_back(requirements);
+            slotEnds.push_back(entry->last);
+        } else {
+            VkMemoryRequirements &slot = (*slots)[best];
+            slot.size            = std::max(slot.size, requirements.size);
+            slot.alignment       = std::max(slot.alignment, requirements.alignment);
+            slot.memoryTypeBits &= requirements.memoryTypeBits;
+            slotEnds[best]       = entry->last;
+        }
+        (*plan)[index] = best;
+    }
+
+    // a slot of a single texture is no different from the one it already has
+    std::vector<uint32_t> slotUsers(slots->size(), 0);
+    for(uint32_t slot : *plan) {
+        if(slot != UINT32_MAX) {
+            ++slotUsers[slot];
+        }
+    }
+    for(uint32_t &slot : *plan) {
+        if(slot != UINT32_MAX && slotUsers[slot] == 1) {
+            slot = UINT32_MAX;
+        }
+    }
+}
+
+void
+TransientTexturePool::ResetFrame(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto &it : mEntries) {
+        it.second.used  = false;
+        it.second.first = 0;
+        it.second.last  = 0;
+    }
+    mClock    = 0;
+    mConflict = false;
+}
+
+std::vector<Texture *>
+TransientTexturePool::EndFrame(vulkanAPI::CommandBufferManager *commandBufferManager)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::vector<Texture *> released;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    std::vector<uint32_t>             plan;
+    std::vector<VkMemoryRequirements> slots;
+    PlanSlots(&plan, &slots);
+
+    // a different order of use has to repeat for a few frames before the textures move, unless they were aliased wrongly
+    if(plan == mCurrentPlan) {
+        mPendingPlan.clear();
+        mStableFrames = 0;
+        ResetFrame();
+        return released;
+    }
+
+    if(plan == mPendingPlan) {
+        ++mStableFrames;
+    } else {
+        mPendingPlan  = plan;
+        mStableFrames = 1;
+    }
+
+    if(!mConflict && mStableFrames < GLOVE_TRANSIENT_STABLE_FRAMES) {
+        ResetFrame();
+        return released;
+    }
+
+    // the images about to be released may still be used by the frames in flight
+    commandBufferManager->WaitLastSubmition();
+
+    std::vector<Slot_t *> planned(slots.size(), nullptr);
+    uint32_t index = 0;
+    for(auto &it : mEntries) {
+        Entry_t &entry = it.second;
+        Slot_t  *slot  = nullptr;
+        if(plan[index] != UINT32_MAX) {
+            if(!planned[plan[index]]) {
+                planned[plan[index]] = CreateSlot(&slots[plan[index]]);
+            }
+            slot = planned[plan[index]];
+        }
+        ++index;
+
+        if(entry.planned) {
+            --entry.planned->planned;
+        }
+        entry.planned = slot;
+        if(slot) {
+            ++slot->planned;
+        }
+
+        // a texture left on its own keeps the slot it already has, if it does not share it
+        if(entry.slot && (slot || entry.slot->users > 1)) {
+            released.push_back(it.first);
+        }
+    }
+    ReleaseUnusedSlots();
+
+    mCurrentPlan = plan;
+    mPendingPlan.clear();
+    mStableFrames = 0;
+    ResetFrame();
+
+    return released;
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       transientTexturePool.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Aliasing of the memory of transient textures whose uses within a frame do not overlap
+ *
+ */
+
+#ifndef __TRANSIENTTEXTUREPOOL_H__
+#define __TRANSIENTTEXTUREPOOL_H__
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "vulkan/memory.h"
+
+/// Number of successive frames that have to use the transient textures in the same order before their memory is aliased anew
+#define GLOVE_TRANSIENT_STABLE_FRAMES                   3
+
+class Texture;
+
+namespace vulkanAPI {
+    class CommandBufferManager;
+}
+
+class TransientTexturePool {
+private:
+    typedef struct Slot_t {
+        vulkanAPI::Memory                  *memory;
+        VkDeviceSize                        size;
+        uint32_t                            memoryTypeBits;
+        /// the texture whose contents the memory holds, the others have to discard theirs before their next use
+        Texture                            *owner;
+        /// textures bound to the memory, and textures planned to be bound to it when they are next allocated
+        uint32_t                            users;
+        uint32_t                            planned;
+    } Slot_t;
+
+    typedef struct Entry_t {
+        Slot_t                             *slot;
+        Slot_t                             *planned;
+        VkMemoryRequirements                requirements;
+        /// clock of the first and the last use in the current frame
+        uint32_t                            first;
+        uint32_t                            last;
+        bool                                used;
+        /// the contents were read after another texture of the slot had been used, they are never aliased again
+        bool                                persistent;
+    } Entry_t;
+
+    const vulkanAPI::vkContext_t           *mVkContext;
+    std::mutex                              mMutex;
+
+    std::map<Texture *, Entry_t>            mEntries;
+    std::vector<Slot_t *>                   mSlots;
+    uint32_t                                mClock;
+    bool                                    mConflict;
+
+    /// the slot of each texture as planned by the last frames, in the order of mEntries
+    std::vector<uint32_t>                   mCurrentPlan;
+    std::vector<uint32_t>                   mPendingPlan;
+    uint32_t                                mStableFrames;
+
+    Slot_t                                 *CreateSlot(const VkMemoryRequirements *requirements);
+    void                                    ReleaseSlot(Slot_t *slot);
+    void                                    ReleaseUnusedSlots(void);
+    void                                    Unbind(Entry_t *entry, Texture *texture);
+    void                                    PlanSlots(std::vector<uint32_t> *plan, std::vector<VkMemoryRequirements> *slots);
+    void                                    ResetFrame(void);
+
+public:
+// Constructor
+    TransientTexturePool(const vulkanAPI::vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~TransientTexturePool();
+
+// Register Functions
+    void                                    Register(Texture *texture);
+    void                                    Unregister(Texture *texture);
+
+// Bind Functions
+    bool                                    Bind(Texture *texture, VkImage image);
+    void                                    Unbind(Texture *texture);
+
+// Use Functions
+    bool                                    Touch(Texture *texture, bool write);
+
+// Frame Functions
+    std::vector<Texture *>                  EndFrame(vulkanAPI::CommandBufferManager *commandBufferManager);
+};
+
+#endif // __TRANSIENTTEXTUREPOOL_H__
@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       vertexArray.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Vertex Array Object Functionality in GLOVE
+ *
+ *  A vertex array object holds the generic vertex attribute arrays and the
+ *  element array buffer binding, so that a mesh is switched to with a single
+ *  bind. Each context has a default one, bound while no other is.
+ */
+
+#include "vertexArray.h"
+#include <cstring>
+
+/// 0 is never handed out, so that it stands for a layout yet to be built
+std::atomic<uint64_t> VertexArray::mNextLayoutSerial(1);
+
+VertexArray::VertexArray(const vulkanAPI::vkContext_t *vkContext, CacheManager *cacheManager)
+: mAttributes(GLOVE_MAX_VERTEX_ATTRIBS), mElementArrayBuffer(nullptr)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto& gva : mAttributes) {
+        gva.SetVkContext(vkContext);
+        gva.SetCacheManager(cacheManager);
+    }
+
+    InvalidateLayout();
+}
+
+VertexArray::~VertexArray()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto& gva : mAttributes) {
+        gva.Release();
+    }
+}
+
+void
+VertexArray::CopyGenericValues(const VertexArray *vertexArray)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a value written again is streamed anew, so only the ones that differ are set
+    for(GLuint i = 0; i < GLOVE_MAX_VERTEX_ATTRIBS; ++i) {
+        GLfloat src[4], dst[4];
+        vertexArray->GetAttribute(i).GetGenericValue(src);
+        mAttributes[i].GetGenericValue(dst);
+        if(memcmp(src, dst, sizeof(src))) {
+            mAttributes[i].SetGenericValue(src);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       vertexArray.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Vertex Array Object Functionality in GLOVE
+ *
+ */
+
+#ifndef __VERTEXARRAY_H__
+#define __VERTEXARRAY_H__
+
+#include "genericVertexAttribute.h"
+#include <atomic>
+#include <vector>
+
+class VertexArray {
+private:
+    std::vector<GenericVertexAttribute> mAttributes;
+    BufferObject                       *mElementArrayBuffer;
+
+    /// identifies the attribute formats, strides, divisors and buffers, which the vertex input layout
+    /// programs build from them depends on; a new one is taken from a process wide counter on every change
+    uint64_t                            mLayoutSerial;
+    static std::atomic<uint64_t>        mNextLayoutSerial;
+
+public:
+    VertexArray(const vulkanAPI::vkContext_t *vkContext, CacheManager *cacheManager);
+    ~VertexArray();
+
+    /// the current values of the attributes are state of the context, which carries them over on bind
+    void                                CopyGenericValues(const VertexArray *vertexArray);
+
+    // Get Functions
+    inline std::vector<GenericVertexAttribute> &GetAttributes(void)               { FUN_ENTRY(GL_LOG_TRACE); return mAttributes; }
+    inline GenericVertexAttribute      &GetAttribute(GLuint index)                { FUN_ENTRY(GL_LOG_TRACE); return mAttributes[index]; }
+    inline const GenericVertexAttribute &GetAttribute(GLuint index)        const { FUN_ENTRY(GL_LOG_TRACE); return mAttributes[index]; }
+    inline BufferObject                *GetElementArrayBuffer(void)         const { FUN_ENTRY(GL_LOG_TRACE); return mElementArrayBuffer; }
+    inline uint64_t                     GetLayoutSerial(void)               const { FUN_ENTRY(GL_LOG_TRACE); return mLayoutSerial; }
+
+    // Set Functions
+    inline void                         SetElementArrayBuffer(BufferObject *ibo)  { FUN_ENTRY(GL_LOG_TRACE); mElementArrayBuffer = ibo; }
+    inline void                         InvalidateLayout(void)                    { FUN_ENTRY(GL_LOG_TRACE); mLayoutSerial = mNextLayoutSerial.fetch_add(1, std::memory_order_relaxed); }
+};
+
+#endif // __VERTEXARRAY_H__
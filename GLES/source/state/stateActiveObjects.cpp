@@ -32,8 +32,10 @@
 StateActiveObjects::StateActiveObjects()
 : mActiveShaderProgram(nullptr),
 mActiveFramebufferObjectID(0),
+mActiveReadFramebufferObjectID(0),
 mActiveRenderbufferObjectID(0),
-mActiveTextureUnit(GL_TEXTURE0)
+mActiveTextureUnit(GL_TEXTURE0),
+mGeneration(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -41,6 +43,18 @@ mActiveTextureUnit(GL_TEXTURE0)
         mActiveBufferObjects[i] = nullptr;
     }
 
+    for(uint32_t i=0; i<GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS; ++i) {
+        mShaderStorageBindings[i] = {nullptr, 0, 0};
+    }
+
+    for(uint32_t i=0; i<GLOVE_MAX_UNIFORM_BUFFER_BINDINGS; ++i) {
+        mUniformBufferBindings[i] = {nullptr, 0, 0};
+    }
+
+    for(uint32_t i=0; i<GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS; ++i) {
+        mTransformFeedbackBindings[i] = {nullptr, 0, 0};
+    }
+
     memset(static_cast<void *>(mActiveTextures), 0, sizeof(mActiveTextures));
 }
 
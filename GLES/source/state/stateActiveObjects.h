@@ -28,7 +28,13 @@
 #include "resources/bufferObject.h"
 #include "resources/texture.h"
 
-#define GL_BUFFER_TARGET_TO_TYPE(__target__)  ((__target__) == GL_ARRAY_BUFFER ? BUFFER_OBJECT_TARGET_ARRAY : BUFFER_OBJECT_TARGET_ELEMENT)
+#define GL_BUFFER_TARGET_TO_TYPE(__target__)  ((__target__) == GL_ARRAY_BUFFER          ? BUFFER_OBJECT_TARGET_ARRAY          : \
+                                               (__target__) == GL_ELEMENT_ARRAY_BUFFER  ? BUFFER_OBJECT_TARGET_ELEMENT        : \
+                                               (__target__) == GL_DRAW_INDIRECT_BUFFER  ? BUFFER_OBJECT_TARGET_DRAW_INDIRECT  : \
+                                               (__target__) == GL_SHADER_STORAGE_BUFFER ? BUFFER_OBJECT_TARGET_SHADER_STORAGE : \
+                                               (__target__) == GL_UNIFORM_BUFFER        ? BUFFER_OBJECT_TARGET_UNIFORM        : \
+                                               (__target__) == GL_TRANSFORM_FEEDBACK_BUFFER ? BUFFER_OBJECT_TARGET_TRANSFORM_FEEDBACK : \
+                                               (__target__) == GL_PIXEL_UNPACK_BUFFER_NV ? BUFFER_OBJECT_TARGET_PIXEL_UNPACK : BUFFER_OBJECT_TARGET_PIXEL_PACK)
 #define GL_TEXTURE_TARGET_TO_TYPE(__target__) ((__target__) == GL_TEXTURE_2D ? 0 : 1)
 #define GL_TEXTURE_ENUM_TO_UNIT(__enum__)     ((__enum__) - GL_TEXTURE0)
 
@@ -37,15 +43,38 @@ private:
       typedef enum {
         BUFFER_OBJECT_TARGET_ARRAY = 0,
         BUFFER_OBJECT_TARGET_ELEMENT,
+        BUFFER_OBJECT_TARGET_PIXEL_PACK,
+        BUFFER_OBJECT_TARGET_DRAW_INDIRECT,
+        BUFFER_OBJECT_TARGET_SHADER_STORAGE,
+        BUFFER_OBJECT_TARGET_UNIFORM,
+        BUFFER_OBJECT_TARGET_TRANSFORM_FEEDBACK,
+        BUFFER_OBJECT_TARGET_PIXEL_UNPACK,
         BUFFER_OBJECT_TARGET_ALL
       } BufferObjectTarget_t;
 
+      typedef struct IndexedBufferBinding_t {
+        BufferObject*           buffer;
+        GLintptr                offset;
+        /// 0 binds what follows the offset, whatever the size of the buffer
+        GLsizeiptr              size;
+      } IndexedBufferBinding_t;
+
       BufferObject*             mActiveBufferObjects[BUFFER_OBJECT_TARGET_ALL];
+      /// the bindings of GL_SHADER_STORAGE_BUFFER the storage blocks of compute programs read and write
+      IndexedBufferBinding_t    mShaderStorageBindings[GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS];
+      /// those of GL_UNIFORM_BUFFER the uniform blocks of compute programs read
+      IndexedBufferBinding_t    mUniformBufferBindings[GLOVE_MAX_UNIFORM_BUFFER_BINDINGS];
+      /// and those of GL_TRANSFORM_FEEDBACK_BUFFER the captured outputs of vertex shaders are written to
+      IndexedBufferBinding_t    mTransformFeedbackBindings[GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS];
       ShaderProgram*            mActiveShaderProgram;
       GLuint                    mActiveFramebufferObjectID;
+      /// the framebuffer blits read from, bound apart through GL_READ_FRAMEBUFFER_ANGLE
+      GLuint                    mActiveReadFramebufferObjectID;
       GLuint                    mActiveRenderbufferObjectID;
       GLenum                    mActiveTextureUnit;
       Texture *                 mActiveTextures[2][GLOVE_MAX_COMBINED_TEXTURE_IMAGE_UNITS];
+      /// changes along with any of the bindings, so that what is derived from them knows when to derive it again
+      uint32_t                  mGeneration;
 
 public:
       StateActiveObjects();
@@ -58,21 +87,39 @@ public:
       inline BufferObject*      GetActiveBufferObject(BufferObjectTarget_t target)         { FUN_ENTRY(GL_LOG_TRACE); return mActiveBufferObjects[target]; }
       inline BufferObject*      GetActiveBufferObject(GLenum target)                       { FUN_ENTRY(GL_LOG_TRACE); return GetActiveBufferObject(GL_BUFFER_TARGET_TO_TYPE(target)); }
       inline uint32_t           GetActiveFramebufferObjectID(void)                  const  { FUN_ENTRY(GL_LOG_TRACE); return mActiveFramebufferObjectID; }
+      inline uint32_t           GetActiveReadFramebufferObjectID(void)              const  { FUN_ENTRY(GL_LOG_TRACE); return mActiveReadFramebufferObjectID; }
       inline uint32_t           GetActiveRenderbufferObjectID(void)                 const  { FUN_ENTRY(GL_LOG_TRACE); return mActiveRenderbufferObjectID; }
       inline GLenum             GetActiveTextureUnit(void)                          const  { FUN_ENTRY(GL_LOG_TRACE); return mActiveTextureUnit; }
+      inline uint32_t           GetGeneration(void)                                 const  { FUN_ENTRY(GL_LOG_TRACE); return mGeneration; }
+      inline BufferObject*      GetShaderStorageBuffer(GLuint index)                const  { FUN_ENTRY(GL_LOG_TRACE); return mShaderStorageBindings[index].buffer; }
+      inline GLintptr           GetShaderStorageOffset(GLuint index)                const  { FUN_ENTRY(GL_LOG_TRACE); return mShaderStorageBindings[index].offset; }
+      inline GLsizeiptr         GetShaderStorageSize(GLuint index)                  const  { FUN_ENTRY(GL_LOG_TRACE); return mShaderStorageBindings[index].size; }
+      inline BufferObject*      GetUniformBuffer(GLuint index)                      const  { FUN_ENTRY(GL_LOG_TRACE); return mUniformBufferBindings[index].buffer; }
+      inline GLintptr           GetUniformBufferOffset(GLuint index)                const  { FUN_ENTRY(GL_LOG_TRACE); return mUniformBufferBindings[index].offset; }
+      inline GLsizeiptr         GetUniformBufferSize(GLuint index)                  const  { FUN_ENTRY(GL_LOG_TRACE); return mUniformBufferBindings[index].size; }
+      inline BufferObject*      GetTransformFeedbackBuffer(GLuint index)            const  { FUN_ENTRY(GL_LOG_TRACE); return mTransformFeedbackBindings[index].buffer; }
+      inline GLintptr           GetTransformFeedbackOffset(GLuint index)            const  { FUN_ENTRY(GL_LOG_TRACE); return mTransformFeedbackBindings[index].offset; }
+      inline GLsizeiptr         GetTransformFeedbackSize(GLuint index)              const  { FUN_ENTRY(GL_LOG_TRACE); return mTransformFeedbackBindings[index].size; }
 
 // Set Functions
-      inline void               SetActiveTexture(GLenum target, Texture *tex)              { FUN_ENTRY(GL_LOG_TRACE); mActiveTextures[GL_TEXTURE_TARGET_TO_TYPE(target)][GL_TEXTURE_ENUM_TO_UNIT(mActiveTextureUnit)] = tex; }
-      inline void               SetActiveTexture(GLenum target, int j, Texture *tex)       { FUN_ENTRY(GL_LOG_TRACE); mActiveTextures[GL_TEXTURE_TARGET_TO_TYPE(target)][j] = tex; }
-      inline void               SetActiveTextureUnit(GLenum tex)                           { FUN_ENTRY(GL_LOG_TRACE); mActiveTextureUnit = tex; }
-      inline void               SetActiveFramebufferObjectID(GLuint id)                    { FUN_ENTRY(GL_LOG_TRACE); mActiveFramebufferObjectID  = id; }
-      inline void               SetActiveRenderbufferObjectID(GLuint id)                   { FUN_ENTRY(GL_LOG_TRACE); mActiveRenderbufferObjectID = id; }
-      inline void               SetActiveShaderProgram(ShaderProgram *program)             { FUN_ENTRY(GL_LOG_TRACE); mActiveShaderProgram = program; }
+      inline void               SetActiveTexture(GLenum target, Texture *tex)              { FUN_ENTRY(GL_LOG_TRACE); mActiveTextures[GL_TEXTURE_TARGET_TO_TYPE(target)][GL_TEXTURE_ENUM_TO_UNIT(mActiveTextureUnit)] = tex; ++mGeneration; }
+      inline void               SetActiveTexture(GLenum target, int j, Texture *tex)       { FUN_ENTRY(GL_LOG_TRACE); mActiveTextures[GL_TEXTURE_TARGET_TO_TYPE(target)][j] = tex; ++mGeneration; }
+      inline void               SetActiveTextureUnit(GLenum tex)                           { FUN_ENTRY(GL_LOG_TRACE); mActiveTextureUnit = tex; ++mGeneration; }
+      inline void               SetActiveFramebufferObjectID(GLuint id)                    { FUN_ENTRY(GL_LOG_TRACE); mActiveFramebufferObjectID  = id; ++mGeneration; }
+      inline void               SetActiveReadFramebufferObjectID(GLuint id)                { FUN_ENTRY(GL_LOG_TRACE); mActiveReadFramebufferObjectID = id; ++mGeneration; }
+      inline void               SetActiveRenderbufferObjectID(GLuint id)                   { FUN_ENTRY(GL_LOG_TRACE); mActiveRenderbufferObjectID = id; ++mGeneration; }
+      inline void               SetActiveShaderProgram(ShaderProgram *program)             { FUN_ENTRY(GL_LOG_TRACE); mActiveShaderProgram = program; ++mGeneration; }
       inline void               SetActiveBufferObject(BufferObjectTarget_t target,
-                                                      BufferObject *bo)                    { FUN_ENTRY(GL_LOG_TRACE); mActiveBufferObjects[target] = bo; }
+                                                      BufferObject *bo)                    { FUN_ENTRY(GL_LOG_TRACE); mActiveBufferObjects[target] = bo; ++mGeneration; }
       inline void               SetActiveBufferObject(GLenum target,
                                                       BufferObject *bo)                    { FUN_ENTRY(GL_LOG_TRACE); SetActiveBufferObject(GL_BUFFER_TARGET_TO_TYPE(target), bo); }
       inline void               ResetActiveBufferObject(GLenum target)                     { FUN_ENTRY(GL_LOG_TRACE); SetActiveBufferObject(target, nullptr); }
+      inline void               SetShaderStorageBinding(GLuint index, BufferObject *bo,
+                                                        GLintptr offset, GLsizeiptr size)  { FUN_ENTRY(GL_LOG_TRACE); mShaderStorageBindings[index] = {bo, offset, size}; ++mGeneration; }
+      inline void               SetUniformBufferBinding(GLuint index, BufferObject *bo,
+                                                        GLintptr offset, GLsizeiptr size)  { FUN_ENTRY(GL_LOG_TRACE); mUniformBufferBindings[index] = {bo, offset, size}; ++mGeneration; }
+      inline void               SetTransformFeedbackBinding(GLuint index, BufferObject *bo,
+                                                            GLintptr offset, GLsizeiptr size) { FUN_ENTRY(GL_LOG_TRACE); mTransformFeedbackBindings[index] = {bo, offset, size}; ++mGeneration; }
 
 // Equals/Is Functions
       inline bool               EqualsActiveBufferObject(BufferObject *bo)                 { FUN_ENTRY(GL_LOG_TRACE); return GetActiveBufferObject(bo->GetTarget()) == bo; }
@@ -311,9 +311,10 @@ bool StateFragmentOperations::UpdateStencilTestFunc(GLenum face, GLenum func, GL
 
     bool res = true;
     StencilOperations& stencilOperations = (face == GL_FRONT) ? mStencilOperations[SF_FRONT] : mStencilOperations[SF_BACK];
+    ref = CLAMP(ref, 0, 0xFF);
     res = (stencilOperations.GetFuncCompare() != func) || (stencilOperations.GetFuncRef() != ref) || (stencilOperations.GetFuncMask() != mask);
     stencilOperations.SetFuncCompare(func);
-    stencilOperations.SetFuncRef(CLAMP(ref, 0, 0xFF));
+    stencilOperations.SetFuncRef(ref);
     stencilOperations.SetFuncMask(mask);
 
     return res;
@@ -45,6 +45,9 @@ public:
       inline bool             UpdatePrimitiveMode(GLenum pMode)                 { FUN_ENTRY(GL_LOG_TRACE); bool res = mPrimitiveMode != pMode;
                                                                                                        mPrimitiveMode = pMode;
                                                                                                        return res; }
+      inline bool             UpdatePrimitiveRestartEnabled(GLboolean enable)   { FUN_ENTRY(GL_LOG_TRACE); bool res = mPrimitiveRestartEnabled != enable;
+                                                                                                       mPrimitiveRestartEnabled = enable;
+                                                                                                       return res; }
 };
 
 #endif //__STATEINPUTASSEMBLY_H__
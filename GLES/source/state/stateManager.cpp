@@ -32,7 +32,7 @@
 #include "stateManager.h"
 
 StateManager::StateManager()
-: mError(GL_NO_ERROR)
+: mError(GL_NO_ERROR), mDirtyState(STATE_DIRTY_NONE), mColorAttachmentRGB(false), mInvertedFrontFace(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -55,6 +55,8 @@ StateManager::IsCapabilityEnabled(GLenum cap)
     case GL_DEPTH_TEST:               res = mFragmentOperationsState.GetDepthTestEnabled();             break;
     case GL_DITHER:                   res = mFragmentOperationsState.GetDitheringEnabled();             break;
     case GL_POLYGON_OFFSET_FILL:      res = mRasterizationState.GetPolygonOffsetFillEnabled();          break;
+    case GL_RASTERIZER_DISCARD:       res = mRasterizationState.GetRasterizerDiscardEnabled();          break;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX: res = mInputAssemblyState.GetPrimitiveRestartEnabled();      break;
     case GL_SAMPLE_ALPHA_TO_COVERAGE: res = mFragmentOperationsState.GetSampleAlphaToCoverageEnabled(); break;
     case GL_SAMPLE_COVERAGE:          res = mFragmentOperationsState.GetSampleCoverageEnabled();        break;
     case GL_SCISSOR_TEST:             res = mFragmentOperationsState.GetScissorTestEnabled();           break;
@@ -139,7 +141,130 @@ StateManager::InitVkPipelineStates(vulkanAPI::Pipeline *pipeline)
     pipeline->CreateMultisampleState(alphaToOneEnable, alphaToCoverageEnable, rasterizationSamples, sampleShadingEnable, minSampleShading);
     std::vector<VkDynamicState> states = {VK_DYNAMIC_STATE_VIEWPORT,
                                           VK_DYNAMIC_STATE_SCISSOR,
-                                          VK_DYNAMIC_STATE_LINE_WIDTH};
+                                          VK_DYNAMIC_STATE_LINE_WIDTH,
+                                          VK_DYNAMIC_STATE_DEPTH_BIAS,
+                                          VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+                                          VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
+                                          VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+                                          VK_DYNAMIC_STATE_STENCIL_REFERENCE};
+#ifdef VK_EXT_extended_dynamic_state
+    if(vulkanAPI::GetContext()->mIsExtendedDynamicStateSupported) {
+        states.insert(states.end(), {VK_DYNAMIC_STATE_CULL_MODE_EXT,
+                                     VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+                                     VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+                                     VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+                                     VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+                                     VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT,
+                                     VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT});
+    }
+#endif // VK_EXT_extended_dynamic_state
     pipeline->CreateDynamicState(states);
     pipeline->CreateInfo();
 }
+
+void
+StateManager::UpdateVkPipelineStates(vulkanAPI::Pipeline *pipeline, bool colorAttachmentRGB, bool invertedFrontFace)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mColorAttachmentRGB != colorAttachmentRGB) {
+        mColorAttachmentRGB = colorAttachmentRGB;
+        mDirtyState        |= STATE_DIRTY_COLOR_MASK;
+    }
+
+    // framebuffers rendered without the Y flip mirror the winding of every primitive
+    if(mInvertedFrontFace != invertedFrontFace) {
+        mInvertedFrontFace  = invertedFrontFace;
+        mDirtyState        |= STATE_DIRTY_CULL;
+    }
+
+    if(mDirtyState == STATE_DIRTY_NONE) {
+        return;
+    }
+
+    if(mDirtyState & STATE_DIRTY_BLEND) {
+        pipeline->SetColorBlendAttachmentEnable(GlBooleanToVkBool(GetFragmentOperationsState()->GetBlendingEnabled()));
+        pipeline->SetColorBlendAttachmentColorOp(GlBlendEquationToVkBlendOp(GetFragmentOperationsState()->GetBlendingEquationRGB()));
+        pipeline->SetColorBlendAttachmentAlphaOp(GlBlendEquationToVkBlendOp(GetFragmentOperationsState()->GetBlendingEquationAlpha()));
+        pipeline->SetColorBlendAttachmentSrcColorFactor(GlBlendFactorToVkBlendFactor(GetFragmentOperationsState()->GetBlendingFactorSourceRGB()));
+        pipeline->SetColorBlendAttachmentDstColorFactor(GlBlendFactorToVkBlendFactor(GetFragmentOperationsState()->GetBlendingFactorDestinationRGB()));
+        pipeline->SetColorBlendAttachmentSrcAlphaFactor(GlBlendFactorToVkBlendFactor(GetFragmentOperationsState()->GetBlendingFactorSourceAlpha()));
+        pipeline->SetColorBlendAttachmentDstAlphaFactor(GlBlendFactorToVkBlendFactor(GetFragmentOperationsState()->GetBlendingFactorDestinationAlpha()));
+    }
+
+    if(mDirtyState & STATE_DIRTY_BLEND_COLOR) {
+        GLfloat blendcolor[4];
+        GetFragmentOperationsState()->GetBlendingColor(blendcolor);
+        pipeline->SetColorBlendConstants(blendcolor);
+    }
+
+    if(mDirtyState & STATE_DIRTY_COLOR_MASK) {
+        GLubyte colorMask = GetFramebufferOperationsState()->GetColorMask();
+        if(mColorAttachmentRGB) {
+            GLboolean colormask[4];
+            GetFramebufferOperationsState()->GetColorMask(colormask);
+            colorMask = GlColorMaskPack(colormask[0], colormask[1], colormask[2], GL_FALSE);
+        }
+        pipeline->SetColorBlendAttachmentWriteMask(GLColorMaskToVkColorComponentFlags(colorMask));
+    }
+
+    if(mDirtyState & STATE_DIRTY_DEPTH) {
+        pipeline->SetDepthTestEnable(GlBooleanToVkBool(GetFragmentOperationsState()->GetDepthTestEnabled()));
+        pipeline->SetDepthWriteEnable(GlBooleanToVkBool(GetFramebufferOperationsState()->GetDepthMask()));
+        pipeline->SetDepthCompareOp(GlCompareFuncToVkCompareOp(GetFragmentOperationsState()->GetDepthTestFunc()));
+    }
+
+    if(mDirtyState & STATE_DIRTY_STENCIL) {
+        pipeline->SetStencilTestEnable(GlBooleanToVkBool(GetFragmentOperationsState()->GetStencilTestEnabled()));
+
+        pipeline->SetStencilFrontCompareOp(GlCompareFuncToVkCompareOp(GetFragmentOperationsState()->GetStencilTestFuncCompareFront()));
+        pipeline->SetStencilFrontCompareMask(GetFragmentOperationsState()->GetStencilTestFuncMaskFront());
+        pipeline->SetStencilFrontReference(GetFragmentOperationsState()->GetStencilTestFuncRefFront());
+        pipeline->SetStencilFrontFailOp (GlStencilFuncToVkStencilOp(GetFragmentOperationsState()->GetStencilTestOpFailFront()));
+        pipeline->SetStencilFrontZFailOp(GlStencilFuncToVkStencilOp(GetFragmentOperationsState()->GetStencilTestOpZfailFront()));
+        pipeline->SetStencilFrontPassOp (GlStencilFuncToVkStencilOp(GetFragmentOperationsState()->GetStencilTestOpZpassFront()));
+
+        pipeline->SetStencilBackCompareOp(GlCompareFuncToVkCompareOp(GetFragmentOperationsState()->GetStencilTestFuncCompareBack()));
+        pipeline->SetStencilBackCompareMask(GetFragmentOperationsState()->GetStencilTestFuncMaskBack());
+        pipeline->SetStencilBackReference(GetFragmentOperationsState()->GetStencilTestFuncRefBack());
+        pipeline->SetStencilBackFailOp (GlStencilFuncToVkStencilOp(GetFragmentOperationsState()->GetStencilTestOpFailBack()));
+        pipeline->SetStencilBackZFailOp(GlStencilFuncToVkStencilOp(GetFragmentOperationsState()->GetStencilTestOpZfailBack()));
+        pipeline->SetStencilBackPassOp (GlStencilFuncToVkStencilOp(GetFragmentOperationsState()->GetStencilTestOpZpassBack()));
+    }
+
+    if(mDirtyState & STATE_DIRTY_STENCIL_MASK) {
+        pipeline->SetStencilFrontWriteMask(GetFramebufferOperationsState()->GetStencilMaskFront());
+        pipeline->SetStencilBackWriteMask(GetFramebufferOperationsState()->GetStencilMaskBack());
+    }
+
+    if(mDirtyState & STATE_DIRTY_CULL) {
+        pipeline->SetRasterizationCullMode(GlBooleanToVkBool(GetRasterizationState()->GetCullEnabled()),
+                                           GlCullModeToVkCullMode(GetRasterizationState()->GetCullFace()));
+
+        VkFrontFace frontFace = GlFrontFaceToVkFrontFace(GetRasterizationState()->GetFrontFace());
+        if(mInvertedFrontFace) {
+            frontFace = frontFace == VK_FRONT_FACE_COUNTER_CLOCKWISE ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        }
+        pipeline->SetRasterizationFrontFace(frontFace);
+    }
+
+    if(mDirtyState & STATE_DIRTY_POLYGON_OFFSET) {
+        pipeline->SetRasterizationDepthBiasEnable(GlBooleanToVkBool(GetRasterizationState()->GetPolygonOffsetFillEnabled()));
+        pipeline->SetRasterizationDepthBiasConstantFactor(GetRasterizationState()->GetPolygonOffsetFactor());
+        pipeline->SetRasterizationDepthBiasSlopeFactor(GetRasterizationState()->GetPolygonOffsetUnits());
+    }
+
+    if(mDirtyState & STATE_DIRTY_MULTISAMPLE) {
+        pipeline->SetMultisampleAlphaToCoverage(GlBooleanToVkBool(GetFragmentOperationsState()->GetSampleAlphaToCoverageEnabled()));
+    }
+
+    if(mDirtyState & STATE_DIRTY_RASTERIZER_DISCARD) {
+        pipeline->SetRasterizationRasterizerDiscardEnable(GlBooleanToVkBool(GetRasterizationState()->GetRasterizerDiscardEnabled()));
+    }
+
+    if(mDirtyState & STATE_DIRTY_PRIMITIVE_RESTART) {
+        pipeline->SetInputAssemblyPrimitiveRestartEnable(GlBooleanToVkBool(GetInputAssemblyState()->GetPrimitiveRestartEnabled()));
+    }
+
+    mDirtyState = STATE_DIRTY_NONE;
+}
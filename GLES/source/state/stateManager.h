@@ -34,6 +34,23 @@
 #include "stateHintAspects.h"
 #include "vulkan/pipeline.h"
 
+/// Categories of GL state that need to be translated to the Vulkan pipeline
+typedef enum {
+    STATE_DIRTY_NONE                = 0,
+    STATE_DIRTY_BLEND               = (1 << 0),
+    STATE_DIRTY_BLEND_COLOR         = (1 << 1),
+    STATE_DIRTY_COLOR_MASK          = (1 << 2),
+    STATE_DIRTY_DEPTH               = (1 << 3),
+    STATE_DIRTY_STENCIL             = (1 << 4),
+    STATE_DIRTY_STENCIL_MASK        = (1 << 5),
+    STATE_DIRTY_CULL                = (1 << 6),
+    STATE_DIRTY_POLYGON_OFFSET      = (1 << 7),
+    STATE_DIRTY_MULTISAMPLE         = (1 << 8),
+    STATE_DIRTY_RASTERIZER_DISCARD  = (1 << 9),
+    STATE_DIRTY_PRIMITIVE_RESTART   = (1 << 10),
+    STATE_DIRTY_ALL                 = (1 << 11) - 1
+} stateDirtyBits_t;
+
 class StateManager {
 
 private:
@@ -47,6 +64,10 @@ private:
       StateHintAspects                        mHintAspectsState;
 
       GLenum                                  mError;
+
+      uint32_t                                mDirtyState;
+      bool                                    mColorAttachmentRGB;
+      bool                                    mInvertedFrontFace;
 public:
 
        StateManager();
@@ -58,6 +79,9 @@ public:
 // Init Functions
              void                             InitVkPipelineStates(vulkanAPI::Pipeline *pipeline);
 
+// Update Functions
+             void                             UpdateVkPipelineStates(vulkanAPI::Pipeline *pipeline, bool colorAttachmentRGB, bool invertedFrontFace);
+
 // Get Functions
       inline StateActiveObjects*              GetActiveObjectsState(void)             { FUN_ENTRY(GL_LOG_TRACE); return &mActiveObjectsState; }
       inline StateViewportTransformation*     GetViewportTransformationState(void)    { FUN_ENTRY(GL_LOG_TRACE); return &mViewportTransformationState; }
@@ -69,9 +93,11 @@ public:
       inline StateHintAspects*                GetHintAspectsState(void)               { FUN_ENTRY(GL_LOG_TRACE); return &mHintAspectsState; }
       inline ShaderProgram*                   GetActiveShaderProgram(void)            { FUN_ENTRY(GL_LOG_TRACE); return mActiveObjectsState.GetActiveShaderProgram(); }
       inline GLenum                           GetError(void)                          { FUN_ENTRY(GL_LOG_TRACE); return mError;  }
+      inline uint32_t                         GetDirtyState(void)               const { FUN_ENTRY(GL_LOG_TRACE); return mDirtyState; }
 
 // Set Functions
       inline void                             SetError(GLenum error)                  { FUN_ENTRY(GL_LOG_TRACE); mError = error; }
+      inline void                             SetDirtyState(uint32_t bits)            { FUN_ENTRY(GL_LOG_TRACE); mDirtyState |= bits; }
 };
 
 #endif // __STATEMANAGER_H__
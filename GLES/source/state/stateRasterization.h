@@ -71,6 +71,7 @@ public:
       inline void             SetPolygonOffsetFactor(GLfloat poFactor)            { FUN_ENTRY(GL_LOG_TRACE); mPolygonOffsetFactor      = poFactor;    }
       inline void             SetPolygonOffsetUnits(GLfloat poUnits)              { FUN_ENTRY(GL_LOG_TRACE); mPolygonOffsetUnits       = poUnits;     }
       inline void             SetPolygonOffsetFillEnabled(GLboolean poEnabled)    { FUN_ENTRY(GL_LOG_TRACE); mPolygonOffsetFillEnabled = poEnabled;   }
+      inline void             SetRasterizerDiscardEnabled(GLboolean enabled)      { FUN_ENTRY(GL_LOG_TRACE); mRasterizerDiscardEnabled = enabled;     }
 
 // Update Function
       inline bool             UpdateCullEnabled(GLboolean enable)                 { FUN_ENTRY(GL_LOG_TRACE); bool res = (mCullEnabled != enable);
@@ -91,6 +92,9 @@ public:
       inline bool             UpdatePolygonOffsetFillEnabled(GLboolean poEnabled) { FUN_ENTRY(GL_LOG_TRACE); bool res = (mPolygonOffsetFillEnabled != poEnabled);
                                                                                                               mPolygonOffsetFillEnabled = poEnabled;
                                                                                                               return res; }
+      inline bool             UpdateRasterizerDiscardEnabled(GLboolean enabled)   { FUN_ENTRY(GL_LOG_TRACE); bool res = (mRasterizerDiscardEnabled != enabled);
+                                                                                                              mRasterizerDiscardEnabled = enabled;
+                                                                                                              return res; }
 };
 
 #endif //__STATERASTERIZATION_H__
@@ -22,9 +22,138 @@
  */
 
 #include "GlToVkConverter.h"
+#include "glEnumTable.h"
 #include "glLogger.h"
 #include "glUtils.h"
 
+static constexpr GlEnumEntry_t<VkLogicOp> glLogicOpTable[] = {
+    { GL_CLEAR,                             VK_LOGIC_OP_CLEAR },
+    { GL_AND,                               VK_LOGIC_OP_AND },
+    { GL_AND_REVERSE,                       VK_LOGIC_OP_AND_REVERSE },
+    { GL_COPY,                              VK_LOGIC_OP_COPY },
+    { GL_AND_INVERTED,                      VK_LOGIC_OP_AND_INVERTED },
+    { GL_NOOP,                              VK_LOGIC_OP_NO_OP },
+    { GL_XOR,                               VK_LOGIC_OP_XOR },
+    { GL_OR,                                VK_LOGIC_OP_OR },
+    { GL_NOR,                               VK_LOGIC_OP_NOR },
+    { GL_EQUIV,                             VK_LOGIC_OP_EQUIVALENT },
+    { GL_INVERT,                            VK_LOGIC_OP_INVERT },
+    { GL_OR_REVERSE,                        VK_LOGIC_OP_OR_REVERSE },
+    { GL_COPY_INVERTED,                     VK_LOGIC_OP_COPY_INVERTED },
+    { GL_OR_INVERTED,                       VK_LOGIC_OP_OR_INVERTED },
+    { GL_NAND,                              VK_LOGIC_OP_NAND },
+    { GL_SET,                               VK_LOGIC_OP_SET }
+};
+static_assert(GlEnumTableIsDense(glLogicOpTable, GL_CLEAR), "glLogicOpTable must list consecutive enums");
+
+static constexpr GlEnumEntry_t<VkCompareOp> glCompareFuncTable[] = {
+    { GL_NEVER,                             VK_COMPARE_OP_NEVER },
+    { GL_LESS,                              VK_COMPARE_OP_LESS },
+    { GL_EQUAL,                             VK_COMPARE_OP_EQUAL },
+    { GL_LEQUAL,                            VK_COMPARE_OP_LESS_OR_EQUAL },
+    { GL_GREATER,                           VK_COMPARE_OP_GREATER },
+    { GL_NOTEQUAL,                          VK_COMPARE_OP_NOT_EQUAL },
+    { GL_GEQUAL,                            VK_COMPARE_OP_GREATER_OR_EQUAL },
+    { GL_ALWAYS,                            VK_COMPARE_OP_ALWAYS }
+};
+static_assert(GlEnumTableIsDense(glCompareFuncTable, GL_NEVER), "glCompareFuncTable must list consecutive enums");
+
+static constexpr GlEnumEntry_t<VkPrimitiveTopology> glPrimitiveTopologyTable[] = {
+    { GL_POINTS,                            VK_PRIMITIVE_TOPOLOGY_POINT_LIST },
+    { GL_LINES,                             VK_PRIMITIVE_TOPOLOGY_LINE_LIST },
+    { GL_LINE_LOOP,                         VK_PRIMITIVE_TOPOLOGY_LINE_STRIP },
+    { GL_LINE_STRIP,                        VK_PRIMITIVE_TOPOLOGY_LINE_STRIP },
+    { GL_TRIANGLES,                         VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST },
+    { GL_TRIANGLE_STRIP,                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP },
+    { GL_TRIANGLE_FAN,                      VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN }
+};
+static_assert(GlEnumTableIsDense(glPrimitiveTopologyTable, GL_POINTS), "glPrimitiveTopologyTable must list consecutive enums");
+
+/// blend factors other than GL_ZERO and GL_ONE come in two ranges
+static constexpr GlEnumEntry_t<VkBlendFactor> glBlendFactorTable[] = {
+    { GL_SRC_COLOR,                         VK_BLEND_FACTOR_SRC_COLOR },
+    { GL_ONE_MINUS_SRC_COLOR,               VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR },
+    { GL_SRC_ALPHA,                         VK_BLEND_FACTOR_SRC_ALPHA },
+    { GL_ONE_MINUS_SRC_ALPHA,               VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA },
+    { GL_DST_ALPHA,                         VK_BLEND_FACTOR_DST_ALPHA },
+    { GL_ONE_MINUS_DST_ALPHA,               VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA },
+    { GL_DST_COLOR,                         VK_BLEND_FACTOR_DST_COLOR },
+    { GL_ONE_MINUS_DST_COLOR,               VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR },
+    { GL_SRC_ALPHA_SATURATE,                VK_BLEND_FACTOR_SRC_ALPHA_SATURATE }
+};
+static_assert(GlEnumTableIsDense(glBlendFactorTable, GL_SRC_COLOR), "glBlendFactorTable must list consecutive enums");
+
+static constexpr GlEnumEntry_t<VkBlendFactor> glBlendFactorConstantTable[] = {
+    { GL_CONSTANT_COLOR,                    VK_BLEND_FACTOR_CONSTANT_COLOR },
+    { GL_ONE_MINUS_CONSTANT_COLOR,          VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR },
+    { GL_CONSTANT_ALPHA,                    VK_BLEND_FACTOR_CONSTANT_ALPHA },
+    { GL_ONE_MINUS_CONSTANT_ALPHA,          VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA }
+};
+static_assert(GlEnumTableIsDense(glBlendFactorConstantTable, GL_CONSTANT_COLOR), "glBlendFactorConstantTable must list consecutive enums");
+
+static constexpr GlEnumEntry_t<VkFormat> glInternalFormatTable[] = {
+    { GL_ALPHA,                             VK_FORMAT_R8_UNORM },
+    { GL_RGBA,                              VK_FORMAT_R8G8B8A8_UNORM },
+    { GL_LUMINANCE,                         VK_FORMAT_R8_UNORM },
+    { GL_LUMINANCE_ALPHA,                   VK_FORMAT_R8G8_UNORM },
+    { GL_RGB8_OES,                          VK_FORMAT_R8G8B8_UNORM },
+    { GL_RGBA4,                             VK_FORMAT_R4G4B4A4_UNORM_PACK16 },
+    { GL_RGB5_A1,                           VK_FORMAT_R5G5B5A1_UNORM_PACK16 },
+    { GL_RGBA8_OES,                         VK_FORMAT_R8G8B8A8_UNORM },
+    { GL_BGRA_EXT,                          VK_FORMAT_B8G8R8A8_UNORM },
+    { GL_DEPTH_COMPONENT16,                 VK_FORMAT_D16_UNORM },
+    { GL_DEPTH_COMPONENT24_OES,             VK_FORMAT_X8_D24_UNORM_PACK32 },
+    { GL_DEPTH_COMPONENT32_OES,             VK_FORMAT_D32_SFLOAT },
+    { GL_UNSIGNED_INT_24_8_OES,             VK_FORMAT_D24_UNORM_S8_UINT },
+    { GL_RGBA32F_EXT,                       VK_FORMAT_R32G32B32A32_SFLOAT },
+    { GL_RGB32F_EXT,                        VK_FORMAT_R32G32B32_SFLOAT },
+    { GL_ALPHA32F_EXT,                      VK_FORMAT_R32_SFLOAT },
+    { GL_LUMINANCE32F_EXT,                  VK_FORMAT_R32_SFLOAT },
+    { GL_LUMINANCE_ALPHA32F_EXT,            VK_FORMAT_R32G32_SFLOAT },
+    { GL_RGBA16F_EXT,                       VK_FORMAT_R16G16B16A16_SFLOAT },
+    { GL_RGB16F_EXT,                        VK_FORMAT_R16G16B16_SFLOAT },
+    { GL_ALPHA16F_EXT,                      VK_FORMAT_R16_SFLOAT },
+    { GL_LUMINANCE16F_EXT,                  VK_FORMAT_R16_SFLOAT },
+    { GL_LUMINANCE_ALPHA16F_EXT,            VK_FORMAT_R16G16_SFLOAT },
+    { GL_DEPTH24_STENCIL8_OES,              VK_FORMAT_D24_UNORM_S8_UINT },
+    { GL_STENCIL_INDEX1_OES,                VK_FORMAT_S8_UINT },
+    { GL_STENCIL_INDEX4_OES,                VK_FORMAT_S8_UINT },
+    { GL_STENCIL_INDEX8,                    VK_FORMAT_S8_UINT },
+    { GL_RGB565,                            VK_FORMAT_R5G6B5_UNORM_PACK16 },
+    { GL_BGRA8_EXT,                         VK_FORMAT_B8G8R8A8_UNORM }
+};
+static_assert(GlEnumTableIsSorted(glInternalFormatTable), "glInternalFormatTable must list ascending enums");
+
+typedef struct glAttribFormats_t {
+    VkFormat                                scaled[4];
+    VkFormat                                normalized[4];
+} glAttribFormats_t;
+
+/// the formats of 1 to 4 elements of each type, GL_FIXED is converted to GL_FLOAT
+static constexpr GlEnumEntry_t<glAttribFormats_t> glAttribFormatTable[] = {
+    { GL_BYTE,                              { { VK_FORMAT_R8_SSCALED,  VK_FORMAT_R8G8_SSCALED,  VK_FORMAT_R8G8B8_SSCALED,  VK_FORMAT_R8G8B8A8_SSCALED },
+                                              { VK_FORMAT_R8_SNORM,    VK_FORMAT_R8G8_SNORM,    VK_FORMAT_R8G8B8_SNORM,    VK_FORMAT_R8G8B8A8_SNORM } } },
+    { GL_UNSIGNED_BYTE,                     { { VK_FORMAT_R8_USCALED,  VK_FORMAT_R8G8_USCALED,  VK_FORMAT_R8G8B8_USCALED,  VK_FORMAT_R8G8B8A8_USCALED },
+                                              { VK_FORMAT_R8_UNORM,    VK_FORMAT_R8G8_UNORM,    VK_FORMAT_R8G8B8_UNORM,    VK_FORMAT_R8G8B8A8_UNORM } } },
+    { GL_SHORT,                             { { VK_FORMAT_R16_SSCALED, VK_FORMAT_R16G16_SSCALED, VK_FORMAT_R16G16B16_SSCALED, VK_FORMAT_R16G16B16A16_SSCALED },
+                                              { VK_FORMAT_R16_SNORM,   VK_FORMAT_R16G16_SNORM,   VK_FORMAT_R16G16B16_SNORM,   VK_FORMAT_R16G16B16A16_SNORM } } },
+    { GL_UNSIGNED_SHORT,                    { { VK_FORMAT_R16_USCALED, VK_FORMAT_R16G16_USCALED, VK_FORMAT_R16G16B16_USCALED, VK_FORMAT_R16G16B16A16_USCALED },
+                                              { VK_FORMAT_R16_UNORM,   VK_FORMAT_R16G16_UNORM,   VK_FORMAT_R16G16B16_UNORM,   VK_FORMAT_R16G16B16A16_UNORM } } },
+    { GL_INT,                               { { VK_FORMAT_R32_SINT,    VK_FORMAT_R32G32_SINT,    VK_FORMAT_R32G32B32_SINT,    VK_FORMAT_R32G32B32A32_SINT },
+                                              { VK_FORMAT_R32_SINT,    VK_FORMAT_R32G32_SINT,    VK_FORMAT_R32G32B32_SINT,    VK_FORMAT_R32G32B32A32_SINT } } },
+    { GL_UNSIGNED_INT,                      { { VK_FORMAT_R32_UINT,    VK_FORMAT_R32G32_UINT,    VK_FORMAT_R32G32B32_UINT,    VK_FORMAT_R32G32B32A32_UINT },
+                                              { VK_FORMAT_R32_UINT,    VK_FORMAT_R32G32_UINT,    VK_FORMAT_R32G32B32_UINT,    VK_FORMAT_R32G32B32A32_UINT } } },
+    { GL_FLOAT,                             { { VK_FORMAT_R32_SFLOAT,  VK_FORMAT_R32G32_SFLOAT,  VK_FORMAT_R32G32B32_SFLOAT,  VK_FORMAT_R32G32B32A32_SFLOAT },
+                                              { VK_FORMAT_R32_SFLOAT,  VK_FORMAT_R32G32_SFLOAT,  VK_FORMAT_R32G32B32_SFLOAT,  VK_FORMAT_R32G32B32A32_SFLOAT } } }
+};
+static_assert(GlEnumTableIsDense(glAttribFormatTable, GL_BYTE), "glAttribFormatTable must list consecutive enums");
+
+/// GL_OES_vertex_half_float, normalization does not apply to it
+static constexpr glAttribFormats_t glAttribHalfFloatFormats = {
+    { VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT },
+    { VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT }
+};
+
 VkBool32
 GlBooleanToVkBool(GLboolean value)
 {
@@ -112,25 +241,13 @@ GlLogicOpToVkLogicOp(GLenum mode)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    switch(mode) {
-    case GL_CLEAR:                          return VK_LOGIC_OP_CLEAR;
-    case GL_AND:                            return VK_LOGIC_OP_AND;
-    case GL_AND_REVERSE:                    return VK_LOGIC_OP_AND_REVERSE;
-    case GL_COPY:                           return VK_LOGIC_OP_COPY;
-    case GL_AND_INVERTED:                   return VK_LOGIC_OP_AND_INVERTED;
-    case GL_NOOP:                           return VK_LOGIC_OP_NO_OP;
-    case GL_XOR:                            return VK_LOGIC_OP_XOR;
-    case GL_OR:                             return VK_LOGIC_OP_OR;
-    case GL_NOR:                            return VK_LOGIC_OP_NOR;
-    case GL_EQUIV:                          return VK_LOGIC_OP_EQUIVALENT;
-    case GL_INVERT:                         return VK_LOGIC_OP_INVERT;
-    case GL_OR_REVERSE:                     return VK_LOGIC_OP_OR_REVERSE;
-    case GL_COPY_INVERTED:                  return VK_LOGIC_OP_COPY_INVERTED;
-    case GL_OR_INVERTED:                    return VK_LOGIC_OP_OR_INVERTED;
-    case GL_NAND:                           return VK_LOGIC_OP_NAND;
-    case GL_SET:                            return VK_LOGIC_OP_SET;
-    default: NOT_FOUND_ENUM(mode);          return VK_LOGIC_OP_CLEAR;
+    const GlEnumEntry_t<VkLogicOp> *entry = GlEnumTableFind(glLogicOpTable, mode);
+    if(entry == nullptr) {
+        NOT_FOUND_ENUM(mode);
+        return VK_LOGIC_OP_CLEAR;
     }
+
+    return entry->value;
 }
 
 VkCompareOp
@@ -138,17 +255,13 @@ GlCompareFuncToVkCompareOp(GLenum mode)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    switch(mode) {
-    case GL_NEVER:                          return VK_COMPARE_OP_NEVER;
-    case GL_EQUAL:                          return VK_COMPARE_OP_EQUAL;
-    case GL_LEQUAL:                         return VK_COMPARE_OP_LESS_OR_EQUAL;
-    case GL_GREATER:                        return VK_COMPARE_OP_GREATER;
-    case GL_NOTEQUAL:                       return VK_COMPARE_OP_NOT_EQUAL;
-    case GL_GEQUAL:                         return VK_COMPARE_OP_GREATER_OR_EQUAL;
-    case GL_ALWAYS:                         return VK_COMPARE_OP_ALWAYS;
-    case GL_LESS:                           return VK_COMPARE_OP_LESS;
-    default: NOT_FOUND_ENUM(mode);          return VK_COMPARE_OP_LESS;
+    const GlEnumEntry_t<VkCompareOp> *entry = GlEnumTableFind(glCompareFuncTable, mode);
+    if(entry == nullptr) {
+        NOT_FOUND_ENUM(mode);
+        return VK_COMPARE_OP_LESS;
     }
+
+    return entry->value;
 }
 
 VkCullModeFlagBits
@@ -228,16 +341,13 @@ GlPrimitiveTopologyToVkPrimitiveTopology(GLenum mode)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    switch(mode) {
-    case GL_POINTS:                         return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
-    case GL_LINES:                          return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-    case GL_LINE_LOOP:
-    case GL_LINE_STRIP:                     return VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
-    case GL_TRIANGLES:                      return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    case GL_TRIANGLE_STRIP:                 return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
-    case GL_TRIANGLE_FAN:                   return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
-    default: NOT_FOUND_ENUM(mode);          return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    const GlEnumEntry_t<VkPrimitiveTopology> *entry = GlEnumTableFind(glPrimitiveTopologyTable, mode);
+    if(entry == nullptr) {
+        NOT_FOUND_ENUM(mode);
+        return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     }
+
+    return entry->value;
 }
 
 VkBlendFactor
@@ -245,24 +355,20 @@ GlBlendFactorToVkBlendFactor(GLenum mode)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    switch(mode) {
-    case GL_ONE:                            return VK_BLEND_FACTOR_ONE;
-    case GL_ZERO:                           return VK_BLEND_FACTOR_ZERO;
-    case GL_SRC_COLOR:                      return VK_BLEND_FACTOR_SRC_COLOR;
-    case GL_ONE_MINUS_SRC_COLOR:            return VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
-    case GL_DST_COLOR:                      return VK_BLEND_FACTOR_DST_COLOR;
-    case GL_ONE_MINUS_DST_COLOR:            return VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
-    case GL_SRC_ALPHA:                      return VK_BLEND_FACTOR_SRC_ALPHA;
-    case GL_ONE_MINUS_SRC_ALPHA:            return VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    case GL_DST_ALPHA:                      return VK_BLEND_FACTOR_DST_ALPHA;
-    case GL_ONE_MINUS_DST_ALPHA:            return VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA;
-    case GL_CONSTANT_COLOR:                 return VK_BLEND_FACTOR_CONSTANT_COLOR;
-    case GL_ONE_MINUS_CONSTANT_COLOR:       return VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR;
-    case GL_CONSTANT_ALPHA:                 return VK_BLEND_FACTOR_CONSTANT_ALPHA;
-    case GL_ONE_MINUS_CONSTANT_ALPHA:       return VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA;
-    case GL_SRC_ALPHA_SATURATE:             return VK_BLEND_FACTOR_SRC_ALPHA_SATURATE;
-    default: NOT_FOUND_ENUM(mode);          return VK_BLEND_FACTOR_ZERO;
+    if(mode == GL_ZERO || mode == GL_ONE) {
+        return mode == GL_ONE ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_ZERO;
     }
+
+    const GlEnumEntry_t<VkBlendFactor> *entry = GlEnumTableFind(glBlendFactorTable, mode);
+    if(entry == nullptr) {
+        entry = GlEnumTableFind(glBlendFactorConstantTable, mode);
+    }
+    if(entry == nullptr) {
+        NOT_FOUND_ENUM(mode);
+        return VK_BLEND_FACTOR_ZERO;
+    }
+
+    return entry->value;
 }
 
 VkBlendOp
@@ -306,34 +412,13 @@ GlInternalFormatToVkFormat(GLenum internalformat)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    switch(internalformat) {
-    case GL_RGB565:                           return VK_FORMAT_R5G6B5_UNORM_PACK16;
-    case GL_RGBA4:                            return VK_FORMAT_R4G4B4A4_UNORM_PACK16;
-    case GL_RGB5_A1:                          return VK_FORMAT_R5G5B5A1_UNORM_PACK16;
-
-    case GL_RGB8_OES:                         return VK_FORMAT_R8G8B8_UNORM;
-
-    case GL_ALPHA:
-    case GL_LUMINANCE:
-    case GL_LUMINANCE_ALPHA:
-    case GL_RGBA:
-    case GL_RGBA8_OES:                        return VK_FORMAT_R8G8B8A8_UNORM;
-
-    case GL_BGRA8_EXT:
-    case GL_BGRA_EXT:                         return VK_FORMAT_B8G8R8A8_UNORM;
-
-    case GL_DEPTH_COMPONENT16:                return VK_FORMAT_D16_UNORM;
-    case GL_DEPTH24_STENCIL8_OES:
-    case GL_UNSIGNED_INT_24_8_OES:            return VK_FORMAT_D24_UNORM_S8_UINT;
-    case GL_DEPTH_COMPONENT24_OES:            return VK_FORMAT_X8_D24_UNORM_PACK32;
-    case GL_DEPTH_COMPONENT32_OES:            return VK_FORMAT_D32_SFLOAT;
-
-    case GL_STENCIL_INDEX1_OES:
-    case GL_STENCIL_INDEX4_OES:
-    case GL_STENCIL_INDEX8:                   return VK_FORMAT_S8_UINT;
-
-    default: { NOT_FOUND_ENUM(internalformat);return VK_FORMAT_UNDEFINED; }
+    const GlEnumEntry_t<VkFormat> *entry = GlEnumTableSearch(glInternalFormatTable, internalformat);
+    if(entry == nullptr) {
+        NOT_FOUND_ENUM(internalformat);
+        return VK_FORMAT_UNDEFINED;
     }
+
+    return entry->value;
 }
 
 VkFormat GlColorFormatToVkColorFormat(GLenum format, GLenum type)
@@ -345,8 +430,8 @@ VkFormat GlColorFormatToVkColorFormat(GLenum format, GLenum type)
             switch(format) {
                 case GL_RGB:                        return VK_FORMAT_R8G8B8_UNORM;
                 case GL_LUMINANCE:
-                case GL_ALPHA:
-                case GL_LUMINANCE_ALPHA:
+                case GL_ALPHA:                      return VK_FORMAT_R8_UNORM;
+                case GL_LUMINANCE_ALPHA:            return VK_FORMAT_R8G8_UNORM;
                 case GL_RGBA:                       return VK_FORMAT_R8G8B8A8_UNORM;
                 default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
             }
@@ -363,84 +448,87 @@ VkFormat GlColorFormatToVkColorFormat(GLenum format, GLenum type)
             assert( format == GL_RGBA );
             return          VK_FORMAT_R5G5B5A1_UNORM_PACK16;
         }
+        case GL_HALF_FLOAT_OES: {
+            switch(format) {
+                case GL_RGB:                        return VK_FORMAT_R16G16B16_SFLOAT;
+                case GL_LUMINANCE:
+                case GL_ALPHA:                      return VK_FORMAT_R16_SFLOAT;
+                case GL_LUMINANCE_ALPHA:            return VK_FORMAT_R16G16_SFLOAT;
+                case GL_RGBA:                       return VK_FORMAT_R16G16B16A16_SFLOAT;
+                default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
+            }
+        }
+        case GL_FLOAT: {
+            switch(format) {
+                case GL_RGB:                        return VK_FORMAT_R32G32B32_SFLOAT;
+                case GL_LUMINANCE:
+                case GL_ALPHA:                      return VK_FORMAT_R32_SFLOAT;
+                case GL_LUMINANCE_ALPHA:            return VK_FORMAT_R32G32_SFLOAT;
+                case GL_RGBA:                       return VK_FORMAT_R32G32B32A32_SFLOAT;
+                default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
+            }
+        }
         default: {
             return VK_FORMAT_R8G8B8A8_UNORM;
         }
     }
 }
 
-VkFormat
-GlAttribPointerToVkFormat(GLint nElements, GLenum type, GLboolean normalized)
+VkComponentMapping
+GlInternalFormatToVkComponentMapping(GLenum internalformat)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    switch(type) {
-    case GL_FLOAT:
-    case GL_FIXED:
-        switch(nElements) {
-        case 1:                             return VK_FORMAT_R32_SFLOAT;
-        case 2:                             return VK_FORMAT_R32G32_SFLOAT;
-        case 3:                             return VK_FORMAT_R32G32B32_SFLOAT;
-        case 4:                             return VK_FORMAT_R32G32B32A32_SFLOAT;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
-
-    case GL_INT:
-        switch(nElements) {
-        case 1:                             return VK_FORMAT_R32_SINT;
-        case 2:                             return VK_FORMAT_R32G32_SINT;
-        case 3:                             return VK_FORMAT_R32G32B32_SINT;
-        case 4:                             return VK_FORMAT_R32G32B32A32_SINT;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
-
-    case GL_UNSIGNED_INT:
-        switch(nElements) {
-        case 1:                             return VK_FORMAT_R32_UINT;
-        case 2:                             return VK_FORMAT_R32G32_UINT;
-        case 3:                             return VK_FORMAT_R32G32B32_UINT;
-        case 4:                             return VK_FORMAT_R32G32B32A32_UINT;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
-
-    case GL_BYTE:
-        switch(nElements) {
-        case 1:                             return normalized ? VK_FORMAT_R8_SNORM : VK_FORMAT_R8_SSCALED;
-        case 2:                             return normalized ? VK_FORMAT_R8G8_SNORM : VK_FORMAT_R8G8_SSCALED;
-        case 3:                             return normalized ? VK_FORMAT_R8G8B8_SNORM : VK_FORMAT_R8G8B8_SSCALED;
-        case 4:                             return normalized ? VK_FORMAT_R8G8B8A8_SNORM : VK_FORMAT_R8G8B8A8_SSCALED;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
+    // luminance and alpha textures are kept in one and two channel images, sampled as GL defines them
+    VkComponentMapping mapping = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+    switch(internalformat) {
+    case GL_LUMINANCE:
+    case GL_LUMINANCE16F_EXT:
+    case GL_LUMINANCE32F_EXT:
+        mapping = { VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_ONE };
+        break;
+    case GL_ALPHA:
+    case GL_ALPHA16F_EXT:
+    case GL_ALPHA32F_EXT:
+        mapping = { VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_R };
+        break;
+    case GL_LUMINANCE_ALPHA:
+    case GL_LUMINANCE_ALPHA16F_EXT:
+    case GL_LUMINANCE_ALPHA32F_EXT:
+        mapping = { VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_R,    VK_COMPONENT_SWIZZLE_G };
+        break;
+    default:
+        break;
+    }
 
-    case GL_UNSIGNED_BYTE:
-        switch(nElements) {
-        case 1:                             return normalized ? VK_FORMAT_R8_UNORM : VK_FORMAT_R8_USCALED;
-        case 2:                             return normalized ? VK_FORMAT_R8G8_UNORM : VK_FORMAT_R8G8_USCALED;
-        case 3:                             return normalized ? VK_FORMAT_R8G8B8_UNORM : VK_FORMAT_R8G8B8_USCALED;
-        case 4:                             return normalized ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_USCALED;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
+    return mapping;
+}
 
-    case GL_SHORT:
-        switch(nElements) {
-        case 1:                             return normalized ? VK_FORMAT_R16_SNORM : VK_FORMAT_R16_SSCALED;
-        case 2:                             return normalized ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R16G16_SSCALED;
-        case 3:                             return normalized ? VK_FORMAT_R16G16B16_SNORM : VK_FORMAT_R16G16B16_SSCALED;
-        case 4:                             return normalized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SSCALED;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
+VkFormat
+GlAttribPointerToVkFormat(GLint nElements, GLenum type, GLboolean normalized)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    case GL_UNSIGNED_SHORT:
-        switch(nElements) {
-        case 1:                             return normalized ? VK_FORMAT_R16_UNORM : VK_FORMAT_R16_USCALED;
-        case 2:                             return normalized ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16_USCALED;
-        case 3:                             return normalized ? VK_FORMAT_R16G16B16_UNORM : VK_FORMAT_R16G16B16_USCALED;
-        case 4:                             return normalized ? VK_FORMAT_R16G16B16A16_UNORM : VK_FORMAT_R16G16B16A16_USCALED;
-        default: { NOT_REACHED();           return VK_FORMAT_UNDEFINED; }
-        }
+    // GL_OES_vertex_type_10_10_10_2 packs x into the most significant bits, which no Vulkan
+    // format does, these are the formats its elements are read with once repacked
+    if(type == GL_UNSIGNED_INT_10_10_10_2_OES) {
+        return normalized ? VK_FORMAT_A2B10G10R10_UNORM_PACK32 : VK_FORMAT_A2B10G10R10_USCALED_PACK32;
+    }
+    if(type == GL_INT_10_10_10_2_OES) {
+        return normalized ? VK_FORMAT_A2B10G10R10_SNORM_PACK32 : VK_FORMAT_A2B10G10R10_SSCALED_PACK32;
+    }
 
-    default: { NOT_REACHED();               return VK_FORMAT_UNDEFINED; }
+    const glAttribFormats_t *formats = &glAttribHalfFloatFormats;
+    if(type != GL_HALF_FLOAT_OES) {
+        const GlEnumEntry_t<glAttribFormats_t> *entry = GlEnumTableFind(glAttribFormatTable, type == GL_FIXED ? GL_FLOAT : type);
+        formats = entry ? &entry->value : nullptr;
+    }
+    if(formats == nullptr || nElements < 1 || nElements > 4) {
+        NOT_REACHED();
+        return VK_FORMAT_UNDEFINED;
     }
+
+    return normalized ? formats->normalized[nElements - 1] : formats->scaled[nElements - 1];
 }
 
 VkIndexType
@@ -456,3 +544,67 @@ GlToVkIndexType(GLenum type)
     default: NOT_FOUND_ENUM(type);          return VK_INDEX_TYPE_MAX_ENUM;
     }
 }
+
+VkFormat
+GlCompressedFormatToVkFormat(GLenum format)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // ETC1 is a subset of ETC2, so it is sampled as such
+    switch(format) {
+    case GL_ETC1_RGB8_OES:                             return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+    case GL_COMPRESSED_RGB8_ETC2:                      return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ETC2:                     return VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK;
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:  return VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2: return VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:                 return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:          return VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK;
+    case GL_COMPRESSED_R11_EAC:                        return VK_FORMAT_EAC_R11_UNORM_BLOCK;
+    case GL_COMPRESSED_SIGNED_R11_EAC:                 return VK_FORMAT_EAC_R11_SNORM_BLOCK;
+    case GL_COMPRESSED_RG11_EAC:                       return VK_FORMAT_EAC_R11G11_UNORM_BLOCK;
+    case GL_COMPRESSED_SIGNED_RG11_EAC:                return VK_FORMAT_EAC_R11G11_SNORM_BLOCK;
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:              return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:             return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:             return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:       return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:             return VK_FORMAT_BC2_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:       return VK_FORMAT_BC2_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:             return VK_FORMAT_BC3_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:       return VK_FORMAT_BC3_SRGB_BLOCK;
+    case GL_COMPRESSED_RED_RGTC1_EXT:                  return VK_FORMAT_BC4_UNORM_BLOCK;
+    case GL_COMPRESSED_SIGNED_RED_RGTC1_EXT:           return VK_FORMAT_BC4_SNORM_BLOCK;
+    case GL_COMPRESSED_RED_GREEN_RGTC2_EXT:            return VK_FORMAT_BC5_UNORM_BLOCK;
+    case GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT:     return VK_FORMAT_BC5_SNORM_BLOCK;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM_EXT:            return VK_FORMAT_BC7_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_EXT:      return VK_FORMAT_BC7_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_4x4_KHR:              return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR:      return VK_FORMAT_ASTC_4x4_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_5x4_KHR:              return VK_FORMAT_ASTC_5x4_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR:      return VK_FORMAT_ASTC_5x4_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_5x5_KHR:              return VK_FORMAT_ASTC_5x5_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR:      return VK_FORMAT_ASTC_5x5_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_6x5_KHR:              return VK_FORMAT_ASTC_6x5_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR:      return VK_FORMAT_ASTC_6x5_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_6x6_KHR:              return VK_FORMAT_ASTC_6x6_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR:      return VK_FORMAT_ASTC_6x6_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_8x5_KHR:              return VK_FORMAT_ASTC_8x5_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR:      return VK_FORMAT_ASTC_8x5_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_8x6_KHR:              return VK_FORMAT_ASTC_8x6_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR:      return VK_FORMAT_ASTC_8x6_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_8x8_KHR:              return VK_FORMAT_ASTC_8x8_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR:      return VK_FORMAT_ASTC_8x8_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_10x5_KHR:             return VK_FORMAT_ASTC_10x5_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR:     return VK_FORMAT_ASTC_10x5_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_10x6_KHR:             return VK_FORMAT_ASTC_10x6_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR:     return VK_FORMAT_ASTC_10x6_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_10x8_KHR:             return VK_FORMAT_ASTC_10x8_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR:     return VK_FORMAT_ASTC_10x8_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_10x10_KHR:            return VK_FORMAT_ASTC_10x10_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR:    return VK_FORMAT_ASTC_10x10_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_12x10_KHR:            return VK_FORMAT_ASTC_12x10_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR:    return VK_FORMAT_ASTC_12x10_SRGB_BLOCK;
+    case GL_COMPRESSED_RGBA_ASTC_12x12_KHR:            return VK_FORMAT_ASTC_12x12_UNORM_BLOCK;
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR:    return VK_FORMAT_ASTC_12x12_SRGB_BLOCK;
+    default: NOT_FOUND_ENUM(format);                   return VK_FORMAT_UNDEFINED;
+    }
+}
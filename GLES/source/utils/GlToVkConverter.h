@@ -50,5 +50,7 @@ VkFormat                GlInternalFormatToVkFormat(GLenum internalformatDepth, G
 VkFormat                GlAttribPointerToVkFormat(GLint nElements, GLenum type, GLboolean normalized);
 VkIndexType             GlToVkIndexType(GLenum type);
 VkFormat                GlColorFormatToVkColorFormat(GLenum format, GLenum type);
+VkComponentMapping      GlInternalFormatToVkComponentMapping(GLenum internalformat);
+VkFormat                GlCompressedFormatToVkFormat(GLenum format);
 
 #endif // __GLTOVKCONVERTER_H__
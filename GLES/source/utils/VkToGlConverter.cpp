@@ -23,6 +23,7 @@
 
 #include "VkToGlConverter.h"
 #include "glLogger.h"
+#include "glUtils.h"
 
 GLenum
 VkFormatToGlInternalformat(VkFormat format)
@@ -44,6 +45,11 @@ VkFormatToGlInternalformat(VkFormat format)
     case VK_FORMAT_B8G8R8A8_SRGB:
     case VK_FORMAT_B8G8R8A8_UNORM:          return GL_BGRA8_EXT;
 
+    case VK_FORMAT_R16G16B16A16_SFLOAT:     return GL_RGBA16F_EXT;
+    case VK_FORMAT_R16G16B16_SFLOAT:        return GL_RGB16F_EXT;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:     return GL_RGBA32F_EXT;
+    case VK_FORMAT_R32G32B32_SFLOAT:        return GL_RGB32F_EXT;
+
     case VK_FORMAT_D16_UNORM:               return GL_DEPTH_COMPONENT16;
     case VK_FORMAT_D16_UNORM_S8_UINT:
     case VK_FORMAT_D24_UNORM_S8_UINT:
@@ -51,6 +57,59 @@ VkFormatToGlInternalformat(VkFormat format)
     case VK_FORMAT_X8_D24_UNORM_PACK32:     return GL_DEPTH_COMPONENT24_OES;
     case VK_FORMAT_D32_SFLOAT:              return GL_DEPTH_COMPONENT32_OES;
     case VK_FORMAT_S8_UINT:                 return GL_STENCIL_INDEX8;
+
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:   return GL_COMPRESSED_RGB8_ETC2;
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:    return GL_COMPRESSED_SRGB8_ETC2;
+    case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK: return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+    case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:  return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:  return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+    case VK_FORMAT_EAC_R11_UNORM_BLOCK:       return GL_COMPRESSED_R11_EAC;
+    case VK_FORMAT_EAC_R11_SNORM_BLOCK:       return GL_COMPRESSED_SIGNED_R11_EAC;
+    case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:    return GL_COMPRESSED_RG11_EAC;
+    case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:    return GL_COMPRESSED_SIGNED_RG11_EAC;
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:       return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:        return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:       return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+    case VK_FORMAT_BC2_UNORM_BLOCK:           return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    case VK_FORMAT_BC2_SRGB_BLOCK:            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+    case VK_FORMAT_BC3_UNORM_BLOCK:           return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case VK_FORMAT_BC3_SRGB_BLOCK:            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+    case VK_FORMAT_BC4_UNORM_BLOCK:           return GL_COMPRESSED_RED_RGTC1_EXT;
+    case VK_FORMAT_BC4_SNORM_BLOCK:           return GL_COMPRESSED_SIGNED_RED_RGTC1_EXT;
+    case VK_FORMAT_BC5_UNORM_BLOCK:           return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+    case VK_FORMAT_BC5_SNORM_BLOCK:           return GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT;
+    case VK_FORMAT_BC7_UNORM_BLOCK:           return GL_COMPRESSED_RGBA_BPTC_UNORM_EXT;
+    case VK_FORMAT_BC7_SRGB_BLOCK:            return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_EXT;
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+    case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+    case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_5x4_KHR;
+    case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR;
+    case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_5x5_KHR;
+    case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR;
+    case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_6x5_KHR;
+    case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR;
+    case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+    case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR;
+    case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_8x5_KHR;
+    case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR;
+    case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_8x6_KHR;
+    case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR;
+    case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:      return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+    case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:       return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR;
+    case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:     return GL_COMPRESSED_RGBA_ASTC_10x5_KHR;
+    case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:      return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR;
+    case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:     return GL_COMPRESSED_RGBA_ASTC_10x6_KHR;
+    case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:      return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR;
+    case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:     return GL_COMPRESSED_RGBA_ASTC_10x8_KHR;
+    case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:      return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR;
+    case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:    return GL_COMPRESSED_RGBA_ASTC_10x10_KHR;
+    case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:     return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR;
+    case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:    return GL_COMPRESSED_RGBA_ASTC_12x10_KHR;
+    case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:     return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR;
+    case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:    return GL_COMPRESSED_RGBA_ASTC_12x12_KHR;
+    case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:     return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR;
     case VK_FORMAT_UNDEFINED:
     default: { NOT_FOUND_ENUM(format);      return GL_INVALID_VALUE; }
     }
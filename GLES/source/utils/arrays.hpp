@@ -18,34 +18,165 @@
  *  @version    1.0
  *
  *  @brief      A simple interface is provided for handling all the accesses to
- *              the arrays of classes needed in GLOVE using the map container.
+ *              the arrays of classes needed in GLOVE using a dense slot map.
  *
  */
 
 #ifndef __ARRAYS_HPP__
 #define __ARRAYS_HPP__
 
-#include <map>
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/// GL handles below it are looked up through a table of pages of it, the rest through a hash map
+#define GLOVE_OBJECT_ARRAY_DENSE_HANDLES                (1 << 20)
+#define GLOVE_OBJECT_ARRAY_PAGE_SHIFT                   10
+#define GLOVE_OBJECT_ARRAY_PAGE_SIZE                    (1 << GLOVE_OBJECT_ARRAY_PAGE_SHIFT)
+#define GLOVE_OBJECT_ARRAY_PAGES                        (GLOVE_OBJECT_ARRAY_DENSE_HANDLES / GLOVE_OBJECT_ARRAY_PAGE_SIZE)
+
+template <class ELEMENT>
+class ObjectArray;
+
+/**
+ * @brief The base of the classes listed in an ObjectArray, which keeps the GL
+ * handle of the object in it, so that it is found back from the object.
+ */
+class ArrayObject {
+    template <class ELEMENT>
+    friend class ObjectArray;
+
+private:
+    uint32_t mArrayId;                 /**< The GL handle of the object in the
+                                          array listing it, set before the
+                                          object is published. */
+    uint32_t mArraySlot;               /**< The position of the object in the
+                                          packed objects of the array. */
+public:
+    ArrayObject() :
+    mArrayId(0), mArraySlot(0)
+    {
+    }
+};
 
 /**
  * @brief A templated class for handling the memory allocation, indexing and
  * searching of all the different arrays of classes.
  *
- * A separate map container is created for every class that the GLOVE supports.
- * This map is used later for the creation of the various new objects,
- * their indexing and searching. The key value of the map is used as the GL
- * handle, therefore the 0 value is not permitted. The mapped value is the
- * generated object.
+ * A separate slot map is created for every class that the GLOVE supports.
+ * A table indexed by the GL handle points to the object of each handle, and
+ * the object keeps its handle, so that both lookups take constant time.
+ * The objects are also kept packed in a vector, in no particular order, for
+ * the passes over all of them. Removals keep it packed by moving the last
+ * object into the slot that is freed. The GL handles are not reused:
+ * framebuffers refer to their attachments by handle, even after the
+ * attachments are deleted.
+ *
+ * Contexts of the same share group use the same arrays from different threads.
+ * Looking up handles below GLOVE_OBJECT_ARRAY_DENSE_HANDLES is wait-free: the
+ * table is made of pages that are only released along with the array, whose
+ * entries are published with release stores once the object is complete.
+ * Creation, removal and the handles beyond the table are serialized by a
+ * mutex. Iterating through the objects returned by GetObjects() is not covered
+ * and is up to the caller, as is keeping an object alive while other threads
+ * may look it up, like the GL share group semantics require.
  */
 template <class ELEMENT>
 class ObjectArray {
+    static_assert(std::is_base_of<ArrayObject, ELEMENT>::value, "the objects of an ObjectArray keep their GL handle in an ArrayObject");
+
 private:
-    uint32_t mCounter;                 /**< The id (key-value of the map)
-                                          reserved during the creation of a new
-                                          object. */
-    std::map<uint32_t, ELEMENT *> mObjects; /**< The templated map container (one
-                                          for each different class that maps
-                                          id to a specific object). */
+    typedef std::atomic<ELEMENT *> entry_t;
+
+    std::atomic<uint32_t> mCounter;    /**< The id (GL handle) reserved during
+                                          the creation of a new object. */
+    std::atomic<entry_t *> mPages[GLOVE_OBJECT_ARRAY_PAGES]; /**< The objects
+                                          of the GL handles, GLOVE_OBJECT_ARRAY_PAGE_SIZE
+                                          handles a page, allocated as the
+                                          handles are first used. */
+    std::vector<ELEMENT *> mObjects;   /**< The objects, packed (one vector for
+                                          each different class). */
+    std::unordered_map<uint32_t, ELEMENT *> mSparseObjects; /**< The objects
+                                          of the GL handles beyond the table. */
+    mutable std::mutex mMutex;         /**< Serializes the creation and the
+                                          removal of the objects. */
+
+    /// The entry of the GL handle in the table, nullptr when its page is not allocated yet
+    entry_t *Entry(uint32_t index) const
+    {
+        entry_t *page = mPages[index >> GLOVE_OBJECT_ARRAY_PAGE_SHIFT].load(std::memory_order_acquire);
+        return page ? &page[index & (GLOVE_OBJECT_ARRAY_PAGE_SIZE - 1)] : nullptr;
+    }
+
+    /// The object of the GL handle, without taking the lock for the handles of the table
+    ELEMENT *Find(uint32_t index) const
+    {
+        if(index < GLOVE_OBJECT_ARRAY_DENSE_HANDLES) {
+            entry_t *entry = Entry(index);
+            return entry ? entry->load(std::memory_order_acquire) : nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        typename std::unordered_map<uint32_t, ELEMENT *>::const_iterator it = mSparseObjects.find(index);
+        return it == mSparseObjects.end() ? nullptr : it->second;
+    }
+
+    /// The object of the GL handle, called with the lock held
+    ELEMENT *FindLocked(uint32_t index) const
+    {
+        if(index < GLOVE_OBJECT_ARRAY_DENSE_HANDLES) {
+            entry_t *entry = Entry(index);
+            return entry ? entry->load(std::memory_order_relaxed) : nullptr;
+        }
+
+        typename std::unordered_map<uint32_t, ELEMENT *>::const_iterator it = mSparseObjects.find(index);
+        return it == mSparseObjects.end() ? nullptr : it->second;
+    }
+
+    /// Publishes the object of the GL handle, called with the lock held
+    void Publish(uint32_t index, ELEMENT *element)
+    {
+        if(index >= GLOVE_OBJECT_ARRAY_DENSE_HANDLES) {
+            if(element) {
+                mSparseObjects[index] = element;
+            } else {
+                mSparseObjects.erase(index);
+            }
+            return;
+        }
+
+        entry_t *entry = Entry(index);
+        if(entry == nullptr) {
+            entry_t *page = new entry_t[GLOVE_OBJECT_ARRAY_PAGE_SIZE];
+            for(uint32_t i = 0; i < GLOVE_OBJECT_ARRAY_PAGE_SIZE; ++i) {
+                page[i].store(nullptr, std::memory_order_relaxed);
+            }
+            mPages[index >> GLOVE_OBJECT_ARRAY_PAGE_SHIFT].store(page, std::memory_order_release);
+            entry = &page[index & (GLOVE_OBJECT_ARRAY_PAGE_SIZE - 1)];
+        }
+        entry->store(element, std::memory_order_release);
+    }
+
+    /// Takes the object of the GL handle out of the array, moving the last object into its slot, called with the lock held
+    ELEMENT *Remove(uint32_t index)
+    {
+        ELEMENT *element = FindLocked(index);
+        if(element == nullptr) {
+            return nullptr;
+        }
+
+        Publish(index, nullptr);
+
+        ELEMENT *last = mObjects.back();
+        mObjects[element->mArraySlot] = last;
+        last->mArraySlot = element->mArraySlot;
+        mObjects.pop_back();
+
+        return element;
+    }
+
 public:
 
     /**
@@ -55,19 +186,25 @@ public:
     ObjectArray() :
     mCounter(0)
     {
+        for(uint32_t i = 0; i < GLOVE_OBJECT_ARRAY_PAGES; ++i) {
+            mPages[i].store(nullptr, std::memory_order_relaxed);
+        }
     }
 
     /**
-    * @brief The destructor removes all elements from the map container (which
-    * are destroyed), leaving the container with a size of 0.
+    * @brief The destructor destroys all the objects of the array, leaving it
+    * with a size of 0.
     */
     ~ObjectArray()
     {
-        typename std::map<uint32_t, ELEMENT *>::iterator it;
-        for(it = mObjects.begin(); it != mObjects.end(); it++) {
-            delete it->second;
+        for(typename std::vector<ELEMENT *>::iterator it = mObjects.begin(); it != mObjects.end(); it++) {
+            delete *it;
         }
         mObjects.clear();
+
+        for(uint32_t i = 0; i < GLOVE_OBJECT_ARRAY_PAGES; ++i) {
+            delete[] mPages[i].load(std::memory_order_relaxed);
+        }
     }
 
     /**
@@ -76,105 +213,126 @@ public:
     */
     uint32_t Allocate()
     {
-        return ++mCounter;
+        return mCounter.fetch_add(1, std::memory_order_relaxed) + 1;
     }
 
     /**
-    * @brief Removes from the map container a single element with the given
-    * key value (element is  destroyed).
+    * @brief Removes from the array a single element with the given
+    * GL handle (element is  destroyed).
     * @param index: The GL handle of the element to be destroyed.
     */
     bool Deallocate(uint32_t index)
     {
-        typename std::map<uint32_t, ELEMENT *>::iterator it = mObjects.find(index);
-        if(it != mObjects.end()) {
-            delete it->second;
-            mObjects.erase(it);
-
-            return true;
+        ELEMENT *element = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            element = Remove(index);
+            if(element == nullptr) {
+                return false;
+            }
         }
 
-        return false;
+        // destroyed outside of the lock, as destructors may reach the array again
+        delete element;
+        return true;
     }
 
     /**
-    * @brief Removes from the map container a single element with the given
-    * key value (element is NOT destroyed).
+    * @brief Removes from the array a single element with the given
+    * GL handle (element is NOT destroyed).
     */
     bool RemoveFromList(uint32_t index)
     {
-        typename std::map<uint32_t, ELEMENT *>::iterator it = mObjects.find(index);
-        if(it != mObjects.end()) {
-            mObjects.erase(it);
-            return true;
-        }
-        return false;
+        std::lock_guard<std::mutex> lock(mMutex);
+        return Remove(index) != nullptr;
     }
 
     /**
-     * @brief Searches the container for an element with a key equivalent to
-     * index and returns it.
+     * @brief Searches the array for an element with a GL handle equivalent
+     * to index and returns it.
      * @param index: The GL handle of the element to be found or to be created.
-     * @return A pointer to the element in the map.
+     * @return A pointer to the element in the array.
      *
-     * In case the key value is not found (thus, the element does not exist)
+     * In case the GL handle is not found (thus, the element does not exist)
      * a new object is created. Consequently this method is the only way to
-     * insert a new element in the map.
+     * insert a new element in the array.
      */
     ELEMENT *GetObject(uint32_t index)
     {
-        if(mCounter < index) {
-            mCounter = index;
+        ELEMENT *element = Find(index);
+        if(element) {
+            return element;
         }
-        typename std::map<uint32_t, ELEMENT *>::iterator it = mObjects.find(index);
-        if(it != mObjects.end()) {
-            return it->second;
-        } else {
-            return mObjects[index] = new ELEMENT();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        uint32_t counter = mCounter.load(std::memory_order_relaxed);
+        while(counter < index && !mCounter.compare_exchange_weak(counter, index, std::memory_order_relaxed)) {
+        }
+
+        // another thread may have created it meanwhile
+        element = FindLocked(index);
+        if(element) {
+            return element;
         }
+
+        element = new ELEMENT();
+        element->mArrayId   = index;
+        element->mArraySlot = static_cast<uint32_t>(mObjects.size());
+        mObjects.push_back(element);
+        Publish(index, element);
+        return element;
     }
 
     /**
-     * @brief Searches the container for an element with a key equivalent to
-     * index.
+     * @brief Searches the array for an element with a GL handle equivalent
+     * to index.
      * @param index: The GL handle of the element to be found.
      * @return The decision whether the element exists or not.
      */
     bool ObjectExists(uint32_t index) const
     {
-        typename std::map<uint32_t, ELEMENT *>::const_iterator it = mObjects.find(index);
-        return it == mObjects.end() ? false : true;
+        return Find(index) != nullptr;
     }
 
     /**
-     * @brief Returns the GL handle of a specific element of the container.
-     * @param *element: The element to be searched in the container.
+     * @brief Returns the GL handle of a specific element of the array.
+     * @param *element: The element to be searched in the array.
      * @return The GL handle of the element.
      *
-     * The container is traversed using the mapped value as the search value.
-     * The GL handle is returned in case the wanted element exists, else the
-     * returned value is 0.
+     * The GL handle the element keeps is returned in case the element is
+     * the one the array lists under it, else the returned value is ~0.
      */
     uint32_t GetObjectId(const ELEMENT * element) const
     {
-        typename std::map<uint32_t, ELEMENT *>::const_iterator it;
-        for(it = mObjects.begin(); it != mObjects.end(); it++) {
-            if(it->second == element) {
-                return it->first;
-            }
+        if(element == nullptr) {
+            return ~0;
         }
 
-        return ~0;
+        return Find(element->mArrayId) == element ? element->mArrayId : ~0;
     }
 
     /**
-     * @brief Returns the map container for a specific class.
-     * @return The map container.
+     * @brief Returns the objects of the array, packed in no particular order.
+     * @return The vector of the objects.
      */
-    std::map<uint32_t, ELEMENT *> *GetObjects(void)
+    const std::vector<ELEMENT *> *GetObjects(void) const
     {
         return &mObjects;
     }
+
+    /**
+     * @brief Calls func for each element of the array, while no other thread
+     * can add or remove one.
+     * @param func: Called with each element, it must not add or remove any.
+     */
+    template <typename FUNC>
+    void ForEachObject(FUNC func) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for(ELEMENT *element : mObjects) {
+            func(element);
+        }
+    }
 };
 
 #endif // __ARRAYS_HPP__
@@ -0,0 +1,88 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       atomicFileWriter.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Files written as a whole or not at all (pipeline, shader and capability caches)
+ *
+ *  @section
+ *
+ *  The caches kept on disk are read by every process that starts, while the
+ *  contexts of others, or the background jobs of the same one, may be
+ *  writing them. Each file is written to a temporary one named after the
+ *  process and the write, then moved over the file, so that neither a crash
+ *  nor a concurrent writer leaves a partial file for a reader to see.
+ *
+ */
+
+#include "atomicFileWriter.h"
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif // WIN32
+
+static std::atomic<uint64_t> nextWriteId(0);
+static std::mutex            replaceMutex;
+
+static inline long
+ProcessId(void)
+{
+#ifdef WIN32
+    return static_cast<long>(_getpid());
+#else
+    return static_cast<long>(getpid());
+#endif // WIN32
+}
+
+static inline bool
+ReplaceFile(const std::string &from, const std::string &to)
+{
+#ifdef WIN32
+    // rename does not replace an existing file there
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif // WIN32
+}
+
+bool
+AtomicFileWriter::Write(const std::string &path, const std::function<bool(FILE *file)> &writer)
+{
+    // no two writes share a temporary file, whichever of them threads or processes run
+    std::string tmpPath = path + ".tmp." + std::to_string(ProcessId()) + "." + std::to_string(++nextWriteId);
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    if(file == nullptr) {
+        return false;
+    }
+
+    bool written = writer(file);
+    written = (fclose(file) == 0) && written;
+
+    std::lock_guard<std::mutex> lock(replaceMutex);
+    if(!written || !ReplaceFile(tmpPath, path)) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,37 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       atomicFileWriter.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Files written as a whole or not at all (pipeline, shader and capability caches)
+ *
+ */
+
+#ifndef __ATOMICFILEWRITER_H__
+#define __ATOMICFILEWRITER_H__
+
+#include <cstdio>
+#include <functional>
+#include <string>
+
+class AtomicFileWriter {
+public:
+    /// writer fills the file it is handed and returns whether it succeeded, path is only replaced if it did
+    static bool           Write(const std::string &path, const std::function<bool(FILE *file)> &writer);
+};
+
+#endif //__ATOMICFILEWRITER_H__
@@ -17,78 +17,133 @@
  *  @date       13/09/2018
  *  @version    1.0
  *
- *  @brief      Vulkan objects cache manager. These caches are needed to keep in memory Vulkan objects referred to by secondary command buffers.
+ *  @brief      Vulkan objects cache manager. These caches are needed to keep in memory Vulkan objects referred to by command buffers in flight.
  *
  */
 
 #include "cacheManager.h"
+#include "vulkan/hostAllocator.h"
+#include "resources/renderbuffer.h"
+#include "resources/shaderProgram.h"
 
-void
-CacheManager::CleanUpUBOCache(void)
+CacheManager::~CacheManager()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(!mUBOCache.empty()) {
-        for(uint32_t i = 0; i < mUBOCache.size(); ++i) {
-            if(mUBOCache[i] != nullptr) {
-                delete mUBOCache[i];
-                mUBOCache[i] = nullptr;
-            }
+    for(auto &entry : mVkPipelineObjectCache) {
+        mActiveCaches.vkPipelines.push_back(entry.second.pipeline);
+        if(entry.second.linked != VK_NULL_HANDLE) {
+            mActiveCaches.vkPipelines.push_back(entry.second.linked);
         }
-
-        mUBOCache.clear();
     }
+    mVkPipelineObjectCache.clear();
+    mVkPipelineLRU.clear();
+
+    CleanUpCaches();
 }
 
 void
-CacheManager::CleanUpVBOCache()
+CacheManager::CleanUpUBOCache(Caches_t *caches)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(!mVBOCache.empty()) {
-        for(uint32_t i = 0; i < mVBOCache.size(); ++i) {
-            if(mVBOCache[i] != nullptr) {
-                delete mVBOCache[i];
-                mVBOCache[i] = nullptr;
-            }
+    for(uint32_t i = 0; i < caches->UBOs.size(); ++i) {
+        if(caches->UBOs[i] != nullptr) {
+            delete caches->UBOs[i];
+            caches->UBOs[i] = nullptr;
         }
+    }
+
+    caches->UBOs.clear();
+}
+
+void
+CacheManager::CleanUpVBOCache(Caches_t *caches)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        mVBOCache.clear();
+    for(uint32_t i = 0; i < caches->VBOs.size(); ++i) {
+        if(caches->VBOs[i] != nullptr) {
+            delete caches->VBOs[i];
+            caches->VBOs[i] = nullptr;
+        }
     }
+
+    caches->VBOs.clear();
 }
 
 void
-CacheManager::CleanUpTextureCache()
+CacheManager::CleanUpTextureCache(Caches_t *caches)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(!mTextureCache.empty()) {
-        for(uint32_t i = 0; i < mTextureCache.size(); ++i) {
-            if(mTextureCache[i] != nullptr) {
-                delete mTextureCache[i];
-                mTextureCache[i] = nullptr;
-            }
+    for(uint32_t i = 0; i < caches->textures.size(); ++i) {
+        if(caches->textures[i] != nullptr) {
+            delete caches->textures[i];
+            caches->textures[i] = nullptr;
         }
+    }
+
+    caches->textures.clear();
+}
+
+void
+CacheManager::CleanUpRenderbufferCache(Caches_t *caches)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-        mTextureCache.clear();
+    for(uint32_t i = 0; i < caches->renderbuffers.size(); ++i) {
+        if(caches->renderbuffers[i] != nullptr) {
+            delete caches->renderbuffers[i];
+            caches->renderbuffers[i] = nullptr;
+        }
     }
+
+    caches->renderbuffers.clear();
 }
 
 void
-CacheManager::CleanUpVkPipelineObjectCache()
+CacheManager::CleanUpShaderProgramCache(Caches_t *caches)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    if(!mVkPipelineObjectCache.empty()) {
-        for(uint32_t i = 0; i < mVkPipelineObjectCache.size(); ++i) {
-            if(mVkPipelineObjectCache[i] != VK_NULL_HANDLE){
-                vkDestroyPipeline(mVkContext->vkDevice, mVkPipelineObjectCache[i], nullptr);
-                mVkPipelineObjectCache[i] = VK_NULL_HANDLE;
-            }
+    for(uint32_t i = 0; i < caches->shaderPrograms.size(); ++i) {
+        if(caches->shaderPrograms[i] != nullptr) {
+            delete caches->shaderPrograms[i];
+            caches->shaderPrograms[i] = nullptr;
         }
+    }
+
+    caches->shaderPrograms.clear();
+}
 
-        mVkPipelineObjectCache.clear();
+void
+CacheManager::CleanUpVkPipelineObjectCache(Caches_t *caches)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < caches->vkPipelines.size(); ++i) {
+        if(caches->vkPipelines[i] != VK_NULL_HANDLE){
+            vkDestroyPipeline(mVkContext->vkDevice, caches->vkPipelines[i], mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+            caches->vkPipelines[i] = VK_NULL_HANDLE;
+        }
     }
+
+    caches->vkPipelines.clear();
+}
+
+void
+CacheManager::CleanUpCaches(Caches_t *caches)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // programs go first, the pipelines they evict are destroyed along with the rest
+    CleanUpShaderProgramCache(caches);
+    CleanUpRenderbufferCache(caches);
+    CleanUpUBOCache(caches);
+    CleanUpVBOCache(caches);
+    CleanUpTextureCache(caches);
+    CleanUpVkPipelineObjectCache(caches);
 }
 
 void
@@ -96,7 +151,7 @@ CacheManager::CacheUBO(UniformBufferObject *uniformBufferObject)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    mUBOCache.push_back(uniformBufferObject);
+    mActiveCaches.UBOs.push_back(uniformBufferObject);
 }
 
 void
@@ -104,7 +159,7 @@ CacheManager::CacheVBO(BufferObject *vbo)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    mVBOCache.push_back(vbo);
+    mActiveCaches.VBOs.push_back(vbo);
 }
 
 void
@@ -112,7 +167,23 @@ CacheManager::CacheTexture(Texture *tex)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    mTextureCache.push_back(tex);
+    mActiveCaches.textures.push_back(tex);
+}
+
+void
+CacheManager::CacheRenderbuffer(Renderbuffer *renderbuffer)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mActiveCaches.renderbuffers.push_back(renderbuffer);
+}
+
+void
+CacheManager::CacheShaderProgram(ShaderProgram *program)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mActiveCaches.shaderPrograms.push_back(program);
 }
 
 void
@@ -120,7 +191,177 @@ CacheManager::CacheVkPipelineObject(VkPipeline pipeline)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    mVkPipelineObjectCache.push_back(pipeline);
+    mActiveCaches.vkPipelines.push_back(pipeline);
+}
+
+VkPipeline
+CacheManager::FindVkPipeline(uint64_t hash, const std::vector<uint32_t> &key)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    auto it = mVkPipelineObjectCache.find(hash);
+    if(it == mVkPipelineObjectCache.end() || it->second.key != key) {
+        return VK_NULL_HANDLE;
+    }
+
+    mVkPipelineLRU.splice(mVkPipelineLRU.begin(), mVkPipelineLRU, it->second.lruIterator);
+
+    return it->second.pipeline;
+}
+
+bool
+CacheManager::TouchVkPipeline(uint64_t hash, VkPipeline pipeline, bool recorded)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // draws already recorded may keep binding the linked pipeline an optimized one has replaced,
+    // new ones look the optimized one up
+    auto it = mVkPipelineObjectCache.find(hash);
+    if(it == mVkPipelineObjectCache.end() ||
+       (it->second.pipeline != pipeline && (!recorded || it->second.linked != pipeline))) {
+        return false;
+    }
+
+    mVkPipelineLRU.splice(mVkPipelineLRU.begin(), mVkPipelineLRU, it->second.lruIterator);
+
+    return true;
+}
+
+void
+CacheManager::InsertVkPipeline(uint64_t hash, const std::vector<uint32_t> &key, VkPipeline pipeline, VkPipelineLayout layout)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // a colliding entry is simply replaced
+    auto it = mVkPipelineObjectCache.find(hash);
+    if(it != mVkPipelineObjectCache.end()) {
+        EvictVkPipeline(it);
+    }
+
+    while(mVkPipelineObjectCache.size() >= GLOVE_MAX_CACHED_PIPELINES) {
+        EvictVkPipeline(mVkPipelineObjectCache.find(mVkPipelineLRU.back()));
+    }
+
+    mVkPipelineLRU.push_front(hash);
+
+    PipelineEntry_t &entry = mVkPipelineObjectCache[hash];
+    entry.key         = key;
+    entry.pipeline    = pipeline;
+    entry.linked      = VK_NULL_HANDLE;
+    entry.layout      = layout;
+    entry.lruIterator = mVkPipelineLRU.begin();
+}
+
+void
+CacheManager::EvictVkPipelines(VkPipelineLayout layout)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // background compilations still refer to the layout
+    mPipelineWarmer.Cancel(layout);
+    mPipelineLibrary.Release(layout);
+
+    for(auto it = mVkPipelineObjectCache.begin(); it != mVkPipelineObjectCache.end();) {
+        auto next = std::next(it);
+        if(it->second.layout == layout) {
+            EvictVkPipeline(it);
+        }
+        it = next;
+    }
+}
+
+void
+CacheManager::TrimVkPipelines(size_t keptPipelines)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the least recently used pipelines go first
+    while(mVkPipelineObjectCache.size() > keptPipelines) {
+        EvictVkPipeline(mVkPipelineObjectCache.find(mVkPipelineLRU.back()));
+    }
+}
+
+void
+CacheManager::EvictVkPipeline(std::unordered_map<uint64_t, PipelineEntry_t>::iterator it)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // evicted pipelines may still be referred to by command buffers in flight
+    CacheVkPipelineObject(it->second.pipeline);
+    if(it->second.linked != VK_NULL_HANDLE) {
+        CacheVkPipelineObject(it->second.linked);
+    }
+    mVkPipelineLRU.erase(it->second.lruIterator);
+    mVkPipelineObjectCache.erase(it);
+}
+
+void
+CacheManager::ReplaceLinkedVkPipelines(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::vector<vulkanAPI::PipelineLibrary::Optimized_t> optimized;
+    mPipelineLibrary.CollectOptimized(&optimized);
+
+    for(const auto &result : optimized) {
+        // the linked pipeline may have been evicted while the optimized one was compiled
+        auto it = mVkPipelineObjectCache.find(result.hash);
+        if(it == mVkPipelineObjectCache.end() || it->second.pipeline != result.linked) {
+            vkDestroyPipeline(mVkContext->vkDevice, result.optimized, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+            continue;
+        }
+
+        it->second.pipeline = result.optimized;
+        it->second.linked   = result.linked;
+    }
+}
+
+void
+CacheManager::SubmitCaches(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    // Objects cached so far can only be referred to by the command buffer that has
+    // just been submitted (or older ones), so they retire together with this frame
+    Caches_t *caches = &mSubmittedCaches[frame];
+    caches->UBOs.insert(caches->UBOs.end(), mActiveCaches.UBOs.begin(), mActiveCaches.UBOs.end());
+    caches->VBOs.insert(caches->VBOs.end(), mActiveCaches.VBOs.begin(), mActiveCaches.VBOs.end());
+    caches->textures.insert(caches->textures.end(), mActiveCaches.textures.begin(), mActiveCaches.textures.end());
+    caches->renderbuffers.insert(caches->renderbuffers.end(), mActiveCaches.renderbuffers.begin(), mActiveCaches.renderbuffers.end());
+    caches->shaderPrograms.insert(caches->shaderPrograms.end(), mActiveCaches.shaderPrograms.begin(), mActiveCaches.shaderPrograms.end());
+    caches->vkPipelines.insert(caches->vkPipelines.end(), mActiveCaches.vkPipelines.begin(), mActiveCaches.vkPipelines.end());
+
+    mActiveCaches.UBOs.clear();
+    mActiveCaches.VBOs.clear();
+    mActiveCaches.textures.clear();
+    mActiveCaches.renderbuffers.clear();
+    mActiveCaches.shaderPrograms.clear();
+    mActiveCaches.vkPipelines.clear();
+
+    mUniformRing.SubmitFrame(frame);
+    mVertexRing.SubmitFrame(frame);
+    mDescriptorPoolRing.SubmitFrame(frame);
+    mBindlessTextureTable.SubmitFrame(frame);
+    mFrameArena.Reset();
+
+    // pipelines are swapped between submissions, the draws of the next one bind the optimized ones
+    ReplaceLinkedVkPipelines();
+}
+
+void
+CacheManager::CleanUpFrameCaches(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    CleanUpCaches(&mSubmittedCaches[frame]);
+    mUniformRing.RetireFrame(frame);
+    mVertexRing.RetireFrame(frame);
+    mDescriptorPoolRing.RetireFrame(frame);
+    mBindlessTextureTable.RetireFrame(frame);
 }
 
 void
@@ -128,8 +369,12 @@ CacheManager::CleanUpCaches()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    CleanUpUBOCache();
-    CleanUpVBOCache();
-    CleanUpTextureCache();
-    CleanUpVkPipelineObjectCache();
+    for(uint32_t i = 0; i < GLOVE_FRAMES_IN_FLIGHT; ++i) {
+        CleanUpCaches(&mSubmittedCaches[i]);
+    }
+    CleanUpCaches(&mActiveCaches);
+    mUniformRing.RetireAll();
+    mVertexRing.RetireAll();
+    mDescriptorPoolRing.RetireAll();
+    mBindlessTextureTable.RetireAll();
 }
@@ -17,42 +17,114 @@
  *  @date       13/09/2018
  *  @version    1.0
  *
- *  @brief      Vulkan objects cache manager. These caches are needed to keep in memory Vulkan objects referred to by secondary command buffers.
+ *  @brief      Vulkan objects cache manager. These caches are needed to keep in memory Vulkan objects referred to by command buffers in flight.
  *
  */
 #ifndef __CACHEMANAGER_H__
 #define __CACHEMANAGER_H__
 
 #include <vector>
+#include <list>
+#include <unordered_map>
 #include "vulkan/vulkan.h"
 #include "utils/glLogger.h"
+#include "utils/frameArena.h"
 #include "resources/bufferObject.h"
 #include "resources/texture.h"
+#include "vulkan/commandBufferManager.h"
+#include "vulkan/pipelineWarmer.h"
+#include "vulkan/pipelineLibrary.h"
+#include "vulkan/uniformRing.h"
+#include "vulkan/descriptorPoolRing.h"
+#include "vulkan/bindlessTextureTable.h"
+#include "vulkan/commandBundle.h"
+
+/// Maximum number of VkPipeline objects kept alive for reuse
+#define GLOVE_MAX_CACHED_PIPELINES                      256
+
+class ShaderProgram;
+class Renderbuffer;
 
 class CacheManager {
 private:
+    typedef struct PipelineEntry_t {
+        std::vector<uint32_t>               key;
+        VkPipeline                          pipeline;
+        /// pipeline linked at draw time and replaced since, still bound by the command bundles recorded with it
+        VkPipeline                          linked;
+        VkPipelineLayout                    layout;
+        std::list<uint64_t>::iterator       lruIterator;
+    } PipelineEntry_t;
+
+    typedef struct Caches_t {
+        std::vector<UniformBufferObject *>  UBOs;
+        std::vector<BufferObject *>         VBOs;
+        std::vector<Texture *>              textures;
+        std::vector<Renderbuffer *>         renderbuffers;
+        std::vector<ShaderProgram *>        shaderPrograms;
+        std::vector<VkPipeline>             vkPipelines;
+    } Caches_t;
+
     const
     vulkanAPI::vkContext_t *            mVkContext;
 
-    std::vector<UniformBufferObject *>  mUBOCache;
-    std::vector<BufferObject *>         mVBOCache;
-    std::vector<Texture *>              mTextureCache;
-    std::vector<VkPipeline>             mVkPipelineObjectCache;
+    Caches_t                            mActiveCaches;
+    Caches_t                            mSubmittedCaches[GLOVE_FRAMES_IN_FLIGHT];
+
+    std::unordered_map<uint64_t, PipelineEntry_t> mVkPipelineObjectCache;
+    std::list<uint64_t>                 mVkPipelineLRU;
 
-    void                                CleanUpUBOCache();
-    void                                CleanUpVBOCache();
-    void                                CleanUpTextureCache();
-    void                                CleanUpVkPipelineObjectCache();
+    vulkanAPI::PipelineWarmer           mPipelineWarmer;
+    vulkanAPI::PipelineLibrary          mPipelineLibrary;
+    vulkanAPI::UniformRing              mUniformRing;
+    vulkanAPI::UniformRing              mVertexRing;
+    vulkanAPI::DescriptorPoolRing       mDescriptorPoolRing;
+    vulkanAPI::BindlessTextureTable     mBindlessTextureTable;
+    FrameArena                          mFrameArena;
+
+    /// while draws are captured, their data goes to the rings of the bundle instead of the ones of the frames
+    vulkanAPI::CommandBundle           *mCaptureBundle;
+
+    void                                CleanUpUBOCache(Caches_t *caches);
+    void                                CleanUpVBOCache(Caches_t *caches);
+    void                                CleanUpTextureCache(Caches_t *caches);
+    void                                CleanUpRenderbufferCache(Caches_t *caches);
+    void                                CleanUpShaderProgramCache(Caches_t *caches);
+    void                                CleanUpVkPipelineObjectCache(Caches_t *caches);
+    void                                CleanUpCaches(Caches_t *caches);
+    void                                EvictVkPipeline(std::unordered_map<uint64_t, PipelineEntry_t>::iterator it);
+    void                                ReplaceLinkedVkPipelines(void);
 
 public:
-     CacheManager(const vulkanAPI::vkContext_t *vkContext) : mVkContext(vkContext) { }
-    ~CacheManager() { }
+     CacheManager(const vulkanAPI::vkContext_t *vkContext) : mVkContext(vkContext), mPipelineWarmer(vkContext), mPipelineLibrary(vkContext), mUniformRing(vkContext),
+                                                           mVertexRing(vkContext, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, GLOVE_VERTEX_RING_ALIGNMENT),
+                                                           mDescriptorPoolRing(vkContext), mBindlessTextureTable(vkContext), mCaptureBundle(nullptr) { }
+    ~CacheManager();
 
     void                                CacheUBO(UniformBufferObject *uniformBufferObject);
     void                                CacheVBO(BufferObject *vbo);
     void                                CacheTexture(Texture *tex);
+    void                                CacheRenderbuffer(Renderbuffer *renderbuffer);
+    void                                CacheShaderProgram(ShaderProgram *program);
     void                                CacheVkPipelineObject(VkPipeline pipeline);
+    VkPipeline                          FindVkPipeline(uint64_t hash, const std::vector<uint32_t> &key);
+    bool                                TouchVkPipeline(uint64_t hash, VkPipeline pipeline, bool recorded = false);
+    void                                InsertVkPipeline(uint64_t hash, const std::vector<uint32_t> &key, VkPipeline pipeline, VkPipelineLayout layout);
+    void                                EvictVkPipelines(VkPipelineLayout layout);
+    void                                TrimVkPipelines(size_t keptPipelines);
+    void                                SubmitCaches(uint32_t frame);
+    void                                CleanUpFrameCaches(uint32_t frame);
     void                                CleanUpCaches();
+
+    inline vulkanAPI::PipelineWarmer   *GetPipelineWarmer(void)           { FUN_ENTRY(GL_LOG_TRACE); return &mPipelineWarmer; }
+    inline vulkanAPI::PipelineLibrary  *GetPipelineLibrary(void)          { FUN_ENTRY(GL_LOG_TRACE); return &mPipelineLibrary; }
+    inline vulkanAPI::UniformRing      *GetUniformRing(void)              { FUN_ENTRY(GL_LOG_TRACE); return mCaptureBundle ? mCaptureBundle->GetUniformRing() : &mUniformRing; }
+    inline vulkanAPI::UniformRing      *GetVertexRing(void)               { FUN_ENTRY(GL_LOG_TRACE); return mCaptureBundle ? mCaptureBundle->GetVertexRing()  : &mVertexRing; }
+    inline vulkanAPI::DescriptorPoolRing *GetDescriptorPoolRing(void)     { FUN_ENTRY(GL_LOG_TRACE); return mCaptureBundle ? mCaptureBundle->GetDescriptorPoolRing() : &mDescriptorPoolRing; }
+    inline vulkanAPI::BindlessTextureTable *GetBindlessTextureTable(void) { FUN_ENTRY(GL_LOG_TRACE); return &mBindlessTextureTable; }
+    inline FrameArena                  *GetFrameArena(void)               { FUN_ENTRY(GL_LOG_TRACE); return &mFrameArena; }
+
+    inline void                         SetCaptureBundle(vulkanAPI::CommandBundle *bundle) { FUN_ENTRY(GL_LOG_TRACE); mCaptureBundle = bundle; }
 };
 
 #endif //__CACHEMANAGER_H__
@@ -0,0 +1,241 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       chromeTrace.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Spans of CPU and GPU work exported as a Chrome / Perfetto JSON trace
+ *
+ *  @section
+ *
+ *  When GLOVE_CHROME_TRACE names a file, every span is kept in memory and the
+ *  whole trace is written to it in the JSON format of chrome://tracing, which
+ *  Perfetto opens as well, once GLOVE shuts down. A thread buffers its spans
+ *  behind a lock no other thread takes until then, and hands them over
+ *  GLOVE_CHROME_TRACE_BATCH at a time.
+ *
+ *  The GPU spans come from timestamp queries, whose clock has an unknown
+ *  offset to the CPU one. Each span is resolved after it has completed on the
+ *  GPU, so the CPU time it is resolved at bounds the offset. The tightest
+ *  bound seen aligns all of them when the trace is written, on a track of
+ *  their own.
+ *
+ */
+
+#include "chromeTrace.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef struct chromeTraceSpan_t {
+    const char                     *name;
+    const char                     *category;
+    uint64_t                        start;
+    uint64_t                        end;
+    uint32_t                        thread;
+} chromeTraceSpan_t;
+
+class ChromeTraceBuffer;
+
+typedef struct chromeTraceState_t {
+    std::mutex                      mutex;
+    /// outlive their threads, so that shutting down collects them without racing a thread exit
+    std::vector<ChromeTraceBuffer *> buffers;
+    std::string                     path;
+    std::vector<chromeTraceSpan_t>  spans;
+    std::vector<chromeTraceSpan_t>  gpuSpans;
+    int64_t                         gpuOffset;
+    bool                            gpuOffsetKnown;
+    uint32_t                        nextThread;
+    uint64_t                        start;
+    bool                            written;
+} chromeTraceState_t;
+
+/// the GPU track is given a thread id no CPU thread gets
+#define GLOVE_CHROME_TRACE_GPU_THREAD                   0xFFFF
+
+std::atomic<int> ChromeTrace::mEnabled(-1);
+
+static chromeTraceState_t *
+GetChromeTraceState(void)
+{
+    static chromeTraceState_t *state = new chromeTraceState_t();
+    return state;
+}
+
+class ChromeTraceBuffer {
+public:
+    std::mutex                      mutex;
+    std::vector<chromeTraceSpan_t>  spans;
+    uint32_t                        thread;
+
+    ChromeTraceBuffer() : thread(0)     { spans.reserve(GLOVE_CHROME_TRACE_BATCH); }
+
+    /// called with the lock of the buffer held, takes the one of the trace
+    void HandOver(chromeTraceState_t *state)
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->spans.insert(state->spans.end(), spans.begin(), spans.end());
+        spans.clear();
+    }
+};
+
+static thread_local ChromeTraceBuffer *threadBuffer = nullptr;
+
+static ChromeTraceBuffer *
+GetThreadBuffer(void)
+{
+    if(threadBuffer == nullptr) {
+        chromeTraceState_t *state = GetChromeTraceState();
+        std::lock_guard<std::mutex> lock(state->mutex);
+
+        threadBuffer = new ChromeTraceBuffer();
+        threadBuffer->thread = state->nextThread++;
+        state->buffers.push_back(threadBuffer);
+    }
+
+    return threadBuffer;
+}
+
+bool
+ChromeTrace::Initialize()
+{
+    chromeTraceState_t *state = GetChromeTraceState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    int enabled = mEnabled.load(std::memory_order_relaxed);
+    if(enabled >= 0) {
+        return enabled != 0;
+    }
+
+    const char *path = getenv(GLOVE_CHROME_TRACE_ENV);
+    if(path == nullptr || path[0] == '\0') {
+        mEnabled.store(0, std::memory_order_relaxed);
+        return false;
+    }
+
+    state->path           = path;
+    state->start          = Now();
+    state->gpuOffset      = 0;
+    state->gpuOffsetKnown = false;
+    state->nextThread     = 1;
+    state->written        = false;
+    atexit(ChromeTrace::Shutdown);
+
+    mEnabled.store(1, std::memory_order_relaxed);
+    return true;
+}
+
+void
+ChromeTrace::AddSpan(const char *name, const char *category, uint64_t start, uint64_t end)
+{
+    ChromeTraceBuffer *buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+
+    chromeTraceSpan_t span = { name, category, start, end, buffer->thread };
+    buffer->spans.push_back(span);
+
+    if(buffer->spans.size() >= GLOVE_CHROME_TRACE_BATCH) {
+        buffer->HandOver(GetChromeTraceState());
+    }
+}
+
+void
+ChromeTrace::AddGpuSpan(const char *name, uint64_t gpuStart, uint64_t gpuEnd)
+{
+    if(!IsEnabled()) {
+        return;
+    }
+
+    const int64_t offset = static_cast<int64_t>(Now()) - static_cast<int64_t>(gpuEnd);
+
+    chromeTraceState_t *state = GetChromeTraceState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    // the span ended on the GPU before now, so now bounds the offset from the GPU clock to the CPU one
+    if(!state->gpuOffsetKnown || offset < state->gpuOffset) {
+        state->gpuOffset      = offset;
+        state->gpuOffsetKnown = true;
+    }
+
+    chromeTraceSpan_t span = { name, "gpu", gpuStart, gpuEnd, GLOVE_CHROME_TRACE_GPU_THREAD };
+    state->gpuSpans.push_back(span);
+}
+
+static void
+WriteSpan(FILE *file, const chromeTraceSpan_t &span, int64_t offset, uint64_t start, bool *first)
+{
+    // the times of the format are microseconds since the trace started
+    const double ts  = static_cast<double>(static_cast<int64_t>(span.start) + offset - static_cast<int64_t>(start)) / 1000.0;
+    const double dur = static_cast<double>(span.end - span.start) / 1000.0;
+
+    fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            *first ? "" : ",", span.name, span.category, ts, dur, span.thread);
+    *first = false;
+}
+
+void
+ChromeTrace::Shutdown()
+{
+    if(mEnabled.load(std::memory_order_relaxed) <= 0) {
+        return;
+    }
+
+    chromeTraceState_t *state = GetChromeTraceState();
+
+    // the buffers only grow in number, the spans left in them have not reached a batch yet
+    std::vector<ChromeTraceBuffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        buffers = state->buffers;
+    }
+    for(auto buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->HandOver(state);
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if(state->written) {
+        return;
+    }
+
+    FILE *file = fopen(state->path.c_str(), "w");
+    if(file == nullptr) {
+        return;
+    }
+
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    fprintf(file, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}", GLOVE_CHROME_TRACE_GPU_THREAD);
+    first = false;
+
+    for(const auto &span : state->spans) {
+        WriteSpan(file, span, 0, state->start, &first);
+    }
+
+    for(const auto &span : state->gpuSpans) {
+        WriteSpan(file, span, state->gpuOffset, state->start, &first);
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    state->written = true;
+    mEnabled.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       chromeTrace.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Spans of CPU and GPU work exported as a Chrome / Perfetto JSON trace
+ *
+ */
+
+#ifndef __CHROMETRACE_H__
+#define __CHROMETRACE_H__
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+/// Environment variable holding the JSON file the spans are written to, no spans are recorded when unset
+#define GLOVE_CHROME_TRACE_ENV                          "GLOVE_CHROME_TRACE"
+
+/// Spans a thread buffers before they are handed over to the trace
+#define GLOVE_CHROME_TRACE_BATCH                        4096
+
+#define CHROME_TRACE_CONCAT_HELPER(a, b)                a##b
+#define CHROME_TRACE_CONCAT(a, b)                       CHROME_TRACE_CONCAT_HELPER(a, b)
+
+/// Spans the rest of the enclosing scope, name and category are string literals or live as long as the trace
+#define CHROME_TRACE_SPAN(name, category)               ChromeTraceSpan CHROME_TRACE_CONCAT(chromeTraceSpan, __LINE__)(name, category)
+
+class ChromeTrace {
+private:
+    /// -1 until the environment has been read, then whether the spans are recorded
+    static std::atomic<int> mEnabled;
+
+    static bool           Initialize();
+
+public:
+    static inline bool    IsEnabled()                   { int enabled = mEnabled.load(std::memory_order_relaxed); return enabled < 0 ? Initialize() : enabled != 0; }
+    static inline uint64_t Now()                        { return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()); }
+
+    static void           AddSpan(const char *name, const char *category, uint64_t start, uint64_t end);
+    /// the times are in nanoseconds of the GPU clock, which is only aligned to the CPU clock when the trace is written
+    static void           AddGpuSpan(const char *name, uint64_t gpuStart, uint64_t gpuEnd);
+    static void           Shutdown();
+};
+
+class ChromeTraceSpan {
+private:
+    const char           *mName;
+    const char           *mCategory;
+    uint64_t              mStart;
+
+public:
+    ChromeTraceSpan(const char *name, const char *category)
+    : mName(name), mCategory(category), mStart(ChromeTrace::IsEnabled() ? ChromeTrace::Now() : 0) { }
+
+    ~ChromeTraceSpan()                                  { if(mStart) { ChromeTrace::AddSpan(mName, mCategory, mStart, ChromeTrace::Now()); } }
+};
+
+#endif //__CHROMETRACE_H__
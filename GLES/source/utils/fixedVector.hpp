@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       fixedVector.hpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      A C++ header-only vector of a fixed capacity, kept inline in its owner.
+ *
+ */
+
+#ifndef __FIXEDVECTOR_HPP__
+#define __FIXEDVECTOR_HPP__
+
+#include <cassert>
+#include <cstddef>
+
+/// For the short lists whose length is bounded by the code building them,
+/// such as the semaphores of a submission, so that they never reach the heap
+template<typename T, size_t CAPACITY>
+class FixedVector {
+private:
+    T                               mData[CAPACITY];
+    size_t                          mSize;
+
+public:
+    FixedVector() : mSize(0) { }
+
+    inline void                     push_back(const T &value)                 { assert(mSize < CAPACITY); mData[mSize++] = value; }
+    inline void                     clear(void)                               { mSize = 0; }
+
+    inline size_t                   size(void)                          const { return mSize; }
+    inline bool                     empty(void)                         const { return mSize == 0; }
+    inline T                       *data(void)                                { return mData; }
+    inline const T                 *data(void)                          const { return mData; }
+    inline T                       &operator[](size_t i)                      { assert(i < mSize); return mData[i]; }
+    inline const T                 &operator[](size_t i)                const { assert(i < mSize); return mData[i]; }
+
+    inline T                       *begin(void)                               { return mData; }
+    inline T                       *end(void)                                 { return mData + mSize; }
+    inline const T                 *begin(void)                         const { return mData; }
+    inline const T                 *end(void)                           const { return mData + mSize; }
+};
+
+#endif // __FIXEDVECTOR_HPP__
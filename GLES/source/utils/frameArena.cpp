@@ -0,0 +1,123 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       frameArena.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Linear allocator of the temporaries of the draws of a context, reset every frame
+ *
+ *  @section
+ *
+ *  The arrays a draw only needs until it is recorded are carved out of chunks
+ *  that the context keeps, instead of the heap. A call rewinds the arena to
+ *  where it found it once it is done, so that the same bytes serve every draw.
+ *  Chunks are only added while the arena grows; at the end of a frame they are
+ *  merged into a single chunk, so that steady-state frames need no allocation
+ *  at all.
+ *
+ */
+
+#include <cassert>
+#include "frameArena.h"
+#include "utils/globals.h"
+
+FrameArena::FrameArena()
+: mChunk(0), mOffset(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    ReleaseChunks();
+}
+
+void
+FrameArena::ReleaseChunks(void)
+{
+    for(auto &chunk : mChunks) {
+        delete[] chunk.data;
+    }
+    mChunks.clear();
+    mChunk  = 0;
+    mOffset = 0;
+}
+
+void *
+FrameArena::Allocate(size_t size, size_t alignment)
+{
+    assert(alignment && !(alignment & (alignment - 1)));
+
+    // the chunks are allocated with new[], which aligns them for any fundamental type
+    while(mChunk < mChunks.size()) {
+        const size_t offset = (mOffset + alignment - 1) & ~(alignment - 1);
+        if(offset + size <= mChunks[mChunk].size) {
+            mOffset = offset + size;
+            return mChunks[mChunk].data + offset;
+        }
+        ++mChunk;
+        mOffset = 0;
+    }
+
+    Chunk_t chunk;
+    chunk.size = size > GLOVE_FRAME_ARENA_CHUNK_SIZE ? size : GLOVE_FRAME_ARENA_CHUNK_SIZE;
+    chunk.data = new uint8_t[chunk.size];
+    mChunks.push_back(chunk);
+
+    mChunk  = mChunks.size() - 1;
+    mOffset = size;
+
+    return chunk.data;
+}
+
+void
+FrameArena::Rewind(const Mark_t &mark)
+{
+    assert(mark.chunk < mChunk || (mark.chunk == mChunk && mark.offset <= mOffset));
+
+    mChunk  = mark.chunk;
+    mOffset = mark.offset;
+}
+
+void
+FrameArena::Reset(void)
+{
+    // temporaries still in use keep their chunks until a later frame
+    if(mChunk || mOffset) {
+        return;
+    }
+
+    // a frame that needed more than one chunk gets them as one from now on
+    if(mChunks.size() > 1) {
+        const size_t capacity = GetCapacity();
+        ReleaseChunks();
+
+        Chunk_t chunk;
+        chunk.size = capacity;
+        chunk.data = new uint8_t[chunk.size];
+        mChunks.push_back(chunk);
+    }
+}
+
+size_t
+FrameArena::GetCapacity(void) const
+{
+    size_t capacity = 0;
+    for(const auto &chunk : mChunks) {
+        capacity += chunk.size;
+    }
+
+    return capacity;
+}
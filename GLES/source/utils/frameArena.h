@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       frameArena.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Linear allocator of the temporaries of the draws of a context, reset every frame
+ *
+ */
+
+#ifndef __FRAMEARENA_H__
+#define __FRAMEARENA_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class FrameArena {
+private:
+    typedef struct Chunk_t {
+        uint8_t                    *data;
+        size_t                      size;
+    } Chunk_t;
+
+    /// chunks are only released along with the arena, or merged when it is reset
+    std::vector<Chunk_t>            mChunks;
+    size_t                          mChunk;
+    size_t                          mOffset;
+
+    void                            ReleaseChunks(void);
+
+public:
+    /// a position of the arena, the allocations made after it are rewound to it together
+    typedef struct Mark_t {
+        size_t                      chunk;
+        size_t                      offset;
+    } Mark_t;
+
+    /// rewinds the arena when the temporaries of a call go out of scope,
+    /// every allocation is made within one
+    class Scope {
+    private:
+        FrameArena                 *mArena;
+        Mark_t                      mMark;
+
+    public:
+        explicit Scope(FrameArena *arena) : mArena(arena), mMark(arena->GetMark()) { }
+        ~Scope()                                                            { mArena->Rewind(mMark); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+// Constructor
+    FrameArena();
+
+// Destructor
+    ~FrameArena();
+
+// Allocate Functions
+    void                           *Allocate(size_t size, size_t alignment);
+    template<typename T>
+    inline T                       *Allocate(size_t count)                  { return static_cast<T *>(Allocate(count * sizeof(T), alignof(T))); }
+
+// Reset Functions
+    void                            Rewind(const Mark_t &mark);
+    void                            Reset(void);
+
+// Get Functions
+    inline Mark_t                   GetMark(void)                     const { Mark_t mark = { mChunk, mOffset }; return mark; }
+    size_t                          GetCapacity(void)                 const;
+};
+
+#endif // __FRAMEARENA_H__
@@ -0,0 +1,828 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glCapture.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Capture of the GL call stream, along with the client memory it reads, into a binary file
+ *
+ *  @section
+ *
+ *  When GLOVE_CAPTURE names a file, every GL call made to GLOVE is written
+ *  to it in the layout of glCaptureFormat.h, as it returns. The client
+ *  memory a call reads is copied into its record, and the names and uniform
+ *  locations it hands out are recorded, so that the replayer can map them to
+ *  the ones of the driver it drives.
+ *
+ *  Client vertex arrays are only read by the draws, so the capture keeps the
+ *  state that tells which ones a draw reads and records them again, along
+ *  with the vertices the draw reaches, right before it. A draw whose indices
+ *  are in a buffer object cannot tell that range, so its client arrays are
+ *  not captured.
+ *
+ *  The calls of all the contexts and threads make up a single stream.
+ *
+ */
+
+#include "glCapture.h"
+#include "glUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define GLOVE_CAPTURE_MAX_ATTRIBS                       32
+
+typedef struct captureAttrib_t {
+    GLint                           size;
+    GLenum                          type;
+    GLboolean                       normalized;
+    GLsizei                         stride;
+    const void                     *pointer;
+    bool                            enabled;
+    bool                            client;
+} captureAttrib_t;
+
+typedef struct captureMapping_t {
+    const void                     *pointer;
+    GLintptr                        offset;
+    GLsizeiptr                      length;
+} captureMapping_t;
+
+/// the vertex array state a vertex array object keeps while another one is bound
+typedef struct captureVertexArray_t {
+    captureAttrib_t                 attribs[GLOVE_CAPTURE_MAX_ATTRIBS];
+    GLuint                          elementArrayBuffer;
+} captureVertexArray_t;
+
+typedef struct captureState_t {
+    std::mutex                      mutex;
+    FILE                           *file;
+    std::vector<char>               fileBuffer;
+    /// ids by the names of the calls, the same name may be given at different addresses
+    std::unordered_map<const char *, uint16_t> calls;
+    std::unordered_map<std::string, uint16_t>  callIds;
+    uint64_t                        start;
+
+    GLuint                          arrayBuffer;
+    GLuint                          elementArrayBuffer;
+    GLuint                          vertexArray;
+    GLuint                          program;
+    GLint                           packAlignment;
+    GLint                           unpackAlignment;
+    captureAttrib_t                 attribs[GLOVE_CAPTURE_MAX_ATTRIBS];
+    std::unordered_map<GLuint, GLsizeiptr> bufferSizes;
+    std::unordered_map<GLuint, captureMapping_t> mappings;
+    std::unordered_map<GLuint, captureVertexArray_t> vertexArrays;
+    bool                            warnedIndexedClientArrays;
+} captureState_t;
+
+std::atomic<int>                    GLCapture::mEnabled(-1);
+
+/// a record is built on the thread making the call, the calls GLOVE makes to itself meanwhile are not captured
+static thread_local std::vector<uint8_t> threadRecord;
+static thread_local bool            threadRecording = false;
+
+static captureState_t *
+GetCaptureState(void)
+{
+    static captureState_t *state = new captureState_t();
+    return state;
+}
+
+static inline uint64_t
+Now(void)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static size_t
+AttribTypeSize(GLenum type)
+{
+    switch(type) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:          return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT_OES:         return 2;
+    default:                        return 4;
+    }
+}
+
+static size_t
+AttribElementSize(GLint size, GLenum type)
+{
+    // the packed types hold all the components of an element in one word
+    return type == GL_UNSIGNED_INT_10_10_10_2_OES || type == GL_INT_10_10_10_2_OES ?
+           sizeof(GLuint) : static_cast<size_t>(size) * AttribTypeSize(type);
+}
+
+static size_t
+IndexTypeSize(GLenum type)
+{
+    switch(type) {
+    case GL_UNSIGNED_BYTE:          return 1;
+    case GL_UNSIGNED_SHORT:         return 2;
+    default:                        return 4;
+    }
+}
+
+/// keeps the vertex arrays of the bound object aside and takes those of array, called with the lock of the state held
+static void
+SwitchVertexArray(captureState_t *state, GLuint array)
+{
+    if(array == state->vertexArray) {
+        return;
+    }
+
+    captureVertexArray_t &current = state->vertexArrays[state->vertexArray];
+    memcpy(current.attribs, state->attribs, sizeof(state->attribs));
+    current.elementArrayBuffer = state->elementArrayBuffer;
+
+    const captureVertexArray_t &bound = state->vertexArrays[array];
+    memcpy(state->attribs, bound.attribs, sizeof(state->attribs));
+    state->elementArrayBuffer = bound.elementArrayBuffer;
+    state->vertexArray        = array;
+}
+
+/// the buffer bound to the target, called with the lock of the state held
+static GLuint
+BoundBuffer(captureState_t *state, GLenum target)
+{
+    return target == GL_ARRAY_BUFFER ? state->arrayBuffer : target == GL_ELEMENT_ARRAY_BUFFER ? state->elementArrayBuffer : 0;
+}
+
+static GLuint
+MaxIndex(GLsizei count, GLenum type, const void *indices)
+{
+    GLuint maxIndex = 0;
+    for(GLsizei i = 0; i < count; ++i) {
+        switch(type) {
+        case GL_UNSIGNED_BYTE:      maxIndex = std::max<GLuint>(maxIndex, static_cast<const GLubyte *>(indices)[i]);  break;
+        case GL_UNSIGNED_SHORT:     maxIndex = std::max<GLuint>(maxIndex, static_cast<const GLushort *>(indices)[i]); break;
+        default:                    maxIndex = std::max<GLuint>(maxIndex, static_cast<const GLuint *>(indices)[i]);   break;
+        }
+    }
+
+    return maxIndex;
+}
+
+bool
+GLCapture::Initialize()
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    int enabled = mEnabled.load(std::memory_order_relaxed);
+    if(enabled >= 0) {
+        return enabled != 0;
+    }
+
+    const char *path = getenv(GLOVE_CAPTURE_ENV);
+    state->file = (path != nullptr && path[0] != '\0') ? fopen(path, "wb") : nullptr;
+    if(state->file == nullptr) {
+        mEnabled.store(0, std::memory_order_relaxed);
+        return false;
+    }
+
+    state->fileBuffer.resize(GLOVE_CAPTURE_FILE_BUFFER);
+    setvbuf(state->file, state->fileBuffer.data(), _IOFBF, state->fileBuffer.size());
+
+    uint8_t header[GLOVE_CAPTURE_HEADER_SIZE] = { 0 };
+    const uint32_t version = GLOVE_CAPTURE_VERSION;
+    memcpy(header, GLOVE_CAPTURE_MAGIC, GLOVE_CAPTURE_MAGIC_SIZE);
+    memcpy(header + GLOVE_CAPTURE_MAGIC_SIZE, &version, sizeof(version));
+    fwrite(header, 1, sizeof(header), state->file);
+
+    state->start                     = Now();
+    state->arrayBuffer               = 0;
+    state->elementArrayBuffer        = 0;
+    state->vertexArray               = 0;
+    state->program                   = 0;
+    state->packAlignment             = 4;
+    state->unpackAlignment           = 4;
+    state->warnedIndexedClientArrays = false;
+    memset(state->attribs, 0, sizeof(state->attribs));
+    atexit(GLCapture::Shutdown);
+
+    mEnabled.store(1, std::memory_order_relaxed);
+    return true;
+}
+
+void
+GLCapture::Shutdown()
+{
+    if(mEnabled.load(std::memory_order_relaxed) <= 0) {
+        return;
+    }
+
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if(state->file) {
+        fclose(state->file);
+        state->file = nullptr;
+    }
+    mEnabled.store(0, std::memory_order_relaxed);
+}
+
+void
+GLCapture::Commit(const char *call, std::vector<uint8_t> &record)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if(state->file == nullptr) {
+        return;
+    }
+
+    captureRecordHeader_t header;
+    memcpy(&header, record.data(), sizeof(header));
+    header.nanoseconds = header.nanoseconds > state->start ? header.nanoseconds - state->start : 0;
+
+    auto id = state->calls.find(call);
+    bool defined = true;
+    if(id == state->calls.end()) {
+        auto callId = state->callIds.find(call);
+        if(callId == state->callIds.end()) {
+            callId  = state->callIds.emplace(call, static_cast<uint16_t>(state->callIds.size())).first;
+            defined = false;
+        }
+        id = state->calls.emplace(call, callId->second).first;
+    }
+
+    if(!defined) {
+        // the name is the only argument, a BLOB, whose size ends where the header does plus the argument tag
+        const uint32_t nameSize = static_cast<uint32_t>(strlen(call) + 1);
+        const uint32_t size     = static_cast<uint32_t>((sizeof(captureRecordHeader_t) + 8 + nameSize + GLOVE_CAPTURE_ALIGNMENT - 1) & ~(GLOVE_CAPTURE_ALIGNMENT - 1));
+        std::vector<uint8_t> define(size, 0);
+        captureRecordHeader_t defineHeader = { size, id->second, 1, GLOVE_CAPTURE_FLAG_DEFINE, header.nanoseconds };
+        memcpy(define.data(), &defineHeader, sizeof(defineHeader));
+        define[sizeof(defineHeader)]     = CAPTURE_ARG_BLOB;
+        define[sizeof(defineHeader) + 1] = CAPTURE_NAME_NONE;
+        memcpy(define.data() + sizeof(defineHeader) + 4, &nameSize, sizeof(nameSize));
+        memcpy(define.data() + sizeof(defineHeader) + 8, call, nameSize);
+        fwrite(define.data(), 1, define.size(), state->file);
+    }
+
+    header.call = id->second;
+    memcpy(record.data(), &header, sizeof(header));
+    fwrite(record.data(), 1, record.size(), state->file);
+}
+
+void
+GLCapture::BindBuffer(GLenum target, GLuint buffer)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if(target == GL_ARRAY_BUFFER) {
+        state->arrayBuffer = buffer;
+    } else if(target == GL_ELEMENT_ARRAY_BUFFER) {
+        state->elementArrayBuffer = buffer;
+    }
+}
+
+void
+GLCapture::BufferData(GLenum target, GLsizeiptr size)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    const GLuint buffer = BoundBuffer(state, target);
+    if(buffer) {
+        state->bufferSizes[buffer] = size;
+    }
+}
+
+void
+GLCapture::MapBuffer(GLenum target, const void *pointer, GLintptr offset, GLsizeiptr length)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    const GLuint buffer = BoundBuffer(state, target);
+    if(buffer && pointer) {
+        const captureMapping_t mapping = { pointer, offset, length ? length : state->bufferSizes[buffer] - offset };
+        state->mappings[buffer] = mapping;
+    }
+}
+
+bool
+GLCapture::UnmapBuffer(GLenum target, GLintptr *offset, std::vector<uint8_t> &data)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    auto mapping = state->mappings.find(BoundBuffer(state, target));
+    if(mapping == state->mappings.end()) {
+        return false;
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(mapping->second.pointer);
+    *offset = mapping->second.offset;
+    data.assign(bytes, bytes + std::max<GLsizeiptr>(mapping->second.length, 0));
+    state->mappings.erase(mapping);
+
+    return true;
+}
+
+void
+GLCapture::DeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    for(GLsizei i = 0; buffers && i < n; ++i) {
+        if(buffers[i] == state->arrayBuffer) {
+            state->arrayBuffer = 0;
+        }
+        if(buffers[i] == state->elementArrayBuffer) {
+            state->elementArrayBuffer = 0;
+        }
+        state->bufferSizes.erase(buffers[i]);
+        state->mappings.erase(buffers[i]);
+    }
+}
+
+void
+GLCapture::BindVertexArray(GLuint array)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    SwitchVertexArray(state, array);
+}
+
+void
+GLCapture::DeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    for(GLsizei i = 0; arrays && i < n; ++i) {
+        if(arrays[i] == 0) {
+            continue;
+        }
+        if(arrays[i] == state->vertexArray) {
+            SwitchVertexArray(state, 0);
+        }
+        state->vertexArrays.erase(arrays[i]);
+    }
+}
+
+void
+GLCapture::UseProgram(GLuint program)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    state->program = program;
+}
+
+void
+GLCapture::SetVertexAttribArrayEnabled(GLuint index, bool enabled)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if(index < GLOVE_CAPTURE_MAX_ATTRIBS) {
+        state->attribs[index].enabled = enabled;
+    }
+}
+
+void
+GLCapture::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *ptr)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if(index < GLOVE_CAPTURE_MAX_ATTRIBS) {
+        captureAttrib_t &attrib = state->attribs[index];
+        attrib.size       = size;
+        attrib.type       = type;
+        attrib.normalized = normalized;
+        attrib.stride     = stride;
+        attrib.pointer    = ptr;
+        attrib.client     = state->arrayBuffer == 0;
+    }
+}
+
+void
+GLCapture::PixelStorei(GLenum pname, GLint param)
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if(pname == GL_PACK_ALIGNMENT) {
+        state->packAlignment = param;
+    } else if(pname == GL_UNPACK_ALIGNMENT) {
+        state->unpackAlignment = param;
+    }
+}
+
+size_t
+GLCapture::ImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, bool pack)
+{
+    if(width <= 0 || height <= 0) {
+        return 0;
+    }
+
+    GLint alignment;
+    {
+        captureState_t *state = GetCaptureState();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        alignment = std::max(pack ? state->packAlignment : state->unpackAlignment, 1);
+    }
+
+    const size_t pixelSize = static_cast<size_t>(GlInternalFormatTypeToNumElements(format, type) * GlTypeToElementSize(type));
+    const size_t rowSize   = static_cast<size_t>(width) * pixelSize;
+    const size_t stride    = (rowSize + alignment - 1) / alignment * alignment;
+
+    // the last row is not padded
+    return stride * static_cast<size_t>(height - 1) + rowSize;
+}
+
+GLuint
+GLCapture::GetCurrentProgram()
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    return state->program;
+}
+
+bool
+GLCapture::UsesClientIndices()
+{
+    captureState_t *state = GetCaptureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    return state->elementArrayBuffer == 0;
+}
+
+void
+GLCapture::CaptureClientArrays(GLuint firstVertex, GLuint vertexCount)
+{
+    captureAttrib_t attribs[GLOVE_CAPTURE_MAX_ATTRIBS];
+    GLuint arrayBuffer;
+    {
+        captureState_t *state = GetCaptureState();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        memcpy(attribs, state->attribs, sizeof(attribs));
+        arrayBuffer = state->arrayBuffer;
+    }
+
+    // the pointers are read as offsets while a buffer is bound
+    bool unbound = false;
+    for(GLuint index = 0; vertexCount && index < GLOVE_CAPTURE_MAX_ATTRIBS; ++index) {
+        const captureAttrib_t &attrib = attribs[index];
+        if(!attrib.enabled || !attrib.client || attrib.pointer == nullptr) {
+            continue;
+        }
+
+        // the vertices the draw reaches, from the start of the array the pointer is given of
+        const size_t elementSize = AttribElementSize(attrib.size, attrib.type);
+        const size_t stride      = attrib.stride ? static_cast<size_t>(attrib.stride) : elementSize;
+        const size_t size        = (firstVertex + vertexCount - 1) * stride + elementSize;
+
+        if(arrayBuffer && !unbound) {
+            GLCaptureRecord record("glBindBuffer");
+            if(record.IsActive()) {
+                record(GL_ARRAY_BUFFER, CaptureName(0, CAPTURE_NAME_BUFFER));
+            }
+            unbound = true;
+        }
+
+        GLCaptureRecord record("glVertexAttribPointer");
+        if(record.IsActive()) {
+            record(index, attrib.size, attrib.type, attrib.normalized, attrib.stride, CaptureBlob(attrib.pointer, size));
+        }
+    }
+
+    if(unbound) {
+        GLCaptureRecord record("glBindBuffer");
+        if(record.IsActive()) {
+            record(GL_ARRAY_BUFFER, CaptureName(arrayBuffer, CAPTURE_NAME_BUFFER));
+        }
+    }
+}
+
+void
+GLCapture::ClientArrays(GLint first, GLsizei count)
+{
+    if(first >= 0 && count > 0) {
+        CaptureClientArrays(static_cast<GLuint>(first), static_cast<GLuint>(count));
+    }
+}
+
+void
+GLCapture::ClientArrays(GLsizei count, GLenum type, const void *indices)
+{
+    captureState_t *state = GetCaptureState();
+    bool clientIndices;
+    bool clientArrays = false;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        clientIndices = state->elementArrayBuffer == 0;
+        for(uint32_t i = 0; i < GLOVE_CAPTURE_MAX_ATTRIBS; ++i) {
+            clientArrays |= state->attribs[i].enabled && state->attribs[i].client;
+        }
+
+        if(clientArrays && !clientIndices && !state->warnedIndexedClientArrays) {
+            fprintf(stderr, "GLOVE: client arrays drawn by indices of a buffer object are not captured\n");
+            state->warnedIndexedClientArrays = true;
+        }
+    }
+
+    if(clientArrays && clientIndices && indices && count > 0) {
+        CaptureClientArrays(0, MaxIndex(count, type, indices) + 1);
+    }
+}
+
+void
+GLCapture::ClientArrays(const GLint *first, const GLsizei *count, GLsizei primcount)
+{
+    GLuint lastVertex = 0;
+    for(GLsizei i = 0; first && count && i < primcount; ++i) {
+        if(first[i] >= 0 && count[i] > 0) {
+            lastVertex = std::max(lastVertex, static_cast<GLuint>(first[i] + count[i]));
+        }
+    }
+
+    CaptureClientArrays(0, lastVertex);
+}
+
+void
+GLCapture::ClientArrays(const GLsizei *count, GLenum type, const void *const *indices, GLsizei primcount)
+{
+    if(!UsesClientIndices()) {
+        ClientArrays(0, type, nullptr);
+        return;
+    }
+
+    GLuint vertexCount = 0;
+    for(GLsizei i = 0; count && indices && i < primcount; ++i) {
+        if(indices[i] && count[i] > 0) {
+            vertexCount = std::max(vertexCount, MaxIndex(count[i], type, indices[i]) + 1);
+        }
+    }
+
+    CaptureClientArrays(0, vertexCount);
+}
+
+void
+GLCapture::MakeCurrent(uint32_t width, uint32_t height)
+{
+    GLCaptureRecord record(GLOVE_CAPTURE_MAKE_CURRENT);
+    if(record.IsActive()) {
+        record(width, height);
+    }
+}
+
+void
+GLCapture::SwapBuffers()
+{
+    GLCaptureRecord record(GLOVE_CAPTURE_SWAP_BUFFERS);
+}
+
+GLCaptureRecord::GLCaptureRecord(const char *call)
+: mCall(call), mActive(GLCapture::IsEnabled() && !threadRecording), mArguments(0), mFlags(0), mStart(0), mData(nullptr),
+  mNamesOut(nullptr), mNamesOutCount(0), mNamesOutPosition(0),
+  mReturnKind(CAPTURE_NAME_NONE), mReturnProgram(0), mReturnLocation(false), mMapTarget(GL_NONE), mMapOffset(0), mMapLength(0)
+{
+    if(!mActive) {
+        return;
+    }
+
+    threadRecording = true;
+    mStart = Now();
+    mData  = &threadRecord;
+    mData->assign(sizeof(captureRecordHeader_t), 0);
+}
+
+GLCaptureRecord::~GLCaptureRecord()
+{
+    if(!mActive) {
+        return;
+    }
+
+    if(mNamesOut && mNamesOutCount > 0) {
+        memcpy(mData->data() + mNamesOutPosition, mNamesOut, static_cast<size_t>(mNamesOutCount) * sizeof(GLuint));
+    }
+
+    Align(0);
+    captureRecordHeader_t header = { static_cast<uint32_t>(mData->size()), 0, mArguments, mFlags, mStart };
+    memcpy(mData->data(), &header, sizeof(header));
+
+    GLCapture::Commit(mCall, *mData);
+    threadRecording = false;
+}
+
+void
+GLCaptureRecord::Arg(captureArg_e type, captureNameKind_e kind)
+{
+    mData->push_back(static_cast<uint8_t>(type));
+    mData->push_back(static_cast<uint8_t>(kind));
+}
+
+void
+GLCaptureRecord::Bytes(const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    mData->insert(mData->end(), bytes, bytes + size);
+}
+
+void
+GLCaptureRecord::Align(size_t size)
+{
+    // pads until size more bytes end on the alignment
+    while((mData->size() + size) % GLOVE_CAPTURE_ALIGNMENT) {
+        mData->push_back(0);
+    }
+}
+
+void
+GLCaptureRecord::Blob(const void *data, size_t size)
+{
+    Arg(CAPTURE_ARG_BLOB);
+    Align(sizeof(uint32_t));
+    Write(static_cast<uint32_t>(size));
+    Bytes(data, size);
+}
+
+void
+GLCaptureRecord::Pointer(const void *pointer, size_t size)
+{
+    if(pointer == nullptr) {
+        Arg(CAPTURE_ARG_NULL);
+    } else {
+        Blob(pointer, size);
+    }
+}
+
+void
+GLCaptureRecord::Add(const captureLocation_t &arg)
+{
+    Arg(CAPTURE_ARG_LOCATION);
+    Write(static_cast<uint32_t>(arg.current ? GLCapture::GetCurrentProgram() : arg.program));
+    Write(static_cast<int32_t>(arg.location));
+}
+
+void
+GLCaptureRecord::Add(const captureOffset_t &arg)
+{
+    Arg(CAPTURE_ARG_OFFSET);
+    Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(arg.offset)));
+}
+
+void
+GLCaptureRecord::Add(const captureIndices_t &arg)
+{
+    if(!GLCapture::UsesClientIndices()) {
+        Add(CaptureOffset(arg.indices));
+    } else {
+        Pointer(arg.indices, arg.count > 0 ? static_cast<size_t>(arg.count) * IndexTypeSize(arg.type) : 0);
+    }
+}
+
+void
+GLCaptureRecord::Add(const captureOut_t &arg)
+{
+    if(arg.data == nullptr) {
+        Arg(CAPTURE_ARG_NULL);
+        return;
+    }
+
+    Arg(CAPTURE_ARG_OUT);
+    Write(static_cast<uint32_t>(arg.size));
+}
+
+void
+GLCaptureRecord::Add(const captureNames_t &arg)
+{
+    if(arg.names == nullptr) {
+        Arg(CAPTURE_ARG_NULL);
+        return;
+    }
+
+    const GLsizei count = std::max(arg.count, 0);
+    Arg(arg.out ? CAPTURE_ARG_NAMES_OUT : CAPTURE_ARG_NAMES, arg.kind);
+    Write(static_cast<uint32_t>(count));
+
+    if(arg.out) {
+        mNamesOut         = arg.names;
+        mNamesOutCount    = count;
+        mNamesOutPosition = mData->size();
+        mData->resize(mData->size() + static_cast<size_t>(count) * sizeof(GLuint), 0);
+    } else {
+        Bytes(arg.names, static_cast<size_t>(count) * sizeof(GLuint));
+    }
+}
+
+void
+GLCaptureRecord::Add(const captureStrings_t &arg)
+{
+    if(arg.strings == nullptr) {
+        Arg(CAPTURE_ARG_NULL);
+        return;
+    }
+
+    const GLsizei count = std::max(arg.count, 0);
+    Arg(CAPTURE_ARG_STRINGS);
+    Write(static_cast<uint32_t>(count));
+
+    for(GLsizei i = 0; i < count; ++i) {
+        const char *string = arg.strings[i] ? arg.strings[i] : "";
+        const size_t length = (arg.lengths && arg.lengths[i] >= 0) ? static_cast<size_t>(arg.lengths[i]) : strlen(string);
+
+        // the replayer hands the strings over with no lengths
+        Arg(CAPTURE_ARG_BLOB);
+        Align(sizeof(uint32_t));
+        Write(static_cast<uint32_t>(length + 1));
+        Bytes(string, length);
+        Write(static_cast<uint8_t>(0));
+    }
+}
+
+void
+GLCaptureRecord::Add(const captureIndexPointers_t &arg)
+{
+    if(arg.indices == nullptr) {
+        Arg(CAPTURE_ARG_NULL);
+        return;
+    }
+
+    const GLsizei count   = std::max(arg.count, 0);
+    const bool    offsets = !GLCapture::UsesClientIndices();
+    Arg(CAPTURE_ARG_POINTERS);
+    Write(static_cast<uint32_t>(count));
+
+    for(GLsizei i = 0; i < count; ++i) {
+        if(offsets) {
+            Add(CaptureOffset(arg.indices[i]));
+        } else {
+            Pointer(arg.indices[i], arg.counts && arg.counts[i] > 0 ? static_cast<size_t>(arg.counts[i]) * IndexTypeSize(arg.type) : 0);
+        }
+    }
+}
+
+void
+GLCaptureRecord::AddReturn(GLuint value)
+{
+    if(mReturnKind != CAPTURE_NAME_NONE) {
+        Add(CaptureName(value, mReturnKind));
+    } else {
+        Add(value);
+    }
+}
+
+void
+GLCaptureRecord::AddReturn(GLint value)
+{
+    if(mReturnLocation) {
+        Arg(CAPTURE_ARG_LOCATION);
+        Write(static_cast<uint32_t>(mReturnProgram));
+        Write(static_cast<int32_t>(value));
+    } else {
+        Add(value);
+    }
+}
+
+void
+GLCaptureRecord::AddReturn(const void *value)
+{
+    if(mMapTarget != GL_NONE) {
+        GLCapture::MapBuffer(mMapTarget, value, mMapOffset, mMapLength);
+    }
+
+    Add(CaptureOffset(value));
+}
+
+GLCaptureMappedBuffer::~GLCaptureMappedBuffer()
+{
+    if(!mMapped) {
+        return;
+    }
+
+    GLCaptureRecord record("glBufferSubData");
+    if(record.IsActive()) {
+        record(mTarget, mOffset, static_cast<GLsizeiptr>(mData.size()), CaptureBlob(mData.data(), mData.size()));
+    }
+}
@@ -0,0 +1,240 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glCapture.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Capture of the GL call stream, along with the client memory it reads, into a binary file
+ *
+ */
+
+#ifndef __GLCAPTURE_H__
+#define __GLCAPTURE_H__
+
+#include "glCaptureFormat.h"
+#include "GLES2/gl2.h"
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/// Environment variable holding the file the calls are captured to, nothing is captured when unset
+#define GLOVE_CAPTURE_ENV                               "GLOVE_CAPTURE"
+
+/// Client memory written by the calls of the process, buffered before it reaches the file
+#define GLOVE_CAPTURE_FILE_BUFFER                       (4 << 20)
+
+/// Captures the call of the enclosing entry point with the arguments given, which it records once the call returns
+#define GL_CAPTURE(...)                                 GLCaptureRecord glCapture(__func__);                    \
+                                                        if(glCapture.IsActive()) { glCapture(__VA_ARGS__); }
+
+/// Keeps the client state the capture needs to know which memory a draw reads
+#define CAPTURE_STATE(func)                             if(GLCapture::IsEnabled()) { GLCapture::func; }
+
+typedef struct captureName_t {
+    GLuint                          name;
+    captureNameKind_e               kind;
+} captureName_t;
+
+typedef struct captureLocation_t {
+    GLint                           location;
+    /// of the current program unless given
+    GLuint                          program;
+    bool                            current;
+} captureLocation_t;
+
+typedef struct captureBlob_t {
+    const void                     *data;
+    size_t                          size;
+} captureBlob_t;
+
+typedef struct captureOffset_t {
+    const void                     *offset;
+} captureOffset_t;
+
+typedef struct captureOut_t {
+    const void                     *data;
+    size_t                          size;
+} captureOut_t;
+
+typedef struct captureIndices_t {
+    const void                     *indices;
+    GLsizei                         count;
+    GLenum                          type;
+} captureIndices_t;
+
+typedef struct captureNames_t {
+    const GLuint                   *names;
+    GLsizei                         count;
+    captureNameKind_e               kind;
+    bool                            out;
+} captureNames_t;
+
+typedef struct captureStrings_t {
+    const GLchar * const           *strings;
+    const GLint                    *lengths;
+    GLsizei                         count;
+} captureStrings_t;
+
+typedef struct captureIndexPointers_t {
+    const void * const             *indices;
+    const GLsizei                  *counts;
+    GLenum                          type;
+    GLsizei                         count;
+} captureIndexPointers_t;
+
+inline captureName_t     CaptureName(GLuint name, captureNameKind_e kind)                   { captureName_t arg = { name, kind }; return arg; }
+inline captureLocation_t CaptureLocation(GLint location)                                    { captureLocation_t arg = { location, 0, true }; return arg; }
+inline captureLocation_t CaptureLocation(GLint location, GLuint program)                    { captureLocation_t arg = { location, program, false }; return arg; }
+inline captureBlob_t     CaptureBlob(const void *data, size_t size)                         { captureBlob_t arg = { data, size }; return arg; }
+inline captureBlob_t     CaptureString(const char *string)                                  { captureBlob_t arg = { string, string ? strlen(string) + 1 : 0 }; return arg; }
+inline captureOffset_t   CaptureOffset(const void *offset)                                  { captureOffset_t arg = { offset }; return arg; }
+inline captureOut_t      CaptureOut(const void *data, size_t size)                          { captureOut_t arg = { data, size }; return arg; }
+inline captureIndices_t  CaptureIndices(const void *indices, GLsizei count, GLenum type)  { captureIndices_t arg = { indices, count, type }; return arg; }
+inline captureNames_t    CaptureNames(const GLuint *names, GLsizei count, captureNameKind_e kind)    { captureNames_t arg = { names, count, kind, false }; return arg; }
+inline captureNames_t    CaptureNamesOut(const GLuint *names, GLsizei count, captureNameKind_e kind) { captureNames_t arg = { names, count, kind, true }; return arg; }
+inline captureStrings_t  CaptureStrings(const GLchar * const *strings, const GLint *lengths, GLsizei count) { captureStrings_t arg = { strings, lengths, count }; return arg; }
+inline captureIndexPointers_t CaptureIndexPointers(const void * const *indices, const GLsizei *counts, GLenum type, GLsizei count) { captureIndexPointers_t arg = { indices, counts, type, count }; return arg; }
+
+class GLCapture {
+    friend class GLCaptureRecord;
+    friend class GLCaptureMappedBuffer;
+
+private:
+    /// -1 until the environment has been read, then whether the calls are captured
+    static std::atomic<int> mEnabled;
+
+    static bool           Initialize();
+    static void           Commit(const char *call, std::vector<uint8_t> &record);
+    static void           CaptureClientArrays(GLuint firstVertex, GLuint vertexCount);
+    static void           MapBuffer(GLenum target, const void *pointer, GLintptr offset, GLsizeiptr length);
+    static bool           UnmapBuffer(GLenum target, GLintptr *offset, std::vector<uint8_t> &data);
+
+public:
+    static inline bool    IsEnabled()                   { int enabled = mEnabled.load(std::memory_order_relaxed); return enabled < 0 ? Initialize() : enabled != 0; }
+    static void           Shutdown();
+
+    /// the client state the captured draws depend on
+    static void           BindBuffer(GLenum target, GLuint buffer);
+    static void           BufferData(GLenum target, GLsizeiptr size);
+    static void           DeleteBuffers(GLsizei n, const GLuint *buffers);
+    static void           BindVertexArray(GLuint array);
+    static void           DeleteVertexArrays(GLsizei n, const GLuint *arrays);
+    static void           UseProgram(GLuint program);
+    static void           SetVertexAttribArrayEnabled(GLuint index, bool enabled);
+    static void           VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *ptr);
+    static void           PixelStorei(GLenum pname, GLint param);
+
+    static GLuint         GetCurrentProgram();
+    static bool           UsesClientIndices();
+    /// bytes of client memory an image of the pixel transfer reads, or writes when packed
+    static size_t         ImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, bool pack);
+
+    /// record the client arrays a draw reads ahead of it, when the draw reads any
+    static void           ClientArrays(GLint first, GLsizei count);
+    static void           ClientArrays(GLsizei count, GLenum type, const void *indices);
+    static void           ClientArrays(const GLint *first, const GLsizei *count, GLsizei primcount);
+    static void           ClientArrays(const GLsizei *count, GLenum type, const void *const *indices, GLsizei primcount);
+
+    static void           MakeCurrent(uint32_t width, uint32_t height);
+    static void           SwapBuffers();
+};
+
+class GLCaptureRecord {
+private:
+    const char           *mCall;
+    bool                  mActive;
+    uint8_t               mArguments;
+    uint8_t               mFlags;
+    uint64_t              mStart;
+    std::vector<uint8_t> *mData;
+
+    /// names a call writes are only known once it returns
+    const GLuint         *mNamesOut;
+    GLsizei               mNamesOutCount;
+    size_t                mNamesOutPosition;
+
+    captureNameKind_e     mReturnKind;
+    GLuint                mReturnProgram;
+    bool                  mReturnLocation;
+    GLenum                mMapTarget;
+    GLintptr              mMapOffset;
+    GLsizeiptr            mMapLength;
+
+    void                  Arg(captureArg_e type, captureNameKind_e kind = CAPTURE_NAME_NONE);
+    void                  Bytes(const void *data, size_t size);
+    template<typename T>
+    void                  Write(T value)                { Bytes(&value, sizeof(T)); }
+    void                  Align(size_t size);
+    void                  Blob(const void *data, size_t size);
+    void                  Pointer(const void *pointer, size_t size);
+
+    void                  Add(GLfloat value)            { uint32_t bits; memcpy(&bits, &value, sizeof(bits)); Arg(CAPTURE_ARG_VALUE32); Write(bits); }
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+                          Add(T value)                  { if(sizeof(T) > 4) { Arg(CAPTURE_ARG_VALUE64); Write(static_cast<uint64_t>(value)); }
+                                                          else              { Arg(CAPTURE_ARG_VALUE32); Write(static_cast<uint32_t>(value)); } }
+    void                  Add(const captureName_t &arg)  { Arg(CAPTURE_ARG_NAME, arg.kind); Write(static_cast<uint32_t>(arg.name)); }
+    void                  Add(const captureLocation_t &arg);
+    void                  Add(const captureBlob_t &arg)  { Pointer(arg.data, arg.size); }
+    void                  Add(const captureOffset_t &arg);
+    void                  Add(const captureIndices_t &arg);
+    void                  Add(const captureOut_t &arg);
+    void                  Add(const captureNames_t &arg);
+    void                  Add(const captureStrings_t &arg);
+    void                  Add(const captureIndexPointers_t &arg);
+
+    void                  AddReturn(GLuint value);
+    void                  AddReturn(GLint value);
+    void                  AddReturn(GLboolean value)    { Add(value); }
+    void                  AddReturn(const void *value);
+
+public:
+    GLCaptureRecord(const char *call);
+    ~GLCaptureRecord();
+
+    inline bool           IsActive()              const { return mActive; }
+
+    void                  operator()()                  { }
+    template<typename T, typename... Rest>
+    void                  operator()(T arg, Rest... rest) { Add(arg); ++mArguments; (*this)(rest...); }
+
+    /// what the call returns is the name of an object of kind, or a uniform location of program
+    void                  ReturnsName(captureNameKind_e kind) { mReturnKind = kind; }
+    void                  ReturnsLocation(GLuint program)     { mReturnLocation = true; mReturnProgram = program; }
+    /// what the call returns maps length bytes of the buffer bound to target from offset, the whole of it when length is 0
+    void                  MapsBuffer(GLenum target, GLintptr offset, GLsizeiptr length) { mMapTarget = target; mMapOffset = offset; mMapLength = length; }
+
+    template<typename T>
+    T                     Return(T value)               { if(mActive) { AddReturn(value); ++mArguments; mFlags |= GLOVE_CAPTURE_FLAG_RETURN; } return value; }
+};
+
+/// Records what the client wrote to the buffer mapped at target as a glBufferSubData, once the unmap the scope makes has been recorded
+class GLCaptureMappedBuffer {
+private:
+    GLenum                mTarget;
+    GLintptr              mOffset;
+    std::vector<uint8_t>  mData;
+    bool                  mMapped;
+
+public:
+    GLCaptureMappedBuffer(GLenum target)
+    : mTarget(target), mOffset(0), mMapped(GLCapture::IsEnabled() && GLCapture::UnmapBuffer(target, &mOffset, mData)) { }
+
+    ~GLCaptureMappedBuffer();
+};
+
+#endif //__GLCAPTURE_H__
@@ -0,0 +1,108 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glCaptureFormat.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Layout of the GL call captures, shared by GLOVE and the replayer
+ *
+ *  @section
+ *
+ *  A capture starts with GLOVE_CAPTURE_MAGIC and a uint32 version padded to
+ *  GLOVE_CAPTURE_ALIGNMENT, followed by records in the byte order of the
+ *  capturing machine. A record is a captureRecordHeader_t followed by its
+ *  arguments, and is itself padded to GLOVE_CAPTURE_ALIGNMENT, so that the
+ *  client memory it carries can be handed to GL straight from the file.
+ *
+ *  Each argument is a uint8 captureArg_e followed by a uint8
+ *  captureNameKind_e and then:
+ *    VALUE32    4 bytes, an integer, an enum or the bits of a float
+ *    VALUE64    8 bytes, a GLintptr or a GLsizeiptr
+ *    NAME       a uint32 name of an object of the kind
+ *    LOCATION   a uint32 program name and the int32 uniform location in it
+ *    NULL       nothing, a null pointer
+ *    OFFSET     a uint64, a pointer that is an offset into a buffer object
+ *    BLOB       a uint32 size, aligned so that the bytes that follow are too
+ *    OUT        a uint32 size, 0 if unknown, of client memory written by the call
+ *    NAMES      a uint32 count and that many names of the kind, read by the call
+ *    NAMES_OUT  a uint32 count and that many names of the kind, written by the call
+ *    STRINGS    a uint32 count and that many BLOB arguments, each NUL terminated
+ *    POINTERS   a uint32 count and that many NULL, OFFSET or BLOB arguments
+ *
+ *  The first time a call is captured, a record flagged DEFINE whose only
+ *  argument is the BLOB of its NUL terminated name gives the name of its id.
+ *  A call that returns a value has it as its last argument.
+ *
+ */
+
+#ifndef __GLCAPTUREFORMAT_H__
+#define __GLCAPTUREFORMAT_H__
+
+#include <stdint.h>
+
+#define GLOVE_CAPTURE_MAGIC                             "GLOVECAP"
+#define GLOVE_CAPTURE_MAGIC_SIZE                        8
+#define GLOVE_CAPTURE_VERSION                           1
+#define GLOVE_CAPTURE_ALIGNMENT                         8
+#define GLOVE_CAPTURE_HEADER_SIZE                       16
+
+/// Pseudo calls that tell the replayer about the surface, made when a context becomes current and on every swap
+#define GLOVE_CAPTURE_MAKE_CURRENT                      "eglMakeCurrent"
+#define GLOVE_CAPTURE_SWAP_BUFFERS                      "eglSwapBuffers"
+
+#define GLOVE_CAPTURE_FLAG_DEFINE                       0x1
+#define GLOVE_CAPTURE_FLAG_RETURN                       0x2
+
+typedef struct captureRecordHeader_t {
+    /// of the whole record, header and padding included
+    uint32_t                        size;
+    uint16_t                        call;
+    uint8_t                         arguments;
+    uint8_t                         flags;
+    /// since the capture started
+    uint64_t                        nanoseconds;
+} captureRecordHeader_t;
+
+typedef enum {
+    CAPTURE_ARG_VALUE32        = 0,
+    CAPTURE_ARG_VALUE64,
+    CAPTURE_ARG_NAME,
+    CAPTURE_ARG_LOCATION,
+    CAPTURE_ARG_NULL,
+    CAPTURE_ARG_OFFSET,
+    CAPTURE_ARG_BLOB,
+    CAPTURE_ARG_OUT,
+    CAPTURE_ARG_NAMES,
+    CAPTURE_ARG_NAMES_OUT,
+    CAPTURE_ARG_STRINGS,
+    CAPTURE_ARG_POINTERS
+} captureArg_e;
+
+typedef enum {
+    CAPTURE_NAME_NONE          = 0,
+    CAPTURE_NAME_BUFFER,
+    CAPTURE_NAME_TEXTURE,
+    CAPTURE_NAME_FRAMEBUFFER,
+    CAPTURE_NAME_RENDERBUFFER,
+    CAPTURE_NAME_PROGRAM,
+    CAPTURE_NAME_SHADER,
+    CAPTURE_NAME_QUERY,
+    CAPTURE_NAME_VERTEX_ARRAY,
+    CAPTURE_NAME_COMMAND_BUNDLE,
+    CAPTURE_NAME_COUNT
+} captureNameKind_e;
+
+#endif //__GLCAPTUREFORMAT_H__
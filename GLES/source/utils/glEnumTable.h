@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glEnumTable.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Lookup tables indexed by GL enums, checked at compile time
+ *
+ *  @section
+ *
+ *  A table lists entries that start with the GL enum they stand for. A dense
+ *  table lists consecutive enums, so that an enum is looked up by its offset
+ *  from the first one. A sorted table lists enums that are too sparse for it
+ *  in ascending order, so that an enum is looked up by a binary search. Both
+ *  orders are checked by static_assert where the tables are defined.
+ *
+ */
+
+#ifndef __GLENUMTABLE_H__
+#define __GLENUMTABLE_H__
+
+#include "GLES2/gl2.h"
+#include <cstddef>
+
+template<typename T>
+struct GlEnumEntry_t {
+    GLenum                          gl;
+    T                               value;
+};
+
+/// whether the entries from index on stand for the consecutive enums from base + index on
+template<typename ENTRY, size_t N>
+constexpr bool
+GlEnumTableIsDense(const ENTRY (&table)[N], GLenum base, size_t index = 0)
+{
+    return index == N || (table[index].gl == base + index && GlEnumTableIsDense(table, base, index + 1));
+}
+
+/// whether the entries from index on stand for enums in ascending order
+template<typename ENTRY, size_t N>
+constexpr bool
+GlEnumTableIsSorted(const ENTRY (&table)[N], size_t index = 1)
+{
+    return index >= N || (table[index - 1].gl < table[index].gl && GlEnumTableIsSorted(table, index + 1));
+}
+
+/// the entry of a dense table of the enums from its first on, nullptr if value is not one of them
+template<typename ENTRY, size_t N>
+inline const ENTRY *
+GlEnumTableFind(const ENTRY (&table)[N], GLenum value)
+{
+    GLenum offset = value - table[0].gl;
+    return offset < N ? &table[offset] : nullptr;
+}
+
+/// the entry of a sorted table, nullptr if value is not one of its enums
+template<typename ENTRY, size_t N>
+inline const ENTRY *
+GlEnumTableSearch(const ENTRY (&table)[N], GLenum value)
+{
+    size_t first = 0;
+    size_t last  = N;
+    while(first < last) {
+        size_t middle = (first + last) / 2;
+        if(table[middle].gl < value) {
+            first = middle + 1;
+        } else {
+            last  = middle;
+        }
+    }
+    return first < N && table[first].gl == value ? &table[first] : nullptr;
+}
+
+#endif // __GLENUMTABLE_H__
@@ -22,7 +22,9 @@
  *  @section
  *
  *  glLogger is an easy-to-use monitor interface that can be used for
- *  developing, debugging and running OpenGL ES applications.
+ *  developing, debugging and running OpenGL ES applications. The function
+ *  entries of trace builds are not logged through it but recorded by
+ *  GLTrace, which writes them out of the calling threads.
  *
  */
 
@@ -86,36 +88,12 @@ GLLogger::DestroyInstance()
     }
 }
 
-int
-GLLogger::CalculateSpacesBefore(glLogLevel_e level)
-{
-    return ( 8 - (int)level*4 );
-}
-
-int
-GLLogger::CalculateSpacesAfter(const char *func, glLogLevel_e level)
-{
-    return  funcWidth - (int)strlen(func)  - 8 + (int)level*4;
-}
-
-void
-GLLogger::WriteFunEntry(glLogLevel_e level, const char* filename, const char *func, int line)
-{
-    char log[200];
-    snprintf(log, 200, "%*s%s()%*s  [ %s: %d  Context: c1 ]", CalculateSpacesBefore(level), "", func, CalculateSpacesAfter(func, level), "", filename, line);
-    mLoggerImpl->WriteLog(level, log);
-}
-
-void
-GLLogger::FunEntry(glLogLevel_e level, const char* filename, const char *func, int line)
-{
-    GLLogger *glLogger = GLLogger::GetInstance();
-    glLogger->WriteFunEntry(level, filename, func, line);
-}
-
 void
 GLLogger::Log(glLogLevel_e level, const char *format, ... )
 {
+    // the function entries never set up the logger, the first message does
+    GLLogger::GetInstance();
+
     char log[200];
     va_list args;
     va_start(args, format);
@@ -127,5 +105,8 @@ GLLogger::Log(glLogLevel_e level, const char *format, ... )
 void
 GLLogger::Shutdown()
 {
+    GLTrace::Shutdown();
+    ChromeTrace::Shutdown();
+    StallDetector::Report();
     GLLogger::DestroyInstance();
 }
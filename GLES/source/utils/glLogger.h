@@ -25,6 +25,9 @@
 #define __GLLOGGER_H__
 
 #include "glLoggerImpl.h"
+#include "glTrace.h"
+#include "chromeTrace.h"
+#include "stallDetector.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -56,7 +59,10 @@ extern "C" {
 #   define STR(x)                                       STR_HELPER(x)
 #   define PROJECT_LENGTH                               strlen(STR(PROJECT_PATH)) -1
 #   define GL_SOURCE_FILE_NAME                          &__FILE__[ PROJECT_LENGTH ]
-#   define FUN_ENTRY(__lvl__)                           GLLogger::FunEntry(__lvl__, GL_SOURCE_FILE_NAME, __func__, __LINE__)
+// a call site registers on its first entry and only records its id from then on, the levels below GLOVE_TRACE_LEVEL are compiled out
+#   define FUN_ENTRY(__lvl__)                           do { if((__lvl__) >= GLOVE_TRACE_LEVEL) {                                                                     \
+                                                            static const uint32_t gloveTraceSite = GLTrace::RegisterSite(__lvl__, GL_SOURCE_FILE_NAME, __func__, __LINE__); \
+                                                            GLTrace::Record(gloveTraceSite); } } while(0)
 #   define GLOVE_PRINT(__lvl__, ...)                    GLLogger::Log(__lvl__, __VA_ARGS__)
 #   define GLOVE_PRINT_ERR(...)                         fprintf(stderr, __VA_ARGS__);
 #else
@@ -67,7 +73,6 @@ extern "C" {
 
 class GLLogger {
 private:
-    static const int      funcWidth = 55;
     static GLLogger      *mInstance;
     static GLLoggerImpl  *mLoggerImpl;
 
@@ -79,13 +84,8 @@ private:
     static GLLogger      *GetInstance();
     static void           DestroyInstance();
 
-    int                   CalculateSpacesBefore(glLogLevel_e level);
-    int                   CalculateSpacesAfter(const char *func, glLogLevel_e level);
-    void                  WriteFunEntry(glLogLevel_e level, const char* filename, const char *func, int line);
-
 public:
     static void           Shutdown();
-    static void           FunEntry(glLogLevel_e level, const char* filename, const char *func, int line);
     static void           Log(glLogLevel_e level, const char *format, ...);
 
 };
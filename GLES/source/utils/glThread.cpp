@@ -0,0 +1,258 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glThread.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Single producer, single consumer ring of GL calls executed by a worker thread
+ *
+ *  @section
+ *
+ *  The thread calling into GL writes every command, with a copy of the client
+ *  memory it refers to, into a ring that a single worker thread executes in
+ *  order. The offsets of the ring are the only state the two threads share, so
+ *  enqueueing takes no lock; the worker only sleeps on a condition once the
+ *  ring runs empty. Calls that return values or read client memory later wait
+ *  for the ring to drain and run on the calling thread.
+ *
+ */
+
+#include "glThread.h"
+#include "utils/glLogger.h"
+
+GLThread::GLThread(const std::function<void(void)> &threadInit)
+: mRing(nullptr), mCapacity(GLOVE_THREADED_DISPATCH_RING_SIZE), mWriteOffset(0), mReadOffset(0),
+  mWorkerSleeping(false), mStopping(false),
+  mArrayBufferBinding(0), mElementArrayBufferBinding(0), mEnabledAttribMask(0), mClientAttribMask(0),
+  mVertexArrayBinding(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mVertexArrays[0] = VertexArrayState_t { 0, 0, 0 };
+
+    mRing   = new uint8_t[mCapacity];
+    mWorker = std::thread(&GLThread::WorkerLoop, this, threadInit);
+}
+
+GLThread::~GLThread()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Sync();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkCondition.notify_one();
+    mWorker.join();
+
+    delete[] mRing;
+}
+
+uint8_t *
+GLThread::Reserve(size_t size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    size_t writeOffset = mWriteOffset.load(std::memory_order_relaxed);
+    size_t ringOffset  = writeOffset % mCapacity;
+
+    // commands are contiguous, so the rest of the ring is skipped when the command does not fit
+    if(ringOffset + size > mCapacity) {
+        const size_t padding = mCapacity - ringOffset;
+        while(writeOffset + padding - mReadOffset.load(std::memory_order_acquire) > mCapacity) {
+            std::this_thread::yield();
+        }
+
+        CommandHeader_t *header = reinterpret_cast<CommandHeader_t *>(mRing + ringOffset);
+        header->execute     = nullptr;
+        header->size        = padding;
+        header->payloadSize = 0;
+        Publish(padding);
+
+        writeOffset += padding;
+        ringOffset   = 0;
+    }
+
+    while(writeOffset + size - mReadOffset.load(std::memory_order_acquire) > mCapacity) {
+        std::this_thread::yield();
+    }
+
+    return mRing + ringOffset;
+}
+
+void
+GLThread::Publish(size_t size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mWriteOffset.store(mWriteOffset.load(std::memory_order_relaxed) + size, std::memory_order_seq_cst);
+
+    // the worker announces itself before its last look at the ring, so no wake up is lost
+    if(mWorkerSleeping.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWorkCondition.notify_one();
+    }
+}
+
+void
+GLThread::Sync(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const size_t writeOffset = mWriteOffset.load(std::memory_order_relaxed);
+    while(mReadOffset.load(std::memory_order_acquire) != writeOffset) {
+        std::this_thread::yield();
+    }
+}
+
+void
+GLThread::WorkerLoop(const std::function<void(void)> &threadInit)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    threadInit();
+
+    size_t readOffset = 0;
+    while(true) {
+        if(mWriteOffset.load(std::memory_order_acquire) == readOffset) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkerSleeping.store(true, std::memory_order_seq_cst);
+            mWorkCondition.wait(lock, [this, readOffset] { return mStopping || mWriteOffset.load(std::memory_order_seq_cst) != readOffset; });
+            mWorkerSleeping.store(false, std::memory_order_relaxed);
+
+            if(mWriteOffset.load(std::memory_order_acquire) == readOffset) {
+                return;
+            }
+        }
+
+        CommandHeader_t *header = reinterpret_cast<CommandHeader_t *>(mRing + readOffset % mCapacity);
+        const size_t size = header->size;
+        if(header->execute != nullptr) {
+            header->execute(reinterpret_cast<uint8_t *>(header) + Align(sizeof(CommandHeader_t)), header->payloadSize);
+        }
+
+        // the space is only handed back once the command has run, which is what Sync() waits for
+        readOffset += size;
+        mReadOffset.store(readOffset, std::memory_order_release);
+    }
+}
+
+void
+GLThread::BindBuffer(GLenum target, GLuint buffer)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(target == GL_ARRAY_BUFFER) {
+        mArrayBufferBinding = buffer;
+    } else if(target == GL_ELEMENT_ARRAY_BUFFER) {
+        mElementArrayBufferBinding = buffer;
+    }
+}
+
+void
+GLThread::DeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(GLsizei i = 0; i < n; ++i) {
+        if(buffers[i] == mArrayBufferBinding) {
+            mArrayBufferBinding = 0;
+        }
+        if(buffers[i] == mElementArrayBufferBinding) {
+            mElementArrayBufferBinding = 0;
+        }
+    }
+}
+
+void
+GLThread::SetVertexAttribArrayEnabled(GLuint index, bool enabled)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(index >= GLOVE_MAX_VERTEX_ATTRIBS) {
+        return;
+    }
+
+    if(enabled) {
+        mEnabledAttribMask |= 1u << index;
+    } else {
+        mEnabledAttribMask &= ~(1u << index);
+    }
+}
+
+void
+GLThread::SetVertexAttribPointer(GLuint index)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(index >= GLOVE_MAX_VERTEX_ATTRIBS) {
+        return;
+    }
+
+    // without a bound array buffer the pointer refers to client memory that is read at draw time
+    if(mArrayBufferBinding == 0) {
+        mClientAttribMask |= 1u << index;
+    } else {
+        mClientAttribMask &= ~(1u << index);
+    }
+}
+
+void
+GLThread::GenVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(GLsizei i = 0; arrays && i < n; ++i) {
+        mVertexArrays[arrays[i]] = VertexArrayState_t { 0, 0, 0 };
+    }
+}
+
+void
+GLThread::DeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(GLsizei i = 0; arrays && i < n; ++i) {
+        if(arrays[i] == 0) {
+            continue;
+        }
+        if(arrays[i] == mVertexArrayBinding) {
+            BindVertexArray(0);
+        }
+        mVertexArrays.erase(arrays[i]);
+    }
+}
+
+void
+GLThread::BindVertexArray(GLuint array)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // a name never generated is an error that leaves the binding as it is
+    if(array == mVertexArrayBinding || mVertexArrays.find(array) == mVertexArrays.end()) {
+        return;
+    }
+
+    mVertexArrays[mVertexArrayBinding] = VertexArrayState_t { mElementArrayBufferBinding, mEnabledAttribMask, mClientAttribMask };
+
+    const VertexArrayState_t &state = mVertexArrays[array];
+    mElementArrayBufferBinding = state.elementArrayBufferBinding;
+    mEnabledAttribMask         = state.enabledAttribMask;
+    mClientAttribMask          = state.clientAttribMask;
+    mVertexArrayBinding        = array;
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glThread.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Single producer, single consumer ring of GL calls executed by a worker thread
+ *
+ */
+
+#ifndef __GLTHREAD_H__
+#define __GLTHREAD_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "GLES2/gl2.h"
+#include "utils/globals.h"
+
+class GLThread final {
+private:
+    typedef void (*execute_t)(void *command, size_t payloadSize);
+
+    /// precedes every command in the ring; a header without a function pads the ring up to its end
+    typedef struct CommandHeader_t {
+        execute_t                                       execute;
+        size_t                                          size;
+        size_t                                          payloadSize;
+    } CommandHeader_t;
+
+    static const size_t                                 ALIGNMENT = alignof(std::max_align_t);
+
+    uint8_t                                            *mRing;
+    const size_t                                        mCapacity;
+    std::atomic<size_t>                                 mWriteOffset;
+    std::atomic<size_t>                                 mReadOffset;
+
+    std::thread                                         mWorker;
+    std::mutex                                          mMutex;
+    std::condition_variable                             mWorkCondition;
+    std::atomic<bool>                                   mWorkerSleeping;
+    std::atomic<bool>                                   mStopping;
+
+/// Client state mirrored on the calling thread, to tell which calls read client memory at execution
+    GLuint                                              mArrayBufferBinding;
+    GLuint                                              mElementArrayBufferBinding;
+    uint32_t                                            mEnabledAttribMask;
+    uint32_t                                            mClientAttribMask;
+
+    /// the three above are state of the vertex array bound, the ones of the others are kept aside
+    typedef struct VertexArrayState_t {
+        GLuint                                          elementArrayBufferBinding;
+        uint32_t                                        enabledAttribMask;
+        uint32_t                                        clientAttribMask;
+    } VertexArrayState_t;
+
+    GLuint                                              mVertexArrayBinding;
+    std::unordered_map<GLuint, VertexArrayState_t>      mVertexArrays;
+
+    static inline size_t                                Align(size_t size)                  { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    /// commands without client memory get a null payload
+    template<typename C>
+    static void                                         Execute(void *command, size_t payloadSize)
+                                                        {
+                                                            C *cmd = static_cast<C *>(command);
+                                                            (*cmd)(payloadSize ? static_cast<const void *>(static_cast<uint8_t *>(command) + Align(sizeof(C))) : nullptr);
+                                                            cmd->~C();
+                                                        }
+
+    uint8_t                                            *Reserve(size_t size);
+    void                                                Publish(size_t size);
+    void                                                WorkerLoop(const std::function<void(void)> &threadInit);
+
+public:
+// Constructor
+    GLThread(const std::function<void(void)> &threadInit);
+
+// Destructor
+    ~GLThread();
+
+// Submit Functions
+    /// Copies size bytes of data after the command, which gets a pointer to the copy when it runs.
+    /// Returns false without enqueueing when the command does not fit, so that the caller runs it itself.
+    template<typename F>
+    bool                                                Enqueue(F &&command, const void *data = nullptr, size_t size = 0)
+                                                        {
+                                                            typedef typename std::decay<F>::type C;
+
+                                                            const size_t commandSize = Align(sizeof(CommandHeader_t)) + Align(sizeof(C)) + Align(size);
+                                                            if(commandSize > mCapacity / 2) {
+                                                                return false;
+                                                            }
+
+                                                            uint8_t *slot = Reserve(commandSize);
+                                                            CommandHeader_t *header = reinterpret_cast<CommandHeader_t *>(slot);
+                                                            header->execute     = &Execute<C>;
+                                                            header->size        = commandSize;
+                                                            header->payloadSize = size;
+
+                                                            uint8_t *cmd = slot + Align(sizeof(CommandHeader_t));
+                                                            new (cmd) C(std::forward<F>(command));
+                                                            if(size && data) {
+                                                                memcpy(cmd + Align(sizeof(C)), data, size);
+                                                            }
+
+                                                            Publish(commandSize);
+                                                            return true;
+                                                        }
+
+    /// Waits until every enqueued command has run, after which the caller may use the context itself
+    void                                                Sync(void);
+
+// Client State Functions
+    void                                                BindBuffer(GLenum target, GLuint buffer);
+    void                                                DeleteBuffers(GLsizei n, const GLuint *buffers);
+    void                                                SetVertexAttribArrayEnabled(GLuint index, bool enabled);
+    void                                                SetVertexAttribPointer(GLuint index);
+    void                                                GenVertexArrays(GLsizei n, const GLuint *arrays);
+    void                                                DeleteVertexArrays(GLsizei n, const GLuint *arrays);
+    void                                                BindVertexArray(GLuint array);
+
+    inline bool                                         UsesClientArrays(void)        const { return (mEnabledAttribMask & mClientAttribMask) != 0; }
+    inline bool                                         UsesClientIndices(void)       const { return mElementArrayBufferBinding == 0; }
+};
+
+#endif // __GLTHREAD_H__
@@ -0,0 +1,289 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glTrace.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      A Lock-free Trace of Function Entries
+ *
+ *  @section
+ *
+ *  Every call site of FUN_ENTRY registers once, the first time it is
+ *  entered, and is known by its id from then on. An entry is the time and
+ *  the id of its call site, stored into a ring owned by the thread entering
+ *  it: the thread only ever writes the head and a single drain thread only
+ *  ever moves the tail, so recording takes no lock and never waits. The
+ *  drain thread formats the entries and writes them to GLOVE_TRACE_FILE
+ *  every GLOVE_TRACE_DRAIN_INTERVAL milliseconds.
+ *
+ */
+
+#include "glLogger.h"
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct traceEntry_t {
+    uint64_t                        timestamp;
+    uint32_t                        site;
+} traceEntry_t;
+
+typedef struct traceSite_t {
+    glLogLevel_e                    level;
+    const char                     *filename;
+    const char                     *func;
+    int                             line;
+} traceSite_t;
+
+typedef struct traceRing_t {
+    traceEntry_t                    entries[GLOVE_TRACE_RING_SIZE];
+    std::atomic<uint64_t>           head;
+    std::atomic<uint64_t>           tail;
+    std::atomic<uint64_t>           dropped;
+    /// the thread has exited, the ring is released once drained
+    std::atomic<bool>               retired;
+    uint32_t                        thread;
+} traceRing_t;
+
+typedef struct traceState_t {
+    std::mutex                      mutex;
+    std::condition_variable         wakeUp;
+    std::vector<traceSite_t>        sites;
+    std::vector<traceRing_t *>      rings;
+    std::thread                     drainer;
+    bool                            started;
+    bool                            running;
+    uint32_t                        nextThread;
+    FILE                           *file;
+    std::chrono::steady_clock::time_point start;
+} traceState_t;
+
+std::atomic<uint32_t> GLTrace::mSubsystemMask(~0u);
+
+/// kept alive until the process exits, so that threads entering functions from static destructors still find it
+static traceState_t *
+GetTraceState(void)
+{
+    static traceState_t *state = new traceState_t();
+    return state;
+}
+
+class TraceRingHolder {
+public:
+    traceRing_t                    *ring;
+
+    TraceRingHolder() : ring(nullptr) { }
+    ~TraceRingHolder()              { if(ring) { ring->retired.store(true, std::memory_order_release); } }
+};
+
+static thread_local TraceRingHolder threadRing;
+
+static const char *subsystemNames[GL_TRACE_SUBSYSTEM_COUNT] = { "api", "context", "state", "resources", "vulkan", "glslang", "utils", "other" };
+
+static glTraceSubsystem_e
+GetSubsystem(const char *filename)
+{
+    // the file names are relative to the project, the directory under the sources is the subsystem
+    for(uint32_t i = 0; i < GL_TRACE_OTHER; ++i) {
+        const std::string directory = std::string(subsystemNames[i]) + "/";
+        if(!strncmp(filename, directory.c_str(), directory.size()) || strstr(filename, ("/" + directory).c_str())) {
+            return static_cast<glTraceSubsystem_e>(i);
+        }
+    }
+
+    return GL_TRACE_OTHER;
+}
+
+static uint32_t
+ParseSubsystemMask(const char *subsystems)
+{
+    if(subsystems == nullptr || !strcmp(subsystems, "all")) {
+        return ~0u;
+    }
+
+    uint32_t mask = 0;
+    std::string list(subsystems);
+    size_t begin = 0;
+    while(begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if(end == std::string::npos) {
+            end = list.size();
+        }
+
+        const std::string name = list.substr(begin, end - begin);
+        for(uint32_t i = 0; i < GL_TRACE_SUBSYSTEM_COUNT; ++i) {
+            if(name == subsystemNames[i]) {
+                mask |= 1u << i;
+            }
+        }
+        begin = end + 1;
+    }
+
+    return mask;
+}
+
+static void
+DrainRings(traceState_t *state)
+{
+    // the sites only grow, so the ones known now cover every entry already pushed
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    for(auto it = state->rings.begin(); it != state->rings.end();) {
+        traceRing_t *ring = *it;
+        bool retired = ring->retired.load(std::memory_order_acquire);
+
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        for(; tail < head; ++tail) {
+            const traceEntry_t &entry = ring->entries[tail & (GLOVE_TRACE_RING_SIZE - 1)];
+            const uint32_t index = entry.site & ((1u << GLOVE_TRACE_SUBSYSTEM_SHIFT) - 1);
+            if(index >= state->sites.size()) {
+                continue;
+            }
+
+            const traceSite_t &site = state->sites[index];
+            fprintf(state->file, "%" PRIu64 " t%u %d %s() [ %s: %d ]\n",
+                    entry.timestamp, ring->thread, static_cast<int>(site.level), site.func, site.filename, site.line);
+        }
+        ring->tail.store(head, std::memory_order_release);
+
+        const uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if(dropped) {
+            fprintf(state->file, "# t%u dropped %" PRIu64 " entries\n", ring->thread, dropped);
+        }
+
+        if(retired && ring->head.load(std::memory_order_acquire) == head) {
+            delete ring;
+            it = state->rings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    fflush(state->file);
+}
+
+static void
+DrainLoop(traceState_t *state)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while(state->running) {
+        state->wakeUp.wait_for(lock, std::chrono::milliseconds(GLOVE_TRACE_DRAIN_INTERVAL));
+
+        lock.unlock();
+        DrainRings(state);
+        lock.lock();
+    }
+}
+
+uint32_t
+GLTrace::RegisterSite(glLogLevel_e level, const char *filename, const char *func, int line)
+{
+    traceState_t *state = GetTraceState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    // the first call site to register starts the trace, which runs once
+    if(!state->started) {
+        state->started = true;
+
+        const char *path = getenv(GLOVE_TRACE_FILE_ENV);
+        state->file = fopen(path ? path : GLOVE_TRACE_FILE_DEFAULT, "w");
+        if(state->file == nullptr) {
+            mSubsystemMask.store(0, std::memory_order_relaxed);
+            return 0;
+        }
+
+        mSubsystemMask.store(ParseSubsystemMask(getenv(GLOVE_TRACE_SUBSYSTEMS_ENV)), std::memory_order_relaxed);
+        state->start      = std::chrono::steady_clock::now();
+        state->nextThread = 0;
+        state->running    = true;
+        state->drainer    = std::thread(DrainLoop, state);
+        atexit(GLTrace::Shutdown);
+    }
+
+    traceSite_t site = { level, filename, func, line };
+    state->sites.push_back(site);
+
+    const uint32_t subsystem = static_cast<uint32_t>(GetSubsystem(filename));
+    return (subsystem << GLOVE_TRACE_SUBSYSTEM_SHIFT) | static_cast<uint32_t>(state->sites.size() - 1);
+}
+
+void
+GLTrace::Push(uint32_t site)
+{
+    traceRing_t *ring = threadRing.ring;
+    if(ring == nullptr) {
+        traceState_t *state = GetTraceState();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if(!state->running) {
+            return;
+        }
+
+        ring = new traceRing_t();
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->tail.store(0, std::memory_order_relaxed);
+        ring->dropped.store(0, std::memory_order_relaxed);
+        ring->retired.store(false, std::memory_order_relaxed);
+        ring->thread = state->nextThread++;
+
+        state->rings.push_back(ring);
+        threadRing.ring = ring;
+    }
+
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if(head - ring->tail.load(std::memory_order_acquire) >= GLOVE_TRACE_RING_SIZE) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    traceEntry_t &entry = ring->entries[head & (GLOVE_TRACE_RING_SIZE - 1)];
+    entry.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - GetTraceState()->start).count());
+    entry.site      = site;
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void
+GLTrace::Shutdown()
+{
+    traceState_t *state = GetTraceState();
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if(!state->running) {
+            return;
+        }
+        state->running = false;
+    }
+
+    state->wakeUp.notify_one();
+    if(state->drainer.joinable()) {
+        state->drainer.join();
+    }
+
+    // whatever was recorded since the last drain
+    mSubsystemMask.store(0, std::memory_order_relaxed);
+    DrainRings(state);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    fclose(state->file);
+    state->file = nullptr;
+}
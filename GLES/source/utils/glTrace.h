@@ -0,0 +1,79 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       glTrace.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      A Lock-free Trace of Function Entries
+ *
+ */
+
+#ifndef __GLTRACE_H__
+#define __GLTRACE_H__
+
+#include <atomic>
+#include <stdint.h>
+#include "glLoggerImpl.h"
+
+/// Lowest level of the function entries traced, the ones below it are compiled out.
+/// the inline getters enter at GL_LOG_TRACE, so they cost nothing by default
+#ifndef GLOVE_TRACE_LEVEL
+#   define GLOVE_TRACE_LEVEL                            GL_LOG_DEBUG
+#endif // GLOVE_TRACE_LEVEL
+
+/// Environment variable holding the file the trace is written to
+#define GLOVE_TRACE_FILE_ENV                            "GLOVE_TRACE_FILE"
+#define GLOVE_TRACE_FILE_DEFAULT                        "glove_trace.log"
+
+/// Environment variable holding the comma separated subsystems traced, all of them when unset
+#define GLOVE_TRACE_SUBSYSTEMS_ENV                      "GLOVE_TRACE_SUBSYSTEMS"
+
+/// Entries buffered per thread, a power of two. the ones recorded while its ring is full are dropped
+#define GLOVE_TRACE_RING_SIZE                           16384
+
+/// Milliseconds between two drains of the rings to the file
+#define GLOVE_TRACE_DRAIN_INTERVAL                      10
+
+/// The subsystem of a call site is kept in the upper bits of its id
+#define GLOVE_TRACE_SUBSYSTEM_SHIFT                     24
+
+typedef enum {
+    GL_TRACE_API        = 0,
+    GL_TRACE_CONTEXT,
+    GL_TRACE_STATE,
+    GL_TRACE_RESOURCES,
+    GL_TRACE_VULKAN,
+    GL_TRACE_GLSLANG,
+    GL_TRACE_UTILS,
+    GL_TRACE_OTHER,
+    GL_TRACE_SUBSYSTEM_COUNT
+} glTraceSubsystem_e;
+
+class GLTrace {
+private:
+    /// subsystems whose call sites are recorded, set once the first call site registers
+    static std::atomic<uint32_t> mSubsystemMask;
+
+    static void           Push(uint32_t site);
+
+public:
+    static uint32_t       RegisterSite(glLogLevel_e level, const char *filename, const char *func, int line);
+    static void           Shutdown();
+
+    static inline void    Record(uint32_t site)         { if(mSubsystemMask.load(std::memory_order_relaxed) & (1u << (site >> GLOVE_TRACE_SUBSYSTEM_SHIFT))) { Push(site); } }
+};
+
+#endif //__GLTRACE_H__
@@ -25,10 +25,20 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include "glUtils.h"
+#include "glEnumTable.h"
 #include "parser_helpers.h"
 #include "glLogger.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define CASE_STR(c)                                     case GL_ ##c: return "GL_" STRINGIFY(c);
 
 GLboolean
@@ -83,12 +93,23 @@ GlFormatToGlInternalFormat(GLenum format, GLenum type)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // compressed data is stored as given
+    if(GlFormatIsCompressed(format)) {
+        return format;
+    }
+
     switch(format) {
     case GL_DEPTH_COMPONENT16:              return GL_DEPTH_COMPONENT16;
     case GL_DEPTH_COMPONENT24_OES:          return GL_DEPTH_COMPONENT24_OES;
     case GL_DEPTH_COMPONENT32_OES:          return GL_DEPTH_COMPONENT32_OES;
     case GL_STENCIL_INDEX8:                 return GL_STENCIL_INDEX8;
     case GL_STENCIL_INDEX4_OES:             return GL_STENCIL_INDEX4_OES;
+    case GL_DEPTH_COMPONENT:
+        switch(type) {
+        case GL_UNSIGNED_SHORT:             return GL_DEPTH_COMPONENT16;
+        case GL_UNSIGNED_INT:               return GL_DEPTH_COMPONENT24_OES;
+        default: NOT_FOUND_ENUM(type);      return GL_INVALID_VALUE;
+        }
     case GL_BGRA_EXT:
     case GL_BGRA8_EXT:
         switch(type) {
@@ -100,6 +121,8 @@ GlFormatToGlInternalFormat(GLenum format, GLenum type)
         case GL_UNSIGNED_SHORT_4_4_4_4:     return GL_RGBA4;
         case GL_UNSIGNED_SHORT_5_5_5_1:     return GL_RGB5_A1;
         case GL_UNSIGNED_BYTE:              return GL_RGBA8_OES;
+        case GL_HALF_FLOAT_OES:             return GL_RGBA16F_EXT;
+        case GL_FLOAT:                      return GL_RGBA32F_EXT;
         default: NOT_FOUND_ENUM(type);      return GL_INVALID_VALUE;
         }
 
@@ -107,27 +130,40 @@ GlFormatToGlInternalFormat(GLenum format, GLenum type)
         switch(type) {
         case GL_UNSIGNED_SHORT_5_6_5:       return GL_RGB565;
         case GL_UNSIGNED_BYTE:              return GL_RGB8_OES;
+        case GL_HALF_FLOAT_OES:             return GL_RGB16F_EXT;
+        case GL_FLOAT:                      return GL_RGB32F_EXT;
         default: NOT_FOUND_ENUM(type);      return GL_INVALID_VALUE;
         }
 
     case GL_LUMINANCE_ALPHA:
         switch(type) {
         case GL_UNSIGNED_BYTE:              return GL_LUMINANCE_ALPHA;
+        case GL_HALF_FLOAT_OES:             return GL_LUMINANCE_ALPHA16F_EXT;
+        case GL_FLOAT:                      return GL_LUMINANCE_ALPHA32F_EXT;
         default: NOT_FOUND_ENUM(type);      return GL_INVALID_VALUE;
         }
 
     case GL_LUMINANCE:
         switch(type) {
         case GL_UNSIGNED_BYTE:              return GL_LUMINANCE;
+        case GL_HALF_FLOAT_OES:             return GL_LUMINANCE16F_EXT;
+        case GL_FLOAT:                      return GL_LUMINANCE32F_EXT;
         default: NOT_FOUND_ENUM(type);      return GL_INVALID_VALUE;
         }
 
     case GL_ALPHA:
         switch(type) {
         case GL_UNSIGNED_BYTE:              return GL_ALPHA;
+        case GL_HALF_FLOAT_OES:             return GL_ALPHA16F_EXT;
+        case GL_FLOAT:                      return GL_ALPHA32F_EXT;
         default: NOT_FOUND_ENUM(type);      return GL_INVALID_VALUE;
         }
 
+    case GL_RGBA16F_EXT:                    return GL_RGBA16F_EXT;
+    case GL_RGB16F_EXT:                     return GL_RGB16F_EXT;
+    case GL_RGBA32F_EXT:                    return GL_RGBA32F_EXT;
+    case GL_RGB32F_EXT:                     return GL_RGB32F_EXT;
+
     case GL_DEPTH24_STENCIL8_OES:
         switch(type) {
         case GL_UNSIGNED_INT_24_8_OES:      return GL_DEPTH24_STENCIL8_OES;
@@ -161,7 +197,21 @@ GlInternalFormatToGlType(GLenum internalformat)
     case GL_BGRA8_EXT :
     case GL_RGBA8_OES :                     return GL_UNSIGNED_BYTE;
     case GL_DEPTH24_STENCIL8_OES:           return GL_UNSIGNED_INT_24_8_OES;
-    default: NOT_FOUND_ENUM(internalformat);return GL_INVALID_VALUE;
+    case GL_RGBA16F_EXT:
+    case GL_RGB16F_EXT:
+    case GL_ALPHA16F_EXT:
+    case GL_LUMINANCE16F_EXT:
+    case GL_LUMINANCE_ALPHA16F_EXT:         return GL_HALF_FLOAT_OES;
+    case GL_RGBA32F_EXT:
+    case GL_RGB32F_EXT:
+    case GL_ALPHA32F_EXT:
+    case GL_LUMINANCE32F_EXT:
+    case GL_LUMINANCE_ALPHA32F_EXT:         return GL_FLOAT;
+    default:
+        if(GlFormatIsCompressed(internalformat)) {
+                                            return GL_UNSIGNED_BYTE;
+        }
+        NOT_FOUND_ENUM(internalformat);     return GL_INVALID_VALUE;
     }
 }
 
@@ -171,13 +221,23 @@ GlInternalFormatToGlFormat(GLenum internalFormat)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     switch(internalFormat) {
+    case GL_ALPHA16F_EXT:
+    case GL_ALPHA32F_EXT:
     case GL_ALPHA:                            return GL_ALPHA;
+    case GL_LUMINANCE16F_EXT:
+    case GL_LUMINANCE32F_EXT:
     case GL_LUMINANCE:                        return GL_LUMINANCE;
+    case GL_LUMINANCE_ALPHA16F_EXT:
+    case GL_LUMINANCE_ALPHA32F_EXT:
     case GL_LUMINANCE_ALPHA:                  return GL_LUMINANCE_ALPHA;
+    case GL_RGB16F_EXT:
+    case GL_RGB32F_EXT:
     case GL_RGB:
     case GL_RGB565:
     case GL_RGB8_OES:                         return GL_RGB;
     case GL_BGRA8_EXT:                        return GL_BGRA8_EXT;
+    case GL_RGBA16F_EXT:
+    case GL_RGBA32F_EXT:
     case GL_RGBA:
     case GL_RGBA8_OES:
     case GL_RGBA4:
@@ -244,24 +304,53 @@ GlInternalFormatTypeToNumElements(GLenum internalFormat, GLenum type)
         case GL_DEPTH24_STENCIL8_OES:              return 1;
         default: { NOT_FOUND_ENUM(internalFormat); return 1; }
         }
+    case GL_HALF_FLOAT_OES:
+    case GL_FLOAT:
+        switch(GlInternalFormatToGlFormat(internalFormat)) {
+        case GL_ALPHA:
+        case GL_LUMINANCE:                         return 1;
+        case GL_LUMINANCE_ALPHA:                   return 2;
+        case GL_RGB:                               return 3;
+        case GL_RGBA:                              return 4;
+        default: { NOT_FOUND_ENUM(internalFormat); return 1; }
+        }
     default: { NOT_FOUND_ENUM(type);               return 1; }
     }
 }
 
+/// the types that are not vertex attribute types in OpenGL ES 2.0 have no size, GL_FIXED lies beyond the table
+static constexpr GlEnumEntry_t<int32_t> glAttribTypeSizeTable[] = {
+    { GL_BYTE,                              sizeof(GLbyte) },
+    { GL_UNSIGNED_BYTE,                     sizeof(GLubyte) },
+    { GL_SHORT,                             sizeof(GLshort) },
+    { GL_UNSIGNED_SHORT,                    sizeof(GLushort) },
+    { GL_INT,                               0 },
+    { GL_UNSIGNED_INT,                      0 },
+    { GL_FLOAT,                             sizeof(GLfloat) }
+};
+static_assert(GlEnumTableIsDense(glAttribTypeSizeTable, GL_BYTE), "glAttribTypeSizeTable must list consecutive enums");
+
 int32_t
 GlAttribTypeToElementSize(GLenum type)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    // the packed types are sized as a whole element, not per component
     switch(type) {
-        case GL_BYTE:                           return sizeof(GLbyte);
-        case GL_UNSIGNED_BYTE:                  return sizeof(GLubyte);
-        case GL_SHORT:                          return sizeof(GLshort);
-        case GL_UNSIGNED_SHORT:                 return sizeof(GLushort);
-        case GL_FIXED:                          return sizeof(GLfixed);
-        case GL_FLOAT:                          return sizeof(GLfloat);
-        default: { NOT_FOUND_ENUM(type);        return sizeof(GLubyte); }
+    case GL_FIXED:                          return sizeof(GLfixed);
+    case GL_HALF_FLOAT_OES:                 return sizeof(GLushort);
+    case GL_UNSIGNED_INT_10_10_10_2_OES:
+    case GL_INT_10_10_10_2_OES:             return sizeof(GLuint);
+    default:                                break;
     }
+
+    const GlEnumEntry_t<int32_t> *entry = GlEnumTableFind(glAttribTypeSizeTable, type);
+    if(entry == nullptr || entry->value == 0) {
+        NOT_FOUND_ENUM(type);
+        return sizeof(GLubyte);
+    }
+
+    return entry->value;
 }
 
 int
@@ -275,132 +364,143 @@ GlTypeToElementSize(GLenum type)
         case GL_UNSIGNED_SHORT_5_5_5_1:
         case GL_UNSIGNED_SHORT_5_6_5:           return sizeof(GLushort);
         case GL_UNSIGNED_INT_24_8_OES:          return sizeof(GLuint);
+        case GL_HALF_FLOAT_OES:                 return sizeof(GLushort);
+        case GL_FLOAT:                          return sizeof(GLfloat);
         default: { NOT_FOUND_ENUM(type);        return sizeof(GLubyte); }
     }
 }
 
-void
-GlFormatToStorageBits(GLenum format, GLint *r_, GLint *g_, GLint *b_, GLint *a_, GLint *d_, GLint *s_)
+GLfloat
+GlHalfToFloat(GLushort half)
 {
-    FUN_ENTRY(GL_LOG_DEBUG);
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const uint32_t sign     = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t       exponent = (half >> 10) & 0x1f;
+    uint32_t       mantissa = half & 0x3ff;
+    uint32_t       bits;
+
+    if(exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else if(exponent) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if(!mantissa) {
+        bits = sign;
+    } else {
+        // denormals become normal floats
+        exponent = 113;
+        while(!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
 
-    GLint r, g, b, a, d, s;
+    GLfloat value;
+    memcpy(&value, &bits, sizeof(GLfloat));
+    return value;
+}
 
-    switch(format) {
-    case GL_RGB565:
-        r = 5;
-        g = 6;
-        b = 5;
-        a = 0;
-        d = 0;
-        s = 0;
-        break;
+GLushort
+GlFloatToHalf(GLfloat value)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
-    case GL_RGBA4:
-        r = 4;
-        g = 4;
-        b = 4;
-        a = 4;
-        d = 0;
-        s = 0;
-        break;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(GLfloat));
 
-    case GL_RGB5_A1:
-        r = 5;
-        g = 5;
-        b = 5;
-        a = 1;
-        d = 0;
-        s = 0;
-        break;
+    const GLushort sign     = static_cast<GLushort>((bits >> 16) & 0x8000);
+    const int32_t  exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 112;
+    uint32_t       mantissa = bits & 0x7fffff;
 
-    case GL_RGB:
-    case GL_RGB8_OES:
-        r = 8;
-        g = 8;
-        b = 8;
-        a = 0;
-        d = 0;
-        s = 0;
-        break;
-
-    case GL_RGBA:
-    case GL_BGRA8_EXT:
-    case GL_RGBA8_OES:
-    case GL_BGRA_EXT:
-        r = 8;
-        g = 8;
-        b = 8;
-        a = 8;
-        d = 0;
-        s = 0;
-        break;
+    if(exponent == 0xff - 112) {
+        return static_cast<GLushort>(sign | 0x7c00 | (mantissa ? 0x200 | (mantissa >> 13) : 0));
+    }
+    if(exponent >= 0x1f) {
+        return static_cast<GLushort>(sign | 0x7c00);
+    }
 
-    case GL_DEPTH_COMPONENT16:
-        r = 0;
-        g = 0;
-        b = 0;
-        a = 0;
-        d = 16;
-        s = 0;
-        break;
+    // rounded to the nearest even, carries may reach the next exponent or infinity
+    uint32_t shift = 13;
+    uint32_t half  = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if(exponent <= 0) {
+        if(exponent < -10) {
+            return sign;
+        }
+        // too small for a normal half, it becomes a denormal one
+        mantissa |= 0x800000;
+        shift     = static_cast<uint32_t>(14 - exponent);
+        half      = mantissa >> shift;
+    }
 
-    case GL_DEPTH_COMPONENT24_OES:
-        r = 0;
-        g = 0;
-        b = 0;
-        a = 0;
-        d = 24;
-        s = 0;
-        break;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway   = 1u << (shift - 1);
+    if(remainder > halfway || (remainder == halfway && (half & 1))) {
+        ++half;
+    }
 
-    case GL_DEPTH24_STENCIL8_OES:
-        r = 0;
-        g = 0;
-        b = 0;
-        a = 0;
-        d = 24;
-        s = 8;
-        break;
+    return static_cast<GLushort>(sign | half);
+}
 
-    case GL_DEPTH_COMPONENT32_OES:
-        r = 0;
-        g = 0;
-        b = 0;
-        a = 0;
-        d = 32;
-        s = 0;
-        break;
+/// the bits every format stores for each of its components
+typedef struct glStorageBits_t {
+    uint8_t                         red;
+    uint8_t                         green;
+    uint8_t                         blue;
+    uint8_t                         alpha;
+    uint8_t                         depth;
+    uint8_t                         stencil;
+} glStorageBits_t;
+
+static constexpr GlEnumEntry_t<glStorageBits_t> glStorageBitsTable[] = {
+    { GL_RGB,                               { 8, 8, 8, 0,  0, 0 } },
+    { GL_RGBA,                              { 8, 8, 8, 8,  0, 0 } },
+    { GL_RGB8_OES,                          { 8, 8, 8, 0,  0, 0 } },
+    { GL_RGBA4,                             { 4, 4, 4, 4,  0, 0 } },
+    { GL_RGB5_A1,                           { 5, 5, 5, 1,  0, 0 } },
+    { GL_RGBA8_OES,                         { 8, 8, 8, 8,  0, 0 } },
+    { GL_BGRA_EXT,                          { 8, 8, 8, 8,  0, 0 } },
+    { GL_DEPTH_COMPONENT16,                 { 0, 0, 0, 0, 16, 0 } },
+    { GL_DEPTH_COMPONENT24_OES,             { 0, 0, 0, 0, 24, 0 } },
+    { GL_DEPTH_COMPONENT32_OES,             { 0, 0, 0, 0, 32, 0 } },
+    { GL_RGBA32F_EXT,                       { 32, 32, 32, 32,  0, 0 } },
+    { GL_RGB32F_EXT,                        { 32, 32, 32,  0,  0, 0 } },
+    { GL_RGBA16F_EXT,                       { 16, 16, 16, 16,  0, 0 } },
+    { GL_RGB16F_EXT,                        { 16, 16, 16,  0,  0, 0 } },
+    { GL_DEPTH24_STENCIL8_OES,              { 0, 0, 0, 0, 24, 8 } },
+    { GL_STENCIL_INDEX1_OES,                { 0, 0, 0, 0,  0, 8 } },
+    { GL_STENCIL_INDEX4_OES,                { 0, 0, 0, 0,  0, 8 } },
+    { GL_STENCIL_INDEX8,                    { 0, 0, 0, 0,  0, 8 } },
+    { GL_RGB565,                            { 5, 6, 5, 0,  0, 0 } },
+    { GL_BGRA8_EXT,                         { 8, 8, 8, 8,  0, 0 } }
+};
+static_assert(GlEnumTableIsSorted(glStorageBitsTable), "glStorageBitsTable must list ascending enums");
+
+/// formats that are not listed store no bits
+static const glStorageBits_t *
+GlFormatStorageBits(GLenum format)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
 
+    static const glStorageBits_t none = { 0, 0, 0, 0, 0, 0 };
 
-    case GL_STENCIL_INDEX1_OES:
-    case GL_STENCIL_INDEX4_OES:
-    case GL_STENCIL_INDEX8:
-        r = 0;
-        g = 0;
-        b = 0;
-        a = 0;
-        d = 0;
-        s = 8;
-        break;
+    const GlEnumEntry_t<glStorageBits_t> *entry = GlEnumTableSearch(glStorageBitsTable, format);
+    return entry ? &entry->value : &none;
+}
 
+void
+GlFormatToStorageBits(GLenum format, GLint *r_, GLint *g_, GLint *b_, GLint *a_, GLint *d_, GLint *s_)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    default:
-        r = 0;
-        g = 0;
-        b = 0;
-        a = 0;
-        d = 0;
-        s = 0;
-        break;
-    }
+    const glStorageBits_t *bits = GlFormatStorageBits(format);
 
-    if(r_)  *r_ = r;
-    if(g_)  *g_ = g;
-    if(b_)  *b_ = b;
-    if(a_)  *a_ = a;
-    if(d_)  *d_ = d;
-    if(s_)  *s_ = s;
+    if(r_)  *r_ = bits->red;
+    if(g_)  *g_ = bits->green;
+    if(b_)  *b_ = bits->blue;
+    if(a_)  *a_ = bits->alpha;
+    if(d_)  *d_ = bits->depth;
+    if(s_)  *s_ = bits->stencil;
 }
 
 void
@@ -408,121 +508,14 @@ GlFormatToStorageBits(GLenum format, GLfloat *r_, GLfloat *g_, GLfloat *b_, GLfl
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    GLfloat r, g, b, a, d, s;
-
-    switch(format) {
-    case GL_RGB565:
-        r = 5.0f;
-        g = 6.0f;
-        b = 5.0f;
-        a = 0.0f;
-        d = 0.0f;
-        s = 0.0f;
-        break;
-
-    case GL_RGBA4:
-        r = 4.0f;
-        g = 4.0f;
-        b = 4.0f;
-        a = 4.0f;
-        d = 0.0f;
-        s = 0.0f;
-        break;
-
-    case GL_RGB5_A1:
-        r = 5.0f;
-        g = 5.0f;
-        b = 5.0f;
-        a = 1.0f;
-        d = 0.0f;
-        s = 0.0f;
-        break;
-
-    case GL_RGB:
-    case GL_RGB8_OES:
-        r = 8.0f;
-        g = 8.0f;
-        b = 8.0f;
-        a = 0.0f;
-        d = 0.0f;
-        s = 0.0f;
-        break;
-
-    case GL_RGBA:
-    case GL_BGRA8_EXT:
-    case GL_RGBA8_OES:
-    case GL_BGRA_EXT:
-        r = 8.0f;
-        g = 8.0f;
-        b = 8.0f;
-        a = 8.0f;
-        d = 0.0f;
-        s = 0.0f;
-        break;
-
-    case GL_DEPTH_COMPONENT16:
-        r = 0.0f;
-        g = 0.0f;
-        b = 0.0f;
-        a = 0.0f;
-        d = 16.0f;
-        s = 0.0f;
-        break;
-
-    case GL_DEPTH_COMPONENT24_OES:
-        r = 0.0f;
-        g = 0.0f;
-        b = 0.0f;
-        a = 0.0f;
-        d = 24.0f;
-        s = 0.0f;
-        break;
+    const glStorageBits_t *bits = GlFormatStorageBits(format);
 
-    case GL_DEPTH24_STENCIL8_OES:
-        r = 0.0f;
-        g = 0.0f;
-        b = 0.0f;
-        a = 0.0f;
-        d = 24.0f;
-        s = 8.0f;
-        break;
-
-    case GL_DEPTH_COMPONENT32_OES:
-        r = 0.0f;
-        g = 0.0f;
-        b = 0.0f;
-        a = 0.0f;
-        d = 32.0f;
-        s = 0.0f;
-        break;
-
-    case GL_STENCIL_INDEX1_OES:
-    case GL_STENCIL_INDEX4_OES:
-    case GL_STENCIL_INDEX8:
-        r = 0.0f;
-        g = 0.0f;
-        b = 0.0f;
-        a = 0.0f;
-        d = 0.0f;
-        s = 8.0f;
-        break;
-
-    default:
-        r = 0.0f;
-        g = 0.0f;
-        b = 0.0f;
-        a = 0.0f;
-        d = 0.0f;
-        s = 0.0f;
-        break;
-    }
-
-    if(r_)  *r_ = r;
-    if(g_)  *g_ = g;
-    if(b_)  *b_ = b;
-    if(a_)  *a_ = a;
-    if(d_)  *d_ = d;
-    if(s_)  *s_ = s;
+    if(r_)  *r_ = static_cast<GLfloat>(bits->red);
+    if(g_)  *g_ = static_cast<GLfloat>(bits->green);
+    if(b_)  *b_ = static_cast<GLfloat>(bits->blue);
+    if(a_)  *a_ = static_cast<GLfloat>(bits->alpha);
+    if(d_)  *d_ = static_cast<GLfloat>(bits->depth);
+    if(s_)  *s_ = static_cast<GLfloat>(bits->stencil);
 }
 
 void
@@ -530,126 +523,16 @@ GlFormatToStorageBits(GLenum format, GLboolean *r_, GLboolean *g_, GLboolean *b_
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    GLboolean r, g, b, a, d, s;
-
-    switch(format) {
-    case GL_RGB565:
-        r = GL_TRUE;
-        g = GL_TRUE;
-        b = GL_TRUE;
-        a = GL_FALSE;
-        d = GL_FALSE;
-        s = GL_FALSE;
-        break;
+    const glStorageBits_t *bits = GlFormatStorageBits(format);
 
-    case GL_RGBA4:
-        r = GL_TRUE;
-        g = GL_TRUE;
-        b = GL_TRUE;
-        a = GL_TRUE;
-        d = GL_FALSE;
-        s = GL_FALSE;
-        break;
-
-    case GL_RGB5_A1:
-        r = GL_TRUE;
-        g = GL_TRUE;
-        b = GL_TRUE;
-        a = GL_TRUE;
-        d = GL_FALSE;
-        s = GL_FALSE;
-        break;
-
-    case GL_RGB:
-    case GL_RGB8_OES:
-        r = GL_TRUE;
-        g = GL_TRUE;
-        b = GL_TRUE;
-        a = GL_FALSE;
-        d = GL_FALSE;
-        s = GL_FALSE;
-        break;
-
-    case GL_RGBA:
-    case GL_BGRA8_EXT:
-    case GL_RGBA8_OES:
-    case GL_BGRA_EXT:
-        r = GL_TRUE;
-        g = GL_TRUE;
-        b = GL_TRUE;
-        a = GL_TRUE;
-        d = GL_FALSE;
-        s = GL_FALSE;
-        break;
-
-    case GL_DEPTH_COMPONENT16:
-        r = GL_FALSE;
-        g = GL_FALSE;
-        b = GL_FALSE;
-        a = GL_FALSE;
-        d = GL_TRUE;
-        s = GL_FALSE;
-        break;
-
-    case GL_DEPTH_COMPONENT24_OES:
-        r = GL_FALSE;
-        g = GL_FALSE;
-        b = GL_FALSE;
-        a = GL_FALSE;
-        d = GL_TRUE;
-        s = GL_FALSE;
-        break;
-
-    case GL_DEPTH24_STENCIL8_OES:
-        r = GL_FALSE;
-        g = GL_FALSE;
-        b = GL_FALSE;
-        a = GL_FALSE;
-        d = GL_TRUE;
-        s = GL_TRUE;
-        break;
-
-    case GL_DEPTH_COMPONENT32_OES:
-        r = GL_FALSE;
-        g = GL_FALSE;
-        b = GL_FALSE;
-        a = GL_FALSE;
-        d = GL_TRUE;
-        s = GL_FALSE;
-        break;
-
-
-    case GL_STENCIL_INDEX1_OES:
-    case GL_STENCIL_INDEX4_OES:
-    case GL_STENCIL_INDEX8:
-        r = GL_FALSE;
-        g = GL_FALSE;
-        b = GL_FALSE;
-        a = GL_FALSE;
-        d = GL_FALSE;
-        s = GL_TRUE;
-        break;
-
-
-    default:
-        r = GL_FALSE;
-        g = GL_FALSE;
-        b = GL_FALSE;
-        a = GL_FALSE;
-        d = GL_FALSE;
-        s = GL_FALSE;
-        break;
-    }
-
-    if(r_)  *r_ = r;
-    if(g_)  *g_ = g;
-    if(b_)  *b_ = b;
-    if(a_)  *a_ = a;
-    if(d_)  *d_ = d;
-    if(s_)  *s_ = s;
+    if(r_)  *r_ = bits->red     ? GL_TRUE : GL_FALSE;
+    if(g_)  *g_ = bits->green   ? GL_TRUE : GL_FALSE;
+    if(b_)  *b_ = bits->blue    ? GL_TRUE : GL_FALSE;
+    if(a_)  *a_ = bits->alpha   ? GL_TRUE : GL_FALSE;
+    if(d_)  *d_ = bits->depth   ? GL_TRUE : GL_FALSE;
+    if(s_)  *s_ = bits->stencil ? GL_TRUE : GL_FALSE;
 }
 
-
 bool
 GlFormatIsDepthRenderable(GLenum format)
 {
@@ -685,7 +568,11 @@ GlFormatIsColorRenderable(GLenum format)
     case GL_RGBA8_OES:
     case GL_RGB565:
     case GL_RGBA4:
-    case GL_RGB5_A1:                    return true;
+    case GL_RGB5_A1:
+    case GL_RGBA16F_EXT:
+    case GL_RGB16F_EXT:
+    case GL_RGBA32F_EXT:
+    case GL_RGB32F_EXT:                 return true;
     default:                            return false;
     }
 }
@@ -718,5 +605,422 @@ OccupiedLocationsPerGlType(GLenum type)
 bool
 IsGlSampler(GLenum type)
 {
-    return (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE);
+    return (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE) || (type == GL_SAMPLER_2D_SHADOW_EXT);
+}
+
+// The vector paths scan 16 bytes of indices at a time and return how many
+// indices they consumed, the remaining ones are scanned one by one.
+template<typename IndexType>
+static uint32_t
+ScanIndexRangeVector(const IndexType *, uint32_t, IndexType *, IndexType *)
+{
+    return 0;
+}
+
+#if defined(__SSE2__)
+template<>
+uint32_t
+ScanIndexRangeVector<uint8_t>(const uint8_t *indices, uint32_t count, uint8_t *minValue, uint8_t *maxValue)
+{
+    __m128i vMin = _mm_set1_epi8(static_cast<char>(*minValue));
+    __m128i vMax = _mm_set1_epi8(static_cast<char>(*maxValue));
+
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + i));
+        vMin = _mm_min_epu8(vMin, v);
+        vMax = _mm_max_epu8(vMax, v);
+    }
+
+    uint8_t mins[16], maxs[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(mins), vMin);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(maxs), vMax);
+    for(uint32_t j = 0; j < 16; ++j) {
+        *minValue = std::min(*minValue, mins[j]);
+        *maxValue = std::max(*maxValue, maxs[j]);
+    }
+
+    return i;
+}
+
+template<>
+uint32_t
+ScanIndexRangeVector<uint16_t>(const uint16_t *indices, uint32_t count, uint16_t *minValue, uint16_t *maxValue)
+{
+    // SSE2 only compares signed words, so the indices are biased into the signed range
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+    __m128i vMin = _mm_set1_epi16(static_cast<short>(*minValue ^ 0x8000));
+    __m128i vMax = _mm_set1_epi16(static_cast<short>(*maxValue ^ 0x8000));
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + i)), bias);
+        vMin = _mm_min_epi16(vMin, v);
+        vMax = _mm_max_epi16(vMax, v);
+    }
+
+    uint16_t mins[8], maxs[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(mins), _mm_xor_si128(vMin, bias));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(maxs), _mm_xor_si128(vMax, bias));
+    for(uint32_t j = 0; j < 8; ++j) {
+        *minValue = std::min(*minValue, mins[j]);
+        *maxValue = std::max(*maxValue, maxs[j]);
+    }
+
+    return i;
+}
+
+template<>
+uint32_t
+ScanIndexRangeVector<uint32_t>(const uint32_t *indices, uint32_t count, uint32_t *minValue, uint32_t *maxValue)
+{
+    // SSE2 has no min or max of dwords, so they are selected by a signed compare of the biased indices
+    const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    __m128i vMin = _mm_set1_epi32(static_cast<int>(*minValue ^ 0x80000000u));
+    __m128i vMax = _mm_set1_epi32(static_cast<int>(*maxValue ^ 0x80000000u));
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128i v  = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + i)), bias);
+        __m128i lt = _mm_cmplt_epi32(v, vMin);
+        __m128i gt = _mm_cmpgt_epi32(v, vMax);
+        vMin = _mm_or_si128(_mm_and_si128(lt, v), _mm_andnot_si128(lt, vMin));
+        vMax = _mm_or_si128(_mm_and_si128(gt, v), _mm_andnot_si128(gt, vMax));
+    }
+
+    uint32_t mins[4], maxs[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(mins), _mm_xor_si128(vMin, bias));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(maxs), _mm_xor_si128(vMax, bias));
+    for(uint32_t j = 0; j < 4; ++j) {
+        *minValue = std::min(*minValue, mins[j]);
+        *maxValue = std::max(*maxValue, maxs[j]);
+    }
+
+    return i;
+}
+#elif defined(__ARM_NEON)
+template<>
+uint32_t
+ScanIndexRangeVector<uint8_t>(const uint8_t *indices, uint32_t count, uint8_t *minValue, uint8_t *maxValue)
+{
+    uint8x16_t vMin = vdupq_n_u8(*minValue);
+    uint8x16_t vMax = vdupq_n_u8(*maxValue);
+
+    uint32_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        uint8x16_t v = vld1q_u8(indices + i);
+        vMin = vminq_u8(vMin, v);
+        vMax = vmaxq_u8(vMax, v);
+    }
+
+    uint8_t mins[16], maxs[16];
+    vst1q_u8(mins, vMin);
+    vst1q_u8(maxs, vMax);
+    for(uint32_t j = 0; j < 16; ++j) {
+        *minValue = std::min(*minValue, mins[j]);
+        *maxValue = std::max(*maxValue, maxs[j]);
+    }
+
+    return i;
+}
+
+template<>
+uint32_t
+ScanIndexRangeVector<uint16_t>(const uint16_t *indices, uint32_t count, uint16_t *minValue, uint16_t *maxValue)
+{
+    uint16x8_t vMin = vdupq_n_u16(*minValue);
+    uint16x8_t vMax = vdupq_n_u16(*maxValue);
+
+    uint32_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        uint16x8_t v = vld1q_u16(indices + i);
+        vMin = vminq_u16(vMin, v);
+        vMax = vmaxq_u16(vMax, v);
+    }
+
+    uint16_t mins[8], maxs[8];
+    vst1q_u16(mins, vMin);
+    vst1q_u16(maxs, vMax);
+    for(uint32_t j = 0; j < 8; ++j) {
+        *minValue = std::min(*minValue, mins[j]);
+        *maxValue = std::max(*maxValue, maxs[j]);
+    }
+
+    return i;
+}
+
+template<>
+uint32_t
+ScanIndexRangeVector<uint32_t>(const uint32_t *indices, uint32_t count, uint32_t *minValue, uint32_t *maxValue)
+{
+    uint32x4_t vMin = vdupq_n_u32(*minValue);
+    uint32x4_t vMax = vdupq_n_u32(*maxValue);
+
+    uint32_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        uint32x4_t v = vld1q_u32(indices + i);
+        vMin = vminq_u32(vMin, v);
+        vMax = vmaxq_u32(vMax, v);
+    }
+
+    uint32_t mins[4], maxs[4];
+    vst1q_u32(mins, vMin);
+    vst1q_u32(maxs, vMax);
+    for(uint32_t j = 0; j < 4; ++j) {
+        *minValue = std::min(*minValue, mins[j]);
+        *maxValue = std::max(*maxValue, maxs[j]);
+    }
+
+    return i;
+}
+#endif
+
+template<typename IndexType>
+static void
+ScanIndexRange(const IndexType *indices, uint32_t count, bool primitiveRestart, uint32_t *minIndex, uint32_t *maxIndex)
+{
+    const IndexType restartIndex = std::numeric_limits<IndexType>::max();
+    IndexType minValue = restartIndex;
+    IndexType maxValue = 0;
+
+    for(uint32_t i = ScanIndexRangeVector(indices, count, &minValue, &maxValue); i < count; ++i) {
+        minValue = std::min(minValue, indices[i]);
+        maxValue = std::max(maxValue, indices[i]);
+    }
+
+    // the restart index only cuts the strips, it names no vertex. It is the highest
+    // value of the type, so the indices are scanned again only when it is present
+    if(primitiveRestart && maxValue == restartIndex) {
+        minValue = restartIndex;
+        maxValue = 0;
+        for(uint32_t i = 0; i < count; ++i) {
+            if(indices[i] != restartIndex) {
+                minValue = std::min(minValue, indices[i]);
+                maxValue = std::max(maxValue, indices[i]);
+            }
+        }
+    }
+
+    *minIndex = count ? minValue : 0;
+    *maxIndex = maxValue;
+}
+
+void
+GlIndexRange(const void *indices, uint32_t count, GLenum type, bool primitiveRestart, uint32_t *minIndex, uint32_t *maxIndex)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    switch(type) {
+        case GL_UNSIGNED_BYTE:      ScanIndexRange(static_cast<const uint8_t  *>(indices), count, primitiveRestart, minIndex, maxIndex); break;
+        case GL_UNSIGNED_SHORT:     ScanIndexRange(static_cast<const uint16_t *>(indices), count, primitiveRestart, minIndex, maxIndex); break;
+        case GL_UNSIGNED_INT:       ScanIndexRange(static_cast<const uint32_t *>(indices), count, primitiveRestart, minIndex, maxIndex); break;
+        default: NOT_REACHED();     *minIndex = 0; *maxIndex = 0; break;
+    }
+}
+
+template<typename SrcType, typename DstType>
+static void
+ConvertTriangleFan(const SrcType *indices, uint32_t count, DstType *dst)
+{
+    // in the order Vulkan draws fans in, so that the winding is kept
+    for(uint32_t i = 0; i + 2 < count; ++i) {
+        *dst++ = static_cast<DstType>(indices ? indices[i + 1] : i + 1);
+        *dst++ = static_cast<DstType>(indices ? indices[i + 2] : i + 2);
+        *dst++ = static_cast<DstType>(indices ? indices[0]     : 0);
+    }
+}
+
+template<typename SrcType>
+static void
+ConvertTriangleFan(const SrcType *indices, uint32_t count, void *dst, GLenum dstType)
+{
+    switch(dstType) {
+        case GL_UNSIGNED_BYTE:      ConvertTriangleFan(indices, count, static_cast<uint8_t  *>(dst)); break;
+        case GL_UNSIGNED_SHORT:     ConvertTriangleFan(indices, count, static_cast<uint16_t *>(dst)); break;
+        case GL_UNSIGNED_INT:       ConvertTriangleFan(indices, count, static_cast<uint32_t *>(dst)); break;
+        default: NOT_REACHED();     break;
+    }
+}
+
+/// writes the GlTriangleFanToListCount(count) indices of the triangles of a fan,
+/// GL_NONE takes the vertices in order, as glDrawArrays does
+void
+GlTriangleFanToList(const void *indices, uint32_t count, GLenum type, void *dst, GLenum dstType)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    switch(type) {
+        case GL_NONE:               ConvertTriangleFan(static_cast<const uint32_t *>(nullptr), count, dst, dstType); break;
+        case GL_UNSIGNED_BYTE:      ConvertTriangleFan(static_cast<const uint8_t  *>(indices), count, dst, dstType); break;
+        case GL_UNSIGNED_SHORT:     ConvertTriangleFan(static_cast<const uint16_t *>(indices), count, dst, dstType); break;
+        case GL_UNSIGNED_INT:       ConvertTriangleFan(static_cast<const uint32_t *>(indices), count, dst, dstType); break;
+        default: NOT_REACHED();     break;
+    }
+}
+
+// A column of up to 4 floats goes to a vec4 slot, its unused lanes cleared,
+// with loads that never read past the last float of the column.
+static inline void
+PackUniformColumn(const float *src, uint32_t rows, float *dst)
+{
+#if defined(__SSE2__)
+    __m128 column;
+    switch(rows) {
+        case 1:  column = _mm_load_ss(src); break;
+        case 2:  column = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(src))); break;
+        case 3:  column = _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(src))), _mm_load_ss(src + 2)); break;
+        default: column = _mm_loadu_ps(src); break;
+    }
+    _mm_storeu_ps(dst, column);
+#elif defined(__ARM_NEON)
+    float32x4_t column;
+    switch(rows) {
+        case 1:  column = vsetq_lane_f32(*src, vdupq_n_f32(0.0f), 0); break;
+        case 2:  column = vcombine_f32(vld1_f32(src), vdup_n_f32(0.0f)); break;
+        case 3:  column = vcombine_f32(vld1_f32(src), vset_lane_f32(src[2], vdup_n_f32(0.0f), 0)); break;
+        default: column = vld1q_f32(src); break;
+    }
+    vst1q_f32(dst, column);
+#else
+    for(uint32_t i = 0; i < 4; ++i) {
+        dst[i] = i < rows ? src[i] : 0.0f;
+    }
+#endif
+}
+
+/// writes count tightly packed matrices of columns x rows floats (vectors have one column) with every
+/// column padded to a vec4, as std140 lays them out, the elements dstStride bytes apart.
+/// transposed matrices are given row after row
+void
+GlPackUniformColumns(const float *src, uint32_t count, uint32_t columns, uint32_t rows, bool transpose, void *dst, size_t dstStride)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(columns >= 1 && columns <= 4 && rows >= 1 && rows <= 4);
+
+    uint8_t *dstElement = static_cast<uint8_t *>(dst);
+    for(uint32_t k = 0; k < count; ++k) {
+        float *dstColumn = reinterpret_cast<float *>(dstElement);
+
+        if(!transpose) {
+            for(uint32_t c = 0; c < columns; ++c) {
+                PackUniformColumn(src + c * rows, rows, dstColumn + 4 * c);
+            }
+        } else {
+            for(uint32_t c = 0; c < columns; ++c) {
+                float column[4];
+                for(uint32_t r = 0; r < rows; ++r) {
+                    column[r] = src[r * columns + c];
+                }
+                PackUniformColumn(column, rows, dstColumn + 4 * c);
+            }
+        }
+
+        src        += columns * rows;
+        dstElement += dstStride;
+    }
+}
+
+bool
+GlFormatIsCompressed(GLenum format)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return GlCompressedFormatToBlockSize(format, nullptr, nullptr, nullptr);
+}
+
+bool
+GlCompressedFormatToBlockSize(GLenum format, GLint *blockWidth, GLint *blockHeight, GLint *blockBytes)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GLint width  = 4;
+    GLint height = 4;
+    GLint bytes  = 16;
+
+    switch(format) {
+    case GL_ETC1_RGB8_OES:
+    case GL_COMPRESSED_R11_EAC:
+    case GL_COMPRESSED_SIGNED_R11_EAC:
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1_EXT:
+    case GL_COMPRESSED_SIGNED_RED_RGTC1_EXT:                                bytes = 8;              break;
+
+    case GL_COMPRESSED_RG11_EAC:
+    case GL_COMPRESSED_SIGNED_RG11_EAC:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RED_GREEN_RGTC2_EXT:
+    case GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_EXT:
+    case GL_COMPRESSED_RGBA_ASTC_4x4_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR:                                                   break;
+
+    case GL_COMPRESSED_RGBA_ASTC_5x4_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR:                           width  = 5; height = 4;  break;
+    case GL_COMPRESSED_RGBA_ASTC_5x5_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR:                           width  = 5; height = 5;  break;
+    case GL_COMPRESSED_RGBA_ASTC_6x5_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR:                           width  = 6; height = 5;  break;
+    case GL_COMPRESSED_RGBA_ASTC_6x6_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR:                           width  = 6; height = 6;  break;
+    case GL_COMPRESSED_RGBA_ASTC_8x5_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR:                           width  = 8; height = 5;  break;
+    case GL_COMPRESSED_RGBA_ASTC_8x6_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR:                           width  = 8; height = 6;  break;
+    case GL_COMPRESSED_RGBA_ASTC_8x8_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR:                           width  = 8; height = 8;  break;
+    case GL_COMPRESSED_RGBA_ASTC_10x5_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR:                          width = 10; height = 5;  break;
+    case GL_COMPRESSED_RGBA_ASTC_10x6_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR:                          width = 10; height = 6;  break;
+    case GL_COMPRESSED_RGBA_ASTC_10x8_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR:                          width = 10; height = 8;  break;
+    case GL_COMPRESSED_RGBA_ASTC_10x10_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR:                         width = 10; height = 10; break;
+    case GL_COMPRESSED_RGBA_ASTC_12x10_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR:                         width = 12; height = 10; break;
+    case GL_COMPRESSED_RGBA_ASTC_12x12_KHR:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR:                         width = 12; height = 12; break;
+
+    default:                                                                return false;
+    }
+
+    if(blockWidth) {
+        *blockWidth = width;
+    }
+    if(blockHeight) {
+        *blockHeight = height;
+    }
+    if(blockBytes) {
+        *blockBytes = bytes;
+    }
+
+    return true;
+}
+
+GLsizei
+GlCompressedImageSize(GLenum format, GLsizei width, GLsizei height)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GLint blockWidth, blockHeight, blockBytes;
+    if(!GlCompressedFormatToBlockSize(format, &blockWidth, &blockHeight, &blockBytes)) {
+        return 0;
+    }
+
+    // partial blocks at the right and bottom edges are stored whole
+    return ((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * blockBytes;
 }
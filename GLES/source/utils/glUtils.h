@@ -29,6 +29,20 @@
 #include "GLES2/gl2ext.h"
 #include <stdint.h>
 
+/// ETC2/EAC formats are core in OpenGL ES 3.0 and have no OpenGL ES 2.0 extension header
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_R11_EAC                           0x9270
+#define GL_COMPRESSED_SIGNED_R11_EAC                    0x9271
+#define GL_COMPRESSED_RG11_EAC                          0x9272
+#define GL_COMPRESSED_SIGNED_RG11_EAC                   0x9273
+#define GL_COMPRESSED_RGB8_ETC2                         0x9274
+#define GL_COMPRESSED_SRGB8_ETC2                        0x9275
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2     0x9276
+#define GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2    0x9277
+#define GL_COMPRESSED_RGBA8_ETC2_EAC                    0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC             0x9279
+#endif // GL_COMPRESSED_RGB8_ETC2
+
 enum GLColorMaskBit {
     GLC_RED     = 0,
     GLC_GREEN   = 1,
@@ -45,12 +59,21 @@ GLenum                  GlInternalFormatToGlFormat(GLenum internalFormat);
 int                     GlInternalFormatTypeToNumElements(GLenum format, GLenum type);
 int32_t                 GlAttribTypeToElementSize(GLenum type);
 int                     GlTypeToElementSize(GLenum type);
+GLfloat                 GlHalfToFloat(GLushort half);
+GLushort                GlFloatToHalf(GLfloat value);
 void                    GlFormatToStorageBits(GLenum format, GLint     *r_, GLint     *g_, GLint     *b_, GLint     *a_, GLint     *d_, GLint     *s_);
 void                    GlFormatToStorageBits(GLenum format, GLfloat   *r_, GLfloat   *g_, GLfloat   *b_, GLfloat   *a_, GLfloat   *d_, GLfloat   *s_);
 void                    GlFormatToStorageBits(GLenum format, GLboolean *r_, GLboolean *g_, GLboolean *b_, GLboolean *a_, GLboolean *d_, GLboolean *s_);
 bool                    GlFormatIsDepthRenderable(GLenum format);
 bool                    GlFormatIsStencilRenderable(GLenum format);
 bool                    GlFormatIsColorRenderable(GLenum format);
+bool                    GlFormatIsCompressed(GLenum format);
+bool                    GlCompressedFormatToBlockSize(GLenum format, GLint *blockWidth, GLint *blockHeight, GLint *blockBytes);
+GLsizei                 GlCompressedImageSize(GLenum format, GLsizei width, GLsizei height);
 uint32_t                OccupiedLocationsPerGlType(GLenum type);
 bool                    IsGlSampler(GLenum type);
+void                    GlIndexRange(const void *indices, uint32_t count, GLenum type, bool primitiveRestart, uint32_t *minIndex, uint32_t *maxIndex);
+void                    GlTriangleFanToList(const void *indices, uint32_t count, GLenum type, void *dst, GLenum dstType);
+void                    GlPackUniformColumns(const float *src, uint32_t count, uint32_t columns, uint32_t rows, bool transpose, void *dst, size_t dstStride);
+inline uint32_t         GlTriangleFanToListCount(uint32_t count)                    { return count >= 3 ? 3 * (count - 2) : 0; }
 #endif // __GLUTILS_H__
@@ -88,8 +88,101 @@
 #define GLOVE_DUMP_PROCESSED_SHADER_SOURCE              false
 #define GLOVE_DUMP_SPIRV_SHADER_SOURCE                  false
 
+/// Translate ESSL 1.00 shaders on their validated AST instead of converting and recompiling their source
+#define GLOVE_TRANSLATE_SHADERS_ON_AST                  true
+
+/// Optimize runtime-compiled SPIR-V with SPIRV-Tools: 0 off, 1 size passes, 2 performance passes
+/// (set through the SPIRV_OPT_LEVEL build option, which also links the optimizer)
+#ifndef GLOVE_SPIRV_OPTIMIZATION_LEVEL
+#define GLOVE_SPIRV_OPTIMIZATION_LEVEL                  0
+#endif
+
+/// Execute GL calls on a worker thread per context, fed through a command ring by the calling thread
+/// (set through the THREADED_DISPATCH build option)
+#ifndef GLOVE_THREADED_DISPATCH
+#define GLOVE_THREADED_DISPATCH                         false
+#endif
+
+/// Bytes of the command ring; calls with more client memory than half of it run synchronously
+#define GLOVE_THREADED_DISPATCH_RING_SIZE               (4 * 1024 * 1024)
+
+/// Record draws into secondary command buffers instead of the active primary one
+#define GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS          false
+
+/// Defer consecutive draws that share their state and bindings, and record them as one batch
+#define GLOVE_BATCH_DRAWS                               false
+
+/// Number of separate draw ranges a batch holds before it is recorded
+#define GLOVE_MAX_BATCHED_DRAWS                         64
+
+/// Draw ranges a batch holds per secondary command buffer at least, before its recording is split across threads
+#define GLOVE_MIN_BATCHED_DRAWS_PER_THREAD              8
+
+/// Place the largest default-block uniform that fits into a push constant block instead of a uniform buffer
+#define GLOVE_USE_PUSH_CONSTANTS                        true
+
+/// Push constant bytes a program uses, the least maxPushConstantsSize of any device
+#define GLOVE_MAX_PUSH_CONSTANTS_SIZE                   128
+
+/// Turn scalar bool and int uniforms named with GLOVE_SPECIALIZATION_UNIFORM_PREFIX into specialization constants,
+/// so that feature switches select a specialized pipeline instead of branching on a uniform.
+/// Off by default, since every value such a uniform takes builds a pipeline of its own
+#define GLOVE_USE_SPECIALIZATION_CONSTANTS              false
+#define GLOVE_SPECIALIZATION_UNIFORM_PREFIX             "spec_"
+
+/// Draw the default framebuffer already turned the way its swapchain is presented, so that the compositor
+/// does not rotate every frame, vertex shaders read the quarter turns from this specialization constant
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+#   define GLOVE_USE_PRE_ROTATION                       true
+#else
+#   define GLOVE_USE_PRE_ROTATION                       false
+#endif // VK_USE_PLATFORM_ANDROID_KHR
+#define GLOVE_PRE_ROTATION_CONSTANT_ID                  1024
+
+/// Textures a program samples through an index reach them in one array per sampler type, of this many slots,
+/// 2D textures at the first binding of the set and cube maps at the second
+#define GLOVE_BINDLESS_TEXTURE_BINDINGS                 2
+#define GLOVE_BINDLESS_TEXTURE_COUNT                    4096
+#define GLOVE_BINDLESS_TEXTURE_SET                      1
+
+/// Ranges recorded by one indirect draw, the least maxDrawIndirectCount of devices with multiDrawIndirect
+#define GLOVE_MAX_DRAW_INDIRECT_COUNT                   65535
+
+/// Storage buffers a compute program binds, and work groups one dispatch launches per dimension, the least of ES 3.1
+#define GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS        4
+#define GLOVE_MAX_COMPUTE_WORK_GROUP_COUNT              65535
+
+/// Uniform buffers bound for the uniform blocks of compute programs, and blocks one of them declares, the least of ES 3.1.
+/// The blocks take the descriptor bindings past those of the storage blocks, from the one given by their layout on
+#define GLOVE_MAX_UNIFORM_BUFFER_BINDINGS               24
+#define GLOVE_MAX_COMPUTE_UNIFORM_BLOCKS                12
+#define GLOVE_UNIFORM_BUFFER_FIRST_VK_BINDING           GLOVE_MAX_SHADER_STORAGE_BUFFER_BINDINGS
+
+/// Buffers transform feedback writes to and the components it captures per vertex, the least of ES 3.0
+#define GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS       4
+#define GLOVE_MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS    4
+#define GLOVE_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS 64
+
+/// Bytes of the chunks the per-frame arena of a context hands out the temporaries of its draws from
+#define GLOVE_FRAME_ARENA_CHUNK_SIZE                    (64 * 1024)
+
+/// Release the host copy of texture levels once they are uploaded, and read them back from the image when needed
+#define GLOVE_RELEASE_TEXTURE_HOST_DATA                 true
+
+/// Create the Vulkan image of a texture on its first use instead of as soon as it is complete
+#define GLOVE_LAZY_TEXTURE_ALLOCATION                   true
+
+/// Submissions a texture must stay unused for before it can be evicted under memory pressure
+#define GLOVE_TEXTURE_EVICTION_IDLE_SUBMITS             120
+
+/// Contexts of a share group whose use of the shared textures is tracked, the textures sampled by any context
+/// beyond them are neither evicted nor written from the host anymore
+#define GLOVE_MAX_SHARE_GROUP_CONTEXTS                  4
+#define GLOVE_UNTRACKED_SHARE_GROUP_SLOT                GLOVE_MAX_SHARE_GROUP_CONTEXTS
+
 #define GLOVE_INVALID_OFFSET                            UINT32_MAX
 
 #define GLOVE_VULKAN_DEPTH_RANGE                        vulkan_DepthRange
+#define GLOVE_VULKAN_LAST_FRAG_DATA                     vulkan_LastFragData
 
 #endif // __GLOBALS_H__
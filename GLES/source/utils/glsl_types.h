@@ -55,7 +55,8 @@ typedef uint32_t                            glsl_sampler_t;
 typedef enum {
     SHADER_TYPE_INVALID  = 0,
     SHADER_TYPE_VERTEX   = 1 << 0,
-    SHADER_TYPE_FRAGMENT = 1 << 1
+    SHADER_TYPE_FRAGMENT = 1 << 1,
+    SHADER_TYPE_COMPUTE  = 1 << 2
 } shader_type_t;
 
 enum ESSL_VERSION {
@@ -68,7 +69,7 @@ inline void GlslPrintShaderSource(shader_type_t shaderType,
                             ESSL_VERSION version,
                             const std::string source) { FUN_ENTRY(GL_LOG_TRACE); 
                                                         std::cout << "\n\n-------- " << 
-                                                        ((shaderType == SHADER_TYPE_VERTEX) ? "VERTEX" : "FRAGMENT")  <<
+                                                        ((shaderType == SHADER_TYPE_VERTEX) ? "VERTEX" : (shaderType == SHADER_TYPE_COMPUTE) ? "COMPUTE" : "FRAGMENT")  <<
                                                         " SHADER v" << version << " --------\n\n" << source << "\n"   <<
                                                         "--------------------------------------\n\n"; }
 
@@ -99,7 +100,8 @@ inline size_t GlslTypeToAllignment(GLenum type)
     case GL_FLOAT_MAT4:                     return 64;
 
     case GL_SAMPLER_2D:
-    case GL_SAMPLER_CUBE:                   return 16;
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW_EXT:          return 16;
     default:                                return 0;
     }
 }
@@ -130,7 +132,8 @@ inline size_t GlslTypeToSize(GLenum type)
     case GL_FLOAT_MAT4:                     return sizeof(glsl_mat4_t);
 
     case GL_SAMPLER_2D:
-    case GL_SAMPLER_CUBE:                   return sizeof(glsl_sampler_t);
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW_EXT:          return sizeof(glsl_sampler_t);
     default:                                return 0;
     }
 }
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       jobSystem.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Bounded set of worker threads shared by all background work of the library
+ *
+ *  @section
+ *
+ *  Shader compilation, command recording, pixel conversion and pipeline
+ *  building each used to start threads of their own, which together could
+ *  outnumber the cores of the device many times over. They all submit jobs
+ *  here instead. Each worker keeps a deque of jobs: it runs the newest of its
+ *  own first, and once it has none left it steals the oldest of another
+ *  worker. Jobs submitted by a worker go to its own deque, the others are
+ *  spread across the workers. Frame jobs are always taken before speculative
+ *  ones, and speculative ones never occupy every worker, so that one is left
+ *  for the frame. The workers are started with the first job and may be
+ *  pinned to a set of cores, e.g. the little ones of a big.LITTLE device.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include "jobSystem.h"
+#include "utils/glLogger.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+
+/// the index of the worker a thread is, -1 for the threads of the application
+static thread_local int workerIndex = -1;
+
+JobSystem::JobSystem()
+: mThreadCount(0), mAffinityMask(0), mRunningSpeculativeJobs(0), mNextWorker(0), mStarted(false), mStopping(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < JOB_PRIORITY_COUNT; ++i) {
+        mPendingJobs[i] = 0;
+    }
+
+    const char *affinity = getenv(GLOVE_JOB_AFFINITY_ENV);
+    if(affinity != nullptr) {
+        mAffinityMask = strtoull(affinity, nullptr, 0);
+    }
+
+    // by default one thread less than the cores the workers may run on, the application keeps the other
+    uint32_t cores = std::thread::hardware_concurrency();
+    if(mAffinityMask) {
+        cores = std::min(cores ? cores : 64u, static_cast<uint32_t>(__builtin_popcountll(mAffinityMask)) + 1);
+    }
+    mThreadCount = (cores > 1) ? std::min(cores - 1, static_cast<uint32_t>(GLOVE_JOB_SYSTEM_MAX_THREADS)) : 0;
+
+    const char *threads = getenv(GLOVE_JOB_THREADS_ENV);
+    if(threads != nullptr) {
+        mThreadCount = std::min(static_cast<uint32_t>(strtoul(threads, nullptr, 10)), static_cast<uint32_t>(GLOVE_JOB_SYSTEM_MAX_THREADS));
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkCondition.notify_all();
+
+    for(auto &worker : mWorkers) {
+        worker->thread.join();
+    }
+}
+
+JobSystem *
+JobSystem::GetInstance(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    static JobSystem jobSystem;
+    return &jobSystem;
+}
+
+uint32_t
+JobSystem::GetThreadCount(void) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return mThreadCount;
+}
+
+void
+JobSystem::SetAffinity(std::thread *thread) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef __linux__
+    if(!mAffinityMask) {
+        return;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for(uint32_t cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+        if(mAffinityMask & (1ull << cpu)) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+
+    // the workers simply run anywhere when the mask holds no core they may use
+    pthread_setaffinity_np(thread->native_handle(), sizeof(cpus), &cpus);
+#endif // __linux__
+}
+
+void
+JobSystem::StartWorkers(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mStarted) {
+        return;
+    }
+    mStarted = true;
+
+    // every deque exists before any worker may steal from it
+    for(uint32_t i = 0; i < mThreadCount; ++i) {
+        mWorkers.emplace_back(new Worker_t());
+    }
+
+    for(uint32_t i = 0; i < mThreadCount; ++i) {
+        mWorkers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+        SetAffinity(&mWorkers[i]->thread);
+    }
+}
+
+bool
+JobSystem::CanRun(jobPriority_t priority) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return mPendingJobs[priority] > 0 &&
+           (priority == JOB_PRIORITY_FRAME || mRunningSpeculativeJobs < std::max(mThreadCount - 1, 1u));
+}
+
+bool
+JobSystem::PopJob(uint32_t index, jobPriority_t priority, std::function<void(void)> *job)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < mThreadCount; ++i) {
+        Worker_t *worker = mWorkers[(index + i) % mThreadCount].get();
+        std::lock_guard<std::mutex> lock(worker->mutex);
+
+        std::deque<std::function<void(void)>> &jobs = worker->jobs[priority];
+        if(jobs.empty()) {
+            continue;
+        }
+
+        if(i == 0) {
+            *job = std::move(jobs.back());
+            jobs.pop_back();
+        } else {
+            *job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void
+JobSystem::WorkerLoop(uint32_t index)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    workerIndex = static_cast<int>(index);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while(true) {
+        mWorkCondition.wait(lock, [this] { return mStopping || CanRun(JOB_PRIORITY_FRAME) || CanRun(JOB_PRIORITY_SPECULATIVE); });
+
+        // a stopping system still runs what is left
+        const jobPriority_t priority = CanRun(JOB_PRIORITY_FRAME) ? JOB_PRIORITY_FRAME : JOB_PRIORITY_SPECULATIVE;
+        if(!CanRun(priority)) {
+            break;
+        }
+
+        // the count is taken before the job, so that each count taken finds one in some deque
+        --mPendingJobs[priority];
+        if(priority == JOB_PRIORITY_SPECULATIVE) {
+            ++mRunningSpeculativeJobs;
+        }
+        lock.unlock();
+
+        std::function<void(void)> job;
+        if(PopJob(index, priority, &job)) {
+            job();
+        }
+
+        lock.lock();
+        if(priority == JOB_PRIORITY_SPECULATIVE) {
+            --mRunningSpeculativeJobs;
+            if(mPendingJobs[JOB_PRIORITY_SPECULATIVE]) {
+                mWorkCondition.notify_one();
+            }
+        }
+    }
+}
+
+void
+JobSystem::Submit(jobPriority_t priority, const std::function<void(void)> &job)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mThreadCount) {
+        job();
+        return;
+    }
+
+    uint32_t index;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        StartWorkers();
+        index = (workerIndex >= 0) ? static_cast<uint32_t>(workerIndex) : mNextWorker++ % mThreadCount;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+        mWorkers[index]->jobs[priority].push_back(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mPendingJobs[priority];
+    }
+    mWorkCondition.notify_one();
+}
@@ -0,0 +1,93 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       jobSystem.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Bounded set of worker threads shared by all background work of the library
+ *
+ */
+
+#ifndef __JOBSYSTEM_H__
+#define __JOBSYSTEM_H__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/// Environment variable holding the number of worker threads, 0 runs every job on the thread submitting it
+#define GLOVE_JOB_THREADS_ENV                           "GLOVE_JOB_THREADS"
+
+/// Environment variable holding the mask of the cores the worker threads are pinned to, e.g. 0x0f
+#define GLOVE_JOB_AFFINITY_ENV                          "GLOVE_JOB_AFFINITY"
+
+/// Upper limit of the worker threads
+#define GLOVE_JOB_SYSTEM_MAX_THREADS                    8
+
+typedef enum {
+    /// waited for by the frame being recorded
+    JOB_PRIORITY_FRAME = 0,
+    /// only saves time later, run when no frame job is waiting and never on every worker at once
+    JOB_PRIORITY_SPECULATIVE,
+    JOB_PRIORITY_COUNT
+} jobPriority_t;
+
+class JobSystem final {
+private:
+    typedef struct Worker_t {
+        std::thread                                     thread;
+        std::mutex                                      mutex;
+        std::deque<std::function<void(void)>>           jobs[JOB_PRIORITY_COUNT];
+    } Worker_t;
+
+    std::vector<std::unique_ptr<Worker_t>>              mWorkers;
+    std::mutex                                          mMutex;
+    std::condition_variable                             mWorkCondition;
+
+    uint32_t                                            mThreadCount;
+    uint64_t                                            mAffinityMask;
+    uint32_t                                            mPendingJobs[JOB_PRIORITY_COUNT];
+    uint32_t                                            mRunningSpeculativeJobs;
+    uint32_t                                            mNextWorker;
+    bool                                                mStarted;
+    bool                                                mStopping;
+
+    void                                                StartWorkers(void);
+    void                                                WorkerLoop(uint32_t index);
+    bool                                                CanRun(jobPriority_t priority)          const;
+    bool                                                PopJob(uint32_t index, jobPriority_t priority, std::function<void(void)> *job);
+    void                                                SetAffinity(std::thread *thread)        const;
+
+public:
+// Constructor
+    JobSystem();
+
+// Destructor
+    ~JobSystem();
+
+// Submit Functions
+    void                                                Submit(jobPriority_t priority, const std::function<void(void)> &job);
+
+// Get Functions
+    uint32_t                                            GetThreadCount(void)                    const;
+    static JobSystem                                   *GetInstance(void);
+};
+
+#endif // __JOBSYSTEM_H__
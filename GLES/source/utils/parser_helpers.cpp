@@ -21,6 +21,7 @@
  *
  */
 
+#include <algorithm>
 #include <string>
 #include "parser_helpers.h"
 
@@ -28,6 +29,7 @@ const char *SAMPLER_TYPES[] =   { "sampler1D",
                                   "sampler2D",
                                   "sampler3D",
                                   "samplerCube",
+                                  "sampler2DShadow",
                                   "sampler2DRect",
                                   "sampler1DArray",
                                   "sampler2DArray",
@@ -47,7 +49,8 @@ const char *IMAGE_TYPES[] =     { "image1D",
                                   "imageCubeArray",
                                   "imageBuffer",
                                   "image2DMS",
-                                  "image2DMSArray" };
+                                  "image2DMSArray",
+                                  "subpassInput" };
 
 inline bool
 IsChar(char c)
@@ -171,3 +174,49 @@ ReplaceAll(string& hays, const string& from, const string& to)
         pos = hays.find(from, pos + to.size());
     }
 }
+
+void
+RemoveExtensionDirective(string& source, const string& extension)
+{
+    auto pos = FindToken(extension, source, 0);
+
+    while(pos != string::npos) {
+        auto lineStart = source.rfind('\n', pos);
+        lineStart = (lineStart == string::npos) ? 0 : lineStart + 1;
+        auto lineEnd = source.find('\n', pos);
+        lineEnd = (lineEnd == string::npos) ? source.size() : lineEnd;
+
+        // only the directive itself is removed, its line is kept so that line numbers do not change
+        auto directive = source.find("#extension", lineStart);
+        if(directive < pos) {
+            source.erase(lineStart, lineEnd - lineStart);
+            pos = lineStart;
+        } else {
+            pos += extension.size();
+        }
+
+        pos = FindToken(extension, source, pos);
+    }
+}
+
+void
+RemoveLayoutDeclaration(string& source, const string& qualifier)
+{
+    auto pos = FindToken(qualifier, source, 0);
+
+    while(pos != string::npos) {
+        // the declaration is the layout qualifier alone, from the layout keyword up to its semicolon
+        auto layout = source.rfind("layout", pos);
+        auto end    = source.find(';', pos);
+        if(layout == string::npos || end == string::npos || source.find(';', layout) < pos) {
+            pos = FindToken(qualifier, source, pos + qualifier.size());
+            continue;
+        }
+
+        // the lines it spans are kept, so that line numbers do not change
+        const size_t lines = static_cast<size_t>(std::count(source.begin() + layout, source.begin() + end, '\n'));
+        source.replace(layout, end + 1 - layout, string(lines, '\n'));
+
+        pos = FindToken(qualifier, source, layout);
+    }
+}
@@ -33,6 +33,8 @@
 using namespace std;
 
 void                    ReplaceAll(string& hays, const string& from, const string& to);
+void                    RemoveExtensionDirective(string& source, const string& extension);
+void                    RemoveLayoutDeclaration(string& source, const string& qualifier);
 bool                    IsChar(char c);
 bool                    IsWhiteSpace(char c);
 bool                    IsBuildInUniform(const string &source);
@@ -0,0 +1,176 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       stallDetector.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Attribution of every CPU wait on the GPU to the GL call and the reason it was made for
+ *
+ *  @section
+ *
+ *  When GLOVE_STALL_DETECTOR is set, each blocking fence wait and each queue
+ *  idle of the auxiliary submissions is recorded along with the GL call that
+ *  led to it and the reason it was needed. The outermost reason wins: a fence waited upon by a Finish that
+ *  glBindFramebuffer made counts as glBindFramebuffer / finish. A wait
+ *  longer than the threshold is reported as soon as it happens, and a
+ *  histogram of the waits per reason, followed by the GL calls that waited
+ *  longest, is printed when GLOVE shuts down.
+ *
+ */
+
+#include "stallDetector.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+typedef struct stallStats_t {
+    uint64_t                        count;
+    uint64_t                        total;
+    uint64_t                        longest;
+} stallStats_t;
+
+typedef std::pair<const char *, stallReason_e> stallKey_t;
+
+typedef struct stallState_t {
+    std::mutex                      mutex;
+    uint64_t                        threshold;
+    std::map<stallKey_t, stallStats_t> calls;
+    uint64_t                        histogram[STALL_REASON_COUNT][GLOVE_STALL_HISTOGRAM_BUCKETS];
+    bool                            reported;
+} stallState_t;
+
+std::atomic<int>                    StallDetector::mEnabled(-1);
+thread_local const char            *StallDetector::mGLCall = nullptr;
+thread_local stallReason_e          StallDetector::mReason = STALL_REASON_COUNT;
+
+static const char *reasonNames[STALL_REASON_COUNT] = { "fence", "aux submit", "finish", "frame ring", "frame pacing", "buffer readback",
+                                                       "query result", "texture update", "upload", "sync object", "teardown",
+                                                       "command bundle" };
+
+static stallState_t *
+GetStallState(void)
+{
+    static stallState_t *state = new stallState_t();
+    return state;
+}
+
+bool
+StallDetector::Initialize()
+{
+    stallState_t *state = GetStallState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    int enabled = mEnabled.load(std::memory_order_relaxed);
+    if(enabled >= 0) {
+        return enabled != 0;
+    }
+
+    const char *threshold = getenv(GLOVE_STALL_DETECTOR_ENV);
+    if(threshold == nullptr || threshold[0] == '\0') {
+        mEnabled.store(0, std::memory_order_relaxed);
+        return false;
+    }
+
+    state->threshold = strtoull(threshold, nullptr, 10) * 1000;
+    state->reported  = false;
+    for(uint32_t i = 0; i < STALL_REASON_COUNT; ++i) {
+        std::fill(state->histogram[i], state->histogram[i] + GLOVE_STALL_HISTOGRAM_BUCKETS, 0);
+    }
+    atexit(StallDetector::Report);
+
+    mEnabled.store(1, std::memory_order_relaxed);
+    return true;
+}
+
+void
+StallDetector::Record(stallReason_e reason, uint64_t nanoseconds)
+{
+    if(!IsEnabled()) {
+        return;
+    }
+
+    const stallReason_e cause = mReason != STALL_REASON_COUNT ? mReason : reason;
+    const char *glCall = mGLCall ? mGLCall : "(no GL call)";
+
+    uint32_t bucket = 0;
+    for(uint64_t us = nanoseconds / 1000; us && bucket < GLOVE_STALL_HISTOGRAM_BUCKETS - 1; us >>= 1) {
+        ++bucket;
+    }
+
+    stallState_t *state = GetStallState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    ++state->histogram[cause][bucket];
+
+    stallStats_t &stats = state->calls[stallKey_t(glCall, cause)];
+    ++stats.count;
+    stats.total  += nanoseconds;
+    stats.longest = std::max(stats.longest, nanoseconds);
+
+    if(nanoseconds >= state->threshold) {
+        fprintf(stderr, "GLOVE: %s waited %.3f ms on the GPU (%s)\n", glCall, static_cast<double>(nanoseconds) / 1e6, reasonNames[cause]);
+    }
+}
+
+void
+StallDetector::Report()
+{
+    if(mEnabled.load(std::memory_order_relaxed) <= 0) {
+        return;
+    }
+
+    stallState_t *state = GetStallState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if(state->reported) {
+        return;
+    }
+    state->reported = true;
+
+    fprintf(stderr, "GLOVE: waits on the GPU per reason, counted in buckets of less than 2^i us\n");
+    for(uint32_t i = 0; i < STALL_REASON_COUNT; ++i) {
+        uint32_t last = GLOVE_STALL_HISTOGRAM_BUCKETS;
+        while(last && state->histogram[i][last - 1] == 0) {
+            --last;
+        }
+        if(!last) {
+            continue;
+        }
+
+        fprintf(stderr, "  %-16s", reasonNames[i]);
+        for(uint32_t bucket = 0; bucket < last; ++bucket) {
+            fprintf(stderr, " %" PRIu64, state->histogram[i][bucket]);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    std::vector<std::pair<stallKey_t, stallStats_t>> calls(state->calls.begin(), state->calls.end());
+    std::sort(calls.begin(), calls.end(), [](const std::pair<stallKey_t, stallStats_t> &a, const std::pair<stallKey_t, stallStats_t> &b) {
+        return a.second.total > b.second.total;
+    });
+
+    fprintf(stderr, "GLOVE: GL calls that waited longest on the GPU\n");
+    for(uint32_t i = 0; i < calls.size() && i < GLOVE_STALL_TOP_CALLS; ++i) {
+        const stallStats_t &stats = calls[i].second;
+        fprintf(stderr, "  %-32s %-16s %8" PRIu64 " waits %10.3f ms total %8.3f ms longest\n",
+                calls[i].first.first, reasonNames[calls[i].first.second], stats.count,
+                static_cast<double>(stats.total) / 1e6, static_cast<double>(stats.longest) / 1e6);
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       stallDetector.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Attribution of every CPU wait on the GPU to the GL call and the reason it was made for
+ *
+ */
+
+#ifndef __STALLDETECTOR_H__
+#define __STALLDETECTOR_H__
+
+#include <atomic>
+#include <stdint.h>
+
+/// Environment variable holding the microseconds a wait may last before it is reported, the waits are not recorded when unset
+#define GLOVE_STALL_DETECTOR_ENV                        "GLOVE_STALL_DETECTOR"
+
+/// GL calls listed in the report, the ones that waited longest in total
+#define GLOVE_STALL_TOP_CALLS                           10
+
+/// Buckets of the histogram, bucket i counts the waits of less than 2^i microseconds
+#define GLOVE_STALL_HISTOGRAM_BUCKETS                   20
+
+#define STALL_CONCAT_HELPER(a, b)                       a##b
+#define STALL_CONCAT(a, b)                              STALL_CONCAT_HELPER(a, b)
+
+/// The waits of the rest of the enclosing scope are made for reason, unless an enclosing scope already gave one
+#define STALL_REASON(reason)                            StallReasonScope STALL_CONCAT(stallReason, __LINE__)(reason)
+
+/// The waits of the rest of the enclosing scope are made by the GL call name, a string that lives as long as the library
+#define STALL_GL_CALL(name)                             StallGLCallScope STALL_CONCAT(stallGLCall, __LINE__)(name)
+
+typedef enum {
+    STALL_REASON_FENCE         = 0,
+    STALL_REASON_AUX_SUBMIT,
+    STALL_REASON_FINISH,
+    STALL_REASON_FRAME_RING,
+    STALL_REASON_FRAME_PACING,
+    STALL_REASON_BUFFER_READBACK,
+    STALL_REASON_QUERY_RESULT,
+    STALL_REASON_TEXTURE_UPDATE,
+    STALL_REASON_UPLOAD,
+    STALL_REASON_SYNC_OBJECT,
+    STALL_REASON_TEARDOWN,
+    STALL_REASON_COMMAND_BUNDLE,
+    STALL_REASON_COUNT
+} stallReason_e;
+
+class StallDetector {
+    friend class StallReasonScope;
+    friend class StallGLCallScope;
+
+private:
+    /// -1 until the environment has been read, then whether the waits are recorded
+    static std::atomic<int>               mEnabled;
+    static thread_local const char       *mGLCall;
+    /// STALL_REASON_COUNT while no scope has given one
+    static thread_local stallReason_e     mReason;
+
+    static bool           Initialize();
+
+public:
+    static inline bool    IsEnabled()                   { int enabled = mEnabled.load(std::memory_order_relaxed); return enabled < 0 ? Initialize() : enabled != 0; }
+
+    /// reason is the one of the wait itself, given when no enclosing scope has one
+    static void           Record(stallReason_e reason, uint64_t nanoseconds);
+    static void           Report();
+};
+
+class StallReasonScope {
+private:
+    bool                  mOwner;
+
+public:
+    StallReasonScope(stallReason_e reason)
+    : mOwner(StallDetector::IsEnabled() && StallDetector::mReason == STALL_REASON_COUNT) { if(mOwner) { StallDetector::mReason = reason; } }
+
+    ~StallReasonScope()                                 { if(mOwner) { StallDetector::mReason = STALL_REASON_COUNT; } }
+};
+
+class StallGLCallScope {
+private:
+    const char           *mPrevious;
+
+public:
+    StallGLCallScope(const char *name)
+    : mPrevious(StallDetector::mGLCall)                 { if(StallDetector::IsEnabled()) { StallDetector::mGLCall = name; } }
+
+    ~StallGLCallScope()                                 { StallDetector::mGLCall = mPrevious; }
+};
+
+#endif //__STALLDETECTOR_H__
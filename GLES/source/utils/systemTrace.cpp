@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       systemTrace.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Debug marker groups forwarded as sections of the system trace (ATrace on Android)
+ *
+ *  @section
+ *
+ *  The groups of GL_EXT_debug_marker are shown next to the CPU work of the
+ *  application in systrace and Perfetto. The NDK tracing functions are looked
+ *  up at run time, so that the library still loads on releases without them.
+ *  Sections nest per thread, so they are begun and ended on the thread of the
+ *  application, and a pop only ends a section its push has begun: one pushed
+ *  while tracing was off, or with no push at all, ends nothing.
+ *
+ */
+
+#include "systemTrace.h"
+
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+#include <dlfcn.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef bool (*PFN_ATrace_isEnabled)(void);
+typedef void (*PFN_ATrace_beginSection)(const char *sectionName);
+typedef void (*PFN_ATrace_endSection)(void);
+
+typedef struct systemTraceFunctions_t {
+    PFN_ATrace_isEnabled            isEnabled;
+    PFN_ATrace_beginSection         beginSection;
+    PFN_ATrace_endSection           endSection;
+} systemTraceFunctions_t;
+
+static const systemTraceFunctions_t *
+GetFunctions(void)
+{
+    static systemTraceFunctions_t functions = { nullptr, nullptr, nullptr };
+    static std::once_flag         once;
+
+    std::call_once(once, []() {
+        void *library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+        if(library == nullptr) {
+            return;
+        }
+
+        functions.isEnabled    = reinterpret_cast<PFN_ATrace_isEnabled>(dlsym(library, "ATrace_isEnabled"));
+        functions.beginSection = reinterpret_cast<PFN_ATrace_beginSection>(dlsym(library, "ATrace_beginSection"));
+        functions.endSection   = reinterpret_cast<PFN_ATrace_endSection>(dlsym(library, "ATrace_endSection"));
+        if(!functions.isEnabled || !functions.beginSection || !functions.endSection) {
+            functions.isEnabled = nullptr;
+        }
+    });
+
+    return functions.isEnabled ? &functions : nullptr;
+}
+
+/// for each group pushed by the thread and not popped yet, whether it has begun a section
+static thread_local std::vector<bool> sectionsBegun;
+
+static inline std::string
+SectionName(GLsizei length, const char *name)
+{
+    if(name == nullptr) {
+        return std::string();
+    }
+
+    return length > 0 ? std::string(name, static_cast<size_t>(length)) : std::string(name);
+}
+
+void
+SystemTrace::BeginSection(GLsizei length, const char *name)
+{
+    const systemTraceFunctions_t *functions = GetFunctions();
+    const bool begun = functions && functions->isEnabled();
+    if(begun) {
+        functions->beginSection(SectionName(length, name).c_str());
+    }
+    sectionsBegun.push_back(begun);
+}
+
+void
+SystemTrace::EndSection()
+{
+    if(sectionsBegun.empty()) {
+        return;
+    }
+
+    const bool begun = sectionsBegun.back();
+    sectionsBegun.pop_back();
+    if(begun) {
+        GetFunctions()->endSection();
+    }
+}
+
+void
+SystemTrace::InsertMarker(GLsizei length, const char *name)
+{
+    // the trace has no instant events, an empty section shows where the marker was issued
+    const systemTraceFunctions_t *functions = GetFunctions();
+    if(functions && functions->isEnabled()) {
+        functions->beginSection(SectionName(length, name).c_str());
+        functions->endSection();
+    }
+}
+
+#else
+
+void
+SystemTrace::BeginSection(GLsizei length, const char *name)
+{
+    (void)length;
+    (void)name;
+}
+
+void
+SystemTrace::EndSection()
+{
+}
+
+void
+SystemTrace::InsertMarker(GLsizei length, const char *name)
+{
+    (void)length;
+    (void)name;
+}
+
+#endif // VK_USE_PLATFORM_ANDROID_KHR
@@ -0,0 +1,37 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       systemTrace.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Debug marker groups forwarded as sections of the system trace (ATrace on Android)
+ *
+ */
+
+#ifndef __SYSTEMTRACE_H__
+#define __SYSTEMTRACE_H__
+
+#include "GLES2/gl2.h"
+
+class SystemTrace {
+public:
+    /// a length of 0 means the name is null terminated
+    static void           BeginSection(GLsizei length, const char *name);
+    static void           EndSection();
+    static void           InsertMarker(GLsizei length, const char *name);
+};
+
+#endif //__SYSTEMTRACE_H__
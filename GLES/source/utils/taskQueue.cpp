@@ -0,0 +1,142 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       taskQueue.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Queue of independent tasks run in the background by the job system
+ *
+ *  @section
+ *
+ *  Tasks are taken in submission order by up to the maximum number of jobs
+ *  of the queue running on the job system at once, which are submitted as the
+ *  queue fills up and each run tasks until none is left. Every submission
+ *  returns a future that becomes ready once its task has run. A queue without
+ *  threads runs its tasks on the submitting thread. The queue runs every task
+ *  still pending before it is destroyed.
+ *
+ */
+
+#include <algorithm>
+#include "taskQueue.h"
+#include "utils/glLogger.h"
+
+TaskQueue::TaskQueue(jobPriority_t priority)
+: mPriority(priority), mMaxThreads(0), mRunningJobs(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mMaxThreads = std::min(JobSystem::GetInstance()->GetThreadCount(), static_cast<uint32_t>(GLOVE_TASK_QUEUE_MAX_THREADS));
+}
+
+TaskQueue::~TaskQueue()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the jobs still running drain what is left
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdleCondition.wait(lock, [this] { return mRunningJobs == 0; });
+}
+
+uint32_t
+TaskQueue::GetMaxThreads(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxThreads;
+}
+
+void
+TaskQueue::SetMaxThreads(uint32_t count)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // there is no point in running more tasks at once than the job system has threads
+    uint32_t jobs = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxThreads = std::min(std::min(count, static_cast<uint32_t>(GLOVE_TASK_QUEUE_MAX_THREADS)), JobSystem::GetInstance()->GetThreadCount());
+        while(mRunningJobs + jobs < mMaxThreads && jobs < mTasks.size()) {
+            ++jobs;
+        }
+        mRunningJobs += jobs;
+    }
+
+    for(uint32_t i = 0; i < jobs; ++i) {
+        JobSystem::GetInstance()->Submit(mPriority, [this] { RunTasks(); });
+    }
+}
+
+bool
+TaskQueue::IsDone(const std::shared_future<void> &done)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return !done.valid() || done.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void
+TaskQueue::RunTasks(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // jobs above a lowered limit end one at a time, the last one keeps draining what is already queued
+    while(!mTasks.empty() && mRunningJobs <= std::max(mMaxThreads, 1u)) {
+        std::function<void(void)> task = std::move(mTasks.front());
+        mTasks.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+
+    --mRunningJobs;
+    mIdleCondition.notify_all();
+}
+
+std::shared_future<void>
+TaskQueue::Submit(const std::function<void(void)> &task)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::shared_ptr<std::packaged_task<void(void)>> packagedTask = std::make_shared<std::packaged_task<void(void)>>(task);
+    std::shared_future<void> done = packagedTask->get_future().share();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if(!mMaxThreads) {
+        lock.unlock();
+        (*packagedTask)();
+        return done;
+    }
+
+    mTasks.emplace_back([packagedTask] { (*packagedTask)(); });
+
+    const bool startJob = mRunningJobs < mMaxThreads;
+    if(startJob) {
+        ++mRunningJobs;
+    }
+    lock.unlock();
+
+    if(startJob) {
+        JobSystem::GetInstance()->Submit(mPriority, [this] { RunTasks(); });
+    }
+
+    return done;
+}
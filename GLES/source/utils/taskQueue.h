@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       taskQueue.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Queue of independent tasks run in the background by the job system
+ *
+ */
+
+#ifndef __TASKQUEUE_H__
+#define __TASKQUEUE_H__
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include "jobSystem.h"
+
+/// Upper limit of the tasks of a queue run at once
+#define GLOVE_TASK_QUEUE_MAX_THREADS                    8
+
+class TaskQueue final {
+private:
+    std::deque<std::function<void(void)>>               mTasks;
+    std::mutex                                          mMutex;
+    std::condition_variable                             mIdleCondition;
+
+    jobPriority_t                                       mPriority;
+    uint32_t                                            mMaxThreads;
+    uint32_t                                            mRunningJobs;
+
+    void                                                RunTasks(void);
+
+public:
+// Constructor
+    TaskQueue(jobPriority_t priority = JOB_PRIORITY_FRAME);
+
+// Destructor
+    ~TaskQueue();
+
+// Submit Functions
+    std::shared_future<void>                            Submit(const std::function<void(void)> &task);
+
+// Get Functions
+    uint32_t                                            GetMaxThreads(void);
+    static bool                                         IsDone(const std::shared_future<void> &done);
+
+// Set Functions
+    void                                                SetMaxThreads(uint32_t count);
+};
+
+#endif // __TASKQUEUE_H__
@@ -0,0 +1,374 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       textureDecoder.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      CPU decoding of compressed texture formats the device cannot sample
+ *
+ *  @section
+ *
+ *  Compressed formats are handed to Vulkan as they are whenever the device
+ *  can sample them. Otherwise, the linear ETC1, ETC2 and S3TC formats are
+ *  decoded here into tightly packed RGBA8 texels, one 4x4 block at a time.
+ *  ETC blocks are stored big endian and S3TC blocks little endian.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "textureDecoder.h"
+#include "glLogger.h"
+
+#define BLOCK_DIM                                       4
+
+static const int etcModifierTable[8][2] = {
+    {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+    { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int etcDistanceTable[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int eacModifierTable[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+};
+
+static inline uint8_t
+Clamp255(int value)
+{
+    return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+}
+
+static inline uint64_t
+ReadBigEndian64(const uint8_t *src)
+{
+    uint64_t value = 0;
+    for(int i = 0; i < 8; ++i) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+static inline uint64_t
+ReadLittleEndian64(const uint8_t *src)
+{
+    uint64_t value = 0;
+    for(int i = 7; i >= 0; --i) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+static inline int
+Bits(uint64_t block, int high, int low)
+{
+    return static_cast<int>((block >> low) & ((1ull << (high - low + 1)) - 1));
+}
+
+static inline int
+Extend(int value, int bits)
+{
+    return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+static inline void
+SetColor(uint8_t *texel, int r, int g, int b, int a = 255)
+{
+    texel[0] = Clamp255(r);
+    texel[1] = Clamp255(g);
+    texel[2] = Clamp255(b);
+    texel[3] = Clamp255(a);
+}
+
+/// texels of a block are written in raster order, 4 bytes each
+static void
+DecodeEtc2ColorBlock(uint64_t block, bool punchthrough, uint8_t *texels)
+{
+    // without punchthrough alpha the bit selects the differential mode, otherwise it marks opaque blocks
+    const bool diffBit     = Bits(block, 33, 33) != 0;
+    const bool differential = punchthrough || diffBit;
+    const bool opaque      = !punchthrough || diffBit;
+    const int  msbs        = Bits(block, 31, 16);
+    const int  lsbs        = Bits(block, 15,  0);
+
+    int base[2][3];
+    if(differential) {
+        const int r = Bits(block, 63, 59), dr = (Bits(block, 58, 56) ^ 4) - 4;
+        const int g = Bits(block, 55, 51), dg = (Bits(block, 50, 48) ^ 4) - 4;
+        const int b = Bits(block, 47, 43), db = (Bits(block, 42, 40) ^ 4) - 4;
+
+        if(r + dr < 0 || r + dr > 31 || g + dg < 0 || g + dg > 31 || b + db < 0 || b + db > 31) {
+            int paint[4][3];
+            if(r + dr < 0 || r + dr > 31) {
+                // T mode
+                const int c1[3] = { Extend((Bits(block, 60, 59) << 2) | Bits(block, 57, 56), 4), Extend(Bits(block, 55, 52), 4), Extend(Bits(block, 51, 48), 4) };
+                const int c2[3] = { Extend(Bits(block, 47, 44), 4), Extend(Bits(block, 43, 40), 4), Extend(Bits(block, 39, 36), 4) };
+                const int d     = etcDistanceTable[(Bits(block, 35, 34) << 1) | Bits(block, 32, 32)];
+                for(int c = 0; c < 3; ++c) {
+                    paint[0][c] = c1[c];
+                    paint[1][c] = c2[c] + d;
+                    paint[2][c] = c2[c];
+                    paint[3][c] = c2[c] - d;
+                }
+            } else if(g + dg < 0 || g + dg > 31) {
+                // H mode
+                const int r1 = Bits(block, 62, 59), g1 = (Bits(block, 58, 56) << 1) | Bits(block, 52, 52), b1 = (Bits(block, 51, 51) << 3) | Bits(block, 49, 47);
+                const int r2 = Bits(block, 46, 43), g2 = Bits(block, 42, 39), b2 = Bits(block, 38, 35);
+                const int index = (Bits(block, 34, 34) << 2) | (Bits(block, 32, 32) << 1) |
+                                  (((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2) ? 1 : 0);
+                const int d     = etcDistanceTable[index];
+                const int c1[3] = { Extend(r1, 4), Extend(g1, 4), Extend(b1, 4) };
+                const int c2[3] = { Extend(r2, 4), Extend(g2, 4), Extend(b2, 4) };
+                for(int c = 0; c < 3; ++c) {
+                    paint[0][c] = c1[c] + d;
+                    paint[1][c] = c1[c] - d;
+                    paint[2][c] = c2[c] + d;
+                    paint[3][c] = c2[c] - d;
+                }
+            } else {
+                // planar mode, always opaque
+                const int o[3] = { Extend(Bits(block, 62, 57), 6),
+                                   Extend((Bits(block, 56, 56) << 6) | Bits(block, 54, 49), 7),
+                                   Extend((Bits(block, 48, 48) << 5) | (Bits(block, 44, 43) << 3) | Bits(block, 41, 39), 6) };
+                const int h[3] = { Extend((Bits(block, 38, 34) << 1) | Bits(block, 32, 32), 6),
+                                   Extend(Bits(block, 31, 25), 7),
+                                   Extend(Bits(block, 24, 19), 6) };
+                const int v[3] = { Extend(Bits(block, 18, 13), 6),
+                                   Extend(Bits(block, 12,  6), 7),
+                                   Extend(Bits(block,  5,  0), 6) };
+                for(int y = 0; y < BLOCK_DIM; ++y) {
+                    for(int x = 0; x < BLOCK_DIM; ++x) {
+                        uint8_t *texel = &texels[(y * BLOCK_DIM + x) * 4];
+                        SetColor(texel, (x * (h[0] - o[0]) + y * (v[0] - o[0]) + 4 * o[0] + 2) >> 2,
+                                        (x * (h[1] - o[1]) + y * (v[1] - o[1]) + 4 * o[1] + 2) >> 2,
+                                        (x * (h[2] - o[2]) + y * (v[2] - o[2]) + 4 * o[2] + 2) >> 2);
+                    }
+                }
+                return;
+            }
+
+            for(int y = 0; y < BLOCK_DIM; ++y) {
+                for(int x = 0; x < BLOCK_DIM; ++x) {
+                    const int i     = x * BLOCK_DIM + y;
+                    const int index = (((msbs >> i) & 1) << 1) | ((lsbs >> i) & 1);
+                    uint8_t *texel  = &texels[(y * BLOCK_DIM + x) * 4];
+                    if(!opaque && index == 2) {
+                        SetColor(texel, 0, 0, 0, 0);
+                    } else {
+                        SetColor(texel, paint[index][0], paint[index][1], paint[index][2]);
+                    }
+                }
+            }
+            return;
+        }
+
+        base[0][0] = Extend(r, 5);      base[1][0] = Extend(r + dr, 5);
+        base[0][1] = Extend(g, 5);      base[1][1] = Extend(g + dg, 5);
+        base[0][2] = Extend(b, 5);      base[1][2] = Extend(b + db, 5);
+    } else {
+        base[0][0] = Extend(Bits(block, 63, 60), 4);    base[1][0] = Extend(Bits(block, 59, 56), 4);
+        base[0][1] = Extend(Bits(block, 55, 52), 4);    base[1][1] = Extend(Bits(block, 51, 48), 4);
+        base[0][2] = Extend(Bits(block, 47, 44), 4);    base[1][2] = Extend(Bits(block, 43, 40), 4);
+    }
+
+    const int  table[2] = { Bits(block, 39, 37), Bits(block, 36, 34) };
+    const bool flip     = Bits(block, 32, 32) != 0;
+
+    for(int y = 0; y < BLOCK_DIM; ++y) {
+        for(int x = 0; x < BLOCK_DIM; ++x) {
+            const int i        = x * BLOCK_DIM + y;
+            const int msb      = (msbs >> i) & 1;
+            const int lsb      = (lsbs >> i) & 1;
+            const int subblock = flip ? (y >= 2) : (x >= 2);
+            uint8_t *texel     = &texels[(y * BLOCK_DIM + x) * 4];
+
+            if(!opaque && msb && !lsb) {
+                SetColor(texel, 0, 0, 0, 0);
+                continue;
+            }
+
+            int modifier = etcModifierTable[table[subblock]][lsb];
+            if(!opaque && !lsb) {
+                modifier = 0;
+            }
+            modifier = msb ? -modifier : modifier;
+
+            SetColor(texel, base[subblock][0] + modifier, base[subblock][1] + modifier, base[subblock][2] + modifier);
+        }
+    }
+}
+
+static void
+DecodeEacAlphaBlock(uint64_t block, uint8_t *texels)
+{
+    const int base       = Bits(block, 63, 56);
+    const int multiplier = Bits(block, 55, 52);
+    const int *modifiers = eacModifierTable[Bits(block, 51, 48)];
+
+    for(int y = 0; y < BLOCK_DIM; ++y) {
+        for(int x = 0; x < BLOCK_DIM; ++x) {
+            const int i = x * BLOCK_DIM + y;
+            texels[(y * BLOCK_DIM + x) * 4 + 3] = Clamp255(base + modifiers[Bits(block, 47 - 3 * i, 45 - 3 * i)] * multiplier);
+        }
+    }
+}
+
+static inline void
+Expand565(int color, int *rgb)
+{
+    rgb[0] = Extend((color >> 11) & 0x1f, 5);
+    rgb[1] = Extend((color >>  5) & 0x3f, 6);
+    rgb[2] = Extend( color        & 0x1f, 5);
+}
+
+static void
+DecodeS3tcColorBlock(uint64_t block, bool fourColorsOnly, bool punchthrough, uint8_t *texels)
+{
+    const int color0 = Bits(block, 15,  0);
+    const int color1 = Bits(block, 31, 16);
+
+    int palette[4][4];
+    Expand565(color0, palette[0]);
+    Expand565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    for(int c = 0; c < 3; ++c) {
+        if(fourColorsOnly || color0 > color1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    if(!fourColorsOnly && color0 <= color1 && punchthrough) {
+        palette[3][3] = 0;
+    }
+
+    for(int i = 0; i < BLOCK_DIM * BLOCK_DIM; ++i) {
+        const int *color = palette[Bits(block, 33 + 2 * i, 32 + 2 * i)];
+        SetColor(&texels[i * 4], color[0], color[1], color[2], color[3]);
+    }
+}
+
+static void
+DecodeS3tcExplicitAlphaBlock(uint64_t block, uint8_t *texels)
+{
+    for(int i = 0; i < BLOCK_DIM * BLOCK_DIM; ++i) {
+        texels[i * 4 + 3] = static_cast<uint8_t>(Bits(block, 4 * i + 3, 4 * i) * 17);
+    }
+}
+
+static void
+DecodeS3tcInterpolatedAlphaBlock(uint64_t block, uint8_t *texels)
+{
+    int alpha[8];
+    alpha[0] = Bits(block, 7, 0);
+    alpha[1] = Bits(block, 15, 8);
+    if(alpha[0] > alpha[1]) {
+        for(int i = 1; i < 7; ++i) {
+            alpha[i + 1] = ((7 - i) * alpha[0] + i * alpha[1]) / 7;
+        }
+    } else {
+        for(int i = 1; i < 5; ++i) {
+            alpha[i + 1] = ((5 - i) * alpha[0] + i * alpha[1]) / 5;
+        }
+        alpha[6] = 0;
+        alpha[7] = 255;
+    }
+
+    for(int i = 0; i < BLOCK_DIM * BLOCK_DIM; ++i) {
+        texels[i * 4 + 3] = static_cast<uint8_t>(alpha[Bits(block, 18 + 3 * i, 16 + 3 * i)]);
+    }
+}
+
+bool
+GlCompressedFormatIsDecodable(GLenum format)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // sRGB and single or dual channel formats have no RGBA8 equivalent to decode into
+    switch(format) {
+    case GL_ETC1_RGB8_OES:
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:          return true;
+    default:                                        return false;
+    }
+}
+
+bool
+DecodeCompressedImage(GLenum format, GLsizei width, GLsizei height, const void *srcData, uint8_t *dstData)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GLint blockWidth, blockHeight, blockBytes;
+    if(!GlCompressedFormatIsDecodable(format) ||
+       !GlCompressedFormatToBlockSize(format, &blockWidth, &blockHeight, &blockBytes)) {
+        return false;
+    }
+
+    const uint8_t *src = static_cast<const uint8_t *>(srcData);
+    uint8_t texels[BLOCK_DIM * BLOCK_DIM * 4];
+
+    for(GLsizei by = 0; by < height; by += BLOCK_DIM) {
+        for(GLsizei bx = 0; bx < width; bx += BLOCK_DIM, src += blockBytes) {
+            switch(format) {
+            case GL_ETC1_RGB8_OES:
+            case GL_COMPRESSED_RGB8_ETC2:                   DecodeEtc2ColorBlock(ReadBigEndian64(src), false, texels); break;
+            case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: DecodeEtc2ColorBlock(ReadBigEndian64(src), true, texels); break;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC:              DecodeEtc2ColorBlock(ReadBigEndian64(src + 8), false, texels);
+                                                            DecodeEacAlphaBlock(ReadBigEndian64(src), texels); break;
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:           DecodeS3tcColorBlock(ReadLittleEndian64(src), false, false, texels); break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:          DecodeS3tcColorBlock(ReadLittleEndian64(src), false, true, texels); break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:          DecodeS3tcColorBlock(ReadLittleEndian64(src + 8), true, false, texels);
+                                                            DecodeS3tcExplicitAlphaBlock(ReadLittleEndian64(src), texels); break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:          DecodeS3tcColorBlock(ReadLittleEndian64(src + 8), true, false, texels);
+                                                            DecodeS3tcInterpolatedAlphaBlock(ReadLittleEndian64(src), texels); break;
+            default: NOT_REACHED();                         return false;
+            }
+
+            // blocks at the right and bottom edges may hang over the image
+            const GLsizei rows    = std::min(height - by, static_cast<GLsizei>(BLOCK_DIM));
+            const GLsizei columns = std::min(width  - bx, static_cast<GLsizei>(BLOCK_DIM));
+            for(GLsizei y = 0; y < rows; ++y) {
+                memcpy(&dstData[((by + y) * width + bx) * 4], &texels[y * BLOCK_DIM * 4], columns * 4);
+            }
+        }
+    }
+
+    return true;
+}
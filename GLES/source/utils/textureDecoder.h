@@ -0,0 +1,32 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       textureDecoder.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      CPU decoding of compressed texture formats the device cannot sample
+ *
+ */
+
+#ifndef __TEXTUREDECODER_H__
+#define __TEXTUREDECODER_H__
+
+#include "glUtils.h"
+
+bool                    GlCompressedFormatIsDecodable(GLenum format);
+bool                    DecodeCompressedImage(GLenum format, GLsizei width, GLsizei height, const void *srcData, uint8_t *dstData);
+
+#endif // __TEXTUREDECODER_H__
@@ -0,0 +1,120 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       workerPool.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Small worker pool splitting CPU bound work into parallel slices
+ *
+ *  @section
+ *
+ *  A task is split into slices that are handed out one at a time to jobs of
+ *  the job system and to the calling thread, which blocks in Run until every
+ *  slice has completed. A job that starts once every slice has been taken
+ *  returns at once, so that the calling thread never waits for a job still
+ *  queued behind others.
+ *
+ */
+
+#include <algorithm>
+#include "workerPool.h"
+#include "jobSystem.h"
+#include "utils/glLogger.h"
+
+WorkerPool::WorkerPool()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+WorkerPool::~WorkerPool()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+WorkerPool *
+WorkerPool::GetInstance(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    static WorkerPool workerPool;
+    return &workerPool;
+}
+
+uint32_t
+WorkerPool::GetConcurrency(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    uint32_t threads = JobSystem::GetInstance()->GetThreadCount();
+    return std::min(threads, static_cast<uint32_t>(GLOVE_WORKER_POOL_MAX_THREADS)) + 1;
+}
+
+bool
+WorkerPool::RunSlice(Run_t *run, std::unique_lock<std::mutex> &lock)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(run->nextSlice >= run->sliceCount) {
+        return false;
+    }
+
+    uint32_t slice = run->nextSlice++;
+    const std::function<void(uint32_t)> *task = run->task;
+
+    lock.unlock();
+    (*task)(slice);
+    lock.lock();
+
+    if(--run->pendingSlices == 0) {
+        run->doneCondition.notify_all();
+    }
+
+    return true;
+}
+
+void
+WorkerPool::Run(uint32_t slices, const std::function<void(uint32_t)> &task)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(slices < 2 || GetConcurrency() < 2) {
+        for(uint32_t i = 0; i < slices; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::shared_ptr<Run_t> run = std::make_shared<Run_t>();
+    run->task          = &task;
+    run->sliceCount    = slices;
+    run->nextSlice     = 0;
+    run->pendingSlices = slices;
+
+    // one slice is left for the calling thread
+    const uint32_t jobs = std::min(slices, GetConcurrency()) - 1;
+    for(uint32_t i = 0; i < jobs; ++i) {
+        JobSystem::GetInstance()->Submit(JOB_PRIORITY_FRAME, [run] {
+            std::unique_lock<std::mutex> lock(run->mutex);
+            while(RunSlice(run.get(), lock));
+        });
+    }
+
+    // the calling thread works as well instead of waiting idle
+    std::unique_lock<std::mutex> lock(run->mutex);
+    while(RunSlice(run.get(), lock));
+
+    run->doneCondition.wait(lock, [&run] { return run->pendingSlices == 0; });
+}
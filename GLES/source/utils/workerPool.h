@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       workerPool.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Small worker pool splitting CPU bound work into parallel slices
+ *
+ */
+
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/// Upper limit of the worker threads, the calling thread always takes part as well
+#define GLOVE_WORKER_POOL_MAX_THREADS                   3
+
+class WorkerPool final {
+private:
+    /// the slices of a run, shared with the jobs that may still start after it has returned
+    typedef struct Run_t {
+        std::mutex                                      mutex;
+        std::condition_variable                         doneCondition;
+        const std::function<void(uint32_t)>            *task;
+        uint32_t                                        sliceCount;
+        uint32_t                                        nextSlice;
+        uint32_t                                        pendingSlices;
+    } Run_t;
+
+    static bool                                         RunSlice(Run_t *run, std::unique_lock<std::mutex> &lock);
+
+public:
+// Constructor
+    WorkerPool();
+
+// Destructor
+    ~WorkerPool();
+
+// Run Functions
+    void                                                Run(uint32_t slices, const std::function<void(uint32_t)> &task);
+
+// Get Functions
+    uint32_t                                            GetConcurrency(void);
+    static WorkerPool                                  *GetInstance(void);
+};
+
+#endif // __WORKERPOOL_H__
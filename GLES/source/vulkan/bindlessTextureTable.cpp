@@ -0,0 +1,273 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       bindlessTextureTable.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Table Of Texture Descriptors Indexed Per Draw Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Each context keeps a single descriptor set, bound once per command buffer,
+ *  with an array of descriptors per sampler type. A texture gets a slot of the
+ *  array the first time it is sampled, and programs are given the slot through
+ *  push constants, so switching textures writes and binds no descriptor set.
+ *  Slots are keyed by the generation of the texture, which changes along with
+ *  its image, so a slot never has to be rewritten while it may be read. Slots
+ *  of textures a frame did not sample are given back once that frame retires,
+ *  in the same way the descriptor pools are.
+ *
+ */
+
+#include "bindlessTextureTable.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+BindlessTextureTable::BindlessTextureTable(const vkContext_t *vkContext)
+: mVkContext(vkContext), mVkDescPool(VK_NULL_HANDLE), mVkDescSet(VK_NULL_HANDLE), mFailed(false), mSerial(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        mLastSlot[i] = 0;
+    }
+}
+
+BindlessTextureTable::~BindlessTextureTable()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+void
+BindlessTextureTable::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the set is freed along with its pool
+    if(mVkDescPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(mVkContext->vkDevice, mVkDescPool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+        mVkDescPool = VK_NULL_HANDLE;
+    }
+    mVkDescSet = VK_NULL_HANDLE;
+
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        mEntries[i].clear();
+        mFreeSlots[i].clear();
+        mPendingSlots[i].clear();
+        for(uint32_t frame = 0; frame < GLOVE_FRAMES_IN_FLIGHT; ++frame) {
+            mRetiredSlots[frame][i].clear();
+        }
+        mLastSlot[i] = 0;
+    }
+}
+
+bool
+BindlessTextureTable::Create(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mFailed || mVkContext->vkBindlessDescSetLayout == VK_NULL_HANDLE) {
+        return false;
+    }
+
+#ifdef VK_EXT_descriptor_indexing
+    VkDescriptorPoolSize poolSize;
+    poolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = GLOVE_BINDLESS_TEXTURE_BINDINGS * GLOVE_BINDLESS_TEXTURE_COUNT;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo;
+    memset(static_cast<void *>(&descriptorPoolInfo), 0, sizeof(descriptorPoolInfo));
+    descriptorPoolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext         = nullptr;
+    descriptorPoolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    descriptorPoolInfo.maxSets       = 1;
+    descriptorPoolInfo.poolSizeCount = 1;
+    descriptorPoolInfo.pPoolSizes    = &poolSize;
+
+    if(vkCreateDescriptorPool(mVkContext->vkDevice, &descriptorPoolInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &mVkDescPool) != VK_SUCCESS) {
+        mVkDescPool = VK_NULL_HANDLE;
+        mFailed     = true;
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo descAllocInfo;
+    memset(static_cast<void *>(&descAllocInfo), 0, sizeof(descAllocInfo));
+    descAllocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descAllocInfo.pNext              = nullptr;
+    descAllocInfo.descriptorPool     = mVkDescPool;
+    descAllocInfo.descriptorSetCount = 1;
+    descAllocInfo.pSetLayouts        = &mVkContext->vkBindlessDescSetLayout;
+
+    if(vkAllocateDescriptorSets(mVkContext->vkDevice, &descAllocInfo, &mVkDescSet) != VK_SUCCESS) {
+        Release();
+        mFailed = true;
+        return false;
+    }
+
+    // slots are handed out from the front of the arrays first
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        mFreeSlots[i].reserve(GLOVE_BINDLESS_TEXTURE_COUNT);
+        for(uint32_t slot = GLOVE_BINDLESS_TEXTURE_COUNT; slot > 0; --slot) {
+            mFreeSlots[i].push_back(slot - 1);
+        }
+    }
+
+    return true;
+#else
+    mFailed = true;
+    return false;
+#endif // VK_EXT_descriptor_indexing
+}
+
+uint32_t
+BindlessTextureTable::GetIndex(uint32_t binding, uint64_t key, const VkDescriptorImageInfo &info)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(binding < GLOVE_BINDLESS_TEXTURE_BINDINGS);
+
+    if(mVkDescSet == VK_NULL_HANDLE && !Create()) {
+        return 0;
+    }
+
+    std::unordered_map<uint64_t, Entry_t> &entries = mEntries[binding];
+    auto it = entries.find(key);
+    if(it != entries.end()) {
+        it->second.lastUsedSerial = mSerial;
+        if(it->second.info.sampler     == info.sampler   &&
+           it->second.info.imageView   == info.imageView &&
+           it->second.info.imageLayout == info.imageLayout) {
+            return it->second.slot;
+        }
+
+        // a changed sampler or layout takes a new slot, the frame being recorded may still read the old one
+        mPendingSlots[binding].push_back(it->second.slot);
+        entries.erase(it);
+    }
+
+    // a wrong texture is sampled rather than an unwritten slot, with this many textures in flight
+    if(mFreeSlots[binding].empty()) {
+        GLOVE_PRINT_ERR("Bindless texture table is full, %u textures per frame are sampled at most\n", GLOVE_BINDLESS_TEXTURE_COUNT);
+        return mLastSlot[binding];
+    }
+
+    Entry_t entry;
+    entry.info           = info;
+    entry.slot           = mFreeSlots[binding].back();
+    entry.lastUsedSerial = mSerial;
+    mFreeSlots[binding].pop_back();
+
+    // the slot is read by no pending command buffer, so it is written in place
+    VkWriteDescriptorSet write;
+    memset(static_cast<void *>(&write), 0, sizeof(write));
+    write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.pNext           = nullptr;
+    write.dstSet          = mVkDescSet;
+    write.dstBinding      = binding;
+    write.dstArrayElement = entry.slot;
+    write.descriptorCount = 1;
+    write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo      = &entry.info;
+    vkUpdateDescriptorSets(mVkContext->vkDevice, 1, &write, 0, nullptr);
+    mVkContext->perfCounters->Add(PERF_COUNTER_DESCRIPTOR_WRITES, 1);
+
+    mLastSlot[binding] = entry.slot;
+    entries[key] = entry;
+
+    return entry.slot;
+}
+
+void
+BindlessTextureTable::Evict(uint32_t binding)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // textures the frame being submitted did not sample were last read by an earlier frame
+    std::unordered_map<uint64_t, Entry_t> &entries = mEntries[binding];
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(it->second.lastUsedSerial < mSerial) {
+            mPendingSlots[binding].push_back(it->second.slot);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+BindlessTextureTable::FreeSlots(std::vector<uint32_t> *slots, uint32_t binding)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mFreeSlots[binding].insert(mFreeSlots[binding].end(), slots->begin(), slots->end());
+    slots->clear();
+}
+
+void
+BindlessTextureTable::SubmitFrame(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    if(mVkDescSet == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // slots are only reclaimed once the table runs short, so that textures keep theirs across frames
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        if(mFreeSlots[i].size() < GLOVE_BINDLESS_TEXTURE_COUNT / 2) {
+            Evict(i);
+        }
+        mRetiredSlots[frame][i].insert(mRetiredSlots[frame][i].end(), mPendingSlots[i].begin(), mPendingSlots[i].end());
+        mPendingSlots[i].clear();
+    }
+
+    ++mSerial;
+}
+
+void
+BindlessTextureTable::RetireFrame(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        FreeSlots(&mRetiredSlots[frame][i], i);
+    }
+}
+
+void
+BindlessTextureTable::RetireAll(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        for(uint32_t frame = 0; frame < GLOVE_FRAMES_IN_FLIGHT; ++frame) {
+            FreeSlots(&mRetiredSlots[frame][i], i);
+        }
+        FreeSlots(&mPendingSlots[i], i);
+    }
+
+    ++mSerial;
+}
+
+}
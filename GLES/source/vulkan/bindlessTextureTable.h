@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       bindlessTextureTable.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Table Of Texture Descriptors Indexed Per Draw Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKBINDLESSTEXTURETABLE_H__
+#define __VKBINDLESSTEXTURETABLE_H__
+
+#include <unordered_map>
+#include <vector>
+#include "context.h"
+#include "commandBufferManager.h"
+#include "utils/globals.h"
+
+namespace vulkanAPI {
+
+class BindlessTextureTable final {
+private:
+    typedef struct Entry_t {
+        VkDescriptorImageInfo           info;
+        uint32_t                        slot;
+        uint64_t                        lastUsedSerial;
+    } Entry_t;
+
+    const vkContext_t                  *mVkContext;
+
+    VkDescriptorPool                    mVkDescPool;
+    VkDescriptorSet                     mVkDescSet;
+    bool                                mFailed;
+
+    /// per binding, the slot of every texture generation sampled lately, the slots ready for reuse,
+    /// the ones the frame being recorded may still read, and the ones kept by each frame in flight
+    std::unordered_map<uint64_t, Entry_t> mEntries[GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    std::vector<uint32_t>               mFreeSlots[GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    std::vector<uint32_t>               mPendingSlots[GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    std::vector<uint32_t>               mRetiredSlots[GLOVE_FRAMES_IN_FLIGHT][GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    uint32_t                            mLastSlot[GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    uint64_t                            mSerial;
+
+    bool                                Create(void);
+    void                                Evict(uint32_t binding);
+    void                                FreeSlots(std::vector<uint32_t> *slots, uint32_t binding);
+
+public:
+// Constructor
+    BindlessTextureTable(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~BindlessTextureTable();
+
+// Release Functions
+    void                                Release(void);
+
+// Get Functions
+    uint32_t                            GetIndex(uint32_t binding, uint64_t key, const VkDescriptorImageInfo &info);
+    inline uint64_t                     GetSerial(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mSerial; }
+    inline const VkDescriptorSet       *GetVkDescSet(void)                        const { FUN_ENTRY(GL_LOG_TRACE); return &mVkDescSet; }
+
+// Submit Functions
+    void                                SubmitFrame(uint32_t frame);
+
+// Retire Functions
+    void                                RetireFrame(uint32_t frame);
+    void                                RetireAll(void);
+};
+
+}
+
+#endif // __VKBINDLESSTEXTURETABLE_H__
@@ -30,6 +30,7 @@
  */
 
 #include "buffer.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
@@ -55,7 +56,7 @@ Buffer::Release(void)
 
     mVkSize = 0;
     if(mVkBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(mVkContext->vkDevice, mVkBuffer, nullptr);
+        vkDestroyBuffer(mVkContext->vkDevice, mVkBuffer, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
         mVkBuffer = VK_NULL_HANDLE;
     }
 }
@@ -75,7 +76,16 @@ Buffer::Create(void)
     info.queueFamilyIndexCount = 0;
     info.pQueueFamilyIndices   = nullptr;
 
-    VkResult err = vkCreateBuffer(mVkContext->vkDevice, &info, nullptr, &mVkBuffer);
+    // buffers filled by the upload queue are shared with the graphics queue
+    // to avoid explicit queue family ownership transfers
+    uint32_t queueFamilyIndices[2] = {mVkContext->vkGraphicsQueueNodeIndex, mVkContext->vkTransferQueueNodeIndex};
+    if((mVkBufferUsageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && queueFamilyIndices[0] != queueFamilyIndices[1]) {
+        info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+        info.queueFamilyIndexCount = 2;
+        info.pQueueFamilyIndices   = queueFamilyIndices;
+    }
+
+    VkResult err = vkCreateBuffer(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkBuffer);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
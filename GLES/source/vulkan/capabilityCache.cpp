@@ -0,0 +1,248 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       capabilityCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Memoized Device Extension And Format Property Queries, Kept On Disk Between Processes
+ *
+ *  @section
+ *
+ *  The extensions and format features of a device only change along with its
+ *  driver, yet every process used to query them anew, and the same formats
+ *  again for every image. Each answer is queried once and kept for the life
+ *  of the device. When the pipeline cache has a path, the answers are also
+ *  written next to it, keyed by the identity of the device and driver like
+ *  the pipeline cache itself, so that later processes start without asking.
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "capabilityCache.h"
+#include "utils/atomicFileWriter.h"
+
+#define GLOVE_CAPABILITY_CACHE_FILE_MAGIC               0x50434c47  // "GLCP"
+#define GLOVE_CAPABILITY_CACHE_FILE_VERSION             1
+
+namespace vulkanAPI {
+
+CapabilityCache::CapabilityCache(const vkContext_t *vkContext)
+: mVkContext(vkContext), mDeviceExtensionsValid(false), mModified(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+CapabilityCache::~CapabilityCache()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+void
+CapabilityCache::InitFileHeader(FileHeader_t *header)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(mVkContext->vkPhysicalDevice, &properties);
+
+    memset(static_cast<void*>(header), 0, sizeof(FileHeader_t));
+    header->magic          = GLOVE_CAPABILITY_CACHE_FILE_MAGIC;
+    header->version        = GLOVE_CAPABILITY_CACHE_FILE_VERSION;
+    header->vendorID       = properties.vendorID;
+    header->deviceID       = properties.deviceID;
+    header->driverVersion  = properties.driverVersion;
+    header->extensionCount = static_cast<uint32_t>(mDeviceExtensions.size());
+    header->formatCount    = static_cast<uint32_t>(mFormatProperties.size());
+    memcpy(header->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+bool
+CapabilityCache::Load(const std::string &path)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if(file == nullptr) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    FileHeader_t fileHeader;
+    FileHeader_t deviceHeader;
+    InitFileHeader(&deviceHeader);
+
+    bool loaded = fread(&fileHeader, sizeof(FileHeader_t), 1, file) == 1 &&
+                  fileHeader.magic         == deviceHeader.magic            &&
+                  fileHeader.version       == deviceHeader.version          &&
+                  fileHeader.vendorID      == deviceHeader.vendorID         &&
+                  fileHeader.deviceID      == deviceHeader.deviceID         &&
+                  fileHeader.driverVersion == deviceHeader.driverVersion    &&
+                 !memcmp(fileHeader.pipelineCacheUUID, deviceHeader.pipelineCacheUUID, VK_UUID_SIZE);
+
+    std::vector<VkExtensionProperties> extensions(loaded ? fileHeader.extensionCount : 0);
+    std::vector<FormatEntry_t>         formats(loaded ? fileHeader.formatCount : 0);
+    loaded = loaded && fileHeader.extensionCount &&
+             fread(extensions.data(), sizeof(VkExtensionProperties), extensions.size(), file) == extensions.size() &&
+             fread(formats.data(), sizeof(FormatEntry_t), formats.size(), file) == formats.size();
+
+    fclose(file);
+
+    if(!loaded) {
+        return false;
+    }
+
+    mDeviceExtensions      = std::move(extensions);
+    mDeviceExtensionsValid = true;
+    for(const auto &entry : formats) {
+        mFormatProperties[static_cast<VkFormat>(entry.format)] = entry.properties;
+    }
+    mModified = false;
+
+    return true;
+}
+
+bool
+CapabilityCache::Save(const std::string &path)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(!mModified || !mDeviceExtensionsValid) {
+        return true;
+    }
+
+    FileHeader_t header;
+    InitFileHeader(&header);
+
+    std::vector<FormatEntry_t> formats;
+    formats.reserve(mFormatProperties.size());
+    for(const auto &format : mFormatProperties) {
+        FormatEntry_t entry;
+        entry.format     = static_cast<uint32_t>(format.first);
+        entry.properties = format.second;
+        formats.push_back(entry);
+    }
+
+    bool written = AtomicFileWriter::Write(path, [&](FILE *file) {
+        return fwrite(&header, sizeof(FileHeader_t), 1, file) == 1 &&
+               fwrite(mDeviceExtensions.data(), sizeof(VkExtensionProperties), mDeviceExtensions.size(), file) == mDeviceExtensions.size() &&
+               fwrite(formats.data(), sizeof(FormatEntry_t), formats.size(), file) == formats.size();
+    });
+    if(!written) {
+        return false;
+    }
+
+    mModified = false;
+
+    return true;
+}
+
+const std::vector<VkExtensionProperties> &
+CapabilityCache::GetDeviceExtensions(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(mDeviceExtensionsValid) {
+        return mDeviceExtensions;
+    }
+
+    VkResult res;
+    uint32_t extensionCount = 0;
+    do {
+        res = vkEnumerateDeviceExtensionProperties(mVkContext->vkPhysicalDevice, nullptr, &extensionCount, nullptr);
+        if(!extensionCount || res) {
+            mDeviceExtensions.clear();
+            break;
+        }
+
+        mDeviceExtensions.resize(extensionCount);
+        res = vkEnumerateDeviceExtensionProperties(mVkContext->vkPhysicalDevice, nullptr, &extensionCount, mDeviceExtensions.data());
+        mDeviceExtensions.resize(extensionCount);
+    } while(res == VK_INCOMPLETE);
+
+    mDeviceExtensionsValid = (res == VK_SUCCESS && !mDeviceExtensions.empty());
+    mModified             |= mDeviceExtensionsValid;
+
+    return mDeviceExtensions;
+}
+
+VkFormatProperties
+CapabilityCache::GetFormatProperties(VkFormat format)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mFormatProperties.find(format);
+    if(it != mFormatProperties.end()) {
+        return it->second;
+    }
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(mVkContext->vkPhysicalDevice, format, &properties);
+    mFormatProperties[format] = properties;
+    mModified = true;
+
+    return properties;
+}
+
+bool
+CapabilityCache::IsHostImageTransferSupported(VkFormat format, VkImageTiling tiling)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+#ifdef VK_EXT_host_image_copy
+    if(!mVkContext->mIsHostImageCopySupported || (tiling != VK_IMAGE_TILING_LINEAR && tiling != VK_IMAGE_TILING_OPTIMAL)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mHostImageTransferTilings.find(format);
+    if(it == mHostImageTransferTilings.end()) {
+        VkFormatProperties3KHR properties3;
+        memset(static_cast<void *>(&properties3), 0, sizeof(properties3));
+        properties3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3_KHR;
+
+        VkFormatProperties2KHR properties;
+        memset(static_cast<void *>(&properties), 0, sizeof(properties));
+        properties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2_KHR;
+        properties.pNext = &properties3;
+
+        mVkContext->fpGetPhysicalDeviceFormatProperties2KHR(mVkContext->vkPhysicalDevice, format, &properties);
+
+        uint32_t tilings = 0;
+        if(properties3.linearTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) {
+            tilings |= 1u << VK_IMAGE_TILING_LINEAR;
+        }
+        if(properties3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) {
+            tilings |= 1u << VK_IMAGE_TILING_OPTIMAL;
+        }
+        it = mHostImageTransferTilings.emplace(format, tilings).first;
+    }
+
+    return (it->second & (1u << tiling)) != 0;
+#else
+    return false;
+#endif // VK_EXT_host_image_copy
+}
+
+}
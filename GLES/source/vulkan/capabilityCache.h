@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       capabilityCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Memoized Device Extension And Format Property Queries, Kept On Disk Between Processes
+ *
+ */
+
+#ifndef __VKCAPABILITYCACHE_H__
+#define __VKCAPABILITYCACHE_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "context.h"
+
+namespace vulkanAPI {
+
+class CapabilityCache final {
+private:
+    /// the answers only hold for the device and driver they were given by
+    typedef struct FileHeader_t {
+        uint32_t                            magic;
+        uint32_t                            version;
+        uint32_t                            vendorID;
+        uint32_t                            deviceID;
+        uint32_t                            driverVersion;
+        uint8_t                             pipelineCacheUUID[VK_UUID_SIZE];
+        uint32_t                            extensionCount;
+        uint32_t                            formatCount;
+    } FileHeader_t;
+
+    typedef struct FormatEntry_t {
+        uint32_t                            format;
+        VkFormatProperties                  properties;
+    } FormatEntry_t;
+
+    const vkContext_t                      *mVkContext;
+
+    std::mutex                              mMutex;
+    std::vector<VkExtensionProperties>      mDeviceExtensions;
+    bool                                    mDeviceExtensionsValid;
+    std::map<VkFormat, VkFormatProperties>  mFormatProperties;
+    /// tilings each format can be written in by the host, queried through VK_EXT_host_image_copy and not kept on disk
+    std::map<VkFormat, uint32_t>            mHostImageTransferTilings;
+
+    /// entries were queried since the cache was loaded, so the file is out of date
+    bool                                    mModified;
+
+    void                                    InitFileHeader(FileHeader_t *header);
+
+public:
+// Constructor
+    CapabilityCache(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~CapabilityCache();
+
+// Load/Save Functions
+    bool                                    Load(const std::string &path);
+    bool                                    Save(const std::string &path);
+
+// Get Functions
+    const std::vector<VkExtensionProperties> &GetDeviceExtensions(void);
+    VkFormatProperties                      GetFormatProperties(VkFormat format);
+
+// Is Functions
+    bool                                    IsHostImageTransferSupported(VkFormat format, VkImageTiling tiling);
+};
+
+}
+
+#endif // __VKCAPABILITYCACHE_H__
@@ -29,27 +29,62 @@
  *  buffers, and which are not directly submitted to queues.
  *  Command buffers are represented by VkCommandBuffer.
  *
+ *  Each frame in flight owns a transient command pool for its primary command
+ *  buffer and one for the secondaries of every recording thread. Nothing is
+ *  reset individually: once the fence of a frame has signaled, its pools are
+ *  reset as a whole, and the threads recording into them never share a pool.
+ *
+ *  Every frame in flight also owns a query pool of timestamps and one of
+ *  occlusion queries, reset when the frame is begun and read once its fence is
+ *  seen signaled. The results are never waited for on their own: they arrive
+ *  along with the frame.
+ *
+ *  Where timeline semaphores are supported, the draw submissions signal a
+ *  counter with their serial, so whether a serial has completed is read
+ *  without waiting, and the frames are waited on for their serial instead of
+ *  through their fences. Uploads are waited on for the counter of the
+ *  transfer queue the same way.
+ *
  */
 
+#include <algorithm>
 #include "commandBufferManager.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+#include "utils/globals.h"
 
 namespace vulkanAPI {
 
 #define GLOVE_NO_BUFFER_TO_WAIT                         0x7FFFFFFF
-#define GLOVE_NUM_COMMAND_BUFFERS                       2
+#define GLOVE_NUM_COMMAND_BUFFERS                       GLOVE_FRAMES_IN_FLIGHT
 #define GLOVE_FENCE_WAIT_TIMEOUT                        UINT64_MAX
 
 CommandBufferManager::CommandBufferManager(const vkContext_t *context)
-: mVkContext(context)
+: mVkContext(context), mTimeline(context), mAuxTimeline(context)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
     mActiveCmdBuffer    = 0;
     mLastSubmittedBuffer= GLOVE_NO_BUFFER_TO_WAIT;
+    mSubmitSerial       = 1;
+    mCompletedSerial    = 0;
+    mFrameCount         = 0;
+    mPendingQueueBarrier = false;
+    mWindowSurface      = true;
+    mSyncItems          = nullptr;
+    memset(static_cast<void *>(mFrameSerials), 0, sizeof(mFrameSerials));
 
     mVkCmdPool          = VK_NULL_HANDLE;
     mVkAuxCommandBuffer = VK_NULL_HANDLE;
     mVkAuxFence         = VK_NULL_HANDLE;
+    mAuxSerial          = 0;
+    mVkAuxTimestampPool = VK_NULL_HANDLE;
+    mAuxTimestampsWritten = false;
+    mInRenderPass       = false;
+    mOpenOcclusionSlot  = 0;
+    mOpenOcclusionInRenderPass = false;
+    mUploadManager      = nullptr;
+    mRecordQueue        = nullptr;
 
     if(!AllocateVkCmdPool()) {
         assert(false);
@@ -61,22 +96,29 @@ CommandBufferManager::CommandBufferManager(const vkContext_t *context)
         return ;
     }
 
+    mUploadManager      = new UploadManager(mVkContext);
+    mRecordQueue        = new TaskQueue();
+    mRecordQueue->SetMaxThreads(std::min(mRecordQueue->GetMaxThreads(), static_cast<uint32_t>(GLOVE_SECONDARY_RECORDING_THREADS - 1)));
 }
 
 CommandBufferManager::~CommandBufferManager()
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
-    FreeResources();
+    delete mRecordQueue;
+    mRecordQueue = nullptr;
 
     if(mVkContext->vkDevice != VK_NULL_HANDLE ) {
 
         vkDeviceWaitIdle(mVkContext->vkDevice);
 
+        delete mUploadManager;
+        mUploadManager = nullptr;
+
         DestroyVkCmdBuffers();
 
         if(mVkCmdPool != VK_NULL_HANDLE) {
-            vkDestroyCommandPool(mVkContext->vkDevice, mVkCmdPool, nullptr);
+            vkDestroyCommandPool(mVkContext->vkDevice, mVkCmdPool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
             mVkCmdPool = VK_NULL_HANDLE;
         }
     }
@@ -90,27 +132,75 @@ CommandBufferManager::DestroyVkCmdBuffers(void)
     for(uint32_t i = 0; i < mVkCommandBuffers.fence.size(); ++i) {
         mVkCommandBuffers.fence[i].Release();
     }
-
-    vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, mVkCommandBuffers.commandBuffer.size(), mVkCommandBuffers.commandBuffer.data());
-    mVkCommandBuffers.commandBuffer.clear();
-    mVkCommandBuffers.commandBufferState.clear();
-    mVkCommandBuffers.fence.clear();
-    memset(static_cast<void *>(&mVkCommandBuffers), 0, mVkCommandBuffers.commandBuffer.size()*sizeof(State));
+    mTimeline.Release();
+    mAuxTimeline.Release();
 
     if(mVkAuxCommandBuffer != VK_NULL_HANDLE) {
         vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, 1, &mVkAuxCommandBuffer);
         mVkAuxCommandBuffer = VK_NULL_HANDLE;
     }
 
-    uint32_t secondaryBuffersPoolSize = mSecondaryCmdBufferPool.GetSize();
+    if(mVkAuxTimestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(mVkContext->vkDevice, mVkAuxTimestampPool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
+        mVkAuxTimestampPool = VK_NULL_HANDLE;
+    }
+
+    for(uint32_t i = 0; i < mVkCommandBuffers.timestampPool.size(); ++i) {
+        // the queries still pending belong to frames that never complete
+        ResolveQueries(i, false);
 
-    for(uint32_t i = 0; i < secondaryBuffersPoolSize; ++i) {
-        VkCommandBuffer *removingSecondaryBuffer = mSecondaryCmdBufferPool.RemoveBuffer();
-        if(removingSecondaryBuffer) {
-            vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, 1, removingSecondaryBuffer);
-            delete removingSecondaryBuffer;
+        if(mVkCommandBuffers.timestampPool[i] != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(mVkContext->vkDevice, mVkCommandBuffers.timestampPool[i], mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
+        }
+
+        if(mVkCommandBuffers.occlusionPool[i] != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(mVkContext->vkDevice, mVkCommandBuffers.occlusionPool[i], mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
         }
     }
+
+    // destroying a pool frees the command buffers allocated from it
+    for(uint32_t f = 0; f < mVkCommandBuffers.secondaryCmdBufferPool.size(); ++f) {
+        for(uint32_t t = 0; t < mVkCommandBuffers.secondaryCmdBufferPool[f].size(); ++t) {
+            CommandBufferPool &secondaryCmdBufferPool = mVkCommandBuffers.secondaryCmdBufferPool[f][t];
+            uint32_t secondaryBuffersPoolSize = secondaryCmdBufferPool.GetSize();
+
+            for(uint32_t i = 0; i < secondaryBuffersPoolSize; ++i) {
+                delete secondaryCmdBufferPool.RemoveBuffer();
+            }
+
+            if(mVkCommandBuffers.secondaryCmdPool[f][t] != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(mVkContext->vkDevice, mVkCommandBuffers.secondaryCmdPool[f][t], mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
+            }
+        }
+    }
+
+    for(auto commandPool : mVkCommandBuffers.commandPool) {
+        if(commandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(mVkContext->vkDevice, commandPool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
+        }
+    }
+
+    mVkCommandBuffers.commandBuffer.clear();
+    mVkCommandBuffers.commandBufferState.clear();
+    mVkCommandBuffers.fence.clear();
+    mVkCommandBuffers.serial.clear();
+    mVkCommandBuffers.commandPool.clear();
+    mVkCommandBuffers.secondaryCmdPool.clear();
+    mVkCommandBuffers.secondaryCmdBufferPool.clear();
+    mVkCommandBuffers.timestampPool.clear();
+    mVkCommandBuffers.timestamps.clear();
+    mVkCommandBuffers.renderPassQueries.clear();
+    mVkCommandBuffers.occlusionPool.clear();
+    mVkCommandBuffers.occlusionQueries.clear();
+    mRenderPassBegin      = nullptr;
+    mRenderPassEnd        = nullptr;
+    mInRenderPass         = false;
+    mActiveOcclusionQuery = nullptr;
+    mOpenOcclusionQuery   = nullptr;
+    mPendingDebugLabels.clear();
+
+    mActiveCmdBuffer     = 0;
+    mLastSubmittedBuffer = GLOVE_NO_BUFFER_TO_WAIT;
 }
 
 void
@@ -120,11 +210,15 @@ CommandBufferManager::Release(void)
 }
 
 VkCommandBuffer *
-CommandBufferManager::AllocateVkSecondaryCmdBuffers(uint32_t numOfBuffers)
+CommandBufferManager::AllocateVkSecondaryCmdBuffers(uint32_t numOfBuffers, uint32_t thread)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkCommandBuffer *reusedCommandBuffer = mSecondaryCmdBufferPool.BindNextAvailableBuffer();
+    assert(thread < GLOVE_SECONDARY_RECORDING_THREADS);
+
+    // only the given thread allocates from its pool, so no lock is taken
+    CommandBufferPool &secondaryCmdBufferPool = mVkCommandBuffers.secondaryCmdBufferPool[mActiveCmdBuffer][thread];
+    VkCommandBuffer *reusedCommandBuffer = secondaryCmdBufferPool.BindNextAvailableBuffer();
 
     if(nullptr != reusedCommandBuffer) {
         return reusedCommandBuffer;
@@ -136,7 +230,7 @@ CommandBufferManager::AllocateVkSecondaryCmdBuffers(uint32_t numOfBuffers)
     VkCommandBufferAllocateInfo cmdAllocInfo;
     cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     cmdAllocInfo.pNext              = nullptr;
-    cmdAllocInfo.commandPool        = mVkCmdPool;
+    cmdAllocInfo.commandPool        = mVkCommandBuffers.secondaryCmdPool[mActiveCmdBuffer][thread];
     cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
     cmdAllocInfo.commandBufferCount = numOfBuffers;
 
@@ -144,22 +238,123 @@ CommandBufferManager::AllocateVkSecondaryCmdBuffers(uint32_t numOfBuffers)
     assert(!err);
 
     if(err != VK_SUCCESS) {
+        delete commandBuffers;
         return nullptr;
     }
 
-    mSecondaryCmdBufferPool.AddBuffer(commandBuffers);
+    secondaryCmdBufferPool.AddBuffer(commandBuffers);
+    mVkContext->perfCounters->Add(PERF_COUNTER_SECONDARY_CMD_BUFFERS_ALLOCATED, numOfBuffers);
 
     return commandBuffers;
 }
 
+bool
+CommandBufferManager::AllocateVkBundleCmdBuffer(VkCommandBuffer *cmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // bundles outlive the frames, so their buffers come from the pool whose buffers are reset one by one
+    VkCommandBufferAllocateInfo cmdAllocInfo;
+    cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext              = nullptr;
+    cmdAllocInfo.commandPool        = mVkCmdPool;
+    cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    if(vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, cmdBuffer) != VK_SUCCESS) {
+        *cmdBuffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    mVkContext->perfCounters->Add(PERF_COUNTER_SECONDARY_CMD_BUFFERS_ALLOCATED);
+
+    return true;
+}
+
+void
+CommandBufferManager::FreeVkBundleCmdBuffer(VkCommandBuffer cmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(cmdBuffer != VK_NULL_HANDLE) {
+        vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, 1, &cmdBuffer);
+    }
+}
+
+void
+CommandBufferManager::FlushUploads(SubmitSemaphores_t *pSems, SubmitStageFlags_t *pFlags, TimelineSubmitInfo *timelineInfo, UploadSubmit_t *upload)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // pending host to device copies must land before anything in this submission reads them.
+    // when they can, they go into the same vkQueueSubmit, as the submit info before it
+    uint64_t uploadValue = 0;
+    VkSemaphore uploadSemaphore = VK_NULL_HANDLE;
+    upload->commandBuffer = mUploadManager->EndVkUploadCommandBuffer(&uploadSemaphore, &uploadValue);
+    if(upload->commandBuffer != VK_NULL_HANDLE) {
+        upload->semaphore = uploadSemaphore;
+        upload->timelineInfo.AddSignal(uploadValue);
+
+        upload->submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        upload->submitInfo.pNext                = upload->timelineInfo.Chain(nullptr);
+        upload->submitInfo.waitSemaphoreCount   = 0;
+        upload->submitInfo.pWaitSemaphores      = nullptr;
+        upload->submitInfo.pWaitDstStageMask    = nullptr;
+        upload->submitInfo.commandBufferCount   = 1;
+        upload->submitInfo.pCommandBuffers      = &upload->commandBuffer;
+        upload->submitInfo.signalSemaphoreCount = 1;
+        upload->submitInfo.pSignalSemaphores    = &upload->semaphore;
+    } else {
+        uploadSemaphore = mUploadManager->SubmitVkUploadCommandBuffer(&uploadValue);
+    }
+
+    if(uploadSemaphore != VK_NULL_HANDLE) {
+        pSems->push_back(uploadSemaphore);
+        pFlags->push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        timelineInfo->AddWait(uploadValue);
+    }
+}
+
+VkResult
+CommandBufferManager::QueueSubmit(UploadSubmit_t *upload, const VkSubmitInfo *submitInfo, VkFence fence)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the caller holds the queue mutex
+    VkSubmitInfo submitInfos[2];
+    uint32_t count = 0;
+    if(upload->commandBuffer != VK_NULL_HANDLE) {
+        submitInfos[count++] = upload->submitInfo;
+    }
+    submitInfos[count++] = *submitInfo;
+
+    VkResult err = vkQueueSubmit(mVkContext->vkQueue, count, submitInfos, fence);
+    assert(!err);
+    mVkContext->perfCounters->Add(PERF_COUNTER_QUEUE_SUBMITS);
+
+    if(err == VK_SUCCESS && upload->commandBuffer != VK_NULL_HANDLE) {
+        mUploadManager->SetVkUploadCommandBufferSubmitted();
+    }
+
+    return err;
+}
+
 void
-CommandBufferManager::FreeResources(void)
+CommandBufferManager::FreeResources(uint32_t index)
 {
-    mSecondaryCmdBufferPool.UnbindAllBuffers();
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the frame is not executing any more, so all its command buffers go back to the initial state at once
+    vkResetCommandPool(mVkContext->vkDevice, mVkCommandBuffers.commandPool[index], 0);
+
+    for(uint32_t t = 0; t < GLOVE_SECONDARY_RECORDING_THREADS; ++t) {
+        mVkCommandBuffers.secondaryCmdBufferPool[index][t].UnbindAllBuffers();
+        vkResetCommandPool(mVkContext->vkDevice, mVkCommandBuffers.secondaryCmdPool[index][t], 0);
+    }
 }
 
 bool
-CommandBufferManager::AllocateVkCmdPool(void)
+CommandBufferManager::CreateVkCmdPool(VkCommandPoolCreateFlags flags, VkCommandPool *cmdPool)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -167,19 +362,141 @@ CommandBufferManager::AllocateVkCmdPool(void)
     memset(static_cast<void *>(&cmdPoolInfo), 0 ,sizeof(cmdPoolInfo));
     cmdPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     cmdPoolInfo.pNext            = nullptr;
-    cmdPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolInfo.flags            = flags;
     cmdPoolInfo.queueFamilyIndex = mVkContext->vkGraphicsQueueNodeIndex;
 
-    VkResult err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, nullptr, &mVkCmdPool);
+    VkResult err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS), cmdPool);
     assert(!err);
 
     if(err != VK_SUCCESS) {
+        *cmdPool = VK_NULL_HANDLE;
         return false;
     }
 
     return true;
 }
 
+bool
+CommandBufferManager::CreateVkQueryPool(VkQueryType queryType, uint32_t queryCount, VkQueryPool *queryPool)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkQueryPoolCreateInfo queryPoolInfo;
+    memset(static_cast<void *>(&queryPoolInfo), 0 ,sizeof(queryPoolInfo));
+    queryPoolInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.pNext              = nullptr;
+    queryPoolInfo.flags              = 0;
+    queryPoolInfo.queryType          = queryType;
+    queryPoolInfo.queryCount         = queryCount;
+    queryPoolInfo.pipelineStatistics = 0;
+
+    VkResult err = vkCreateQueryPool(mVkContext->vkDevice, &queryPoolInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS), queryPool);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        *queryPool = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t
+CommandBufferManager::TicksToNanoseconds(uint64_t ticks) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return static_cast<uint64_t>(static_cast<double>(ticks) * mVkContext->vkTimestampPeriod);
+}
+
+void
+CommandBufferManager::ResolveQueries(uint32_t index, bool executed)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    ResolveTimestamps(index, executed);
+    ResolveOcclusionQueries(index, executed);
+}
+
+void
+CommandBufferManager::ResolveOcclusionQueries(uint32_t index, bool executed)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::vector<std::shared_ptr<OcclusionQuery_t>> &occlusionQueries = mVkCommandBuffers.occlusionQueries[index];
+    if(occlusionQueries.empty()) {
+        return;
+    }
+
+    // only the samples of a frame that executed are read, the others count as none
+    uint64_t results[GLOVE_MAX_OCCLUSION_QUERIES_PER_FRAME];
+    memset(static_cast<void *>(results), 0, sizeof(results));
+
+    const uint32_t queryCount = static_cast<uint32_t>(occlusionQueries.size());
+    if(executed) {
+        vkGetQueryPoolResults(mVkContext->vkDevice, mVkCommandBuffers.occlusionPool[index], 0, queryCount,
+                              sizeof(results), results, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    }
+
+    for(uint32_t i = 0; i < queryCount; ++i) {
+        occlusionQueries[i]->anySamplesPassed |= results[i] != 0;
+        --occlusionQueries[i]->pendingQueries;
+    }
+
+    occlusionQueries.clear();
+}
+
+void
+CommandBufferManager::ResolveTimestamps(uint32_t index, bool executed)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::vector<std::shared_ptr<Timestamp_t>> &timestamps = mVkCommandBuffers.timestamps[index];
+    if(timestamps.empty()) {
+        return;
+    }
+
+    // only the queries written are read, the ones beyond the pool and those of a frame never executed are zero
+    uint64_t results[GLOVE_MAX_TIMESTAMPS_PER_FRAME];
+    memset(static_cast<void *>(results), 0, sizeof(results));
+
+    const uint32_t queryCount = std::min(static_cast<uint32_t>(timestamps.size()), static_cast<uint32_t>(GLOVE_MAX_TIMESTAMPS_PER_FRAME));
+    if(executed) {
+        vkGetQueryPoolResults(mVkContext->vkDevice, mVkCommandBuffers.timestampPool[index], 0, queryCount,
+                              sizeof(results), results, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    }
+
+    const uint64_t mask = mVkContext->vkTimestampValidBits >= 64 ? UINT64_MAX : (1ull << mVkContext->vkTimestampValidBits) - 1;
+    for(uint32_t i = 0; i < timestamps.size(); ++i) {
+        timestamps[i]->ticks     = i < queryCount ? results[i] & mask : 0;
+        timestamps[i]->available = true;
+    }
+
+    uint64_t renderPassTicks = 0;
+    for(const auto &queries : mVkCommandBuffers.renderPassQueries[index]) {
+        renderPassTicks += (timestamps[queries.second]->ticks - timestamps[queries.first]->ticks) & mask;
+        if(executed) {
+            ChromeTrace::AddGpuSpan("render pass", TicksToNanoseconds(timestamps[queries.first]->ticks),
+                                                   TicksToNanoseconds(timestamps[queries.second]->ticks));
+        }
+    }
+    if(renderPassTicks) {
+        mVkContext->perfCounters->Add(PERF_COUNTER_RENDER_PASS_GPU_NS, TicksToNanoseconds(renderPassTicks));
+    }
+
+    timestamps.clear();
+    mVkCommandBuffers.renderPassQueries[index].clear();
+}
+
+bool
+CommandBufferManager::AllocateVkCmdPool(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the auxiliary command buffer is reset on its own, whenever it is begun again
+    return CreateVkCmdPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, &mVkCmdPool);
+}
+
 bool
 CommandBufferManager::AllocateVkCmdBuffers(void)
 {
@@ -188,22 +505,52 @@ CommandBufferManager::AllocateVkCmdBuffers(void)
     mVkCommandBuffers.commandBuffer.resize(GLOVE_NUM_COMMAND_BUFFERS);
     mVkCommandBuffers.commandBufferState.resize(GLOVE_NUM_COMMAND_BUFFERS);
     mVkCommandBuffers.fence.resize(GLOVE_NUM_COMMAND_BUFFERS);
+    mVkCommandBuffers.serial.resize(GLOVE_NUM_COMMAND_BUFFERS, 0);
+    mVkCommandBuffers.commandPool.resize(GLOVE_NUM_COMMAND_BUFFERS);
+    mVkCommandBuffers.secondaryCmdPool.resize(GLOVE_NUM_COMMAND_BUFFERS, std::vector<VkCommandPool>(GLOVE_SECONDARY_RECORDING_THREADS));
+    mVkCommandBuffers.secondaryCmdBufferPool.resize(GLOVE_NUM_COMMAND_BUFFERS, std::vector<CommandBufferPool>(GLOVE_SECONDARY_RECORDING_THREADS));
+    mVkCommandBuffers.timestampPool.resize(GLOVE_NUM_COMMAND_BUFFERS, VK_NULL_HANDLE);
+    mVkCommandBuffers.timestamps.resize(GLOVE_NUM_COMMAND_BUFFERS);
+    mVkCommandBuffers.renderPassQueries.resize(GLOVE_NUM_COMMAND_BUFFERS);
+    mVkCommandBuffers.occlusionPool.resize(GLOVE_NUM_COMMAND_BUFFERS, VK_NULL_HANDLE);
+    mVkCommandBuffers.occlusionQueries.resize(GLOVE_NUM_COMMAND_BUFFERS);
 
     VkCommandBufferAllocateInfo cmdAllocInfo;
     cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     cmdAllocInfo.pNext              = nullptr;
-    cmdAllocInfo.commandPool        = mVkCmdPool;
     cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cmdAllocInfo.commandBufferCount = GLOVE_NUM_COMMAND_BUFFERS;
+    cmdAllocInfo.commandBufferCount = 1;
 
-    VkResult err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, mVkCommandBuffers.commandBuffer.data());
-    assert(!err);
+    VkResult err;
+    for(uint32_t i = 0; i < GLOVE_NUM_COMMAND_BUFFERS; ++i) {
+        if(!CreateVkCmdPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, &mVkCommandBuffers.commandPool[i])) {
+            return false;
+        }
 
-    if(err != VK_SUCCESS) {
-        return false;
+        for(uint32_t t = 0; t < GLOVE_SECONDARY_RECORDING_THREADS; ++t) {
+            if(!CreateVkCmdPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, &mVkCommandBuffers.secondaryCmdPool[i][t])) {
+                return false;
+            }
+        }
+
+        if(IsTimestampSupported() && !CreateVkQueryPool(VK_QUERY_TYPE_TIMESTAMP, GLOVE_MAX_TIMESTAMPS_PER_FRAME, &mVkCommandBuffers.timestampPool[i])) {
+            return false;
+        }
+
+        if(!CreateVkQueryPool(VK_QUERY_TYPE_OCCLUSION, GLOVE_MAX_OCCLUSION_QUERIES_PER_FRAME, &mVkCommandBuffers.occlusionPool[i])) {
+            return false;
+        }
+
+        cmdAllocInfo.commandPool = mVkCommandBuffers.commandPool[i];
+        err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, &mVkCommandBuffers.commandBuffer[i]);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
     }
 
-    cmdAllocInfo.commandBufferCount = 1;
+    cmdAllocInfo.commandPool = mVkCmdPool;
     err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, &mVkAuxCommandBuffer);
     assert(!err);
 
@@ -211,6 +558,10 @@ CommandBufferManager::AllocateVkCmdBuffers(void)
         return false;
     }
 
+    if(IsTimestampSupported() && !CreateVkQueryPool(VK_QUERY_TYPE_TIMESTAMP, 2, &mVkAuxTimestampPool)) {
+        return false;
+    }
+
     for(uint32_t i = 0; i < GLOVE_NUM_COMMAND_BUFFERS; ++i) {
         mVkCommandBuffers.commandBufferState[i] = CMD_BUFFER_INITIAL_STATE;
 
@@ -220,6 +571,12 @@ CommandBufferManager::AllocateVkCmdBuffers(void)
         }
     }
 
+    // without the counters the frames are tracked through their fences, and the auxiliary work by waiting for the queue
+    if(mVkContext->mIsTimelineSemaphoreSupported && (!mTimeline.Create() || !mAuxTimeline.Create())) {
+        mTimeline.Release();
+        mAuxTimeline.Release();
+    }
+
     return true;
 }
 
@@ -232,6 +589,18 @@ CommandBufferManager::BeginVkDrawCommandBuffer(void)
         return true;
     }
 
+    // the ring has wrapped around to a frame that the GPU may still be executing
+    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_SUBMITED_STATE) {
+        WaitVkDrawCommandBuffer(mActiveCmdBuffer);
+    }
+
+    // the pools of the frame do not reset single command buffers, a frame ended but never submitted is reset along with them
+    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_EXECUTABLE_STATE) {
+        ResolveQueries(mActiveCmdBuffer, false);
+        FreeResources(mActiveCmdBuffer);
+        mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_INITIAL_STATE;
+    }
+
     VkCommandBufferBeginInfo info;
     info.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     info.pNext            = nullptr;
@@ -247,28 +616,67 @@ CommandBufferManager::BeginVkDrawCommandBuffer(void)
 
     mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_RECORDING_STATE;
 
+    if(mVkCommandBuffers.timestampPool[mActiveCmdBuffer] != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], mVkCommandBuffers.timestampPool[mActiveCmdBuffer],
+                            0, GLOVE_MAX_TIMESTAMPS_PER_FRAME);
+    }
+
+    vkCmdResetQueryPool(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], mVkCommandBuffers.occlusionPool[mActiveCmdBuffer],
+                        0, GLOVE_MAX_OCCLUSION_QUERIES_PER_FRAME);
+
+    if(mPendingQueueBarrier) {
+        RecordQueueBarrier(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer]);
+        mPendingQueueBarrier = false;
+    }
+
+    RecordPendingVkDebugLabels();
+
     return true;
 }
 
+void
+CommandBufferManager::RecordQueueBarrier(VkCommandBuffer cmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the first synchronization scope of a pipeline barrier covers every command
+    // submitted earlier to the same queue, so it also orders against other contexts
+    VkMemoryBarrier memoryBarrier;
+    memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.pNext         = nullptr;
+    memoryBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
 bool
-CommandBufferManager::BeginVkSecondaryCommandBuffer(const VkCommandBuffer *cmdBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer)
+CommandBufferManager::BeginVkSecondaryCommandBuffer(const VkCommandBuffer *cmdBuffer, const RenderPass *renderPass, VkFramebuffer framebuffer,
+                                                    VkCommandBufferUsageFlags usage)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     VkCommandBufferInheritanceInfo inheritanceInfo;
     inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
     inheritanceInfo.pNext = nullptr;
-    inheritanceInfo.renderPass = renderPass;
+#ifdef VK_KHR_dynamic_rendering
+    // passes begun dynamically are continued through their formats instead of a render pass object
+    VkCommandBufferInheritanceRenderingInfoKHR inheritanceRenderingInfo;
+    VkFormat                                   inheritanceColorFormat;
+    inheritanceInfo.pNext = renderPass->ChainInheritanceRendering(&inheritanceRenderingInfo, &inheritanceColorFormat, nullptr);
+#endif // VK_KHR_dynamic_rendering
+    inheritanceInfo.renderPass = *renderPass->GetRenderPass();
     inheritanceInfo.subpass = 0;
     inheritanceInfo.framebuffer = framebuffer;
-    inheritanceInfo.occlusionQueryEnable = VK_FALSE;
+    inheritanceInfo.occlusionQueryEnable = mVkContext->mIsInheritedQueriesSupported ? VK_TRUE : VK_FALSE;
     inheritanceInfo.queryFlags = 0;
     inheritanceInfo.pipelineStatistics = 0;
 
     VkCommandBufferBeginInfo cmdBeginInfo;
     cmdBeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmdBeginInfo.pNext            = nullptr;
-    cmdBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    cmdBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | usage;
     cmdBeginInfo.pInheritanceInfo = &inheritanceInfo;
 
     VkResult err = vkBeginCommandBuffer(*cmdBuffer, &cmdBeginInfo);
@@ -286,8 +694,7 @@ CommandBufferManager::EndVkDrawCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_EXECUTABLE_STATE ||
-       mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_INITIAL_STATE) {
+    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] != CMD_BUFFER_RECORDING_STATE) {
         return;
     }
 
@@ -304,42 +711,112 @@ CommandBufferManager::EndVkSecondaryCommandBuffer(const VkCommandBuffer *cmdBuff
     vkEndCommandBuffer(*cmdBuffer);
 }
 
+bool
+CommandBufferManager::RecordVkSecondaryCommandBuffers(const RenderPass *renderPass, VkFramebuffer framebuffer, uint32_t count,
+                                                      const std::function<void(VkCommandBuffer cmdBuffer, uint32_t index)> &record)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    count = std::min(count, static_cast<uint32_t>(GLOVE_SECONDARY_RECORDING_THREADS));
+
+    // the secondary command buffer with index i is recorded from the pool of thread i
+    std::vector<VkCommandBuffer> cmdBuffers(count);
+    auto recordSecondary = [this, renderPass, framebuffer, &record, &cmdBuffers](uint32_t index) {
+        VkCommandBuffer *cmdBuffer = AllocateVkSecondaryCmdBuffers(1, index);
+        if(cmdBuffer == nullptr || !BeginVkSecondaryCommandBuffer(cmdBuffer, renderPass, framebuffer)) {
+            return;
+        }
+
+        record(*cmdBuffer, index);
+        EndVkSecondaryCommandBuffer(cmdBuffer);
+        cmdBuffers[index] = *cmdBuffer;
+    };
+
+    std::vector<std::shared_future<void>> done;
+    for(uint32_t i = 1; i < count; ++i) {
+        done.push_back(mRecordQueue->Submit(std::bind(recordSecondary, i)));
+    }
+    recordSecondary(0);
+
+    for(auto &recorded : done) {
+        recorded.wait();
+    }
+
+    for(auto cmdBuffer : cmdBuffers) {
+        if(cmdBuffer == VK_NULL_HANDLE) {
+            return false;
+        }
+    }
+
+    // the work is executed in the order it was split in, whichever thread finished first
+    vkCmdExecuteCommands(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], count, cmdBuffers.data());
+
+    return true;
+}
+
 bool
 CommandBufferManager::SubmitVkDrawCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_INITIAL_STATE) {
+    if(mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] != CMD_BUFFER_EXECUTABLE_STATE) {
         return true;
     }
 
-    vector<VkSemaphore> pSems;
-    vector<VkPipelineStageFlags> pFlags;
-    if(mVkContext->vkSyncItems->acquireSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkAcquireSemaphore);
+    SubmitSemaphores_t pSems;
+    SubmitStageFlags_t pFlags;
+    TimelineSubmitInfo timelineInfo;
+    UploadSubmit_t upload;
+    FlushUploads(&pSems, &pFlags, &timelineInfo, &upload);
+
+    // the swapchain semaphores are shared with the other contexts, only the ones drawing
+    // to a window surface take part in the acquire, draw and present chain
+    std::lock_guard<std::mutex> lock(mVkContext->vkQueueMutex);
+    const bool windowSurface = mWindowSurface;
+    vkSyncItems_t *syncItems = mSyncItems ? mSyncItems : mVkContext->vkSyncItems;
+    if(windowSurface && syncItems->acquireSemaphoreFlag) {
+        pSems.push_back(syncItems->vkAcquireSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        timelineInfo.AddWait(0);
     }
-    if(mVkContext->vkSyncItems->drawSemaphoreFlag) {
-        pSems.push_back(mVkContext->vkSyncItems->vkDrawSemaphore);
+    if(windowSurface && syncItems->drawSemaphoreFlag) {
+        pSems.push_back(syncItems->vkDrawSemaphore);
         pFlags.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        timelineInfo.AddWait(0);
+    }
+
+    SubmitSemaphores_t signalSems;
+    if(windowSurface) {
+        signalSems.push_back(syncItems->vkDrawSemaphore);
+        timelineInfo.AddSignal(0);
+    }
+    const bool timeline = mTimeline.IsCreated();
+    if(timeline) {
+        signalSems.push_back(mTimeline.GetSemaphore());
+        timelineInfo.AddSignal(mSubmitSerial);
     }
 
     VkSubmitInfo submitInfo;
     submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext                = nullptr;
+    submitInfo.pNext                = timelineInfo.Chain(nullptr);
     submitInfo.commandBufferCount   = 1;
     submitInfo.pCommandBuffers      = &mVkCommandBuffers.commandBuffer[mActiveCmdBuffer];
     submitInfo.waitSemaphoreCount   = static_cast<uint32_t>(pSems.size());
     submitInfo.pWaitSemaphores      = pSems.data();
     submitInfo.pWaitDstStageMask    = pFlags.data();
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores    = &mVkContext->vkSyncItems->vkDrawSemaphore;
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSems.size());
+    submitInfo.pSignalSemaphores    = signalSems.data();
 
-    mVkContext->vkSyncItems->drawSemaphoreFlag    = true;
-    mVkContext->vkSyncItems->acquireSemaphoreFlag = false;
+    if(windowSurface) {
+        syncItems->drawSemaphoreFlag    = true;
+        syncItems->acquireSemaphoreFlag = false;
+    }
 
-    VkResult err = vkQueueSubmit(mVkContext->vkQueue, 1, &submitInfo, mVkCommandBuffers.fence[mActiveCmdBuffer].GetFence());
-    assert(!err);
+    VkResult err;
+    {
+        CHROME_TRACE_SPAN("vkQueueSubmit", "vulkan");
+        err = QueueSubmit(&upload, &submitInfo, timeline ? VK_NULL_HANDLE : mVkCommandBuffers.fence[mActiveCmdBuffer].GetFence());
+    }
 
     if(err != VK_SUCCESS) {
         return false;
@@ -348,35 +825,374 @@ CommandBufferManager::SubmitVkDrawCommandBuffer(void)
     mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_SUBMITED_STATE;
 
     mLastSubmittedBuffer = mActiveCmdBuffer;
+    mVkCommandBuffers.serial[mActiveCmdBuffer] = mSubmitSerial++;
 
+    // the next frame slot keeps its submitted state until it is waited upon,
+    // so the CPU only blocks when it wraps around to a frame still in flight
     mActiveCmdBuffer = (mActiveCmdBuffer + 1) % GLOVE_NUM_COMMAND_BUFFERS;
 
-    mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] = CMD_BUFFER_INITIAL_STATE;
-
     return true;
 }
 
 bool
-CommandBufferManager::WaitLastSubmition(void)
+CommandBufferManager::WaitVkDrawCommandBuffer(uint32_t index)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mLastSubmittedBuffer != GLOVE_NO_BUFFER_TO_WAIT) {
+    if(mVkCommandBuffers.commandBufferState[index] != CMD_BUFFER_SUBMITED_STATE) {
+        return false;
+    }
 
-        if(!mVkCommandBuffers.fence[mLastSubmittedBuffer].Wait(VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT))
+    if(mTimeline.IsCreated()) {
+        CHROME_TRACE_SPAN("timeline wait", "vulkan");
+        if(!mTimeline.Wait(mVkCommandBuffers.serial[index], GLOVE_FENCE_WAIT_TIMEOUT)) {
             return false;
+        }
+    } else {
+        {
+            CHROME_TRACE_SPAN("fence wait", "vulkan");
+            if(!mVkCommandBuffers.fence[index].Wait(VK_TRUE, GLOVE_FENCE_WAIT_TIMEOUT)) {
+                return false;
+            }
+        }
 
-        if(!mVkCommandBuffers.fence[mLastSubmittedBuffer].Reset()) {
+        if(!mVkCommandBuffers.fence[index].Reset()) {
             return false;
         }
+    }
+
+    ResolveQueries(index, true);
+    FreeResources(index);
 
-        FreeResources();
+    mVkCommandBuffers.commandBufferState[index] = CMD_BUFFER_INITIAL_STATE;
+    mCompletedSerial = std::max(mCompletedSerial, mVkCommandBuffers.serial[index]);
 
+    if(mLastSubmittedBuffer == static_cast<int32_t>(index)) {
         mLastSubmittedBuffer = GLOVE_NO_BUFFER_TO_WAIT;
+    }
+
+    return true;
+}
+
+bool
+CommandBufferManager::WaitLastSubmition(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // retire every frame in flight, starting from the oldest one
+    bool waited = false;
+    for(uint32_t i = 1; i <= GLOVE_NUM_COMMAND_BUFFERS; ++i) {
+        uint32_t index = (mActiveCmdBuffer + i) % GLOVE_NUM_COMMAND_BUFFERS;
+        waited |= WaitVkDrawCommandBuffer(index);
+    }
+
+    return waited;
+}
+
+bool
+CommandBufferManager::WaitVkSerial(uint64_t serial)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // retire the frames in flight, oldest first, up to the one submitted with the serial
+    for(uint32_t i = 1; i <= GLOVE_NUM_COMMAND_BUFFERS && mCompletedSerial < serial; ++i) {
+        uint32_t index = (mActiveCmdBuffer + i) % GLOVE_NUM_COMMAND_BUFFERS;
+        if(mVkCommandBuffers.commandBufferState[index] == CMD_BUFFER_SUBMITED_STATE &&
+           mVkCommandBuffers.serial[index] <= serial) {
+            WaitVkDrawCommandBuffer(index);
+        }
+    }
+
+    return mCompletedSerial >= serial;
+}
+
+void
+CommandBufferManager::PollVkQueries(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the frames whose fence has already signaled hand over their query results without a wait,
+    // they are retired as usual once the ring comes back to them
+    for(uint32_t i = 1; i <= GLOVE_NUM_COMMAND_BUFFERS; ++i) {
+        uint32_t index = (mActiveCmdBuffer + i) % GLOVE_NUM_COMMAND_BUFFERS;
+        if(mVkCommandBuffers.commandBufferState[index] == CMD_BUFFER_SUBMITED_STATE &&
+           (!mVkCommandBuffers.timestamps[index].empty() || !mVkCommandBuffers.occlusionQueries[index].empty()) &&
+           IsVkDrawCommandBufferCompleted(index)) {
+            ResolveQueries(index, true);
+        }
+    }
+}
+
+bool
+CommandBufferManager::IsVkDrawCommandBufferCompleted(uint32_t index)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mTimeline.IsCreated()) {
+        return mTimeline.IsCompleted(mVkCommandBuffers.serial[index]);
+    }
+
+    return mVkCommandBuffers.fence[index].WaitFor(0) == VK_SUCCESS;
+}
+
+uint64_t
+CommandBufferManager::UpdateCompletedSerial(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the counter is read without a wait, the frames it has passed are retired once the ring comes back to them
+    if(mTimeline.IsCreated()) {
+        mCompletedSerial = std::max(mCompletedSerial, mTimeline.GetCompletedValue());
+    }
+
+    return mCompletedSerial;
+}
+
+std::shared_ptr<Timestamp_t>
+CommandBufferManager::WriteVkTimestamp(VkPipelineStageFlagBits stage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(IsActiveCommandBufferRecording());
+
+    std::shared_ptr<Timestamp_t> timestamp = std::make_shared<Timestamp_t>();
+    timestamp->ticks     = 0;
+    timestamp->serial    = mSubmitSerial;
+    timestamp->available = false;
+
+    std::vector<std::shared_ptr<Timestamp_t>> &timestamps = mVkCommandBuffers.timestamps[mActiveCmdBuffer];
+    const uint32_t query = static_cast<uint32_t>(timestamps.size());
+    timestamps.push_back(timestamp);
+
+    if(query < GLOVE_MAX_TIMESTAMPS_PER_FRAME && mVkCommandBuffers.timestampPool[mActiveCmdBuffer] != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], stage,
+                            mVkCommandBuffers.timestampPool[mActiveCmdBuffer], query);
+    }
+
+    return timestamp;
+}
+
+void
+CommandBufferManager::BeginVkRenderPassTimestamps(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsTimestampSupported()) {
+        return;
+    }
+
+    // the end timestamp is handed out already while the render pass is recorded, and written when it ends
+    mRenderPassBegin = WriteVkTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+    mRenderPassEnd = std::make_shared<Timestamp_t>();
+    mRenderPassEnd->ticks     = 0;
+    mRenderPassEnd->serial    = mSubmitSerial;
+    mRenderPassEnd->available = false;
+}
+
+void
+CommandBufferManager::EndVkRenderPassTimestamps(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mRenderPassEnd == nullptr) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<Timestamp_t>> &timestamps = mVkCommandBuffers.timestamps[mActiveCmdBuffer];
+    const uint32_t beginQuery = static_cast<uint32_t>(std::find(timestamps.begin(), timestamps.end(), mRenderPassBegin) - timestamps.begin());
+    const uint32_t endQuery   = static_cast<uint32_t>(timestamps.size());
+
+    timestamps.push_back(mRenderPassEnd);
+    if(endQuery < GLOVE_MAX_TIMESTAMPS_PER_FRAME && mVkCommandBuffers.timestampPool[mActiveCmdBuffer] != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            mVkCommandBuffers.timestampPool[mActiveCmdBuffer], endQuery);
+    }
+
+    if(beginQuery < endQuery) {
+        mVkCommandBuffers.renderPassQueries[mActiveCmdBuffer].push_back(std::make_pair(beginQuery, endQuery));
+    }
+
+    mRenderPassBegin = nullptr;
+    mRenderPassEnd   = nullptr;
+}
+
+void
+CommandBufferManager::BeginVkOcclusionQuerySlot(bool inRenderPass)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a query that cannot be counted passes, so that nothing visible is ever culled
+    std::vector<std::shared_ptr<OcclusionQuery_t>> &occlusionQueries = mVkCommandBuffers.occlusionQueries[mActiveCmdBuffer];
+    if(mOpenOcclusionQuery != nullptr || occlusionQueries.size() >= GLOVE_MAX_OCCLUSION_QUERIES_PER_FRAME ||
+       (GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS && (inRenderPass || !mVkContext->mIsInheritedQueriesSupported))) {
+        mActiveOcclusionQuery->anySamplesPassed = true;
+        return;
+    }
+
+    mOpenOcclusionSlot         = static_cast<uint32_t>(occlusionQueries.size());
+    mOpenOcclusionInRenderPass = inRenderPass;
+    mOpenOcclusionQuery        = mActiveOcclusionQuery;
+    occlusionQueries.push_back(mOpenOcclusionQuery);
+
+    ++mOpenOcclusionQuery->pendingQueries;
+    mOpenOcclusionQuery->serial = mSubmitSerial;
+
+    vkCmdBeginQuery(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], mVkCommandBuffers.occlusionPool[mActiveCmdBuffer], mOpenOcclusionSlot, 0);
+}
+
+void
+CommandBufferManager::EndVkOcclusionQuerySlot(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vkCmdEndQuery(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], mVkCommandBuffers.occlusionPool[mActiveCmdBuffer], mOpenOcclusionSlot);
+    mOpenOcclusionQuery = nullptr;
+}
+
+std::shared_ptr<OcclusionQuery_t>
+CommandBufferManager::BeginVkOcclusionQuery(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mActiveOcclusionQuery = std::make_shared<OcclusionQuery_t>();
+    mActiveOcclusionQuery->pendingQueries   = 0;
+    mActiveOcclusionQuery->serial           = mSubmitSerial;
+    mActiveOcclusionQuery->anySamplesPassed = false;
+
+    // draws happen only inside render passes, the following ones begin their own Vulkan query
+    if(mInRenderPass) {
+        BeginVkOcclusionQuerySlot(true);
+    }
+
+    return mActiveOcclusionQuery;
+}
+
+void
+CommandBufferManager::EndVkOcclusionQuery(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mActiveOcclusionQuery == nullptr) {
+        return;
+    }
+
+    // a Vulkan query begun before the render pass can only end after it, counting a few more draws
+    if(mOpenOcclusionQuery == mActiveOcclusionQuery && (mOpenOcclusionInRenderPass || !mInRenderPass)) {
+        EndVkOcclusionQuerySlot();
+    }
+
+    mActiveOcclusionQuery = nullptr;
+}
+
+void
+CommandBufferManager::BeginVkRenderPassQueries(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    BeginVkRenderPassTimestamps();
+
+    if(mActiveOcclusionQuery != nullptr) {
+        BeginVkOcclusionQuerySlot(false);
+    }
+
+    mInRenderPass = true;
+}
+
+void
+CommandBufferManager::EndVkRenderPassQueries(bool renderPassEnded)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mOpenOcclusionQuery != nullptr && mOpenOcclusionInRenderPass != renderPassEnded) {
+        EndVkOcclusionQuerySlot();
+    }
+
+    if(renderPassEnded) {
+        EndVkRenderPassTimestamps();
+        mInRenderPass = false;
+        RecordPendingVkDebugLabels();
+    }
+}
+
+void
+CommandBufferManager::AddVkDebugLabel(debugLabelOp_t op, const char *name)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a render pass begun for secondary command buffers takes no other commands, while the primary one
+    // may open a label in a command buffer and close it in a later one
+    if(IsActiveCommandBufferRecording() && !(mInRenderPass && GLOVE_RECORD_SECONDARY_COMMAND_BUFFERS)) {
+        RecordVkDebugLabel(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], op, name);
+        return;
+    }
+
+    DebugLabel_t label;
+    label.op   = op;
+    label.name = name ? name : "";
+    mPendingDebugLabels.push_back(std::move(label));
+}
+
+void
+CommandBufferManager::RecordPendingVkDebugLabels(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(const auto &label : mPendingDebugLabels) {
+        RecordVkDebugLabel(mVkCommandBuffers.commandBuffer[mActiveCmdBuffer], label.op, label.name.c_str());
+    }
+    mPendingDebugLabels.clear();
+}
+
+void
+CommandBufferManager::RecordVkDebugLabel(VkCommandBuffer cmdBuffer, debugLabelOp_t op, const char *name) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_EXT_debug_utils
+    if(!mVkContext->mIsDebugUtilsSupported) {
+        return;
+    }
+
+    if(op == DEBUG_LABEL_END) {
+        mVkContext->fpCmdEndDebugUtilsLabelEXT(cmdBuffer);
+        return;
+    }
+
+    VkDebugUtilsLabelEXT label;
+    memset(static_cast<void *>(&label), 0, sizeof(label));
+    label.sType      = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+    label.pLabelName = name;
+
+    if(op == DEBUG_LABEL_BEGIN) {
+        mVkContext->fpCmdBeginDebugUtilsLabelEXT(cmdBuffer, &label);
+    } else {
+        mVkContext->fpCmdInsertDebugUtilsLabelEXT(cmdBuffer, &label);
+    }
+#else
+    (void)cmdBuffer;
+    (void)op;
+    (void)name;
+#endif // VK_EXT_debug_utils
+}
+
+bool
+CommandBufferManager::PaceFrames(uint32_t maxFramesInFlight)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mFrameSerials[mFrameCount % GLOVE_FRAMES_IN_FLIGHT] = mSubmitSerial - 1;
+    ++mFrameCount;
+
+    // the next frame counts as in flight as soon as it is recorded, so with a single frame
+    // in flight the one just submitted has to complete before the CPU moves on
+    uint32_t maxFrames = std::min(std::max(maxFramesInFlight, 1u), static_cast<uint32_t>(GLOVE_FRAMES_IN_FLIGHT));
+    if(mFrameCount < maxFrames) {
         return true;
     }
 
-    return false;
+    STALL_REASON(STALL_REASON_FRAME_PACING);
+    return WaitVkSerial(mFrameSerials[(mFrameCount - maxFrames) % GLOVE_FRAMES_IN_FLIGHT]);
 }
 
 bool
@@ -393,6 +1209,18 @@ CommandBufferManager::BeginVkAuxCommandBuffer(void)
     VkResult err = vkBeginCommandBuffer(mVkAuxCommandBuffer, &info);
     assert(!err);
 
+    // the auxiliary work is waited for anyway, so the time between its two timestamps costs nothing to read
+    mAuxTimestampsWritten = false;
+    if(err == VK_SUCCESS && mVkAuxTimestampPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(mVkAuxCommandBuffer, mVkAuxTimestampPool, 0, 2);
+        vkCmdWriteTimestamp(mVkAuxCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mVkAuxTimestampPool, 0);
+    }
+
+    // the upload or copy may read what the other contexts wrote, the barrier stays pending for the draws
+    if(err == VK_SUCCESS && mPendingQueueBarrier) {
+        RecordQueueBarrier(mVkAuxCommandBuffer);
+    }
+
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
 }
 
@@ -401,6 +1229,10 @@ CommandBufferManager::EndVkAuxCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mVkAuxTimestampPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(mVkAuxCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mVkAuxTimestampPool, 1);
+    }
+
     VkResult err = vkEndCommandBuffer(mVkAuxCommandBuffer);
     assert(!err);
 
@@ -412,26 +1244,117 @@ CommandBufferManager::SubmitVkAuxCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    SubmitSemaphores_t pSems;
+    SubmitStageFlags_t pFlags;
+    TimelineSubmitInfo timelineInfo;
+    UploadSubmit_t upload;
+    FlushUploads(&pSems, &pFlags, &timelineInfo, &upload);
+
+    const VkSemaphore auxSemaphore = mAuxTimeline.GetSemaphore();
+    if(mAuxTimeline.IsCreated()) {
+        timelineInfo.AddSignal(++mAuxSerial);
+    }
+
     VkSubmitInfo info = {};
     info.sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    info.pNext                  = nullptr;
+    info.pNext                  = timelineInfo.Chain(nullptr);
     info.commandBufferCount     = 1;
     info.pCommandBuffers        = &mVkAuxCommandBuffer;
+    info.waitSemaphoreCount     = static_cast<uint32_t>(pSems.size());
+    info.pWaitSemaphores        = pSems.data();
+    info.pWaitDstStageMask      = pFlags.data();
+    info.signalSemaphoreCount   = mAuxTimeline.IsCreated() ? 1 : 0;
+    info.pSignalSemaphores      = mAuxTimeline.IsCreated() ? &auxSemaphore : nullptr;
+
+    CHROME_TRACE_SPAN("vkQueueSubmit aux", "vulkan");
+    std::lock_guard<std::mutex> lock(mVkContext->vkQueueMutex);
+    VkResult err = QueueSubmit(&upload, &info, mVkAuxFence);
+    mVkContext->perfCounters->Add(PERF_COUNTER_AUX_SUBMITS);
+    mAuxTimestampsWritten = (err == VK_SUCCESS && mVkAuxTimestampPool != VK_NULL_HANDLE);
 
-    VkResult err = vkQueueSubmit(mVkContext->vkQueue, 1, &info, mVkAuxFence);
-    assert(!err);
+    return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY && err != VK_ERROR_DEVICE_LOST);
+}
+
+bool
+CommandBufferManager::SubmitVkFence(VkFence fence)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // a submission without command buffers signals its fence once all the
+    // work queued before it has completed, pending uploads included
+    SubmitSemaphores_t pSems;
+    SubmitStageFlags_t pFlags;
+    TimelineSubmitInfo timelineInfo;
+    UploadSubmit_t upload;
+    FlushUploads(&pSems, &pFlags, &timelineInfo, &upload);
+
+    VkSubmitInfo info = {};
+    info.sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    info.pNext                  = timelineInfo.Chain(nullptr);
+    info.commandBufferCount     = 0;
+    info.pCommandBuffers        = nullptr;
+    info.waitSemaphoreCount     = static_cast<uint32_t>(pSems.size());
+    info.pWaitSemaphores        = pSems.data();
+    info.pWaitDstStageMask      = pFlags.data();
+
+    CHROME_TRACE_SPAN("vkQueueSubmit fence", "vulkan");
+    std::lock_guard<std::mutex> lock(mVkContext->vkQueueMutex);
+    VkResult err = QueueSubmit(&upload, &info, fence);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY && err != VK_ERROR_DEVICE_LOST);
 }
 
+bool
+CommandBufferManager::SubmitVkUploads(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // uploads batched while no draw was recorded are submitted ahead of an empty submission,
+    // so that whatever is queued after it, by any context, runs after them
+    if(!mUploadManager->IsRecording()) {
+        return true;
+    }
+
+    return SubmitVkFence(VK_NULL_HANDLE);
+}
+
 bool
 CommandBufferManager::WaitVkAuxCommandBuffer(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err = vkQueueWaitIdle(mVkContext->vkQueue);
+    VkResult err;
+    if(mAuxTimeline.IsCreated()) {
+        // only the auxiliary work and what was submitted before it is waited for, not the work other contexts queue meanwhile
+        CHROME_TRACE_SPAN("aux timeline wait", "vulkan");
+        const uint64_t start = ChromeTrace::Now();
+        err = mAuxTimeline.Wait(mAuxSerial, GLOVE_FENCE_WAIT_TIMEOUT) ? VK_SUCCESS : VK_ERROR_DEVICE_LOST;
+        StallDetector::Record(STALL_REASON_AUX_SUBMIT, ChromeTrace::Now() - start);
+    } else {
+        std::lock_guard<std::mutex> lock(mVkContext->vkQueueMutex);
+        CHROME_TRACE_SPAN("vkQueueWaitIdle", "vulkan");
+        const uint64_t start = ChromeTrace::Now();
+        err = vkQueueWaitIdle(mVkContext->vkQueue);
+        StallDetector::Record(STALL_REASON_AUX_SUBMIT, ChromeTrace::Now() - start);
+    }
     assert(!err);
 
+    // every draw submitted ahead of the auxiliary work has completed along with it
+    if(err == VK_SUCCESS) {
+        mCompletedSerial = std::max(mCompletedSerial, mSubmitSerial - 1);
+    }
+
+    if(err == VK_SUCCESS && mAuxTimestampsWritten) {
+        uint64_t results[2] = { 0, 0 };
+        if(vkGetQueryPoolResults(mVkContext->vkDevice, mVkAuxTimestampPool, 0, 2, sizeof(results), results,
+                                 sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            const uint64_t mask = mVkContext->vkTimestampValidBits >= 64 ? UINT64_MAX : (1ull << mVkContext->vkTimestampValidBits) - 1;
+            mVkContext->perfCounters->Add(PERF_COUNTER_AUX_GPU_NS, TicksToNanoseconds((results[1] - results[0]) & mask));
+            ChromeTrace::AddGpuSpan("aux submit", TicksToNanoseconds(results[0] & mask), TicksToNanoseconds(results[1] & mask));
+        }
+        mAuxTimestampsWritten = false;
+    }
+
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY && err != VK_ERROR_DEVICE_LOST);
 }
 
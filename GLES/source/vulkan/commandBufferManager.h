@@ -24,13 +24,56 @@
 #ifndef __VKCBMANAGER_H__
 #define __VKCBMANAGER_H__
 
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 #include "context.h"
 #include "fence.h"
+#include "timeline.h"
 #include "commandBufferPool.h"
+#include "renderPass.h"
+#include "uploadManager.h"
+#include "utils/taskQueue.h"
+
+/// Number of frames the CPU may record ahead of the GPU at most,
+/// the presentation policy of the window surface may lower it (see PaceFrames)
+#define GLOVE_FRAMES_IN_FLIGHT                          3
+
+/// Number of threads that record the secondary command buffers of a render pass at most,
+/// each one allocating from its own command pool
+#define GLOVE_SECONDARY_RECORDING_THREADS               4
+
+/// Number of timestamps a frame in flight writes at most, the ones beyond it read as zero
+#define GLOVE_MAX_TIMESTAMPS_PER_FRAME                  256
+
+/// Number of occlusion queries a frame in flight begins at most, the ones beyond it pass conservatively
+#define GLOVE_MAX_OCCLUSION_QUERIES_PER_FRAME           256
 
 namespace vulkanAPI {
 
+/// GPU time written into a frame, in ticks of the device, known once the frame has completed
+typedef struct Timestamp_t {
+    uint64_t                        ticks;
+    uint64_t                        serial;
+    bool                            available;
+} Timestamp_t;
+
+/// Any samples passed query, made of one Vulkan query for every render pass drawn while it is active.
+/// its result is known once it has ended and none of them is pending
+typedef struct OcclusionQuery_t {
+    uint32_t                        pendingQueries;
+    uint64_t                        serial;
+    bool                            anySamplesPassed;
+} OcclusionQuery_t;
+
+/// Label of the command buffers a capture tool shows, a begun one spans the commands until its end
+typedef enum {
+    DEBUG_LABEL_BEGIN = 0,
+    DEBUG_LABEL_INSERT,
+    DEBUG_LABEL_END
+} debugLabelOp_t;
+
 typedef enum {
     CMD_BUFFER_INITIAL_STATE = 0,
     CMD_BUFFER_RECORDING_STATE,
@@ -45,24 +88,118 @@ private:
         std::vector<VkCommandBuffer>         commandBuffer;
         std::vector<cmdBufferState_t>        commandBufferState;
         std::vector<Fence>                   fence;
+        std::vector<uint64_t>                serial;
+        /// every frame allocates from pools of its own, reset as a whole once the frame has completed
+        std::vector<VkCommandPool>                       commandPool;
+        std::vector<std::vector<VkCommandPool>>          secondaryCmdPool;
+        std::vector<std::vector<CommandBufferPool>>      secondaryCmdBufferPool;
+        /// timestamps of every frame are written into its own query pool, in the order they were requested
+        std::vector<VkQueryPool>                         timestampPool;
+        std::vector<std::vector<std::shared_ptr<Timestamp_t>>> timestamps;
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> renderPassQueries;
+        /// occlusion queries of every frame, in the order they were begun
+        std::vector<VkQueryPool>                         occlusionPool;
+        std::vector<std::vector<std::shared_ptr<OcclusionQuery_t>>> occlusionQueries;
 
         State()  { FUN_ENTRY(GL_LOG_TRACE); }
         ~State() { FUN_ENTRY(GL_LOG_TRACE); }
     } State;
 
+    typedef struct DebugLabel_t {
+        debugLabelOp_t               op;
+        std::string                  name;
+    } DebugLabel_t;
+
+    /// the lists of a submission are short enough to be kept on the stack
+    typedef FixedVector<VkSemaphore, GLOVE_MAX_SUBMIT_SEMAPHORES>          SubmitSemaphores_t;
+    typedef FixedVector<VkPipelineStageFlags, GLOVE_MAX_SUBMIT_SEMAPHORES> SubmitStageFlags_t;
+
+    /// upload batch submitted ahead of the work that waits on it, in the same vkQueueSubmit
+    typedef struct UploadSubmit_t {
+        VkCommandBuffer              commandBuffer;
+        VkSemaphore                  semaphore;
+        TimelineSubmitInfo           timelineInfo;
+        VkSubmitInfo                 submitInfo;
+
+        UploadSubmit_t() : commandBuffer(VK_NULL_HANDLE), semaphore(VK_NULL_HANDLE) { FUN_ENTRY(GL_LOG_TRACE); }
+    } UploadSubmit_t;
+
     VkCommandPool                   mVkCmdPool;
     const vkContext_t              *mVkContext;
 
     uint32_t                        mActiveCmdBuffer;
     int32_t                         mLastSubmittedBuffer;
 
+    /// every draw submission is numbered, so that resources can tell when the
+    /// frames that referred to them have completed
+    uint64_t                        mSubmitSerial;
+    uint64_t                        mCompletedSerial;
+
+    /// last serial of each of the recent frames, indexed by frame number
+    uint64_t                        mFrameSerials[GLOVE_FRAMES_IN_FLIGHT];
+    uint64_t                        mFrameCount;
+
+    /// the next draw command buffer starts with a barrier against all the work
+    /// submitted to the queue before it, by any context, and so do the auxiliary ones until then
+    bool                            mPendingQueueBarrier;
+
+    /// whether the draw surface is a window surface, whose frames wait on the swapchain semaphores
+    bool                            mWindowSurface;
+    /// the swapchain semaphores of the draw surface, null for the ones of the context
+    vkSyncItems_t                  *mSyncItems;
+
     State                           mVkCommandBuffers;
 
     VkCommandBuffer                 mVkAuxCommandBuffer;
     VkFence                         mVkAuxFence;
-    CommandBufferPool               mSecondaryCmdBufferPool;
 
-    void FreeResources(void);
+    /// when supported, every draw submission signals the counter with its serial and every
+    /// auxiliary one the counter of its own, the frames are then waited on without their fences
+    Timeline                        mTimeline;
+    Timeline                        mAuxTimeline;
+    uint64_t                        mAuxSerial;
+
+    /// the render pass being recorded has written its begin timestamp, its end one is written when it ends
+    std::shared_ptr<Timestamp_t>    mRenderPassBegin;
+    std::shared_ptr<Timestamp_t>    mRenderPassEnd;
+    bool                            mInRenderPass;
+
+    /// the active occlusion query begins a Vulkan query with every render pass, which is open until the
+    /// render pass ends. one begun inside a render pass has to end inside it, one begun outside it after it
+    std::shared_ptr<OcclusionQuery_t> mActiveOcclusionQuery;
+    std::shared_ptr<OcclusionQuery_t> mOpenOcclusionQuery;
+    uint32_t                        mOpenOcclusionSlot;
+    bool                            mOpenOcclusionInRenderPass;
+
+    /// the auxiliary command buffer is timed from its begin to its end
+    VkQueryPool                     mVkAuxTimestampPool;
+    bool                            mAuxTimestampsWritten;
+
+    UploadManager                  *mUploadManager;
+
+    /// runs the recording of all but the first secondary command buffer of a render pass
+    TaskQueue                      *mRecordQueue;
+
+    /// labels added while no draw command buffer was being recorded, or while its render pass
+    /// only took secondary command buffers, recorded as soon as it can take them
+    std::vector<DebugLabel_t>       mPendingDebugLabels;
+
+    bool CreateVkCmdPool(VkCommandPoolCreateFlags flags, VkCommandPool *cmdPool);
+    bool CreateVkQueryPool(VkQueryType queryType, uint32_t queryCount, VkQueryPool *queryPool);
+    void FreeResources(uint32_t index);
+    void RecordQueueBarrier(VkCommandBuffer cmdBuffer);
+    void RecordPendingVkDebugLabels(void);
+    void ResolveQueries(uint32_t index, bool executed);
+    void ResolveTimestamps(uint32_t index, bool executed);
+    void ResolveOcclusionQueries(uint32_t index, bool executed);
+    void BeginVkRenderPassTimestamps(void);
+    void EndVkRenderPassTimestamps(void);
+    void BeginVkOcclusionQuerySlot(bool inRenderPass);
+    void EndVkOcclusionQuerySlot(void);
+    uint64_t TicksToNanoseconds(uint64_t ticks)                           const;
+    void FlushUploads(SubmitSemaphores_t *pSems, SubmitStageFlags_t *pFlags, TimelineSubmitInfo *timelineInfo, UploadSubmit_t *upload);
+    VkResult QueueSubmit(UploadSubmit_t *upload, const VkSubmitInfo *submitInfo, VkFence fence);
+    bool IsVkDrawCommandBufferCompleted(uint32_t index);
 
 public:
 // Constructor
@@ -80,29 +217,70 @@ public:
 
 // Destroy Functions
     void DestroyVkCmdBuffers(void);
-    VkCommandBuffer *AllocateVkSecondaryCmdBuffers(uint32_t numOfBuffers);
+    VkCommandBuffer *AllocateVkSecondaryCmdBuffers(uint32_t numOfBuffers, uint32_t thread = 0);
+    bool AllocateVkBundleCmdBuffer(VkCommandBuffer *cmdBuffer);
+    void FreeVkBundleCmdBuffer(VkCommandBuffer cmdBuffer);
 
 // Begin Functions
     bool BeginVkAuxCommandBuffer(void);
     bool BeginVkDrawCommandBuffer(void);
-    bool BeginVkSecondaryCommandBuffer(const VkCommandBuffer *cmdBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer);
+    bool BeginVkSecondaryCommandBuffer(const VkCommandBuffer *cmdBuffer, const RenderPass *renderPass, VkFramebuffer framebuffer,
+                                       VkCommandBufferUsageFlags usage = 0);
 
 // End Functions
     bool EndVkAuxCommandBuffer(void);
     void EndVkDrawCommandBuffer(void);
     void EndVkSecondaryCommandBuffer(const VkCommandBuffer *cmdBuffer);
 
+// Record Functions
+    bool RecordVkSecondaryCommandBuffers(const RenderPass *renderPass, VkFramebuffer framebuffer, uint32_t count,
+                                         const std::function<void(VkCommandBuffer cmdBuffer, uint32_t index)> &record);
+
 // Submit Functions
     bool SubmitVkDrawCommandBuffer(void);
     bool SubmitVkAuxCommandBuffer(void);
+    bool SubmitVkFence(VkFence fence);
+    bool SubmitVkUploads(void);
 
 // Wait Functions
     bool WaitLastSubmition(void);
+    bool WaitVkSerial(uint64_t serial);
+    bool WaitVkDrawCommandBuffer(uint32_t index);
     bool WaitVkAuxCommandBuffer(void);
+    bool PaceFrames(uint32_t maxFramesInFlight);
+    void PollVkQueries(void);
+    uint64_t UpdateCompletedSerial(void);
+
+// Query Functions
+    std::shared_ptr<Timestamp_t> WriteVkTimestamp(VkPipelineStageFlagBits stage);
+    std::shared_ptr<OcclusionQuery_t> BeginVkOcclusionQuery(void);
+    void EndVkOcclusionQuery(void);
+    void BeginVkRenderPassQueries(void);
+    void EndVkRenderPassQueries(bool renderPassEnded);
+    inline void WaitPriorSubmissions(void)                                      { FUN_ENTRY(GL_LOG_TRACE); mPendingQueueBarrier = true; }
+
+// Debug Label Functions
+    void AddVkDebugLabel(debugLabelOp_t op, const char *name);
+    void RecordVkDebugLabel(VkCommandBuffer cmdBuffer, debugLabelOp_t op, const char *name) const;
 
 // Get Functions
     inline VkCommandBuffer GetActiveCommandBuffer(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mVkCommandBuffers.commandBuffer[mActiveCmdBuffer]; }
+    inline uint32_t        GetActiveCommandBufferIndex(void)              const { FUN_ENTRY(GL_LOG_TRACE); return mActiveCmdBuffer; }
     inline VkCommandBuffer GetAuxCommandBuffer(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mVkAuxCommandBuffer; }
+    inline UploadManager  *GetUploadManager(void)                         const { FUN_ENTRY(GL_LOG_TRACE); return mUploadManager; }
+    inline uint64_t        GetSubmitSerial(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mSubmitSerial; }
+    inline uint64_t        GetCompletedSerial(void)                       const { FUN_ENTRY(GL_LOG_TRACE); return mCompletedSerial; }
+    inline const std::shared_ptr<Timestamp_t> &GetRenderPassBeginTimestamp(void) const { FUN_ENTRY(GL_LOG_TRACE); return mRenderPassBegin; }
+    inline const std::shared_ptr<Timestamp_t> &GetRenderPassEndTimestamp(void)   const { FUN_ENTRY(GL_LOG_TRACE); return mRenderPassEnd; }
+
+// Set Functions
+    inline void            SetWindowSurface(bool windowSurface)                 { FUN_ENTRY(GL_LOG_TRACE); mWindowSurface = windowSurface; }
+    inline void            SetSyncItems(vkSyncItems_t *syncItems)               { FUN_ENTRY(GL_LOG_TRACE); mSyncItems = syncItems; }
+
+// Is Functions
+    inline bool            IsActiveCommandBufferRecording(void)           const { FUN_ENTRY(GL_LOG_TRACE); return mVkCommandBuffers.commandBufferState[mActiveCmdBuffer] == CMD_BUFFER_RECORDING_STATE; }
+    inline bool            IsTimestampSupported(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mVkContext->vkTimestampValidBits != 0; }
+    inline bool            IsInRenderPass(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mInRenderPass; }
 };
 
 }
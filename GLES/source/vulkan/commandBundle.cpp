@@ -0,0 +1,190 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       commandBundle.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Draws recorded once into a secondary command buffer and executed by any later frame (GL_GLOVE_command_bundle)
+ *
+ *  @section
+ *
+ *  Static geometry is drawn with the same state frame after frame, yet every
+ *  draw is translated and recorded again each time. A bundle records its draws
+ *  once, into a secondary command buffer that continues a render pass of the
+ *  same compatibility class, and each frame executes it with a single command.
+ *  The uniform blocks, the streamed vertex data and the descriptor sets of the
+ *  draws are written into rings of the bundle, which are never retired, so the
+ *  dynamic offsets recorded stay valid for as long as the bundle does.
+ *
+ */
+
+#include "commandBundle.h"
+
+namespace vulkanAPI {
+
+CommandBundle::CommandBundle(const vkContext_t *vkContext, CommandBufferManager *commandBufferManager)
+: mVkContext(vkContext), mCommandBufferManager(commandBufferManager), mVkCmdBuffer(VK_NULL_HANDLE), mRenderPass(vkContext),
+  mUniformRing(vkContext, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 0, GLOVE_COMMAND_BUNDLE_RING_SIZE),
+  mVertexRing(vkContext, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+              GLOVE_VERTEX_RING_ALIGNMENT, GLOVE_COMMAND_BUNDLE_RING_SIZE),
+  mDescriptorPoolRing(vkContext), mDrawCount(0), mLastUsedSerial(0), mDebugLabelDepth(0),
+  mRecording(false), mRecorded(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+CommandBundle::~CommandBundle()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+void
+CommandBundle::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkCmdBuffer != VK_NULL_HANDLE) {
+        mCommandBufferManager->FreeVkBundleCmdBuffer(mVkCmdBuffer);
+        mVkCmdBuffer = VK_NULL_HANDLE;
+    }
+
+    mUniformRing.Release();
+    mVertexRing.Release();
+    mDescriptorPoolRing.Release();
+    mRenderPass.Release();
+    mPipelines.clear();
+    mDrawCount = 0;
+    mDebugLabelDepth = 0;
+    mRecording = false;
+    mRecorded  = false;
+}
+
+bool
+CommandBundle::Begin(const RenderPass *renderPass)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the commands recorded before are dropped along with the data they refer to,
+    // the caller has waited for the frames that executed them
+    mUniformRing.RetireAll();
+    mVertexRing.RetireAll();
+    mDescriptorPoolRing.RetireAll();
+    mPipelines.clear();
+    mDrawCount = 0;
+    mDebugLabelDepth = 0;
+    mRecorded  = false;
+
+    mRenderPass.SetMultisampleColorTransient(renderPass->GetMultisampleColorTransient());
+    mRenderPass.SetColorFetchEnabled(renderPass->GetColorFetchEnabled());
+    mRenderPass.SetViewCount(renderPass->GetViewCount());
+    if(!mRenderPass.Create(renderPass->GetColorFormat(), renderPass->GetDepthStencilFormat(), renderPass->GetSamples())) {
+        return false;
+    }
+
+    if(mVkCmdBuffer == VK_NULL_HANDLE) {
+        if(!mCommandBufferManager->AllocateVkBundleCmdBuffer(&mVkCmdBuffer)) {
+            return false;
+        }
+    } else if(vkResetCommandBuffer(mVkCmdBuffer, 0) != VK_SUCCESS) {
+        return false;
+    }
+
+    // the same bundle may be executed by every frame in flight, and more than once by each
+    if(!mCommandBufferManager->BeginVkSecondaryCommandBuffer(&mVkCmdBuffer, &mRenderPass, VK_NULL_HANDLE,
+                                                             VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT)) {
+        return false;
+    }
+
+    mRecording = true;
+
+    return true;
+}
+
+bool
+CommandBundle::End(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mRecording) {
+        return false;
+    }
+
+    // a secondary command buffer ends every label it has begun
+    for(; mDebugLabelDepth; --mDebugLabelDepth) {
+        mCommandBufferManager->RecordVkDebugLabel(mVkCmdBuffer, DEBUG_LABEL_END, nullptr);
+    }
+
+    mRecording = false;
+    mRecorded  = vkEndCommandBuffer(mVkCmdBuffer) == VK_SUCCESS;
+
+    return mRecorded;
+}
+
+void
+CommandBundle::AddDraws(uint32_t drawCount, uint64_t pipelineHash, VkPipeline pipeline)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    mDrawCount += drawCount;
+
+    for(const auto &ref : mPipelines) {
+        if(ref.pipeline == pipeline) {
+            return;
+        }
+    }
+
+    PipelineRef_t ref;
+    ref.hash     = pipelineHash;
+    ref.pipeline = pipeline;
+    mPipelines.push_back(ref);
+}
+
+bool
+CommandBundle::AddDebugLabel(debugLabelOp_t op, const char *name)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // nor can it end the labels begun around it, those are left to the frame
+    if(op == DEBUG_LABEL_END && !mDebugLabelDepth) {
+        return false;
+    }
+
+    mCommandBufferManager->RecordVkDebugLabel(mVkCmdBuffer, op, name);
+    if(op == DEBUG_LABEL_BEGIN) {
+        ++mDebugLabelDepth;
+    } else if(op == DEBUG_LABEL_END) {
+        --mDebugLabelDepth;
+    }
+
+    return true;
+}
+
+bool
+CommandBundle::IsCompatible(const RenderPass *renderPass) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return renderPass->GetColorFormat()               == mRenderPass.GetColorFormat()              &&
+           renderPass->GetDepthStencilFormat()        == mRenderPass.GetDepthStencilFormat()       &&
+           renderPass->GetSamples()                   == mRenderPass.GetSamples()                  &&
+           renderPass->GetMultisampleColorTransient() == mRenderPass.GetMultisampleColorTransient() &&
+           renderPass->GetColorFetchEnabled()         == mRenderPass.GetColorFetchEnabled()        &&
+           renderPass->GetViewCount()                 == mRenderPass.GetViewCount();
+}
+
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       commandBundle.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Draws recorded once into a secondary command buffer and executed by any later frame (GL_GLOVE_command_bundle)
+ *
+ */
+
+#ifndef __VKCOMMANDBUNDLE_H__
+#define __VKCOMMANDBUNDLE_H__
+
+#include <vector>
+#include "context.h"
+#include "commandBufferManager.h"
+#include "renderPass.h"
+#include "uniformRing.h"
+#include "descriptorPoolRing.h"
+
+/// Initial size of the uniform and vertex rings of a bundle, which only hold the data of its own draws
+#define GLOVE_COMMAND_BUNDLE_RING_SIZE                  (64 * 1024)
+
+namespace vulkanAPI {
+
+class CommandBundle final {
+private:
+
+    typedef struct PipelineRef_t {
+        uint64_t                    hash;
+        VkPipeline                  pipeline;
+    } PipelineRef_t;
+
+    const vkContext_t              *mVkContext;
+    CommandBufferManager           *mCommandBufferManager;
+
+    VkCommandBuffer                 mVkCmdBuffer;
+
+    /// the render pass the draws are recorded against, any compatible one executes them
+    RenderPass                      mRenderPass;
+
+    /// the data the draws refer to is never retired, it lives as long as the recorded commands
+    UniformRing                     mUniformRing;
+    UniformRing                     mVertexRing;
+    DescriptorPoolRing              mDescriptorPoolRing;
+
+    /// pipelines of the context cache bound by the draws, the bundle can only be executed while they are all alive
+    std::vector<PipelineRef_t>      mPipelines;
+    uint32_t                        mDrawCount;
+    uint64_t                        mLastUsedSerial;
+    /// labels begun into the secondary command buffer and not ended yet, it ends them itself
+    uint32_t                        mDebugLabelDepth;
+    bool                            mRecording;
+    bool                            mRecorded;
+
+public:
+// Constructor
+    CommandBundle(const vkContext_t *vkContext = nullptr, CommandBufferManager *commandBufferManager = nullptr);
+
+// Destructor
+    ~CommandBundle();
+
+// Release Functions
+    void                            Release(void);
+
+// Begin/End Functions
+    bool                            Begin(const RenderPass *renderPass);
+    bool                            End(void);
+
+// Add Functions
+    void                            AddDraws(uint32_t drawCount, uint64_t pipelineHash, VkPipeline pipeline);
+    bool                            AddDebugLabel(debugLabelOp_t op, const char *name);
+
+// Get Functions
+    inline VkCommandBuffer         *GetVkCommandBuffer(void)                        { FUN_ENTRY(GL_LOG_TRACE); return &mVkCmdBuffer; }
+    inline UniformRing             *GetUniformRing(void)                            { FUN_ENTRY(GL_LOG_TRACE); return &mUniformRing; }
+    inline UniformRing             *GetVertexRing(void)                             { FUN_ENTRY(GL_LOG_TRACE); return &mVertexRing; }
+    inline DescriptorPoolRing      *GetDescriptorPoolRing(void)                     { FUN_ENTRY(GL_LOG_TRACE); return &mDescriptorPoolRing; }
+    inline const std::vector<PipelineRef_t> &GetPipelines(void)               const { FUN_ENTRY(GL_LOG_TRACE); return mPipelines; }
+    inline uint32_t                 GetDrawCount(void)                        const { FUN_ENTRY(GL_LOG_TRACE); return mDrawCount; }
+    inline uint64_t                 GetLastUsedSerial(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mLastUsedSerial; }
+    inline uint32_t                 GetDebugLabelDepth(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mDebugLabelDepth; }
+
+// Set Functions
+    inline void                     SetLastUsedSerial(uint64_t serial)              { FUN_ENTRY(GL_LOG_TRACE); mLastUsedSerial = serial; }
+
+// Is Functions
+    inline bool                     IsRecording(void)                         const { FUN_ENTRY(GL_LOG_TRACE); return mRecording; }
+    inline bool                     IsRecorded(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mRecorded; }
+    bool                            IsCompatible(const RenderPass *renderPass) const;
+};
+
+}
+
+#endif // __VKCOMMANDBUNDLE_H__
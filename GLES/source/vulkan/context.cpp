@@ -28,11 +28,45 @@
  */
 
 #include "context.h"
+#include "memoryAllocator.h"
+#include "samplerCache.h"
+#include "pipelineLayoutCache.h"
+#include "shaderModuleCache.h"
+#include "capabilityCache.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+#include "utils/globals.h"
+#include "utils/atomicFileWriter.h"
+#include <algorithm>
+#include <mutex>
+#include <string>
 
 namespace vulkanAPI {
 
 #define GLOVE_VK_VALIDATION_LAYERS                      false
 
+/// Environment variable holding the path of the on-disk pipeline cache
+#define GLOVE_PIPELINE_CACHE_PATH_ENV                   "GLOVE_PIPELINE_CACHE_PATH"
+/// Path used when the environment variable is not set (empty keeps the cache in memory only)
+#define GLOVE_PIPELINE_CACHE_DEFAULT_PATH               ""
+#define GLOVE_PIPELINE_CACHE_FILE_MAGIC                 0x434c5047  // "GPLC"
+#define GLOVE_PIPELINE_CACHE_FILE_VERSION               1
+/// Appended to the path of the pipeline cache to make that of the capability cache
+#define GLOVE_CAPABILITY_CACHE_FILE_SUFFIX              ".caps"
+
+/// Index, in enumeration order, or part of the name of the GPU to run on, instead of the one ranked first
+#define GLOVE_GPU_ENV                                   "GLOVE_GPU"
+
+/// Set to 1 to sample textures through a table indexed per draw, where descriptor indexing is supported
+#define GLOVE_BINDLESS_TEXTURES_ENV                     "GLOVE_BINDLESS_TEXTURES"
+
+/// Set to 1 to tile images linearly where their format allows, for integrated GPUs where linear images are measured to be faster
+#define GLOVE_LINEAR_IMAGES_ENV                         "GLOVE_LINEAR_IMAGES"
+
+/// Set to "precision" to pick the depth/stencil formats with the most depth bits the device renders to,
+/// instead of the ones with the fewest bytes per sample that still hold the requested bits ("bandwidth")
+#define GLOVE_DEPTH_STENCIL_POLICY_ENV                  "GLOVE_DEPTH_STENCIL_POLICY"
+
 #ifdef VK_USE_PLATFORM_XCB_KHR
 static const std::vector<const char*> requiredInstanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME,
                                                                     VK_KHR_XCB_SURFACE_EXTENSION_NAME};
@@ -51,14 +85,95 @@ static const std::vector<const char*> requiredInstanceExtensions = {VK_KHR_SURFA
 #else // native
 static const std::vector<const char*> requiredInstanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME,
                                                                     VK_KHR_DISPLAY_EXTENSION_NAME};
+/// frames are presented straight to a display plane, with no compositor in between
+#define GLOVE_DIRECT_DISPLAY_PLATFORM
 #endif
 
 static const std::vector<const char*> requiredDeviceExtensions   = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+/// Without a window system nothing is presented, so neither list is needed
+static const std::vector<const char*> headlessExtensions;
 
 static const std::vector<const char*> usefulDeviceExtensions     = {"VK_KHR_maintenance1"};
 
+/// Required to query the extended dynamic state feature on a Vulkan 1.0 instance
+static const char *physicalDeviceProperties2InstanceExtension   = "VK_KHR_get_physical_device_properties2";
+static const char *extendedDynamicStateDeviceExtension          = "VK_EXT_extended_dynamic_state";
+static const char *indexTypeUint8DeviceExtension                = "VK_EXT_index_type_uint8";
+static const char *descriptorUpdateTemplateDeviceExtension      = "VK_KHR_descriptor_update_template";
+static const char *incrementalPresentDeviceExtension            = "VK_KHR_incremental_present";
+static const char *displayTimingDeviceExtension                 = "VK_GOOGLE_display_timing";
+/// vblank events of a display plane, the instance extension is required by the device one
+static const char *displaySurfaceCounterInstanceExtension       = "VK_EXT_display_surface_counter";
+static const char *displayControlDeviceExtension                = "VK_EXT_display_control";
+static const char *memoryBudgetDeviceExtension                  = "VK_EXT_memory_budget";
+static const char *timelineSemaphoreDeviceExtension             = "VK_KHR_timeline_semaphore";
+static const char *transformFeedbackDeviceExtension             = "VK_EXT_transform_feedback";
+/// devices layered over another API (MoltenVK) that lack parts of Vulkan, it is enabled whenever it is listed
+static const char *portabilitySubsetDeviceExtension             = "VK_KHR_portability_subset";
+static const std::vector<const char*> descriptorIndexingDeviceExtensions = {"VK_KHR_maintenance3",
+                                                                            "VK_EXT_descriptor_indexing"};
+static const std::vector<const char*> hostImageCopyDeviceExtensions      = {"VK_KHR_copy_commands2",
+                                                                            "VK_KHR_format_feature_flags2",
+                                                                            "VK_EXT_host_image_copy"};
+static const std::vector<const char*> dynamicRenderingDeviceExtensions   = {"VK_KHR_multiview",
+                                                                            "VK_KHR_maintenance2",
+                                                                            "VK_KHR_create_renderpass2",
+                                                                            "VK_KHR_depth_stencil_resolve",
+                                                                            "VK_KHR_dynamic_rendering"};
+static const std::vector<const char*> pipelineLibraryDeviceExtensions    = {"VK_KHR_pipeline_library",
+                                                                            "VK_EXT_graphics_pipeline_library"};
+static const std::vector<const char*> multiviewDeviceExtensions          = {"VK_KHR_multiview"};
+
+/// Required by any device extension that imports external memory on a Vulkan 1.0 instance
+static const char *externalMemoryCapabilitiesInstanceExtension  = "VK_KHR_external_memory_capabilities";
+/// Required by the device extensions that export fences as sync files on a Vulkan 1.0 instance
+static const char *externalFenceCapabilitiesInstanceExtension   = "VK_KHR_external_fence_capabilities";
+/// Labels of the command buffers, listed by the layers of capture tools when they are loaded
+static const char *debugUtilsInstanceExtension                  = "VK_EXT_debug_utils";
+/// Device extensions that import EGLImages, each set along with the extensions it depends on
+static const std::vector<const char*> dmaBufDeviceExtensions             = {"VK_KHR_external_memory",
+                                                                            "VK_KHR_external_memory_fd",
+                                                                            "VK_EXT_external_memory_dma_buf"};
+static const std::vector<const char*> syncFdFenceDeviceExtensions        = {"VK_KHR_external_fence",
+                                                                            "VK_KHR_external_fence_fd"};
+static const std::vector<const char*> drmFormatModifierDeviceExtensions  = {"VK_KHR_maintenance1",
+                                                                            "VK_KHR_bind_memory2",
+                                                                            "VK_KHR_get_memory_requirements2",
+                                                                            "VK_KHR_image_format_list",
+                                                                            "VK_KHR_sampler_ycbcr_conversion",
+                                                                            "VK_EXT_image_drm_format_modifier"};
+static const std::vector<const char*> hardwareBufferDeviceExtensions     = {"VK_KHR_maintenance1",
+                                                                            "VK_KHR_bind_memory2",
+                                                                            "VK_KHR_get_memory_requirements2",
+                                                                            "VK_KHR_sampler_ycbcr_conversion",
+                                                                            "VK_KHR_external_memory",
+                                                                            "VK_KHR_dedicated_allocation",
+                                                                            "VK_EXT_queue_family_foreign",
+                                                                            "VK_ANDROID_external_memory_android_hardware_buffer"};
+
+static       bool isHeadless                                    = false;
+static       bool isPhysicalDeviceProperties2Supported          = false;
+static       bool isExternalMemoryCapabilitiesSupported         = false;
+static       bool isExternalFenceCapabilitiesSupported          = false;
+static       bool isDisplaySurfaceCounterSupported              = false;
+static       bool isDebugUtilsSupported                         = false;
+
 static       char **enabledInstanceLayers           = nullptr;
 
+typedef struct pipelineCacheFileHeader_t {
+    uint32_t                                            magic;
+    uint32_t                                            version;
+    uint32_t                                            vendorID;
+    uint32_t                                            deviceID;
+    uint32_t                                            driverVersion;
+    uint8_t                                             pipelineCacheUUID[VK_UUID_SIZE];
+    uint64_t                                            dataSize;
+} pipelineCacheFileHeader_t;
+
+static       size_t pipelineCacheSavedSize          = 0;
+/// contexts on several threads save the cache as they submit their frames
+static       std::mutex pipelineCacheSaveMutex;
+
 vkContext_t GloveVkContext;
 
 bool InitVkLayers(uint32_t* nLayers);
@@ -70,6 +185,7 @@ bool InitVkQueueFamilyIndex(void);
 bool CreateVkDevice(void);
 bool CreateVkCommandPool(void);
 bool CreateVkSemaphores(void);
+void DestroyVkSemaphores(void);
 void InitVkQueue(void);
 
 bool
@@ -114,11 +230,27 @@ InitVkLayers(uint32_t* nLayers)
     return true;
 }
 
+static inline const std::vector<const char*> &
+GetRequiredInstanceExtensions(void)
+{
+    return isHeadless ? headlessExtensions : requiredInstanceExtensions;
+}
+
+static inline const std::vector<const char*> &
+GetRequiredDeviceExtensions(void)
+{
+    return isHeadless ? headlessExtensions : requiredDeviceExtensions;
+}
+
 bool
 CheckVkInstanceExtensions(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    const char *headless = getenv(GLOVE_HEADLESS_ENV);
+    isHeadless = (headless != nullptr && atoi(headless) != 0);
+    const std::vector<const char*> &requiredInstanceExtensions = GetRequiredInstanceExtensions();
+
     VkResult res;
     uint32_t extensionCount = 0;
     VkExtensionProperties *vkExtensionProperties = nullptr;
@@ -139,6 +271,11 @@ CheckVkInstanceExtensions(void)
     } while(res == VK_INCOMPLETE);
 
     std::vector<bool> requiredExtensionsAvailable(requiredInstanceExtensions.size(), false);
+    isPhysicalDeviceProperties2Supported = false;
+    isExternalMemoryCapabilitiesSupported = false;
+    isExternalFenceCapabilitiesSupported = false;
+    isDisplaySurfaceCounterSupported = false;
+    isDebugUtilsSupported = false;
     for(uint32_t i = 0; i < extensionCount; ++i) {
         for(uint32_t j = 0; j < requiredInstanceExtensions.size(); ++j) {
             if(!strcmp(requiredInstanceExtensions[j], vkExtensionProperties[i].extensionName)) {
@@ -146,7 +283,26 @@ CheckVkInstanceExtensions(void)
                 break;
             }
         }
+        if(!strcmp(physicalDeviceProperties2InstanceExtension, vkExtensionProperties[i].extensionName)) {
+            isPhysicalDeviceProperties2Supported = true;
+        }
+        if(!strcmp(externalMemoryCapabilitiesInstanceExtension, vkExtensionProperties[i].extensionName)) {
+            isExternalMemoryCapabilitiesSupported = true;
+        }
+        if(!strcmp(externalFenceCapabilitiesInstanceExtension, vkExtensionProperties[i].extensionName)) {
+            isExternalFenceCapabilitiesSupported = true;
+        }
+        if(!strcmp(debugUtilsInstanceExtension, vkExtensionProperties[i].extensionName)) {
+            isDebugUtilsSupported = true;
+        }
+#ifdef GLOVE_DIRECT_DISPLAY_PLATFORM
+        if(!isHeadless && !strcmp(displaySurfaceCounterInstanceExtension, vkExtensionProperties[i].extensionName)) {
+            isDisplaySurfaceCounterSupported = true;
+        }
+#endif // GLOVE_DIRECT_DISPLAY_PLATFORM
     }
+    isExternalMemoryCapabilitiesSupported = isExternalMemoryCapabilitiesSupported && isPhysicalDeviceProperties2Supported;
+    isExternalFenceCapabilitiesSupported  = isExternalFenceCapabilitiesSupported  && isPhysicalDeviceProperties2Supported;
 
     if(vkExtensionProperties) {
         free(vkExtensionProperties);
@@ -162,325 +318,1841 @@ CheckVkInstanceExtensions(void)
     return true;
 }
 
-bool
-CheckVkDeviceExtensions(void)
+static bool
+CheckVkExtendedDynamicStateFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult res;
-    uint32_t extensionCount = 0;
-    VkExtensionProperties *vkExtensionProperties = nullptr;
+#ifdef VK_EXT_extended_dynamic_state
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
+    }
 
-    do {
-        res = vkEnumerateDeviceExtensionProperties(GloveVkContext.vkGpus[0], nullptr, &extensionCount, nullptr);
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr) {
+        return false;
+    }
 
-        if(!extensionCount || res) {
-            break;
-        }
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures;
+    memset(static_cast<void *>(&extendedDynamicStateFeatures), 0, sizeof(extendedDynamicStateFeatures));
+    extendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
 
-        vkExtensionProperties = (VkExtensionProperties *)realloc(vkExtensionProperties, extensionCount * sizeof(*vkExtensionProperties));
-        if(!vkExtensionProperties) {
-            return false;
-        }
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &extendedDynamicStateFeatures;
 
-        res = vkEnumerateDeviceExtensionProperties(GloveVkContext.vkGpus[0], nullptr, &extensionCount, vkExtensionProperties);
-    } while(res == VK_INCOMPLETE);
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
 
-    std::vector<bool> requiredExtensionsAvailable(requiredDeviceExtensions.size(), false);
-    for(uint32_t i = 0; i < extensionCount; ++i) {
-        for(uint32_t j = 0; j < requiredDeviceExtensions.size(); ++j) {
-            if(!strcmp(requiredDeviceExtensions[j], vkExtensionProperties[i].extensionName)) {
-                requiredExtensionsAvailable[j] = true;
-                break;
-            }
-        }
-    }
+    return extendedDynamicStateFeatures.extendedDynamicState == VK_TRUE;
+#else
+    return false;
+#endif // VK_EXT_extended_dynamic_state
+}
 
-    GetContext()->mIsMaintenanceExtSupported = false;
-    for(uint32_t i = 0; i < extensionCount; ++i) {
-        for(uint32_t j = 0; j < usefulDeviceExtensions.size(); ++j) {
-            if(!strcmp(usefulDeviceExtensions[j], vkExtensionProperties[i].extensionName)) {
-                GetContext()->mIsMaintenanceExtSupported = true;
-                break;
-            }
-        }
-    }
+static bool
+CheckVkIndexTypeUint8Feature(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(vkExtensionProperties) {
-        free(vkExtensionProperties);
-        vkExtensionProperties = nullptr;
+#ifdef VK_EXT_index_type_uint8
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
     }
 
-    for(uint32_t j = 0; j < requiredDeviceExtensions.size(); ++j) {
-        if(!requiredExtensionsAvailable[j]) {
-            printf("\n%s extension is mandatory for GLOVE\n", requiredDeviceExtensions[j]);
-            printf("Please link GLOVE to a Vulkan driver which supports the latter\n");
-            return false;
-        }
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr) {
+        return false;
     }
 
-    return true;
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT indexTypeUint8Features;
+    memset(static_cast<void *>(&indexTypeUint8Features), 0, sizeof(indexTypeUint8Features));
+    indexTypeUint8Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &indexTypeUint8Features;
+
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+
+    return indexTypeUint8Features.indexTypeUint8 == VK_TRUE;
+#else
+    return false;
+#endif // VK_EXT_index_type_uint8
 }
 
-bool
-CreateVkInstance(void)
+static bool
+CheckVkTriangleFanFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint32_t enabledLayerCount = 0;
-    if(GLOVE_VK_VALIDATION_LAYERS) {
-        if(InitVkLayers(&enabledLayerCount) == false) {
-            return false;
-        }
+#ifdef VK_KHR_portability_subset
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
     }
 
-    VkApplicationInfo applicationInfo;
-    applicationInfo.sType             = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    applicationInfo.pNext             = nullptr;
-    applicationInfo.pApplicationName  = "GLOVE (GL Over Vulkan)\0";
-    applicationInfo.applicationVersion= 1;
-    applicationInfo.pEngineName       = "GLOVE (GL Over Vulkan)\0";
-    applicationInfo.engineVersion     = 1;
-    applicationInfo.apiVersion        = VK_API_VERSION_1_0;
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr) {
+        return false;
+    }
 
-    VkInstanceCreateInfo instanceInfo;
-    memset(static_cast<void *>(&instanceInfo), 0 ,sizeof(instanceInfo));
-    instanceInfo.sType                    = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-    instanceInfo.pNext                    = nullptr;
-    instanceInfo.flags                    = 0;
-    instanceInfo.pApplicationInfo         = &applicationInfo;
-    instanceInfo.enabledLayerCount        = enabledLayerCount;
-    instanceInfo.ppEnabledLayerNames      = enabledInstanceLayers;
-    instanceInfo.enabledExtensionCount    = static_cast<uint32_t>(requiredInstanceExtensions.size());
-    instanceInfo.ppEnabledExtensionNames  = requiredInstanceExtensions.data();
+    VkPhysicalDevicePortabilitySubsetFeaturesKHR portabilitySubsetFeatures;
+    memset(static_cast<void *>(&portabilitySubsetFeatures), 0, sizeof(portabilitySubsetFeatures));
+    portabilitySubsetFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PORTABILITY_SUBSET_FEATURES_KHR;
 
-    VkResult err = vkCreateInstance(&instanceInfo, nullptr, &GloveVkContext.vkInstance);
-    assert(!err);
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &portabilitySubsetFeatures;
 
-    for(uint32_t i = 0; i < enabledLayerCount; ++i) {
-       free(enabledInstanceLayers[i]);
-    }
-    free(enabledInstanceLayers);
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
 
-    return (err == VK_SUCCESS);
+    return portabilitySubsetFeatures.triangleFans == VK_TRUE;
+#else
+    // the subset is not known to these headers, so fans are taken to be missing from it
+    return false;
+#endif // VK_KHR_portability_subset
 }
 
-bool
-EnumerateVkGpus(void)
+static bool
+CheckVkTimelineSemaphoreFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint32_t gpuCount;
-
-    VkResult err;
-    err = vkEnumeratePhysicalDevices(GloveVkContext.vkInstance, &gpuCount, nullptr);
-    assert(!err);
-
-    if(err != VK_SUCCESS) {
+#ifdef VK_KHR_timeline_semaphore
+    if(!isPhysicalDeviceProperties2Supported) {
         return false;
     }
 
-    GloveVkContext.vkGpus.resize(gpuCount);
-
-    err = vkEnumeratePhysicalDevices(GloveVkContext.vkInstance, &gpuCount, GloveVkContext.vkGpus.data());
-    assert(!err);
-
-    if(err != VK_SUCCESS) {
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr) {
         return false;
     }
 
-    vkGetPhysicalDeviceMemoryProperties(GloveVkContext.vkGpus[0], &GloveVkContext.vkDeviceMemoryProperties);
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures;
+    memset(static_cast<void *>(&timelineSemaphoreFeatures), 0, sizeof(timelineSemaphoreFeatures));
+    timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
 
-    return true;
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &timelineSemaphoreFeatures;
+
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+
+    return timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE;
+#else
+    return false;
+#endif // VK_KHR_timeline_semaphore
 }
 
-bool
-InitVkQueueFamilyIndex(void)
+static bool
+CheckVkTransformFeedbackFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint32_t queueFamilyCount;
-    vkGetPhysicalDeviceQueueFamilyProperties(GloveVkContext.vkGpus[0], &queueFamilyCount, nullptr);
-    assert(queueFamilyCount >= 1);
-    if(!queueFamilyCount) {
+#ifdef VK_EXT_transform_feedback
+    if(!isPhysicalDeviceProperties2Supported) {
         return false;
     }
 
-    VkQueueFamilyProperties *queueProperties = new VkQueueFamilyProperties[queueFamilyCount];
-    vkGetPhysicalDeviceQueueFamilyProperties(GloveVkContext.vkGpus[0], &queueFamilyCount, queueProperties);
-
-    uint32_t i;
-    for(i = 0; i < queueFamilyCount; ++i) {
-        if(queueProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            GloveVkContext.vkGraphicsQueueNodeIndex = i;
-            break;
-        }
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr) {
+        return false;
     }
 
-    delete[] queueProperties;
-    return i < queueFamilyCount ? true : false;
+    VkPhysicalDeviceTransformFeedbackFeaturesEXT transformFeedbackFeatures;
+    memset(static_cast<void *>(&transformFeedbackFeatures), 0, sizeof(transformFeedbackFeatures));
+    transformFeedbackFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TRANSFORM_FEEDBACK_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &transformFeedbackFeatures;
+
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+
+    return transformFeedbackFeatures.transformFeedback == VK_TRUE;
+#else
+    return false;
+#endif // VK_EXT_transform_feedback
 }
 
-bool
-CreateVkDevice(void)
+static bool
+CheckVkDynamicRenderingFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    float queue_priorities[1] = {0.0};
-    VkDeviceQueueCreateInfo queueInfo;
-    queueInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueInfo.pNext            = nullptr;
-    queueInfo.flags            = 0;
-    queueInfo.queueCount       = 1;
-    queueInfo.pQueuePriorities = queue_priorities;
-    queueInfo.queueFamilyIndex = GloveVkContext.vkGraphicsQueueNodeIndex;
-
-    std::vector<const char*> enabledExtensions(requiredDeviceExtensions);
+#ifdef VK_KHR_dynamic_rendering
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
+    }
 
-    if(true == GetContext()->mIsMaintenanceExtSupported) {
-        enabledExtensions.insert(enabledExtensions.end(), usefulDeviceExtensions.begin(), usefulDeviceExtensions.end());
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr) {
+        return false;
     }
 
-    VkDeviceCreateInfo deviceInfo;
-    deviceInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceInfo.pNext                   = nullptr;
-    deviceInfo.flags                   = 0;
-    deviceInfo.queueCreateInfoCount    = 1;
-    deviceInfo.pQueueCreateInfos       = &queueInfo;
-    deviceInfo.enabledLayerCount       = 0;
-    deviceInfo.ppEnabledLayerNames     = nullptr;
-    deviceInfo.enabledExtensionCount   = enabledExtensions.size();
-    deviceInfo.ppEnabledExtensionNames = enabledExtensions.data();
-    deviceInfo.pEnabledFeatures        = nullptr;
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures;
+    memset(static_cast<void *>(&dynamicRenderingFeatures), 0, sizeof(dynamicRenderingFeatures));
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
 
-    VkResult err = vkCreateDevice(GloveVkContext.vkGpus[0], &deviceInfo, nullptr, &GloveVkContext.vkDevice);
-    assert(!err);
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &dynamicRenderingFeatures;
 
-    return (err == VK_SUCCESS);
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+
+    return dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+#else
+    return false;
+#endif // VK_KHR_dynamic_rendering
 }
 
-bool
-CreateVkSemaphores(void)
+static bool
+CheckVkGraphicsPipelineLibraryFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err;
+#ifdef VK_EXT_graphics_pipeline_library
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
+    }
 
-    GloveVkContext.vkSyncItems = new vkSyncItems_t;
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    PFN_vkGetPhysicalDeviceProperties2KHR getPhysicalDeviceProperties2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceProperties2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr || getPhysicalDeviceProperties2 == nullptr) {
+        return false;
+    }
 
-    VkSemaphoreCreateInfo semaphoreCreateInfo;
-    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext = nullptr;
-    semaphoreCreateInfo.flags = 0;
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures;
+    memset(static_cast<void *>(&pipelineLibraryFeatures), 0, sizeof(pipelineLibraryFeatures));
+    pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
 
-    err = vkCreateSemaphore(GloveVkContext.vkDevice, &semaphoreCreateInfo, nullptr, &GloveVkContext.vkSyncItems->vkDrawSemaphore);
-    assert(!err);
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &pipelineLibraryFeatures;
 
-    if(err != VK_SUCCESS) {
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+    if(pipelineLibraryFeatures.graphicsPipelineLibrary != VK_TRUE) {
         return false;
     }
 
-    err = vkCreateSemaphore(GloveVkContext.vkDevice, &semaphoreCreateInfo, nullptr, &GloveVkContext.vkSyncItems->vkAcquireSemaphore);
-    assert(!err);
+    // linking is only worth it at draw time where it is much faster than compiling
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT pipelineLibraryProperties;
+    memset(static_cast<void *>(&pipelineLibraryProperties), 0, sizeof(pipelineLibraryProperties));
+    pipelineLibraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
 
-    if(err != VK_SUCCESS) {
-        return false;
-    }
+    VkPhysicalDeviceProperties2KHR properties;
+    memset(static_cast<void *>(&properties), 0, sizeof(properties));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &pipelineLibraryProperties;
 
-    GloveVkContext.vkSyncItems->acquireSemaphoreFlag = true;
-    GloveVkContext.vkSyncItems->drawSemaphoreFlag = false;
+    getPhysicalDeviceProperties2(GloveVkContext.vkPhysicalDevice, &properties);
 
-    return true;
+    return pipelineLibraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+#else
+    return false;
+#endif // VK_EXT_graphics_pipeline_library
 }
 
-void
-InitVkQueue(void)
+static bool
+CheckVkMultiviewFeature(uint32_t *maxViewCount)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    vkGetDeviceQueue(GloveVkContext.vkDevice,
-                     GloveVkContext.vkGraphicsQueueNodeIndex,
-                     0,
-                     &GloveVkContext.vkQueue);
-}
+#ifdef VK_KHR_multiview
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
+    }
 
-vkContext_t *
-GetContext()
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    PFN_vkGetPhysicalDeviceProperties2KHR getPhysicalDeviceProperties2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceProperties2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr || getPhysicalDeviceProperties2 == nullptr) {
+        return false;
+    }
 
-    return &GloveVkContext;
-}
+    VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures;
+    memset(static_cast<void *>(&multiviewFeatures), 0, sizeof(multiviewFeatures));
+    multiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
 
-void
-ResetContextResources()
-{
-    GloveVkContext.vkInstance                   = VK_NULL_HANDLE;
-    GloveVkContext.vkGpus.clear();
-    GloveVkContext.vkQueue                      = VK_NULL_HANDLE;
-    GloveVkContext.vkGraphicsQueueNodeIndex     = 0;
-    GloveVkContext.vkDevice                     = VK_NULL_HANDLE;
-    GloveVkContext.vkSyncItems                  = nullptr;
-    GloveVkContext.mIsMaintenanceExtSupported   = false;
-    GloveVkContext.mInitialized                 = false;
-    memset(static_cast<void*>(&GloveVkContext.vkDeviceMemoryProperties), 0,
-           sizeof(VkPhysicalDeviceMemoryProperties));
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &multiviewFeatures;
+
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+    if(multiviewFeatures.multiview != VK_TRUE) {
+        return false;
+    }
+
+    VkPhysicalDeviceMultiviewPropertiesKHR multiviewProperties;
+    memset(static_cast<void *>(&multiviewProperties), 0, sizeof(multiviewProperties));
+    multiviewProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES_KHR;
+
+    VkPhysicalDeviceProperties2KHR properties;
+    memset(static_cast<void *>(&properties), 0, sizeof(properties));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &multiviewProperties;
+
+    getPhysicalDeviceProperties2(GloveVkContext.vkPhysicalDevice, &properties);
+    *maxViewCount = multiviewProperties.maxMultiviewViewCount;
+
+    return multiviewProperties.maxMultiviewViewCount > 1;
+#else
+    return false;
+#endif // VK_KHR_multiview
 }
 
-bool
-InitContext()
+static bool
+CheckVkHostImageCopyFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if (GloveVkContext.mInitialized == true) {
-        return true;
+#ifdef VK_EXT_host_image_copy
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
     }
 
-    ResetContextResources();
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    PFN_vkGetPhysicalDeviceProperties2KHR getPhysicalDeviceProperties2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceProperties2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr || getPhysicalDeviceProperties2 == nullptr) {
+        return false;
+    }
 
-    if( !CheckVkInstanceExtensions()  ||
-        !CreateVkInstance()           ||
-        !EnumerateVkGpus()            ||
-        !InitVkQueueFamilyIndex()     ||
-        !CheckVkDeviceExtensions()    ||
-        !CreateVkDevice()             ||
-        !CreateVkSemaphores()
-      ) {
-        assert(false);
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures;
+    memset(static_cast<void *>(&hostImageCopyFeatures), 0, sizeof(hostImageCopyFeatures));
+    hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &hostImageCopyFeatures;
+
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+    if(hostImageCopyFeatures.hostImageCopy != VK_TRUE) {
         return false;
     }
-    InitVkQueue();
 
-    GloveVkContext.mInitialized = true;
+    // textures are kept in the general layout, which host copies have to be able to write in
+    VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties;
+    memset(static_cast<void *>(&hostImageCopyProperties), 0, sizeof(hostImageCopyProperties));
+    hostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
 
-    return GloveVkContext.mInitialized;
+    VkPhysicalDeviceProperties2KHR properties;
+    memset(static_cast<void *>(&properties), 0, sizeof(properties));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &hostImageCopyProperties;
+
+    getPhysicalDeviceProperties2(GloveVkContext.vkPhysicalDevice, &properties);
+
+    std::vector<VkImageLayout> copyDstLayouts(hostImageCopyProperties.copyDstLayoutCount);
+    hostImageCopyProperties.pCopyDstLayouts = copyDstLayouts.data();
+    getPhysicalDeviceProperties2(GloveVkContext.vkPhysicalDevice, &properties);
+
+    return std::find(copyDstLayouts.begin(), copyDstLayouts.end(), VK_IMAGE_LAYOUT_GENERAL) != copyDstLayouts.end();
+#else
+    return false;
+#endif // VK_EXT_host_image_copy
 }
 
-void
-TerminateContext()
+static bool
+CheckVkDescriptorIndexingFeature(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(!GloveVkContext.mInitialized) {
-        return;
+#ifdef VK_EXT_descriptor_indexing
+    if(!isPhysicalDeviceProperties2Supported) {
+        return false;
     }
 
-    if(GloveVkContext.vkSyncItems->vkAcquireSemaphore != VK_NULL_HANDLE) {
-        vkDestroySemaphore(GloveVkContext.vkDevice, GloveVkContext.vkSyncItems->vkAcquireSemaphore, nullptr);
-        GloveVkContext.vkSyncItems->vkAcquireSemaphore = VK_NULL_HANDLE;
+    PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFeatures2KHR"));
+    PFN_vkGetPhysicalDeviceProperties2KHR getPhysicalDeviceProperties2 =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceProperties2KHR"));
+    if(getPhysicalDeviceFeatures2 == nullptr || getPhysicalDeviceProperties2 == nullptr) {
+        return false;
     }
 
-    if(GloveVkContext.vkSyncItems->vkDrawSemaphore != VK_NULL_HANDLE) {
-        vkDestroySemaphore(GloveVkContext.vkDevice, GloveVkContext.vkSyncItems->vkDrawSemaphore, nullptr);
-        GloveVkContext.vkSyncItems->vkDrawSemaphore = VK_NULL_HANDLE;
-    }
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures;
+    memset(static_cast<void *>(&descriptorIndexingFeatures), 0, sizeof(descriptorIndexingFeatures));
+    descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2KHR features;
+    memset(static_cast<void *>(&features), 0, sizeof(features));
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &descriptorIndexingFeatures;
+
+    getPhysicalDeviceFeatures2(GloveVkContext.vkPhysicalDevice, &features);
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties;
+    memset(static_cast<void *>(&descriptorIndexingProperties), 0, sizeof(descriptorIndexingProperties));
+    descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2KHR properties;
+    memset(static_cast<void *>(&properties), 0, sizeof(properties));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &descriptorIndexingProperties;
+
+    getPhysicalDeviceProperties2(GloveVkContext.vkPhysicalDevice, &properties);
+
+    // the table is indexed with dynamically uniform values, and written while the command buffers that bind it are pending
+    const uint32_t tableSize = GLOVE_BINDLESS_TEXTURE_BINDINGS * GLOVE_BINDLESS_TEXTURE_COUNT;
+    return features.features.shaderSampledImageArrayDynamicIndexing                 == VK_TRUE &&
+           descriptorIndexingFeatures.descriptorBindingPartiallyBound              == VK_TRUE &&
+           descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+           descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending    == VK_TRUE &&
+           descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers     >= tableSize &&
+           descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages >= tableSize &&
+           descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSamplers          >= tableSize &&
+           descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages     >= tableSize &&
+           descriptorIndexingProperties.maxPerStageUpdateAfterBindResources              >= tableSize;
+#else
+    return false;
+#endif // VK_EXT_descriptor_indexing
+}
 
-    if(GloveVkContext.vkDevice != VK_NULL_HANDLE ) {
-        vkDeviceWaitIdle(GloveVkContext.vkDevice);
-        vkDestroyDevice(GloveVkContext.vkDevice, nullptr);
-        vkDestroyInstance(GloveVkContext.vkInstance, nullptr);
+static bool
+CheckVkMultiDrawIndirectFeature(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(GloveVkContext.vkPhysicalDevice, &features);
+
+    return features.multiDrawIndirect == VK_TRUE;
+}
+
+static bool
+CheckVkInheritedQueriesFeature(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(GloveVkContext.vkPhysicalDevice, &features);
+
+    return features.inheritedQueries == VK_TRUE;
+}
+
+static void
+CheckVkTextureCompressionFeatures(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(GloveVkContext.vkPhysicalDevice, &features);
+
+    GetContext()->mIsTextureCompressionETC2Supported = features.textureCompressionETC2     == VK_TRUE;
+    GetContext()->mIsTextureCompressionASTCSupported = features.textureCompressionASTC_LDR == VK_TRUE;
+    GetContext()->mIsTextureCompressionBCSupported   = features.textureCompressionBC       == VK_TRUE;
+}
+
+static void
+CheckVkVertexFormats(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // every 8, 16 and 32 bit layout a GL attribute type is read with, or repacked or converted to
+    GetContext()->vkVertexFormats.reset();
+    for(uint32_t format = VK_FORMAT_R8_UNORM; format <= VK_FORMAT_R32G32B32A32_SFLOAT; ++format) {
+        VkFormatProperties properties = GloveVkContext.capabilityCache->GetFormatProperties(static_cast<VkFormat>(format));
+        GetContext()->vkVertexFormats[format] = (properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) != 0;
+    }
+}
+
+static void
+CheckVkFramebufferSampleCounts(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GloveVkContext.vkPhysicalDevice, &properties);
+
+    GetContext()->vkFramebufferSampleCounts = properties.limits.framebufferColorSampleCounts &
+                                              properties.limits.framebufferDepthSampleCounts &
+                                              properties.limits.framebufferStencilSampleCounts;
+}
+
+static void
+CheckVkTimestampSupport(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GloveVkContext.vkPhysicalDevice, &properties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(GloveVkContext.vkPhysicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueProperties(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(GloveVkContext.vkPhysicalDevice, &queueFamilyCount, queueProperties.data());
+
+    // timestamps are written only into the draw and auxiliary command buffers, both run on the graphics queue
+    GetContext()->vkTimestampValidBits = GloveVkContext.vkGraphicsQueueNodeIndex < queueFamilyCount ?
+                                         queueProperties[GloveVkContext.vkGraphicsQueueNodeIndex].timestampValidBits : 0;
+    GetContext()->vkTimestampPeriod    = properties.limits.timestampPeriod;
+    if(GetContext()->vkTimestampPeriod <= 0.0f) {
+        GetContext()->vkTimestampValidBits = 0;
+    }
+
+    GetContext()->vkMinStorageBufferOffsetAlignment = properties.limits.minStorageBufferOffsetAlignment ?
+                                                      properties.limits.minStorageBufferOffsetAlignment : 1;
+    GetContext()->vkMinUniformBufferOffsetAlignment = properties.limits.minUniformBufferOffsetAlignment ?
+                                                      properties.limits.minUniformBufferOffsetAlignment : 1;
+    GetContext()->vkMaxUniformBufferRange           = properties.limits.maxUniformBufferRange;
+}
+
+static bool
+HasVkDeviceExtensions(const std::vector<const char*> &extensions, const VkExtensionProperties *vkExtensionProperties, uint32_t extensionCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(const char *extension : extensions) {
+        uint32_t i = 0;
+        while(i < extensionCount && strcmp(extension, vkExtensionProperties[i].extensionName)) {
+            ++i;
+        }
+        if(i == extensionCount) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void
+AppendVkDeviceExtensions(std::vector<const char*> *enabledExtensions, const std::vector<const char*> &extensions)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the sets share dependencies, which are enabled once
+    for(const char *extension : extensions) {
+        bool enabled = false;
+        for(const char *enabledExtension : *enabledExtensions) {
+            if(!strcmp(extension, enabledExtension)) {
+                enabled = true;
+                break;
+            }
+        }
+        if(!enabled) {
+            enabledExtensions->push_back(extension);
+        }
+    }
+}
+
+bool
+CheckVkDeviceExtensions(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the list is enumerated once per driver, later processes find it next to the pipeline cache
+    const std::vector<VkExtensionProperties> &deviceExtensions = GloveVkContext.capabilityCache->GetDeviceExtensions();
+    const uint32_t extensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    const VkExtensionProperties *vkExtensionProperties = deviceExtensions.data();
+
+    const std::vector<const char*> &requiredDeviceExtensions = GetRequiredDeviceExtensions();
+    std::vector<bool> requiredExtensionsAvailable(requiredDeviceExtensions.size(), false);
+    for(uint32_t i = 0; i < extensionCount; ++i) {
+        for(uint32_t j = 0; j < requiredDeviceExtensions.size(); ++j) {
+            if(!strcmp(requiredDeviceExtensions[j], vkExtensionProperties[i].extensionName)) {
+                requiredExtensionsAvailable[j] = true;
+                break;
+            }
+        }
+    }
+
+    GetContext()->mIsMaintenanceExtSupported = false;
+    GetContext()->mIsExtendedDynamicStateSupported = false;
+    GetContext()->mIsIndexTypeUint8Supported = false;
+    GetContext()->mIsDescriptorUpdateTemplateSupported = false;
+    GetContext()->mIsIncrementalPresentSupported = false;
+    GetContext()->mIsDisplayTimingSupported = false;
+    GetContext()->mIsDisplayControlSupported = false;
+    GetContext()->mIsMemoryBudgetSupported = false;
+    GetContext()->mIsTimelineSemaphoreSupported = false;
+    GetContext()->mIsTransformFeedbackSupported = false;
+    GetContext()->mIsHostImageCopySupported = false;
+    GetContext()->mIsDynamicRenderingSupported = false;
+    GetContext()->mIsGraphicsPipelineLibrarySupported = false;
+    GetContext()->mIsMultiviewSupported = false;
+    GetContext()->vkMaxMultiviewViewCount = 1;
+    GetContext()->mIsPortabilitySubset = false;
+#ifdef VK_USE_PLATFORM_MACOS_MVK
+    // MoltenVK emulates fans with a conversion of its own on every draw, even where it does not list the subset
+    GetContext()->mIsTriangleFanSupported = false;
+#else
+    GetContext()->mIsTriangleFanSupported = true;
+#endif // VK_USE_PLATFORM_MACOS_MVK
+    for(uint32_t i = 0; i < extensionCount; ++i) {
+        for(uint32_t j = 0; j < usefulDeviceExtensions.size(); ++j) {
+            if(!strcmp(usefulDeviceExtensions[j], vkExtensionProperties[i].extensionName)) {
+                GetContext()->mIsMaintenanceExtSupported = true;
+                break;
+            }
+        }
+        if(!strcmp(extendedDynamicStateDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsExtendedDynamicStateSupported = CheckVkExtendedDynamicStateFeature();
+        }
+        if(!strcmp(indexTypeUint8DeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsIndexTypeUint8Supported = CheckVkIndexTypeUint8Feature();
+        }
+#ifdef VK_KHR_descriptor_update_template
+        if(!strcmp(descriptorUpdateTemplateDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsDescriptorUpdateTemplateSupported = true;
+        }
+#endif // VK_KHR_descriptor_update_template
+#ifdef VK_KHR_incremental_present
+        if(!isHeadless && !strcmp(incrementalPresentDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsIncrementalPresentSupported = true;
+        }
+#endif // VK_KHR_incremental_present
+#if defined(VK_GOOGLE_display_timing) && defined(VK_USE_PLATFORM_ANDROID_KHR)
+        // presentation times are only paced on Android, where EGL_ANDROID_presentation_time is exposed through it
+        if(!isHeadless && !strcmp(displayTimingDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsDisplayTimingSupported = true;
+        }
+#endif // VK_GOOGLE_display_timing && VK_USE_PLATFORM_ANDROID_KHR
+#if defined(VK_EXT_display_control) && defined(GLOVE_DIRECT_DISPLAY_PLATFORM)
+        if(isDisplaySurfaceCounterSupported && !strcmp(displayControlDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsDisplayControlSupported = true;
+        }
+#endif // VK_EXT_display_control && GLOVE_DIRECT_DISPLAY_PLATFORM
+#ifdef VK_EXT_memory_budget
+        // the budget is queried along with the memory properties, through the instance extension
+        if(isPhysicalDeviceProperties2Supported && !strcmp(memoryBudgetDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsMemoryBudgetSupported = true;
+        }
+#endif // VK_EXT_memory_budget
+        if(!strcmp(timelineSemaphoreDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsTimelineSemaphoreSupported = CheckVkTimelineSemaphoreFeature();
+        }
+        if(!strcmp(transformFeedbackDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsTransformFeedbackSupported = CheckVkTransformFeedbackFeature();
+        }
+        if(!strcmp(portabilitySubsetDeviceExtension, vkExtensionProperties[i].extensionName)) {
+            GetContext()->mIsPortabilitySubset    = true;
+            GetContext()->mIsTriangleFanSupported = CheckVkTriangleFanFeature();
+        }
+    }
+    GetContext()->mIsExternalMemoryDmaBufSupported  = isExternalMemoryCapabilitiesSupported &&
+                                                      HasVkDeviceExtensions(dmaBufDeviceExtensions, vkExtensionProperties, extensionCount);
+    GetContext()->mIsSyncFdFenceSupported           = isExternalFenceCapabilitiesSupported &&
+                                                      HasVkDeviceExtensions(syncFdFenceDeviceExtensions, vkExtensionProperties, extensionCount);
+    GetContext()->mIsDrmFormatModifierSupported     = GetContext()->mIsExternalMemoryDmaBufSupported &&
+                                                      HasVkDeviceExtensions(drmFormatModifierDeviceExtensions, vkExtensionProperties, extensionCount);
+    GetContext()->mIsHostImageCopySupported         = HasVkDeviceExtensions(hostImageCopyDeviceExtensions, vkExtensionProperties, extensionCount) &&
+                                                      CheckVkHostImageCopyFeature();
+    GetContext()->mIsDynamicRenderingSupported      = HasVkDeviceExtensions(dynamicRenderingDeviceExtensions, vkExtensionProperties, extensionCount) &&
+                                                      CheckVkDynamicRenderingFeature();
+    GetContext()->mIsGraphicsPipelineLibrarySupported = HasVkDeviceExtensions(pipelineLibraryDeviceExtensions, vkExtensionProperties, extensionCount) &&
+                                                      CheckVkGraphicsPipelineLibraryFeature();
+    GetContext()->mIsMultiviewSupported             = HasVkDeviceExtensions(multiviewDeviceExtensions, vkExtensionProperties, extensionCount) &&
+                                                      CheckVkMultiviewFeature(&GetContext()->vkMaxMultiviewViewCount);
+    if(!GetContext()->mIsMultiviewSupported) {
+        GetContext()->vkMaxMultiviewViewCount = 1;
+    }
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    GetContext()->mIsAndroidHardwareBufferSupported = isExternalMemoryCapabilitiesSupported &&
+                                                      HasVkDeviceExtensions(hardwareBufferDeviceExtensions, vkExtensionProperties, extensionCount);
+#else
+    GetContext()->mIsAndroidHardwareBufferSupported = false;
+#endif // VK_USE_PLATFORM_ANDROID_KHR
+    const char *bindlessTextures = getenv(GLOVE_BINDLESS_TEXTURES_ENV);
+    GetContext()->mUseBindlessTextures              = bindlessTextures != nullptr && atoi(bindlessTextures) != 0 &&
+                                                      HasVkDeviceExtensions(descriptorIndexingDeviceExtensions, vkExtensionProperties, extensionCount) &&
+                                                      CheckVkDescriptorIndexingFeature();
+    GetContext()->mIsMultiDrawIndirectSupported = CheckVkMultiDrawIndirectFeature();
+    GetContext()->mIsInheritedQueriesSupported  = CheckVkInheritedQueriesFeature();
+    CheckVkTextureCompressionFeatures();
+    CheckVkVertexFormats();
+    CheckVkFramebufferSampleCounts();
+    CheckVkTimestampSupport();
+
+    for(uint32_t j = 0; j < requiredDeviceExtensions.size(); ++j) {
+        if(!requiredExtensionsAvailable[j]) {
+            printf("\n%s extension is mandatory for GLOVE\n", requiredDeviceExtensions[j]);
+            printf("Please link GLOVE to a Vulkan driver which supports the latter\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+CreateVkInstance(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t enabledLayerCount = 0;
+    if(GLOVE_VK_VALIDATION_LAYERS) {
+        if(InitVkLayers(&enabledLayerCount) == false) {
+            return false;
+        }
+    }
+
+    VkApplicationInfo applicationInfo;
+    applicationInfo.sType             = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    applicationInfo.pNext             = nullptr;
+    applicationInfo.pApplicationName  = "GLOVE (GL Over Vulkan)\0";
+    applicationInfo.applicationVersion= 1;
+    applicationInfo.pEngineName       = "GLOVE (GL Over Vulkan)\0";
+    applicationInfo.engineVersion     = 1;
+    applicationInfo.apiVersion        = VK_API_VERSION_1_0;
+
+    VkInstanceCreateInfo instanceInfo;
+    memset(static_cast<void *>(&instanceInfo), 0 ,sizeof(instanceInfo));
+    instanceInfo.sType                    = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pNext                    = nullptr;
+    instanceInfo.flags                    = 0;
+    instanceInfo.pApplicationInfo         = &applicationInfo;
+    instanceInfo.enabledLayerCount        = enabledLayerCount;
+    instanceInfo.ppEnabledLayerNames      = enabledInstanceLayers;
+
+    std::vector<const char*> enabledExtensions(GetRequiredInstanceExtensions());
+    if(isPhysicalDeviceProperties2Supported) {
+        enabledExtensions.push_back(physicalDeviceProperties2InstanceExtension);
+    }
+    if(isExternalMemoryCapabilitiesSupported) {
+        enabledExtensions.push_back(externalMemoryCapabilitiesInstanceExtension);
+    }
+    if(isExternalFenceCapabilitiesSupported) {
+        enabledExtensions.push_back(externalFenceCapabilitiesInstanceExtension);
+    }
+    if(isDisplaySurfaceCounterSupported) {
+        enabledExtensions.push_back(displaySurfaceCounterInstanceExtension);
+    }
+    if(isDebugUtilsSupported) {
+        enabledExtensions.push_back(debugUtilsInstanceExtension);
+    }
+    instanceInfo.enabledExtensionCount    = static_cast<uint32_t>(enabledExtensions.size());
+    instanceInfo.ppEnabledExtensionNames  = enabledExtensions.data();
+
+    VkResult err = vkCreateInstance(&instanceInfo, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &GloveVkContext.vkInstance);
+    assert(!err);
+
+    for(uint32_t i = 0; i < enabledLayerCount; ++i) {
+       free(enabledInstanceLayers[i]);
+    }
+    free(enabledInstanceLayers);
+
+    return (err == VK_SUCCESS);
+}
+
+static bool
+HasVkGraphicsQueue(VkPhysicalDevice gpu)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueProperties(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, queueProperties.data());
+
+    for(const auto &properties : queueProperties) {
+        if(properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static VkDeviceSize
+GetVkDeviceLocalMemorySize(VkPhysicalDevice gpu)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(gpu, &memoryProperties);
+
+    VkDeviceSize size = 0;
+    for(uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i) {
+        if(memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            size += memoryProperties.memoryHeaps[i].size;
+        }
+    }
+
+    return size;
+}
+
+static VkPhysicalDevice
+SelectVkGpu(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the GPU asked for, by its index or by part of its name, is taken if it can render at all
+    const char *requested = getenv(GLOVE_GPU_ENV);
+    if(requested != nullptr && requested[0] != '\0') {
+        char *end = nullptr;
+        const unsigned long index = strtoul(requested, &end, 10);
+
+        for(uint32_t i = 0; i < GloveVkContext.vkGpus.size(); ++i) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(GloveVkContext.vkGpus[i], &properties);
+
+            const bool match = *end == '\0' ? index == i : strstr(properties.deviceName, requested) != nullptr;
+            if(match && HasVkGraphicsQueue(GloveVkContext.vkGpus[i])) {
+                return GloveVkContext.vkGpus[i];
+            }
+        }
+    }
+
+    // otherwise discrete GPUs come first, then integrated, virtual and CPU ones,
+    // with the one with most device local memory first among those of a kind
+    static const VkPhysicalDeviceType typeRanks[] = {VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU,
+                                                     VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU,  VK_PHYSICAL_DEVICE_TYPE_CPU};
+    const uint32_t typeRankCount = sizeof(typeRanks) / sizeof(typeRanks[0]);
+
+    VkPhysicalDevice best         = VK_NULL_HANDLE;
+    uint32_t         bestRank     = 0;
+    VkDeviceSize     bestHeapSize = 0;
+    for(const auto gpu : GloveVkContext.vkGpus) {
+        if(!HasVkGraphicsQueue(gpu)) {
+            continue;
+        }
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(gpu, &properties);
+
+        uint32_t rank = 0;
+        while(rank < typeRankCount && typeRanks[rank] != properties.deviceType) {
+            ++rank;
+        }
+
+        const VkDeviceSize heapSize = GetVkDeviceLocalMemorySize(gpu);
+        if(best == VK_NULL_HANDLE || rank < bestRank || (rank == bestRank && heapSize > bestHeapSize)) {
+            best         = gpu;
+            bestRank     = rank;
+            bestHeapSize = heapSize;
+        }
+    }
+
+    return best;
+}
+
+bool
+EnumerateVkGpus(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t gpuCount;
+
+    VkResult err;
+    err = vkEnumeratePhysicalDevices(GloveVkContext.vkInstance, &gpuCount, nullptr);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    GloveVkContext.vkGpus.resize(gpuCount);
+
+    err = vkEnumeratePhysicalDevices(GloveVkContext.vkInstance, &gpuCount, GloveVkContext.vkGpus.data());
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    GloveVkContext.vkPhysicalDevice = SelectVkGpu();
+    if(GloveVkContext.vkPhysicalDevice == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    vkGetPhysicalDeviceMemoryProperties(GloveVkContext.vkPhysicalDevice, &GloveVkContext.vkDeviceMemoryProperties);
+
+    return true;
+}
+
+bool
+InitVkQueueFamilyIndex(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t queueFamilyCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(GloveVkContext.vkPhysicalDevice, &queueFamilyCount, nullptr);
+    assert(queueFamilyCount >= 1);
+    if(!queueFamilyCount) {
+        return false;
+    }
+
+    VkQueueFamilyProperties *queueProperties = new VkQueueFamilyProperties[queueFamilyCount];
+    vkGetPhysicalDeviceQueueFamilyProperties(GloveVkContext.vkPhysicalDevice, &queueFamilyCount, queueProperties);
+
+    uint32_t i;
+    for(i = 0; i < queueFamilyCount; ++i) {
+        if(queueProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            GloveVkContext.vkGraphicsQueueNodeIndex = i;
+            break;
+        }
+    }
+
+    // prefer a dedicated transfer queue family (typically backed by a DMA engine)
+    // for texture uploads, then an async compute family, which can transfer too,
+    // then a second queue of the graphics family, otherwise share the graphics queue
+    GloveVkContext.vkTransferQueueNodeIndex = GloveVkContext.vkGraphicsQueueNodeIndex;
+    GloveVkContext.vkTransferQueueIndex     = 0;
+    uint32_t computeQueueNodeIndex = queueFamilyCount;
+    bool     dedicatedTransfer     = false;
+    for(uint32_t j = 0; j < queueFamilyCount; ++j) {
+        if(!queueProperties[j].queueCount || (queueProperties[j].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+            continue;
+        }
+        if((queueProperties[j].queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueProperties[j].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+            GloveVkContext.vkTransferQueueNodeIndex = j;
+            dedicatedTransfer = true;
+            break;
+        }
+        if((queueProperties[j].queueFlags & VK_QUEUE_COMPUTE_BIT) && computeQueueNodeIndex == queueFamilyCount) {
+            computeQueueNodeIndex = j;
+        }
+    }
+
+    if(!dedicatedTransfer && i < queueFamilyCount) {
+        if(computeQueueNodeIndex < queueFamilyCount) {
+            GloveVkContext.vkTransferQueueNodeIndex = computeQueueNodeIndex;
+        } else if(queueProperties[i].queueCount > 1) {
+            GloveVkContext.vkTransferQueueIndex = 1;
+        }
+    }
+    GloveVkContext.vkTransferQueueFlags = queueProperties[GloveVkContext.vkTransferQueueNodeIndex].queueFlags;
+
+    delete[] queueProperties;
+    return i < queueFamilyCount ? true : false;
+}
+
+bool
+CreateVkDevice(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // rendering is favored over the uploads when both share a family
+    float queue_priorities[2] = {1.0, 0.5};
+    VkDeviceQueueCreateInfo queueInfo[2];
+    queueInfo[0].sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo[0].pNext            = nullptr;
+    queueInfo[0].flags            = 0;
+    queueInfo[0].queueCount       = GloveVkContext.vkTransferQueueIndex + 1;
+    queueInfo[0].pQueuePriorities = queue_priorities;
+    queueInfo[0].queueFamilyIndex = GloveVkContext.vkGraphicsQueueNodeIndex;
+
+    uint32_t queueInfoCount = 1;
+    if(GloveVkContext.vkTransferQueueNodeIndex != GloveVkContext.vkGraphicsQueueNodeIndex) {
+        queueInfo[1] = queueInfo[0];
+        queueInfo[1].queueCount       = 1;
+        queueInfo[1].pQueuePriorities = &queue_priorities[1];
+        queueInfo[1].queueFamilyIndex = GloveVkContext.vkTransferQueueNodeIndex;
+        ++queueInfoCount;
+    }
+
+    std::vector<const char*> enabledExtensions(GetRequiredDeviceExtensions());
+
+    if(true == GetContext()->mIsMaintenanceExtSupported) {
+        enabledExtensions.insert(enabledExtensions.end(), usefulDeviceExtensions.begin(), usefulDeviceExtensions.end());
+    }
+
+    const void *deviceInfoNext = nullptr;
+#ifdef VK_EXT_extended_dynamic_state
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures;
+    memset(static_cast<void *>(&extendedDynamicStateFeatures), 0, sizeof(extendedDynamicStateFeatures));
+    extendedDynamicStateFeatures.sType                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+    extendedDynamicStateFeatures.extendedDynamicState = VK_TRUE;
+
+    if(true == GetContext()->mIsExtendedDynamicStateSupported) {
+        enabledExtensions.push_back(extendedDynamicStateDeviceExtension);
+        deviceInfoNext = &extendedDynamicStateFeatures;
+    }
+#endif // VK_EXT_extended_dynamic_state
+
+#ifdef VK_EXT_index_type_uint8
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT indexTypeUint8Features;
+    memset(static_cast<void *>(&indexTypeUint8Features), 0, sizeof(indexTypeUint8Features));
+    indexTypeUint8Features.sType          = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT;
+    indexTypeUint8Features.pNext          = const_cast<void *>(deviceInfoNext);
+    indexTypeUint8Features.indexTypeUint8 = VK_TRUE;
+
+    if(true == GetContext()->mIsIndexTypeUint8Supported) {
+        enabledExtensions.push_back(indexTypeUint8DeviceExtension);
+        deviceInfoNext = &indexTypeUint8Features;
+    }
+#endif // VK_EXT_index_type_uint8
+
+#ifdef VK_KHR_timeline_semaphore
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures;
+    memset(static_cast<void *>(&timelineSemaphoreFeatures), 0, sizeof(timelineSemaphoreFeatures));
+    timelineSemaphoreFeatures.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timelineSemaphoreFeatures.pNext             = const_cast<void *>(deviceInfoNext);
+    timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+
+    if(true == GetContext()->mIsTimelineSemaphoreSupported) {
+        enabledExtensions.push_back(timelineSemaphoreDeviceExtension);
+        deviceInfoNext = &timelineSemaphoreFeatures;
+    }
+#endif // VK_KHR_timeline_semaphore
+
+#ifdef VK_EXT_transform_feedback
+    VkPhysicalDeviceTransformFeedbackFeaturesEXT transformFeedbackFeatures;
+    memset(static_cast<void *>(&transformFeedbackFeatures), 0, sizeof(transformFeedbackFeatures));
+    transformFeedbackFeatures.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TRANSFORM_FEEDBACK_FEATURES_EXT;
+    transformFeedbackFeatures.pNext             = const_cast<void *>(deviceInfoNext);
+    transformFeedbackFeatures.transformFeedback = VK_TRUE;
+
+    if(true == GetContext()->mIsTransformFeedbackSupported) {
+        enabledExtensions.push_back(transformFeedbackDeviceExtension);
+        deviceInfoNext = &transformFeedbackFeatures;
+    }
+#endif // VK_EXT_transform_feedback
+
+#ifdef VK_EXT_host_image_copy
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures;
+    memset(static_cast<void *>(&hostImageCopyFeatures), 0, sizeof(hostImageCopyFeatures));
+    hostImageCopyFeatures.sType         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+    hostImageCopyFeatures.pNext         = const_cast<void *>(deviceInfoNext);
+    hostImageCopyFeatures.hostImageCopy = VK_TRUE;
+
+    if(true == GetContext()->mIsHostImageCopySupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, hostImageCopyDeviceExtensions);
+        deviceInfoNext = &hostImageCopyFeatures;
+    }
+#endif // VK_EXT_host_image_copy
+
+#ifdef VK_KHR_dynamic_rendering
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures;
+    memset(static_cast<void *>(&dynamicRenderingFeatures), 0, sizeof(dynamicRenderingFeatures));
+    dynamicRenderingFeatures.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRenderingFeatures.pNext            = const_cast<void *>(deviceInfoNext);
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+    if(true == GetContext()->mIsDynamicRenderingSupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, dynamicRenderingDeviceExtensions);
+        deviceInfoNext = &dynamicRenderingFeatures;
+    }
+#endif // VK_KHR_dynamic_rendering
+
+#ifdef VK_KHR_multiview
+    VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures;
+    memset(static_cast<void *>(&multiviewFeatures), 0, sizeof(multiviewFeatures));
+    multiviewFeatures.sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
+    multiviewFeatures.pNext     = const_cast<void *>(deviceInfoNext);
+    multiviewFeatures.multiview = VK_TRUE;
+
+    if(true == GetContext()->mIsMultiviewSupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, multiviewDeviceExtensions);
+        deviceInfoNext = &multiviewFeatures;
+    }
+#endif // VK_KHR_multiview
+
+#ifdef VK_EXT_graphics_pipeline_library
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures;
+    memset(static_cast<void *>(&pipelineLibraryFeatures), 0, sizeof(pipelineLibraryFeatures));
+    pipelineLibraryFeatures.sType                   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    pipelineLibraryFeatures.pNext                   = const_cast<void *>(deviceInfoNext);
+    pipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+    if(true == GetContext()->mIsGraphicsPipelineLibrarySupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, pipelineLibraryDeviceExtensions);
+        deviceInfoNext = &pipelineLibraryFeatures;
+    }
+#endif // VK_EXT_graphics_pipeline_library
+
+#ifdef VK_KHR_portability_subset
+    VkPhysicalDevicePortabilitySubsetFeaturesKHR portabilitySubsetFeatures;
+    memset(static_cast<void *>(&portabilitySubsetFeatures), 0, sizeof(portabilitySubsetFeatures));
+    portabilitySubsetFeatures.sType        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PORTABILITY_SUBSET_FEATURES_KHR;
+    portabilitySubsetFeatures.pNext        = const_cast<void *>(deviceInfoNext);
+    portabilitySubsetFeatures.triangleFans = GetContext()->mIsTriangleFanSupported ? VK_TRUE : VK_FALSE;
+
+    if(true == GetContext()->mIsPortabilitySubset) {
+        deviceInfoNext = &portabilitySubsetFeatures;
+    }
+#endif // VK_KHR_portability_subset
+
+    if(true == GetContext()->mIsPortabilitySubset) {
+        enabledExtensions.push_back(portabilitySubsetDeviceExtension);
+    }
+
+#ifdef VK_EXT_descriptor_indexing
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures;
+    memset(static_cast<void *>(&descriptorIndexingFeatures), 0, sizeof(descriptorIndexingFeatures));
+    descriptorIndexingFeatures.sType                                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    descriptorIndexingFeatures.pNext                                     = const_cast<void *>(deviceInfoNext);
+    descriptorIndexingFeatures.descriptorBindingPartiallyBound              = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending    = VK_TRUE;
+
+    if(true == GetContext()->mUseBindlessTextures) {
+        AppendVkDeviceExtensions(&enabledExtensions, descriptorIndexingDeviceExtensions);
+        deviceInfoNext = &descriptorIndexingFeatures;
+    }
+#endif // VK_EXT_descriptor_indexing
+
+    if(true == GetContext()->mIsDescriptorUpdateTemplateSupported) {
+        enabledExtensions.push_back(descriptorUpdateTemplateDeviceExtension);
+    }
+
+    if(true == GetContext()->mIsIncrementalPresentSupported) {
+        enabledExtensions.push_back(incrementalPresentDeviceExtension);
+    }
+
+    if(true == GetContext()->mIsDisplayTimingSupported) {
+        enabledExtensions.push_back(displayTimingDeviceExtension);
+    }
+
+    if(true == GetContext()->mIsDisplayControlSupported) {
+        enabledExtensions.push_back(displayControlDeviceExtension);
+    }
+
+    if(true == GetContext()->mIsMemoryBudgetSupported) {
+        enabledExtensions.push_back(memoryBudgetDeviceExtension);
+    }
+
+    if(true == GetContext()->mIsExternalMemoryDmaBufSupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, dmaBufDeviceExtensions);
+    }
+
+    if(true == GetContext()->mIsSyncFdFenceSupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, syncFdFenceDeviceExtensions);
+    }
+
+    if(true == GetContext()->mIsDrmFormatModifierSupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, drmFormatModifierDeviceExtensions);
+    }
+
+    if(true == GetContext()->mIsAndroidHardwareBufferSupported) {
+        AppendVkDeviceExtensions(&enabledExtensions, hardwareBufferDeviceExtensions);
+    }
+
+    VkPhysicalDeviceFeatures enabledFeatures;
+    memset(static_cast<void *>(&enabledFeatures), 0, sizeof(enabledFeatures));
+    enabledFeatures.multiDrawIndirect          = GetContext()->mIsMultiDrawIndirectSupported      ? VK_TRUE : VK_FALSE;
+    enabledFeatures.inheritedQueries           = GetContext()->mIsInheritedQueriesSupported       ? VK_TRUE : VK_FALSE;
+    enabledFeatures.textureCompressionETC2     = GetContext()->mIsTextureCompressionETC2Supported ? VK_TRUE : VK_FALSE;
+    enabledFeatures.textureCompressionASTC_LDR = GetContext()->mIsTextureCompressionASTCSupported ? VK_TRUE : VK_FALSE;
+    enabledFeatures.textureCompressionBC       = GetContext()->mIsTextureCompressionBCSupported   ? VK_TRUE : VK_FALSE;
+    enabledFeatures.shaderSampledImageArrayDynamicIndexing = GetContext()->mUseBindlessTextures   ? VK_TRUE : VK_FALSE;
+
+    VkDeviceCreateInfo deviceInfo;
+    deviceInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext                   = deviceInfoNext;
+    deviceInfo.flags                   = 0;
+    deviceInfo.queueCreateInfoCount    = queueInfoCount;
+    deviceInfo.pQueueCreateInfos       = queueInfo;
+    deviceInfo.enabledLayerCount       = 0;
+    deviceInfo.ppEnabledLayerNames     = nullptr;
+    deviceInfo.enabledExtensionCount   = enabledExtensions.size();
+    deviceInfo.ppEnabledExtensionNames = enabledExtensions.data();
+    deviceInfo.pEnabledFeatures        = &enabledFeatures;
+
+    VkResult err = vkCreateDevice(GloveVkContext.vkPhysicalDevice, &deviceInfo, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &GloveVkContext.vkDevice);
+    assert(!err);
+
+    return (err == VK_SUCCESS);
+}
+
+bool
+CreateVkSemaphores(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkResult err;
+
+    GloveVkContext.vkSyncItems = new vkSyncItems_t;
+    memset(static_cast<void *>(GloveVkContext.vkSyncItems), 0, sizeof(vkSyncItems_t));
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo;
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+    semaphoreCreateInfo.flags = 0;
+
+    err = vkCreateSemaphore(GloveVkContext.vkDevice, &semaphoreCreateInfo, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &GloveVkContext.vkSyncItems->vkSpareAcquireSemaphore);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    for(uint32_t i = 0; i < GLOVE_MAX_SWAPCHAIN_IMAGES; ++i) {
+        err = vkCreateSemaphore(GloveVkContext.vkDevice, &semaphoreCreateInfo, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &GloveVkContext.vkSyncItems->vkImageAcquireSemaphores[i]);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
+
+        err = vkCreateSemaphore(GloveVkContext.vkDevice, &semaphoreCreateInfo, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &GloveVkContext.vkSyncItems->vkImageDrawSemaphores[i]);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
+    }
+
+    // nothing waits on an acquire before a window surface acquires its first image
+    GloveVkContext.vkSyncItems->vkAcquireSemaphore   = GloveVkContext.vkSyncItems->vkImageAcquireSemaphores[0];
+    GloveVkContext.vkSyncItems->vkDrawSemaphore      = GloveVkContext.vkSyncItems->vkImageDrawSemaphores[0];
+    GloveVkContext.vkSyncItems->acquireSemaphoreFlag = false;
+    GloveVkContext.vkSyncItems->drawSemaphoreFlag    = false;
+    // until a window surface sets its presentation policy, the CPU records one frame ahead
+    GloveVkContext.vkSyncItems->maxFramesInFlight    = 2;
+
+    return true;
+}
+
+static void
+DestroyVkSemaphore(VkSemaphore *semaphore)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(*semaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(GloveVkContext.vkDevice, *semaphore, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE));
+        *semaphore = VK_NULL_HANDLE;
+    }
+}
+
+void
+DestroyVkSemaphores(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(GloveVkContext.vkSyncItems == nullptr) {
+        return;
+    }
+
+    DestroyVkSemaphore(&GloveVkContext.vkSyncItems->vkSpareAcquireSemaphore);
+    for(uint32_t i = 0; i < GLOVE_MAX_SWAPCHAIN_IMAGES; ++i) {
+        DestroyVkSemaphore(&GloveVkContext.vkSyncItems->vkImageAcquireSemaphores[i]);
+        DestroyVkSemaphore(&GloveVkContext.vkSyncItems->vkImageDrawSemaphores[i]);
+    }
+    GloveVkContext.vkSyncItems->vkAcquireSemaphore = VK_NULL_HANDLE;
+    GloveVkContext.vkSyncItems->vkDrawSemaphore    = VK_NULL_HANDLE;
+}
+
+void
+InitVkQueue(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vkGetDeviceQueue(GloveVkContext.vkDevice,
+                     GloveVkContext.vkGraphicsQueueNodeIndex,
+                     0,
+                     &GloveVkContext.vkQueue);
+
+    vkGetDeviceQueue(GloveVkContext.vkDevice,
+                     GloveVkContext.vkTransferQueueNodeIndex,
+                     GloveVkContext.vkTransferQueueIndex,
+                     &GloveVkContext.vkTransferQueue);
+}
+
+static std::string
+GetVkPipelineCachePath(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const char *path = getenv(GLOVE_PIPELINE_CACHE_PATH_ENV);
+
+    return (path != nullptr && path[0] != '\0') ? std::string(path) : std::string(GLOVE_PIPELINE_CACHE_DEFAULT_PATH);
+}
+
+static std::string
+GetVkCapabilityCachePath(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const std::string path = GetVkPipelineCachePath();
+
+    return path.empty() ? path : path + GLOVE_CAPABILITY_CACHE_FILE_SUFFIX;
+}
+
+static void
+InitVkPipelineCacheFileHeader(pipelineCacheFileHeader_t *header, uint64_t dataSize)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GloveVkContext.vkPhysicalDevice, &properties);
+
+    memset(static_cast<void*>(header), 0, sizeof(pipelineCacheFileHeader_t));
+    header->magic         = GLOVE_PIPELINE_CACHE_FILE_MAGIC;
+    header->version       = GLOVE_PIPELINE_CACHE_FILE_VERSION;
+    header->vendorID      = properties.vendorID;
+    header->deviceID      = properties.deviceID;
+    header->driverVersion = properties.driverVersion;
+    header->dataSize      = dataSize;
+    memcpy(header->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static vector<uint8_t>
+LoadVkPipelineCacheData(const std::string &path)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vector<uint8_t> data;
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if(file == nullptr) {
+        return data;
+    }
+
+    pipelineCacheFileHeader_t fileHeader;
+    pipelineCacheFileHeader_t deviceHeader;
+    InitVkPipelineCacheFileHeader(&deviceHeader, 0);
+
+    if(fread(&fileHeader, sizeof(pipelineCacheFileHeader_t), 1, file) == 1 &&
+       fileHeader.magic         == deviceHeader.magic                       &&
+       fileHeader.version       == deviceHeader.version                     &&
+       fileHeader.vendorID      == deviceHeader.vendorID                    &&
+       fileHeader.deviceID      == deviceHeader.deviceID                    &&
+       fileHeader.driverVersion == deviceHeader.driverVersion               &&
+      !memcmp(fileHeader.pipelineCacheUUID, deviceHeader.pipelineCacheUUID, VK_UUID_SIZE)) {
+
+        data.resize(static_cast<size_t>(fileHeader.dataSize));
+        if(data.size() && fread(data.data(), 1, data.size(), file) != data.size()) {
+            data.clear();
+        }
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+bool
+CreateVkPipelineCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::string path = GetVkPipelineCachePath();
+    vector<uint8_t> data;
+    if(!path.empty()) {
+        data = LoadVkPipelineCacheData(path);
+    }
+
+    VkPipelineCacheCreateInfo info;
+    info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.pNext           = nullptr;
+    info.flags           = 0;
+    info.initialDataSize = data.size();
+    info.pInitialData    = data.size() ? data.data() : nullptr;
+
+    VkResult err = vkCreatePipelineCache(GloveVkContext.vkDevice, &info, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &GloveVkContext.vkPipelineCache);
+
+    if(err != VK_SUCCESS && data.size()) {
+        /// The driver rejected the stored blob, start over with an empty cache
+        info.initialDataSize = 0;
+        info.pInitialData    = nullptr;
+        data.clear();
+        err = vkCreatePipelineCache(GloveVkContext.vkDevice, &info, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &GloveVkContext.vkPipelineCache);
+    }
+    assert(!err);
+
+    pipelineCacheSavedSize = data.size();
+
+    return (err == VK_SUCCESS);
+}
+
+bool
+CreateVkCapabilityCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.capabilityCache = new CapabilityCache(&GloveVkContext);
+
+    std::string path = GetVkCapabilityCachePath();
+    if(!path.empty()) {
+        GloveVkContext.capabilityCache->Load(path);
+    }
+
+    return true;
+}
+
+bool
+CreateVkMemoryAllocator(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.memoryAllocator = new MemoryAllocator(&GloveVkContext);
+
+    return true;
+}
+
+bool
+CreateVkSamplerCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.samplerCache = new SamplerCache(&GloveVkContext);
+
+    return true;
+}
+
+bool
+CreateVkPipelineLayoutCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.pipelineLayoutCache = new PipelineLayoutCache(&GloveVkContext);
+
+    return true;
+}
+
+bool
+CreateVkBindlessDescriptorSetLayout(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!GloveVkContext.mUseBindlessTextures) {
+        return true;
+    }
+
+#ifdef VK_EXT_descriptor_indexing
+    // one array per sampler type, of which only the slots a draw indexes have to be written
+    VkDescriptorSetLayoutBinding bindings[GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    VkDescriptorBindingFlagsEXT  bindingFlags[GLOVE_BINDLESS_TEXTURE_BINDINGS];
+    for(uint32_t i = 0; i < GLOVE_BINDLESS_TEXTURE_BINDINGS; ++i) {
+        bindings[i].binding            = i;
+        bindings[i].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount    = GLOVE_BINDLESS_TEXTURE_COUNT;
+        bindings[i].stageFlags         = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+        bindingFlags[i]                = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                         VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                         VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo;
+    bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.pNext         = nullptr;
+    bindingFlagsInfo.bindingCount  = GLOVE_BINDLESS_TEXTURE_BINDINGS;
+    bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo descLayoutInfo;
+    descLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descLayoutInfo.pNext        = &bindingFlagsInfo;
+    descLayoutInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    descLayoutInfo.bindingCount = GLOVE_BINDLESS_TEXTURE_BINDINGS;
+    descLayoutInfo.pBindings    = bindings;
+
+    // programs keep their samplers as descriptors when the table can not be made
+    if(vkCreateDescriptorSetLayout(GloveVkContext.vkDevice, &descLayoutInfo, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &GloveVkContext.vkBindlessDescSetLayout) != VK_SUCCESS) {
+        GloveVkContext.vkBindlessDescSetLayout = VK_NULL_HANDLE;
+        GloveVkContext.mUseBindlessTextures    = false;
+    }
+#else
+    GloveVkContext.mUseBindlessTextures = false;
+#endif // VK_EXT_descriptor_indexing
+
+    return true;
+}
+
+bool
+CreateVkShaderModuleCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.shaderModuleCache = new ShaderModuleCache(&GloveVkContext);
+
+    return true;
+}
+
+bool
+CreateVkPerfCounters(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    GloveVkContext.perfCounters = new PerfCounters();
+
+    return true;
+}
+
+bool
+CreateVkHostAllocator(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the bytes are accounted into the perf counters, which are thus created first
+    GloveVkContext.hostAllocator = new HostAllocator(GloveVkContext.perfCounters);
+
+    return true;
+}
+
+bool
+SavePipelineCache(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!GloveVkContext.mInitialized || GloveVkContext.vkPipelineCache == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    std::string path = GetVkPipelineCachePath();
+    if(path.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pipelineCacheSaveMutex);
+
+    size_t size = 0;
+    VkResult err = vkGetPipelineCacheData(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, &size, nullptr);
+    if(err != VK_SUCCESS || size == 0 || size == pipelineCacheSavedSize) {
+        return err == VK_SUCCESS;
+    }
+
+    vector<uint8_t> data(size);
+    err = vkGetPipelineCacheData(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, &size, data.data());
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    pipelineCacheFileHeader_t header;
+    InitVkPipelineCacheFileHeader(&header, size);
+
+    bool written = AtomicFileWriter::Write(path, [&](FILE *file) {
+        return fwrite(&header, sizeof(pipelineCacheFileHeader_t), 1, file) == 1 &&
+               fwrite(data.data(), 1, size, file) == size;
+    });
+    if(!written) {
+        return false;
+    }
+
+    pipelineCacheSavedSize = size;
+
+    return true;
+}
+
+void
+InitVkDeviceFunctions(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkDevice device = GloveVkContext.vkDevice;
+    (void)device;
+
+#ifdef VK_KHR_descriptor_update_template
+    if(GloveVkContext.mIsDescriptorUpdateTemplateSupported) {
+        GloveVkContext.fpCreateDescriptorUpdateTemplateKHR  = reinterpret_cast<PFN_vkCreateDescriptorUpdateTemplateKHR> (vkGetDeviceProcAddr(device, "vkCreateDescriptorUpdateTemplateKHR"));
+        GloveVkContext.fpDestroyDescriptorUpdateTemplateKHR = reinterpret_cast<PFN_vkDestroyDescriptorUpdateTemplateKHR>(vkGetDeviceProcAddr(device, "vkDestroyDescriptorUpdateTemplateKHR"));
+        GloveVkContext.fpUpdateDescriptorSetWithTemplateKHR = reinterpret_cast<PFN_vkUpdateDescriptorSetWithTemplateKHR>(vkGetDeviceProcAddr(device, "vkUpdateDescriptorSetWithTemplateKHR"));
+
+        GloveVkContext.mIsDescriptorUpdateTemplateSupported = GloveVkContext.fpCreateDescriptorUpdateTemplateKHR  &&
+                                                              GloveVkContext.fpDestroyDescriptorUpdateTemplateKHR &&
+                                                              GloveVkContext.fpUpdateDescriptorSetWithTemplateKHR;
+    }
+#endif // VK_KHR_descriptor_update_template
+
+#ifdef VK_KHR_external_memory_fd
+    if(GloveVkContext.mIsExternalMemoryDmaBufSupported) {
+        GloveVkContext.fpGetMemoryFdPropertiesKHR = reinterpret_cast<PFN_vkGetMemoryFdPropertiesKHR>(vkGetDeviceProcAddr(device, "vkGetMemoryFdPropertiesKHR"));
+        GloveVkContext.fpGetMemoryFdKHR           = reinterpret_cast<PFN_vkGetMemoryFdKHR>(vkGetDeviceProcAddr(device, "vkGetMemoryFdKHR"));
+
+        GloveVkContext.mIsExternalMemoryDmaBufSupported = GloveVkContext.fpGetMemoryFdPropertiesKHR != nullptr && GloveVkContext.fpGetMemoryFdKHR != nullptr;
+        GloveVkContext.mIsDrmFormatModifierSupported    = GloveVkContext.mIsDrmFormatModifierSupported && GloveVkContext.mIsExternalMemoryDmaBufSupported;
+    }
+#else
+    GloveVkContext.mIsExternalMemoryDmaBufSupported = false;
+    GloveVkContext.mIsDrmFormatModifierSupported    = false;
+#endif // VK_KHR_external_memory_fd
+
+#if defined(VK_KHR_external_fence_fd) && !defined(WIN32)
+    if(GloveVkContext.mIsSyncFdFenceSupported) {
+        GloveVkContext.fpGetFenceFdKHR = reinterpret_cast<PFN_vkGetFenceFdKHR>(vkGetDeviceProcAddr(device, "vkGetFenceFdKHR"));
+
+        GloveVkContext.mIsSyncFdFenceSupported = GloveVkContext.fpGetFenceFdKHR != nullptr;
+    }
+#else
+    GloveVkContext.mIsSyncFdFenceSupported = false;
+#endif // VK_KHR_external_fence_fd && !WIN32
+
+#ifdef VK_ANDROID_external_memory_android_hardware_buffer
+    if(GloveVkContext.mIsAndroidHardwareBufferSupported) {
+        GloveVkContext.fpGetAndroidHardwareBufferPropertiesANDROID = reinterpret_cast<PFN_vkGetAndroidHardwareBufferPropertiesANDROID>
+                                                                     (vkGetDeviceProcAddr(device, "vkGetAndroidHardwareBufferPropertiesANDROID"));
+
+        GloveVkContext.mIsAndroidHardwareBufferSupported = GloveVkContext.fpGetAndroidHardwareBufferPropertiesANDROID != nullptr;
+    }
+#else
+    GloveVkContext.mIsAndroidHardwareBufferSupported = false;
+#endif // VK_ANDROID_external_memory_android_hardware_buffer
+
+#ifdef VK_EXT_memory_budget
+    if(GloveVkContext.mIsMemoryBudgetSupported) {
+        GloveVkContext.fpGetPhysicalDeviceMemoryProperties2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>
+                                                                 (vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+
+        GloveVkContext.mIsMemoryBudgetSupported = GloveVkContext.fpGetPhysicalDeviceMemoryProperties2KHR != nullptr;
+    }
+#else
+    GloveVkContext.mIsMemoryBudgetSupported = false;
+#endif // VK_EXT_memory_budget
+
+#ifdef VK_KHR_timeline_semaphore
+    if(GloveVkContext.mIsTimelineSemaphoreSupported) {
+        GloveVkContext.fpGetSemaphoreCounterValueKHR = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+        GloveVkContext.fpWaitSemaphoresKHR           = reinterpret_cast<PFN_vkWaitSemaphoresKHR>          (vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+
+        GloveVkContext.mIsTimelineSemaphoreSupported = GloveVkContext.fpGetSemaphoreCounterValueKHR &&
+                                                       GloveVkContext.fpWaitSemaphoresKHR;
+    }
+#else
+    GloveVkContext.mIsTimelineSemaphoreSupported = false;
+#endif // VK_KHR_timeline_semaphore
+
+#ifdef VK_EXT_transform_feedback
+    if(GloveVkContext.mIsTransformFeedbackSupported) {
+        GloveVkContext.fpCmdBindTransformFeedbackBuffersEXT = reinterpret_cast<PFN_vkCmdBindTransformFeedbackBuffersEXT>(vkGetDeviceProcAddr(device, "vkCmdBindTransformFeedbackBuffersEXT"));
+        GloveVkContext.fpCmdBeginTransformFeedbackEXT       = reinterpret_cast<PFN_vkCmdBeginTransformFeedbackEXT>      (vkGetDeviceProcAddr(device, "vkCmdBeginTransformFeedbackEXT"));
+        GloveVkContext.fpCmdEndTransformFeedbackEXT         = reinterpret_cast<PFN_vkCmdEndTransformFeedbackEXT>        (vkGetDeviceProcAddr(device, "vkCmdEndTransformFeedbackEXT"));
+
+        GloveVkContext.mIsTransformFeedbackSupported = GloveVkContext.fpCmdBindTransformFeedbackBuffersEXT &&
+                                                       GloveVkContext.fpCmdBeginTransformFeedbackEXT       &&
+                                                       GloveVkContext.fpCmdEndTransformFeedbackEXT;
+    }
+#else
+    GloveVkContext.mIsTransformFeedbackSupported = false;
+#endif // VK_EXT_transform_feedback
+
+#ifdef VK_EXT_host_image_copy
+    if(GloveVkContext.mIsHostImageCopySupported) {
+        GloveVkContext.fpCopyMemoryToImageEXT                  = reinterpret_cast<PFN_vkCopyMemoryToImageEXT>    (vkGetDeviceProcAddr(device, "vkCopyMemoryToImageEXT"));
+        GloveVkContext.fpTransitionImageLayoutEXT              = reinterpret_cast<PFN_vkTransitionImageLayoutEXT>(vkGetDeviceProcAddr(device, "vkTransitionImageLayoutEXT"));
+        GloveVkContext.fpGetPhysicalDeviceFormatProperties2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceFormatProperties2KHR>
+                                                                 (vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkGetPhysicalDeviceFormatProperties2KHR"));
+
+        GloveVkContext.mIsHostImageCopySupported = GloveVkContext.fpCopyMemoryToImageEXT     &&
+                                                   GloveVkContext.fpTransitionImageLayoutEXT &&
+                                                   GloveVkContext.fpGetPhysicalDeviceFormatProperties2KHR;
+    }
+#else
+    GloveVkContext.mIsHostImageCopySupported = false;
+#endif // VK_EXT_host_image_copy
+
+#ifdef VK_KHR_dynamic_rendering
+    if(GloveVkContext.mIsDynamicRenderingSupported) {
+        GloveVkContext.fpCmdBeginRenderingKHR = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR"));
+        GloveVkContext.fpCmdEndRenderingKHR   = reinterpret_cast<PFN_vkCmdEndRenderingKHR>  (vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR"));
+
+        GloveVkContext.mIsDynamicRenderingSupported = GloveVkContext.fpCmdBeginRenderingKHR &&
+                                                      GloveVkContext.fpCmdEndRenderingKHR;
+    }
+#else
+    GloveVkContext.mIsDynamicRenderingSupported = false;
+#endif // VK_KHR_dynamic_rendering
+
+#ifdef VK_EXT_debug_utils
+    if(isDebugUtilsSupported) {
+        // commands of an instance extension, which the loader dispatches to the layers that implement them
+        GloveVkContext.fpCmdBeginDebugUtilsLabelEXT  = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT> (vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkCmdBeginDebugUtilsLabelEXT"));
+        GloveVkContext.fpCmdEndDebugUtilsLabelEXT    = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>   (vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkCmdEndDebugUtilsLabelEXT"));
+        GloveVkContext.fpCmdInsertDebugUtilsLabelEXT = reinterpret_cast<PFN_vkCmdInsertDebugUtilsLabelEXT>(vkGetInstanceProcAddr(GloveVkContext.vkInstance, "vkCmdInsertDebugUtilsLabelEXT"));
+
+        GloveVkContext.mIsDebugUtilsSupported = GloveVkContext.fpCmdBeginDebugUtilsLabelEXT &&
+                                                GloveVkContext.fpCmdEndDebugUtilsLabelEXT   &&
+                                                GloveVkContext.fpCmdInsertDebugUtilsLabelEXT;
+    }
+#endif // VK_EXT_debug_utils
+
+#ifndef VK_EXT_graphics_pipeline_library
+    GloveVkContext.mIsGraphicsPipelineLibrarySupported = false;
+#endif // VK_EXT_graphics_pipeline_library
+
+#ifndef VK_KHR_multiview
+    GloveVkContext.mIsMultiviewSupported    = false;
+    GloveVkContext.vkMaxMultiviewViewCount  = 1;
+#endif // VK_KHR_multiview
+
+#ifdef VK_EXT_extended_dynamic_state
+    if(!GloveVkContext.mIsExtendedDynamicStateSupported) {
+        return;
+    }
+
+    GloveVkContext.fpCmdSetCullModeEXT          = reinterpret_cast<PFN_vkCmdSetCullModeEXT>         (vkGetDeviceProcAddr(device, "vkCmdSetCullModeEXT"));
+    GloveVkContext.fpCmdSetFrontFaceEXT         = reinterpret_cast<PFN_vkCmdSetFrontFaceEXT>        (vkGetDeviceProcAddr(device, "vkCmdSetFrontFaceEXT"));
+    GloveVkContext.fpCmdSetPrimitiveTopologyEXT = reinterpret_cast<PFN_vkCmdSetPrimitiveTopologyEXT>(vkGetDeviceProcAddr(device, "vkCmdSetPrimitiveTopologyEXT"));
+    GloveVkContext.fpCmdSetDepthTestEnableEXT   = reinterpret_cast<PFN_vkCmdSetDepthTestEnableEXT>  (vkGetDeviceProcAddr(device, "vkCmdSetDepthTestEnableEXT"));
+    GloveVkContext.fpCmdSetDepthWriteEnableEXT  = reinterpret_cast<PFN_vkCmdSetDepthWriteEnableEXT> (vkGetDeviceProcAddr(device, "vkCmdSetDepthWriteEnableEXT"));
+    GloveVkContext.fpCmdSetDepthCompareOpEXT    = reinterpret_cast<PFN_vkCmdSetDepthCompareOpEXT>   (vkGetDeviceProcAddr(device, "vkCmdSetDepthCompareOpEXT"));
+    GloveVkContext.fpCmdBindVertexBuffers2EXT   = reinterpret_cast<PFN_vkCmdBindVertexBuffers2EXT>  (vkGetDeviceProcAddr(device, "vkCmdBindVertexBuffers2EXT"));
+
+    GloveVkContext.mIsExtendedDynamicStateSupported = GloveVkContext.fpCmdSetCullModeEXT          &&
+                                                      GloveVkContext.fpCmdSetFrontFaceEXT         &&
+                                                      GloveVkContext.fpCmdSetPrimitiveTopologyEXT &&
+                                                      GloveVkContext.fpCmdSetDepthTestEnableEXT   &&
+                                                      GloveVkContext.fpCmdSetDepthWriteEnableEXT  &&
+                                                      GloveVkContext.fpCmdSetDepthCompareOpEXT    &&
+                                                      GloveVkContext.fpCmdBindVertexBuffers2EXT;
+#endif // VK_EXT_extended_dynamic_state
+}
+
+vkContext_t *
+GetContext()
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    return &GloveVkContext;
+}
+
+void
+ResetContextResources()
+{
+    GloveVkContext.vkInstance                   = VK_NULL_HANDLE;
+    GloveVkContext.vkGpus.clear();
+    GloveVkContext.vkPhysicalDevice             = VK_NULL_HANDLE;
+    GloveVkContext.vkQueue                      = VK_NULL_HANDLE;
+    GloveVkContext.vkGraphicsQueueNodeIndex     = 0;
+    GloveVkContext.vkTransferQueue              = VK_NULL_HANDLE;
+    GloveVkContext.vkTransferQueueNodeIndex     = 0;
+    GloveVkContext.vkTransferQueueIndex         = 0;
+    GloveVkContext.vkTransferQueueFlags         = 0;
+    GloveVkContext.vkDevice                     = VK_NULL_HANDLE;
+    GloveVkContext.vkSyncItems                  = nullptr;
+    GloveVkContext.vkPipelineCache              = VK_NULL_HANDLE;
+    GloveVkContext.vkBindlessDescSetLayout      = VK_NULL_HANDLE;
+    GloveVkContext.memoryAllocator              = nullptr;
+    GloveVkContext.samplerCache                 = nullptr;
+    GloveVkContext.pipelineLayoutCache          = nullptr;
+    GloveVkContext.shaderModuleCache            = nullptr;
+    GloveVkContext.capabilityCache              = nullptr;
+    GloveVkContext.perfCounters                 = nullptr;
+    GloveVkContext.hostAllocator                = nullptr;
+    GloveVkContext.mIsMaintenanceExtSupported   = false;
+    GloveVkContext.mIsExtendedDynamicStateSupported = false;
+    GloveVkContext.mIsIndexTypeUint8Supported   = false;
+    GloveVkContext.mIsMultiDrawIndirectSupported = false;
+    GloveVkContext.mIsInheritedQueriesSupported = false;
+    GloveVkContext.mIsDescriptorUpdateTemplateSupported = false;
+    GloveVkContext.mIsIncrementalPresentSupported = false;
+    GloveVkContext.mIsDisplayTimingSupported    = false;
+    GloveVkContext.mIsDisplayControlSupported   = false;
+    GloveVkContext.mIsExternalMemoryDmaBufSupported = false;
+    GloveVkContext.mIsSyncFdFenceSupported      = false;
+    GloveVkContext.mIsDrmFormatModifierSupported = false;
+    GloveVkContext.mIsAndroidHardwareBufferSupported = false;
+    GloveVkContext.mIsMemoryBudgetSupported     = false;
+    GloveVkContext.mIsTimelineSemaphoreSupported = false;
+    GloveVkContext.mIsTransformFeedbackSupported = false;
+    GloveVkContext.mIsHostImageCopySupported    = false;
+    GloveVkContext.mIsDynamicRenderingSupported = false;
+    GloveVkContext.mIsGraphicsPipelineLibrarySupported = false;
+    GloveVkContext.mIsMultiviewSupported        = false;
+    GloveVkContext.mIsDebugUtilsSupported       = false;
+    GloveVkContext.mIsPortabilitySubset         = false;
+    GloveVkContext.mIsTriangleFanSupported      = true;
+    GloveVkContext.mUseBindlessTextures         = false;
+    GloveVkContext.mPreferLinearImages          = false;
+    GloveVkContext.mPreferDepthPrecision        = false;
+    GloveVkContext.vkFramebufferSampleCounts    = VK_SAMPLE_COUNT_1_BIT;
+    GloveVkContext.vkTimestampValidBits         = 0;
+    GloveVkContext.vkTimestampPeriod            = 0.0f;
+    GloveVkContext.vkMinStorageBufferOffsetAlignment = 1;
+    GloveVkContext.vkMinUniformBufferOffsetAlignment = 1;
+    GloveVkContext.vkMaxUniformBufferRange      = 0;
+    GloveVkContext.vkMaxMultiviewViewCount      = 1;
+    GloveVkContext.mInitialized                 = false;
+    memset(static_cast<void*>(&GloveVkContext.vkDeviceMemoryProperties), 0,
+           sizeof(VkPhysicalDeviceMemoryProperties));
+}
+
+bool
+InitContext()
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if (GloveVkContext.mInitialized == true) {
+        return true;
+    }
+
+    ResetContextResources();
+
+    if( !CreateVkPerfCounters()       ||
+        !CreateVkHostAllocator()      ||
+        !CheckVkInstanceExtensions()  ||
+        !CreateVkInstance()           ||
+        !EnumerateVkGpus()            ||
+        !CreateVkCapabilityCache()    ||
+        !InitVkQueueFamilyIndex()     ||
+        !CheckVkDeviceExtensions()    ||
+        !CreateVkDevice()             ||
+        !CreateVkPipelineCache()      ||
+        !CreateVkMemoryAllocator()    ||
+        !CreateVkSamplerCache()       ||
+        !CreateVkPipelineLayoutCache() ||
+        !CreateVkBindlessDescriptorSetLayout() ||
+        !CreateVkShaderModuleCache()  ||
+        !CreateVkSemaphores()
+      ) {
+        assert(false);
+        return false;
+    }
+    InitVkQueue();
+    InitVkDeviceFunctions();
+
+    const char *linearImages = getenv(GLOVE_LINEAR_IMAGES_ENV);
+    GloveVkContext.mPreferLinearImages = (linearImages != nullptr && atoi(linearImages) != 0);
+
+    const char *depthStencilPolicy = getenv(GLOVE_DEPTH_STENCIL_POLICY_ENV);
+    GloveVkContext.mPreferDepthPrecision = (depthStencilPolicy != nullptr && !strcmp(depthStencilPolicy, "precision"));
+
+    GloveVkContext.mInitialized = true;
+
+    return GloveVkContext.mInitialized;
+}
+
+void
+TerminateContext()
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!GloveVkContext.mInitialized) {
+        return;
+    }
+
+    if(GloveVkContext.vkPipelineCache != VK_NULL_HANDLE) {
+        SavePipelineCache();
+        vkDestroyPipelineCache(GloveVkContext.vkDevice, GloveVkContext.vkPipelineCache, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        GloveVkContext.vkPipelineCache = VK_NULL_HANDLE;
+    }
+
+    if(GloveVkContext.capabilityCache != nullptr) {
+        // the file is keyed by the properties of the device, so it is written while that is still there
+        std::string path = GetVkCapabilityCachePath();
+        if(!path.empty()) {
+            GloveVkContext.capabilityCache->Save(path);
+        }
+        SafeDelete(GloveVkContext.capabilityCache);
+    }
+
+    if(GloveVkContext.vkDevice != VK_NULL_HANDLE ) {
+        vkDeviceWaitIdle(GloveVkContext.vkDevice);
+        DestroyVkSemaphores();
+        SafeDelete(GloveVkContext.shaderModuleCache);
+        SafeDelete(GloveVkContext.samplerCache);
+        SafeDelete(GloveVkContext.pipelineLayoutCache);
+        if(GloveVkContext.vkBindlessDescSetLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(GloveVkContext.vkDevice, GloveVkContext.vkBindlessDescSetLayout, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+        }
+        SafeDelete(GloveVkContext.memoryAllocator);
+        vkDestroyDevice(GloveVkContext.vkDevice, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE));
+        vkDestroyInstance(GloveVkContext.vkInstance, GloveVkContext.hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE));
     }
 
+    // the driver frees the last of its allocations along with the instance
+    SafeDelete(GloveVkContext.hostAllocator);
+    SafeDelete(GloveVkContext.perfCounters);
     SafeDelete(GloveVkContext.vkSyncItems);
 
     ResetContextResources();
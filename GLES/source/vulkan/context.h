@@ -24,7 +24,9 @@
 #ifndef __VKCONTEXT_H__
 #define __VKCONTEXT_H__
 
+#include <bitset>
 #include <map>
+#include <mutex>
 #include <vector>
 #include "utils/glLogger.h"
 #include "vulkan/vulkan.h"
@@ -34,15 +36,122 @@ using namespace std;
 
 namespace vulkanAPI {
 
+    class MemoryAllocator;
+    class PerfCounters;
+    class HostAllocator;
+    class SamplerCache;
+    class PipelineLayoutCache;
+    class ShaderModuleCache;
+    class CapabilityCache;
+
     typedef struct vkContext_t {
         vkContext_t() {
             vkInstance            = VK_NULL_HANDLE;
+            vkPhysicalDevice      = VK_NULL_HANDLE;
             vkQueue               = VK_NULL_HANDLE;
             mInitialized          = false;
             vkGraphicsQueueNodeIndex = 0;
+            vkTransferQueue       = VK_NULL_HANDLE;
+            vkTransferQueueNodeIndex = 0;
+            vkTransferQueueIndex  = 0;
+            vkTransferQueueFlags  = 0;
             vkDevice = VK_NULL_HANDLE;
             vkSyncItems             = nullptr;
+            vkPipelineCache         = VK_NULL_HANDLE;
+            vkBindlessDescSetLayout = VK_NULL_HANDLE;
+            memoryAllocator         = nullptr;
+            samplerCache            = nullptr;
+            shaderModuleCache       = nullptr;
+            capabilityCache         = nullptr;
+            pipelineLayoutCache     = nullptr;
+            perfCounters            = nullptr;
+            hostAllocator           = nullptr;
             mIsMaintenanceExtSupported = false;
+            mIsExtendedDynamicStateSupported = false;
+            mIsIndexTypeUint8Supported = false;
+            mIsMultiDrawIndirectSupported = false;
+            mIsInheritedQueriesSupported = false;
+            mIsDescriptorUpdateTemplateSupported = false;
+            mIsIncrementalPresentSupported = false;
+            mIsDisplayTimingSupported = false;
+            mIsDisplayControlSupported = false;
+            mIsPortabilitySubset = false;
+            mIsTriangleFanSupported = true;
+            mIsTextureCompressionETC2Supported = false;
+            mIsTextureCompressionASTCSupported = false;
+            mIsTextureCompressionBCSupported = false;
+            mIsExternalMemoryDmaBufSupported = false;
+            mIsSyncFdFenceSupported = false;
+            mIsDrmFormatModifierSupported = false;
+            mIsAndroidHardwareBufferSupported = false;
+            mIsMemoryBudgetSupported = false;
+            mIsTimelineSemaphoreSupported = false;
+            mIsTransformFeedbackSupported = false;
+            mIsHostImageCopySupported = false;
+            mIsDynamicRenderingSupported = false;
+            mIsGraphicsPipelineLibrarySupported = false;
+            mIsMultiviewSupported = false;
+            mIsDebugUtilsSupported = false;
+            mUseBindlessTextures = false;
+            mPreferLinearImages = false;
+            mPreferDepthPrecision = false;
+            vkFramebufferSampleCounts = VK_SAMPLE_COUNT_1_BIT;
+            vkTimestampValidBits    = 0;
+            vkTimestampPeriod       = 0.0f;
+            vkMinStorageBufferOffsetAlignment = 1;
+            vkMinUniformBufferOffsetAlignment = 1;
+            vkMaxUniformBufferRange = 0;
+            vkMaxMultiviewViewCount = 1;
+#ifdef VK_EXT_extended_dynamic_state
+            fpCmdSetCullModeEXT          = nullptr;
+            fpCmdSetFrontFaceEXT         = nullptr;
+            fpCmdSetPrimitiveTopologyEXT = nullptr;
+            fpCmdSetDepthTestEnableEXT   = nullptr;
+            fpCmdSetDepthWriteEnableEXT  = nullptr;
+            fpCmdSetDepthCompareOpEXT    = nullptr;
+            fpCmdBindVertexBuffers2EXT   = nullptr;
+#endif // VK_EXT_extended_dynamic_state
+#ifdef VK_KHR_descriptor_update_template
+            fpCreateDescriptorUpdateTemplateKHR  = nullptr;
+            fpDestroyDescriptorUpdateTemplateKHR = nullptr;
+            fpUpdateDescriptorSetWithTemplateKHR = nullptr;
+#endif // VK_KHR_descriptor_update_template
+#ifdef VK_KHR_external_memory_fd
+            fpGetMemoryFdPropertiesKHR = nullptr;
+            fpGetMemoryFdKHR           = nullptr;
+#endif // VK_KHR_external_memory_fd
+#ifdef VK_KHR_external_fence_fd
+            fpGetFenceFdKHR = nullptr;
+#endif // VK_KHR_external_memory_fd
+#ifdef VK_ANDROID_external_memory_android_hardware_buffer
+            fpGetAndroidHardwareBufferPropertiesANDROID = nullptr;
+#endif // VK_ANDROID_external_memory_android_hardware_buffer
+#ifdef VK_EXT_memory_budget
+            fpGetPhysicalDeviceMemoryProperties2KHR = nullptr;
+#endif // VK_EXT_memory_budget
+#ifdef VK_KHR_timeline_semaphore
+            fpGetSemaphoreCounterValueKHR = nullptr;
+            fpWaitSemaphoresKHR           = nullptr;
+#endif // VK_KHR_timeline_semaphore
+#ifdef VK_EXT_transform_feedback
+            fpCmdBindTransformFeedbackBuffersEXT = nullptr;
+            fpCmdBeginTransformFeedbackEXT       = nullptr;
+            fpCmdEndTransformFeedbackEXT         = nullptr;
+#endif // VK_EXT_transform_feedback
+#ifdef VK_EXT_host_image_copy
+            fpCopyMemoryToImageEXT                  = nullptr;
+            fpTransitionImageLayoutEXT              = nullptr;
+            fpGetPhysicalDeviceFormatProperties2KHR = nullptr;
+#endif // VK_EXT_host_image_copy
+#ifdef VK_KHR_dynamic_rendering
+            fpCmdBeginRenderingKHR = nullptr;
+            fpCmdEndRenderingKHR   = nullptr;
+#endif // VK_KHR_dynamic_rendering
+#ifdef VK_EXT_debug_utils
+            fpCmdBeginDebugUtilsLabelEXT  = nullptr;
+            fpCmdEndDebugUtilsLabelEXT    = nullptr;
+            fpCmdInsertDebugUtilsLabelEXT = nullptr;
+#endif // VK_EXT_debug_utils
             mInitialized            = false;
             memset(static_cast<void*>(&vkDeviceMemoryProperties), 0,
                    sizeof(VkPhysicalDeviceMemoryProperties));
@@ -50,12 +159,146 @@ namespace vulkanAPI {
 
         VkInstance                                          vkInstance;
         vector<VkPhysicalDevice>                            vkGpus;
+        /// the one of vkGpus everything runs on, see GLOVE_GPU_ENV
+        VkPhysicalDevice                                    vkPhysicalDevice;
         VkQueue                                             vkQueue;
         uint32_t                                            vkGraphicsQueueNodeIndex;
+        /// uploads go to a queue of their own when the device has one to spare, of the family
+        /// and at the index within it given, otherwise to vkQueue
+        VkQueue                                             vkTransferQueue;
+        uint32_t                                            vkTransferQueueNodeIndex;
+        uint32_t                                            vkTransferQueueIndex;
+        VkQueueFlags                                        vkTransferQueueFlags;
         VkDevice                                            vkDevice;
         VkPhysicalDeviceMemoryProperties                    vkDeviceMemoryProperties;
+        /// sample counts usable by color, depth and stencil attachments alike
+        VkSampleCountFlags                                  vkFramebufferSampleCounts;
+        /// bits of the timestamps written on the graphics queue and nanoseconds per tick, no timestamps when zero
+        uint32_t                                            vkTimestampValidBits;
+        float                                               vkTimestampPeriod;
+        /// alignment of the offsets the storage buffers of compute shaders are bound at
+        VkDeviceSize                                        vkMinStorageBufferOffsetAlignment;
+        /// and of those of the uniform buffers, which are bound for as many bytes at most
+        VkDeviceSize                                        vkMinUniformBufferOffsetAlignment;
+        uint32_t                                            vkMaxUniformBufferRange;
+        /// views a single render pass draws into at most, one unless multiview is supported
+        uint32_t                                            vkMaxMultiviewViewCount;
         vkSyncItems_t                                       *vkSyncItems;
+        VkPipelineCache                                     vkPipelineCache;
+        /// layout of the set holding every texture sampled through an index, set 1 of the programs that do
+        VkDescriptorSetLayout                               vkBindlessDescSetLayout;
+        MemoryAllocator                                     *memoryAllocator;
+        SamplerCache                                        *samplerCache;
+        ShaderModuleCache                                   *shaderModuleCache;
+        CapabilityCache                                     *capabilityCache;
+        PipelineLayoutCache                                 *pipelineLayoutCache;
+        PerfCounters                                        *perfCounters;
+        /// allocation callbacks every object is created and destroyed with, per subsystem
+        HostAllocator                                       *hostAllocator;
+        /// contexts current to different threads submit to the same queues, and EGL presents to them
+        mutable std::mutex                                  vkQueueMutex;
         bool                                                mIsMaintenanceExtSupported;
+        bool                                                mIsExtendedDynamicStateSupported;
+        bool                                                mIsIndexTypeUint8Supported;
+        bool                                                mIsMultiDrawIndirectSupported;
+        /// secondary command buffers are executed while an occlusion query of their primary is active
+        bool                                                mIsInheritedQueriesSupported;
+        bool                                                mIsDescriptorUpdateTemplateSupported;
+        bool                                                mIsIncrementalPresentSupported;
+        /// frames are presented at requested times, and their past presentation times are reported (VK_GOOGLE_display_timing)
+        bool                                                mIsDisplayTimingSupported;
+        /// the first pixel out of a display plane signals a fence, to present in step with its vblank (VK_EXT_display_control)
+        bool                                                mIsDisplayControlSupported;
+        bool                                                mIsTextureCompressionETC2Supported;
+        bool                                                mIsTextureCompressionASTCSupported;
+        bool                                                mIsTextureCompressionBCSupported;
+        /// memory of EGLImages is imported from dma-bufs, tiled by DRM format modifiers, or from AHardwareBuffers,
+        /// and memory of textures is exported as dma-bufs
+        bool                                                mIsExternalMemoryDmaBufSupported;
+        /// fences are exported as sync files, which other devices wait on (VK_KHR_external_fence_fd)
+        bool                                                mIsSyncFdFenceSupported;
+        bool                                                mIsDrmFormatModifierSupported;
+        bool                                                mIsAndroidHardwareBufferSupported;
+        /// the driver reports how much of each heap the process may use
+        bool                                                mIsMemoryBudgetSupported;
+        /// submissions signal a counter of their queue, which is waited on for a value instead of through fences
+        bool                                                mIsTimelineSemaphoreSupported;
+        /// vertex shader outputs are captured into buffers while drawing (VK_EXT_transform_feedback)
+        bool                                                mIsTransformFeedbackSupported;
+        /// pixels are written into images by the host, without staging buffers or commands (VK_EXT_host_image_copy)
+        bool                                                mIsHostImageCopySupported;
+        /// passes are begun on the image views themselves, without render pass and framebuffer objects (VK_KHR_dynamic_rendering)
+        bool                                                mIsDynamicRenderingSupported;
+        /// pipelines are linked from parts compiled and cached separately, quickly enough to do so at draw time (VK_EXT_graphics_pipeline_library)
+        bool                                                mIsGraphicsPipelineLibrarySupported;
+        /// the draws of a render pass are broadcast to several layers of its attachments, each shader invocation sees its view (VK_KHR_multiview)
+        bool                                                mIsMultiviewSupported;
+        /// command buffers carry labels, which capture tools and GPU profilers show (VK_EXT_debug_utils)
+        bool                                                mIsDebugUtilsSupported;
+        /// the device implements a subset of Vulkan (VK_KHR_portability_subset), triangle fans may be missing from it
+        bool                                                mIsPortabilitySubset;
+        /// fans are drawn as they are, otherwise they are drawn as indexed triangle lists
+        bool                                                mIsTriangleFanSupported;
+        /// samplers index a table of partially bound descriptors, given per draw through push constants
+        /// (opted in through GLOVE_BINDLESS_TEXTURES_ENV where descriptor indexing is supported)
+        bool                                                mUseBindlessTextures;
+        /// single sampled images are tiled linearly where their format allows, instead of optimally
+        bool                                                mPreferLinearImages;
+        /// depth/stencil formats are ranked by depth bits rather than by the bytes of a sample (GLOVE_DEPTH_STENCIL_POLICY_ENV)
+        bool                                                mPreferDepthPrecision;
+        /// formats of R8_UNORM up to R32G32B32A32_SFLOAT that vertex buffers can be read with,
+        /// looked up instead of asking the device for every attribute layout
+        std::bitset<VK_FORMAT_R32G32B32A32_SFLOAT + 1>      vkVertexFormats;
+#ifdef VK_EXT_extended_dynamic_state
+        PFN_vkCmdSetCullModeEXT                             fpCmdSetCullModeEXT;
+        PFN_vkCmdSetFrontFaceEXT                            fpCmdSetFrontFaceEXT;
+        PFN_vkCmdSetPrimitiveTopologyEXT                    fpCmdSetPrimitiveTopologyEXT;
+        PFN_vkCmdSetDepthTestEnableEXT                      fpCmdSetDepthTestEnableEXT;
+        PFN_vkCmdSetDepthWriteEnableEXT                     fpCmdSetDepthWriteEnableEXT;
+        PFN_vkCmdSetDepthCompareOpEXT                       fpCmdSetDepthCompareOpEXT;
+        PFN_vkCmdBindVertexBuffers2EXT                      fpCmdBindVertexBuffers2EXT;
+#endif // VK_EXT_extended_dynamic_state
+#ifdef VK_KHR_descriptor_update_template
+        PFN_vkCreateDescriptorUpdateTemplateKHR             fpCreateDescriptorUpdateTemplateKHR;
+        PFN_vkDestroyDescriptorUpdateTemplateKHR            fpDestroyDescriptorUpdateTemplateKHR;
+        PFN_vkUpdateDescriptorSetWithTemplateKHR            fpUpdateDescriptorSetWithTemplateKHR;
+#endif // VK_KHR_descriptor_update_template
+#ifdef VK_KHR_external_memory_fd
+        PFN_vkGetMemoryFdPropertiesKHR                      fpGetMemoryFdPropertiesKHR;
+        PFN_vkGetMemoryFdKHR                                fpGetMemoryFdKHR;
+#endif // VK_KHR_external_memory_fd
+#ifdef VK_KHR_external_fence_fd
+        PFN_vkGetFenceFdKHR                                 fpGetFenceFdKHR;
+#endif // VK_KHR_external_memory_fd
+#ifdef VK_ANDROID_external_memory_android_hardware_buffer
+        PFN_vkGetAndroidHardwareBufferPropertiesANDROID     fpGetAndroidHardwareBufferPropertiesANDROID;
+#endif // VK_ANDROID_external_memory_android_hardware_buffer
+#ifdef VK_EXT_memory_budget
+        PFN_vkGetPhysicalDeviceMemoryProperties2KHR         fpGetPhysicalDeviceMemoryProperties2KHR;
+#endif // VK_EXT_memory_budget
+#ifdef VK_KHR_timeline_semaphore
+        PFN_vkGetSemaphoreCounterValueKHR                   fpGetSemaphoreCounterValueKHR;
+        PFN_vkWaitSemaphoresKHR                             fpWaitSemaphoresKHR;
+#endif // VK_KHR_timeline_semaphore
+#ifdef VK_EXT_transform_feedback
+        PFN_vkCmdBindTransformFeedbackBuffersEXT            fpCmdBindTransformFeedbackBuffersEXT;
+        PFN_vkCmdBeginTransformFeedbackEXT                  fpCmdBeginTransformFeedbackEXT;
+        PFN_vkCmdEndTransformFeedbackEXT                    fpCmdEndTransformFeedbackEXT;
+#endif // VK_EXT_transform_feedback
+#ifdef VK_EXT_host_image_copy
+        PFN_vkCopyMemoryToImageEXT                          fpCopyMemoryToImageEXT;
+        PFN_vkTransitionImageLayoutEXT                      fpTransitionImageLayoutEXT;
+        PFN_vkGetPhysicalDeviceFormatProperties2KHR         fpGetPhysicalDeviceFormatProperties2KHR;
+#endif // VK_EXT_host_image_copy
+#ifdef VK_KHR_dynamic_rendering
+        PFN_vkCmdBeginRenderingKHR                          fpCmdBeginRenderingKHR;
+        PFN_vkCmdEndRenderingKHR                            fpCmdEndRenderingKHR;
+#endif // VK_KHR_dynamic_rendering
+#ifdef VK_EXT_debug_utils
+        PFN_vkCmdBeginDebugUtilsLabelEXT                    fpCmdBeginDebugUtilsLabelEXT;
+        PFN_vkCmdEndDebugUtilsLabelEXT                      fpCmdEndDebugUtilsLabelEXT;
+        PFN_vkCmdInsertDebugUtilsLabelEXT                   fpCmdInsertDebugUtilsLabelEXT;
+#endif // VK_EXT_debug_utils
         bool                                                mInitialized;
     } vkContext_t;
 
@@ -63,6 +306,7 @@ namespace vulkanAPI {
     bool                              InitContext();
     void                              TerminateContext();
     void                              ClearContextResources();
+    bool                              SavePipelineCache();
 
     template<typename T>  inline void SafeDelete(T*& ptr)                       { FUN_ENTRY(GL_LOG_TRACE); delete ptr; ptr = nullptr; }
 };
@@ -0,0 +1,203 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       descriptorPoolRing.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Per Frame Descriptor Pool Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Descriptor sets are never updated once a command buffer may refer to them.
+ *  Instead, a fresh set is allocated out of a shared pool whenever the bindings
+ *  of a program change, and at least once per frame. The pools a frame allocated
+ *  from are reset as a whole once the fence of that frame has signaled, so that
+ *  no set is ever freed individually.
+ *
+ */
+
+#include "descriptorPoolRing.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+std::atomic<uint64_t> DescriptorPoolRing::mNextSerial(0);
+
+DescriptorPoolRing::DescriptorPoolRing(const vkContext_t *vkContext)
+: mVkContext(vkContext), mActivePool(VK_NULL_HANDLE), mSerial(++mNextSerial)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+DescriptorPoolRing::~DescriptorPoolRing()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+void
+DescriptorPoolRing::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    RetireAll();
+
+    for(auto pool : mFreePools) {
+        vkDestroyDescriptorPool(mVkContext->vkDevice, pool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+    }
+    mFreePools.clear();
+}
+
+bool
+DescriptorPoolRing::CreatePool(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mActivePool != VK_NULL_HANDLE) {
+        mPendingPools.push_back(mActivePool);
+        mActivePool = VK_NULL_HANDLE;
+    }
+
+    if(!mFreePools.empty()) {
+        mActivePool = mFreePools.back();
+        mFreePools.pop_back();
+        return true;
+    }
+
+    // a set reads at most the one color attachment as input attachment, and the sets of compute programs
+    // the storage and uniform buffers of the application
+    VkDescriptorPoolSize poolSizes[5];
+    poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[0].descriptorCount = GLOVE_DESCRIPTOR_POOL_MAX_SETS * GLOVE_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET;
+    poolSizes[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].descriptorCount = GLOVE_DESCRIPTOR_POOL_MAX_SETS * GLOVE_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET;
+    poolSizes[2].type            = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    poolSizes[2].descriptorCount = GLOVE_DESCRIPTOR_POOL_MAX_SETS;
+    poolSizes[3].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[3].descriptorCount = GLOVE_DESCRIPTOR_POOL_MAX_SETS * GLOVE_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET;
+    poolSizes[4].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[4].descriptorCount = GLOVE_DESCRIPTOR_POOL_MAX_SETS * GLOVE_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo;
+    memset(static_cast<void *>(&descriptorPoolInfo), 0, sizeof(descriptorPoolInfo));
+    descriptorPoolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.pNext         = nullptr;
+    descriptorPoolInfo.flags         = 0;
+    descriptorPoolInfo.maxSets       = GLOVE_DESCRIPTOR_POOL_MAX_SETS;
+    descriptorPoolInfo.poolSizeCount = 5;
+    descriptorPoolInfo.pPoolSizes    = poolSizes;
+
+    if(vkCreateDescriptorPool(mVkContext->vkDevice, &descriptorPoolInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &mActivePool) != VK_SUCCESS) {
+        mActivePool = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+void
+DescriptorPoolRing::ResetPools(std::vector<VkDescriptorPool> *pools)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(auto pool : *pools) {
+        vkResetDescriptorPool(mVkContext->vkDevice, pool, 0);
+        mFreePools.push_back(pool);
+    }
+    pools->clear();
+}
+
+bool
+DescriptorPoolRing::Allocate(VkDescriptorSetLayout layout, VkDescriptorSet *descriptorSet)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkDescriptorSetAllocateInfo descAllocInfo;
+    memset(static_cast<void *>(&descAllocInfo), 0, sizeof(descAllocInfo));
+    descAllocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descAllocInfo.pNext              = nullptr;
+    descAllocInfo.descriptorSetCount = 1;
+    descAllocInfo.pSetLayouts        = &layout;
+
+    // a full (or fragmented) pool is put aside until its frame retires, and allocation is retried on a fresh one
+    if(mActivePool != VK_NULL_HANDLE) {
+        descAllocInfo.descriptorPool = mActivePool;
+        if(vkAllocateDescriptorSets(mVkContext->vkDevice, &descAllocInfo, descriptorSet) == VK_SUCCESS) {
+            return true;
+        }
+    }
+
+    if(!CreatePool()) {
+        return false;
+    }
+
+    descAllocInfo.descriptorPool = mActivePool;
+    if(vkAllocateDescriptorSets(mVkContext->vkDevice, &descAllocInfo, descriptorSet) != VK_SUCCESS) {
+        *descriptorSet = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+void
+DescriptorPoolRing::SubmitFrame(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    // sets allocated so far belong to the submitted frame (or older ones)
+    if(mActivePool != VK_NULL_HANDLE) {
+        mPendingPools.push_back(mActivePool);
+        mActivePool = VK_NULL_HANDLE;
+    }
+    mRetiredPools[frame].insert(mRetiredPools[frame].end(), mPendingPools.begin(), mPendingPools.end());
+    mPendingPools.clear();
+
+    mSerial = ++mNextSerial;
+}
+
+void
+DescriptorPoolRing::RetireFrame(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    ResetPools(&mRetiredPools[frame]);
+}
+
+void
+DescriptorPoolRing::RetireAll(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mActivePool != VK_NULL_HANDLE) {
+        mPendingPools.push_back(mActivePool);
+        mActivePool = VK_NULL_HANDLE;
+    }
+
+    for(uint32_t i = 0; i < GLOVE_FRAMES_IN_FLIGHT; ++i) {
+        ResetPools(&mRetiredPools[i]);
+    }
+    ResetPools(&mPendingPools);
+
+    mSerial = ++mNextSerial;
+}
+
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       descriptorPoolRing.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Per Frame Descriptor Pool Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKDESCRIPTORPOOLRING_H__
+#define __VKDESCRIPTORPOOLRING_H__
+
+#include <atomic>
+#include <vector>
+#include "context.h"
+#include "commandBufferManager.h"
+
+/// Descriptor sets each pool of the ring can hold
+#define GLOVE_DESCRIPTOR_POOL_MAX_SETS                  256
+
+/// Descriptors of each type a pool of the ring can hold, per set
+#define GLOVE_DESCRIPTOR_POOL_DESCRIPTORS_PER_SET       16
+
+namespace vulkanAPI {
+
+class DescriptorPoolRing final {
+private:
+    /// serials are unique among all the rings, so that a set allocated out of one
+    /// is never taken for a set allocated out of another one swapped in for it
+    static std::atomic<uint64_t>    mNextSerial;
+
+    const vkContext_t              *mVkContext;
+
+    /// pool sets are being allocated from, the ones already filled while recording,
+    /// the ones kept alive by each frame in flight, and the reset ones ready for reuse
+    VkDescriptorPool                mActivePool;
+    std::vector<VkDescriptorPool>   mPendingPools;
+    std::vector<VkDescriptorPool>   mRetiredPools[GLOVE_FRAMES_IN_FLIGHT];
+    std::vector<VkDescriptorPool>   mFreePools;
+    uint64_t                        mSerial;
+
+    bool                            CreatePool(void);
+    void                            ResetPools(std::vector<VkDescriptorPool> *pools);
+
+public:
+// Constructor
+    DescriptorPoolRing(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~DescriptorPoolRing();
+
+// Release Functions
+    void                            Release(void);
+
+// Allocate Functions
+    bool                            Allocate(VkDescriptorSetLayout layout, VkDescriptorSet *descriptorSet);
+
+// Submit Functions
+    void                            SubmitFrame(uint32_t frame);
+
+// Retire Functions
+    void                            RetireFrame(uint32_t frame);
+    void                            RetireAll(void);
+
+// Get Functions
+    inline uint64_t                 GetSerial(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mSerial; }
+};
+
+}
+
+#endif // __VKDESCRIPTORPOOLRING_H__
@@ -22,12 +22,20 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#ifndef WIN32
+#include <poll.h>
+#include <unistd.h>
+#endif // WIN32
 #include "fence.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
 Fence::Fence(const vkContext_t *vkContext)
-: mVkContext(vkContext), mVkFence(VK_NULL_HANDLE)
+: mVkContext(vkContext), mVkFence(VK_NULL_HANDLE), mSyncFd(-1), mExported(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -45,9 +53,17 @@ Fence::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkFence != VK_NULL_HANDLE) {
-        vkDestroyFence(mVkContext->vkDevice, mVkFence, nullptr);
+        vkDestroyFence(mVkContext->vkDevice, mVkFence, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE));
         mVkFence = VK_NULL_HANDLE;
     }
+
+#ifndef WIN32
+    if(mSyncFd >= 0) {
+        close(mSyncFd);
+    }
+#endif // WIN32
+    mSyncFd   = -1;
+    mExported = false;
 }
 
 bool
@@ -66,7 +82,12 @@ Fence::Wait(VkBool32 waitAll, uint64_t timeout)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mExported) {
+        return WaitFor(UINT64_MAX) == VK_SUCCESS;
+    }
+
     VkResult err = VK_TIMEOUT;
+    const auto start = std::chrono::steady_clock::now();
 
     do {
 
@@ -78,11 +99,65 @@ Fence::Wait(VkBool32 waitAll, uint64_t timeout)
 
     } while (err == VK_TIMEOUT);
 
+    CountWait(start);
+
     return true;
 }
 
+VkResult
+Fence::WaitFor(uint64_t timeout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifndef WIN32
+    // exporting a sync file reset the fence, its payload lives in the file from then on
+    if(mExported) {
+        if(mSyncFd < 0) {
+            return VK_SUCCESS;
+        }
+
+        struct pollfd pfd;
+        pfd.fd      = mSyncFd;
+        pfd.events  = POLLIN;
+        pfd.revents = 0;
+        const int timeoutMs = timeout == UINT64_MAX ? -1 : static_cast<int>(std::min<uint64_t>(timeout / 1000000 + (timeout % 1000000 != 0), INT32_MAX));
+
+        const auto start = std::chrono::steady_clock::now();
+        const int ready = poll(&pfd, 1, timeoutMs);
+        if(timeout) {
+            CountWait(start);
+        }
+
+        return ready > 0 ? VK_SUCCESS : (ready == 0 ? VK_TIMEOUT : VK_ERROR_DEVICE_LOST);
+    }
+#endif // WIN32
+
+    // unlike Wait, an expired timeout is handed back to the caller
+    if(!timeout) {
+        return vkWaitForFences(mVkContext->vkDevice, 1, &mVkFence, VK_TRUE, timeout);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    VkResult err = vkWaitForFences(mVkContext->vkDevice, 1, &mVkFence, VK_TRUE, timeout);
+    CountWait(start);
+
+    return err;
+}
+
+void
+Fence::CountWait(std::chrono::steady_clock::time_point start) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // polls are not counted, only the waits that may block the calling thread
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    mVkContext->perfCounters->Add(PERF_COUNTER_FENCE_WAITS);
+    mVkContext->perfCounters->Add(PERF_COUNTER_FENCE_WAIT_NS, static_cast<uint64_t>(duration.count()));
+    StallDetector::Record(STALL_REASON_FENCE, static_cast<uint64_t>(duration.count()));
+}
+
 bool
-Fence::Create(bool signaled)
+Fence::Create(bool signaled, bool exportable)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
@@ -91,10 +166,54 @@ Fence::Create(bool signaled)
     info.pNext = nullptr;
     info.flags = signaled ? VK_FENCE_CREATE_SIGNALED_BIT : 0;
 
-    VkResult err = vkCreateFence(mVkContext->vkDevice, &info, nullptr, &mVkFence);
+#if defined(VK_KHR_external_fence_fd) && !defined(WIN32)
+    VkExportFenceCreateInfoKHR exportInfo;
+    if(exportable) {
+        if(!mVkContext->mIsSyncFdFenceSupported) {
+            return false;
+        }
+
+        exportInfo.sType       = VK_STRUCTURE_TYPE_EXPORT_FENCE_CREATE_INFO_KHR;
+        exportInfo.pNext       = nullptr;
+        exportInfo.handleTypes = VK_EXTERNAL_FENCE_HANDLE_TYPE_SYNC_FD_BIT_KHR;
+        info.pNext             = &exportInfo;
+    }
+#else
+    if(exportable) {
+        return false;
+    }
+#endif // VK_KHR_external_fence_fd && !WIN32
+
+    VkResult err = vkCreateFence(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &mVkFence);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
 }
 
+int
+Fence::ExportSyncFd(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#if defined(VK_KHR_external_fence_fd) && !defined(WIN32)
+    // the payload is moved into the sync file once, every caller gets a descriptor of its own to it
+    if(!mExported) {
+        VkFenceGetFdInfoKHR info;
+        info.sType      = VK_STRUCTURE_TYPE_FENCE_GET_FD_INFO_KHR;
+        info.pNext      = nullptr;
+        info.fence      = mVkFence;
+        info.handleType = VK_EXTERNAL_FENCE_HANDLE_TYPE_SYNC_FD_BIT_KHR;
+        if(mVkContext->fpGetFenceFdKHR(mVkContext->vkDevice, &info, &mSyncFd) != VK_SUCCESS) {
+            mSyncFd = -1;
+            return -1;
+        }
+        mExported = true;
+    }
+
+    return mSyncFd >= 0 ? dup(mSyncFd) : -1;
+#else
+    return -1;
+#endif // VK_KHR_external_fence_fd && !WIN32
+}
+
 }
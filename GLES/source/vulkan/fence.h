@@ -24,6 +24,7 @@
 #ifndef __VKFENCE_H__
 #define __VKFENCE_H__
 
+#include <chrono>
 #include "context.h"
 
 namespace vulkanAPI {
@@ -37,6 +38,12 @@ private:
 
     VkFence                           mVkFence;
 
+    /// sync file the fence has been exported as, which then carries its payload (-1 once signaled)
+    int                               mSyncFd;
+    bool                              mExported;
+
+    void                              CountWait(std::chrono::steady_clock::time_point start) const;
+
 public:
 // Constructor
     Fence(const vkContext_t *vkContext = nullptr);
@@ -45,7 +52,7 @@ public:
     ~Fence();
 
 // Create Functions
-    bool                              Create(bool signaled);
+    bool                              Create(bool signaled, bool exportable = false);
 
 // Release Functions
     void                              Release(void);
@@ -55,9 +62,14 @@ public:
 
 // Wait Functions
     bool                              Wait(VkBool32  waitAll, uint64_t timeout);
+    VkResult                          WaitFor(uint64_t timeout);
+
+// Export Functions
+    int                               ExportSyncFd(void);
 
 // Get Functions
     inline VkFence                    GetFence(void)                      const { FUN_ENTRY(GL_LOG_TRACE); return mVkFence; }
+    inline bool                       IsExported(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mExported; }
 
 // Set Functions
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; }
@@ -27,12 +27,14 @@
  */
 
 #include "framebuffer.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
 Framebuffer::Framebuffer(const vkContext_t *vkContext)
 : mVkContext(vkContext),
-  mVkFramebuffer(VK_NULL_HANDLE)
+  mVkFramebuffer(VK_NULL_HANDLE),
+  mWidth(0), mHeight(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 }
@@ -50,7 +52,7 @@ Framebuffer::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkFramebuffer != VK_NULL_HANDLE) {
-        vkDestroyFramebuffer(mVkContext->vkDevice, mVkFramebuffer, nullptr);
+        vkDestroyFramebuffer(mVkContext->vkDevice, mVkFramebuffer, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
         mVkFramebuffer = VK_NULL_HANDLE;
     }
 }
@@ -62,18 +64,35 @@ Framebuffer::Create(vector<VkImageView> *imageViews, VkRenderPass *renderpass, u
 
     Release();
 
+    mVkImageViews = *imageViews;
+    mWidth        = width;
+    mHeight       = height;
+
+    // passes begun dynamically have no render pass object, the framebuffer object waits for one that does
+    if(*renderpass == VK_NULL_HANDLE) {
+        return true;
+    }
+
+    return CreateVkFramebuffer(renderpass);
+}
+
+bool
+Framebuffer::CreateVkFramebuffer(const VkRenderPass *renderpass)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
     VkFramebufferCreateInfo info;
     info.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
     info.pNext           = nullptr;
     info.flags           = 0;
     info.renderPass      = *renderpass;
-    info.width           = width;
-    info.height          = height;
+    info.width           = mWidth;
+    info.height          = mHeight;
     info.layers          = 1;
-    info.attachmentCount = static_cast<uint32_t>(imageViews->size());
-    info.pAttachments    = imageViews->data();
+    info.attachmentCount = static_cast<uint32_t>(mVkImageViews.size());
+    info.pAttachments    = mVkImageViews.data();
 
-    VkResult err = vkCreateFramebuffer(mVkContext->vkDevice, &info, nullptr, &mVkFramebuffer);
+    VkResult err = vkCreateFramebuffer(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkFramebuffer);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -37,6 +37,11 @@ private:
 
     VkFramebuffer           mVkFramebuffer;
 
+    /// the attachments, in the order of the render pass, which passes begun dynamically render to directly
+    vector<VkImageView>     mVkImageViews;
+    uint32_t                mWidth;
+    uint32_t                mHeight;
+
 public:
 // Constructor
     Framebuffer(const vkContext_t *vkContext = nullptr);
@@ -46,12 +51,16 @@ public:
 
 // Create Functions
     bool                    Create  (vector<VkImageView> *imageViews, VkRenderPass *renderpass, uint32_t width, uint32_t height);
+    bool                    CreateVkFramebuffer(const VkRenderPass *renderpass);
 
 // Release Functions
     void                    Release (void);
 
 // Get functions
     inline VkFramebuffer*   GetFramebuffer(void)                                { FUN_ENTRY(GL_LOG_TRACE); return &mVkFramebuffer; }
+    inline const
+           VkFramebuffer*   GetFramebuffer(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return &mVkFramebuffer; }
+    inline const vector<VkImageView> &GetImageViews(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageViews; }
 };
 
 }
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       hostAllocator.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Host Memory Allocation Callbacks of the Vulkan Objects, Accounted Per Subsystem
+ *
+ *  @section
+ *
+ *  Without allocation callbacks, the host memory the driver allocates for
+ *  each object comes from the general purpose heap and is accounted nowhere.
+ *  Every object is instead created with the callbacks of the subsystem it
+ *  belongs to, which count the bytes it holds into a perf counter of that
+ *  subsystem, and serve the small allocations most objects make out of
+ *  per size class free lists, so that objects created and destroyed every
+ *  frame reuse the same blocks rather than going back to the heap.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+/// Precedes every allocation, the size is the one asked for
+typedef struct BlockHeader_t {
+    size_t                                  size;
+    uint32_t                                offset;
+    uint32_t                                sizeClass;
+} BlockHeader_t;
+
+/// Space the header takes in front of every allocation, which keeps the allocations aligned as malloc's are
+static const size_t HOST_ALLOCATOR_HEADER_SPACE = (sizeof(BlockHeader_t) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+static inline BlockHeader_t *
+GetHeader(void *memory)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return reinterpret_cast<BlockHeader_t *>(static_cast<uint8_t *>(memory) - sizeof(BlockHeader_t));
+}
+
+HostAllocator::HostAllocator(PerfCounters *perfCounters)
+: mEnabled(true)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const char *enabled = getenv(GLOVE_HOST_ALLOCATOR_ENV);
+    mEnabled = (enabled == nullptr || atoi(enabled) != 0);
+
+    for(uint32_t i = 0; i < HOST_ALLOCATION_COUNT; ++i) {
+        Subsystem_t &subsystem = mSubsystems[i];
+
+        subsystem.perfCounters = perfCounters;
+        subsystem.counter      = static_cast<perfCounter_t>(PERF_COUNTER_HOST_BYTES_PIPELINES + i);
+        for(uint32_t c = 0; c < GLOVE_HOST_ALLOCATOR_SIZE_CLASSES; ++c) {
+            subsystem.freeBlocks[c] = nullptr;
+            subsystem.freeCount[c]  = 0;
+        }
+
+        subsystem.callbacks.pUserData             = &subsystem;
+        subsystem.callbacks.pfnAllocation         = Allocate;
+        subsystem.callbacks.pfnReallocation       = Reallocate;
+        subsystem.callbacks.pfnFree               = Free;
+        subsystem.callbacks.pfnInternalAllocation = InternalAllocation;
+        subsystem.callbacks.pfnInternalFree       = InternalFree;
+    }
+}
+
+HostAllocator::~HostAllocator()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto &subsystem : mSubsystems) {
+        for(uint32_t c = 0; c < GLOVE_HOST_ALLOCATOR_SIZE_CLASSES; ++c) {
+            void *memory = subsystem.freeBlocks[c];
+            while(memory != nullptr) {
+                void *next = *static_cast<void **>(memory);
+                free(static_cast<uint8_t *>(memory) - GetHeader(memory)->offset);
+                memory = next;
+            }
+            subsystem.freeBlocks[c] = nullptr;
+            subsystem.freeCount[c]  = 0;
+        }
+    }
+}
+
+uint32_t
+HostAllocator::GetSizeClass(size_t size, size_t alignment)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the pooled blocks are only as aligned as malloc returns them
+    if(alignment > alignof(std::max_align_t)) {
+        return GLOVE_HOST_ALLOCATOR_SIZE_CLASSES;
+    }
+
+    uint32_t sizeClass = 0;
+    while(sizeClass < GLOVE_HOST_ALLOCATOR_SIZE_CLASSES && size > (static_cast<size_t>(GLOVE_HOST_ALLOCATOR_MIN_SIZE_CLASS) << sizeClass)) {
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
+
+VKAPI_ATTR void *VKAPI_CALL
+HostAllocator::Allocate(void *userData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Subsystem_t *subsystem = static_cast<Subsystem_t *>(userData);
+    if(size == 0) {
+        return nullptr;
+    }
+
+    const uint32_t sizeClass = GetSizeClass(size, alignment);
+    uint8_t       *memory    = nullptr;
+    uint8_t       *base      = nullptr;
+
+    if(sizeClass < GLOVE_HOST_ALLOCATOR_SIZE_CLASSES) {
+        {
+            std::lock_guard<std::mutex> lock(subsystem->mutex);
+            memory = static_cast<uint8_t *>(subsystem->freeBlocks[sizeClass]);
+            if(memory != nullptr) {
+                subsystem->freeBlocks[sizeClass] = *reinterpret_cast<void **>(memory);
+                --subsystem->freeCount[sizeClass];
+            }
+        }
+
+        if(memory == nullptr) {
+            base = static_cast<uint8_t *>(malloc(HOST_ALLOCATOR_HEADER_SPACE + (static_cast<size_t>(GLOVE_HOST_ALLOCATOR_MIN_SIZE_CLASS) << sizeClass)));
+            if(base == nullptr) {
+                return nullptr;
+            }
+            memory = base + HOST_ALLOCATOR_HEADER_SPACE;
+        }
+    } else {
+        base = static_cast<uint8_t *>(malloc(HOST_ALLOCATOR_HEADER_SPACE + size + alignment));
+        if(base == nullptr) {
+            return nullptr;
+        }
+
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(base) + HOST_ALLOCATOR_HEADER_SPACE + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        memory = reinterpret_cast<uint8_t *>(aligned);
+    }
+
+    BlockHeader_t *header = GetHeader(memory);
+    header->size          = size;
+    header->sizeClass     = sizeClass;
+    if(base != nullptr) {
+        header->offset    = static_cast<uint32_t>(memory - base);
+    }
+
+    subsystem->perfCounters->Add(subsystem->counter, size);
+
+    return memory;
+}
+
+VKAPI_ATTR void *VKAPI_CALL
+HostAllocator::Reallocate(void *userData, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(original == nullptr) {
+        return Allocate(userData, size, alignment, scope);
+    }
+
+    if(size == 0) {
+        Free(userData, original);
+        return nullptr;
+    }
+
+    // a pooled block grows or shrinks in place as long as it stays in its size class
+    BlockHeader_t *header = GetHeader(original);
+    if(header->sizeClass < GLOVE_HOST_ALLOCATOR_SIZE_CLASSES && GetSizeClass(size, alignment) == header->sizeClass) {
+        Subsystem_t *subsystem = static_cast<Subsystem_t *>(userData);
+        subsystem->perfCounters->Add(subsystem->counter, size);
+        subsystem->perfCounters->Sub(subsystem->counter, header->size);
+        header->size = size;
+        return original;
+    }
+
+    void *memory = Allocate(userData, size, alignment, scope);
+    if(memory == nullptr) {
+        return nullptr;
+    }
+
+    memcpy(memory, original, std::min(size, header->size));
+    Free(userData, original);
+
+    return memory;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+HostAllocator::Free(void *userData, void *memory)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(memory == nullptr) {
+        return;
+    }
+
+    Subsystem_t   *subsystem = static_cast<Subsystem_t *>(userData);
+    BlockHeader_t *header    = GetHeader(memory);
+
+    subsystem->perfCounters->Sub(subsystem->counter, header->size);
+
+    if(header->sizeClass < GLOVE_HOST_ALLOCATOR_SIZE_CLASSES) {
+        std::lock_guard<std::mutex> lock(subsystem->mutex);
+        if(subsystem->freeCount[header->sizeClass] < GLOVE_HOST_ALLOCATOR_POOL_DEPTH) {
+            *static_cast<void **>(memory) = subsystem->freeBlocks[header->sizeClass];
+            subsystem->freeBlocks[header->sizeClass] = memory;
+            ++subsystem->freeCount[header->sizeClass];
+            return;
+        }
+    }
+
+    free(static_cast<uint8_t *>(memory) - header->offset);
+}
+
+VKAPI_ATTR void VKAPI_CALL
+HostAllocator::InternalAllocation(void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // memory the driver allocates on its own, such as for executable code, counts into the same subsystem
+    Subsystem_t *subsystem = static_cast<Subsystem_t *>(userData);
+    subsystem->perfCounters->Add(subsystem->counter, size);
+}
+
+VKAPI_ATTR void VKAPI_CALL
+HostAllocator::InternalFree(void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Subsystem_t *subsystem = static_cast<Subsystem_t *>(userData);
+    subsystem->perfCounters->Sub(subsystem->counter, size);
+}
+
+}
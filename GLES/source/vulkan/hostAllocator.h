@@ -0,0 +1,98 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       hostAllocator.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Host Memory Allocation Callbacks of the Vulkan Objects, Accounted Per Subsystem
+ *
+ */
+
+#ifndef __VKHOSTALLOCATOR_H__
+#define __VKHOSTALLOCATOR_H__
+
+#include <mutex>
+#include "context.h"
+#include "perfCounters.h"
+
+/// Environment variable that, set to 0, leaves the host allocations of the driver to its own allocator
+#define GLOVE_HOST_ALLOCATOR_ENV                        "GLOVE_HOST_ALLOCATOR"
+
+/// Smallest size class of the pooled allocations, the classes grow in powers of two
+#define GLOVE_HOST_ALLOCATOR_MIN_SIZE_CLASS             64
+
+/// Size classes of the pooled allocations, larger ones come from the heap every time
+#define GLOVE_HOST_ALLOCATOR_SIZE_CLASSES               5
+
+/// Freed blocks each size class of a subsystem keeps for the next allocations at most
+#define GLOVE_HOST_ALLOCATOR_POOL_DEPTH                 256
+
+namespace vulkanAPI {
+
+typedef enum {
+    /// pipelines, pipeline layouts, pipeline caches and shader modules
+    HOST_ALLOCATION_PIPELINES = 0,
+    /// descriptor pools, descriptor set layouts and update templates
+    HOST_ALLOCATION_DESCRIPTORS,
+    /// command and query pools
+    HOST_ALLOCATION_COMMANDS,
+    /// images, buffers, device memory and the views, samplers, render passes and framebuffers over them
+    HOST_ALLOCATION_RESOURCES,
+    /// the instance, the device and the synchronization objects
+    HOST_ALLOCATION_DEVICE,
+    HOST_ALLOCATION_COUNT
+} hostAllocation_t;
+
+class HostAllocator final {
+private:
+    typedef struct Subsystem_t {
+        PerfCounters                       *perfCounters;
+        perfCounter_t                       counter;
+
+        /// each freed block of a size class links to the next one in its first bytes
+        std::mutex                          mutex;
+        void                               *freeBlocks[GLOVE_HOST_ALLOCATOR_SIZE_CLASSES];
+        uint32_t                            freeCount[GLOVE_HOST_ALLOCATOR_SIZE_CLASSES];
+
+        VkAllocationCallbacks               callbacks;
+    } Subsystem_t;
+
+    Subsystem_t                             mSubsystems[HOST_ALLOCATION_COUNT];
+    bool                                    mEnabled;
+
+    static uint32_t                         GetSizeClass(size_t size, size_t alignment);
+
+    static VKAPI_ATTR void *VKAPI_CALL      Allocate(void *userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    static VKAPI_ATTR void *VKAPI_CALL      Reallocate(void *userData, void *original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+    static VKAPI_ATTR void  VKAPI_CALL      Free(void *userData, void *memory);
+    static VKAPI_ATTR void  VKAPI_CALL      InternalAllocation(void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+    static VKAPI_ATTR void  VKAPI_CALL      InternalFree(void *userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+public:
+// Constructor
+    HostAllocator(PerfCounters *perfCounters);
+
+// Destructor
+    ~HostAllocator();
+
+// Get Functions
+    /// the callbacks the objects of a subsystem are created and destroyed with, which must be the same for both
+    inline const VkAllocationCallbacks     *GetCallbacks(hostAllocation_t subsystem) const  { FUN_ENTRY(GL_LOG_TRACE); return mEnabled ? &mSubsystems[subsystem].callbacks : nullptr; }
+};
+
+}
+
+#endif // __VKHOSTALLOCATOR_H__
@@ -29,19 +29,140 @@
  *
  */
 
+#include <algorithm>
 #include "image.h"
+#include "hostAllocator.h"
+#include "capabilityCache.h"
 
 namespace vulkanAPI {
 
+#define GLOVE_VK_ACCESS_WRITE_BITS  (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | \
+                                     VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT)
+
+// Accesses and stages of the work that uses an image in the given layout.
+// They are the destination scope of a transition into the layout and, until
+// the next transition, the source scope of the one out of it.
+static void
+GetVkImageLayoutUsage(VkImageLayout layout, VkAccessFlags *accessMask, VkPipelineStageFlags *stageMask)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(layout) {
+    case VK_IMAGE_LAYOUT_PREINITIALIZED:
+        // Only valid as initial layout for linear images, preserves host writes
+        *accessMask = VK_ACCESS_HOST_WRITE_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_HOST_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        *accessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        *accessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        *accessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        *accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        // sampler or input attachment
+        *accessMask = VK_ACCESS_SHADER_READ_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+        // depth textures sampled in place, shadow maps mostly
+        *accessMask = VK_ACCESS_SHADER_READ_BIT;
+        *stageMask  = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        // the presentation engine is synchronized through semaphores
+        *accessMask = 0;
+        *stageMask  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        break;
+
+    case VK_IMAGE_LAYOUT_GENERAL:
+    case VK_IMAGE_LAYOUT_UNDEFINED:
+        // GENERAL images are written through the upload queue and handed over with semaphores
+        *accessMask = 0;
+        *stageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        break;
+
+    default:
+        NOT_REACHED();
+        *accessMask = 0;
+        *stageMask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        break;
+    }
+}
+
+ImageBarrierBatch::ImageBarrierBatch()
+: mVkSrcStages(0), mVkDstStages(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+ImageBarrierBatch::~ImageBarrierBatch()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+void
+ImageBarrierBatch::Add(const VkImageMemoryBarrier *imageMemoryBarrier, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mVkImageMemoryBarriers.push_back(*imageMemoryBarrier);
+    mVkSrcStages |= srcStages;
+    mVkDstStages |= dstStages;
+}
+
+void
+ImageBarrierBatch::Record(VkCommandBuffer *activeCmdBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkImageMemoryBarriers.empty()) {
+        return;
+    }
+
+    vkCmdPipelineBarrier(*activeCmdBuffer,
+                         mVkSrcStages ? mVkSrcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                         mVkDstStages ? mVkDstStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+                         0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(mVkImageMemoryBarriers.size()), mVkImageMemoryBarriers.data());
+
+    mVkImageMemoryBarriers.clear();
+    mVkSrcStages = 0;
+    mVkDstStages = 0;
+}
+
 Image::Image(const vkContext_t *vkContext)
 : mVkContext(vkContext), mVkImage(VK_NULL_HANDLE), mVkFormat(VK_FORMAT_UNDEFINED), mVkImageType(VK_IMAGE_TYPE_2D),
 mVkImageUsage(VK_IMAGE_USAGE_FLAG_BITS_MAX_ENUM), mVkImageLayout(VK_IMAGE_LAYOUT_UNDEFINED),
-mVkImageTiling(VK_IMAGE_TILING_LINEAR), mVkImageTarget(VK_IMAGE_TARGET_2D),
+mVkImageTiling(VK_IMAGE_TILING_OPTIMAL), mVkImageTarget(VK_IMAGE_TARGET_2D),
 mVkSampleCount(VK_SAMPLE_COUNT_1_BIT), mVkSharingMode(VK_SHARING_MODE_EXCLUSIVE),
 mWidth(0), mHeight(0), mMipLevels(1), mLayers(1), mDelete(true),
-mCopyStencil(false)
+mCopyStencil(false), mHostTransferRequested(false), mHostTransfer(false), mExportable(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
+
+    memset(static_cast<void *>(&mVkImageSubresourceRange), 0, sizeof(mVkImageSubresourceRange));
+    mVkImageSubresourceRange.levelCount = 1;
+    mVkImageSubresourceRange.layerCount = 1;
+
+    ResetSubresourceStates();
 }
 
 Image::~Image()
@@ -58,23 +179,65 @@ Image::Release(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkImage != VK_NULL_HANDLE) {
-        vkDestroyImage(mVkContext->vkDevice, mVkImage, nullptr);
-        mVkImage = VK_NULL_HANDLE;
+    // images set from outside belong to whoever created them
+    if(mVkImage != VK_NULL_HANDLE && mDelete) {
+        vkDestroyImage(mVkContext->vkDevice, mVkImage, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
     }
+    mVkImage    = VK_NULL_HANDLE;
 
     mWidth      = 0;
     mHeight     = 0;
     mMipLevels  = 1;
     mLayers     = 1;
     mDelete     = true;
+    mHostTransfer = false;
+
+    ResetSubresourceStates();
+}
+
+void
+Image::ResetSubresourceStates(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    SubresourceState_t state;
+    state.layout = mVkImageLayout;
+    GetVkImageLayoutUsage(mVkImageLayout, &state.accessMask, &state.stageMask);
+
+    mSubresourceStates.assign(mMipLevels * mLayers, state);
+}
+
+void
+Image::DiscardContents(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the memory was last written through another image aliasing it, whose work the next barrier has to wait for
+    SubresourceState_t state;
+    state.layout     = VK_IMAGE_LAYOUT_UNDEFINED;
+    state.accessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    state.stageMask  = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    mVkImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    mSubresourceStates.assign(mMipLevels * mLayers, state);
+}
+
+VkImageLayout
+Image::GetImageLayout(uint32_t mipLevel, uint32_t layer) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(mipLevel >= mMipLevels || layer >= mLayers) {
+        return mVkImageLayout;
+    }
+
+    return mSubresourceStates[layer * mMipLevels + mipLevel].layout;
 }
 
 void
 Image::SetImageTiling(void)
 {
-    VkFormatProperties props;
-    vkGetPhysicalDeviceFormatProperties(mVkContext->vkGpus[0], mVkFormat, &props);
+    const VkFormatProperties props = mVkContext->capabilityCache->GetFormatProperties(mVkFormat);
 
     VkFormatFeatureFlagBits flagbits = static_cast<VkFormatFeatureFlagBits>(0);
     if(mVkImageUsage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) {
@@ -84,14 +247,11 @@ Image::SetImageTiling(void)
         flagbits = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
     }
 
-    if      (props.linearTilingFeatures  & flagbits) {
+    // images are read and written by the GPU only, uploads go through staging buffers,
+    // so that linear tiling is only chosen when asked for; multisampled images can only be optimal
+    if(mVkContext->mPreferLinearImages && mVkSampleCount == VK_SAMPLE_COUNT_1_BIT && (props.linearTilingFeatures & flagbits)) {
         mVkImageTiling = VK_IMAGE_TILING_LINEAR;
-    }
-    else if (props.optimalTilingFeatures & flagbits) {
-        mVkImageTiling = VK_IMAGE_TILING_OPTIMAL;
-    }
-    else {
-        // Format not supported
+    } else {
         mVkImageTiling = VK_IMAGE_TILING_OPTIMAL;
     }
 }
@@ -122,17 +282,157 @@ Image::Create(void)
     info.queueFamilyIndexCount = 0;
     info.pQueueFamilyIndices   = nullptr;
 
-    VkResult err = vkCreateImage(mVkContext->vkDevice, &info, nullptr, &mVkImage);
+    // the memory of the image is shared with other devices through a dma-buf, see Memory::Export
+    VkExternalMemoryImageCreateInfoKHR externalInfo;
+    memset(static_cast<void *>(&externalInfo), 0, sizeof(externalInfo));
+    if(mExportable) {
+        externalInfo.sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO_KHR;
+        externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+        info.pNext               = &externalInfo;
+    }
+
+#ifdef VK_EXT_host_image_copy
+    mHostTransfer = mHostTransferRequested && mVkSampleCount == VK_SAMPLE_COUNT_1_BIT &&
+                    mVkContext->capabilityCache->IsHostImageTransferSupported(mVkFormat, mVkImageTiling);
+    if(mHostTransfer) {
+        info.usage = static_cast<VkImageUsageFlags>(info.usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT);
+    }
+#else
+    mHostTransfer = false;
+#endif // VK_EXT_host_image_copy
+
+    // images filled by the upload queue are shared with the graphics queue
+    // to avoid explicit queue family ownership transfers
+    uint32_t queueFamilyIndices[2] = {mVkContext->vkGraphicsQueueNodeIndex, mVkContext->vkTransferQueueNodeIndex};
+    if((mVkImageUsage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) && queueFamilyIndices[0] != queueFamilyIndices[1]) {
+        info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+        info.queueFamilyIndexCount = 2;
+        info.pQueueFamilyIndices   = queueFamilyIndices;
+    }
+
+    VkResult err = vkCreateImage(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkImage);
     assert(!err);
 
     mDelete = VK_TRUE;
     mLayers = info.arrayLayers;
 
     CreateImageSubresourceRange();
+    ResetSubresourceStates();
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
 }
 
+bool
+Image::Import(const EGLImageInterface *eglImage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkExternalMemoryImageCreateInfoKHR externalInfo;
+    memset(static_cast<void *>(&externalInfo), 0, sizeof(externalInfo));
+    externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO_KHR;
+
+    VkImageTiling tiling;
+#ifdef VK_EXT_image_drm_format_modifier
+    VkSubresourceLayout planeLayouts[GLOVE_MAX_EGL_IMAGE_PLANES];
+    VkImageDrmFormatModifierExplicitCreateInfoEXT modifierInfo;
+    memset(static_cast<void *>(&modifierInfo), 0, sizeof(modifierInfo));
+#endif // VK_EXT_image_drm_format_modifier
+
+    if(eglImage->source == EGL_IMAGE_SOURCE_DMA_BUF) {
+        if(!mVkContext->mIsExternalMemoryDmaBufSupported) {
+            return false;
+        }
+        externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
+        if(mVkContext->mIsDrmFormatModifierSupported && eglImage->hasModifier) {
+#ifdef VK_EXT_image_drm_format_modifier
+            // the driver is told the exact layout the exporter tiled the buffer with
+            for(uint32_t i = 0; i < eglImage->planeCount; ++i) {
+                memset(static_cast<void *>(&planeLayouts[i]), 0, sizeof(planeLayouts[i]));
+                planeLayouts[i].offset   = eglImage->offsets[i];
+                planeLayouts[i].rowPitch = eglImage->pitches[i];
+            }
+            modifierInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_DRM_FORMAT_MODIFIER_EXPLICIT_CREATE_INFO_EXT;
+            modifierInfo.drmFormatModifier           = eglImage->modifier;
+            modifierInfo.drmFormatModifierPlaneCount = eglImage->planeCount;
+            modifierInfo.pPlaneLayouts               = planeLayouts;
+            externalInfo.pNext                       = &modifierInfo;
+            tiling = VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT;
+#else
+            return false;
+#endif // VK_EXT_image_drm_format_modifier
+        } else if(!eglImage->hasModifier || eglImage->modifier == GLOVE_DRM_FORMAT_MOD_LINEAR) {
+            // without modifiers only linear buffers can be described, as linear images of the same pitch
+            tiling = VK_IMAGE_TILING_LINEAR;
+        } else {
+            return false;
+        }
+    } else {
+#ifdef VK_ANDROID_external_memory_android_hardware_buffer
+        if(!mVkContext->mIsAndroidHardwareBufferSupported) {
+            return false;
+        }
+        externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_ANDROID_HARDWARE_BUFFER_BIT_ANDROID;
+        tiling = VK_IMAGE_TILING_OPTIMAL;
+#else
+        return false;
+#endif // VK_ANDROID_external_memory_android_hardware_buffer
+    }
+
+    mVkFormat      = eglImage->vkFormat;
+    mWidth         = eglImage->width;
+    mHeight        = eglImage->height;
+    mMipLevels     = 1;
+    mVkImageTiling = tiling;
+    mVkImageTarget = VK_IMAGE_TARGET_2D;
+    mVkSampleCount = VK_SAMPLE_COUNT_1_BIT;
+    mVkImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkImageCreateInfo info;
+    info.sType          = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    info.pNext          = &externalInfo;
+    info.flags          = 0;
+    info.imageType      = VK_IMAGE_TYPE_2D;
+    info.format         = mVkFormat;
+    info.extent.width   = mWidth;
+    info.extent.height  = mHeight;
+    info.extent.depth   = 1;
+    info.arrayLayers    = TEXTURE_2D_LAYERS;
+    info.mipLevels      = mMipLevels;
+    info.samples        = mVkSampleCount;
+    info.tiling         = mVkImageTiling;
+    info.usage          = mVkImageUsage;
+    info.sharingMode    = VK_SHARING_MODE_EXCLUSIVE;
+    info.initialLayout  = mVkImageLayout;
+    info.queueFamilyIndexCount = 0;
+    info.pQueueFamilyIndices   = nullptr;
+
+    VkResult err = vkCreateImage(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkImage);
+    if(err != VK_SUCCESS) {
+        mVkImage = VK_NULL_HANDLE;
+        return false;
+    }
+
+    mDelete = VK_TRUE;
+    mLayers = info.arrayLayers;
+
+    CreateImageSubresourceRange();
+    ResetSubresourceStates();
+
+    // the rows of a linear image must be laid out like the ones of the buffer
+    if(mVkImageTiling == VK_IMAGE_TILING_LINEAR) {
+        VkImageSubresource subresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0};
+        VkSubresourceLayout layout;
+        vkGetImageSubresourceLayout(mVkContext->vkDevice, mVkImage, &subresource, &layout);
+        if(layout.rowPitch != eglImage->pitches[0]) {
+            Release();
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void
 Image::CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWidth, uint32_t extentHeight, uint32_t miplevel, uint32_t layer, uint32_t layerCount)
 {
@@ -170,7 +470,40 @@ Image::CopyBufferToImage(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    vkCmdCopyBufferToImage(*activeCmdBuffer, srcBuffer, mVkImage, mVkImageLayout, 1, &mVkBufferImageCopy);
+    vkCmdCopyBufferToImage(*activeCmdBuffer, srcBuffer, mVkImage,
+                           GetImageLayout(mVkBufferImageCopy.imageSubresource.mipLevel, mVkBufferImageCopy.imageSubresource.baseArrayLayer), 1, &mVkBufferImageCopy);
+}
+
+bool
+Image::CopyMemoryToImage(const void *srcData, uint32_t rowLength)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_EXT_host_image_copy
+    // the region of the last CreateBufferImageCopy, read from host memory instead of a buffer,
+    // which the device must not be accessing meanwhile
+    VkMemoryToImageCopyEXT region;
+    memset(static_cast<void *>(&region), 0, sizeof(region));
+    region.sType             = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+    region.pHostPointer      = srcData;
+    region.memoryRowLength   = rowLength;
+    region.memoryImageHeight = 0;
+    region.imageSubresource  = mVkBufferImageCopy.imageSubresource;
+    region.imageOffset       = mVkBufferImageCopy.imageOffset;
+    region.imageExtent       = mVkBufferImageCopy.imageExtent;
+
+    VkCopyMemoryToImageInfoEXT info;
+    memset(static_cast<void *>(&info), 0, sizeof(info));
+    info.sType          = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+    info.dstImage       = mVkImage;
+    info.dstImageLayout = GetImageLayout(region.imageSubresource.mipLevel, region.imageSubresource.baseArrayLayer);
+    info.regionCount    = 1;
+    info.pRegions       = &region;
+
+    return mHostTransfer && mVkContext->fpCopyMemoryToImageEXT(mVkContext->vkDevice, &info) == VK_SUCCESS;
+#else
+    return false;
+#endif // VK_EXT_host_image_copy
 }
 
 void
@@ -178,7 +511,8 @@ Image::CopyImageToBuffer(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    vkCmdCopyImageToBuffer(*activeCmdBuffer, mVkImage, mVkImageLayout, srcBuffer, 1, &mVkBufferImageCopy);
+    vkCmdCopyImageToBuffer(*activeCmdBuffer, mVkImage,
+                           GetImageLayout(mVkBufferImageCopy.imageSubresource.mipLevel, mVkBufferImageCopy.imageSubresource.baseArrayLayer), srcBuffer, 1, &mVkBufferImageCopy);
 }
 
 void
@@ -189,6 +523,14 @@ Image::BlitImage(VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout,
     vkCmdBlitImage(*activeCmdBuffer, GetImage(), srcImageLayout, dstImage, dstImageLayout, 1, imageBlit, imageFilter);
 }
 
+void
+Image::CopyImage(VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageCopy* imageCopy)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    vkCmdCopyImage(*activeCmdBuffer, GetImage(), srcImageLayout, dstImage, dstImageLayout, 1, imageCopy);
+}
+
 void
 Image::CreateImageSubresourceRange()
 {
@@ -224,144 +566,154 @@ Image::ModifyImageSubresourceRange(uint32_t baseMipLevel, uint32_t levelCount, u
     mVkImageSubresourceRange.layerCount      = layerCount;
 }
 
-void
+bool
 Image::ModifyImageLayout(VkCommandBuffer *activeCmdBuffer, VkImageLayout newImageLayout)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkImageLayout oldImageLayout = mVkImageLayout;
+    ImageBarrierBatch barriers;
+    bool changed = ModifyImageLayout(&barriers, newImageLayout);
+    barriers.Record(activeCmdBuffer);
+
+    return changed;
+}
+
+bool
+Image::ModifyImageLayout(ImageBarrierBatch *barriers, VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    SubresourceState_t newState;
+    newState.layout = newImageLayout;
+    GetVkImageLayoutUsage(newImageLayout, &newState.accessMask, &newState.stageMask);
+
+    const uint32_t baseLevel = mVkImageSubresourceRange.baseMipLevel;
+    const uint32_t baseLayer = mVkImageSubresourceRange.baseArrayLayer;
+    const uint32_t endLevel  = std::min(baseLevel + mVkImageSubresourceRange.levelCount, mMipLevels);
+    const uint32_t endLayer  = std::min(baseLayer + mVkImageSubresourceRange.layerCount, mLayers);
+    if(baseLevel >= endLevel || baseLayer >= endLayer) {
+        return false;
+    }
+
+    // a range in a single state is covered by a single barrier
+    const SubresourceState_t &baseState = mSubresourceStates[baseLayer * mMipLevels + baseLevel];
+    bool uniform = true;
+    for(uint32_t layer = baseLayer; layer < endLayer && uniform; ++layer) {
+        for(uint32_t level = baseLevel; level < endLevel; ++level) {
+            const SubresourceState_t &state = mSubresourceStates[layer * mMipLevels + level];
+            if(state.layout != baseState.layout || state.accessMask != baseState.accessMask || state.stageMask != baseState.stageMask) {
+                uniform = false;
+                break;
+            }
+        }
+    }
 
     VkImageMemoryBarrier imageMemoryBarrier;
     imageMemoryBarrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     imageMemoryBarrier.pNext                = nullptr;
-    imageMemoryBarrier.srcAccessMask        = 0;
-    imageMemoryBarrier.dstAccessMask        = 0;
-    imageMemoryBarrier.oldLayout            = oldImageLayout;
     imageMemoryBarrier.newLayout            = newImageLayout;
+    imageMemoryBarrier.dstAccessMask        = newState.accessMask;
     imageMemoryBarrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
     imageMemoryBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
     imageMemoryBarrier.image                = mVkImage;
-    imageMemoryBarrier.subresourceRange     = mVkImageSubresourceRange;
-
-    VkPipelineStageFlags srcStages  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    VkPipelineStageFlags destStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-
-    // Source layouts (old)
-    // Source access mask controls actions that have to be finished on the old layout
-    // before it will be transitioned to the new layout
-    switch(oldImageLayout) {
-    case VK_IMAGE_LAYOUT_PREINITIALIZED:
-            // Image is preinitialized
-            // Only valid as initial layout for linear images, preserves memory contents
-            // Make sure host writes have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-            srcStages = VK_PIPELINE_STAGE_HOST_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-            // Image is a color attachment
-            // Make sure any writes to the color buffer have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            srcStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-            // Image is a depth/stencil attachment
-            // Make sure any writes to the depth/stencil buffer have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            srcStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-            // Image is a transfer source
-            // Make sure any reads from the image have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            srcStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-            // Image is a transfer destination
-            // Make sure any writes to the image have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            srcStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            break;
-
-    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-            // Image is read by a shader
-            // Make sure any shader reads from the image have been finished
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            srcStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            break;
+    imageMemoryBarrier.subresourceRange.aspectMask = mVkImageSubresourceRange.aspectMask;
+
+    bool changed = false;
+    for(uint32_t layer = baseLayer; layer < endLayer; ++layer) {
+        uint32_t level = baseLevel;
+        while(level < endLevel) {
+            SubresourceState_t *state = &mSubresourceStates[layer * mMipLevels + level];
+
+            // successive levels in the same state share a barrier
+            uint32_t levelCount = 1;
+            while(level + levelCount < endLevel &&
+                  state[levelCount].layout     == state->layout     &&
+                  state[levelCount].accessMask == state->accessMask &&
+                  state[levelCount].stageMask  == state->stageMask) {
+                ++levelCount;
+            }
+
+            // reads in the layout already in place need no barrier, writes still have to be made visible
+            if(state->layout != newImageLayout || (state->accessMask & GLOVE_VK_ACCESS_WRITE_BITS)) {
+                VkPipelineStageFlags srcStages = state->stageMask;
+
+                imageMemoryBarrier.oldLayout     = state->layout;
+                imageMemoryBarrier.srcAccessMask = state->accessMask & GLOVE_VK_ACCESS_WRITE_BITS;
+                if(newImageLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && imageMemoryBarrier.srcAccessMask == 0 &&
+                   state->layout  != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+                    // contents of unknown origin are assumed written by the host or a copy
+                    imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+                    srcStages = VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+                }
+
+                imageMemoryBarrier.subresourceRange.baseMipLevel   = uniform ? baseLevel : level;
+                imageMemoryBarrier.subresourceRange.levelCount     = uniform ? endLevel - baseLevel : levelCount;
+                imageMemoryBarrier.subresourceRange.baseArrayLayer = uniform ? baseLayer : layer;
+                imageMemoryBarrier.subresourceRange.layerCount     = uniform ? endLayer - baseLayer : 1;
+                barriers->Add(&imageMemoryBarrier, srcStages, newState.stageMask);
+
+                changed = changed || state->layout != newImageLayout;
+            }
+
+            if(uniform) {
+                break;
+            }
+
+            for(uint32_t i = 0; i < levelCount; ++i) {
+                state[i] = newState;
+            }
+            level += levelCount;
+        }
 
-    case VK_IMAGE_LAYOUT_UNDEFINED:
-    default:
-            // Image layout is undefined (or does not matter)
-            // Only valid as initial layout
-            // No flags required, listed only for completeness
-            imageMemoryBarrier.srcAccessMask = 0;
+        if(uniform) {
             break;
+        }
     }
 
-
-    // Target layouts (new)
-    // Destination access mask controls the dependency for the new image layout
-    switch(newImageLayout) {
-    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-        // Image will be used as a transfer destination
-        // Make sure any writes to the image have been finished
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        destStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-        // Image will be used as a transfer source
-        // Make sure any reads from and writes to the image have been finished
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        destStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-        // Image will be used as a color attachment
-        // Make sure any writes to the color buffer have been finished
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        destStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-        // Image layout will be used as a depth/stencil attachment
-        // Make sure any writes to depth/stencil buffer have been finished
-        imageMemoryBarrier.dstAccessMask = imageMemoryBarrier.dstAccessMask | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        destStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-        // Image will be read in a shader (sampler, input attachment)
-        // Make sure any writes to the image have been finished
-        if(imageMemoryBarrier.srcAccessMask == 0) {
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
-            srcStages = VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    if(uniform) {
+        for(uint32_t layer = baseLayer; layer < endLayer; ++layer) {
+            for(uint32_t level = baseLevel; level < endLevel; ++level) {
+                mSubresourceStates[layer * mMipLevels + level] = newState;
+            }
         }
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        destStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        break;
+    }
 
-    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        break;
+    return changed;
+}
 
-    case VK_IMAGE_LAYOUT_GENERAL:
-        // Image layout supports all operations
-        imageMemoryBarrier.dstAccessMask = 0;
-        break;
+bool
+Image::ModifyImageLayoutOnHost(VkImageLayout newImageLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
 
-    default:
-        NOT_REACHED();
-        break;
+#ifdef VK_EXT_host_image_copy
+    // meant for images just created, whose every subresource is still in the layout they were created in
+    if(!mHostTransfer) {
+        return false;
+    }
+
+    VkHostImageLayoutTransitionInfoEXT info;
+    memset(static_cast<void *>(&info), 0, sizeof(info));
+    info.sType                           = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+    info.image                           = mVkImage;
+    info.oldLayout                       = mVkImageLayout;
+    info.newLayout                       = newImageLayout;
+    info.subresourceRange.aspectMask     = mVkImageSubresourceRange.aspectMask;
+    info.subresourceRange.baseMipLevel   = 0;
+    info.subresourceRange.levelCount     = mMipLevels;
+    info.subresourceRange.baseArrayLayer = 0;
+    info.subresourceRange.layerCount     = mLayers;
+
+    if(mVkContext->fpTransitionImageLayoutEXT(mVkContext->vkDevice, 1, &info) != VK_SUCCESS) {
+        return false;
     }
 
-    vkCmdPipelineBarrier(*activeCmdBuffer, srcStages, destStages, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+    SetImageLayout(newImageLayout);
 
-    mVkImageLayout = newImageLayout;
+    return true;
+#else
+    return false;
+#endif // VK_EXT_host_image_copy
 }
 
 VkFormat
@@ -370,8 +722,7 @@ Image::FindSupportedVkColorFormat(VkFormat format)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     //Check if the selected vkformat supports VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT
-    VkFormatProperties formatDeviceProps;
-    vkGetPhysicalDeviceFormatProperties(mVkContext->vkGpus[0], format, &formatDeviceProps);
+    const VkFormatProperties formatDeviceProps = mVkContext->capabilityCache->GetFormatProperties(format);
 
     switch(mVkImageTiling) {
     case VK_IMAGE_TILING_OPTIMAL:
@@ -390,7 +741,13 @@ Image::FindSupportedVkColorFormat(VkFormat format)
         NOT_REACHED();
         break;
     }
-    return VK_FORMAT_R8G8B8A8_UNORM;
+
+    // three channel float images are rarely renderable, the fourth channel costs less than a conversion
+    switch(format) {
+    case VK_FORMAT_R16G16B16_SFLOAT:    return FindSupportedVkColorFormat(VK_FORMAT_R16G16B16A16_SFLOAT);
+    case VK_FORMAT_R32G32B32_SFLOAT:    return FindSupportedVkColorFormat(VK_FORMAT_R32G32B32A32_SFLOAT);
+    default:                            return VK_FORMAT_R8G8B8A8_UNORM;
+    }
 }
 
 } 
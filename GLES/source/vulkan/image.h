@@ -32,6 +32,31 @@
 
 namespace vulkanAPI {
 
+/// Collects image memory barriers so that they are recorded with a single call
+class ImageBarrierBatch {
+private:
+
+    std::vector<VkImageMemoryBarrier> mVkImageMemoryBarriers;
+    VkPipelineStageFlags              mVkSrcStages;
+    VkPipelineStageFlags              mVkDstStages;
+
+public:
+// Constructor
+    ImageBarrierBatch();
+
+// Destructor
+    ~ImageBarrierBatch();
+
+// Add Functions
+    void                              Add(const VkImageMemoryBarrier *imageMemoryBarrier, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages);
+
+// Record Functions
+    void                              Record(VkCommandBuffer *activeCmdBuffer);
+
+// Get Functions
+    inline bool                       IsEmpty(void)                       const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageMemoryBarriers.empty(); }
+};
+
 class Image {
 public:
 
@@ -66,6 +91,25 @@ private:
 
     bool                              mCopyStencil;
 
+    /// pixels are copied into the image, and its layout changed, by the host (VK_EXT_host_image_copy),
+    /// as asked for and as the format allows it once created
+    bool                              mHostTransferRequested;
+    bool                              mHostTransfer;
+
+    /// memory of the image may be exported as a dma-buf
+    bool                              mExportable;
+
+    /// Layout and last use of a single mip level of a single layer
+    typedef struct SubresourceState_t {
+        VkImageLayout                 layout;
+        VkAccessFlags                 accessMask;
+        VkPipelineStageFlags          stageMask;
+    } SubresourceState_t;
+
+    std::vector<SubresourceState_t>   mSubresourceStates;
+
+    void                              ResetSubresourceStates(void);
+
 public:
 // Constructor
     Image(const vkContext_t *vkContext = nullptr);
@@ -80,16 +124,25 @@ public:
 
 // Create Functions
     bool                              Create(void);
+    /// creates an image over the memory of an EGLImage, which Memory::Import binds afterwards
+    bool                              Import(const EGLImageInterface *eglImage);
     void                              CreateImageSubresourceRange(void);
     void                              CreateBufferImageCopy(int32_t offsetX, int32_t offsetY, uint32_t extentWidth, uint32_t extentHeight, uint32_t miplevel, uint32_t layer, uint32_t layerCount);
 
 // Copy Functions
     void                              CopyBufferToImage(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer);
+    bool                              CopyMemoryToImage(const void *srcData, uint32_t rowLength);
     void                              CopyImageToBuffer(VkCommandBuffer *activeCmdBuffer, VkBuffer srcBuffer);
+    void                              CopyImage(        VkCommandBuffer *activeCmdBuffer, VkImageLayout srcImageLayout,
+                                                        VkImage          dstImage,        VkImageLayout dstImageLayout,
+                                                  const VkImageCopy*     imageCopy);
 
 // Modify Functions
     void                              ModifyImageSubresourceRange(uint32_t baseMipLevel, uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount);
-    void                              ModifyImageLayout(VkCommandBuffer *activeCmdBuffer, VkImageLayout newImageLayout);
+    bool                              ModifyImageLayout(VkCommandBuffer *activeCmdBuffer, VkImageLayout newImageLayout);
+    bool                              ModifyImageLayout(ImageBarrierBatch *barriers, VkImageLayout newImageLayout);
+    bool                              ModifyImageLayoutOnHost(VkImageLayout newImageLayout);
+    void                              DiscardContents(void);
 
 // Release Functions
     void                              Release(void);
@@ -98,26 +151,38 @@ public:
     inline VkImage &                  GetImage(void)                            { FUN_ENTRY(GL_LOG_TRACE); return mVkImage;          }
     inline VkFormat                   GetFormat(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mVkFormat;         }
     inline VkImageTarget              GetImageTarget(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageTarget;    }
-    inline VkImageLayout              GetImageLayout(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageLayout;    }
+    inline VkImageLayout              GetImageLayout(void)                const { FUN_ENTRY(GL_LOG_TRACE); return GetImageLayout(mVkImageSubresourceRange.baseMipLevel,
+                                                                                                                                mVkImageSubresourceRange.baseArrayLayer); }
+           VkImageLayout              GetImageLayout(uint32_t mipLevel, uint32_t layer) const;
+    inline VkImageUsageFlagBits       GetImageUsage(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageUsage;     }
+    inline VkImageTiling              GetImageTiling(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageTiling;    }
     inline VkBufferImageCopy *        GetBufferImageCopy(void)                  { FUN_ENTRY(GL_LOG_TRACE); return &mVkBufferImageCopy;      }
     inline VkImageSubresourceRange    GetImageSubresourceRange(void)      const { FUN_ENTRY(GL_LOG_TRACE); return mVkImageSubresourceRange; }
     inline uint32_t                   GetMipLevels(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mMipLevels;        }
     inline uint32_t                   GetLayers(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mLayers;           }
+    inline VkSampleCountFlagBits      GetSampleCount(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mVkSampleCount;    }
+    inline bool                       IsHostTransfer(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mHostTransfer;     }
+    inline bool                       IsExportable(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mExportable;       }
 
 // Set Functions
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext     = vkContext; }
     inline void                       SetFormat(VkFormat format)                { FUN_ENTRY(GL_LOG_TRACE); mVkFormat      = format;    }
     inline void                       SetCopyStencil(bool copy)                 { FUN_ENTRY(GL_LOG_TRACE); mCopyStencil   = copy;      }
+    inline void                       SetHostTransfer(bool hostTransfer)        { FUN_ENTRY(GL_LOG_TRACE); mHostTransferRequested = hostTransfer; }
+    inline void                       SetExportable(bool exportable)            { FUN_ENTRY(GL_LOG_TRACE); mExportable    = exportable; }
     inline void                       SetImage(VkImage image)                   { FUN_ENTRY(GL_LOG_TRACE); mVkImage       = image;
                                                                                                            mDelete        = false;     }
     inline void                       SetImageUsage(VkImageUsageFlagBits usage) { FUN_ENTRY(GL_LOG_TRACE); mVkImageUsage  = usage;     }
            void                       SetImageTiling();
     inline void                       SetImageTiling(VkImageTiling tiling)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageTiling = tiling;    }
     inline void                       SetImageTarget(VkImageTarget target)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageTarget = target;    }
-    inline void                       SetImageLayout(VkImageLayout layout)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageLayout = layout;    }
+    inline void                       SetImageLayout(VkImageLayout layout)      { FUN_ENTRY(GL_LOG_TRACE); mVkImageLayout = layout;
+                                                                                                           ResetSubresourceStates();    }
     inline void                       SetWidth(uint32_t width)                  { FUN_ENTRY(GL_LOG_TRACE); mWidth         = width;     }
     inline void                       SetHeight(uint32_t height)                { FUN_ENTRY(GL_LOG_TRACE); mHeight        = height;    }
-    inline void                       SetMipLevels(uint32_t levels)             { FUN_ENTRY(GL_LOG_TRACE); mMipLevels     = levels;    }
+    inline void                       SetMipLevels(uint32_t levels)             { FUN_ENTRY(GL_LOG_TRACE); mMipLevels     = levels;
+                                                                                                           ResetSubresourceStates();    }
+    inline void                       SetSampleCount(VkSampleCountFlagBits samples) { FUN_ENTRY(GL_LOG_TRACE); mVkSampleCount = samples; }
 
 // Find Functions
     VkFormat                          FindSupportedVkColorFormat(VkFormat format);
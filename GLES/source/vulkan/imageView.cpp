@@ -31,6 +31,7 @@
  */
 
 #include "imageView.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
@@ -38,6 +39,11 @@ ImageView::ImageView(const vkContext_t *vkContext)
 : mVkContext(vkContext), mVkImageView(VK_NULL_HANDLE)
 {
     FUN_ENTRY(GL_LOG_TRACE);
+
+    mVkComponentMapping.r = VK_COMPONENT_SWIZZLE_R;
+    mVkComponentMapping.g = VK_COMPONENT_SWIZZLE_G;
+    mVkComponentMapping.b = VK_COMPONENT_SWIZZLE_B;
+    mVkComponentMapping.a = VK_COMPONENT_SWIZZLE_A;
 }
 
 ImageView::~ImageView()
@@ -53,7 +59,7 @@ ImageView::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkImageView != VK_NULL_HANDLE) {
-        vkDestroyImageView(mVkContext->vkDevice, mVkImageView, nullptr);
+        vkDestroyImageView(mVkContext->vkDevice, mVkImageView, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
         mVkImageView = VK_NULL_HANDLE;
     }
 }
@@ -70,13 +76,36 @@ ImageView::Create(vulkanAPI::Image *image)
     info.viewType         = (image->GetImageTarget() == Image::VK_IMAGE_TARGET_2D) ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_CUBE;
     info.image            = image->GetImage();
     info.format           = image->GetFormat();
-    info.components.r     = VK_COMPONENT_SWIZZLE_R;
-    info.components.g     = VK_COMPONENT_SWIZZLE_G;
-    info.components.b     = VK_COMPONENT_SWIZZLE_B;
-    info.components.a     = VK_COMPONENT_SWIZZLE_A;
+    info.components       = mVkComponentMapping;
+    info.subresourceRange = image->GetImageSubresourceRange();
+
+    VkResult err = vkCreateImageView(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkImageView);
+    assert(!err);
+
+    return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
+}
+
+bool
+ImageView::Create(vulkanAPI::Image *image, uint32_t baseLayer, uint32_t layerCount)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the base level of consecutive layers, which multiview render passes draw into as one attachment
+    VkImageViewCreateInfo info;
+    info.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    info.pNext            = nullptr;
+    info.flags            = 0;
+    info.viewType         = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    info.image            = image->GetImage();
+    info.format           = image->GetFormat();
+    info.components       = mVkComponentMapping;
     info.subresourceRange = image->GetImageSubresourceRange();
+    info.subresourceRange.baseMipLevel   = 0;
+    info.subresourceRange.levelCount     = 1;
+    info.subresourceRange.baseArrayLayer = baseLayer;
+    info.subresourceRange.layerCount     = layerCount;
 
-    VkResult err = vkCreateImageView(mVkContext->vkDevice, &info, nullptr, &mVkImageView);
+    VkResult err = vkCreateImageView(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkImageView);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -37,6 +37,9 @@ private:
 
     VkImageView                       mVkImageView;
 
+    /// formats with fewer channels than they are sampled with get theirs through a swizzle
+    VkComponentMapping                mVkComponentMapping;
+
 public:
 // Constructor
     ImageView(const vkContext_t *vkContext = nullptr);
@@ -46,6 +49,7 @@ public:
 
 // Create Functions
     bool                              Create(vulkanAPI::Image *image);
+    bool                              Create(vulkanAPI::Image *image, uint32_t baseLayer, uint32_t layerCount);
 
 // Release Functions
     void                              Release(void);
@@ -55,6 +59,7 @@ public:
 
 // Set Functions
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; }
+    inline void                       SetComponentMapping(const VkComponentMapping &mapping) { FUN_ENTRY(GL_LOG_TRACE); mVkComponentMapping = mapping; }
 };
 
 }
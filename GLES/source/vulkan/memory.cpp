@@ -29,13 +29,49 @@
  */
 
 #include "memory.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+#ifndef WIN32
+#include <unistd.h>
+#endif // WIN32
 
 namespace vulkanAPI {
 
+/// Properties a memory type should only have when they are asked for, as they come in smaller or slower heaps
+#define GLOVE_MEMORY_COSTLY_PROPERTIES                  (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT | \
+                                                         VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+
+static int32_t
+CountBits(VkFlags flags)
+{
+    int32_t count = 0;
+    for(; flags; flags &= flags - 1) {
+        ++count;
+    }
+    return count;
+}
+
+static void
+CloseImportedFd(int fd)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+#ifndef WIN32
+    if(fd >= 0) {
+        close(fd);
+    }
+#else
+    (void)fd;
+#endif // WIN32
+}
+
 Memory::Memory(const vkContext_t *vkContext, VkFlags flags)
-: mVkContext(vkContext), mVkMemory (VK_NULL_HANDLE), mVkMemoryFlags(0), mVkFlags(flags)
+: mVkContext(vkContext), mVkMemory (VK_NULL_HANDLE), mVkOffset(0), mOptimalResource(false), mVkMemoryFlags(0), mVkFlags(flags),
+  mVkPreferredFlags(0), mVkTypeFlags(0), mVkDedicatedSize(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
+
+    memset(static_cast<void *>(&mAllocation), 0, sizeof(mAllocation));
 }
 
 Memory::~Memory()
@@ -50,9 +86,21 @@ Memory::Release(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(mVkContext->vkDevice, mVkMemory, nullptr);
+    if(mAllocation.block) {
+        // the blocks are already gone if the context was terminated first
+        if(mVkContext->memoryAllocator) {
+            mVkContext->memoryAllocator->Free(&mAllocation);
+        }
+        memset(static_cast<void *>(&mAllocation), 0, sizeof(mAllocation));
         mVkMemory = VK_NULL_HANDLE;
+        mVkOffset = 0;
+    } else if(mVkMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(mVkContext->vkDevice, mVkMemory, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
+        mVkMemory = VK_NULL_HANDLE;
+        if(mVkDedicatedSize && mVkContext->perfCounters) {
+            mVkContext->perfCounters->SubDeviceMemory(mVkTypeFlags, mVkDedicatedSize);
+        }
+        mVkDedicatedSize = 0;
     }
 }
 
@@ -61,8 +109,16 @@ Memory::GetData(VkDeviceSize size, VkDeviceSize offset, void *data) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mAllocation.mapped) {
+        if(!mVkContext->memoryAllocator->Invalidate(&mAllocation, offset, size)) {
+            return false;
+        }
+        memcpy(data, mAllocation.mapped + offset, size);
+        return true;
+    }
+
     void *pData;
-    VkResult err = vkMapMemory(mVkContext->vkDevice, mVkMemory, offset, size, mVkMemoryFlags, &pData);
+    VkResult err = vkMapMemory(mVkContext->vkDevice, mVkMemory, mVkOffset + offset, size, mVkMemoryFlags, &pData);
     assert(!err);
 
     if(err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY && err != VK_ERROR_MEMORY_MAP_FAILED)
@@ -88,9 +144,18 @@ Memory::SetData(VkDeviceSize size, VkDeviceSize offset, const void *data)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mAllocation.mapped) {
+        if(data) {
+            memcpy(mAllocation.mapped + offset, data, size);
+        } else {
+            memset(mAllocation.mapped + offset, 0x0, size);
+        }
+        return mVkContext->memoryAllocator->Flush(&mAllocation, offset, size);
+    }
+
     void *pData = nullptr;
 
-    VkResult err = vkMapMemory(mVkContext->vkDevice, mVkMemory, offset, size ? size : mVkRequirements.size, mVkMemoryFlags, &pData);
+    VkResult err = vkMapMemory(mVkContext->vkDevice, mVkMemory, mVkOffset + offset, size ? size : mVkRequirements.size, mVkMemoryFlags, &pData);
     assert(!err);
 
     if(data) {
@@ -111,6 +176,7 @@ Memory::GetBufferMemoryRequirements(VkBuffer &buffer)
 
     memset(static_cast<void *>(&mVkRequirements), 0, sizeof(mVkRequirements));
     vkGetBufferMemoryRequirements(mVkContext->vkDevice, buffer, &mVkRequirements);
+    mOptimalResource = false;
 
     return mVkRequirements.size > 0 ? true : false;
 }
@@ -122,6 +188,7 @@ Memory::GetImageMemoryRequirements(VkImage &image)
 
     memset(static_cast<void *>(&mVkRequirements), 0, sizeof(mVkRequirements));
     vkGetImageMemoryRequirements(mVkContext->vkDevice, image, &mVkRequirements);
+    mOptimalResource = true;
 }
 
 VkResult
@@ -129,32 +196,38 @@ Memory::GetMemoryTypeIndexFromProperties(uint32_t *typeIndex)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    uint32_t typeBitsShift = mVkRequirements.memoryTypeBits;
+    // Among the types with the required properties, the one with most of the preferred ones and fewest
+    // of the costly ones asked for by neither is taken, the larger heap breaking ties. When no type
+    // has the required properties, any type the resource can live in is ranked the same way
+    const VkPhysicalDeviceMemoryProperties &properties = mVkContext->vkDeviceMemoryProperties;
+    const VkFlags requiredFlags[] = {mVkFlags, 0};
+
+    for(VkFlags required : requiredFlags) {
+        int32_t      bestType     = -1;
+        int32_t      bestScore    = 0;
+        VkDeviceSize bestHeapSize = 0;
+
+        for(uint32_t i = 0; i < properties.memoryTypeCount; ++i) {
+            const VkFlags flags = properties.memoryTypes[i].propertyFlags;
+            if(!(mVkRequirements.memoryTypeBits & (1u << i)) || (flags & required) != required) {
+                continue;
+            }
 
-    // Search memtypes to find first index with those properties
-    for(uint32_t i = 0; i < mVkContext->vkDeviceMemoryProperties.memoryTypeCount; i++) {
-        if((typeBitsShift & 1) == 1) {
-            // Type is available, does it match user properties?
-            if ((mVkContext->vkDeviceMemoryProperties.memoryTypes[i].propertyFlags & mVkFlags) == mVkFlags) {
-                *typeIndex = i;
-                return VK_SUCCESS;
+            const int32_t score = 2 * CountBits(flags & mVkPreferredFlags) -
+                                  CountBits(flags & GLOVE_MEMORY_COSTLY_PROPERTIES & ~(mVkFlags | mVkPreferredFlags));
+            const VkDeviceSize heapSize = properties.memoryHeaps[properties.memoryTypes[i].heapIndex].size;
+            if(bestType < 0 || score > bestScore || (score == bestScore && heapSize > bestHeapSize)) {
+                bestType     = static_cast<int32_t>(i);
+                bestScore    = score;
+                bestHeapSize = heapSize;
             }
         }
-        typeBitsShift >>= 1;
-    }
-
-    typeBitsShift = mVkRequirements.memoryTypeBits;
 
-    // Retry with properties = 0x0
-    for(uint32_t i = 0; i < mVkContext->vkDeviceMemoryProperties.memoryTypeCount; i++) {
-        if((typeBitsShift & 1) == 1) {
-            // Type is available, does it match user properties?
-            if ((mVkContext->vkDeviceMemoryProperties.memoryTypes[i].propertyFlags & 0) == 0) {
-                *typeIndex = i;
-                return VK_SUCCESS;
-            }
+        if(bestType >= 0) {
+            *typeIndex   = static_cast<uint32_t>(bestType);
+            mVkTypeFlags = properties.memoryTypes[bestType].propertyFlags;
+            return VK_SUCCESS;
         }
-        typeBitsShift >>= 1;
     }
 
      // No memory types matched, return failure
@@ -166,7 +239,7 @@ Memory::BindBufferMemory(VkBuffer &buffer)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err = vkBindBufferMemory(mVkContext->vkDevice, buffer, mVkMemory, 0);
+    VkResult err = vkBindBufferMemory(mVkContext->vkDevice, buffer, mVkMemory, mVkOffset);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -177,7 +250,7 @@ Memory::BindImageMemory(VkImage &image)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    VkResult err = vkBindImageMemory(mVkContext->vkDevice, image, mVkMemory, 0);
+    VkResult err = vkBindImageMemory(mVkContext->vkDevice, image, mVkMemory, mVkOffset);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -197,10 +270,217 @@ Memory::Create()
     VkResult err;
     err = GetMemoryTypeIndexFromProperties(&allocInfo.memoryTypeIndex);
     assert(!err);
-    err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, nullptr, &mVkMemory);
+
+    if(mVkContext->memoryAllocator) {
+        if(!mVkContext->memoryAllocator->Allocate(allocInfo.memoryTypeIndex, &mVkRequirements, mOptimalResource, &mAllocation)) {
+            // the heap of the preferred type may be a small one, e.g., the host visible window into device memory
+            if(mVkPreferredFlags) {
+                mVkPreferredFlags = 0;
+                return Create();
+            }
+            return false;
+        }
+        mVkMemory = mAllocation.memory;
+        mVkOffset = mAllocation.offset;
+        return true;
+    }
+
+    err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkMemory);
+    // running out of memory is left to the caller, which may evict objects and retry
+    if(err == VK_ERROR_OUT_OF_HOST_MEMORY || err == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+        mVkMemory = VK_NULL_HANDLE;
+        return false;
+    }
     assert(!err);
+    mVkContext->perfCounters->Add(PERF_COUNTER_MEMORY_ALLOCATIONS);
+    mVkContext->perfCounters->AddDeviceMemory(mVkTypeFlags, allocInfo.allocationSize);
+    mVkDedicatedSize = allocInfo.allocationSize;
 
-    return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    return true;
+}
+
+bool
+Memory::Import(VkImage &image, const EGLImageInterface *eglImage)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Release();
+    GetImageMemoryRequirements(image);
+
+    // imported memory is dedicated to the image, it never comes from the allocator blocks
+    VkMemoryDedicatedAllocateInfoKHR dedicatedInfo;
+    memset(static_cast<void *>(&dedicatedInfo), 0, sizeof(dedicatedInfo));
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR;
+    dedicatedInfo.image = image;
+
+    VkMemoryAllocateInfo allocInfo;
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext           = nullptr;
+    allocInfo.memoryTypeIndex = 0;
+    allocInfo.allocationSize  = mVkRequirements.size;
+
+    VkDeviceSize bindOffset = 0;
+    int fd = -1;
+
+#if defined(VK_KHR_external_memory_fd) && !defined(WIN32)
+    VkImportMemoryFdInfoKHR fdInfo;
+    memset(static_cast<void *>(&fdInfo), 0, sizeof(fdInfo));
+#endif // VK_KHR_external_memory_fd && !WIN32
+#ifdef VK_ANDROID_external_memory_android_hardware_buffer
+    VkImportAndroidHardwareBufferInfoANDROID hardwareBufferInfo;
+    memset(static_cast<void *>(&hardwareBufferInfo), 0, sizeof(hardwareBufferInfo));
+#endif // VK_ANDROID_external_memory_android_hardware_buffer
+
+    if(eglImage->source == EGL_IMAGE_SOURCE_DMA_BUF) {
+#if defined(VK_KHR_external_memory_fd) && !defined(WIN32)
+        VkMemoryFdPropertiesKHR fdProperties;
+        memset(static_cast<void *>(&fdProperties), 0, sizeof(fdProperties));
+        fdProperties.sType = VK_STRUCTURE_TYPE_MEMORY_FD_PROPERTIES_KHR;
+        if(mVkContext->fpGetMemoryFdPropertiesKHR(mVkContext->vkDevice, VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT,
+                                                  eglImage->fds[0], &fdProperties) != VK_SUCCESS) {
+            return false;
+        }
+        mVkRequirements.memoryTypeBits &= fdProperties.memoryTypeBits;
+
+        // a linear image starts at the offset of its plane, explicit modifiers carry the offsets themselves
+        if(!mVkContext->mIsDrmFormatModifierSupported || !eglImage->hasModifier) {
+            bindOffset = eglImage->offsets[0];
+            if(mVkRequirements.alignment && bindOffset % mVkRequirements.alignment) {
+                return false;
+            }
+            allocInfo.allocationSize += bindOffset;
+        }
+
+        // a successful import takes over the descriptor, the EGLImage keeps its own
+        fd = dup(eglImage->fds[0]);
+        if(fd < 0) {
+            return false;
+        }
+
+        fdInfo.sType      = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR;
+        fdInfo.pNext      = &dedicatedInfo;
+        fdInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+        fdInfo.fd         = fd;
+        allocInfo.pNext   = &fdInfo;
+#else
+        return false;
+#endif // VK_KHR_external_memory_fd && !WIN32
+    } else {
+#ifdef VK_ANDROID_external_memory_android_hardware_buffer
+        VkAndroidHardwareBufferPropertiesANDROID hardwareBufferProperties;
+        memset(static_cast<void *>(&hardwareBufferProperties), 0, sizeof(hardwareBufferProperties));
+        hardwareBufferProperties.sType = VK_STRUCTURE_TYPE_ANDROID_HARDWARE_BUFFER_PROPERTIES_ANDROID;
+        AHardwareBuffer *hardwareBuffer = static_cast<AHardwareBuffer *>(eglImage->hardwareBuffer);
+        if(mVkContext->fpGetAndroidHardwareBufferPropertiesANDROID(mVkContext->vkDevice, hardwareBuffer, &hardwareBufferProperties) != VK_SUCCESS) {
+            return false;
+        }
+        mVkRequirements.memoryTypeBits &= hardwareBufferProperties.memoryTypeBits;
+
+        hardwareBufferInfo.sType  = VK_STRUCTURE_TYPE_IMPORT_ANDROID_HARDWARE_BUFFER_INFO_ANDROID;
+        hardwareBufferInfo.pNext  = &dedicatedInfo;
+        hardwareBufferInfo.buffer = hardwareBuffer;
+        allocInfo.allocationSize  = hardwareBufferProperties.allocationSize;
+        allocInfo.pNext           = &hardwareBufferInfo;
+#else
+        return false;
+#endif // VK_ANDROID_external_memory_android_hardware_buffer
+    }
+
+    if(!mVkRequirements.memoryTypeBits || GetMemoryTypeIndexFromProperties(&allocInfo.memoryTypeIndex) != VK_SUCCESS) {
+        CloseImportedFd(fd);
+        return false;
+    }
+
+    VkResult err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkMemory);
+    if(err != VK_SUCCESS) {
+        CloseImportedFd(fd);
+        mVkMemory = VK_NULL_HANDLE;
+        return false;
+    }
+    // the memory is the exporter's, whose process accounts it
+    mVkContext->perfCounters->Add(PERF_COUNTER_MEMORY_ALLOCATIONS);
+
+    mVkOffset = bindOffset;
+    return BindImageMemory(image);
+}
+
+bool
+Memory::Export(VkImage &image)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Release();
+    GetImageMemoryRequirements(image);
+
+#if defined(VK_KHR_external_memory_fd) && !defined(WIN32)
+    if(!mVkContext->mIsExternalMemoryDmaBufSupported) {
+        return false;
+    }
+
+    // exported memory is dedicated to the image as well, the importer gets all of it
+    VkMemoryDedicatedAllocateInfoKHR dedicatedInfo;
+    memset(static_cast<void *>(&dedicatedInfo), 0, sizeof(dedicatedInfo));
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR;
+    dedicatedInfo.image = image;
+
+    VkExportMemoryAllocateInfoKHR exportInfo;
+    memset(static_cast<void *>(&exportInfo), 0, sizeof(exportInfo));
+    exportInfo.sType       = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO_KHR;
+    exportInfo.pNext       = &dedicatedInfo;
+    exportInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
+    VkMemoryAllocateInfo allocInfo;
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext           = &exportInfo;
+    allocInfo.memoryTypeIndex = 0;
+    allocInfo.allocationSize  = mVkRequirements.size;
+
+    if(GetMemoryTypeIndexFromProperties(&allocInfo.memoryTypeIndex) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkResult err = vkAllocateMemory(mVkContext->vkDevice, &allocInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkMemory);
+    if(err != VK_SUCCESS) {
+        mVkMemory = VK_NULL_HANDLE;
+        return false;
+    }
+    mVkContext->perfCounters->Add(PERF_COUNTER_MEMORY_ALLOCATIONS);
+    mVkContext->perfCounters->AddDeviceMemory(mVkTypeFlags, allocInfo.allocationSize);
+    mVkDedicatedSize = allocInfo.allocationSize;
+
+    mVkOffset = 0;
+    return BindImageMemory(image);
+#else
+    return false;
+#endif // VK_KHR_external_memory_fd && !WIN32
+}
+
+int
+Memory::ExportFd(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#if defined(VK_KHR_external_memory_fd) && !defined(WIN32)
+    if(mVkMemory == VK_NULL_HANDLE || mAllocation.block) {
+        return -1;
+    }
+
+    // every call returns a new descriptor, owned by the caller
+    VkMemoryGetFdInfoKHR info;
+    info.sType      = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+    info.pNext      = nullptr;
+    info.memory     = mVkMemory;
+    info.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
+    int fd = -1;
+    if(mVkContext->fpGetMemoryFdKHR(mVkContext->vkDevice, &info, &fd) != VK_SUCCESS) {
+        return -1;
+    }
+
+    return fd;
+#else
+    return -1;
+#endif // VK_KHR_external_memory_fd && !WIN32
 }
 
 }
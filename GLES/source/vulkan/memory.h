@@ -27,6 +27,7 @@
 #include <cmath>
 #include "utils.h"
 #include "context.h"
+#include "memoryAllocator.h"
 
 namespace vulkanAPI {
 
@@ -38,10 +39,19 @@ private:
     vkContext_t *                     mVkContext;
 
     VkDeviceMemory                    mVkMemory;
+    VkDeviceSize                      mVkOffset;
+    MemoryAllocator::Allocation_t     mAllocation;
+    bool                              mOptimalResource;
     const
     VkMemoryMapFlags                  mVkMemoryFlags;
     VkFlags                           mVkFlags;
+    /// properties the memory type is ranked by, dropped when no memory of such a type is left
+    VkFlags                           mVkPreferredFlags;
+    /// properties of the memory type the memory was allocated from
+    VkFlags                           mVkTypeFlags;
     VkMemoryRequirements              mVkRequirements;
+    /// size of the memory allocated for the object alone, accounted into the perf counters
+    VkDeviceSize                      mVkDedicatedSize;
 
 public:
 // Constructor
@@ -52,6 +62,12 @@ public:
 
 // Allocate Functions
     bool                              Create(void);
+    /// allocates the image over the memory of an EGLImage and binds it, sharing the memory with its exporter
+    bool                              Import(VkImage &image, const EGLImageInterface *eglImage);
+    /// allocates memory of the image that can be exported as a dma-buf, and binds it
+    bool                              Export(VkImage &image);
+    /// a new dma-buf descriptor of the exported memory, -1 on failure
+    int                               ExportFd(void) const;
 
 // Release Functions
     void                              Release(void);
@@ -62,6 +78,9 @@ public:
 
 // Get Functions
     void                              GetImageMemoryRequirements(VkImage &image);
+    /// requirements of memory that several images are bound to, one at a time
+    inline void                       SetImageMemoryRequirements(const VkMemoryRequirements *requirements) { FUN_ENTRY(GL_LOG_TRACE); mVkRequirements  = *requirements;
+                                                                                                                                       mOptimalResource = true; }
     bool                              GetBufferMemoryRequirements(VkBuffer &buffer);
     bool                              GetData(VkDeviceSize size, VkDeviceSize offset, void *data) const;
     VkResult                          GetMemoryTypeIndexFromProperties(uint32_t *typeIndex);
@@ -71,6 +90,11 @@ public:
     void                              UpdateData(VkDeviceSize size, VkDeviceSize offset, const void *data);
 
     inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; }
+    inline void                       SetFlags(VkFlags flags)                   { FUN_ENTRY(GL_LOG_TRACE); mVkFlags   = flags;     }
+    inline void                       SetPreferredFlags(VkFlags flags)          { FUN_ENTRY(GL_LOG_TRACE); mVkPreferredFlags = flags; }
+
+// Is Functions
+    inline bool                       IsHostVisible(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return (mVkTypeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0; }
 };
 
 }
@@ -0,0 +1,481 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       memoryAllocator.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Device Memory Sub-Allocation Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  The number of device memory allocations that may simultaneously exist is
+ *  limited by maxMemoryAllocationCount and each vkAllocateMemory call is
+ *  expensive. Buffers and images are therefore placed in large blocks of
+ *  device memory, one set of blocks per memory type. Inside a block, free
+ *  space is kept in an address ordered list whose neighbouring ranges are
+ *  merged on release, and requests are rounded up to size classes so that
+ *  released ranges are easily reused. Requests larger than half a block get
+ *  an allocation of their own.
+ *
+ *  Blocks of host visible memory types are mapped once when they are created
+ *  and stay mapped until they are freed. Writes to and reads from non-coherent
+ *  types are made visible by flushing or invalidating only the accessed range,
+ *  expanded to nonCoherentAtomSize.
+ *
+ *  The memory the blocks hold is accounted per heap and compared against the
+ *  budget VK_EXT_memory_budget reports, or a share of the heap size without
+ *  it, so that cached objects can be released before allocations start to
+ *  fail. An allocation that fails anyway is retried once the empty blocks of
+ *  all pools have been freed.
+ *
+ */
+
+#include <cstring>
+#include <iterator>
+#include "memoryAllocator.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+MemoryAllocator::MemoryAllocator(const vkContext_t *vkContext)
+: mVkContext(vkContext), mAllocationCount(0), mNonCoherentAtomSize(1)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(mVkContext->vkPhysicalDevice, &properties);
+    if(properties.limits.nonCoherentAtomSize) {
+        mNonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+    }
+
+    const uint32_t heapCount = mVkContext->vkDeviceMemoryProperties.memoryHeapCount;
+    for(uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+        mHeapUsage[i]         = 0;
+        mHeapExternalUsage[i] = 0;
+        mHeapBudget[i]        = i < heapCount ? mVkContext->vkDeviceMemoryProperties.memoryHeaps[i].size / 100 * GLOVE_MEMORY_DEFAULT_BUDGET_PERCENT : 0;
+    }
+
+    const uint32_t typeCount = mVkContext->vkDeviceMemoryProperties.memoryTypeCount;
+
+    mPools.resize(2 * typeCount);
+    for(uint32_t i = 0; i < typeCount; ++i) {
+        const VkMemoryType &type     = mVkContext->vkDeviceMemoryProperties.memoryTypes[i];
+        const VkDeviceSize  heapSize = mVkContext->vkDeviceMemoryProperties.memoryHeaps[type.heapIndex].size;
+
+        /// small heaps should not be consumed by a few partially used blocks
+        VkDeviceSize blockSize = GLOVE_MEMORY_BLOCK_SIZE;
+        while(blockSize > GLOVE_MEMORY_MAX_POW2_SIZE_CLASS && blockSize > heapSize / 8) {
+            blockSize >>= 1;
+        }
+
+        for(uint32_t optimal = 0; optimal < 2; ++optimal) {
+            Pool_t &pool         = mPools[2 * i + optimal];
+            pool.memoryTypeIndex = i;
+            pool.blockSize       = blockSize;
+        }
+    }
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto &pool : mPools) {
+        for(auto block : pool.blocks) {
+            DestroyBlock(block);
+        }
+        pool.blocks.clear();
+    }
+}
+
+VkDeviceSize
+MemoryAllocator::GetSizeClass(VkDeviceSize size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(size <= GLOVE_MEMORY_MIN_SIZE_CLASS) {
+        return GLOVE_MEMORY_MIN_SIZE_CLASS;
+    }
+
+    if(size <= GLOVE_MEMORY_MAX_POW2_SIZE_CLASS) {
+        VkDeviceSize sizeClass = GLOVE_MEMORY_MIN_SIZE_CLASS;
+        while(sizeClass < size) {
+            sizeClass <<= 1;
+        }
+        return sizeClass;
+    }
+
+    return (size + GLOVE_MEMORY_MAX_POW2_SIZE_CLASS - 1) & ~static_cast<VkDeviceSize>(GLOVE_MEMORY_MAX_POW2_SIZE_CLASS - 1);
+}
+
+MemoryAllocator::Block_t *
+MemoryAllocator::CreateBlock(uint32_t pool, VkDeviceSize size, bool dedicated)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkMemoryAllocateInfo allocInfo;
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext           = nullptr;
+    allocInfo.memoryTypeIndex = mPools[pool].memoryTypeIndex;
+    allocInfo.allocationSize  = size;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if(vkAllocateMemory(mVkContext->vkDevice, &allocInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &memory) != VK_SUCCESS) {
+        /// the empty blocks of the other pools may be holding the memory of the heap
+        ReleaseAllEmptyBlocks();
+        if(vkAllocateMemory(mVkContext->vkDevice, &allocInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &memory) != VK_SUCCESS) {
+            return nullptr;
+        }
+    }
+    mVkContext->perfCounters->Add(PERF_COUNTER_MEMORY_ALLOCATIONS);
+    mVkContext->perfCounters->Add(PERF_COUNTER_MEMORY_BYTES_ALLOCATED, size);
+    mHeapUsage[GetHeapIndex(pool)] += size;
+
+    const VkMemoryPropertyFlags flags = mVkContext->vkDeviceMemoryProperties.memoryTypes[allocInfo.memoryTypeIndex].propertyFlags;
+    mVkContext->perfCounters->AddDeviceMemory(flags, size);
+
+    Block_t *block   = new Block_t();
+    block->memory    = memory;
+    block->size      = size;
+    block->freeSize  = size;
+    block->pool      = pool;
+    block->dedicated = dedicated;
+    block->coherent  = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    block->mapped    = nullptr;
+    block->freeRanges[0] = size;
+
+    if(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void *mapped = nullptr;
+        if(vkMapMemory(mVkContext->vkDevice, memory, 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS) {
+            block->mapped = static_cast<uint8_t *>(mapped);
+        }
+    }
+
+    mPools[pool].blocks.push_back(block);
+    ++mAllocationCount;
+
+    return block;
+}
+
+void
+MemoryAllocator::DestroyBlock(Block_t *block)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    /// freeing the memory implicitly unmaps it
+    vkFreeMemory(mVkContext->vkDevice, block->memory, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
+    --mAllocationCount;
+
+    mHeapUsage[GetHeapIndex(block->pool)] -= block->size;
+    /// the counters are gone by the time the allocator is destroyed
+    if(mVkContext->perfCounters) {
+        mVkContext->perfCounters->Add(PERF_COUNTER_MEMORY_BYTES_FREED, block->size);
+        mVkContext->perfCounters->SubDeviceMemory(mVkContext->vkDeviceMemoryProperties.memoryTypes[mPools[block->pool].memoryTypeIndex].propertyFlags,
+                                                  block->size);
+    }
+
+    delete block;
+}
+
+bool
+MemoryAllocator::AllocateFromBlock(Block_t *block, VkDeviceSize size, VkDeviceSize alignment, Allocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(block->freeSize < size) {
+        return false;
+    }
+
+    /// first fit in address order keeps the used ranges packed at the start of each block
+    for(auto it = block->freeRanges.begin(); it != block->freeRanges.end(); ++it) {
+        const VkDeviceSize rangeOffset = it->first;
+        const VkDeviceSize rangeSize   = it->second;
+        const VkDeviceSize offset      = (rangeOffset + alignment - 1) / alignment * alignment;
+        const VkDeviceSize padding     = offset - rangeOffset;
+
+        if(padding + size > rangeSize) {
+            continue;
+        }
+
+        block->freeRanges.erase(it);
+        if(padding) {
+            block->freeRanges[rangeOffset] = padding;
+        }
+        if(rangeSize > padding + size) {
+            block->freeRanges[offset + size] = rangeSize - padding - size;
+        }
+        block->freeSize -= size;
+
+        allocation->memory = block->memory;
+        allocation->offset = offset;
+        allocation->size   = size;
+        allocation->mapped = block->mapped ? block->mapped + offset : nullptr;
+        allocation->block  = block;
+
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t
+MemoryAllocator::GetHeapIndex(uint32_t pool) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    return mVkContext->vkDeviceMemoryProperties.memoryTypes[mPools[pool].memoryTypeIndex].heapIndex;
+}
+
+void
+MemoryAllocator::ReleaseEmptyBlocks(Pool_t *pool, uint32_t keptBlocks)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint32_t emptyBlocks = 0;
+    for(auto it = pool->blocks.begin(); it != pool->blocks.end();) {
+        Block_t *block = *it;
+        if(block->freeSize == block->size && ++emptyBlocks > keptBlocks) {
+            DestroyBlock(block);
+            it = pool->blocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+MemoryAllocator::ReleaseAllEmptyBlocks(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(auto &pool : mPools) {
+        ReleaseEmptyBlocks(&pool, 0);
+    }
+}
+
+bool
+MemoryAllocator::Allocate(uint32_t memoryTypeIndex, const VkMemoryRequirements *requirements,
+                          bool optimalResource, Allocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const uint32_t     poolIndex = 2 * memoryTypeIndex + (optimalResource ? 1 : 0);
+    Pool_t            &pool      = mPools[poolIndex];
+    const VkDeviceSize alignment = requirements->alignment ? requirements->alignment : 1;
+    const VkDeviceSize size      = GetSizeClass(requirements->size);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if(size <= pool.blockSize / 2) {
+        for(auto block : pool.blocks) {
+            if(!block->dedicated && AllocateFromBlock(block, size, alignment, allocation)) {
+                return true;
+            }
+        }
+
+        Block_t *block = CreateBlock(poolIndex, pool.blockSize, false);
+        if(block && AllocateFromBlock(block, size, alignment, allocation)) {
+            return true;
+        }
+    }
+
+    /// large requests, or a heap too full for a new block, get an allocation of their own
+    Block_t *block = CreateBlock(poolIndex, requirements->size, true);
+    if(!block) {
+        return false;
+    }
+
+    block->freeRanges.clear();
+    block->freeSize    = 0;
+
+    allocation->memory = block->memory;
+    allocation->offset = 0;
+    allocation->size   = requirements->size;
+    allocation->mapped = block->mapped;
+    allocation->block  = block;
+
+    return true;
+}
+
+void
+MemoryAllocator::Free(Allocation_t *allocation)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Block_t *block = allocation->block;
+    if(!block) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Pool_t &pool = mPools[block->pool];
+
+    if(block->dedicated) {
+        for(auto it = pool.blocks.begin(); it != pool.blocks.end(); ++it) {
+            if(*it == block) {
+                pool.blocks.erase(it);
+                break;
+            }
+        }
+        DestroyBlock(block);
+    } else {
+        VkDeviceSize offset = allocation->offset;
+        VkDeviceSize size   = allocation->size;
+
+        /// merge with the neighbouring free ranges
+        auto next = block->freeRanges.lower_bound(offset);
+        if(next != block->freeRanges.begin()) {
+            auto prev = std::prev(next);
+            if(prev->first + prev->second == offset) {
+                offset  = prev->first;
+                size   += prev->second;
+                block->freeRanges.erase(prev);
+            }
+        }
+        if(next != block->freeRanges.end() && offset + size == next->first) {
+            size += next->second;
+            block->freeRanges.erase(next);
+        }
+        block->freeRanges[offset] = size;
+        block->freeSize          += allocation->size;
+
+        if(block->freeSize == block->size) {
+            ReleaseEmptyBlocks(&pool);
+        }
+    }
+
+    allocation->memory = VK_NULL_HANDLE;
+    allocation->offset = 0;
+    allocation->size   = 0;
+    allocation->mapped = nullptr;
+    allocation->block  = nullptr;
+}
+
+void
+MemoryAllocator::UpdateBudget(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_EXT_memory_budget
+    if(!mVkContext->mIsMemoryBudgetSupported) {
+        return;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget;
+    memset(static_cast<void *>(&budget), 0, sizeof(budget));
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2KHR properties;
+    memset(static_cast<void *>(&properties), 0, sizeof(properties));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    properties.pNext = &budget;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mVkContext->fpGetPhysicalDeviceMemoryProperties2KHR(mVkContext->vkPhysicalDevice, &properties);
+
+    for(uint32_t i = 0; i < properties.memoryProperties.memoryHeapCount && i < VK_MAX_MEMORY_HEAPS; ++i) {
+        if(budget.heapBudget[i]) {
+            mHeapBudget[i] = budget.heapBudget[i];
+        }
+        /// the usage the driver reports is that of the whole process, the blocks included
+        mHeapExternalUsage[i] = budget.heapUsage[i] > mHeapUsage[i] ? budget.heapUsage[i] - mHeapUsage[i] : 0;
+    }
+#endif // VK_EXT_memory_budget
+}
+
+bool
+MemoryAllocator::IsUnderPressure(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    /// heaps the blocks hold nothing of cannot be relieved anyway
+    const uint32_t heapCount = mVkContext->vkDeviceMemoryProperties.memoryHeapCount;
+    for(uint32_t i = 0; i < heapCount; ++i) {
+        if(mHeapUsage[i] && (mHeapUsage[i] + mHeapExternalUsage[i]) / GLOVE_MEMORY_PRESSURE_PERCENT > mHeapBudget[i] / 100) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+MemoryAllocator::Trim(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    ReleaseAllEmptyBlocks();
+}
+
+bool
+MemoryAllocator::GetMappedRange(const Allocation_t *allocation, VkDeviceSize offset, VkDeviceSize size, VkMappedMemoryRange *range) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const Block_t *block = allocation->block;
+    if(!block || !block->mapped || block->coherent || !size) {
+        return false;
+    }
+
+    const VkDeviceSize start = (allocation->offset + offset) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+    VkDeviceSize       end   = (allocation->offset + offset + size + mNonCoherentAtomSize - 1) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+    if(end > block->size) {
+        end = block->size;
+    }
+
+    range->sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range->pNext  = nullptr;
+    range->memory = block->memory;
+    range->offset = start;
+    range->size   = end - start;
+
+    return true;
+}
+
+bool
+MemoryAllocator::Flush(const Allocation_t *allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkMappedMemoryRange range;
+    if(!GetMappedRange(allocation, offset, size, &range)) {
+        return true;
+    }
+
+    return vkFlushMappedMemoryRanges(mVkContext->vkDevice, 1, &range) == VK_SUCCESS;
+}
+
+bool
+MemoryAllocator::Invalidate(const Allocation_t *allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkMappedMemoryRange range;
+    if(!GetMappedRange(allocation, offset, size, &range)) {
+        return true;
+    }
+
+    return vkInvalidateMappedMemoryRanges(mVkContext->vkDevice, 1, &range) == VK_SUCCESS;
+}
+
+}
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       memoryAllocator.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Device Memory Sub-Allocation Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKMEMORYALLOCATOR_H__
+#define __VKMEMORYALLOCATOR_H__
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "context.h"
+
+/// Size of the device memory blocks that objects are sub-allocated from
+#define GLOVE_MEMORY_BLOCK_SIZE                         (16 * 1024 * 1024)
+
+/// Smallest size class of a sub-allocation
+#define GLOVE_MEMORY_MIN_SIZE_CLASS                     256
+
+/// Size classes grow in powers of two up to this size and linearly beyond it
+#define GLOVE_MEMORY_MAX_POW2_SIZE_CLASS                (64 * 1024)
+
+/// Number of empty blocks each pool keeps instead of freeing them
+#define GLOVE_MEMORY_MAX_EMPTY_BLOCKS                   1
+
+/// Percentage of a heap the process may use when the driver does not report a budget
+#define GLOVE_MEMORY_DEFAULT_BUDGET_PERCENT             80
+
+/// Percentage of the budget of a heap beyond which its memory is under pressure
+#define GLOVE_MEMORY_PRESSURE_PERCENT                   90
+
+namespace vulkanAPI {
+
+class MemoryAllocator final {
+public:
+    struct Block_t;
+
+    typedef struct Allocation_t {
+        VkDeviceMemory                      memory;
+        VkDeviceSize                        offset;
+        VkDeviceSize                        size;
+        uint8_t                            *mapped;
+        Block_t                            *block;
+    } Allocation_t;
+
+    typedef struct Block_t {
+        VkDeviceMemory                      memory;
+        VkDeviceSize                        size;
+        VkDeviceSize                        freeSize;
+        uint32_t                            pool;
+        bool                                dedicated;
+        bool                                coherent;
+        uint8_t                            *mapped;                 // whole block, for host visible types
+        std::map<VkDeviceSize, VkDeviceSize> freeRanges;              // offset -> size, address ordered
+    } Block_t;
+
+private:
+    typedef struct Pool_t {
+        uint32_t                            memoryTypeIndex;
+        VkDeviceSize                        blockSize;
+        std::vector<Block_t *>              blocks;
+    } Pool_t;
+
+    const vkContext_t                      *mVkContext;
+
+    /// the allocator is shared by the contexts of all threads
+    std::mutex                              mMutex;
+
+    /// one pool per memory type for linear (buffer) and one for optimal (image) resources,
+    /// so that bufferImageGranularity never has to be considered inside a block
+    std::vector<Pool_t>                     mPools;
+
+    uint32_t                                mAllocationCount;
+    VkDeviceSize                            mNonCoherentAtomSize;
+
+    /// memory the blocks of each heap hold, and how much of the heap the process may use
+    VkDeviceSize                            mHeapUsage[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize                            mHeapBudget[VK_MAX_MEMORY_HEAPS];
+    /// memory of each heap used by the process outside of the blocks, as the driver last reported it
+    VkDeviceSize                            mHeapExternalUsage[VK_MAX_MEMORY_HEAPS];
+
+    static VkDeviceSize                     GetSizeClass(VkDeviceSize size);
+    Block_t                                *CreateBlock(uint32_t pool, VkDeviceSize size, bool dedicated);
+    void                                    DestroyBlock(Block_t *block);
+    bool                                    AllocateFromBlock(Block_t *block, VkDeviceSize size, VkDeviceSize alignment, Allocation_t *allocation);
+    void                                    ReleaseEmptyBlocks(Pool_t *pool, uint32_t keptBlocks = GLOVE_MEMORY_MAX_EMPTY_BLOCKS);
+    void                                    ReleaseAllEmptyBlocks(void);
+    uint32_t                                GetHeapIndex(uint32_t pool) const;
+    bool                                    GetMappedRange(const Allocation_t *allocation, VkDeviceSize offset, VkDeviceSize size, VkMappedMemoryRange *range) const;
+
+public:
+// Constructor
+    MemoryAllocator(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~MemoryAllocator();
+
+// Allocate Functions
+    bool                                    Allocate(uint32_t memoryTypeIndex, const VkMemoryRequirements *requirements,
+                                                     bool optimalResource, Allocation_t *allocation);
+
+// Free Functions
+    void                                    Free(Allocation_t *allocation);
+
+// Budget Functions
+    void                                    UpdateBudget(void);
+    bool                                    IsUnderPressure(void);
+    void                                    Trim(void);
+
+// Flush/Invalidate Functions
+    bool                                    Flush(const Allocation_t *allocation, VkDeviceSize offset, VkDeviceSize size) const;
+    bool                                    Invalidate(const Allocation_t *allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+// Get Functions
+    inline uint32_t                         GetAllocationCount(void)          const { FUN_ENTRY(GL_LOG_TRACE); return mAllocationCount; }
+    inline VkDeviceSize                     GetHeapUsage(uint32_t heap)       const { FUN_ENTRY(GL_LOG_TRACE); return mHeapUsage[heap]; }
+    inline VkDeviceSize                     GetHeapBudget(uint32_t heap)      const { FUN_ENTRY(GL_LOG_TRACE); return mHeapBudget[heap]; }
+};
+
+}
+
+#endif // __VKMEMORYALLOCATOR_H__
@@ -0,0 +1,265 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       perfCounters.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Per-frame Performance Counters of the Vulkan backend
+ *
+ *  @section
+ *
+ *  The counters are owned by the device, so the work of all contexts adds up
+ *  in them, whichever thread records or submits it. Every count is a relaxed
+ *  atomic add and nothing else is done while counting. The totals are turned
+ *  into per-frame values whenever a frame is submitted to its surface, and
+ *  these are written to the logger every GLOVE_PERF_COUNTERS_DUMP frames.
+ *  The gauges also keep the highest value they have reached, which, along
+ *  with the peak resident set of the process, is written to the file named
+ *  by GLOVE_MEMORY_REPORT once the device is destroyed, or at exit for the
+ *  processes that never terminate their display.
+ *
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif // WIN32
+#include "perfCounters.h"
+
+namespace vulkanAPI {
+
+/// Longest line written to the logger at once, which truncates longer ones
+#define GLOVE_PERF_COUNTERS_DUMP_LINE                   160
+
+/// the counters whose report is still to be written when the process exits
+static PerfCounters *sMemoryReportCounters = nullptr;
+
+PerfCounters::PerfCounters()
+: mFrameCount(0), mDumpInterval(0), mMemoryReportPath(getenv(GLOVE_MEMORY_REPORT_ENV))
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        mTotals[i].store(0, std::memory_order_relaxed);
+        mPeaks[i].store(0, std::memory_order_relaxed);
+        mFrameStart[i] = 0;
+        mLastFrame[i]  = 0;
+    }
+
+    const char *interval = getenv(GLOVE_PERF_COUNTERS_DUMP_ENV);
+    if(interval != nullptr && atoi(interval) > 0) {
+        mDumpInterval = static_cast<uint32_t>(atoi(interval));
+    }
+
+    if(mMemoryReportPath != nullptr && *mMemoryReportPath) {
+        static bool registered = false;
+        if(!registered) {
+            registered = atexit(WriteMemoryReportAtExit) == 0;
+        }
+        sMemoryReportCounters = this;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(sMemoryReportCounters == this) {
+        sMemoryReportCounters = nullptr;
+        WriteMemoryReport();
+    }
+}
+
+void
+PerfCounters::WriteMemoryReportAtExit(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(sMemoryReportCounters != nullptr) {
+        sMemoryReportCounters->WriteMemoryReport();
+        sMemoryReportCounters = nullptr;
+    }
+}
+
+void
+PerfCounters::WriteMemoryReport(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    FILE *file = fopen(mMemoryReportPath, "w");
+    if(file == nullptr) {
+        return;
+    }
+
+    // "<name> <bytes>" per line, the resident set first
+#ifndef WIN32
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        fprintf(file, "peak_rss_bytes %" PRIu64 "\n", static_cast<uint64_t>(usage.ru_maxrss));
+#else
+        fprintf(file, "peak_rss_bytes %" PRIu64 "\n", static_cast<uint64_t>(usage.ru_maxrss) * 1024);
+#endif // __APPLE__
+    }
+#endif // WIN32
+
+    for(uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if(IsGauge(static_cast<perfCounter_t>(i))) {
+            fprintf(file, "peak_%s %" PRIu64 "\n", GetName(static_cast<perfCounter_t>(i)), GetPeak(static_cast<perfCounter_t>(i)));
+        }
+    }
+
+    fclose(file);
+}
+
+void
+PerfCounters::RaisePeak(perfCounter_t counter, uint64_t value)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    uint64_t peak = mPeaks[counter].load(std::memory_order_relaxed);
+    while(value > peak && !mPeaks[counter].compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+    }
+}
+
+void
+PerfCounters::AddDeviceMemory(VkMemoryPropertyFlags flags, VkDeviceSize size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+        Add(PERF_COUNTER_DEVICE_LOCAL_BYTES, size);
+    }
+    if(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        Add(PERF_COUNTER_HOST_VISIBLE_BYTES, size);
+    }
+}
+
+void
+PerfCounters::SubDeviceMemory(VkMemoryPropertyFlags flags, VkDeviceSize size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+        Sub(PERF_COUNTER_DEVICE_LOCAL_BYTES, size);
+    }
+    if(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        Sub(PERF_COUNTER_HOST_VISIBLE_BYTES, size);
+    }
+}
+
+const char *
+PerfCounters::GetName(perfCounter_t counter)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    switch(counter) {
+    case PERF_COUNTER_DRAWS:                            return "draws";
+    case PERF_COUNTER_SECONDARY_CMD_BUFFERS_ALLOCATED:  return "secondary_cmd_buffers_allocated";
+    case PERF_COUNTER_PIPELINES_CREATED:                return "pipelines_created";
+    case PERF_COUNTER_PIPELINES_REUSED:                 return "pipelines_reused";
+    case PERF_COUNTER_PIPELINES_LINKED:                 return "pipelines_linked";
+    case PERF_COUNTER_RENDER_PASSES_BEGUN:              return "render_passes_begun";
+    case PERF_COUNTER_QUEUE_SUBMITS:                    return "queue_submits";
+    case PERF_COUNTER_AUX_SUBMITS:                      return "aux_submits";
+    case PERF_COUNTER_FENCE_WAITS:                      return "fence_waits";
+    case PERF_COUNTER_FENCE_WAIT_NS:                    return "fence_wait_ns";
+    case PERF_COUNTER_BYTES_UPLOADED:                   return "bytes_uploaded";
+    case PERF_COUNTER_BYTES_READ_BACK:                  return "bytes_read_back";
+    case PERF_COUNTER_DESCRIPTOR_WRITES:                return "descriptor_writes";
+    case PERF_COUNTER_MEMORY_ALLOCATIONS:               return "memory_allocations";
+    case PERF_COUNTER_MEMORY_BYTES_ALLOCATED:           return "memory_bytes_allocated";
+    case PERF_COUNTER_MEMORY_BYTES_FREED:               return "memory_bytes_freed";
+    case PERF_COUNTER_MEMORY_TRIMS:                     return "memory_trims";
+    case PERF_COUNTER_RENDER_PASS_GPU_NS:               return "render_pass_gpu_ns";
+    case PERF_COUNTER_AUX_GPU_NS:                       return "aux_gpu_ns";
+    case PERF_COUNTER_HOST_BYTES_PIPELINES:             return "host_bytes_pipelines";
+    case PERF_COUNTER_HOST_BYTES_DESCRIPTORS:           return "host_bytes_descriptors";
+    case PERF_COUNTER_HOST_BYTES_COMMANDS:              return "host_bytes_commands";
+    case PERF_COUNTER_HOST_BYTES_RESOURCES:             return "host_bytes_resources";
+    case PERF_COUNTER_HOST_BYTES_DEVICE:                return "host_bytes_device";
+    case PERF_COUNTER_DEVICE_LOCAL_BYTES:               return "device_local_bytes";
+    case PERF_COUNTER_HOST_VISIBLE_BYTES:               return "host_visible_bytes";
+    default:                                            return "";
+    }
+}
+
+void
+PerfCounters::GetTotals(uint64_t *values) const
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        values[i] = mTotals[i].load(std::memory_order_relaxed);
+    }
+}
+
+void
+PerfCounters::GetLastFrame(uint64_t *values)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::lock_guard<std::mutex> lock(mFrameMutex);
+    memcpy(values, mLastFrame, sizeof(mLastFrame));
+}
+
+void
+PerfCounters::EndFrame(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mFrameMutex);
+
+    uint64_t totals[PERF_COUNTER_COUNT];
+    GetTotals(totals);
+    for(uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        mLastFrame[i]  = IsGauge(static_cast<perfCounter_t>(i)) ? totals[i] : totals[i] - mFrameStart[i];
+        mFrameStart[i] = totals[i];
+    }
+
+    ++mFrameCount;
+    if(mDumpInterval && mFrameCount % mDumpInterval == 0) {
+        Dump();
+    }
+}
+
+void
+PerfCounters::Dump(void) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the counters of a frame are packed in as few lines as the logger takes
+    char line[GLOVE_PERF_COUNTERS_DUMP_LINE];
+    int  length = snprintf(line, sizeof(line), "perf frame %" PRIu64 ":", mFrameCount);
+    for(uint32_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        char counter[64];
+        int  counterLength = snprintf(counter, sizeof(counter), " %s=%" PRIu64, GetName(static_cast<perfCounter_t>(i)), mLastFrame[i]);
+
+        if(length + counterLength >= static_cast<int>(sizeof(line))) {
+            GLLogger::Log(GL_LOG_INFO, "%s", line);
+            length = snprintf(line, sizeof(line), "perf frame %" PRIu64 ":", mFrameCount);
+        }
+
+        memcpy(line + length, counter, counterLength + 1);
+        length += counterLength;
+    }
+
+    GLLogger::Log(GL_LOG_INFO, "%s", line);
+}
+
+}
@@ -0,0 +1,122 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       perfCounters.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Per-frame Performance Counters of the Vulkan backend
+ *
+ */
+
+#ifndef __VKPERFCOUNTERS_H__
+#define __VKPERFCOUNTERS_H__
+
+#include <atomic>
+#include <mutex>
+#include "context.h"
+
+/// Environment variable holding the number of frames between two dumps of the counters to the logger
+#define GLOVE_PERF_COUNTERS_DUMP_ENV                    "GLOVE_PERF_COUNTERS_DUMP"
+
+/// Environment variable holding the file the peak memory of the process is written to when it is done with the device
+#define GLOVE_MEMORY_REPORT_ENV                         "GLOVE_MEMORY_REPORT"
+
+namespace vulkanAPI {
+
+typedef enum {
+    PERF_COUNTER_DRAWS = 0,
+    PERF_COUNTER_SECONDARY_CMD_BUFFERS_ALLOCATED,
+    PERF_COUNTER_PIPELINES_CREATED,
+    PERF_COUNTER_PIPELINES_REUSED,
+    PERF_COUNTER_PIPELINES_LINKED,
+    PERF_COUNTER_RENDER_PASSES_BEGUN,
+    PERF_COUNTER_QUEUE_SUBMITS,
+    PERF_COUNTER_AUX_SUBMITS,
+    PERF_COUNTER_FENCE_WAITS,
+    PERF_COUNTER_FENCE_WAIT_NS,
+    PERF_COUNTER_BYTES_UPLOADED,
+    PERF_COUNTER_BYTES_READ_BACK,
+    PERF_COUNTER_DESCRIPTOR_WRITES,
+    PERF_COUNTER_MEMORY_ALLOCATIONS,
+    PERF_COUNTER_MEMORY_BYTES_ALLOCATED,
+    PERF_COUNTER_MEMORY_BYTES_FREED,
+    PERF_COUNTER_MEMORY_TRIMS,
+    PERF_COUNTER_RENDER_PASS_GPU_NS,
+    PERF_COUNTER_AUX_GPU_NS,
+    /// live host bytes of the objects of each subsystem (see HostAllocator), reported as they are rather than per frame
+    PERF_COUNTER_HOST_BYTES_PIPELINES,
+    PERF_COUNTER_HOST_BYTES_DESCRIPTORS,
+    PERF_COUNTER_HOST_BYTES_COMMANDS,
+    PERF_COUNTER_HOST_BYTES_RESOURCES,
+    PERF_COUNTER_HOST_BYTES_DEVICE,
+    /// live bytes of device memory, by the properties of the type it was allocated from, in both for a type with both
+    PERF_COUNTER_DEVICE_LOCAL_BYTES,
+    PERF_COUNTER_HOST_VISIBLE_BYTES,
+    PERF_COUNTER_COUNT
+} perfCounter_t;
+
+class PerfCounters final {
+private:
+    /// totals since the device was created, added to by every context and worker thread
+    std::atomic<uint64_t>                   mTotals[PERF_COUNTER_COUNT];
+    /// highest value each gauge has reached
+    std::atomic<uint64_t>                   mPeaks[PERF_COUNTER_COUNT];
+
+    std::mutex                              mFrameMutex;
+    uint64_t                                mFrameStart[PERF_COUNTER_COUNT];
+    uint64_t                                mLastFrame[PERF_COUNTER_COUNT];
+    uint64_t                                mFrameCount;
+    uint32_t                                mDumpInterval;
+    const char                             *mMemoryReportPath;
+
+    void                                    Dump(void) const;
+    void                                    RaisePeak(perfCounter_t counter, uint64_t value);
+    static void                             WriteMemoryReportAtExit(void);
+
+public:
+// Constructor
+    PerfCounters();
+
+// Destructor
+    ~PerfCounters();
+
+// Count Functions
+    inline void                             Add(perfCounter_t counter, uint64_t value = 1)  { FUN_ENTRY(GL_LOG_TRACE); const uint64_t total = mTotals[counter].fetch_add(value, std::memory_order_relaxed) + value;
+                                                                                              if(IsGauge(counter)) { RaisePeak(counter, total); } }
+    inline void                             Sub(perfCounter_t counter, uint64_t value)      { FUN_ENTRY(GL_LOG_TRACE); mTotals[counter].fetch_sub(value, std::memory_order_relaxed); }
+    void                                    AddDeviceMemory(VkMemoryPropertyFlags flags, VkDeviceSize size);
+    void                                    SubDeviceMemory(VkMemoryPropertyFlags flags, VkDeviceSize size);
+
+// Frame Functions
+    void                                    EndFrame(void);
+
+// Report Functions
+    void                                    WriteMemoryReport(void) const;
+
+// Get Functions
+    inline uint64_t                         GetTotal(perfCounter_t counter)           const { FUN_ENTRY(GL_LOG_TRACE); return mTotals[counter].load(std::memory_order_relaxed); }
+    inline uint64_t                         GetPeak(perfCounter_t counter)            const { FUN_ENTRY(GL_LOG_TRACE); return mPeaks[counter].load(std::memory_order_relaxed); }
+    void                                    GetTotals(uint64_t *values)               const;
+    void                                    GetLastFrame(uint64_t *values);
+    static const char                      *GetName(perfCounter_t counter);
+
+// Is Functions
+    static inline bool                      IsGauge(perfCounter_t counter)                  { FUN_ENTRY(GL_LOG_TRACE); return counter >= PERF_COUNTER_HOST_BYTES_PIPELINES && counter <= PERF_COUNTER_HOST_VISIBLE_BYTES; }
+};
+
+}
+
+#endif // __VKPERFCOUNTERS_H__
@@ -27,13 +27,24 @@
  */
 
 #include "pipeline.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
+template<typename T>
+static inline void
+AppendToKey(std::vector<uint32_t> &key, const T &value)
+{
+    uint32_t words[(sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t)] = {0};
+    memcpy(words, &value, sizeof(T));
+    key.insert(key.end(), words, words + sizeof(words) / sizeof(uint32_t));
+}
+
 Pipeline::Pipeline(const vkContext_t *vkContext)
-: mVkContext(vkContext), mVkPipeline(VK_NULL_HANDLE), mVkPipelineLayout(VK_NULL_HANDLE),
-  mVkPipelineCache(VK_NULL_HANDLE), mVkPipelineVertexInputState(VK_NULL_HANDLE),
-  mVkPipelineShaderStageCount(0), mCacheManager(nullptr)
+: mVkContext(vkContext), mVkPipeline(VK_NULL_HANDLE), mEnabledDynamicStates(0), mExtendedDynamicState(false),
+  mVkPipelineLayout(VK_NULL_HANDLE), mVkPipelineCache(VK_NULL_HANDLE), mPrimitiveRestartEnable(VK_FALSE),
+  mVkPipelineVertexInputState(VK_NULL_HANDLE), mVkPipelineShaderStageCount(0), mCacheManager(nullptr), mKeyHash(0), mProgramHash(0)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
@@ -44,8 +55,6 @@ Pipeline::Pipeline(const vkContext_t *vkContext)
     mUpdateState.IndexBuffer      = false;
     mUpdateState.Viewport         = true;
     mUpdateState.Pipeline         = true;
-
-    mEnabledDynamicStatesList.resize(VK_DYNAMIC_STATE_RANGE_SIZE);
 }
 
 Pipeline::~Pipeline()
@@ -73,36 +82,23 @@ Pipeline::SetScissor(int32_t x, int32_t y, int32_t width, int32_t height)
     mVkScissorRect.extent.height = height;
 }
 
-void
-Pipeline::MoveToCache()
-{
-    FUN_ENTRY(GL_LOG_DEBUG);
-
-    if(mVkPipeline != VK_NULL_HANDLE) {
-        mCacheManager->CacheVkPipelineObject(mVkPipeline);
-        mVkPipeline = VK_NULL_HANDLE;
-    }
-}
-
 void
 Pipeline::Release()
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mVkPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(mVkContext->vkDevice, mVkPipeline, nullptr);
-        mVkPipeline = VK_NULL_HANDLE;
-    }
+    // pipeline objects are owned by the cache manager, which may share them among pipelines
+    mVkPipeline = VK_NULL_HANDLE;
 }
 
 void
-Pipeline::ComputeViewport(int fboWidth, int fboHeight, int viewportX, int viewportY, int viewportW, int viewportH, float minDepth, float maxDepth)
+Pipeline::ComputeViewport(int fboWidth, int fboHeight, int viewportX, int viewportY, int viewportW, int viewportH, float minDepth, float maxDepth, bool invertY)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     viewportW = std::min(viewportW, fboWidth);
     viewportH = std::min(viewportH, fboHeight);
-    if(mVkContext->mIsMaintenanceExtSupported) {
+    if(invertY && mVkContext->mIsMaintenanceExtSupported) {
         viewportY = fboHeight - viewportY;
         viewportH = -viewportH;
     }
@@ -116,14 +112,14 @@ Pipeline::ComputeViewport(int fboWidth, int fboHeight, int viewportX, int viewpo
 }
 
 void
-Pipeline::ComputeScissor(int fboWidth, int fboHeight, int scissorX, int scissorY, int scissorW, int scissorH)
+Pipeline::ComputeScissor(int fboWidth, int fboHeight, int scissorX, int scissorY, int scissorW, int scissorH, bool invertY)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     scissorW = std::min(scissorW, fboWidth);
     scissorH = std::min(scissorH, fboHeight);
 
-    int scissorYinv = fboHeight - scissorY - scissorH;
+    int scissorYinv = invertY ? fboHeight - scissorY - scissorH : scissorY;
 
     mVkScissorRect  = {
                         { scissorX, scissorYinv },
@@ -158,7 +154,8 @@ Pipeline::CreateInputAssemblyState(VkBool32 primitiveRestartEnable, VkPrimitiveT
     mVkPipelineInputAssemblyState.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     mVkPipelineInputAssemblyState.pNext                  = nullptr;
     mVkPipelineInputAssemblyState.flags                  = 0;
-    mVkPipelineInputAssemblyState.primitiveRestartEnable = primitiveRestartEnable;
+    mVkPipelineInputAssemblyState.primitiveRestartEnable = VK_FALSE;
+    mPrimitiveRestartEnable                              = primitiveRestartEnable;
 
     SetInputAssemblyTopology(topology);
 }
@@ -295,16 +292,23 @@ void
 Pipeline::CreateDynamicState(const std::vector<VkDynamicState>& states)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
-    assert(states.size() <= VK_DYNAMIC_STATE_RANGE_SIZE);
-    for(size_t index = 0; index < mEnabledDynamicStatesList.size(); ++index) {
-        mEnabledDynamicStatesList[index] = false;
-    }
+    assert(states.size() <= GLOVE_MAX_DYNAMIC_STATES);
+    mEnabledDynamicStates = 0;
+    mExtendedDynamicState = false;
     memset(mVkPipelineDynamicStateEnables, 0, sizeof(mVkPipelineDynamicStateEnables));
 
     for(size_t stateIndex = 0; stateIndex < states.size(); ++stateIndex) {
         VkDynamicState state = states[stateIndex];
         mVkPipelineDynamicStateEnables[stateIndex] = state;
-        mEnabledDynamicStatesList[state] = true;
+        if(state < VK_DYNAMIC_STATE_RANGE_SIZE) {
+            mEnabledDynamicStates |= 1u << state;
+        }
+#ifdef VK_EXT_extended_dynamic_state
+        /// the extended states are enabled as a whole, see StateManager::InitVkPipelineStates
+        if(state == VK_DYNAMIC_STATE_CULL_MODE_EXT) {
+            mExtendedDynamicState = true;
+        }
+#endif // VK_EXT_extended_dynamic_state
     }
 
     memset(static_cast<void *>(&mVkPipelineDynamicState), 0, sizeof(mVkPipelineDynamicState));
@@ -319,35 +323,105 @@ Pipeline::UpdateDynamicState(const VkCommandBuffer *CmdBuffer, float lineWidth)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mEnabledDynamicStatesList[VK_DYNAMIC_STATE_VIEWPORT]) {
+    if(IsDynamicState(VK_DYNAMIC_STATE_VIEWPORT)) {
         vkCmdSetViewport  (*CmdBuffer, 0, mVkPipelineViewportState.viewportCount, &mVkViewport);
     }
-    if(mEnabledDynamicStatesList[VK_DYNAMIC_STATE_SCISSOR]) {
+    if(IsDynamicState(VK_DYNAMIC_STATE_SCISSOR)) {
         vkCmdSetScissor   (*CmdBuffer, 0, mVkPipelineViewportState.scissorCount , &mVkScissorRect);
     }
-    if(mEnabledDynamicStatesList[VK_DYNAMIC_STATE_LINE_WIDTH]) {
+    if(IsDynamicState(VK_DYNAMIC_STATE_LINE_WIDTH)) {
         vkCmdSetLineWidth (*CmdBuffer, lineWidth);
     }
-    /*
-    TODO:: fill the remaining dynamic states
-    VK_DYNAMIC_STATE_BLEND_CONSTANTS
-    VK_DYNAMIC_STATE_DEPTH_BOUNDS
-    VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK
-    VK_DYNAMIC_STATE_STENCIL_WRITE_MASK
-    VK_DYNAMIC_STATE_STENCIL_REFERENCE
-    */
+    if(IsDynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS)) {
+        vkCmdSetDepthBias (*CmdBuffer, mVkPipelineRasterizationState.depthBiasConstantFactor,
+                                       mVkPipelineRasterizationState.depthBiasClamp,
+                                       mVkPipelineRasterizationState.depthBiasSlopeFactor);
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_BLEND_CONSTANTS)) {
+        vkCmdSetBlendConstants(*CmdBuffer, mVkPipelineColorBlendState.blendConstants);
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK)) {
+        vkCmdSetStencilCompareMask(*CmdBuffer, VK_STENCIL_FACE_FRONT_BIT, mVkPipelineDepthStencilState.front.compareMask);
+        vkCmdSetStencilCompareMask(*CmdBuffer, VK_STENCIL_FACE_BACK_BIT , mVkPipelineDepthStencilState.back.compareMask);
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK)) {
+        vkCmdSetStencilWriteMask  (*CmdBuffer, VK_STENCIL_FACE_FRONT_BIT, mVkPipelineDepthStencilState.front.writeMask);
+        vkCmdSetStencilWriteMask  (*CmdBuffer, VK_STENCIL_FACE_BACK_BIT , mVkPipelineDepthStencilState.back.writeMask);
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_STENCIL_REFERENCE)) {
+        vkCmdSetStencilReference  (*CmdBuffer, VK_STENCIL_FACE_FRONT_BIT, mVkPipelineDepthStencilState.front.reference);
+        vkCmdSetStencilReference  (*CmdBuffer, VK_STENCIL_FACE_BACK_BIT , mVkPipelineDepthStencilState.back.reference);
+    }
+#ifdef VK_EXT_extended_dynamic_state
+    if(mExtendedDynamicState) {
+        mVkContext->fpCmdSetCullModeEXT         (*CmdBuffer, mVkPipelineRasterizationState.cullMode);
+        mVkContext->fpCmdSetFrontFaceEXT        (*CmdBuffer, mVkPipelineRasterizationState.frontFace);
+        mVkContext->fpCmdSetPrimitiveTopologyEXT(*CmdBuffer, mVkPipelineInputAssemblyState.topology);
+        mVkContext->fpCmdSetDepthTestEnableEXT  (*CmdBuffer, mVkPipelineDepthStencilState.depthTestEnable);
+        mVkContext->fpCmdSetDepthWriteEnableEXT (*CmdBuffer, mVkPipelineDepthStencilState.depthWriteEnable);
+        mVkContext->fpCmdSetDepthCompareOpEXT   (*CmdBuffer, mVkPipelineDepthStencilState.depthCompareOp);
+    }
+#endif // VK_EXT_extended_dynamic_state
 }
 
 void
-Pipeline::SetInfo(const VkRenderPass *renderpass)
+Pipeline::MaskDynamicState(VkPipelineInputAssemblyStateCreateInfo *inputAssembly,
+                           VkPipelineRasterizationStateCreateInfo *rasterization,
+                           VkPipelineColorBlendStateCreateInfo    *colorBlend,
+                           VkPipelineDepthStencilStateCreateInfo  *depthStencil) const
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    /// values set through vkCmdSet* do not affect the pipeline object, so they
+    /// are cleared before they reach the pipeline key or the recorded state
+    if(IsDynamicState(VK_DYNAMIC_STATE_LINE_WIDTH)) {
+        rasterization->lineWidth               = 1.0f;
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS)) {
+        rasterization->depthBiasConstantFactor = 0.0f;
+        rasterization->depthBiasClamp          = 0.0f;
+        rasterization->depthBiasSlopeFactor    = 0.0f;
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_BLEND_CONSTANTS)) {
+        memset(colorBlend->blendConstants, 0, sizeof(colorBlend->blendConstants));
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK)) {
+        depthStencil->front.compareMask        = 0;
+        depthStencil->back.compareMask         = 0;
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK)) {
+        depthStencil->front.writeMask          = 0;
+        depthStencil->back.writeMask           = 0;
+    }
+    if(IsDynamicState(VK_DYNAMIC_STATE_STENCIL_REFERENCE)) {
+        depthStencil->front.reference          = 0;
+        depthStencil->back.reference           = 0;
+    }
+    if(mExtendedDynamicState) {
+        /// only the topology class has to match the one of the pipeline
+        inputAssembly->topology                = GetTopologyClass(inputAssembly->topology);
+        rasterization->cullMode                = VK_CULL_MODE_NONE;
+        rasterization->frontFace               = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        depthStencil->depthTestEnable          = VK_FALSE;
+        depthStencil->depthWriteEnable         = VK_FALSE;
+        depthStencil->depthCompareOp           = VK_COMPARE_OP_NEVER;
+    }
+}
+
+void
+Pipeline::SetInfo(const RenderPass *renderPass)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_KHR_dynamic_rendering
+    mVkPipelineInfo.pNext               = renderPass->ChainPipelineRendering(&mVkPipelineRenderingInfo, &mVkPipelineRenderingColorFormat, nullptr);
+#endif // VK_KHR_dynamic_rendering
+
     mVkPipelineInfo.layout              = mVkPipelineLayout;
     mVkPipelineInfo.pVertexInputState   = mVkPipelineVertexInputState;
     mVkPipelineInfo.pStages             = mVkPipelineShaderStages;
     mVkPipelineInfo.stageCount          = mVkPipelineShaderStageCount;
-    mVkPipelineInfo.renderPass          = *renderpass;
+    mVkPipelineInfo.renderPass          = *renderPass->GetRenderPass();
 }
 
 void
@@ -358,32 +432,225 @@ Pipeline::Bind(const VkCommandBuffer *CmdBuffer) const
     vkCmdBindPipeline(*CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mVkPipeline);
 }
 
+void
+Pipeline::ComputeKey(const RenderPass *renderPass)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::vector<uint32_t> &vertexInputKey      = mPartKeys[PipelineLibrary::PART_VERTEX_INPUT];
+    std::vector<uint32_t> &preRasterizationKey = mPartKeys[PipelineLibrary::PART_PRE_RASTERIZATION];
+    std::vector<uint32_t> &fragmentShaderKey   = mPartKeys[PipelineLibrary::PART_FRAGMENT_SHADER];
+    std::vector<uint32_t> &fragmentOutputKey   = mPartKeys[PipelineLibrary::PART_FRAGMENT_OUTPUT];
+    for(auto &key : mPartKeys) {
+        key.clear();
+    }
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = mVkPipelineInputAssemblyState;
+    VkPipelineRasterizationStateCreateInfo rasterization = mVkPipelineRasterizationState;
+    VkPipelineColorBlendStateCreateInfo    colorBlend    = mVkPipelineColorBlendState;
+    VkPipelineDepthStencilStateCreateInfo  depthStencil  = mVkPipelineDepthStencilState;
+    MaskDynamicState(&inputAssembly, &rasterization, &colorBlend, &depthStencil);
+
+    AppendToKey(vertexInputKey, inputAssembly.topology);
+    AppendToKey(vertexInputKey, inputAssembly.primitiveRestartEnable);
+    if(mVkPipelineVertexInputState) {
+        AppendToKey(vertexInputKey, mVkPipelineVertexInputState->vertexBindingDescriptionCount);
+        for(uint32_t i = 0; i < mVkPipelineVertexInputState->vertexBindingDescriptionCount; ++i) {
+            AppendToKey(vertexInputKey, mVkPipelineVertexInputState->pVertexBindingDescriptions[i]);
+        }
+        AppendToKey(vertexInputKey, mVkPipelineVertexInputState->vertexAttributeDescriptionCount);
+        for(uint32_t i = 0; i < mVkPipelineVertexInputState->vertexAttributeDescriptionCount; ++i) {
+            AppendToKey(vertexInputKey, mVkPipelineVertexInputState->pVertexAttributeDescriptions[i]);
+        }
+    }
+
+    AppendToKey(preRasterizationKey, rasterization.depthClampEnable);
+    AppendToKey(preRasterizationKey, rasterization.rasterizerDiscardEnable);
+    AppendToKey(preRasterizationKey, rasterization.polygonMode);
+    AppendToKey(preRasterizationKey, rasterization.cullMode);
+    AppendToKey(preRasterizationKey, rasterization.frontFace);
+    AppendToKey(preRasterizationKey, rasterization.depthBiasEnable);
+    AppendToKey(preRasterizationKey, rasterization.depthBiasConstantFactor);
+    AppendToKey(preRasterizationKey, rasterization.depthBiasClamp);
+    AppendToKey(preRasterizationKey, rasterization.depthBiasSlopeFactor);
+    AppendToKey(preRasterizationKey, rasterization.lineWidth);
+    AppendToKey(preRasterizationKey, mVkPipelineViewportState.viewportCount);
+    AppendToKey(preRasterizationKey, mVkPipelineViewportState.scissorCount);
+
+    AppendToKey(fragmentShaderKey, depthStencil.depthTestEnable);
+    AppendToKey(fragmentShaderKey, depthStencil.depthWriteEnable);
+    AppendToKey(fragmentShaderKey, depthStencil.depthCompareOp);
+    AppendToKey(fragmentShaderKey, depthStencil.depthBoundsTestEnable);
+    AppendToKey(fragmentShaderKey, depthStencil.stencilTestEnable);
+    AppendToKey(fragmentShaderKey, depthStencil.front);
+    AppendToKey(fragmentShaderKey, depthStencil.back);
+    AppendToKey(fragmentShaderKey, depthStencil.minDepthBounds);
+    AppendToKey(fragmentShaderKey, depthStencil.maxDepthBounds);
+
+    AppendToKey(fragmentOutputKey, mVkPipelineColorBlendAttachmentState);
+    AppendToKey(fragmentOutputKey, colorBlend.logicOpEnable);
+    AppendToKey(fragmentOutputKey, colorBlend.logicOp);
+    AppendToKey(fragmentOutputKey, colorBlend.attachmentCount);
+    AppendToKey(fragmentOutputKey, colorBlend.blendConstants);
+
+    // the multisample state is part of both the fragment shader and the fragment output
+    for(auto key : {&fragmentShaderKey, &fragmentOutputKey}) {
+        AppendToKey(*key, mVkPipelineMultisampleState.rasterizationSamples);
+        AppendToKey(*key, mVkPipelineMultisampleState.sampleShadingEnable);
+        AppendToKey(*key, mVkPipelineMultisampleState.minSampleShading);
+        AppendToKey(*key, mVkPipelineMultisampleState.alphaToCoverageEnable);
+        AppendToKey(*key, mVkPipelineMultisampleState.alphaToOneEnable);
+    }
+
+    for(uint32_t i = 0; i < mVkPipelineShaderStageCount; ++i) {
+        std::vector<uint32_t> &key = (mVkPipelineShaderStages[i].stage == VK_SHADER_STAGE_VERTEX_BIT) ? preRasterizationKey : fragmentShaderKey;
+        AppendToKey(key, mVkPipelineShaderStages[i].stage);
+        AppendToKey(key, mVkPipelineShaderStages[i].module);
+
+        // every set of specialization constant values is a pipeline variant of its own
+        const VkSpecializationInfo *specialization = mVkPipelineShaderStages[i].pSpecializationInfo;
+        if(specialization) {
+            const uint32_t *data = static_cast<const uint32_t *>(specialization->pData);
+            key.insert(key.end(), data, data + specialization->dataSize / sizeof(uint32_t));
+        }
+    }
+
+    // render passes with the same attachment formats, sample count, input attachments and views are
+    // compatible, the sample count is already part of the multisample state. The dynamic states
+    // are given to every part, as the parts have to agree on them to be linked together
+    for(auto &key : mPartKeys) {
+        AppendToKey(key, mVkPipelineDynamicState.dynamicStateCount);
+        for(uint32_t i = 0; i < mVkPipelineDynamicState.dynamicStateCount; ++i) {
+            AppendToKey(key, mVkPipelineDynamicStateEnables[i]);
+        }
+        AppendToKey(key, mVkPipelineLayout);
+        AppendToKey(key, renderPass->GetColorFormat());
+        AppendToKey(key, renderPass->GetDepthStencilFormat());
+        AppendToKey(key, renderPass->GetColorFetchEnabled());
+        AppendToKey(key, renderPass->GetViewCount());
+    }
+
+    mKey.clear();
+    for(const auto &key : mPartKeys) {
+        AppendToKey(mKey, static_cast<uint32_t>(key.size()));
+        mKey.insert(mKey.end(), key.begin(), key.end());
+    }
+
+    // FNV-1a
+    mKeyHash = 0xcbf29ce484222325ULL;
+    for(uint32_t word : mKey) {
+        mKeyHash = (mKeyHash ^ word) * 0x100000001b3ULL;
+    }
+}
+
 bool
-Pipeline::Create(const VkRenderPass *renderpass)
+Pipeline::Create(const RenderPass *renderPass)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
-    if(mUpdateState.Pipeline) {
-        SetInfo(renderpass);
-        return CreateGraphicsPipeline();
+    // rasterization follows the sample count of the attachments drawn to
+    SetMultisampleRasterizationSamples(renderPass->GetSamples());
+
+    // the bound pipeline must still be alive in the cache, as it may have been
+    // evicted in favour of other pipelines or together with its layout
+    if(!mUpdateState.Pipeline &&
+       (mVkPipeline == VK_NULL_HANDLE || mCacheManager->TouchVkPipeline(mKeyHash, mVkPipeline))) {
+        return true;
     }
 
+    SetInfo(renderPass);
+    ComputeKey(renderPass);
+
+    mUpdateState.Pipeline = false;
+
+    mVkPipeline = mCacheManager->FindVkPipeline(mKeyHash, mKey);
+    if(mVkPipeline != VK_NULL_HANDLE) {
+        mVkContext->perfCounters->Add(PERF_COUNTER_PIPELINES_REUSED);
+        return true;
+    }
+
+    if(!CreateGraphicsPipeline()) {
+        return false;
+    }
+
+    RecordState(renderPass);
+
     return true;
 }
 
+void
+Pipeline::RecordState(const RenderPass *renderPass) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the warmer compiles against single view passes only, multiview ones are left to draw time
+    PipelineWarmer *pipelineWarmer = mCacheManager->GetPipelineWarmer();
+    if(!mProgramHash || !pipelineWarmer->IsEnabled() || renderPass->GetViewCount() > 1) {
+        return;
+    }
+
+    PipelineWarmer::StateRecord_t record;
+    GetStateRecord(renderPass->GetColorFormat(), renderPass->GetDepthStencilFormat(), renderPass->GetColorFetchEnabled(), &record);
+
+    pipelineWarmer->Record(record);
+}
+
+void
+Pipeline::GetStateRecord(VkFormat colorFormat, VkFormat depthStencilFormat, VkBool32 colorFetch, PipelineWarmer::StateRecord_t *record) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    memset(static_cast<void *>(&record->fixed), 0, sizeof(record->fixed));
+    record->fixed.programHash          = mProgramHash;
+    record->fixed.colorFormat          = colorFormat;
+    record->fixed.depthStencilFormat   = depthStencilFormat;
+    record->fixed.colorFetch           = colorFetch;
+    record->fixed.inputAssembly        = mVkPipelineInputAssemblyState;
+    record->fixed.rasterization        = mVkPipelineRasterizationState;
+    record->fixed.colorBlendAttachment = mVkPipelineColorBlendAttachmentState;
+    record->fixed.colorBlend           = mVkPipelineColorBlendState;
+    record->fixed.depthStencil         = mVkPipelineDepthStencilState;
+    record->fixed.multisample          = mVkPipelineMultisampleState;
+    MaskDynamicState(&record->fixed.inputAssembly, &record->fixed.rasterization, &record->fixed.colorBlend, &record->fixed.depthStencil);
+    record->fixed.viewportCount        = mVkPipelineViewportState.viewportCount;
+    record->fixed.scissorCount         = mVkPipelineViewportState.scissorCount;
+
+    record->dynamicStates.assign(mVkPipelineDynamicStateEnables, mVkPipelineDynamicStateEnables + mVkPipelineDynamicState.dynamicStateCount);
+    if(mVkPipelineVertexInputState) {
+        record->bindings.assign(mVkPipelineVertexInputState->pVertexBindingDescriptions,
+                                mVkPipelineVertexInputState->pVertexBindingDescriptions   + mVkPipelineVertexInputState->vertexBindingDescriptionCount);
+        record->attributes.assign(mVkPipelineVertexInputState->pVertexAttributeDescriptions,
+                                  mVkPipelineVertexInputState->pVertexAttributeDescriptions + mVkPipelineVertexInputState->vertexAttributeDescriptionCount);
+    }
+}
+
 bool
 Pipeline::CreateGraphicsPipeline(void)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
+    CHROME_TRACE_SPAN("vkCreateGraphicsPipelines", "pipeline");
 
-    MoveToCache();
+    // the pipeline is linked from libraries of its parts, which later combinations reuse,
+    // the cache manager replaces it with an optimized one once that has been compiled
+    mVkPipeline = mCacheManager->GetPipelineLibrary()->Link(mVkPipelineInfo, mVkPipelineCache, mKeyHash, mPartKeys);
+    if(mVkPipeline != VK_NULL_HANDLE) {
+        mCacheManager->InsertVkPipeline(mKeyHash, mKey, mVkPipeline, mVkPipelineLayout);
+        mVkContext->perfCounters->Add(PERF_COUNTER_PIPELINES_LINKED);
+        return true;
+    }
 
-    VkResult err = vkCreateGraphicsPipelines(mVkContext->vkDevice, mVkPipelineCache, 1, &mVkPipelineInfo, nullptr, &mVkPipeline);
+    VkResult err = vkCreateGraphicsPipelines(mVkContext->vkDevice, mVkPipelineCache, 1, &mVkPipelineInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &mVkPipeline);
     assert(!err);
-    
-    mUpdateState.Pipeline = false;
 
-    return (err == VK_SUCCESS);
+    if(err != VK_SUCCESS) {
+        mVkPipeline = VK_NULL_HANDLE;
+        return false;
+    }
+
+    mCacheManager->InsertVkPipeline(mKeyHash, mKey, mVkPipeline, mVkPipelineLayout);
+    mVkContext->perfCounters->Add(PERF_COUNTER_PIPELINES_CREATED);
+
+    return true;
 }
 
 }
@@ -25,8 +25,18 @@
 #define __VKPIPELINE_H__
 
 #include "context.h"
+#include "renderPass.h"
 #include "utils/cacheManager.h"
 
+/// Headers that know about extended dynamic state no longer define the core range
+#ifndef VK_DYNAMIC_STATE_RANGE_SIZE
+#   define VK_DYNAMIC_STATE_RANGE_SIZE                  (VK_DYNAMIC_STATE_STENCIL_REFERENCE - VK_DYNAMIC_STATE_VIEWPORT + 1)
+#endif
+
+/// Number of VK_EXT_extended_dynamic_state states driven by the pipeline
+#define GLOVE_MAX_EXTENDED_DYNAMIC_STATES               7
+#define GLOVE_MAX_DYNAMIC_STATES                        (VK_DYNAMIC_STATE_RANGE_SIZE + GLOVE_MAX_EXTENDED_DYNAMIC_STATES)
+
 namespace vulkanAPI {
 
 class Pipeline {
@@ -35,14 +45,27 @@ private:
     const
     vkContext_t *                               mVkContext;
 
+    /// what every draw reads, kept together ahead of the create infos that only building a pipeline touches
+    VkPipeline                                  mVkPipeline;
+    struct {
+    VkBool32                                    Pipeline;
+    VkBool32                                    VertexAttribVBOs;
+    VkBool32                                    IndexBuffer;
+    VkBool32                                    Viewport;
+    }                                           mUpdateState;
+    /// a bit per core dynamic state the pipeline is created with
+    uint32_t                                    mEnabledDynamicStates;
+    bool                                        mExtendedDynamicState;
     VkViewport                                  mVkViewport;
     VkRect2D                                    mVkScissorRect;
-    VkPipeline                                  mVkPipeline;
+
     VkPipelineLayout                            mVkPipelineLayout;
     VkPipelineCache                             mVkPipelineCache;
 
     VkGraphicsPipelineCreateInfo                mVkPipelineInfo;
     VkPipelineInputAssemblyStateCreateInfo      mVkPipelineInputAssemblyState;
+    /// restart as enabled by GL, which Vulkan applies to strips and fans only
+    VkBool32                                    mPrimitiveRestartEnable;
 
     VkPipelineColorBlendStateCreateInfo         mVkPipelineColorBlendState;
     VkPipelineColorBlendAttachmentState         mVkPipelineColorBlendAttachmentState;
@@ -52,27 +75,44 @@ private:
     VkPipelineVertexInputStateCreateInfo       *mVkPipelineVertexInputState;
     VkPipelineMultisampleStateCreateInfo        mVkPipelineMultisampleState;
 
-    std::vector<bool>                           mEnabledDynamicStatesList;
-    VkDynamicState                              mVkPipelineDynamicStateEnables[VK_DYNAMIC_STATE_RANGE_SIZE];
+    VkDynamicState                              mVkPipelineDynamicStateEnables[GLOVE_MAX_DYNAMIC_STATES];
     VkPipelineDynamicStateCreateInfo            mVkPipelineDynamicState;
+#ifdef VK_KHR_dynamic_rendering
+    /// the attachment formats pipelines are created against when passes are begun without render pass objects
+    VkPipelineRenderingCreateInfoKHR            mVkPipelineRenderingInfo;
+    VkFormat                                    mVkPipelineRenderingColorFormat;
+#endif // VK_KHR_dynamic_rendering
 
     int                                         mVkPipelineShaderStageIDs[2];
     uint32_t                                    mVkPipelineShaderStageCount;
     VkPipelineShaderStageCreateInfo             mVkPipelineShaderStages[2];
 
-    struct {
-    VkBool32                                    Pipeline;
-    VkBool32                                    VertexAttribVBOs;
-    VkBool32                                    IndexBuffer;
-    VkBool32                                    Viewport;
-    }                                           mUpdateState;
-
     CacheManager                               *mCacheManager;
 
+    std::vector<uint32_t>                       mKey;
+    /// the state each part of the pipeline depends on, mKey is all of them in a row
+    std::vector<uint32_t>                       mPartKeys[PipelineLibrary::PART_COUNT];
+    uint64_t                                    mKeyHash;
+    uint64_t                                    mProgramHash;
+
     bool                                        CreateGraphicsPipeline(void);
-    void                                        MoveToCache(void);
+    void                                        ComputeKey(const RenderPass *renderPass);
+    void                                        RecordState(const RenderPass *renderPass) const;
+    void                                        MaskDynamicState(VkPipelineInputAssemblyStateCreateInfo *inputAssembly,
+                                                                 VkPipelineRasterizationStateCreateInfo *rasterization,
+                                                                 VkPipelineColorBlendStateCreateInfo    *colorBlend,
+                                                                 VkPipelineDepthStencilStateCreateInfo  *depthStencil) const;
+
+    inline bool IsDynamicState(VkDynamicState state)                      const { FUN_ENTRY(GL_LOG_TRACE); return state < VK_DYNAMIC_STATE_RANGE_SIZE && (mEnabledDynamicStates & (1u << state)); }
+    static inline VkPrimitiveTopology GetTopologyClass(VkPrimitiveTopology topology)  { FUN_ENTRY(GL_LOG_TRACE); return topology == VK_PRIMITIVE_TOPOLOGY_POINT_LIST ? VK_PRIMITIVE_TOPOLOGY_POINT_LIST :
+                                                                                                           (topology == VK_PRIMITIVE_TOPOLOGY_LINE_LIST || topology == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP) ? VK_PRIMITIVE_TOPOLOGY_LINE_LIST :
+                                                                                                           VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; }
+    inline void UpdateInputAssemblyPrimitiveRestart(void)                       { FUN_ENTRY(GL_LOG_TRACE); VkPrimitiveTopology topology = mVkPipelineInputAssemblyState.topology;
+                                                                                                           VkBool32 enable = mPrimitiveRestartEnable && (topology == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP || topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP || topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN);
+                                                                                                           mUpdateState.Pipeline |= (mVkPipelineInputAssemblyState.primitiveRestartEnable != enable);
+                                                                                                           mVkPipelineInputAssemblyState.primitiveRestartEnable = enable; }
     void                                        Release(void);
-    void                                        SetInfo(const VkRenderPass *renderpass);
+    void                                        SetInfo(const RenderPass *renderPass);
 
 public:
 // Constructor
@@ -85,6 +125,10 @@ public:
     inline int      * GetShaderStageIDsRef(void)                                { FUN_ENTRY(GL_LOG_TRACE); return mVkPipelineShaderStageIDs; }
     inline uint32_t & GetShaderStageCountRef(void)                              { FUN_ENTRY(GL_LOG_TRACE); return mVkPipelineShaderStageCount; }
     inline VkPipelineShaderStageCreateInfo * GetShaderStages(void)              { FUN_ENTRY(GL_LOG_TRACE); return mVkPipelineShaderStages; }
+    inline VkPipeline GetVkPipeline(void)                                 const { FUN_ENTRY(GL_LOG_TRACE); return mVkPipeline; }
+    inline uint64_t   GetKeyHash(void)                                    const { FUN_ENTRY(GL_LOG_TRACE); return mKeyHash; }
+           void       GetStateRecord(VkFormat colorFormat, VkFormat depthStencilFormat, VkBool32 colorFetch,
+                                     PipelineWarmer::StateRecord_t *record) const;
 
     inline bool GetUpdatePipelineState(void)                              const { FUN_ENTRY(GL_LOG_TRACE); return mUpdateState.Pipeline; }
     inline bool GetUpdateViewportState(void)                              const { FUN_ENTRY(GL_LOG_TRACE); return mUpdateState.Viewport; }
@@ -97,61 +141,69 @@ public:
     inline void SetUpdateViewportState(VkBool32 enable)                         { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Viewport         = enable; }
     inline void SetUpdatePipeline(VkBool32 enable)                              { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline         = enable; }
 
-    inline void SetInputAssemblyTopology(VkPrimitiveTopology topology)          { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineInputAssemblyState.topology            = topology; mUpdateState.Pipeline = true;}
-    inline void SetMultisampleAlphaToCoverage(VkBool32 enable)                  { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineMultisampleState.alphaToCoverageEnable = enable;   mUpdateState.Pipeline = true; }
+    inline void SetInputAssemblyTopology(VkPrimitiveTopology topology)          { FUN_ENTRY(GL_LOG_TRACE); if(topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN && !mVkContext->mIsTriangleFanSupported) { topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; }
+                                                                                                           mUpdateState.Pipeline |= !mExtendedDynamicState || GetTopologyClass(topology) != GetTopologyClass(mVkPipelineInputAssemblyState.topology);
+                                                                                                           mVkPipelineInputAssemblyState.topology            = topology;
+                                                                                                           UpdateInputAssemblyPrimitiveRestart(); }
+    inline void SetInputAssemblyPrimitiveRestartEnable(VkBool32 enable)         { FUN_ENTRY(GL_LOG_TRACE); mPrimitiveRestartEnable = enable; UpdateInputAssemblyPrimitiveRestart(); }
+    inline void SetMultisampleAlphaToCoverage(VkBool32 enable)                  { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineMultisampleState.alphaToCoverageEnable != enable); mVkPipelineMultisampleState.alphaToCoverageEnable = enable; }
+    inline void SetMultisampleRasterizationSamples(VkSampleCountFlagBits samples) { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineMultisampleState.rasterizationSamples != samples); mVkPipelineMultisampleState.rasterizationSamples = samples; }
 
-    inline void SetRasterizationPolygonMode(VkPolygonMode mode)                 { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.polygonMode = mode; mUpdateState.Pipeline = true;}
+    inline void SetRasterizationPolygonMode(VkPolygonMode mode)                 { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.polygonMode != mode); mVkPipelineRasterizationState.polygonMode = mode; }
     inline void SetRasterizationCullMode(VkBool32 enable,
-                                         VkCullModeFlagBits mode)               { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.cullMode  = enable ? mode : VK_CULL_MODE_NONE; mUpdateState.Pipeline = true;}
-    inline void SetRasterizationFrontFace(VkFrontFace face)                     { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.frontFace = face; mUpdateState.Pipeline = true;}
+                                         VkCullModeFlagBits mode)               { FUN_ENTRY(GL_LOG_TRACE); VkCullModeFlags cullMode = enable ? mode : VK_CULL_MODE_NONE;
+                                                                                                           mUpdateState.Pipeline |= (mVkPipelineRasterizationState.cullMode != cullMode && !mExtendedDynamicState); mVkPipelineRasterizationState.cullMode = cullMode; }
+    inline void SetRasterizationFrontFace(VkFrontFace face)                     { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.frontFace != face && !mExtendedDynamicState); mVkPipelineRasterizationState.frontFace = face; }
 
-    inline void SetRasterizationDepthBiasEnable(VkBool32 enable)                { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.depthBiasEnable         = enable; mUpdateState.Pipeline = true;}
-    inline void SetRasterizationDepthBiasConstantFactor(float factor)           { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.depthBiasConstantFactor = factor; mUpdateState.Pipeline = true;}
-    inline void SetRasterizationDepthBiasSlopeFactor(float factor)              { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.depthBiasSlopeFactor    = factor; mUpdateState.Pipeline = true;}
-    inline void SetRasterizationLineWidth(float lineWidth)                      { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineRasterizationState.lineWidth = lineWidth; mUpdateState.Pipeline = true;}
+    inline void SetRasterizationDepthBiasEnable(VkBool32 enable)                { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.depthBiasEnable != enable); mVkPipelineRasterizationState.depthBiasEnable         = enable; }
+    inline void SetRasterizationRasterizerDiscardEnable(VkBool32 enable)        { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.rasterizerDiscardEnable != enable); mVkPipelineRasterizationState.rasterizerDiscardEnable = enable; }
+    inline void SetRasterizationDepthBiasConstantFactor(float factor)           { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.depthBiasConstantFactor != factor && !IsDynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS)); mVkPipelineRasterizationState.depthBiasConstantFactor = factor; }
+    inline void SetRasterizationDepthBiasSlopeFactor(float factor)              { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.depthBiasSlopeFactor != factor && !IsDynamicState(VK_DYNAMIC_STATE_DEPTH_BIAS)); mVkPipelineRasterizationState.depthBiasSlopeFactor    = factor; }
+    inline void SetRasterizationLineWidth(float lineWidth)                      { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineRasterizationState.lineWidth != lineWidth && !IsDynamicState(VK_DYNAMIC_STATE_LINE_WIDTH)); mVkPipelineRasterizationState.lineWidth = lineWidth; }
 
-    inline void SetColorBlendAttachmentEnable(VkBool32 enable)                  { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.blendEnable = enable; mUpdateState.Pipeline = true; }
+    inline void SetColorBlendAttachmentEnable(VkBool32 enable)                  { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.blendEnable != enable); mVkPipelineColorBlendAttachmentState.blendEnable = enable; }
     inline void SetColorBlendConstants(float *color)                            { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendState.blendConstants[0] = color[0];
                                                                                                            mVkPipelineColorBlendState.blendConstants[1] = color[1];
                                                                                                            mVkPipelineColorBlendState.blendConstants[2] = color[2];
-                                                                                                           mVkPipelineColorBlendState.blendConstants[3] = color[3];    mUpdateState.Pipeline = true;}
-    inline void SetColorBlendAttachmentWriteMask(VkColorComponentFlags mask)    { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.colorWriteMask = mask; mUpdateState.Pipeline = true;}
-
-    inline void SetColorBlendAttachmentSrcColorFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.srcColorBlendFactor = factor; mUpdateState.Pipeline = true;}
-    inline void SetColorBlendAttachmentDstColorFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.dstColorBlendFactor = factor; mUpdateState.Pipeline = true;}
-    inline void SetColorBlendAttachmentSrcAlphaFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.srcAlphaBlendFactor = factor; mUpdateState.Pipeline = true;}
-    inline void SetColorBlendAttachmentDstAlphaFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.dstAlphaBlendFactor = factor; mUpdateState.Pipeline = true;}
-
-    inline void SetColorBlendAttachmentColorOp(VkBlendOp op)                    { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.colorBlendOp = op; mUpdateState.Pipeline = true;}
-    inline void SetColorBlendAttachmentAlphaOp(VkBlendOp op)                    { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineColorBlendAttachmentState.alphaBlendOp = op; mUpdateState.Pipeline = true;}
-
-    inline void SetDepthTestEnable(VkBool32 enable)                             { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.depthTestEnable        = enable; mUpdateState.Pipeline = true;}
-    inline void SetDepthWriteEnable(VkBool32 enable)                            { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.depthWriteEnable       = enable; mUpdateState.Pipeline = true;}
-    inline void SetDepthCompareOp(VkCompareOp op)                               { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.depthCompareOp         = op;     mUpdateState.Pipeline = true;}
-    inline void SetDepthBoundsTestEnable(VkBool32 enable)                       { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.depthBoundsTestEnable  = enable; mUpdateState.Pipeline = true;}
-    inline void SetMinDepthBounds(float depth)                                  { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.minDepthBounds         = depth;  mUpdateState.Pipeline = true;}
-    inline void SetMaxDepthBounds(float depth)                                  { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.maxDepthBounds         = depth;  mUpdateState.Pipeline = true;}
-
-    inline void SetStencilTestEnable(VkBool32 enable)                           { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.stencilTestEnable      = enable; mUpdateState.Pipeline = true;}
-
-    inline void SetStencilBackFailOp(VkStencilOp op)                            { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.failOp      = op;     mUpdateState.Pipeline = true;}
-    inline void SetStencilBackPassOp(VkStencilOp op)                            { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.passOp      = op;     mUpdateState.Pipeline = true;}
-    inline void SetStencilBackZFailOp(VkStencilOp op)                           { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.depthFailOp = op;     mUpdateState.Pipeline = true;}
-    inline void SetStencilBackWriteMask(uint32_t mask)                          { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.writeMask   = mask;   mUpdateState.Pipeline = true;}
-    inline void SetStencilBackCompareOp(VkCompareOp op)                         { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.compareOp   = op;     mUpdateState.Pipeline = true;}
-    inline void SetStencilBackCompareMask(uint32_t mask)                        { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.compareMask = mask;   mUpdateState.Pipeline = true;}
-    inline void SetStencilBackReference(uint32_t ref)                           { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.back.reference   = ref;    mUpdateState.Pipeline = true;}
-
-    inline void SetStencilFrontFailOp(VkStencilOp op)                           { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.failOp      = op;    mUpdateState.Pipeline = true;}
-    inline void SetStencilFrontPassOp(VkStencilOp op)                           { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.passOp      = op;    mUpdateState.Pipeline = true;}
-    inline void SetStencilFrontZFailOp(VkStencilOp op)                          { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.depthFailOp = op;    mUpdateState.Pipeline = true;}
-    inline void SetStencilFrontWriteMask(uint32_t mask)                         { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.writeMask   = mask;  mUpdateState.Pipeline = true;}
-    inline void SetStencilFrontCompareOp(VkCompareOp op)                        { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.compareOp   = op;    mUpdateState.Pipeline = true;}
-    inline void SetStencilFrontCompareMask(uint32_t mask)                       { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.compareMask = mask;  mUpdateState.Pipeline = true;}
-    inline void SetStencilFrontReference(uint32_t ref)                          { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineDepthStencilState.front.reference   = ref;   mUpdateState.Pipeline = true;}
+                                                                                                           mVkPipelineColorBlendState.blendConstants[3] = color[3];    mUpdateState.Pipeline |= !IsDynamicState(VK_DYNAMIC_STATE_BLEND_CONSTANTS);}
+    inline void SetColorBlendAttachmentWriteMask(VkColorComponentFlags mask)    { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.colorWriteMask != mask); mVkPipelineColorBlendAttachmentState.colorWriteMask = mask; }
+
+    inline void SetColorBlendAttachmentSrcColorFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.srcColorBlendFactor != factor); mVkPipelineColorBlendAttachmentState.srcColorBlendFactor = factor; }
+    inline void SetColorBlendAttachmentDstColorFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.dstColorBlendFactor != factor); mVkPipelineColorBlendAttachmentState.dstColorBlendFactor = factor; }
+    inline void SetColorBlendAttachmentSrcAlphaFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.srcAlphaBlendFactor != factor); mVkPipelineColorBlendAttachmentState.srcAlphaBlendFactor = factor; }
+    inline void SetColorBlendAttachmentDstAlphaFactor(VkBlendFactor factor)     { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.dstAlphaBlendFactor != factor); mVkPipelineColorBlendAttachmentState.dstAlphaBlendFactor = factor; }
+
+    inline void SetColorBlendAttachmentColorOp(VkBlendOp op)                    { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.colorBlendOp != op); mVkPipelineColorBlendAttachmentState.colorBlendOp = op; }
+    inline void SetColorBlendAttachmentAlphaOp(VkBlendOp op)                    { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineColorBlendAttachmentState.alphaBlendOp != op); mVkPipelineColorBlendAttachmentState.alphaBlendOp = op; }
+
+    inline void SetDepthTestEnable(VkBool32 enable)                             { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.depthTestEnable != enable && !mExtendedDynamicState); mVkPipelineDepthStencilState.depthTestEnable        = enable; }
+    inline void SetDepthWriteEnable(VkBool32 enable)                            { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.depthWriteEnable != enable && !mExtendedDynamicState); mVkPipelineDepthStencilState.depthWriteEnable       = enable; }
+    inline void SetDepthCompareOp(VkCompareOp op)                               { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.depthCompareOp != op && !mExtendedDynamicState); mVkPipelineDepthStencilState.depthCompareOp         = op; }
+    inline void SetDepthBoundsTestEnable(VkBool32 enable)                       { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.depthBoundsTestEnable != enable); mVkPipelineDepthStencilState.depthBoundsTestEnable  = enable; }
+    inline void SetMinDepthBounds(float depth)                                  { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.minDepthBounds != depth); mVkPipelineDepthStencilState.minDepthBounds         = depth; }
+    inline void SetMaxDepthBounds(float depth)                                  { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.maxDepthBounds != depth); mVkPipelineDepthStencilState.maxDepthBounds         = depth; }
+
+    inline void SetStencilTestEnable(VkBool32 enable)                           { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.stencilTestEnable != enable); mVkPipelineDepthStencilState.stencilTestEnable      = enable; }
+
+    inline void SetStencilBackFailOp(VkStencilOp op)                            { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.failOp != op); mVkPipelineDepthStencilState.back.failOp      = op; }
+    inline void SetStencilBackPassOp(VkStencilOp op)                            { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.passOp != op); mVkPipelineDepthStencilState.back.passOp      = op; }
+    inline void SetStencilBackZFailOp(VkStencilOp op)                           { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.depthFailOp != op); mVkPipelineDepthStencilState.back.depthFailOp = op; }
+    inline void SetStencilBackWriteMask(uint32_t mask)                          { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.writeMask != mask && !IsDynamicState(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK)); mVkPipelineDepthStencilState.back.writeMask   = mask; }
+    inline void SetStencilBackCompareOp(VkCompareOp op)                         { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.compareOp != op); mVkPipelineDepthStencilState.back.compareOp   = op; }
+    inline void SetStencilBackCompareMask(uint32_t mask)                        { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.compareMask != mask && !IsDynamicState(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK)); mVkPipelineDepthStencilState.back.compareMask = mask; }
+    inline void SetStencilBackReference(uint32_t ref)                           { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.back.reference != ref && !IsDynamicState(VK_DYNAMIC_STATE_STENCIL_REFERENCE)); mVkPipelineDepthStencilState.back.reference   = ref; }
+
+    inline void SetStencilFrontFailOp(VkStencilOp op)                           { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.failOp != op); mVkPipelineDepthStencilState.front.failOp      = op; }
+    inline void SetStencilFrontPassOp(VkStencilOp op)                           { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.passOp != op); mVkPipelineDepthStencilState.front.passOp      = op; }
+    inline void SetStencilFrontZFailOp(VkStencilOp op)                          { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.depthFailOp != op); mVkPipelineDepthStencilState.front.depthFailOp = op; }
+    inline void SetStencilFrontWriteMask(uint32_t mask)                         { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.writeMask != mask && !IsDynamicState(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK)); mVkPipelineDepthStencilState.front.writeMask   = mask; }
+    inline void SetStencilFrontCompareOp(VkCompareOp op)                        { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.compareOp != op); mVkPipelineDepthStencilState.front.compareOp   = op; }
+    inline void SetStencilFrontCompareMask(uint32_t mask)                       { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.compareMask != mask && !IsDynamicState(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK)); mVkPipelineDepthStencilState.front.compareMask = mask; }
+    inline void SetStencilFrontReference(uint32_t ref)                          { FUN_ENTRY(GL_LOG_TRACE); mUpdateState.Pipeline |= (mVkPipelineDepthStencilState.front.reference != ref && !IsDynamicState(VK_DYNAMIC_STATE_STENCIL_REFERENCE)); mVkPipelineDepthStencilState.front.reference   = ref; }
 
     inline void SetCache(VkPipelineCache cache)                                 { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineCache            = cache; }
     inline void SetLayout(VkPipelineLayout layout)                              { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineLayout           = layout; }
+    inline void SetProgramHash(uint64_t hash)                                   { FUN_ENTRY(GL_LOG_TRACE); mProgramHash                = hash; }
     inline void SetVertexInputState(
                             VkPipelineVertexInputStateCreateInfo *vertexInput)  { FUN_ENTRY(GL_LOG_TRACE); mVkPipelineVertexInputState = vertexInput; }
     inline void SetCacheManager(CacheManager *cacheManager)                     { FUN_ENTRY(GL_LOG_TRACE); mCacheManager = cacheManager; }
@@ -177,14 +229,14 @@ public:
           void CreateMultisampleState(VkBool32 alphaToOneEnable, VkBool32 alphaToCoverageEnable, VkSampleCountFlagBits rasterizationSamples, VkBool32 sampleShadingEnable, float minSampleShading);
 
 // Compute Functions
-          void ComputeViewport(int fboWidth, int fboHeight, int viewportX, int viewportY, int viewportW, int viewportH, float minDepth, float maxDepth);
-          void ComputeScissor(int fboWidth, int fboHeight, int scissorX, int scissorY, int scissorW, int scissorH);
+          void ComputeViewport(int fboWidth, int fboHeight, int viewportX, int viewportY, int viewportW, int viewportH, float minDepth, float maxDepth, bool invertY);
+          void ComputeScissor(int fboWidth, int fboHeight, int scissorX, int scissorY, int scissorW, int scissorH, bool invertY);
 
 // Bind Functions
           void Bind(const VkCommandBuffer *CmdBuffer) const;
 
 // Create Functions
-          bool Create(const VkRenderPass *renderpass);
+          bool Create(const RenderPass *renderPass);
 // Update Functions
           void UpdateDynamicState(const VkCommandBuffer *CmdBuffer, float lineWidth) const;
 };
@@ -23,6 +23,7 @@
  */
 
 #include "pipelineCache.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
@@ -45,7 +46,7 @@ PipelineCache::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkPipelineCache != VK_NULL_HANDLE) {
-        vkDestroyPipelineCache(mVkContext->vkDevice, mVkPipelineCache, nullptr);
+        vkDestroyPipelineCache(mVkContext->vkDevice, mVkPipelineCache, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
         mVkPipelineCache = VK_NULL_HANDLE;
     }
 }
@@ -59,6 +60,21 @@ PipelineCache::GetData(void* data, size_t* size) const
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
 }
 
+bool
+PipelineCache::MergeInto(VkPipelineCache dstCache) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkPipelineCache == VK_NULL_HANDLE || dstCache == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    VkResult err = vkMergePipelineCaches(mVkContext->vkDevice, dstCache, 1, &mVkPipelineCache);
+    assert(!err);
+
+    return (err == VK_SUCCESS);
+}
+
 bool
 PipelineCache::Create(const void *data, size_t size)
 {
@@ -73,7 +89,7 @@ PipelineCache::Create(const void *data, size_t size)
     info.pInitialData    = data;
     info.initialDataSize = size;
 
-    VkResult err = vkCreatePipelineCache(mVkContext->vkDevice, &info, nullptr, &mVkPipelineCache);
+    VkResult err = vkCreatePipelineCache(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &mVkPipelineCache);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -51,7 +51,8 @@ public:
 // Release Functions
     void                              Release(void);
 
-// Release Functions
+// Merge Functions
+           bool                       MergeInto(VkPipelineCache dstCache) const;
 
 // Get Functions
            bool                       GetData(void* data, size_t* size)   const;
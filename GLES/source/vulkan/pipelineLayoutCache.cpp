@@ -0,0 +1,168 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineLayoutCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Shared, Reference Counted Descriptor Set And Pipeline Layouts
+ *
+ *  @section
+ *
+ *  Programs of an application mostly differ in their code, not in the
+ *  blocks and samplers they bind, so most of them end up with the same
+ *  descriptor set layout. Layouts are looked up by their bindings and push
+ *  constant range and shared between the programs with the same ones, which
+ *  keeps their pipeline layouts identical, hence compatible. Like samplers,
+ *  a layout that is no longer referenced stays in the cache, so that its
+ *  handle is never reused for another layout while pipelines cached with it
+ *  still exist; all layouts are destroyed with the cache.
+ *
+ */
+
+#include <algorithm>
+#include "pipelineLayoutCache.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+PipelineLayoutCache::PipelineLayoutCache(const vkContext_t *vkContext)
+: mVkContext(vkContext)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+PipelineLayoutCache::~PipelineLayoutCache()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto &entry : mLayouts) {
+        vkDestroyPipelineLayout(mVkContext->vkDevice, entry.second.pipelineLayout, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        vkDestroyDescriptorSetLayout(mVkContext->vkDevice, entry.second.descriptorSetLayout, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+    }
+    mLayouts.clear();
+}
+
+PipelineLayoutCache::Key_t
+PipelineLayoutCache::GetKey(const VkDescriptorSetLayoutBinding *bindings, uint32_t bindingCount, const VkPushConstantRange *pushConstantRange,
+                            VkDescriptorSetLayout bindlessSetLayout)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    std::vector<const VkDescriptorSetLayoutBinding *> sorted(bindingCount);
+    for(uint32_t i = 0; i < bindingCount; ++i) {
+        sorted[i] = &bindings[i];
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const VkDescriptorSetLayoutBinding *a, const VkDescriptorSetLayoutBinding *b) {
+        return a->binding < b->binding;
+    });
+
+    Key_t key;
+    key.reserve(4 * bindingCount + 4);
+    for(const auto *binding : sorted) {
+        key.push_back(binding->binding);
+        key.push_back(static_cast<uint32_t>(binding->descriptorType));
+        key.push_back(binding->descriptorCount);
+        key.push_back(static_cast<uint32_t>(binding->stageFlags));
+    }
+
+    // no range at all is told apart by its empty stages
+    key.push_back(pushConstantRange ? static_cast<uint32_t>(pushConstantRange->stageFlags) : 0);
+    key.push_back(pushConstantRange ? pushConstantRange->offset : 0);
+    key.push_back(pushConstantRange ? pushConstantRange->size   : 0);
+
+    // there is a single layout of the texture table for the device
+    key.push_back(bindlessSetLayout != VK_NULL_HANDLE);
+
+    return key;
+}
+
+bool
+PipelineLayoutCache::Acquire(const VkDescriptorSetLayoutBinding *bindings, uint32_t bindingCount, const VkPushConstantRange *pushConstantRange,
+                             VkDescriptorSetLayout bindlessSetLayout, VkDescriptorSetLayout *descriptorSetLayout, VkPipelineLayout *pipelineLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const Key_t key = GetKey(bindings, bindingCount, pushConstantRange, bindlessSetLayout);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mLayouts.find(key);
+    if(it != mLayouts.end()) {
+        ++it->second.refCount;
+        *descriptorSetLayout = it->second.descriptorSetLayout;
+        *pipelineLayout      = it->second.pipelineLayout;
+        return true;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descLayoutInfo;
+    descLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descLayoutInfo.pNext        = nullptr;
+    descLayoutInfo.flags        = 0;
+    descLayoutInfo.bindingCount = bindingCount;
+    descLayoutInfo.pBindings    = bindings;
+
+    Entry_t entry;
+    if(vkCreateDescriptorSetLayout(mVkContext->vkDevice, &descLayoutInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS), &entry.descriptorSetLayout) != VK_SUCCESS) {
+        assert(0);
+        return false;
+    }
+
+    // the texture table follows the set of the program
+    const VkDescriptorSetLayout setLayouts[2] = { entry.descriptorSetLayout, bindlessSetLayout };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+    pipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.pNext                  = nullptr;
+    pipelineLayoutCreateInfo.flags                  = 0;
+    pipelineLayoutCreateInfo.setLayoutCount         = bindlessSetLayout != VK_NULL_HANDLE ? 2 : 1;
+    pipelineLayoutCreateInfo.pSetLayouts            = setLayouts;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = pushConstantRange ? 1 : 0;
+    pipelineLayoutCreateInfo.pPushConstantRanges    = pushConstantRange;
+
+    if(vkCreatePipelineLayout(mVkContext->vkDevice, &pipelineLayoutCreateInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &entry.pipelineLayout) != VK_SUCCESS) {
+        assert(0);
+        vkDestroyDescriptorSetLayout(mVkContext->vkDevice, entry.descriptorSetLayout, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DESCRIPTORS));
+        return false;
+    }
+
+    entry.refCount = 1;
+    mLayouts.insert(std::make_pair(key, entry));
+
+    *descriptorSetLayout = entry.descriptorSetLayout;
+    *pipelineLayout      = entry.pipelineLayout;
+
+    return true;
+}
+
+uint32_t
+PipelineLayoutCache::Release(VkPipelineLayout pipelineLayout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // few distinct layouts exist, so a linear search is cheaper than a second map
+    for(auto &entry : mLayouts) {
+        if(entry.second.pipelineLayout == pipelineLayout) {
+            assert(entry.second.refCount);
+            return --entry.second.refCount;
+        }
+    }
+
+    return 0;
+}
+
+}
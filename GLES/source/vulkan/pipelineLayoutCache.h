@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineLayoutCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Shared, Reference Counted Descriptor Set And Pipeline Layouts
+ *
+ */
+
+#ifndef __VKPIPELINELAYOUTCACHE_H__
+#define __VKPIPELINELAYOUTCACHE_H__
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "context.h"
+
+namespace vulkanAPI {
+
+class PipelineLayoutCache final {
+private:
+    /// the bindings in increasing binding order, then the push constant range and the set of textures indexed per draw
+    typedef std::vector<uint32_t>           Key_t;
+
+    typedef struct Entry_t {
+        VkDescriptorSetLayout              descriptorSetLayout;
+        VkPipelineLayout                   pipelineLayout;
+        uint32_t                           refCount;
+    } Entry_t;
+
+    const vkContext_t                      *mVkContext;
+
+    std::mutex                              mMutex;
+    std::map<Key_t, Entry_t>                mLayouts;
+
+    static Key_t                            GetKey(const VkDescriptorSetLayoutBinding *bindings, uint32_t bindingCount,
+                                                   const VkPushConstantRange *pushConstantRange, VkDescriptorSetLayout bindlessSetLayout);
+
+public:
+// Constructor
+    PipelineLayoutCache(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~PipelineLayoutCache();
+
+// Acquire/Release Functions
+    bool                                    Acquire(const VkDescriptorSetLayoutBinding *bindings, uint32_t bindingCount,
+                                                    const VkPushConstantRange *pushConstantRange, VkDescriptorSetLayout bindlessSetLayout,
+                                                    VkDescriptorSetLayout *descriptorSetLayout, VkPipelineLayout *pipelineLayout);
+    uint32_t                                Release(VkPipelineLayout pipelineLayout);
+
+// Get Functions
+    inline uint32_t                         GetLayoutCount(void)              const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mLayouts.size()); }
+};
+
+}
+
+#endif // __VKPIPELINELAYOUTCACHE_H__
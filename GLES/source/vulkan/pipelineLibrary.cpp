@@ -0,0 +1,355 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineLibrary.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Graphics Pipelines Linked From Separately Compiled Parts (VK_EXT_graphics_pipeline_library)
+ *
+ *  @section
+ *
+ *  A state change that no cached pipeline matches costs a full compilation on
+ *  the render thread, even though most of the state it compiles has been seen
+ *  before. The vertex input, pre-rasterization, fragment shader and fragment
+ *  output parts of the pipeline are compiled into libraries of their own and
+ *  cached by the state each one depends on, so that a new combination of them
+ *  is only linked, which is fast. The linked pipeline is then optimized across
+ *  its parts by a speculative job, and the cache manager replaces it once done.
+ *
+ */
+
+#include "pipelineLibrary.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+PipelineLibrary::PipelineLibrary(const vkContext_t *vkContext)
+: mVkContext(vkContext), mWorkerJobs(0), mStarted(false), mStopping(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+PipelineLibrary::~PipelineLibrary()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    StopWorkerJobs();
+
+    for(auto &optimized : mOptimized) {
+        vkDestroyPipeline(mVkContext->vkDevice, optimized.optimized, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+    }
+    mOptimized.clear();
+
+    for(uint32_t part = 0; part < PART_COUNT; ++part) {
+        for(auto &library : mLibraries[part]) {
+            vkDestroyPipeline(mVkContext->vkDevice, library.second.pipeline, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        }
+        mLibraries[part].clear();
+    }
+}
+
+uint64_t
+PipelineLibrary::HashKey(Part_t part, const std::vector<uint32_t> &key)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // FNV-1a
+    uint64_t hash = (0xcbf29ce484222325ULL ^ static_cast<uint32_t>(part)) * 0x100000001b3ULL;
+    for(uint32_t word : key) {
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+VkPipeline
+PipelineLibrary::CreateLibrary(Part_t part, const VkGraphicsPipelineCreateInfo &info, VkPipelineCache cache) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_EXT_graphics_pipeline_library
+    static const VkGraphicsPipelineLibraryFlagsEXT partFlags[PART_COUNT] = {
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+    };
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo;
+    libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    libraryInfo.pNext = info.pNext;
+    libraryInfo.flags = partFlags[part];
+
+    VkGraphicsPipelineCreateInfo partInfo = info;
+    partInfo.pNext = &libraryInfo;
+    partInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+    // each shader stage belongs to the part that runs it, and to that part only
+    VkShaderStageFlagBits stage = (part == PART_PRE_RASTERIZATION) ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+    partInfo.stageCount = 0;
+    partInfo.pStages    = nullptr;
+    if(part == PART_PRE_RASTERIZATION || part == PART_FRAGMENT_SHADER) {
+        for(uint32_t i = 0; i < info.stageCount; ++i) {
+            if(info.pStages[i].stage == stage) {
+                partInfo.stageCount = 1;
+                partInfo.pStages    = &info.pStages[i];
+            }
+        }
+    }
+
+    // programs without attributes still need a vertex input state to compile against
+    VkPipelineVertexInputStateCreateInfo vertexInput;
+    memset(static_cast<void *>(&vertexInput), 0, sizeof(vertexInput));
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    if(partInfo.pVertexInputState == nullptr) {
+        partInfo.pVertexInputState = &vertexInput;
+    }
+
+    VkPipeline library = VK_NULL_HANDLE;
+    if(vkCreateGraphicsPipelines(mVkContext->vkDevice, cache, 1, &partInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &library) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+
+    return library;
+#else
+    return VK_NULL_HANDLE;
+#endif // VK_EXT_graphics_pipeline_library
+}
+
+VkPipeline
+PipelineLibrary::GetLibrary(Part_t part, const std::vector<uint32_t> &key, const VkGraphicsPipelineCreateInfo &info, VkPipelineCache cache)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    uint64_t hash = HashKey(part, key);
+    auto it = mLibraries[part].find(hash);
+    if(it != mLibraries[part].end()) {
+        return (it->second.key == key) ? it->second.pipeline : VK_NULL_HANDLE;
+    }
+
+    // libraries are only released along with their layout, past the limit pipelines are compiled whole
+    if(mLibraries[part].size() >= GLOVE_MAX_PIPELINE_LIBRARIES) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkPipeline pipeline = CreateLibrary(part, info, cache);
+    if(pipeline == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    Library_t &library = mLibraries[part][hash];
+    library.key      = key;
+    library.pipeline = pipeline;
+    library.layout   = info.layout;
+
+    return pipeline;
+}
+
+VkPipeline
+PipelineLibrary::LinkLibraries(const VkPipeline *libraries, VkPipelineLayout layout, VkPipelineCache cache, bool optimize) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_EXT_graphics_pipeline_library
+    VkPipelineLibraryCreateInfoKHR libraryInfo;
+    libraryInfo.sType        = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryInfo.pNext        = nullptr;
+    libraryInfo.libraryCount = PART_COUNT;
+    libraryInfo.pLibraries   = libraries;
+
+    VkGraphicsPipelineCreateInfo info;
+    memset(static_cast<void *>(&info), 0, sizeof(info));
+    info.sType  = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    info.pNext  = &libraryInfo;
+    info.flags  = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    info.layout = layout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if(vkCreateGraphicsPipelines(mVkContext->vkDevice, cache, 1, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &pipeline) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+#else
+    return VK_NULL_HANDLE;
+#endif // VK_EXT_graphics_pipeline_library
+}
+
+VkPipeline
+PipelineLibrary::Link(const VkGraphicsPipelineCreateInfo &info, VkPipelineCache cache, uint64_t hash, const std::vector<uint32_t> *keys)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsEnabled()) {
+        return VK_NULL_HANDLE;
+    }
+
+    Job_t job;
+    for(uint32_t part = 0; part < PART_COUNT; ++part) {
+        job.libraries[part] = GetLibrary(static_cast<Part_t>(part), keys[part], info, cache);
+        if(job.libraries[part] == VK_NULL_HANDLE) {
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    job.linked = LinkLibraries(job.libraries, info.layout, cache, false);
+    if(job.linked == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    job.hash   = hash;
+    job.layout = info.layout;
+    job.cache  = cache;
+
+    // without worker threads the linked pipeline is kept as it is
+    if(!JobSystem::GetInstance()->GetThreadCount()) {
+        return job.linked;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(!mStopping) {
+            mJobs.push_back(job);
+        }
+    }
+
+    StartWorkerJobs();
+
+    return job.linked;
+}
+
+void
+PipelineLibrary::CollectOptimized(std::vector<Optimized_t> *optimized)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    if(!mStarted) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    optimized->insert(optimized->end(), mOptimized.begin(), mOptimized.end());
+    mOptimized.clear();
+}
+
+void
+PipelineLibrary::Release(VkPipelineLayout layout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // background links still refer to the libraries of the layout
+    if(mStarted) {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        for(auto it = mJobs.begin(); it != mJobs.end();) {
+            it = (it->layout == layout) ? mJobs.erase(it) : std::next(it);
+        }
+
+        mIdleCondition.wait(lock, [this, layout] { return mRunningJobs.find(layout) == mRunningJobs.end(); });
+
+        for(auto it = mOptimized.begin(); it != mOptimized.end();) {
+            if(it->layout == layout) {
+                vkDestroyPipeline(mVkContext->vkDevice, it->optimized, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+                it = mOptimized.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // pipelines linked from the libraries do not need them to stay alive
+    for(uint32_t part = 0; part < PART_COUNT; ++part) {
+        for(auto it = mLibraries[part].begin(); it != mLibraries[part].end();) {
+            if(it->second.layout == layout) {
+                vkDestroyPipeline(mVkContext->vkDevice, it->second.pipeline, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+                it = mLibraries[part].erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void
+PipelineLibrary::StartWorkerJobs(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the jobs leave the job system once nothing is left to link
+    uint32_t jobs = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while(mWorkerJobs + jobs < GLOVE_PIPELINE_LIBRARY_THREADS && jobs < mJobs.size()) {
+            ++jobs;
+        }
+        mWorkerJobs += jobs;
+    }
+
+    mStarted |= jobs > 0;
+    for(uint32_t i = 0; i < jobs; ++i) {
+        JobSystem::GetInstance()->Submit(JOB_PRIORITY_SPECULATIVE, [this] { RunWorkerJob(); });
+    }
+}
+
+void
+PipelineLibrary::StopWorkerJobs(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStopping = true;
+    mJobs.clear();
+
+    mIdleCondition.wait(lock, [this] { return mWorkerJobs == 0; });
+}
+
+void
+PipelineLibrary::RunWorkerJob(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while(!mStopping && !mJobs.empty()) {
+        Job_t job = mJobs.front();
+        mJobs.pop_front();
+        ++mRunningJobs[job.layout];
+
+        lock.unlock();
+        VkPipeline pipeline = LinkLibraries(job.libraries, job.layout, job.cache, true);
+        lock.lock();
+
+        if(pipeline != VK_NULL_HANDLE) {
+            Optimized_t optimized;
+            optimized.hash      = job.hash;
+            optimized.linked    = job.linked;
+            optimized.optimized = pipeline;
+            optimized.layout    = job.layout;
+            mOptimized.push_back(optimized);
+        }
+
+        if(--mRunningJobs[job.layout] == 0) {
+            mRunningJobs.erase(job.layout);
+        }
+        mIdleCondition.notify_all();
+    }
+
+    --mWorkerJobs;
+    mIdleCondition.notify_all();
+}
+
+}
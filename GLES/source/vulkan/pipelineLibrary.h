@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineLibrary.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Graphics Pipelines Linked From Separately Compiled Parts (VK_EXT_graphics_pipeline_library)
+ *
+ */
+
+#ifndef __VKPIPELINELIBRARY_H__
+#define __VKPIPELINELIBRARY_H__
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include "context.h"
+#include "utils/jobSystem.h"
+
+/// Number of jobs of the job system linking optimized pipelines at once
+#define GLOVE_PIPELINE_LIBRARY_THREADS                  1
+
+/// Upper limit of the libraries kept for each part of the pipeline
+#define GLOVE_MAX_PIPELINE_LIBRARIES                    512
+
+namespace vulkanAPI {
+
+class PipelineLibrary final {
+public:
+    /// the parts a graphics pipeline is linked from, each compiled into a library of its own
+    typedef enum {
+        PART_VERTEX_INPUT = 0,
+        PART_PRE_RASTERIZATION,
+        PART_FRAGMENT_SHADER,
+        PART_FRAGMENT_OUTPUT,
+        PART_COUNT
+    } Part_t;
+
+    /// an optimized pipeline linked in the background, to replace the one linked at draw time
+    typedef struct Optimized_t {
+        uint64_t                                        hash;
+        VkPipeline                                      linked;
+        VkPipeline                                      optimized;
+        VkPipelineLayout                                layout;
+    } Optimized_t;
+
+private:
+    typedef struct Library_t {
+        std::vector<uint32_t>                           key;
+        VkPipeline                                      pipeline;
+        VkPipelineLayout                                layout;
+    } Library_t;
+
+    typedef struct Job_t {
+        uint64_t                                        hash;
+        VkPipeline                                      linked;
+        VkPipeline                                      libraries[PART_COUNT];
+        VkPipelineLayout                                layout;
+        VkPipelineCache                                 cache;
+    } Job_t;
+
+    const vkContext_t                                  *mVkContext;
+
+    std::unordered_map<uint64_t, Library_t>             mLibraries[PART_COUNT];
+
+    std::deque<Job_t>                                   mJobs;
+    std::vector<Optimized_t>                            mOptimized;
+    std::map<VkPipelineLayout, uint32_t>                mRunningJobs;
+    std::mutex                                          mMutex;
+    std::condition_variable                             mIdleCondition;
+    uint32_t                                            mWorkerJobs;
+    /// whether jobs have ever been started, read without the lock by the thread that starts them
+    bool                                                mStarted;
+    bool                                                mStopping;
+
+    static uint64_t                                     HashKey(Part_t part, const std::vector<uint32_t> &key);
+    VkPipeline                                          GetLibrary(Part_t part, const std::vector<uint32_t> &key,
+                                                                   const VkGraphicsPipelineCreateInfo &info, VkPipelineCache cache);
+    VkPipeline                                          CreateLibrary(Part_t part, const VkGraphicsPipelineCreateInfo &info, VkPipelineCache cache) const;
+    VkPipeline                                          LinkLibraries(const VkPipeline *libraries, VkPipelineLayout layout,
+                                                                      VkPipelineCache cache, bool optimize) const;
+    void                                                StartWorkerJobs(void);
+    void                                                StopWorkerJobs(void);
+    void                                                RunWorkerJob(void);
+
+public:
+// Constructor
+    PipelineLibrary(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~PipelineLibrary();
+
+// Link Functions
+    VkPipeline                                          Link(const VkGraphicsPipelineCreateInfo &info, VkPipelineCache cache, uint64_t hash,
+                                                             const std::vector<uint32_t> *keys);
+
+// Collect Functions
+    void                                                CollectOptimized(std::vector<Optimized_t> *optimized);
+
+// Release Functions
+    void                                                Release(VkPipelineLayout layout);
+
+// Is Functions
+    inline bool                                         IsEnabled(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return mVkContext && mVkContext->mIsGraphicsPipelineLibrarySupported; }
+};
+
+}
+
+#endif // __VKPIPELINELIBRARY_H__
@@ -0,0 +1,509 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineWarmer.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Background Pipeline Compilation Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Every pipeline state that is compiled during a session is recorded, together
+ *  with a hash of the SPIR-V of its program, in a log file. On the next launch,
+ *  as soon as a program with the same SPIR-V is linked, the recorded states are
+ *  compiled by speculative jobs against the context pipeline cache, so that the
+ *  pipeline creation on the render thread turns into a cache lookup.
+ *
+ */
+
+#include "pipelineWarmer.h"
+#include "hostAllocator.h"
+#include "renderPass.h"
+#include "utils/atomicFileWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace vulkanAPI {
+
+#define GLOVE_PIPELINE_STATE_LOG_MAGIC                  0x4c535047  // "GPSL"
+#define GLOVE_PIPELINE_STATE_LOG_VERSION                2
+#define GLOVE_PIPELINE_STATE_MAX_ARRAY_SIZE             64
+
+typedef struct stateLogHeader_t {
+    uint32_t                                            magic;
+    uint32_t                                            version;
+    uint32_t                                            fixedSize;
+    uint32_t                                            count;
+} stateLogHeader_t;
+
+template<typename T>
+static bool
+ReadArray(FILE *file, std::vector<T> &array)
+{
+    uint32_t count;
+    if(fread(&count, sizeof(uint32_t), 1, file) != 1 || count > GLOVE_PIPELINE_STATE_MAX_ARRAY_SIZE) {
+        return false;
+    }
+
+    array.resize(count);
+    return !count || fread(array.data(), sizeof(T), count, file) == count;
+}
+
+template<typename T>
+static bool
+WriteArray(FILE *file, const std::vector<T> &array)
+{
+    uint32_t count = static_cast<uint32_t>(array.size());
+    return fwrite(&count, sizeof(uint32_t), 1, file) == 1 &&
+           (!count || fwrite(array.data(), sizeof(T), count, file) == count);
+}
+
+static void
+HashBytes(uint64_t &hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    for(size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+}
+
+PipelineWarmer::PipelineWarmer(const vkContext_t *vkContext)
+: mVkContext(vkContext), mRecordsUpdated(false), mWorkerJobs(0), mStarted(false), mStopping(false)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    const char *path = getenv(GLOVE_PIPELINE_STATE_LOG_ENV);
+    if(path != nullptr) {
+        mLogPath = path;
+    }
+
+    if(IsEnabled()) {
+        LoadLog();
+    }
+}
+
+PipelineWarmer::~PipelineWarmer()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    StopWorkerJobs();
+
+    if(IsEnabled()) {
+        SaveLog();
+    }
+}
+
+uint64_t
+PipelineWarmer::HashRecord(const StateRecord_t &record)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    HashBytes(hash, &record.fixed, sizeof(StateFixed_t));
+    HashBytes(hash, record.dynamicStates.data(), record.dynamicStates.size() * sizeof(VkDynamicState));
+    HashBytes(hash, record.bindings.data()     , record.bindings.size()      * sizeof(VkVertexInputBindingDescription));
+    HashBytes(hash, record.attributes.data()   , record.attributes.size()    * sizeof(VkVertexInputAttributeDescription));
+
+    return hash;
+}
+
+bool
+PipelineWarmer::AddRecord(const StateRecord_t &record)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mRecords.size() >= GLOVE_MAX_PIPELINE_STATE_RECORDS) {
+        return false;
+    }
+
+    if(!mRecordHashes.insert(HashRecord(record)).second) {
+        return false;
+    }
+
+    mRecords.push_back(record);
+
+    return true;
+}
+
+void
+PipelineWarmer::SanitizeRecord(StateRecord_t *record)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// Pointers are meaningless across launches and threads, keep them out of the log, the hash and the jobs
+    record->fixed.inputAssembly.pNext     = nullptr;
+    record->fixed.rasterization.pNext     = nullptr;
+    record->fixed.colorBlend.pNext        = nullptr;
+    record->fixed.colorBlend.pAttachments = nullptr;
+    record->fixed.depthStencil.pNext      = nullptr;
+    record->fixed.multisample.pNext       = nullptr;
+    record->fixed.multisample.pSampleMask = nullptr;
+}
+
+void
+PipelineWarmer::Record(const StateRecord_t &record)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!IsEnabled()) {
+        return;
+    }
+
+    StateRecord_t sanitized = record;
+    SanitizeRecord(&sanitized);
+
+    if(AddRecord(sanitized)) {
+        mRecordsUpdated = true;
+    }
+}
+
+bool
+PipelineWarmer::LoadLog(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    FILE *file = fopen(mLogPath.c_str(), "rb");
+    if(file == nullptr) {
+        return false;
+    }
+
+    stateLogHeader_t header;
+    bool valid = fread(&header, sizeof(stateLogHeader_t), 1, file) == 1 &&
+                 header.magic     == GLOVE_PIPELINE_STATE_LOG_MAGIC   &&
+                 header.version   == GLOVE_PIPELINE_STATE_LOG_VERSION &&
+                 header.fixedSize == sizeof(StateFixed_t);
+
+    for(uint32_t i = 0; valid && i < header.count; ++i) {
+        StateRecord_t record;
+        valid = fread(&record.fixed, sizeof(StateFixed_t), 1, file) == 1 &&
+                ReadArray(file, record.dynamicStates)                   &&
+                ReadArray(file, record.bindings)                        &&
+                ReadArray(file, record.attributes);
+        if(valid) {
+            AddRecord(record);
+        }
+    }
+
+    fclose(file);
+
+    return valid;
+}
+
+bool
+PipelineWarmer::SaveLog(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mRecordsUpdated) {
+        return true;
+    }
+
+    /// Keep the states other processes have logged in the meantime
+    LoadLog();
+
+    stateLogHeader_t header;
+    header.magic     = GLOVE_PIPELINE_STATE_LOG_MAGIC;
+    header.version   = GLOVE_PIPELINE_STATE_LOG_VERSION;
+    header.fixedSize = sizeof(StateFixed_t);
+    header.count     = static_cast<uint32_t>(mRecords.size());
+
+    bool written = AtomicFileWriter::Write(mLogPath, [&](FILE *file) {
+        bool valid = fwrite(&header, sizeof(stateLogHeader_t), 1, file) == 1;
+        for(const auto &record : mRecords) {
+            valid = valid                                                     &&
+                    fwrite(&record.fixed, sizeof(StateFixed_t), 1, file) == 1 &&
+                    WriteArray(file, record.dynamicStates)                    &&
+                    WriteArray(file, record.bindings)                         &&
+                    WriteArray(file, record.attributes);
+        }
+        return valid;
+    });
+    if(!written) {
+        return false;
+    }
+
+    mRecordsUpdated = false;
+
+    return true;
+}
+
+void
+PipelineWarmer::StartWorkerJobs(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the jobs leave the job system once nothing is left to compile
+    uint32_t jobs = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while(mWorkerJobs + jobs < GLOVE_PIPELINE_WARMUP_THREADS && jobs < mJobs.size()) {
+            ++jobs;
+        }
+        mWorkerJobs += jobs;
+    }
+
+    mStarted |= jobs > 0;
+    for(uint32_t i = 0; i < jobs; ++i) {
+        JobSystem::GetInstance()->Submit(JOB_PRIORITY_SPECULATIVE, [this] { RunWorkerJob(); });
+    }
+}
+
+void
+PipelineWarmer::StopWorkerJobs(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStopping = true;
+    mJobs.clear();
+
+    mIdleCondition.wait(lock, [this] { return mWorkerJobs == 0; });
+}
+
+void
+PipelineWarmer::RunWorkerJob(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while(!mStopping && !mJobs.empty()) {
+        Job_t job = std::move(mJobs.front());
+        mJobs.pop_front();
+        ++mRunningJobs[job.layout];
+
+        lock.unlock();
+        CompileJob(job);
+        lock.lock();
+
+        if(--mRunningJobs[job.layout] == 0) {
+            mRunningJobs.erase(job.layout);
+        }
+        mIdleCondition.notify_all();
+    }
+
+    --mWorkerJobs;
+    mIdleCondition.notify_all();
+}
+
+uint32_t
+PipelineWarmer::WarmUp(uint64_t programHash, VkPipelineLayout layout, VkPipelineCache cache,
+                       const uint32_t *vertexSpirv, size_t vertexSpirvSize,
+                       const uint32_t *fragmentSpirv, size_t fragmentSpirvSize)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // compiling on the render thread would only move the cost to the link
+    if(!IsEnabled() || layout == VK_NULL_HANDLE || !vertexSpirvSize || !fragmentSpirvSize || !JobSystem::GetInstance()->GetThreadCount()) {
+        return 0;
+    }
+
+    uint32_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for(const auto &record : mRecords) {
+            if(record.fixed.programHash != programHash) {
+                continue;
+            }
+
+            Job_t job;
+            job.record = record;
+            job.layout = layout;
+            job.cache  = cache;
+            job.spirv[0].assign(vertexSpirv  , vertexSpirv   + vertexSpirvSize);
+            job.spirv[1].assign(fragmentSpirv, fragmentSpirv + fragmentSpirvSize);
+            mJobs.push_back(std::move(job));
+            ++queued;
+        }
+    }
+
+    if(queued) {
+        StartWorkerJobs();
+    }
+
+    return queued;
+}
+
+bool
+PipelineWarmer::Compile(const StateRecord_t &record, VkPipelineLayout layout, VkPipelineCache cache,
+                        const uint32_t *vertexSpirv, size_t vertexSpirvSize,
+                        const uint32_t *fragmentSpirv, size_t fragmentSpirvSize)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // states known up front are compiled whether a log is kept or not, and are not added to it
+    if(layout == VK_NULL_HANDLE || !vertexSpirvSize || !fragmentSpirvSize || !JobSystem::GetInstance()->GetThreadCount()) {
+        return false;
+    }
+
+    Job_t job;
+    job.record = record;
+    job.layout = layout;
+    job.cache  = cache;
+    job.spirv[0].assign(vertexSpirv  , vertexSpirv   + vertexSpirvSize);
+    job.spirv[1].assign(fragmentSpirv, fragmentSpirv + fragmentSpirvSize);
+    SanitizeRecord(&job.record);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(mStopping) {
+            return false;
+        }
+        mJobs.push_back(std::move(job));
+    }
+
+    StartWorkerJobs();
+
+    return true;
+}
+
+void
+PipelineWarmer::Cancel(VkPipelineLayout layout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mStarted) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for(auto it = mJobs.begin(); it != mJobs.end();) {
+        it = (it->layout == layout) ? mJobs.erase(it) : std::next(it);
+    }
+
+    mIdleCondition.wait(lock, [this, layout] { return mRunningJobs.find(layout) == mRunningJobs.end(); });
+}
+
+VkShaderModule
+PipelineWarmer::CreateVkShaderModule(const std::vector<uint32_t> &spirv) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkShaderModuleCreateInfo info;
+    info.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    info.pNext    = nullptr;
+    info.flags    = 0;
+    info.codeSize = spirv.size() * sizeof(uint32_t);
+    info.pCode    = spirv.data();
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if(vkCreateShaderModule(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &module) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+
+    return module;
+}
+
+bool
+PipelineWarmer::CompileJob(const Job_t &job) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    StateFixed_t fixed = job.record.fixed;
+    fixed.colorBlend.pAttachments = fixed.colorBlend.attachmentCount ? &fixed.colorBlendAttachment : nullptr;
+    fixed.multisample.pSampleMask = nullptr;
+
+    /// Only the attachment formats, the sample count and the input attachment matter for render pass compatibility
+    RenderPass renderPass(mVkContext);
+    renderPass.SetColorFetchEnabled(fixed.colorFetch);
+    if(!renderPass.Create(fixed.colorFormat, fixed.depthStencilFormat, fixed.multisample.rasterizationSamples)) {
+        return false;
+    }
+
+    VkShaderModule modules[2] = {CreateVkShaderModule(job.spirv[0]), CreateVkShaderModule(job.spirv[1])};
+
+    bool compiled = false;
+    if(modules[0] != VK_NULL_HANDLE && modules[1] != VK_NULL_HANDLE) {
+        VkPipelineShaderStageCreateInfo stages[2];
+        for(uint32_t i = 0; i < 2; ++i) {
+            stages[i].sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[i].pNext               = nullptr;
+            stages[i].flags               = 0;
+            stages[i].stage               = i ? VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+            stages[i].module              = modules[i];
+            stages[i].pName               = "main\0";
+            stages[i].pSpecializationInfo = nullptr;
+        }
+
+        VkPipelineVertexInputStateCreateInfo vertexInput;
+        memset(static_cast<void *>(&vertexInput), 0, sizeof(vertexInput));
+        vertexInput.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInput.vertexBindingDescriptionCount   = static_cast<uint32_t>(job.record.bindings.size());
+        vertexInput.pVertexBindingDescriptions      = job.record.bindings.data();
+        vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(job.record.attributes.size());
+        vertexInput.pVertexAttributeDescriptions    = job.record.attributes.data();
+
+        /// GL ES has a single viewport, the values themselves are dynamic state
+        VkViewport viewport  = {0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+        VkRect2D   scissor   = {{0, 0}, {1, 1}};
+        VkPipelineViewportStateCreateInfo viewportState;
+        memset(static_cast<void *>(&viewportState), 0, sizeof(viewportState));
+        viewportState.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = std::min(fixed.viewportCount, 1u);
+        viewportState.pViewports    = &viewport;
+        viewportState.scissorCount  = std::min(fixed.scissorCount, 1u);
+        viewportState.pScissors     = &scissor;
+
+        VkPipelineDynamicStateCreateInfo dynamicState;
+        memset(static_cast<void *>(&dynamicState), 0, sizeof(dynamicState));
+        dynamicState.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = static_cast<uint32_t>(job.record.dynamicStates.size());
+        dynamicState.pDynamicStates    = job.record.dynamicStates.data();
+
+        VkGraphicsPipelineCreateInfo info;
+        memset(static_cast<void *>(&info), 0, sizeof(info));
+        info.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        info.stageCount          = 2;
+        info.pStages             = stages;
+        info.pVertexInputState   = &vertexInput;
+        info.pInputAssemblyState = &fixed.inputAssembly;
+        info.pViewportState      = &viewportState;
+        info.pRasterizationState = &fixed.rasterization;
+        info.pMultisampleState   = &fixed.multisample;
+        info.pDepthStencilState  = &fixed.depthStencil;
+        info.pColorBlendState    = &fixed.colorBlend;
+        info.pDynamicState       = &dynamicState;
+        info.layout              = job.layout;
+        info.renderPass          = *renderPass.GetRenderPass();
+#ifdef VK_KHR_dynamic_rendering
+        VkPipelineRenderingCreateInfoKHR renderingInfo;
+        VkFormat                         renderingColorFormat;
+        info.pNext               = renderPass.ChainPipelineRendering(&renderingInfo, &renderingColorFormat, nullptr);
+#endif // VK_KHR_dynamic_rendering
+        info.subpass             = 0;
+
+        /// The pipeline itself is thrown away, what is kept is its entry in the pipeline cache
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        compiled = vkCreateGraphicsPipelines(mVkContext->vkDevice, job.cache, 1, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &pipeline) == VK_SUCCESS;
+        if(pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(mVkContext->vkDevice, pipeline, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        }
+    }
+
+    for(uint32_t i = 0; i < 2; ++i) {
+        if(modules[i] != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(mVkContext->vkDevice, modules[i], mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+        }
+    }
+
+    return compiled;
+}
+
+}
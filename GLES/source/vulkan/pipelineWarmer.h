@@ -0,0 +1,134 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       pipelineWarmer.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Background Pipeline Compilation Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKPIPELINEWARMER_H__
+#define __VKPIPELINEWARMER_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include "context.h"
+#include "utils/jobSystem.h"
+
+/// Environment variable holding the path of the recorded pipeline state log
+#define GLOVE_PIPELINE_STATE_LOG_ENV                    "GLOVE_PIPELINE_STATE_LOG"
+
+/// Number of jobs of the job system compiling recorded pipelines at once
+#define GLOVE_PIPELINE_WARMUP_THREADS                   2
+
+/// Upper limit of the pipeline states kept in the log
+#define GLOVE_MAX_PIPELINE_STATE_RECORDS                4096
+
+namespace vulkanAPI {
+
+class PipelineWarmer final {
+public:
+    typedef struct StateFixed_t {
+        uint64_t                                        programHash;
+        VkFormat                                        colorFormat;
+        VkFormat                                        depthStencilFormat;
+        VkBool32                                        colorFetch;
+        VkPipelineInputAssemblyStateCreateInfo          inputAssembly;
+        VkPipelineRasterizationStateCreateInfo          rasterization;
+        VkPipelineColorBlendAttachmentState             colorBlendAttachment;
+        VkPipelineColorBlendStateCreateInfo             colorBlend;
+        VkPipelineDepthStencilStateCreateInfo           depthStencil;
+        VkPipelineMultisampleStateCreateInfo            multisample;
+        uint32_t                                        viewportCount;
+        uint32_t                                        scissorCount;
+    } StateFixed_t;
+
+    typedef struct StateRecord_t {
+        StateFixed_t                                    fixed;
+        std::vector<VkDynamicState>                     dynamicStates;
+        std::vector<VkVertexInputBindingDescription>    bindings;
+        std::vector<VkVertexInputAttributeDescription>  attributes;
+    } StateRecord_t;
+
+private:
+    typedef struct Job_t {
+        StateRecord_t                                   record;
+        VkPipelineLayout                                layout;
+        VkPipelineCache                                 cache;
+        std::vector<uint32_t>                           spirv[2];
+    } Job_t;
+
+    const vkContext_t                                  *mVkContext;
+
+    std::string                                         mLogPath;
+    std::vector<StateRecord_t>                          mRecords;
+    std::unordered_set<uint64_t>                        mRecordHashes;
+    bool                                                mRecordsUpdated;
+
+    std::deque<Job_t>                                   mJobs;
+    std::map<VkPipelineLayout, uint32_t>                mRunningJobs;
+    std::mutex                                          mMutex;
+    std::condition_variable                             mIdleCondition;
+    uint32_t                                            mWorkerJobs;
+    /// whether jobs have ever been started, read without the lock by the thread that starts them
+    bool                                                mStarted;
+    bool                                                mStopping;
+
+    static uint64_t                                     HashRecord(const StateRecord_t &record);
+    static void                                         SanitizeRecord(StateRecord_t *record);
+    bool                                                AddRecord(const StateRecord_t &record);
+    bool                                                LoadLog(void);
+    bool                                                SaveLog(void);
+    void                                                StartWorkerJobs(void);
+    void                                                StopWorkerJobs(void);
+    void                                                RunWorkerJob(void);
+    bool                                                CompileJob(const Job_t &job)   const;
+    VkShaderModule                                      CreateVkShaderModule(const std::vector<uint32_t> &spirv) const;
+
+public:
+// Constructor
+    PipelineWarmer(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~PipelineWarmer();
+
+// Record Functions
+    void                                                Record(const StateRecord_t &record);
+
+// Warm Up Functions
+    uint32_t                                            WarmUp(uint64_t programHash, VkPipelineLayout layout, VkPipelineCache cache,
+                                                               const uint32_t *vertexSpirv, size_t vertexSpirvSize,
+                                                               const uint32_t *fragmentSpirv, size_t fragmentSpirvSize);
+    bool                                                Compile(const StateRecord_t &record, VkPipelineLayout layout, VkPipelineCache cache,
+                                                                const uint32_t *vertexSpirv, size_t vertexSpirvSize,
+                                                                const uint32_t *fragmentSpirv, size_t fragmentSpirvSize);
+
+// Cancel Functions
+    void                                                Cancel(VkPipelineLayout layout);
+
+// Get Functions
+    inline bool                                         IsEnabled(void)                 const { FUN_ENTRY(GL_LOG_TRACE); return !mLogPath.empty(); }
+};
+
+}
+
+#endif // __VKPIPELINEWARMER_H__
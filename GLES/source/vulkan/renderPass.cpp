@@ -30,20 +30,42 @@
 
 #include "renderPass.h"
 #include "utils.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
 
 namespace vulkanAPI {
 
+static VkAttachmentLoadOp
+LoadOp(bool clear, bool load)
+{
+    return clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (load ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+}
+
+static VkAttachmentStoreOp
+StoreOp(bool write, VkAttachmentLoadOp loadOp)
+{
+    return (write || loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
 RenderPass::RenderPass(const vkContext_t *vkContext)
 : mVkContext(vkContext),
   mVkPipelineBindPoint(VK_PIPELINE_BIND_POINT_GRAPHICS),
   mVkRenderPass(VK_NULL_HANDLE),
+  mVkColorFormat(VK_FORMAT_UNDEFINED), mVkDepthStencilFormat(VK_FORMAT_UNDEFINED), mVkSamples(VK_SAMPLE_COUNT_1_BIT),
   mColorClearEnabled(false), mDepthClearEnabled(false), mStencilClearEnabled(false),
   mColorWriteEnabled(true), mDepthWriteEnabled(true), mStencilWriteEnabled(false),
+  mColorLoadEnabled(true), mDepthLoadEnabled(true), mStencilLoadEnabled(true),
+  mMultisampleColorTransient(false),
+  mColorFetchEnabled(false),
+  mViewCount(1),
+  mDynamic(false),
   mStarted(false)
 {
     FUN_ENTRY(GL_LOG_TRACE);
 
     memset(static_cast<void *>(mVkClearValues), 0, sizeof(mVkClearValues));
+    memset(static_cast<void *>(&mVkColorAttachment), 0, sizeof(mVkColorAttachment));
+    memset(static_cast<void *>(&mVkDepthStencilAttachment), 0, sizeof(mVkDepthStencilAttachment));
 }
 
 RenderPass::~RenderPass()
@@ -59,40 +81,60 @@ RenderPass::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkRenderPass != VK_NULL_HANDLE) {
-        vkDestroyRenderPass(mVkContext->vkDevice, mVkRenderPass, nullptr);
+        vkDestroyRenderPass(mVkContext->vkDevice, mVkRenderPass, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
         mVkRenderPass = VK_NULL_HANDLE;
     }
+
+    mDynamic = false;
 }
 
 bool
-RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
+RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat, VkSampleCountFlagBits samples)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
     Release();
 
+    // attachment formats and sample count define the render pass compatibility class
+    mVkColorFormat        = colorFormat;
+    mVkDepthStencilFormat = depthstencilFormat;
+    mVkSamples            = samples;
+
+    const bool multisampled = samples != VK_SAMPLE_COUNT_1_BIT;
+    const bool transient    = multisampled && mMultisampleColorTransient;
+
+    // color read back by the fragment shader is both the color and the input attachment
+    // of the subpass, which can only share the general layout
+    const bool fetch        = mColorFetchEnabled && colorFormat != VK_FORMAT_UNDEFINED && !multisampled;
+    const bool dynamic      = mVkContext->mIsDynamicRenderingSupported && !fetch;
+
     VkAttachmentReference           color;
+    VkAttachmentReference           resolve;
     VkAttachmentReference           depthstencil;
     vector<VkAttachmentDescription> attachments;
 
+    // Contents are loaded unless they are cleared or were discarded. They are stored
+    // when the pass writes them or has to keep what it loaded, so only attachments
+    // that are both undefined and left untouched are dropped.
     if(colorFormat != VK_FORMAT_UNDEFINED) {
 
         /// Color attachment
         VkAttachmentDescription attachmentColor;
         attachmentColor.flags           = 0;
         attachmentColor.format          = colorFormat;
-        attachmentColor.samples         = VK_SAMPLE_COUNT_1_BIT;
-        attachmentColor.loadOp          = (mColorClearEnabled && mColorWriteEnabled) ? VK_ATTACHMENT_LOAD_OP_CLEAR  : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        attachmentColor.storeOp         = mColorWriteEnabled ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentColor.samples         = samples;
+        attachmentColor.loadOp          = LoadOp(mColorClearEnabled && mColorWriteEnabled, mColorLoadEnabled && !transient);
+        attachmentColor.storeOp         = transient ? VK_ATTACHMENT_STORE_OP_DONT_CARE : StoreOp(mColorWriteEnabled, attachmentColor.loadOp);
         attachmentColor.stencilLoadOp   = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         attachmentColor.stencilStoreOp  = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         attachmentColor.initialLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
         attachmentColor.finalLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
         attachments.push_back(attachmentColor);
+        mVkColorAttachment = attachmentColor;
 
         color.attachment           = attachments.size() - 1;
-        color.layout               = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        color.layout               = fetch ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     }
 
     /// Depth/Stencil attachment
@@ -104,44 +146,101 @@ RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
         VkAttachmentDescription attachmentDepthStencil;
         attachmentDepthStencil.flags          = 0;
         attachmentDepthStencil.format         = depthstencilFormat;
-        attachmentDepthStencil.samples        = VK_SAMPLE_COUNT_1_BIT;
-        attachmentDepthStencil.loadOp         = (isDepth   && mDepthClearEnabled && mDepthWriteEnabled)     ? VK_ATTACHMENT_LOAD_OP_CLEAR  : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        attachmentDepthStencil.storeOp        = (isDepth   && mDepthWriteEnabled)                           ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachmentDepthStencil.stencilLoadOp  = (isStencil && mStencilClearEnabled && mStencilWriteEnabled) ? VK_ATTACHMENT_LOAD_OP_CLEAR  : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        attachmentDepthStencil.stencilStoreOp = (isStencil && mStencilWriteEnabled)                         ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDepthStencil.samples        = samples;
+        attachmentDepthStencil.loadOp         = isDepth   ? LoadOp(mDepthClearEnabled && mDepthWriteEnabled, mDepthLoadEnabled)       : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDepthStencil.storeOp        = isDepth   ? StoreOp(mDepthWriteEnabled, attachmentDepthStencil.loadOp)                 : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDepthStencil.stencilLoadOp  = isStencil ? LoadOp(mStencilClearEnabled && mStencilWriteEnabled, mStencilLoadEnabled) : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDepthStencil.stencilStoreOp = isStencil ? StoreOp(mStencilWriteEnabled, attachmentDepthStencil.stencilLoadOp)       : VK_ATTACHMENT_STORE_OP_DONT_CARE;
         attachmentDepthStencil.initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         attachmentDepthStencil.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         attachments.push_back(attachmentDepthStencil);
+        mVkDepthStencilAttachment = attachmentDepthStencil;
 
         depthstencil.attachment   = attachments.size() - 1;
         depthstencil.layout       = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     }
 
+    /// Resolve attachment, the single sampled image the multisampled color ends up in
+    if(colorFormat != VK_FORMAT_UNDEFINED && multisampled) {
+
+        VkAttachmentDescription attachmentResolve;
+        attachmentResolve.flags           = 0;
+        attachmentResolve.format          = colorFormat;
+        attachmentResolve.samples         = VK_SAMPLE_COUNT_1_BIT;
+        attachmentResolve.loadOp          = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentResolve.storeOp         = VK_ATTACHMENT_STORE_OP_STORE;
+        attachmentResolve.stencilLoadOp   = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentResolve.stencilStoreOp  = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentResolve.initialLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachmentResolve.finalLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        attachments.push_back(attachmentResolve);
+
+        resolve.attachment         = attachments.size() - 1;
+        resolve.layout             = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    // the operations of the attachments are given when the pass is begun, framebuffers and
+    // pipelines only need the formats they are created with
+    if(dynamic) {
+        mDynamic = true;
+        return true;
+    }
+
     VkSubpassDescription subpass;
     subpass.pipelineBindPoint       = mVkPipelineBindPoint;
     subpass.flags                   = 0;
     subpass.colorAttachmentCount    = colorFormat        != VK_FORMAT_UNDEFINED ? 1             : 0;
     subpass.pColorAttachments       = colorFormat        != VK_FORMAT_UNDEFINED ? &color        : nullptr;
     subpass.pDepthStencilAttachment = depthstencilFormat != VK_FORMAT_UNDEFINED ? &depthstencil : nullptr;
-    subpass.pResolveAttachments     = nullptr;
-    subpass.inputAttachmentCount    = 0;
-    subpass.pInputAttachments       = nullptr;
+    subpass.pResolveAttachments     = colorFormat != VK_FORMAT_UNDEFINED && multisampled ? &resolve : nullptr;
+    subpass.inputAttachmentCount    = fetch ? 1      : 0;
+    subpass.pInputAttachments       = fetch ? &color : nullptr;
     subpass.preserveAttachmentCount = 0;
     subpass.pPreserveAttachments    = nullptr;
 
+    /// the draws that read the color wait for the earlier ones of the subpass, at the same pixels only
+    VkSubpassDependency dependency;
+    dependency.srcSubpass           = 0;
+    dependency.dstSubpass           = 0;
+    dependency.srcStageMask         = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstStageMask         = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependency.srcAccessMask        = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstAccessMask        = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+    dependency.dependencyFlags      = VK_DEPENDENCY_BY_REGION_BIT;
+
+    // all views are drawn by the single subpass, and are likely to be close enough to each other
+    // for the device to render them concurrently
+    const uint32_t viewMask = GetViewMask();
+#ifdef VK_KHR_multiview
+    VkRenderPassMultiviewCreateInfoKHR multiview;
+    multiview.sType                = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO_KHR;
+    multiview.pNext                = nullptr;
+    multiview.subpassCount         = 1;
+    multiview.pViewMasks           = &viewMask;
+    multiview.dependencyCount      = 0;
+    multiview.pViewOffsets         = nullptr;
+    multiview.correlationMaskCount = 1;
+    multiview.pCorrelationMasks    = &viewMask;
+#endif // VK_KHR_multiview
+
     VkRenderPassCreateInfo info;
     info.sType            = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+#ifdef VK_KHR_multiview
+    info.pNext            = viewMask ? &multiview : nullptr;
+#else
     info.pNext            = nullptr;
+#endif // VK_KHR_multiview
     info.flags            = 0;
     info.attachmentCount  = static_cast<uint32_t>(attachments.size());
     info.pAttachments     = attachments.data();
     info.subpassCount     = 1;
     info.pSubpasses       = &subpass;
-    info.dependencyCount  = 0;
-    info.pDependencies    = nullptr;
+    info.dependencyCount  = fetch ? 1           : 0;
+    info.pDependencies    = fetch ? &dependency : nullptr;
 
-    VkResult err = vkCreateRenderPass(mVkContext->vkDevice, &info, nullptr, &mVkRenderPass);
+    VkResult err = vkCreateRenderPass(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkRenderPass);
     assert(!err);
 
     return (err != VK_ERROR_OUT_OF_HOST_MEMORY && err != VK_ERROR_OUT_OF_DEVICE_MEMORY);
@@ -149,14 +248,19 @@ RenderPass::Create(VkFormat colorFormat, VkFormat depthstencilFormat)
 
 
 void
-RenderPass::Begin(VkCommandBuffer *activeCmdBuffer, VkFramebuffer *framebuffer, bool hasSecondary)
+RenderPass::Begin(VkCommandBuffer *activeCmdBuffer, const Framebuffer *framebuffer, bool hasSecondary)
 {
     FUN_ENTRY(GL_LOG_DEBUG);
 
+    if(mDynamic) {
+        BeginRendering(activeCmdBuffer, framebuffer, hasSecondary);
+        return;
+    }
+
     VkRenderPassBeginInfo info;
     info.sType                     = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     info.pNext                     = nullptr;
-    info.framebuffer               = *framebuffer;
+    info.framebuffer               = *framebuffer->GetFramebuffer();
     info.renderPass                = mVkRenderPass;
     info.renderArea                = mVkRenderArea;
     info.clearValueCount           = 2;
@@ -165,8 +269,68 @@ RenderPass::Begin(VkCommandBuffer *activeCmdBuffer, VkFramebuffer *framebuffer,
     const VkSubpassContents subpassContents = hasSecondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
 
     vkCmdBeginRenderPass(*activeCmdBuffer, &info, subpassContents);
+    mVkContext->perfCounters->Add(PERF_COUNTER_RENDER_PASSES_BEGUN);
+
+    mStarted = true;
+}
+
+void
+RenderPass::BeginRendering(VkCommandBuffer *activeCmdBuffer, const Framebuffer *framebuffer, bool hasSecondary)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_KHR_dynamic_rendering
+    // the image views are in the order of the attachments of the render pass: color, depth/stencil, resolve
+    const vector<VkImageView> &imageViews = framebuffer->GetImageViews();
+    const bool hasColor        = mVkColorFormat        != VK_FORMAT_UNDEFINED;
+    const bool hasDepthStencil = mVkDepthStencilFormat != VK_FORMAT_UNDEFINED;
+    const bool multisampled    = mVkSamples            != VK_SAMPLE_COUNT_1_BIT;
+
+    VkRenderingAttachmentInfoKHR color;
+    memset(static_cast<void *>(&color), 0, sizeof(color));
+    color.sType                = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    color.imageView            = hasColor ? imageViews.front() : VK_NULL_HANDLE;
+    color.imageLayout          = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color.resolveMode          = hasColor && multisampled ? VK_RESOLVE_MODE_AVERAGE_BIT_KHR : VK_RESOLVE_MODE_NONE_KHR;
+    color.resolveImageView     = hasColor && multisampled ? imageViews.back() : VK_NULL_HANDLE;
+    color.resolveImageLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color.loadOp               = mVkColorAttachment.loadOp;
+    color.storeOp              = mVkColorAttachment.storeOp;
+    color.clearValue           = mVkClearValues[0];
+
+    VkRenderingAttachmentInfoKHR depth;
+    memset(static_cast<void *>(&depth), 0, sizeof(depth));
+    depth.sType                = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depth.imageView            = hasDepthStencil ? imageViews[hasColor ? 1 : 0] : VK_NULL_HANDLE;
+    depth.imageLayout          = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth.resolveMode          = VK_RESOLVE_MODE_NONE_KHR;
+    depth.loadOp               = mVkDepthStencilAttachment.loadOp;
+    depth.storeOp              = mVkDepthStencilAttachment.storeOp;
+    depth.clearValue           = mVkClearValues[1];
+
+    VkRenderingAttachmentInfoKHR stencil = depth;
+    stencil.loadOp             = mVkDepthStencilAttachment.stencilLoadOp;
+    stencil.storeOp            = mVkDepthStencilAttachment.stencilStoreOp;
+
+    VkRenderingInfoKHR info;
+    memset(static_cast<void *>(&info), 0, sizeof(info));
+    info.sType                 = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    info.flags                 = hasSecondary ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+    info.renderArea            = mVkRenderArea;
+    info.layerCount            = 1;
+    info.viewMask              = GetViewMask();
+    info.colorAttachmentCount  = hasColor ? 1 : 0;
+    info.pColorAttachments     = hasColor ? &color : nullptr;
+    info.pDepthAttachment      = VkFormatIsDepth(mVkDepthStencilFormat)   ? &depth   : nullptr;
+    info.pStencilAttachment    = VkFormatIsStencil(mVkDepthStencilFormat) ? &stencil : nullptr;
+
+    mVkContext->fpCmdBeginRenderingKHR(*activeCmdBuffer, &info);
+    mVkContext->perfCounters->Add(PERF_COUNTER_RENDER_PASSES_BEGUN);
 
     mStarted = true;
+#else
+    NOT_REACHED();
+#endif // VK_KHR_dynamic_rendering
 }
 
 bool
@@ -176,6 +340,12 @@ RenderPass::End(VkCommandBuffer *activeCmdBuffer)
 
     if (mStarted) {
         mStarted = false;
+#ifdef VK_KHR_dynamic_rendering
+        if(mDynamic) {
+            mVkContext->fpCmdEndRenderingKHR(*activeCmdBuffer);
+            return true;
+        }
+#endif // VK_KHR_dynamic_rendering
         vkCmdEndRenderPass(*activeCmdBuffer);
         return true;
     } else {
@@ -183,6 +353,73 @@ RenderPass::End(VkCommandBuffer *activeCmdBuffer)
     }
 }
 
+void
+RenderPass::RecordColorFetchBarrier(VkCommandBuffer *activeCmdBuffer) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the self-dependency of the subpass, so that the color written by the earlier draws is read back
+    VkMemoryBarrier barrier;
+    barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.pNext         = nullptr;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+
+    vkCmdPipelineBarrier(*activeCmdBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_DEPENDENCY_BY_REGION_BIT, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+#ifdef VK_KHR_dynamic_rendering
+const void *
+RenderPass::ChainPipelineRendering(VkPipelineRenderingCreateInfoKHR *info, VkFormat *colorFormat, const void *next) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mDynamic) {
+        return next;
+    }
+
+    // pipelines are created against the attachment formats only, the color one is kept by the caller
+    *colorFormat = mVkColorFormat;
+
+    memset(static_cast<void *>(info), 0, sizeof(*info));
+    info->sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    info->pNext                   = next;
+    info->viewMask                = GetViewMask();
+    info->colorAttachmentCount    = mVkColorFormat != VK_FORMAT_UNDEFINED ? 1 : 0;
+    info->pColorAttachmentFormats = colorFormat;
+    info->depthAttachmentFormat   = VkFormatIsDepth(mVkDepthStencilFormat)   ? mVkDepthStencilFormat : VK_FORMAT_UNDEFINED;
+    info->stencilAttachmentFormat = VkFormatIsStencil(mVkDepthStencilFormat) ? mVkDepthStencilFormat : VK_FORMAT_UNDEFINED;
+
+    return info;
+}
+
+const void *
+RenderPass::ChainInheritanceRendering(VkCommandBufferInheritanceRenderingInfoKHR *info, VkFormat *colorFormat, const void *next) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mDynamic) {
+        return next;
+    }
+
+    // secondary command buffers continue any pass begun with the same formats and sample count
+    *colorFormat = mVkColorFormat;
+
+    memset(static_cast<void *>(info), 0, sizeof(*info));
+    info->sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    info->pNext                   = next;
+    info->viewMask                = GetViewMask();
+    info->colorAttachmentCount    = mVkColorFormat != VK_FORMAT_UNDEFINED ? 1 : 0;
+    info->pColorAttachmentFormats = colorFormat;
+    info->depthAttachmentFormat   = VkFormatIsDepth(mVkDepthStencilFormat)   ? mVkDepthStencilFormat : VK_FORMAT_UNDEFINED;
+    info->stencilAttachmentFormat = VkFormatIsStencil(mVkDepthStencilFormat) ? mVkDepthStencilFormat : VK_FORMAT_UNDEFINED;
+    info->rasterizationSamples    = mVkSamples;
+
+    return info;
+}
+#endif // VK_KHR_dynamic_rendering
+
 void
 RenderPass::SetClearArea(const VkRect2D *rect)
 {
@@ -25,6 +25,7 @@
 #define __VKRENDERPASS_H__
 
 #include "context.h"
+#include "framebuffer.h"
 
 namespace vulkanAPI {
 
@@ -40,6 +41,9 @@ private:
     VkRenderPass            mVkRenderPass;
     VkClearValue            mVkClearValues[2];
     VkRect2D                mVkRenderArea;
+    VkFormat                mVkColorFormat;
+    VkFormat                mVkDepthStencilFormat;
+    VkSampleCountFlagBits   mVkSamples;
 
     VkBool32                mColorClearEnabled;
     VkBool32                mDepthClearEnabled;
@@ -49,8 +53,30 @@ private:
     VkBool32                mDepthWriteEnabled;
     VkBool32                mStencilWriteEnabled;
 
+    VkBool32                mColorLoadEnabled;
+    VkBool32                mDepthLoadEnabled;
+    VkBool32                mStencilLoadEnabled;
+
+    /// the multisampled color only lives until it is resolved at the end of the pass
+    VkBool32                mMultisampleColorTransient;
+
+    /// the single sampled color is read back as the input attachment of the subpass (GL_EXT_shader_framebuffer_fetch)
+    VkBool32                mColorFetchEnabled;
+
+    /// each draw is broadcast to this many consecutive layers of the attachments (VK_KHR_multiview)
+    uint32_t                mViewCount;
+
+    /// begun on the image views of the framebuffer with the attachment operations below, no render pass object
+    /// is created (VK_KHR_dynamic_rendering). Reading the color back still takes a subpass with an input attachment
+    VkBool32                mDynamic;
+    VkAttachmentDescription mVkColorAttachment;
+    VkAttachmentDescription mVkDepthStencilAttachment;
+
     VkBool32                mStarted;
 
+    inline uint32_t         GetViewMask(void)                             const { FUN_ENTRY(GL_LOG_TRACE); return mViewCount > 1 ? (1u << mViewCount) - 1 : 0; }
+    void                    BeginRendering(VkCommandBuffer *activeCmdBuffer, const Framebuffer *framebuffer, bool hasSecondary);
+
 public:
 
 // Constructor
@@ -60,16 +86,25 @@ public:
     ~RenderPass();
 
 // Begin/End functions
-    void                    Begin   (VkCommandBuffer *activeCmdBuffer, VkFramebuffer *framebuffer, bool hasSecondary);
+    void                    Begin   (VkCommandBuffer *activeCmdBuffer, const Framebuffer *framebuffer, bool hasSecondary);
 
     bool                    End     (VkCommandBuffer *activeCmdBuffer);
 
+// Barrier functions
+    void                    RecordColorFetchBarrier(VkCommandBuffer *activeCmdBuffer) const;
+
 // Create functions
-    bool                    Create  (VkFormat colorFormat, VkFormat depthstencilFormat);
+    bool                    Create  (VkFormat colorFormat, VkFormat depthstencilFormat, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
 
 // Release functions
     void                    Release (void);
 
+// Chain functions
+#ifdef VK_KHR_dynamic_rendering
+    const void *            ChainPipelineRendering(VkPipelineRenderingCreateInfoKHR *info, VkFormat *colorFormat, const void *next) const;
+    const void *            ChainInheritanceRendering(VkCommandBufferInheritanceRenderingInfoKHR *info, VkFormat *colorFormat, const void *next) const;
+#endif // VK_KHR_dynamic_rendering
+
 // Get functions
     inline VkBool32         GetColorClearEnabled(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mColorClearEnabled;   }
     inline VkBool32         GetDepthClearEnabled(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mDepthClearEnabled;   }
@@ -77,7 +112,23 @@ public:
     inline VkBool32         GetColorWriteEnabled(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mColorWriteEnabled;   }
     inline VkBool32         GetDepthWriteEnabled(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mDepthWriteEnabled;   }
     inline VkBool32         GetStencilWriteEnabled(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mStencilWriteEnabled; }
+    inline VkBool32         GetColorLoadEnabled(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mColorLoadEnabled;    }
+    inline VkBool32         GetDepthLoadEnabled(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mDepthLoadEnabled;    }
+    inline VkBool32         GetStencilLoadEnabled(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mStencilLoadEnabled;  }
     inline VkRenderPass*    GetRenderPass(void)                                 { FUN_ENTRY(GL_LOG_TRACE); return &mVkRenderPass; }
+    inline const
+           VkRenderPass*    GetRenderPass(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return &mVkRenderPass; }
+    inline VkFormat         GetColorFormat(void)                          const { FUN_ENTRY(GL_LOG_TRACE); return mVkColorFormat;       }
+    inline VkFormat         GetDepthStencilFormat(void)                   const { FUN_ENTRY(GL_LOG_TRACE); return mVkDepthStencilFormat; }
+    inline VkSampleCountFlagBits GetSamples(void)                         const { FUN_ENTRY(GL_LOG_TRACE); return mVkSamples;           }
+    inline VkBool32         GetMultisampleColorTransient(void)            const { FUN_ENTRY(GL_LOG_TRACE); return mMultisampleColorTransient; }
+    inline VkBool32         GetColorFetchEnabled(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mColorFetchEnabled;   }
+    inline uint32_t         GetViewCount(void)                            const { FUN_ENTRY(GL_LOG_TRACE); return mViewCount;           }
+    inline const VkRect2D * GetRenderArea(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return &mVkRenderArea;       }
+
+// Is functions
+    inline bool             IsDynamic(void)                               const { FUN_ENTRY(GL_LOG_TRACE); return mDynamic;             }
+    inline bool             IsCreated(void)                               const { FUN_ENTRY(GL_LOG_TRACE); return mDynamic || mVkRenderPass != VK_NULL_HANDLE; }
 
 // Set Functions
     inline void             SetVkContext(const vkContext_t *vkContext)          { FUN_ENTRY(GL_LOG_TRACE); mVkContext           = vkContext; }
@@ -87,6 +138,12 @@ public:
     inline void             SetColorWriteEnabled(VkBool32 enable)               { FUN_ENTRY(GL_LOG_TRACE); mColorWriteEnabled   = enable;    }
     inline void             SetDepthWriteEnabled(VkBool32 enable)               { FUN_ENTRY(GL_LOG_TRACE); mDepthWriteEnabled   = enable;    }
     inline void             SetStencilWriteEnabled(VkBool32 enable)             { FUN_ENTRY(GL_LOG_TRACE); mStencilWriteEnabled = enable;    }
+    inline void             SetColorLoadEnabled(VkBool32 enable)                { FUN_ENTRY(GL_LOG_TRACE); mColorLoadEnabled    = enable;    }
+    inline void             SetDepthLoadEnabled(VkBool32 enable)                { FUN_ENTRY(GL_LOG_TRACE); mDepthLoadEnabled    = enable;    }
+    inline void             SetStencilLoadEnabled(VkBool32 enable)              { FUN_ENTRY(GL_LOG_TRACE); mStencilLoadEnabled  = enable;    }
+    inline void             SetMultisampleColorTransient(VkBool32 enable)       { FUN_ENTRY(GL_LOG_TRACE); mMultisampleColorTransient = enable; }
+    inline void             SetColorFetchEnabled(VkBool32 enable)               { FUN_ENTRY(GL_LOG_TRACE); mColorFetchEnabled   = enable;    }
+    inline void             SetViewCount(uint32_t viewCount)                    { FUN_ENTRY(GL_LOG_TRACE); mViewCount           = viewCount; }
 
            void             SetClearArea(const VkRect2D *rect);
            void             SetClearColorValue(const float *value);
@@ -28,6 +28,8 @@
  */
 
 #include "sampler.h"
+#include "hostAllocator.h"
+#include "samplerCache.h"
 
 namespace vulkanAPI {
 
@@ -62,7 +64,12 @@ Sampler::Release(void)
     FUN_ENTRY(GL_LOG_DEBUG);
 
     if(mVkSampler != VK_NULL_HANDLE) {
-        vkDestroySampler(mVkContext->vkDevice, mVkSampler, nullptr);
+        // shared samplers are only dropped by this object, the cache destroys them
+        if(mVkContext->samplerCache) {
+            mVkContext->samplerCache->Release(mVkSampler);
+        } else {
+            vkDestroySampler(mVkContext->vkDevice, mVkSampler, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
+        }
         mVkSampler = VK_NULL_HANDLE;
     }
 
@@ -102,7 +109,14 @@ Sampler::Create()
     samplerInfo.borderColor             = mVkBorderColor;
     samplerInfo.unnormalizedCoordinates = mUnnormalizedCoordinates;
 
-    VkResult err = vkCreateSampler(mVkContext->vkDevice, &samplerInfo, nullptr, &mVkSampler);
+    // textures with the same state share one sampler
+    if(mVkContext->samplerCache) {
+        mVkSampler = mVkContext->samplerCache->Acquire(&samplerInfo);
+        mUpdated   = mVkSampler == VK_NULL_HANDLE;
+        return mVkSampler != VK_NULL_HANDLE;
+    }
+
+    VkResult err = vkCreateSampler(mVkContext->vkDevice, &samplerInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &mVkSampler);
     assert(!err);
 
     mUpdated = false;
@@ -78,6 +78,8 @@ public:
     inline void                       SetAddressModeW(VkSamplerAddressMode mode){ FUN_ENTRY(GL_LOG_TRACE); mVkAddressModeW = mode;   mUpdated = VK_TRUE; }
     inline void                       SetMipmapMode(VkSamplerMipmapMode mode)   { FUN_ENTRY(GL_LOG_TRACE); mVkMipmapMode   = mode;   mUpdated = VK_TRUE; }
     inline void                       SetMaxLod(float lod)                      { FUN_ENTRY(GL_LOG_TRACE); mMaxLod         = lod;    mUpdated = VK_TRUE; }
+    inline void                       SetCompareEnabled(VkBool32 enabled)       { FUN_ENTRY(GL_LOG_TRACE); mCompareEnabled = enabled; mUpdated = VK_TRUE; }
+    inline void                       SetCompareOp(VkCompareOp op)              { FUN_ENTRY(GL_LOG_TRACE); mVkCompareOp    = op;     mUpdated = VK_TRUE; }
 };
 
 }
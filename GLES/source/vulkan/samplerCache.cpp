@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       samplerCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Shared, Reference Counted VkSampler Objects
+ *
+ *  @section
+ *
+ *  Textures vastly outnumber the distinct sampler states they use, and the
+ *  number of samplers that may exist is limited by maxSamplerAllocationCount.
+ *  Samplers are therefore looked up by their create info and shared between
+ *  all textures with the same state. A sampler that is no longer referenced
+ *  stays in the cache, since a submitted command buffer may still use it and
+ *  the same state is likely to be asked for again; all samplers are destroyed
+ *  with the cache.
+ *
+ */
+
+#include <cstring>
+#include "samplerCache.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+SamplerCache::SamplerCache(const vkContext_t *vkContext)
+: mVkContext(vkContext)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+SamplerCache::~SamplerCache()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto &entry : mSamplers) {
+        vkDestroySampler(mVkContext->vkDevice, entry.second.sampler, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES));
+    }
+    mSamplers.clear();
+}
+
+SamplerCache::Key_t
+SamplerCache::GetKey(const VkSamplerCreateInfo *info)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Key_t key;
+    key[0]  = static_cast<uint32_t>(info->magFilter);
+    key[1]  = static_cast<uint32_t>(info->minFilter);
+    key[2]  = static_cast<uint32_t>(info->mipmapMode);
+    key[3]  = static_cast<uint32_t>(info->addressModeU);
+    key[4]  = static_cast<uint32_t>(info->addressModeV);
+    key[5]  = static_cast<uint32_t>(info->addressModeW);
+    memcpy(&key[6],  &info->mipLodBias,    sizeof(uint32_t));
+    key[7]  = info->anisotropyEnable;
+    memcpy(&key[8],  &info->maxAnisotropy, sizeof(uint32_t));
+    key[9]  = info->compareEnable;
+    key[10] = static_cast<uint32_t>(info->compareOp);
+    memcpy(&key[11], &info->minLod,        sizeof(uint32_t));
+    memcpy(&key[12], &info->maxLod,        sizeof(uint32_t));
+    key[13] = static_cast<uint32_t>(info->borderColor);
+    key[14] = info->unnormalizedCoordinates;
+
+    return key;
+}
+
+VkSampler
+SamplerCache::Acquire(const VkSamplerCreateInfo *info)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    const Key_t key = GetKey(info);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mSamplers.find(key);
+    if(it != mSamplers.end()) {
+        ++it->second.refCount;
+        return it->second.sampler;
+    }
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkResult err = vkCreateSampler(mVkContext->vkDevice, info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_RESOURCES), &sampler);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+
+    Entry_t entry;
+    entry.sampler  = sampler;
+    entry.refCount = 1;
+    mSamplers.insert(std::make_pair(key, entry));
+
+    return sampler;
+}
+
+void
+SamplerCache::Release(VkSampler sampler)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // few distinct states exist, so a linear search is cheaper than a second map
+    for(auto &entry : mSamplers) {
+        if(entry.second.sampler == sampler) {
+            assert(entry.second.refCount);
+            --entry.second.refCount;
+            return;
+        }
+    }
+}
+
+}
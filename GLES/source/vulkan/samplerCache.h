@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       samplerCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Shared, Reference Counted VkSampler Objects
+ *
+ */
+
+#ifndef __VKSAMPLERCACHE_H__
+#define __VKSAMPLERCACHE_H__
+
+#include <array>
+#include <map>
+#include <mutex>
+#include "context.h"
+
+namespace vulkanAPI {
+
+class SamplerCache final {
+private:
+    /// every VkSamplerCreateInfo field that affects sampling, floats by their bit pattern
+    typedef std::array<uint32_t, 15>        Key_t;
+
+    typedef struct Entry_t {
+        VkSampler                          sampler;
+        uint32_t                           refCount;
+    } Entry_t;
+
+    const vkContext_t                      *mVkContext;
+
+    std::mutex                              mMutex;
+    std::map<Key_t, Entry_t>                mSamplers;
+
+    static Key_t                            GetKey(const VkSamplerCreateInfo *info);
+
+public:
+// Constructor
+    SamplerCache(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~SamplerCache();
+
+// Acquire/Release Functions
+    VkSampler                               Acquire(const VkSamplerCreateInfo *info);
+    void                                    Release(VkSampler sampler);
+
+// Get Functions
+    inline uint32_t                         GetSamplerCount(void)             const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mSamplers.size()); }
+};
+
+}
+
+#endif // __VKSAMPLERCACHE_H__
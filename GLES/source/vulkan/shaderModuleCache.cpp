@@ -0,0 +1,142 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       shaderModuleCache.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Shared, Reference Counted VkShaderModule Objects
+ *
+ *  @section
+ *
+ *  Programs that link the same shader stage against different counterparts
+ *  often end up with identical SPIR-V for it. Modules are therefore looked up
+ *  by their code and shared between all programs using it, which spares the
+ *  driver compiling the same module again and keeps the stage identity stable
+ *  across the pipelines created from them. A module is only needed while
+ *  pipelines are created from it, so the last release destroys it right away.
+ *  The cache is shared by all contexts, so access to it is serialized.
+ *
+ */
+
+#include <cstring>
+#include "shaderModuleCache.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+ShaderModuleCache::ShaderModuleCache(const vkContext_t *vkContext)
+: mVkContext(vkContext)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+ShaderModuleCache::~ShaderModuleCache()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    for(auto &entry : mModules) {
+        vkDestroyShaderModule(mVkContext->vkDevice, entry.second.module, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+    }
+    mModules.clear();
+    mModuleKeys.clear();
+}
+
+uint64_t
+ShaderModuleCache::GetKey(const uint32_t *spirv, size_t size)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    /// FNV-1a over the words of the module
+    uint64_t key = 0xcbf29ce484222325ULL;
+    for(size_t word = 0; word < size; ++word) {
+        key = (key ^ spirv[word]) * 0x100000001b3ULL;
+    }
+
+    return key;
+}
+
+VkShaderModule
+ShaderModuleCache::Acquire(const uint32_t *spirv, size_t size)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!size) {
+        return VK_NULL_HANDLE;
+    }
+
+    const uint64_t key = GetKey(spirv, size);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto range = mModules.equal_range(key);
+    for(auto it = range.first; it != range.second; ++it) {
+        if(it->second.spirv.size() == size && !memcmp(it->second.spirv.data(), spirv, size * sizeof(uint32_t))) {
+            ++it->second.refCount;
+            return it->second.module;
+        }
+    }
+
+    VkShaderModuleCreateInfo info;
+    info.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    info.pNext    = nullptr;
+    info.flags    = 0;
+    info.codeSize = size * sizeof(uint32_t);
+    info.pCode    = spirv;
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if(vkCreateShaderModule(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES), &module) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+
+    Entry_t entry;
+    entry.module   = module;
+    entry.refCount = 1;
+    entry.spirv.assign(spirv, spirv + size);
+    mModules.insert(std::make_pair(key, entry));
+    mModuleKeys[module] = key;
+
+    return module;
+}
+
+void
+ShaderModuleCache::Release(VkShaderModule module)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto keyIt = mModuleKeys.find(module);
+    if(keyIt == mModuleKeys.end()) {
+        return;
+    }
+
+    auto range = mModules.equal_range(keyIt->second);
+    for(auto it = range.first; it != range.second; ++it) {
+        if(it->second.module != module) {
+            continue;
+        }
+
+        assert(it->second.refCount);
+        if(--it->second.refCount == 0) {
+            vkDestroyShaderModule(mVkContext->vkDevice, module, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_PIPELINES));
+            mModules.erase(it);
+            mModuleKeys.erase(keyIt);
+        }
+        return;
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       shaderModuleCache.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Shared, Reference Counted VkShaderModule Objects
+ *
+ */
+
+#ifndef __VKSHADERMODULECACHE_H__
+#define __VKSHADERMODULECACHE_H__
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "context.h"
+
+namespace vulkanAPI {
+
+class ShaderModuleCache final {
+private:
+    typedef struct Entry_t {
+        VkShaderModule                     module;
+        uint32_t                           refCount;
+        /// tells apart modules whose hashes collide
+        std::vector<uint32_t>              spirv;
+    } Entry_t;
+
+    const vkContext_t                      *mVkContext;
+
+    std::mutex                              mMutex;
+    std::multimap<uint64_t, Entry_t>        mModules;
+    std::map<VkShaderModule, uint64_t>      mModuleKeys;
+
+    static uint64_t                         GetKey(const uint32_t *spirv, size_t size);
+
+public:
+// Constructor
+    ShaderModuleCache(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~ShaderModuleCache();
+
+// Acquire/Release Functions
+    VkShaderModule                          Acquire(const uint32_t *spirv, size_t size);
+    void                                    Release(VkShaderModule module);
+
+// Get Functions
+    inline uint32_t                         GetModuleCount(void)              const { FUN_ENTRY(GL_LOG_TRACE); return static_cast<uint32_t>(mModules.size()); }
+};
+
+}
+
+#endif // __VKSHADERMODULECACHE_H__
@@ -0,0 +1,180 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       timeline.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Determine completion of execution of queue operations via timeline semaphores in Vulkan
+ *
+ *  @scope
+ *
+ *  The signal operation of a submission covers all the work submitted to the
+ *  queue before it, so once the counter has reached a value every submission
+ *  up to the one that signaled it has completed. Unlike a fence, the counter
+ *  is read without a wait and without being reset, and other submissions can
+ *  wait on a value of it, on any queue.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include "timeline.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+Timeline::Timeline(const vkContext_t *vkContext)
+: mVkContext(vkContext), mVkSemaphore(VK_NULL_HANDLE), mCompletedValue(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+}
+
+Timeline::~Timeline()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+void
+Timeline::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(mVkContext->vkDevice, mVkSemaphore, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE));
+        mVkSemaphore = VK_NULL_HANDLE;
+    }
+    mCompletedValue = 0;
+}
+
+bool
+Timeline::Create(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+#ifdef VK_KHR_timeline_semaphore
+    if(!mVkContext->mIsTimelineSemaphoreSupported) {
+        return false;
+    }
+
+    VkSemaphoreTypeCreateInfoKHR typeInfo;
+    typeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeInfo.pNext         = nullptr;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeInfo.initialValue  = 0;
+
+    VkSemaphoreCreateInfo info;
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    info.pNext = &typeInfo;
+    info.flags = 0;
+
+    VkResult err = vkCreateSemaphore(mVkContext->vkDevice, &info, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &mVkSemaphore);
+    assert(!err);
+
+    mCompletedValue = 0;
+
+    return err == VK_SUCCESS;
+#else
+    return false;
+#endif // VK_KHR_timeline_semaphore
+}
+
+uint64_t
+Timeline::GetCompletedValue(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+#ifdef VK_KHR_timeline_semaphore
+    uint64_t value = 0;
+    if(mVkSemaphore != VK_NULL_HANDLE &&
+       mVkContext->fpGetSemaphoreCounterValueKHR(mVkContext->vkDevice, mVkSemaphore, &value) == VK_SUCCESS) {
+        mCompletedValue = std::max(mCompletedValue, value);
+    }
+#endif // VK_KHR_timeline_semaphore
+
+    return mCompletedValue;
+}
+
+bool
+Timeline::Wait(uint64_t value, uint64_t timeout)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(IsCompleted(value)) {
+        return true;
+    }
+
+#ifdef VK_KHR_timeline_semaphore
+    VkSemaphoreWaitInfoKHR info;
+    info.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    info.pNext          = nullptr;
+    info.flags          = 0;
+    info.semaphoreCount = 1;
+    info.pSemaphores    = &mVkSemaphore;
+    info.pValues        = &value;
+
+    const auto start = std::chrono::steady_clock::now();
+    VkResult err;
+    do {
+        err = mVkContext->fpWaitSemaphoresKHR(mVkContext->vkDevice, &info, timeout);
+        assert(err == VK_SUCCESS || err == VK_TIMEOUT);
+
+        if(err == VK_ERROR_OUT_OF_HOST_MEMORY || err == VK_ERROR_OUT_OF_DEVICE_MEMORY || err == VK_ERROR_DEVICE_LOST) {
+            return false;
+        }
+    } while(err == VK_TIMEOUT);
+
+    // waits on a counter block the calling thread the same way fence waits do
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    mVkContext->perfCounters->Add(PERF_COUNTER_FENCE_WAITS);
+    mVkContext->perfCounters->Add(PERF_COUNTER_FENCE_WAIT_NS, static_cast<uint64_t>(duration.count()));
+    StallDetector::Record(STALL_REASON_FENCE, static_cast<uint64_t>(duration.count()));
+
+    mCompletedValue = std::max(mCompletedValue, value);
+
+    return true;
+#else
+    return false;
+#endif // VK_KHR_timeline_semaphore
+}
+
+const void *
+TimelineSubmitInfo::Chain(const void *next)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // submissions without a timeline semaphore keep the structure out of their chain
+#ifdef VK_KHR_timeline_semaphore
+    if(!mTimeline) {
+        return next;
+    }
+
+    mInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    mInfo.pNext                     = next;
+    mInfo.waitSemaphoreValueCount   = static_cast<uint32_t>(mWaitValues.size());
+    mInfo.pWaitSemaphoreValues      = mWaitValues.data();
+    mInfo.signalSemaphoreValueCount = static_cast<uint32_t>(mSignalValues.size());
+    mInfo.pSignalSemaphoreValues    = mSignalValues.data();
+
+    return &mInfo;
+#else
+    return next;
+#endif // VK_KHR_timeline_semaphore
+}
+
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       timeline.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Determine completion of execution of queue operations via timeline semaphores in Vulkan
+ *
+ */
+
+#ifndef __VKTIMELINE_H__
+#define __VKTIMELINE_H__
+
+#include "context.h"
+#include "utils/fixedVector.hpp"
+
+/// Semaphores a submission waits on, or signals, at most: the uploads, the swapchain and the timeline ones
+#define GLOVE_MAX_SUBMIT_SEMAPHORES                     4
+
+namespace vulkanAPI {
+
+/// Counter signaled by the submissions of a queue with increasing values,
+/// a submission has completed once the counter has reached its value
+class Timeline {
+
+private:
+
+    const
+    vkContext_t *                     mVkContext;
+
+    VkSemaphore                       mVkSemaphore;
+
+    /// the highest value the counter has been seen with, it never goes back
+    uint64_t                          mCompletedValue;
+
+public:
+// Constructor
+    Timeline(const vkContext_t *vkContext = nullptr);
+
+// Destructor
+    ~Timeline();
+
+// Create Functions
+    bool                              Create(void);
+
+// Release Functions
+    void                              Release(void);
+
+// Wait Functions
+    bool                              Wait(uint64_t value, uint64_t timeout);
+
+// Get Functions
+    inline VkSemaphore                GetSemaphore(void)                  const { FUN_ENTRY(GL_LOG_TRACE); return mVkSemaphore; }
+    uint64_t                          GetCompletedValue(void);
+
+// Set Functions
+    inline void                       SetContext(const vkContext_t *vkContext)  { FUN_ENTRY(GL_LOG_TRACE); mVkContext = vkContext; }
+
+// Is Functions
+    inline bool                       IsCreated(void)                     const { FUN_ENTRY(GL_LOG_TRACE); return mVkSemaphore != VK_NULL_HANDLE; }
+    inline bool                       IsCompleted(uint64_t value)               { FUN_ENTRY(GL_LOG_TRACE); return value <= mCompletedValue || value <= GetCompletedValue(); }
+};
+
+/// Values of the semaphores a submission waits on and signals, in the order of its semaphores.
+/// binary semaphores ignore theirs
+class TimelineSubmitInfo {
+
+private:
+
+#ifdef VK_KHR_timeline_semaphore
+    VkTimelineSemaphoreSubmitInfoKHR  mInfo;
+#endif // VK_KHR_timeline_semaphore
+    FixedVector<uint64_t, GLOVE_MAX_SUBMIT_SEMAPHORES> mWaitValues;
+    FixedVector<uint64_t, GLOVE_MAX_SUBMIT_SEMAPHORES> mSignalValues;
+    bool                              mTimeline;
+
+public:
+// Constructor
+    TimelineSubmitInfo() : mTimeline(false) { FUN_ENTRY(GL_LOG_TRACE); }
+
+// Add Functions
+    inline void                       AddWait(uint64_t value)                   { FUN_ENTRY(GL_LOG_TRACE); mWaitValues.push_back(value);   mTimeline |= value != 0; }
+    inline void                       AddSignal(uint64_t value)                 { FUN_ENTRY(GL_LOG_TRACE); mSignalValues.push_back(value); mTimeline |= value != 0; }
+
+// Chain Functions
+    const void                       *Chain(const void *next);
+};
+
+}
+
+#endif // __VKTIMELINE_H__
@@ -0,0 +1,242 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       uniformRing.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Uniform Data Ring Buffer Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Uniform data of every draw is written into fresh space of a single host
+ *  visible buffer that stays mapped, and is bound as a dynamic uniform buffer
+ *  so that only the offset changes between draws. Space is handed out
+ *  linearly and is reclaimed one frame at a time, once the fence of the
+ *  frame that used it has signaled. When the ring runs out of space it is
+ *  replaced by a larger one and the old buffer is kept alive until every
+ *  frame that refers to it has retired. The same ring streams client vertex
+ *  arrays, bound with vertex buffer offsets instead.
+ *
+ */
+
+#include <algorithm>
+#include "uniformRing.h"
+
+namespace vulkanAPI {
+
+std::atomic<uint64_t> UniformRing::mNextSerial(0);
+
+UniformRing::UniformRing(const vkContext_t *vkContext, VkBufferUsageFlags usage, VkDeviceSize alignment, VkDeviceSize initialSize)
+: mVkContext(vkContext), mUsage(usage), mInitialSize(initialSize), mSize(0), mAlignment(alignment), mHead(0), mTail(0), mGeneration(0), mSerial(++mNextSerial)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mRingBuffer.buffer = nullptr;
+    mRingBuffer.memory = nullptr;
+
+    for(uint32_t i = 0; i < GLOVE_FRAMES_IN_FLIGHT; ++i) {
+        mFrameEnd[i] = 0;
+    }
+}
+
+UniformRing::~UniformRing()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+void
+UniformRing::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    RetireAll();
+    ReleaseRingBuffer(&mRingBuffer);
+
+    mSize = 0;
+}
+
+void
+UniformRing::ReleaseRingBuffer(RingBuffer_t *ringBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    delete ringBuffer->buffer;
+    delete ringBuffer->memory;
+    ringBuffer->buffer = nullptr;
+    ringBuffer->memory = nullptr;
+}
+
+void
+UniformRing::ReleaseRingBuffers(std::vector<RingBuffer_t> *ringBuffers)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(auto &ringBuffer : *ringBuffers) {
+        ReleaseRingBuffer(&ringBuffer);
+    }
+    ringBuffers->clear();
+}
+
+bool
+UniformRing::CreateRingBuffer(VkDeviceSize size)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // unless given, the alignment is the one of dynamic uniform buffer offsets
+    if(!mAlignment) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(mVkContext->vkPhysicalDevice, &properties);
+        mAlignment = std::max(properties.limits.minUniformBufferOffsetAlignment, static_cast<VkDeviceSize>(1));
+    }
+
+    RingBuffer_t ringBuffer;
+    ringBuffer.buffer = new Buffer(mVkContext, mUsage, VK_SHARING_MODE_EXCLUSIVE);
+    ringBuffer.memory = new Memory(mVkContext, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    // every draw reads its blocks out of the ring, which is kept in device memory where the host can write it
+    ringBuffer.memory->SetPreferredFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    ringBuffer.buffer->SetSize(size);
+
+    if(!ringBuffer.buffer->Create()                                                     ||
+       !ringBuffer.memory->GetBufferMemoryRequirements(ringBuffer.buffer->GetVkBuffer()) ||
+       !ringBuffer.memory->Create()                                                     ||
+       !ringBuffer.memory->BindBufferMemory(ringBuffer.buffer->GetVkBuffer())) {
+        ReleaseRingBuffer(&ringBuffer);
+        return false;
+    }
+
+    // the command buffer being recorded may still refer to the old ring
+    if(mRingBuffer.buffer) {
+        mPendingRingBuffers.push_back(mRingBuffer);
+    }
+
+    mRingBuffer = ringBuffer;
+    mSize       = size;
+    mHead       = 0;
+    mTail       = 0;
+    for(uint32_t i = 0; i < GLOVE_FRAMES_IN_FLIGHT; ++i) {
+        mFrameEnd[i] = 0;
+    }
+
+    mGeneration = ++mNextSerial;
+    mSerial     = ++mNextSerial;
+
+    return true;
+}
+
+bool
+UniformRing::FindSpace(VkDeviceSize size, VkDeviceSize *offset) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // head never catches up with the tail, so that head == tail always means empty
+    VkDeviceSize alignedHead = (mHead + mAlignment - 1) & ~(mAlignment - 1);
+
+    if(mHead >= mTail) {
+        if(alignedHead + size <= mSize) {
+            *offset = alignedHead;
+            return true;
+        }
+
+        if(size < mTail) {
+            *offset = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    if(alignedHead + size < mTail) {
+        *offset = alignedHead;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+UniformRing::Allocate(VkDeviceSize size, const void *data, uint32_t *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkDeviceSize ringOffset = 0;
+
+    if(!mRingBuffer.buffer || !FindSpace(size, &ringOffset)) {
+        VkDeviceSize ringSize = mSize ? mSize * 2 : mInitialSize;
+        while(ringSize < size * 2) {
+            ringSize *= 2;
+        }
+
+        if(!CreateRingBuffer(ringSize)) {
+            return false;
+        }
+
+        ringOffset = 0;
+    }
+
+    if(!mRingBuffer.memory->SetData(size, ringOffset, data)) {
+        return false;
+    }
+
+    mHead   = ringOffset + size;
+    *offset = static_cast<uint32_t>(ringOffset);
+
+    return true;
+}
+
+void
+UniformRing::SubmitFrame(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    // space written so far belongs to the submitted frame (or older ones)
+    mFrameEnd[frame] = mHead;
+    mRetiredRingBuffers[frame].insert(mRetiredRingBuffers[frame].end(), mPendingRingBuffers.begin(), mPendingRingBuffers.end());
+    mPendingRingBuffers.clear();
+
+    mSerial = ++mNextSerial;
+}
+
+void
+UniformRing::RetireFrame(uint32_t frame)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    assert(frame < GLOVE_FRAMES_IN_FLIGHT);
+
+    mTail = mFrameEnd[frame];
+    ReleaseRingBuffers(&mRetiredRingBuffers[frame]);
+}
+
+void
+UniformRing::RetireAll(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(uint32_t i = 0; i < GLOVE_FRAMES_IN_FLIGHT; ++i) {
+        ReleaseRingBuffers(&mRetiredRingBuffers[i]);
+        mFrameEnd[i] = mHead;
+    }
+    ReleaseRingBuffers(&mPendingRingBuffers);
+
+    mTail = mHead;
+    mSerial = ++mNextSerial;
+}
+
+}
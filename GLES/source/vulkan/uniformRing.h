@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       uniformRing.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Uniform Data Ring Buffer Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKUNIFORMRING_H__
+#define __VKUNIFORMRING_H__
+
+#include <atomic>
+#include <vector>
+#include "context.h"
+#include "buffer.h"
+#include "memory.h"
+#include "commandBufferManager.h"
+
+/// Initial size of the uniform ring buffer, doubled whenever it runs out of space
+#define GLOVE_UNIFORM_RING_SIZE                         (4 * 1024 * 1024)
+
+/// Alignment of client vertex array and index data streamed through a ring
+#define GLOVE_VERTEX_RING_ALIGNMENT                     16
+
+namespace vulkanAPI {
+
+class UniformRing final {
+private:
+
+    typedef struct RingBuffer_t {
+        Buffer                     *buffer;
+        Memory                     *memory;
+    } RingBuffer_t;
+
+    /// serials and generations are unique among all the rings, so that data written
+    /// into one is never taken for data written into another one swapped in for it
+    static std::atomic<uint64_t>    mNextSerial;
+
+    const vkContext_t              *mVkContext;
+    VkBufferUsageFlags              mUsage;
+    VkDeviceSize                    mInitialSize;
+
+    RingBuffer_t                    mRingBuffer;
+    VkDeviceSize                    mSize;
+    VkDeviceSize                    mAlignment;
+    VkDeviceSize                    mHead;
+    VkDeviceSize                    mTail;
+    VkDeviceSize                    mFrameEnd[GLOVE_FRAMES_IN_FLIGHT];
+    uint64_t                        mGeneration;
+    uint64_t                        mSerial;
+
+    /// ring buffers replaced while recording, and the ones kept alive by each frame in flight
+    std::vector<RingBuffer_t>       mPendingRingBuffers;
+    std::vector<RingBuffer_t>       mRetiredRingBuffers[GLOVE_FRAMES_IN_FLIGHT];
+
+    bool                            CreateRingBuffer(VkDeviceSize size);
+    void                            ReleaseRingBuffer(RingBuffer_t *ringBuffer);
+    void                            ReleaseRingBuffers(std::vector<RingBuffer_t> *ringBuffers);
+    bool                            FindSpace(VkDeviceSize size, VkDeviceSize *offset) const;
+
+public:
+// Constructor
+    UniformRing(const vkContext_t *vkContext = nullptr, VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VkDeviceSize alignment = 0,
+                VkDeviceSize initialSize = GLOVE_UNIFORM_RING_SIZE);
+
+// Destructor
+    ~UniformRing();
+
+// Release Functions
+    void                            Release(void);
+
+// Allocate Functions
+    bool                            Allocate(VkDeviceSize size, const void *data, uint32_t *offset);
+
+// Submit Functions
+    void                            SubmitFrame(uint32_t frame);
+
+// Retire Functions
+    void                            RetireFrame(uint32_t frame);
+    void                            RetireAll(void);
+
+// Get Functions
+    inline VkBuffer                 GetVkBuffer(void)                         const { FUN_ENTRY(GL_LOG_TRACE); return mRingBuffer.buffer ? mRingBuffer.buffer->GetVkBuffer() : VK_NULL_HANDLE; }
+    inline uint64_t                 GetGeneration(void)                       const { FUN_ENTRY(GL_LOG_TRACE); return mGeneration; }
+    inline uint64_t                 GetSerial(void)                           const { FUN_ENTRY(GL_LOG_TRACE); return mSerial; }
+};
+
+}
+
+#endif // __VKUNIFORMRING_H__
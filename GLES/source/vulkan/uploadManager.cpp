@@ -0,0 +1,815 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       uploadManager.cpp
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Upload Manager Functionality in Vulkan
+ *
+ *  @section
+ *
+ *  Host to device copies are batched into a single command buffer that is
+ *  submitted to the transfer queue (a dedicated transfer queue family is
+ *  used when the device exposes one). The batch is flushed right before the
+ *  next graphics submission, which waits on the batch semaphore instead of
+ *  the CPU waiting for the queue to become idle. Uploads are written into a
+ *  persistently mapped staging ring whose space is reclaimed once the batch
+ *  that used it has retired; uploads that do not fit get a staging buffer of
+ *  their own, recycled the same way. Consecutive buffer to image copies that
+ *  target the same image from the same staging buffer are held back and
+ *  recorded as a single copy command with one region each, so that many
+ *  small sub-image updates cost a single pair of layout transitions. Where
+ *  timeline semaphores are supported, the batches signal a counter of the
+ *  transfer queue instead, which both the graphics submissions and the CPU
+ *  wait on for the id of a batch.
+ *
+ */
+
+#include <algorithm>
+#include "uploadManager.h"
+#include "perfCounters.h"
+#include "hostAllocator.h"
+
+namespace vulkanAPI {
+
+#define GLOVE_UPLOAD_FENCE_WAIT_TIMEOUT                 UINT64_MAX
+
+UploadManager::UploadManager(const vkContext_t *context)
+: mVkContext(context), mVkCmdPool(VK_NULL_HANDLE), mActiveBatch(0), mNextBatchId(0), mTimeline(context),
+  mFreeStagingSize(0), mRingHead(0), mRingTail(0)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    mStagingRing.buffer = nullptr;
+    mStagingRing.memory = nullptr;
+
+    mPendingImageCopy.buffer = VK_NULL_HANDLE;
+    mPendingImageCopy.image  = VK_NULL_HANDLE;
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        mBatches[i].commandBuffer = VK_NULL_HANDLE;
+        mBatches[i].semaphore     = VK_NULL_HANDLE;
+        mBatches[i].ringEnd       = 0;
+        mBatches[i].id            = mNextBatchId++;
+        mBatches[i].recording     = false;
+        mBatches[i].submitted     = false;
+    }
+
+    if(!CreateVkBatches()) {
+        assert(false);
+        return ;
+    }
+
+    // without the ring every upload falls back to a staging buffer of its own
+    CreateStagingRing();
+}
+
+UploadManager::~UploadManager()
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    Release();
+}
+
+bool
+UploadManager::CreateVkBatches(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    VkCommandPoolCreateInfo cmdPoolInfo;
+    cmdPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.pNext            = nullptr;
+    cmdPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolInfo.queueFamilyIndex = mVkContext->vkTransferQueueNodeIndex;
+
+    VkResult err = vkCreateCommandPool(mVkContext->vkDevice, &cmdPoolInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS), &mVkCmdPool);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo cmdAllocInfo;
+    cmdAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.pNext              = nullptr;
+    cmdAllocInfo.commandPool        = mVkCmdPool;
+    cmdAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = 1;
+
+    // the batches fall back to a fence and a semaphore each without the counter
+    if(mVkContext->mIsTimelineSemaphoreSupported && !mTimeline.Create()) {
+        return false;
+    }
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo;
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+    semaphoreCreateInfo.flags = 0;
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        err = vkAllocateCommandBuffers(mVkContext->vkDevice, &cmdAllocInfo, &mBatches[i].commandBuffer);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
+
+        if(mTimeline.IsCreated()) {
+            continue;
+        }
+
+        err = vkCreateSemaphore(mVkContext->vkDevice, &semaphoreCreateInfo, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE), &mBatches[i].semaphore);
+        assert(!err);
+
+        if(err != VK_SUCCESS) {
+            return false;
+        }
+
+        mBatches[i].fence.SetContext(mVkContext);
+        if(!mBatches[i].fence.Create(false)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+UploadManager::CreateStagingRing(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the pixel conversion kernel reads and writes the ring in place
+    mStagingRing.buffer = new Buffer(mVkContext, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    mStagingRing.memory = new Memory(mVkContext, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    mStagingRing.buffer->SetSize(GLOVE_STAGING_RING_SIZE);
+
+    if(!mStagingRing.buffer->Create()                                                      ||
+       !mStagingRing.memory->GetBufferMemoryRequirements(mStagingRing.buffer->GetVkBuffer()) ||
+       !mStagingRing.memory->Create()                                                      ||
+       !mStagingRing.memory->BindBufferMemory(mStagingRing.buffer->GetVkBuffer())) {
+        ReleaseStagingBuffer(&mStagingRing);
+        return false;
+    }
+
+    mRingHead = 0;
+    mRingTail = 0;
+
+    return true;
+}
+
+void
+UploadManager::Release(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mVkCmdPool == VK_NULL_HANDLE) {
+        return;
+    }
+
+    WaitAll();
+
+    ReleaseFreeStagingBuffers();
+    ReleaseStagingBuffer(&mStagingRing);
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        mBatches[i].fence.Release();
+
+        if(mBatches[i].semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(mVkContext->vkDevice, mBatches[i].semaphore, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_DEVICE));
+            mBatches[i].semaphore = VK_NULL_HANDLE;
+        }
+
+        if(mBatches[i].commandBuffer != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(mVkContext->vkDevice, mVkCmdPool, 1, &mBatches[i].commandBuffer);
+            mBatches[i].commandBuffer = VK_NULL_HANDLE;
+        }
+    }
+
+    mTimeline.Release();
+
+    vkDestroyCommandPool(mVkContext->vkDevice, mVkCmdPool, mVkContext->hostAllocator->GetCallbacks(HOST_ALLOCATION_COMMANDS));
+    mVkCmdPool = VK_NULL_HANDLE;
+}
+
+void
+UploadManager::ReleaseStagingBuffer(StagingBuffer_t *stagingBuffer)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    delete stagingBuffer->buffer;
+    delete stagingBuffer->memory;
+    stagingBuffer->buffer = nullptr;
+    stagingBuffer->memory = nullptr;
+}
+
+bool
+UploadManager::AllocateFromStagingRing(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!mStagingRing.buffer || size > GLOVE_STAGING_RING_SIZE / 2) {
+        return false;
+    }
+
+    // buffer to image copies need offsets that are multiples of both 4 and the texel size
+    VkDeviceSize texelAlignment = std::max(alignment, static_cast<VkDeviceSize>(1));
+    VkDeviceSize ringAlignment  = texelAlignment;
+    while(ringAlignment % 4) {
+        ringAlignment += texelAlignment;
+    }
+    VkDeviceSize alignedHead = (mRingHead + ringAlignment - 1) / ringAlignment * ringAlignment;
+
+    // head never catches up with the tail, so that head == tail always means empty
+    if(mRingHead >= mRingTail) {
+        if(alignedHead + size <= GLOVE_STAGING_RING_SIZE) {
+            *offset = alignedHead;
+        } else if(size < mRingTail) {
+            *offset = 0;
+        } else {
+            return false;
+        }
+    } else if(alignedHead + size < mRingTail) {
+        *offset = alignedHead;
+    } else {
+        return false;
+    }
+
+    mRingHead = *offset + size;
+
+    return true;
+}
+
+VkBuffer
+UploadManager::AllocateStagingBuffer(VkDeviceSize size, const void *data, VkDeviceSize alignment, VkDeviceSize *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Batch_t *batch = BeginBatch();
+    if(!batch) {
+        return VK_NULL_HANDLE;
+    }
+
+    mVkContext->perfCounters->Add(PERF_COUNTER_BYTES_UPLOADED, size);
+
+    if(AllocateFromStagingRing(size, alignment, offset)) {
+        if(!mStagingRing.memory->SetData(size, *offset, data)) {
+            return VK_NULL_HANDLE;
+        }
+
+        return mStagingRing.buffer->GetVkBuffer();
+    }
+
+    *offset = 0;
+
+    // reuse the smallest free staging buffer that can hold the data
+    int32_t bestFit = -1;
+    for(uint32_t i = 0; i < mFreeStagingBuffers.size(); ++i) {
+        VkDeviceSize freeSize = mFreeStagingBuffers[i].buffer->GetSize();
+        if(freeSize >= size && (bestFit < 0 || freeSize < mFreeStagingBuffers[bestFit].buffer->GetSize())) {
+            bestFit = static_cast<int32_t>(i);
+        }
+    }
+
+    StagingBuffer_t stagingBuffer;
+    if(bestFit >= 0) {
+        stagingBuffer = mFreeStagingBuffers[bestFit];
+        mFreeStagingBuffers.erase(mFreeStagingBuffers.begin() + bestFit);
+        mFreeStagingSize -= stagingBuffer.buffer->GetSize();
+
+        if(!stagingBuffer.memory->SetData(size, 0, data)) {
+            ReleaseStagingBuffer(&stagingBuffer);
+            return VK_NULL_HANDLE;
+        }
+    } else {
+        stagingBuffer.buffer = new Buffer(mVkContext, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE);
+        stagingBuffer.memory = new Memory(mVkContext, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer.buffer->SetSize(size);
+
+        if(!stagingBuffer.buffer->Create()                                                   ||
+           !stagingBuffer.memory->GetBufferMemoryRequirements(stagingBuffer.buffer->GetVkBuffer()) ||
+           !stagingBuffer.memory->Create()                                                   ||
+           !stagingBuffer.memory->SetData(size, 0, data)                                     ||
+           !stagingBuffer.memory->BindBufferMemory(stagingBuffer.buffer->GetVkBuffer())) {
+            ReleaseStagingBuffer(&stagingBuffer);
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    batch->stagingBuffers.push_back(stagingBuffer);
+
+    return stagingBuffer.buffer->GetVkBuffer();
+}
+
+VkBuffer
+UploadManager::AllocateStagingRing(VkDeviceSize size, const void *data, VkDeviceSize alignment, VkDeviceSize *offset)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // space for the device to write into has no data of the host
+    Batch_t *batch = BeginBatch();
+    if(!batch || !AllocateFromStagingRing(size, alignment, offset)) {
+        return VK_NULL_HANDLE;
+    }
+
+    if(data) {
+        mVkContext->perfCounters->Add(PERF_COUNTER_BYTES_UPLOADED, size);
+        if(!mStagingRing.memory->SetData(size, *offset, data)) {
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    return mStagingRing.buffer->GetVkBuffer();
+}
+
+UploadManager::Batch_t *
+UploadManager::BeginBatch(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Batch_t *batch = &mBatches[mActiveBatch];
+
+    if(batch->recording) {
+        return batch;
+    }
+
+    // the ring has wrapped around to a batch that may still be in flight
+    if(!RetireBatch(batch)) {
+        return nullptr;
+    }
+
+    VkCommandBufferBeginInfo info;
+    info.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    info.pNext            = nullptr;
+    info.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    info.pInheritanceInfo = nullptr;
+
+    VkResult err = vkBeginCommandBuffer(batch->commandBuffer, &info);
+    assert(!err);
+
+    if(err != VK_SUCCESS) {
+        return nullptr;
+    }
+
+    batch->id        = mNextBatchId++;
+    batch->recording = true;
+
+    return batch;
+}
+
+VkCommandBuffer *
+UploadManager::BeginVkUploadCommandBuffer(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Batch_t *batch = BeginBatch();
+    if(!batch) {
+        return nullptr;
+    }
+
+    // the caller may record commands on an image with copies still held back
+    FlushImageCopy(batch);
+
+    return &batch->commandBuffer;
+}
+
+bool
+UploadManager::CanMergeImageCopy(VkBuffer srcBuffer, VkImage dstImage, const VkBufferImageCopy *region) const
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mPendingImageCopy.regions.empty() || mPendingImageCopy.buffer != srcBuffer || mPendingImageCopy.image != dstImage) {
+        return false;
+    }
+
+    // regions of a single copy command execute in no particular order, so they must not overlap
+    const VkImageSubresourceLayers *subresource = &region->imageSubresource;
+    for(const auto &pending : mPendingImageCopy.regions) {
+        const VkImageSubresourceLayers *pendingSubresource = &pending.imageSubresource;
+        if(pendingSubresource->aspectMask != subresource->aspectMask) {
+            return false;
+        }
+
+        if(pendingSubresource->mipLevel != subresource->mipLevel ||
+           pendingSubresource->baseArrayLayer >= subresource->baseArrayLayer + subresource->layerCount ||
+           subresource->baseArrayLayer >= pendingSubresource->baseArrayLayer + pendingSubresource->layerCount) {
+            continue;
+        }
+
+        if(pending.imageOffset.x < region->imageOffset.x + static_cast<int32_t>(region->imageExtent.width)  &&
+           region->imageOffset.x < pending.imageOffset.x + static_cast<int32_t>(pending.imageExtent.width)  &&
+           pending.imageOffset.y < region->imageOffset.y + static_cast<int32_t>(region->imageExtent.height) &&
+           region->imageOffset.y < pending.imageOffset.y + static_cast<int32_t>(pending.imageExtent.height)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+UploadManager::FlushImageCopy(Batch_t *batch)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(mPendingImageCopy.regions.empty()) {
+        return;
+    }
+
+    assert(batch->recording);
+
+    // a single transition covers every level and layer that the regions touch
+    const VkBufferImageCopy *first = &mPendingImageCopy.regions[0];
+    uint32_t minLevel = first->imageSubresource.mipLevel;
+    uint32_t maxLevel = first->imageSubresource.mipLevel;
+    uint32_t minLayer = first->imageSubresource.baseArrayLayer;
+    uint32_t maxLayer = first->imageSubresource.baseArrayLayer + first->imageSubresource.layerCount;
+    for(const auto &region : mPendingImageCopy.regions) {
+        minLevel = std::min(minLevel, region.imageSubresource.mipLevel);
+        maxLevel = std::max(maxLevel, region.imageSubresource.mipLevel);
+        minLayer = std::min(minLayer, region.imageSubresource.baseArrayLayer);
+        maxLayer = std::max(maxLayer, region.imageSubresource.baseArrayLayer + region.imageSubresource.layerCount);
+    }
+
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext                           = nullptr;
+    imageMemoryBarrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.oldLayout                       = VK_IMAGE_LAYOUT_GENERAL;
+    imageMemoryBarrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image                           = mPendingImageCopy.image;
+    imageMemoryBarrier.subresourceRange.aspectMask     = first->imageSubresource.aspectMask;
+    imageMemoryBarrier.subresourceRange.baseMipLevel   = minLevel;
+    imageMemoryBarrier.subresourceRange.levelCount     = maxLevel - minLevel + 1;
+    imageMemoryBarrier.subresourceRange.baseArrayLayer = minLayer;
+    imageMemoryBarrier.subresourceRange.layerCount     = maxLayer - minLayer;
+
+    // the source may be a GL pixel unpack buffer, which earlier copies on this queue have filled
+    VkMemoryBarrier memoryBarrier;
+    memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.pNext         = nullptr;
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(batch->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         1, &memoryBarrier, 0, nullptr, 1, &imageMemoryBarrier);
+
+    vkCmdCopyBufferToImage(batch->commandBuffer, mPendingImageCopy.buffer, mPendingImageCopy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(mPendingImageCopy.regions.size()), mPendingImageCopy.regions.data());
+
+    // later work on the graphics queue is ordered by the batch semaphore
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.newLayout     = VK_IMAGE_LAYOUT_GENERAL;
+
+    vkCmdPipelineBarrier(batch->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+    mPendingImageCopy.buffer = VK_NULL_HANDLE;
+    mPendingImageCopy.image  = VK_NULL_HANDLE;
+    mPendingImageCopy.regions.clear();
+}
+
+bool
+UploadManager::CopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, const VkBufferImageCopy *region)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // images are expected in the general layout, and are left in it
+    Batch_t *batch = BeginBatch();
+    if(!batch) {
+        return false;
+    }
+
+    if(!CanMergeImageCopy(srcBuffer, dstImage, region)) {
+        FlushImageCopy(batch);
+        mPendingImageCopy.buffer = srcBuffer;
+        mPendingImageCopy.image  = dstImage;
+    }
+    mPendingImageCopy.regions.push_back(*region);
+
+    return true;
+}
+
+bool
+UploadManager::CopyBuffer(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // buffer copies never touch the images of held back copies, but may overwrite the unpack buffer they read
+    Batch_t *batch = BeginBatch();
+    if(!batch) {
+        return false;
+    }
+    if(mPendingImageCopy.buffer == dstBuffer) {
+        FlushImageCopy(batch);
+    }
+    VkCommandBuffer *uploadCmdBuffer = &batch->commandBuffer;
+
+    // order against every earlier copy on this queue, as the same buffer may be
+    // both the destination of an earlier copy and the source of this one
+    VkMemoryBarrier memoryBarrier;
+    memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.pNext         = nullptr;
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(*uploadCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy region;
+    region.srcOffset = srcOffset;
+    region.dstOffset = dstOffset;
+    region.size      = size;
+
+    vkCmdCopyBuffer(*uploadCmdBuffer, srcBuffer, dstBuffer, 1, &region);
+
+    return true;
+}
+
+bool
+UploadManager::SubmitBatch(Batch_t *batch, bool signalSemaphore)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!EndBatch(batch)) {
+        return false;
+    }
+
+    // the counter is always signaled, whoever waits on the batch
+    const bool timeline = mTimeline.IsCreated();
+    const VkSemaphore timelineSemaphore = mTimeline.GetSemaphore();
+    TimelineSubmitInfo timelineInfo;
+    if(timeline) {
+        timelineInfo.AddSignal(batch->id + 1);
+    }
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                = timelineInfo.Chain(nullptr);
+    submitInfo.waitSemaphoreCount   = 0;
+    submitInfo.pWaitSemaphores      = nullptr;
+    submitInfo.pWaitDstStageMask    = nullptr;
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.pCommandBuffers      = &batch->commandBuffer;
+    submitInfo.signalSemaphoreCount = (timeline || signalSemaphore) ? 1 : 0;
+    submitInfo.pSignalSemaphores    = timeline ? &timelineSemaphore : (signalSemaphore ? &batch->semaphore : nullptr);
+
+    VkResult err;
+    {
+        CHROME_TRACE_SPAN("vkQueueSubmit upload", "vulkan");
+        std::lock_guard<std::mutex> lock(mVkContext->vkQueueMutex);
+        err = vkQueueSubmit(mVkContext->vkTransferQueue, 1, &submitInfo, timeline ? VK_NULL_HANDLE : batch->fence.GetFence());
+    }
+    assert(!err);
+    mVkContext->perfCounters->Add(PERF_COUNTER_QUEUE_SUBMITS);
+
+    if(err != VK_SUCCESS) {
+        return false;
+    }
+
+    SetBatchSubmitted(batch);
+
+    return true;
+}
+
+bool
+UploadManager::EndBatch(Batch_t *batch)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(batch == &mBatches[mActiveBatch]) {
+        FlushImageCopy(batch);
+    }
+
+    VkResult err = vkEndCommandBuffer(batch->commandBuffer);
+    assert(!err);
+
+    batch->recording = false;
+    batch->ringEnd   = mRingHead;
+
+    return err == VK_SUCCESS;
+}
+
+void
+UploadManager::SetBatchSubmitted(Batch_t *batch)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    batch->submitted = true;
+
+    if(batch == &mBatches[mActiveBatch]) {
+        mActiveBatch = (mActiveBatch + 1) % GLOVE_NUM_UPLOAD_BATCHES;
+    }
+}
+
+bool
+UploadManager::RetireBatch(Batch_t *batch)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    if(!batch->submitted) {
+        return true;
+    }
+
+    // batches retire in submission order, so that the staging ring is reclaimed in order too
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        if(mBatches[i].submitted && mBatches[i].id < batch->id && !RetireBatch(&mBatches[i])) {
+            return false;
+        }
+    }
+
+    {
+        CHROME_TRACE_SPAN("upload fence wait", "vulkan");
+        STALL_REASON(STALL_REASON_UPLOAD);
+        if(mTimeline.IsCreated()) {
+            if(!mTimeline.Wait(batch->id + 1, GLOVE_UPLOAD_FENCE_WAIT_TIMEOUT)) {
+                return false;
+            }
+        } else if(!batch->fence.Wait(VK_TRUE, GLOVE_UPLOAD_FENCE_WAIT_TIMEOUT) || !batch->fence.Reset()) {
+            return false;
+        }
+    }
+
+    batch->submitted = false;
+    mRingTail        = batch->ringEnd;
+
+    // keep the staging buffers for later uploads, up to a limit
+    for(auto &stagingBuffer : batch->stagingBuffers) {
+        if(mFreeStagingSize + stagingBuffer.buffer->GetSize() <= GLOVE_MAX_STAGING_POOL_SIZE) {
+            mFreeStagingSize += stagingBuffer.buffer->GetSize();
+            mFreeStagingBuffers.push_back(stagingBuffer);
+        } else {
+            ReleaseStagingBuffer(&stagingBuffer);
+        }
+    }
+    batch->stagingBuffers.clear();
+
+    return true;
+}
+
+void
+UploadManager::ReleaseFreeStagingBuffers(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // the pooled buffers belong to retired batches, nothing refers to them anymore
+    for(auto &stagingBuffer : mFreeStagingBuffers) {
+        ReleaseStagingBuffer(&stagingBuffer);
+    }
+    mFreeStagingBuffers.clear();
+    mFreeStagingSize = 0;
+}
+
+VkCommandBuffer *
+UploadManager::GetVkUploadCommandBuffer(void)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // unlike BeginVkUploadCommandBuffer, copies held back stay mergeable, the caller records no image commands
+    Batch_t *batch = &mBatches[mActiveBatch];
+
+    return batch->recording ? &batch->commandBuffer : nullptr;
+}
+
+VkSemaphore
+UploadManager::SubmitVkUploadCommandBuffer(uint64_t *waitValue)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Batch_t *batch = &mBatches[mActiveBatch];
+    *waitValue = 0;
+
+    if(!batch->recording) {
+        return VK_NULL_HANDLE;
+    }
+
+    // the semaphore must be waited upon by the caller's next submission, for the value given when it is the counter
+    if(!SubmitBatch(batch, true)) {
+        return VK_NULL_HANDLE;
+    }
+
+    if(mTimeline.IsCreated()) {
+        *waitValue = batch->id + 1;
+        return mTimeline.GetSemaphore();
+    }
+
+    return batch->semaphore;
+}
+
+VkCommandBuffer
+UploadManager::EndVkUploadCommandBuffer(VkSemaphore *signalSemaphore, uint64_t *signalValue)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Batch_t *batch = &mBatches[mActiveBatch];
+
+    // the caller puts the batch ahead of its own work in its submission, which is only possible
+    // when both go to the same queue and the batch retires through the counter instead of its fence
+    if(!batch->recording || !mTimeline.IsCreated() || mVkContext->vkTransferQueue != mVkContext->vkQueue) {
+        return VK_NULL_HANDLE;
+    }
+
+    if(!EndBatch(batch)) {
+        return VK_NULL_HANDLE;
+    }
+
+    *signalSemaphore = mTimeline.GetSemaphore();
+    *signalValue     = batch->id + 1;
+
+    return batch->commandBuffer;
+}
+
+void
+UploadManager::SetVkUploadCommandBufferSubmitted(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    Batch_t *batch = &mBatches[mActiveBatch];
+    if(!batch->recording && !batch->submitted) {
+        SetBatchSubmitted(batch);
+    }
+}
+
+bool
+UploadManager::WaitVkUploadBatch(uint64_t batchId)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        Batch_t *batch = &mBatches[i];
+        if(batch->id != batchId) {
+            continue;
+        }
+
+        if(batch->recording && !SubmitBatch(batch, false)) {
+            return false;
+        }
+
+        return RetireBatch(batch);
+    }
+
+    return true;
+}
+
+bool
+UploadManager::IsBatchCompleted(uint64_t batchId)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    // asked without waiting, a batch no longer kept has retired long ago
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        Batch_t *batch = &mBatches[i];
+        if(batch->id != batchId) {
+            continue;
+        }
+
+        if(batch->recording) {
+            return false;
+        }
+
+        if(!batch->submitted) {
+            return true;
+        }
+
+        if(mTimeline.IsCreated()) {
+            return mTimeline.IsCompleted(batch->id + 1);
+        }
+
+        return vkGetFenceStatus(mVkContext->vkDevice, batch->fence.GetFence()) == VK_SUCCESS;
+    }
+
+    return true;
+}
+
+bool
+UploadManager::WaitAll(void)
+{
+    FUN_ENTRY(GL_LOG_DEBUG);
+
+    bool res = true;
+    for(uint32_t i = 0; i < GLOVE_NUM_UPLOAD_BATCHES; ++i) {
+        res &= WaitVkUploadBatch(mBatches[i].id);
+    }
+
+    return res;
+}
+
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ *  @file       uploadManager.h
+ *  @author     Think Silicon
+ *  @date       25/07/2018
+ *  @version    1.0
+ *
+ *  @brief      Upload Manager Functionality in Vulkan
+ *
+ */
+
+#ifndef __VKUPLOADMANAGER_H__
+#define __VKUPLOADMANAGER_H__
+
+#include <vector>
+#include "context.h"
+#include "fence.h"
+#include "timeline.h"
+#include "buffer.h"
+#include "memory.h"
+
+/// Number of upload batches that may be in flight at the same time
+#define GLOVE_NUM_UPLOAD_BATCHES                        2
+
+/// Upper limit of the memory kept in the free staging buffers pool
+#define GLOVE_MAX_STAGING_POOL_SIZE                     (32 * 1024 * 1024)
+
+/// Size of the staging ring that uploads are written into, larger uploads get a staging buffer of their own
+#define GLOVE_STAGING_RING_SIZE                         (8 * 1024 * 1024)
+
+namespace vulkanAPI {
+
+class UploadManager final {
+private:
+
+    typedef struct StagingBuffer_t {
+        Buffer                      *buffer;
+        Memory                      *memory;
+    } StagingBuffer_t;
+
+    typedef struct Batch_t {
+        VkCommandBuffer              commandBuffer;
+        VkSemaphore                  semaphore;
+        Fence                        fence;
+        std::vector<StagingBuffer_t> stagingBuffers;
+        VkDeviceSize                 ringEnd;
+        uint64_t                     id;
+        bool                         recording;
+        bool                         submitted;
+    } Batch_t;
+
+    /// buffer to image copies waiting to be recorded as a single command
+    typedef struct ImageCopy_t {
+        VkBuffer                       buffer;
+        VkImage                        image;
+        std::vector<VkBufferImageCopy> regions;
+    } ImageCopy_t;
+
+    const vkContext_t              *mVkContext;
+
+    VkCommandPool                   mVkCmdPool;
+
+    Batch_t                         mBatches[GLOVE_NUM_UPLOAD_BATCHES];
+    uint32_t                        mActiveBatch;
+    uint64_t                        mNextBatchId;
+
+    /// when supported, every batch signals the counter of the transfer queue with its id plus one,
+    /// instead of its fence and semaphore
+    Timeline                        mTimeline;
+
+    std::vector<StagingBuffer_t>    mFreeStagingBuffers;
+    VkDeviceSize                    mFreeStagingSize;
+
+    StagingBuffer_t                 mStagingRing;
+    VkDeviceSize                    mRingHead;
+    VkDeviceSize                    mRingTail;
+
+    ImageCopy_t                     mPendingImageCopy;
+
+    Batch_t                        *BeginBatch(void);
+    bool                            CreateVkBatches(void);
+    bool                            CreateStagingRing(void);
+    bool                            AllocateFromStagingRing(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset);
+    bool                            RetireBatch(Batch_t *batch);
+    bool                            SubmitBatch(Batch_t *batch, bool signalSemaphore);
+    bool                            EndBatch(Batch_t *batch);
+    void                            SetBatchSubmitted(Batch_t *batch);
+    void                            ReleaseStagingBuffer(StagingBuffer_t *stagingBuffer);
+    bool                            CanMergeImageCopy(VkBuffer srcBuffer, VkImage dstImage, const VkBufferImageCopy *region) const;
+    void                            FlushImageCopy(Batch_t *batch);
+
+public:
+// Constructor
+    UploadManager(const vkContext_t *context = nullptr);
+
+// Destructor
+    ~UploadManager();
+
+// Release Functions
+    void                            Release(void);
+    void                            ReleaseFreeStagingBuffers(void);
+
+// Allocate Functions
+    VkBuffer                        AllocateStagingBuffer(VkDeviceSize size, const void *data, VkDeviceSize alignment, VkDeviceSize *offset);
+    VkBuffer                        AllocateStagingRing(VkDeviceSize size, const void *data, VkDeviceSize alignment, VkDeviceSize *offset);
+
+// Copy Functions
+    bool                            CopyBuffer(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size);
+    bool                            CopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, const VkBufferImageCopy *region);
+
+// Begin Functions
+    VkCommandBuffer                *BeginVkUploadCommandBuffer(void);
+
+// Submit Functions
+    VkSemaphore                     SubmitVkUploadCommandBuffer(uint64_t *waitValue);
+
+// End Functions
+    VkCommandBuffer                 EndVkUploadCommandBuffer(VkSemaphore *signalSemaphore, uint64_t *signalValue);
+    void                            SetVkUploadCommandBufferSubmitted(void);
+
+// Wait Functions
+    bool                            WaitVkUploadBatch(uint64_t batchId);
+    bool                            WaitAll(void);
+
+// Get Functions
+    inline uint64_t                 GetActiveBatchId(void)                    const { FUN_ENTRY(GL_LOG_TRACE); return mBatches[mActiveBatch].id; }
+    inline VkBuffer                 GetStagingRingBuffer(void)                const { FUN_ENTRY(GL_LOG_TRACE); return mStagingRing.buffer ? mStagingRing.buffer->GetVkBuffer() : VK_NULL_HANDLE; }
+    VkCommandBuffer                *GetVkUploadCommandBuffer(void);
+    inline bool                     IsRecording(void)                         const { FUN_ENTRY(GL_LOG_TRACE); return mBatches[mActiveBatch].recording; }
+    inline bool                     IsBatchSubmitted(uint64_t batchId)        const { FUN_ENTRY(GL_LOG_TRACE); return !(mBatches[mActiveBatch].recording && mBatches[mActiveBatch].id == batchId); }
+    bool                            IsBatchCompleted(uint64_t batchId);
+};
+
+}
+
+#endif // __VKUPLOADMANAGER_H__
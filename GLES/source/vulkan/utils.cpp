@@ -25,7 +25,10 @@
  *
  */
 
+#include <algorithm>
 #include "utils.h"
+#include "context.h"
+#include "capabilityCache.h"
 #include "utils/glLogger.h"
 #include "utils/parser_helpers.h"
 
@@ -60,11 +63,10 @@ GetVkFormatStencilBits(VkFormat format)
 }
 
 VkFormat
-FindSupportedFormat(VkPhysicalDevice vkPhysicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
+FindSupportedFormat(vulkanAPI::CapabilityCache *capabilityCache, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
 {
     for (VkFormat format : candidates) {
-        VkFormatProperties props;
-        vkGetPhysicalDeviceFormatProperties(vkPhysicalDevice, format, &props);
+        const VkFormatProperties props = capabilityCache->GetFormatProperties(format);
 
         if(tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features) {
             return format;
@@ -77,44 +79,68 @@ FindSupportedFormat(VkPhysicalDevice vkPhysicalDevice, const std::vector<VkForma
     return VK_FORMAT_UNDEFINED;
 }
 
+/// Depth/stencil formats, with the bits they hold and the bytes a sample of them takes in memory
+typedef struct DepthStencilFormat_t {
+    VkFormat    format;
+    uint32_t    depthBits;
+    uint32_t    stencilBits;
+    uint32_t    bytes;
+} DepthStencilFormat_t;
+
+static const DepthStencilFormat_t depthStencilFormats[] = {
+    {VK_FORMAT_S8_UINT,              0, 8, 1},
+    {VK_FORMAT_D16_UNORM,           16, 0, 2},
+    {VK_FORMAT_D16_UNORM_S8_UINT,   16, 8, 3},
+    {VK_FORMAT_X8_D24_UNORM_PACK32, 24, 0, 4},
+    {VK_FORMAT_D24_UNORM_S8_UINT,   24, 8, 4},
+    {VK_FORMAT_D32_SFLOAT,          32, 0, 4},
+    {VK_FORMAT_D32_SFLOAT_S8_UINT,  32, 8, 8}
+};
+
 VkFormat
-FindSupportedDepthStencilFormat(VkPhysicalDevice dev, uint32_t depthSize, uint32_t stencilSize)
+FindSupportedDepthStencilFormat(vulkanAPI::CapabilityCache *capabilityCache, uint32_t depthSize, uint32_t stencilSize, VkFormatFeatureFlags features)
 {
-    std::vector<VkFormat> acceptableFormats;
-    switch(depthSize) {
-    case 0:
-    {
-        stencilSize ?
-                    acceptableFormats = {VK_FORMAT_S8_UINT,
-                     VK_FORMAT_D16_UNORM_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT} :
-                    acceptableFormats = { }; break;
-    }
-    case 16:
-    {
-        stencilSize ?
-                    acceptableFormats = {VK_FORMAT_D16_UNORM_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT} :
-                    acceptableFormats = {VK_FORMAT_D16_UNORM, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D32_SFLOAT}; break;
+    if(!depthSize && !stencilSize) {
+        return VK_FORMAT_UNDEFINED;
     }
-    case 24:
-    {
-        stencilSize ?
-                    acceptableFormats = {VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D32_SFLOAT_S8_UINT} :
-                    acceptableFormats = {VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D32_SFLOAT}; break;
-    }
-    case 32:
-    {
-        stencilSize ?
-                    acceptableFormats = {VK_FORMAT_D32_SFLOAT_S8_UINT} :
-                    acceptableFormats = {VK_FORMAT_D32_SFLOAT}; break;
+
+    // every format holding at least the requested bits is acceptable, those the device renders to are tried
+    // by the bytes each sample loads and stores, then without the aspect that was not asked for,
+    // then with the fewest depth bits. Depth bits come first where precision is preferred
+    const bool precision = depthSize && vulkanAPI::GetContext()->mPreferDepthPrecision;
+    std::vector<const DepthStencilFormat_t *> candidates;
+    for(const auto &entry : depthStencilFormats) {
+        if(entry.depthBits >= depthSize && entry.stencilBits >= stencilSize) {
+            candidates.push_back(&entry);
+        }
     }
-    default: NOT_REACHED(); break;
+
+    std::stable_sort(candidates.begin(), candidates.end(), [=](const DepthStencilFormat_t *a, const DepthStencilFormat_t *b) {
+        if(precision && a->depthBits != b->depthBits) {
+            return a->depthBits > b->depthBits;
+        }
+        if(a->bytes != b->bytes) {
+            return a->bytes < b->bytes;
+        }
+        const bool aExtra = (!depthSize && a->depthBits) || (!stencilSize && a->stencilBits);
+        const bool bExtra = (!depthSize && b->depthBits) || (!stencilSize && b->stencilBits);
+        if(aExtra != bExtra) {
+            return bExtra;
+        }
+        return a->depthBits < b->depthBits;
+    });
+
+    std::vector<VkFormat> acceptableFormats;
+    acceptableFormats.reserve(candidates.size());
+    for(const auto candidate : candidates) {
+        acceptableFormats.push_back(candidate->format);
     }
 
     return FindSupportedFormat(
-        dev,
+        capabilityCache,
         acceptableFormats,
         VK_IMAGE_TILING_OPTIMAL,
-        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+        features
     );
 }
 
@@ -179,6 +205,37 @@ VkFormatIsColor(VkFormat format)
     return (format != VK_FORMAT_UNDEFINED) && !VkFormatIsDepthStencil(format);
 }
 
+uint32_t
+GetMaxVkSampleCount(VkSampleCountFlags supportedCounts)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    uint32_t maxSamples = 1;
+    for(uint32_t count = VK_SAMPLE_COUNT_64_BIT; count > VK_SAMPLE_COUNT_1_BIT; count >>= 1) {
+        if(supportedCounts & count) {
+            maxSamples = count;
+            break;
+        }
+    }
+
+    return maxSamples;
+}
+
+VkSampleCountFlagBits
+FindSupportedVkSampleCount(VkSampleCountFlags supportedCounts, uint32_t samples)
+{
+    FUN_ENTRY(GL_LOG_TRACE);
+
+    // the smallest supported count that is at least the requested one
+    for(uint32_t count = VK_SAMPLE_COUNT_2_BIT; count <= VK_SAMPLE_COUNT_64_BIT && samples > 1; count <<= 1) {
+        if(count >= samples && (supportedCounts & count)) {
+            return static_cast<VkSampleCountFlagBits>(count);
+        }
+    }
+
+    return samples > 1 ? static_cast<VkSampleCountFlagBits>(GetMaxVkSampleCount(supportedCounts)) : VK_SAMPLE_COUNT_1_BIT;
+}
+
 #define CASE_STR(c)                     case VK_ ##c: return "VK_" STRINGIFY(c);
 
 const char *
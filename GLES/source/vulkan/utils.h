@@ -27,15 +27,21 @@
 #include "vulkan/vulkan.h"
 #include <vector>
 
+namespace vulkanAPI {
+    class CapabilityCache;
+}
 
 uint32_t                GetVkFormatStencilBits(VkFormat format);
 uint32_t                GetVkFormatDepthBits(VkFormat format);
-VkFormat                FindSupportedDepthStencilFormat(VkPhysicalDevice dev, uint32_t depthSize, uint32_t stencilSize);
-VkFormat                FindSupportedFormat(VkPhysicalDevice vkPhysicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+VkFormat                FindSupportedDepthStencilFormat(vulkanAPI::CapabilityCache *capabilityCache, uint32_t depthSize, uint32_t stencilSize,
+                                                        VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+VkFormat                FindSupportedFormat(vulkanAPI::CapabilityCache *capabilityCache, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 bool                    VkFormatIsDepthStencil(VkFormat format);
 bool                    VkFormatIsDepth(VkFormat format);
 bool                    VkFormatIsStencil(VkFormat format);
 bool                    VkFormatIsColor(VkFormat format);
+uint32_t                GetMaxVkSampleCount(VkSampleCountFlags supportedCounts);
+VkSampleCountFlagBits   FindSupportedVkSampleCount(VkSampleCountFlags supportedCounts, uint32_t samples);
 const char *            VkResultToString(VkResult res);
 
 #endif // __VKUTILS_H__
@@ -0,0 +1,322 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "EGL/egl.h"
+#include "GLES2/gl2.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+/// Draws through the GL entry points of GLOVE into a headless pbuffer.
+/// To measure nothing but the translation cost of GLOVE, run it against a
+/// Vulkan driver that does no work, e.g. with VK_ICD_FILENAMES set to the
+/// mock ICD of Vulkan-Tools.
+
+namespace Benchmarks {
+
+static std::atomic<uint64_t> allocations(0);
+
+} //end of namespace
+
+// every allocation of the process, the ones of GLOVE included, is counted,
+// which is why this benchmark is built as an executable of its own (glove_draw_bench)
+void *
+operator new(size_t size)
+{
+    Benchmarks::allocations.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = malloc(size ? size : 1);
+    if(ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *
+operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    Benchmarks::allocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size)                                   { return operator new(size); }
+void *operator new[](size_t size, const std::nothrow_t &t) noexcept { return operator new(size, t); }
+void  operator delete(void *ptr) noexcept                           { free(ptr); }
+void  operator delete[](void *ptr) noexcept                         { free(ptr); }
+void  operator delete(void *ptr, const std::nothrow_t &) noexcept   { free(ptr); }
+void  operator delete[](void *ptr, const std::nothrow_t &) noexcept { free(ptr); }
+
+namespace Benchmarks {
+
+#define DRAW_BENCH_SURFACE_SIZE                         256
+#define DRAW_BENCH_TEXTURES                             4
+#define DRAW_BENCH_PROGRAMS                             2
+
+static const char *drawVertexShader =
+    "attribute vec2 a_position;\n"
+    "attribute vec2 a_texCoord;\n"
+    "uniform vec4 u_offset;\n"
+    "varying vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    v_texCoord  = a_texCoord;\n"
+    "    gl_Position = vec4(a_position, 0.0, 1.0) + u_offset;\n"
+    "}\n";
+
+static const char *drawFragmentShaders[DRAW_BENCH_PROGRAMS] = {
+    "precision mediump float;\n"
+    "uniform sampler2D u_texture;\n"
+    "varying vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(u_texture, v_texCoord);\n"
+    "}\n",
+
+    "precision mediump float;\n"
+    "uniform sampler2D u_texture;\n"
+    "varying vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(u_texture, v_texCoord).bgra * 0.5;\n"
+    "}\n"
+};
+
+class DrawScene {
+private:
+    EGLDisplay            mDisplay;
+    EGLSurface            mSurface;
+    EGLContext            mContext;
+
+    GLuint                mPrograms[DRAW_BENCH_PROGRAMS];
+    GLint                 mOffsetLocations[DRAW_BENCH_PROGRAMS];
+    GLuint                mTextures[DRAW_BENCH_TEXTURES];
+    GLuint                mVertexBuffer;
+    GLuint                mIndexBuffer;
+
+    /// a fixed sequence, so that every run changes the same state
+    uint32_t              mRandom;
+
+    static GLuint         CompileShader(GLenum type, const char *source);
+    bool                  InitializeEGL(void);
+    bool                  InitializeGL(void);
+    inline uint32_t       NextRandom(void)              { mRandom = mRandom * 1664525u + 1013904223u; return mRandom >> 8; }
+
+    DrawScene();
+
+public:
+    static DrawScene     *Get(void);
+
+    void                  Reset(void)                   { mRandom = 1; }
+    /// churn is the percentage of the draws preceded by a change of program, texture, blending or depth state
+    void                  DrawFrame(uint32_t draws, uint32_t churn, bool indexed);
+};
+
+DrawScene::DrawScene()
+: mDisplay(EGL_NO_DISPLAY), mSurface(EGL_NO_SURFACE), mContext(EGL_NO_CONTEXT), mVertexBuffer(0), mIndexBuffer(0), mRandom(1)
+{
+}
+
+DrawScene *
+DrawScene::Get(void)
+{
+    // EGL is set up once for all the runs, a scene that failed to is never handed out
+    static DrawScene *scene = nullptr;
+    static bool initialized = false;
+    if(!initialized) {
+        initialized = true;
+        scene = new DrawScene();
+        if(!scene->InitializeEGL() || !scene->InitializeGL()) {
+            delete scene;
+            scene = nullptr;
+        }
+    }
+
+    return scene;
+}
+
+bool
+DrawScene::InitializeEGL(void)
+{
+    // no window system is needed, unless asked otherwise
+    setenv("GLOVE_HEADLESS", "1", 0);
+
+    mDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if(mDisplay == EGL_NO_DISPLAY || !eglInitialize(mDisplay, nullptr, nullptr)) {
+        return false;
+    }
+
+    const EGLint configAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+                                     EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+                                     EGL_DEPTH_SIZE, 16, EGL_NONE };
+    EGLConfig config;
+    EGLint    configCount = 0;
+    if(!eglChooseConfig(mDisplay, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, DRAW_BENCH_SURFACE_SIZE, EGL_HEIGHT, DRAW_BENCH_SURFACE_SIZE, EGL_NONE };
+    const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    mSurface = eglCreatePbufferSurface(mDisplay, config, surfaceAttribs);
+    mContext = eglCreateContext(mDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+
+    return mSurface != EGL_NO_SURFACE && mContext != EGL_NO_CONTEXT && eglMakeCurrent(mDisplay, mSurface, mSurface, mContext);
+}
+
+GLuint
+DrawScene::CompileShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    return compiled ? shader : 0;
+}
+
+bool
+DrawScene::InitializeGL(void)
+{
+    GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, drawVertexShader);
+    for(uint32_t i = 0; i < DRAW_BENCH_PROGRAMS; ++i) {
+        GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, drawFragmentShaders[i]);
+        if(!vertexShader || !fragmentShader) {
+            return false;
+        }
+
+        mPrograms[i] = glCreateProgram();
+        glAttachShader(mPrograms[i], vertexShader);
+        glAttachShader(mPrograms[i], fragmentShader);
+        glBindAttribLocation(mPrograms[i], 0, "a_position");
+        glBindAttribLocation(mPrograms[i], 1, "a_texCoord");
+        glLinkProgram(mPrograms[i]);
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(mPrograms[i], GL_LINK_STATUS, &linked);
+        if(!linked) {
+            return false;
+        }
+
+        mOffsetLocations[i] = glGetUniformLocation(mPrograms[i], "u_offset");
+        glUseProgram(mPrograms[i]);
+        glUniform1i(glGetUniformLocation(mPrograms[i], "u_texture"), 0);
+    }
+
+    const GLubyte texels[DRAW_BENCH_TEXTURES][16] = { { 255,   0,   0, 255, 0, 255,   0, 255,   0,   0, 255, 255, 255, 255, 255, 255 },
+                                                      {   0, 255,   0, 255, 0,   0, 255, 255, 255,   0,   0, 255,   0,   0,   0, 255 },
+                                                      {   0,   0, 255, 255, 255, 0,   0, 255,   0, 255,   0, 255, 128, 128, 128, 255 },
+                                                      { 128, 128, 128, 255, 255, 255, 0, 255, 0, 255, 255, 255, 255,   0, 255, 255 } };
+    glGenTextures(DRAW_BENCH_TEXTURES, mTextures);
+    for(uint32_t i = 0; i < DRAW_BENCH_TEXTURES; ++i) {
+        glBindTexture(GL_TEXTURE_2D, mTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    // a small quad, as the sprites and glyphs of the draw heavy applications are
+    const GLfloat  vertices[] = { -0.05f, -0.05f, 0.0f, 0.0f,   0.05f, -0.05f, 1.0f, 0.0f,
+                                   0.05f,  0.05f, 1.0f, 1.0f,  -0.05f,  0.05f, 0.0f, 1.0f };
+    const GLushort indices[]  = { 0, 1, 2, 0, 2, 3 };
+
+    glGenBuffers(1, &mVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glGenBuffers(1, &mIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<const void *>(0));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<const void *>(2 * sizeof(GLfloat)));
+
+    glViewport(0, 0, DRAW_BENCH_SURFACE_SIZE, DRAW_BENCH_SURFACE_SIZE);
+    glEnable(GL_DEPTH_TEST);
+
+    return glGetError() == GL_NO_ERROR;
+}
+
+void
+DrawScene::DrawFrame(uint32_t draws, uint32_t churn, bool indexed)
+{
+    uint32_t program = 0;
+    glUseProgram(mPrograms[program]);
+    glBindTexture(GL_TEXTURE_2D, mTextures[0]);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    for(uint32_t i = 0; i < draws; ++i) {
+        if(NextRandom() % 100 < churn) {
+            const uint32_t change = NextRandom();
+            switch(change % 4) {
+            case 0:  program = (program + 1) % DRAW_BENCH_PROGRAMS; glUseProgram(mPrograms[program]); break;
+            case 1:  glBindTexture(GL_TEXTURE_2D, mTextures[(change >> 2) % DRAW_BENCH_TEXTURES]); break;
+            case 2:  if(change & 4) { glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); } else { glDisable(GL_BLEND); } break;
+            default: glDepthFunc((change & 4) ? GL_LEQUAL : GL_LESS); break;
+            }
+        }
+
+        // every draw is placed by a uniform of its own
+        const GLfloat x = static_cast<GLfloat>(i % 19) * 0.1f - 0.9f;
+        const GLfloat y = static_cast<GLfloat>((i / 19) % 19) * 0.1f - 0.9f;
+        glUniform4f(mOffsetLocations[program], x, y, 0.0f, 0.0f);
+
+        if(indexed) {
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, reinterpret_cast<const void *>(0));
+        } else {
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        }
+    }
+
+    eglSwapBuffers(mDisplay, mSurface);
+}
+
+static void
+DrawThroughputBench(benchmark::State &state)
+{
+    DrawScene *scene = DrawScene::Get();
+    if(scene == nullptr) {
+        state.SkipWithError("no headless EGL context could be created");
+        return;
+    }
+
+    const uint32_t draws   = static_cast<uint32_t>(state.range(0));
+    const uint32_t churn   = static_cast<uint32_t>(state.range(1));
+    const bool     indexed = state.range(2) != 0;
+
+    // the first frame creates the pipelines and descriptors the others reuse
+    scene->Reset();
+    scene->DrawFrame(draws, churn, indexed);
+    scene->Reset();
+
+    uint64_t elapsed = 0;
+    const uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+    for(auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        scene->DrawFrame(draws, churn, indexed);
+        elapsed += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // a steady-state frame is expected to reach the heap for none of its draws
+    const double totalDraws       = static_cast<double>(state.iterations()) * draws;
+    const double totalAllocations = static_cast<double>(allocations.load(std::memory_order_relaxed) - allocationsBefore);
+    state.counters["ns_per_draw"]      = benchmark::Counter(static_cast<double>(elapsed) / totalDraws);
+    state.counters["allocs_per_draw"]  = benchmark::Counter(totalAllocations / totalDraws);
+    state.counters["allocs_per_frame"] = benchmark::Counter(totalAllocations / static_cast<double>(state.iterations()));
+    state.counters["draws_per_s"]      = benchmark::Counter(totalDraws, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(DrawThroughputBench)->ArgNames({ "draws", "churn", "indexed" })
+                              ->Args({  1000,   0, 0 })->Args({ 10000,   0, 0 })->Args({ 10000,   0, 1 })
+                              ->Args({ 10000,  10, 1 })->Args({ 10000,  50, 1 })->Args({ 10000, 100, 1 })
+                              ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} //end of namespace
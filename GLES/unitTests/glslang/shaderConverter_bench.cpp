@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "shaderCorpus.h"
+#include <memory>
+
+namespace Benchmarks {
+
+// only the conversion of the ESSL 100 sources to ESSL 400 is timed, the compile it works on is redone untimed every time
+static void
+ShaderConverterBench(benchmark::State &state)
+{
+    const shaderCorpusEntry_t &entry = shaderCorpus[state.range(0)];
+    state.SetLabel(entry.name);
+
+    std::unique_ptr<GlslangShaderCompiler> compiler;
+    for(auto _ : state) {
+        state.PauseTiming();
+        compiler.reset(new GlslangShaderCompiler());
+        const bool compiled = CompileProgram(compiler.get(), entry.vertex, entry.fragment);
+        state.ResumeTiming();
+
+        if(!compiled || !ConvertProgram(compiler.get())) {
+            state.SkipWithError("the shader did not compile");
+            break;
+        }
+    }
+}
+
+BENCHMARK(ShaderConverterBench)->DenseRange(0, static_cast<int>(shaderCorpusSize) - 1)->Unit(benchmark::kMicrosecond);
+
+// the whole front end of glLinkProgram, for comparing the conversion against the compiles around it
+static void
+ShaderLinkBench(benchmark::State &state)
+{
+    const shaderCorpusEntry_t &entry = shaderCorpus[state.range(0)];
+    state.SetLabel(entry.name);
+
+    std::vector<uint32_t> vertexSpv;
+    std::vector<uint32_t> fragmentSpv;
+    for(auto _ : state) {
+        GlslangShaderCompiler compiler;
+        if(!CompileProgram(&compiler, entry.vertex, entry.fragment) || !ConvertProgram(&compiler) ||
+           !LinkProgram(&compiler, &vertexSpv, &fragmentSpv)) {
+            state.SkipWithError("the shader did not link");
+            break;
+        }
+    }
+}
+
+BENCHMARK(ShaderLinkBench)->DenseRange(0, static_cast<int>(shaderCorpusSize) - 1)->Unit(benchmark::kMicrosecond);
+
+} //end of namespace
@@ -0,0 +1,181 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "shaderCorpus.h"
+
+namespace Benchmarks {
+
+/// any id will do, the programs are never saved to files
+static const uintptr_t benchProgram = 1;
+
+const shaderCorpusEntry_t shaderCorpus[] = {
+    { "PassThrough",
+      "attribute vec4 a_position;\n"
+      "uniform mat4 u_mvp;\n"
+      "void main() {\n"
+      "    gl_Position = u_mvp * a_position;\n"
+      "}\n",
+      "precision mediump float;\n"
+      "uniform vec4 u_color;\n"
+      "void main() {\n"
+      "    gl_FragColor = u_color;\n"
+      "}\n" },
+
+    { "TexturedLit",
+      "attribute vec4 a_position;\n"
+      "attribute vec3 a_normal;\n"
+      "attribute vec2 a_texCoord;\n"
+      "uniform mat4 u_modelView;\n"
+      "uniform mat4 u_projection;\n"
+      "uniform mat3 u_normalMatrix;\n"
+      "varying vec3 v_normal;\n"
+      "varying vec3 v_position;\n"
+      "varying vec2 v_texCoord;\n"
+      "void main() {\n"
+      "    vec4 position = u_modelView * a_position;\n"
+      "    v_position    = position.xyz;\n"
+      "    v_normal      = normalize(u_normalMatrix * a_normal);\n"
+      "    v_texCoord    = a_texCoord;\n"
+      "    gl_Position   = u_projection * position;\n"
+      "}\n",
+      "precision mediump float;\n"
+      "uniform sampler2D u_diffuse;\n"
+      "uniform vec3 u_lightPosition;\n"
+      "uniform vec3 u_lightColor;\n"
+      "uniform float u_shininess;\n"
+      "varying vec3 v_normal;\n"
+      "varying vec3 v_position;\n"
+      "varying vec2 v_texCoord;\n"
+      "void main() {\n"
+      "    vec3 n = normalize(v_normal);\n"
+      "    vec3 l = normalize(u_lightPosition - v_position);\n"
+      "    vec3 h = normalize(l - normalize(v_position));\n"
+      "    float diffuse  = max(dot(n, l), 0.0);\n"
+      "    float specular = pow(max(dot(n, h), 0.0), u_shininess);\n"
+      "    vec4 albedo = texture2D(u_diffuse, v_texCoord);\n"
+      "    gl_FragColor = vec4(albedo.rgb * u_lightColor * diffuse + vec3(specular), albedo.a);\n"
+      "}\n" },
+
+    { "Skinned",
+      "attribute vec4 a_position;\n"
+      "attribute vec4 a_weights;\n"
+      "attribute vec4 a_joints;\n"
+      "attribute vec2 a_texCoord;\n"
+      "struct Light { vec3 direction; vec3 color; };\n"
+      "uniform mat4 u_joints[16];\n"
+      "uniform mat4 u_viewProjection;\n"
+      "uniform Light u_lights[2];\n"
+      "varying vec3 v_color;\n"
+      "varying vec2 v_texCoord;\n"
+      "void main() {\n"
+      "    mat4 skin = a_weights.x * u_joints[int(a_joints.x)] +\n"
+      "                a_weights.y * u_joints[int(a_joints.y)] +\n"
+      "                a_weights.z * u_joints[int(a_joints.z)] +\n"
+      "                a_weights.w * u_joints[int(a_joints.w)];\n"
+      "    vec4 position = skin * a_position;\n"
+      "    vec3 normal   = normalize(position.xyz);\n"
+      "    v_color = vec3(0.0);\n"
+      "    for(int i = 0; i < 2; ++i) {\n"
+      "        v_color += u_lights[i].color * max(dot(normal, -u_lights[i].direction), 0.0);\n"
+      "    }\n"
+      "    v_texCoord  = a_texCoord;\n"
+      "    gl_Position = u_viewProjection * position;\n"
+      "}\n",
+      "precision mediump float;\n"
+      "uniform sampler2D u_texture;\n"
+      "varying vec3 v_color;\n"
+      "varying vec2 v_texCoord;\n"
+      "void main() {\n"
+      "    gl_FragColor = texture2D(u_texture, v_texCoord) * vec4(v_color, 1.0);\n"
+      "}\n" },
+
+    { "PostProcess",
+      "attribute vec2 a_position;\n"
+      "varying vec2 v_texCoord;\n"
+      "void main() {\n"
+      "    v_texCoord  = a_position * 0.5 + 0.5;\n"
+      "    gl_Position = vec4(a_position, 0.0, 1.0);\n"
+      "}\n",
+      "precision mediump float;\n"
+      "uniform sampler2D u_scene;\n"
+      "uniform sampler2D u_bloom;\n"
+      "uniform samplerCube u_environment;\n"
+      "uniform vec2 u_texelSize;\n"
+      "uniform float u_weights[5];\n"
+      "uniform float u_exposure;\n"
+      "varying vec2 v_texCoord;\n"
+      "void main() {\n"
+      "    vec3 bloom = texture2D(u_bloom, v_texCoord).rgb * u_weights[0];\n"
+      "    for(int i = 1; i < 5; ++i) {\n"
+      "        vec2 offset = vec2(float(i) * u_texelSize.x, 0.0);\n"
+      "        bloom += texture2D(u_bloom, v_texCoord + offset).rgb * u_weights[i];\n"
+      "        bloom += texture2D(u_bloom, v_texCoord - offset).rgb * u_weights[i];\n"
+      "    }\n"
+      "    vec3 reflection = textureCube(u_environment, vec3(v_texCoord, 1.0)).rgb;\n"
+      "    vec3 color = texture2D(u_scene, v_texCoord).rgb + bloom + reflection * 0.1;\n"
+      "    gl_FragColor = vec4(vec3(1.0) - exp(-color * u_exposure), 1.0);\n"
+      "}\n" }
+};
+
+const size_t shaderCorpusSize = sizeof(shaderCorpus) / sizeof(shaderCorpus[0]);
+
+const char *passThroughFragmentShader =
+    "precision mediump float;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(1.0);\n"
+    "}\n";
+
+std::string
+GenerateUniformVertexShader(uint32_t count)
+{
+    std::string source = "attribute vec4 a_position;\n";
+    for(uint32_t i = 0; i < count; ++i) {
+        source += "uniform vec4 u_value" + std::to_string(i) + ";\n";
+    }
+
+    source += "void main() {\n    vec4 sum = a_position;\n";
+    for(uint32_t i = 0; i < count; ++i) {
+        source += "    sum += u_value" + std::to_string(i) + ";\n";
+    }
+    source += "    gl_Position = sum;\n}\n";
+
+    return source;
+}
+
+bool
+CompileProgram(ShaderCompiler *compiler, const char *vertex, const char *fragment)
+{
+    if(!compiler->CompileShader(&vertex, SHADER_TYPE_VERTEX, ESSL_VERSION_100) ||
+       !compiler->CompileShader(&fragment, SHADER_TYPE_FRAGMENT, ESSL_VERSION_100) ||
+       !compiler->ValidateProgram(ESSL_VERSION_100)) {
+        return false;
+    }
+
+    compiler->PrepareReflection(ESSL_VERSION_100);
+    return true;
+}
+
+bool
+ConvertProgram(ShaderCompiler *compiler)
+{
+    return compiler->PreprocessShader(benchProgram, SHADER_TYPE_VERTEX  , ESSL_VERSION_100, ESSL_VERSION_400, false) &&
+           compiler->PreprocessShader(benchProgram, SHADER_TYPE_FRAGMENT, ESSL_VERSION_100, ESSL_VERSION_400, false);
+}
+
+bool
+LinkProgram(ShaderCompiler *compiler, std::vector<uint32_t> *vertexSpv, std::vector<uint32_t> *fragmentSpv)
+{
+    return compiler->LinkProgram(benchProgram, ESSL_VERSION_400, *vertexSpv, *fragmentSpv);
+}
+
+} //end of namespace
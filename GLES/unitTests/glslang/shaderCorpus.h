@@ -0,0 +1,45 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef __SHADER_CORPUS_H__
+#define __SHADER_CORPUS_H__
+
+#include "glslang/glslangShaderCompiler.h"
+#include <string>
+#include <vector>
+
+namespace Benchmarks {
+
+typedef struct shaderCorpusEntry_t {
+    const char                     *name;
+    const char                     *vertex;
+    const char                     *fragment;
+} shaderCorpusEntry_t;
+
+/// ESSL 100 programs shaped like the ones of the applications GLOVE runs
+extern const shaderCorpusEntry_t    shaderCorpus[];
+extern const size_t                 shaderCorpusSize;
+
+/// a vertex shader reading count vec4 uniforms
+std::string                         GenerateUniformVertexShader(uint32_t count);
+extern const char                  *passThroughFragmentShader;
+
+/// the steps of ShaderProgram::RunLinkJob, first the ESSL 100 compile and reflection ...
+bool                                CompileProgram(ShaderCompiler *compiler, const char *vertex, const char *fragment);
+/// ... then the conversion of both stages to ESSL 400 and the link into SPIR-V
+bool                                ConvertProgram(ShaderCompiler *compiler);
+bool                                LinkProgram(ShaderCompiler *compiler, std::vector<uint32_t> *vertexSpv, std::vector<uint32_t> *fragmentSpv);
+
+} //end of namespace
+
+#endif // __SHADER_CORPUS_H__
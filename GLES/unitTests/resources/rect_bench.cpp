@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "resources/rect.h"
+#include <vector>
+
+namespace Benchmarks {
+
+// the formats are converted pairwise, the same as glTexImage2D and glReadPixels do
+static void
+ConvertPixelsBench(benchmark::State &state, GLenum srcFormat, int srcElements, GLenum dstFormat, int dstElements)
+{
+    const int size = static_cast<int>(state.range(0));
+    ImageRect srcRect(0, 0, size, size, srcElements, 1, 4);
+    ImageRect dstRect(0, 0, size, size, dstElements, 1, 4);
+
+    std::vector<uint8_t> src(srcRect.GetRectBufferSize(), 0x7F);
+    std::vector<uint8_t> dst(dstRect.GetRectBufferSize());
+
+    for(auto _ : state) {
+        ConvertPixels(srcFormat, dstFormat, &srcRect, src.data(), &dstRect, dst.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * src.size());
+}
+
+BENCHMARK_CAPTURE(ConvertPixelsBench, RGBA_to_RGBA,      GL_RGBA,     4, GL_RGBA,      4)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertPixelsBench, RGBA_to_BGRA,      GL_RGBA,     4, GL_BGRA_EXT,  4)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertPixelsBench, BGRA_to_RGBA,      GL_BGRA_EXT, 4, GL_RGBA,      4)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertPixelsBench, RGB_to_RGBA,       GL_RGB,      3, GL_RGBA,      4)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertPixelsBench, RGBA_to_RGB,       GL_RGBA,     4, GL_RGB,       3)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertPixelsBench, RGBA_to_LUMINANCE, GL_RGBA,     4, GL_LUMINANCE, 1)->Arg(64)->Arg(256)->Arg(1024);
+
+// float texels, 0x3C bytes are finite in both halves and floats
+static void
+ConvertFloatPixelsBench(benchmark::State &state, GLenum srcFormat, int srcElements, int srcElementSize, GLenum dstFormat, int dstElements, int dstElementSize)
+{
+    const int size = static_cast<int>(state.range(0));
+    ImageRect srcRect(0, 0, size, size, srcElements, srcElementSize, 4);
+    ImageRect dstRect(0, 0, size, size, dstElements, dstElementSize, 4);
+
+    std::vector<uint8_t> src(srcRect.GetRectBufferSize(), 0x3C);
+    std::vector<uint8_t> dst(dstRect.GetRectBufferSize());
+
+    for(auto _ : state) {
+        ConvertPixels(srcFormat, dstFormat, &srcRect, src.data(), &dstRect, dst.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * src.size());
+}
+
+BENCHMARK_CAPTURE(ConvertFloatPixelsBench, RGB16F_to_RGBA16F,  GL_RGB16F_EXT,  3, 2, GL_RGBA16F_EXT, 4, 2)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertFloatPixelsBench, RGBA16F_to_RGBA32F, GL_RGBA16F_EXT, 4, 2, GL_RGBA32F_EXT, 4, 4)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertFloatPixelsBench, RGBA32F_to_RGBA16F, GL_RGBA32F_EXT, 4, 4, GL_RGBA16F_EXT, 4, 2)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(ConvertFloatPixelsBench, RGBA16F_to_RGBA,    GL_RGBA16F_EXT, 4, 2, GL_RGBA,        4, 1)->Arg(256)->Arg(1024);
+
+static void
+InvertImageYAxisBench(benchmark::State &state)
+{
+    const int size = static_cast<int>(state.range(0));
+    ImageRect rect(0, 0, size, size, 4, 1, 4);
+    std::vector<uint8_t> image(rect.GetRectBufferSize(), 0x7F);
+
+    for(auto _ : state) {
+        InvertImageYAxis(image.data(), &rect);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * image.size());
+}
+
+BENCHMARK(InvertImageYAxisBench)->Arg(64)->Arg(256)->Arg(1024);
+
+} //end of namespace
@@ -0,0 +1,62 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "glslang/shaderCorpus.h"
+#include "resources/shaderResourceInterface.h"
+
+namespace Benchmarks {
+
+// the uniforms set by the glUniform* calls of a draw, written straight into the client copy of their blocks
+static void
+SetUniformClientDataBench(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    const std::string vertex = GenerateUniformVertexShader(count);
+
+    GlslangShaderCompiler compiler;
+    std::vector<uint32_t> vertexSpv;
+    std::vector<uint32_t> fragmentSpv;
+    if(!CompileProgram(&compiler, vertex.c_str(), passThroughFragmentShader) || !ConvertProgram(&compiler) ||
+       !LinkProgram(&compiler, &vertexSpv, &fragmentSpv)) {
+        state.SkipWithError("the shader did not link");
+        return;
+    }
+
+    ShaderResourceInterface resourceInterface;
+    resourceInterface.SetReflection(compiler.GetShaderReflection());
+    resourceInterface.CreateInterface();
+    resourceInterface.SetReflectionSize();
+    resourceInterface.SetReflection(nullptr);
+    resourceInterface.AllocateUniformClientData();
+    resourceInterface.AllocateUniformBlockClientData();
+
+    std::vector<int> locations(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        locations[i] = resourceInterface.GetUniformLocation(("u_value" + std::to_string(i)).c_str());
+    }
+
+    float value[4] = { 0.0f, 0.25f, 0.5f, 1.0f };
+    for(auto _ : state) {
+        for(int location : locations) {
+            resourceInterface.SetUniformClientData(static_cast<uint32_t>(location), sizeof(value), value);
+        }
+        value[0] += 1.0f;
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+BENCHMARK(SetUniformClientDataBench)->Arg(1)->Arg(8)->Arg(32)->Arg(96);
+
+} //end of namespace
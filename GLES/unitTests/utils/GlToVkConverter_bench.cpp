@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "utils/GlToVkConverter.h"
+
+namespace Benchmarks {
+
+// the converters run for every pipeline state and texture that is set up
+static const GLenum internalFormats[] = { GL_RGBA8_OES, GL_RGB8_OES, GL_RGBA, GL_RGB, GL_LUMINANCE, GL_ALPHA, GL_LUMINANCE_ALPHA,
+                                          GL_RGB565, GL_RGBA4, GL_RGB5_A1, GL_BGRA8_EXT, GL_DEPTH_COMPONENT16, GL_STENCIL_INDEX8 };
+
+static const GLenum blendFactors[]    = { GL_ZERO, GL_ONE, GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR, GL_DST_COLOR, GL_ONE_MINUS_DST_COLOR,
+                                          GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA,
+                                          GL_CONSTANT_COLOR, GL_ONE_MINUS_CONSTANT_COLOR, GL_SRC_ALPHA_SATURATE };
+
+static const GLenum compareFuncs[]    = { GL_NEVER, GL_LESS, GL_EQUAL, GL_LEQUAL, GL_GREATER, GL_NOTEQUAL, GL_GEQUAL, GL_ALWAYS };
+
+static const GLenum attribTypes[]     = { GL_BYTE, GL_UNSIGNED_BYTE, GL_SHORT, GL_UNSIGNED_SHORT, GL_FIXED, GL_FLOAT };
+
+static void
+GlTexInternalFormatToVkFormatBench(benchmark::State &state)
+{
+    for(auto _ : state) {
+        for(GLenum format : internalFormats) {
+            benchmark::DoNotOptimize(GlTexInternalFormatToVkFormat(format));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (sizeof(internalFormats) / sizeof(internalFormats[0])));
+}
+
+BENCHMARK(GlTexInternalFormatToVkFormatBench);
+
+static void
+GlBlendFactorToVkBlendFactorBench(benchmark::State &state)
+{
+    for(auto _ : state) {
+        for(GLenum factor : blendFactors) {
+            benchmark::DoNotOptimize(GlBlendFactorToVkBlendFactor(factor));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (sizeof(blendFactors) / sizeof(blendFactors[0])));
+}
+
+BENCHMARK(GlBlendFactorToVkBlendFactorBench);
+
+static void
+GlCompareFuncToVkCompareOpBench(benchmark::State &state)
+{
+    for(auto _ : state) {
+        for(GLenum func : compareFuncs) {
+            benchmark::DoNotOptimize(GlCompareFuncToVkCompareOp(func));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (sizeof(compareFuncs) / sizeof(compareFuncs[0])));
+}
+
+BENCHMARK(GlCompareFuncToVkCompareOpBench);
+
+static void
+GlAttribPointerToVkFormatBench(benchmark::State &state)
+{
+    for(auto _ : state) {
+        for(GLenum type : attribTypes) {
+            for(GLint elements = 1; elements <= 4; ++elements) {
+                benchmark::DoNotOptimize(GlAttribPointerToVkFormat(elements, type, GL_FALSE));
+                benchmark::DoNotOptimize(GlAttribPointerToVkFormat(elements, type, GL_TRUE));
+            }
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (sizeof(attribTypes) / sizeof(attribTypes[0])) * 8);
+}
+
+BENCHMARK(GlAttribPointerToVkFormatBench);
+
+} //end of namespace
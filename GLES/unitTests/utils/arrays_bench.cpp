@@ -0,0 +1,138 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "resources/shader.h"
+#include "utils/arrays.hpp"
+#include <vector>
+
+namespace Benchmarks {
+
+// the ids are given out, looked up and returned in the order the GL objects of a frame are
+static void
+ObjectArrayAllocateBench(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    ObjectArray<Shader> shaders;
+
+    for(auto _ : state) {
+        for(uint32_t i = 0; i < count; ++i) {
+            benchmark::DoNotOptimize(shaders.Allocate());
+        }
+        for(uint32_t i = 1; i <= count; ++i) {
+            shaders.Deallocate(i);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+BENCHMARK(ObjectArrayAllocateBench)->Arg(16)->Arg(256)->Arg(4096);
+
+static void
+ObjectArrayLookupBench(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    ObjectArray<Shader> shaders;
+    for(uint32_t i = 0; i < count; ++i) {
+        shaders.GetObject(shaders.Allocate());
+    }
+
+    for(auto _ : state) {
+        for(uint32_t i = 1; i <= count; ++i) {
+            benchmark::DoNotOptimize(shaders.ObjectExists(i));
+            benchmark::DoNotOptimize(shaders.GetObject(i));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+BENCHMARK(ObjectArrayLookupBench)->Arg(16)->Arg(256)->Arg(4096);
+
+// the GL handle of the bound object, as glGetIntegerv(GL_CURRENT_PROGRAM) and the purge passes ask for it
+static void
+ObjectArrayReverseLookupBench(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    ObjectArray<Shader> shaders;
+    std::vector<Shader *> objects;
+    for(uint32_t i = 0; i < count; ++i) {
+        objects.push_back(shaders.GetObject(shaders.Allocate()));
+    }
+
+    for(auto _ : state) {
+        for(const Shader *shader : objects) {
+            benchmark::DoNotOptimize(shaders.GetObjectId(shader));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+
+BENCHMARK(ObjectArrayReverseLookupBench)->Arg(16)->Arg(256)->Arg(4096);
+
+static void
+ObjectArrayIterateBench(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    ObjectArray<Shader> shaders;
+    for(uint32_t i = 0; i < count; ++i) {
+        shaders.GetObject(shaders.Allocate());
+    }
+    // the holes a scene leaves behind
+    for(uint32_t i = 1; i <= count; i += 2) {
+        shaders.Deallocate(i);
+    }
+
+    for(auto _ : state) {
+        for(Shader *shader : *shaders.GetObjects()) {
+            benchmark::DoNotOptimize(shader);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * shaders.GetObjects()->size());
+}
+
+BENCHMARK(ObjectArrayIterateBench)->Arg(16)->Arg(256)->Arg(4096);
+
+// the contexts of a share group binding the objects of the same array from their own threads
+static ObjectArray<Shader> *sharedShaders = nullptr;
+
+static void
+ObjectArraySharedLookupBench(benchmark::State &state)
+{
+    const uint32_t count = 4096;
+    if(state.thread_index() == 0) {
+        sharedShaders = new ObjectArray<Shader>();
+        for(uint32_t i = 0; i < count; ++i) {
+            sharedShaders->GetObject(sharedShaders->Allocate());
+        }
+    }
+
+    for(auto _ : state) {
+        for(uint32_t id = 1; id <= count; ++id) {
+            benchmark::DoNotOptimize(sharedShaders->GetObject(id));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+    if(state.thread_index() == 0) {
+        delete sharedShaders;
+        sharedShaders = nullptr;
+    }
+}
+
+BENCHMARK(ObjectArraySharedLookupBench)->Threads(1)->Threads(2)->Threads(4);
+
+} //end of namespace
@@ -12,6 +12,10 @@
  */
 
 #include "arrays_tests.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace Testing {
 
@@ -67,4 +71,97 @@ TEST_F(ObjectArrayTest, DeleteShaders)
 
 }
 
+TEST_F(ObjectArrayTest, ReverseLookupAfterRemovals)
+{
+    for(uint32_t i=1; i<11; i++) {
+        ShaderArray.GetObject(ShaderArray.Allocate());
+    }
+
+    // every removal moves the last object into the slot it frees
+    for(uint32_t i=1; i<11; i+=3) {
+        ASSERT_TRUE(ShaderArray.Deallocate(i));
+    }
+
+    for(uint32_t i=1; i<11; i++) {
+        ASSERT_EQ(i % 3 != 1, ShaderArray.ObjectExists(i));
+        if(i % 3 != 1) {
+            ASSERT_EQ(i, ShaderArray.GetObjectId(ShaderArray.GetObject(i)));
+        }
+    }
+    ASSERT_EQ(6u, ShaderArray.GetObjects()->size());
+}
+
+TEST_F(ObjectArrayTest, RemoveFromListKeepsObject)
+{
+    Shader *shader = ShaderArray.GetObject(ShaderArray.Allocate());
+    uint32_t id = ShaderArray.GetObjectId(shader);
+
+    ASSERT_TRUE(ShaderArray.RemoveFromList(id));
+    ASSERT_FALSE(ShaderArray.ObjectExists(id));
+    ASSERT_EQ(~0u, ShaderArray.GetObjectId(shader));
+    ASSERT_FALSE(ShaderArray.RemoveFromList(id));
+    delete shader;
+
+    // GL handles are not given out again
+    ASSERT_EQ(id + 1, ShaderArray.Allocate());
+}
+
+TEST_F(ObjectArrayTest, HandlesBeyondTable)
+{
+    const uint32_t id = 0x80000000u;
+
+    Shader *shader = ShaderArray.GetObject(id);
+    ASSERT_TRUE(ShaderArray.ObjectExists(id));
+    ASSERT_EQ(id, ShaderArray.GetObjectId(shader));
+    ASSERT_EQ(shader, ShaderArray.GetObject(id));
+    ASSERT_EQ(id + 1, ShaderArray.Allocate());
+
+    ASSERT_TRUE(ShaderArray.Deallocate(id));
+    ASSERT_FALSE(ShaderArray.ObjectExists(id));
+}
+
+TEST_F(ObjectArrayTest, GetObjectsListsEveryObjectOnce)
+{
+    for(uint32_t i=1; i<11; i++) {
+        ShaderArray.GetObject(ShaderArray.Allocate());
+    }
+    ASSERT_TRUE(ShaderArray.Deallocate(10));
+    ASSERT_TRUE(ShaderArray.Deallocate(4));
+
+    std::vector<uint32_t> ids;
+    for(Shader *shader : *ShaderArray.GetObjects()) {
+        ids.push_back(ShaderArray.GetObjectId(shader));
+    }
+    std::sort(ids.begin(), ids.end());
+
+    ASSERT_EQ((std::vector<uint32_t>{1, 2, 3, 5, 6, 7, 8, 9}), ids);
+}
+
+TEST_F(ObjectArrayTest, LookupWhileAnotherThreadCreates)
+{
+    const uint32_t count = 4096;
+    std::atomic<uint32_t> created(0);
+
+    // a loader thread creates the objects that the render thread binds
+    std::thread loader([&]() {
+        for(uint32_t i=1; i<=count; i++) {
+            ShaderArray.GetObject(ShaderArray.Allocate());
+            created.store(i, std::memory_order_release);
+        }
+    });
+
+    uint32_t found = 0;
+    while(found < count) {
+        const uint32_t last = created.load(std::memory_order_acquire);
+        for(uint32_t id=found + 1; id<=last; id++) {
+            ASSERT_TRUE(ShaderArray.ObjectExists(id));
+            ASSERT_EQ(id, ShaderArray.GetObjectId(ShaderArray.GetObject(id)));
+        }
+        found = last;
+    }
+    loader.join();
+
+    ASSERT_EQ(count, ShaderArray.GetObjects()->size());
+}
+
 } //end of namespace
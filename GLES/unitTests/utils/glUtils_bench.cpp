@@ -0,0 +1,45 @@
+/**
+ * Copyright (C) 2015-2018 Think Silicon S.A. (https://think-silicon.com/)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public v3
+ * License as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "benchmark/benchmark.h"
+#include "utils/glUtils.h"
+#include <vector>
+
+namespace Benchmarks {
+
+// the range of client side indices is scanned on every indexed draw
+template<typename IndexType, GLenum type>
+static void
+GlIndexRangeBench(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    std::vector<IndexType> indices(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        indices[i] = static_cast<IndexType>((i * 7919u) % (1u << (8 * sizeof(IndexType) - 1)));
+    }
+
+    uint32_t minIndex = 0;
+    uint32_t maxIndex = 0;
+    for(auto _ : state) {
+        GlIndexRange(indices.data(), count, type, false, &minIndex, &maxIndex);
+        benchmark::DoNotOptimize(maxIndex);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * count * sizeof(IndexType));
+}
+
+BENCHMARK_TEMPLATE(GlIndexRangeBench, GLubyte,  GL_UNSIGNED_BYTE)->Arg(256)->Arg(65536);
+BENCHMARK_TEMPLATE(GlIndexRangeBench, GLushort, GL_UNSIGNED_SHORT)->Arg(256)->Arg(65536)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(GlIndexRangeBench, GLuint,   GL_UNSIGNED_INT)->Arg(256)->Arg(65536)->Arg(1 << 20);
+
+} //end of namespace
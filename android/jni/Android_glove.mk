@@ -35,6 +35,7 @@ include $(PREBUILT_STATIC_LIBRARY)
 include $(CLEAR_VARS)
 LOCAL_MODULE := libGLESv2_GLOVE
 LOCAL_SRC_FILES :=  $(SRC_PATH)/GLES/source/api/gl.cpp \
+                    $(SRC_PATH)/GLES/source/api/glDispatch.cpp \
                     $(SRC_PATH)/GLES/source/api/eglInterface.cpp \
                     $(SRC_PATH)/GLES/source/context/context.cpp \
                     $(SRC_PATH)/GLES/source/context/contextBufferObject.cpp \
@@ -7,6 +7,7 @@ BUILD_TYPE=Release
 VULKAN_LIBRARY=""
 VULKAN_INCLUDE_PATH=""
 TRACE_BUILD=OFF
+BUILD_BENCHMARKS=OFF
 TOOLCHAIN_FILE=""
 SYSROOT=""
 C_FLAGS=""
@@ -30,6 +31,7 @@ function buildGlove() {
           -DUSE_SURFACE=$USE_SURFACE \
           -DVULKAN_INCLUDE_PATH=$VULKAN_INCLUDE_PATH \
           -DTRACE_BUILD=$TRACE_BUILD \
+          -DBUILD_BENCHMARKS=$BUILD_BENCHMARKS \
           -DCMAKE_TOOLCHAIN_FILE=$TOOLCHAIN_FILE \
           -DCMAKE_SYSROOT=$SYSROOT \
           -DCMAKE_INSTALL_PREFIX=$INSTALL_PREFIX \
@@ -84,6 +86,11 @@ else
                 SYSROOT=$1
                 echo "Setting SYSROOT"
                 ;;
+            # option to build the microbenchmarks
+            -b|--benchmarks)
+                BUILD_BENCHMARKS=ON
+                echo "Building benchmarks"
+                ;;
             # option to activate GL & Vulkan logs
             -t|--trace-build)
                 TRACE_BUILD=ON
@@ -115,6 +122,7 @@ else
                 echo "Unrecognized option: $option"
                 echo "Try the following:"
                 echo " -a | --arm-compile                   # cross build for ARM platform (default OFF)"
+                echo " -b | --benchmarks                    # build the glove_bench microbenchmarks (default OFF)"
                 echo " -d | --debug                         # build in Debug mode (default Release)"
                 echo " -e | --werror                        # handle warnings as errors (default OFF)"
                 echo " -f | --use-surface                   # set windowing system (Options: XCB, ANDROID, NATIVE, WINDOWS, MACOS) (default XCB)"
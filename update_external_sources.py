@@ -14,9 +14,11 @@ SYSROOT = ""
 
 GLSLANG_REPOSITORY="https://github.com/KhronosGroup/glslang.git"
 GOOGLETEST_REPOSITORY="https://github.com/google/googletest.git"
+BENCHMARK_REPOSITORY="https://github.com/google/benchmark.git"
 NO_AMD_FLAG = "-DENABLE_AMD_EXTENSIONS=OFF"
 NO_NV_FLAG  = "-DENABLE_NV_EXTENSIONS=OFF"
 NO_OPT_FLAG = "-DENABLE_OPT=OFF"
+NO_BENCHMARK_TESTS_FLAG = "-DBENCHMARK_ENABLE_TESTING=OFF"
 
 def ReadLine(fileName):
     file = open(fileName, "rb")
@@ -59,10 +61,13 @@ def Build(proj):
     amd_flag = ""
     nv_flag  = ""
     opt_flag = ""
+    test_flag = ""
     if proj == "glslang":
         amd_flag = NO_AMD_FLAG
         nv_flag  = NO_NV_FLAG
         opt_flag = NO_OPT_FLAG
+    if proj == "benchmark":
+        test_flag = NO_BENCHMARK_TESTS_FLAG
 
     if sys.platform == "linux2" or sys.platform == "linux":
         print(check_output(["cmake", "-DCMAKE_BUILD_TYPE=Release",
@@ -72,6 +77,7 @@ def Build(proj):
                                      amd_flag,
                                      nv_flag,
                                      opt_flag,
+                                     test_flag,
                                      ".."]))
 
         os.system("make -j" + str(multiprocessing.cpu_count()))
@@ -82,6 +88,7 @@ def Build(proj):
                                      amd_flag,
                                      nv_flag,
                                      opt_flag,
+                                     test_flag,
                                      ".."]))
         # Build both versions for Windows to comply with MSVC requirements
         os.system("cmake --build . --config Release --target install")
@@ -93,6 +100,7 @@ def Build(proj):
                                      amd_flag,
                                      nv_flag,
                                      opt_flag,
+                                     test_flag,
                                      ".."]))
         os.system("cmake --build . --config Release --target install")
     else :
@@ -131,8 +139,10 @@ ParseOptions()
 
 GLSLANG_REVISION = ReadLine(EXT_DIR + os.path.sep + "glslang_revision")
 GOOGLETEST_REVISION = ReadLine(EXT_DIR + os.path.sep + "googletest_revision")
+BENCHMARK_REVISION = ReadLine(EXT_DIR + os.path.sep + "benchmark_revision")
 print('glslang revision: ' + GLSLANG_REVISION)
 print('googletest revision: ' + GOOGLETEST_REVISION)
+print('benchmark revision: ' + BENCHMARK_REVISION)
 
 if os.path.exists(EXT_DIR + os.path.sep + "glslang") == False or os.path.exists(EXT_DIR + os.path.sep + "glslang" + os.path.sep + ".git") == False :
     Create("glslang", GLSLANG_REPOSITORY, GLSLANG_REVISION)
@@ -147,3 +157,10 @@ else :
     Update("googletest", GOOGLETEST_REVISION)
 
 Build("googletest")
+
+if os.path.exists(EXT_DIR + os.path.sep + "benchmark") == False or os.path.exists(EXT_DIR + os.path.sep + "benchmark" + os.path.sep + ".git") == False :
+    Create("benchmark", BENCHMARK_REPOSITORY, BENCHMARK_REVISION)
+else :
+    Update("benchmark", BENCHMARK_REVISION)
+
+Build("benchmark")
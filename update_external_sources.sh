@@ -1,5 +1,5 @@
 #!/usr/bin/env bash
-# Update source for glslang, googletest
+# Update source for glslang, googletest, benchmark
 
 set -e
 
@@ -9,16 +9,21 @@ BUILD_FOLDER=build
 INSTALL_PATH=""
 TOOLCHAIN_FILE=""
 SYSROOT=""
+SPIRV_OPT=false
 
 GLSLANG_REPOSITORY="https://github.com/KhronosGroup/glslang.git"
 GOOGLETEST_REPOSITORY="https://github.com/google/googletest.git"
+BENCHMARK_REPOSITORY="https://github.com/google/benchmark.git"
 
 GLSLANG_REVISION=$(cat $EXT_DIR/glslang_revision)
 GOOGLETEST_REVISION=$(cat $EXT_DIR/googletest_revision)
+BENCHMARK_REVISION=$(cat $EXT_DIR/benchmark_revision)
 GLSLANG_FLAGS="-DENABLE_AMD_EXTENSIONS=OFF -DENABLE_NV_EXTENSIONS=OFF -DENABLE_OPT=OFF"
+BENCHMARK_FLAGS="-DBENCHMARK_ENABLE_TESTING=OFF -DBENCHMARK_ENABLE_GTEST_TESTS=OFF"
 
 echo "GLSLANG_REVISION=$GLSLANG_REVISION"
 echo "GOOGLETEST_REVISION=$GOOGLETEST_REVISION"
+echo "BENCHMARK_REVISION=$BENCHMARK_REVISION"
 
 function create() {
     PROJECT=$1
@@ -51,6 +56,9 @@ function build() {
     if [ $PROJECT == "glslang" ]; then
         PROJECT_FLAGS=$GLSLANG_FLAGS
     fi
+    if [ $PROJECT == "benchmark" ]; then
+        PROJECT_FLAGS=$BENCHMARK_FLAGS
+    fi
 
     echo "PROJECT_FLAGS:" $PROJECT_FLAGS
 
@@ -83,11 +91,17 @@ do
             BUILD_FOLDER=cross_build
             TOOLCHAIN_FILE=$BASEDIR/CMake/toolchain-arm.cmake
             ;;
+        # option to build glslang with the SPIRV-Tools optimizer
+        -o|--spirv-opt)
+            SPIRV_OPT=true
+            GLSLANG_FLAGS="-DENABLE_AMD_EXTENSIONS=OFF -DENABLE_NV_EXTENSIONS=OFF -DENABLE_OPT=ON"
+            ;;
         *)
             echo "Unrecognized option: $option"
             echo "Try the following:"
             echo " -i | --install-path (dir)    # set custom installation path"
             echo " -s | --sysroot      (dir)    # set sysroot for cross compilation"
+            echo " -o | --spirv-opt             # build glslang with the SPIRV-Tools optimizer"
             exit 1
             ;;
     esac
@@ -98,6 +112,11 @@ if [ ! -d "$EXT_DIR/glslang" ] || [ ! -d "$EXT_DIR/glslang/.git" ]; then
     create glslang $GLSLANG_REPOSITORY $GLSLANG_REVISION
 fi
 update glslang $GLSLANG_REVISION
+if [ "$SPIRV_OPT" = true ]; then
+    cd $EXT_DIR/glslang
+    python3 update_glslang_sources.py
+    cd $BASEDIR
+fi
 build glslang
 
 if [ ! -d "$EXT_DIR/googletest" ] || [ ! -d "$EXT_DIR/googletest/.git" ]; then
@@ -106,6 +125,12 @@ fi
 update googletest $GOOGLETEST_REVISION
 build googletest
 
+if [ ! -d "$EXT_DIR/benchmark" ] || [ ! -d "$EXT_DIR/benchmark/.git" ]; then
+    create benchmark $BENCHMARK_REPOSITORY $BENCHMARK_REVISION
+fi
+update benchmark $BENCHMARK_REVISION
+build benchmark
+
 if  grep -q "openSUSE" /etc/os-release 
 then
 	cd External/googletest/